@@ -1,5 +1,9 @@
 #pragma once
+#include "DensityMatrix/Backend.h"
 #include "GraphState/Backend.h"
+#include "Hybrid/Backend.h"
+#include "PauliFrame/Backend.h"
+#include "StabilizerTableau/Backend.h"
 #include "backends/QubitConfiguration.h"
 #include "interfaces/IConfiguration.h"
 #include "interfaces/IQuantumBackend.h"
@@ -9,6 +13,7 @@
 // the namespace for exposing the backend
 namespace quisp::backends {
 
+using abstract::BellMeasurementResult;
 using abstract::EigenvalueResult;
 using abstract::IConfiguration;
 using abstract::IQuantumBackend;
@@ -18,8 +23,17 @@ using abstract::MeasurementOutcome;
 using abstract::MeasureXResult;
 using abstract::MeasureYResult;
 using abstract::MeasureZResult;
+using abstract::PurificationBasis;
 using backends::StationaryQubitConfiguration;
+using density_matrix::DensityMatrixBackend;
+using density_matrix::DensityMatrixQubit;
 using graph_state::GraphStateBackend;
 using graph_state::GraphStateQubit;
+using hybrid::HybridBackend;
+using hybrid::HybridQubit;
+using pauli_frame::PauliFrameBackend;
+using pauli_frame::PauliFrameQubit;
+using stabilizer_tableau::StabilizerTableauBackend;
+using stabilizer_tableau::StabilizerTableauQubit;
 
 }  // namespace quisp::backends
@@ -0,0 +1,123 @@
+#include "Backend.h"
+#include "Qubit.h"
+#include "backends/interfaces/IConfiguration.h"
+#include "backends/interfaces/IQubit.h"
+#include "modules/QNIC/StationaryQubit/QubitId.h"
+
+using quisp::modules::qubit_id::QubitId;
+
+namespace quisp::backends::density_matrix {
+DensityMatrixBackend::DensityMatrixBackend(std::unique_ptr<IRandomNumberGenerator> rng, std::unique_ptr<StationaryQubitConfiguration> configuration)
+    : current_time(SimTime()), rng(std::move(rng)), short_live_qubit_pool_size(0) {
+  config = std::move(configuration);
+}
+DensityMatrixBackend::DensityMatrixBackend(std::unique_ptr<IRandomNumberGenerator> rng, std::unique_ptr<StationaryQubitConfiguration> configuration, ICallback* cb)
+    : DensityMatrixBackend(std::move(rng), std::move(configuration)) {
+  callback = cb;
+}
+DensityMatrixBackend::~DensityMatrixBackend() {
+  for (auto& pair : qubits) {
+    delete pair.second->getId();
+  }
+}
+
+std::unique_ptr<DensityMatrixQubit> DensityMatrixBackend::makeQubit(const IQubitId* id, std::unique_ptr<IConfiguration> conf, bool is_short_live) {
+  IConfiguration* raw_conf = conf.release();
+  StationaryQubitConfiguration* dm_conf = dynamic_cast<StationaryQubitConfiguration*>(raw_conf);
+  if (dm_conf == nullptr) {
+    delete raw_conf;
+    throw std::runtime_error("DensityMatrix::createQubit: failed to cast. got invalid configuration.");
+  }
+  auto qubit = std::make_unique<DensityMatrixQubit>(id, this, is_short_live);
+  qubit->configure(std::unique_ptr<StationaryQubitConfiguration>(dm_conf));
+  return qubit;
+}
+
+IQubit* DensityMatrixBackend::createShortLiveQubit() {
+  auto* qubit_id = new QubitId(-1, -1, -1, ++short_live_qubit_pool_size);
+  auto original_qubit = makeQubit(qubit_id, getDefaultConfiguration(), true);
+  auto* qubit_ptr = original_qubit.get();
+  qubits.insert({qubit_id->getPackedKey(), std::move(original_qubit)});
+  return qubit_ptr;
+}
+
+IQubit* DensityMatrixBackend::createQubit(const IQubitId* id, std::unique_ptr<IConfiguration> conf) {
+  if (qubits.find(id->getPackedKey()) != qubits.cend()) {
+    throw std::runtime_error("DensityMatrix::createQubit: trying to create qubit with already existed Id.");
+  }
+  auto original_qubit = makeQubit(id, std::move(conf), false);
+  auto* qubit_ptr = original_qubit.get();
+  qubits.insert({id->getPackedKey(), std::move(original_qubit)});
+  return qubit_ptr;
+}
+IQubit* DensityMatrixBackend::createQubit(const IQubitId* id) { return createQubit(id, getDefaultConfiguration()); }
+
+IQubit* DensityMatrixBackend::getQubit(const IQubitId* id) {
+  auto qubit_iterator = qubits.find(id->getPackedKey());
+  if (qubit_iterator == qubits.cend()) {
+    throw std::runtime_error("DensityMatrix::getQubit: trying to get qubit with non existing Id.");
+  }
+  return qubit_iterator->second.get();
+}
+
+IQubit* DensityMatrixBackend::getShortLiveQubit() {
+  if (short_live_qubit_pool.empty()) {
+    return createShortLiveQubit();
+  }
+  auto* qubit = short_live_qubit_pool.front();
+  short_live_qubit_pool.pop_front();
+  return qubit;
+}
+
+void DensityMatrixBackend::returnToPool(IQubit* pool_qubit) {
+  pool_qubit->setFree();
+  short_live_qubit_pool.emplace_back(pool_qubit);
+}
+
+void DensityMatrixBackend::deleteQubit(const IQubitId* id) {
+  auto qubit_iterator = qubits.find(id->getPackedKey());
+  if (qubit_iterator == qubits.cend()) {
+    throw std::runtime_error("DensityMatrix::deleteQubit: trying to delete qubit with non existing Id.");
+  }
+  // the qubit is traced out of its cluster on destruction
+  qubits.erase(qubit_iterator);
+}
+
+std::unique_ptr<IConfiguration> DensityMatrixBackend::getDefaultConfiguration() const {
+  // copy the default backend configuration for each qubit
+  return std::make_unique<StationaryQubitConfiguration>(*config.get());
+}
+const SimTime& DensityMatrixBackend::getSimTime() {
+  if (callback != nullptr) callback->willUpdate(*this);
+  return current_time;
+}
+void DensityMatrixBackend::setSimTime(SimTime time) { current_time = time; }
+double DensityMatrixBackend::dblrand() { return rng->doubleRandom(); }
+
+double DensityMatrixBackend::getBellPairFidelity(IQubit* first, IQubit* second) {
+  auto* dm_first = dynamic_cast<DensityMatrixQubit*>(first);
+  auto* dm_second = dynamic_cast<DensityMatrixQubit*>(second);
+  if (dm_first == nullptr || dm_second == nullptr || dm_first == dm_second) throw std::invalid_argument("DensityMatrix::getBellPairFidelity: needs two qubits of this backend");
+  dm_first->applyMemoryError();
+  dm_second->applyMemoryError();
+
+  Matrix4cd pair;
+  auto& first_cluster = dm_first->getCluster();
+  auto& second_cluster = dm_second->getCluster();
+  if (&first_cluster == &second_cluster) {
+    pair = first_cluster.reduced({first_cluster.position(dm_first), first_cluster.position(dm_second)});
+  } else {
+    // not entangled, the pair is the product of both reduced states
+    MatrixXcd first_rho = first_cluster.reduced({first_cluster.position(dm_first)});
+    MatrixXcd second_rho = second_cluster.reduced({second_cluster.position(dm_second)});
+    for (int i = 0; i < 2; i++) {
+      for (int j = 0; j < 2; j++) pair.block<2, 2>(2 * i, 2 * j) = first_rho(i, j) * second_rho;
+    }
+  }
+  // <Phi+| rho |Phi+>
+  return (pair(0, 0) + pair(0, 3) + pair(3, 0) + pair(3, 3)).real() / 2;
+}
+
+std::shared_ptr<const MemoryTransition> DensityMatrixBackend::getMemoryTransition(const Matrix6d& transition_matrix) { return memory_transitions.get(transition_matrix); }
+
+}  // namespace quisp::backends::density_matrix
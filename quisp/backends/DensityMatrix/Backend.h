@@ -0,0 +1,69 @@
+#pragma once
+#include <omnetpp.h>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include "../GraphState/MemoryTransition.h"
+#include "../interfaces/IConfiguration.h"
+#include "../interfaces/IQuantumBackend.h"
+#include "../interfaces/IQubit.h"
+#include "../interfaces/IRandomNumberGenerator.h"
+#include "Cluster.h"
+#include "Qubit.h"
+#include "backends/QubitConfiguration.h"
+#include "backends/interfaces/IQubitId.h"
+
+namespace quisp::backends::density_matrix {
+using abstract::IConfiguration;
+using abstract::IQuantumBackend;
+using abstract::IQubit;
+using abstract::IQubitId;
+using abstract::IRandomNumberGenerator;
+using graph_state::MemoryTransitionCache;
+
+/**
+ * @brief quantum backend that keeps the full density matrix of each cluster of entangled qubits.
+ *
+ * Unlike the stabilizer backends, it is not limited to Clifford gates and Pauli errors: the errors are applied as
+ * channels, which gives the exact mixed state, and it has T, arbitrary rotations and amplitude damping.
+ * The cost grows with 4^(cluster size), so it is meant for small systems, e.g. a few memories per node with purification.
+ */
+class DensityMatrixBackend : public IQuantumBackend {
+ public:
+  class ICallback {
+   public:
+    virtual ~ICallback() {}
+    virtual void willUpdate(DensityMatrixBackend& backend) = 0;
+  };
+  DensityMatrixBackend(std::unique_ptr<IRandomNumberGenerator> rng, std::unique_ptr<StationaryQubitConfiguration> configuration);
+  DensityMatrixBackend(std::unique_ptr<IRandomNumberGenerator> rng, std::unique_ptr<StationaryQubitConfiguration> configuration, ICallback* callback);
+  ~DensityMatrixBackend();
+  IQubit* createQubit(const IQubitId* id, std::unique_ptr<IConfiguration> conf) override;
+  IQubit* createQubit(const IQubitId* id) override;
+  IQubit* createShortLiveQubit() override;
+  IQubit* getQubit(const IQubitId* id) override;
+  IQubit* getShortLiveQubit() override;
+  void returnToPool(IQubit*) override;
+  void deleteQubit(const IQubitId* id) override;
+  std::unique_ptr<IConfiguration> getDefaultConfiguration() const override;
+  const SimTime& getSimTime() override;
+  void setSimTime(SimTime time) override;
+  double getBellPairFidelity(IQubit* first, IQubit* second) override;
+  double dblrand();
+
+  std::shared_ptr<const MemoryTransition> getMemoryTransition(const Matrix6d& transition_matrix);
+
+ protected:
+  std::unique_ptr<DensityMatrixQubit> makeQubit(const IQubitId* id, std::unique_ptr<IConfiguration> conf, bool is_short_live);
+
+  std::unordered_map<std::uint64_t, std::unique_ptr<DensityMatrixQubit>> qubits;
+  SimTime current_time;
+  const std::unique_ptr<IRandomNumberGenerator> rng;
+  std::unique_ptr<StationaryQubitConfiguration> config;
+  ICallback* callback = nullptr;
+  std::deque<IQubit*> short_live_qubit_pool;
+  MemoryTransitionCache memory_transitions;
+  int short_live_qubit_pool_size;  // this is used to generate qubit id for short live qubits in a pool; currenlty only photons.
+};
+}  // namespace quisp::backends::density_matrix
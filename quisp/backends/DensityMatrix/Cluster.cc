@@ -0,0 +1,172 @@
+#include "Cluster.h"
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+namespace quisp::backends::density_matrix {
+namespace {
+
+/**
+ * rho <- op rho op^dagger, where op acts on the bits of offsets: row a of op takes the basis index base + offsets[a].
+ * Dim is the fixed dimension of rho or Eigen::Dynamic, K the dimension of op.
+ */
+template <int Dim, int K>
+void applyKernel(MatrixXcd &rho, const Eigen::Matrix<Complex, K, K> &op, const std::array<std::size_t, K> &offsets) {
+  const auto dim = rho.rows();
+  Eigen::Map<Eigen::Matrix<Complex, Dim, Dim>> m(rho.data(), dim, dim);
+  std::size_t target_mask = 0;
+  for (auto offset : offsets) target_mask |= offset;
+
+  Eigen::Matrix<Complex, K, Dim> rows(K, dim);
+  for (std::size_t base = 0; base < static_cast<std::size_t>(dim); base++) {
+    if ((base & target_mask) != 0) continue;
+    for (int a = 0; a < K; a++) rows.row(a) = m.row(base + offsets[a]);
+    rows = (op * rows).eval();
+    for (int a = 0; a < K; a++) m.row(base + offsets[a]) = rows.row(a);
+  }
+  const Eigen::Matrix<Complex, K, K> op_conjugate = op.conjugate();
+  Eigen::Matrix<Complex, Dim, K> cols(dim, K);
+  for (std::size_t base = 0; base < static_cast<std::size_t>(dim); base++) {
+    if ((base & target_mask) != 0) continue;
+    for (int a = 0; a < K; a++) cols.col(a) = m.col(base + offsets[a]);
+    cols = (cols * op_conjugate.transpose()).eval();
+    for (int a = 0; a < K; a++) m.col(base + offsets[a]) = cols.col(a);
+  }
+}
+
+template <int K>
+void applyOperator(MatrixXcd &rho, int num_qubits, const Eigen::Matrix<Complex, K, K> &op, const std::array<std::size_t, K> &offsets) {
+  static_assert(DensityMatrixCluster::max_fixed_size == 6, "instantiate the kernels for each fixed size");
+  switch (num_qubits) {
+    case 1:
+      return applyKernel<2, K>(rho, op, offsets);
+    case 2:
+      return applyKernel<4, K>(rho, op, offsets);
+    case 3:
+      return applyKernel<8, K>(rho, op, offsets);
+    case 4:
+      return applyKernel<16, K>(rho, op, offsets);
+    case 5:
+      return applyKernel<32, K>(rho, op, offsets);
+    case 6:
+      return applyKernel<64, K>(rho, op, offsets);
+    default:
+      return applyKernel<Eigen::Dynamic, K>(rho, op, offsets);
+  }
+}
+
+template <int K>
+void applyKraus(MatrixXcd &rho, int num_qubits, const std::vector<Eigen::Matrix<Complex, K, K>> &kraus_operators, const std::array<std::size_t, K> &offsets) {
+  if (kraus_operators.empty()) throw std::invalid_argument("DensityMatrixCluster: a channel needs a Kraus operator");
+  MatrixXcd result = MatrixXcd::Zero(rho.rows(), rho.cols());
+  MatrixXcd term;
+  for (auto &kraus : kraus_operators) {
+    term = rho;
+    applyOperator<K>(term, num_qubits, kraus, offsets);
+    result += term;
+  }
+  rho.swap(result);
+}
+
+// the basis index i of the rest with the bit of the mask inserted
+std::size_t insertBit(std::size_t i, std::size_t mask, bool bit) {
+  auto low = i & (mask - 1);
+  return ((i - low) << 1) | (bit ? mask : 0) | low;
+}
+}  // namespace
+
+DensityMatrixCluster::DensityMatrixCluster(DensityMatrixQubit *qubit) : members{qubit}, rho(MatrixXcd::Zero(2, 2)) { rho(0, 0) = 1; }
+
+std::shared_ptr<DensityMatrixCluster> DensityMatrixCluster::merge(const DensityMatrixCluster &first, const DensityMatrixCluster &second) {
+  if (first.size() + second.size() > max_size) throw std::runtime_error("DensityMatrixCluster: the merged cluster exceeds max_size qubits");
+  std::shared_ptr<DensityMatrixCluster> merged(new DensityMatrixCluster());
+  merged->members = first.members;
+  merged->members.insert(merged->members.end(), second.members.begin(), second.members.end());
+  auto block = second.rho.rows();
+  merged->rho.resize(first.rho.rows() * block, first.rho.cols() * block);
+  for (Eigen::Index i = 0; i < first.rho.rows(); i++) {
+    for (Eigen::Index j = 0; j < first.rho.cols(); j++) merged->rho.block(i * block, j * block, block, block) = first.rho(i, j) * second.rho;
+  }
+  return merged;
+}
+
+int DensityMatrixCluster::position(const DensityMatrixQubit *qubit) const {
+  auto it = std::find(members.begin(), members.end(), qubit);
+  if (it == members.end()) throw std::runtime_error("DensityMatrixCluster: the qubit is not a member");
+  return static_cast<int>(it - members.begin());
+}
+
+void DensityMatrixCluster::apply(const Matrix2cd &op, int position) { applyOperator<2>(rho, size(), op, {0, mask(position)}); }
+
+void DensityMatrixCluster::apply(const Matrix4cd &op, int first, int second) {
+  applyOperator<4>(rho, size(), op, {0, mask(second), mask(first), mask(first) | mask(second)});
+}
+
+void DensityMatrixCluster::applyChannel(const std::vector<Matrix2cd> &kraus_operators, int position) { applyKraus<2>(rho, size(), kraus_operators, {0, mask(position)}); }
+
+void DensityMatrixCluster::applyChannel(const std::vector<Matrix4cd> &kraus_operators, int first, int second) {
+  applyKraus<4>(rho, size(), kraus_operators, {0, mask(second), mask(first), mask(first) | mask(second)});
+}
+
+double DensityMatrixCluster::probabilityOfOne(int position) const {
+  auto bit = mask(position);
+  double probability = 0;
+  for (Eigen::Index i = 0; i < rho.rows(); i++) {
+    if ((static_cast<std::size_t>(i) & bit) != 0) probability += rho(i, i).real();
+  }
+  return probability;
+}
+
+void DensityMatrixCluster::removeMeasured(int position, bool outcome) {
+  auto probability = outcome ? probabilityOfOne(position) : 1 - probabilityOfOne(position);
+  if (probability <= 0) throw std::runtime_error("DensityMatrixCluster: the measurement outcome has zero probability");
+  double weights[2] = {outcome ? 0 : 1 / probability, outcome ? 1 / probability : 0};
+  removeBit(position, weights);
+}
+
+void DensityMatrixCluster::removeTracedOut(int position) {
+  double weights[2] = {1, 1};
+  removeBit(position, weights);
+}
+
+void DensityMatrixCluster::removeBit(int position, const double (&weights)[2]) {
+  auto bit = mask(position);
+  auto dim = rho.rows() / 2;
+  MatrixXcd result = MatrixXcd::Zero(dim, dim);
+  for (int value = 0; value < 2; value++) {
+    if (weights[value] == 0) continue;
+    for (Eigen::Index j = 0; j < dim; j++) {
+      auto full_j = insertBit(j, bit, value);
+      for (Eigen::Index i = 0; i < dim; i++) result(i, j) += weights[value] * rho(insertBit(i, bit, value), full_j);
+    }
+  }
+  rho.swap(result);
+  members.erase(members.begin() + position);
+}
+
+MatrixXcd DensityMatrixCluster::reduced(const std::vector<int> &positions) const {
+  std::vector<std::size_t> kept_masks;
+  std::size_t kept = 0;
+  for (auto position : positions) {
+    kept_masks.push_back(mask(position));
+    kept |= mask(position);
+  }
+  auto reduced_dim = Eigen::Index{1} << positions.size();
+  MatrixXcd result = MatrixXcd::Zero(reduced_dim, reduced_dim);
+  // the reduced index of a full index, the first position is the most significant bit
+  auto reduce = [&](std::size_t full) {
+    std::size_t index = 0;
+    for (auto m : kept_masks) index = (index << 1) | ((full & m) != 0 ? 1 : 0);
+    return index;
+  };
+  for (Eigen::Index j = 0; j < rho.cols(); j++) {
+    for (Eigen::Index i = 0; i < rho.rows(); i++) {
+      // the traced out bits must agree
+      if (((static_cast<std::size_t>(i) ^ static_cast<std::size_t>(j)) & ~kept) != 0) continue;
+      result(reduce(i), reduce(j)) += rho(i, j);
+    }
+  }
+  return result;
+}
+
+}  // namespace quisp::backends::density_matrix
@@ -0,0 +1,65 @@
+#pragma once
+#include <Eigen/Dense>
+#include <complex>
+#include <memory>
+#include <vector>
+
+namespace quisp::backends::density_matrix {
+using Complex = std::complex<double>;
+using Eigen::Matrix2cd;
+using Eigen::Matrix4cd;
+using Eigen::MatrixXcd;
+
+class DensityMatrixQubit;
+
+/**
+ * @brief the density matrix of a cluster of qubits that may be entangled with each other, but not with the other clusters.
+ *
+ * The first member is the most significant bit of the basis index, like kron(first, second).
+ * The gate and channel kernels are instantiated for each dimension up to max_fixed_size qubits, so Eigen works on fixed size
+ * rows and columns without allocations, and on dynamic sized ones above that. Clusters above max_size qubits are rejected,
+ * the density matrix has 4^size entries.
+ */
+class DensityMatrixCluster {
+ public:
+  static constexpr int max_fixed_size = 6;
+  static constexpr int max_size = 10;
+
+  // the qubit alone in |0>
+  explicit DensityMatrixCluster(DensityMatrixQubit *qubit);
+  // kron(first, second) with the members of the first followed by the ones of the second
+  static std::shared_ptr<DensityMatrixCluster> merge(const DensityMatrixCluster &first, const DensityMatrixCluster &second);
+
+  int size() const { return static_cast<int>(members.size()); }
+  const std::vector<DensityMatrixQubit *> &getMembers() const { return members; }
+  // throws std::runtime_error if the qubit isn't a member
+  int position(const DensityMatrixQubit *qubit) const;
+  const MatrixXcd &getDensityMatrix() const { return rho; }
+
+  // rho <- op rho op^dagger on the qubit at the position
+  void apply(const Matrix2cd &op, int position);
+  // the same for the pair, the first position is the high bit of op
+  void apply(const Matrix4cd &op, int first, int second);
+  // rho <- sum_k K_k rho K_k^dagger
+  void applyChannel(const std::vector<Matrix2cd> &kraus_operators, int position);
+  void applyChannel(const std::vector<Matrix4cd> &kraus_operators, int first, int second);
+
+  double probabilityOfOne(int position) const;
+  // projects the qubit to the outcome, which must have a non zero probability, and removes it from the cluster
+  void removeMeasured(int position, bool outcome);
+  // traces the qubit out and removes it from the cluster
+  void removeTracedOut(int position);
+  // the reduced density matrix of the qubits at the positions, the first one is the most significant bit
+  MatrixXcd reduced(const std::vector<int> &positions) const;
+
+ protected:
+  DensityMatrixCluster() {}
+  std::size_t mask(int position) const { return std::size_t{1} << (size() - 1 - position); }
+  // rho(i, j) <- rho(i with the bit of the position, j with it), for the bit values in weights
+  void removeBit(int position, const double (&weights)[2]);
+
+  std::vector<DensityMatrixQubit *> members;
+  MatrixXcd rho;
+};
+
+}  // namespace quisp::backends::density_matrix
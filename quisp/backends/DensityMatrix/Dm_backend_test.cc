@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include "Backend.h"
+#include "Qubit.h"
+#include "backends/GraphState/test.h"
+#include "backends/interfaces/IConfiguration.h"
+
+namespace {
+using namespace quisp::backends::density_matrix;
+using quisp::backends::StationaryQubitConfiguration;
+using quisp_test::backends::graph_state::QubitId;
+using quisp_test::backends::graph_state::TestRNG;
+
+class DmBackend : public DensityMatrixBackend {
+ public:
+  using DensityMatrixBackend::qubits;
+  DmBackend(std::unique_ptr<IRandomNumberGenerator> rng, std::unique_ptr<StationaryQubitConfiguration> config) : DensityMatrixBackend(std::move(rng), std::move(config)) {}
+};
+
+class DmQubit : public DensityMatrixQubit {
+ public:
+  using DensityMatrixQubit::gate_err_cnot;
+  using DensityMatrixQubit::measurement_err;
+  using DensityMatrixQubit::memory_err;
+};
+
+class DmBackendTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    SimTime::setScaleExp(-9);
+    rng = new TestRNG();
+    backend = std::make_unique<DmBackend>(std::unique_ptr<IRandomNumberGenerator>(rng), std::make_unique<StationaryQubitConfiguration>());
+  }
+  DensityMatrixQubit* createQubit(int id) { return dynamic_cast<DensityMatrixQubit*>(backend->createQubit(new QubitId(id))); }
+  DensityMatrixQubit* createQubit(int id, const StationaryQubitConfiguration& conf) {
+    return dynamic_cast<DensityMatrixQubit*>(backend->createQubit(new QubitId(id), std::make_unique<StationaryQubitConfiguration>(conf)));
+  }
+  TestRNG* rng;
+  std::unique_ptr<DmBackend> backend;
+};
+
+TEST_F(DmBackendTest, createAndGetQubit) {
+  auto* id = new QubitId(123);
+  auto* qubit = backend->createQubit(id);
+  EXPECT_EQ(backend->qubits.size(), 1);
+  ASSERT_THROW(backend->createQubit(id), std::runtime_error);
+  QubitId same_id(123);
+  EXPECT_EQ(backend->getQubit(&same_id), qubit);
+  QubitId unknown_id(4);
+  ASSERT_THROW(backend->getQubit(&unknown_id), std::runtime_error);
+  ASSERT_THROW(backend->createQubit(new QubitId(5), std::make_unique<IConfiguration>()), std::runtime_error);
+}
+
+TEST_F(DmBackendTest, createQubitWithConfiguration) {
+  StationaryQubitConfiguration conf;
+  conf.measurement_z_err_rate = 0.25;
+  conf.memory_x_err_rate = 0.26;
+  conf.cnot_gate_err_rate = 0.5;
+  conf.cnot_gate_xx_err_ratio = 1;
+  auto* qubit = reinterpret_cast<DmQubit*>(createQubit(1, conf));
+  EXPECT_EQ(qubit->measurement_err.z_error_rate, 0.25);
+  EXPECT_EQ(qubit->memory_err.x_error_rate, 0.26);
+  EXPECT_EQ(qubit->gate_err_cnot.xx_error_rate, 0.5);
+}
+
+TEST_F(DmBackendTest, bellPairMergesAndMeasurementSplits) {
+  auto* left = createQubit(1);
+  auto* right = createQubit(2);
+  EXPECT_NEAR(backend->getBellPairFidelity(left, right), 0.5, 1e-12);
+  left->gateH();
+  left->gateCNOT(right);
+  EXPECT_EQ(&left->getCluster(), &right->getCluster());
+  EXPECT_NEAR(backend->getBellPairFidelity(left, right), 1, 1e-12);
+  EXPECT_NEAR(backend->getBellPairFidelity(right, left), 1, 1e-12);
+
+  rng->double_value = 0.3;
+  auto result = left->measureZ();
+  EXPECT_EQ(result, EigenvalueResult::MINUS_ONE);
+  EXPECT_NE(&left->getCluster(), &right->getCluster());
+  EXPECT_EQ(right->getCluster().size(), 1);
+  EXPECT_EQ(right->measureZ(), result);
+
+  right->setFree();
+  EXPECT_EQ(right->measureZ(), EigenvalueResult::PLUS_ONE);
+  EXPECT_THROW(backend->getBellPairFidelity(left, left), std::invalid_argument);
+}
+
+TEST_F(DmBackendTest, photonEmissionAndBellStateMeasurement) {
+  // same sequence as StationaryQubit::generateEntangledPhoton and BellStateAnalyzer::measureSuccessfully
+  auto* left = createQubit(1);
+  auto* right = createQubit(2);
+  auto* left_photon = backend->getShortLiveQubit();
+  auto* right_photon = backend->getShortLiveQubit();
+  left->noiselessH();
+  left->noiselessCNOT(left_photon);
+  right->noiselessH();
+  right->noiselessCNOT(right_photon);
+  EXPECT_EQ(left->getCluster().size(), 2);
+
+  left_photon->noiselessX();
+  left_photon->noiselessCNOT(right_photon);
+  left_photon->noiselessMeasureX(EigenvalueResult::PLUS_ONE);
+  right_photon->noiselessMeasureZ(EigenvalueResult::PLUS_ONE);
+  left_photon->relaseBackToPool();
+  right_photon->relaseBackToPool();
+
+  // the memories are now in Psi+, X on one of them gives Phi+
+  EXPECT_EQ(left->getCluster().size(), 2);
+  left->noiselessX();
+  EXPECT_NEAR(backend->getBellPairFidelity(left, right), 1, 1e-12);
+  EXPECT_EQ(backend->getShortLiveQubit(), left_photon);
+}
+
+TEST_F(DmBackendTest, depolarizedBellPairFidelity) {
+  StationaryQubitConfiguration conf;
+  conf.cnot_gate_err_rate = 0.3;
+  auto* left = createQubit(1, conf);
+  auto* right = createQubit(2, conf);
+  left->noiselessH();
+  left->gateCNOT(right);
+  // the errors of the two qubit gate are exact, 3 of the 15 Paulis (XX, YY, ZZ) keep Phi+ up to a sign
+  EXPECT_NEAR(backend->getBellPairFidelity(left, right), 1 - 0.3 * 12 / 15, 1e-12);
+}
+
+TEST_F(DmBackendTest, memoryRelaxationAndAmplitudeDamping) {
+  StationaryQubitConfiguration conf;
+  conf.memory_relaxation_rate = 0.5;
+  auto* qubit = createQubit(1, conf);
+  qubit->noiselessX();
+  backend->setSimTime(SimTime(1000, omnetpp::SIMTIME_US));
+  // the channel is applied as a whole, the qubit has relaxed without any random draw
+  rng->double_value = 0.0;
+  qubit->applyMemoryError();
+  EXPECT_NEAR(qubit->getCluster().probabilityOfOne(0), 0, 1e-6);
+
+  auto* damped = createQubit(2);
+  damped->noiselessX();
+  damped->applyAmplitudeDamping(0.25);
+  EXPECT_NEAR(damped->getCluster().probabilityOfOne(0), 0.75, 1e-12);
+  EXPECT_THROW(damped->applyAmplitudeDamping(1.5), std::invalid_argument);
+}
+
+TEST_F(DmBackendTest, nonCliffordRotations) {
+  auto* qubit = createQubit(1);
+  qubit->gateH();
+  qubit->gateT();
+  qubit->gateT();
+  // T^2 = S, H S |0> is Y+
+  rng->double_value = 0.5;
+  EXPECT_EQ(qubit->measureY(), EigenvalueResult::PLUS_ONE);
+
+  // Ry(theta) |0> has the probability sin^2(theta / 2) of 1
+  auto* rotated = createQubit(2);
+  double theta = 0.7;
+  Matrix2cd ry;
+  ry << std::cos(theta / 2), -std::sin(theta / 2), std::sin(theta / 2), std::cos(theta / 2);
+  rotated->applyUnitary(ry);
+  EXPECT_NEAR(rotated->getCluster().probabilityOfOne(0), std::pow(std::sin(theta / 2), 2), 1e-12);
+  EXPECT_THROW(rotated->applyUnitary(Matrix2cd::Ones()), std::invalid_argument);
+}
+
+TEST_F(DmBackendTest, forcedMeasurementOfADeterministicOutcome) {
+  auto* qubit = createQubit(1);
+  EXPECT_EQ(qubit->noiselessMeasureZ(EigenvalueResult::MINUS_ONE), EigenvalueResult::PLUS_ONE);
+  qubit->noiselessX();
+  EXPECT_EQ(qubit->noiselessMeasureZ(EigenvalueResult::PLUS_ONE), EigenvalueResult::MINUS_ONE);
+}
+
+TEST_F(DmBackendTest, deletedQubitsAreTracedOut) {
+  auto* first = createQubit(1);
+  auto* second = createQubit(2);
+  auto* third = createQubit(3);
+  first->noiselessH();
+  first->noiselessCNOT(second);
+  first->noiselessCNOT(third);
+  EXPECT_EQ(first->getCluster().size(), 3);
+  QubitId id(2);
+  backend->deleteQubit(&id);
+  EXPECT_EQ(first->getCluster().size(), 2);
+  // the GHZ state without one qubit is the classical mixture of 00 and 11
+  EXPECT_NEAR(backend->getBellPairFidelity(first, third), 0.5, 1e-12);
+}
+
+}  // namespace
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include "Cluster.h"
+
+namespace {
+using namespace quisp::backends::density_matrix;
+
+// the cluster only keeps the member pointers, the qubits are never dereferenced
+DensityMatrixQubit* fakeQubit(std::uintptr_t i) { return reinterpret_cast<DensityMatrixQubit*>(i * 16); }
+
+const Matrix2cd hadamard = (Matrix2cd() << 1, 1, 1, -1).finished() / std::sqrt(2.0);
+const Matrix4cd cnot = (Matrix4cd() << 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 1, 0).finished();
+
+std::shared_ptr<DensityMatrixCluster> clusterOf(int num_qubits) {
+  auto cluster = std::make_shared<DensityMatrixCluster>(fakeQubit(1));
+  for (int i = 1; i < num_qubits; i++) cluster = DensityMatrixCluster::merge(*cluster, DensityMatrixCluster(fakeQubit(i + 1)));
+  return cluster;
+}
+
+// the GHZ state on the cluster, the density matrix has 1/2 at the corners
+void makeGhz(DensityMatrixCluster& cluster) {
+  cluster.apply(hadamard, 0);
+  for (int i = 1; i < cluster.size(); i++) cluster.apply(cnot, 0, i);
+}
+
+void expectGhz(const DensityMatrixCluster& cluster) {
+  auto& rho = cluster.getDensityMatrix();
+  auto last = rho.rows() - 1;
+  for (Eigen::Index i = 0; i < rho.rows(); i++) {
+    for (Eigen::Index j = 0; j < rho.cols(); j++) {
+      bool is_corner = (i == 0 || i == last) && (j == 0 || j == last);
+      EXPECT_NEAR(std::abs(rho(i, j) - Complex(is_corner ? 0.5 : 0, 0)), 0, 1e-12) << i << ", " << j;
+    }
+  }
+}
+
+TEST(DmClusterTest, mergeKeepsTheMemberOrder) {
+  DensityMatrixCluster first(fakeQubit(1));
+  DensityMatrixCluster second(fakeQubit(2));
+  second.apply((Matrix2cd() << 0, 1, 1, 0).finished(), 0);
+  auto merged = DensityMatrixCluster::merge(first, second);
+  ASSERT_EQ(merged->size(), 2);
+  EXPECT_EQ(merged->position(fakeQubit(1)), 0);
+  EXPECT_EQ(merged->position(fakeQubit(2)), 1);
+  EXPECT_THROW(merged->position(fakeQubit(3)), std::runtime_error);
+  // |01>, the second qubit is the low bit
+  EXPECT_DOUBLE_EQ(merged->getDensityMatrix()(1, 1).real(), 1);
+  EXPECT_DOUBLE_EQ(merged->probabilityOfOne(1), 1);
+  EXPECT_DOUBLE_EQ(merged->probabilityOfOne(0), 0);
+}
+
+TEST(DmClusterTest, fixedAndDynamicKernels) {
+  // 6 qubits use the fixed size kernels, 7 the dynamic ones
+  for (int num_qubits : {2, 6, 7}) {
+    auto cluster = clusterOf(num_qubits);
+    makeGhz(*cluster);
+    expectGhz(*cluster);
+    EXPECT_NEAR(cluster->getDensityMatrix().trace().real(), 1, 1e-12);
+  }
+}
+
+TEST(DmClusterTest, measurementSplitsTheGhzState) {
+  auto cluster = clusterOf(4);
+  makeGhz(*cluster);
+  EXPECT_NEAR(cluster->probabilityOfOne(2), 0.5, 1e-12);
+  cluster->removeMeasured(2, true);
+  ASSERT_EQ(cluster->size(), 3);
+  EXPECT_EQ(cluster->position(fakeQubit(4)), 2);
+  // the rest is |111>
+  EXPECT_NEAR(cluster->getDensityMatrix()(7, 7).real(), 1, 1e-12);
+  EXPECT_NEAR(cluster->probabilityOfOne(0), 1, 1e-12);
+
+  DensityMatrixCluster alone(fakeQubit(1));
+  EXPECT_THROW(alone.removeMeasured(0, true), std::runtime_error);
+}
+
+TEST(DmClusterTest, partialTrace) {
+  auto cluster = clusterOf(3);
+  makeGhz(*cluster);
+  auto pair = cluster->reduced({2, 0});
+  ASSERT_EQ(pair.rows(), 4);
+  // mixture of |00> and |11>, without the coherence
+  EXPECT_NEAR(pair(0, 0).real(), 0.5, 1e-12);
+  EXPECT_NEAR(pair(3, 3).real(), 0.5, 1e-12);
+  EXPECT_NEAR(std::abs(pair(0, 3)), 0, 1e-12);
+
+  cluster->removeTracedOut(1);
+  ASSERT_EQ(cluster->size(), 2);
+  EXPECT_TRUE(cluster->getDensityMatrix().isApprox(cluster->reduced({0, 1})));
+  EXPECT_NEAR((cluster->getDensityMatrix() - pair).norm(), 0, 1e-12);
+}
+
+TEST(DmClusterTest, channel) {
+  DensityMatrixCluster cluster(fakeQubit(1));
+  cluster.apply(hadamard, 0);
+  // full dephasing
+  const Matrix2cd z = (Matrix2cd() << 1, 0, 0, -1).finished();
+  cluster.applyChannel(std::vector<Matrix2cd>{Matrix2cd::Identity() / std::sqrt(2.0), z / std::sqrt(2.0)}, 0);
+  EXPECT_NEAR(std::abs(cluster.getDensityMatrix()(0, 1)), 0, 1e-12);
+  EXPECT_NEAR(cluster.getDensityMatrix()(0, 0).real(), 0.5, 1e-12);
+  EXPECT_THROW(cluster.applyChannel(std::vector<Matrix2cd>{}, 0), std::invalid_argument);
+}
+
+TEST(DmClusterTest, tooLargeClusters) {
+  auto cluster = clusterOf(DensityMatrixCluster::max_size);
+  EXPECT_THROW(DensityMatrixCluster::merge(*cluster, DensityMatrixCluster(fakeQubit(100))), std::runtime_error);
+}
+
+}  // namespace
@@ -0,0 +1,282 @@
+#include "Qubit.h"
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+#include "Backend.h"
+
+namespace quisp::backends::density_matrix {
+
+namespace {
+// below this, an outcome is treated as impossible instead of renormalizing rounding errors
+constexpr double impossible_probability = 1e-12;
+
+const Matrix2cd &pauliI() {
+  static const Matrix2cd m = Matrix2cd::Identity();
+  return m;
+}
+const Matrix2cd &pauliX() {
+  static const Matrix2cd m = (Matrix2cd() << 0, 1, 1, 0).finished();
+  return m;
+}
+const Matrix2cd &pauliY() {
+  static const Matrix2cd m = (Matrix2cd() << 0, Complex(0, -1), Complex(0, 1), 0).finished();
+  return m;
+}
+const Matrix2cd &pauliZ() {
+  static const Matrix2cd m = (Matrix2cd() << 1, 0, 0, -1).finished();
+  return m;
+}
+const Matrix2cd &hadamard() {
+  static const Matrix2cd m = (Matrix2cd() << 1, 1, 1, -1).finished() / std::sqrt(2.0);
+  return m;
+}
+const Matrix2cd &phaseS() {
+  static const Matrix2cd m = (Matrix2cd() << 1, 0, 0, Complex(0, 1)).finished();
+  return m;
+}
+const Matrix2cd &phaseSdg() {
+  static const Matrix2cd m = (Matrix2cd() << 1, 0, 0, Complex(0, -1)).finished();
+  return m;
+}
+const Matrix2cd &phaseT() {
+  static const Matrix2cd m = (Matrix2cd() << 1, 0, 0, std::polar(1.0, M_PI / 4)).finished();
+  return m;
+}
+// the control is the high bit
+const Matrix4cd &cnot() {
+  static const Matrix4cd m = (Matrix4cd() << 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 1, 0).finished();
+  return m;
+}
+Matrix4cd kron(const Matrix2cd &first, const Matrix2cd &second) {
+  Matrix4cd result;
+  for (int i = 0; i < 2; i++) {
+    for (int j = 0; j < 2; j++) result.block<2, 2>(2 * i, 2 * j) = first(i, j) * second;
+  }
+  return result;
+}
+}  // namespace
+
+DensityMatrixQubit::DensityMatrixQubit(const IQubitId *id, DensityMatrixBackend *const backend, bool is_short_live)
+    : cluster(std::make_shared<DensityMatrixCluster>(this)), id(id), backend(backend), is_short_live(is_short_live) {}
+
+DensityMatrixQubit::~DensityMatrixQubit() {
+  // the other members of the cluster keep it without this qubit
+  if (cluster->size() > 1) cluster->removeTracedOut(cluster->position(this));
+}
+
+const IQubitId *const DensityMatrixQubit::getId() const { return id; }
+
+void DensityMatrixQubit::relaseBackToPool() {
+  if (!is_short_live) {
+    throw std::runtime_error("cannot release non short-live qubit");
+  }
+  backend->returnToPool(this);
+}
+
+void DensityMatrixQubit::configure(std::unique_ptr<StationaryQubitConfiguration> c) {
+  setMemoryErrorRates(c->memory_x_err_rate, c->memory_y_err_rate, c->memory_z_err_rate, c->memory_excitation_rate, c->memory_relaxation_rate);
+  measurement_err.setParams(c->measurement_x_err_rate, c->measurement_y_err_rate, c->measurement_z_err_rate);
+  gate_err_h.setParams(c->h_gate_x_err_ratio, c->h_gate_y_err_ratio, c->h_gate_z_err_ratio, c->h_gate_err_rate);
+  gate_err_x.setParams(c->x_gate_x_err_ratio, c->x_gate_y_err_ratio, c->x_gate_z_err_ratio, c->x_gate_err_rate);
+  gate_err_z.setParams(c->z_gate_x_err_ratio, c->z_gate_y_err_ratio, c->z_gate_z_err_ratio, c->z_gate_err_rate);
+  gate_err_cnot.setParams(c->cnot_gate_err_rate, c->cnot_gate_ix_err_ratio, c->cnot_gate_iy_err_ratio, c->cnot_gate_iz_err_ratio, c->cnot_gate_xi_err_ratio,
+                          c->cnot_gate_xx_err_ratio, c->cnot_gate_xy_err_ratio, c->cnot_gate_xz_err_ratio, c->cnot_gate_yi_err_ratio, c->cnot_gate_yx_err_ratio,
+                          c->cnot_gate_yy_err_ratio, c->cnot_gate_yz_err_ratio, c->cnot_gate_zi_err_ratio, c->cnot_gate_zx_err_ratio, c->cnot_gate_zy_err_ratio,
+                          c->cnot_gate_zz_err_ratio);
+}
+
+void DensityMatrixQubit::setMemoryErrorRates(double x_error_rate, double y_error_rate, double z_error_rate, double excitation_rate, double relaxation_rate) {
+  memory_err.x_error_rate = x_error_rate;
+  memory_err.y_error_rate = y_error_rate;
+  memory_err.z_error_rate = z_error_rate;
+  memory_err.excitation_error_rate = excitation_rate;
+  memory_err.relaxation_error_rate = relaxation_rate;
+  memory_err.error_rate = x_error_rate + y_error_rate + z_error_rate + excitation_rate + relaxation_rate;  // This is per μs.
+  memory_transition = backend->getMemoryTransition(MemoryTransition::transitionMatrix(x_error_rate, y_error_rate, z_error_rate, excitation_rate, relaxation_rate));
+}
+
+void DensityMatrixQubit::apply(const Matrix2cd &op) { cluster->apply(op, cluster->position(this)); }
+
+void DensityMatrixQubit::mergeWith(DensityMatrixQubit *another_qubit) {
+  if (cluster == another_qubit->cluster) return;
+  auto merged = DensityMatrixCluster::merge(*cluster, *another_qubit->cluster);
+  for (auto *member : merged->getMembers()) member->cluster = merged;
+}
+
+void DensityMatrixQubit::applyCNOT(DensityMatrixQubit *target_qubit) {
+  mergeWith(target_qubit);
+  cluster->apply(cnot(), cluster->position(this), cluster->position(target_qubit));
+}
+
+void DensityMatrixQubit::applySingleQubitGateError(SingleGateErrorModel const &err) {
+  if (err.pauli_error_rate == 0) {
+    return;
+  }
+  cluster->applyChannel(std::vector<Matrix2cd>{std::sqrt(1 - err.pauli_error_rate) * pauliI(), std::sqrt(err.x_error_rate) * pauliX(),
+                                               std::sqrt(err.z_error_rate) * pauliZ(), std::sqrt(err.y_error_rate) * pauliY()},
+                        cluster->position(this));
+}
+
+void DensityMatrixQubit::applyTwoQubitGateError(TwoQubitGateErrorModel const &err, DensityMatrixQubit *another_qubit) {
+  if (err.pauli_error_rate == 0) {
+    return;
+  }
+  // the pauli on this qubit first, both in the order I, X, Y, Z
+  const Matrix2cd *paulis[4] = {&pauliI(), &pauliX(), &pauliY(), &pauliZ()};
+  const double rates[16] = {1 - err.pauli_error_rate, err.ix_error_rate, err.iy_error_rate, err.iz_error_rate, err.xi_error_rate, err.xx_error_rate,
+                            err.xy_error_rate,        err.xz_error_rate, err.yi_error_rate, err.yx_error_rate, err.yy_error_rate, err.yz_error_rate,
+                            err.zi_error_rate,        err.zx_error_rate, err.zy_error_rate, err.zz_error_rate};
+  std::vector<Matrix4cd> kraus_operators;
+  for (int label = 0; label < 16; label++) {
+    if (rates[label] == 0) continue;
+    kraus_operators.push_back(std::sqrt(rates[label]) * kron(*paulis[label / 4], *paulis[label % 4]));
+  }
+  cluster->applyChannel(kraus_operators, cluster->position(this), cluster->position(another_qubit));
+}
+
+void DensityMatrixQubit::applyMemoryError() {
+  // If no memory error occurs, skip this memory error simulation.
+  if (memory_err.error_rate == 0) return;
+
+  SimTime current_time = backend->getSimTime();
+  double time_evolution_microsec = (current_time.dbl() - updated_time.dbl()) * 1000000;
+  if (time_evolution_microsec > 0) {
+    // Clean, X, Z, Y, Excited, Relaxed
+    RowVector6d pi_vector = memory_transition->errorDistribution(time_evolution_microsec);
+    double sum = pi_vector.sum();
+    if (sum > 1.01 || sum < 0.99 || std::isnan(pi_vector(0, 0))) {
+      throw std::runtime_error("DensityMatrixQubit::applyMemoryError: invalid memory error distribution");
+    }
+    // the Pauli errors, excitation resets to |1> and relaxation to |0>
+    Matrix2cd to_one_from_zero = Matrix2cd::Zero(), to_one_from_one = Matrix2cd::Zero(), to_zero_from_zero = Matrix2cd::Zero(), to_zero_from_one = Matrix2cd::Zero();
+    to_one_from_zero(1, 0) = to_one_from_one(1, 1) = std::sqrt(pi_vector(0, 4));
+    to_zero_from_zero(0, 0) = to_zero_from_one(0, 1) = std::sqrt(pi_vector(0, 5));
+    cluster->applyChannel(std::vector<Matrix2cd>{std::sqrt(pi_vector(0, 0)) * pauliI(), std::sqrt(pi_vector(0, 1)) * pauliX(), std::sqrt(pi_vector(0, 2)) * pauliZ(),
+                                                 std::sqrt(pi_vector(0, 3)) * pauliY(), to_one_from_zero, to_one_from_one, to_zero_from_zero, to_zero_from_one},
+                          cluster->position(this));
+  }
+  updated_time = current_time;
+}
+
+EigenvalueResult DensityMatrixQubit::clusterMeasureZ(const EigenvalueResult *forced_result) {
+  auto position = cluster->position(this);
+  auto probability_of_one = cluster->probabilityOfOne(position);
+  bool is_one = forced_result != nullptr ? *forced_result == EigenvalueResult::MINUS_ONE : backend->dblrand() < probability_of_one;
+  if (is_one && probability_of_one < impossible_probability) is_one = false;
+  if (!is_one && 1 - probability_of_one < impossible_probability) is_one = true;
+
+  if (cluster->size() > 1) cluster->removeMeasured(position, is_one);
+  cluster = std::make_shared<DensityMatrixCluster>(this);
+  if (is_one) apply(pauliX());
+  return is_one ? EigenvalueResult::MINUS_ONE : EigenvalueResult::PLUS_ONE;
+}
+
+EigenvalueResult DensityMatrixQubit::flipWithProbability(EigenvalueResult result, double probability) {
+  if (backend->dblrand() < probability) {
+    return result == EigenvalueResult::PLUS_ONE ? EigenvalueResult::MINUS_ONE : EigenvalueResult::PLUS_ONE;
+  }
+  return result;
+}
+
+// public member functions
+
+void DensityMatrixQubit::setFree() {
+  // force qubit to be in |0> state
+  if (cluster->size() > 1) cluster->removeTracedOut(cluster->position(this));
+  cluster = std::make_shared<DensityMatrixCluster>(this);
+  updated_time = backend->getSimTime();
+}
+
+void DensityMatrixQubit::gateCNOT(IQubit *const target_qubit) {
+  auto dm_target_qubit = dynamic_cast<DensityMatrixQubit *>(target_qubit);
+  applyMemoryError();
+  dm_target_qubit->applyMemoryError();
+  applyCNOT(dm_target_qubit);
+  applyTwoQubitGateError(gate_err_cnot, dm_target_qubit);
+}
+
+void DensityMatrixQubit::gateH() {
+  applyMemoryError();
+  apply(hadamard());
+  applySingleQubitGateError(gate_err_h);
+}
+void DensityMatrixQubit::gateZ() {
+  applyMemoryError();
+  apply(pauliZ());
+  applySingleQubitGateError(gate_err_z);
+}
+void DensityMatrixQubit::gateX() {
+  applyMemoryError();
+  apply(pauliX());
+  applySingleQubitGateError(gate_err_x);
+}
+void DensityMatrixQubit::gateY() {
+  applyMemoryError();
+  apply(pauliY());
+  // same as GraphStateQubit, Y uses the X gate error
+  applySingleQubitGateError(gate_err_x);
+}
+void DensityMatrixQubit::gateS() {
+  applyMemoryError();
+  apply(phaseS());
+}
+void DensityMatrixQubit::gateSdg() {
+  applyMemoryError();
+  apply(phaseSdg());
+}
+void DensityMatrixQubit::gateT() {
+  applyMemoryError();
+  apply(phaseT());
+}
+void DensityMatrixQubit::applyUnitary(const Matrix2cd &unitary) {
+  if (!(unitary * unitary.adjoint()).isIdentity(1e-9)) throw std::invalid_argument("DensityMatrixQubit::applyUnitary: the matrix is not unitary");
+  applyMemoryError();
+  apply(unitary);
+}
+void DensityMatrixQubit::applyAmplitudeDamping(double gamma) {
+  if (gamma < 0 || gamma > 1) throw std::invalid_argument("DensityMatrixQubit::applyAmplitudeDamping: gamma must be in [0, 1]");
+  applyMemoryError();
+  Matrix2cd keep = Matrix2cd::Zero(), decay = Matrix2cd::Zero();
+  keep(0, 0) = 1;
+  keep(1, 1) = std::sqrt(1 - gamma);
+  decay(0, 1) = std::sqrt(gamma);
+  cluster->applyChannel(std::vector<Matrix2cd>{keep, decay}, cluster->position(this));
+}
+
+EigenvalueResult DensityMatrixQubit::measureX() {
+  applyMemoryError();
+  apply(hadamard());
+  return flipWithProbability(clusterMeasureZ(), measurement_err.x_error_rate);
+}
+
+EigenvalueResult DensityMatrixQubit::measureY() {
+  applyMemoryError();
+  apply(phaseSdg());
+  apply(hadamard());
+  return flipWithProbability(clusterMeasureZ(), measurement_err.y_error_rate);
+}
+
+EigenvalueResult DensityMatrixQubit::measureZ() {
+  applyMemoryError();
+  return flipWithProbability(clusterMeasureZ(), measurement_err.z_error_rate);
+}
+
+void DensityMatrixQubit::noiselessX() { apply(pauliX()); }
+void DensityMatrixQubit::noiselessZ() { apply(pauliZ()); }
+void DensityMatrixQubit::noiselessH() { apply(hadamard()); }
+void DensityMatrixQubit::noiselessCNOT(IQubit *const target_qubit) { applyCNOT(static_cast<DensityMatrixQubit *>(target_qubit)); }
+EigenvalueResult DensityMatrixQubit::noiselessMeasureZ() { return clusterMeasureZ(); }
+EigenvalueResult DensityMatrixQubit::noiselessMeasureX() {
+  apply(hadamard());
+  return clusterMeasureZ();
+}
+EigenvalueResult DensityMatrixQubit::noiselessMeasureZ(EigenvalueResult forced_result) {
+  // a forced result only applies to possible outcomes, deterministic outcomes are returned as they are.
+  return clusterMeasureZ(&forced_result);
+}
+EigenvalueResult DensityMatrixQubit::noiselessMeasureX(EigenvalueResult forced_result) {
+  apply(hadamard());
+  return noiselessMeasureZ(forced_result);
+}
+
+}  // namespace quisp::backends::density_matrix
@@ -0,0 +1,100 @@
+#pragma once
+#include <memory>
+#include "../GraphState/MemoryTransition.h"
+#include "../GraphState/types.h"
+#include "../interfaces/IQubit.h"
+#include "Cluster.h"
+#include "backends/QubitConfiguration.h"
+#include "backends/interfaces/IQubitId.h"
+#include "omnetpp/simtime.h"
+
+namespace quisp::backends::density_matrix {
+
+using abstract::EigenvalueResult;
+using abstract::IQubit;
+using abstract::IQubitId;
+using graph_state::Matrix6d;
+using graph_state::MemoryTransition;
+using graph_state::RowVector6d;
+using graph_state::types::MeasurementErrorModel;
+using graph_state::types::MemoryErrorModel;
+using graph_state::types::SingleGateErrorModel;
+using graph_state::types::TwoQubitGateErrorModel;
+using omnetpp::SimTime;
+
+class DensityMatrixBackend;
+
+/**
+ * @brief a qubit of the DensityMatrixBackend, a member of the DensityMatrixCluster it is entangled with.
+ *
+ * The error models are the same as GraphStateQubit's, but the gate and memory errors are applied as channels to the
+ * density matrix instead of sampled Paulis, only the measurements draw random numbers.
+ * Two qubit gates merge the clusters of both qubits, measurements and setFree split the qubit off again.
+ */
+class DensityMatrixQubit : public IQubit {
+ public:
+  DensityMatrixQubit(const IQubitId *id, DensityMatrixBackend *const backend, bool is_short_live);
+  ~DensityMatrixQubit();
+  void configure(std::unique_ptr<StationaryQubitConfiguration> configuration);
+  void setFree() override;
+  const IQubitId *const getId() const override;
+  void relaseBackToPool() override;
+  const DensityMatrixCluster &getCluster() const { return *cluster; }
+
+  void gateX() override;
+  void gateZ() override;
+  void gateY() override;
+  void gateH() override;
+  void gateS() override;
+  void gateSdg() override;
+  void gateCNOT(IQubit *const target_qubit) override;
+  EigenvalueResult measureX() override;
+  EigenvalueResult measureY() override;
+  EigenvalueResult measureZ() override;
+
+  // beyond the Clifford gates of IQubit, noiseless
+  void gateT();
+  void applyUnitary(const Matrix2cd &unitary);
+  // |1> decays to |0> with the probability gamma
+  void applyAmplitudeDamping(double gamma);
+
+  void noiselessH() override;
+  void noiselessX() override;
+  void noiselessZ() override;
+  void noiselessCNOT(IQubit *const target_qubit) override;
+  EigenvalueResult noiselessMeasureZ() override;
+  EigenvalueResult noiselessMeasureX() override;
+  EigenvalueResult noiselessMeasureZ(EigenvalueResult forced_result) override;
+  EigenvalueResult noiselessMeasureX(EigenvalueResult forced_result) override;
+
+  // brings the memory error up to the current time, for reading the state without an operation
+  void applyMemoryError();
+
+ protected:
+  // error simulation
+  void setMemoryErrorRates(double x_error_rate, double y_error_rate, double z_error_rate, double excitation_rate, double relaxation_rate);
+  void applySingleQubitGateError(SingleGateErrorModel const &err);
+  void applyTwoQubitGateError(TwoQubitGateErrorModel const &err, DensityMatrixQubit *another_qubit);
+  void apply(const Matrix2cd &op);
+  void applyCNOT(DensityMatrixQubit *target_qubit);
+  void mergeWith(DensityMatrixQubit *another_qubit);
+  // measures in the Z basis and moves this qubit to a new cluster in the measured state, forced_result is used when it is possible
+  EigenvalueResult clusterMeasureZ(const EigenvalueResult *forced_result = nullptr);
+  EigenvalueResult flipWithProbability(EigenvalueResult result, double probability);
+
+  SingleGateErrorModel gate_err_h;
+  SingleGateErrorModel gate_err_x;
+  SingleGateErrorModel gate_err_z;
+  TwoQubitGateErrorModel gate_err_cnot;
+  MeasurementErrorModel measurement_err;
+  MemoryErrorModel memory_err;
+  std::shared_ptr<const MemoryTransition> memory_transition;
+
+  std::shared_ptr<DensityMatrixCluster> cluster;
+  SimTime updated_time = SimTime(0);
+  const IQubitId *id;
+  DensityMatrixBackend *const backend;
+  const bool is_short_live;
+};
+
+}  // namespace quisp::backends::density_matrix
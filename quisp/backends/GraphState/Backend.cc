@@ -1,8 +1,13 @@
 #include "Backend.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
 #include "Qubit.h"
 #include "backends/interfaces/IConfiguration.h"
 #include "backends/interfaces/IQubit.h"
 #include "modules/QNIC/StationaryQubit/QubitId.h"
+#include "utils/MemoryUsage.h"
 
 using quisp::modules::qubit_id::QubitId;
 
@@ -17,27 +22,39 @@ GraphStateBackend::GraphStateBackend(std::unique_ptr<IRandomNumberGenerator> rng
 }
 GraphStateBackend::~GraphStateBackend() {
   for (auto& pair : qubits) {
-    delete pair.first;
+    delete qubit_arena.get(pair.second)->getId();
   }
 }
 
+void GraphStateBackend::setLocalComplementThreads(int num_threads, std::size_t min_degree) {
+  local_complement_pool = num_threads > 1 ? std::make_unique<utils::ThreadPool>(num_threads) : nullptr;
+  parallel_local_complement_degree = min_degree;
+}
+
 IQubit* GraphStateBackend::createShortLiveQubit() {
+  TraceScope trace(this, trace::TraceOp::CreateShortLiveQubit);
   auto* qubit_id = new QubitId(-1, -1, -1, ++short_live_qubit_pool_size);
-  auto original_qubit = std::make_unique<GraphStateQubit>(qubit_id, this, true);
-  auto conf = getDefaultConfiguration();
-  IConfiguration* raw_conf = conf.release();
-  StationaryQubitConfiguration* gss_conf = dynamic_cast<StationaryQubitConfiguration*>(raw_conf);
-  original_qubit->configure(std::unique_ptr<StationaryQubitConfiguration>(gss_conf));
-  auto* qubit_ptr = original_qubit.get();
-  qubits.insert({qubit_id, std::move(original_qubit)});
-  return qubit_ptr;
+  // flying photons don't sit in a memory, they share the gate and measurement errors of the default configuration without the memory error.
+  StationaryQubitConfiguration photon_conf = *config;
+  photon_conf.memory_x_err_rate = 0;
+  photon_conf.memory_y_err_rate = 0;
+  photon_conf.memory_z_err_rate = 0;
+  photon_conf.memory_excitation_rate = 0;
+  photon_conf.memory_relaxation_rate = 0;
+  photon_conf.memory_completely_mixed_rate = 0;
+  auto index = emplaceQubit(qubit_id, true, photon_conf);
+  auto* qubit = qubit_arena.get(index);
+  qubit->setErrorModels(*getErrorModels(photon_conf));
+  registerQubit(qubit_id, index);
+  trace.setQubit(qubit);
+  return qubit;
 }
 
 IQubit* GraphStateBackend::createQubit(const IQubitId* id, std::unique_ptr<IConfiguration> conf) {
-  if (qubits.find(id) != qubits.cend()) {
+  TraceScope trace(this, trace::TraceOp::CreateQubit);
+  if (qubits.find(id->getPackedKey()) != qubits.cend()) {
     throw std::runtime_error("GraphState::createQubit: trying to create qubit with already existed Id.");
   }
-  auto original_qubit = std::make_unique<GraphStateQubit>(id, this, false);
 
   IConfiguration* raw_conf = conf.release();
   StationaryQubitConfiguration* gss_conf = dynamic_cast<StationaryQubitConfiguration*>(raw_conf);
@@ -47,52 +64,329 @@ IQubit* GraphStateBackend::createQubit(const IQubitId* id, std::unique_ptr<IConf
     throw std::runtime_error("GraphState::getQubit: failed to cast. got invalid configuration.");
   }
 
-  original_qubit->configure(std::unique_ptr<StationaryQubitConfiguration>(gss_conf));
-  auto* qubit_ptr = original_qubit.get();
-  qubits.insert({id, std::move(original_qubit)});
-  return qubit_ptr;
+  auto index = emplaceQubit(id, false, *gss_conf);
+  auto* qubit = qubit_arena.get(index);
+  qubit->configure(std::unique_ptr<StationaryQubitConfiguration>(gss_conf));
+  registerQubit(id, index);
+  trace.setQubit(qubit);
+  return qubit;
 }
 IQubit* GraphStateBackend::createQubit(const IQubitId* id) { return createQubit(id, getDefaultConfiguration()); }
 
-IQubit* GraphStateBackend::getQubit(const IQubitId* id) {
-  auto qubit_iterator = qubits.find(id);
+std::size_t GraphStateBackend::emplaceQubit(const IQubitId* id, bool is_short_live, const StationaryQubitConfiguration& conf) {
+  // the error free qubit type is chosen once here, so the ideal runs don't check error rates on every gate.
+  if (conf.isNoiseless()) {
+    return qubit_arena.emplace<NoiselessGraphStateQubit>(id, this, is_short_live);
+  }
+  return qubit_arena.emplace(id, this, is_short_live);
+}
+
+std::size_t GraphStateBackend::registerQubit(const IQubitId* id, std::size_t index) {
+  qubits.insert({id->getPackedKey(), index});
+  id->setBackendIndex(index);
+  components.add(index);
+  return index;
+}
+
+GraphStateQubit* GraphStateBackend::findQubit(const IQubitId* id) const {
+  // the id passed to createQubit knows its index, other instances with the same value fall back to the packed key.
+  auto* qubit = qubit_arena.get(id->getBackendIndex());
+  if (qubit != nullptr && qubit->getId() == id) {
+    return qubit;
+  }
+  auto qubit_iterator = qubits.find(id->getPackedKey());
   if (qubit_iterator == qubits.cend()) {
+    return nullptr;
+  }
+  return qubit_arena.get(qubit_iterator->second);
+}
+
+IQubit* GraphStateBackend::getQubit(const IQubitId* id) {
+  auto* qubit = findQubit(id);
+  if (qubit == nullptr) {
     throw std::runtime_error("GraphState::getQubit: trying to get qubit with non existing Id.");
   }
-  return qubit_iterator->second.get();
+  return qubit;
 }
 
 IQubit* GraphStateBackend::getShortLiveQubit() {
+  TraceScope trace(this, trace::TraceOp::GetShortLiveQubit);
+  IQubit* qubit;
   if (short_live_qubit_pool.empty()) {
-    return createShortLiveQubit();
+    qubit = createShortLiveQubit();
+  } else {
+    qubit = short_live_qubit_pool.front();
+    short_live_qubit_pool.pop_front();
   }
-  auto* qubit = short_live_qubit_pool.front();
-  short_live_qubit_pool.pop_front();
+  trace.setQubit(qubit);
   return qubit;
 }
 
 void GraphStateBackend::returnToPool(IQubit* pool_qubit) {
+  TraceScope trace(this, trace::TraceOp::ReturnToPool, pool_qubit);
   pool_qubit->setFree();
   short_live_qubit_pool.emplace_back(pool_qubit);
 }
 
 void GraphStateBackend::deleteQubit(const IQubitId* id) {
-  auto qubit_iterator = qubits.find(id);
+  auto qubit_iterator = qubits.find(id->getPackedKey());
   if (qubit_iterator == qubits.cend()) {
     throw std::runtime_error("GraphState::getQubit: trying to delete qubit with non existing Id.");
   }
+  auto index = qubit_iterator->second;
+  TraceScope trace(this, trace::TraceOp::DeleteQubit, qubit_arena.get(index));
+  // the deleted qubit leaves the graph state, so no other qubit keeps an edge to it.
+  qubit_arena.get(index)->removeAllEdges();
+  refreshComponent(index, index);
+  qubit_arena.erase(index);
   qubits.erase(qubit_iterator);
 }
 
+GraphStateQubit* GraphStateBackend::toGraphStateQubit(IQubit* qubit) const {
+  auto* gs_qubit = dynamic_cast<GraphStateQubit*>(qubit);
+  if (gs_qubit == nullptr || qubit_arena.get(gs_qubit->getId()->getBackendIndex()) != gs_qubit) {
+    throw std::runtime_error("GraphState: the qubit does not belong to this backend.");
+  }
+  return gs_qubit;
+}
+
+void GraphStateBackend::joinComponents(GraphStateQubit* qubit, GraphStateQubit* another_qubit) {
+  components.join(qubit->getId()->getBackendIndex(), another_qubit->getId()->getBackendIndex());
+}
+
+void GraphStateBackend::splitComponent(GraphStateQubit* qubit) { components.split(qubit->getId()->getBackendIndex()); }
+
+namespace {
+constexpr char graph_state_magic[8] = {'Q', 'S', 'P', 'G', 'R', 'P', 'H', '1'};
+
+template <typename T>
+void writeValue(std::ostream& os, T value) {
+  os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+T readValue(std::istream& is) {
+  T value;
+  if (!is.read(reinterpret_cast<char*>(&value), sizeof(T))) throw std::runtime_error("truncated graph state snapshot");
+  return value;
+}
+}  // namespace
+
+void GraphStateBackend::saveGraphState(std::ostream& os) const {
+  os.write(graph_state_magic, sizeof(graph_state_magic));
+  writeValue<int64_t>(os, current_time.raw());
+  writeValue<uint64_t>(os, qubit_arena.numSlots());
+  writeValue<uint64_t>(os, qubit_arena.size());
+  for (std::size_t index = 0; index < qubit_arena.numSlots(); index++) {
+    auto* qubit = qubit_arena.get(index);
+    if (qubit == nullptr) continue;
+    writeValue<uint64_t>(os, index);
+    writeValue<uint8_t>(os, static_cast<uint8_t>(qubit->vertex_operator));
+    writeValue<int64_t>(os, qubit->updated_time.raw());
+    // each edge is written once, by its lower index end
+    std::vector<uint64_t> higher_neighbors;
+    for (auto* neighbor : qubit->neighbors) {
+      auto neighbor_index = neighbor->getId()->getBackendIndex();
+      if (neighbor_index > index) higher_neighbors.push_back(neighbor_index);
+    }
+    writeValue<uint32_t>(os, higher_neighbors.size());
+    for (auto neighbor_index : higher_neighbors) writeValue<uint64_t>(os, neighbor_index);
+  }
+}
+
+void GraphStateBackend::restoreGraphState(std::istream& is) {
+  char magic[sizeof(graph_state_magic)];
+  if (!is.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), graph_state_magic)) throw std::runtime_error("not a graph state snapshot");
+  auto saved_time = readValue<int64_t>(is);
+  auto num_slots = readValue<uint64_t>(is);
+  auto num_qubits = readValue<uint64_t>(is);
+  if (num_slots != qubit_arena.numSlots() || num_qubits != qubit_arena.size()) throw std::runtime_error("the graph state snapshot was saved with different qubits");
+
+  components.clear();
+  for (std::size_t index = 0; index < qubit_arena.numSlots(); index++) {
+    if (auto* qubit = qubit_arena.get(index); qubit != nullptr) {
+      qubit->neighbors.clear();
+      components.add(index);
+      touchEdges(qubit);
+    }
+  }
+  for (uint64_t i = 0; i < num_qubits; i++) {
+    auto* qubit = qubit_arena.get(readValue<uint64_t>(is));
+    if (qubit == nullptr) throw std::runtime_error("the graph state snapshot was saved with different qubits");
+    auto vertex_operator = readValue<uint8_t>(is);
+    if (vertex_operator >= 24) throw std::runtime_error("invalid vertex operator in the graph state snapshot");
+    qubit->vertex_operator = static_cast<types::CliffordOperator>(vertex_operator);
+    qubit->updated_time.setRaw(readValue<int64_t>(is));
+    auto degree = readValue<uint32_t>(is);
+    for (uint32_t j = 0; j < degree; j++) {
+      auto* neighbor = qubit_arena.get(readValue<uint64_t>(is));
+      if (neighbor == nullptr || neighbor == qubit) throw std::runtime_error("invalid edge in the graph state snapshot");
+      qubit->addEdge(neighbor);
+    }
+  }
+  current_time.setRaw(saved_time);
+}
+
+void GraphStateBackend::refreshComponent(std::size_t index, std::size_t removed) {
+  components.refresh(
+      index,
+      [this](std::size_t node, auto visit) {
+        for (auto* neighbor : qubit_arena.get(node)->neighbors) {
+          visit(neighbor->getId()->getBackendIndex());
+        }
+      },
+      removed);
+}
+
+double GraphStateBackend::getBellPairFidelity(IQubit* first, IQubit* second) { return toGraphStateQubit(first)->bellPairFidelity(toGraphStateQubit(second)); }
+
+std::size_t GraphStateBackend::getComponentSize(IQubit* qubit) {
+  auto index = toGraphStateQubit(qubit)->getId()->getBackendIndex();
+  refreshComponent(index);
+  return components.membersOf(index).size();
+}
+
+std::vector<IQubit*> GraphStateBackend::getComponentQubits(IQubit* qubit) {
+  auto index = toGraphStateQubit(qubit)->getId()->getBackendIndex();
+  refreshComponent(index);
+  std::vector<IQubit*> component_qubits;
+  for (auto member : components.membersOf(index)) {
+    component_qubits.push_back(qubit_arena.get(member));
+  }
+  return component_qubits;
+}
+
+void GraphStateBackend::refreshDirtyComponents() {
+  components.refreshDirty([this](std::size_t node, auto visit) {
+    for (auto* neighbor : qubit_arena.get(node)->neighbors) {
+      visit(neighbor->getId()->getBackendIndex());
+    }
+  });
+}
+
+std::vector<std::size_t> GraphStateBackend::getComponentSizeHistogram() {
+  refreshDirtyComponents();
+  return components.sizeHistogram();
+}
+
+void GraphStateBackend::setStatisticsSampler(std::ostream* os, SimTime interval, std::function<std::uint64_t(std::uint64_t)> endpoint_of) {
+  statistics_stream = os;
+  if (os == nullptr) {
+    statistics.reset();
+    return;
+  }
+  if (interval <= SimTime::ZERO) throw std::invalid_argument("GraphStateBackend::setStatisticsSampler: the interval must be positive");
+  statistics_interval = interval;
+  next_statistics_time = current_time;
+  statistics_endpoint_of = std::move(endpoint_of);
+  if (!statistics_endpoint_of) statistics_endpoint_of = [](std::uint64_t key) { return key; };
+  // the qubits so far, the later ones are touched by their edges
+  statistics = std::make_unique<GraphStateStatistics>();
+  for (std::size_t index = 0; index < qubit_arena.numSlots(); index++) {
+    if (qubit_arena.get(index) != nullptr) statistics->touch(index);
+  }
+  writeStatisticsHeader(*os);
+}
+
+void GraphStateBackend::writeStatistics() {
+  if (statistics_stream == nullptr) return;
+  refreshDirtyComponents();
+  auto key_of = [this](std::size_t index) { return qubit_arena.get(index)->getId()->getPackedKey(); };
+  statistics->update([this](std::size_t index) { return qubit_arena.get(index) == nullptr ? 0 : qubit_arena.get(index)->neighbors.size(); },
+                     [this](std::size_t index) { return (*qubit_arena.get(index)->neighbors.begin())->getId()->getBackendIndex(); },
+                     [&](std::size_t a, std::size_t b) {
+                       auto end_a = statistics_endpoint_of(key_of(a)), end_b = statistics_endpoint_of(key_of(b));
+                       return GraphStateStatistics::Link{std::min(end_a, end_b), std::max(end_a, end_b)};
+                     });
+  writeStatisticsSnapshot(*statistics_stream, current_time.raw(), *statistics, components.sizeHistogram());
+  // the next interval after the current time
+  next_statistics_time = statistics_interval * (std::floor(current_time / statistics_interval) + 1);
+}
+
+GraphStateBackend::MemoryUsage GraphStateBackend::getMemoryUsage() const {
+  MemoryUsage usage;
+  usage.num_qubits = qubit_arena.size();
+  usage.bytes = qubit_arena.allocatedBytes() + utils::heapBytesOf(qubits) + utils::heapBytesOf(short_live_qubit_pool);
+  std::size_t num_neighbors = 0;
+  for (std::size_t index = 0; index < qubit_arena.numSlots(); index++) {
+    auto* qubit = qubit_arena.get(index);
+    if (qubit == nullptr) continue;
+    num_neighbors += qubit->neighbors.size();
+    usage.bytes += qubit->neighbors.heapBytes();
+  }
+  // each edge is in the neighbors of both ends
+  usage.num_edges = num_neighbors / 2;
+  return usage;
+}
+
+void GraphStateBackend::reserveQubits(std::size_t num_qubits) {
+  qubit_arena.reserve(num_qubits);
+  qubits.reserve(num_qubits);
+}
+
+void GraphStateBackend::setMemoryResourceStrategy(utils::MemoryResourceStrategy strategy) {
+  if (qubit_arena.numSlots() > 0) throw std::runtime_error("GraphState::setMemoryResourceStrategy: the qubits are already created.");
+  neighbor_memory_resource = std::make_unique<utils::MemoryResource>(strategy, true);
+}
+
+void GraphStateBackend::reserveShortLiveQubits(std::size_t pool_size) {
+  // the arena grows once for the whole pool, so the photons created here sit next to each other
+  if (pool_size > short_live_qubit_pool.size()) qubit_arena.reserve(qubit_arena.numSlots() + pool_size - short_live_qubit_pool.size());
+  while (short_live_qubit_pool.size() < pool_size) {
+    short_live_qubit_pool.push_back(createShortLiveQubit());
+  }
+}
+
 std::unique_ptr<IConfiguration> GraphStateBackend::getDefaultConfiguration() const {
   // copy the default backend configuration for each qubit
   return std::make_unique<StationaryQubitConfiguration>(*config.get());
 }
 const SimTime& GraphStateBackend::getSimTime() {
-  if (callback != nullptr) callback->willUpdate(*this);
+  if (callback == nullptr) return current_time;
+  if (event_scoped_time) {
+    auto event = omnetpp::getSimulation()->getEventNumber();
+    if (event == updated_event) return current_time;
+    updated_event = event;
+  }
+  callback->willUpdate(*this);
   return current_time;
 }
-void GraphStateBackend::setSimTime(SimTime time) { current_time = time; }
-double GraphStateBackend::dblrand() { return rng->doubleRandom(); }
+void GraphStateBackend::setSimTime(SimTime time) {
+  current_time = time;
+  if (statistics_stream != nullptr && current_time >= next_statistics_time) writeStatistics();
+}
+double GraphStateBackend::dblrand() {
+  rng_draws++;
+  return rng->doubleRandom();
+}
+
+std::shared_ptr<const MemoryTransition> GraphStateBackend::getMemoryTransition(const Matrix6d& transition_matrix) { return memory_transitions.get(transition_matrix); }
+
+std::shared_ptr<const GraphStateErrorModels> GraphStateBackend::getErrorModels(const StationaryQubitConfiguration& c) {
+  auto& models = error_models[c.key()];
+  if (models != nullptr) return models;
+
+  auto m = std::make_shared<GraphStateErrorModels>();
+  m->measurement_err.setParams(c.measurement_x_err_rate, c.measurement_y_err_rate, c.measurement_z_err_rate);
+  m->gate_err_h.setParams(c.h_gate_x_err_ratio, c.h_gate_y_err_ratio, c.h_gate_z_err_ratio, c.h_gate_err_rate);
+  m->gate_err_x.setParams(c.x_gate_x_err_ratio, c.x_gate_y_err_ratio, c.x_gate_z_err_ratio, c.x_gate_err_rate);
+  m->gate_err_z.setParams(c.z_gate_x_err_ratio, c.z_gate_y_err_ratio, c.z_gate_z_err_ratio, c.z_gate_err_rate);
+  m->gate_err_cnot.setParams(c.cnot_gate_err_rate, c.cnot_gate_ix_err_ratio, c.cnot_gate_iy_err_ratio, c.cnot_gate_iz_err_ratio, c.cnot_gate_xi_err_ratio,
+                             c.cnot_gate_xx_err_ratio, c.cnot_gate_xy_err_ratio, c.cnot_gate_xz_err_ratio, c.cnot_gate_yi_err_ratio, c.cnot_gate_yx_err_ratio,
+                             c.cnot_gate_yy_err_ratio, c.cnot_gate_yz_err_ratio, c.cnot_gate_zi_err_ratio, c.cnot_gate_zx_err_ratio, c.cnot_gate_zy_err_ratio,
+                             c.cnot_gate_zz_err_ratio);
+  auto& memory_err = m->memory_err;
+  memory_err.x_error_rate = c.memory_x_err_rate;
+  memory_err.y_error_rate = c.memory_y_err_rate;
+  memory_err.z_error_rate = c.memory_z_err_rate;
+  memory_err.excitation_error_rate = c.memory_excitation_rate;
+  memory_err.relaxation_error_rate = c.memory_relaxation_rate;
+  memory_err.error_rate = c.memory_x_err_rate + c.memory_y_err_rate + c.memory_z_err_rate + c.memory_excitation_rate + c.memory_relaxation_rate;  // This is per μs.
+  m->memory_transition_matrix =
+      MemoryTransition::transitionMatrix(c.memory_x_err_rate, c.memory_y_err_rate, c.memory_z_err_rate, c.memory_excitation_rate, c.memory_relaxation_rate);
+  m->memory_transition = getMemoryTransition(m->memory_transition_matrix);
+  models = m;
+  return models;
+}
 
 }  // namespace quisp::backends::graph_state
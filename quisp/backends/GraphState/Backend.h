@@ -1,15 +1,28 @@
 #pragma once
 #include <omnetpp.h>
+#include <cstdint>
 #include <deque>
+#include <functional>
+#include <istream>
+#include <map>
 #include <memory>
+#include <ostream>
 #include <unordered_map>
+#include <vector>
 #include "../interfaces/IConfiguration.h"
 #include "../interfaces/IQuantumBackend.h"
+#include "../Trace/OperationTrace.h"
 #include "../interfaces/IQubit.h"
 #include "../interfaces/IRandomNumberGenerator.h"
+#include "EntanglementComponents.h"
+#include "GraphStateStatistics.h"
+#include "MemoryTransition.h"
 #include "Qubit.h"
+#include "QubitArena.h"
 #include "backends/QubitConfiguration.h"
 #include "backends/interfaces/IQubitId.h"
+#include "utils/MemoryResource.h"
+#include "utils/ThreadPool.h"
 
 namespace quisp::backends::graph_state {
 using abstract::IConfiguration;
@@ -32,6 +45,7 @@ class GraphStateBackend : public IQuantumBackend {
   ~GraphStateBackend();
   IQubit* createQubit(const IQubitId* id, std::unique_ptr<IConfiguration> conf) override;
   IQubit* createQubit(const IQubitId* id) override;
+  // a photon with the gate and measurement errors of the default configuration but no memory error, configured once for all its uses from the pool
   IQubit* createShortLiveQubit() override;
   IQubit* getQubit(const IQubitId* id) override;
   IQubit* getShortLiveQubit() override;
@@ -40,15 +54,185 @@ class GraphStateBackend : public IQuantumBackend {
   std::unique_ptr<IConfiguration> getDefaultConfiguration() const override;
   const SimTime& getSimTime() override;
   void setSimTime(SimTime time) override;
+  double getBellPairFidelity(IQubit* first, IQubit* second) override;
   double dblrand();
 
+  /**
+   * @brief preallocate the storage for the given number of qubits, so that creating them does not reallocate.
+   */
+  void reserveQubits(std::size_t num_qubits);
+
+  /**
+   * @brief fill the short live qubit pool up to the given size, instead of creating photons on the first emissions.
+   */
+  void reserveShortLiveQubits(std::size_t pool_size);
+
+  /**
+   * @brief returns the precomputed memory transition for the given matrix.
+   * qubits configured with the same memory error rates share the same instance.
+   */
+  std::shared_ptr<const MemoryTransition> getMemoryTransition(const Matrix6d& transition_matrix);
+
+  /**
+   * @brief returns the error models of the configuration, built at the first call for it.
+   * qubits configured with the same parameters share the same instance.
+   */
+  std::shared_ptr<const GraphStateErrorModels> getErrorModels(const StationaryQubitConfiguration& conf);
+
+  /**
+   * @brief connected components of the graph state, i.e. the groups of qubits that are entangled with each other.
+   * Components that lost an edge, e.g. by a measurement, are rebuilt lazily by these queries.
+   */
+  std::size_t getComponentSize(IQubit* qubit);
+  std::vector<IQubit*> getComponentQubits(IQubit* qubit);
+  // histogram[k] is the number of components with k qubits
+  std::vector<std::size_t> getComponentSizeHistogram();
+
+  struct MemoryUsage {
+    std::size_t num_qubits = 0;
+    std::size_t num_edges = 0;
+    std::size_t bytes = 0;
+  };
+  // the live qubits, the edges of the graph state, and the approximate heap bytes of the qubits, their neighbors and the id index
+  MemoryUsage getMemoryUsage() const;
+
+  /**
+   * @brief local complementations of the vertices with at least min_degree neighbors run on num_threads threads (including the caller).
+   * num_threads <= 1 keeps all of them on the simulation thread. The resulting graph is the same either way.
+   */
+  void setLocalComplementThreads(int num_threads, std::size_t min_degree);
+  // the pool for the local complementation of a vertex with the degree, or nullptr to run it serially
+  utils::ThreadPool* getLocalComplementPool(std::size_t degree) const {
+    return degree >= parallel_local_complement_degree ? local_complement_pool.get() : nullptr;
+  }
+
+  /**
+   * @brief writes the graph state, i.e. the vertex operators, the edges and the last update times of the qubits, and the current time.
+   * The qubits are identified by their backend index, so restoreGraphState needs a backend with the qubits created in the same order,
+   * e.g. another run of the same network right after its initialization.
+   */
+  void saveGraphState(std::ostream& os) const;
+  // replaces the graph state with the one saved by saveGraphState. throws std::runtime_error if the qubits don't match.
+  void restoreGraphState(std::istream& is);
+
+  /**
+   * @brief single qubit gates leave the memory error of depolarizing qubits to the next measurement or two qubit gate.
+   * The sampled errors have the same distribution, but the random numbers are drawn differently than the eager default.
+   */
+  void setLazyMemoryError(bool lazy) { lazy_memory_error = lazy; }
+  bool isLazyMemoryError() const { return lazy_memory_error; }
+
+  /**
+   * @brief the neighbors of the qubits beyond their inline ones take their memory from a resource of this backend, see utils/MemoryResource.h.
+   * Set it before creating any qubit. The resource is synchronized for the parallel local complementations.
+   */
+  void setMemoryResourceStrategy(utils::MemoryResourceStrategy strategy);
+  std::pmr::memory_resource* getNeighborMemoryResource() const { return neighbor_memory_resource->get(); }
+
+  /**
+   * @brief getSimTime() asks the callback for the time only once per event of the running simulation, the time doesn't move within an event.
+   * Only for the callback updating the time from the OMNeT++ simulation, while it executes the events.
+   */
+  void setEventScopedTime(bool enabled) {
+    event_scoped_time = enabled;
+    updated_event = -1;
+  }
+
+  /**
+   * @brief records the operations on the backend and its qubits, see trace::replay to run them on any backend.
+   * nullptr stops the recording. The writer must outlive the recording.
+   */
+  void setTraceWriter(trace::TraceWriter* writer) { trace_writer = writer; }
+
+  /**
+   * @brief records an operation when the recording is on, when it goes out of scope.
+   * The operations the recorded one calls, e.g. noiselessH in gateCNOT, are a part of it and not recorded by themselves.
+   */
+  class TraceScope {
+   public:
+    TraceScope(GraphStateBackend* backend, trace::TraceOp op, const IQubit* qubit = nullptr, const IQubit* other = nullptr, std::uint8_t arg = 0)
+        : backend(backend->trace_writer == nullptr ? nullptr : backend) {
+      if (this->backend == nullptr || backend->trace_depth++ > 0) return;
+      record.op = op;
+      record.arg = arg;
+      if (qubit != nullptr) setQubit(qubit);
+      if (other != nullptr) record.other = other->getId()->getPackedKey();
+      record.time = backend->current_time.raw();
+      rng_draws_before = backend->rng_draws;
+    }
+    ~TraceScope() {
+      if (backend == nullptr || --backend->trace_depth > 0) return;
+      record.rng_draws = static_cast<std::uint16_t>(backend->rng_draws - rng_draws_before);
+      backend->trace_writer->write(record);
+    }
+    // for the operations that get their qubit on the way, e.g. getShortLiveQubit
+    void setQubit(const IQubit* qubit) { record.qubit = qubit->getId()->getPackedKey(); }
+
+   private:
+    GraphStateBackend* const backend;
+    trace::TraceRecord record;
+    std::uint64_t rng_draws_before = 0;
+  };
+
+  /**
+   * @brief writes the degree and the component size histograms and the Bell pairs by link every interval of the simulation time, see StatisticsSnapshot.
+   * The snapshot of an interval is taken at the first time update of the backend in it, and costs O(changes) since the last one.
+   * endpoint_of maps the packed key of a qubit to the end of its link, e.g. its node and qnic. nullptr stops the sampling.
+   * The stream must outlive the sampling.
+   */
+  void setStatisticsSampler(std::ostream* os, SimTime interval, std::function<std::uint64_t(std::uint64_t)> endpoint_of);
+  // writes the snapshot of the current time to the sampler's stream
+  void writeStatistics();
+
+  // called by GraphStateQubit when it adds or removes edges
+  void joinComponents(GraphStateQubit* qubit, GraphStateQubit* another_qubit);
+  void splitComponent(GraphStateQubit* qubit);
+  // called by GraphStateQubit when its neighbors changed
+  void touchEdges(GraphStateQubit* qubit) {
+    if (statistics != nullptr) statistics->touch(qubit->getId()->getBackendIndex());
+  }
+
  protected:
-  std::unordered_map<const IQubitId*, std::unique_ptr<GraphStateQubit>, IQubitId::Hash, IQubitId::Pred> qubits;
+  std::size_t emplaceQubit(const IQubitId* id, bool is_short_live, const StationaryQubitConfiguration& conf);
+  std::size_t registerQubit(const IQubitId* id, std::size_t index);
+  GraphStateQubit* findQubit(const IQubitId* id) const;
+  GraphStateQubit* toGraphStateQubit(IQubit* qubit) const;
+  void refreshComponent(std::size_t index, std::size_t removed = EntanglementComponents::none);
+  void refreshDirtyComponents();
+
+  // the neighbors of the qubits live here, so it's declared before the qubits to outlive them
+  std::unique_ptr<utils::MemoryResource> neighbor_memory_resource = std::make_unique<utils::MemoryResource>();
+  // qubits live in qubit_arena, qubits maps the packed keys of their ids to the arena index.
+  QubitArena<GraphStateQubit> qubit_arena;
+  std::unordered_map<std::uint64_t, std::size_t> qubits;
+  // over the arena indices
+  EntanglementComponents components;
   SimTime current_time;
   const std::unique_ptr<IRandomNumberGenerator> rng;
   std::unique_ptr<StationaryQubitConfiguration> config;
   ICallback* callback = nullptr;
   std::deque<IQubit*> short_live_qubit_pool;
+  MemoryTransitionCache memory_transitions;
+  // the error models of each distinct qubit configuration
+  std::map<StationaryQubitConfiguration::Key, std::shared_ptr<const GraphStateErrorModels>> error_models;
+  // nullptr unless setLocalComplementThreads asked for more than one thread
+  std::unique_ptr<utils::ThreadPool> local_complement_pool;
+  std::size_t parallel_local_complement_degree = 0;
+  bool lazy_memory_error = false;
+  bool event_scoped_time = false;
+  // the event of the last update by the callback with event_scoped_time
+  omnetpp::eventnumber_t updated_event = -1;
+  trace::TraceWriter* trace_writer = nullptr;
+  // the nesting of the TraceScopes, only the outermost one is recorded
+  int trace_depth = 0;
+  // counted by dblrand for the trace
+  std::uint64_t rng_draws = 0;
+  // nullptr unless setStatisticsSampler started the sampling
+  std::unique_ptr<GraphStateStatistics> statistics;
+  std::ostream* statistics_stream = nullptr;
+  SimTime statistics_interval;
+  SimTime next_statistics_time;
+  std::function<std::uint64_t(std::uint64_t)> statistics_endpoint_of;
   int short_live_qubit_pool_size;  // this is used to generate qubit id for short live qubits in a pool; currenlty only photons.
 };
 }  // namespace quisp::backends::graph_state
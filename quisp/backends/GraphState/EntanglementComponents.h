@@ -0,0 +1,166 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace quisp::backends::graph_state {
+
+/**
+ * @brief connected components of the graph state, over dense node indices.
+ *
+ * Adding an edge joins two components with union-find (union by size, path halving) and merges their member lists.
+ * Removing an edge may split a component, which union-find can't express, so the component is only marked dirty
+ * and refresh() rebuilds it from its members with a BFS over the actual edges the next time it's queried.
+ * Components that never lose an edge are never rebuilt.
+ * The histogram of the component sizes follows the joins and the rebuilds, and refreshDirty() rebuilds only the dirty components for it.
+ *
+ * Edges must only be added through join(), so all the neighbors of a node are members of its component.
+ */
+class EntanglementComponents {
+ public:
+  static constexpr std::size_t none = std::numeric_limits<std::size_t>::max();
+
+  // the node becomes a component on its own
+  void add(std::size_t node) {
+    if (node >= parent.size()) {
+      parent.resize(node + 1, none);
+      members.resize(node + 1);
+      dirty.resize(node + 1, false);
+    }
+    parent[node] = node;
+    members[node] = {node};
+    dirty[node] = false;
+    countSize(1, 1);
+  }
+
+  // forgets all the nodes
+  void clear() { *this = EntanglementComponents(); }
+
+  bool contains(std::size_t node) const { return node < parent.size() && parent[node] != none; }
+
+  std::size_t find(std::size_t node) {
+    while (parent[node] != node) {
+      parent[node] = parent[parent[node]];
+      node = parent[node];
+    }
+    return node;
+  }
+
+  // an edge between a and b was added
+  void join(std::size_t a, std::size_t b) {
+    a = find(a);
+    b = find(b);
+    if (a == b) return;
+    if (members[a].size() < members[b].size()) std::swap(a, b);
+    countSize(members[a].size(), -1);
+    countSize(members[b].size(), -1);
+    countSize(members[a].size() + members[b].size(), 1);
+    parent[b] = a;
+    members[a].insert(members[a].end(), members[b].begin(), members[b].end());
+    members[b].clear();
+    members[b].shrink_to_fit();
+    dirty[a] = dirty[a] || dirty[b];
+    dirty[b] = false;
+  }
+
+  // an edge of the node was removed, its component may have split
+  void split(std::size_t node) {
+    auto root = find(node);
+    if (dirty[root]) return;
+    dirty[root] = true;
+    // the components cleaned by the queries since stay in the list, which is pruned once it outgrows the nodes
+    if (dirty_roots.size() >= parent.size()) pruneDirtyRoots();
+    dirty_roots.push_back(root);
+  }
+
+  /**
+   * @brief the node's component is rebuilt if it's dirty.
+   * @param for_each_neighbor calls its second argument with each neighbor index of the node given as its first argument.
+   * @param removed a member to drop from the component, e.g. a deleted qubit. It must not have edges anymore.
+   */
+  template <typename ForEachNeighbor>
+  void refresh(std::size_t node, ForEachNeighbor for_each_neighbor, std::size_t removed = none) {
+    auto root = find(node);
+    if (!dirty[root] && removed == none) return;
+    auto old_members = std::move(members[root]);
+    members[root].clear();
+    dirty[root] = false;
+    countSize(old_members.size(), -1);
+    for (auto member : old_members) parent[member] = none;
+    std::vector<std::size_t> queue;
+    for (auto start : old_members) {
+      if (start == removed || parent[start] != none) continue;
+      parent[start] = start;
+      auto& component = members[start];
+      component.push_back(start);
+      queue.assign(1, start);
+      while (!queue.empty()) {
+        auto current = queue.back();
+        queue.pop_back();
+        for_each_neighbor(current, [&](std::size_t neighbor) {
+          if (parent[neighbor] != none) return;
+          parent[neighbor] = start;
+          component.push_back(neighbor);
+          queue.push_back(neighbor);
+        });
+      }
+      countSize(component.size(), 1);
+    }
+  }
+
+  // rebuilds the components that lost an edge, so that the size histogram is exact
+  template <typename ForEachNeighbor>
+  void refreshDirty(ForEachNeighbor for_each_neighbor) {
+    auto roots = std::move(dirty_roots);
+    dirty_roots.clear();
+    for (auto root : roots) {
+      if (contains(root)) refresh(root, for_each_neighbor);
+    }
+  }
+
+  // histogram[k] is the number of components with k nodes, exact after refreshDirty()
+  const std::vector<std::size_t>& sizeHistogram() const { return size_histogram; }
+
+  // members of the node's component, call refresh() before to get the exact component
+  const std::vector<std::size_t>& membersOf(std::size_t node) { return members[find(node)]; }
+
+  // roots of all the components
+  template <typename F>
+  void forEachRoot(F f) const {
+    for (std::size_t node = 0; node < parent.size(); node++) {
+      if (parent[node] == node) f(node);
+    }
+  }
+
+  bool isDirty(std::size_t node) { return dirty[find(node)]; }
+
+ private:
+  void countSize(std::size_t size, int delta) {
+    if (size_histogram.size() <= size) size_histogram.resize(size + 1, 0);
+    size_histogram[size] += delta;
+    while (!size_histogram.empty() && size_histogram.back() == 0) size_histogram.pop_back();
+  }
+
+  void pruneDirtyRoots() {
+    std::vector<std::size_t> roots;
+    for (auto node : dirty_roots) {
+      if (!contains(node)) continue;
+      auto root = find(node);
+      if (dirty[root]) roots.push_back(root);
+    }
+    std::sort(roots.begin(), roots.end());
+    roots.erase(std::unique(roots.begin(), roots.end()), roots.end());
+    dirty_roots = std::move(roots);
+  }
+
+  std::vector<std::size_t> parent;
+  std::vector<std::vector<std::size_t>> members;
+  std::vector<bool> dirty;
+  // a node of each dirty component, and of some cleaned ones
+  std::vector<std::size_t> dirty_roots;
+  std::vector<std::size_t> size_histogram;
+};
+
+}  // namespace quisp::backends::graph_state
@@ -0,0 +1,118 @@
+#include "EntanglementComponents.h"
+#include <gtest/gtest.h>
+#include <set>
+#include <utility>
+
+namespace {
+using quisp::backends::graph_state::EntanglementComponents;
+
+class EntanglementComponentsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    for (std::size_t i = 0; i < 6; i++) components.add(i);
+  }
+  void addEdge(std::size_t a, std::size_t b) {
+    edges.insert({std::min(a, b), std::max(a, b)});
+    components.join(a, b);
+  }
+  void deleteEdge(std::size_t a, std::size_t b) {
+    edges.erase({std::min(a, b), std::max(a, b)});
+    components.split(a);
+  }
+  void refresh(std::size_t node, std::size_t removed = EntanglementComponents::none) {
+    components.refresh(
+        node,
+        [this](std::size_t n, auto visit) {
+          for (auto& [a, b] : edges) {
+            if (a == n) visit(b);
+            if (b == n) visit(a);
+          }
+        },
+        removed);
+  }
+  void refreshDirty() {
+    components.refreshDirty([this](std::size_t n, auto visit) {
+      for (auto& [a, b] : edges) {
+        if (a == n) visit(b);
+        if (b == n) visit(a);
+      }
+    });
+  }
+  std::set<std::pair<std::size_t, std::size_t>> edges;
+  EntanglementComponents components;
+};
+
+TEST_F(EntanglementComponentsTest, joinComponents) {
+  EXPECT_NE(components.find(0), components.find(1));
+  addEdge(0, 1);
+  addEdge(2, 3);
+  EXPECT_EQ(components.find(0), components.find(1));
+  EXPECT_NE(components.find(1), components.find(2));
+  addEdge(1, 2);
+  EXPECT_EQ(components.find(0), components.find(3));
+  EXPECT_EQ(components.membersOf(3).size(), 4);
+  EXPECT_FALSE(components.isDirty(0));
+
+  int num_roots = 0;
+  components.forEachRoot([&](std::size_t) { num_roots++; });
+  EXPECT_EQ(num_roots, 3);
+}
+
+TEST_F(EntanglementComponentsTest, splitIsRebuiltOnRefresh) {
+  addEdge(0, 1);
+  addEdge(1, 2);
+  addEdge(2, 3);
+  deleteEdge(1, 2);
+  EXPECT_TRUE(components.isDirty(3));
+  // still the stale component until it is refreshed
+  EXPECT_EQ(components.membersOf(0).size(), 4);
+  refresh(3);
+  EXPECT_FALSE(components.isDirty(0));
+  EXPECT_EQ(components.find(0), components.find(1));
+  EXPECT_EQ(components.find(2), components.find(3));
+  EXPECT_NE(components.find(0), components.find(2));
+  EXPECT_EQ(components.membersOf(0).size(), 2);
+  EXPECT_EQ(components.membersOf(2).size(), 2);
+}
+
+TEST_F(EntanglementComponentsTest, refreshWithRemovedNode) {
+  addEdge(0, 1);
+  addEdge(1, 2);
+  deleteEdge(0, 1);
+  deleteEdge(1, 2);
+  refresh(1, 1);
+  EXPECT_FALSE(components.contains(1));
+  EXPECT_TRUE(components.contains(0));
+  EXPECT_EQ(components.membersOf(0).size(), 1);
+  EXPECT_EQ(components.membersOf(2).size(), 1);
+
+  // the index can be reused
+  components.add(1);
+  addEdge(1, 5);
+  EXPECT_EQ(components.membersOf(5).size(), 2);
+}
+
+TEST_F(EntanglementComponentsTest, sizeHistogram) {
+  using Histogram = std::vector<std::size_t>;
+  EXPECT_EQ(components.sizeHistogram(), (Histogram{0, 6}));
+  addEdge(0, 1);
+  addEdge(1, 2);
+  addEdge(3, 4);
+  EXPECT_EQ(components.sizeHistogram(), (Histogram{0, 1, 1, 1}));
+  deleteEdge(1, 2);
+  // the stale component until the dirty ones are rebuilt
+  EXPECT_EQ(components.sizeHistogram(), (Histogram{0, 1, 1, 1}));
+  refreshDirty();
+  EXPECT_EQ(components.sizeHistogram(), (Histogram{0, 2, 2}));
+  EXPECT_FALSE(components.isDirty(0));
+
+  deleteEdge(0, 1);
+  refresh(0, 0);
+  refreshDirty();
+  EXPECT_EQ(components.sizeHistogram(), (Histogram{0, 3, 1}));
+  components.clear();
+  EXPECT_TRUE(components.sizeHistogram().empty());
+  EXPECT_FALSE(components.contains(3));
+}
+
+}  // namespace
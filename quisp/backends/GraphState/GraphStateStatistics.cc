@@ -0,0 +1,83 @@
+#include "GraphStateStatistics.h"
+#include <omnetpp.h>
+#include <algorithm>
+#include <stdexcept>
+
+namespace quisp::backends::graph_state {
+using omnetpp::SimTime;
+
+namespace {
+constexpr char statistics_magic[8] = {'Q', 'S', 'P', 'G', 'S', 'T', 'A', '1'};
+
+template <typename T>
+void writeValue(std::ostream& os, T value) {
+  os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+T readValue(std::istream& is) {
+  T value;
+  if (!is.read(reinterpret_cast<char*>(&value), sizeof(T))) throw std::runtime_error("truncated graph state statistics");
+  return value;
+}
+
+// the non-zero entries of a histogram
+void writeHistogram(std::ostream& os, const std::vector<std::size_t>& histogram) {
+  writeValue<std::uint32_t>(os, std::count_if(histogram.begin(), histogram.end(), [](std::size_t count) { return count != 0; }));
+  for (std::size_t value = 0; value < histogram.size(); value++) {
+    if (histogram[value] == 0) continue;
+    writeValue<std::uint32_t>(os, value);
+    writeValue<std::uint64_t>(os, histogram[value]);
+  }
+}
+
+std::vector<std::pair<std::uint32_t, std::uint64_t>> readHistogram(std::istream& is) {
+  std::vector<std::pair<std::uint32_t, std::uint64_t>> entries(readValue<std::uint32_t>(is));
+  for (auto& [value, count] : entries) {
+    value = readValue<std::uint32_t>(is);
+    count = readValue<std::uint64_t>(is);
+  }
+  return entries;
+}
+}  // namespace
+
+void writeStatisticsHeader(std::ostream& os) {
+  os.write(statistics_magic, sizeof(statistics_magic));
+  writeValue<std::int32_t>(os, SimTime::getScaleExp());
+}
+
+void writeStatisticsSnapshot(std::ostream& os, std::int64_t time, const GraphStateStatistics& statistics, const std::vector<std::size_t>& component_size_histogram) {
+  writeValue(os, time);
+  writeHistogram(os, statistics.degreeHistogram());
+  writeHistogram(os, component_size_histogram);
+  writeValue<std::uint32_t>(os, statistics.bellPairsByLink().size());
+  for (auto& [link, pairs] : statistics.bellPairsByLink()) {
+    writeValue(os, link.first);
+    writeValue(os, link.second);
+    writeValue<std::uint64_t>(os, pairs);
+  }
+}
+
+std::vector<StatisticsSnapshot> readStatistics(std::istream& is) {
+  char magic[sizeof(statistics_magic)];
+  if (!is.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), statistics_magic)) throw std::runtime_error("not graph state statistics");
+  if (readValue<std::int32_t>(is) != SimTime::getScaleExp()) throw std::runtime_error("the graph state statistics were written with another SimTime scale");
+
+  std::vector<StatisticsSnapshot> snapshots;
+  std::int64_t time;
+  while (is.read(reinterpret_cast<char*>(&time), sizeof(time))) {
+    auto& snapshot = snapshots.emplace_back();
+    snapshot.time = time;
+    snapshot.degrees = readHistogram(is);
+    snapshot.component_sizes = readHistogram(is);
+    snapshot.bell_pairs.resize(readValue<std::uint32_t>(is));
+    for (auto& [link, pairs] : snapshot.bell_pairs) {
+      link.first = readValue<std::uint64_t>(is);
+      link.second = readValue<std::uint64_t>(is);
+      pairs = readValue<std::uint64_t>(is);
+    }
+  }
+  return snapshots;
+}
+
+}  // namespace quisp::backends::graph_state
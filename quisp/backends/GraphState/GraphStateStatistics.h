@@ -0,0 +1,119 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <map>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace quisp::backends::graph_state {
+
+/**
+ * @brief the degree histogram and the Bell pairs by link of the graph state, over dense node indices.
+ *
+ * The backend touches a node whenever its neighbors change, and update() reads the degrees of the touched nodes only,
+ * so an update costs O(changes) rather than O(nodes). A Bell pair is an edge between two nodes of degree 1,
+ * i.e. a component of two nodes, and it's counted by the link of its two ends.
+ */
+class GraphStateStatistics {
+ public:
+  static constexpr std::size_t none = std::numeric_limits<std::size_t>::max();
+  // the ends of a link, the lower one first
+  using Link = std::pair<std::uint64_t, std::uint64_t>;
+
+  void touch(std::size_t node) {
+    if (node >= degrees.size()) {
+      degrees.resize(node + 1, 0);
+      partners.resize(node + 1, none);
+      pair_links.resize(node + 1);
+      is_touched.resize(node + 1, false);
+    }
+    if (is_touched[node]) return;
+    is_touched[node] = true;
+    touched.push_back(node);
+  }
+
+  /**
+   * @brief brings the statistics up to date with the touched nodes.
+   * @param degree_of the number of neighbors of a node, 0 for a deleted one
+   * @param sole_neighbor_of the neighbor of a node of degree 1
+   * @param link_of the link of the two ends of a Bell pair
+   */
+  template <typename DegreeOf, typename SoleNeighborOf, typename LinkOf>
+  void update(DegreeOf degree_of, SoleNeighborOf sole_neighbor_of, LinkOf link_of) {
+    // the pairs of the touched nodes may have formed or broken, and so may the pairs of their old partners and their current neighbors
+    std::vector<std::size_t> affected;
+    for (auto node : touched) {
+      is_touched[node] = false;
+      affected.push_back(node);
+      if (partners[node] != none) affected.push_back(partners[node]);
+      auto degree = static_cast<std::uint32_t>(degree_of(node));
+      if (degree == 1) affected.push_back(sole_neighbor_of(node));
+      countDegree(degrees[node], -1);
+      countDegree(degree, 1);
+      degrees[node] = degree;
+    }
+    touched.clear();
+    for (auto node : affected) {
+      if (partners[node] == none) continue;
+      if (--bell_pairs[pair_links[node]] == 0) bell_pairs.erase(pair_links[node]);
+      partners[partners[node]] = none;
+      partners[node] = none;
+    }
+    for (auto node : affected) {
+      if (partners[node] != none || degrees[node] != 1) continue;
+      auto neighbor = sole_neighbor_of(node);
+      if (degrees[neighbor] != 1) continue;
+      auto link = link_of(node, neighbor);
+      bell_pairs[link]++;
+      partners[node] = neighbor;
+      partners[neighbor] = node;
+      pair_links[node] = pair_links[neighbor] = link;
+    }
+  }
+
+  // histogram[d] is the number of nodes with d neighbors, from d = 1
+  const std::vector<std::size_t>& degreeHistogram() const { return degree_histogram; }
+  const std::map<Link, std::size_t>& bellPairsByLink() const { return bell_pairs; }
+
+ private:
+  void countDegree(std::uint32_t degree, int delta) {
+    if (degree == 0) return;
+    if (degree_histogram.size() <= degree) degree_histogram.resize(degree + 1, 0);
+    degree_histogram[degree] += delta;
+    while (!degree_histogram.empty() && degree_histogram.back() == 0) degree_histogram.pop_back();
+  }
+
+  // the degrees and the Bell pairs of the nodes at the last update
+  std::vector<std::uint32_t> degrees;
+  std::vector<std::size_t> partners;
+  std::vector<Link> pair_links;
+  std::vector<bool> is_touched;
+  std::vector<std::size_t> touched;
+  std::vector<std::size_t> degree_histogram;
+  std::map<Link, std::size_t> bell_pairs;
+};
+
+/**
+ * @brief a snapshot of the statistics of the graph state in the statistics file of GraphStateBackend::setStatisticsSampler.
+ *
+ * The file starts with an 8 byte tag and the SimTime scale exponent (int32), and the snapshots follow in the byte order of the host:
+ * the time (int64 raw SimTime), then the non-zero entries of the degree and the component size histograms,
+ * each as a uint32 count of entries followed by (uint32 degree or size, uint64 count), and the Bell pairs by link,
+ * a uint32 count followed by (uint64 end, uint64 end, uint64 pairs).
+ */
+struct StatisticsSnapshot {
+  std::int64_t time = 0;
+  std::vector<std::pair<std::uint32_t, std::uint64_t>> degrees;
+  std::vector<std::pair<std::uint32_t, std::uint64_t>> component_sizes;
+  std::vector<std::pair<GraphStateStatistics::Link, std::uint64_t>> bell_pairs;
+};
+
+void writeStatisticsHeader(std::ostream& os);
+void writeStatisticsSnapshot(std::ostream& os, std::int64_t time, const GraphStateStatistics& statistics, const std::vector<std::size_t>& component_size_histogram);
+// reads a whole statistics file. throws std::runtime_error if it's not one or its SimTime scale differs from the current one.
+std::vector<StatisticsSnapshot> readStatistics(std::istream& is);
+
+}  // namespace quisp::backends::graph_state
@@ -0,0 +1,84 @@
+#include "GraphStateStatistics.h"
+#include <gtest/gtest.h>
+#include <set>
+#include <utility>
+
+namespace {
+using quisp::backends::graph_state::GraphStateStatistics;
+using Histogram = std::vector<std::size_t>;
+using Pairs = std::map<GraphStateStatistics::Link, std::size_t>;
+
+class GraphStateStatisticsTest : public ::testing::Test {
+ protected:
+  void toggleEdge(std::size_t a, std::size_t b) {
+    auto edge = std::make_pair(std::min(a, b), std::max(a, b));
+    if (!edges.erase(edge)) edges.insert(edge);
+    statistics.touch(a);
+    statistics.touch(b);
+  }
+  std::size_t degreeOf(std::size_t node) const {
+    std::size_t degree = 0;
+    for (auto& [a, b] : edges) degree += a == node || b == node;
+    return degree;
+  }
+  void update() {
+    statistics.update([this](std::size_t node) { return degreeOf(node); },
+                      [this](std::size_t node) {
+                        for (auto& [a, b] : edges) {
+                          if (a == node) return b;
+                          if (b == node) return a;
+                        }
+                        return GraphStateStatistics::none;
+                      },
+                      // the nodes 0 to 2 are at the end 0 of the links and the others at the end 1
+                      [](std::size_t a, std::size_t b) { return GraphStateStatistics::Link{std::min(a / 3, b / 3), std::max(a / 3, b / 3)}; });
+  }
+  std::set<std::pair<std::size_t, std::size_t>> edges;
+  GraphStateStatistics statistics;
+};
+
+TEST_F(GraphStateStatisticsTest, BellPairsByLink) {
+  toggleEdge(0, 3);
+  toggleEdge(1, 4);
+  toggleEdge(2, 5);
+  update();
+  EXPECT_EQ(statistics.degreeHistogram(), (Histogram{0, 6}));
+  EXPECT_EQ(statistics.bellPairsByLink(), (Pairs{{{0, 1}, 3}}));
+
+  // 3 and 4 swap the pairs 0-3 and 1-4 into 0-1, and 0-1 is within the end 0
+  toggleEdge(3, 4);
+  update();
+  EXPECT_EQ(statistics.degreeHistogram(), (Histogram{0, 4, 2}));
+  EXPECT_EQ(statistics.bellPairsByLink(), (Pairs{{{0, 1}, 1}}));
+  toggleEdge(0, 3);
+  toggleEdge(1, 4);
+  toggleEdge(3, 4);
+  toggleEdge(0, 1);
+  update();
+  EXPECT_EQ(statistics.degreeHistogram(), (Histogram{0, 4}));
+  EXPECT_EQ(statistics.bellPairsByLink(), (Pairs{{{0, 0}, 1}, {{0, 1}, 1}}));
+}
+
+TEST_F(GraphStateStatisticsTest, PairBrokenFromTheOtherEnd) {
+  toggleEdge(0, 3);
+  update();
+  EXPECT_EQ(statistics.bellPairsByLink().size(), 1);
+  // only 3 and 5 are touched, 0 keeps its edge but isn't in a pair anymore
+  toggleEdge(3, 5);
+  update();
+  EXPECT_EQ(statistics.degreeHistogram(), (Histogram{0, 2, 1}));
+  EXPECT_TRUE(statistics.bellPairsByLink().empty());
+  toggleEdge(3, 5);
+  update();
+  EXPECT_EQ(statistics.bellPairsByLink(), (Pairs{{{0, 1}, 1}}));
+
+  // a deleted node has no edges
+  edges.clear();
+  statistics.touch(0);
+  statistics.touch(3);
+  update();
+  EXPECT_TRUE(statistics.degreeHistogram().empty());
+  EXPECT_TRUE(statistics.bellPairsByLink().empty());
+}
+
+}  // namespace
@@ -0,0 +1,167 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <vector>
+#include "test.h"
+
+namespace {
+using namespace quisp_test::backends::graph_state;
+
+struct BenchBackend {
+  BenchBackend(int num_qubits) {
+    SimTime::setScaleExp(-9);
+    rng = new TestRNG();
+    backend = std::make_unique<Backend>(std::unique_ptr<IRandomNumberGenerator>(rng), std::make_unique<StationaryQubitConfiguration>());
+    for (int i = 0; i < num_qubits; i++) {
+      auto* qubit = dynamic_cast<Qubit*>(backend->createQubit(i));
+      qubit->fillParams();
+      qubits.push_back(qubit);
+    }
+  }
+  void reset() {
+    for (auto* qubit : qubits) qubit->reset();
+  }
+  TestRNG* rng;
+  std::unique_ptr<Backend> backend;
+  std::vector<Qubit*> qubits;
+};
+
+// entangle a linear chain and swap it down, similar to a repeater chain with state.range(0) nodes.
+static void BM_GraphState_ApplyPureCZ_Chain(benchmark::State& state) {
+  BenchBackend b(state.range(0));
+  for (auto _ : state) {
+    b.reset();
+    for (auto* q : b.qubits) q->applyClifford(CliffordOperator::H);
+    for (size_t i = 0; i + 1 < b.qubits.size(); i++) b.qubits[i]->applyPureCZ(b.qubits[i + 1]);
+    benchmark::DoNotOptimize(b.qubits[0]->getNeighborSet().size());
+  }
+  state.SetItemsProcessed(state.iterations() * (state.range(0) - 1));
+}
+BENCHMARK(BM_GraphState_ApplyPureCZ_Chain)->Arg(8)->Arg(64)->Arg(256);
+
+// local complementation on a star graph whose center has state.range(0) neighbors.
+static void BM_GraphState_LocalComplement_Star(benchmark::State& state) {
+  BenchBackend b(state.range(0) + 1);
+  auto* center = b.qubits[0];
+  for (size_t i = 1; i < b.qubits.size(); i++) center->addEdge(b.qubits[i]);
+  for (auto _ : state) {
+    center->localComplement();
+    benchmark::DoNotOptimize(center->getVertexOperator());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GraphState_LocalComplement_Star)->Arg(2)->Arg(4)->Arg(16)->Arg(64);
+
+// local complementation of the center of state.range(0) neighbors that are half connected to each other,
+// on state.range(1) threads.
+static void BM_GraphState_LocalComplement_Dense(benchmark::State& state) {
+  BenchBackend b(state.range(0) + 1);
+  b.backend->setLocalComplementThreads(state.range(1), 0);
+  auto* center = b.qubits[0];
+  for (size_t i = 1; i < b.qubits.size(); i++) {
+    center->addEdge(b.qubits[i]);
+    for (size_t j = i + 1; j < b.qubits.size(); j += 2) b.qubits[i]->addEdge(b.qubits[j]);
+  }
+  for (auto _ : state) {
+    center->localComplement();
+    benchmark::DoNotOptimize(center->getVertexOperator());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) * (state.range(0) - 1) / 2);
+}
+BENCHMARK(BM_GraphState_LocalComplement_Dense)->ArgsProduct({{16, 64, 256, 1024}, {1, 2, 4}})->UseRealTime();
+
+// memory error on a qubit that waited 10 μs since the last operation.
+static void BM_GraphState_ApplyMemoryError(benchmark::State& state) {
+  BenchBackend b(1);
+  auto* qubit = b.qubits[0];
+  qubit->setMemoryErrorRates(1e-5, 1e-5, 1e-5, 1e-6, 1e-6);
+  b.rng->double_value = 0.0;
+  SimTime now = 0;
+  for (auto _ : state) {
+    now += SimTime(10e-6);
+    b.backend->setSimTime(now);
+    qubit->applyMemoryError();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GraphState_ApplyMemoryError);
+
+// same workload as BM_PauliFrame_SwapChain to compare the backends.
+static void BM_GraphState_SwapChain(benchmark::State& state) {
+  SimTime::setScaleExp(-9);
+  auto* rng = new TestRNG();
+  auto conf = std::make_unique<StationaryQubitConfiguration>();
+  conf->cnot_gate_err_rate = 0.01;
+  GraphStateBackend backend(std::unique_ptr<IRandomNumberGenerator>(rng), std::move(conf));
+  std::vector<IQubit*> qubits;
+  for (int i = 0; i < 2 * state.range(0); i++) qubits.push_back(backend.createQubit(new QubitId(i)));
+  for (auto _ : state) {
+    for (size_t i = 0; i < qubits.size(); i += 2) {
+      qubits[i]->gateH();
+      qubits[i]->gateCNOT(qubits[i + 1]);
+    }
+    for (size_t i = 1; i + 1 < qubits.size(); i += 2) {
+      qubits[i]->gateCNOT(qubits[i + 1]);
+      if (qubits[i + 1]->measureZ() == EigenvalueResult::MINUS_ONE) qubits.back()->gateX();
+      if (qubits[i]->measureX() == EigenvalueResult::MINUS_ONE) qubits.front()->gateZ();
+    }
+    benchmark::DoNotOptimize(qubits.front()->measureZ());
+    benchmark::DoNotOptimize(qubits.back()->measureZ());
+    for (auto* qubit : qubits) qubit->setFree();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_GraphState_SwapChain)->Arg(2)->Arg(8)->Arg(32);
+
+// single gates and measurements through the IQubit interface, state.range(0) == 1 enables the gate and memory errors.
+static std::unique_ptr<StationaryQubitConfiguration> benchConfiguration(bool noisy) {
+  auto conf = std::make_unique<StationaryQubitConfiguration>();
+  if (noisy) {
+    conf->h_gate_err_rate = 0.01;
+    conf->x_gate_err_rate = 0.01;
+    conf->cnot_gate_err_rate = 0.01;
+    conf->measurement_z_err_rate = 0.01;
+    conf->memory_z_err_rate = 1e-5;
+  }
+  return conf;
+}
+
+static void BM_GraphState_GateH(benchmark::State& state) {
+  SimTime::setScaleExp(-9);
+  GraphStateBackend backend(std::make_unique<TestRNG>(), benchConfiguration(state.range(0)));
+  auto* qubit = backend.createQubit(new QubitId(0));
+  for (auto _ : state) {
+    qubit->gateH();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GraphState_GateH)->Arg(0)->Arg(1);
+
+static void BM_GraphState_GateCNOT(benchmark::State& state) {
+  SimTime::setScaleExp(-9);
+  GraphStateBackend backend(std::make_unique<TestRNG>(), benchConfiguration(state.range(0)));
+  auto* control = backend.createQubit(new QubitId(0));
+  auto* target = backend.createQubit(new QubitId(1));
+  control->gateH();
+  for (auto _ : state) {
+    control->gateCNOT(target);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GraphState_GateCNOT)->Arg(0)->Arg(1);
+
+static void BM_GraphState_MeasureZ(benchmark::State& state) {
+  SimTime::setScaleExp(-9);
+  GraphStateBackend backend(std::make_unique<TestRNG>(), benchConfiguration(state.range(0)));
+  auto* qubit = backend.createQubit(new QubitId(0));
+  auto* partner = backend.createQubit(new QubitId(1));
+  for (auto _ : state) {
+    qubit->gateH();
+    qubit->gateCNOT(partner);
+    benchmark::DoNotOptimize(qubit->measureZ());
+    benchmark::DoNotOptimize(partner->measureZ());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GraphState_MeasureZ)->Arg(0)->Arg(1);
+
+}  // namespace
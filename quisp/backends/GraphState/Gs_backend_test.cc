@@ -1,10 +1,14 @@
 #include <cxxabi.h>
+#include <algorithm>
 #include <gtest/gtest.h>
 #include <omnetpp.h>
+#include <sstream>
 #include <stdexcept>
+#include <vector>
 #include "Backend.h"
 #include "Qubit.h"
 #include "backends/interfaces/IConfiguration.h"
+#include "modules/QNIC/StationaryQubit/QubitId.h"
 #include "test.h"
 
 namespace {
@@ -20,11 +24,15 @@ class TestGsQubit : public GraphStateQubit {
   using GraphStateQubit::gate_err_z;
   using GraphStateQubit::measurement_err;
   using GraphStateQubit::memory_err;
+  using GraphStateQubit::neighbors;
+  using GraphStateQubit::vertex_operator;
 };
 
 class GsBackend : public GraphStateBackend {
  public:
+  using GraphStateBackend::qubit_arena;
   using GraphStateBackend::qubits;
+  using GraphStateBackend::short_live_qubit_pool;
   GsBackend(std::unique_ptr<IRandomNumberGenerator> rng, std::unique_ptr<StationaryQubitConfiguration> config) : GraphStateBackend(std::move(rng), std::move(config)) {}
 };
 
@@ -62,6 +70,24 @@ TEST_F(GsBackendTest, getQubit) {
   EXPECT_EQ(same_qubit, qubit);
 }
 
+TEST_F(GsBackendTest, packedQubitIdKeys) {
+  using NodeQubitId = quisp::modules::qubit_id::QubitId;
+  EXPECT_EQ(NodeQubitId::pack(1, 2, 1, 3), (std::uint64_t{1} << 40) | (std::uint64_t{1} << 38) | (std::uint64_t{2} << 24) | 3);
+  EXPECT_EQ(NodeQubitId::pack(-1, -1, -1, 0), ~std::uint64_t{0} << 24);
+  EXPECT_THROW(NodeQubitId::pack(1 << 24, 0, 0, 0), std::invalid_argument);
+  EXPECT_THROW(NodeQubitId::pack(0, 0, 3, 0), std::invalid_argument);
+
+  // the short live qubits use the same keys with the reserved node, so they don't collide with the qubits of the nodes
+  auto* qubit = backend->createQubit(new NodeQubitId(0, 0, 0, 1));
+  auto* photon = backend->getShortLiveQubit();
+  EXPECT_NE(qubit, photon);
+  EXPECT_EQ(backend->qubits.size(), 2);
+  NodeQubitId same_id(0, 0, 0, 1);
+  EXPECT_EQ(backend->getQubit(&same_id), qubit);
+  NodeQubitId photon_id(-1, -1, -1, 1);
+  EXPECT_EQ(backend->getQubit(&photon_id), photon);
+}
+
 TEST_F(GsBackendTest, getQubitTwice) {
   auto* id = new QubitId(3);
   backend->createQubit(id);
@@ -153,4 +179,259 @@ TEST_F(GsBackendTest, getQubitWithConfiguration) {
   EXPECT_EQ(Gs_qubit->gate_err_cnot.zi_error_rate, conf->cnot_gate_zi_err_ratio);
   EXPECT_EQ(Gs_qubit->gate_err_cnot.zz_error_rate, conf->cnot_gate_zz_err_ratio);
 }
+
+TEST_F(GsBackendTest, sameConfigurationSharesErrorModels) {
+  StationaryQubitConfiguration conf;
+  conf.h_gate_err_rate = 0.01;
+  conf.h_gate_x_err_ratio = 1;
+  conf.memory_x_err_rate = 1e-4;
+  StationaryQubitConfiguration same_conf = conf;
+  StationaryQubitConfiguration other_conf = conf;
+  other_conf.memory_x_err_rate = 2e-4;
+
+  auto models = backend->getErrorModels(conf);
+  EXPECT_EQ(models, backend->getErrorModels(same_conf));
+  EXPECT_NE(models, backend->getErrorModels(other_conf));
+  EXPECT_DOUBLE_EQ(models->gate_err_h.pauli_error_rate, 0.01);
+  EXPECT_DOUBLE_EQ(models->memory_err.x_error_rate, 1e-4);
+
+  auto* qubit = reinterpret_cast<TestGsQubit*>(backend->createQubit(new QubitId(1), std::make_unique<StationaryQubitConfiguration>(conf)));
+  EXPECT_DOUBLE_EQ(qubit->gate_err_h.pauli_error_rate, 0.01);
+  EXPECT_DOUBLE_EQ(qubit->memory_err.x_error_rate, 1e-4);
+}
+
+TEST_F(GsBackendTest, deletedQubitSlotIsReused) {
+  auto* id = new QubitId(1);
+  auto* qubit = backend->createQubit(id);
+  auto index = id->getBackendIndex();
+  EXPECT_EQ(backend->qubit_arena.get(index), qubit);
+  backend->deleteQubit(id);
+  EXPECT_EQ(backend->qubit_arena.get(index), nullptr);
+  EXPECT_THROW(backend->getQubit(id), std::runtime_error);
+
+  auto* another_id = new QubitId(2);
+  auto* another_qubit = backend->createQubit(another_id);
+  EXPECT_EQ(another_id->getBackendIndex(), index);
+  // the stale index in the deleted id must not resolve to the new qubit
+  EXPECT_THROW(backend->getQubit(id), std::runtime_error);
+  EXPECT_EQ(backend->getQubit(another_id), another_qubit);
+}
+
+TEST_F(GsBackendTest, memoryUsage) {
+  auto empty = backend->getMemoryUsage();
+  EXPECT_EQ(empty.num_qubits, 0);
+  auto* a = backend->createQubit(new QubitId(1));
+  auto* b = backend->createQubit(new QubitId(2));
+  a->noiselessH();
+  a->noiselessCNOT(b);
+  auto usage = backend->getMemoryUsage();
+  EXPECT_EQ(usage.num_qubits, 2);
+  EXPECT_EQ(usage.num_edges, 1);
+  EXPECT_GE(usage.bytes, 2 * sizeof(GraphStateQubit));
+}
+
+TEST_F(GsBackendTest, neighborsOnMemoryResource) {
+  backend->setMemoryResourceStrategy(quisp::utils::MemoryResourceStrategy::Pool);
+  EXPECT_NE(backend->getNeighborMemoryResource(), std::pmr::new_delete_resource());
+  auto* center = backend->createQubit(new QubitId(0));
+  center->noiselessH();
+  for (int i = 1; i <= 8; i++) center->noiselessCNOT(backend->createQubit(new QubitId(i)));
+  // the GHZ state is a star, the center spills out of its inline neighbors
+  EXPECT_EQ(backend->getMemoryUsage().num_edges, 8);
+  EXPECT_FALSE(static_cast<TestGsQubit*>(center)->neighbors.isInline());
+  EXPECT_THROW(backend->setMemoryResourceStrategy(quisp::utils::MemoryResourceStrategy::Monotonic), std::runtime_error);
+}
+
+TEST_F(GsBackendTest, reserveShortLiveQubits) {
+  backend->reserveQubits(1000);
+  EXPECT_GE(backend->qubit_arena.capacity(), 1000);
+  EXPECT_EQ(backend->qubits.size(), 0);
+  backend->reserveShortLiveQubits(3);
+  EXPECT_EQ(backend->short_live_qubit_pool.size(), 3);
+  EXPECT_EQ(backend->qubits.size(), 3);
+  auto* photon = backend->getShortLiveQubit();
+  EXPECT_EQ(backend->short_live_qubit_pool.size(), 2);
+  photon->relaseBackToPool();
+  backend->reserveShortLiveQubits(3);
+  EXPECT_EQ(backend->qubits.size(), 3);
+}
+
+TEST_F(GsBackendTest, shortLiveQubitsHaveNoMemoryError) {
+  auto conf = std::make_unique<StationaryQubitConfiguration>();
+  conf->memory_x_err_rate = 0.1;
+  conf->memory_relaxation_rate = 0.1;
+  conf->cnot_gate_err_rate = 0.2;
+  backend = std::make_unique<GsBackend>(std::unique_ptr<IRandomNumberGenerator>(rng = new TestRNG()), std::move(conf));
+  auto* photon = reinterpret_cast<TestGsQubit*>(backend->getShortLiveQubit());
+  EXPECT_EQ(photon->memory_err.error_rate, 0);
+  EXPECT_EQ(photon->gate_err_cnot.pauli_error_rate, 0.2);
+  auto* stationary = reinterpret_cast<TestGsQubit*>(backend->createQubit(new QubitId(1)));
+  EXPECT_NE(stationary->memory_err.error_rate, 0);
+
+  // the released photon comes back as it was configured
+  photon->relaseBackToPool();
+  EXPECT_EQ(backend->getShortLiveQubit(), photon);
+  EXPECT_EQ(photon->memory_err.error_rate, 0);
+}
+
+TEST_F(GsBackendTest, restoreGraphState) {
+  std::vector<IQubit*> qubits;
+  for (int i = 0; i < 4; i++) qubits.push_back(backend->createQubit(new QubitId(i)));
+  // GHZ state over the first three qubits, the last one flipped
+  backend->setSimTime(SimTime(5, SIMTIME_US));
+  qubits[0]->noiselessH();
+  qubits[0]->noiselessCNOT(qubits[1]);
+  qubits[1]->noiselessCNOT(qubits[2]);
+  qubits[3]->noiselessX();
+  std::stringstream snapshot;
+  backend->saveGraphState(snapshot);
+
+  auto restored = std::make_unique<GsBackend>(std::make_unique<TestRNG>(), std::make_unique<StationaryQubitConfiguration>());
+  std::vector<IQubit*> restored_qubits;
+  for (int i = 0; i < 4; i++) restored_qubits.push_back(restored->createQubit(new QubitId(i)));
+  restored->restoreGraphState(snapshot);
+  EXPECT_EQ(restored->getSimTime(), SimTime(5, SIMTIME_US));
+  EXPECT_EQ(restored->getComponentSizeHistogram(), backend->getComponentSizeHistogram());
+  for (int i = 0; i < 4; i++) {
+    auto* qubit = reinterpret_cast<TestGsQubit*>(qubits[i]);
+    auto* restored_qubit = reinterpret_cast<TestGsQubit*>(restored_qubits[i]);
+    EXPECT_EQ(restored_qubit->vertex_operator, qubit->vertex_operator);
+    EXPECT_EQ(restored_qubit->neighbors.size(), qubit->neighbors.size());
+  }
+  EXPECT_EQ(restored_qubits[0]->noiselessMeasureZ(), qubits[0]->noiselessMeasureZ());
+  EXPECT_EQ(restored_qubits[2]->noiselessMeasureZ(), qubits[2]->noiselessMeasureZ());
+  EXPECT_EQ(restored_qubits[3]->noiselessMeasureZ(), EigenvalueResult::MINUS_ONE);
+}
+
+TEST_F(GsBackendTest, restoreGraphStateWithDifferentQubits) {
+  backend->createQubit(new QubitId(1));
+  std::stringstream snapshot;
+  backend->saveGraphState(snapshot);
+  auto other = std::make_unique<GsBackend>(std::make_unique<TestRNG>(), std::make_unique<StationaryQubitConfiguration>());
+  other->createQubit(new QubitId(1));
+  other->createQubit(new QubitId(2));
+  EXPECT_THROW(other->restoreGraphState(snapshot), std::runtime_error);
+  std::stringstream garbage("not a snapshot at all");
+  EXPECT_THROW(other->restoreGraphState(garbage), std::runtime_error);
+}
+
+class CountingRNG : public TestRNG {
+ public:
+  double doubleRandom() override {
+    count++;
+    return TestRNG::doubleRandom();
+  }
+  int count = 0;
+};
+
+TEST(GsBackendNoiselessTest, noiselessConfigurationSkipsErrorSimulation) {
+  SimTime::setScaleExp(-9);
+  auto* rng = new CountingRNG();
+  auto backend = std::make_unique<GsBackend>(std::unique_ptr<IRandomNumberGenerator>(rng), std::make_unique<StationaryQubitConfiguration>());
+  auto* control = backend->createQubit(new QubitId(1));
+  auto* target = backend->createQubit(new QubitId(2));
+  auto* photon = backend->getShortLiveQubit();
+  EXPECT_NE(dynamic_cast<NoiselessGraphStateQubit*>(control), nullptr);
+  EXPECT_NE(dynamic_cast<NoiselessGraphStateQubit*>(photon), nullptr);
+
+  backend->setSimTime(SimTime(1, SIMTIME_US));
+  control->gateX();
+  control->gateCNOT(target);
+  EXPECT_EQ(control->measureZ(), EigenvalueResult::MINUS_ONE);
+  EXPECT_EQ(target->measureZ(), EigenvalueResult::MINUS_ONE);
+  photon->gateH();
+  photon->gateS();
+  EXPECT_EQ(photon->measureY(), EigenvalueResult::PLUS_ONE);
+  EXPECT_EQ(rng->count, 0);
+
+  auto conf = std::make_unique<StationaryQubitConfiguration>();
+  conf->measurement_z_err_rate = 0.1;
+  auto* noisy = backend->createQubit(new QubitId(3), std::move(conf));
+  EXPECT_EQ(dynamic_cast<NoiselessGraphStateQubit*>(noisy), nullptr);
+  noisy->measureZ();
+  EXPECT_EQ(rng->count, 1);
+}
+
+TEST_F(GsBackendTest, entanglementComponents) {
+  auto* a = backend->createQubit(new QubitId(1));
+  auto* b = backend->createQubit(new QubitId(2));
+  auto* c = backend->createQubit(new QubitId(3));
+  auto* d = backend->createQubit(new QubitId(4));
+  EXPECT_EQ(backend->getComponentSize(a), 1);
+  EXPECT_EQ(backend->getComponentSizeHistogram(), (std::vector<std::size_t>{0, 4}));
+
+  // two Bell pairs, a-b and c-d
+  a->noiselessH();
+  a->noiselessCNOT(b);
+  c->noiselessH();
+  c->noiselessCNOT(d);
+  EXPECT_EQ(backend->getComponentSize(a), 2);
+  EXPECT_EQ(backend->getComponentSize(d), 2);
+  EXPECT_EQ(backend->getComponentSizeHistogram(), (std::vector<std::size_t>{0, 0, 2}));
+
+  // entanglement swapping at b and c joins and then splits them again
+  b->noiselessCNOT(c);
+  EXPECT_EQ(backend->getComponentSize(a), 4);
+  b->noiselessMeasureX();
+  c->noiselessMeasureZ();
+  EXPECT_EQ(backend->getComponentSize(a), 2);
+  EXPECT_EQ(backend->getComponentSize(b), 1);
+  auto qubits = backend->getComponentQubits(d);
+  EXPECT_EQ(qubits.size(), 2);
+  EXPECT_NE(std::find(qubits.begin(), qubits.end(), a), qubits.end());
+  EXPECT_EQ(backend->getComponentSizeHistogram(), (std::vector<std::size_t>{0, 2, 1}));
+
+  backend->deleteQubit(a->getId());
+  EXPECT_EQ(backend->getComponentSize(d), 1);
+  EXPECT_EQ(backend->getComponentSizeHistogram(), (std::vector<std::size_t>{0, 3}));
+}
+
+TEST_F(GsBackendTest, statisticsSampler) {
+  std::vector<IQubit*> qubits;
+  for (int i = 0; i < 4; i++) qubits.push_back(backend->createQubit(new QubitId(i)));
+  std::stringstream file;
+  // the qubits 0 and 1 are at one end of the links and 2 and 3 at the other
+  backend->setStatisticsSampler(&file, SimTime(1, SIMTIME_US), [](std::uint64_t key) { return key / 2; });
+  backend->setSimTime(SimTime(0));
+
+  // Bell pairs 0-2 and 1-3, then a swapping at 2 and 3 leaves 0-1
+  qubits[0]->noiselessH();
+  qubits[0]->noiselessCNOT(qubits[2]);
+  qubits[1]->noiselessH();
+  qubits[1]->noiselessCNOT(qubits[3]);
+  // within the interval of the last snapshot
+  backend->setSimTime(SimTime(500, SIMTIME_NS));
+  backend->setSimTime(SimTime(1500, SIMTIME_NS));
+  qubits[2]->noiselessCNOT(qubits[3]);
+  qubits[2]->noiselessMeasureX();
+  qubits[3]->noiselessMeasureZ();
+  backend->setSimTime(SimTime(2, SIMTIME_US));
+  backend->deleteQubit(qubits[0]->getId());
+  backend->setSimTime(SimTime(3, SIMTIME_US));
+  backend->setStatisticsSampler(nullptr, SimTime(1, SIMTIME_US), nullptr);
+  backend->setSimTime(SimTime(4, SIMTIME_US));
+
+  using Entries = std::vector<std::pair<std::uint32_t, std::uint64_t>>;
+  using Pairs = std::vector<std::pair<GraphStateStatistics::Link, std::uint64_t>>;
+  auto snapshots = readStatistics(file);
+  ASSERT_EQ(snapshots.size(), 4);
+  EXPECT_EQ(snapshots[0].time, 0);
+  EXPECT_TRUE(snapshots[0].degrees.empty());
+  EXPECT_EQ(snapshots[0].component_sizes, (Entries{{1, 4}}));
+  EXPECT_TRUE(snapshots[0].bell_pairs.empty());
+
+  EXPECT_EQ(snapshots[1].time, SimTime(1500, SIMTIME_NS).raw());
+  EXPECT_EQ(snapshots[1].degrees, (Entries{{1, 4}}));
+  EXPECT_EQ(snapshots[1].component_sizes, (Entries{{2, 2}}));
+  EXPECT_EQ(snapshots[1].bell_pairs, (Pairs{{{0, 1}, 2}}));
+
+  EXPECT_EQ(snapshots[2].degrees, (Entries{{1, 2}}));
+  EXPECT_EQ(snapshots[2].component_sizes, (Entries{{1, 2}, {2, 1}}));
+  EXPECT_EQ(snapshots[2].bell_pairs, (Pairs{{{0, 0}, 1}}));
+
+  EXPECT_EQ(snapshots[3].time, SimTime(3, SIMTIME_US).raw());
+  EXPECT_TRUE(snapshots[3].degrees.empty());
+  EXPECT_EQ(snapshots[3].component_sizes, (Entries{{1, 3}}));
+  EXPECT_TRUE(snapshots[3].bell_pairs.empty());
+}
 }  // namespace
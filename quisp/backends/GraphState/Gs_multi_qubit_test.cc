@@ -569,4 +569,79 @@ TEST_F(GsMultiQubitTest, checkMSMLinkConnection) {
   resetRegister();
 }
 
+TEST_F(GsMultiQubitTest, bellMeasureSwapsEntanglement) {
+  // Bell pairs (0, 1) and (2, 3), the Bell state measurement on 1 and 2 leaves (0, 3) entangled after the correction
+  for (double bsm_rand : {0.0, 0.5}) {
+    for (double rand : {0.0, 0.5}) {
+      for (bool check_xx : {false, true}) {
+        quantum_register.at(0)->gateH();
+        quantum_register.at(0)->gateCNOT(quantum_register.at(1));
+        quantum_register.at(2)->gateH();
+        quantum_register.at(2)->gateCNOT(quantum_register.at(3));
+        rng->double_value = bsm_rand;
+        auto result = quantum_register.at(1)->bellMeasure(quantum_register.at(2));
+        EXPECT_EQ(result.x_result, bsm_rand < 0.5 ? EigenvalueResult::PLUS_ONE : EigenvalueResult::MINUS_ONE);
+        EXPECT_EQ(result.z_result, bsm_rand < 0.5 ? EigenvalueResult::PLUS_ONE : EigenvalueResult::MINUS_ONE);
+        if (result.z_result == EigenvalueResult::MINUS_ONE) quantum_register.at(3)->gateX();
+        if (result.x_result == EigenvalueResult::MINUS_ONE) quantum_register.at(0)->gateZ();
+
+        rng->double_value = rand;
+        auto meas0 = check_xx ? quantum_register.at(0)->measureX() : quantum_register.at(0)->measureZ();
+        auto meas3 = check_xx ? quantum_register.at(3)->measureX() : quantum_register.at(3)->measureZ();
+        EXPECT_EQ(meas0, meas3);
+        resetRegister();
+      }
+    }
+  }
+}
+
+TEST_F(GsMultiQubitTest, bellPairFidelity) {
+  auto* bell_0 = quantum_register.at(0);
+  auto* bell_1 = quantum_register.at(1);
+  // |00>
+  EXPECT_DOUBLE_EQ(backend->getBellPairFidelity(bell_0, bell_1), 0.5);
+
+  bell_0->noiselessH();
+  bell_0->noiselessCNOT(bell_1);
+  EXPECT_NEAR(backend->getBellPairFidelity(bell_0, bell_1), 1, 1e-12);
+  EXPECT_NEAR(backend->getBellPairFidelity(bell_1, bell_0), 1, 1e-12);
+  bell_1->noiselessZ();
+  EXPECT_NEAR(backend->getBellPairFidelity(bell_0, bell_1), 0, 1e-12);
+  bell_0->noiselessZ();
+  bell_0->noiselessX();
+  EXPECT_NEAR(backend->getBellPairFidelity(bell_0, bell_1), 0, 1e-12);
+  bell_1->noiselessX();
+  EXPECT_NEAR(backend->getBellPairFidelity(bell_0, bell_1), 1, 1e-12);
+  // S and Sdg cancel on the Bell pair
+  bell_0->gateS();
+  bell_1->gateSdg();
+  EXPECT_NEAR(backend->getBellPairFidelity(bell_0, bell_1), 1, 1e-12);
+
+  // two qubits of a GHZ state are classically correlated
+  auto* ghz_0 = quantum_register.at(2);
+  ghz_0->noiselessH();
+  ghz_0->noiselessCNOT(quantum_register.at(3));
+  ghz_0->noiselessCNOT(quantum_register.at(4));
+  EXPECT_NEAR(backend->getBellPairFidelity(ghz_0, quantum_register.at(3)), 0.5, 1e-12);
+  EXPECT_NEAR(backend->getBellPairFidelity(quantum_register.at(3), quantum_register.at(4)), 0.5, 1e-12);
+  EXPECT_THROW(backend->getBellPairFidelity(ghz_0, ghz_0), std::runtime_error);
+}
+
+TEST_F(GsMultiQubitTest, bellPairFidelityWithPendingMemoryError) {
+  auto* bell_0 = quantum_register.at(0);
+  auto* bell_1 = quantum_register.at(1);
+  bell_0->noiselessH();
+  bell_0->noiselessCNOT(bell_1);
+  bell_0->setMemoryErrorRates(1e-3, 1e-3, 1e-3, 1e-3, 1e-3);
+  backend->setSimTime(SimTime(100, SIMTIME_US));
+  auto distribution = bell_0->memory_transition->errorDistribution(100);
+  // X, Y and Z errors give the orthogonal Bell states, the excitation and the relaxation leave |1> or |0> next to a mixed qubit
+  auto expected = distribution(0, 0) + (distribution(0, 4) + distribution(0, 5)) / 4;
+  rng->double_value = 0;
+  EXPECT_NEAR(backend->getBellPairFidelity(bell_0, bell_1), expected, 1e-12);
+  // nothing is sampled
+  EXPECT_EQ(bell_0->updated_time, SimTime(0));
+  EXPECT_LT(expected, 1);
+}
+
 }  // namespace
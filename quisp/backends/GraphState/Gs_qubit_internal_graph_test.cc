@@ -296,6 +296,41 @@ TEST_F(GsQubitInternalGraphTest, localComplement) {
   }
 }
 
+TEST_F(GsQubitInternalGraphTest, parallelLocalComplementMatchesSerial) {
+  // the same graph in two backends, complemented serially and on the thread pool
+  auto parallel_backend = std::make_unique<Backend>(std::make_unique<TestRNG>(), std::make_unique<StationaryQubitConfiguration>());
+  parallel_backend->setLocalComplementThreads(4, 8);
+  const int num_qubits = 40;
+  std::vector<Qubit *> serial_qubits, parallel_qubits;
+  for (int i = 0; i < num_qubits; i++) {
+    serial_qubits.push_back(dynamic_cast<Qubit *>(backend->createQubit(i + 100)));
+    parallel_qubits.push_back(dynamic_cast<Qubit *>(parallel_backend->createQubit(i + 100)));
+    serial_qubits[i]->fillParams();
+    parallel_qubits[i]->fillParams();
+  }
+  for (int i = 1; i < num_qubits; i++) {
+    serial_qubits[0]->addEdge(serial_qubits[i]);
+    parallel_qubits[0]->addEdge(parallel_qubits[i]);
+    for (int j = i + 1; j < num_qubits; j++) {
+      if ((i * 7 + j * 13) % 5 > 1) continue;
+      serial_qubits[i]->addEdge(serial_qubits[j]);
+      parallel_qubits[i]->addEdge(parallel_qubits[j]);
+    }
+  }
+
+  for (int round = 0; round < 3; round++) {
+    serial_qubits[0]->localComplement();
+    parallel_qubits[0]->localComplement();
+    for (int i = 0; i < num_qubits; i++) {
+      EXPECT_EQ(serial_qubits[i]->getVertexOperator(), parallel_qubits[i]->getVertexOperator());
+      EXPECT_EQ(serial_qubits[i]->getNeighborSet().size(), parallel_qubits[i]->getNeighborSet().size());
+      for (int j = 0; j < num_qubits; j++) {
+        EXPECT_EQ(serial_qubits[i]->isNeighbor(serial_qubits[j]), parallel_qubits[i]->isNeighbor(parallel_qubits[j])) << i << "-" << j;
+      }
+    }
+  }
+}
+
 TEST_F(GsQubitInternalGraphTest, removeVertexOperationResultShouldBeinIdentity) {
   // expect qubit to be Id after
   for (int i = 0; i < 24; i++) {
@@ -900,4 +935,51 @@ TEST_F(GsQubitInternalGraphTest, graphMeasureZGHZState) {
     }
   }
 }
+
+TEST_F(GsQubitInternalGraphTest, purifyFusedWithMeasurement) {
+  auto *alice_keep = static_cast<Qubit *>(backend->createQubit(11));
+  auto *alice_trash = static_cast<Qubit *>(backend->createQubit(12));
+  auto *bob_keep = static_cast<Qubit *>(backend->createQubit(13));
+  auto *bob_trash = static_cast<Qubit *>(backend->createQubit(14));
+
+  for (auto basis : {PurificationBasis::X, PurificationBasis::Z, PurificationBasis::Y}) {
+    for (bool with_error : {false, true}) {
+      for (int i = 1; i <= 2; i++) {
+        for (int j = 1; j <= 2; j++) {
+          alice_keep->reset();
+          alice_trash->reset();
+          bob_keep->reset();
+          bob_trash->reset();
+          alice_keep->fillParams();
+          alice_trash->fillParams();
+          bob_keep->fillParams();
+          bob_trash->fillParams();
+
+          alice_keep->addEdge(bob_keep);
+          alice_keep->vertex_operator = CliffordOperator::Id;
+          alice_trash->addEdge(bob_trash);
+          alice_trash->vertex_operator = CliffordOperator::Id;
+          // the X purification detects the X error, the Z and the Y purification detect the Z error
+          if (with_error) alice_trash->applyClifford(basis == PurificationBasis::X ? CliffordOperator::X : CliffordOperator::Z);
+
+          rng->double_value = (double)i / 3;
+          auto alice_result = alice_keep->purify(alice_trash, basis);
+          rng->double_value = (double)j / 3;
+          auto bob_result = bob_keep->purify(bob_trash, basis);
+          if (with_error) {
+            EXPECT_NE(alice_result, bob_result);
+          } else {
+            EXPECT_EQ(alice_result, bob_result);
+          }
+
+          // the kept qubits are still a bell pair
+          EXPECT_EQ(alice_keep->neighbors.size(), 1);
+          EXPECT_TRUE(alice_keep->isNeighbor(bob_keep));
+          EXPECT_EQ(alice_trash->neighbors.size(), 0);
+          EXPECT_EQ(bob_trash->neighbors.size(), 0);
+        }
+      }
+    }
+  }
+}
 }  // end namespace
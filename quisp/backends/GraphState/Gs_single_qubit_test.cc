@@ -40,7 +40,7 @@ TEST_F(GsSingleQubitTest, setFreeUpdatesTime) {
 TEST_F(GsSingleQubitTest, setMemoryErrorTransitionMatrix) {
   qubit->setMemoryErrorRates(.011, .012, .013, .014, .015);
 
-  auto mat = qubit->memory_transition_matrix;
+  auto mat = qubit->memory_transition->getTransitionMatrix();
 
   // each element means: "Clean Xerror Zerror Yerror Excited Relaxed Mixed"
   Eigen::RowVectorXd row0(6);
@@ -70,6 +70,65 @@ TEST_F(GsSingleQubitTest, setMemoryErrorTransitionMatrix) {
   qubit->setMemoryErrorRates(0, 0, 0, 0, 0);
 }
 
+class CountingRNG : public TestRNG {
+ public:
+  double doubleRandom() override {
+    count++;
+    return TestRNG::doubleRandom();
+  }
+  int count = 0;
+};
+
+TEST(GsSingleQubitLazyMemoryErrorTest, singleQubitGatesDeferDepolarizingMemoryError) {
+  SimTime::setScaleExp(-9);
+  auto* rng = new CountingRNG();
+  auto backend = std::make_unique<Backend>(std::unique_ptr<IRandomNumberGenerator>(rng), std::make_unique<StationaryQubitConfiguration>());
+  backend->setLazyMemoryError(true);
+  auto* qubit = dynamic_cast<Qubit*>(backend->createQubit(1));
+  qubit->fillParams();
+  qubit->setMemoryErrorRates(1e-3, 1e-3, 1e-3, 0, 0);
+  qubit->setFree();
+
+  backend->setSimTime(SimTime(1, SIMTIME_US));
+  qubit->gateH();
+  backend->setSimTime(SimTime(2, SIMTIME_US));
+  qubit->gateS();
+  EXPECT_EQ(rng->count, 0);
+  EXPECT_EQ(qubit->updated_time, SimTime(0));
+
+  // one draw for the memory error of the whole 3 μs, one for the outcome of |+i> and one for the measurement error
+  backend->setSimTime(SimTime(3, SIMTIME_US));
+  qubit->measureZ();
+  EXPECT_EQ(rng->count, 3);
+  EXPECT_EQ(qubit->updated_time, SimTime(3, SIMTIME_US));
+
+  // the excitation doesn't commute with the gates
+  qubit->setMemoryErrorRates(1e-3, 1e-3, 1e-3, 1e-3, 0);
+  backend->setSimTime(SimTime(4, SIMTIME_US));
+  qubit->gateH();
+  EXPECT_EQ(rng->count, 4);
+  EXPECT_EQ(qubit->updated_time, SimTime(4, SIMTIME_US));
+}
+
+TEST(GsSingleQubitLazyMemoryErrorTest, noiselessMeasurementAppliesDeferredMemoryError) {
+  SimTime::setScaleExp(-9);
+  auto* rng = new CountingRNG();
+  auto backend = std::make_unique<Backend>(std::unique_ptr<IRandomNumberGenerator>(rng), std::make_unique<StationaryQubitConfiguration>());
+  backend->setLazyMemoryError(true);
+  auto* qubit = dynamic_cast<Qubit*>(backend->createQubit(1));
+  qubit->fillParams();
+  qubit->setMemoryErrorRates(1e-3, 1e-3, 1e-3, 0, 0);
+  qubit->setFree();
+
+  backend->setSimTime(SimTime(1, SIMTIME_US));
+  qubit->gateX();
+  backend->setSimTime(SimTime(5, SIMTIME_US));
+  // only the part until the gate, the noiseless measurement has no memory error of its own
+  qubit->noiselessMeasureZ();
+  EXPECT_EQ(rng->count, 1);
+  EXPECT_EQ(qubit->updated_time, SimTime(1, SIMTIME_US));
+}
+
 TEST_F(GsSingleQubitTest, singleGatemeasureZ) {
   // do nothing
   auto meas = qubit->measureZ();
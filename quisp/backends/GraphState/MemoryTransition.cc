@@ -0,0 +1,92 @@
+#include "MemoryTransition.h"
+#include <algorithm>
+#include <cmath>
+#include <unsupported/Eigen/MatrixFunctions>
+
+namespace quisp::backends::graph_state {
+using Eigen::MatrixPower;
+using Eigen::MatrixXd;
+using Matrix6cd = Eigen::Matrix<std::complex<double>, 6, 6>;
+
+MemoryTransition::MemoryTransition(const Matrix6d& transition_matrix) : transition_matrix(transition_matrix) {
+  for (int i = 0; i < transition_matrix.cols(); i++) {
+    if (transition_matrix(0, i) == 1) {
+      skip_exponentiation = true;
+      return;
+    }
+  }
+
+  Eigen::EigenSolver<Matrix6d> solver(transition_matrix);
+  if (solver.info() != Eigen::Success) return;
+
+  Matrix6cd eigenvectors = solver.eigenvectors();
+  Eigen::FullPivLU<Matrix6cd> lu(eigenvectors);
+  if (!lu.isInvertible()) return;
+  Matrix6cd inverse = lu.inverse();
+  eigenvalues = solver.eigenvalues();
+
+  // make sure V diag(lambda) V^-1 actually reproduces Q, repeated eigenvalues can make V ill-conditioned.
+  Matrix6cd reconstructed = eigenvectors * eigenvalues.asDiagonal() * inverse;
+  if ((reconstructed.real() - transition_matrix).cwiseAbs().maxCoeff() > 1e-9 || reconstructed.imag().cwiseAbs().maxCoeff() > 1e-9) return;
+
+  for (int k = 0; k < 6; k++) {
+    weighted_rows.row(k) = eigenvectors(0, k) * inverse.row(k);
+  }
+  diagonalized = true;
+}
+
+Matrix6d MemoryTransition::transitionMatrix(double x_error_rate, double y_error_rate, double z_error_rate, double excitation_rate, double relaxation_rate) {
+  double error_rate = x_error_rate + y_error_rate + z_error_rate + excitation_rate + relaxation_rate;  // This is per μs.
+  Matrix6d q;
+  // clang-format off
+  q <<
+    1 - error_rate,  x_error_rate,   z_error_rate,   y_error_rate,   excitation_rate,     relaxation_rate,
+    x_error_rate,    1 - error_rate, y_error_rate,   z_error_rate,   excitation_rate,     relaxation_rate,
+    z_error_rate,    y_error_rate,   1 - error_rate, x_error_rate,   excitation_rate,     relaxation_rate,
+    y_error_rate,    z_error_rate,   x_error_rate,   1 - error_rate, excitation_rate,     relaxation_rate,
+    0,               0,              0,              0,              1 - relaxation_rate, relaxation_rate,
+    0,               0,              0,              0,              excitation_rate,     1 - excitation_rate;
+  // clang-format on
+  return q;
+}
+
+RowVector6d MemoryTransition::errorDistribution(double time_evolution_microsec) const {
+  if (skip_exponentiation) {
+    return transition_matrix.row(0);
+  }
+
+  if (!diagonalized) {
+    // calculate time evoluted error matrix: Q^(time_evolution_microsec) in Eq 5.3
+    MatrixXd q(transition_matrix);
+    MatrixPower<MatrixXd> q_pow(q);
+    MatrixXd transition_mat = q_pow(time_evolution_microsec);
+    return transition_mat.row(0);
+  }
+
+  Eigen::Matrix<std::complex<double>, 1, 6> pi = Eigen::Matrix<std::complex<double>, 1, 6>::Zero();
+  for (int k = 0; k < 6; k++) {
+    auto lambda = eigenvalues(k);
+    std::complex<double> lambda_t;
+    if (lambda.imag() == 0 && lambda.real() > 0) {
+      lambda_t = std::pow(lambda.real(), time_evolution_microsec);
+    } else {
+      lambda_t = std::pow(lambda, time_evolution_microsec);
+    }
+    pi += lambda_t * weighted_rows.row(k);
+  }
+  return pi.real();
+}
+
+std::shared_ptr<const MemoryTransition> MemoryTransitionCache::get(const Matrix6d& transition_matrix) {
+  std::array<double, 36> key;
+  std::copy(transition_matrix.data(), transition_matrix.data() + key.size(), key.begin());
+  auto it = transitions.find(key);
+  if (it != transitions.end()) {
+    return it->second;
+  }
+  auto transition = std::make_shared<const MemoryTransition>(transition_matrix);
+  transitions.emplace(key, transition);
+  return transition;
+}
+
+}  // namespace quisp::backends::graph_state
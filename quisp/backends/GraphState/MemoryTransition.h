@@ -0,0 +1,59 @@
+#pragma once
+#include <Eigen/Eigen>
+#include <array>
+#include <complex>
+#include <map>
+#include <memory>
+
+namespace quisp::backends::graph_state {
+
+using Matrix6d = Eigen::Matrix<double, 6, 6>;
+using RowVector6d = Eigen::Matrix<double, 1, 6>;
+
+/**
+ * @brief precomputed memory error transition for one set of memory error rates.
+ *
+ * The transition matrix Q (I, X, Z, Y, Excited, Relaxed; per μs) is diagonalized once,
+ * so that the error distribution pi(t) = pi(0) Q^t can be evaluated in closed form
+ * for any elapsed time t without running a matrix power on every gate.
+ * Qubits with the same configuration share one instance through GraphStateBackend.
+ * If Q cannot be diagonalized reliably, it falls back to Eigen's MatrixPower.
+ */
+class MemoryTransition {
+ public:
+  explicit MemoryTransition(const Matrix6d& transition_matrix);
+
+  /**
+   * @brief build the transition matrix Q from memory error rates per μs.
+   */
+  static Matrix6d transitionMatrix(double x_error_rate, double y_error_rate, double z_error_rate, double excitation_rate, double relaxation_rate);
+
+  /**
+   * @brief the first row of Q^t, i.e. the error distribution of an initially clean qubit after t μs.
+   */
+  RowVector6d errorDistribution(double time_evolution_microsec) const;
+  const Matrix6d& getTransitionMatrix() const { return transition_matrix; }
+  bool isDiagonalized() const { return diagonalized; }
+
+ protected:
+  Matrix6d transition_matrix;
+  // do not exponentiate when a row has a probability of 1, Eigen won't handle it well.
+  bool skip_exponentiation = false;
+  bool diagonalized = false;
+  Eigen::Matrix<std::complex<double>, 6, 1> eigenvalues;
+  // row k is V(0, k) * V^-1.row(k), so pi(t) = sum_k eigenvalues(k)^t * weighted_rows.row(k)
+  Eigen::Matrix<std::complex<double>, 6, 6> weighted_rows;
+};
+
+/**
+ * @brief keeps one MemoryTransition per distinct transition matrix.
+ */
+class MemoryTransitionCache {
+ public:
+  std::shared_ptr<const MemoryTransition> get(const Matrix6d& transition_matrix);
+
+ protected:
+  std::map<std::array<double, 36>, std::shared_ptr<const MemoryTransition>> transitions;
+};
+
+}  // namespace quisp::backends::graph_state
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <test_utils/TestUtils.h>
+#include <unsupported/Eigen/MatrixFunctions>
+#include <vector>
+#include "MemoryTransition.h"
+#include "test.h"
+
+namespace {
+using namespace quisp_test::backends::graph_state;
+using quisp::backends::graph_state::Matrix6d;
+using quisp::backends::graph_state::MemoryTransition;
+using quisp::backends::graph_state::RowVector6d;
+
+Matrix6d transitionMatrix(double x, double y, double z, double ex, double rl) {
+  double sigma = x + y + z + ex + rl;
+  Matrix6d q;
+  // clang-format off
+  q <<
+    1 - sigma, x,         z,         y,         ex,      rl,
+    x,         1 - sigma, y,         z,         ex,      rl,
+    z,         y,         1 - sigma, x,         ex,      rl,
+    y,         z,         x,         1 - sigma, ex,      rl,
+    0,         0,         0,         0,         1 - rl,  rl,
+    0,         0,         0,         0,         ex,      1 - ex;
+  // clang-format on
+  return q;
+}
+
+RowVector6d matrixPowerRow(const Matrix6d& q, double t) {
+  Eigen::MatrixXd m(q);
+  Eigen::MatrixPower<Eigen::MatrixXd> q_pow(m);
+  Eigen::MatrixXd result = q_pow(t);
+  return result.row(0);
+}
+
+TEST(MemoryTransitionTest, matchesMatrixPower) {
+  std::vector<Matrix6d> matrices = {
+      transitionMatrix(1e-4, 2e-4, 3e-4, 4e-5, 5e-5),  transitionMatrix(1e-3, 1e-3, 1e-3, 0, 0),   transitionMatrix(0, 0, 2e-3, 0, 0),
+      transitionMatrix(1e-5, 1e-5, 1e-5, 1e-5, 1e-5), transitionMatrix(0, 0, 0, 1e-3, 2e-3),      transitionMatrix(.011, .012, .013, .014, .015),
+  };
+  std::vector<double> times = {0.5, 1, 3.7, 100, 12345.6};
+  for (auto& q : matrices) {
+    MemoryTransition transition(q);
+    EXPECT_TRUE(transition.isDiagonalized());
+    for (auto t : times) {
+      auto expected = matrixPowerRow(q, t);
+      auto actual = transition.errorDistribution(t);
+      for (int i = 0; i < 6; i++) {
+        EXPECT_NEAR(actual(0, i), expected(0, i), 1e-9) << "t=" << t << " i=" << i;
+      }
+      EXPECT_NEAR(actual.sum(), 1.0, 1e-9);
+    }
+  }
+}
+
+TEST(MemoryTransitionTest, skipExponentiationWhenProbabilityIsOne) {
+  auto q = transitionMatrix(1, 0, 0, 0, 0);
+  MemoryTransition transition(q);
+  EXPECT_FALSE(transition.isDiagonalized());
+  EXPECT_EQ(transition.errorDistribution(10), q.row(0));
+}
+
+TEST(MemoryTransitionTest, sharedAmongQubitsWithSameRates) {
+  SimTime::setScaleExp(-9);
+  auto* rng = new TestRNG();
+  auto backend = std::make_unique<Backend>(std::unique_ptr<IRandomNumberGenerator>(rng), std::make_unique<StationaryQubitConfiguration>());
+  auto* qubit = dynamic_cast<Qubit*>(backend->createQubit(1));
+  auto* another_qubit = dynamic_cast<Qubit*>(backend->createQubit(2));
+  qubit->setMemoryErrorRates(1e-4, 1e-4, 1e-4, 0, 0);
+  another_qubit->setMemoryErrorRates(1e-4, 1e-4, 1e-4, 0, 0);
+  EXPECT_EQ(qubit->memory_transition, another_qubit->memory_transition);
+  another_qubit->setMemoryErrorRates(2e-4, 1e-4, 1e-4, 0, 0);
+  EXPECT_NE(qubit->memory_transition, another_qubit->memory_transition);
+}
+
+}  // namespace
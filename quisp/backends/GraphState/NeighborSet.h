@@ -0,0 +1,122 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory_resource>
+#include <vector>
+
+namespace quisp::backends::graph_state {
+
+/**
+ * @brief a set of graph state neighbors, kept sorted by address.
+ *
+ * Most vertices in repeater chain simulations have only a few edges, so the first
+ * InlineCapacity neighbors are stored inside the object itself and the set only spills
+ * to a vector when the degree grows beyond that, allocated from the memory resource of the set.
+ * Lookups are a binary search over a contiguous array instead of a hash bucket walk.
+ *
+ * Iterators are plain pointers into the storage and are invalidated by insert, erase and clear.
+ */
+template <typename T, std::size_t InlineCapacity = 4>
+class NeighborSet {
+ public:
+  using value_type = T*;
+  using size_type = std::size_t;
+  using const_iterator = T* const*;
+  using iterator = const_iterator;
+
+  explicit NeighborSet(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) : heap_storage(resource) {}
+
+  const_iterator begin() const { return data(); }
+  const_iterator end() const { return data() + count; }
+  size_type size() const { return count; }
+  bool empty() const { return count == 0; }
+  size_type capacity() const { return on_heap ? heap_storage.capacity() : InlineCapacity; }
+  bool isInline() const { return !on_heap; }
+  // the storage beyond the inline one, for the memory accounting
+  size_type heapBytes() const { return heap_storage.capacity() * sizeof(T*); }
+
+  const_iterator find(T* value) const {
+    auto it = lowerBound(value);
+    if (it != end() && *it == value) return it;
+    return end();
+  }
+  bool contains(T* value) const { return find(value) != end(); }
+
+  /**
+   * @brief insert the value if it is not in the set yet.
+   * @return true if the value was inserted.
+   */
+  bool insert(T* value) {
+    auto it = lowerBound(value);
+    if (it != end() && *it == value) return false;
+    auto index = static_cast<size_type>(it - begin());
+    if (!on_heap && count == InlineCapacity) {
+      heap_storage.reserve(InlineCapacity * 2);
+      heap_storage.assign(inline_storage.begin(), inline_storage.end());
+      on_heap = true;
+    }
+    if (on_heap) {
+      heap_storage.insert(heap_storage.begin() + index, value);
+    } else {
+      std::copy_backward(inline_storage.begin() + index, inline_storage.begin() + count, inline_storage.begin() + count + 1);
+      inline_storage[index] = value;
+    }
+    count++;
+    return true;
+  }
+
+  /**
+   * @brief erase the value if it is in the set.
+   * @return the number of erased elements (0 or 1).
+   */
+  size_type erase(T* value) {
+    auto it = find(value);
+    if (it == end()) return 0;
+    auto index = static_cast<size_type>(it - begin());
+    if (on_heap) {
+      heap_storage.erase(heap_storage.begin() + index);
+    } else {
+      std::copy(inline_storage.begin() + index + 1, inline_storage.begin() + count, inline_storage.begin() + index);
+    }
+    count--;
+    return 1;
+  }
+
+  /**
+   * @brief replace the contents with [first, last), which must be sorted by address without duplicates.
+   */
+  template <typename InputIt>
+  void assignSorted(InputIt first, InputIt last) {
+    auto n = static_cast<size_type>(std::distance(first, last));
+    if (n > InlineCapacity || on_heap) {
+      heap_storage.assign(first, last);
+      on_heap = true;
+    } else {
+      std::copy(first, last, inline_storage.begin());
+    }
+    count = n;
+  }
+
+  void clear() {
+    count = 0;
+    on_heap = false;
+    std::pmr::vector<T*>(heap_storage.get_allocator()).swap(heap_storage);
+  }
+
+  bool operator==(const NeighborSet& other) const { return count == other.count && std::equal(begin(), end(), other.begin()); }
+  bool operator!=(const NeighborSet& other) const { return !(*this == other); }
+
+ protected:
+  T* const* data() const { return on_heap ? heap_storage.data() : inline_storage.data(); }
+  const_iterator lowerBound(T* value) const { return std::lower_bound(begin(), end(), value, std::less<T*>()); }
+
+  std::array<T*, InlineCapacity> inline_storage{};
+  std::pmr::vector<T*> heap_storage;
+  size_type count = 0;
+  bool on_heap = false;
+};
+
+}  // namespace quisp::backends::graph_state
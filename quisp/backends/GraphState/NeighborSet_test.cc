@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+#include "NeighborSet.h"
+
+namespace {
+using quisp::backends::graph_state::NeighborSet;
+
+struct Vertex {
+  int id;
+};
+
+class NeighborSetTest : public ::testing::Test {
+ protected:
+  void SetUp() {
+    for (int i = 0; i < 16; i++) vertices.push_back(Vertex{i});
+  }
+  std::vector<Vertex> vertices;
+};
+
+TEST_F(NeighborSetTest, insertAndFind) {
+  NeighborSet<Vertex, 4> set;
+  EXPECT_TRUE(set.empty());
+  EXPECT_TRUE(set.insert(&vertices[2]));
+  EXPECT_TRUE(set.insert(&vertices[0]));
+  EXPECT_FALSE(set.insert(&vertices[2]));
+  EXPECT_EQ(set.size(), 2);
+  EXPECT_TRUE(set.contains(&vertices[0]));
+  EXPECT_TRUE(set.contains(&vertices[2]));
+  EXPECT_FALSE(set.contains(&vertices[1]));
+  EXPECT_EQ(set.find(&vertices[1]), set.end());
+  EXPECT_NE(set.find(&vertices[2]), set.end());
+  EXPECT_TRUE(set.isInline());
+}
+
+TEST_F(NeighborSetTest, spillToHeapKeepsOrder) {
+  NeighborSet<Vertex, 4> set;
+  for (int i = 15; i >= 0; i--) set.insert(&vertices[i]);
+  EXPECT_EQ(set.size(), 16);
+  EXPECT_FALSE(set.isInline());
+  EXPECT_TRUE(std::is_sorted(set.begin(), set.end(), std::less<Vertex*>()));
+  for (auto& v : vertices) EXPECT_TRUE(set.contains(&v));
+}
+
+TEST_F(NeighborSetTest, erase) {
+  NeighborSet<Vertex, 4> set;
+  for (int i = 0; i < 6; i++) set.insert(&vertices[i]);
+  EXPECT_EQ(set.erase(&vertices[3]), 1);
+  EXPECT_EQ(set.erase(&vertices[3]), 0);
+  EXPECT_EQ(set.size(), 5);
+  EXPECT_FALSE(set.contains(&vertices[3]));
+
+  NeighborSet<Vertex, 4> inline_set;
+  inline_set.insert(&vertices[0]);
+  inline_set.insert(&vertices[1]);
+  inline_set.insert(&vertices[2]);
+  EXPECT_EQ(inline_set.erase(&vertices[0]), 1);
+  EXPECT_EQ(inline_set.size(), 2);
+  EXPECT_TRUE(inline_set.contains(&vertices[1]));
+  EXPECT_TRUE(inline_set.contains(&vertices[2]));
+}
+
+TEST_F(NeighborSetTest, clearReturnsToInlineStorage) {
+  NeighborSet<Vertex, 2> set;
+  for (int i = 0; i < 8; i++) set.insert(&vertices[i]);
+  EXPECT_FALSE(set.isInline());
+  set.clear();
+  EXPECT_TRUE(set.empty());
+  EXPECT_TRUE(set.isInline());
+  EXPECT_EQ(set.begin(), set.end());
+}
+
+TEST_F(NeighborSetTest, copy) {
+  NeighborSet<Vertex, 2> set;
+  for (int i = 0; i < 5; i++) set.insert(&vertices[i]);
+  auto copied = set;
+  EXPECT_EQ(copied, set);
+  copied.erase(&vertices[0]);
+  EXPECT_NE(copied, set);
+  EXPECT_TRUE(set.contains(&vertices[0]));
+}
+
+}  // namespace
@@ -1,14 +1,133 @@
 #include "Qubit.h"
+#include <algorithm>
+#include <array>
+#include <complex>
+#include <cstdint>
+#include <functional>
+#include <iterator>
 #include <stdexcept>
 #include <string>
+#include <vector>
 #include "Backend.h"
 #include "backends/interfaces/IQubit.h"
 #include "types.h"
+#include "utils/Validation.h"
 
 namespace quisp::backends::graph_state {
+using trace::TraceOp;
 using types::CliffordOperator;
+using TraceScope = GraphStateBackend::TraceScope;
+
+namespace {
+constexpr CliffordOperator clifford_application_lookup[24][24] =
+#include "clifford_application_lookup.tbl"
+    ;
+
+constexpr bool controlled_z_lookup_edge[2][24][24] =
+#include "cz_lookup_edge.tbl"
+    ;
+
+constexpr CliffordOperator controlled_z_lookup_node_1[2][24][24] =
+#include "cz_lookup_node_1.tbl"
+    ;
+
+constexpr CliffordOperator controlled_z_lookup_node_2[2][24][24] =
+#include "cz_lookup_node_2.tbl"
+    ;
+
+/**
+ * @brief local complementations that remove a vertex operator, applied from the last one.
+ *
+ * Bit i of ops is set if the i-th operation is V (local complement on the qubit itself)
+ * and cleared if it is U (local complement on a neighbor).
+ */
+struct VertexOperatorDecomposition {
+  uint8_t length;
+  uint8_t ops;
+};
+
+constexpr VertexOperatorDecomposition decompose(const char *sequence) {
+  VertexOperatorDecomposition decomposition{0, 0};
+  for (; sequence[decomposition.length] != '\0'; decomposition.length++) {
+    if (sequence[decomposition.length] == 'V') decomposition.ops |= 1 << decomposition.length;
+  }
+  return decomposition;
+}
+
+constexpr VertexOperatorDecomposition decomposition_table[24] = {
+    decompose(""),      decompose("VV"),    decompose("UUVV"),  decompose("UU"),    decompose("VVV"),  decompose("V"),    decompose("VUU"),  decompose("UUV"),
+    decompose("UVUUU"), decompose("UUUVU"), decompose("UVVVU"), decompose("UVU"),   decompose("U"),    decompose("UUU"),  decompose("VVU"),  decompose("UVV"),
+    decompose("UVVV"),  decompose("UV"),    decompose("UVUU"),  decompose("UUUV"),  decompose("VVVU"), decompose("VU"),   decompose("VUUU"), decompose("UUVU"),
+};
+static_assert(decomposition_table[8].length == 5 && decomposition_table[8].ops == 0b00010, "decomposition bits are read from the first operation");
+
+using Eigen::Matrix2cd;
+using Eigen::Matrix4cd;
+
+// the unitaries of the vertex operators up to the global phase, generated from H and S with the application table
+const std::array<Matrix2cd, 24> &cliffordMatrices() {
+  static const std::array<Matrix2cd, 24> matrices = [] {
+    std::array<Matrix2cd, 24> result;
+    std::array<bool, 24> found{};
+    Matrix2cd h, s;
+    h << 1, 1, 1, -1;
+    h /= std::sqrt(2.0);
+    s << 1, 0, 0, std::complex<double>(0, 1);
+    result[(int)CliffordOperator::Id] = Matrix2cd::Identity();
+    found[(int)CliffordOperator::Id] = true;
+    std::vector<int> queue{(int)CliffordOperator::Id};
+    for (std::size_t i = 0; i < queue.size(); i++) {
+      auto vop = queue[i];
+      for (auto [op, matrix] : {std::pair{CliffordOperator::H, h}, std::pair{CliffordOperator::S, s}}) {
+        auto next = (int)clifford_application_lookup[(int)op][vop];
+        if (found[next]) continue;
+        result[next] = matrix * result[vop];
+        found[next] = true;
+        queue.push_back(next);
+      }
+    }
+    return result;
+  }();
+  return matrices;
+}
+
+Matrix4cd kron(const Matrix2cd &first, const Matrix2cd &second) {
+  Matrix4cd result;
+  for (int i = 0; i < 2; i++) {
+    for (int j = 0; j < 2; j++) result.block<2, 2>(2 * i, 2 * j) = first(i, j) * second;
+  }
+  return result;
+}
+
+// the memory error of one qubit of the pair until now, averaged over the error distribution instead of sampled
+void applyMemoryChannel(Matrix4cd &rho, bool on_first, const RowVector6d &distribution) {
+  Matrix2cd x, y, z, id = Matrix2cd::Identity();
+  x << 0, 1, 1, 0;
+  y << 0, std::complex<double>(0, -1), std::complex<double>(0, 1), 0;
+  z << 1, 0, 0, -1;
+  auto on_qubit = [&](const Matrix2cd &op) { return on_first ? kron(op, id) : kron(id, op); };
+  // excitation and relaxation measure the qubit and leave it in |1> or |0>
+  Matrix2cd other = Matrix2cd::Zero();
+  for (int k = 0; k < 2; k++) {
+    for (int i = 0; i < 2; i++) {
+      for (int j = 0; j < 2; j++) other(i, j) += on_first ? rho(2 * k + i, 2 * k + j) : rho(2 * i + k, 2 * j + k);
+    }
+  }
+  Matrix2cd excited = Matrix2cd::Zero(), relaxed = Matrix2cd::Zero();
+  excited(1, 1) = 1;
+  relaxed(0, 0) = 1;
+  Matrix4cd result = distribution(0, 0) * rho;
+  result += distribution(0, 1) * on_qubit(x) * rho * on_qubit(x);
+  result += distribution(0, 2) * on_qubit(z) * rho * on_qubit(z);
+  result += distribution(0, 3) * on_qubit(y) * rho * on_qubit(y);
+  result += distribution(0, 4) * (on_first ? kron(excited, other) : kron(other, excited));
+  result += distribution(0, 5) * (on_first ? kron(relaxed, other) : kron(other, relaxed));
+  rho = result;
+}
+}  // namespace
+
 GraphStateQubit::GraphStateQubit(const IQubitId *id, GraphStateBackend *const backend, bool is_short_live)
-    : memory_transition_matrix(MatrixXd::Zero(6, 6)), id(id), backend(backend), is_short_live(is_short_live) {
+    : neighbors(backend != nullptr ? backend->getNeighborMemoryResource() : std::pmr::get_default_resource()), id(id), backend(backend), is_short_live(is_short_live) {
   // initialize variables for graph state representation tracking
   vertex_operator = CliffordOperator::H;
 }
@@ -24,34 +143,26 @@ void GraphStateQubit::relaseBackToPool() {
   backend->returnToPool(this);
 }
 
-void GraphStateQubit::configure(std::unique_ptr<StationaryQubitConfiguration> c) {
-  setMemoryErrorRates(c->memory_x_err_rate, c->memory_y_err_rate, c->memory_z_err_rate, c->memory_excitation_rate, c->memory_relaxation_rate);
-  measurement_err.setParams(c->measurement_x_err_rate, c->measurement_y_err_rate, c->measurement_z_err_rate);
-  gate_err_h.setParams(c->h_gate_x_err_ratio, c->h_gate_y_err_ratio, c->h_gate_z_err_ratio, c->h_gate_err_rate);
-  gate_err_x.setParams(c->x_gate_x_err_ratio, c->x_gate_y_err_ratio, c->x_gate_z_err_ratio, c->x_gate_err_rate);
-  gate_err_z.setParams(c->z_gate_x_err_ratio, c->z_gate_y_err_ratio, c->z_gate_z_err_ratio, c->z_gate_err_rate);
-  gate_err_cnot.setParams(c->cnot_gate_err_rate, c->cnot_gate_ix_err_ratio, c->cnot_gate_iy_err_ratio, c->cnot_gate_iz_err_ratio, c->cnot_gate_xi_err_ratio,
-                          c->cnot_gate_xx_err_ratio, c->cnot_gate_xy_err_ratio, c->cnot_gate_xz_err_ratio, c->cnot_gate_yi_err_ratio, c->cnot_gate_yx_err_ratio,
-                          c->cnot_gate_yy_err_ratio, c->cnot_gate_yz_err_ratio, c->cnot_gate_zi_err_ratio, c->cnot_gate_zx_err_ratio, c->cnot_gate_zy_err_ratio,
-                          c->cnot_gate_zz_err_ratio);
+void GraphStateQubit::configure(std::unique_ptr<StationaryQubitConfiguration> c) { setErrorModels(*backend->getErrorModels(*c)); }
+
+void GraphStateQubit::setErrorModels(const GraphStateErrorModels &models) {
+  gate_err_h = models.gate_err_h;
+  gate_err_x = models.gate_err_x;
+  gate_err_z = models.gate_err_z;
+  gate_err_cnot = models.gate_err_cnot;
+  measurement_err = models.measurement_err;
+  memory_err = models.memory_err;
+  memory_transition = models.memory_transition;
 }
+
 void GraphStateQubit::setMemoryErrorRates(double x_error_rate, double y_error_rate, double z_error_rate, double excitation_rate, double relaxation_rate) {
   memory_err.x_error_rate = x_error_rate;
   memory_err.y_error_rate = y_error_rate;
   memory_err.z_error_rate = z_error_rate;
   memory_err.excitation_error_rate = excitation_rate;
   memory_err.relaxation_error_rate = relaxation_rate;
-  double error_rate = x_error_rate + y_error_rate + z_error_rate + excitation_rate + relaxation_rate;  // This is per μs.
-  memory_err.error_rate = error_rate;
-  // clang-format off
-  memory_transition_matrix <<
-    1 - error_rate,  x_error_rate,   z_error_rate,   y_error_rate,   excitation_rate,     relaxation_rate,
-    x_error_rate,    1 - error_rate, y_error_rate,   z_error_rate,   excitation_rate,     relaxation_rate,
-    z_error_rate,    y_error_rate,   1 - error_rate, x_error_rate,   excitation_rate,     relaxation_rate,
-    y_error_rate,    z_error_rate,   x_error_rate,   1 - error_rate, excitation_rate,     relaxation_rate,
-    0,               0,              0,              0,              1 - relaxation_rate, relaxation_rate,
-    0,               0,              0,              0,              excitation_rate,     1 - excitation_rate;
-  // clang-format on
+  memory_err.error_rate = x_error_rate + y_error_rate + z_error_rate + excitation_rate + relaxation_rate;  // This is per μs.
+  memory_transition = backend->getMemoryTransition(MemoryTransition::transitionMatrix(x_error_rate, y_error_rate, z_error_rate, excitation_rate, relaxation_rate));
 }
 
 void GraphStateQubit::applySingleQubitGateError(SingleGateErrorModel const &err) {
@@ -60,11 +171,7 @@ void GraphStateQubit::applySingleQubitGateError(SingleGateErrorModel const &err)
   }
 
   enum class ErrorLabel : int { NO_ERR, X, Z, Y };
-  std::map<ErrorLabel, double> weights = {
-      {ErrorLabel::NO_ERR, 1 - err.pauli_error_rate}, {ErrorLabel::X, err.x_error_rate}, {ErrorLabel::Z, err.z_error_rate}, {ErrorLabel::Y, err.y_error_rate}};
-
-  double rand = backend->dblrand();
-  ErrorLabel r = samplingWithWeights(weights, rand);
+  ErrorLabel r = static_cast<ErrorLabel>(err.distribution.sample(backend->dblrand()));
 
   switch (r) {
     case ErrorLabel::NO_ERR:
@@ -87,26 +194,7 @@ void GraphStateQubit::applyTwoQubitGateError(TwoQubitGateErrorModel const &err,
   }
 
   enum class ErrorLabel : int { NO_ERR, IX, IY, IZ, XI, XX, XY, XZ, YI, YX, YY, YZ, ZI, ZX, ZY, ZZ };
-  std::map<ErrorLabel, double> weights{
-      {ErrorLabel::NO_ERR, 1 - err.pauli_error_rate},
-      {ErrorLabel::IX, err.ix_error_rate},
-      {ErrorLabel::IY, err.iy_error_rate},
-      {ErrorLabel::IZ, err.iz_error_rate},
-      {ErrorLabel::XI, err.zi_error_rate},
-      {ErrorLabel::XX, err.xx_error_rate},
-      {ErrorLabel::XY, err.xy_error_rate},
-      {ErrorLabel::XZ, err.xz_error_rate},
-      {ErrorLabel::YI, err.yi_error_rate},
-      {ErrorLabel::YX, err.yx_error_rate},
-      {ErrorLabel::YY, err.yy_error_rate},
-      {ErrorLabel::YZ, err.yz_error_rate},
-      {ErrorLabel::ZI, err.zi_error_rate},
-      {ErrorLabel::ZX, err.zx_error_rate},
-      {ErrorLabel::ZY, err.zy_error_rate},
-      {ErrorLabel::ZZ, err.zz_error_rate},
-  };
-  double rand = backend->dblrand();
-  ErrorLabel r = samplingWithWeights(weights, rand);
+  ErrorLabel r = static_cast<ErrorLabel>(err.distribution.sample(backend->dblrand()));
 
   switch (r) {
     case ErrorLabel::NO_ERR:
@@ -168,57 +256,64 @@ void GraphStateQubit::applyTwoQubitGateError(TwoQubitGateErrorModel const &err,
   }
 }
 
+std::pair<CliffordOperator, CliffordOperator> GraphStateQubit::sampleTwoQubitGateError(TwoQubitGateErrorModel const &err) {
+  if (err.pauli_error_rate == 0) return {CliffordOperator::Id, CliffordOperator::Id};
+  // same labels as applyTwoQubitGateError: 4 * (Pauli on this qubit) + (Pauli on the other), both in the order I, X, Y, Z
+  constexpr CliffordOperator paulis[4] = {CliffordOperator::Id, CliffordOperator::X, CliffordOperator::Y, CliffordOperator::Z};
+  auto label = err.distribution.sample(backend->dblrand());
+  return {paulis[label / 4], paulis[label % 4]};
+}
+
 void GraphStateQubit::applyMemoryError() {
   // If no memory error occurs, skip this memory error simulation.
   if (memory_err.error_rate == 0) return;
+  applyMemoryErrorUntil(backend->getSimTime());
+}
+
+bool GraphStateQubit::memoryErrorCommutesWithCliffords() const {
+  // the depolarizing channel is invariant under the Clifford conjugation, and Pauli channels commute with each other
+  return memory_err.x_error_rate == memory_err.y_error_rate && memory_err.y_error_rate == memory_err.z_error_rate && memory_err.excitation_error_rate == 0 &&
+         memory_err.relaxation_error_rate == 0;
+}
+
+void GraphStateQubit::applyMemoryErrorBeforeSingleQubitGate() {
+  if (memory_err.error_rate == 0) return;
+  if (backend->isLazyMemoryError() && memoryErrorCommutesWithCliffords()) {
+    // the error over [updated_time, now] is the same after the gate, so it's sampled together with the following idle time
+    deferred_until = backend->getSimTime();
+    return;
+  }
+  applyMemoryErrorUntil(backend->getSimTime());
+}
 
-  SimTime current_time = backend->getSimTime();
+void GraphStateQubit::applyDeferredMemoryError() {
+  // the noiseless operations don't sample the memory error, so only the part the gates deferred is applied here
+  if (deferred_until > updated_time) applyMemoryErrorUntil(deferred_until);
+}
 
+void GraphStateQubit::applyMemoryErrorUntil(SimTime current_time) {
   // Check when the error got updated last time.
   // Errors will be performed depending on the difference between that time and the current time.
   double time_evolution = current_time.dbl() - updated_time.dbl();
   double time_evolution_microsec = time_evolution * 1000000 /** 100*/;
   if (time_evolution_microsec > 0) {
-    bool skip_exponentiation = false;
-    for (int i = 0; i < memory_transition_matrix.cols(); i++) {
-      if (memory_transition_matrix(0, i) == 1) {
-        // Do not to the exponentiation! Eigen will mess up the exponentiation anyway...
-        skip_exponentiation = true;
-        break;
-      }
-    }
-
-    MatrixXd transition_mat(6, 6);
-    if (!skip_exponentiation) {
-      // calculate time evoluted error matrix: Q^(time_evolution_microsec) in Eq 5.3
-      MatrixPower<MatrixXd> q_pow(memory_transition_matrix);
-      transition_mat = q_pow(time_evolution_microsec);
-    } else {
-      transition_mat = memory_transition_matrix;
-    }
+    // pi(t) in Eq 5.3
+    // Clean, X, Z, Y, Excited, Relaxed
+    // take error rate vector from DynamicTransitionMatrix Eq 5.3
+    RowVector6d pi_vector = memory_transition->errorDistribution(time_evolution_microsec);
 
-    // validate transition_mat
-    for (int r = 0; r < transition_mat.rows(); r++) {
-      double col_sum = 0;
-      for (int i = 0; i < transition_mat.cols(); i++) {
-        col_sum += transition_mat(r, i);
-      }
-      if (col_sum > 1.01 || col_sum < 0.99) {
+    // validate pi_vector
+    if (utils::validates(utils::ValidationLevel::Full)) {
+      double sum = pi_vector.sum();
+      if (sum > 1.01 || sum < 0.99) {
         throw std::runtime_error("Row of the transition matrix does not sum up to 1.");
       }
-    }
 
-    if (std::isnan(transition_mat(0, 0))) {
-      throw std::runtime_error("Transition matrix is NaN. This is Eigen's fault.");
+      if (std::isnan(pi_vector(0, 0))) {
+        throw std::runtime_error("Transition matrix is NaN. This is Eigen's fault.");
+      }
     }
 
-    MatrixXd pi_vector(1, 6);
-    pi_vector << 1, 0, 0, 0, 0, 0;
-    // pi(t) in Eq 5.3
-    // Clean, X, Z, Y, Excited, Relaxed
-    // take error rate vector from DynamicTransitionMatrix Eq 5.3
-    pi_vector = pi_vector * transition_mat;
-
     enum class ErrorLabel { NO_ERR, X, Z, Y, Excitation, Relaxation };
     std::map<ErrorLabel, double> weights = {{ErrorLabel::NO_ERR, pi_vector(0, 0)}, {ErrorLabel::X, pi_vector(0, 1)},          {ErrorLabel::Z, pi_vector(0, 2)},
                                             {ErrorLabel::Y, pi_vector(0, 3)},      {ErrorLabel::Excitation, pi_vector(0, 4)}, {ErrorLabel::Relaxation, pi_vector(0, 5)}};
@@ -274,17 +369,23 @@ void GraphStateQubit::applyClifford(CliffordOperator op) { this->vertex_operator
 
 void GraphStateQubit::applyRightClifford(CliffordOperator op) { this->vertex_operator = clifford_application_lookup[(int)(this->vertex_operator)][(int)op]; }
 
-bool GraphStateQubit::isNeighbor(GraphStateQubit *another_qubit) { return this->neighbors.find(another_qubit) != this->neighbors.end(); }
+bool GraphStateQubit::isNeighbor(GraphStateQubit *another_qubit) { return this->neighbors.contains(another_qubit); }
 
 void GraphStateQubit::addEdge(GraphStateQubit *another_qubit) {
   if (another_qubit == this) throw std::runtime_error("adding edge to self is not allowed");
   this->neighbors.insert(another_qubit);
   another_qubit->neighbors.insert(this);
+  backend->joinComponents(this, another_qubit);
+  backend->touchEdges(this);
+  backend->touchEdges(another_qubit);
 }
 
 void GraphStateQubit::deleteEdge(GraphStateQubit *another_qubit) {
   this->neighbors.erase(another_qubit);
   another_qubit->neighbors.erase(this);
+  backend->splitComponent(this);
+  backend->touchEdges(this);
+  backend->touchEdges(another_qubit);
 }
 
 void GraphStateQubit::toggleEdge(GraphStateQubit *another_qubit) {
@@ -296,23 +397,66 @@ void GraphStateQubit::toggleEdge(GraphStateQubit *another_qubit) {
 }
 
 void GraphStateQubit::removeAllEdges() {
+  if (neighbors.empty()) return;
   for (auto *v : neighbors) {
     v->neighbors.erase(this);
+    backend->touchEdges(v);
   }
   this->neighbors.clear();
+  backend->splitComponent(this);
+  backend->touchEdges(this);
 }
 
 void GraphStateQubit::localComplement() {
+  if (auto *pool = backend == nullptr ? nullptr : backend->getLocalComplementPool(this->neighbors.size()); pool != nullptr) {
+    return localComplementParallel(*pool);
+  }
   // this should work and not interfere with iterating orders
+  // the neighbors stay connected through this qubit, so the component is unchanged and the edges are toggled directly.
   auto it_end = this->neighbors.end();
   for (auto it_u = this->neighbors.begin(); it_u != it_end; it_u++) {
     auto it_v = std::next(it_u);
     for (; it_v != it_end; it_v++) {
-      (*it_u)->toggleEdge(*it_v);
+      auto *u = *it_u;
+      auto *v = *it_v;
+      if (u->isNeighbor(v)) {
+        u->neighbors.erase(v);
+        v->neighbors.erase(u);
+      } else {
+        u->neighbors.insert(v);
+        v->neighbors.insert(u);
+      }
     }
   }
   for (auto *v : this->neighbors) {
     v->applyRightClifford(CliffordOperator::S);
+    if (backend != nullptr) backend->touchEdges(v);
+  }
+  this->applyRightClifford(CliffordOperator::RX_INV);
+}
+
+void GraphStateQubit::localComplementParallel(utils::ThreadPool &pool) {
+  // the complementation replaces N(u) with N(u) xor (N(this) - {u}) for every neighbor u.
+  // each u only reads N(this), which doesn't change, and its own set, so the neighbors are updated independently.
+  std::vector<GraphStateQubit *> center_neighbors(this->neighbors.begin(), this->neighbors.end());
+  auto num_neighbors = center_neighbors.size();
+  auto num_chunks = std::min<std::size_t>(num_neighbors, pool.size() * 4);
+  pool.parallelFor(num_chunks, [&](std::size_t chunk) {
+    std::vector<GraphStateQubit *> toggled;
+    for (auto i = chunk * num_neighbors / num_chunks; i < (chunk + 1) * num_neighbors / num_chunks; i++) {
+      auto *u = center_neighbors[i];
+      toggled.clear();
+      toggled.reserve(u->neighbors.size() + num_neighbors);
+      std::set_symmetric_difference(u->neighbors.begin(), u->neighbors.end(), center_neighbors.begin(), center_neighbors.end(), std::back_inserter(toggled),
+                                    std::less<GraphStateQubit *>());
+      // u is in N(this) but never its own neighbor
+      toggled.erase(std::lower_bound(toggled.begin(), toggled.end(), u, std::less<GraphStateQubit *>()));
+      u->neighbors.assignSorted(toggled.begin(), toggled.end());
+    }
+  });
+  for (auto *v : this->neighbors) {
+    v->applyRightClifford(CliffordOperator::S);
+    backend->touchEdges(v);
   }
   this->applyRightClifford(CliffordOperator::RX_INV);
 }
@@ -329,12 +473,11 @@ void GraphStateQubit::removeVertexOperation(GraphStateQubit *qubit_to_avoid) {
     }
   }
   auto swapping_partner = swapping_partner_temp;
-  std::string decomposition_string = decomposition_table[(int)this->vertex_operator];
-  for (int i = decomposition_string.size() - 1; i >= 0; i--) {
-    if (decomposition_string[i] == 'V') {
+  auto decomposition = decomposition_table[(int)this->vertex_operator];
+  for (int i = decomposition.length - 1; i >= 0; i--) {
+    if (decomposition.ops & (1 << i)) {
       this->localComplement();
     } else {
-      // 'U'
       swapping_partner->localComplement();
     }
   }
@@ -418,6 +561,7 @@ EigenvalueResult GraphStateQubit::graphMeasureZ(const EigenvalueResult eigenvalu
 // public member functions
 
 void GraphStateQubit::setFree() {
+  TraceScope trace(backend, TraceOp::SetFree, this);
   // force qubit to be in |0> state
   this->graphMeasureZ();
   this->vertex_operator = CliffordOperator::H;
@@ -425,6 +569,7 @@ void GraphStateQubit::setFree() {
 }
 
 void GraphStateQubit::gateCNOT(IQubit *const target_qubit) {
+  TraceScope trace(backend, TraceOp::CNOT, this, target_qubit);
   auto gs_target_qubit = dynamic_cast<GraphStateQubit *>(target_qubit);
   this->applyMemoryError();
   gs_target_qubit->applyMemoryError();
@@ -435,40 +580,47 @@ void GraphStateQubit::gateCNOT(IQubit *const target_qubit) {
 }
 
 void GraphStateQubit::gateH() {
-  this->applyMemoryError();
+  TraceScope trace(backend, TraceOp::H, this);
+  this->applyMemoryErrorBeforeSingleQubitGate();
   this->applyClifford(CliffordOperator::H);
   this->applySingleQubitGateError(gate_err_h);
 }
 void GraphStateQubit::gateZ() {
-  this->applyMemoryError();
+  TraceScope trace(backend, TraceOp::Z, this);
+  this->applyMemoryErrorBeforeSingleQubitGate();
   this->applyClifford(CliffordOperator::Z);
   this->applySingleQubitGateError(gate_err_z);
 }
 void GraphStateQubit::gateX() {
-  this->applyMemoryError();
+  TraceScope trace(backend, TraceOp::X, this);
+  this->applyMemoryErrorBeforeSingleQubitGate();
   this->applyClifford(CliffordOperator::X);
   this->applySingleQubitGateError(gate_err_x);
 }
 void GraphStateQubit::gateY() {
-  this->applyMemoryError();
+  TraceScope trace(backend, TraceOp::Y, this);
+  this->applyMemoryErrorBeforeSingleQubitGate();
   this->applyClifford(CliffordOperator::Y);
   // TODO: add single qubit error gate for Y?
   this->applySingleQubitGateError(gate_err_x);
 }
 void GraphStateQubit::gateS() {
-  this->applyMemoryError();
+  TraceScope trace(backend, TraceOp::S, this);
+  this->applyMemoryErrorBeforeSingleQubitGate();
   this->applyClifford(CliffordOperator::S);
   // apply s error, not implemented yet
   // or do we need to expose this gate to stat qubit?
 }
 void GraphStateQubit::gateSdg() {
-  this->applyMemoryError();
+  TraceScope trace(backend, TraceOp::Sdg, this);
+  this->applyMemoryErrorBeforeSingleQubitGate();
   this->applyClifford(CliffordOperator::S_INV);
   // apply sdg error, not implemented yet
   // or do we need to expose this gate to stat qubit?
 }
 
 EigenvalueResult GraphStateQubit::measureX() {
+  TraceScope trace(backend, TraceOp::MeasureX, this);
   applyMemoryError();
   this->applyClifford(CliffordOperator::H);
   auto result = this->graphMeasureZ();
@@ -480,6 +632,7 @@ EigenvalueResult GraphStateQubit::measureX() {
 }
 
 EigenvalueResult GraphStateQubit::measureY() {
+  TraceScope trace(backend, TraceOp::MeasureY, this);
   applyMemoryError();
   this->applyClifford(CliffordOperator::S_INV);
   this->applyClifford(CliffordOperator::H);
@@ -492,6 +645,7 @@ EigenvalueResult GraphStateQubit::measureY() {
 }
 
 EigenvalueResult GraphStateQubit::measureZ() {
+  TraceScope trace(backend, TraceOp::MeasureZ, this);
   applyMemoryError();
   auto result = this->graphMeasureZ();
   // measurement error
@@ -501,26 +655,204 @@ EigenvalueResult GraphStateQubit::measureZ() {
   return result;
 }
 
-void GraphStateQubit::noiselessX() { applyClifford(CliffordOperator::X); }
-void GraphStateQubit::noiselessZ() { applyClifford(CliffordOperator::Z); }
-void GraphStateQubit::noiselessH() { applyClifford(CliffordOperator::H); }
+BellMeasurementResult GraphStateQubit::bellMeasure(IQubit *const target_qubit) {
+  TraceScope trace(backend, TraceOp::BellMeasure, this, target_qubit);
+  auto gs_target_qubit = static_cast<GraphStateQubit *>(target_qubit);
+  this->applyMemoryError();
+  gs_target_qubit->applyMemoryError();
+  gs_target_qubit->noiselessH();
+  this->applyPureCZ(gs_target_qubit);
+  gs_target_qubit->noiselessH();
+  // the target first: its measurement removes the edge between the two, so the control has one neighbor less to complement
+  auto z_result = gs_target_qubit->graphMeasureZ();
+  this->applyClifford(CliffordOperator::H);
+  auto x_result = this->graphMeasureZ();
+
+  // both qubits are measured right after the gate, so the gate error only flips the outcomes:
+  // X or Y on the target flips its Z outcome, Z or Y on the control flips its X outcome
+  auto [control_error, target_error] = sampleTwoQubitGateError(gate_err_cnot);
+  bool x_flipped = control_error == CliffordOperator::Z || control_error == CliffordOperator::Y;
+  bool z_flipped = target_error == CliffordOperator::X || target_error == CliffordOperator::Y;
+  // measurement error
+  if (measurement_err.x_error_rate > 0 && backend->dblrand() < measurement_err.x_error_rate) x_flipped = !x_flipped;
+  if (gs_target_qubit->measurement_err.z_error_rate > 0 && backend->dblrand() < gs_target_qubit->measurement_err.z_error_rate) z_flipped = !z_flipped;
+
+  auto flip = [](EigenvalueResult result) { return result == EigenvalueResult::PLUS_ONE ? EigenvalueResult::MINUS_ONE : EigenvalueResult::PLUS_ONE; };
+  return BellMeasurementResult{x_flipped ? flip(x_result) : x_result, z_flipped ? flip(z_result) : z_result};
+}
+
+EigenvalueResult GraphStateQubit::purify(IQubit *const trash_qubit, PurificationBasis basis) {
+  TraceScope trace(backend, TraceOp::Purify, this, trash_qubit, static_cast<std::uint8_t>(basis));
+  auto gs_trash_qubit = static_cast<GraphStateQubit *>(trash_qubit);
+  this->applyMemoryError();
+  gs_trash_qubit->applyMemoryError();
+
+  EigenvalueResult result;
+  bool flipped;
+  if (basis == PurificationBasis::X) {
+    // CNOT from this qubit to the trash, Z measurement of the trash. X or Y on the trash only flips the outcome
+    gs_trash_qubit->noiselessH();
+    this->applyPureCZ(gs_trash_qubit);
+    gs_trash_qubit->noiselessH();
+    auto [control_error, target_error] = sampleTwoQubitGateError(gate_err_cnot);
+    if (control_error != CliffordOperator::Id) this->applyClifford(control_error);
+    result = gs_trash_qubit->graphMeasureZ();
+    flipped = target_error == CliffordOperator::X || target_error == CliffordOperator::Y;
+    if (gs_trash_qubit->measurement_err.z_error_rate > 0 && backend->dblrand() < gs_trash_qubit->measurement_err.z_error_rate) flipped = !flipped;
+  } else {
+    // CNOT from the trash to this qubit, X measurement of the trash. Z or Y on the trash only flips the outcome
+    // the Y purification is the same between Sdg on both qubits and S on this one
+    if (basis == PurificationBasis::Y) {
+      gs_trash_qubit->applyClifford(CliffordOperator::S_INV);
+      this->applyClifford(CliffordOperator::S_INV);
+    }
+    this->noiselessH();
+    gs_trash_qubit->applyPureCZ(this);
+    this->noiselessH();
+    auto [control_error, target_error] = gs_trash_qubit->sampleTwoQubitGateError(gs_trash_qubit->gate_err_cnot);
+    if (target_error != CliffordOperator::Id) this->applyClifford(target_error);
+    if (basis == PurificationBasis::Y) this->applyClifford(CliffordOperator::S);
+    gs_trash_qubit->applyClifford(CliffordOperator::H);
+    result = gs_trash_qubit->graphMeasureZ();
+    flipped = control_error == CliffordOperator::Z || control_error == CliffordOperator::Y;
+    if (gs_trash_qubit->measurement_err.x_error_rate > 0 && backend->dblrand() < gs_trash_qubit->measurement_err.x_error_rate) flipped = !flipped;
+  }
+  if (!flipped) return result;
+  return result == EigenvalueResult::PLUS_ONE ? EigenvalueResult::MINUS_ONE : EigenvalueResult::PLUS_ONE;
+}
+
+double GraphStateQubit::bellPairFidelity(GraphStateQubit *another_qubit) {
+  if (another_qubit == this) throw std::runtime_error("bellPairFidelity: the qubits of a pair must differ");
+  // the reduced state of a graph state is the sum of its stabilizers that act only on the pair, over 4.
+  // the stabilizer with the X part on a set of the pair qualifies if the Z parts of the others cancel out
+  auto only_partner = [](GraphStateQubit *qubit, GraphStateQubit *partner) { return qubit->neighbors.size() == (qubit->isNeighbor(partner) ? 1 : 0); };
+  auto same_outer_neighbors = [&]() {
+    auto outer_size = [&](GraphStateQubit *qubit, GraphStateQubit *partner) { return qubit->neighbors.size() - (qubit->isNeighbor(partner) ? 1 : 0); };
+    if (outer_size(this, another_qubit) != outer_size(another_qubit, this)) return false;
+    for (auto *v : neighbors) {
+      if (v != another_qubit && !another_qubit->isNeighbor(v)) return false;
+    }
+    return true;
+  };
+  Matrix2cd x, z, id = Matrix2cd::Identity();
+  x << 0, 1, 1, 0;
+  z << 1, 0, 0, -1;
+  bool has_edge = isNeighbor(another_qubit);
+  Matrix4cd stabilizer_first = kron(x, has_edge ? z : id);
+  Matrix4cd stabilizer_second = kron(has_edge ? z : id, x);
+  Matrix4cd rho = Matrix4cd::Identity();
+  if (only_partner(this, another_qubit)) rho += stabilizer_first;
+  if (only_partner(another_qubit, this)) rho += stabilizer_second;
+  if (same_outer_neighbors()) rho += stabilizer_first * stabilizer_second;
+  rho /= 4;
+
+  auto &cliffords = cliffordMatrices();
+  Matrix4cd vertex_operators = kron(cliffords[(int)vertex_operator], cliffords[(int)another_qubit->vertex_operator]);
+  rho = vertex_operators * rho * vertex_operators.adjoint();
+
+  // the memory error since the last update of each qubit, without drawing random numbers
+  auto now = backend->getSimTime();
+  for (auto [qubit, on_first] : {std::pair{this, true}, std::pair{another_qubit, false}}) {
+    double time_evolution_microsec = (now.dbl() - qubit->updated_time.dbl()) * 1000000;
+    if (qubit->memory_err.error_rate == 0 || qubit->memory_transition == nullptr || time_evolution_microsec <= 0) continue;
+    applyMemoryChannel(rho, on_first, qubit->memory_transition->errorDistribution(time_evolution_microsec));
+  }
+
+  // fidelity with (|00> + |11>) / sqrt(2)
+  return (rho(0, 0) + rho(0, 3) + rho(3, 0) + rho(3, 3)).real() / 2;
+}
+
+void GraphStateQubit::noiselessX() {
+  TraceScope trace(backend, TraceOp::NoiselessX, this);
+  applyClifford(CliffordOperator::X);
+}
+void GraphStateQubit::noiselessZ() {
+  TraceScope trace(backend, TraceOp::NoiselessZ, this);
+  applyClifford(CliffordOperator::Z);
+}
+void GraphStateQubit::noiselessH() {
+  TraceScope trace(backend, TraceOp::NoiselessH, this);
+  applyClifford(CliffordOperator::H);
+}
 void GraphStateQubit::noiselessCNOT(IQubit *const target_qubit) {
+  TraceScope trace(backend, TraceOp::NoiselessCNOT, this, target_qubit);
   auto gs_target_qubit = static_cast<GraphStateQubit *>(target_qubit);
+  applyDeferredMemoryError();
+  gs_target_qubit->applyDeferredMemoryError();
   gs_target_qubit->noiselessH();
   applyPureCZ(gs_target_qubit);
   gs_target_qubit->noiselessH();
 }
-EigenvalueResult GraphStateQubit::noiselessMeasureZ() { return graphMeasureZ(); }
+EigenvalueResult GraphStateQubit::noiselessMeasureZ() {
+  TraceScope trace(backend, TraceOp::NoiselessMeasureZ, this);
+  applyDeferredMemoryError();
+  return graphMeasureZ();
+}
 EigenvalueResult GraphStateQubit::noiselessMeasureX() {
+  TraceScope trace(backend, TraceOp::NoiselessMeasureX, this);
+  applyDeferredMemoryError();
   applyClifford(CliffordOperator::H);
   return graphMeasureZ();
 }
-EigenvalueResult GraphStateQubit::noiselessMeasureZ(EigenvalueResult eigenvalue) { return graphMeasureZ(eigenvalue); }
+EigenvalueResult GraphStateQubit::noiselessMeasureZ(EigenvalueResult eigenvalue) {
+  TraceScope trace(backend, TraceOp::NoiselessMeasureZForced, this, nullptr, static_cast<std::uint8_t>(eigenvalue));
+  applyDeferredMemoryError();
+  return graphMeasureZ(eigenvalue);
+}
 EigenvalueResult GraphStateQubit::noiselessMeasureX(EigenvalueResult eigenvalue) {
+  TraceScope trace(backend, TraceOp::NoiselessMeasureXForced, this, nullptr, static_cast<std::uint8_t>(eigenvalue));
+  applyDeferredMemoryError();
   applyClifford(CliffordOperator::H);
   return graphMeasureZ(eigenvalue);
 }
 
+void NoiselessGraphStateQubit::gateX() {
+  TraceScope trace(backend, TraceOp::X, this);
+  applyClifford(CliffordOperator::X);
+}
+void NoiselessGraphStateQubit::gateZ() {
+  TraceScope trace(backend, TraceOp::Z, this);
+  applyClifford(CliffordOperator::Z);
+}
+void NoiselessGraphStateQubit::gateY() {
+  TraceScope trace(backend, TraceOp::Y, this);
+  applyClifford(CliffordOperator::Y);
+}
+void NoiselessGraphStateQubit::gateH() {
+  TraceScope trace(backend, TraceOp::H, this);
+  applyClifford(CliffordOperator::H);
+}
+void NoiselessGraphStateQubit::gateS() {
+  TraceScope trace(backend, TraceOp::S, this);
+  applyClifford(CliffordOperator::S);
+}
+void NoiselessGraphStateQubit::gateSdg() {
+  TraceScope trace(backend, TraceOp::Sdg, this);
+  applyClifford(CliffordOperator::S_INV);
+}
+void NoiselessGraphStateQubit::gateCNOT(IQubit *const target_qubit) {
+  TraceScope trace(backend, TraceOp::CNOT, this, target_qubit);
+  auto gs_target_qubit = static_cast<GraphStateQubit *>(target_qubit);
+  // the target may still have its own memory error
+  gs_target_qubit->applyMemoryError();
+  noiselessCNOT(target_qubit);
+}
+EigenvalueResult NoiselessGraphStateQubit::measureX() {
+  TraceScope trace(backend, TraceOp::MeasureX, this);
+  applyClifford(CliffordOperator::H);
+  return graphMeasureZ();
+}
+EigenvalueResult NoiselessGraphStateQubit::measureY() {
+  TraceScope trace(backend, TraceOp::MeasureY, this);
+  applyClifford(CliffordOperator::S_INV);
+  applyClifford(CliffordOperator::H);
+  return graphMeasureZ();
+}
+EigenvalueResult NoiselessGraphStateQubit::measureZ() {
+  TraceScope trace(backend, TraceOp::MeasureZ, this);
+  return graphMeasureZ();
+}
+
 // map clifford operator to string
 std::string GraphStateQubit::cliffordToString(CliffordOperator op) {
   switch (op) {
@@ -575,24 +907,4 @@ std::string GraphStateQubit::cliffordToString(CliffordOperator op) {
   }
 }
 
-// initialize static variables
-CliffordOperator GraphStateQubit::clifford_application_lookup[24][24] =
-#include "clifford_application_lookup.tbl"
-    ;
-
-bool GraphStateQubit::controlled_z_lookup_edge[2][24][24] =
-#include "cz_lookup_edge.tbl"
-    ;
-
-CliffordOperator GraphStateQubit::controlled_z_lookup_node_1[2][24][24] =
-#include "cz_lookup_node_1.tbl"
-    ;
-
-CliffordOperator GraphStateQubit::controlled_z_lookup_node_2[2][24][24] =
-#include "cz_lookup_node_2.tbl"
-    ;
-
-std::string GraphStateQubit::decomposition_table[24] = {
-    "", "VV", "UUVV", "UU", "VVV", "V", "VUU", "UUV", "UVUUU", "UUUVU", "UVVVU", "UVU", "U", "UUU", "VVU", "UVV", "UVVV", "UV", "UVUU", "UUUV", "VVVU", "VU", "VUUU", "UUVU",
-};
 }  // namespace quisp::backends::graph_state
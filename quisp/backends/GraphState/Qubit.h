@@ -1,14 +1,17 @@
 #pragma once
 #include <string>
-#include <unordered_set>
+#include <utility>
 #include <unsupported/Eigen/MatrixFunctions>
 #include "../interfaces/IQuantumBackend.h"
 #include "../interfaces/IQubit.h"
 #include "Eigen/src/Core/Matrix.h"
+#include "MemoryTransition.h"
+#include "NeighborSet.h"
 #include "backends/QubitConfiguration.h"
 #include "backends/interfaces/IQubitId.h"
 #include "omnetpp/simtime.h"
 #include "types.h"
+#include "utils/ThreadPool.h"
 #include "utils/UtilFunctions.h"
 #include "vector"
 
@@ -16,6 +19,7 @@ namespace quisp {
 using util_functions::samplingWithWeights;
 namespace backends::graph_state {
 
+using abstract::BellMeasurementResult;
 using abstract::EigenvalueResult;
 using abstract::IQuantumBackend;
 using abstract::IQubit;
@@ -24,6 +28,7 @@ using abstract::MeasurementOutcome;
 using abstract::MeasureXResult;
 using abstract::MeasureYResult;
 using abstract::MeasureZResult;
+using abstract::PurificationBasis;
 using abstract::SimTime;
 using Eigen::Matrix;
 using Eigen::MatrixPower;
@@ -35,13 +40,35 @@ using types::SingleGateErrorModel;
 using types::TwoQubitGateErrorModel;
 
 class GraphStateBackend;
+class NoiselessGraphStateQubit;
+
+/**
+ * @brief the error models of a StationaryQubitConfiguration.
+ *
+ * GraphStateBackend builds them once per distinct configuration, and the qubits configured with it copy them.
+ */
+struct GraphStateErrorModels {
+  SingleGateErrorModel gate_err_h;
+  SingleGateErrorModel gate_err_x;
+  SingleGateErrorModel gate_err_z;
+  TwoQubitGateErrorModel gate_err_cnot;
+  MeasurementErrorModel measurement_err;
+  MemoryErrorModel memory_err;
+  Matrix6d memory_transition_matrix;
+  std::shared_ptr<const MemoryTransition> memory_transition;
+};
+
 class GraphStateQubit : public IQubit {
+  friend class GraphStateBackend;
+  friend class NoiselessGraphStateQubit;
+
  public:
   GraphStateQubit(const IQubitId *id, GraphStateBackend *const backend, bool is_short_live);
   ~GraphStateQubit();
   void configure(std::unique_ptr<StationaryQubitConfiguration> configuration);
   void setFree() override;
   const IQubitId *const getId() const override;
+  bool isShortLive() const { return is_short_live; }
   void relaseBackToPool() override;
 
   void gateX() override;
@@ -54,6 +81,8 @@ class GraphStateQubit : public IQubit {
   EigenvalueResult measureX() override;
   EigenvalueResult measureY() override;
   EigenvalueResult measureZ() override;
+  BellMeasurementResult bellMeasure(IQubit *const target_qubit) override;
+  EigenvalueResult purify(IQubit *const trash_qubit, PurificationBasis basis) override;
 
   void noiselessH() override;
   void noiselessX() override;
@@ -66,10 +95,22 @@ class GraphStateQubit : public IQubit {
 
  protected:
   // error simulation
+  void setErrorModels(const GraphStateErrorModels &models);
   void setMemoryErrorRates(double x_error_rate, double y_error_rate, double z_error_rate, double excitation_rate, double relaxation_rate);
   void applySingleQubitGateError(SingleGateErrorModel const &err);
   void applyTwoQubitGateError(TwoQubitGateErrorModel const &err, GraphStateQubit *another_qubit);
+  // the Paulis of the error on this qubit and on the other one, for the gates fused with a measurement
+  std::pair<CliffordOperator, CliffordOperator> sampleTwoQubitGateError(TwoQubitGateErrorModel const &err);
   void applyMemoryError();
+  /**
+   * @brief the memory error before a single qubit gate.
+   * With the lazy memory error of the backend and a depolarizing memory channel, the elapsed time is left to the next
+   * measurement or two qubit gate instead, which samples the same distribution with one random number.
+   */
+  void applyMemoryErrorBeforeSingleQubitGate();
+  bool memoryErrorCommutesWithCliffords() const;
+  void applyDeferredMemoryError();
+  void applyMemoryErrorUntil(SimTime time);
   void excite();
   void relax();
 
@@ -80,7 +121,14 @@ class GraphStateQubit : public IQubit {
   TwoQubitGateErrorModel gate_err_cnot;
   MeasurementErrorModel measurement_err;
   MemoryErrorModel memory_err;
-  Eigen::MatrixXd memory_transition_matrix; /*I,X,Y,Z,Ex,Rl for single qubit. Unit in μs.*/
+  // shared among qubits with the same memory error rates, its transition matrix is I,X,Y,Z,Ex,Rl for single qubit. Unit in μs.
+  std::shared_ptr<const MemoryTransition> memory_transition;
+
+  /**
+   * @brief the fidelity of this qubit and the other one to the Bell state (|00> + |11>) / sqrt(2), read off the graph.
+   * The pending memory error until now is averaged over its distribution, so the trajectory doesn't change.
+   */
+  double bellPairFidelity(GraphStateQubit *another_qubit);
 
   // graph state specific operations
   void applyClifford(CliffordOperator op);
@@ -91,24 +139,20 @@ class GraphStateQubit : public IQubit {
   void toggleEdge(GraphStateQubit *another_qubit);
   void removeAllEdges();
   void localComplement();
+  void localComplementParallel(utils::ThreadPool &pool);
   void removeVertexOperation(GraphStateQubit *qubit_to_avoid);
   void applyPureCZ(GraphStateQubit *another_qubit);
   EigenvalueResult graphMeasureZ();
   EigenvalueResult graphMeasureZ(EigenvalueResult eigenvalue);
 
   SimTime updated_time = SimTime(0);
+  // the last gate that deferred its memory error, see applyMemoryErrorBeforeSingleQubitGate
+  SimTime deferred_until = SimTime(0);
 
   // graph state
-  std::unordered_set<GraphStateQubit *> neighbors;
+  NeighborSet<GraphStateQubit> neighbors;
   CliffordOperator vertex_operator;
 
-  // graph state tables
-  static std::string decomposition_table[24];
-  static CliffordOperator clifford_application_lookup[24][24];
-  static bool controlled_z_lookup_edge[2][24][24];
-  static CliffordOperator controlled_z_lookup_node_1[2][24][24];
-  static CliffordOperator controlled_z_lookup_node_2[2][24][24];
-
   const IQubitId *id;
   GraphStateBackend *const backend;
   const bool is_short_live;
@@ -117,5 +161,28 @@ class GraphStateQubit : public IQubit {
   std::string cliffordToString(CliffordOperator op);
 };
 
+/**
+ * @brief GraphStateQubit for configurations without any error.
+ *
+ * GraphStateBackend creates this instead of GraphStateQubit when StationaryQubitConfiguration::isNoiseless() holds,
+ * so gates and measurements go straight to the graph operations without memory error updates, error sampling or random numbers.
+ * It shares the arena with GraphStateQubit and therefore must not add data members.
+ */
+class NoiselessGraphStateQubit final : public GraphStateQubit {
+ public:
+  using GraphStateQubit::GraphStateQubit;
+
+  void gateX() override;
+  void gateZ() override;
+  void gateY() override;
+  void gateH() override;
+  void gateS() override;
+  void gateSdg() override;
+  void gateCNOT(IQubit *const target_qubit) override;
+  EigenvalueResult measureX() override;
+  EigenvalueResult measureY() override;
+  EigenvalueResult measureZ() override;
+};
+
 }  // namespace backends::graph_state
 }  // namespace quisp
@@ -0,0 +1,102 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace quisp::backends::graph_state {
+
+/**
+ * @brief slab storage for qubit objects with stable addresses and dense indices.
+ *
+ * Objects are constructed in place inside chunks of ChunkSize slots, so creating 10^5
+ * qubits costs a few hundred allocations instead of one per qubit, and qubits created
+ * together stay close to each other in memory. The index returned by emplace() stays
+ * valid until erase() and freed indices are reused by the next emplace().
+ *
+ * emplace<U>() accepts subclasses of T that do not add any data members, e.g. the test helpers.
+ */
+template <typename T, std::size_t ChunkSize = 256>
+class QubitArena {
+ public:
+  QubitArena() {}
+  QubitArena(const QubitArena&) = delete;
+  QubitArena& operator=(const QubitArena&) = delete;
+  ~QubitArena() { clear(); }
+
+  template <typename U = T, typename... Args>
+  std::size_t emplace(Args&&... args) {
+    static_assert(std::is_base_of<T, U>::value, "U must be T or a subclass of T");
+    static_assert(sizeof(U) == sizeof(T) && alignof(U) == alignof(T), "U must not add data members to T");
+    std::size_t index;
+    if (!free_indices.empty()) {
+      index = free_indices.back();
+      free_indices.pop_back();
+    } else {
+      index = objects.size();
+      if (index == capacity()) addChunk();
+      objects.push_back(nullptr);
+    }
+    try {
+      objects[index] = new (slot(index)) U(std::forward<Args>(args)...);
+    } catch (...) {
+      free_indices.push_back(index);
+      throw;
+    }
+    num_objects++;
+    return index;
+  }
+
+  /**
+   * @return the object at the index, or nullptr if the index is free or out of range.
+   */
+  T* get(std::size_t index) const { return index < objects.size() ? objects[index] : nullptr; }
+
+  void erase(std::size_t index) {
+    auto* object = get(index);
+    if (object == nullptr) return;
+    object->~T();
+    objects[index] = nullptr;
+    free_indices.push_back(index);
+    num_objects--;
+  }
+
+  void clear() {
+    for (auto*& object : objects) {
+      if (object != nullptr) object->~T();
+      object = nullptr;
+    }
+    objects.clear();
+    free_indices.clear();
+    num_objects = 0;
+  }
+
+  void reserve(std::size_t size) {
+    while (capacity() < size) addChunk();
+    objects.reserve(size);
+  }
+
+  std::size_t size() const { return num_objects; }
+  // every index below this is either in use or free
+  std::size_t numSlots() const { return objects.size(); }
+  std::size_t capacity() const { return chunks.size() * ChunkSize; }
+  // the chunks and the index vectors, not the heap storage owned by the objects
+  std::size_t allocatedBytes() const {
+    return capacity() * sizeof(Slot) + chunks.capacity() * sizeof(chunks[0]) + objects.capacity() * sizeof(T*) + free_indices.capacity() * sizeof(std::size_t);
+  }
+
+ private:
+  using Slot = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+  void addChunk() { chunks.emplace_back(new Slot[ChunkSize]); }
+  void* slot(std::size_t index) { return &chunks[index / ChunkSize][index % ChunkSize]; }
+
+  std::vector<std::unique_ptr<Slot[]>> chunks;
+  std::vector<T*> objects;
+  std::vector<std::size_t> free_indices;
+  std::size_t num_objects = 0;
+};
+
+}  // namespace quisp::backends::graph_state
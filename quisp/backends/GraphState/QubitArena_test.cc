@@ -0,0 +1,81 @@
+#include "QubitArena.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace {
+using quisp::backends::graph_state::QubitArena;
+
+class Counted {
+ public:
+  Counted(int value, int* alive) : value(value), alive(alive) { (*alive)++; }
+  virtual ~Counted() { (*alive)--; }
+  int value;
+  int* alive;
+};
+
+class CountedSubclass : public Counted {
+ public:
+  CountedSubclass(int value, int* alive) : Counted(value * 10, alive) {}
+  int tenth() const { return value / 10; }
+};
+
+TEST(QubitArenaTest, emplaceAndGet) {
+  int alive = 0;
+  QubitArena<Counted, 4> arena;
+  auto first = arena.emplace(1, &alive);
+  auto second = arena.emplace(2, &alive);
+  EXPECT_EQ(arena.size(), 2);
+  EXPECT_EQ(alive, 2);
+  EXPECT_EQ(arena.get(first)->value, 1);
+  EXPECT_EQ(arena.get(second)->value, 2);
+  EXPECT_EQ(arena.get(100), nullptr);
+}
+
+TEST(QubitArenaTest, addressesAreStableAcrossChunks) {
+  int alive = 0;
+  QubitArena<Counted, 4> arena;
+  std::vector<Counted*> objects;
+  for (int i = 0; i < 10; i++) objects.push_back(arena.get(arena.emplace(i, &alive)));
+  EXPECT_EQ(arena.capacity(), 12);
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(arena.get(i), objects[i]);
+    EXPECT_EQ(objects[i]->value, i);
+  }
+}
+
+TEST(QubitArenaTest, eraseReusesIndex) {
+  int alive = 0;
+  QubitArena<Counted, 4> arena;
+  arena.emplace(1, &alive);
+  auto index = arena.emplace(2, &alive);
+  arena.erase(index);
+  EXPECT_EQ(alive, 1);
+  EXPECT_EQ(arena.get(index), nullptr);
+  EXPECT_EQ(arena.emplace(3, &alive), index);
+  EXPECT_EQ(arena.get(index)->value, 3);
+  EXPECT_EQ(arena.size(), 2);
+}
+
+TEST(QubitArenaTest, destroysObjectsOnDestruction) {
+  int alive = 0;
+  {
+    QubitArena<Counted, 4> arena;
+    arena.reserve(9);
+    EXPECT_EQ(arena.capacity(), 12);
+    for (int i = 0; i < 6; i++) arena.emplace(i, &alive);
+    arena.emplace<CountedSubclass>(7, &alive);
+    EXPECT_EQ(alive, 7);
+  }
+  EXPECT_EQ(alive, 0);
+}
+
+TEST(QubitArenaTest, emplaceSubclass) {
+  int alive = 0;
+  QubitArena<Counted, 4> arena;
+  auto index = arena.emplace<CountedSubclass>(7, &alive);
+  auto* object = dynamic_cast<CountedSubclass*>(arena.get(index));
+  ASSERT_NE(object, nullptr);
+  EXPECT_EQ(object->tenth(), 7);
+}
+
+}  // namespace
@@ -32,6 +32,7 @@ class QubitId : public IQubitId {
     auto qubit_id = dynamic_cast<const QubitId&>(qubit_id_ref);
     return id == qubit_id.id;
   }
+  std::uint64_t pack() const override { return static_cast<std::uint32_t>(id); }
 };
 
 class TestRNG : public quisp::backends::abstract::IRandomNumberGenerator {
@@ -69,7 +70,7 @@ class Qubit : public GraphStateQubit {
   using GraphStateQubit::measureX;
   using GraphStateQubit::measureY;
   using GraphStateQubit::measureZ;
-  using GraphStateQubit::memory_transition_matrix;
+  using GraphStateQubit::memory_transition;
   using GraphStateQubit::neighbors;
   using GraphStateQubit::relax;
   using GraphStateQubit::removeAllEdges;
@@ -80,12 +81,13 @@ class Qubit : public GraphStateQubit {
   using GraphStateQubit::updated_time;
   using GraphStateQubit::vertex_operator;
 
-  std::unordered_set<GraphStateQubit*> getNeighborSet() { return neighbors; }
+  const NeighborSet<GraphStateQubit>& getNeighborSet() { return neighbors; }
   void setVertexOperator(CliffordOperator op) { this->vertex_operator = op; }
   CliffordOperator getVertexOperator() { return this->vertex_operator; }
   Qubit(const IQubitId* id, GraphStateBackend* const backend) : GraphStateQubit(id, backend, false) {}
   void reset() {
     // we should not call setFree() here
+    if (!this->neighbors.empty()) backend->splitComponent(this);
     this->neighbors.clear();
     this->vertex_operator = CliffordOperator::H;
   }
@@ -150,22 +152,20 @@ class Qubit : public GraphStateQubit {
 
 class Backend : public GraphStateBackend {
  public:
+  using GraphStateBackend::qubit_arena;
   using GraphStateBackend::qubits;
   Backend(std::unique_ptr<IRandomNumberGenerator> rng, std::unique_ptr<StationaryQubitConfiguration> config) : GraphStateBackend(std::move(rng), std::move(config)) {}
   IQubit* createQubit(int id) { return this->createQubitInternal(new QubitId(id)); }
   IQubit* getQubit(int id) { return this->getQubitInternal(new QubitId(id)); }
   IQubit* createQubitInternal(const IQubitId* id) {
-    auto qubit = qubits.find(id);
+    auto qubit = qubits.find(id->getPackedKey());
 
     if (qubit != qubits.cend()) {
       return nullptr;
     }
-    auto original_qubit = std::make_unique<Qubit>(id, this);
-    auto* qubit_ptr = original_qubit.get();
-    qubits.insert({id, std::move(original_qubit)});
-    return qubit_ptr;
+    return qubit_arena.get(registerQubit(id, qubit_arena.emplace<Qubit>(id, this)));
   }
-  IQubit* getQubitInternal(const IQubitId* id) { return qubits.find(id)->second.get(); }
+  IQubit* getQubitInternal(const IQubitId* id) { return findQubit(id); }
 };
 
 }  // namespace quisp_test::backends::graph_state
@@ -1,5 +1,7 @@
 #pragma once
 #include <Eigen/Eigen>
+#include "utils/UtilFunctions.h"
+
 namespace quisp::backends::graph_state::types {
 enum class CliffordOperator : int {
   Id = 0,
@@ -33,6 +35,8 @@ struct SingleGateErrorModel {
   double z_error_rate;
   double x_error_rate;
   double y_error_rate;
+  // labels: no error, X, Z, Y
+  util_functions::CumulativeDistribution<4> distribution;
 
   void setParams(double x_ratio, double y_ratio, double z_ratio, double error_rate) {
     double sum = x_ratio + z_ratio + y_ratio;
@@ -47,6 +51,7 @@ struct SingleGateErrorModel {
     x_error_rate = pauli_error_rate * (x_ratio / sum);
     y_error_rate = pauli_error_rate * (y_ratio / sum);
     z_error_rate = pauli_error_rate * (z_ratio / sum);
+    distribution = util_functions::CumulativeDistribution<4>({1 - pauli_error_rate, x_error_rate, z_error_rate, y_error_rate});
   }
 };
 
@@ -67,6 +72,8 @@ struct TwoQubitGateErrorModel {
   double zx_error_rate;
   double zy_error_rate;
   double zz_error_rate;
+  // labels: no error, IX, IY, IZ, XI, XX, XY, XZ, YI, YX, YY, YZ, ZI, ZX, ZY, ZZ
+  util_functions::CumulativeDistribution<16> distribution;
 
   void setParams(double error_rate,
 
@@ -110,6 +117,9 @@ struct TwoQubitGateErrorModel {
     zx_error_rate = pauli_error_rate * (zx_ratio / ratio_sum);
     zy_error_rate = pauli_error_rate * (zy_ratio / ratio_sum);
     zz_error_rate = pauli_error_rate * (zz_ratio / ratio_sum);
+    distribution = util_functions::CumulativeDistribution<16>({1 - pauli_error_rate, ix_error_rate, iy_error_rate, iz_error_rate, xi_error_rate, xx_error_rate,
+                                                               xy_error_rate, xz_error_rate, yi_error_rate, yx_error_rate, yy_error_rate, yz_error_rate,
+                                                               zi_error_rate, zx_error_rate, zy_error_rate, zz_error_rate});
   }
 };
 
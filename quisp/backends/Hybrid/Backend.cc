@@ -0,0 +1,228 @@
+#include "Backend.h"
+#include <vector>
+#include "Qubit.h"
+#include "backends/interfaces/IConfiguration.h"
+#include "backends/interfaces/IQubit.h"
+#include "modules/QNIC/StationaryQubit/QubitId.h"
+
+using quisp::modules::qubit_id::QubitId;
+
+namespace quisp::backends::hybrid {
+using pauli_frame::CnotLink;
+
+namespace {
+// the simulators draw from the hybrid backend's RNG, so a run is reproducible whichever simulator a qubit lives in
+class ForwardingRNG : public IRandomNumberGenerator {
+ public:
+  explicit ForwardingRNG(HybridBackend* backend) : backend(backend) {}
+  double doubleRandom() override { return backend->dblrand(); }
+
+ private:
+  HybridBackend* const backend;
+};
+
+// the qubits in the entangled component of the qubit, a pending CNOT gives its controls and targets with nullptr for the measured ones
+std::vector<PauliFrameQubit*> entangledWith(PauliFrameQubit* qubit) {
+  if (auto* link = qubit->getLink()) return {link->controls[0], link->controls[1], link->targets[0], link->targets[1]};
+  if (qubit->getPartner() != nullptr) return {qubit, qubit->getPartner()};
+  return {qubit};
+}
+
+EigenvalueResult toEigenvalue(bool is_minus) { return is_minus ? EigenvalueResult::MINUS_ONE : EigenvalueResult::PLUS_ONE; }
+}  // namespace
+
+HybridBackend::HybridBackend(std::unique_ptr<IRandomNumberGenerator> rng, std::unique_ptr<StationaryQubitConfiguration> configuration)
+    : current_time(SimTime()), rng(std::move(rng)), short_live_qubit_pool_size(0) {
+  config = std::move(configuration);
+  pauli_frame = std::make_unique<PauliFrameBackend>(std::make_unique<ForwardingRNG>(this), std::make_unique<StationaryQubitConfiguration>(*config),
+                                                    static_cast<PauliFrameBackend::ICallback*>(this));
+  graph_state = std::make_unique<GraphStateBackend>(std::make_unique<ForwardingRNG>(this), std::make_unique<StationaryQubitConfiguration>(*config),
+                                                    static_cast<GraphStateBackend::ICallback*>(this));
+}
+HybridBackend::HybridBackend(std::unique_ptr<IRandomNumberGenerator> rng, std::unique_ptr<StationaryQubitConfiguration> configuration, ICallback* cb)
+    : HybridBackend(std::move(rng), std::move(configuration)) {
+  callback = cb;
+}
+// the simulators delete the ids of the qubits they hold
+HybridBackend::~HybridBackend() {}
+
+HybridQubit* HybridBackend::insertQubit(const IQubitId* id, std::unique_ptr<IConfiguration> conf, bool is_short_live) {
+  IConfiguration* raw_conf = conf.release();
+  StationaryQubitConfiguration* hybrid_conf = dynamic_cast<StationaryQubitConfiguration*>(raw_conf);
+  if (hybrid_conf == nullptr) {
+    delete raw_conf;
+    throw std::runtime_error("Hybrid::createQubit: failed to cast. got invalid configuration.");
+  }
+  auto qubit = std::make_unique<HybridQubit>(id, std::unique_ptr<StationaryQubitConfiguration>(hybrid_conf), this, is_short_live);
+  qubit->pauli_frame_qubit = dynamic_cast<PauliFrameQubit*>(pauli_frame->createQubit(id, std::make_unique<StationaryQubitConfiguration>(*hybrid_conf)));
+  auto* qubit_ptr = qubit.get();
+  qubits.insert({id->getPackedKey(), std::move(qubit)});
+  return qubit_ptr;
+}
+
+HybridQubit* HybridBackend::findQubit(const IQubitId* id) const {
+  auto qubit_iterator = qubits.find(id->getPackedKey());
+  if (qubit_iterator == qubits.cend()) return nullptr;
+  return qubit_iterator->second.get();
+}
+
+IQubit* HybridBackend::createShortLiveQubit() {
+  auto* qubit_id = new QubitId(-1, -1, -1, ++short_live_qubit_pool_size);
+  return insertQubit(qubit_id, getDefaultConfiguration(), true);
+}
+
+IQubit* HybridBackend::createQubit(const IQubitId* id, std::unique_ptr<IConfiguration> conf) {
+  if (findQubit(id) != nullptr) {
+    throw std::runtime_error("Hybrid::createQubit: trying to create qubit with already existed Id.");
+  }
+  return insertQubit(id, std::move(conf), false);
+}
+IQubit* HybridBackend::createQubit(const IQubitId* id) { return createQubit(id, getDefaultConfiguration()); }
+
+IQubit* HybridBackend::getQubit(const IQubitId* id) {
+  auto* qubit = findQubit(id);
+  if (qubit == nullptr) {
+    throw std::runtime_error("Hybrid::getQubit: trying to get qubit with non existing Id.");
+  }
+  return qubit;
+}
+
+IQubit* HybridBackend::getShortLiveQubit() {
+  if (short_live_qubit_pool.empty()) {
+    return createShortLiveQubit();
+  }
+  auto* qubit = short_live_qubit_pool.front();
+  short_live_qubit_pool.pop_front();
+  return qubit;
+}
+
+void HybridBackend::returnToPool(IQubit* pool_qubit) {
+  pool_qubit->setFree();
+  short_live_qubit_pool.emplace_back(pool_qubit);
+}
+
+void HybridBackend::deleteQubit(const IQubitId* id) {
+  auto qubit_iterator = qubits.find(id->getPackedKey());
+  if (qubit_iterator == qubits.cend()) {
+    throw std::runtime_error("Hybrid::deleteQubit: trying to delete qubit with non existing Id.");
+  }
+  if (qubit_iterator->second->graph_state_qubit != nullptr) {
+    graph_state->deleteQubit(id);
+    num_graph_state_qubits--;
+  } else {
+    pauli_frame->deleteQubit(id);
+  }
+  qubits.erase(qubit_iterator);
+}
+
+GraphStateQubit* HybridBackend::createGraphStateQubit(const IQubitId* id, const StationaryQubitConfiguration& configuration) {
+  auto* qubit = dynamic_cast<GraphStateQubit*>(graph_state->createQubit(id, std::make_unique<StationaryQubitConfiguration>(configuration)));
+  // starts the memory error from now
+  qubit->setFree();
+  num_graph_state_qubits++;
+  return qubit;
+}
+
+void HybridBackend::promote(HybridQubit* qubit) {
+  if (qubit->graph_state_qubit != nullptr) return;
+  // the memory error may break the pairs, so it's sampled before looking at the component
+  for (auto* member : entangledWith(qubit->pauli_frame_qubit)) {
+    if (member != nullptr) member->applyMemoryError();
+  }
+  auto members = entangledWith(qubit->pauli_frame_qubit);
+  const CnotLink* link = qubit->pauli_frame_qubit->getLink();
+  std::vector<GraphStateQubit*> promoted;
+  std::vector<const IQubitId*> measured_ids;
+  for (auto* member : members) {
+    if (member != nullptr) {
+      promoted.push_back(createGraphStateQubit(member->getId(), *findQubit(member->getId())->configuration));
+    } else {
+      // the measured qubit of a pending CNOT is recreated to project the others onto its outcome
+      measured_ids.push_back(new QubitId(-1, -1, -1, ++short_live_qubit_pool_size));
+      promoted.push_back(createGraphStateQubit(measured_ids.back(), *config));
+    }
+  }
+
+  // the reference state: an eigenstate, |Phi+> or CNOT(control -> target) |Phi+> |Phi+>
+  if (members.size() == 1) {
+    auto basis = members[0]->getBasis();
+    if (basis != Basis::Z) promoted[0]->noiselessH();
+    // no time has passed since the qubit was created, so S doesn't draw a memory error
+    if (basis == Basis::Y) promoted[0]->gateS();
+  } else {
+    for (std::size_t pair = 0; pair < members.size(); pair += 2) {
+      promoted[pair]->noiselessH();
+      promoted[pair]->noiselessCNOT(promoted[pair + 1]);
+    }
+  }
+  if (link != nullptr) {
+    promoted[0]->noiselessCNOT(promoted[2]);
+    for (int i = 0; i < 4; i++) {
+      if (members[i] != nullptr) continue;
+      // the stored results are the outcomes of the reference state, without the frame of the measured qubit
+      if (i < 2) {
+        promoted[i]->noiselessMeasureX(toEigenvalue(link->control_result));
+      } else {
+        promoted[i]->noiselessMeasureZ(toEigenvalue(link->target_result));
+      }
+    }
+  }
+  for (std::size_t i = 0; i < members.size(); i++) {
+    if (members[i] == nullptr) continue;
+    if (members[i]->hasXFrame()) promoted[i]->noiselessX();
+    if (members[i]->hasZFrame()) promoted[i]->noiselessZ();
+  }
+
+  for (std::size_t i = 0; i < members.size(); i++) {
+    if (members[i] == nullptr) continue;
+    auto* hybrid_qubit = findQubit(members[i]->getId());
+    pauli_frame->deleteQubit(hybrid_qubit->id);
+    hybrid_qubit->pauli_frame_qubit = nullptr;
+    hybrid_qubit->graph_state_qubit = promoted[i];
+  }
+  for (auto* measured_id : measured_ids) {
+    graph_state->deleteQubit(measured_id);
+    num_graph_state_qubits--;
+    delete measured_id;
+  }
+}
+
+void HybridBackend::demote(HybridQubit* qubit) {
+  if (qubit->graph_state_qubit == nullptr) return;
+  qubit->graph_state_qubit->setFree();
+  graph_state->deleteQubit(qubit->id);
+  num_graph_state_qubits--;
+  qubit->graph_state_qubit = nullptr;
+  qubit->pauli_frame_qubit = dynamic_cast<PauliFrameQubit*>(pauli_frame->createQubit(qubit->id, std::make_unique<StationaryQubitConfiguration>(*qubit->configuration)));
+  // starts the memory error from now
+  qubit->pauli_frame_qubit->setFree();
+}
+
+std::unique_ptr<IConfiguration> HybridBackend::getDefaultConfiguration() const {
+  // copy the default backend configuration for each qubit
+  return std::make_unique<StationaryQubitConfiguration>(*config.get());
+}
+const SimTime& HybridBackend::getSimTime() {
+  if (callback != nullptr) callback->willUpdate(*this);
+  return current_time;
+}
+void HybridBackend::setSimTime(SimTime time) { current_time = time; }
+double HybridBackend::dblrand() { return rng->doubleRandom(); }
+
+void HybridBackend::willUpdate(PauliFrameBackend& backend) { backend.setSimTime(getSimTime()); }
+void HybridBackend::willUpdate(GraphStateBackend& backend) { backend.setSimTime(getSimTime()); }
+
+double HybridBackend::getBellPairFidelity(IQubit* first, IQubit* second) {
+  auto* hybrid_first = dynamic_cast<HybridQubit*>(first);
+  auto* hybrid_second = dynamic_cast<HybridQubit*>(second);
+  if (hybrid_first == nullptr || hybrid_second == nullptr) throw std::runtime_error("Hybrid: the qubit does not belong to this backend.");
+  auto* pf_first = hybrid_first->pauli_frame_qubit;
+  auto* pf_second = hybrid_second->pauli_frame_qubit;
+  if (pf_first != nullptr && pf_second != nullptr && !pf_first->isLinked() && !pf_second->isLinked()) return pauli_frame->getBellPairFidelity(pf_first, pf_second);
+  // the Pauli frames don't have the reduced state of a qubit in a pending CNOT
+  promote(hybrid_first);
+  promote(hybrid_second);
+  return graph_state->getBellPairFidelity(hybrid_first->graph_state_qubit, hybrid_second->graph_state_qubit);
+}
+
+}  // namespace quisp::backends::hybrid
@@ -0,0 +1,81 @@
+#pragma once
+#include <omnetpp.h>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include "../GraphState/Backend.h"
+#include "../PauliFrame/Backend.h"
+#include "../interfaces/IConfiguration.h"
+#include "../interfaces/IQuantumBackend.h"
+#include "../interfaces/IQubit.h"
+#include "../interfaces/IRandomNumberGenerator.h"
+#include "Qubit.h"
+#include "backends/QubitConfiguration.h"
+#include "backends/interfaces/IQubitId.h"
+
+namespace quisp::backends::hybrid {
+using abstract::IConfiguration;
+using abstract::IQuantumBackend;
+using abstract::IQubit;
+using abstract::IQubitId;
+using abstract::IRandomNumberGenerator;
+using graph_state::GraphStateBackend;
+using pauli_frame::PauliFrameBackend;
+using omnetpp::SimTime;
+
+/**
+ * @brief quantum backend tracking the link level Bell pairs as Pauli frames and the rest as graph states.
+ *
+ * Long repeater chains spend most operations on Bell pair generation, swapping and purification, which the
+ * PauliFrameBackend handles with a few bit operations, while the protocols at the end nodes may build larger clusters.
+ * Each qubit lives in one of the two simulators, see HybridQubit. Both use this backend's RNG and time.
+ */
+class HybridBackend : public IQuantumBackend, PauliFrameBackend::ICallback, GraphStateBackend::ICallback {
+ public:
+  class ICallback {
+   public:
+    virtual ~ICallback() {}
+    virtual void willUpdate(HybridBackend& backend) = 0;
+  };
+  HybridBackend(std::unique_ptr<IRandomNumberGenerator> rng, std::unique_ptr<StationaryQubitConfiguration> configuration);
+  HybridBackend(std::unique_ptr<IRandomNumberGenerator> rng, std::unique_ptr<StationaryQubitConfiguration> configuration, ICallback* callback);
+  ~HybridBackend();
+  IQubit* createQubit(const IQubitId* id, std::unique_ptr<IConfiguration> conf) override;
+  IQubit* createQubit(const IQubitId* id) override;
+  IQubit* createShortLiveQubit() override;
+  IQubit* getQubit(const IQubitId* id) override;
+  IQubit* getShortLiveQubit() override;
+  void returnToPool(IQubit*) override;
+  void deleteQubit(const IQubitId* id) override;
+  std::unique_ptr<IConfiguration> getDefaultConfiguration() const override;
+  const SimTime& getSimTime() override;
+  void setSimTime(SimTime time) override;
+  double getBellPairFidelity(IQubit* first, IQubit* second) override;
+  double dblrand();
+
+  // moves the qubit and the ones entangled with it to the graph state in the same state, nothing happens to graph state qubits
+  void promote(HybridQubit* qubit);
+  // moves a qubit in |0> back to the Pauli frames
+  void demote(HybridQubit* qubit);
+  std::size_t numGraphStateQubits() const { return num_graph_state_qubits; }
+
+ protected:
+  void willUpdate(PauliFrameBackend& backend) override;
+  void willUpdate(GraphStateBackend& backend) override;
+  HybridQubit* insertQubit(const IQubitId* id, std::unique_ptr<IConfiguration> conf, bool is_short_live);
+  HybridQubit* findQubit(const IQubitId* id) const;
+  GraphStateQubit* createGraphStateQubit(const IQubitId* id, const StationaryQubitConfiguration& configuration);
+
+  std::unordered_map<std::uint64_t, std::unique_ptr<HybridQubit>> qubits;
+  SimTime current_time;
+  const std::unique_ptr<IRandomNumberGenerator> rng;
+  std::unique_ptr<StationaryQubitConfiguration> config;
+  ICallback* callback = nullptr;
+  std::unique_ptr<PauliFrameBackend> pauli_frame;
+  std::unique_ptr<GraphStateBackend> graph_state;
+  std::size_t num_graph_state_qubits = 0;
+  std::deque<IQubit*> short_live_qubit_pool;
+  int short_live_qubit_pool_size;  // this is used to generate qubit id for short live qubits in a pool; currenlty only photons.
+};
+}  // namespace quisp::backends::hybrid
@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <stdexcept>
+#include "Backend.h"
+#include "Qubit.h"
+#include "backends/GraphState/test.h"
+#include "backends/interfaces/IConfiguration.h"
+
+namespace {
+using namespace quisp::backends::hybrid;
+using quisp::backends::StationaryQubitConfiguration;
+using quisp_test::backends::graph_state::QubitId;
+using quisp_test::backends::graph_state::TestRNG;
+
+class HybridBackendTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    SimTime::setScaleExp(-9);
+    rng = new TestRNG();
+    backend = std::make_unique<HybridBackend>(std::unique_ptr<IRandomNumberGenerator>(rng), std::make_unique<StationaryQubitConfiguration>());
+  }
+  HybridQubit* createQubit(int id) { return dynamic_cast<HybridQubit*>(backend->createQubit(new QubitId(id))); }
+  void makeBellPair(IQubit* left, IQubit* right) {
+    left->gateH();
+    left->gateCNOT(right);
+  }
+  void correctSwapping(IQubit* left, IQubit* right, EigenvalueResult x_result, EigenvalueResult z_result) {
+    if (x_result == EigenvalueResult::MINUS_ONE) left->gateZ();
+    if (z_result == EigenvalueResult::MINUS_ONE) right->gateX();
+  }
+  TestRNG* rng;
+  std::unique_ptr<HybridBackend> backend;
+};
+
+TEST_F(HybridBackendTest, createAndGetQubit) {
+  auto* id = new QubitId(123);
+  auto* qubit = backend->createQubit(id);
+  ASSERT_THROW(backend->createQubit(id), std::runtime_error);
+  QubitId same_id(123);
+  EXPECT_EQ(backend->getQubit(&same_id), qubit);
+  QubitId unknown_id(4);
+  ASSERT_THROW(backend->getQubit(&unknown_id), std::runtime_error);
+  ASSERT_THROW(backend->createQubit(new QubitId(5), std::make_unique<IConfiguration>()), std::runtime_error);
+  backend->deleteQubit(&same_id);
+  ASSERT_THROW(backend->getQubit(&same_id), std::runtime_error);
+}
+
+TEST_F(HybridBackendTest, linkLevelOperationsStayInPauliFrames) {
+  // two links made at Bell state analyzers, then swapped in the middle
+  auto* left = createQubit(1);
+  auto* middle_left = createQubit(2);
+  auto* middle_right = createQubit(3);
+  auto* right = createQubit(4);
+  for (auto [a, b] : {std::pair{left, middle_left}, std::pair{middle_right, right}}) {
+    auto* photon_a = backend->getShortLiveQubit();
+    auto* photon_b = backend->getShortLiveQubit();
+    a->gateH();
+    a->gateCNOT(photon_a);
+    b->gateH();
+    b->gateCNOT(photon_b);
+    auto result = photon_a->bellMeasure(photon_b);
+    correctSwapping(a, b, result.x_result, result.z_result);
+    photon_a->relaseBackToPool();
+    photon_b->relaseBackToPool();
+  }
+  auto result = middle_left->bellMeasure(middle_right);
+  correctSwapping(left, right, result.x_result, result.z_result);
+  EXPECT_NEAR(backend->getBellPairFidelity(left, right), 1, 1e-12);
+  EXPECT_EQ(backend->numGraphStateQubits(), 0);
+  EXPECT_FALSE(left->isGraphState());
+}
+
+TEST_F(HybridBackendTest, ghzStatePromotesTheCluster) {
+  auto* a = createQubit(1);
+  auto* b = createQubit(2);
+  auto* c = createQubit(3);
+  auto* unrelated = createQubit(4);
+  makeBellPair(a, b);
+  a->gateCNOT(c);
+  EXPECT_TRUE(a->isGraphState());
+  EXPECT_TRUE(b->isGraphState());
+  EXPECT_TRUE(c->isGraphState());
+  EXPECT_FALSE(unrelated->isGraphState());
+  EXPECT_EQ(backend->numGraphStateQubits(), 3);
+
+  // the GHZ state is the same in the graph state
+  rng->double_value = 0.7;
+  auto result = a->measureZ();
+  EXPECT_EQ(b->measureZ(), result);
+  EXPECT_EQ(c->measureZ(), result);
+
+  // released qubits return to the Pauli frames in |0>
+  for (auto* qubit : {a, b, c}) qubit->setFree();
+  EXPECT_EQ(backend->numGraphStateQubits(), 0);
+  EXPECT_FALSE(b->isGraphState());
+  EXPECT_EQ(b->measureZ(), EigenvalueResult::PLUS_ONE);
+  makeBellPair(a, b);
+  EXPECT_NEAR(backend->getBellPairFidelity(a, b), 1, 1e-12);
+}
+
+TEST_F(HybridBackendTest, promotionKeepsTheFrames) {
+  auto* a = createQubit(1);
+  auto* b = createQubit(2);
+  makeBellPair(a, b);
+  a->gateX();
+  b->gateZ();
+  EXPECT_NEAR(backend->getBellPairFidelity(a, b), 0, 1e-12);
+  // H on a half of a pair is beyond the Pauli frames
+  a->gateH();
+  EXPECT_TRUE(a->isGraphState());
+  a->gateH();
+  b->gateZ();
+  a->gateX();
+  EXPECT_NEAR(backend->getBellPairFidelity(a, b), 1, 1e-12);
+
+  // an unpaired qubit in |+i>
+  auto* q = createQubit(3);
+  q->gateH();
+  q->gateS();
+  q->gateZ();
+  backend->promote(q);
+  EXPECT_TRUE(q->isGraphState());
+  EXPECT_EQ(q->measureY(), EigenvalueResult::MINUS_ONE);
+}
+
+TEST_F(HybridBackendTest, promotionOfAPendingCnot) {
+  auto* a = createQubit(1);
+  auto* b = createQubit(2);
+  auto* c = createQubit(3);
+  auto* d = createQubit(4);
+  makeBellPair(a, b);
+  makeBellPair(c, d);
+  // the swapping at b and c, with the measurement of c in the graph state
+  b->gateCNOT(c);
+  rng->double_value = 0.7;
+  auto x_result = b->measureX();
+  EXPECT_EQ(backend->numGraphStateQubits(), 0);
+  backend->promote(c);
+  EXPECT_TRUE(a->isGraphState());
+  EXPECT_TRUE(d->isGraphState());
+  EXPECT_FALSE(b->isGraphState());
+  EXPECT_EQ(backend->numGraphStateQubits(), 3);
+  auto z_result = c->measureZ();
+  correctSwapping(a, d, x_result, z_result);
+  EXPECT_NEAR(backend->getBellPairFidelity(a, d), 1, 1e-12);
+}
+
+TEST_F(HybridBackendTest, mixedCnotPromotesThePauliFrames) {
+  auto* a = createQubit(1);
+  auto* b = createQubit(2);
+  auto* c = createQubit(3);
+  auto* d = createQubit(4);
+  makeBellPair(a, b);
+  a->gateH();
+  makeBellPair(c, d);
+  // a is in the graph state, so are c and d after the CNOT
+  a->gateCNOT(c);
+  EXPECT_TRUE(c->isGraphState());
+  EXPECT_TRUE(d->isGraphState());
+  EXPECT_EQ(backend->numGraphStateQubits(), 4);
+}
+
+}  // namespace
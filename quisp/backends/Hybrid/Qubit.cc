@@ -0,0 +1,152 @@
+#include "Qubit.h"
+#include <stdexcept>
+#include "Backend.h"
+
+namespace quisp::backends::hybrid {
+
+HybridQubit::HybridQubit(const IQubitId *id, std::unique_ptr<StationaryQubitConfiguration> configuration, HybridBackend *const backend, bool is_short_live)
+    : id(id), configuration(std::move(configuration)), backend(backend), is_short_live(is_short_live) {}
+
+HybridQubit::~HybridQubit() {}
+
+const IQubitId *const HybridQubit::getId() const { return id; }
+
+void HybridQubit::relaseBackToPool() {
+  if (!is_short_live) {
+    throw std::runtime_error("cannot release non short-live qubit");
+  }
+  backend->returnToPool(this);
+}
+
+IQubit *HybridQubit::current() const {
+  if (graph_state_qubit != nullptr) return graph_state_qubit;
+  return pauli_frame_qubit;
+}
+
+HybridQubit *HybridQubit::toHybridQubit(IQubit *qubit) const {
+  auto *hybrid_qubit = dynamic_cast<HybridQubit *>(qubit);
+  if (hybrid_qubit == nullptr) {
+    throw std::runtime_error("HybridQubit: the qubit does not belong to the hybrid backend.");
+  }
+  return hybrid_qubit;
+}
+
+void HybridQubit::prepareLocalClifford() {
+  if (pauli_frame_qubit == nullptr) return;
+  if (pauli_frame_qubit->getPartner() != nullptr || pauli_frame_qubit->isLinked()) backend->promote(this);
+}
+
+void HybridQubit::prepareCNOT(HybridQubit *target, bool with_memory_error) {
+  if (pauli_frame_qubit != nullptr && target->pauli_frame_qubit != nullptr) {
+    // the memory error may break a pair, so it's sampled before checking the state
+    if (with_memory_error) {
+      pauli_frame_qubit->applyMemoryError();
+      target->pauli_frame_qubit->applyMemoryError();
+    }
+    if (pauli_frame_qubit->canApplyCNOT(target->pauli_frame_qubit)) return;
+  }
+  backend->promote(this);
+  backend->promote(target);
+}
+
+void HybridQubit::prepareMeasurement(Basis basis, bool with_memory_error) {
+  if (pauli_frame_qubit == nullptr) return;
+  if (with_memory_error) pauli_frame_qubit->applyMemoryError();
+  if (!pauli_frame_qubit->canMeasure(basis)) backend->promote(this);
+}
+
+// public member functions
+
+void HybridQubit::setFree() {
+  if (graph_state_qubit != nullptr) {
+    backend->demote(this);
+    return;
+  }
+  pauli_frame_qubit->setFree();
+}
+
+void HybridQubit::gateX() { current()->gateX(); }
+void HybridQubit::gateZ() { current()->gateZ(); }
+void HybridQubit::gateY() { current()->gateY(); }
+void HybridQubit::gateH() {
+  prepareLocalClifford();
+  current()->gateH();
+}
+void HybridQubit::gateS() {
+  prepareLocalClifford();
+  current()->gateS();
+}
+void HybridQubit::gateSdg() {
+  prepareLocalClifford();
+  current()->gateSdg();
+}
+
+void HybridQubit::gateCNOT(IQubit *const target_qubit) {
+  auto *target = toHybridQubit(target_qubit);
+  prepareCNOT(target, true);
+  if (graph_state_qubit != nullptr) {
+    graph_state_qubit->gateCNOT(target->graph_state_qubit);
+  } else {
+    pauli_frame_qubit->gateCNOT(target->pauli_frame_qubit);
+  }
+}
+
+EigenvalueResult HybridQubit::measureX() {
+  prepareMeasurement(Basis::X, true);
+  return current()->measureX();
+}
+EigenvalueResult HybridQubit::measureY() {
+  prepareMeasurement(Basis::Y, true);
+  return current()->measureY();
+}
+EigenvalueResult HybridQubit::measureZ() {
+  prepareMeasurement(Basis::Z, true);
+  return current()->measureZ();
+}
+
+BellMeasurementResult HybridQubit::bellMeasure(IQubit *const target_qubit) {
+  auto *target = toHybridQubit(target_qubit);
+  // the graph state fuses the whole measurement, the Pauli frames go through the gates one by one
+  if (graph_state_qubit != nullptr && target->graph_state_qubit != nullptr) return graph_state_qubit->bellMeasure(target->graph_state_qubit);
+  return IQubit::bellMeasure(target_qubit);
+}
+
+EigenvalueResult HybridQubit::purify(IQubit *const trash_qubit, PurificationBasis basis) {
+  auto *trash = toHybridQubit(trash_qubit);
+  if (graph_state_qubit != nullptr && trash->graph_state_qubit != nullptr) return graph_state_qubit->purify(trash->graph_state_qubit, basis);
+  return IQubit::purify(trash_qubit, basis);
+}
+
+void HybridQubit::noiselessX() { current()->noiselessX(); }
+void HybridQubit::noiselessZ() { current()->noiselessZ(); }
+void HybridQubit::noiselessH() {
+  prepareLocalClifford();
+  current()->noiselessH();
+}
+void HybridQubit::noiselessCNOT(IQubit *const target_qubit) {
+  auto *target = toHybridQubit(target_qubit);
+  prepareCNOT(target, false);
+  if (graph_state_qubit != nullptr) {
+    graph_state_qubit->noiselessCNOT(target->graph_state_qubit);
+  } else {
+    pauli_frame_qubit->noiselessCNOT(target->pauli_frame_qubit);
+  }
+}
+EigenvalueResult HybridQubit::noiselessMeasureZ() {
+  prepareMeasurement(Basis::Z, false);
+  return current()->noiselessMeasureZ();
+}
+EigenvalueResult HybridQubit::noiselessMeasureX() {
+  prepareMeasurement(Basis::X, false);
+  return current()->noiselessMeasureX();
+}
+EigenvalueResult HybridQubit::noiselessMeasureZ(EigenvalueResult forced_result) {
+  prepareMeasurement(Basis::Z, false);
+  return current()->noiselessMeasureZ(forced_result);
+}
+EigenvalueResult HybridQubit::noiselessMeasureX(EigenvalueResult forced_result) {
+  prepareMeasurement(Basis::X, false);
+  return current()->noiselessMeasureX(forced_result);
+}
+
+}  // namespace quisp::backends::hybrid
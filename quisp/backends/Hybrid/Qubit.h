@@ -0,0 +1,78 @@
+#pragma once
+#include <memory>
+#include "../GraphState/Qubit.h"
+#include "../PauliFrame/Qubit.h"
+#include "../interfaces/IQubit.h"
+#include "backends/QubitConfiguration.h"
+#include "backends/interfaces/IQubitId.h"
+
+namespace quisp::backends::hybrid {
+
+using abstract::BellMeasurementResult;
+using abstract::EigenvalueResult;
+using abstract::IQubit;
+using abstract::IQubitId;
+using abstract::PurificationBasis;
+using graph_state::GraphStateQubit;
+using pauli_frame::Basis;
+using pauli_frame::PauliFrameQubit;
+
+class HybridBackend;
+
+/**
+ * @brief a qubit of the HybridBackend, either a PauliFrameQubit or a GraphStateQubit of the backend's simulators.
+ *
+ * Qubits start as Pauli frames. An operation the frame can't represent, e.g. H on a half of a Bell pair or a CNOT making
+ * a GHZ state, first promotes the qubit and the ones it's entangled with to graph state qubits in the same state.
+ * Released qubits are back in |0> and return to the Pauli frames.
+ */
+class HybridQubit : public IQubit {
+  friend class HybridBackend;
+
+ public:
+  HybridQubit(const IQubitId *id, std::unique_ptr<StationaryQubitConfiguration> configuration, HybridBackend *const backend, bool is_short_live);
+  ~HybridQubit();
+  void setFree() override;
+  const IQubitId *const getId() const override;
+  void relaseBackToPool() override;
+  bool isGraphState() const { return graph_state_qubit != nullptr; }
+
+  void gateX() override;
+  void gateZ() override;
+  void gateY() override;
+  void gateH() override;
+  void gateS() override;
+  void gateSdg() override;
+  void gateCNOT(IQubit *const target_qubit) override;
+  EigenvalueResult measureX() override;
+  EigenvalueResult measureY() override;
+  EigenvalueResult measureZ() override;
+  BellMeasurementResult bellMeasure(IQubit *const target_qubit) override;
+  EigenvalueResult purify(IQubit *const trash_qubit, PurificationBasis basis) override;
+
+  void noiselessH() override;
+  void noiselessX() override;
+  void noiselessZ() override;
+  void noiselessCNOT(IQubit *const target_qubit) override;
+  EigenvalueResult noiselessMeasureZ() override;
+  EigenvalueResult noiselessMeasureX() override;
+  EigenvalueResult noiselessMeasureZ(EigenvalueResult forced_result) override;
+  EigenvalueResult noiselessMeasureX(EigenvalueResult forced_result) override;
+
+ protected:
+  IQubit *current() const;
+  HybridQubit *toHybridQubit(IQubit *qubit) const;
+  // promotes unless the Pauli frame keeps representing the state
+  void prepareLocalClifford();
+  void prepareCNOT(HybridQubit *target, bool with_memory_error);
+  void prepareMeasurement(Basis basis, bool with_memory_error);
+
+  PauliFrameQubit *pauli_frame_qubit = nullptr;
+  GraphStateQubit *graph_state_qubit = nullptr;
+  const IQubitId *id;
+  const std::unique_ptr<StationaryQubitConfiguration> configuration;
+  HybridBackend *const backend;
+  const bool is_short_live;
+};
+
+}  // namespace quisp::backends::hybrid
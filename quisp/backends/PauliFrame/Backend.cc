@@ -0,0 +1,106 @@
+#include "Backend.h"
+#include "Qubit.h"
+#include "backends/interfaces/IConfiguration.h"
+#include "backends/interfaces/IQubit.h"
+#include "modules/QNIC/StationaryQubit/QubitId.h"
+
+using quisp::modules::qubit_id::QubitId;
+
+namespace quisp::backends::pauli_frame {
+PauliFrameBackend::PauliFrameBackend(std::unique_ptr<IRandomNumberGenerator> rng, std::unique_ptr<StationaryQubitConfiguration> configuration)
+    : current_time(SimTime()), rng(std::move(rng)), short_live_qubit_pool_size(0) {
+  config = std::move(configuration);
+}
+PauliFrameBackend::PauliFrameBackend(std::unique_ptr<IRandomNumberGenerator> rng, std::unique_ptr<StationaryQubitConfiguration> configuration, ICallback* cb)
+    : PauliFrameBackend(std::move(rng), std::move(configuration)) {
+  callback = cb;
+}
+PauliFrameBackend::~PauliFrameBackend() {
+  for (auto& pair : qubits) {
+    delete pair.first;
+  }
+}
+
+std::unique_ptr<PauliFrameQubit> PauliFrameBackend::makeQubit(const IQubitId* id, std::unique_ptr<IConfiguration> conf, bool is_short_live) {
+  IConfiguration* raw_conf = conf.release();
+  StationaryQubitConfiguration* st_conf = dynamic_cast<StationaryQubitConfiguration*>(raw_conf);
+  if (st_conf == nullptr) {
+    delete raw_conf;
+    throw std::runtime_error("PauliFrame::createQubit: failed to cast. got invalid configuration.");
+  }
+  auto qubit = std::make_unique<PauliFrameQubit>(id, this, is_short_live);
+  qubit->configure(std::unique_ptr<StationaryQubitConfiguration>(st_conf));
+  return qubit;
+}
+
+IQubit* PauliFrameBackend::createShortLiveQubit() {
+  auto* qubit_id = new QubitId(-1, -1, -1, ++short_live_qubit_pool_size);
+  auto original_qubit = makeQubit(qubit_id, getDefaultConfiguration(), true);
+  auto* qubit_ptr = original_qubit.get();
+  qubits.insert({qubit_id, std::move(original_qubit)});
+  return qubit_ptr;
+}
+
+IQubit* PauliFrameBackend::createQubit(const IQubitId* id, std::unique_ptr<IConfiguration> conf) {
+  if (qubits.find(id) != qubits.cend()) {
+    throw std::runtime_error("PauliFrame::createQubit: trying to create qubit with already existed Id.");
+  }
+  auto original_qubit = makeQubit(id, std::move(conf), false);
+  auto* qubit_ptr = original_qubit.get();
+  qubits.insert({id, std::move(original_qubit)});
+  return qubit_ptr;
+}
+IQubit* PauliFrameBackend::createQubit(const IQubitId* id) { return createQubit(id, getDefaultConfiguration()); }
+
+IQubit* PauliFrameBackend::getQubit(const IQubitId* id) {
+  auto qubit_iterator = qubits.find(id);
+  if (qubit_iterator == qubits.cend()) {
+    throw std::runtime_error("PauliFrame::getQubit: trying to get qubit with non existing Id.");
+  }
+  return qubit_iterator->second.get();
+}
+
+IQubit* PauliFrameBackend::getShortLiveQubit() {
+  if (short_live_qubit_pool.empty()) {
+    return createShortLiveQubit();
+  }
+  auto* qubit = short_live_qubit_pool.front();
+  short_live_qubit_pool.pop_front();
+  return qubit;
+}
+
+void PauliFrameBackend::returnToPool(IQubit* pool_qubit) {
+  pool_qubit->setFree();
+  short_live_qubit_pool.emplace_back(pool_qubit);
+}
+
+void PauliFrameBackend::deleteQubit(const IQubitId* id) {
+  auto qubit_iterator = qubits.find(id);
+  if (qubit_iterator == qubits.cend()) {
+    throw std::runtime_error("PauliFrame::deleteQubit: trying to delete qubit with non existing Id.");
+  }
+  // the partners must not keep a pointer to the deleted qubit
+  qubit_iterator->second->setFree();
+  qubits.erase(qubit_iterator);
+}
+
+std::unique_ptr<IConfiguration> PauliFrameBackend::getDefaultConfiguration() const {
+  // copy the default backend configuration for each qubit
+  return std::make_unique<StationaryQubitConfiguration>(*config.get());
+}
+const SimTime& PauliFrameBackend::getSimTime() {
+  if (callback != nullptr) callback->willUpdate(*this);
+  return current_time;
+}
+void PauliFrameBackend::setSimTime(SimTime time) { current_time = time; }
+double PauliFrameBackend::getBellPairFidelity(IQubit* first, IQubit* second) {
+  auto* pf_first = dynamic_cast<PauliFrameQubit*>(first);
+  auto* pf_second = dynamic_cast<PauliFrameQubit*>(second);
+  if (pf_first == nullptr || pf_second == nullptr) throw std::runtime_error("PauliFrame: the qubit does not belong to this backend.");
+  return pf_first->bellPairFidelity(pf_second);
+}
+double PauliFrameBackend::dblrand() { return rng->doubleRandom(); }
+
+std::shared_ptr<const MemoryTransition> PauliFrameBackend::getMemoryTransition(const Matrix6d& transition_matrix) { return memory_transitions.get(transition_matrix); }
+
+}  // namespace quisp::backends::pauli_frame
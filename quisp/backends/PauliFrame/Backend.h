@@ -0,0 +1,66 @@
+#pragma once
+#include <omnetpp.h>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include "../GraphState/MemoryTransition.h"
+#include "../interfaces/IConfiguration.h"
+#include "../interfaces/IQuantumBackend.h"
+#include "../interfaces/IQubit.h"
+#include "../interfaces/IRandomNumberGenerator.h"
+#include "Qubit.h"
+#include "backends/QubitConfiguration.h"
+#include "backends/interfaces/IQubitId.h"
+
+namespace quisp::backends::pauli_frame {
+using abstract::IConfiguration;
+using abstract::IQuantumBackend;
+using abstract::IQubit;
+using abstract::IQubitId;
+using abstract::IRandomNumberGenerator;
+using graph_state::MemoryTransitionCache;
+
+/**
+ * @brief "error tracking only" quantum backend based on per qubit Pauli frames.
+ *
+ * Meant for link level studies where only the Pauli errors on each Bell pair matter.
+ * It uses the same error models as GraphStateBackend, see PauliFrameQubit for the supported operations.
+ */
+class PauliFrameBackend : public IQuantumBackend {
+ public:
+  class ICallback {
+   public:
+    virtual ~ICallback() {}
+    virtual void willUpdate(PauliFrameBackend& backend) = 0;
+  };
+  PauliFrameBackend(std::unique_ptr<IRandomNumberGenerator> rng, std::unique_ptr<StationaryQubitConfiguration> configuration);
+  PauliFrameBackend(std::unique_ptr<IRandomNumberGenerator> rng, std::unique_ptr<StationaryQubitConfiguration> configuration, ICallback* callback);
+  ~PauliFrameBackend();
+  IQubit* createQubit(const IQubitId* id, std::unique_ptr<IConfiguration> conf) override;
+  IQubit* createQubit(const IQubitId* id) override;
+  IQubit* createShortLiveQubit() override;
+  IQubit* getQubit(const IQubitId* id) override;
+  IQubit* getShortLiveQubit() override;
+  void returnToPool(IQubit*) override;
+  void deleteQubit(const IQubitId* id) override;
+  std::unique_ptr<IConfiguration> getDefaultConfiguration() const override;
+  const SimTime& getSimTime() override;
+  void setSimTime(SimTime time) override;
+  double getBellPairFidelity(IQubit* first, IQubit* second) override;
+  double dblrand();
+
+  std::shared_ptr<const MemoryTransition> getMemoryTransition(const Matrix6d& transition_matrix);
+
+ protected:
+  std::unique_ptr<PauliFrameQubit> makeQubit(const IQubitId* id, std::unique_ptr<IConfiguration> conf, bool is_short_live);
+
+  std::unordered_map<const IQubitId*, std::unique_ptr<PauliFrameQubit>, IQubitId::Hash, IQubitId::Pred> qubits;
+  SimTime current_time;
+  const std::unique_ptr<IRandomNumberGenerator> rng;
+  std::unique_ptr<StationaryQubitConfiguration> config;
+  ICallback* callback = nullptr;
+  std::deque<IQubit*> short_live_qubit_pool;
+  MemoryTransitionCache memory_transitions;
+  int short_live_qubit_pool_size;  // this is used to generate qubit id for short live qubits in a pool; currenlty only photons.
+};
+}  // namespace quisp::backends::pauli_frame
@@ -0,0 +1,182 @@
+#include "MultiShotFrames.h"
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace quisp::backends::pauli_frame {
+namespace {
+// same order as the labels of SingleGateErrorModel and the memory error distribution
+enum class Pauli : int { I, X, Z, Y };
+}  // namespace
+
+MultiShotFrames::MultiShotFrames(int num_qubits, int num_shots, IRandomNumberGenerator *rng)
+    : num_qubits(num_qubits), num_shots(num_shots), num_words((num_shots + shots_per_word - 1) / shots_per_word), rng(rng) {
+  if (num_qubits <= 0 || num_shots <= 0) throw std::invalid_argument("MultiShotFrames: num_qubits and num_shots must be positive");
+  x.assign(offset(num_qubits), 0);
+  z.assign(offset(num_qubits), 0);
+  lost.assign(offset(num_qubits), 0);
+  for (int qubit = 0; qubit < num_qubits; qubit++) randomize(&z[offset(qubit)]);
+}
+
+MultiShotFrames::Word MultiShotFrames::randomWord() {
+  // a double has 53 random bits, take 32 from each of the two
+  auto high = static_cast<Word>(rng->doubleRandom() * 4294967296.0);
+  auto low = static_cast<Word>(rng->doubleRandom() * 4294967296.0);
+  return (high << 32) | low;
+}
+
+void MultiShotFrames::randomize(Word *frames) {
+  for (int i = 0; i < num_words; i++) frames[i] ^= randomWord();
+  // keep the bits past the last shot 0, the gates only move the bits within a shot
+  if (num_shots % shots_per_word != 0) frames[num_words - 1] &= (Word{1} << (num_shots % shots_per_word)) - 1;
+}
+
+template <typename F>
+void MultiShotFrames::forEachHit(double probability, F on_hit) {
+  if (probability <= 0) return;
+  if (probability >= 1) {
+    for (int shot = 0; shot < num_shots; shot++) on_hit(shot);
+    return;
+  }
+  // the gap to the next hit is geometric, so the rng is drawn once per hit instead of once per shot
+  double shot = -1;
+  while (true) {
+    shot += 1 + static_cast<double>(rng->geometricRandom(probability));
+    if (!(shot < num_shots)) return;
+    on_hit(static_cast<int>(shot));
+  }
+}
+
+void MultiShotFrames::applyPauli(int qubit, int shot, int pauli) {
+  switch (static_cast<Pauli>(pauli)) {
+    case Pauli::I:
+      break;
+    case Pauli::X:
+      flipBit(&x[offset(qubit)], shot);
+      break;
+    case Pauli::Z:
+      flipBit(&z[offset(qubit)], shot);
+      break;
+    case Pauli::Y:
+      flipBit(&x[offset(qubit)], shot);
+      flipBit(&z[offset(qubit)], shot);
+      break;
+  }
+}
+
+void MultiShotFrames::h(int qubit) {
+  auto *qx = &x[offset(qubit)];
+  auto *qz = &z[offset(qubit)];
+  for (int i = 0; i < num_words; i++) std::swap(qx[i], qz[i]);
+}
+
+void MultiShotFrames::s(int qubit) {
+  auto *qx = &x[offset(qubit)];
+  auto *qz = &z[offset(qubit)];
+  for (int i = 0; i < num_words; i++) qz[i] ^= qx[i];
+}
+
+void MultiShotFrames::cnot(int control, int target) {
+  auto *cx = &x[offset(control)];
+  auto *cz = &z[offset(control)];
+  auto *tx = &x[offset(target)];
+  auto *tz = &z[offset(target)];
+  auto *closs = &lost[offset(control)];
+  auto *tloss = &lost[offset(target)];
+  for (int i = 0; i < num_words; i++) {
+    tx[i] ^= cx[i];
+    cz[i] ^= tz[i];
+    // a gate with a lost qubit spoils the other one
+    auto either_lost = closs[i] | tloss[i];
+    closs[i] = either_lost;
+    tloss[i] = either_lost;
+  }
+}
+
+void MultiShotFrames::reset(int qubit) {
+  auto *qx = &x[offset(qubit)];
+  auto *qz = &z[offset(qubit)];
+  auto *qloss = &lost[offset(qubit)];
+  for (int i = 0; i < num_words; i++) {
+    qx[i] = 0;
+    qz[i] = 0;
+    qloss[i] = 0;
+  }
+  randomize(qz);
+}
+
+void MultiShotFrames::pauliError(int qubit, const SingleGateErrorModel &err) {
+  auto error_rate = err.pauli_error_rate;
+  // the label given an error: the rand falls into the error part of the distribution
+  forEachHit(error_rate, [&](int shot) { applyPauli(qubit, shot, err.distribution.sample(1 - error_rate * rng->doubleRandom())); });
+}
+
+void MultiShotFrames::twoQubitError(int control, int target, const TwoQubitGateErrorModel &err) {
+  auto error_rate = err.pauli_error_rate;
+  // label = 4 * (pauli on control) + (pauli on target), both in the order I, X, Y, Z
+  constexpr int paulis[4] = {static_cast<int>(Pauli::I), static_cast<int>(Pauli::X), static_cast<int>(Pauli::Y), static_cast<int>(Pauli::Z)};
+  forEachHit(error_rate, [&](int shot) {
+    auto label = err.distribution.sample(1 - error_rate * rng->doubleRandom());
+    applyPauli(control, shot, paulis[label / 4]);
+    applyPauli(target, shot, paulis[label % 4]);
+  });
+}
+
+void MultiShotFrames::memoryError(int qubit, const RowVector6d &distribution) {
+  auto error_rate = 1 - distribution(0, 0);
+  forEachHit(error_rate, [&](int shot) {
+    auto rand = distribution(0, 0) + error_rate * rng->doubleRandom();
+    int label = 1;
+    double ceil = distribution(0, 0) + distribution(0, 1);
+    while (label < 5 && rand >= ceil) ceil += distribution(0, ++label);
+    if (label < 4) {
+      applyPauli(qubit, shot, label);
+    } else {
+      // excitation and relaxation leave the qubit in a basis state, the entanglement is gone
+      lost[offset(qubit) + shot / shots_per_word] |= Word{1} << (shot % shots_per_word);
+    }
+  });
+}
+
+void MultiShotFrames::loss(int qubit, double probability) {
+  forEachHit(probability, [&](int shot) { lost[offset(qubit) + shot / shots_per_word] |= Word{1} << (shot % shots_per_word); });
+}
+
+std::vector<MultiShotFrames::Word> MultiShotFrames::measureZ(int qubit, double error_rate) {
+  auto *qx = &x[offset(qubit)];
+  std::vector<Word> flips(qx, qx + num_words);
+  forEachHit(error_rate, [&](int shot) { flipBit(flips.data(), shot); });
+  // a lost qubit gives a random outcome
+  auto *qloss = &lost[offset(qubit)];
+  for (int i = 0; i < num_words; i++) {
+    if (qloss[i] != 0) flips[i] ^= randomWord() & qloss[i];
+  }
+  // the Z eigenstate doesn't remember its Z frame
+  randomize(&z[offset(qubit)]);
+  return flips;
+}
+
+std::vector<MultiShotFrames::Word> MultiShotFrames::measureX(int qubit, double error_rate) {
+  h(qubit);
+  auto flips = measureZ(qubit, error_rate);
+  h(qubit);
+  return flips;
+}
+
+void MultiShotFrames::applyXIf(int qubit, const std::vector<Word> &shots) {
+  auto *qx = &x[offset(qubit)];
+  for (int i = 0; i < num_words; i++) qx[i] ^= shots.at(i);
+}
+
+void MultiShotFrames::applyZIf(int qubit, const std::vector<Word> &shots) {
+  auto *qz = &z[offset(qubit)];
+  for (int i = 0; i < num_words; i++) qz[i] ^= shots.at(i);
+}
+
+int MultiShotFrames::count(const std::vector<Word> &shots) {
+  int num = 0;
+  for (auto word : shots) num += __builtin_popcountll(word);
+  return num;
+}
+
+}  // namespace quisp::backends::pauli_frame
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "../GraphState/MemoryTransition.h"
+#include "../GraphState/types.h"
+#include "../interfaces/IRandomNumberGenerator.h"
+
+namespace quisp::backends::pauli_frame {
+using abstract::IRandomNumberGenerator;
+using graph_state::RowVector6d;
+using graph_state::types::SingleGateErrorModel;
+using graph_state::types::TwoQubitGateErrorModel;
+
+/**
+ * @brief the Pauli frames of many trajectories (shots) of the same circuit, one bit per shot in 64 bit words.
+ *
+ * A Clifford gate is a few word operations for 64 shots at once, and the errors are sampled by skipping to the next
+ * erroneous shot, so a repetition costs a fraction of a full simulation run. The measurements return the shots
+ * whose outcome is flipped from a noiseless reference run of the same circuit, e.g. with PauliFrameBackend without errors.
+ * The circuit must not branch on the outcomes; a Pauli correction on an outcome is applied to the flipped shots with applyXIf/applyZIf.
+ * Each qubit starts in |0> with a random Z frame, like after reset(), so the random outcomes are random in each shot.
+ */
+class MultiShotFrames {
+ public:
+  using Word = std::uint64_t;
+  static constexpr int shots_per_word = 64;
+
+  // the rng must outlive the frames
+  MultiShotFrames(int num_qubits, int num_shots, IRandomNumberGenerator *rng);
+
+  int numQubits() const { return num_qubits; }
+  int numShots() const { return num_shots; }
+  int numWords() const { return num_words; }
+
+  // the Pauli gates don't change the frames, they're in the reference run
+  void h(int qubit);
+  void s(int qubit);
+  void cnot(int control, int target);
+  void reset(int qubit);
+
+  // the errors, drawn independently in each shot
+  void pauliError(int qubit, const SingleGateErrorModel &err);
+  void twoQubitError(int control, int target, const TwoQubitGateErrorModel &err);
+  // distribution: clean, X, Z, Y, excited, relaxed like MemoryTransition::errorDistribution. the last two lose the qubit
+  void memoryError(int qubit, const RowVector6d &distribution);
+  void loss(int qubit, double probability);
+
+  // returns the shots with the flipped outcome, with the measurement error. the measured qubit collapses
+  std::vector<Word> measureZ(int qubit, double error_rate = 0);
+  std::vector<Word> measureX(int qubit, double error_rate = 0);
+
+  // the Pauli corrections on the outcomes: applies the gate in the shots of the mask
+  void applyXIf(int qubit, const std::vector<Word> &shots);
+  void applyZIf(int qubit, const std::vector<Word> &shots);
+
+  const Word *xFrames(int qubit) const { return &x[offset(qubit)]; }
+  const Word *zFrames(int qubit) const { return &z[offset(qubit)]; }
+  const Word *lostShots(int qubit) const { return &lost[offset(qubit)]; }
+
+  // the number of the shots in the mask
+  static int count(const std::vector<Word> &shots);
+
+ protected:
+  std::size_t offset(int qubit) const { return static_cast<std::size_t>(qubit) * num_words; }
+  Word randomWord();
+  void randomize(Word *frames);
+  void flipBit(Word *frames, int shot) { frames[shot / shots_per_word] ^= Word{1} << (shot % shots_per_word); }
+  void applyPauli(int qubit, int shot, int pauli);
+
+  // calls on_hit(shot) for each shot with probability, skipping the shots in between
+  template <typename F>
+  void forEachHit(double probability, F on_hit);
+
+  const int num_qubits;
+  const int num_shots;
+  const int num_words;
+  IRandomNumberGenerator *const rng;
+  // qubit major, the words of a qubit are contiguous
+  std::vector<Word> x;
+  std::vector<Word> z;
+  std::vector<Word> lost;
+};
+
+}  // namespace quisp::backends::pauli_frame
@@ -0,0 +1,100 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <vector>
+#include "Backend.h"
+#include "MultiShotFrames.h"
+#include "ShardedShotFrames.h"
+#include "backends/GraphState/test.h"
+
+namespace {
+using namespace quisp::backends::pauli_frame;
+using quisp::backends::StationaryQubitConfiguration;
+using quisp_test::backends::graph_state::QubitId;
+using quisp_test::backends::graph_state::TestRNG;
+
+// generate state.range(0) Bell pairs, swap them into one end to end pair and measure it, like a repeater chain.
+static void BM_PauliFrame_SwapChain(benchmark::State& state) {
+  SimTime::setScaleExp(-9);
+  auto* rng = new TestRNG();
+  auto conf = std::make_unique<StationaryQubitConfiguration>();
+  conf->cnot_gate_err_rate = 0.01;
+  PauliFrameBackend backend(std::unique_ptr<IRandomNumberGenerator>(rng), std::move(conf));
+  std::vector<IQubit*> qubits;
+  for (int i = 0; i < 2 * state.range(0); i++) qubits.push_back(backend.createQubit(new QubitId(i)));
+  for (auto _ : state) {
+    for (size_t i = 0; i < qubits.size(); i += 2) {
+      qubits[i]->gateH();
+      qubits[i]->gateCNOT(qubits[i + 1]);
+    }
+    for (size_t i = 1; i + 1 < qubits.size(); i += 2) {
+      qubits[i]->gateCNOT(qubits[i + 1]);
+      if (qubits[i + 1]->measureZ() == EigenvalueResult::MINUS_ONE) qubits.back()->gateX();
+      if (qubits[i]->measureX() == EigenvalueResult::MINUS_ONE) qubits.front()->gateZ();
+    }
+    benchmark::DoNotOptimize(qubits.front()->measureZ());
+    benchmark::DoNotOptimize(qubits.back()->measureZ());
+    for (auto* qubit : qubits) qubit->setFree();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PauliFrame_SwapChain)->Arg(2)->Arg(8)->Arg(32);
+
+// the same swap chain for state.range(1) shots at once, the items are the Bell pairs of all the shots.
+static void BM_MultiShot_SwapChain(benchmark::State& state) {
+  TestRNG rng;
+  rng.double_value = 0.5;
+  TwoQubitGateErrorModel cnot_error;
+  cnot_error.setParams(0.01, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1);
+  int num_qubits = 2 * state.range(0);
+  for (auto _ : state) {
+    MultiShotFrames frames(num_qubits, state.range(1), &rng);
+    for (int i = 0; i < num_qubits; i += 2) {
+      frames.h(i);
+      frames.cnot(i, i + 1);
+      frames.twoQubitError(i, i + 1, cnot_error);
+    }
+    for (int i = 1; i + 1 < num_qubits; i += 2) {
+      frames.cnot(i, i + 1);
+      frames.twoQubitError(i, i + 1, cnot_error);
+      frames.applyXIf(num_qubits - 1, frames.measureZ(i + 1));
+      frames.applyZIf(0, frames.measureX(i));
+    }
+    benchmark::DoNotOptimize(frames.measureZ(0));
+    benchmark::DoNotOptimize(frames.measureZ(num_qubits - 1));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(1));
+}
+BENCHMARK(BM_MultiShot_SwapChain)->Args({8, 64})->Args({8, 4096})->Args({32, 4096});
+
+// the same for 2^20 shots in shards of 2^14 on state.range(1) threads
+static void BM_ShardedShots_SwapChain(benchmark::State& state) {
+  TwoQubitGateErrorModel cnot_error;
+  cnot_error.setParams(0.01, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1);
+  auto make_rng = [](int shard) {
+    auto rng = std::make_unique<TestRNG>();
+    rng->double_value = 0.5;
+    return std::unique_ptr<IRandomNumberGenerator>(std::move(rng));
+  };
+  int num_qubits = 2 * state.range(0);
+  int num_shots = 1 << 20;
+  for (auto _ : state) {
+    ShardedShotFrames frames(num_qubits, num_shots, 1 << 14, make_rng, state.range(1));
+    for (int i = 0; i < num_qubits; i += 2) {
+      frames.h(i);
+      frames.cnot(i, i + 1);
+      frames.twoQubitError(i, i + 1, cnot_error);
+    }
+    for (int i = 1; i + 1 < num_qubits; i += 2) {
+      frames.cnot(i, i + 1);
+      frames.twoQubitError(i, i + 1, cnot_error);
+      frames.applyXIf(num_qubits - 1, frames.measureZ(i + 1));
+      frames.applyZIf(0, frames.measureX(i));
+    }
+    benchmark::DoNotOptimize(frames.measureZ(0));
+    benchmark::DoNotOptimize(frames.measureZ(num_qubits - 1));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) * num_shots);
+}
+BENCHMARK(BM_ShardedShots_SwapChain)->Args({8, 1})->Args({8, 4})->Unit(benchmark::kMillisecond);
+
+}  // namespace
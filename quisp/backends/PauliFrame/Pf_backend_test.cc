@@ -0,0 +1,362 @@
+#include <gtest/gtest.h>
+#include <test_utils/TestUtils.h>
+#include <memory>
+#include <stdexcept>
+#include "Backend.h"
+#include "Qubit.h"
+#include "backends/GraphState/test.h"
+#include "backends/interfaces/IConfiguration.h"
+
+namespace {
+using namespace quisp::backends::pauli_frame;
+using quisp::backends::StationaryQubitConfiguration;
+using quisp_test::backends::graph_state::QubitId;
+using quisp_test::backends::graph_state::TestRNG;
+
+class PfBackend : public PauliFrameBackend {
+ public:
+  using PauliFrameBackend::qubits;
+  PfBackend(std::unique_ptr<IRandomNumberGenerator> rng, std::unique_ptr<StationaryQubitConfiguration> config) : PauliFrameBackend(std::move(rng), std::move(config)) {}
+};
+
+class PfQubit : public PauliFrameQubit {
+ public:
+  using PauliFrameQubit::gate_err_cnot;
+  using PauliFrameQubit::measurement_err;
+  using PauliFrameQubit::memory_err;
+};
+
+class PfBackendTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    SimTime::setScaleExp(-9);
+    rng = new TestRNG();
+    backend = std::make_unique<PfBackend>(std::unique_ptr<IRandomNumberGenerator>(rng), std::make_unique<StationaryQubitConfiguration>());
+  }
+  PauliFrameQubit* createQubit(int id) { return dynamic_cast<PauliFrameQubit*>(backend->createQubit(new QubitId(id))); }
+  void makeBellPair(IQubit* left, IQubit* right) {
+    left->gateH();
+    left->gateCNOT(right);
+  }
+  TestRNG* rng;
+  std::unique_ptr<PfBackend> backend;
+};
+
+TEST_F(PfBackendTest, createAndGetQubit) {
+  auto* id = new QubitId(123);
+  auto* qubit = backend->createQubit(id);
+  EXPECT_EQ(backend->qubits.size(), 1);
+  ASSERT_THROW(backend->createQubit(id), std::runtime_error);
+  auto* same_id = new QubitId(123);
+  EXPECT_EQ(backend->getQubit(same_id), qubit);
+  ASSERT_THROW(backend->getQubit(new QubitId(4)), std::runtime_error);
+}
+
+TEST_F(PfBackendTest, createQubitWithInvalidConfiguration) {
+  auto conf = new IConfiguration;
+  ASSERT_THROW({ backend->createQubit(new QubitId(4), std::unique_ptr<IConfiguration>(conf)); }, std::runtime_error);
+}
+
+TEST_F(PfBackendTest, createQubitWithConfiguration) {
+  auto conf = std::make_unique<StationaryQubitConfiguration>();
+  conf->measurement_z_err_rate = 0.25;
+  conf->memory_x_err_rate = 0.26;
+  conf->cnot_gate_err_rate = 0.5;
+  conf->cnot_gate_xx_err_ratio = 1;
+  auto* qubit = reinterpret_cast<PfQubit*>(backend->createQubit(new QubitId(1), std::move(conf)));
+  EXPECT_EQ(qubit->measurement_err.z_error_rate, 0.25);
+  EXPECT_EQ(qubit->memory_err.x_error_rate, 0.26);
+  EXPECT_EQ(qubit->gate_err_cnot.xx_error_rate, 0.5);
+}
+
+TEST_F(PfBackendTest, singleQubitGates) {
+  auto* q = createQubit(1);
+  EXPECT_EQ(q->measureZ(), EigenvalueResult::PLUS_ONE);
+  q->gateX();
+  EXPECT_EQ(q->measureZ(), EigenvalueResult::MINUS_ONE);
+  q->setFree();
+  q->gateH();
+  EXPECT_EQ(q->measureX(), EigenvalueResult::PLUS_ONE);
+  q->gateZ();
+  EXPECT_EQ(q->measureX(), EigenvalueResult::MINUS_ONE);
+  q->setFree();
+  q->gateH();
+  q->gateS();
+  EXPECT_EQ(q->measureY(), EigenvalueResult::PLUS_ONE);
+  q->gateSdg();
+  EXPECT_EQ(q->measureX(), EigenvalueResult::PLUS_ONE);
+  q->gateSdg();
+  EXPECT_EQ(q->measureY(), EigenvalueResult::MINUS_ONE);
+  q->gateH();
+  EXPECT_EQ(q->measureY(), EigenvalueResult::PLUS_ONE);
+}
+
+TEST_F(PfBackendTest, bellPairCorrelations) {
+  auto* left = createQubit(1);
+  auto* right = createQubit(2);
+  for (double random_value : {0.2, 0.7}) {
+    rng->double_value = random_value;
+    makeBellPair(left, right);
+    EXPECT_EQ(left->getPartner(), right);
+    EXPECT_EQ(left->measureZ(), right->measureZ());
+    EXPECT_EQ(left->getPartner(), nullptr);
+    left->setFree();
+    right->setFree();
+
+    makeBellPair(left, right);
+    EXPECT_EQ(left->measureX(), right->measureX());
+    left->setFree();
+    right->setFree();
+
+    makeBellPair(left, right);
+    EXPECT_NE(left->measureY(), right->measureY());
+    left->setFree();
+    right->setFree();
+  }
+}
+
+TEST_F(PfBackendTest, frameTracksPauliOnEitherSide) {
+  auto* left = createQubit(1);
+  auto* right = createQubit(2);
+  makeBellPair(left, right);
+  right->gateX();
+  EXPECT_TRUE(right->hasXFrame());
+  EXPECT_EQ(left->getPartner(), right);
+  EXPECT_NE(left->measureZ(), right->measureZ());
+  left->setFree();
+  right->setFree();
+
+  makeBellPair(left, right);
+  left->gateZ();
+  EXPECT_NE(left->measureX(), right->measureX());
+}
+
+TEST_F(PfBackendTest, entanglementSwapping) {
+  for (bool control_first : {true, false}) {
+    for (double random_value : {0.2, 0.7}) {
+      rng->double_value = random_value;
+      auto* a = createQubit(1);
+      auto* b = createQubit(2);
+      auto* c = createQubit(3);
+      auto* d = createQubit(4);
+      makeBellPair(a, b);
+      makeBellPair(c, d);
+      b->gateCNOT(c);
+      EXPECT_TRUE(b->isLinked());
+      EigenvalueResult x_result, z_result;
+      if (control_first) {
+        x_result = b->measureX();
+        rng->double_value = 1 - random_value;
+        z_result = c->measureZ();
+      } else {
+        z_result = c->measureZ();
+        rng->double_value = 1 - random_value;
+        x_result = b->measureX();
+      }
+      EXPECT_EQ(a->getPartner(), d);
+      EXPECT_FALSE(a->isLinked());
+      if (z_result == EigenvalueResult::MINUS_ONE) d->gateX();
+      if (x_result == EigenvalueResult::MINUS_ONE) a->gateZ();
+      EXPECT_FALSE(a->hasZFrame() != d->hasZFrame());
+      EXPECT_FALSE(a->hasXFrame() != d->hasXFrame());
+      EXPECT_EQ(a->measureZ(), d->measureZ());
+      for (int i = 1; i <= 4; i++) backend->deleteQubit(new QubitId(i));
+    }
+  }
+}
+
+TEST_F(PfBackendTest, purificationOfCleanPairs) {
+  auto* a1 = createQubit(1);
+  auto* b1 = createQubit(2);
+  auto* a2 = createQubit(3);
+  auto* b2 = createQubit(4);
+  makeBellPair(a1, b1);
+  makeBellPair(a2, b2);
+  // each node purifies when its own rule fires
+  a1->gateCNOT(a2);
+  rng->double_value = 0.7;
+  auto a_result = a2->measureZ();
+  EXPECT_TRUE(b2->isLinked());
+  b1->gateCNOT(b2);
+  auto b_result = b2->measureZ();
+  EXPECT_EQ(a_result, b_result);
+  EXPECT_EQ(a1->getPartner(), b1);
+  EXPECT_EQ(a1->measureX(), b1->measureX());
+}
+
+TEST_F(PfBackendTest, purificationDetectsBitFlip) {
+  auto* a1 = createQubit(1);
+  auto* b1 = createQubit(2);
+  auto* a2 = createQubit(3);
+  auto* b2 = createQubit(4);
+  makeBellPair(a1, b1);
+  makeBellPair(a2, b2);
+  b1->gateX();
+  a1->gateCNOT(a2);
+  b1->gateCNOT(b2);
+  EXPECT_EQ(a1->getPartner(), b1);
+  EXPECT_NE(a2->measureZ(), b2->measureZ());
+}
+
+TEST_F(PfBackendTest, purificationSpreadsPhaseFlipToKeptPair) {
+  auto* a1 = createQubit(1);
+  auto* b1 = createQubit(2);
+  auto* a2 = createQubit(3);
+  auto* b2 = createQubit(4);
+  makeBellPair(a1, b1);
+  makeBellPair(a2, b2);
+  a2->gateZ();
+  a1->gateCNOT(a2);
+  b1->gateCNOT(b2);
+  EXPECT_EQ(a2->measureZ(), b2->measureZ());
+  EXPECT_NE(a1->measureX(), b1->measureX());
+}
+
+TEST_F(PfBackendTest, purifyZWithControlMeasuredFirst) {
+  // same as RuntimeCallback::purifyZ, the trash pair is the control and measured in X
+  auto* a1 = createQubit(1);
+  auto* b1 = createQubit(2);
+  auto* trash_a = createQubit(3);
+  auto* trash_b = createQubit(4);
+  makeBellPair(a1, b1);
+  makeBellPair(trash_a, trash_b);
+  trash_a->gateCNOT(a1);
+  auto a_result = trash_a->measureX();
+  trash_b->gateCNOT(b1);
+  EXPECT_EQ(a_result, trash_b->measureX());
+  EXPECT_EQ(a1->getPartner(), b1);
+}
+
+TEST_F(PfBackendTest, photonEmissionAndBellStateMeasurement) {
+  // same sequence as StationaryQubit::generateEntangledPhoton and BellStateAnalyzer::measureSuccessfully
+  auto* left = backend->createQubit(new QubitId(1));
+  auto* right = backend->createQubit(new QubitId(2));
+  auto* left_photon = backend->getShortLiveQubit();
+  auto* right_photon = backend->getShortLiveQubit();
+  left->noiselessH();
+  left->noiselessCNOT(left_photon);
+  right->noiselessH();
+  right->noiselessCNOT(right_photon);
+
+  left_photon->noiselessX();
+  left_photon->noiselessCNOT(right_photon);
+  left_photon->noiselessMeasureX(EigenvalueResult::PLUS_ONE);
+  right_photon->noiselessMeasureZ(EigenvalueResult::PLUS_ONE);
+  left_photon->relaseBackToPool();
+  right_photon->relaseBackToPool();
+
+  // the memories are now in Psi+: ZZ = -1, XX = +1
+  EXPECT_EQ(dynamic_cast<PauliFrameQubit*>(left)->getPartner(), right);
+  rng->double_value = 0.7;
+  auto l = left->noiselessMeasureZ();
+  auto r = right->noiselessMeasureZ();
+  EXPECT_NE(l, r);
+}
+
+TEST_F(PfBackendTest, freeingLinkedQubitKeepsOtherPair) {
+  auto* a = createQubit(1);
+  auto* b = createQubit(2);
+  auto* c = createQubit(3);
+  auto* d = createQubit(4);
+  makeBellPair(a, b);
+  makeBellPair(c, d);
+  b->gateCNOT(c);
+  a->setFree();
+  EXPECT_FALSE(b->isLinked());
+  EXPECT_EQ(b->getPartner(), nullptr);
+  EXPECT_EQ(c->getPartner(), d);
+  EXPECT_EQ(a->measureZ(), EigenvalueResult::PLUS_ONE);
+  backend->deleteQubit(new QubitId(3));
+  EXPECT_EQ(d->getPartner(), nullptr);
+}
+
+TEST_F(PfBackendTest, unsupportedOperationsThrow) {
+  auto* a = createQubit(1);
+  auto* b = createQubit(2);
+  auto* c = createQubit(3);
+  makeBellPair(a, b);
+  EXPECT_THROW(a->gateH(), std::runtime_error);
+  EXPECT_THROW(a->gateS(), std::runtime_error);
+  // CNOT from a Bell pair into |0> makes a GHZ state
+  EXPECT_FALSE(a->canApplyCNOT(c));
+  EXPECT_THROW(a->gateCNOT(c), std::runtime_error);
+  EXPECT_TRUE(c->canApplyCNOT(a));
+
+  auto* d = createQubit(4);
+  makeBellPair(c, d);
+  a->gateCNOT(c);
+  EXPECT_TRUE(a->canMeasure(Basis::X));
+  EXPECT_FALSE(a->canMeasure(Basis::Y));
+  a->measureX();
+  EXPECT_FALSE(b->canMeasure(Basis::X));
+  EXPECT_TRUE(b->canMeasure(Basis::Z));
+  EXPECT_THROW(b->measureX(), std::runtime_error);
+}
+
+TEST_F(PfBackendTest, bellPairFidelity) {
+  auto* a = createQubit(1);
+  auto* b = createQubit(2);
+  auto* c = createQubit(3);
+  auto* d = createQubit(4);
+  // |00>
+  EXPECT_DOUBLE_EQ(backend->getBellPairFidelity(a, b), 0.5);
+  makeBellPair(a, b);
+  EXPECT_DOUBLE_EQ(backend->getBellPairFidelity(a, b), 1);
+  EXPECT_DOUBLE_EQ(backend->getBellPairFidelity(b, a), 1);
+  EXPECT_DOUBLE_EQ(backend->getBellPairFidelity(a, c), 0.25);
+  b->gateZ();
+  EXPECT_DOUBLE_EQ(backend->getBellPairFidelity(a, b), 0);
+  // |0> and |1>
+  d->gateX();
+  EXPECT_DOUBLE_EQ(backend->getBellPairFidelity(c, d), 0);
+  EXPECT_THROW(backend->getBellPairFidelity(c, c), std::runtime_error);
+}
+
+TEST_F(PfBackendTest, bellPairFidelityWithPendingMemoryError) {
+  StationaryQubitConfiguration conf;
+  conf.memory_x_err_rate = 0.001;
+  conf.memory_z_err_rate = 0.002;
+  conf.memory_relaxation_rate = 0.003;
+  conf.memory_excitation_rate = 0.0005;
+  GraphStateBackend graph_state(std::make_unique<TestRNG>(), std::make_unique<StationaryQubitConfiguration>(conf));
+  auto* gs_left = graph_state.createQubit(new QubitId(1));
+  auto* gs_right = graph_state.createQubit(new QubitId(2));
+  auto* left = backend->createQubit(new QubitId(1), std::make_unique<StationaryQubitConfiguration>(conf));
+  auto* right = backend->createQubit(new QubitId(2), std::make_unique<StationaryQubitConfiguration>(conf));
+  makeBellPair(gs_left, gs_right);
+  makeBellPair(left, right);
+  graph_state.setSimTime(SimTime(100, omnetpp::SIMTIME_US));
+  backend->setSimTime(SimTime(100, omnetpp::SIMTIME_US));
+  // the same expected state as the graph state oracle, nothing is sampled
+  EXPECT_NEAR(backend->getBellPairFidelity(left, right), graph_state.getBellPairFidelity(gs_left, gs_right), 1e-12);
+  EXPECT_LT(backend->getBellPairFidelity(left, right), 1);
+  EXPECT_EQ(dynamic_cast<PauliFrameQubit*>(left)->getPartner(), right);
+}
+
+TEST_F(PfBackendTest, cnotGateError) {
+  auto conf = std::make_unique<StationaryQubitConfiguration>();
+  conf->cnot_gate_err_rate = 1.0;
+  conf->cnot_gate_xz_err_ratio = 1;
+  auto* control = backend->createQubit(new QubitId(1), std::make_unique<StationaryQubitConfiguration>(*conf));
+  auto* target = backend->createQubit(new QubitId(2), std::move(conf));
+  rng->double_value = 0.99;
+  control->gateCNOT(target);
+  // XZ error: X on control, Z on target (which does not flip |0>)
+  EXPECT_EQ(control->measureZ(), EigenvalueResult::MINUS_ONE);
+  EXPECT_EQ(target->measureZ(), EigenvalueResult::PLUS_ONE);
+}
+
+TEST_F(PfBackendTest, memoryRelaxation) {
+  auto conf = std::make_unique<StationaryQubitConfiguration>();
+  conf->memory_relaxation_rate = 0.5;
+  auto* qubit = dynamic_cast<PauliFrameQubit*>(backend->createQubit(new QubitId(1), std::move(conf)));
+  auto* partner = createQubit(2);
+  makeBellPair(partner, qubit);
+  backend->setSimTime(SimTime(1000, omnetpp::SIMTIME_US));
+  // relaxation is the last label in the distribution
+  rng->double_value = 1.0;
+  EXPECT_EQ(qubit->measureZ(), EigenvalueResult::PLUS_ONE);
+  EXPECT_EQ(partner->getPartner(), nullptr);
+}
+
+}  // namespace
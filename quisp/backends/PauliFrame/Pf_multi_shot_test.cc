@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include "MultiShotFrames.h"
+
+namespace {
+using namespace quisp::backends::pauli_frame;
+using Word = MultiShotFrames::Word;
+
+class MersenneRNG : public IRandomNumberGenerator {
+ public:
+  double doubleRandom() override { return std::uniform_real_distribution<double>(0, 1)(engine); }
+  std::mt19937_64 engine{42};
+};
+
+std::vector<Word> xorShots(const std::vector<Word> &a, const std::vector<Word> &b) {
+  std::vector<Word> result(a.size());
+  for (size_t i = 0; i < a.size(); i++) result[i] = a[i] ^ b[i];
+  return result;
+}
+
+class MultiShotFramesTest : public ::testing::Test {
+ protected:
+  void bellPair(MultiShotFrames &frames, int first, int second) {
+    frames.h(first);
+    frames.cnot(first, second);
+  }
+  MersenneRNG rng;
+};
+
+TEST_F(MultiShotFramesTest, BellPairOutcomesAreRandomButCorrelated) {
+  // 1000 shots, the last word is partially used
+  MultiShotFrames frames(2, 1000, &rng);
+  EXPECT_EQ(frames.numWords(), 16);
+  bellPair(frames, 0, 1);
+  auto first = frames.measureZ(0);
+  auto second = frames.measureZ(1);
+  EXPECT_EQ(MultiShotFrames::count(xorShots(first, second)), 0);
+  // the reference outcome is flipped in about half of the shots
+  EXPECT_NEAR(MultiShotFrames::count(first), 500, 60);
+  EXPECT_EQ(first.back() >> (1000 % 64), 0);
+}
+
+TEST_F(MultiShotFramesTest, ErrorsInEachShot) {
+  MultiShotFrames frames(2, 64 * 100, &rng);
+  SingleGateErrorModel x_error;
+  x_error.setParams(1, 0, 0, 0.1);
+  bellPair(frames, 0, 1);
+  frames.pauliError(1, x_error);
+  auto zz = xorShots(frames.measureZ(0), frames.measureZ(1));
+  EXPECT_NEAR(MultiShotFrames::count(zz), 640, 80);
+
+  // a Z error doesn't flip the Z outcome
+  MultiShotFrames z_frames(2, 64 * 100, &rng);
+  SingleGateErrorModel z_error;
+  z_error.setParams(0, 0, 1, 1);
+  bellPair(z_frames, 0, 1);
+  z_frames.pauliError(0, z_error);
+  EXPECT_EQ(MultiShotFrames::count(xorShots(z_frames.measureZ(0), z_frames.measureZ(1))), 0);
+}
+
+TEST_F(MultiShotFramesTest, CnotSpreadsErrors) {
+  MultiShotFrames frames(2, 256, &rng);
+  SingleGateErrorModel x_error;
+  x_error.setParams(1, 0, 0, 1);
+  frames.pauliError(0, x_error);
+  frames.cnot(0, 1);
+  EXPECT_EQ(MultiShotFrames::count(frames.measureZ(0)), 256);
+  EXPECT_EQ(MultiShotFrames::count(frames.measureZ(1)), 256);
+}
+
+TEST_F(MultiShotFramesTest, SwappingWithCorrectionMasks) {
+  // Bell pairs (0, 1) and (2, 3), the swapping at 1 and 2 makes (0, 3)
+  for (bool check_xx : {false, true}) {
+    MultiShotFrames frames(4, 512, &rng);
+    bellPair(frames, 0, 1);
+    bellPair(frames, 2, 3);
+    frames.cnot(1, 2);
+    frames.h(1);
+    auto m1 = frames.measureZ(1);
+    auto m2 = frames.measureZ(2);
+    frames.applyXIf(3, m2);
+    frames.applyZIf(0, m1);
+    if (check_xx) {
+      EXPECT_EQ(MultiShotFrames::count(xorShots(frames.measureX(0), frames.measureX(3))), 0);
+    } else {
+      EXPECT_EQ(MultiShotFrames::count(xorShots(frames.measureZ(0), frames.measureZ(3))), 0);
+    }
+  }
+}
+
+TEST_F(MultiShotFramesTest, LostQubitGivesRandomOutcomes) {
+  MultiShotFrames frames(2, 64 * 50, &rng);
+  bellPair(frames, 0, 1);
+  frames.loss(1, 1);
+  auto zz = xorShots(frames.measureZ(0), frames.measureZ(1));
+  EXPECT_NEAR(MultiShotFrames::count(zz), 1600, 150);
+  frames.reset(1);
+  EXPECT_EQ(frames.lostShots(1)[0], 0);
+  EXPECT_EQ(MultiShotFrames::count(frames.measureZ(1)), 0);
+}
+
+}  // namespace
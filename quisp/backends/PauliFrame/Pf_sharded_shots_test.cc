@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <random>
+#include <vector>
+#include "ShardedShotFrames.h"
+
+namespace {
+using namespace quisp::backends::pauli_frame;
+using Word = ShardedShotFrames::Word;
+
+class MersenneRNG : public IRandomNumberGenerator {
+ public:
+  explicit MersenneRNG(int seed) : engine(seed) {}
+  double doubleRandom() override { return std::uniform_real_distribution<double>(0, 1)(engine); }
+  std::mt19937_64 engine;
+};
+
+std::unique_ptr<IRandomNumberGenerator> rngOfShard(int shard) { return std::make_unique<MersenneRNG>(42 + shard); }
+
+std::vector<Word> xorShots(const std::vector<Word> &a, const std::vector<Word> &b) {
+  std::vector<Word> result(a.size());
+  for (size_t i = 0; i < a.size(); i++) result[i] = a[i] ^ b[i];
+  return result;
+}
+
+// Bell pairs (0, 1) and (2, 3) with X errors, swapped at 1 and 2 into (0, 3). returns the ZZ parity of (0, 3)
+std::vector<Word> noisySwapping(ShardedShotFrames &frames) {
+  SingleGateErrorModel x_error;
+  x_error.setParams(1, 0, 0, 0.05);
+  for (int first : {0, 2}) {
+    frames.h(first);
+    frames.cnot(first, first + 1);
+    frames.pauliError(first + 1, x_error);
+  }
+  frames.cnot(1, 2);
+  frames.h(1);
+  auto m1 = frames.measureZ(1);
+  auto m2 = frames.measureZ(2);
+  frames.applyXIf(3, m2);
+  frames.applyZIf(0, m1);
+  return xorShots(frames.measureZ(0), frames.measureZ(3));
+}
+
+TEST(ShardedShotFramesTest, Shards) {
+  ShardedShotFrames frames(2, 1000, 200, rngOfShard, 2);
+  // 200 shots round up to 4 words, the last shard has the rest
+  EXPECT_EQ(frames.numShards(), 4);
+  EXPECT_EQ(frames.numWords(), 16);
+  EXPECT_EQ(frames.shard(3).numShots(), 1000 - 3 * 256);
+  EXPECT_THROW(ShardedShotFrames(2, 1000, 0, rngOfShard, 1), std::invalid_argument);
+}
+
+TEST(ShardedShotFramesTest, BellPairOutcomesAreRandomButCorrelated) {
+  ShardedShotFrames frames(2, 1000, 128, rngOfShard, 4);
+  frames.h(0);
+  frames.cnot(0, 1);
+  auto first = frames.measureZ(0);
+  auto second = frames.measureZ(1);
+  EXPECT_EQ(MultiShotFrames::count(xorShots(first, second)), 0);
+  EXPECT_NEAR(MultiShotFrames::count(first), 500, 60);
+  EXPECT_EQ(first.back() >> (1000 % 64), 0);
+}
+
+TEST(ShardedShotFramesTest, SwappingWithCorrectionMasks) {
+  ShardedShotFrames frames(4, 64 * 100, 64 * 8, rngOfShard, 4);
+  auto zz = noisySwapping(frames);
+  // one of the two X errors flips the parity
+  EXPECT_NEAR(MultiShotFrames::count(zz), 6400 * 2 * 0.05 * 0.95, 100);
+}
+
+TEST(ShardedShotFramesTest, SameOutcomesOnAnyNumberOfThreads) {
+  ShardedShotFrames one_thread(4, 64 * 40, 64 * 3, rngOfShard, 1);
+  ShardedShotFrames four_threads(4, 64 * 40, 64 * 3, rngOfShard, 4);
+  EXPECT_EQ(noisySwapping(one_thread), noisySwapping(four_threads));
+}
+
+}  // namespace
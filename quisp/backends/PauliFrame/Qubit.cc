@@ -0,0 +1,486 @@
+#include "Qubit.h"
+#include <cmath>
+#include <stdexcept>
+#include "Backend.h"
+#include "utils/UtilFunctions.h"
+
+namespace quisp::backends::pauli_frame {
+using util_functions::samplingWithWeights;
+
+namespace {
+enum class Pauli : int { I, X, Z, Y };
+
+EigenvalueResult toEigenvalue(bool is_minus) { return is_minus ? EigenvalueResult::MINUS_ONE : EigenvalueResult::PLUS_ONE; }
+}  // namespace
+
+PauliFrameQubit::PauliFrameQubit(const IQubitId *id, PauliFrameBackend *const backend, bool is_short_live) : id(id), backend(backend), is_short_live(is_short_live) {}
+
+PauliFrameQubit::~PauliFrameQubit() {}
+
+const IQubitId *const PauliFrameQubit::getId() const { return id; }
+
+void PauliFrameQubit::relaseBackToPool() {
+  if (!is_short_live) {
+    throw std::runtime_error("cannot release non short-live qubit");
+  }
+  backend->returnToPool(this);
+}
+
+void PauliFrameQubit::configure(std::unique_ptr<StationaryQubitConfiguration> c) {
+  setMemoryErrorRates(c->memory_x_err_rate, c->memory_y_err_rate, c->memory_z_err_rate, c->memory_excitation_rate, c->memory_relaxation_rate);
+  measurement_err.setParams(c->measurement_x_err_rate, c->measurement_y_err_rate, c->measurement_z_err_rate);
+  gate_err_h.setParams(c->h_gate_x_err_ratio, c->h_gate_y_err_ratio, c->h_gate_z_err_ratio, c->h_gate_err_rate);
+  gate_err_x.setParams(c->x_gate_x_err_ratio, c->x_gate_y_err_ratio, c->x_gate_z_err_ratio, c->x_gate_err_rate);
+  gate_err_z.setParams(c->z_gate_x_err_ratio, c->z_gate_y_err_ratio, c->z_gate_z_err_ratio, c->z_gate_err_rate);
+  gate_err_cnot.setParams(c->cnot_gate_err_rate, c->cnot_gate_ix_err_ratio, c->cnot_gate_iy_err_ratio, c->cnot_gate_iz_err_ratio, c->cnot_gate_xi_err_ratio,
+                          c->cnot_gate_xx_err_ratio, c->cnot_gate_xy_err_ratio, c->cnot_gate_xz_err_ratio, c->cnot_gate_yi_err_ratio, c->cnot_gate_yx_err_ratio,
+                          c->cnot_gate_yy_err_ratio, c->cnot_gate_yz_err_ratio, c->cnot_gate_zi_err_ratio, c->cnot_gate_zx_err_ratio, c->cnot_gate_zy_err_ratio,
+                          c->cnot_gate_zz_err_ratio);
+}
+
+void PauliFrameQubit::setMemoryErrorRates(double x_error_rate, double y_error_rate, double z_error_rate, double excitation_rate, double relaxation_rate) {
+  memory_err.x_error_rate = x_error_rate;
+  memory_err.y_error_rate = y_error_rate;
+  memory_err.z_error_rate = z_error_rate;
+  memory_err.excitation_error_rate = excitation_rate;
+  memory_err.relaxation_error_rate = relaxation_rate;
+  memory_err.error_rate = x_error_rate + y_error_rate + z_error_rate + excitation_rate + relaxation_rate;  // This is per μs.
+  memory_transition = backend->getMemoryTransition(MemoryTransition::transitionMatrix(x_error_rate, y_error_rate, z_error_rate, excitation_rate, relaxation_rate));
+}
+
+void PauliFrameQubit::applyPauli(int pauli) {
+  switch (static_cast<Pauli>(pauli)) {
+    case Pauli::I:
+      break;
+    case Pauli::X:
+      frame_x = !frame_x;
+      break;
+    case Pauli::Z:
+      frame_z = !frame_z;
+      break;
+    case Pauli::Y:
+      frame_x = !frame_x;
+      frame_z = !frame_z;
+      break;
+  }
+}
+
+void PauliFrameQubit::applySingleQubitGateError(SingleGateErrorModel const &err) {
+  if (err.pauli_error_rate == 0) {
+    return;
+  }
+  applyPauli(static_cast<int>(err.distribution.sample(backend->dblrand())));
+}
+
+void PauliFrameQubit::applyTwoQubitGateError(TwoQubitGateErrorModel const &err, PauliFrameQubit *another_qubit) {
+  if (err.pauli_error_rate == 0) {
+    return;
+  }
+  // label = 4 * (pauli on this qubit) + (pauli on another qubit), both in the order I, X, Y, Z
+  constexpr int paulis[4] = {static_cast<int>(Pauli::I), static_cast<int>(Pauli::X), static_cast<int>(Pauli::Y), static_cast<int>(Pauli::Z)};
+  auto label = err.distribution.sample(backend->dblrand());
+  applyPauli(paulis[label / 4]);
+  another_qubit->applyPauli(paulis[label % 4]);
+}
+
+void PauliFrameQubit::applyMemoryError() {
+  // If no memory error occurs, skip this memory error simulation.
+  if (memory_err.error_rate == 0) return;
+
+  SimTime current_time = backend->getSimTime();
+  double time_evolution_microsec = (current_time.dbl() - updated_time.dbl()) * 1000000;
+  if (time_evolution_microsec > 0) {
+    // Clean, X, Z, Y, Excited, Relaxed
+    RowVector6d pi_vector = memory_transition->errorDistribution(time_evolution_microsec);
+    double sum = pi_vector.sum();
+    if (sum > 1.01 || sum < 0.99 || std::isnan(pi_vector(0, 0))) {
+      throw std::runtime_error("PauliFrameQubit::applyMemoryError: invalid memory error distribution");
+    }
+
+    std::map<int, double> weights = {{0, pi_vector(0, 0)}, {1, pi_vector(0, 1)}, {2, pi_vector(0, 2)}, {3, pi_vector(0, 3)}, {4, pi_vector(0, 4)}, {5, pi_vector(0, 5)}};
+    int r = samplingWithWeights(weights, backend->dblrand());
+    if (r < 4) {
+      applyPauli(r);
+    } else {
+      // excitation ends in |1>, relaxation ends in |0>, either way the entanglement is gone.
+      discard();
+      setUnpaired(Basis::Z, r == 4);
+    }
+  }
+  updated_time = current_time;
+}
+
+RowVector6d PauliFrameQubit::pendingMemoryError() const {
+  // Clean, X, Z, Y, Excited, Relaxed
+  RowVector6d clean = RowVector6d::Zero();
+  clean(0, 0) = 1;
+  if (memory_err.error_rate == 0) return clean;
+  double time_evolution_microsec = (backend->getSimTime().dbl() - updated_time.dbl()) * 1000000;
+  if (time_evolution_microsec <= 0) return clean;
+  return memory_transition->errorDistribution(time_evolution_microsec);
+}
+
+EigenvalueResult PauliFrameQubit::flipWithProbability(EigenvalueResult result, double probability) {
+  if (backend->dblrand() < probability) {
+    return result == EigenvalueResult::PLUS_ONE ? EigenvalueResult::MINUS_ONE : EigenvalueResult::PLUS_ONE;
+  }
+  return result;
+}
+
+// reference state and frame
+
+void PauliFrameQubit::frameH() { std::swap(frame_x, frame_z); }
+
+void PauliFrameQubit::frameS() {
+  // S X Sdg = Y and Sdg X S = -Y, the sign is a global phase
+  frame_z = frame_z != frame_x;
+}
+
+void PauliFrameQubit::frameCNOT(PauliFrameQubit *target) {
+  // X on the control spreads to the target, Z on the target spreads to the control.
+  target->frame_x = target->frame_x != frame_x;
+  frame_z = frame_z != target->frame_z;
+}
+
+bool PauliFrameQubit::frameFlips(Basis measured_basis) const {
+  switch (measured_basis) {
+    case Basis::Z:
+      return frame_x;
+    case Basis::X:
+      return frame_z;
+    case Basis::Y:
+      return frame_x != frame_z;
+  }
+  return false;
+}
+
+bool PauliFrameQubit::canApplyCNOT(const PauliFrameQubit *target) const {
+  // the same cases as applyCNOT
+  if (target == this) return false;
+  if (link != nullptr || target->link != nullptr) return link == target->link && link->hasControl(this) && link->hasTarget(target);
+  if (partner == target || (partner != nullptr && target->partner != nullptr)) return true;
+  if ((partner == nullptr && basis == Basis::Z) || (target->partner == nullptr && target->basis == Basis::X)) return true;
+  return partner == nullptr && target->partner == nullptr && basis == Basis::X && target->basis == Basis::Z;
+}
+
+bool PauliFrameQubit::canMeasure(Basis measured_basis) const {
+  // the same cases as measureLinked: the measurements commuting with the CNOT, and the first of each pair that doesn't
+  if (link == nullptr) return true;
+  if (link->hasControl(this)) return measured_basis == Basis::Z || (measured_basis == Basis::X && !link->control_measured);
+  return measured_basis == Basis::X || (measured_basis == Basis::Z && !link->target_measured);
+}
+
+void PauliFrameQubit::setUnpaired(Basis new_basis, bool value) {
+  basis = new_basis;
+  partner = nullptr;
+  link = nullptr;
+  frame_x = new_basis == Basis::Z && value;
+  frame_z = new_basis != Basis::Z && value;
+}
+
+void PauliFrameQubit::pairWith(PauliFrameQubit *another) {
+  partner = another;
+  another->partner = this;
+  link = nullptr;
+  another->link = nullptr;
+}
+
+bool PauliFrameQubit::randomReference(Basis measured_basis, int forced_outcome) {
+  // a forced outcome fixes the measured value, i.e. the reference bit xor this qubit's frame.
+  if (forced_outcome >= 0) return (forced_outcome == 1) != frameFlips(measured_basis);
+  return !(backend->dblrand() < 0.5);
+}
+
+bool PauliFrameQubit::measure(Basis measured_basis, int forced_outcome) {
+  if (link != nullptr) {
+    return measureLinked(measured_basis, forced_outcome);
+  }
+  if (partner != nullptr) {
+    // |Phi+> is stabilized by XX and ZZ and has YY = -1
+    bool reference = randomReference(measured_basis, forced_outcome);
+    bool outcome = reference != frameFlips(measured_basis);
+    bool partner_reference = measured_basis == Basis::Y ? !reference : reference;
+    partner->setUnpaired(measured_basis, partner_reference != partner->frameFlips(measured_basis));
+    setUnpaired(measured_basis, outcome);
+    return outcome;
+  }
+  bool outcome;
+  if (basis == measured_basis) {
+    outcome = frameFlips(measured_basis);
+  } else {
+    outcome = randomReference(measured_basis, forced_outcome) != frameFlips(measured_basis);
+  }
+  setUnpaired(measured_basis, outcome);
+  return outcome;
+}
+
+bool PauliFrameQubit::measureLinked(Basis measured_basis, int forced_outcome) {
+  auto current_link = link;
+  auto &controls = current_link->controls;
+  auto &targets = current_link->targets;
+  auto settle = [](PauliFrameQubit *qubit, Basis basis, bool reference) {
+    if (qubit != nullptr) qubit->setUnpaired(basis, reference != qubit->frameFlips(basis));
+  };
+  auto remaining = [](PauliFrameQubit *(&qubits)[2]) { return qubits[0] != nullptr ? qubits[0] : qubits[1]; };
+  auto remove = [this](PauliFrameQubit *(&qubits)[2]) {
+    for (auto &qubit : qubits) {
+      if (qubit == this) qubit = nullptr;
+    }
+  };
+  bool reference = randomReference(measured_basis, forced_outcome);
+  bool outcome = reference != frameFlips(measured_basis);
+  bool is_control = current_link->hasControl(this);
+  bool nothing_measured = !current_link->control_measured && !current_link->target_measured;
+
+  if (is_control && measured_basis == Basis::Z && (nothing_measured || current_link->control_measured)) {
+    // Z on the control commutes with the CNOT: the control pair collapses and the target pair stays entangled.
+    remove(controls);
+    settle(remaining(controls), Basis::Z, reference);
+    targets[0]->frame_x = targets[0]->frame_x != reference;
+    targets[0]->pairWith(targets[1]);
+  } else if (!is_control && measured_basis == Basis::X && (nothing_measured || current_link->target_measured)) {
+    // X on the target commutes with the CNOT: the target pair collapses and the control pair stays entangled.
+    remove(targets);
+    settle(remaining(targets), Basis::X, reference);
+    controls[0]->frame_z = controls[0]->frame_z != reference;
+    controls[0]->pairWith(controls[1]);
+  } else if (is_control && measured_basis == Basis::Z && current_link->target_measured) {
+    remove(controls);
+    settle(remaining(controls), Basis::Z, reference);
+    settle(remaining(targets), Basis::Z, reference != current_link->target_result);
+  } else if (!is_control && measured_basis == Basis::X && current_link->control_measured) {
+    remove(targets);
+    settle(remaining(targets), Basis::X, reference);
+    settle(remaining(controls), Basis::X, reference != current_link->control_result);
+  } else if (is_control && measured_basis == Basis::X && !current_link->control_measured) {
+    remove(controls);
+    current_link->control_measured = true;
+    current_link->control_result = reference;
+  } else if (!is_control && measured_basis == Basis::Z && !current_link->target_measured) {
+    remove(targets);
+    current_link->target_measured = true;
+    current_link->target_result = reference;
+  } else {
+    throw std::runtime_error("PauliFrameQubit::measure: unsupported measurement on a qubit in a pending CNOT");
+  }
+
+  if (current_link->control_measured && current_link->target_measured) {
+    // entanglement swapping: the remaining qubits form a pair up to X^{target result} and Z^{control result}
+    auto *control = remaining(controls);
+    auto *target = remaining(targets);
+    control->frame_z = control->frame_z != current_link->control_result;
+    target->frame_x = target->frame_x != current_link->target_result;
+    control->pairWith(target);
+  }
+  setUnpaired(measured_basis, outcome);
+  return outcome;
+}
+
+void PauliFrameQubit::resolveLinkByCNOT(PauliFrameQubit *target) {
+  auto current_link = link;
+  if (current_link->control_measured) {
+    // the control pair had a qubit measured in X, the other one ends up in an X eigenstate.
+    setUnpaired(Basis::X, current_link->control_result != frameFlips(Basis::X));
+    current_link->targets[0]->pairWith(current_link->targets[1]);
+  } else if (current_link->target_measured) {
+    target->setUnpaired(Basis::Z, current_link->target_result != target->frameFlips(Basis::Z));
+    current_link->controls[0]->pairWith(current_link->controls[1]);
+  } else {
+    // bilateral CNOT preserves |Phi+> |Phi+>
+    current_link->controls[0]->pairWith(current_link->controls[1]);
+    current_link->targets[0]->pairWith(current_link->targets[1]);
+  }
+}
+
+void PauliFrameQubit::applyCNOT(PauliFrameQubit *target) {
+  if (target == this) {
+    throw std::runtime_error("PauliFrameQubit::gateCNOT: control and target must be different qubits");
+  }
+  if (link != nullptr || target->link != nullptr) {
+    if (link == target->link && link->hasControl(this) && link->hasTarget(target)) {
+      frameCNOT(target);
+      resolveLinkByCNOT(target);
+      return;
+    }
+    throw std::runtime_error("PauliFrameQubit::gateCNOT: unsupported CNOT on a qubit in a pending CNOT");
+  }
+  frameCNOT(target);
+  if (partner == target) {
+    // CNOT |Phi+> = |+>|0>
+    setUnpaired(Basis::X, frameFlips(Basis::X));
+    target->setUnpaired(Basis::Z, target->frameFlips(Basis::Z));
+  } else if (partner != nullptr && target->partner != nullptr) {
+    auto new_link = std::make_shared<CnotLink>();
+    new_link->controls[0] = this;
+    new_link->controls[1] = partner;
+    new_link->targets[0] = target;
+    new_link->targets[1] = target->partner;
+    for (auto *qubit : {new_link->controls[0], new_link->controls[1], new_link->targets[0], new_link->targets[1]}) {
+      qubit->partner = nullptr;
+      qubit->link = new_link;
+    }
+  } else if (partner == nullptr && basis == Basis::Z) {
+    // the control is in a Z eigenstate and the reference state does not change.
+  } else if (target->partner == nullptr && target->basis == Basis::X) {
+    // the target is in an X eigenstate and the reference state does not change.
+  } else if (partner == nullptr && target->partner == nullptr && basis == Basis::X && target->basis == Basis::Z) {
+    // CNOT |+>|0> = |Phi+>
+    pairWith(target);
+  } else {
+    throw std::runtime_error("PauliFrameQubit::gateCNOT: the resulting state is not a product of Bell pairs");
+  }
+}
+
+void PauliFrameQubit::discard() {
+  // tracing out this qubit is the same as measuring it and forgetting the outcome.
+  if (link != nullptr) {
+    measureLinked(link->hasControl(this) ? Basis::Z : Basis::X, -1);
+  } else if (partner != nullptr) {
+    measure(Basis::Z);
+  }
+}
+
+// public member functions
+
+void PauliFrameQubit::setFree() {
+  discard();
+  setUnpaired(Basis::Z, false);
+  updated_time = backend->getSimTime();
+}
+
+double PauliFrameQubit::bellPairFidelity(const PauliFrameQubit *another) const {
+  if (another == this) throw std::runtime_error("bellPairFidelity: the qubits of a pair must differ");
+  if (link != nullptr || another->link != nullptr) throw std::runtime_error("PauliFrameQubit::bellPairFidelity: unsupported on a qubit in a pending CNOT");
+  const RowVector6d errors[2] = {pendingMemoryError(), another->pendingMemoryError()};
+  if (partner == another) {
+    // X^x Z^z on both halves keeps |Phi+> if x and z agree, otherwise it's another Bell state
+    auto has_x = [](int pauli) { return pauli == static_cast<int>(Pauli::X) || pauli == static_cast<int>(Pauli::Y); };
+    auto has_z = [](int pauli) { return pauli == static_cast<int>(Pauli::Z) || pauli == static_cast<int>(Pauli::Y); };
+    double fidelity = 0;
+    for (int a = 0; a < 4; a++) {
+      for (int b = 0; b < 4; b++) {
+        if ((frame_x != has_x(a)) == (another->frame_x != has_x(b)) && (frame_z != has_z(a)) == (another->frame_z != has_z(b))) fidelity += errors[0](0, a) * errors[1](0, b);
+      }
+    }
+    // a reset half leaves the other one maximally mixed, two resets leave |k>|l>
+    double paulis[2] = {errors[0].head<4>().sum(), errors[1].head<4>().sum()};
+    fidelity += ((1 - paulis[0]) * paulis[1] + paulis[0] * (1 - paulis[1])) / 4;
+    fidelity += (errors[0](0, 4) * errors[1](0, 4) + errors[0](0, 5) * errors[1](0, 5)) / 2;
+    return fidelity;
+  }
+
+  // a product state, F = (1 + <Z><Z> + <X><X> - <Y><Y>) / 4 with the Bloch vectors in the order of Basis
+  auto bloch_vector = [](const PauliFrameQubit *qubit, const RowVector6d &error) {
+    // the Paulis flipping each component: X and Y flip Z, Z and Y flip X, X and Z flip Y
+    constexpr int flipping[3][2] = {{1, 3}, {2, 3}, {1, 2}};
+    Eigen::Vector3d r = Eigen::Vector3d::Zero();
+    // a half of a pair with another qubit is maximally mixed
+    if (qubit->partner == nullptr) r(static_cast<int>(qubit->basis)) = qubit->frameFlips(qubit->basis) ? -1 : 1;
+    for (int k = 0; k < 3; k++) r(k) *= error.head<4>().sum() - 2 * (error(0, flipping[k][0]) + error(0, flipping[k][1]));
+    // excitation ends in |1>, relaxation in |0>
+    r(static_cast<int>(Basis::Z)) += error(0, 5) - error(0, 4);
+    return r;
+  };
+  Eigen::Vector3d first = bloch_vector(this, errors[0]), second = bloch_vector(another, errors[1]);
+  return (1 + first(0) * second(0) + first(1) * second(1) - first(2) * second(2)) / 4;
+}
+
+void PauliFrameQubit::gateCNOT(IQubit *const target_qubit) {
+  auto pf_target_qubit = dynamic_cast<PauliFrameQubit *>(target_qubit);
+  applyMemoryError();
+  pf_target_qubit->applyMemoryError();
+  applyCNOT(pf_target_qubit);
+  applyTwoQubitGateError(gate_err_cnot, pf_target_qubit);
+}
+
+void PauliFrameQubit::gateH() {
+  applyMemoryError();
+  noiselessH();
+  applySingleQubitGateError(gate_err_h);
+}
+void PauliFrameQubit::gateZ() {
+  applyMemoryError();
+  applyPauli(static_cast<int>(Pauli::Z));
+  applySingleQubitGateError(gate_err_z);
+}
+void PauliFrameQubit::gateX() {
+  applyMemoryError();
+  applyPauli(static_cast<int>(Pauli::X));
+  applySingleQubitGateError(gate_err_x);
+}
+void PauliFrameQubit::gateY() {
+  applyMemoryError();
+  applyPauli(static_cast<int>(Pauli::Y));
+  // same as GraphStateQubit, Y uses the X gate error
+  applySingleQubitGateError(gate_err_x);
+}
+void PauliFrameQubit::gateS() {
+  if (partner != nullptr || link != nullptr) {
+    throw std::runtime_error("PauliFrameQubit::gateS: only supported on unpaired qubits");
+  }
+  applyMemoryError();
+  frameS();
+  // S|+> = |+i>, S|+i> = Z|+>
+  if (basis == Basis::X) {
+    basis = Basis::Y;
+  } else if (basis == Basis::Y) {
+    basis = Basis::X;
+    frame_z = !frame_z;
+  }
+}
+void PauliFrameQubit::gateSdg() {
+  if (partner != nullptr || link != nullptr) {
+    throw std::runtime_error("PauliFrameQubit::gateSdg: only supported on unpaired qubits");
+  }
+  applyMemoryError();
+  frameS();
+  // Sdg|+> = Z|+i>, Sdg|+i> = |+>
+  if (basis == Basis::X) {
+    basis = Basis::Y;
+    frame_z = !frame_z;
+  } else if (basis == Basis::Y) {
+    basis = Basis::X;
+  }
+}
+
+EigenvalueResult PauliFrameQubit::measureX() {
+  applyMemoryError();
+  return flipWithProbability(toEigenvalue(measure(Basis::X)), measurement_err.x_error_rate);
+}
+
+EigenvalueResult PauliFrameQubit::measureY() {
+  applyMemoryError();
+  return flipWithProbability(toEigenvalue(measure(Basis::Y)), measurement_err.y_error_rate);
+}
+
+EigenvalueResult PauliFrameQubit::measureZ() {
+  applyMemoryError();
+  return flipWithProbability(toEigenvalue(measure(Basis::Z)), measurement_err.z_error_rate);
+}
+
+void PauliFrameQubit::noiselessX() { applyPauli(static_cast<int>(Pauli::X)); }
+void PauliFrameQubit::noiselessZ() { applyPauli(static_cast<int>(Pauli::Z)); }
+void PauliFrameQubit::noiselessH() {
+  if (partner != nullptr || link != nullptr) {
+    throw std::runtime_error("PauliFrameQubit::gateH: only supported on unpaired qubits");
+  }
+  frameH();
+  // H swaps |0> and |+>, H|+i> = Z|+i>
+  if (basis == Basis::Z) {
+    basis = Basis::X;
+  } else if (basis == Basis::X) {
+    basis = Basis::Z;
+  } else {
+    frame_z = !frame_z;
+  }
+}
+void PauliFrameQubit::noiselessCNOT(IQubit *const target_qubit) { applyCNOT(static_cast<PauliFrameQubit *>(target_qubit)); }
+EigenvalueResult PauliFrameQubit::noiselessMeasureZ() { return toEigenvalue(measure(Basis::Z)); }
+EigenvalueResult PauliFrameQubit::noiselessMeasureX() { return toEigenvalue(measure(Basis::X)); }
+EigenvalueResult PauliFrameQubit::noiselessMeasureZ(EigenvalueResult forced_result) {
+  // a forced result only applies to random outcomes, deterministic outcomes are returned as they are.
+  return toEigenvalue(measure(Basis::Z, forced_result == EigenvalueResult::MINUS_ONE ? 1 : 0));
+}
+EigenvalueResult PauliFrameQubit::noiselessMeasureX(EigenvalueResult forced_result) { return toEigenvalue(measure(Basis::X, forced_result == EigenvalueResult::MINUS_ONE ? 1 : 0)); }
+
+}  // namespace quisp::backends::pauli_frame
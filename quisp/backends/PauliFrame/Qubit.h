@@ -0,0 +1,144 @@
+#pragma once
+#include <memory>
+#include "../GraphState/MemoryTransition.h"
+#include "../GraphState/types.h"
+#include "../interfaces/IQubit.h"
+#include "backends/QubitConfiguration.h"
+#include "backends/interfaces/IQubitId.h"
+#include "omnetpp/simtime.h"
+
+namespace quisp::backends::pauli_frame {
+
+using abstract::EigenvalueResult;
+using abstract::IQubit;
+using abstract::IQubitId;
+using graph_state::Matrix6d;
+using graph_state::MemoryTransition;
+using graph_state::RowVector6d;
+using graph_state::types::MeasurementErrorModel;
+using graph_state::types::MemoryErrorModel;
+using graph_state::types::SingleGateErrorModel;
+using graph_state::types::TwoQubitGateErrorModel;
+using omnetpp::SimTime;
+
+class PauliFrameBackend;
+class PauliFrameQubit;
+
+// the eigenbasis of an unpaired qubit's reference state: |0>, |+> or |+i>
+enum class Basis : int { Z, X, Y };
+
+/**
+ * @brief two Bell pairs connected by a CNOT whose bilateral counterpart or measurements are still pending.
+ *
+ * CNOT(c -> t) on |Phi+>_{c c'} |Phi+>_{t t'} gives the same state as CNOT(c' -> t), CNOT(c -> t') and CNOT(c' -> t'),
+ * so only the pair a qubit belongs to matters. Measuring a control in X or a target in Z removes it from the link
+ * and stores the outcome of the reference state. Purification resolves the link with the second CNOT,
+ * entanglement swapping with the second measurement.
+ */
+struct CnotLink {
+  PauliFrameQubit *controls[2] = {nullptr, nullptr};
+  PauliFrameQubit *targets[2] = {nullptr, nullptr};
+  bool control_measured = false;
+  bool target_measured = false;
+  bool control_result = false;
+  bool target_result = false;
+  bool hasControl(const PauliFrameQubit *qubit) const { return qubit != nullptr && (controls[0] == qubit || controls[1] == qubit); }
+  bool hasTarget(const PauliFrameQubit *qubit) const { return qubit != nullptr && (targets[0] == qubit || targets[1] == qubit); }
+};
+
+/**
+ * @brief a qubit of the PauliFrameBackend.
+ *
+ * Instead of the full state, each qubit keeps a reference state and the Pauli operator (the frame) applied on top of it.
+ * The reference is either a single qubit eigenstate (Basis), one half of |Phi+> with the partner qubit,
+ * or a member of a CnotLink. Pauli gates and Pauli errors only flip the frame bits, so error tracking for
+ * Bell pair level protocols (generation, tomography, purification and entanglement swapping) costs a few bit operations.
+ * H, S and Sdg are only supported on unpaired qubits and the operations that would build larger entangled states throw.
+ */
+class PauliFrameQubit : public IQubit {
+ public:
+  PauliFrameQubit(const IQubitId *id, PauliFrameBackend *const backend, bool is_short_live);
+  ~PauliFrameQubit();
+  void configure(std::unique_ptr<StationaryQubitConfiguration> configuration);
+  void setFree() override;
+  const IQubitId *const getId() const override;
+  void relaseBackToPool() override;
+
+  void gateX() override;
+  void gateZ() override;
+  void gateY() override;
+  void gateH() override;
+  void gateS() override;
+  void gateSdg() override;
+  void gateCNOT(IQubit *const target_qubit) override;
+  EigenvalueResult measureX() override;
+  EigenvalueResult measureY() override;
+  EigenvalueResult measureZ() override;
+
+  void noiselessH() override;
+  void noiselessX() override;
+  void noiselessZ() override;
+  void noiselessCNOT(IQubit *const target_qubit) override;
+  EigenvalueResult noiselessMeasureZ() override;
+  EigenvalueResult noiselessMeasureX() override;
+  EigenvalueResult noiselessMeasureZ(EigenvalueResult forced_result) override;
+  EigenvalueResult noiselessMeasureX(EigenvalueResult forced_result) override;
+
+  PauliFrameQubit *getPartner() const { return partner; }
+  bool isLinked() const { return link != nullptr; }
+  const CnotLink *getLink() const { return link.get(); }
+  Basis getBasis() const { return basis; }
+  bool hasXFrame() const { return frame_x; }
+  bool hasZFrame() const { return frame_z; }
+
+  // whether the CNOT and the measurement keep the state representable, they throw otherwise. H, S and Sdg need an unpaired qubit
+  bool canApplyCNOT(const PauliFrameQubit *target) const;
+  bool canMeasure(Basis measured_basis) const;
+  // the fidelity to |Phi+> with the memory error since the last update, without drawing random numbers. throws in a pending CNOT
+  double bellPairFidelity(const PauliFrameQubit *another) const;
+  void applyMemoryError();
+
+ protected:
+  // error simulation
+  void setMemoryErrorRates(double x_error_rate, double y_error_rate, double z_error_rate, double excitation_rate, double relaxation_rate);
+  void applySingleQubitGateError(SingleGateErrorModel const &err);
+  void applyTwoQubitGateError(TwoQubitGateErrorModel const &err, PauliFrameQubit *another_qubit);
+  RowVector6d pendingMemoryError() const;
+  void applyPauli(int pauli);
+  EigenvalueResult flipWithProbability(EigenvalueResult result, double probability);
+
+  // reference state and frame
+  void frameH();
+  void frameS();
+  void frameCNOT(PauliFrameQubit *target);
+  bool frameFlips(Basis measured_basis) const;
+  void setUnpaired(Basis new_basis, bool value);
+  void pairWith(PauliFrameQubit *another);
+  void discard();
+  bool randomReference(Basis measured_basis, int forced_outcome);
+  bool measure(Basis measured_basis, int forced_outcome = -1);
+  bool measureLinked(Basis measured_basis, int forced_outcome);
+  void applyCNOT(PauliFrameQubit *target);
+  void resolveLinkByCNOT(PauliFrameQubit *target);
+
+  SingleGateErrorModel gate_err_h;
+  SingleGateErrorModel gate_err_x;
+  SingleGateErrorModel gate_err_z;
+  TwoQubitGateErrorModel gate_err_cnot;
+  MeasurementErrorModel measurement_err;
+  MemoryErrorModel memory_err;
+  std::shared_ptr<const MemoryTransition> memory_transition;
+
+  bool frame_x = false;
+  bool frame_z = false;
+  Basis basis = Basis::Z;
+  PauliFrameQubit *partner = nullptr;
+  std::shared_ptr<CnotLink> link;
+
+  SimTime updated_time = SimTime(0);
+  const IQubitId *id;
+  PauliFrameBackend *const backend;
+  const bool is_short_live;
+};
+
+}  // namespace quisp::backends::pauli_frame
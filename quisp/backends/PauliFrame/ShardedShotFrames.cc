@@ -0,0 +1,96 @@
+#include "ShardedShotFrames.h"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace quisp::backends::pauli_frame {
+
+ShardedShotFrames::ShardedShotFrames(int num_qubits, int num_shots, int shots_per_shard, const RNGFactory &make_rng, int num_threads)
+    : num_qubits(num_qubits), num_shots(num_shots), num_words((num_shots + MultiShotFrames::shots_per_word - 1) / MultiShotFrames::shots_per_word), pool(num_threads) {
+  if (num_qubits <= 0 || num_shots <= 0 || shots_per_shard <= 0) throw std::invalid_argument("ShardedShotFrames: num_qubits, num_shots and shots_per_shard must be positive");
+  int words_per_shard = (shots_per_shard + MultiShotFrames::shots_per_word - 1) / MultiShotFrames::shots_per_word;
+  for (int first_word = 0; first_word < num_words; first_word += words_per_shard) {
+    Shard shard;
+    shard.rng = make_rng(shards.size());
+    if (shard.rng == nullptr) throw std::invalid_argument("ShardedShotFrames: no rng for the shard");
+    int shard_shots = std::min(words_per_shard * MultiShotFrames::shots_per_word, num_shots - first_word * MultiShotFrames::shots_per_word);
+    shard.frames = std::make_unique<MultiShotFrames>(num_qubits, shard_shots, shard.rng.get());
+    shard.first_word = first_word;
+    shards.push_back(std::move(shard));
+  }
+}
+
+void ShardedShotFrames::enqueue(Operation operation) { queued_operations.push_back(std::move(operation)); }
+
+void ShardedShotFrames::flush() {
+  if (queued_operations.empty()) return;
+  auto operations = std::move(queued_operations);
+  queued_operations.clear();
+  pool.parallelFor(shards.size(), [&](std::size_t i) {
+    for (auto &operation : operations) operation(shards[i]);
+  });
+}
+
+std::vector<ShardedShotFrames::Word> ShardedShotFrames::sliceOf(const Shard &shard, const std::vector<Word> &shots) {
+  auto begin = shots.begin() + shard.first_word;
+  return std::vector<Word>(begin, begin + shard.frames->numWords());
+}
+
+void ShardedShotFrames::h(int qubit) {
+  enqueue([qubit](Shard &shard) { shard.frames->h(qubit); });
+}
+
+void ShardedShotFrames::s(int qubit) {
+  enqueue([qubit](Shard &shard) { shard.frames->s(qubit); });
+}
+
+void ShardedShotFrames::cnot(int control, int target) {
+  enqueue([control, target](Shard &shard) { shard.frames->cnot(control, target); });
+}
+
+void ShardedShotFrames::reset(int qubit) {
+  enqueue([qubit](Shard &shard) { shard.frames->reset(qubit); });
+}
+
+void ShardedShotFrames::pauliError(int qubit, const SingleGateErrorModel &err) {
+  enqueue([qubit, err](Shard &shard) { shard.frames->pauliError(qubit, err); });
+}
+
+void ShardedShotFrames::twoQubitError(int control, int target, const TwoQubitGateErrorModel &err) {
+  enqueue([control, target, err](Shard &shard) { shard.frames->twoQubitError(control, target, err); });
+}
+
+void ShardedShotFrames::memoryError(int qubit, const RowVector6d &distribution) {
+  enqueue([qubit, distribution](Shard &shard) { shard.frames->memoryError(qubit, distribution); });
+}
+
+void ShardedShotFrames::loss(int qubit, double probability) {
+  enqueue([qubit, probability](Shard &shard) { shard.frames->loss(qubit, probability); });
+}
+
+std::vector<ShardedShotFrames::Word> ShardedShotFrames::measure(int qubit, double error_rate, bool x_basis) {
+  std::vector<Word> flips(num_words, 0);
+  // the shards write their own words of the outcomes
+  enqueue([&flips, qubit, error_rate, x_basis](Shard &shard) {
+    auto shard_flips = x_basis ? shard.frames->measureX(qubit, error_rate) : shard.frames->measureZ(qubit, error_rate);
+    std::copy(shard_flips.begin(), shard_flips.end(), flips.begin() + shard.first_word);
+  });
+  flush();
+  return flips;
+}
+
+std::vector<ShardedShotFrames::Word> ShardedShotFrames::measureZ(int qubit, double error_rate) { return measure(qubit, error_rate, false); }
+
+std::vector<ShardedShotFrames::Word> ShardedShotFrames::measureX(int qubit, double error_rate) { return measure(qubit, error_rate, true); }
+
+void ShardedShotFrames::applyXIf(int qubit, const std::vector<Word> &shots) {
+  if (static_cast<int>(shots.size()) != num_words) throw std::invalid_argument("ShardedShotFrames::applyXIf: the mask doesn't cover the shots");
+  enqueue([qubit, shots](Shard &shard) { shard.frames->applyXIf(qubit, sliceOf(shard, shots)); });
+}
+
+void ShardedShotFrames::applyZIf(int qubit, const std::vector<Word> &shots) {
+  if (static_cast<int>(shots.size()) != num_words) throw std::invalid_argument("ShardedShotFrames::applyZIf: the mask doesn't cover the shots");
+  enqueue([qubit, shots](Shard &shard) { shard.frames->applyZIf(qubit, sliceOf(shard, shots)); });
+}
+
+}  // namespace quisp::backends::pauli_frame
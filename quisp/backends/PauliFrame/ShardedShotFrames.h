@@ -0,0 +1,73 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <vector>
+#include "MultiShotFrames.h"
+#include "utils/ThreadPool.h"
+
+namespace quisp::backends::pauli_frame {
+
+/**
+ * @brief MultiShotFrames of many more shots, split into shards of their own frames and random stream and run on a thread pool.
+ *
+ * The gates and the errors are queued, and a measurement or flush() applies the queue to all the shards in parallel,
+ * so the pool is woken once per batch instead of once per gate. A shard only draws from its own rng,
+ * so the outcomes don't depend on the number of threads. The interface is the same as MultiShotFrames,
+ * the correction masks and the outcomes span all the shots.
+ */
+class ShardedShotFrames {
+ public:
+  using Word = MultiShotFrames::Word;
+  // the rng of the shard, e.g. a stream of StreamRNG per shard
+  using RNGFactory = std::function<std::unique_ptr<IRandomNumberGenerator>(int shard)>;
+
+  // shots_per_shard is rounded up to whole words. num_threads includes the calling thread
+  ShardedShotFrames(int num_qubits, int num_shots, int shots_per_shard, const RNGFactory &make_rng, int num_threads);
+
+  int numQubits() const { return num_qubits; }
+  int numShots() const { return num_shots; }
+  int numWords() const { return num_words; }
+  int numShards() const { return shards.size(); }
+
+  void h(int qubit);
+  void s(int qubit);
+  void cnot(int control, int target);
+  void reset(int qubit);
+  void pauliError(int qubit, const SingleGateErrorModel &err);
+  void twoQubitError(int control, int target, const TwoQubitGateErrorModel &err);
+  void memoryError(int qubit, const RowVector6d &distribution);
+  void loss(int qubit, double probability);
+
+  std::vector<Word> measureZ(int qubit, double error_rate = 0);
+  std::vector<Word> measureX(int qubit, double error_rate = 0);
+
+  void applyXIf(int qubit, const std::vector<Word> &shots);
+  void applyZIf(int qubit, const std::vector<Word> &shots);
+
+  // applies the queued operations to the shards
+  void flush();
+  // the frames of the shard with the operations flushed so far
+  const MultiShotFrames &shard(int index) const { return *shards[index].frames; }
+
+ private:
+  struct Shard {
+    std::unique_ptr<IRandomNumberGenerator> rng;
+    std::unique_ptr<MultiShotFrames> frames;
+    int first_word;
+  };
+  using Operation = std::function<void(Shard &shard)>;
+
+  void enqueue(Operation operation);
+  // the words of the shard in a mask of all the shots
+  static std::vector<Word> sliceOf(const Shard &shard, const std::vector<Word> &shots);
+  std::vector<Word> measure(int qubit, double error_rate, bool x_basis);
+
+  const int num_qubits;
+  const int num_shots;
+  const int num_words;
+  std::vector<Shard> shards;
+  std::vector<Operation> queued_operations;
+  utils::ThreadPool pool;
+};
+
+}  // namespace quisp::backends::pauli_frame
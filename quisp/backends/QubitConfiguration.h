@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include "interfaces/IConfiguration.h"
 namespace quisp::backends {
 /**
@@ -55,6 +56,73 @@ class StationaryQubitConfiguration : public abstract::IConfiguration {
 
   double cnot_gate_err_rate = 0;
 
+  // true if none of the gates, measurements or memories introduce errors
+  bool isNoiseless() const {
+    return memory_x_err_rate == 0 && memory_y_err_rate == 0 && memory_z_err_rate == 0 && memory_excitation_rate == 0 && memory_relaxation_rate == 0 &&
+           memory_completely_mixed_rate == 0 && measurement_x_err_rate == 0 && measurement_y_err_rate == 0 && measurement_z_err_rate == 0 && x_gate_err_rate == 0 &&
+           z_gate_err_rate == 0 && h_gate_err_rate == 0 && cnot_gate_err_rate == 0;
+  }
+
+  struct Parameter {
+    const char* name;  // of the NED parameter
+    double StationaryQubitConfiguration::*field;
+  };
+  static constexpr std::size_t num_parameters = 37;
+  static const std::array<Parameter, num_parameters>& parameters();
+
+  // the values of parameters(), to compare and hash the configurations
+  using Key = std::array<double, num_parameters>;
+  Key key() const {
+    Key k;
+    auto& params = parameters();
+    for (std::size_t i = 0; i < num_parameters; i++) k[i] = this->*params[i].field;
+    return k;
+  }
+
  protected:
 };
+
+inline const std::array<StationaryQubitConfiguration::Parameter, StationaryQubitConfiguration::num_parameters>& StationaryQubitConfiguration::parameters() {
+  using C = StationaryQubitConfiguration;
+  static const std::array<Parameter, num_parameters> params = {{
+      {"memory_x_error_rate", &C::memory_x_err_rate},
+      {"memory_y_error_rate", &C::memory_y_err_rate},
+      {"memory_z_error_rate", &C::memory_z_err_rate},
+      {"memory_energy_excitation_rate", &C::memory_excitation_rate},
+      {"memory_energy_relaxation_rate", &C::memory_relaxation_rate},
+      {"memory_completely_mixed_rate", &C::memory_completely_mixed_rate},
+      {"x_measurement_error_rate", &C::measurement_x_err_rate},
+      {"y_measurement_error_rate", &C::measurement_y_err_rate},
+      {"z_measurement_error_rate", &C::measurement_z_err_rate},
+      {"x_gate_x_error_ratio", &C::x_gate_x_err_ratio},
+      {"x_gate_y_error_ratio", &C::x_gate_y_err_ratio},
+      {"x_gate_z_error_ratio", &C::x_gate_z_err_ratio},
+      {"x_gate_error_rate", &C::x_gate_err_rate},
+      {"z_gate_x_error_ratio", &C::z_gate_x_err_ratio},
+      {"z_gate_y_error_ratio", &C::z_gate_y_err_ratio},
+      {"z_gate_z_error_ratio", &C::z_gate_z_err_ratio},
+      {"z_gate_error_rate", &C::z_gate_err_rate},
+      {"h_gate_x_error_ratio", &C::h_gate_x_err_ratio},
+      {"h_gate_y_error_ratio", &C::h_gate_y_err_ratio},
+      {"h_gate_z_error_ratio", &C::h_gate_z_err_ratio},
+      {"h_gate_error_rate", &C::h_gate_err_rate},
+      {"cnot_gate_ix_error_ratio", &C::cnot_gate_ix_err_ratio},
+      {"cnot_gate_iy_error_ratio", &C::cnot_gate_iy_err_ratio},
+      {"cnot_gate_iz_error_ratio", &C::cnot_gate_iz_err_ratio},
+      {"cnot_gate_xi_error_ratio", &C::cnot_gate_xi_err_ratio},
+      {"cnot_gate_xx_error_ratio", &C::cnot_gate_xx_err_ratio},
+      {"cnot_gate_xy_error_ratio", &C::cnot_gate_xy_err_ratio},
+      {"cnot_gate_xz_error_ratio", &C::cnot_gate_xz_err_ratio},
+      {"cnot_gate_yi_error_ratio", &C::cnot_gate_yi_err_ratio},
+      {"cnot_gate_yx_error_ratio", &C::cnot_gate_yx_err_ratio},
+      {"cnot_gate_yy_error_ratio", &C::cnot_gate_yy_err_ratio},
+      {"cnot_gate_yz_error_ratio", &C::cnot_gate_yz_err_ratio},
+      {"cnot_gate_zi_error_ratio", &C::cnot_gate_zi_err_ratio},
+      {"cnot_gate_zx_error_ratio", &C::cnot_gate_zx_err_ratio},
+      {"cnot_gate_zy_error_ratio", &C::cnot_gate_zy_err_ratio},
+      {"cnot_gate_zz_error_ratio", &C::cnot_gate_zz_err_ratio},
+      {"cnot_gate_error_rate", &C::cnot_gate_err_rate},
+  }};
+  return params;
+}
 }  // namespace quisp::backends
@@ -0,0 +1,110 @@
+#include "Backend.h"
+#include "Qubit.h"
+#include "backends/interfaces/IConfiguration.h"
+#include "backends/interfaces/IQubit.h"
+#include "modules/QNIC/StationaryQubit/QubitId.h"
+
+using quisp::modules::qubit_id::QubitId;
+
+namespace quisp::backends::stabilizer_tableau {
+StabilizerTableauBackend::StabilizerTableauBackend(std::unique_ptr<IRandomNumberGenerator> rng, std::unique_ptr<StationaryQubitConfiguration> configuration)
+    : current_time(SimTime()), rng(std::move(rng)), short_live_qubit_pool_size(0) {
+  config = std::move(configuration);
+}
+StabilizerTableauBackend::StabilizerTableauBackend(std::unique_ptr<IRandomNumberGenerator> rng, std::unique_ptr<StationaryQubitConfiguration> configuration, ICallback* cb)
+    : StabilizerTableauBackend(std::move(rng), std::move(configuration)) {
+  callback = cb;
+}
+StabilizerTableauBackend::~StabilizerTableauBackend() {
+  for (auto& pair : qubits) {
+    delete pair.first;
+  }
+}
+
+std::size_t StabilizerTableauBackend::allocateColumn() {
+  if (free_columns.empty()) {
+    return tableau.addQubit();
+  }
+  auto column = free_columns.back();
+  free_columns.pop_back();
+  return column;
+}
+
+std::unique_ptr<StabilizerTableauQubit> StabilizerTableauBackend::makeQubit(const IQubitId* id, std::unique_ptr<IConfiguration> conf, bool is_short_live) {
+  IConfiguration* raw_conf = conf.release();
+  StationaryQubitConfiguration* st_conf = dynamic_cast<StationaryQubitConfiguration*>(raw_conf);
+  if (st_conf == nullptr) {
+    delete raw_conf;
+    throw std::runtime_error("StabilizerTableau::createQubit: failed to cast. got invalid configuration.");
+  }
+  auto qubit = std::make_unique<StabilizerTableauQubit>(id, allocateColumn(), this, is_short_live);
+  qubit->configure(std::unique_ptr<StationaryQubitConfiguration>(st_conf));
+  return qubit;
+}
+
+IQubit* StabilizerTableauBackend::createShortLiveQubit() {
+  auto* qubit_id = new QubitId(-1, -1, -1, ++short_live_qubit_pool_size);
+  auto original_qubit = makeQubit(qubit_id, getDefaultConfiguration(), true);
+  auto* qubit_ptr = original_qubit.get();
+  qubits.insert({qubit_id, std::move(original_qubit)});
+  return qubit_ptr;
+}
+
+IQubit* StabilizerTableauBackend::createQubit(const IQubitId* id, std::unique_ptr<IConfiguration> conf) {
+  if (qubits.find(id) != qubits.cend()) {
+    throw std::runtime_error("StabilizerTableau::createQubit: trying to create qubit with already existed Id.");
+  }
+  auto original_qubit = makeQubit(id, std::move(conf), false);
+  auto* qubit_ptr = original_qubit.get();
+  qubits.insert({id, std::move(original_qubit)});
+  return qubit_ptr;
+}
+IQubit* StabilizerTableauBackend::createQubit(const IQubitId* id) { return createQubit(id, getDefaultConfiguration()); }
+
+IQubit* StabilizerTableauBackend::getQubit(const IQubitId* id) {
+  auto qubit_iterator = qubits.find(id);
+  if (qubit_iterator == qubits.cend()) {
+    throw std::runtime_error("StabilizerTableau::getQubit: trying to get qubit with non existing Id.");
+  }
+  return qubit_iterator->second.get();
+}
+
+IQubit* StabilizerTableauBackend::getShortLiveQubit() {
+  if (short_live_qubit_pool.empty()) {
+    return createShortLiveQubit();
+  }
+  auto* qubit = short_live_qubit_pool.front();
+  short_live_qubit_pool.pop_front();
+  return qubit;
+}
+
+void StabilizerTableauBackend::returnToPool(IQubit* pool_qubit) {
+  pool_qubit->setFree();
+  short_live_qubit_pool.emplace_back(pool_qubit);
+}
+
+void StabilizerTableauBackend::deleteQubit(const IQubitId* id) {
+  auto qubit_iterator = qubits.find(id);
+  if (qubit_iterator == qubits.cend()) {
+    throw std::runtime_error("StabilizerTableau::deleteQubit: trying to delete qubit with non existing Id.");
+  }
+  // disentangle the column from the rest before reusing it
+  qubit_iterator->second->setFree();
+  free_columns.push_back(qubit_iterator->second->getIndex());
+  qubits.erase(qubit_iterator);
+}
+
+std::unique_ptr<IConfiguration> StabilizerTableauBackend::getDefaultConfiguration() const {
+  // copy the default backend configuration for each qubit
+  return std::make_unique<StationaryQubitConfiguration>(*config.get());
+}
+const SimTime& StabilizerTableauBackend::getSimTime() {
+  if (callback != nullptr) callback->willUpdate(*this);
+  return current_time;
+}
+void StabilizerTableauBackend::setSimTime(SimTime time) { current_time = time; }
+double StabilizerTableauBackend::dblrand() { return rng->doubleRandom(); }
+
+std::shared_ptr<const MemoryTransition> StabilizerTableauBackend::getMemoryTransition(const Matrix6d& transition_matrix) { return memory_transitions.get(transition_matrix); }
+
+}  // namespace quisp::backends::stabilizer_tableau
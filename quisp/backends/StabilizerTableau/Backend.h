@@ -0,0 +1,73 @@
+#pragma once
+#include <omnetpp.h>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "../GraphState/MemoryTransition.h"
+#include "../interfaces/IConfiguration.h"
+#include "../interfaces/IQuantumBackend.h"
+#include "../interfaces/IQubit.h"
+#include "../interfaces/IRandomNumberGenerator.h"
+#include "Qubit.h"
+#include "Tableau.h"
+#include "backends/QubitConfiguration.h"
+#include "backends/interfaces/IQubitId.h"
+
+namespace quisp::backends::stabilizer_tableau {
+using abstract::IConfiguration;
+using abstract::IQuantumBackend;
+using abstract::IQubit;
+using abstract::IQubitId;
+using abstract::IRandomNumberGenerator;
+using graph_state::MemoryTransitionCache;
+
+/**
+ * @brief quantum backend based on a bit-packed stabilizer tableau.
+ *
+ * All qubits of the simulation are columns of one Tableau. Unlike GraphStateBackend,
+ * the cost of an operation does not depend on the shape of the entangled cluster,
+ * which helps when swapping and purification build large clusters.
+ * Released qubits are measured out to |0> and their columns are reused.
+ */
+class StabilizerTableauBackend : public IQuantumBackend {
+ public:
+  class ICallback {
+   public:
+    virtual ~ICallback() {}
+    virtual void willUpdate(StabilizerTableauBackend& backend) = 0;
+  };
+  StabilizerTableauBackend(std::unique_ptr<IRandomNumberGenerator> rng, std::unique_ptr<StationaryQubitConfiguration> configuration);
+  StabilizerTableauBackend(std::unique_ptr<IRandomNumberGenerator> rng, std::unique_ptr<StationaryQubitConfiguration> configuration, ICallback* callback);
+  ~StabilizerTableauBackend();
+  IQubit* createQubit(const IQubitId* id, std::unique_ptr<IConfiguration> conf) override;
+  IQubit* createQubit(const IQubitId* id) override;
+  IQubit* createShortLiveQubit() override;
+  IQubit* getQubit(const IQubitId* id) override;
+  IQubit* getShortLiveQubit() override;
+  void returnToPool(IQubit*) override;
+  void deleteQubit(const IQubitId* id) override;
+  std::unique_ptr<IConfiguration> getDefaultConfiguration() const override;
+  const SimTime& getSimTime() override;
+  void setSimTime(SimTime time) override;
+  double dblrand();
+
+  Tableau& getTableau() { return tableau; }
+  std::shared_ptr<const MemoryTransition> getMemoryTransition(const Matrix6d& transition_matrix);
+
+ protected:
+  std::size_t allocateColumn();
+  std::unique_ptr<StabilizerTableauQubit> makeQubit(const IQubitId* id, std::unique_ptr<IConfiguration> conf, bool is_short_live);
+
+  Tableau tableau;
+  std::unordered_map<const IQubitId*, std::unique_ptr<StabilizerTableauQubit>, IQubitId::Hash, IQubitId::Pred> qubits;
+  std::vector<std::size_t> free_columns;
+  SimTime current_time;
+  const std::unique_ptr<IRandomNumberGenerator> rng;
+  std::unique_ptr<StationaryQubitConfiguration> config;
+  ICallback* callback = nullptr;
+  std::deque<IQubit*> short_live_qubit_pool;
+  MemoryTransitionCache memory_transitions;
+  int short_live_qubit_pool_size;  // this is used to generate qubit id for short live qubits in a pool; currenlty only photons.
+};
+}  // namespace quisp::backends::stabilizer_tableau
@@ -0,0 +1,214 @@
+#include "Qubit.h"
+#include <cmath>
+#include <stdexcept>
+#include "Backend.h"
+#include "utils/UtilFunctions.h"
+
+namespace quisp::backends::stabilizer_tableau {
+using util_functions::samplingWithWeights;
+
+namespace {
+enum class Pauli : int { I, X, Z, Y };
+}
+
+StabilizerTableauQubit::StabilizerTableauQubit(const IQubitId *id, std::size_t index, StabilizerTableauBackend *const backend, bool is_short_live)
+    : id(id), index(index), backend(backend), is_short_live(is_short_live) {}
+
+StabilizerTableauQubit::~StabilizerTableauQubit() {}
+
+const IQubitId *const StabilizerTableauQubit::getId() const { return id; }
+
+void StabilizerTableauQubit::relaseBackToPool() {
+  if (!is_short_live) {
+    throw std::runtime_error("cannot release non short-live qubit");
+  }
+  backend->returnToPool(this);
+}
+
+void StabilizerTableauQubit::configure(std::unique_ptr<StationaryQubitConfiguration> c) {
+  setMemoryErrorRates(c->memory_x_err_rate, c->memory_y_err_rate, c->memory_z_err_rate, c->memory_excitation_rate, c->memory_relaxation_rate);
+  measurement_err.setParams(c->measurement_x_err_rate, c->measurement_y_err_rate, c->measurement_z_err_rate);
+  gate_err_h.setParams(c->h_gate_x_err_ratio, c->h_gate_y_err_ratio, c->h_gate_z_err_ratio, c->h_gate_err_rate);
+  gate_err_x.setParams(c->x_gate_x_err_ratio, c->x_gate_y_err_ratio, c->x_gate_z_err_ratio, c->x_gate_err_rate);
+  gate_err_z.setParams(c->z_gate_x_err_ratio, c->z_gate_y_err_ratio, c->z_gate_z_err_ratio, c->z_gate_err_rate);
+  gate_err_cnot.setParams(c->cnot_gate_err_rate, c->cnot_gate_ix_err_ratio, c->cnot_gate_iy_err_ratio, c->cnot_gate_iz_err_ratio, c->cnot_gate_xi_err_ratio,
+                          c->cnot_gate_xx_err_ratio, c->cnot_gate_xy_err_ratio, c->cnot_gate_xz_err_ratio, c->cnot_gate_yi_err_ratio, c->cnot_gate_yx_err_ratio,
+                          c->cnot_gate_yy_err_ratio, c->cnot_gate_yz_err_ratio, c->cnot_gate_zi_err_ratio, c->cnot_gate_zx_err_ratio, c->cnot_gate_zy_err_ratio,
+                          c->cnot_gate_zz_err_ratio);
+}
+
+void StabilizerTableauQubit::setMemoryErrorRates(double x_error_rate, double y_error_rate, double z_error_rate, double excitation_rate, double relaxation_rate) {
+  memory_err.x_error_rate = x_error_rate;
+  memory_err.y_error_rate = y_error_rate;
+  memory_err.z_error_rate = z_error_rate;
+  memory_err.excitation_error_rate = excitation_rate;
+  memory_err.relaxation_error_rate = relaxation_rate;
+  memory_err.error_rate = x_error_rate + y_error_rate + z_error_rate + excitation_rate + relaxation_rate;  // This is per μs.
+  memory_transition = backend->getMemoryTransition(MemoryTransition::transitionMatrix(x_error_rate, y_error_rate, z_error_rate, excitation_rate, relaxation_rate));
+}
+
+void StabilizerTableauQubit::applyPauli(int pauli) {
+  switch (static_cast<Pauli>(pauli)) {
+    case Pauli::I:
+      break;
+    case Pauli::X:
+      backend->getTableau().x(index);
+      break;
+    case Pauli::Z:
+      backend->getTableau().z(index);
+      break;
+    case Pauli::Y:
+      backend->getTableau().y(index);
+      break;
+  }
+}
+
+void StabilizerTableauQubit::applySingleQubitGateError(SingleGateErrorModel const &err) {
+  if (err.pauli_error_rate == 0) {
+    return;
+  }
+  applyPauli(static_cast<int>(err.distribution.sample(backend->dblrand())));
+}
+
+void StabilizerTableauQubit::applyTwoQubitGateError(TwoQubitGateErrorModel const &err, StabilizerTableauQubit *another_qubit) {
+  if (err.pauli_error_rate == 0) {
+    return;
+  }
+  // label = 4 * (pauli on this qubit) + (pauli on another qubit), both in the order I, X, Y, Z
+  constexpr int paulis[4] = {static_cast<int>(Pauli::I), static_cast<int>(Pauli::X), static_cast<int>(Pauli::Y), static_cast<int>(Pauli::Z)};
+  auto label = err.distribution.sample(backend->dblrand());
+  applyPauli(paulis[label / 4]);
+  another_qubit->applyPauli(paulis[label % 4]);
+}
+
+void StabilizerTableauQubit::applyMemoryError() {
+  // If no memory error occurs, skip this memory error simulation.
+  if (memory_err.error_rate == 0) return;
+
+  SimTime current_time = backend->getSimTime();
+  double time_evolution_microsec = (current_time.dbl() - updated_time.dbl()) * 1000000;
+  if (time_evolution_microsec > 0) {
+    // Clean, X, Z, Y, Excited, Relaxed
+    RowVector6d pi_vector = memory_transition->errorDistribution(time_evolution_microsec);
+    double sum = pi_vector.sum();
+    if (sum > 1.01 || sum < 0.99 || std::isnan(pi_vector(0, 0))) {
+      throw std::runtime_error("StabilizerTableauQubit::applyMemoryError: invalid memory error distribution");
+    }
+
+    std::map<int, double> weights = {{0, pi_vector(0, 0)}, {1, pi_vector(0, 1)}, {2, pi_vector(0, 2)}, {3, pi_vector(0, 3)}, {4, pi_vector(0, 4)}, {5, pi_vector(0, 5)}};
+    int r = samplingWithWeights(weights, backend->dblrand());
+    if (r < 4) {
+      applyPauli(r);
+    } else {
+      // excitation ends in |1>, relaxation ends in |0>
+      auto result = tableauMeasureZ();
+      bool is_excitation = r == 4;
+      if ((result == EigenvalueResult::PLUS_ONE) == is_excitation) backend->getTableau().x(index);
+    }
+  }
+  updated_time = current_time;
+}
+
+EigenvalueResult StabilizerTableauQubit::tableauMeasureZ() {
+  auto &tableau = backend->getTableau();
+  bool random_bit = false;
+  if (tableau.isZMeasurementRandom(index)) {
+    random_bit = !(backend->dblrand() < 0.5);
+  }
+  return tableau.measureZ(index, random_bit) ? EigenvalueResult::MINUS_ONE : EigenvalueResult::PLUS_ONE;
+}
+
+EigenvalueResult StabilizerTableauQubit::flipWithProbability(EigenvalueResult result, double probability) {
+  if (backend->dblrand() < probability) {
+    return result == EigenvalueResult::PLUS_ONE ? EigenvalueResult::MINUS_ONE : EigenvalueResult::PLUS_ONE;
+  }
+  return result;
+}
+
+// public member functions
+
+void StabilizerTableauQubit::setFree() {
+  // force qubit to be in |0> state
+  if (tableauMeasureZ() == EigenvalueResult::MINUS_ONE) backend->getTableau().x(index);
+  updated_time = backend->getSimTime();
+}
+
+void StabilizerTableauQubit::gateCNOT(IQubit *const target_qubit) {
+  auto st_target_qubit = dynamic_cast<StabilizerTableauQubit *>(target_qubit);
+  applyMemoryError();
+  st_target_qubit->applyMemoryError();
+  backend->getTableau().cnot(index, st_target_qubit->index);
+  applyTwoQubitGateError(gate_err_cnot, st_target_qubit);
+}
+
+void StabilizerTableauQubit::gateH() {
+  applyMemoryError();
+  backend->getTableau().h(index);
+  applySingleQubitGateError(gate_err_h);
+}
+void StabilizerTableauQubit::gateZ() {
+  applyMemoryError();
+  backend->getTableau().z(index);
+  applySingleQubitGateError(gate_err_z);
+}
+void StabilizerTableauQubit::gateX() {
+  applyMemoryError();
+  backend->getTableau().x(index);
+  applySingleQubitGateError(gate_err_x);
+}
+void StabilizerTableauQubit::gateY() {
+  applyMemoryError();
+  backend->getTableau().y(index);
+  // same as GraphStateQubit, Y uses the X gate error
+  applySingleQubitGateError(gate_err_x);
+}
+void StabilizerTableauQubit::gateS() {
+  applyMemoryError();
+  backend->getTableau().s(index);
+}
+void StabilizerTableauQubit::gateSdg() {
+  applyMemoryError();
+  backend->getTableau().sdg(index);
+}
+
+EigenvalueResult StabilizerTableauQubit::measureX() {
+  applyMemoryError();
+  backend->getTableau().h(index);
+  return flipWithProbability(tableauMeasureZ(), measurement_err.x_error_rate);
+}
+
+EigenvalueResult StabilizerTableauQubit::measureY() {
+  applyMemoryError();
+  backend->getTableau().sdg(index);
+  backend->getTableau().h(index);
+  return flipWithProbability(tableauMeasureZ(), measurement_err.y_error_rate);
+}
+
+EigenvalueResult StabilizerTableauQubit::measureZ() {
+  applyMemoryError();
+  return flipWithProbability(tableauMeasureZ(), measurement_err.z_error_rate);
+}
+
+void StabilizerTableauQubit::noiselessX() { backend->getTableau().x(index); }
+void StabilizerTableauQubit::noiselessZ() { backend->getTableau().z(index); }
+void StabilizerTableauQubit::noiselessH() { backend->getTableau().h(index); }
+void StabilizerTableauQubit::noiselessCNOT(IQubit *const target_qubit) {
+  auto st_target_qubit = static_cast<StabilizerTableauQubit *>(target_qubit);
+  backend->getTableau().cnot(index, st_target_qubit->index);
+}
+EigenvalueResult StabilizerTableauQubit::noiselessMeasureZ() { return tableauMeasureZ(); }
+EigenvalueResult StabilizerTableauQubit::noiselessMeasureX() {
+  backend->getTableau().h(index);
+  return tableauMeasureZ();
+}
+EigenvalueResult StabilizerTableauQubit::noiselessMeasureZ(EigenvalueResult forced_result) {
+  // a forced result only applies to random outcomes, deterministic outcomes are returned as they are.
+  bool is_minus = backend->getTableau().measureZ(index, forced_result == EigenvalueResult::MINUS_ONE);
+  return is_minus ? EigenvalueResult::MINUS_ONE : EigenvalueResult::PLUS_ONE;
+}
+EigenvalueResult StabilizerTableauQubit::noiselessMeasureX(EigenvalueResult forced_result) {
+  backend->getTableau().h(index);
+  return noiselessMeasureZ(forced_result);
+}
+
+}  // namespace quisp::backends::stabilizer_tableau
@@ -0,0 +1,86 @@
+#pragma once
+#include <memory>
+#include "../GraphState/MemoryTransition.h"
+#include "../GraphState/types.h"
+#include "../interfaces/IQubit.h"
+#include "backends/QubitConfiguration.h"
+#include "backends/interfaces/IQubitId.h"
+#include "omnetpp/simtime.h"
+
+namespace quisp::backends::stabilizer_tableau {
+
+using abstract::EigenvalueResult;
+using abstract::IQubit;
+using abstract::IQubitId;
+using graph_state::Matrix6d;
+using graph_state::MemoryTransition;
+using graph_state::RowVector6d;
+using graph_state::types::MeasurementErrorModel;
+using graph_state::types::MemoryErrorModel;
+using graph_state::types::SingleGateErrorModel;
+using graph_state::types::TwoQubitGateErrorModel;
+using omnetpp::SimTime;
+
+class StabilizerTableauBackend;
+
+/**
+ * @brief a qubit of the StabilizerTableauBackend, i.e. a column of the shared tableau.
+ *
+ * The error models are the same as GraphStateQubit's, only the state representation differs.
+ */
+class StabilizerTableauQubit : public IQubit {
+ public:
+  StabilizerTableauQubit(const IQubitId *id, std::size_t index, StabilizerTableauBackend *const backend, bool is_short_live);
+  ~StabilizerTableauQubit();
+  void configure(std::unique_ptr<StationaryQubitConfiguration> configuration);
+  void setFree() override;
+  const IQubitId *const getId() const override;
+  void relaseBackToPool() override;
+  std::size_t getIndex() const { return index; }
+
+  void gateX() override;
+  void gateZ() override;
+  void gateY() override;
+  void gateH() override;
+  void gateS() override;
+  void gateSdg() override;
+  void gateCNOT(IQubit *const target_qubit) override;
+  EigenvalueResult measureX() override;
+  EigenvalueResult measureY() override;
+  EigenvalueResult measureZ() override;
+
+  void noiselessH() override;
+  void noiselessX() override;
+  void noiselessZ() override;
+  void noiselessCNOT(IQubit *const target_qubit) override;
+  EigenvalueResult noiselessMeasureZ() override;
+  EigenvalueResult noiselessMeasureX() override;
+  EigenvalueResult noiselessMeasureZ(EigenvalueResult forced_result) override;
+  EigenvalueResult noiselessMeasureX(EigenvalueResult forced_result) override;
+
+ protected:
+  // error simulation
+  void setMemoryErrorRates(double x_error_rate, double y_error_rate, double z_error_rate, double excitation_rate, double relaxation_rate);
+  void applySingleQubitGateError(SingleGateErrorModel const &err);
+  void applyTwoQubitGateError(TwoQubitGateErrorModel const &err, StabilizerTableauQubit *another_qubit);
+  void applyMemoryError();
+  void applyPauli(int pauli);
+  EigenvalueResult tableauMeasureZ();
+  EigenvalueResult flipWithProbability(EigenvalueResult result, double probability);
+
+  SingleGateErrorModel gate_err_h;
+  SingleGateErrorModel gate_err_x;
+  SingleGateErrorModel gate_err_z;
+  TwoQubitGateErrorModel gate_err_cnot;
+  MeasurementErrorModel measurement_err;
+  MemoryErrorModel memory_err;
+  std::shared_ptr<const MemoryTransition> memory_transition;
+
+  SimTime updated_time = SimTime(0);
+  const IQubitId *id;
+  const std::size_t index;
+  StabilizerTableauBackend *const backend;
+  const bool is_short_live;
+};
+
+}  // namespace quisp::backends::stabilizer_tableau
@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include <test_utils/TestUtils.h>
+#include <memory>
+#include <stdexcept>
+#include "Backend.h"
+#include "Qubit.h"
+#include "backends/GraphState/test.h"
+#include "backends/interfaces/IConfiguration.h"
+
+namespace {
+using namespace quisp::backends::stabilizer_tableau;
+using quisp::backends::StationaryQubitConfiguration;
+using quisp_test::backends::graph_state::QubitId;
+using quisp_test::backends::graph_state::TestRNG;
+
+class StBackend : public StabilizerTableauBackend {
+ public:
+  using StabilizerTableauBackend::free_columns;
+  using StabilizerTableauBackend::qubits;
+  using StabilizerTableauBackend::tableau;
+  StBackend(std::unique_ptr<IRandomNumberGenerator> rng, std::unique_ptr<StationaryQubitConfiguration> config) : StabilizerTableauBackend(std::move(rng), std::move(config)) {}
+};
+
+class StQubit : public StabilizerTableauQubit {
+ public:
+  using StabilizerTableauQubit::gate_err_cnot;
+  using StabilizerTableauQubit::measurement_err;
+  using StabilizerTableauQubit::memory_err;
+};
+
+class StBackendTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    SimTime::setScaleExp(-9);
+    rng = new TestRNG();
+    backend = std::make_unique<StBackend>(std::unique_ptr<IRandomNumberGenerator>(rng), std::make_unique<StationaryQubitConfiguration>());
+  }
+  TestRNG* rng;
+  std::unique_ptr<StBackend> backend;
+};
+
+TEST_F(StBackendTest, createAndGetQubit) {
+  auto* id = new QubitId(123);
+  auto* qubit = backend->createQubit(id);
+  EXPECT_EQ(backend->qubits.size(), 1);
+  ASSERT_THROW(backend->createQubit(id), std::runtime_error);
+  auto* same_id = new QubitId(123);
+  EXPECT_EQ(backend->getQubit(same_id), qubit);
+  ASSERT_THROW(backend->getQubit(new QubitId(4)), std::runtime_error);
+}
+
+TEST_F(StBackendTest, createQubitWithInvalidConfiguration) {
+  auto conf = new IConfiguration;
+  ASSERT_THROW({ backend->createQubit(new QubitId(4), std::unique_ptr<IConfiguration>(conf)); }, std::runtime_error);
+}
+
+TEST_F(StBackendTest, createQubitWithConfiguration) {
+  auto conf = std::make_unique<StationaryQubitConfiguration>();
+  conf->measurement_z_err_rate = 0.25;
+  conf->memory_x_err_rate = 0.26;
+  conf->cnot_gate_err_rate = 0.5;
+  conf->cnot_gate_xx_err_ratio = 1;
+  auto* qubit = reinterpret_cast<StQubit*>(backend->createQubit(new QubitId(1), std::move(conf)));
+  EXPECT_EQ(qubit->measurement_err.z_error_rate, 0.25);
+  EXPECT_EQ(qubit->memory_err.x_error_rate, 0.26);
+  EXPECT_EQ(qubit->gate_err_cnot.xx_error_rate, 0.5);
+}
+
+TEST_F(StBackendTest, deletedColumnIsReused) {
+  auto* id = new QubitId(1);
+  auto* qubit = dynamic_cast<StabilizerTableauQubit*>(backend->createQubit(id));
+  auto index = qubit->getIndex();
+  backend->deleteQubit(id);
+  EXPECT_EQ(backend->free_columns.size(), 1);
+  auto* another = dynamic_cast<StabilizerTableauQubit*>(backend->createQubit(new QubitId(2)));
+  EXPECT_EQ(another->getIndex(), index);
+  EXPECT_EQ(backend->tableau.numQubits(), 1);
+}
+
+TEST_F(StBackendTest, shortLiveQubitPool) {
+  auto* photon = backend->getShortLiveQubit();
+  photon->noiselessX();
+  photon->relaseBackToPool();
+  // returned photons are reset to |0>
+  auto* reused = backend->getShortLiveQubit();
+  EXPECT_EQ(reused, photon);
+  EXPECT_EQ(reused->noiselessMeasureZ(), EigenvalueResult::PLUS_ONE);
+  auto* stationary = backend->createQubit(new QubitId(9));
+  EXPECT_THROW(stationary->relaseBackToPool(), std::runtime_error);
+}
+
+TEST_F(StBackendTest, photonEmissionAndBellStateMeasurement) {
+  // same sequence as StationaryQubit::generateEntangledPhoton and BellStateAnalyzer::measureSuccessfully
+  auto* left = backend->createQubit(new QubitId(1));
+  auto* right = backend->createQubit(new QubitId(2));
+  auto* left_photon = backend->getShortLiveQubit();
+  auto* right_photon = backend->getShortLiveQubit();
+  left->noiselessH();
+  left->noiselessCNOT(left_photon);
+  right->noiselessH();
+  right->noiselessCNOT(right_photon);
+
+  left_photon->noiselessX();
+  left_photon->noiselessCNOT(right_photon);
+  left_photon->noiselessMeasureX(EigenvalueResult::PLUS_ONE);
+  right_photon->noiselessMeasureZ(EigenvalueResult::PLUS_ONE);
+
+  // the memories are now in Psi+: ZZ = -1, XX = +1
+  rng->double_value = 0.7;
+  auto l = left->noiselessMeasureZ();
+  auto r = right->noiselessMeasureZ();
+  EXPECT_NE(l, r);
+}
+
+TEST_F(StBackendTest, gatesWithoutNoise) {
+  auto* control = backend->createQubit(new QubitId(1));
+  auto* target = backend->createQubit(new QubitId(2));
+  control->gateX();
+  control->gateCNOT(target);
+  EXPECT_EQ(target->measureZ(), EigenvalueResult::MINUS_ONE);
+  EXPECT_EQ(control->measureZ(), EigenvalueResult::MINUS_ONE);
+  control->setFree();
+  EXPECT_EQ(control->measureZ(), EigenvalueResult::PLUS_ONE);
+
+  auto* q = backend->createQubit(new QubitId(3));
+  q->gateH();
+  EXPECT_EQ(q->measureX(), EigenvalueResult::PLUS_ONE);
+  q->setFree();
+  q->gateH();
+  q->gateS();
+  EXPECT_EQ(q->measureY(), EigenvalueResult::PLUS_ONE);
+}
+
+TEST_F(StBackendTest, cnotGateError) {
+  auto conf = std::make_unique<StationaryQubitConfiguration>();
+  conf->cnot_gate_err_rate = 1.0;
+  conf->cnot_gate_xz_err_ratio = 1;
+  auto* control = backend->createQubit(new QubitId(1), std::make_unique<StationaryQubitConfiguration>(*conf));
+  auto* target = backend->createQubit(new QubitId(2), std::move(conf));
+  rng->double_value = 0.99;
+  control->gateCNOT(target);
+  // XZ error: X on control, Z on target (which does not flip |0>)
+  EXPECT_EQ(control->measureZ(), EigenvalueResult::MINUS_ONE);
+  EXPECT_EQ(target->measureZ(), EigenvalueResult::PLUS_ONE);
+}
+
+TEST_F(StBackendTest, memoryRelaxation) {
+  auto conf = std::make_unique<StationaryQubitConfiguration>();
+  conf->memory_relaxation_rate = 0.5;
+  auto* qubit = backend->createQubit(new QubitId(1), std::move(conf));
+  qubit->noiselessX();
+  backend->setSimTime(SimTime(1000, omnetpp::SIMTIME_US));
+  // relaxation is the last label in the distribution
+  rng->double_value = 1.0;
+  EXPECT_EQ(qubit->measureZ(), EigenvalueResult::PLUS_ONE);
+}
+
+}  // namespace
@@ -0,0 +1,223 @@
+#include "Tableau.h"
+#include <algorithm>
+#include <stdexcept>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace quisp::backends::stabilizer_tableau {
+
+namespace {
+inline int popcount(uint64_t v) { return __builtin_popcountll(v); }
+
+// bit masks of the positions where multiplying P1 (x1, z1) by P2 (x2, z2) yields a factor of +i / -i.
+inline uint64_t plusMask(uint64_t x1, uint64_t z1, uint64_t x2, uint64_t z2) { return (x1 & z1 & ~x2 & z2) | (x1 & ~z1 & x2 & z2) | (~x1 & z1 & x2 & ~z2); }
+inline uint64_t minusMask(uint64_t x1, uint64_t z1, uint64_t x2, uint64_t z2) { return (x1 & z1 & x2 & ~z2) | (x1 & ~z1 & ~x2 & z2) | (~x1 & z1 & x2 & z2); }
+}  // namespace
+
+Tableau::Tableau() {}
+
+std::size_t Tableau::addQubit() {
+  if (num_qubits == capacity) grow();
+  auto a = num_qubits++;
+  // a fresh qubit in |0>: destabilizer X_a, stabilizer +Z_a
+  rowClear(a);
+  rowClear(stabRow(a));
+  xs(a)[a / 64] |= uint64_t{1} << (a % 64);
+  zs(stabRow(a))[a / 64] |= uint64_t{1} << (a % 64);
+  return a;
+}
+
+void Tableau::grow() {
+  auto new_capacity = std::max<std::size_t>(64, capacity * 2);
+  auto new_num_words = new_capacity / 64;
+  auto new_row_stride = 2 * new_num_words;
+  std::vector<uint64_t> new_words((2 * new_capacity + 1) * new_row_stride, 0);
+  std::vector<uint8_t> new_signs(2 * new_capacity + 1, 0);
+  for (std::size_t i = 0; i < num_qubits; i++) {
+    for (auto [old_row, new_row] : {std::pair{i, i}, std::pair{stabRow(i), new_capacity + i}}) {
+      std::copy(xs(old_row), xs(old_row) + num_words, &new_words[new_row * new_row_stride]);
+      std::copy(zs(old_row), zs(old_row) + num_words, &new_words[new_row * new_row_stride + new_num_words]);
+      new_signs[new_row] = signs[old_row];
+    }
+  }
+  capacity = new_capacity;
+  num_words = new_num_words;
+  row_stride = new_row_stride;
+  words = std::move(new_words);
+  signs = std::move(new_signs);
+}
+
+void Tableau::rowClear(std::size_t r) {
+  std::fill(xs(r), xs(r) + row_stride, 0);
+  signs[r] = 0;
+}
+
+void Tableau::rowCopy(std::size_t dst, std::size_t src) {
+  std::copy(xs(src), xs(src) + row_stride, xs(dst));
+  signs[dst] = signs[src];
+}
+
+void Tableau::rowMult(std::size_t h, std::size_t i) {
+  uint64_t* xh = xs(h);
+  uint64_t* zh = zs(h);
+  const uint64_t* xi = xs(i);
+  const uint64_t* zi = zs(i);
+  int phase = 2 * signs[h] + 2 * signs[i];
+  std::size_t w = 0;
+#if defined(__AVX2__)
+  for (; w + 4 <= num_words; w += 4) {
+    __m256i x1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(xi + w));
+    __m256i z1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(zi + w));
+    __m256i x2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(xh + w));
+    __m256i z2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(zh + w));
+    __m256i nx1 = _mm256_andnot_si256(x1, _mm256_set1_epi64x(-1));
+    __m256i nz1 = _mm256_andnot_si256(z1, _mm256_set1_epi64x(-1));
+    // plus: (x1 z1 ~x2 z2) | (x1 ~z1 x2 z2) | (~x1 z1 x2 ~z2)
+    __m256i plus = _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(_mm256_and_si256(x1, z1), _mm256_andnot_si256(x2, z2)),
+                                                   _mm256_and_si256(_mm256_and_si256(x1, nz1), _mm256_and_si256(x2, z2))),
+                                   _mm256_and_si256(_mm256_and_si256(nx1, z1), _mm256_andnot_si256(z2, x2)));
+    // minus: (x1 z1 x2 ~z2) | (x1 ~z1 ~x2 z2) | (~x1 z1 x2 z2)
+    __m256i minus = _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(_mm256_and_si256(x1, z1), _mm256_andnot_si256(z2, x2)),
+                                                    _mm256_and_si256(_mm256_and_si256(x1, nz1), _mm256_andnot_si256(x2, z2))),
+                                    _mm256_and_si256(_mm256_and_si256(nx1, z1), _mm256_and_si256(x2, z2)));
+    alignas(32) uint64_t plus_words[4], minus_words[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(plus_words), plus);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(minus_words), minus);
+    for (int k = 0; k < 4; k++) phase += popcount(plus_words[k]) - popcount(minus_words[k]);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(xh + w), _mm256_xor_si256(x1, x2));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(zh + w), _mm256_xor_si256(z1, z2));
+  }
+#endif
+  for (; w < num_words; w++) {
+    phase += popcount(plusMask(xi[w], zi[w], xh[w], zh[w])) - popcount(minusMask(xi[w], zi[w], xh[w], zh[w]));
+    xh[w] ^= xi[w];
+    zh[w] ^= zi[w];
+  }
+  // the phase is always 0 or 2 (mod 4) for commuting generators
+  signs[h] = (((phase % 4) + 4) % 4) == 2;
+}
+
+void Tableau::cnot(std::size_t control, std::size_t target) {
+  if (control == target) throw std::runtime_error("Tableau::cnot: control and target must be different qubits");
+  auto cw = control / 64, tw = target / 64;
+  uint64_t cm = uint64_t{1} << (control % 64), tm = uint64_t{1} << (target % 64);
+  forEachActiveRow([&](std::size_t r) {
+    uint64_t* x = xs(r);
+    uint64_t* z = zs(r);
+    bool xc = x[cw] & cm, zc = z[cw] & cm, xt = x[tw] & tm, zt = z[tw] & tm;
+    signs[r] ^= xc && zt && (xt == zc);
+    if (xc) x[tw] ^= tm;
+    if (zt) z[cw] ^= cm;
+  });
+}
+
+void Tableau::cz(std::size_t a, std::size_t b) {
+  h(b);
+  cnot(a, b);
+  h(b);
+}
+
+void Tableau::h(std::size_t a) {
+  auto aw = a / 64;
+  uint64_t am = uint64_t{1} << (a % 64);
+  forEachActiveRow([&](std::size_t r) {
+    uint64_t* x = xs(r);
+    uint64_t* z = zs(r);
+    bool xa = x[aw] & am, za = z[aw] & am;
+    signs[r] ^= xa && za;
+    if (xa != za) {
+      x[aw] ^= am;
+      z[aw] ^= am;
+    }
+  });
+}
+
+void Tableau::s(std::size_t a) {
+  auto aw = a / 64;
+  uint64_t am = uint64_t{1} << (a % 64);
+  forEachActiveRow([&](std::size_t r) {
+    uint64_t* x = xs(r);
+    uint64_t* z = zs(r);
+    bool xa = x[aw] & am, za = z[aw] & am;
+    signs[r] ^= xa && za;
+    if (xa) z[aw] ^= am;
+  });
+}
+
+void Tableau::sdg(std::size_t a) {
+  s(a);
+  z(a);
+}
+
+void Tableau::x(std::size_t a) {
+  forEachActiveRow([&](std::size_t r) { signs[r] ^= zBit(r, a); });
+}
+
+void Tableau::y(std::size_t a) {
+  forEachActiveRow([&](std::size_t r) { signs[r] ^= xBit(r, a) != zBit(r, a); });
+}
+
+void Tableau::z(std::size_t a) {
+  forEachActiveRow([&](std::size_t r) { signs[r] ^= xBit(r, a); });
+}
+
+bool Tableau::isZMeasurementRandom(std::size_t a) const {
+  for (std::size_t i = 0; i < num_qubits; i++) {
+    if (xBit(stabRow(i), a)) return true;
+  }
+  return false;
+}
+
+bool Tableau::measureZ(std::size_t a, bool random_bit) {
+  std::size_t p = num_qubits;
+  for (std::size_t i = 0; i < num_qubits; i++) {
+    if (xBit(stabRow(i), a)) {
+      p = i;
+      break;
+    }
+  }
+
+  if (p < num_qubits) {
+    // random outcome: every other generator anticommuting with Z_a gets multiplied by stabilizer p.
+    auto p_row = stabRow(p);
+    forEachActiveRow([&](std::size_t r) {
+      if (r != p_row && xBit(r, a)) rowMult(r, p_row);
+    });
+    rowCopy(p, p_row);
+    rowClear(p_row);
+    zs(p_row)[a / 64] |= uint64_t{1} << (a % 64);
+    signs[p_row] = random_bit;
+    return random_bit;
+  }
+
+  // deterministic outcome: Z_a is a product of the stabilizers whose destabilizers anticommute with it.
+  auto scratch = scratchRow();
+  rowClear(scratch);
+  for (std::size_t i = 0; i < num_qubits; i++) {
+    if (xBit(i, a)) rowMult(scratch, stabRow(i));
+  }
+  return signs[scratch];
+}
+
+int Tableau::expectation(const std::vector<bool>& x_bits, const std::vector<bool>& z_bits) {
+  if (x_bits.size() != num_qubits || z_bits.size() != num_qubits) throw std::runtime_error("Tableau::expectation: operator size does not match the number of qubits");
+  auto anticommutes = [&](std::size_t r) {
+    bool result = false;
+    for (std::size_t q = 0; q < num_qubits; q++) {
+      result ^= (x_bits[q] && zBit(r, q)) != (z_bits[q] && xBit(r, q));
+    }
+    return result;
+  };
+  for (std::size_t i = 0; i < num_qubits; i++) {
+    if (anticommutes(stabRow(i))) return 0;
+  }
+  auto scratch = scratchRow();
+  rowClear(scratch);
+  for (std::size_t i = 0; i < num_qubits; i++) {
+    if (anticommutes(i)) rowMult(scratch, stabRow(i));
+  }
+  return signs[scratch] ? -1 : 1;
+}
+
+}  // namespace quisp::backends::stabilizer_tableau
@@ -0,0 +1,91 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace quisp::backends::stabilizer_tableau {
+
+/**
+ * @brief Aaronson-Gottesman (CHP) stabilizer tableau with bit-packed rows.
+ *
+ * Each row holds the X and Z bits of one destabilizer/stabilizer generator packed into 64-bit words,
+ * followed by its sign. Row i is the destabilizer of qubit i, row capacity + i is its stabilizer,
+ * and the last row is a scratch row for deterministic measurements.
+ * Gates touch one column of every active row, measurements use word-wise row multiplication.
+ *
+ * Qubits are added in |0> and the tableau grows by doubling its capacity.
+ * see: S. Aaronson and D. Gottesman, "Improved simulation of stabilizer circuits", PRA 70, 052328 (2004).
+ */
+class Tableau {
+ public:
+  Tableau();
+
+  /**
+   * @brief add a new qubit in |0>.
+   * @return the column index of the qubit.
+   */
+  std::size_t addQubit();
+  std::size_t numQubits() const { return num_qubits; }
+  std::size_t getCapacity() const { return capacity; }
+
+  void cnot(std::size_t control, std::size_t target);
+  void cz(std::size_t a, std::size_t b);
+  void h(std::size_t a);
+  void s(std::size_t a);
+  void sdg(std::size_t a);
+  void x(std::size_t a);
+  void y(std::size_t a);
+  void z(std::size_t a);
+
+  /**
+   * @brief whether a Z measurement of the qubit has a random outcome.
+   */
+  bool isZMeasurementRandom(std::size_t a) const;
+
+  /**
+   * @brief measure the qubit in Z basis.
+   * @param random_bit the outcome used if the result is not determined by the state (true means -1).
+   * @return true if the result is -1.
+   */
+  bool measureZ(std::size_t a, bool random_bit);
+
+  /**
+   * @brief the expectation of the Pauli product given as X and Z bit masks over all qubits.
+   * @return +1 or -1 if the operator (or its negation) stabilizes the state, otherwise 0.
+   */
+  int expectation(const std::vector<bool>& x_bits, const std::vector<bool>& z_bits);
+
+ protected:
+  std::size_t rowIndex(std::size_t r) const { return r * row_stride; }
+  uint64_t* xs(std::size_t r) { return &words[rowIndex(r)]; }
+  uint64_t* zs(std::size_t r) { return &words[rowIndex(r) + num_words]; }
+  const uint64_t* xs(std::size_t r) const { return &words[rowIndex(r)]; }
+  const uint64_t* zs(std::size_t r) const { return &words[rowIndex(r) + num_words]; }
+  bool xBit(std::size_t r, std::size_t a) const { return (xs(r)[a / 64] >> (a % 64)) & 1; }
+  bool zBit(std::size_t r, std::size_t a) const { return (zs(r)[a / 64] >> (a % 64)) & 1; }
+  std::size_t stabRow(std::size_t i) const { return capacity + i; }
+  std::size_t scratchRow() const { return 2 * capacity; }
+
+  // calls f(row) for every destabilizer and stabilizer row of the active qubits.
+  template <typename F>
+  void forEachActiveRow(F&& f) {
+    for (std::size_t i = 0; i < num_qubits; i++) f(i);
+    for (std::size_t i = 0; i < num_qubits; i++) f(stabRow(i));
+  }
+
+  // row h := row i * row h, keeping track of the sign.
+  void rowMult(std::size_t h, std::size_t i);
+  void rowCopy(std::size_t dst, std::size_t src);
+  void rowClear(std::size_t r);
+  void grow();
+
+  std::size_t num_qubits = 0;
+  std::size_t capacity = 0;
+  std::size_t num_words = 0;
+  // x words, z words
+  std::size_t row_stride = 0;
+  std::vector<uint64_t> words;
+  std::vector<uint8_t> signs;
+};
+
+}  // namespace quisp::backends::stabilizer_tableau
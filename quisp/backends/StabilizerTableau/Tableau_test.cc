@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "Tableau.h"
+
+namespace {
+using quisp::backends::stabilizer_tableau::Tableau;
+
+std::vector<bool> bits(std::size_t n, std::vector<std::size_t> ones) {
+  std::vector<bool> v(n, false);
+  for (auto i : ones) v[i] = true;
+  return v;
+}
+
+TEST(TableauTest, freshQubitsAreZero) {
+  Tableau t;
+  for (int i = 0; i < 3; i++) t.addQubit();
+  EXPECT_EQ(t.numQubits(), 3);
+  for (std::size_t i = 0; i < 3; i++) {
+    EXPECT_FALSE(t.isZMeasurementRandom(i));
+    EXPECT_FALSE(t.measureZ(i, true));
+  }
+}
+
+TEST(TableauTest, singleQubitGates) {
+  Tableau t;
+  t.addQubit();
+  t.x(0);
+  EXPECT_TRUE(t.measureZ(0, false));
+  t.x(0);
+  t.h(0);
+  EXPECT_TRUE(t.isZMeasurementRandom(0));
+  EXPECT_EQ(t.expectation(bits(1, {0}), bits(1, {})), 1);  // |+>
+  t.z(0);
+  EXPECT_EQ(t.expectation(bits(1, {0}), bits(1, {})), -1);  // |->
+  t.s(0);
+  EXPECT_EQ(t.expectation(bits(1, {0}), bits(1, {0})), -1);  // S|-> = |-i>
+  t.sdg(0);
+  EXPECT_EQ(t.expectation(bits(1, {0}), bits(1, {})), -1);
+  t.y(0);
+  EXPECT_EQ(t.expectation(bits(1, {0}), bits(1, {})), 1);
+}
+
+TEST(TableauTest, bellPairCorrelations) {
+  for (bool random_bit : {false, true}) {
+    Tableau t;
+    t.addQubit();
+    t.addQubit();
+    t.h(0);
+    t.cnot(0, 1);
+    EXPECT_EQ(t.expectation(bits(2, {0, 1}), bits(2, {})), 1);
+    EXPECT_EQ(t.expectation(bits(2, {}), bits(2, {0, 1})), 1);
+    EXPECT_EQ(t.expectation(bits(2, {0, 1}), bits(2, {0, 1})), -1);  // YY
+    EXPECT_EQ(t.expectation(bits(2, {}), bits(2, {0})), 0);
+    EXPECT_TRUE(t.isZMeasurementRandom(0));
+    auto m0 = t.measureZ(0, random_bit);
+    EXPECT_EQ(m0, random_bit);
+    EXPECT_FALSE(t.isZMeasurementRandom(1));
+    EXPECT_EQ(t.measureZ(1, !random_bit), m0);
+  }
+}
+
+TEST(TableauTest, czMatchesHadamardConjugatedCnot) {
+  Tableau t;
+  t.addQubit();
+  t.addQubit();
+  t.h(0);
+  t.h(1);
+  t.cz(0, 1);
+  // graph state of two vertices: stabilizers XZ and ZX
+  EXPECT_EQ(t.expectation(bits(2, {0}), bits(2, {1})), 1);
+  EXPECT_EQ(t.expectation(bits(2, {1}), bits(2, {0})), 1);
+}
+
+TEST(TableauTest, entanglementSwapping) {
+  // |Phi+>_{01} |Phi+>_{23}, Bell measurement on 1 and 2 leaves 0 and 3 entangled up to Pauli corrections
+  Tableau t;
+  for (int i = 0; i < 4; i++) t.addQubit();
+  t.h(0);
+  t.cnot(0, 1);
+  t.h(2);
+  t.cnot(2, 3);
+  t.cnot(1, 2);
+  t.h(1);
+  bool m1 = t.measureZ(1, true);
+  bool m2 = t.measureZ(2, false);
+  if (m2) t.x(3);
+  if (m1) t.z(3);
+  EXPECT_EQ(t.expectation(bits(4, {0, 3}), bits(4, {})), 1);
+  EXPECT_EQ(t.expectation(bits(4, {}), bits(4, {0, 3})), 1);
+}
+
+TEST(TableauTest, growsBeyondOneWord) {
+  Tableau t;
+  const std::size_t n = 150;
+  for (std::size_t i = 0; i < n; i++) t.addQubit();
+  EXPECT_GE(t.getCapacity(), n);
+  // GHZ state over all qubits
+  t.h(0);
+  for (std::size_t i = 1; i < n; i++) t.cnot(0, i);
+  auto all = std::vector<bool>(n, true);
+  EXPECT_EQ(t.expectation(all, std::vector<bool>(n, false)), 1);
+  EXPECT_EQ(t.expectation(bits(n, {}), bits(n, {3, 140})), 1);
+  auto m = t.measureZ(70, true);
+  for (std::size_t i = 0; i < n; i++) {
+    EXPECT_FALSE(t.isZMeasurementRandom(i));
+    EXPECT_EQ(t.measureZ(i, false), m);
+  }
+  // adding a qubit after growing keeps the existing state
+  t.addQubit();
+  EXPECT_EQ(t.measureZ(5, false), m);
+  EXPECT_FALSE(t.measureZ(n, true));
+}
+
+}  // namespace
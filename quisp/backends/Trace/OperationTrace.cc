@@ -0,0 +1,204 @@
+#include "OperationTrace.h"
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+#include "backends/interfaces/IQubit.h"
+#include "modules/QNIC/StationaryQubit/QubitId.h"
+
+using quisp::modules::qubit_id::QubitId;
+
+namespace quisp::backends::trace {
+using abstract::EigenvalueResult;
+using abstract::IQubit;
+using abstract::PurificationBasis;
+using abstract::SimTime;
+
+namespace {
+constexpr char trace_magic[8] = {'Q', 'S', 'P', 'T', 'R', 'A', 'C', '1'};
+
+template <typename T>
+void writeValue(std::ostream &os, T value) {
+  os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T>
+bool readValue(std::istream &is, T &value) {
+  return static_cast<bool>(is.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+
+int unpackField(std::uint64_t key, int shift, int bits) {
+  auto mask = (std::uint64_t{1} << bits) - 1;
+  auto value = (key >> shift) & mask;
+  return value == mask ? -1 : static_cast<int>(value);
+}
+
+bool isShortLiveKey(std::uint64_t key) { return unpackField(key, 64 - QubitId::node_bits, QubitId::node_bits) == -1; }
+
+QubitId *toQubitId(std::uint64_t key) {
+  int qnic_index_shift = QubitId::qubit_bits;
+  int qnic_type_shift = qnic_index_shift + QubitId::qnic_index_bits;
+  int node_shift = qnic_type_shift + QubitId::qnic_type_bits;
+  return new QubitId(unpackField(key, node_shift, QubitId::node_bits), unpackField(key, qnic_index_shift, QubitId::qnic_index_bits),
+                     unpackField(key, qnic_type_shift, QubitId::qnic_type_bits), unpackField(key, 0, QubitId::qubit_bits));
+}
+
+class Replayer {
+ public:
+  explicit Replayer(IQuantumBackend *backend) : backend(backend) {}
+
+  void run(const TraceRecord &record) {
+    if (record.time != current_time.raw()) {
+      current_time.setRaw(record.time);
+      backend->setSimTime(current_time);
+    }
+    switch (record.op) {
+      case TraceOp::CreateQubit:
+        if (qubits.find(record.qubit) == qubits.cend()) qubits[record.qubit] = backend->createQubit(toQubitId(record.qubit));
+        break;
+      case TraceOp::CreateShortLiveQubit:
+        qubits[record.qubit] = backend->createShortLiveQubit();
+        break;
+      case TraceOp::GetShortLiveQubit:
+        qubits[record.qubit] = backend->getShortLiveQubit();
+        break;
+      case TraceOp::ReturnToPool:
+        backend->returnToPool(qubit(record.qubit));
+        break;
+      case TraceOp::DeleteQubit: {
+        auto *id = qubit(record.qubit)->getId();
+        backend->deleteQubit(id);
+        qubits.erase(record.qubit);
+        // the replay created the id, and the backends don't delete the ids of the deleted qubits
+        delete id;
+        break;
+      }
+      case TraceOp::SetFree:
+        qubit(record.qubit)->setFree();
+        break;
+      case TraceOp::X:
+        qubit(record.qubit)->gateX();
+        break;
+      case TraceOp::Y:
+        qubit(record.qubit)->gateY();
+        break;
+      case TraceOp::Z:
+        qubit(record.qubit)->gateZ();
+        break;
+      case TraceOp::H:
+        qubit(record.qubit)->gateH();
+        break;
+      case TraceOp::S:
+        qubit(record.qubit)->gateS();
+        break;
+      case TraceOp::Sdg:
+        qubit(record.qubit)->gateSdg();
+        break;
+      case TraceOp::CNOT:
+        qubit(record.qubit)->gateCNOT(qubit(record.other));
+        break;
+      case TraceOp::MeasureX:
+        qubit(record.qubit)->measureX();
+        break;
+      case TraceOp::MeasureY:
+        qubit(record.qubit)->measureY();
+        break;
+      case TraceOp::MeasureZ:
+        qubit(record.qubit)->measureZ();
+        break;
+      case TraceOp::BellMeasure:
+        qubit(record.qubit)->bellMeasure(qubit(record.other));
+        break;
+      case TraceOp::Purify:
+        qubit(record.qubit)->purify(qubit(record.other), static_cast<PurificationBasis>(record.arg));
+        break;
+      case TraceOp::NoiselessX:
+        qubit(record.qubit)->noiselessX();
+        break;
+      case TraceOp::NoiselessZ:
+        qubit(record.qubit)->noiselessZ();
+        break;
+      case TraceOp::NoiselessH:
+        qubit(record.qubit)->noiselessH();
+        break;
+      case TraceOp::NoiselessCNOT:
+        qubit(record.qubit)->noiselessCNOT(qubit(record.other));
+        break;
+      case TraceOp::NoiselessMeasureX:
+        qubit(record.qubit)->noiselessMeasureX();
+        break;
+      case TraceOp::NoiselessMeasureZ:
+        qubit(record.qubit)->noiselessMeasureZ();
+        break;
+      case TraceOp::NoiselessMeasureXForced:
+        qubit(record.qubit)->noiselessMeasureX(static_cast<EigenvalueResult>(record.arg));
+        break;
+      case TraceOp::NoiselessMeasureZForced:
+        qubit(record.qubit)->noiselessMeasureZ(static_cast<EigenvalueResult>(record.arg));
+        break;
+      default:
+        throw std::runtime_error("replay: unknown operation in the trace");
+    }
+  }
+
+ protected:
+  IQubit *qubit(std::uint64_t key) {
+    auto it = qubits.find(key);
+    if (it != qubits.cend()) return it->second;
+    auto *created = isShortLiveKey(key) ? backend->getShortLiveQubit() : backend->createQubit(toQubitId(key));
+    qubits[key] = created;
+    return created;
+  }
+
+  IQuantumBackend *const backend;
+  std::unordered_map<std::uint64_t, IQubit *> qubits;
+  SimTime current_time = SimTime(0);
+};
+}  // namespace
+
+TraceWriter::TraceWriter(std::ostream &os) : os(os) {
+  os.write(trace_magic, sizeof(trace_magic));
+  writeValue<std::int32_t>(os, SimTime::getScaleExp());
+}
+
+void TraceWriter::write(const TraceRecord &record) {
+  writeValue(os, static_cast<std::uint8_t>(record.op));
+  writeValue(os, record.arg);
+  writeValue(os, record.rng_draws);
+  writeValue(os, record.qubit);
+  writeValue(os, record.other);
+  writeValue(os, record.time);
+  num_records++;
+}
+
+std::vector<TraceRecord> readTrace(std::istream &is) {
+  char magic[sizeof(trace_magic)];
+  if (!is.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), trace_magic)) throw std::runtime_error("not a backend operation trace");
+  std::int32_t scale_exp;
+  if (!readValue(is, scale_exp)) throw std::runtime_error("truncated backend operation trace");
+  if (scale_exp != SimTime::getScaleExp()) throw std::runtime_error("the backend operation trace was recorded with another SimTime scale");
+
+  std::vector<TraceRecord> records;
+  TraceRecord record;
+  std::uint8_t op;
+  while (readValue(is, op)) {
+    record.op = static_cast<TraceOp>(op);
+    if (!readValue(is, record.arg) || !readValue(is, record.rng_draws) || !readValue(is, record.qubit) || !readValue(is, record.other) || !readValue(is, record.time)) {
+      throw std::runtime_error("truncated backend operation trace");
+    }
+    records.push_back(record);
+  }
+  return records;
+}
+
+ReplayResult replay(const std::vector<TraceRecord> &records, IQuantumBackend *backend) {
+  Replayer replayer(backend);
+  ReplayResult result;
+  for (auto &record : records) {
+    replayer.run(record);
+    result.num_ops++;
+    result.num_recorded_rng_draws += record.rng_draws;
+  }
+  return result;
+}
+
+}  // namespace quisp::backends::trace
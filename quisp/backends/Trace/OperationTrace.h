@@ -0,0 +1,89 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+#include "../interfaces/IQuantumBackend.h"
+
+namespace quisp::backends::trace {
+using abstract::IQuantumBackend;
+
+enum class TraceOp : std::uint8_t {
+  CreateQubit,
+  CreateShortLiveQubit,
+  GetShortLiveQubit,
+  ReturnToPool,
+  DeleteQubit,
+  SetFree,
+  X,
+  Y,
+  Z,
+  H,
+  S,
+  Sdg,
+  CNOT,
+  MeasureX,
+  MeasureY,
+  MeasureZ,
+  BellMeasure,
+  Purify,  // arg: PurificationBasis
+  NoiselessX,
+  NoiselessZ,
+  NoiselessH,
+  NoiselessCNOT,
+  NoiselessMeasureX,
+  NoiselessMeasureZ,
+  NoiselessMeasureXForced,  // arg: EigenvalueResult
+  NoiselessMeasureZForced,  // arg: EigenvalueResult
+};
+
+/**
+ * @brief one backend operation, 28 bytes in the trace file.
+ *
+ * The qubits are the packed keys of their ids (IQubitId::getPackedKey), the time is the raw SimTime when the operation ran,
+ * and rng_draws is the number of random numbers the operation consumed in the recording backend.
+ */
+struct TraceRecord {
+  TraceOp op = TraceOp::CreateQubit;
+  std::uint8_t arg = 0;
+  std::uint16_t rng_draws = 0;
+  std::uint64_t qubit = 0;
+  std::uint64_t other = 0;
+  std::int64_t time = 0;
+};
+
+/**
+ * @brief writes the trace file: a header with the SimTime scale, followed by fixed size records.
+ */
+class TraceWriter {
+ public:
+  explicit TraceWriter(std::ostream &os);
+  void write(const TraceRecord &record);
+  std::size_t numRecords() const { return num_records; }
+
+ protected:
+  std::ostream &os;
+  std::size_t num_records = 0;
+};
+
+// reads a whole trace written by TraceWriter. throws std::runtime_error if it's not a trace or its SimTime scale differs from the current one.
+std::vector<TraceRecord> readTrace(std::istream &is);
+
+struct ReplayResult {
+  std::size_t num_ops = 0;
+  // consumed in the recording, the replaying backend draws its own
+  std::size_t num_recorded_rng_draws = 0;
+};
+
+/**
+ * @brief drives the backend with the recorded operations, without any simulation around it.
+ *
+ * The qubits get the default configuration of the backend. The qubits the trace uses before creating them,
+ * e.g. when the recording started in the middle of a run, are created at their first use.
+ * The measurement outcomes come from the replaying backend and don't change the recorded operations,
+ * so the replay has the workload of the recording but not its trajectory.
+ */
+ReplayResult replay(const std::vector<TraceRecord> &records, IQuantumBackend *backend);
+
+}  // namespace quisp::backends::trace
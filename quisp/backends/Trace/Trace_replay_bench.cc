@@ -0,0 +1,111 @@
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include "OperationTrace.h"
+#include "backends/GraphState/Backend.h"
+#include "backends/GraphState/test.h"
+#include "backends/Hybrid/Backend.h"
+#include "backends/PauliFrame/Backend.h"
+#include "backends/StabilizerTableau/Backend.h"
+#include "modules/QNIC/StationaryQubit/QubitId.h"
+
+namespace {
+using namespace quisp::backends::trace;
+using quisp::backends::StationaryQubitConfiguration;
+using quisp::backends::graph_state::GraphStateBackend;
+using quisp::backends::hybrid::HybridBackend;
+using quisp::backends::pauli_frame::PauliFrameBackend;
+using quisp::backends::stabilizer_tableau::StabilizerTableauBackend;
+using quisp::modules::qubit_id::QubitId;
+using quisp_test::backends::graph_state::TestRNG;
+
+// a repeater chain of 16 nodes: every round makes the links with the photons at the Bell state analyzers and swaps them end to end
+std::vector<TraceRecord> recordRepeaterChain() {
+  constexpr int num_nodes = 16;
+  constexpr int num_rounds = 64;
+  GraphStateBackend backend(std::make_unique<TestRNG>(), std::make_unique<StationaryQubitConfiguration>());
+  std::stringstream stream;
+  TraceWriter writer(stream);
+  backend.setTraceWriter(&writer);
+  // qnic 0 faces the left neighbor, qnic 1 the right one
+  std::vector<IQubit*> lefts, rights;
+  for (int node = 0; node < num_nodes; node++) {
+    lefts.push_back(backend.createQubit(new QubitId(node, 0, 0, 0)));
+    rights.push_back(backend.createQubit(new QubitId(node, 1, 0, 0)));
+  }
+  for (int round = 0; round < num_rounds; round++) {
+    for (int node = 0; node + 1 < num_nodes; node++) {
+      auto* photon_left = backend.getShortLiveQubit();
+      auto* photon_right = backend.getShortLiveQubit();
+      rights[node]->gateH();
+      rights[node]->gateCNOT(photon_left);
+      lefts[node + 1]->gateH();
+      lefts[node + 1]->gateCNOT(photon_right);
+      backend.setSimTime(backend.getSimTime() + SimTime(10, omnetpp::SIMTIME_US));
+      photon_left->bellMeasure(photon_right);
+      photon_left->relaseBackToPool();
+      photon_right->relaseBackToPool();
+    }
+    for (int node = 1; node + 1 < num_nodes; node++) {
+      lefts[node]->bellMeasure(rights[node]);
+      rights.back()->gateX();
+      lefts.front()->gateZ();
+    }
+    lefts.front()->measureZ();
+    rights.back()->measureZ();
+    for (int node = 0; node < num_nodes; node++) {
+      lefts[node]->setFree();
+      rights[node]->setFree();
+    }
+  }
+  backend.setTraceWriter(nullptr);
+  return readTrace(stream);
+}
+
+// QUISP_BACKEND_TRACE names a trace recorded with GraphStateBackend::setTraceWriter, e.g. from a simulation run, instead of the repeater chain
+const std::vector<TraceRecord>& benchTrace() {
+  static const std::vector<TraceRecord> records = [] {
+    SimTime::setScaleExp(-9);
+    auto* path = std::getenv("QUISP_BACKEND_TRACE");
+    if (path == nullptr) return recordRepeaterChain();
+    std::ifstream file(path, std::ios::binary);
+    if (!file) throw std::runtime_error("cannot open the backend operation trace");
+    return readTrace(file);
+  }();
+  return records;
+}
+
+template <typename BackendType>
+void replayBench(benchmark::State& state) {
+  auto& records = benchTrace();
+  std::size_t num_ops = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto backend = std::make_unique<BackendType>(std::make_unique<TestRNG>(), std::make_unique<StationaryQubitConfiguration>());
+    state.ResumeTiming();
+    num_ops += replay(records, backend.get()).num_ops;
+    state.PauseTiming();
+    backend.reset();
+    state.ResumeTiming();
+  }
+  state.counters["ops"] = benchmark::Counter(num_ops, benchmark::Counter::kIsRate);
+  state.SetItemsProcessed(num_ops);
+}
+
+static void BM_Replay_GraphState(benchmark::State& state) { replayBench<GraphStateBackend>(state); }
+BENCHMARK(BM_Replay_GraphState);
+
+static void BM_Replay_PauliFrame(benchmark::State& state) { replayBench<PauliFrameBackend>(state); }
+BENCHMARK(BM_Replay_PauliFrame);
+
+static void BM_Replay_StabilizerTableau(benchmark::State& state) { replayBench<StabilizerTableauBackend>(state); }
+BENCHMARK(BM_Replay_StabilizerTableau);
+
+static void BM_Replay_Hybrid(benchmark::State& state) { replayBench<HybridBackend>(state); }
+BENCHMARK(BM_Replay_Hybrid);
+
+}  // namespace
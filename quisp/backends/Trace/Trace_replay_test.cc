@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include "OperationTrace.h"
+#include "backends/GraphState/Backend.h"
+#include "backends/GraphState/test.h"
+#include "backends/PauliFrame/Backend.h"
+#include "backends/StabilizerTableau/Backend.h"
+#include "modules/QNIC/StationaryQubit/QubitId.h"
+
+namespace {
+using namespace quisp::backends::trace;
+using quisp::backends::StationaryQubitConfiguration;
+using quisp::backends::graph_state::GraphStateBackend;
+using quisp::backends::pauli_frame::PauliFrameBackend;
+using quisp::backends::stabilizer_tableau::StabilizerTableauBackend;
+using quisp::modules::qubit_id::QubitId;
+using quisp_test::backends::graph_state::TestRNG;
+
+class TraceReplayTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    SimTime::setScaleExp(-9);
+    backend = std::make_unique<GraphStateBackend>(std::make_unique<TestRNG>(), std::make_unique<StationaryQubitConfiguration>());
+  }
+
+  // entanglement swapping of two links, each made by a Bell state measurement of the photons from both ends
+  void swapping() {
+    auto* left = backend->createQubit(new QubitId(0, 0, 0, 0));
+    auto* middle_left = backend->createQubit(new QubitId(1, 0, 0, 0));
+    auto* middle_right = backend->createQubit(new QubitId(1, 1, 0, 0));
+    auto* right = backend->createQubit(new QubitId(2, 0, 0, 0));
+    for (auto [a, b] : {std::pair{left, middle_left}, std::pair{middle_right, right}}) {
+      auto* photon_a = emit(a);
+      backend->setSimTime(backend->getSimTime() + SimTime(1, omnetpp::SIMTIME_US));
+      auto* photon_b = emit(b);
+      photon_a->bellMeasure(photon_b);
+      photon_a->relaseBackToPool();
+      photon_b->relaseBackToPool();
+    }
+    middle_left->bellMeasure(middle_right);
+    right->gateX();
+    left->gateZ();
+  }
+
+  IQubit* emit(IQubit* memory) {
+    auto* photon = backend->getShortLiveQubit();
+    memory->gateH();
+    memory->gateCNOT(photon);
+    return photon;
+  }
+
+  std::vector<TraceRecord> record() {
+    std::stringstream stream;
+    TraceWriter writer(stream);
+    backend->setTraceWriter(&writer);
+    swapping();
+    backend->setTraceWriter(nullptr);
+    auto records = readTrace(stream);
+    EXPECT_EQ(records.size(), writer.numRecords());
+    return records;
+  }
+
+  std::unique_ptr<GraphStateBackend> backend;
+};
+
+TEST_F(TraceReplayTest, recordsTheOutermostOperations) {
+  auto records = record();
+  // 4 creations, 2 x (2 x (get photon, H, CNOT), Bell measurement, 2 releases), the swapping and the corrections
+  ASSERT_EQ(records.size(), 4 + 2 * 9 + 3);
+  EXPECT_EQ(records[0].op, TraceOp::CreateQubit);
+  EXPECT_EQ(records[0].qubit, QubitId::pack(0, 0, 0, 0));
+  EXPECT_EQ(records[0].rng_draws, 0);
+  // the photon created by the empty pool is a part of getShortLiveQubit
+  EXPECT_EQ(records[4].op, TraceOp::GetShortLiveQubit);
+  EXPECT_EQ(records[4].qubit, QubitId::pack(-1, -1, -1, 1));
+  EXPECT_EQ(records[6].op, TraceOp::CNOT);
+  EXPECT_EQ(records[6].qubit, QubitId::pack(0, 0, 0, 0));
+  EXPECT_EQ(records[6].other, QubitId::pack(-1, -1, -1, 1));
+  EXPECT_EQ(records[6].time, 0);
+  EXPECT_EQ(records[7].time, SimTime(1, omnetpp::SIMTIME_US).raw());
+  EXPECT_EQ(records[10].op, TraceOp::BellMeasure);
+  // the setFree in returnToPool is a part of it
+  EXPECT_EQ(records[11].op, TraceOp::ReturnToPool);
+  EXPECT_EQ(records[12].op, TraceOp::ReturnToPool);
+  EXPECT_EQ(records[13].op, TraceOp::GetShortLiveQubit);
+  EXPECT_EQ(records[13].qubit, records[4].qubit);
+  EXPECT_EQ(records[22].op, TraceOp::BellMeasure);
+  EXPECT_EQ(records[22].other, QubitId::pack(1, 1, 0, 0));
+}
+
+TEST_F(TraceReplayTest, replaysOnAnyBackend) {
+  auto records = record();
+  auto expect_replay = [&](IQuantumBackend* replaying) {
+    auto result = replay(records, replaying);
+    EXPECT_EQ(result.num_ops, records.size());
+    QubitId id(2, 0, 0, 0);
+    EXPECT_NE(replaying->getQubit(&id), nullptr);
+  };
+
+  GraphStateBackend graph_state(std::make_unique<TestRNG>(), std::make_unique<StationaryQubitConfiguration>());
+  std::stringstream stream;
+  TraceWriter writer(stream);
+  graph_state.setTraceWriter(&writer);
+  expect_replay(&graph_state);
+  graph_state.setTraceWriter(nullptr);
+  // the replay runs the same operations again
+  auto rerecorded = readTrace(stream);
+  ASSERT_EQ(rerecorded.size(), records.size());
+  for (std::size_t i = 0; i < records.size(); i++) {
+    EXPECT_EQ(rerecorded[i].op, records[i].op);
+    EXPECT_EQ(rerecorded[i].qubit, records[i].qubit);
+    EXPECT_EQ(rerecorded[i].time, records[i].time);
+  }
+
+  PauliFrameBackend pauli_frame(std::make_unique<TestRNG>(), std::make_unique<StationaryQubitConfiguration>());
+  expect_replay(&pauli_frame);
+  StabilizerTableauBackend tableau(std::make_unique<TestRNG>(), std::make_unique<StationaryQubitConfiguration>());
+  expect_replay(&tableau);
+}
+
+TEST_F(TraceReplayTest, createsTheQubitsOfAPartialTrace) {
+  backend->createQubit(new QubitId(0, 0, 0, 0));
+  std::stringstream stream;
+  TraceWriter writer(stream);
+  backend->setTraceWriter(&writer);
+  QubitId id(0, 0, 0, 0);
+  backend->getQubit(&id)->gateH();
+  backend->setTraceWriter(nullptr);
+
+  GraphStateBackend replaying(std::make_unique<TestRNG>(), std::make_unique<StationaryQubitConfiguration>());
+  EXPECT_EQ(replay(readTrace(stream), &replaying).num_ops, 1);
+  EXPECT_NE(replaying.getQubit(&id), nullptr);
+}
+
+TEST_F(TraceReplayTest, rejectsBrokenTraces) {
+  std::stringstream not_a_trace("QSPGRPH1");
+  EXPECT_THROW(readTrace(not_a_trace), std::runtime_error);
+
+  std::stringstream stream;
+  TraceWriter writer(stream);
+  writer.write(TraceRecord{});
+  auto truncated = stream.str();
+  truncated.pop_back();
+  std::stringstream truncated_stream(truncated);
+  EXPECT_THROW(readTrace(truncated_stream), std::runtime_error);
+}
+
+}  // namespace
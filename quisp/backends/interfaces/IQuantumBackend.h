@@ -1,14 +1,16 @@
 #pragma once
 #include <omnetpp/simtime_t.h>
 #include <memory>
+#include <stdexcept>
+#include <vector>
 #include "IConfiguration.h"
+#include "IQubit.h"
 #include "IQubitId.h"
 
 namespace quisp::backends::abstract {
 
 using omnetpp::SimTime;
 using omnetpp::SimTimeUnit;
-class IQubit;
 
 /**
  * @brief The abstract interface for a quantum backend.
@@ -32,6 +34,29 @@ class IQuantumBackend {
   virtual const SimTime& getSimTime() = 0;
   virtual void setSimTime(SimTime time) = 0;
 
+  /**
+   * @brief the fidelity of the two qubits to the Bell state (|00> + |11>) / sqrt(2), known to the simulator without any measurement.
+   * for the metrics of the simulation studies, a real network only knows it from the tomography.
+   */
+  virtual double getBellPairFidelity(IQubit* first, IQubit* second) { throw std::runtime_error("getBellPairFidelity is not implemented"); }
+
+  /**
+   * @brief one purification round of each qubits[i] with trash_qubits[i], the outcomes of the trash qubits are written to results.
+   * a batch purification of a Program comes in one call, the default runs IQubit::purify pair by pair.
+   */
+  virtual void purify(const std::vector<IQubit*>& qubits, const std::vector<IQubit*>& trash_qubits, PurificationBasis basis, std::vector<EigenvalueResult>& results) {
+    results.resize(qubits.size());
+    for (std::size_t i = 0; i < qubits.size(); i++) results[i] = qubits[i]->purify(trash_qubits[i], basis);
+  }
+
+  /**
+   * @brief frees the qubits back to |0>, the same as IQubit::setFree of each one in order.
+   * the qubits of a failed emission round or a terminated RuleSet come in one call, the default frees them one by one.
+   */
+  virtual void setFree(const std::vector<IQubit*>& qubits) {
+    for (auto* qubit : qubits) qubit->setFree();
+  }
+
  protected:
 };
 
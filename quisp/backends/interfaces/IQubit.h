@@ -18,6 +18,17 @@ enum class EigenvalueResult : int {
   PLUS_ONE,
   MINUS_ONE,
 };
+// the Pauli checked by a purification: X (ZZ of the pairs), Z (XX of the pairs) or Y
+enum class PurificationBasis : int {
+  X,
+  Z,
+  Y,
+};
+// the outcomes of a Bell state measurement: X of the control and Z of the target after a CNOT between them
+struct BellMeasurementResult {
+  EigenvalueResult x_result;
+  EigenvalueResult z_result;
+};
 struct MeasurementOutcome {
   char basis;
   bool outcome_is_plus;
@@ -64,6 +75,31 @@ class IQubit {
   virtual EigenvalueResult measureX() { throw std::runtime_error("measureX not implemented"); }
   virtual EigenvalueResult measureY() { throw std::runtime_error("measureY not implemented"); }
   virtual EigenvalueResult measureZ() { throw std::runtime_error("measureZ not implemented"); }
+
+  // CNOT to the target, then X on this qubit and Z on the target. a backend may fuse them into one update
+  virtual BellMeasurementResult bellMeasure(IQubit *const target_qubit) {
+    gateCNOT(target_qubit);
+    auto x_result = measureX();
+    auto z_result = target_qubit->measureZ();
+    return BellMeasurementResult{x_result, z_result};
+  }
+
+  // one round of the purification of this qubit with the trash qubit, returns the outcome of the trash
+  virtual EigenvalueResult purify(IQubit *const trash_qubit, PurificationBasis basis) {
+    if (basis == PurificationBasis::X) {
+      gateCNOT(trash_qubit);
+      return trash_qubit->measureZ();
+    }
+    if (basis == PurificationBasis::Y) {
+      trash_qubit->gateSdg();
+      gateSdg();
+      trash_qubit->gateCNOT(this);
+      gateS();
+      return trash_qubit->measureX();
+    }
+    trash_qubit->gateCNOT(this);
+    return trash_qubit->measureX();
+  }
 };
 
 }  // namespace quisp::backends::abstract
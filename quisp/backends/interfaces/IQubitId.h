@@ -1,5 +1,6 @@
 #pragma once
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 
 namespace quisp::backends::abstract {
@@ -26,6 +27,27 @@ class IQubitId {
     bool operator()(const IQubitId* id1, const IQubitId* id2) const { return id1->compare(*id2); }
   };
 
+  /**
+   * a 64 bit value that identifies the qubit, computed once by pack().
+   * the backends use it as the map key by value, so a lookup neither calls hash() and compare() nor follows the id pointer.
+   */
+  std::uint64_t getPackedKey() const {
+    if (!has_packed_key) {
+      packed_key = pack();
+      has_packed_key = true;
+    }
+    return packed_key;
+  }
+
+  static constexpr std::size_t no_backend_index = static_cast<std::size_t>(-1);
+
+  /**
+   * a dense index the backend assigned to this id when the qubit was created.
+   * it lets the backend find the qubit without hashing, the backend must still check the id it finds there.
+   */
+  std::size_t getBackendIndex() const { return backend_index; }
+  void setBackendIndex(std::size_t index) const { backend_index = index; }
+
  protected:
   /**
    * a hash function for unordered_map. this function should return a unique value for each qubit id.
@@ -36,5 +58,15 @@ class IQubitId {
    * a comparison function for unordered_map.
    */
   virtual bool compare(const IQubitId& id) const = 0;
+
+  /**
+   * the packed key, two ids must give the same key if and only if compare() returns true.
+   */
+  virtual std::uint64_t pack() const = 0;
+
+ private:
+  mutable std::uint64_t packed_key = 0;
+  mutable bool has_packed_key = false;
+  mutable std::size_t backend_index = no_backend_index;
 };
 }  // namespace quisp::backends::abstract
@@ -0,0 +1,136 @@
+#include "IRandomNumberGenerator.h"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+
+namespace quisp::backends::abstract {
+
+namespace {
+// the 128 layers of the ziggurat of the standard normal, as ZIGNOR by J. A. Doornik (2005)
+constexpr int num_layers = 128;
+constexpr double tail_start = 3.442619855899;
+constexpr double layer_area = 9.91256303526217e-3;
+
+struct ZigguratTables {
+  // the right edges of the layers from the bottom, x[num_layers] = 0 at the top
+  double x[num_layers + 1];
+  // x[i + 1] / x[i], below which the sample lies in the rectangle under the curve
+  double ratio[num_layers];
+
+  ZigguratTables() {
+    double f = std::exp(-0.5 * tail_start * tail_start);
+    x[0] = layer_area / f;
+    x[1] = tail_start;
+    x[num_layers] = 0;
+    for (int i = 2; i < num_layers; i++) {
+      x[i] = std::sqrt(-2 * std::log(layer_area / x[i - 1] + f));
+      f = std::exp(-0.5 * x[i] * x[i]);
+    }
+    for (int i = 0; i < num_layers; i++) ratio[i] = x[i + 1] / x[i];
+  }
+};
+
+const ZigguratTables &zigguratTables() {
+  static const ZigguratTables tables;
+  return tables;
+}
+
+// std::binomial_distribution takes the uniforms of the generator through this
+struct UniformBitGenerator {
+  using result_type = std::uint32_t;
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return 0xffffffff; }
+  result_type operator()() { return static_cast<result_type>(rng->doubleRandom() * 4294967296.0); }
+  IRandomNumberGenerator *rng;
+};
+
+long long geometricFromUniform(double rand, double log_no_success) {
+  // 1 - rand is in (0, 1]
+  double failures = std::floor(std::log1p(-rand) / log_no_success);
+  return failures < static_cast<double>(std::numeric_limits<long long>::max()) ? static_cast<long long>(failures) : std::numeric_limits<long long>::max();
+}
+}  // namespace
+
+double IRandomNumberGenerator::standardNormal(double rand) {
+  auto &tables = zigguratTables();
+  while (true) {
+    // the layer from the top bits of the uniform and the position in the layer from the rest
+    double scaled = rand * num_layers;
+    int layer = std::min(static_cast<int>(scaled), num_layers - 1);
+    double u = 2 * (scaled - layer) - 1;
+    if (std::fabs(u) < tables.ratio[layer]) return u * tables.x[layer];
+    if (layer == 0) {
+      // the tail beyond tail_start by Marsaglia's method
+      double x, y;
+      do {
+        x = std::log1p(-doubleRandom()) / tail_start;
+        y = std::log1p(-doubleRandom());
+      } while (-2 * y < x * x);
+      return u < 0 ? x - tail_start : tail_start - x;
+    }
+    double x = u * tables.x[layer];
+    double f0 = std::exp(-0.5 * (tables.x[layer] * tables.x[layer] - x * x));
+    double f1 = std::exp(-0.5 * (tables.x[layer + 1] * tables.x[layer + 1] - x * x));
+    if (f1 + doubleRandom() * (f0 - f1) < 1.0) return x;
+    rand = doubleRandom();
+  }
+}
+
+double IRandomNumberGenerator::normalRandom(double mean, double stddev) { return mean + stddev * standardNormal(doubleRandom()); }
+
+void IRandomNumberGenerator::normalRandoms(double *values, std::size_t n, double mean, double stddev) {
+  // the first uniforms of the samples in a batch, the rejected ones draw the rest one at a time
+  doubleRandoms(values, n);
+  for (std::size_t i = 0; i < n; i++) values[i] = mean + stddev * standardNormal(values[i]);
+}
+
+int IRandomNumberGenerator::binomialRandom(int n, double p) {
+  if (n <= 0 || p <= 0) return 0;
+  if (p >= 1) return n;
+  if (p > 0.5) return n - binomialRandom(n, 1 - p);
+  if (n * p >= 30) {
+    UniformBitGenerator gen{this};
+    return std::binomial_distribution<int>(n, p)(gen);
+  }
+  // the successes are the geometric gaps that fit in the n trials
+  double log_no_success = std::log1p(-p);
+  int successes = 0;
+  long long trial = geometricFromUniform(doubleRandom(), log_no_success);
+  while (trial < n) {
+    successes++;
+    long long gap = geometricFromUniform(doubleRandom(), log_no_success);
+    if (gap >= n - trial - 1) break;
+    trial += 1 + gap;
+  }
+  return successes;
+}
+
+void IRandomNumberGenerator::binomialRandoms(int *values, std::size_t count, int n, double p) {
+  for (std::size_t i = 0; i < count; i++) values[i] = binomialRandom(n, p);
+}
+
+long long IRandomNumberGenerator::geometricRandom(double p) {
+  if (p >= 1) return 0;
+  if (p <= 0) return std::numeric_limits<long long>::max();
+  return geometricFromUniform(doubleRandom(), std::log1p(-p));
+}
+
+void IRandomNumberGenerator::geometricRandoms(long long *values, std::size_t n, double p) {
+  if (p >= 1 || p <= 0) {
+    std::fill(values, values + n, p >= 1 ? 0 : std::numeric_limits<long long>::max());
+    return;
+  }
+  // the uniforms in a buffer first, then their gaps with the logarithm of the failure taken once
+  double log_no_success = std::log1p(-p);
+  double rands[256];
+  for (std::size_t done = 0; done < n;) {
+    auto batch = std::min<std::size_t>(n - done, 256);
+    doubleRandoms(rands, batch);
+    for (std::size_t i = 0; i < batch; i++) values[done + i] = geometricFromUniform(rands[i], log_no_success);
+    done += batch;
+  }
+}
+
+}  // namespace quisp::backends::abstract
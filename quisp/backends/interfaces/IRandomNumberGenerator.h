@@ -1,4 +1,6 @@
 #pragma once
+#include <algorithm>
+#include <cstddef>
 
 namespace quisp::backends::abstract {
 class IRandomNumberGenerator {
@@ -6,5 +8,46 @@ class IRandomNumberGenerator {
   IRandomNumberGenerator() = default;
   virtual ~IRandomNumberGenerator() {}
   virtual double doubleRandom() = 0;
+  // fills values with n uniform random numbers, for samplers that consume them in batches
+  virtual void doubleRandoms(double *values, std::size_t n) {
+    for (std::size_t i = 0; i < n; i++) {
+      values[i] = doubleRandom();
+    }
+  }
+
+  // the samplers below take their uniforms from doubleRandom() and doubleRandoms() only, so they follow the stream of the generator.
+  // the bulk ones sample the same distribution as the single ones, but not from the same numbers.
+
+  /// @brief Normal(mean, stddev) by the ziggurat method of Marsaglia and Tsang, mostly one uniform per sample.
+  double normalRandom(double mean, double stddev);
+  void normalRandoms(double *values, std::size_t n, double mean, double stddev);
+
+  /// @brief the number of successes of n trials of probability p, in O(n min(p, 1 - p)) uniforms up to a mean of 30.
+  int binomialRandom(int n, double p);
+  void binomialRandoms(int *values, std::size_t count, int n, double p);
+
+  /// @brief the number of failures before the first success of probability p, one uniform per sample.
+  long long geometricRandom(double p);
+  void geometricRandoms(long long *values, std::size_t n, double p);
+
+  /// @brief the label of a util_functions::CumulativeDistribution, or anything with its sample() methods.
+  template <typename Distribution>
+  std::size_t categoricalRandom(const Distribution &distribution) {
+    return distribution.sample(doubleRandom());
+  }
+  template <typename Distribution>
+  void categoricalRandoms(const Distribution &distribution, std::size_t *labels, std::size_t n) {
+    double rands[256];
+    for (std::size_t done = 0; done < n;) {
+      auto count = std::min<std::size_t>(n - done, 256);
+      doubleRandoms(rands, count);
+      distribution.sample(rands, labels + done, count);
+      done += count;
+    }
+  }
+
+ private:
+  // the standard normal of the ziggurat, from the first uniform of the sample
+  double standardNormal(double rand);
 };
 }  // namespace quisp::backends::abstract
@@ -0,0 +1,108 @@
+#include "IRandomNumberGenerator.h"
+
+#include <gtest/gtest.h>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+#include "utils/UtilFunctions.h"
+
+namespace {
+using quisp::backends::abstract::IRandomNumberGenerator;
+
+class MersenneRNG : public IRandomNumberGenerator {
+ public:
+  double doubleRandom() override {
+    num_draws++;
+    return std::uniform_real_distribution<double>(0, 1)(engine);
+  }
+  std::mt19937_64 engine{42};
+  long num_draws = 0;
+};
+
+template <typename T>
+std::pair<double, double> meanAndVariance(const std::vector<T> &values) {
+  double sum = 0, sum_squares = 0;
+  for (auto v : values) {
+    sum += v;
+    sum_squares += static_cast<double>(v) * v;
+  }
+  double mean = sum / values.size();
+  return {mean, sum_squares / values.size() - mean * mean};
+}
+
+TEST(IRandomNumberGeneratorTest, Normal) {
+  MersenneRNG rng;
+  std::vector<double> values(200000);
+  rng.normalRandoms(values.data(), values.size(), 1, 2);
+  auto [mean, variance] = meanAndVariance(values);
+  EXPECT_NEAR(mean, 1, 0.02);
+  EXPECT_NEAR(variance, 4, 0.05);
+  // the tail beyond the base layer of the ziggurat and the symmetry
+  long beyond = 0, below_mean = 0;
+  for (auto v : values) {
+    beyond += std::fabs(v - 1) > 2 * 3.5;
+    below_mean += v < 1;
+  }
+  EXPECT_NEAR(beyond / (double)values.size(), 4.65e-4, 1.5e-4);
+  EXPECT_NEAR(below_mean / (double)values.size(), 0.5, 0.005);
+  // mostly one uniform per sample
+  EXPECT_LT(rng.num_draws, values.size() * 1.05);
+
+  for (int i = 0; i < 1000; i++) EXPECT_EQ(rng.normalRandom(3, 0), 3);
+}
+
+TEST(IRandomNumberGeneratorTest, Binomial) {
+  MersenneRNG rng;
+  EXPECT_EQ(rng.binomialRandom(0, 0.5), 0);
+  EXPECT_EQ(rng.binomialRandom(10, 0), 0);
+  EXPECT_EQ(rng.binomialRandom(10, 1), 10);
+  EXPECT_EQ(rng.num_draws, 0);
+  EXPECT_EQ(rng.binomialRandom(1000000, 1e-300), 0);
+
+  // the gaps, the complement and the large mean
+  for (auto [n, p] : std::vector<std::pair<int, double>>{{50, 0.1}, {20, 0.9}, {1000, 0.3}}) {
+    std::vector<int> values(50000);
+    rng.binomialRandoms(values.data(), values.size(), n, p);
+    auto [mean, variance] = meanAndVariance(values);
+    EXPECT_NEAR(mean, n * p, 0.02 * n * p) << n << " " << p;
+    EXPECT_NEAR(variance, n * p * (1 - p), 0.05 * n * p * (1 - p)) << n << " " << p;
+    for (auto v : values) {
+      ASSERT_GE(v, 0);
+      ASSERT_LE(v, n);
+    }
+  }
+}
+
+TEST(IRandomNumberGeneratorTest, Geometric) {
+  MersenneRNG rng;
+  EXPECT_EQ(rng.geometricRandom(1), 0);
+  EXPECT_EQ(rng.geometricRandom(0), std::numeric_limits<long long>::max());
+  EXPECT_EQ(rng.num_draws, 0);
+
+  for (double p : {0.01, 0.5, 0.9}) {
+    std::vector<long long> values(100000);
+    rng.geometricRandoms(values.data(), values.size(), p);
+    auto [mean, variance] = meanAndVariance(values);
+    EXPECT_NEAR(mean, (1 - p) / p, 0.02 * (1 - p) / p + 0.002) << p;
+    EXPECT_NEAR(variance, (1 - p) / (p * p), 0.05 * (1 - p) / (p * p) + 0.002) << p;
+  }
+}
+
+TEST(IRandomNumberGeneratorTest, Categorical) {
+  MersenneRNG rng;
+  quisp::util_functions::CumulativeDistribution<4> distribution({0.1, 0.2, 0, 0.7});
+  std::vector<std::size_t> labels(100000);
+  rng.categoricalRandoms(distribution, labels.data(), labels.size());
+  EXPECT_EQ(rng.num_draws, labels.size());
+  std::array<long, 4> counts{};
+  for (auto label : labels) counts[label]++;
+  EXPECT_NEAR(counts[0] / 1e5, 0.1, 0.005);
+  EXPECT_NEAR(counts[1] / 1e5, 0.2, 0.005);
+  EXPECT_EQ(counts[2], 0);
+  EXPECT_NEAR(counts[3] / 1e5, 0.7, 0.005);
+  EXPECT_LT(rng.categoricalRandom(distribution), 4);
+}
+
+}  // namespace
@@ -0,0 +1,18 @@
+#include <benchmark/benchmark.h>
+#include <omnetpp.h>
+#include <omnetpp/cownedobject.h>
+#include <omnetpp/csimulation.h>
+#include "test_utils/TestUtils.h"
+
+int main(int argc, char **argv) {
+  // same runtime setup as unit_test_main.cc; see the comments there.
+  omnetpp::cStaticFlag _flag;
+  omnetpp::CodeFragments::executeAll(CodeFragments::STARTUP);
+  auto *env = quisp_test::createStaticEnv();
+  omnetpp::cSimulation::setStaticEnvir(env);
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+  ::benchmark::RunSpecifiedBenchmarks();
+  ::benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,78 @@
+#include "FreeSpaceChannel.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace omnetpp;
+
+namespace quisp::channels {
+
+Define_Channel(FreeSpaceChannel);
+
+FreeSpaceChannel::FreeSpaceChannel() {}
+
+void FreeSpaceChannel::initialize() {
+  QuantumChannel::initialize();
+  distance_profile = std::make_unique<OrbitalDataParser>(par("distance_csv").stdstringValue());
+  slot_width = par("slot_width").doubleValue();
+  speed_of_light = par("speed_of_light_in_vacuum").doubleValue();
+  if (slot_width <= 0) {
+    throw cRuntimeError("free space channel has invalid slot width");
+  }
+  double max_visible_distance = par("max_visible_distance").doubleValue();
+  if (max_visible_distance < 0) throw cRuntimeError("free space channel has negative max_visible_distance");
+  if (max_visible_distance > 0) computeVisibilityWindows(max_visible_distance);
+}
+
+void FreeSpaceChannel::computeVisibilityWindows(double max_visible_distance) {
+  visibility_windows = distance_profile->findIntervalsAtMost(max_visible_distance);
+  always_visible = false;
+}
+
+simtime_t FreeSpaceChannel::getNextVisibleTime(simtime_t t) const {
+  if (always_visible) return t;
+  auto window = std::lower_bound(visibility_windows.begin(), visibility_windows.end(), t.dbl(), [](const auto &window, double t) { return window.second < t; });
+  if (window == visibility_windows.end()) return SimTime::getMaxTime();
+  if (window->first <= t.dbl()) return t;
+  return window->first;
+}
+
+simtime_t FreeSpaceChannel::getNextVisibleTime(const std::vector<const FreeSpaceChannel *> &channels, simtime_t t) {
+  // each window start of a channel may fall out of the window of another one, so it goes on until they all agree
+  for (bool moved = true; moved && t < SimTime::getMaxTime();) {
+    moved = false;
+    for (auto *channel : channels) {
+      auto next = channel->getNextVisibleTime(t);
+      if (next == t) continue;
+      t = next;
+      moved = true;
+    }
+  }
+  return t;
+}
+
+const FreeSpaceChannel::Slot &FreeSpaceChannel::slotAt(double t) const {
+  const double first = distance_profile->getLowestDatapoint();
+  const double last = distance_profile->getHighestDatapoint();
+  // the times out of the data share the first or the last slot
+  t = std::clamp(t, first, last);
+  auto index = static_cast<std::size_t>(std::floor((t - first) / slot_width));
+  if (index >= slots.size()) slots.resize(index + 1);
+
+  auto &slot = slots[index];
+  if (!slot) {
+    // evaluated at the middle of the slot, within the data
+    double distance_of_slot = distance_profile->getPropertyAtTime(std::min(first + (index + 0.5) * slot_width, last));
+    slot = Slot{computeOutcomeTable(distance_of_slot, err, outcome_cache_file.get()), distance_of_slot / speed_of_light};
+  }
+  return *slot;
+}
+
+std::array<double, 5> FreeSpaceChannel::getPhotonOutcomeProbabilities() const { return slotAt(simTime().dbl()).table.probabilities; }
+
+cChannel::Result FreeSpaceChannel::processMessage(cMessage *msg, const SendOptions &options, simtime_t t) {
+  outcome_table = slotAt(t.dbl()).table;
+  return QuantumChannel::processMessage(msg, options, t);
+}
+
+}  // namespace quisp::channels
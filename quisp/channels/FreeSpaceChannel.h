@@ -0,0 +1,58 @@
+#pragma once
+
+#include <omnetpp.h>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "QuantumChannel.h"
+#include "utils/OrbitalDataParser.h"
+
+namespace quisp::channels {
+
+/** \class FreeSpaceChannel FreeSpaceChannel.h
+ *
+ *  \brief QuantumChannel whose distance changes over time, e.g. to a satellite.
+ *
+ *  The distance is read from distance_csv (time in s, distance in km). The simulation time is cut into
+ *  slots of slot_width, and the photon outcomes and the delay of a slot are computed at its first photon
+ *  and reused by the rest of the photons of the slot.
+ *
+ *  With max_visible_distance, the satellite is below the horizon while it's farther than that. The visibility windows
+ *  are computed from the data at initialization, and the BSA and EPPS controllers suspend the link outside of them.
+ */
+class FreeSpaceChannel : public QuantumChannel {
+ public:
+  FreeSpaceChannel();
+  // the outcome probabilities of the slot of the current simulation time
+  std::array<double, 5> getPhotonOutcomeProbabilities() const override;
+  // t if the satellite is in view at t, otherwise the start of the next visibility window. SimTime::getMaxTime() if it doesn't come back
+  omnetpp::simtime_t getNextVisibleTime(omnetpp::simtime_t t) const;
+  // the first time from t when all the channels are in view, e.g. the two links of a BSA
+  static omnetpp::simtime_t getNextVisibleTime(const std::vector<const FreeSpaceChannel *> &channels, omnetpp::simtime_t t);
+
+ protected:
+  struct Slot {
+    PhotonOutcomeTable table;
+    omnetpp::simtime_t delay;
+  };
+
+  void initialize() override;
+  omnetpp::cChannel::Result processMessage(omnetpp::cMessage *msg, const omnetpp::SendOptions &options, omnetpp::simtime_t t) override;
+  omnetpp::simtime_t getPhotonDelay(omnetpp::simtime_t t) const override { return slotAt(t.dbl()).delay; }
+  // the slot of time t in s, computed at the first query
+  const Slot &slotAt(double t) const;
+  // the windows of distance_profile within max_visible_distance, 0 for always visible
+  void computeVisibilityWindows(double max_visible_distance);
+
+  // the data points are shared by the channels with the same file
+  mutable std::unique_ptr<OrbitalDataParser> distance_profile;
+  double slot_width = 1;  // in s
+  double speed_of_light = 299792.458;  // in km/s
+  mutable std::vector<std::optional<Slot>> slots;
+  // the [begin, end] times in s the satellite is in view, in order. empty with always_visible
+  std::vector<std::pair<double, double>> visibility_windows;
+  bool always_visible = true;
+};
+
+}  // namespace quisp::channels
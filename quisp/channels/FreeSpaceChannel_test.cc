@@ -0,0 +1,99 @@
+#include "FreeSpaceChannel.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include "PhotonicQubit_m.h"
+#include "test_utils/TestUtils.h"
+
+namespace {
+using quisp::channels::FreeSpaceChannel;
+using quisp::messages::PhotonicQubit;
+
+class FreeSpaceChannelTestTarget : public FreeSpaceChannel {
+ public:
+  using FreeSpaceChannel::computeVisibilityWindows;
+  using FreeSpaceChannel::processMessage;
+  using FreeSpaceChannel::slotAt;
+  using FreeSpaceChannel::slots;
+  FreeSpaceChannelTestTarget(const std::string &csv, double slot_width) {
+    err.x_error_rate = 0;
+    err.y_error_rate = 0;
+    err.z_error_rate = 0;
+    err.loss_rate = 0.001;
+    err.error_rate = 0.001;
+    distance_profile = std::make_unique<OrbitalDataParser>(csv);
+    this->slot_width = slot_width;
+  }
+};
+
+class FreeSpaceChannelTest : public ::testing::Test {
+ protected:
+  void SetUp() {
+    std::ofstream csv("channels/free_space_test.csv");
+    csv << "0,1000\n";
+    csv << "10,2000\n";
+    csv.close();
+  }
+  void TearDown() { std::remove("channels/free_space_test.csv"); }
+};
+
+TEST_F(FreeSpaceChannelTest, SlotIsComputedOnce) {
+  FreeSpaceChannelTestTarget channel{"channels/free_space_test.csv", 1};
+  auto &slot = channel.slotAt(0.2);
+  EXPECT_EQ(&slot, &channel.slotAt(0.9));
+  EXPECT_NE(&slot, &channel.slotAt(1.1));
+  // the distance of the slot is at its middle, 1050 km
+  EXPECT_NEAR(slot.delay.dbl(), 1050 / 299792.458, 1e-9);
+}
+
+TEST_F(FreeSpaceChannelTest, FartherSlotLosesMore) {
+  FreeSpaceChannelTestTarget channel{"channels/free_space_test.csv", 1};
+  auto near = channel.slotAt(0).table.probabilities;
+  auto far = channel.slotAt(9.5).table.probabilities;
+  EXPECT_LT(far[0], near[0]);
+  EXPECT_GT(far[4], near[4]);
+  // the times after the data stay in the last slot
+  EXPECT_EQ(&channel.slotAt(9.5), &channel.slotAt(100));
+}
+
+TEST_F(FreeSpaceChannelTest, DelayOfTheSlot) {
+  quisp_test::prepareSimulation();
+  FreeSpaceChannelTestTarget channel{"channels/free_space_test.csv", 2};
+  PhotonicQubit photon;
+  photon.setLost(true);
+  omnetpp::SendOptions options;
+  auto result = channel.processMessage(&photon, options, 5);
+  EXPECT_EQ(result.delay, channel.slotAt(5).delay);
+  EXPECT_NEAR(result.delay.dbl(), 1500 / 299792.458, 1e-9);
+}
+
+TEST_F(FreeSpaceChannelTest, VisibilityWindows) {
+  std::ofstream csv("channels/free_space_pass_test.csv");
+  // in view below 1500 km: until 5s and from 25s
+  csv << "0,1000\n";
+  csv << "10,2000\n";
+  csv << "20,2000\n";
+  csv << "30,1000\n";
+  csv.close();
+  FreeSpaceChannelTestTarget channel{"channels/free_space_pass_test.csv", 1};
+  std::remove("channels/free_space_pass_test.csv");
+  EXPECT_EQ(channel.getNextVisibleTime(3), 3);
+  channel.computeVisibilityWindows(1500);
+  EXPECT_EQ(channel.getNextVisibleTime(3), 3);
+  EXPECT_EQ(channel.getNextVisibleTime(6), 25);
+  // the last data point holds after the data
+  EXPECT_EQ(channel.getNextVisibleTime(100), 100);
+
+  FreeSpaceChannelTestTarget never_back{"channels/free_space_test.csv", 1};
+  never_back.computeVisibilityWindows(1500);
+  EXPECT_EQ(never_back.getNextVisibleTime(6), omnetpp::SimTime::getMaxTime());
+
+  // a link of two channels is in view when both are
+  FreeSpaceChannelTestTarget closer{"channels/free_space_test.csv", 1};
+  closer.computeVisibilityWindows(1800);
+  EXPECT_EQ(FreeSpaceChannel::getNextVisibleTime({&channel, &closer}, 2), 2);
+  EXPECT_EQ(FreeSpaceChannel::getNextVisibleTime({&channel, &closer}, 6), omnetpp::SimTime::getMaxTime());
+  EXPECT_EQ(FreeSpaceChannel::getNextVisibleTime({&channel, &channel}, 6), 25);
+}
+
+}  // namespace
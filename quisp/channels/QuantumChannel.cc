@@ -2,7 +2,11 @@
  *
  *  \brief QuantumChannel
  */
-#include <omnetpp.h>
+#include "QuantumChannel.h"
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <set>
 #include <stdexcept>
 #include <unsupported/Eigen/MatrixFunctions>
 #include "PhotonicQubit_m.h"
@@ -14,38 +18,34 @@ using namespace quisp::messages;
 
 namespace quisp::channels {
 
-/* The sum of Z, X and Y error rate equates to error_rate. Value could potentially between 0 ~ 1. */
-struct channel_error_model {
-  double error_rate;  // total error rate
-  double z_error_rate;
-  double x_error_rate;
-  double y_error_rate;
-  double loss_rate;
-};
+Define_Channel(QuantumChannel);
 
-/** \class QuantumChannel QuantumChannel.cc
- *
- *  \brief QuantumChannel
- */
-class QuantumChannel : public cDatarateChannel {
- public:
-  QuantumChannel();
-  // member variables
-  channel_error_model err;
-  double distance = 0;  // in km
-
- protected:
-  virtual void initialize() override;
-  virtual cChannel::Result processMessage(cMessage *msg, const SendOptions &options, simtime_t t) override;
-
- private:
-  void validateParameters();
-  MatrixXd transition_to_the_distance;
+namespace {
+// {distance, x, y, z, loss}
+using TransitionKey = std::array<double, 5>;
+
+// a table in the outcome cache file; the ceils follow from the probabilities
+struct OutcomeRecord {
+  TransitionKey key;
+  std::array<double, 5> probabilities;
+};
+constexpr const char *outcome_record_tag = "QOUTCOM1";
+
+// the outcome tables of the process, shared by the simulations running on its threads
+struct OutcomeCache {
+  std::mutex mutex;
+  std::map<TransitionKey, std::array<double, 5>> tables;
+  // the outcome_cache_files read into the tables
+  std::set<std::string> loaded_paths;
 };
 
-Define_Channel(QuantumChannel);
+OutcomeCache &outcomeCache() {
+  static OutcomeCache cache;
+  return cache;
+}
+}  // namespace
 
-QuantumChannel::QuantumChannel() : transition_to_the_distance(5, 5) {}
+QuantumChannel::QuantumChannel() {}
 
 void QuantumChannel::initialize() {
   cDatarateChannel::initialize();
@@ -55,8 +55,65 @@ void QuantumChannel::initialize() {
   err.y_error_rate = par("channel_y_error_rate");
   err.z_error_rate = par("channel_z_error_rate");
   err.error_rate = err.x_error_rate + err.y_error_rate + err.z_error_rate + err.loss_rate;
+  drop_lost_photons = par("drop_lost_photons");
   validateParameters();
+  std::string cache_path = par("outcome_cache_file").stdstringValue();
+  if (!cache_path.empty()) loadOutcomeCacheFile(cache_path);
+  updateTransitionMatrix();
+}
+
+void QuantumChannel::finish() {
+  if (drop_lost_photons) recordScalar("dropped_lost_photons", num_dropped_photons);
+}
+
+void QuantumChannel::updateTransitionMatrix() { outcome_table = computeOutcomeTable(distance, err, outcome_cache_file.get()); }
+
+void QuantumChannel::loadOutcomeCacheFile(const std::string &path) {
+  outcome_cache_file = std::make_unique<utils::RecordFile>(path, outcome_record_tag, sizeof(OutcomeRecord));
+  // the channels of a network share the file, so it's read once per process
+  auto &cache = outcomeCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  if (!cache.loaded_paths.insert(path).second) return;
+  try {
+    outcome_cache_file->read([&](const std::byte *bytes) {
+      OutcomeRecord record;
+      std::memcpy(&record, bytes, sizeof(OutcomeRecord));
+      cache.tables.emplace(record.key, record.probabilities);
+    });
+  } catch (const std::runtime_error &e) {
+    throw cRuntimeError("quantum channel can't use outcome_cache_file: %s", e.what());
+  }
+}
 
+QuantumChannel::PhotonOutcomeTable QuantumChannel::computeOutcomeTable(double distance, const channel_error_model &err, const utils::RecordFile *cache_file) {
+  // the channels with the same distance and error rates share the exponentiation of the transition matrix
+  auto &cache = outcomeCache();
+  TransitionKey key{distance, err.x_error_rate, err.y_error_rate, err.z_error_rate, err.loss_rate};
+  PhotonOutcomeTable table;
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  auto it = cache.tables.find(key);
+  if (it != cache.tables.end()) {
+    table.probabilities = it->second;
+  } else {
+    // only the first row is used: a photon enters without error, and a lost photon stays lost
+    MatrixXd transition_to_the_distance = computeTransitionMatrix(distance, err);
+    for (int i = 0; i < 5; i++) table.probabilities[i] = transition_to_the_distance(0, i);
+    cache.tables.emplace(key, table.probabilities);
+    if (cache_file != nullptr) {
+      OutcomeRecord record{key, table.probabilities};
+      try {
+        cache_file->append(&record);
+      } catch (const std::runtime_error &e) {
+        throw cRuntimeError("quantum channel can't use outcome_cache_file: %s", e.what());
+      }
+    }
+  }
+  table.ceils[0] = table.probabilities[0];
+  for (int i = 1; i < 4; i++) table.ceils[i] = table.ceils[i - 1] + table.probabilities[i];
+  return table;
+}
+
+MatrixXd QuantumChannel::computeTransitionMatrix(double distance, const channel_error_model &err) {
   MatrixXd transition_matrix(5, 5);
   // clang-format off
   transition_matrix << 1 - err.error_rate,  err.x_error_rate,   err.z_error_rate,   err.y_error_rate,   err.loss_rate,
@@ -67,54 +124,103 @@ void QuantumChannel::initialize() {
   // clang-format on
 
   MatrixPower<MatrixXd> transition_matrix_to_the_power(transition_matrix);
-  transition_to_the_distance = transition_matrix_to_the_power(distance);
+  return transition_matrix_to_the_power(distance);
+}
+
+std::array<double, 5> QuantumChannel::getPhotonOutcomeProbabilities() const { return outcome_table.probabilities; }
+
+QuantumChannel::PhotonOutcome QuantumChannel::samplePhotonOutcome(double rand) const {
+  auto &ceils = outcome_table.ceils;
+  if (rand < ceils[0]) return PhotonOutcome::NoError;
+  if (rand < ceils[1]) return PhotonOutcome::XError;
+  if (rand < ceils[2]) return PhotonOutcome::ZError;
+  if (rand < ceils[3]) return PhotonOutcome::YError;
+  return PhotonOutcome::Lost;
 }
 
 cChannel::Result QuantumChannel::processMessage(cMessage *msg, const SendOptions &options, simtime_t t) {
+  if (auto *train = dynamic_cast<PhotonicQubitTrain *>(msg)) {
+    processPhotonTrain(train);
+    return {false, getPhotonDelay(t), 0};
+  }
   PhotonicQubit *q = dynamic_cast<PhotonicQubit *>(msg);
   if (q == nullptr) {
     throw new cRuntimeError("something other than photonic qubit is sent through quantum channel");
   }
 
-  MatrixXd probability_vector(1, 5);  // I, X, Z, Y, Photon Lost
-  if (q->isLost()) {
-    probability_vector << 0, 0, 0, 0, 1;  // Photon already lost due to the coupling lost.
-  } else {
-    probability_vector << 1, 0, 0, 0, 0;  // No error
+  double rand = dblrand();
+  // Photon already lost due to the coupling lost stays lost.
+  auto outcome = q->isLost() ? PhotonOutcome::Lost : samplePhotonOutcome(rand);
+  switch (outcome) {
+    case PhotonOutcome::NoError:
+      // Qubit will end up with no error
+      break;
+    case PhotonOutcome::XError:
+      q->getQubitRefForUpdate()->noiselessX();
+      q->setXError(true);
+      break;
+    case PhotonOutcome::ZError:
+      q->getQubitRefForUpdate()->noiselessZ();
+      q->setZError(true);
+      break;
+    case PhotonOutcome::YError:
+      q->getQubitRefForUpdate()->noiselessX();
+      q->getQubitRefForUpdate()->noiselessZ();
+      q->setXError(true);
+      q->setZError(true);
+      break;
+    case PhotonOutcome::Lost:
+      q->setLost(true);
+      break;
   }
-  MatrixXd output_probability_vector(1, 5);
-  output_probability_vector = probability_vector * transition_to_the_distance;
 
-  // |-- no error --|-- x_error --|-- z_error --|-- y_error --|-- lost --|
-  double no_error_ceil = output_probability_vector(0, 0);
-  double x_error_ceil = no_error_ceil + output_probability_vector(0, 1);
-  double z_error_ceil = x_error_ceil + output_probability_vector(0, 2);
-  double y_error_ceil = z_error_ceil + output_probability_vector(0, 3);
-  double lost_ceil = y_error_ceil + output_probability_vector(0, 4);
-
-  double rand = dblrand();
-  if (rand < no_error_ceil) {
-    // Qubit will end up with no error
-  } else if (rand < x_error_ceil) {
-    // X error
-    q->getQubitRefForUpdate()->noiselessX();
-    q->setXError(true);
-  } else if (rand < z_error_ceil) {
-    // Z error
-    q->getQubitRefForUpdate()->noiselessZ();
-    q->setZError(true);
-  } else if (rand < y_error_ceil) {
-    // Y error
-    q->getQubitRefForUpdate()->noiselessX();
-    q->getQubitRefForUpdate()->noiselessZ();
-    q->setXError(true);
-    q->setZError(true);
-  } else {
-    // photon is lost
-    q->setLost(true);
+  if (drop_lost_photons) {
+    // the first and the last photons drive the round of the BSA, so they always arrive
+    if (q->isLost() && !q->isFirst() && !q->isLast()) {
+      q->getQubitRefForUpdate()->relaseBackToPool();
+      dropped_arrival_times.push_back(t + getPhotonDelay(t));
+      num_dropped_photons++;
+      return {true, getPhotonDelay(t), 0};
+    }
+    for (auto &arrival_time : dropped_arrival_times) q->appendDroppedArrivalTime(arrival_time);
+    dropped_arrival_times.clear();
   }
+  return {false, getPhotonDelay(t), 0};
+}
 
-  return {false, getDelay(), 0};
+void QuantumChannel::processPhotonTrain(PhotonicQubitTrain *train) {
+  // the photons lost at the emission don't take a random number, the others take theirs in a batch
+  size_t num_emitted = 0;
+  for (size_t i = 0; i < train->getNumPhotons(); i++) num_emitted += !train->getPhoton(i).is_lost;
+  photon_rands.resize(num_emitted);
+  channel_rng.doubleRandoms(photon_rands.data(), num_emitted);
+  size_t next_rand = 0;
+  for (size_t i = 0; i < train->getNumPhotons(); i++) {
+    auto photon = train->getPhoton(i);
+    if (photon.is_lost) continue;
+    switch (samplePhotonOutcome(photon_rands[next_rand++])) {
+      case PhotonOutcome::NoError:
+        continue;
+      case PhotonOutcome::XError:
+        photon.qubit_ref->noiselessX();
+        photon.has_x_error = true;
+        break;
+      case PhotonOutcome::ZError:
+        photon.qubit_ref->noiselessZ();
+        photon.has_z_error = true;
+        break;
+      case PhotonOutcome::YError:
+        photon.qubit_ref->noiselessX();
+        photon.qubit_ref->noiselessZ();
+        photon.has_x_error = true;
+        photon.has_z_error = true;
+        break;
+      case PhotonOutcome::Lost:
+        photon.is_lost = true;
+        break;
+    }
+    train->setPhoton(i, photon);
+  }
 }
 
 void QuantumChannel::validateParameters() {
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <omnetpp.h>
+#include <Eigen/Eigen>
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "PhotonicQubit_m.h"
+#include "modules/Backend/RNG.h"
+#include "utils/RecordFile.h"
+
+namespace quisp::channels {
+
+/* The sum of Z, X and Y error rate equates to error_rate. Value could potentially between 0 ~ 1. */
+struct channel_error_model {
+  double error_rate;  // total error rate
+  double z_error_rate;
+  double x_error_rate;
+  double y_error_rate;
+  double loss_rate;
+};
+
+/** \class QuantumChannel QuantumChannel.h
+ *
+ *  \brief QuantumChannel
+ */
+class QuantumChannel : public omnetpp::cDatarateChannel {
+ public:
+  QuantumChannel();
+  // member variables
+  channel_error_model err;
+  double distance = 0;  // in km
+
+  // the probabilities of {no error, X, Z, Y, lost} of a photon over the whole channel, without sending it
+  virtual std::array<double, 5> getPhotonOutcomeProbabilities() const;
+
+ protected:
+  // the outcomes of a photon entering the channel without error; a lost photon stays lost
+  struct PhotonOutcomeTable {
+    std::array<double, 5> probabilities = {1, 0, 0, 0, 0};  // no error, X, Z, Y, lost
+    // |-- no error --|-- x_error --|-- z_error --|-- y_error --|-- lost --|
+    std::array<double, 4> ceils = {1, 1, 1, 1};
+  };
+
+  virtual void initialize() override;
+  virtual void finish() override;
+  virtual omnetpp::cChannel::Result processMessage(omnetpp::cMessage *msg, const omnetpp::SendOptions &options, omnetpp::simtime_t t) override;
+  // the propagation delay of a photon entering at t
+  virtual omnetpp::simtime_t getPhotonDelay(omnetpp::simtime_t t) const { return getDelay(); }
+  // sets the outcome probabilities from err and distance, computed once for all the channels with the same values
+  void updateTransitionMatrix();
+  // the table of err over distance km, computed once for the same values. a computed table is appended to cache_file
+  static PhotonOutcomeTable computeOutcomeTable(double distance, const channel_error_model &err, const utils::RecordFile *cache_file = nullptr);
+  // takes the tables of the former runs in path, and appends the new ones to it
+  void loadOutcomeCacheFile(const std::string &path);
+  void validateParameters();
+
+  PhotonOutcomeTable outcome_table;
+  std::unique_ptr<utils::RecordFile> outcome_cache_file;
+  bool drop_lost_photons = false;
+  // the arrival times of the photons dropped since the last delivered one
+  std::vector<omnetpp::simtime_t> dropped_arrival_times;
+  long num_dropped_photons = 0;
+  // the RNG of the channel, and the uniforms of a photon train
+  modules::backend::rng::RNG channel_rng{this};
+  std::vector<double> photon_rands;
+
+ private:
+  enum class PhotonOutcome : int { NoError = 0, XError, ZError, YError, Lost };
+  // the outcome of a photon entering without error, for rand in [0, 1)
+  PhotonOutcome samplePhotonOutcome(double rand) const;
+  // applies the loss and the errors to all the photons of the train in one pass
+  void processPhotonTrain(messages::PhotonicQubitTrain *train);
+  // the transition matrix of a photon to the power of the distance
+  static Eigen::MatrixXd computeTransitionMatrix(double distance, const channel_error_model &err);
+};
+
+}  // namespace quisp::channels
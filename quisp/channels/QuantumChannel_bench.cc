@@ -0,0 +1,82 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+
+#include "PhotonicQubit_m.h"
+#include "QuantumChannel.h"
+#include "backends/GraphState/test.h"
+#include "test_utils/TestUtils.h"
+
+namespace {
+using quisp::channels::QuantumChannel;
+using quisp::messages::PhotonicQubit;
+using quisp::messages::PhotonicQubitTrain;
+using quisp::messages::TrainPhoton;
+using namespace quisp_test::backends::graph_state;
+
+class BenchQuantumChannel : public QuantumChannel {
+ public:
+  using QuantumChannel::processMessage;
+  using QuantumChannel::updateTransitionMatrix;
+};
+
+// a photon through a 20 km channel with Pauli errors and loss.
+static void BM_QuantumChannel_ProcessMessage(benchmark::State& state) {
+  quisp_test::prepareSimulation();
+  SimTime::setScaleExp(-9);
+  GraphStateBackend backend(std::make_unique<TestRNG>(), std::make_unique<StationaryQubitConfiguration>());
+  BenchQuantumChannel channel;
+  channel.distance = 20;
+  channel.err.x_error_rate = 0.01;
+  channel.err.y_error_rate = 0.01;
+  channel.err.z_error_rate = 0.01;
+  channel.err.loss_rate = 0.04;
+  channel.err.error_rate = 0.07;
+  channel.updateTransitionMatrix();
+
+  PhotonicQubit photon;
+  photon.setQubitRef(backend.getShortLiveQubit());
+  omnetpp::SendOptions options;
+  for (auto _ : state) {
+    photon.setLost(false);
+    auto result = channel.processMessage(&photon, options, 0);
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_QuantumChannel_ProcessMessage);
+
+// a train of range(0) photons through the same channel as one message.
+static void BM_QuantumChannel_ProcessPhotonTrain(benchmark::State& state) {
+  quisp_test::prepareSimulation();
+  SimTime::setScaleExp(-9);
+  GraphStateBackend backend(std::make_unique<TestRNG>(), std::make_unique<StationaryQubitConfiguration>());
+  BenchQuantumChannel channel;
+  channel.distance = 20;
+  channel.err.x_error_rate = 0.01;
+  channel.err.y_error_rate = 0.01;
+  channel.err.z_error_rate = 0.01;
+  channel.err.loss_rate = 0.04;
+  channel.err.error_rate = 0.07;
+  channel.updateTransitionMatrix();
+
+  PhotonicQubitTrain train;
+  for (int i = 0; i < state.range(0); i++) {
+    TrainPhoton photon;
+    photon.qubit_ref = backend.getShortLiveQubit();
+    train.appendPhoton(photon);
+  }
+  omnetpp::SendOptions options;
+  for (auto _ : state) {
+    for (size_t i = 0; i < train.getNumPhotons(); i++) {
+      auto photon = train.getPhoton(i);
+      photon.is_lost = false;
+      train.setPhoton(i, photon);
+    }
+    auto result = channel.processMessage(&train, options, 0);
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_QuantumChannel_ProcessPhotonTrain)->Arg(16)->Arg(128);
+
+}  // namespace
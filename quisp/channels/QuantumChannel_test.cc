@@ -0,0 +1,136 @@
+#include "QuantumChannel.h"
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <array>
+#include <cstring>
+#include "backends/interfaces/IQubit.h"
+#include "PhotonicQubit_m.h"
+#include "test_utils/TestUtils.h"
+
+namespace {
+using quisp::channels::QuantumChannel;
+using quisp::messages::PhotonicQubit;
+using quisp::utils::RecordFile;
+// {distance, x, y, z, loss} and the outcome probabilities, as in the outcome cache file
+using OutcomeRecord = std::array<std::array<double, 5>, 2>;
+
+// a short-live qubit that counts its releases
+class PoolQubit : public quisp::backends::abstract::IQubit {
+ public:
+  void setFree() override {}
+  void relaseBackToPool() override { num_released++; }
+  int num_released = 0;
+};
+
+class QuantumChannelTestTarget : public QuantumChannel {
+ public:
+  using QuantumChannel::drop_lost_photons;
+  using QuantumChannel::loadOutcomeCacheFile;
+  using QuantumChannel::num_dropped_photons;
+  using QuantumChannel::processMessage;
+  using QuantumChannel::updateTransitionMatrix;
+  QuantumChannelTestTarget(double distance, double x_error_rate, double loss_rate) {
+    this->distance = distance;
+    err.x_error_rate = x_error_rate;
+    err.y_error_rate = 0;
+    err.z_error_rate = 0;
+    err.loss_rate = loss_rate;
+    err.error_rate = x_error_rate + loss_rate;
+    updateTransitionMatrix();
+  }
+};
+
+TEST(QuantumChannelTest, OutcomeProbabilitiesOfTheDistance) {
+  QuantumChannelTestTarget no_distance{0, 0.01, 0.04};
+  auto outcomes = no_distance.getPhotonOutcomeProbabilities();
+  EXPECT_NEAR(outcomes[0], 1, 1e-12);
+  EXPECT_NEAR(outcomes[4], 0, 1e-12);
+
+  QuantumChannelTestTarget one_km{1, 0.01, 0.04};
+  outcomes = one_km.getPhotonOutcomeProbabilities();
+  EXPECT_NEAR(outcomes[0], 0.95, 1e-12);
+  EXPECT_NEAR(outcomes[1], 0.01, 1e-12);
+  EXPECT_NEAR(outcomes[4], 0.04, 1e-12);
+}
+
+TEST(QuantumChannelTest, SameParametersShareTheOutcomes) {
+  QuantumChannelTestTarget channel{20, 0.01, 0.04};
+  QuantumChannelTestTarget same_channel{20, 0.01, 0.04};
+  QuantumChannelTestTarget longer_channel{30, 0.01, 0.04};
+  EXPECT_EQ(channel.getPhotonOutcomeProbabilities(), same_channel.getPhotonOutcomeProbabilities());
+  EXPECT_LT(longer_channel.getPhotonOutcomeProbabilities()[0], channel.getPhotonOutcomeProbabilities()[0]);
+}
+
+TEST(QuantumChannelTest, TakeOutcomesOfTheCacheFile) {
+  std::string path = testing::TempDir() + "outcome_cache_take_" + std::to_string(::getpid());
+  ::unlink(path.c_str());
+  OutcomeRecord record{{{123, 0.01, 0, 0, 0.04}, {0.5, 0.1, 0, 0, 0.4}}};
+  RecordFile{path, "QOUTCOM1", sizeof(OutcomeRecord)}.append(&record);
+
+  QuantumChannelTestTarget channel{0, 0.01, 0.04};
+  channel.loadOutcomeCacheFile(path);
+  channel.distance = 123;
+  channel.updateTransitionMatrix();
+  EXPECT_EQ(channel.getPhotonOutcomeProbabilities(), record[1]);
+  ::unlink(path.c_str());
+}
+
+TEST(QuantumChannelTest, AppendComputedOutcomesToTheCacheFile) {
+  std::string path = testing::TempDir() + "outcome_cache_append_" + std::to_string(::getpid());
+  ::unlink(path.c_str());
+  QuantumChannelTestTarget channel{0, 0.01, 0.04};
+  channel.loadOutcomeCacheFile(path);
+  channel.distance = 77;
+  channel.updateTransitionMatrix();
+  // the outcomes computed before the file was given aren't in it
+  std::vector<OutcomeRecord> records;
+  RecordFile{path, "QOUTCOM1", sizeof(OutcomeRecord)}.read([&](const std::byte *bytes) {
+    OutcomeRecord record;
+    std::memcpy(&record, bytes, sizeof(OutcomeRecord));
+    records.push_back(record);
+  });
+  ASSERT_EQ(records.size(), 1);
+  EXPECT_EQ(records[0][0], (std::array<double, 5>{77, 0.01, 0, 0, 0.04}));
+  EXPECT_EQ(records[0][1], channel.getPhotonOutcomeProbabilities());
+  ::unlink(path.c_str());
+}
+
+TEST(QuantumChannelTest, LostPhotonStaysLost) {
+  quisp_test::prepareSimulation();
+  QuantumChannelTestTarget lossless{20, 0, 0};
+  PhotonicQubit photon;
+  photon.setLost(true);
+  omnetpp::SendOptions options;
+  lossless.processMessage(&photon, options, 0);
+  EXPECT_TRUE(photon.isLost());
+  EXPECT_FALSE(photon.hasXError());
+}
+
+TEST(QuantumChannelTest, DropLostPhotonsBetweenFirstAndLast) {
+  quisp_test::prepareSimulation();
+  QuantumChannelTestTarget lossless{20, 0, 0};
+  lossless.drop_lost_photons = true;
+  omnetpp::SendOptions options;
+  PoolQubit qubit;
+  PhotonicQubit first, lost, lost_last, next;
+  for (auto *photon : {&first, &lost, &lost_last, &next}) photon->setQubitRef(&qubit);
+  first.setFirst(true);
+  first.setLost(true);
+  lost.setLost(true);
+  lost_last.setLost(true);
+  lost_last.setLast(true);
+
+  // the first and the last photons arrive even if they're lost
+  EXPECT_FALSE(lossless.processMessage(&first, options, 0).discard);
+  EXPECT_TRUE(lossless.processMessage(&lost, options, 1).discard);
+  EXPECT_EQ(qubit.num_released, 1);
+  EXPECT_FALSE(lossless.processMessage(&lost_last, options, 2).discard);
+  // the next photon through the channel carries the arrival time of the dropped one
+  ASSERT_EQ(lost_last.getNumDroppedPhotons(), 1);
+  EXPECT_EQ(lost_last.getDroppedArrivalTime(0), 1 + lossless.getDelay());
+  EXPECT_FALSE(lossless.processMessage(&next, options, 3).discard);
+  EXPECT_EQ(next.getNumDroppedPhotons(), 0);
+  EXPECT_EQ(lossless.num_dropped_photons, 1);
+}
+
+}  // namespace
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <omnetpp.h>
+
+namespace quisp::messages {
+
+/**
+ * @brief MessagePool recycles the messages of the type T instead of deleting them.
+ *
+ * The consuming module releases a message to the pool, and the producing module acquires it
+ * in place of a new allocation. The pool owns the released messages through its cQueue, so the pool
+ * must belong to a module that both produces and consumes T, like the RuleEngine with the results exchanged
+ * with its partners. A message acquired in a module's context is owned by that module as if it's new.
+ */
+template <typename T>
+class MessagePool {
+ public:
+  /// @param capacity the max number of the free messages kept, 0 disables the pooling
+  explicit MessagePool(const char *name, int capacity = 256) : free_messages(name), capacity(capacity) {}
+
+  /// @brief returns a recycled message reset to the default values, or a new one.
+  T *acquire(const char *name) {
+    if (free_messages.isEmpty()) {
+      num_allocated++;
+      return new T(name);
+    }
+    num_reused++;
+    auto *msg = static_cast<T *>(free_messages.pop());
+    msg->setName(name);
+    return msg;
+  }
+
+  /// @brief keeps the message for the next acquisition, or deletes it if the pool is full.
+  void release(T *msg) {
+    if (free_messages.getLength() >= capacity) {
+      delete msg;
+      return;
+    }
+    // reset the fields. the name and the message id are kept
+    *msg = T();
+    free_messages.insert(msg);
+  }
+
+  void setCapacity(int capacity) { this->capacity = capacity; }
+  long numAllocated() const { return num_allocated; }
+  long numReused() const { return num_reused; }
+  int numFree() const { return free_messages.getLength(); }
+
+ private:
+  omnetpp::cQueue free_messages;
+  int capacity;
+  long num_allocated = 0;
+  long num_reused = 0;
+};
+
+}  // namespace quisp::messages
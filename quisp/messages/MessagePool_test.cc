@@ -0,0 +1,51 @@
+#include "MessagePool.h"
+
+#include <gtest/gtest.h>
+#include <messages/classical_messages.h>
+#include <test_utils/TestUtils.h>
+
+namespace {
+using quisp::messages::MessagePool;
+using quisp::messages::PurificationResult;
+using quisp_test::utils::prepareSimulation;
+
+TEST(MessagePoolTest, ReuseReleasedMessage) {
+  prepareSimulation();
+  MessagePool<PurificationResult> pool{"purification_result_pool"};
+  auto *msg = pool.acquire("PurificationResult");
+  msg->setSrcAddr(3);
+  msg->setRulesetId(5);
+  msg->setKind(7);
+  pool.release(msg);
+  EXPECT_EQ(pool.numFree(), 1);
+
+  auto *reused = pool.acquire("PurificationResult");
+  EXPECT_EQ(reused, msg);
+  EXPECT_STREQ(reused->getName(), "PurificationResult");
+  EXPECT_EQ(reused->getSrcAddr(), 0);
+  EXPECT_EQ(reused->getRulesetId(), 0);
+  EXPECT_EQ(reused->getKind(), 0);
+  EXPECT_EQ(pool.numAllocated(), 1);
+  EXPECT_EQ(pool.numReused(), 1);
+  EXPECT_EQ(pool.numFree(), 0);
+  delete reused;
+}
+
+TEST(MessagePoolTest, Capacity) {
+  prepareSimulation();
+  MessagePool<PurificationResult> pool{"purification_result_pool", 1};
+  auto *first = pool.acquire("PurificationResult");
+  auto *second = pool.acquire("PurificationResult");
+  pool.release(first);
+  pool.release(second);  // deleted
+  EXPECT_EQ(pool.numFree(), 1);
+
+  pool.setCapacity(0);
+  auto *msg = pool.acquire("PurificationResult");
+  pool.release(msg);
+  EXPECT_EQ(pool.numFree(), 0);
+  EXPECT_EQ(pool.numAllocated(), 2);
+  EXPECT_EQ(pool.numReused(), 1);
+}
+
+}  // namespace
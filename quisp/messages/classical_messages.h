@@ -2,6 +2,7 @@
 #include "BSA_ipc_messages_m.h"
 #include "EPPS_ipc_messages_m.h"
 #include "QNode_ipc_messages_m.h"
+#include "bell_pair_cutoff_messages_m.h"
 #include "connection_setup_messages_m.h"
 #include "entanglement_swapping_messages_m.h"
 #include "link_generation_messages_m.h"
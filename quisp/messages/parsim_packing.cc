@@ -0,0 +1,266 @@
+#include "parsim_packing.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "messages/entanglement_swapping_messages_m.h"
+
+namespace omnetpp {
+
+namespace {
+template <typename Enum>
+void packEnum(cCommBuffer *b, Enum value) {
+  b->pack(static_cast<int>(value));
+}
+
+template <typename Enum>
+void unpackEnum(cCommBuffer *b, Enum &value) {
+  int packed;
+  b->unpack(packed);
+  value = static_cast<Enum>(packed);
+}
+
+int unpackSize(cCommBuffer *b) {
+  int size;
+  b->unpack(size);
+  if (size < 0) throw cRuntimeError("parsim unpacking: negative container size %d", size);
+  return size;
+}
+
+void packQNic(cCommBuffer *b, const quisp::modules::QNIC &qnic) {
+  packEnum(b, qnic.type);
+  b->pack(qnic.index);
+  b->pack(qnic.address);
+}
+
+void unpackQNic(cCommBuffer *b, quisp::modules::QNIC &qnic) {
+  unpackEnum(b, qnic.type);
+  b->unpack(qnic.index);
+  b->unpack(qnic.address);
+  qnic.pointer = nullptr;
+}
+}  // namespace
+
+void doParsimPacking(cCommBuffer *b, const quisp::modules::QNIC_type &type) { packEnum(b, type); }
+void doParsimUnpacking(cCommBuffer *b, quisp::modules::QNIC_type &type) { unpackEnum(b, type); }
+
+void doParsimPacking(cCommBuffer *b, const quisp::modules::QNicPairInfo &pair) {
+  packQNic(b, pair.first);
+  packQNic(b, pair.second);
+}
+
+void doParsimUnpacking(cCommBuffer *b, quisp::modules::QNicPairInfo &pair) {
+  unpackQNic(b, pair.first);
+  unpackQNic(b, pair.second);
+}
+
+void doParsimPacking(cCommBuffer *b, const nlohmann::json &j) {
+  auto bytes = nlohmann::json::to_cbor(j);
+  b->pack((int)bytes.size());
+  b->pack(bytes.data(), (int)bytes.size());
+}
+
+void doParsimUnpacking(cCommBuffer *b, nlohmann::json &j) {
+  std::vector<std::uint8_t> bytes(unpackSize(b));
+  b->unpack(bytes.data(), (int)bytes.size());
+  j = nlohmann::json::from_cbor(bytes);
+}
+
+void doParsimPacking(cCommBuffer *, const std::shared_ptr<const quisp::runtime::RuleSet> &) {}
+void doParsimUnpacking(cCommBuffer *, std::shared_ptr<const quisp::runtime::RuleSet> &ruleset) { ruleset = nullptr; }
+
+void doParsimPacking(cCommBuffer *b, const quisp::messages::SwappingResultEntry &entry) {
+  b->pack(entry.shared_rule_tag);
+  b->pack(entry.sequence_number);
+  b->pack(entry.correction_frame);
+  b->pack(entry.new_partner);
+}
+
+void doParsimUnpacking(cCommBuffer *b, quisp::messages::SwappingResultEntry &entry) {
+  b->unpack(entry.shared_rule_tag);
+  b->unpack(entry.sequence_number);
+  b->unpack(entry.correction_frame);
+  b->unpack(entry.new_partner);
+}
+
+void doParsimPacking(cCommBuffer *b, const quisp::physical::types::PauliOperator &op) { packEnum(b, op); }
+void doParsimUnpacking(cCommBuffer *b, quisp::physical::types::PauliOperator &op) { unpackEnum(b, op); }
+
+void doParsimPacking(cCommBuffer *b, const quisp::physical::types::BSAClickResult &result) {
+  b->pack(result.success);
+  packEnum(b, result.correction_operation);
+  packEnum(b, result.pauli_error);
+}
+
+void doParsimUnpacking(cCommBuffer *b, quisp::physical::types::BSAClickResult &result) {
+  b->unpack(result.success);
+  unpackEnum(b, result.correction_operation);
+  unpackEnum(b, result.pauli_error);
+}
+
+void doParsimPacking(cCommBuffer *b, const quisp::physical::types::CompactClickResults &results) {
+  auto successes = results.decode();
+  b->pack((int)successes.size());
+  for (auto &success : successes) {
+    b->pack(success.photon_index);
+    packEnum(b, success.correction_operation);
+    packEnum(b, success.pauli_error);
+  }
+}
+
+void doParsimUnpacking(cCommBuffer *b, quisp::physical::types::CompactClickResults &results) {
+  results.clear();
+  int size = unpackSize(b);
+  for (int i = 0; i < size; i++) {
+    quisp::physical::types::ClickSuccess success;
+    b->unpack(success.photon_index);
+    unpackEnum(b, success.correction_operation);
+    unpackEnum(b, success.pauli_error);
+    results.append(success.photon_index, success.correction_operation, success.pauli_error);
+  }
+}
+
+void doParsimPacking(cCommBuffer *b, const quisp::modules::ospf::OspfState &state) { packEnum(b, state); }
+void doParsimUnpacking(cCommBuffer *b, quisp::modules::ospf::OspfState &state) { unpackEnum(b, state); }
+
+void doParsimPacking(cCommBuffer *b, const quisp::modules::ospf::OspfNeighborInfo &info) {
+  b->pack(info.router_id);
+  b->pack(info.hop_address);
+  packEnum(b, info.state);
+  b->pack(info.cost);
+  b->pack(info.area);
+}
+
+void doParsimUnpacking(cCommBuffer *b, quisp::modules::ospf::OspfNeighborInfo &info) {
+  b->unpack(info.router_id);
+  b->unpack(info.hop_address);
+  unpackEnum(b, info.state);
+  b->unpack(info.cost);
+  b->unpack(info.area);
+}
+
+void doParsimPacking(cCommBuffer *b, const quisp::modules::ospf::LinkStateAdvertisement &lsa) {
+  b->pack(lsa.lsa_id);
+  b->pack(lsa.lsa_origin_id);
+  b->pack(lsa.lsa_age);
+  doParsimPacking(b, lsa.neighbor_nodes);
+  b->pack(lsa.area);
+  b->pack((int)lsa.area_summaries.size());
+  for (auto &[area, summary] : lsa.area_summaries) {
+    b->pack(area);
+    b->pack(summary.cost);
+    b->pack(summary.via);
+  }
+}
+
+void doParsimUnpacking(cCommBuffer *b, quisp::modules::ospf::LinkStateAdvertisement &lsa) {
+  b->unpack(lsa.lsa_id);
+  b->unpack(lsa.lsa_origin_id);
+  b->unpack(lsa.lsa_age);
+  doParsimUnpacking(b, lsa.neighbor_nodes);
+  b->unpack(lsa.area);
+  lsa.area_summaries.clear();
+  int size = unpackSize(b);
+  for (int i = 0; i < size; i++) {
+    quisp::modules::ospf::AreaId area;
+    quisp::modules::ospf::AreaSummary summary;
+    b->unpack(area);
+    b->unpack(summary.cost);
+    b->unpack(summary.via);
+    lsa.area_summaries.emplace(area, summary);
+  }
+}
+
+void doParsimPacking(cCommBuffer *b, const quisp::modules::ospf::RouterIds &ids) {
+  b->pack((int)ids.size());
+  b->pack(ids.data(), (int)ids.size());
+}
+
+void doParsimUnpacking(cCommBuffer *b, quisp::modules::ospf::RouterIds &ids) {
+  ids.resize(unpackSize(b));
+  b->unpack(ids.data(), (int)ids.size());
+}
+
+void doParsimPacking(cCommBuffer *b, const quisp::modules::ospf::NeighborTable &table) {
+  b->pack((int)table.size());
+  for (auto &[addr, info] : table) {
+    b->pack(addr);
+    doParsimPacking(b, info);
+  }
+}
+
+void doParsimUnpacking(cCommBuffer *b, quisp::modules::ospf::NeighborTable &table) {
+  table.clear();
+  int size = unpackSize(b);
+  for (int i = 0; i < size; i++) {
+    quisp::modules::ospf::NodeAddr addr;
+    quisp::modules::ospf::OspfNeighborInfo info;
+    b->unpack(addr);
+    doParsimUnpacking(b, info);
+    table.emplace(addr, info);
+  }
+}
+
+void doParsimPacking(cCommBuffer *b, const quisp::modules::ospf::LinkStateDatabaseSummary &summary) {
+  b->pack((int)summary.size());
+  for (auto &lsa : summary) {
+    b->pack(lsa.lsa_id);
+    b->pack(lsa.lsa_origin_id);
+    b->pack(lsa.lsa_age);
+  }
+}
+
+void doParsimUnpacking(cCommBuffer *b, quisp::modules::ospf::LinkStateDatabaseSummary &summary) {
+  summary.resize(unpackSize(b));
+  for (auto &lsa : summary) {
+    b->unpack(lsa.lsa_id);
+    b->unpack(lsa.lsa_origin_id);
+    b->unpack(lsa.lsa_age);
+  }
+}
+
+void doParsimPacking(cCommBuffer *b, const quisp::modules::ospf::LinkStateUpdate &update) {
+  b->pack((int)update.size());
+  for (auto &lsa : update) {
+    b->pack(lsa != nullptr);
+    if (lsa != nullptr) doParsimPacking(b, *lsa);
+  }
+}
+
+void doParsimUnpacking(cCommBuffer *b, quisp::modules::ospf::LinkStateUpdate &update) {
+  update.clear();
+  int size = unpackSize(b);
+  for (int i = 0; i < size; i++) {
+    bool has_lsa;
+    b->unpack(has_lsa);
+    if (!has_lsa) {
+      update.push_back(nullptr);
+      continue;
+    }
+    quisp::modules::ospf::LinkStateAdvertisement lsa;
+    doParsimUnpacking(b, lsa);
+    update.push_back(std::make_shared<const quisp::modules::ospf::LinkStateAdvertisement>(std::move(lsa)));
+  }
+}
+
+void doParsimPacking(cCommBuffer *b, const quisp::modules::ospf::AreaCosts &costs) {
+  b->pack((int)costs.size());
+  for (auto &[area, cost] : costs) {
+    b->pack(area);
+    b->pack(cost);
+  }
+}
+
+void doParsimUnpacking(cCommBuffer *b, quisp::modules::ospf::AreaCosts &costs) {
+  costs.clear();
+  int size = unpackSize(b);
+  for (int i = 0; i < size; i++) {
+    quisp::modules::ospf::AreaId area;
+    double cost;
+    b->unpack(area);
+    b->unpack(cost);
+    costs.emplace(area, cost);
+  }
+}
+
+}  // namespace omnetpp
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <omnetpp.h>
+#include <memory>
+#include <nlohmann/json.hpp>
+
+#include "modules/PhysicalConnection/BSA/CompactClickResults.h"
+#include "modules/PhysicalConnection/BSA/types.h"
+#include "modules/QNIC.h"
+#include "modules/QRSA/RoutingDaemon/RoutingProtocol/Ospf/Ospf.h"
+#include "runtime/RuleSet.h"
+
+namespace quisp::messages {
+struct SwappingResultEntry;
+}  // namespace quisp::messages
+
+/**
+ * @file parsim_packing.h
+ * @brief the parsim packing of the @opaque message fields, for the packets that cross the partitions of a parallel simulation.
+ *
+ * The generated parsimPack/parsimUnpack of the messages call doParsimPacking/doParsimUnpacking for these types,
+ * and the ones without an overload throw at the first cross-partition packet. The overloads are in the omnetpp namespace
+ * like the generated templates, so they're found through the cCommBuffer argument.
+ */
+namespace omnetpp {
+
+void doParsimPacking(cCommBuffer *b, const quisp::modules::QNIC_type &type);
+void doParsimUnpacking(cCommBuffer *b, quisp::modules::QNIC_type &type);
+/// @brief the type, index and address of the both QNICs. the module pointers are local to the process and aren't packed.
+void doParsimPacking(cCommBuffer *b, const quisp::modules::QNicPairInfo &pair);
+void doParsimUnpacking(cCommBuffer *b, quisp::modules::QNicPairInfo &pair);
+
+/// @brief packs the json in CBOR
+void doParsimPacking(cCommBuffer *b, const nlohmann::json &j);
+void doParsimUnpacking(cCommBuffer *b, nlohmann::json &j);
+/// @brief the compiled RuleSet is shared in a process only, the receiver compiles the serialized RuleSet of the packet instead.
+void doParsimPacking(cCommBuffer *b, const std::shared_ptr<const quisp::runtime::RuleSet> &ruleset);
+/// @brief always unpacks nullptr
+void doParsimUnpacking(cCommBuffer *b, std::shared_ptr<const quisp::runtime::RuleSet> &ruleset);
+
+void doParsimPacking(cCommBuffer *b, const quisp::messages::SwappingResultEntry &entry);
+void doParsimUnpacking(cCommBuffer *b, quisp::messages::SwappingResultEntry &entry);
+
+void doParsimPacking(cCommBuffer *b, const quisp::physical::types::PauliOperator &op);
+void doParsimUnpacking(cCommBuffer *b, quisp::physical::types::PauliOperator &op);
+void doParsimPacking(cCommBuffer *b, const quisp::physical::types::BSAClickResult &result);
+void doParsimUnpacking(cCommBuffer *b, quisp::physical::types::BSAClickResult &result);
+/// @brief packs the decoded successes, and appends them again on unpacking
+void doParsimPacking(cCommBuffer *b, const quisp::physical::types::CompactClickResults &results);
+void doParsimUnpacking(cCommBuffer *b, quisp::physical::types::CompactClickResults &results);
+
+void doParsimPacking(cCommBuffer *b, const quisp::modules::ospf::OspfState &state);
+void doParsimUnpacking(cCommBuffer *b, quisp::modules::ospf::OspfState &state);
+void doParsimPacking(cCommBuffer *b, const quisp::modules::ospf::OspfNeighborInfo &info);
+void doParsimUnpacking(cCommBuffer *b, quisp::modules::ospf::OspfNeighborInfo &info);
+void doParsimPacking(cCommBuffer *b, const quisp::modules::ospf::LinkStateAdvertisement &lsa);
+void doParsimUnpacking(cCommBuffer *b, quisp::modules::ospf::LinkStateAdvertisement &lsa);
+void doParsimPacking(cCommBuffer *b, const quisp::modules::ospf::RouterIds &ids);
+void doParsimUnpacking(cCommBuffer *b, quisp::modules::ospf::RouterIds &ids);
+void doParsimPacking(cCommBuffer *b, const quisp::modules::ospf::NeighborTable &table);
+void doParsimUnpacking(cCommBuffer *b, quisp::modules::ospf::NeighborTable &table);
+void doParsimPacking(cCommBuffer *b, const quisp::modules::ospf::LinkStateDatabaseSummary &summary);
+void doParsimUnpacking(cCommBuffer *b, quisp::modules::ospf::LinkStateDatabaseSummary &summary);
+/// @brief packs the LSAs by value, the unpacked update has its own copies
+void doParsimPacking(cCommBuffer *b, const quisp::modules::ospf::LinkStateUpdate &update);
+void doParsimUnpacking(cCommBuffer *b, quisp::modules::ospf::LinkStateUpdate &update);
+void doParsimPacking(cCommBuffer *b, const quisp::modules::ospf::AreaCosts &costs);
+void doParsimUnpacking(cCommBuffer *b, quisp::modules::ospf::AreaCosts &costs);
+
+}  // namespace omnetpp
@@ -0,0 +1,144 @@
+#include "parsim_packing.h"
+
+#include <gtest/gtest.h>
+#include <messages/classical_messages.h>
+#include <memory>
+#include <vector>
+// the buffer of the parsim communications in OMNeT++, see TEST_INCLUDE of makefrag
+#include "sim/parsim/cmemcommbuffer.h"
+
+namespace {
+using namespace quisp::modules::ospf;
+using namespace quisp::physical::types;
+using nlohmann::json;
+using omnetpp::cMemCommBuffer;
+using quisp::messages::SwappingResultEntry;
+using quisp::modules::QNIC_E;
+using quisp::modules::QNIC_R;
+using quisp::modules::QNIC_RP;
+using quisp::modules::QNIC_type;
+using quisp::modules::QNicPairInfo;
+
+// packs the value and unpacks it into a default one, as the receiving partition does
+template <typename T>
+T roundTrip(const T &value) {
+  cMemCommBuffer buffer;
+  doParsimPacking(&buffer, value);
+  T unpacked{};
+  doParsimUnpacking(&buffer, unpacked);
+  EXPECT_TRUE(buffer.isBufferEmpty());
+  return unpacked;
+}
+
+TEST(ParsimPackingTest, QNicType) {
+  for (auto type : {QNIC_E, QNIC_R, QNIC_RP}) EXPECT_EQ(roundTrip<QNIC_type>(type), type);
+}
+
+TEST(ParsimPackingTest, QNicPairInfo) {
+  QNicPairInfo pair;
+  pair.first = {QNIC_R, 2, 103, nullptr};
+  pair.second = {QNIC_E, 0, 201, nullptr};
+  auto unpacked = roundTrip(pair);
+  EXPECT_EQ(unpacked.first.type, QNIC_R);
+  EXPECT_EQ(unpacked.first.index, 2);
+  EXPECT_EQ(unpacked.first.address, 103);
+  EXPECT_EQ(unpacked.second.type, QNIC_E);
+  EXPECT_EQ(unpacked.second.index, 0);
+  EXPECT_EQ(unpacked.second.address, 201);
+  EXPECT_EQ(unpacked.second.pointer, nullptr);
+}
+
+TEST(ParsimPackingTest, Json) {
+  json ruleset = {{"ruleset_id", 1234}, {"owner_address", 3}, {"rules", {{{"name", "purification"}, {"partners", {2, 5}}}}}, {"fidelity", 0.95}};
+  EXPECT_EQ(roundTrip(ruleset), ruleset);
+  EXPECT_EQ(roundTrip(json{}), json{});
+}
+
+TEST(ParsimPackingTest, RuntimeRuleSetIsCompiledAgainByTheReceiver) {
+  std::shared_ptr<const quisp::runtime::RuleSet> compiled = std::make_shared<const quisp::runtime::RuleSet>("compiled rs");
+  EXPECT_EQ(roundTrip(compiled), nullptr);
+}
+
+TEST(ParsimPackingTest, SwappingResultEntry) {
+  auto unpacked = roundTrip(SwappingResultEntry{3, 17, 2, 9});
+  EXPECT_EQ(unpacked.shared_rule_tag, 3);
+  EXPECT_EQ(unpacked.sequence_number, 17);
+  EXPECT_EQ(unpacked.correction_frame, 2);
+  EXPECT_EQ(unpacked.new_partner, 9);
+}
+
+TEST(ParsimPackingTest, BSAResults) {
+  for (auto op : {PauliOperator::I, PauliOperator::X, PauliOperator::Y, PauliOperator::Z}) EXPECT_EQ(roundTrip(op), op);
+
+  auto click = roundTrip(BSAClickResult{true, PauliOperator::X, PauliOperator::Z});
+  EXPECT_TRUE(click.success);
+  EXPECT_EQ(click.correction_operation, PauliOperator::X);
+  EXPECT_EQ(click.pauli_error, PauliOperator::Z);
+
+  CompactClickResults results;
+  results.append(1, PauliOperator::I);
+  results.append(130, PauliOperator::Y, PauliOperator::X);
+  results.append(20000, PauliOperator::Z);
+  auto successes = roundTrip(results).decode();
+  ASSERT_EQ(successes.size(), 3);
+  EXPECT_EQ(successes[1].photon_index, 130);
+  EXPECT_EQ(successes[1].correction_operation, PauliOperator::Y);
+  EXPECT_EQ(successes[1].pauli_error, PauliOperator::X);
+  EXPECT_EQ(successes[2].photon_index, 20000);
+  EXPECT_EQ(successes[2].pauli_error, PauliOperator::I);
+  EXPECT_TRUE(roundTrip(CompactClickResults{}).empty());
+}
+
+TEST(ParsimPackingTest, OspfNeighbors) {
+  EXPECT_EQ(roundTrip(OspfState::EXCHANGE), OspfState::EXCHANGE);
+
+  OspfNeighborInfo info{4, 1, OspfState::FULL, 2.5};
+  info.area = 7;
+  auto unpacked = roundTrip(info);
+  EXPECT_EQ(unpacked.router_id, 4);
+  EXPECT_EQ(unpacked.hop_address, 1);
+  EXPECT_EQ(unpacked.state, OspfState::FULL);
+  EXPECT_DOUBLE_EQ(unpacked.cost, 2.5);
+  EXPECT_EQ(unpacked.area, 7);
+
+  NeighborTable table{{4, info}, {6, OspfNeighborInfo{6, 2, OspfState::TWO_WAY, 1}}};
+  auto unpacked_table = roundTrip(table);
+  ASSERT_EQ(unpacked_table.size(), 2);
+  EXPECT_EQ(unpacked_table.at(6).hop_address, 2);
+  EXPECT_EQ(unpacked_table.at(6).state, OspfState::TWO_WAY);
+
+  EXPECT_EQ(roundTrip(RouterIds{3, 1, 4}), (RouterIds{3, 1, 4}));
+  EXPECT_TRUE(roundTrip(RouterIds{}).empty());
+  EXPECT_EQ(roundTrip(AreaCosts{{1, 0.5}, {2, 3}}), (AreaCosts{{1, 0.5}, {2, 3}}));
+}
+
+TEST(ParsimPackingTest, OspfLinkStateAdvertisements) {
+  LinkStateAdvertisement lsa{5, 5, 12, NeighborTable{{4, OspfNeighborInfo{4, 1, OspfState::FULL, 2.5}}}};
+  lsa.area = 1;
+  lsa.area_summaries = {{2, AreaSummary{3.5, 4}}};
+  auto unpacked = roundTrip(lsa);
+  EXPECT_EQ(unpacked.lsa_id, 5);
+  EXPECT_EQ(unpacked.lsa_origin_id, 5);
+  EXPECT_EQ(unpacked.lsa_age, 12);
+  ASSERT_EQ(unpacked.neighbor_nodes.size(), 1);
+  EXPECT_DOUBLE_EQ(unpacked.neighbor_nodes.at(4).cost, 2.5);
+  EXPECT_EQ(unpacked.area, 1);
+  EXPECT_EQ(unpacked.area_summaries, lsa.area_summaries);
+
+  auto summary = roundTrip(LinkStateDatabaseSummary{{5, 5, 12}, {6, 6, 3}});
+  ASSERT_EQ(summary.size(), 2);
+  EXPECT_EQ(summary[1].lsa_origin_id, 6);
+  EXPECT_EQ(summary[1].lsa_age, 3);
+
+  // the LSAs shared with the database are sent as copies
+  auto shared = std::make_shared<const LinkStateAdvertisement>(lsa);
+  auto update = roundTrip(LinkStateUpdate{shared, nullptr});
+  ASSERT_EQ(update.size(), 2);
+  ASSERT_NE(update[0], nullptr);
+  EXPECT_NE(update[0], shared);
+  EXPECT_EQ(update[0]->lsa_age, 12);
+  EXPECT_EQ(update[0]->neighbor_nodes.size(), 1);
+  EXPECT_EQ(update[1], nullptr);
+}
+
+}  // namespace
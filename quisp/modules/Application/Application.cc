@@ -5,8 +5,9 @@
  *  \brief Application
  */
 #include "Application.h"
-#include <random>
+#include <stdexcept>
 #include <vector>
+#include "modules/SharedResource/ConnectionMetrics.h"
 #include "utils/ComponentProvider.h"
 
 using namespace omnetpp;
@@ -17,12 +18,30 @@ namespace modules {
 
 Application::Application() : provider(utils::ComponentProvider{this}) {}
 
+Application::~Application() {
+  cancelAndDelete(generateTrafficMsg);
+  if (max_outstanding_requests > 0) {
+    auto *qnode = provider.getQNode();
+    qnode->unsubscribe(connection_established_signal, this);
+    qnode->unsubscribe(connection_terminated_signal, this);
+  }
+}
+
+Application::TrafficPattern Application::parseTrafficPattern(const std::string &name) {
+  if (name == "interval") return TrafficPattern::Interval;
+  if (name == "poisson") return TrafficPattern::Poisson;
+  if (name == "bursty") return TrafficPattern::Bursty;
+  throw std::invalid_argument("unknown traffic pattern: " + name);
+}
+
 /**
  * \brief Initialize module.
  *
  * If the node type is not EndNode, this module is automatically deleted in this function.
  */
 void Application::initialize() {
+  event_profiler = provider.getEventProfiler();
+  event_trace = provider.getEventTrace();
   initializeLogger(provider);
 
   // Since we only need this module in EndNode, delete it otherwise.
@@ -34,16 +53,53 @@ void Application::initialize() {
   }
   id = 0;
   my_address = provider.getNodeAddr();
+  connection_requested_signal = registerSignal(SharedResource::CONNECTION_REQUESTED_SIGNAL);
   is_initiator = provider.getQNode()->par("is_initiator");
 
   if (!is_initiator) {
     return;
   }
+  qos_priority = par("qos_priority");
+  qos_min_share = par("qos_min_share");
+  if (qos_min_share < 0 || qos_min_share > 1) error("qos_min_share must be in [0, 1]: %f", qos_min_share);
+
+  if (auto *replay = provider.getEventReplay(); replay != nullptr) {
+    replay_stimuli = &replay->stimuliOf(getFullPath());
+    generateTrafficMsg = new GenerateTraffic("GenerateTraffic");
+    scheduleNextArrival();
+    return;
+  }
 
+  try {
+    traffic_pattern = parseTrafficPattern(par("traffic_pattern").stdstringValue());
+  } catch (const std::invalid_argument &e) {
+    error("%s", e.what());
+  }
   createEndNodeWeightMap();
+  if (!hasDestination()) {
+    EV_WARN << "Node " << my_address << " has no end node to send the requests to\n";
+    return;
+  }
+  createDestinationSampler();
+
+  max_outstanding_requests = par("max_outstanding_requests");
+  if (max_outstanding_requests > 0) {
+    // the ConnectionManager and the RuleEngine of this node emit them
+    connection_established_signal = registerSignal(SharedResource::CONNECTION_ESTABLISHED_SIGNAL);
+    connection_terminated_signal = registerSignal(SharedResource::CONNECTION_TERMINATED_SIGNAL);
+    auto *qnode = provider.getQNode();
+    qnode->subscribe(connection_established_signal, this);
+    qnode->subscribe(connection_terminated_signal, this);
+  }
+
   generateTrafficMsg = new GenerateTraffic("GenerateTraffic");
-  scheduleAt(simTime() + 100, generateTrafficMsg);
-  generateTraffic();
+  scheduleNextArrival();
+}
+
+void Application::finish() {
+  if (!is_initiator) return;
+  recordScalar("connection_requests_generated", num_generated_requests);
+  recordScalar("connection_requests_blocked", num_blocked_requests);
 }
 
 /**
@@ -53,11 +109,14 @@ void Application::initialize() {
 ConnectionSetupRequest *Application::createConnectionSetupRequest(int dest_addr, int num_of_required_resources) {
   ConnectionSetupRequest *pk = new ConnectionSetupRequest("ConnSetupRequest");
   pk->setApplicationId(id);
+  pk->setRequestId(next_request_id++);
   pk->setActual_srcAddr(my_address);
   pk->setActual_destAddr(dest_addr);
   pk->setDestAddr(my_address);
   pk->setSrcAddr(my_address);
   pk->setNum_measure(num_of_required_resources);
+  pk->setQos_priority(qos_priority);
+  pk->setQos_min_share(qos_min_share);
   pk->setKind(7);
   return pk;
 }
@@ -68,34 +127,30 @@ ConnectionSetupRequest *Application::createConnectionSetupRequest(int dest_addr,
  * @param msg OMNeT++ cMessage
  */
 void Application::handleMessage(cMessage *msg) {
+  modules::SharedResource::EventProfiler::Scope profile(event_profiler, this, msg);
   if (dynamic_cast<DeleteThisModule *>(msg)) {
     delete msg;
     deleteModule();
     return;
   }
 
-  if (auto *req = dynamic_cast<ConnectionSetupRequest *>(msg)) {
-    logger->logPacket("handleMessage", msg);
-    send(msg, "toRouter");
-    return;
-  }
-
   if (dynamic_cast<ConnectionSetupResponse *>(msg)) {
-    logger->logPacket("handleMessage", msg);
+    QUISP_LOG(logger, Packet, logPacket("handleMessage", msg));
     send(msg, "toRouter");
     return;
   }
 
   if (dynamic_cast<InternalRuleSetForwarding *>(msg)) {
-    logger->logPacket("handleMessage", msg);
+    QUISP_LOG(logger, Packet, logPacket("handleMessage", msg));
     send(msg, "toRouter");
     return;
   }
 
   if (dynamic_cast<GenerateTraffic *>(msg)) {
-    logger->logPacket("handleMessage", msg);
+    QUISP_LOG(logger, Packet, logPacket("handleMessage", msg));
     generateTraffic();
-    scheduleAt(simTime() + 100, msg);
+    scheduleNextArrival();
+    return;
   }
 
   delete msg;
@@ -134,40 +189,110 @@ void Application::createEndNodeWeightMap() {
   }
 }
 
-void Application::generateTraffic() {
-  std::vector<int> weights;
+void Application::receiveSignal(cComponent *source, simsignal_t signal, cObject *obj, cObject *details) {
+  auto *event = dynamic_cast<SharedResource::ConnectionMetricEvent *>(obj);
+  if (event == nullptr) return;
+  if (signal == connection_established_signal) {
+    if (event->initiator_addr == my_address && outstanding_requests.count(event->request_id) > 0) outstanding_request_by_ruleset[event->ruleset_id] = event->request_id;
+  } else if (signal == connection_terminated_signal) {
+    auto it = outstanding_request_by_ruleset.find(event->ruleset_id);
+    if (it == outstanding_request_by_ruleset.end()) return;
+    outstanding_requests.erase(it->second);
+    outstanding_request_by_ruleset.erase(it);
+  }
+}
+
+bool Application::hasDestination() const {
+  for (auto [address, weight] : end_node_weight_map) {
+    if (address != my_address && weight > 0) return true;
+  }
+  return false;
+}
+
+/**
+ * \brief Prepare the O(1) sampling of the destinations
+ *
+ * Without the specific recipients, the table of all the end nodes is built once in SharedResource.
+ */
+void Application::createDestinationSampler() {
+  if (!par("has_specific_recipients").boolValue()) {
+    std::string node_type{provider.getQNode()->par("node_type").str().c_str()};
+    end_node_sampler = provider.getEndNodeSamplerForApplication(node_type);
+    return;
+  }
   std::vector<int> addresses;
+  std::vector<double> weights;
+  for (auto [address, weight] : end_node_weight_map) {
+    addresses.push_back(address);
+    weights.push_back(weight);
+  }
+  recipient_sampler = std::make_unique<SharedResource::AliasTable>(std::move(addresses), weights);
+}
+
+int Application::sampleDestination() {
+  if (recipient_sampler != nullptr) return recipient_sampler->sample(uniform(0, 1));
+  // hasDestination() ensures another end node has a positive weight
+  while (true) {
+    int dest_addr = end_node_sampler->sample(uniform(0, 1));
+    if (dest_addr != my_address) return dest_addr;
+  }
+}
 
+simtime_t Application::nextInterarrivalTime() {
+  if (traffic_pattern == TrafficPattern::Poisson) return exponential(1.0 / par("request_arrival_rate").doubleValue());
+  return par("request_generation_interval").doubleValue();
+}
+
+/**
+ * \brief Schedule the next arrival of the requests, up to sim-time-limit if it's defined, or the next replayed request
+ */
+void Application::scheduleNextArrival() {
+  if (replay_stimuli != nullptr) {
+    if (next_stimulus < replay_stimuli->size()) scheduleAt((*replay_stimuli)[next_stimulus].time, generateTrafficMsg);
+    return;
+  }
   cConfiguration *config = getEnvir()->getConfig();
   auto *sim_time_limit_option = cConfigOption::get("sim-time-limit");
   double max_sim_time = config->getAsDouble(sim_time_limit_option);
 
-  auto generate_up_to_time = simTime() + 100;
-  // if max_sim_time is not defined generate traffic for the next 100s for now
-  if (max_sim_time != 0) {
-    generate_up_to_time = max_sim_time;
-    cancelAndDelete(generateTrafficMsg);
-  }
+  simtime_t send_time = simTime() + nextInterarrivalTime();
+  if (max_sim_time != 0 && send_time >= max_sim_time) return;
+  scheduleAt(send_time, generateTrafficMsg);
+}
 
-  for (auto &it : end_node_weight_map) {
-    weights.push_back(it.second);
-    addresses.push_back(it.first);
+void Application::generateTraffic() {
+  if (replay_stimuli != nullptr) {
+    for (; next_stimulus < replay_stimuli->size() && (*replay_stimuli)[next_stimulus].time <= simTime(); next_stimulus++) {
+      sendConnectionSetupRequest((*replay_stimuli)[next_stimulus].dest_addr, (*replay_stimuli)[next_stimulus].num_pairs);
+    }
+    return;
   }
+  int num_requests = traffic_pattern == TrafficPattern::Bursty ? par("burst_size").intValue() : 1;
+  for (int i = 0; i < num_requests; i++) {
+    if (max_outstanding_requests > 0 && static_cast<int>(outstanding_requests.size()) >= max_outstanding_requests) {
+      num_blocked_requests++;
+      continue;
+    }
+    sendConnectionSetupRequest(sampleDestination(), par("number_of_bellpair").intValue());
+  }
+}
 
-  std::discrete_distribution<int> dist(std::begin(weights), std::end(weights));
-  std::mt19937 gen;
-  gen.seed(time(0));  // if you want different results from different runs
-
-  simtime_t send_time = simTime() + par("request_generation_interval").doubleValue();
-
-  while (send_time < generate_up_to_time) {
-    int dest_addr = addresses[dist(gen)];
-    int num_request_bell_pair = par("number_of_bellpair").intValue();
-    ConnectionSetupRequest *pk = createConnectionSetupRequest(dest_addr, num_request_bell_pair);
-    EV_INFO << "Node " << my_address << " will initiate connection to " << dest_addr << " at " << send_time << " with " << num_request_bell_pair << " Bell pairs\n";
-    scheduleAt(send_time, pk);
-    send_time = send_time + par("request_generation_interval").doubleValue();
+void Application::sendConnectionSetupRequest(int dest_addr, int num_of_required_resources) {
+  ConnectionSetupRequest *pk = createConnectionSetupRequest(dest_addr, num_of_required_resources);
+  EV_INFO << "Node " << my_address << " initiates connection to " << dest_addr << " at " << simTime() << " with " << num_of_required_resources << " Bell pairs\n";
+  QUISP_LOG(logger, Packet, logPacket("sendConnectionSetupRequest", pk));
+  num_generated_requests++;
+  if (event_trace != nullptr) event_trace->stimulus(this, dest_addr, num_of_required_resources);
+  if (max_outstanding_requests > 0) outstanding_requests.insert(pk->getRequestId());
+  if (mayHaveListeners(connection_requested_signal)) {
+    SharedResource::ConnectionMetricEvent event;
+    event.initiator_addr = my_address;
+    event.responder_addr = dest_addr;
+    event.request_id = pk->getRequestId();
+    event.node_addr = my_address;
+    emit(connection_requested_signal, &event);
   }
+  send(pk, "toRouter");
 }
 
 }  // namespace modules
@@ -8,8 +8,15 @@
 #ifndef MODULES_APPLICATION_H_
 #define MODULES_APPLICATION_H_
 
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include "IApplication.h"
 #include "modules/Logger/LoggerBase.h"
+#include "modules/SharedResource/AliasTable.h"
 #include "utils/ComponentProvider.h"
 
 using namespace omnetpp;
@@ -20,30 +27,70 @@ namespace modules {
 /** \class Application Application.cc
  *
  *  \brief Application
+ *
+ *  The initiator generates the connection setup requests to the end nodes sampled by their mass,
+ *  with the arrival process of traffic_pattern. At most max_outstanding_requests requests are in
+ *  flight, from the request to the termination of its RuleSet at this node.
+ *  With an EventReplay, it sends the requests of the traced run at their times instead.
  */
-class Application : public IApplication, public Logger::LoggerBase {
+class Application : public IApplication, public Logger::LoggerBase, public cListener {
  public:
   Application();
-  ~Application() {}
+  ~Application();
+
+  enum class TrafficPattern { Interval, Poisson, Bursty };
+  /// @throws std::invalid_argument for an unknown pattern.
+  static TrafficPattern parseTrafficPattern(const std::string &name);
 
  private:
-  cMessage *generateTrafficMsg;
+  cMessage *generateTrafficMsg = nullptr;
 
  protected:
   int id; /*!< Application id, which can be used if a user tried to simulate multiple applications on a single network */
   int my_address;
   bool is_initiator;
+  int next_request_id = 0;
+  simsignal_t connection_requested_signal;
+  simsignal_t connection_established_signal;
+  simsignal_t connection_terminated_signal;
 
   std::unordered_map<int, int> end_node_weight_map;
+  // the end nodes of the network, shared by the applications. this node is rejected when it's sampled
+  const SharedResource::AliasTable *end_node_sampler = nullptr;
+  // the possible recipients, if has_specific_recipients is true
+  std::unique_ptr<SharedResource::AliasTable> recipient_sampler;
+
+  TrafficPattern traffic_pattern = TrafficPattern::Interval;
+  int max_outstanding_requests = 0;  // 0 for no limit
+  // the QoS class of the connections of this application
+  int qos_priority = 0;
+  double qos_min_share = 0;
+  std::set<int> outstanding_requests;  // request ids
+  std::unordered_map<unsigned long, int> outstanding_request_by_ruleset;
+  long num_generated_requests = 0;
+  long num_blocked_requests = 0;  // arrivals dropped at max_outstanding_requests
+  // the requests of this module in the replayed trace, or nullptr
+  const std::vector<SharedResource::EventReplay::Stimulus> *replay_stimuli = nullptr;
+  std::size_t next_stimulus = 0;
 
   void initialize() override;
+  void finish() override;
   void handleMessage(cMessage *msg) override;
+  void receiveSignal(cComponent *source, simsignal_t signal, cObject *obj, cObject *details) override;
 
   void createEndNodeWeightMap();
+  void createDestinationSampler();
+  bool hasDestination() const;
+  int sampleDestination();
+  simtime_t nextInterarrivalTime();
+  void scheduleNextArrival();
   void generateTraffic();
+  void sendConnectionSetupRequest(int dest_addr, int num_of_required_resources);
 
   messages::ConnectionSetupRequest *createConnectionSetupRequest(int dest_addr, int num_of_required_resources);
   utils::ComponentProvider provider;
+  modules::SharedResource::EventProfiler *event_profiler = nullptr;
+  modules::SharedResource::EventTrace *event_trace = nullptr;
 };
 
 Define_Module(Application);
@@ -16,7 +16,16 @@ using namespace quisp_test;
 
 class Strategy : public quisp_test::TestComponentProviderStrategy {
  public:
-  Strategy(TestQNode *_qnode) : parent_qnode(_qnode) {}
+  Strategy(TestQNode *_qnode) : parent_qnode(_qnode) {
+    setParBool(&initializer, "profile_events", false);
+    setParStr(&initializer, "event_trace_filename", "");
+    setParStr(&initializer, "event_replay_filename", "");
+    setParInt(&initializer, "init_threads", 1);
+    setParBool(&initializer, "keep_tables_across_runs", false);
+    setParBool(&initializer, "centralized_connection_setup", false);
+    setParDouble(&initializer, "controller_delay", 0);
+    setParStr(&initializer, "validation_level", "full");
+  }
   cModule *getQNode() override { return parent_qnode; }
   int getNodeAddr() override { return parent_qnode->address; };
   quisp::modules::SharedResource::SharedResource *getSharedResource() override { return &initializer; }
@@ -39,9 +48,18 @@ class AppTestTarget : public quisp::modules::Application {
     }
     return toRouterGate;
   };
+  using quisp::modules::Application::num_blocked_requests;
+  using quisp::modules::Application::num_generated_requests;
+
   explicit AppTestTarget(TestQNode *parent_qnode) : Application(), toRouterGate(new TestGate(this, "toRouter")) {
     this->provider.setStrategy(std::make_unique<Strategy>(parent_qnode));
     setComponentType(new TestModuleType("test qnode"));
+    setParStr(this, "traffic_pattern", "interval");
+    setParDouble(this, "request_arrival_rate", 0.2);
+    setParInt(this, "burst_size", 4);
+    setParInt(this, "max_outstanding_requests", 0);
+    setParInt(this, "qos_priority", 0);
+    setParDouble(this, "qos_min_share", 0);
   }
   virtual ~AppTestTarget() { EVCB.gateDeleted(toRouterGate); }
   std::unordered_map<int, int> getEndNodeWeightMap() { return this->end_node_weight_map; }
@@ -139,6 +157,48 @@ TEST(AppTest, Init_Connection_Setup_Message_Send) {
   ASSERT_EQ(pkt->getDestAddr(), 123);
 }
 
+TEST(AppTest, Bursty_Traffic_With_Outstanding_Limit) {
+  auto *sim = prepareSimulation();
+  auto *mock_qnode = new TestQNode{123, 100, true};
+  auto *mock_qnode2 = new TestQNode{456, 100, false};
+  auto *app = new AppTestTarget{mock_qnode};
+  sim->setConfigValue("sim-time-limit", "10.1s");
+
+  setParStr(app, "traffic_pattern", "bursty");
+  setParDouble(app, "request_generation_interval", 5);
+  setParInt(app, "burst_size", 3);
+  setParInt(app, "max_outstanding_requests", 4);
+  setParInt(app, "number_of_bellpair", 10);
+  setParBool(app, "has_specific_recipients", false);
+
+  sim->registerComponent(app);
+  app->callInitialize();
+  sim->run();
+
+  // 3 requests at 5s, then 1 of the 3 at 10s since no RuleSet terminates
+  ASSERT_EQ(app->toRouterGate->messages.size(), 4);
+  EXPECT_EQ(app->num_generated_requests, 4);
+  EXPECT_EQ(app->num_blocked_requests, 2);
+  for (int i = 0; i < 4; i++) {
+    auto *pkt = dynamic_cast<ConnectionSetupRequest *>(app->toRouterGate->messages.at(i));
+    ASSERT_NE(pkt, nullptr);
+    EXPECT_EQ(pkt->getRequestId(), i);
+    EXPECT_EQ(pkt->getActual_destAddr(), mock_qnode2->address);
+  }
+}
+
+TEST(AppTest, Unknown_Traffic_Pattern) {
+  auto *sim = prepareSimulation();
+  auto *mock_qnode = new TestQNode{123, 100, true};
+  auto *mock_qnode2 = new TestQNode{456, 100, false};
+  auto *app = new AppTestTarget{mock_qnode};
+  setParStr(app, "traffic_pattern", "constant");
+  setParBool(app, "has_specific_recipients", false);
+
+  sim->registerComponent(app);
+  EXPECT_ANY_THROW(app->callInitialize());
+}
+
 TEST(AppTest, Specifying_Empty_As_Recipients) {
   auto *sim = prepareSimulation();
   auto *mock_qnode = new TestQNode{123, 100, true};
@@ -1,67 +1,139 @@
 #include "Backend.h"
 #include <memory>
+#include "QubitConfigurationParameters.h"
 #include "backends/QubitConfiguration.h"
+#include "modules/QNIC/StationaryQubit/QubitId.h"
+#include "modules/SharedResource/SharedResource.h"
 
 namespace quisp::modules::backend {
 
 BackendContainer::BackendContainer() {}
 
-BackendContainer::~BackendContainer() {}
+BackendContainer::~BackendContainer() {
+  if (listens_lifecycle) getEnvir()->removeLifecycleListener(this);
+}
 
 void BackendContainer::initialize() {
   auto backend_type = std::string(par("backend_type").stringValue());
   if (backend_type == "GraphStateBackend") {
     auto config = getDefaultQubitErrorModelConfiguration();
-    backend = std::make_unique<GraphStateBackend>(std::make_unique<RNG>(this), std::move(config), static_cast<GraphStateBackend::ICallback*>(this));
+    auto gs_backend = std::make_unique<GraphStateBackend>(createRNG(), std::move(config), static_cast<GraphStateBackend::ICallback*>(this));
+    auto memory_resource = std::string(par("memory_resource").stringValue());
+    auto memory_resource_strategy = utils::memoryResourceStrategyByName(memory_resource);
+    if (!memory_resource_strategy) throw omnetpp::cRuntimeError("Unknown memory resource: %s", memory_resource.c_str());
+    // before the photons of the pool, the resource must outlive all the qubits
+    gs_backend->setMemoryResourceStrategy(*memory_resource_strategy);
+    gs_backend->reserveShortLiveQubits(par("short_live_qubit_pool_size").intValue());
+    gs_backend->setLocalComplementThreads(par("local_complement_threads").intValue(), par("parallel_local_complement_degree").intValue());
+    gs_backend->setLazyMemoryError(par("lazy_memory_error").boolValue());
+    auto trace_path = std::string(par("trace_file").stringValue());
+    if (!trace_path.empty()) {
+      trace_file.open(trace_path, std::ios::binary);
+      if (!trace_file) throw omnetpp::cRuntimeError("cannot open the trace file: %s", trace_path.c_str());
+      trace_writer = std::make_unique<backends::trace::TraceWriter>(trace_file);
+      gs_backend->setTraceWriter(trace_writer.get());
+    }
+    auto statistics_path = std::string(par("graph_state_statistics_file").stringValue());
+    if (!statistics_path.empty()) {
+      statistics_file.open(statistics_path, std::ios::binary);
+      if (!statistics_file) throw omnetpp::cRuntimeError("cannot open the graph state statistics file: %s", statistics_path.c_str());
+      // the Bell pairs are counted by the node and the qnic of their ends
+      auto endpoint_of = [](std::uint64_t key) { return key >> qubit_id::QubitId::qubit_bits; };
+      gs_backend->setStatisticsSampler(&statistics_file, par("graph_state_statistics_interval").doubleValue(), endpoint_of);
+    }
+    backend = std::move(gs_backend);
+  } else if (backend_type == "StabilizerTableauBackend") {
+    auto config = getDefaultQubitErrorModelConfiguration();
+    backend = std::make_unique<StabilizerTableauBackend>(createRNG(), std::move(config), static_cast<StabilizerTableauBackend::ICallback*>(this));
+  } else if (backend_type == "PauliFrameBackend") {
+    auto config = getDefaultQubitErrorModelConfiguration();
+    backend = std::make_unique<PauliFrameBackend>(createRNG(), std::move(config), static_cast<PauliFrameBackend::ICallback*>(this));
+  } else if (backend_type == "DensityMatrixBackend") {
+    auto config = getDefaultQubitErrorModelConfiguration();
+    backend = std::make_unique<DensityMatrixBackend>(createRNG(), std::move(config), static_cast<DensityMatrixBackend::ICallback*>(this));
+  } else if (backend_type == "HybridBackend") {
+    auto config = getDefaultQubitErrorModelConfiguration();
+    backend = std::make_unique<HybridBackend>(createRNG(), std::move(config), static_cast<HybridBackend::ICallback*>(this));
   } else {
     throw omnetpp::cRuntimeError("Unknown backend type: %s", backend_type.c_str());
   }
-}
 
-std::unique_ptr<StationaryQubitConfiguration> BackendContainer::getDefaultQubitErrorModelConfiguration() {
-  auto conf = std::make_unique<StationaryQubitConfiguration>();
-  conf->measurement_x_err_rate = par("x_measurement_error_rate").doubleValue();
-  conf->measurement_y_err_rate = par("y_measurement_error_rate").doubleValue();
-  conf->measurement_z_err_rate = par("z_measurement_error_rate").doubleValue();
-
-  conf->h_gate_err_rate = par("h_gate_error_rate").doubleValue();
-  conf->h_gate_x_err_ratio = par("h_gate_x_error_ratio").doubleValue();
-  conf->h_gate_y_err_ratio = par("h_gate_y_error_ratio").doubleValue();
-  conf->h_gate_z_err_ratio = par("h_gate_z_error_ratio").doubleValue();
-
-  conf->x_gate_err_rate = par("x_gate_error_rate").doubleValue();
-  conf->x_gate_x_err_ratio = par("x_gate_x_error_ratio").doubleValue();
-  conf->x_gate_y_err_ratio = par("x_gate_y_error_ratio").doubleValue();
-  conf->x_gate_z_err_ratio = par("x_gate_z_error_ratio").doubleValue();
+  // the backend is not in a node and has no ComponentProvider, and the unit tests have no SharedResource
+  if (auto* network = getSimulation()->getSystemModule(); network != nullptr) {
+    auto* mod = network->getSubmodule("sharedResource");
+    if (mod == nullptr) mod = network->getSubmodule("sharedResource", getEnvir()->getParsimProcId());
+    if (auto* shared_resource = dynamic_cast<SharedResource::SharedResource*>(mod)) {
+      event_profiler = shared_resource->getEventProfiler();
+      auto* memory_accounting = shared_resource->getMemoryAccounting();
+      auto* gs_backend = dynamic_cast<GraphStateBackend*>(backend.get());
+      // only the graph state backend reports its qubits so far, the graph is what grows in the long runs
+      if (memory_accounting != nullptr && gs_backend != nullptr) {
+        memory_accounting->addReporter([gs_backend](SharedResource::MemoryAccounting::Usage& usage) {
+          auto backend_usage = gs_backend->getMemoryUsage();
+          usage["backend qubits"] += {backend_usage.num_qubits, backend_usage.bytes};
+          usage["backend edges"] += {backend_usage.num_edges, 0};
+        });
+      }
+    }
+  }
 
-  conf->z_gate_err_rate = par("z_gate_error_rate").doubleValue();
-  conf->z_gate_x_err_ratio = par("z_gate_x_error_ratio").doubleValue();
-  conf->z_gate_y_err_ratio = par("z_gate_y_error_ratio").doubleValue();
-  conf->z_gate_z_err_ratio = par("z_gate_z_error_ratio").doubleValue();
+  // the event profiler counts the operations by the time updates, so they stay one per operation with it
+  if (dynamic_cast<GraphStateBackend*>(backend.get()) != nullptr && event_profiler == nullptr) {
+    getEnvir()->addLifecycleListener(this);
+    listens_lifecycle = true;
+  }
+}
 
-  conf->cnot_gate_err_rate = par("cnot_gate_error_rate").doubleValue();
-  conf->cnot_gate_iz_err_ratio = par("cnot_gate_iz_error_ratio").doubleValue();
-  conf->cnot_gate_zi_err_ratio = par("cnot_gate_zi_error_ratio").doubleValue();
-  conf->cnot_gate_zz_err_ratio = par("cnot_gate_zz_error_ratio").doubleValue();
-  conf->cnot_gate_ix_err_ratio = par("cnot_gate_ix_error_ratio").doubleValue();
-  conf->cnot_gate_xi_err_ratio = par("cnot_gate_xi_error_ratio").doubleValue();
-  conf->cnot_gate_xx_err_ratio = par("cnot_gate_xx_error_ratio").doubleValue();
-  conf->cnot_gate_iy_err_ratio = par("cnot_gate_iy_error_ratio").doubleValue();
-  conf->cnot_gate_yi_err_ratio = par("cnot_gate_yi_error_ratio").doubleValue();
-  conf->cnot_gate_yy_err_ratio = par("cnot_gate_yy_error_ratio").doubleValue();
+void BackendContainer::lifecycleEvent(omnetpp::SimulationLifecycleEventType event_type, omnetpp::cObject* details) {
+  auto* gs_backend = dynamic_cast<GraphStateBackend*>(backend.get());
+  if (gs_backend == nullptr) return;
+  // initialize() and finish() of the modules run outside the events, the time is updated on each call there
+  if (event_type == omnetpp::LF_ON_SIMULATION_START || event_type == omnetpp::LF_ON_SIMULATION_RESUME) {
+    gs_backend->setEventScopedTime(true);
+  } else if (event_type == omnetpp::LF_ON_SIMULATION_PAUSE || event_type == omnetpp::LF_ON_SIMULATION_SUCCESS || event_type == omnetpp::LF_ON_SIMULATION_ERROR ||
+             event_type == omnetpp::LF_PRE_NETWORK_FINISH) {
+    gs_backend->setEventScopedTime(false);
+  }
+}
 
-  conf->memory_x_err_rate = par("memory_x_error_rate").doubleValue();
-  conf->memory_y_err_rate = par("memory_y_error_rate").doubleValue();
-  conf->memory_z_err_rate = par("memory_z_error_rate").doubleValue();
-  conf->memory_excitation_rate = par("memory_energy_excitation_rate").doubleValue();
-  conf->memory_relaxation_rate = par("memory_energy_relaxation_rate").doubleValue();
-  conf->memory_completely_mixed_rate = par("memory_completely_mixed_rate").doubleValue();
+std::unique_ptr<IRandomNumberGenerator> BackendContainer::createRNG() {
+  auto rng_type = std::string(par("rng_type").stringValue());
+  if (rng_type == "omnetpp") return std::make_unique<RNG>(this);
+  if (rng_type == "philox") return std::make_unique<BufferedRNG>(this, par("rng_buffer_size").intValue());
+  throw omnetpp::cRuntimeError("Unknown rng type: %s", rng_type.c_str());
+}
 
+std::unique_ptr<StationaryQubitConfiguration> BackendContainer::getDefaultQubitErrorModelConfiguration() {
+  auto conf = std::make_unique<StationaryQubitConfiguration>();
+  readQubitConfiguration(this, *conf);
   return conf;
 }
 
-void BackendContainer::willUpdate(GraphStateBackend& backend) { backend.setSimTime(omnetpp::simTime()); }
-void BackendContainer::finish() {}
+void BackendContainer::willUpdate(GraphStateBackend& backend) {
+  if (event_profiler != nullptr) event_profiler->countBackendOp();
+  backend.setSimTime(omnetpp::simTime());
+}
+void BackendContainer::willUpdate(StabilizerTableauBackend& backend) {
+  if (event_profiler != nullptr) event_profiler->countBackendOp();
+  backend.setSimTime(omnetpp::simTime());
+}
+void BackendContainer::willUpdate(PauliFrameBackend& backend) {
+  if (event_profiler != nullptr) event_profiler->countBackendOp();
+  backend.setSimTime(omnetpp::simTime());
+}
+void BackendContainer::willUpdate(DensityMatrixBackend& backend) {
+  if (event_profiler != nullptr) event_profiler->countBackendOp();
+  backend.setSimTime(omnetpp::simTime());
+}
+void BackendContainer::willUpdate(HybridBackend& backend) {
+  if (event_profiler != nullptr) event_profiler->countBackendOp();
+  backend.setSimTime(omnetpp::simTime());
+}
+void BackendContainer::finish() {
+  if (trace_writer == nullptr) return;
+  if (auto* gs_backend = dynamic_cast<GraphStateBackend*>(backend.get())) gs_backend->setTraceWriter(nullptr);
+  trace_file.flush();
+}
 
 IQuantumBackend* BackendContainer::getQuantumBackend() {
   if (backend == nullptr) {
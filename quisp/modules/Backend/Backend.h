@@ -1,18 +1,36 @@
 #pragma once
 #include <modules/common_types.h>
 #include <omnetpp.h>
+#include <fstream>
 #include <memory>
 #include "RNG.h"
+#include "backends/DensityMatrix/Backend.h"
 #include "backends/GraphState/Qubit.h"
+#include "backends/Hybrid/Backend.h"
+#include "backends/PauliFrame/Backend.h"
 #include "backends/QubitConfiguration.h"
+#include "backends/StabilizerTableau/Backend.h"
+#include "modules/SharedResource/EventProfiler.h"
 
 namespace quisp::modules::backend {
+using quisp::modules::common::DensityMatrixBackend;
 using quisp::modules::common::GraphStateBackend;
+using quisp::modules::common::HybridBackend;
 using quisp::modules::common::IQuantumBackend;
+using quisp::modules::common::PauliFrameBackend;
+using quisp::modules::common::StabilizerTableauBackend;
 using quisp::modules::common::StationaryQubitConfiguration;
+using backends::abstract::IRandomNumberGenerator;
+using rng::BufferedRNG;
 using rng::RNG;
 
-class BackendContainer : public omnetpp::cSimpleModule, GraphStateBackend::ICallback {
+class BackendContainer : public omnetpp::cSimpleModule,
+                         public omnetpp::cISimulationLifecycleListener,
+                         GraphStateBackend::ICallback,
+                         StabilizerTableauBackend::ICallback,
+                         PauliFrameBackend::ICallback,
+                         DensityMatrixBackend::ICallback,
+                         HybridBackend::ICallback {
  public:
   BackendContainer();
   ~BackendContainer();
@@ -22,10 +40,23 @@ class BackendContainer : public omnetpp::cSimpleModule, GraphStateBackend::ICall
 
   IQuantumBackend* getQuantumBackend();
   void willUpdate(GraphStateBackend& backend) override;
+  void willUpdate(StabilizerTableauBackend& backend) override;
+  void willUpdate(PauliFrameBackend& backend) override;
+  void willUpdate(DensityMatrixBackend& backend) override;
+  void willUpdate(HybridBackend& backend) override;
+  // the graph state backend updates its time once per event while the simulation executes the events
+  void lifecycleEvent(omnetpp::SimulationLifecycleEventType event_type, omnetpp::cObject* details) override;
 
  protected:
+  std::unique_ptr<IRandomNumberGenerator> createRNG();
   std::unique_ptr<StationaryQubitConfiguration> getDefaultQubitErrorModelConfiguration();
   std::unique_ptr<IQuantumBackend> backend = nullptr;
+  std::ofstream trace_file;
+  std::unique_ptr<backends::trace::TraceWriter> trace_writer;
+  std::ofstream statistics_file;
+  // counts the backend clock updates, i.e. the operations, for the event being handled
+  SharedResource::EventProfiler* event_profiler = nullptr;
+  bool listens_lifecycle = false;
 };
 
 Define_Module(BackendContainer);
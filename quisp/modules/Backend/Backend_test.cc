@@ -7,7 +7,11 @@
 namespace {
 using namespace quisp_test;
 using OriginalBackendContainer = quisp::modules::backend::BackendContainer;
+using quisp::modules::backend::DensityMatrixBackend;
 using quisp::modules::backend::GraphStateBackend;
+using quisp::modules::backend::HybridBackend;
+using quisp::modules::backend::PauliFrameBackend;
+using quisp::modules::backend::StabilizerTableauBackend;
 using quisp::modules::backend::StationaryQubitConfiguration;
 
 class BackendContainer : public OriginalBackendContainer {
@@ -54,6 +58,14 @@ class BackendContainerTest : public ::testing::Test {
     setParDouble(backend, "memory_energy_excitation_rate", .27);
     setParDouble(backend, "memory_energy_relaxation_rate", .28);
     setParDouble(backend, "memory_completely_mixed_rate", .29);
+    setParInt(backend, "short_live_qubit_pool_size", 0);
+    setParStr(backend, "rng_type", "omnetpp");
+    setParInt(backend, "rng_buffer_size", 1024);
+    setParInt(backend, "local_complement_threads", 1);
+    setParInt(backend, "parallel_local_complement_degree", 128);
+    setParBool(backend, "lazy_memory_error", false);
+    setParStr(backend, "trace_file", "");
+    setParStr(backend, "memory_resource", "global");
     sim->registerComponent(backend);
   }
   virtual void TearDown() {}
@@ -87,6 +99,102 @@ TEST_F(BackendContainerTest, getGsQuantumBackend) {
   EXPECT_NE(gs_backend, nullptr);
 }
 
+TEST_F(BackendContainerTest, gsBackendUpdatesTimeOncePerEvent) {
+  setParStr(backend, "backend_type", "GraphStateBackend");
+  backend->callInitialize();
+  auto *gs_backend = dynamic_cast<GraphStateBackend *>(backend->getQuantumBackend());
+  ASSERT_NE(gs_backend, nullptr);
+
+  backend->lifecycleEvent(omnetpp::LF_ON_SIMULATION_START, nullptr);
+  EXPECT_EQ(gs_backend->getSimTime(), omnetpp::simTime());
+  // the time is taken once in the event, the later calls keep it
+  gs_backend->setSimTime(omnetpp::SimTime(1, omnetpp::SIMTIME_S));
+  EXPECT_EQ(gs_backend->getSimTime(), omnetpp::SimTime(1, omnetpp::SIMTIME_S));
+
+  // finish() updates the time on each call again
+  backend->lifecycleEvent(omnetpp::LF_PRE_NETWORK_FINISH, nullptr);
+  EXPECT_EQ(gs_backend->getSimTime(), omnetpp::simTime());
+}
+
+TEST_F(BackendContainerTest, callInitializeWithPhiloxRNG) {
+  setParStr(backend, "backend_type", "GraphStateBackend");
+  setParStr(backend, "rng_type", "philox");
+  backend->callInitialize();
+  EXPECT_NE(backend->backend, nullptr);
+}
+
+TEST_F(BackendContainerTest, callInitializeWithPoolMemoryResource) {
+  setParStr(backend, "backend_type", "GraphStateBackend");
+  setParStr(backend, "memory_resource", "pool");
+  setParInt(backend, "short_live_qubit_pool_size", 4);
+  backend->callInitialize();
+  auto *gs_backend = dynamic_cast<GraphStateBackend *>(backend->getQuantumBackend());
+  ASSERT_NE(gs_backend, nullptr);
+  EXPECT_NE(gs_backend->getNeighborMemoryResource(), std::pmr::new_delete_resource());
+}
+
+TEST_F(BackendContainerTest, callInitializeWithInvalidMemoryResource) {
+  setParStr(backend, "backend_type", "GraphStateBackend");
+  setParStr(backend, "memory_resource", "SomeInvalidResource");
+  EXPECT_THROW(backend->callInitialize(), omnetpp::cRuntimeError);
+}
+
+TEST_F(BackendContainerTest, callInitializeWithInvalidRNG) {
+  setParStr(backend, "backend_type", "GraphStateBackend");
+  setParStr(backend, "rng_type", "SomeInvalidRNG");
+  EXPECT_THROW(backend->callInitialize(), omnetpp::cRuntimeError);
+}
+
+TEST_F(BackendContainerTest, getStQuantumBackend) {
+  setParStr(backend, "backend_type", "StabilizerTableauBackend");
+  backend->callInitialize();
+  ASSERT_NE(backend->backend, nullptr);
+  auto *b = backend->getQuantumBackend();
+  ASSERT_NE(b, nullptr);
+  auto *st_backend = dynamic_cast<StabilizerTableauBackend *>(b);
+  EXPECT_NE(st_backend, nullptr);
+}
+
+TEST_F(BackendContainerTest, getPfQuantumBackend) {
+  setParStr(backend, "backend_type", "PauliFrameBackend");
+  backend->callInitialize();
+  ASSERT_NE(backend->backend, nullptr);
+  auto *b = backend->getQuantumBackend();
+  ASSERT_NE(b, nullptr);
+  auto *pf_backend = dynamic_cast<PauliFrameBackend *>(b);
+  EXPECT_NE(pf_backend, nullptr);
+}
+
+TEST_F(BackendContainerTest, getDmQuantumBackend) {
+  setParStr(backend, "backend_type", "DensityMatrixBackend");
+  backend->callInitialize();
+  ASSERT_NE(backend->backend, nullptr);
+  auto *b = backend->getQuantumBackend();
+  ASSERT_NE(b, nullptr);
+  auto *dm_backend = dynamic_cast<DensityMatrixBackend *>(b);
+  EXPECT_NE(dm_backend, nullptr);
+}
+
+TEST_F(BackendContainerTest, getHybridQuantumBackend) {
+  setParStr(backend, "backend_type", "HybridBackend");
+  backend->callInitialize();
+  ASSERT_NE(backend->backend, nullptr);
+  auto *b = backend->getQuantumBackend();
+  ASSERT_NE(b, nullptr);
+  auto *hybrid_backend = dynamic_cast<HybridBackend *>(b);
+  EXPECT_NE(hybrid_backend, nullptr);
+}
+
+TEST_F(BackendContainerTest, preallocateShortLiveQubits) {
+  setParStr(backend, "backend_type", "GraphStateBackend");
+  setParInt(backend, "short_live_qubit_pool_size", 4);
+  backend->callInitialize();
+  auto *b = backend->getQuantumBackend();
+  auto *photon = b->getShortLiveQubit();
+  ASSERT_NE(photon, nullptr);
+  EXPECT_NE(b->getShortLiveQubit(), photon);
+}
+
 TEST_F(BackendContainerTest, getGsQuantumBackendWithoutInit) {
   setParStr(backend, "backend_type", "GraphStateBackend");
   ASSERT_EQ(backend->backend, nullptr);
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace quisp::modules::backend::rng {
+
+/**
+ * @brief Philox4x32-10 counter-based generator (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC'11).
+ *
+ * The output of a counter depends only on the counter and the key, so a block of numbers is
+ * generated without a sequential state update between them.
+ */
+class Philox4x32 {
+ public:
+  using Counter = std::array<uint32_t, 4>;
+  using Key = std::array<uint32_t, 2>;
+
+  explicit Philox4x32(Key key) : key(key) {}
+  explicit Philox4x32(uint64_t seed) : key{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)} {}
+
+  // the 4 words of the counter
+  static Counter block(Counter counter, Key key) {
+    for (int round = 0; round < 10; round++) {
+      counter = roundOf(counter, key);
+      key[0] += 0x9E3779B9;
+      key[1] += 0xBB67AE85;
+    }
+    return counter;
+  }
+
+  /**
+   * @brief fills values with n uniform doubles in [0, 1), 53 bits each, and advances the counter.
+   *
+   * Each counter gives two doubles; when n is odd the last one is dropped, so the sequence
+   * depends on how the draws are split into calls. BufferedRNG always fills whole buffers.
+   */
+  void fill(double *values, std::size_t n) {
+    std::size_t i = 0;
+    while (i < n) {
+      // generate the words first and convert them in a separate loop the compiler can vectorize
+      constexpr std::size_t max_chunk = 128;
+      uint32_t words[max_chunk][2];
+      std::size_t chunk = (n - i) < max_chunk ? (n - i) : max_chunk;
+      for (std::size_t j = 0; j < chunk; j += 2) {
+        auto out = block(counter, key);
+        increment();
+        words[j][0] = out[0];
+        words[j][1] = out[1];
+        words[j + 1][0] = out[2];
+        words[j + 1][1] = out[3];
+      }
+      for (std::size_t j = 0; j < chunk; j++) values[i + j] = toUnit(words[j][0], words[j][1]);
+      i += chunk;
+    }
+  }
+
+  const Counter &getCounter() const { return counter; }
+
+  // the uniform double in [0, 1) of the upper 53 bits of two words
+  static double toUnit(uint32_t high, uint32_t low) {
+    constexpr double two_to_minus_53 = 1.0 / 9007199254740992.0;
+    return static_cast<double>((static_cast<uint64_t>(high) << 32 | low) >> 11) * two_to_minus_53;
+  }
+
+ private:
+  static Counter roundOf(const Counter &c, const Key &k) {
+    uint64_t p0 = static_cast<uint64_t>(0xD2511F53) * c[0];
+    uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57) * c[2];
+    return {static_cast<uint32_t>(p1 >> 32) ^ c[1] ^ k[0], static_cast<uint32_t>(p1), static_cast<uint32_t>(p0 >> 32) ^ c[3] ^ k[1], static_cast<uint32_t>(p0)};
+  }
+  void increment() {
+    for (auto &word : counter) {
+      if (++word != 0) break;
+    }
+  }
+
+  Key key;
+  Counter counter = {0, 0, 0, 0};
+};
+
+}  // namespace quisp::modules::backend::rng
@@ -0,0 +1,72 @@
+#include "Philox.h"
+#include <gtest/gtest.h>
+#include <vector>
+#include "RNG.h"
+
+namespace {
+using quisp::modules::backend::rng::BufferedRNG;
+using quisp::modules::backend::rng::Philox4x32;
+using quisp::modules::backend::rng::StreamRNG;
+
+TEST(PhiloxTest, KnownAnswers) {
+  // the known answer tests of Random123
+  EXPECT_EQ(Philox4x32::block({0, 0, 0, 0}, {0, 0}), (Philox4x32::Counter{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+  EXPECT_EQ(Philox4x32::block({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff}),
+            (Philox4x32::Counter{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}));
+  EXPECT_EQ(Philox4x32::block({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0}),
+            (Philox4x32::Counter{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}));
+}
+
+TEST(PhiloxTest, UniformInUnitInterval) {
+  Philox4x32 generator(1);
+  std::vector<double> values(10000);
+  generator.fill(values.data(), values.size());
+  double sum = 0;
+  for (auto v : values) {
+    ASSERT_GE(v, 0);
+    ASSERT_LT(v, 1);
+    sum += v;
+  }
+  EXPECT_NEAR(sum / values.size(), 0.5, 0.02);
+}
+
+TEST(BufferedRNGTest, SameSequenceRegardlessOfTheDraws) {
+  BufferedRNG one_by_one(42, 6), in_batches(42, 1024);
+  std::vector<double> a(3000), b(3000);
+  for (auto &v : a) v = one_by_one.doubleRandom();
+  in_batches.doubleRandoms(b.data(), 1001);
+  in_batches.doubleRandoms(b.data() + 1001, 1999);
+  EXPECT_EQ(a, b);
+
+  BufferedRNG other_seed(43, 1024);
+  EXPECT_NE(other_seed.doubleRandom(), a[0]);
+}
+
+TEST(StreamRNGTest, StreamsAreIndependentOfTheOrder) {
+  auto stream_a = StreamRNG::streamId(1, 0, 0, 3);
+  auto stream_b = StreamRNG::streamId(1, 0, 0, 4);
+  EXPECT_NE(stream_a, stream_b);
+
+  // a alone, and a interleaved with b
+  StreamRNG a(7, stream_a), a_interleaved(7, stream_a), b(7, stream_b);
+  std::vector<double> alone, interleaved;
+  for (int i = 0; i < 5; i++) alone.push_back(a.doubleRandom());
+  for (int i = 0; i < 5; i++) {
+    b.doubleRandom();
+    interleaved.push_back(a_interleaved.doubleRandom());
+    b.doubleRandom();
+  }
+  EXPECT_EQ(alone, interleaved);
+  EXPECT_NE(StreamRNG(7, stream_b).doubleRandom(), alone[0]);
+  EXPECT_NE(StreamRNG(8, stream_a).doubleRandom(), alone[0]);
+}
+
+TEST(StreamRNGTest, StreamIdRange) {
+  EXPECT_NE(StreamRNG::streamId(1, -1, -1, -1), StreamRNG::streamId(1, 0, -1, -1));
+  EXPECT_NE(StreamRNG::streamId(1, 0, 0, -1), StreamRNG::streamId(2, 0, 0, -1));
+  EXPECT_NO_THROW(StreamRNG::streamId(1, 2, 1022, (1 << 20) - 2));
+  EXPECT_THROW(StreamRNG::streamId(1, 0, 1023, 0), std::invalid_argument);
+  EXPECT_THROW(StreamRNG::streamId(1, 0, 0, 1 << 20), std::invalid_argument);
+}
+
+}  // namespace
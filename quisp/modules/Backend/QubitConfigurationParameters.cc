@@ -0,0 +1,29 @@
+#include "QubitConfigurationParameters.h"
+#include <string_view>
+#include <unordered_map>
+
+namespace quisp::modules::backend {
+using quisp::backends::StationaryQubitConfiguration;
+
+namespace {
+using Field = double StationaryQubitConfiguration::*;
+const std::unordered_map<std::string_view, Field> &fieldsByName() {
+  static const std::unordered_map<std::string_view, Field> fields = [] {
+    std::unordered_map<std::string_view, Field> fields;
+    for (auto &param : StationaryQubitConfiguration::parameters()) fields.emplace(param.name, param.field);
+    return fields;
+  }();
+  return fields;
+}
+}  // namespace
+
+void readQubitConfiguration(const omnetpp::cComponent *component, StationaryQubitConfiguration &conf) {
+  auto &fields = fieldsByName();
+  for (int i = 0; i < component->getNumParams(); i++) {
+    const auto &param = component->par(i);
+    auto it = fields.find(param.getName());
+    if (it != fields.end()) conf.*(it->second) = param.doubleValue();
+  }
+}
+
+}  // namespace quisp::modules::backend
@@ -0,0 +1,16 @@
+#pragma once
+#include <omnetpp.h>
+#include "backends/QubitConfiguration.h"
+
+namespace quisp::modules::backend {
+
+/**
+ * @brief overwrites the fields of conf with the error model parameters that component has.
+ *
+ * It goes through the parameters of component once and finds each field by name,
+ * instead of looking up every parameter of StationaryQubitConfiguration::parameters() by name.
+ * The fields without a parameter keep their values.
+ */
+void readQubitConfiguration(const omnetpp::cComponent *component, quisp::backends::StationaryQubitConfiguration &conf);
+
+}  // namespace quisp::modules::backend
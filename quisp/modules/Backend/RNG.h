@@ -2,14 +2,101 @@
 
 #include <backends/Backends.h>
 #include <omnetpp.h>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include "Philox.h"
 
 namespace quisp::modules::backend::rng {
+// the RNG of a module or a channel
 class RNG : public backends::abstract::IRandomNumberGenerator {
  public:
-  RNG(omnetpp::cModule* module) : module(module) {}
-  double doubleRandom() override { return module->dblrand(); }
+  RNG(omnetpp::cComponent* component) : component(component) {}
+  double doubleRandom() override { return component->dblrand(); }
 
  private:
-  omnetpp::cModule* module;
+  omnetpp::cComponent* component;
+};
+
+/**
+ * @brief draws from Philox4x32 a buffer of uniforms at a time, instead of a call into the OMNeT++ RNG per number.
+ *
+ * The numbers depend only on the seed, not on how they are drawn, so a run is reproducible per OMNeT++ seed.
+ */
+class BufferedRNG : public backends::abstract::IRandomNumberGenerator {
+ public:
+  BufferedRNG(uint64_t seed, std::size_t buffer_size = 1024) : generator(seed), buffer(std::max<std::size_t>(buffer_size + buffer_size % 2, 2)), next(buffer.size()) {}
+  // seeded from the OMNeT++ RNG of the module
+  BufferedRNG(omnetpp::cModule* module, std::size_t buffer_size = 1024)
+      : BufferedRNG(static_cast<uint64_t>(module->getRNG(0)->intRand()) << 32 | module->getRNG(0)->intRand(), buffer_size) {}
+
+  double doubleRandom() override {
+    if (next == buffer.size()) refill();
+    return buffer[next++];
+  }
+
+  void doubleRandoms(double* values, std::size_t n) override {
+    while (n > 0) {
+      if (next == buffer.size()) refill();
+      auto count = std::min(n, buffer.size() - next);
+      std::copy_n(buffer.data() + next, count, values);
+      next += count;
+      values += count;
+      n -= count;
+    }
+  }
+
+ private:
+  void refill() {
+    generator.fill(buffer.data(), buffer.size());
+    next = 0;
+  }
+
+  Philox4x32 generator;
+  std::vector<double> buffer;  // of an even size, so no number of the generator is dropped
+  std::size_t next;
+};
+/**
+ * @brief the numbers of one stream, e.g. of a qubit, from Philox4x32 keyed by the seed.
+ *
+ * The n-th number of a stream depends only on the seed, the stream and n, not on the draws of the other
+ * streams, so the results don't depend on how the events of different streams are ordered or partitioned.
+ */
+class StreamRNG : public backends::abstract::IRandomNumberGenerator {
+ public:
+  StreamRNG(uint64_t seed, uint64_t stream) : key{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)}, stream(stream) {}
+
+  double doubleRandom() override {
+    if (has_spare) {
+      has_spare = false;
+      return spare;
+    }
+    auto words = Philox4x32::block({static_cast<uint32_t>(draws), static_cast<uint32_t>(draws >> 32), static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32)}, key);
+    draws++;
+    spare = Philox4x32::toUnit(words[2], words[3]);
+    has_spare = true;
+    return Philox4x32::toUnit(words[0], words[1]);
+  }
+
+  /**
+   * @brief the stream of a qubit, a QNIC (qubit_index = -1) or a node (qnic_type = qnic_index = qubit_index = -1).
+   *
+   * It packs the 32 bits node address, 2 bits qnic type, 10 bits qnic index and 20 bits qubit index.
+   */
+  static uint64_t streamId(int node_addr, int qnic_type, int qnic_index, int qubit_index) {
+    uint64_t type = qnic_type + 1, qnic = qnic_index + 1, qubit = qubit_index + 1;
+    if (qnic_type < -1 || type >= (1 << 2) || qnic_index < -1 || qnic >= (1 << 10) || qubit_index < -1 || qubit >= (1 << 20)) {
+      throw std::invalid_argument("StreamRNG::streamId: the qnic or the qubit index is out of range");
+    }
+    return static_cast<uint64_t>(static_cast<uint32_t>(node_addr)) << 32 | type << 30 | qnic << 20 | qubit;
+  }
+
+ private:
+  Philox4x32::Key key;
+  uint64_t stream;
+  uint64_t draws = 0;
+  // the second number of the last block
+  double spare = 0;
+  bool has_spare = false;
 };
 }  // namespace quisp::modules::backend::rng
@@ -0,0 +1,64 @@
+#include "PriorityScheduler.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace quisp::modules::queue_scheduling {
+
+PriorityScheduler::Policy PriorityScheduler::parsePolicy(const std::string &name) {
+  if (name == "strict_priority") return Policy::StrictPriority;
+  if (name == "weighted_fair") return Policy::WeightedFair;
+  throw std::invalid_argument("unknown queue scheduling policy: " + name);
+}
+
+PriorityScheduler::PriorityScheduler(Policy policy, std::vector<int> weights) : policy(policy), weights(std::move(weights)), current_weights(this->weights.size(), 0) {
+  if (this->weights.empty()) throw std::invalid_argument("PriorityScheduler: no priority class");
+  if (policy != Policy::WeightedFair) return;
+  for (auto weight : this->weights) {
+    if (weight <= 0) throw std::invalid_argument("PriorityScheduler: the weights must be positive");
+  }
+}
+
+int PriorityScheduler::next(const std::vector<std::size_t> &queue_lengths) {
+  int num_classes = weights.size();
+  if (policy == Policy::StrictPriority) {
+    for (int i = 0; i < num_classes; i++) {
+      if (queue_lengths[i] > 0) return i;
+    }
+    return -1;
+  }
+  int selected = -1;
+  long total_weight = 0;
+  for (int i = 0; i < num_classes; i++) {
+    if (queue_lengths[i] == 0) continue;
+    current_weights[i] += weights[i];
+    total_weight += weights[i];
+    // the tie goes to the higher priority
+    if (selected == -1 || current_weights[i] > current_weights[selected]) selected = i;
+  }
+  if (selected != -1) current_weights[selected] -= total_weight;
+  return selected;
+}
+
+std::unordered_map<std::string, int> parseMessageClassMap(const std::string &class_map, int num_classes) {
+  std::unordered_map<std::string, int> classes;
+  std::istringstream entries(class_map);
+  for (std::string entry; entries >> entry;) {
+    auto separator = entry.rfind(':');
+    if (separator == std::string::npos || separator == 0) throw std::invalid_argument("malformed class map entry: " + entry);
+    int priority_class;
+    try {
+      std::size_t parsed;
+      priority_class = std::stoi(entry.substr(separator + 1), &parsed);
+      if (parsed != entry.size() - separator - 1) throw std::invalid_argument(entry);
+    } catch (const std::logic_error &) {
+      throw std::invalid_argument("malformed class map entry: " + entry);
+    }
+    if (priority_class < 0 || priority_class >= num_classes) throw std::invalid_argument("priority class out of range: " + entry);
+    classes[entry.substr(0, separator)] = priority_class;
+  }
+  return classes;
+}
+
+}  // namespace quisp::modules::queue_scheduling
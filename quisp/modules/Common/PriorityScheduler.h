@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace quisp::modules::queue_scheduling {
+
+/**
+ * @brief PriorityScheduler picks the priority class a Queue transmits next.
+ *
+ * The class 0 has the highest priority. StrictPriority always serves the highest non-empty class,
+ * WeightedFair serves the non-empty classes in proportion to their weights by the smooth weighted round robin,
+ * so that a class doesn't starve under the load of the higher classes.
+ */
+class PriorityScheduler {
+ public:
+  enum class Policy { StrictPriority, WeightedFair };
+  /// @throws std::invalid_argument for an unknown policy.
+  static Policy parsePolicy(const std::string &name);
+
+  /// @throws std::invalid_argument if there is no class or the policy is WeightedFair and a weight is not positive.
+  PriorityScheduler(Policy policy, std::vector<int> weights);
+
+  /// @brief returns the class to dequeue next, or -1 if every queue is empty.
+  int next(const std::vector<std::size_t> &queue_lengths);
+  std::size_t numClasses() const { return weights.size(); }
+
+ private:
+  Policy policy;
+  std::vector<int> weights;
+  std::vector<long> current_weights;
+};
+
+/**
+ * @brief parses the class map "MessageA:0 MessageB:2" into the class of the message class names.
+ *
+ * @throws std::invalid_argument for a malformed entry or a class out of [0, num_classes).
+ */
+std::unordered_map<std::string, int> parseMessageClassMap(const std::string &class_map, int num_classes);
+
+}  // namespace quisp::modules::queue_scheduling
@@ -0,0 +1,56 @@
+#include "PriorityScheduler.h"
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+using namespace quisp::modules::queue_scheduling;
+
+TEST(PrioritySchedulerTest, StrictPriority) {
+  PriorityScheduler scheduler{PriorityScheduler::Policy::StrictPriority, {1, 1, 1}};
+  EXPECT_EQ(scheduler.next({0, 0, 0}), -1);
+  EXPECT_EQ(scheduler.next({0, 3, 5}), 1);
+  EXPECT_EQ(scheduler.next({1, 3, 5}), 0);
+  EXPECT_EQ(scheduler.next({0, 0, 5}), 2);
+}
+
+TEST(PrioritySchedulerTest, WeightedFair) {
+  PriorityScheduler scheduler{PriorityScheduler::Policy::WeightedFair, {4, 2, 1}};
+  std::vector<int> served(3, 0);
+  for (int i = 0; i < 70; i++) served[scheduler.next({10, 10, 10})]++;
+  EXPECT_EQ(served, (std::vector<int>{40, 20, 10}));
+
+  // the empty classes are skipped and don't accumulate the credit
+  for (int i = 0; i < 6; i++) EXPECT_EQ(scheduler.next({0, 0, 1}), 2);
+  EXPECT_EQ(scheduler.next({0, 0, 0}), -1);
+
+  // the lowest class is served even under the load of the higher classes
+  std::vector<int> first_seven(3, 0);
+  for (int i = 0; i < 7; i++) first_seven[scheduler.next({10, 10, 10})]++;
+  EXPECT_EQ(first_seven, (std::vector<int>{4, 2, 1}));
+}
+
+TEST(PrioritySchedulerTest, InvalidConfiguration) {
+  EXPECT_THROW(PriorityScheduler::parsePolicy("fifo"), std::invalid_argument);
+  EXPECT_EQ(PriorityScheduler::parsePolicy("weighted_fair"), PriorityScheduler::Policy::WeightedFair);
+  EXPECT_THROW((PriorityScheduler{PriorityScheduler::Policy::StrictPriority, {}}), std::invalid_argument);
+  EXPECT_THROW((PriorityScheduler{PriorityScheduler::Policy::WeightedFair, {2, 0}}), std::invalid_argument);
+}
+
+TEST(PrioritySchedulerTest, ParseMessageClassMap) {
+  auto classes = parseMessageClassMap(" SwappingResult:0  OspfHelloPacket:2\nLinkTomographyResult:1 ", 3);
+  EXPECT_EQ(classes.size(), 3);
+  EXPECT_EQ(classes.at("SwappingResult"), 0);
+  EXPECT_EQ(classes.at("LinkTomographyResult"), 1);
+  EXPECT_EQ(classes.at("OspfHelloPacket"), 2);
+  EXPECT_TRUE(parseMessageClassMap("", 3).empty());
+
+  EXPECT_THROW(parseMessageClassMap("SwappingResult", 3), std::invalid_argument);
+  EXPECT_THROW(parseMessageClassMap(":1", 3), std::invalid_argument);
+  EXPECT_THROW(parseMessageClassMap("SwappingResult:x", 3), std::invalid_argument);
+  EXPECT_THROW(parseMessageClassMap("SwappingResult:1x", 3), std::invalid_argument);
+  EXPECT_THROW(parseMessageClassMap("SwappingResult:3", 3), std::invalid_argument);
+}
+
+}  // namespace
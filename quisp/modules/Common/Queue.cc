@@ -5,13 +5,15 @@
  */
 
 #include "Queue.h"
+#include <stdexcept>
+#include <typeinfo>
+#include "utils/ComponentProvider.h"
+#include "utils/Headless.h"
 
 namespace quisp {
 namespace modules {
 
 void Queue::initialize() {
-  queue.setName("queue");
-
   end_transmission_event = new cMessage("endTxEvent");
 
   if (par("useCutThroughSwitching")) {
@@ -19,6 +21,32 @@ void Queue::initialize() {
   }
 
   frame_capacity = par("frame_capacity");
+  record_summaries = par("record_summaries");
+
+  int num_classes = par("num_classes");
+  default_class = par("default_class");
+  if (num_classes <= 0) error("num_classes must be positive: %d", num_classes);
+  if (default_class < 0 || default_class >= num_classes) error("default_class %d is out of the %d classes", default_class, num_classes);
+  std::vector<int> weights = cStringTokenizer(par("class_weights").stringValue()).asIntVector();
+  if (weights.empty()) weights.assign(num_classes, 1);
+  class_frame_capacities = std::vector<long>(num_classes, frame_capacity);
+  auto capacities = cStringTokenizer(par("class_frame_capacities").stringValue()).asIntVector();
+  if (!capacities.empty()) {
+    if ((int)capacities.size() != num_classes) error("class_frame_capacities needs %d values but %d given", num_classes, (int)capacities.size());
+    class_frame_capacities.assign(capacities.begin(), capacities.end());
+  }
+  if ((int)weights.size() != num_classes) error("class_weights needs %d values but %d given", num_classes, (int)weights.size());
+  try {
+    scheduler = std::make_unique<queue_scheduling::PriorityScheduler>(queue_scheduling::PriorityScheduler::parsePolicy(par("scheduling").stdstringValue()), weights);
+    message_classes = queue_scheduling::parseMessageClassMap(par("class_map").stdstringValue(), num_classes);
+  } catch (const std::invalid_argument &e) {
+    error("%s", e.what());
+  }
+  for (int i = 0; i < num_classes; i++) {
+    class_queues.push_back(std::make_unique<cQueue>(("queue-" + std::to_string(i)).c_str()));
+    class_qlen_signals.push_back(registerClassSignal("classQlen", i));
+    class_drop_signals.push_back(registerClassSignal("classDrop", i));
+  }
 
   qlen_signal = registerSignal("qlen");
   busy_signal = registerSignal("busy");
@@ -28,9 +56,51 @@ void Queue::initialize() {
   tx_bytes_signal = registerSignal("txBytes");
   rx_bytes_signal = registerSignal("rxBytes");
 
-  emit(qlen_signal, queue.getLength());
+  emit(qlen_signal, queue_length);
   emit(busy_signal, false);
   is_busy = false;
+  updateQueueLength();
+
+  utils::ComponentProvider provider{this};
+  if (auto *memory_accounting = provider.getMemoryAccounting()) {
+    // the bytes are the message objects at least, without their own fields
+    memory_accounting->addReporter([this](SharedResource::MemoryAccounting::Usage &usage) { usage["queued messages"] += {(std::size_t)queue_length, queue_length * sizeof(cPacket)}; });
+  }
+}
+
+simsignal_t Queue::registerClassSignal(const char *name, int priority_class) {
+  std::string signal_name = std::string(name) + "-" + std::to_string(priority_class);
+  simsignal_t signal = registerSignal(signal_name.c_str());
+  cProperty *statistic_template = getProperties()->get("statisticTemplate", name);
+  if (statistic_template != nullptr) getEnvir()->addResultRecorders(this, signal, signal_name.c_str(), statistic_template);
+  return signal;
+}
+
+int Queue::classOf(cMessage *msg) {
+  auto type = std::type_index(typeid(*msg));
+  auto cached = class_by_type.find(type);
+  if (cached != class_by_type.end()) return cached->second;
+
+  std::string class_name = msg->getClassName();
+  auto separator = class_name.rfind("::");
+  if (separator != std::string::npos) class_name = class_name.substr(separator + 2);
+  auto it = message_classes.find(class_name);
+  int priority_class = it == message_classes.end() ? default_class : it->second;
+  class_by_type.emplace(type, priority_class);
+  return priority_class;
+}
+
+cMessage *Queue::popNext() {
+  std::vector<std::size_t> lengths;
+  lengths.reserve(class_queues.size());
+  for (auto &queue : class_queues) lengths.push_back(queue->getLength());
+  int priority_class = scheduler->next(lengths);
+  if (priority_class == -1) return nullptr;
+  auto *msg = (cMessage *)class_queues[priority_class]->pop();
+  queue_length--;
+  updateQueueLength();
+  emit(class_qlen_signals[priority_class], class_queues[priority_class]->getLength());
+  return msg;
 }
 
 void Queue::startTransmitting(cMessage *msg) {
@@ -49,7 +119,7 @@ void Queue::startTransmitting(cMessage *msg) {
 }
 
 void Queue::handleMessage(cMessage *msg) {
-  if (hasGUI()) {
+  if (utils::showsGUI(this)) {
     bubble("Queue received a message!\n");
   }
 
@@ -58,14 +128,15 @@ void Queue::handleMessage(cMessage *msg) {
     EV_INFO << "Transmission finished.\n";
     is_busy = false;
 
-    if (queue.isEmpty()) {
+    msg = popNext();
+    if (msg == nullptr) {
       emit(busy_signal, false);
       return;
     }
 
-    msg = (cMessage *)queue.pop();
     emit(queuing_time_signal, simTime() - msg->getTimestamp());
-    emit(qlen_signal, queue.getLength());
+    if (record_summaries) queueing_time_histogram.record((simTime() - msg->getTimestamp()).dbl());
+    emit(qlen_signal, queue_length);
     startTransmitting(msg);
     return;
   }
@@ -83,32 +154,53 @@ void Queue::handleMessage(cMessage *msg) {
     EV_INFO << "Currently busy! queue it up\n";
 
     // We are currently busy, so just queue up the packet.
-    if (frame_capacity && queue.getLength() >= frame_capacity) {
-      EV_INFO << "Received " << msg << " but transmitter busy and queue full: discarding\n";
-      emit(drop_signal, (long)check_and_cast<cPacket *>(msg)->getByteLength());
+    int priority_class = classOf(msg);
+    auto &queue = class_queues[priority_class];
+    if (class_frame_capacities[priority_class] && queue->getLength() >= class_frame_capacities[priority_class]) {
+      EV_INFO << "Received " << msg << " but transmitter busy and queue of class " << priority_class << " full: discarding\n";
+      long num_bytes = check_and_cast<cPacket *>(msg)->getByteLength();
+      emit(drop_signal, num_bytes);
+      emit(class_drop_signals[priority_class], num_bytes);
+      num_dropped++;
       delete msg;
       return;
     }
 
-    EV_INFO << "Received " << msg << " but transmitter busy: queuing up\n";
+    EV_INFO << "Received " << msg << " but transmitter busy: queuing up in class " << priority_class << "\n";
     msg->setTimestamp();
-    queue.insert(msg);
-    emit(qlen_signal, queue.getLength());
+    queue->insert(msg);
+    queue_length++;
+    updateQueueLength();
+    emit(qlen_signal, queue_length);
+    emit(class_qlen_signals[priority_class], queue->getLength());
     return;
   }
 
   // We are idle, so we can start transmitting right away.
   EV_INFO << "Received " << msg << endl;
   emit(queuing_time_signal, SIMTIME_ZERO);
+  if (record_summaries) queueing_time_histogram.record(0);
   startTransmitting(msg);
   emit(busy_signal, true);
 }
 
-void Queue::finish() { cancelAndDelete(end_transmission_event); }
+void Queue::updateQueueLength() {
+  if (record_summaries) queue_length_average.update(simTime().dbl(), queue_length);
+}
+
+void Queue::finish() {
+  cancelAndDelete(end_transmission_event);
+  if (!record_summaries) return;
+  queueing_time_histogram.forEachSummary([this](const std::string &suffix, double value) { recordScalar(("queueing time" + suffix).c_str(), value, suffix == ":count" ? nullptr : "s"); });
+  recordScalar("queue length:timeavg", queue_length_average.average(simTime().dbl()));
+  recordScalar("queue length:max", queue_length_average.max());
+  recordScalar("dropped messages", num_dropped);
+}
 
 void Queue::refreshDisplay() const {
+  if (!utils::showsGUI(this)) return;
   getDisplayString().setTagArg("t", 0, is_busy ? "transmitting" : "idle");
-  getDisplayString().setTagArg("i", 1, is_busy ? (queue.getLength() >= 3 ? "red" : "yellow") : "");
+  getDisplayString().setTagArg("i", 1, is_busy ? (queue_length >= 3 ? "red" : "yellow") : "");
 }
 
 }  // namespace modules
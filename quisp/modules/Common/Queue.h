@@ -13,6 +13,14 @@
 #include <omnetpp.h>
 #include <stdio.h>
 #include <string.h>
+#include <memory>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+#include "PriorityScheduler.h"
+#include "utils/StreamingStats.h"
 
 using namespace omnetpp;
 
@@ -22,11 +30,20 @@ namespace modules {
 /** \class Queue Queue.cc
  *
  *  \brief Queue
+ *
+ *  The messages waiting for the transmitter are queued by their priority class, looked up by the message class name
+ *  in class_map. Each class has its own buffer, and the scheduling policy picks the class transmitted next.
  */
 class Queue : public cSimpleModule {
  private:
   long frame_capacity;
-  cQueue queue;
+  std::vector<std::unique_ptr<cQueue>> class_queues;
+  std::vector<long> class_frame_capacities;  // 0 means no limit
+  long queue_length = 0;  // of all the classes
+  std::unique_ptr<queue_scheduling::PriorityScheduler> scheduler;
+  std::unordered_map<std::string, int> message_classes;  // by the message class name without the namespace
+  std::unordered_map<std::type_index, int> class_by_type;  // cache of the lookup above
+  int default_class;
   cMessage *end_transmission_event;
   bool is_busy;
 
@@ -36,11 +53,22 @@ class Queue : public cSimpleModule {
   simsignal_t drop_signal;
   simsignal_t tx_bytes_signal;
   simsignal_t rx_bytes_signal;
+  std::vector<simsignal_t> class_qlen_signals;
+  std::vector<simsignal_t> class_drop_signals;
+  // the summaries recorded in finish() with record_summaries, instead of the vectors of the signals above
+  bool record_summaries;
+  utils::LogHistogram queueing_time_histogram;
+  utils::TimeWeightedAverage queue_length_average;
+  long num_dropped = 0;
   virtual void initialize() override;
   virtual void finish() override;
   virtual void handleMessage(cMessage *msg) override;
   virtual void refreshDisplay() const override;
   virtual void startTransmitting(cMessage *msg);
+  int classOf(cMessage *msg);
+  cMessage *popNext();
+  simsignal_t registerClassSignal(const char *name, int priority_class);
+  void updateQueueLength();
 };
 
 Define_Module(Queue);
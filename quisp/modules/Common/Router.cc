@@ -4,6 +4,9 @@
  *  \brief Router
  */
 #include "Router.h"
+#include <algorithm>
+#include <cstdint>
+#include "utils/Headless.h"
 #include "messages/BSA_ipc_messages_m.h"
 #include "messages/classical_messages.h"  //Path selection: type = 1, Timing notifier for BMA: type = 4
 #include "messages/link_generation_messages_m.h"
@@ -13,10 +16,32 @@ using namespace quisp::messages;
 
 namespace quisp::modules {
 
+namespace {
+// the finalizer of splitmix64, so the flows of nearby addresses and RuleSet ids spread evenly over the gates
+std::uint64_t mix(std::uint64_t x) {
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
+
+// the RuleSet of the results the RuleEngines exchange, 0 for the other packets
+unsigned long rulesetIdOf(const Header *pk) {
+  if (auto *result = dynamic_cast<const SwappingResult *>(pk)) return result->getRulesetId();
+  if (auto *batch = dynamic_cast<const SwappingResultBatch *>(pk)) return batch->getRulesetId();
+  if (auto *result = dynamic_cast<const PurificationResult *>(pk)) return result->getRulesetId();
+  if (auto *discarded = dynamic_cast<const BellPairDiscarded *>(pk)) return discarded->getRulesetId();
+  if (auto *result = dynamic_cast<const LinkTomographyResult *>(pk)) return result->getRuleset_id();
+  if (auto *stop = dynamic_cast<const LinkTomographyStop *>(pk)) return stop->getRuleset_id();
+  return 0;
+}
+}  // namespace
+
 Router::Router() : provider(utils::ComponentProvider{this}) {}
 
 void Router::initialize() {
+  event_profiler = provider.getEventProfiler();
   my_address = provider.getNodeAddr();
+  local_delivery = par("local_delivery").boolValue();
 
   // Topology creation for routing table
   auto topo = provider.getTopologyForRouter();
@@ -26,10 +51,10 @@ void Router::initialize() {
     return;
   }
 
-  generateRoutingTable(topo);
+  generateRoutingTable(topo, provider.getNextHopTableForRouter());
 }
 
-void Router::generateRoutingTable(cTopology *topo) {
+void Router::generateRoutingTable(cTopology *topo, const SharedResource::NextHopTable *next_hops) {
   cTopology::Node *thisNode = topo->getNodeFor(getParentModule());  // The parent node with this specific router
 
   // Traverse through all the destinations from the thisNode
@@ -38,22 +63,25 @@ void Router::generateRoutingTable(cTopology *topo) {
     // skip the node that is running this specific router app
     if (node == thisNode) continue;
 
-    // Apply dijkstra to each node to find all shortest paths.
-    topo->calculateWeightedSingleShortestPathsTo(topo->getNode(i));
+    // The next link in the shortest path towards the target node, shared with the other routers.
+    auto *next_link = next_hops->getNextHop(thisNode, node);
+    if (next_link == nullptr) continue;
 
-    // Overwrites getNumPaths() and so on.
-    // Check the number of shortest paths towards the target node.
-    // This may be more than 1 if multiple paths have the same minimum cost.
-
-    if (thisNode->getNumPaths() == 0) continue;
-
-    // Returns the next link/gate in the ith shortest paths towards the target node.
-    cGate *parentModuleGate = thisNode->getPath(0)->getLocalGate();
+    cGate *parentModuleGate = next_link->getLocalGate();
     int gateIndex = parentModuleGate->getIndex();
-    int address = topo->getNode(i)->getModule()->par("address");
+    int address = node->getModule()->par("address");
 
     // Store gate index per destination from this node
-    routing_table[address] = gateIndex;
+    routing_table.set(address, gateIndex);
+
+    if (par("equal_cost_multipath").boolValue()) {
+      std::vector<int> gate_indices;
+      for (auto *link : next_hops->getEqualCostNextHops(thisNode, node)) {
+        int index = link->getLocalGate()->getIndex();
+        if (std::find(gate_indices.begin(), gate_indices.end(), index) == gate_indices.end()) gate_indices.push_back(index);
+      }
+      if (gate_indices.size() > 1) multipath_table.set(address, std::move(gate_indices));
+    }
 
     if (strstr(parentModuleGate->getFullName(), "quantum")) {
       error("Classical routing table referring to quantum gates...");
@@ -61,84 +89,141 @@ void Router::generateRoutingTable(cTopology *topo) {
   }
 }
 
+const int *Router::findOutGateIndex(const Header *pk) const {
+  auto *gate_indices = multipath_table.find(pk->getDestAddr());
+  if (gate_indices == nullptr) return routing_table.find(pk->getDestAddr());
+  // salted by the address of this router, so the flows split at the next router don't all take the same gate again
+  auto flow = ((std::uint64_t)(std::uint32_t)pk->getSrcAddr() << 32) | (std::uint32_t)pk->getDestAddr();
+  auto hash = mix(mix(flow ^ mix(my_address)) ^ rulesetIdOf(pk));
+  return &(*gate_indices)[hash % gate_indices->size()];
+}
+
+bool Router::deliverLocally(Header *pk) {
+  if (!local_delivery || pk->getDestAddr() != my_address) return false;
+  Enter_Method_Silent("deliverLocally");
+  take(pk);
+  // the same dispatch as the packets arriving at the Router, but in the event of the sender
+  handleMessage(pk);
+  return true;
+}
+
+void sendToRouter(cSimpleModule *module, Header *pk, const char *gate_name) {
+  auto *gate = module->gate(gate_name);
+  auto *router = dynamic_cast<Router *>(gate->getPathEndGate()->getOwnerModule());
+  if (router != nullptr && router->deliverLocally(pk)) return;
+  module->send(pk, gate);
+}
+
 void Router::handleMessage(cMessage *msg) {
+  modules::SharedResource::EventProfiler::Scope profile(event_profiler, this, msg);
   const int unidentified_destination = -1;
   // check the header of the received package
   Header *pk = check_and_cast<Header *>(msg);
   int dest_addr = pk->getDestAddr();
   int who_are_you = pk->getKind();
+  const bool shows_gui = utils::showsGUI(this);
 
   // If destination is this node: Path selection
   if (dest_addr == my_address && who_are_you == 1) {
     send(pk, "toApp");
     return;
   } else if (dest_addr == my_address && dynamic_cast<BSMTimingNotification *>(msg)) {  // Timing for BSM
-    bubble("Timing Notifier from BSA (stand-alone or internal) received");
+    if (shows_gui) bubble("Timing Notifier from BSA (stand-alone or internal) received");
     send(pk, "rePort$o");  // send to Application locally
     return;
   } else if (dest_addr == my_address && dynamic_cast<EPPSTimingNotification *>(msg)) {  // Timing for BSM
-    bubble("Timing Notifier from EPPS received");
+    if (shows_gui) bubble("Timing Notifier from EPPS received");
     send(pk, "rePort$o");  // send to Application locally
     return;
   } else if (dest_addr == my_address && dynamic_cast<SingleClickResult *>(msg)) {
-    bubble("Single click result from BSA received");
+    if (shows_gui) bubble("Single click result from BSA received");
     send(pk, "rePort$o");
     return;
   } else if (dest_addr == my_address && dynamic_cast<MSMResult *>(msg)) {
-    bubble("MSM BSA result from partner RE received");
+    if (shows_gui) bubble("MSM BSA result from partner RE received");
     send(pk, "rePort$o");
     return;
   } else if (dest_addr == my_address && dynamic_cast<StopEPPSEmission *>(msg)) {
-    bubble("Stop EPPS emission signal received");
+    if (shows_gui) bubble("Stop EPPS emission signal received");
+    send(pk, "toApp");
+    return;
+  } else if (dest_addr == my_address && dynamic_cast<MSMMemoryExhausted *>(msg)) {
     send(pk, "toApp");
     return;
   } else if (dest_addr == my_address && dynamic_cast<ConnectionSetupRequest *>(msg)) {
-    bubble("Connection setup request received");
+    if (shows_gui) bubble("Connection setup request received");
     send(pk, "cmPort$o");
     return;
   } else if (dest_addr == my_address && dynamic_cast<ConnectionSetupResponse *>(msg)) {
-    bubble("Connection setup response received");
+    if (shows_gui) bubble("Connection setup response received");
     send(pk, "cmPort$o");
     return;
   } else if (dest_addr == my_address && dynamic_cast<RejectConnectionSetupRequest *>(msg)) {
-    bubble("Reject connection setup response received");
+    if (shows_gui) bubble("Reject connection setup response received");
     send(pk, "cmPort$o");
     return;
+  } else if (dest_addr == my_address && dynamic_cast<ConnectionSetupReleaseNotification *>(msg)) {
+    if (shows_gui) bubble("Connection setup release notification received");
+    send(pk, "cmPort$o");
+    return;
+  } else if (dest_addr == my_address && dynamic_cast<ConnectionRearm *>(msg)) {
+    send(pk, "rePort$o");
+    return;
   } else if (dest_addr == my_address && dynamic_cast<InternalRuleSetForwarding *>(msg)) {
-    bubble("Internal RuleSet Forwarding packet received");
+    if (shows_gui) bubble("Internal RuleSet Forwarding packet received");
+    send(pk, "rePort$o");
+    return;
+  } else if (dest_addr == my_address && dynamic_cast<InternalRuleSetTermination *>(msg)) {
     send(pk, "rePort$o");
     return;
   } else if (dest_addr == my_address && dynamic_cast<InternalRuleSetForwarding_Application *>(msg)) {
-    bubble("Internal RuleSet Forwarding Application packet received");
+    if (shows_gui) bubble("Internal RuleSet Forwarding Application packet received");
     send(pk, "rePort$o");
     return;
   } else if (dest_addr == my_address && dynamic_cast<SwappingResult *>(msg)) {
-    bubble("Swapping Result packet received");
+    if (shows_gui) bubble("Swapping Result packet received");
+    send(pk, "rePort$o");
+    return;
+  } else if (dest_addr == my_address && dynamic_cast<SwappingResultBatch *>(msg)) {
+    if (shows_gui) bubble("Swapping Result batch received");
     send(pk, "rePort$o");
     return;
   } else if (dest_addr == my_address && dynamic_cast<LinkTomographyRequest *>(msg)) {
-    bubble("Link tomography request received");
+    if (shows_gui) bubble("Link tomography request received");
     send(pk, "hmPort$o");
     return;
   } else if (dest_addr == my_address && dynamic_cast<LinkTomographyAck *>(msg)) {
-    bubble("Link tomography ack received");
+    if (shows_gui) bubble("Link tomography ack received");
     send(pk, "hmPort$o");
     return;
   } else if (dest_addr == my_address && dynamic_cast<LinkTomographyRuleSet *>(msg)) {
-    bubble("Link tomography rule set received");
+    if (shows_gui) bubble("Link tomography rule set received");
     send(pk, "rePort$o");
     return;
   } else if (dest_addr == my_address && dynamic_cast<LinkTomographyResult *>(msg)) {
-    bubble("Link tomography result received");
+    if (shows_gui) bubble("Link tomography result received");
+    send(pk, "hmPort$o");
+    return;
+  } else if (dest_addr == my_address && dynamic_cast<QuantumLinkVisibility *>(msg)) {
+    send(pk, "hmPort$o");
+    return;
+  } else if (dest_addr == my_address && dynamic_cast<LinkTomographyStop *>(msg)) {
+    if (shows_gui) bubble("Link tomography stop received");
     send(pk, "hmPort$o");
     return;
   } else if (dest_addr == my_address && dynamic_cast<PurificationResult *>(msg)) {
-    bubble("Purification result received");
+    if (shows_gui) bubble("Purification result received");
+    send(pk, "rePort$o");
+    return;
+  } else if (dest_addr == my_address && dynamic_cast<BellPairDiscarded *>(msg)) {
     send(pk, "rePort$o");
     return;
   } else if (dest_addr == my_address && dynamic_cast<StopEmitting *>(msg)) {
     send(pk, "rePort$o");
     return;
+  } else if (dest_addr == my_address && dynamic_cast<QuantumLinkDown *>(msg)) {
+    send(pk, "rePort$o");
+    return;
   } else if (dest_addr == my_address && dynamic_cast<OspfPacket *>(msg)) {
     send(pk, "rdPort$o");
     return;
@@ -151,16 +236,16 @@ void Router::handleMessage(cMessage *msg) {
   }
 
   // Check if packet is reachable
-  if (!routing_table.count(dest_addr)) {
+  auto *out_gate_index = findOutGateIndex(pk);
+  if (out_gate_index == nullptr) {
     std::cout << "In Node[" << my_address << "]Address... " << dest_addr << " unreachable, discarding packet " << pk->getName() << endl;
     delete pk;
     error("Router couldn't find the path. Shoudn't happen. Or maybe the router does not understand the packet.");
     return;
   }
 
-  int out_gate_index = routing_table.at(dest_addr);
   pk->setHopCount(pk->getHopCount() + 1);
-  send(pk, "toQueue", out_gate_index);
+  send(pk, "toQueue", *out_gate_index);
 }
 
 void Router::handleOspfHelloPacket(cMessage *msg) {
@@ -1,12 +1,14 @@
 #pragma once
 #include <omnetpp.h>
+#include <utils/AddressTable.h>
+#include <vector>
 #include <utils/ComponentProvider.h>
 #include "messages/classical_messages.h"
 
 namespace quisp::modules {
 
 using namespace ospf;
-using RoutingTable = std::map<NodeAddr, int>;  // destaddr -> gateindex
+using RoutingTable = utils::AddressTable<int>;  // destaddr -> gateindex
 
 /** \class Router
  *
@@ -16,16 +18,32 @@ class Router : public omnetpp::cSimpleModule {
  public:
   Router();
 
+  /**
+   * @brief hands the packet for this node to its module at once, without an event of the Router.
+   * @return false if local_delivery is off or the packet goes to another node, then the caller sends it as usual.
+   */
+  bool deliverLocally(messages::Header* pk);
+
  protected:
   virtual void initialize() override;
   virtual void handleMessage(omnetpp::cMessage* msg) override;
-  void generateRoutingTable(cTopology* topo);
+  void generateRoutingTable(cTopology* topo, const SharedResource::NextHopTable* next_hops);
   void handleOspfHelloPacket(omnetpp::cMessage* msg);
+  /**
+   * @brief the gate index of toQueue towards the destination of the packet, nullptr if unreachable.
+   * With equal_cost_multipath, the flow of the packet, its source, destination and RuleSet, picks one of the equal cost gates,
+   * so the packets of a flow keep their order on one path and the flows spread over the parallel ones.
+   */
+  const int* findOutGateIndex(const messages::Header* pk) const;
 
   utils::ComponentProvider provider;
+  modules::SharedResource::EventProfiler *event_profiler = nullptr;
 
   NodeAddr my_address;
   RoutingTable routing_table;
+  bool local_delivery = false;
+  // the gate indices of the shortest paths to the destinations with more than one, with equal_cost_multipath
+  utils::AddressTable<std::vector<int>> multipath_table;
 
  private:
   virtual bool parentModuleIsQNode();
@@ -34,5 +52,11 @@ class Router : public omnetpp::cSimpleModule {
   void redirectOspfHelloPacketToRoutingDaemon(messages::OspfPacket* pk);
 };
 
+/**
+ * @brief sends the packet through the gate of the module towards the Router of the node.
+ * The packet for the node itself goes on to its module right away when the Router has local_delivery.
+ */
+void sendToRouter(omnetpp::cSimpleModule* module, messages::Header* pk, const char* gate_name = "RouterPort$o");
+
 Define_Module(Router);
 }  // namespace quisp::modules
@@ -23,7 +23,16 @@ class MockNode : public quisp_test::TestQNode {
 
 class Strategy : public quisp_test::TestComponentProviderStrategy {
  public:
-  Strategy(MockNode* _qnode) : parent_qnode(_qnode) {}
+  Strategy(MockNode* _qnode) : parent_qnode(_qnode) {
+    setParBool(&shared_resource, "profile_events", false);
+    setParStr(&shared_resource, "event_trace_filename", "");
+    setParStr(&shared_resource, "event_replay_filename", "");
+    setParInt(&shared_resource, "init_threads", 1);
+    setParBool(&shared_resource, "keep_tables_across_runs", false);
+    setParBool(&shared_resource, "centralized_connection_setup", false);
+    setParDouble(&shared_resource, "controller_delay", 0);
+    setParStr(&shared_resource, "validation_level", "full");
+  }
   cModule* getNode() override { return parent_qnode; }
   int getNodeAddr() override { return parent_qnode->address; }
   SharedResource* getSharedResource() override { return &shared_resource; }
@@ -35,8 +44,11 @@ class Strategy : public quisp_test::TestComponentProviderStrategy {
 
 class Router : public OriginalRouter {
  public:
+  using OriginalRouter::findOutGateIndex;
   using OriginalRouter::handleMessage;
   using OriginalRouter::initialize;
+  using OriginalRouter::local_delivery;
+  using OriginalRouter::multipath_table;
   using OriginalRouter::routing_table;
   explicit Router(MockNode* parent_qnode) : OriginalRouter() {
     this->provider.setStrategy(std::make_unique<Strategy>(parent_qnode));
@@ -46,7 +58,10 @@ class Router : public OriginalRouter {
     cmPort = new TestGate(this, "cmPort$o");
     rdPort = new TestGate(this, "rdPort$o");
     queueGate = new TestGate(this, "toQueue");
-    routing_table.insert({8, queueGate->getId()});
+    appPort = new TestGate(this, "toApp");
+    routing_table.set(8, queueGate->getId());
+    setParBool(this, "local_delivery", false);
+    setParBool(this, "equal_cost_multipath", false);
   }
 
   TestGate* hmPort;
@@ -54,6 +69,7 @@ class Router : public OriginalRouter {
   TestGate* cmPort;
   TestGate* rdPort;
   TestGate* queueGate;
+  TestGate* appPort;
 
   std::map<const char*, cGate*> ports{};
   cGate* gate(const char* gatename, int index = -1) override {
@@ -62,6 +78,7 @@ class Router : public OriginalRouter {
     if (strcmp(gatename, "rePort$o") == 0) return rePort;
     if (strcmp(gatename, "rdPort$o") == 0) return rdPort;
     if (strcmp(gatename, "toQueue") == 0) return queueGate;
+    if (strcmp(gatename, "toApp") == 0) return appPort;
     error("port: %s not found", gatename);
     return nullptr;
   }
@@ -117,6 +134,35 @@ TEST_F(RouterTest, handlePacketForOtherNode) {
   }
 }
 
+TEST_F(RouterTest, equalCostMultipath) {
+  router->multipath_table.set(8, {3, 4, 5});
+  std::map<int, int> flows_per_gate;
+  for (unsigned long ruleset_id = 1; ruleset_id <= 300; ruleset_id++) {
+    SwappingResult result;
+    result.setSrcAddr(10);
+    result.setDestAddr(8);
+    result.setRulesetId(ruleset_id);
+    auto* gate_index = router->findOutGateIndex(&result);
+    ASSERT_NE(gate_index, nullptr);
+    flows_per_gate[*gate_index]++;
+    // the packets of the same flow take the same gate
+    PurificationResult same_flow;
+    same_flow.setSrcAddr(10);
+    same_flow.setDestAddr(8);
+    same_flow.setRulesetId(ruleset_id);
+    EXPECT_EQ(*router->findOutGateIndex(&same_flow), *gate_index);
+  }
+  ASSERT_EQ(flows_per_gate.size(), 3);
+  for (auto [gate_index, num_flows] : flows_per_gate) EXPECT_GT(num_flows, 60) << gate_index;
+
+  // the destinations of a single shortest path use the routing table
+  ConnectionSetupRequest request;
+  request.setDestAddr(7);
+  EXPECT_EQ(router->findOutGateIndex(&request), nullptr);
+  router->routing_table.set(7, 2);
+  EXPECT_EQ(*router->findOutGateIndex(&request), 2);
+}
+
 TEST_F(RouterTest, handleConnSetupRequest) {
   auto msg = new ConnectionSetupRequest;
   msg->setDestAddr(10);
@@ -152,6 +198,13 @@ TEST_F(RouterTest, handleRejectConnectionSetupReq) {
   ASSERT_EQ(router->cmPort->messages.size(), 1);
 }
 
+TEST_F(RouterTest, handleConnectionSetupReleaseNotification) {
+  auto msg = new ConnectionSetupReleaseNotification;
+  msg->setDestAddr(10);
+  router->handleMessage(msg);
+  ASSERT_EQ(router->cmPort->messages.size(), 1);
+}
+
 TEST_F(RouterTest, handleInternalRuleSetForwarding) {
   auto msg = new InternalRuleSetForwarding;
   msg->setDestAddr(10);
@@ -166,6 +219,13 @@ TEST_F(RouterTest, handleInternalRuleSetForwarding_Application) {
   ASSERT_EQ(router->rePort->messages.size(), 1);
 }
 
+TEST_F(RouterTest, handleInternalRuleSetTermination) {
+  auto msg = new InternalRuleSetTermination;
+  msg->setDestAddr(10);
+  router->handleMessage(msg);
+  ASSERT_EQ(router->rePort->messages.size(), 1);
+}
+
 TEST_F(RouterTest, handleSwappingResult) {
   auto msg = new SwappingResult;
   msg->setDestAddr(10);
@@ -173,6 +233,31 @@ TEST_F(RouterTest, handleSwappingResult) {
   ASSERT_EQ(router->rePort->messages.size(), 1);
 }
 
+TEST_F(RouterTest, handleSwappingResultBatch) {
+  auto msg = new SwappingResultBatch;
+  msg->setDestAddr(10);
+  router->handleMessage(msg);
+  ASSERT_EQ(router->rePort->messages.size(), 1);
+}
+
+TEST_F(RouterTest, deliverLocally) {
+  auto msg = new StopEmitting;
+  msg->setDestAddr(10);
+  auto other = new StopEmitting;
+  other->setDestAddr(8);
+  EXPECT_FALSE(router->deliverLocally(msg));
+
+  router->local_delivery = true;
+  EXPECT_TRUE(router->deliverLocally(msg));
+  ASSERT_EQ(router->rePort->messages.size(), 1);
+  EXPECT_EQ(router->rePort->messages.at(0), msg);
+
+  // the packet for another node takes the Router event and the Queue
+  EXPECT_FALSE(router->deliverLocally(other));
+  EXPECT_EQ(router->queueGate->messages.size(), 0);
+  delete other;
+}
+
 TEST_F(RouterTest, handleLinkTomographyAck) {
   auto msg = new LinkTomographyAck;
   msg->setDestAddr(10);
@@ -194,6 +279,20 @@ TEST_F(RouterTest, handleLinkTomographyRuleSet) {
   ASSERT_EQ(router->rePort->messages.size(), 1);
 }
 
+TEST_F(RouterTest, handleLinkTomographyStop) {
+  auto msg = new LinkTomographyStop;
+  msg->setDestAddr(10);
+  router->handleMessage(msg);
+  ASSERT_EQ(router->hmPort->messages.size(), 1);
+}
+
+TEST_F(RouterTest, handleQuantumLinkVisibility) {
+  auto msg = new QuantumLinkVisibility;
+  msg->setDestAddr(10);
+  router->handleMessage(msg);
+  ASSERT_EQ(router->hmPort->messages.size(), 1);
+}
+
 TEST_F(RouterTest, handlePurificationResult) {
   auto msg = new PurificationResult;
   msg->setDestAddr(10);
@@ -208,6 +307,29 @@ TEST_F(RouterTest, handleStopEmitting) {
   ASSERT_EQ(router->rePort->messages.size(), 1);
 }
 
+TEST_F(RouterTest, handleMSMMemoryExhausted) {
+  // to the EPPSController of the EPPS node
+  auto msg = new MSMMemoryExhausted;
+  msg->setDestAddr(10);
+  router->handleMessage(msg);
+  ASSERT_EQ(router->appPort->messages.size(), 1);
+  EXPECT_EQ(router->rePort->messages.size(), 0);
+}
+
+TEST_F(RouterTest, handleQuantumLinkDown) {
+  auto msg = new QuantumLinkDown;
+  msg->setDestAddr(10);
+  router->handleMessage(msg);
+  ASSERT_EQ(router->rePort->messages.size(), 1);
+}
+
+TEST_F(RouterTest, handleConnectionRearm) {
+  auto msg = new ConnectionRearm;
+  msg->setDestAddr(10);
+  router->handleMessage(msg);
+  ASSERT_EQ(router->rePort->messages.size(), 1);
+}
+
 TEST_F(RouterTest, handleOspfPacket) {
   auto msg = new OspfPacket;
   msg->setDestAddr(10);
@@ -0,0 +1,184 @@
+#include "BinaryLogger.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include "messages/connection_setup_messages_m.h"
+
+namespace quisp::modules::Logger {
+
+using quisp::messages::ConnectionSetupRequest;
+using quisp::messages::ConnectionSetupResponse;
+using quisp::messages::RejectConnectionSetupRequest;
+
+namespace {
+const char magic[] = "QSPBLOG1";
+
+template <typename T>
+void append(std::string& payload, const T& value) {
+  payload.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename Packet>
+bool setPacketFields(BinaryLogRecord& record, omnetpp::cMessage const* const msg) {
+  auto* packet = dynamic_cast<const Packet*>(msg);
+  if (packet == nullptr) return false;
+  record.application_id = packet->getApplicationId();
+  record.actual_src_addr = packet->getActual_srcAddr();
+  record.actual_dest_addr = packet->getActual_destAddr();
+  return true;
+}
+}  // namespace
+
+BinaryLogWriter::BinaryLogWriter(const std::string& filename, std::size_t block_records) : block_records(block_records) {
+  file = std::fopen(filename.c_str(), "wb");
+  if (file == nullptr) throw omnetpp::cRuntimeError("failed to open the binary log: %s", filename.c_str());
+  std::fwrite(magic, 1, 8, file);
+  records.reserve(block_records);
+  trace_records.reserve(block_records);
+  // id 0 is the empty string, e.g. msg_type of the records other than packets
+  intern("");
+}
+
+BinaryLogWriter::~BinaryLogWriter() {
+  flush();
+  std::fclose(file);
+}
+
+uint32_t BinaryLogWriter::intern(const std::string& s) {
+  auto [it, inserted] = string_ids.emplace(s, string_ids.size());
+  if (inserted) pending_strings.push_back(&it->first);
+  return it->second;
+}
+
+void BinaryLogWriter::write(const BinaryLogRecord& record) {
+  records.push_back(record);
+  if (records.size() >= block_records) flush();
+}
+
+void BinaryLogWriter::write(const EventTraceRecord& record) {
+  trace_records.push_back(record);
+  if (trace_records.size() >= block_records) flush();
+}
+
+void BinaryLogWriter::flush() {
+  if (!pending_strings.empty()) {
+    std::string payload;
+    append<uint32_t>(payload, string_ids.size() - pending_strings.size());
+    for (auto* s : pending_strings) {
+      append<uint32_t>(payload, s->size());
+      payload += *s;
+    }
+    writeBlock(Strings, pending_strings.size(), payload);
+    pending_strings.clear();
+  }
+  if (!records.empty()) {
+    writeBlock(Records, records.size(), std::string(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(BinaryLogRecord)));
+    records.clear();
+  }
+  if (!trace_records.empty()) {
+    writeBlock(Trace, trace_records.size(), std::string(reinterpret_cast<const char*>(trace_records.data()), trace_records.size() * sizeof(EventTraceRecord)));
+    trace_records.clear();
+  }
+  std::fflush(file);
+}
+
+void BinaryLogWriter::writeBlock(BlockType type, uint32_t count, const std::string& payload) {
+  std::string header;
+  append<uint32_t>(header, type);
+  append<uint32_t>(header, count);
+  append<uint64_t>(header, payload.size());
+  std::fwrite(header.data(), 1, header.size(), file);
+  std::fwrite(payload.data(), 1, payload.size(), file);
+}
+
+BinaryLog BinaryLog::read(const std::string& filename) {
+  std::ifstream file(filename, std::ios::binary);
+  if (!file) throw omnetpp::cRuntimeError("failed to open the binary log: %s", filename.c_str());
+  std::string bytes(std::istreambuf_iterator<char>(file), {});
+  if (bytes.compare(0, 8, magic) != 0) throw omnetpp::cRuntimeError("not a binary log: %s", filename.c_str());
+
+  BinaryLog log;
+  std::size_t pos = 8;
+  while (pos + 16 <= bytes.size()) {
+    uint32_t type, count;
+    uint64_t size;
+    std::memcpy(&type, &bytes[pos], 4);
+    std::memcpy(&count, &bytes[pos + 4], 4);
+    std::memcpy(&size, &bytes[pos + 8], 8);
+    pos += 16;
+    if (size > bytes.size() - pos) throw omnetpp::cRuntimeError("truncated binary log: %s", filename.c_str());
+    const char* payload = &bytes[pos];
+    if (type == BinaryLogWriter::Strings) {
+      std::size_t p = 4;
+      for (uint32_t i = 0; i < count; i++) {
+        uint32_t length;
+        std::memcpy(&length, payload + p, 4);
+        log.strings.emplace_back(payload + p + 4, length);
+        p += 4 + length;
+      }
+    } else if (type == BinaryLogWriter::Records) {
+      auto offset = log.records.size();
+      log.records.resize(offset + count);
+      std::memcpy(&log.records[offset], payload, count * sizeof(BinaryLogRecord));
+    } else if (type == BinaryLogWriter::Trace) {
+      auto offset = log.trace_records.size();
+      log.trace_records.resize(offset + count);
+      std::memcpy(&log.trace_records[offset], payload, count * sizeof(EventTraceRecord));
+    }
+    pos += size;
+  }
+  return log;
+}
+
+BinaryLogger::BinaryLogger(std::shared_ptr<BinaryLogWriter> writer) : writer(writer), qubit_state_change(writer->intern("QubitStateChange")) {}
+
+BinaryLogger::~BinaryLogger() {}
+
+void BinaryLogger::setModule(omnetpp::cModule const* const mod) { module = mod; }
+
+void BinaryLogger::setQNodeAddress(int addr) { qnode_address = addr; }
+
+BinaryLogRecord BinaryLogger::newRecord(BinaryLogEventKind kind, uint32_t event_type) const {
+  BinaryLogRecord record;
+  record.simtime = omnetpp::simTime().dbl();
+  record.kind = kind;
+  record.event_type = event_type;
+  record.address = qnode_address;
+  record.partner_addr = -1;
+  record.qnic_type = -1;
+  record.qnic_index = -1;
+  record.qubit_index = -1;
+  record.flags = 0;
+  record.msg_type = 0;
+  record.application_id = -1;
+  record.actual_src_addr = -1;
+  record.actual_dest_addr = -1;
+  return record;
+}
+
+void BinaryLogger::logPacket(const std::string& event_type, omnetpp::cMessage const* const msg) {
+  auto record = newRecord(BinaryLogEventKind::Packet, writer->intern(event_type));
+  record.msg_type = writer->intern(msg->getClassName());
+  setPacketFields<ConnectionSetupRequest>(record, msg) || setPacketFields<RejectConnectionSetupRequest>(record, msg) || setPacketFields<ConnectionSetupResponse>(record, msg);
+  writer->write(record);
+}
+
+void BinaryLogger::logQubitState(quisp::modules::QNIC_type qnic_type, int qnic_index, int qubit_index, bool is_busy, bool is_allocated) {
+  auto record = newRecord(BinaryLogEventKind::QubitState, qubit_state_change);
+  record.qnic_type = qnic_type;
+  record.qnic_index = qnic_index;
+  record.qubit_index = qubit_index;
+  record.flags = (is_busy ? 1 : 0) | (is_allocated ? 2 : 0);
+  writer->write(record);
+}
+
+void BinaryLogger::logBellPairInfo(const std::string& event_type, int partner_addr, quisp::modules::QNIC_type qnic_type, int qnic_index, int qubit_index) {
+  auto record = newRecord(BinaryLogEventKind::BellPair, writer->intern("BellPair" + event_type));
+  record.partner_addr = partner_addr;
+  record.qnic_type = qnic_type;
+  record.qnic_index = qnic_index;
+  record.qubit_index = qubit_index;
+  writer->write(record);
+}
+
+}  // namespace quisp::modules::Logger
@@ -0,0 +1,131 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ILogger.h"
+
+namespace quisp::modules::Logger {
+
+enum class BinaryLogEventKind : uint32_t {
+  Packet = 0,
+  QubitState = 1,
+  BellPair = 2,
+};
+
+/**
+ * \brief a fixed-size event of the binary log. The fields that the event kind doesn't have are -1.
+ *
+ * scripts/binary_log.py reads it with the same layout.
+ */
+struct BinaryLogRecord {
+  double simtime;
+  BinaryLogEventKind kind;
+  uint32_t event_type;  // interned string
+  int32_t address;
+  int32_t partner_addr;
+  int32_t qnic_type;
+  int32_t qnic_index;
+  int32_t qubit_index;
+  uint32_t flags;  // bit 0: busy, bit 1: allocated
+  uint32_t msg_type;  // interned class name of the packet
+  int32_t application_id;
+  int32_t actual_src_addr;
+  int32_t actual_dest_addr;
+};
+static_assert(sizeof(BinaryLogRecord) == 56, "the reader in scripts/binary_log.py assumes 56 bytes records");
+
+enum class EventTraceKind : uint32_t {
+  Delivery = 0,
+  Stimulus = 1,
+};
+
+/**
+ * \brief a fixed-size record of the event trace of SharedResource::EventTrace, in the Trace blocks of the same file.
+ *
+ * A delivery is a message handled by a module, a stimulus is a connection request of an Application.
+ * The fields that the kind doesn't have are -1, or 0 for the interned strings.
+ */
+struct EventTraceRecord {
+  double simtime;
+  int64_t simtime_raw;  // exact, for the replay with the same simtime-resolution
+  uint64_t event_number;
+  uint64_t rng_draws;  // the numbers drawn from all the RNGs before the event
+  EventTraceKind kind;
+  uint32_t module;  // interned full path
+  uint32_t msg_type;  // interned class name of the message
+  int32_t msg_kind;
+  int32_t dest_addr;  // the stimulus: the destination and the Bell pairs of the request
+  int32_t num_pairs;
+};
+static_assert(sizeof(EventTraceRecord) == 56, "the reader in scripts/binary_log.py assumes 56 bytes trace records");
+
+/**
+ * \brief BinaryLogWriter writes the records and the interned strings of all the BinaryLoggers into one file.
+ *
+ * The file starts with the 8 bytes magic "QSPBLOG1", then a sequence of blocks:
+ * uint32 block type, uint32 count, uint64 payload bytes, payload. A strings block has the uint32 id of
+ * its first string followed by count pairs of uint32 length and bytes; a records block has count BinaryLogRecords
+ * and a trace block count EventTraceRecords. The log and the event trace can share one writer.
+ * A string is always written before the first record using it. Everything is little endian.
+ */
+class BinaryLogWriter {
+ public:
+  enum BlockType : uint32_t { Strings = 1, Records = 2, Trace = 3 };
+  explicit BinaryLogWriter(const std::string& filename, std::size_t block_records = 4096);
+  ~BinaryLogWriter();
+  uint32_t intern(const std::string& s);
+  void write(const BinaryLogRecord& record);
+  void write(const EventTraceRecord& record);
+  // writes the buffered strings and records
+  void flush();
+
+ private:
+  void writeBlock(BlockType type, uint32_t count, const std::string& payload);
+
+  std::FILE* file = nullptr;
+  std::size_t block_records;
+  std::unordered_map<std::string, uint32_t> string_ids;
+  // the strings interned after the last flush
+  std::vector<const std::string*> pending_strings;
+  std::vector<BinaryLogRecord> records;
+  std::vector<EventTraceRecord> trace_records;
+};
+
+/**
+ * \brief BinaryLog is the content of a file of BinaryLogWriter, e.g. to replay an event trace.
+ */
+struct BinaryLog {
+  std::vector<std::string> strings;
+  std::vector<BinaryLogRecord> records;
+  std::vector<EventTraceRecord> trace_records;
+
+  /// @throws omnetpp::cRuntimeError if the file can't be read or isn't a binary log.
+  static BinaryLog read(const std::string& filename);
+};
+
+/**
+ * \brief BinaryLogger class writes fixed-size event records in blocks, to be loaded into numpy/pandas
+ * by scripts/binary_log.py instead of parsing the jsonl.
+ */
+class BinaryLogger : public ILogger {
+ public:
+  BinaryLogger(std::shared_ptr<BinaryLogWriter> writer);
+  virtual ~BinaryLogger();
+  void logPacket(const std::string& event_type, omnetpp::cMessage const* const msg) override;
+  void logQubitState(quisp::modules::QNIC_type qnic_type, int qnic_index, int qubit_index, bool is_busy, bool is_allocated) override;
+  void logBellPairInfo(const std::string& event_type, int partner_addr, quisp::modules::QNIC_type qnic_type, int qnic_index, int qubit_index) override;
+  void setModule(omnetpp::cModule const* const mod) override;
+  void setQNodeAddress(int addr) override;
+
+ protected:
+  BinaryLogRecord newRecord(BinaryLogEventKind kind, uint32_t event_type) const;
+
+  std::shared_ptr<BinaryLogWriter> writer;
+  int qnode_address = -1;
+  omnetpp::cModule const* module = nullptr;
+  uint32_t qubit_state_change;
+};
+}  // namespace quisp::modules::Logger
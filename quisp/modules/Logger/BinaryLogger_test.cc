@@ -0,0 +1,132 @@
+#include "BinaryLogger.h"
+#include <gtest/gtest.h>
+#include <test_utils/TestUtils.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "messages/connection_setup_messages_m.h"
+
+namespace {
+
+using quisp::messages::ConnectionSetupRequest;
+using quisp::modules::Logger::BinaryLog;
+using quisp::modules::Logger::BinaryLogEventKind;
+using quisp::modules::Logger::BinaryLogger;
+using quisp::modules::Logger::BinaryLogRecord;
+using quisp::modules::Logger::BinaryLogWriter;
+using quisp::modules::Logger::EventTraceKind;
+using quisp::modules::Logger::EventTraceRecord;
+using namespace quisp_test;
+
+class BinaryLoggerTest : public testing::Test {
+ protected:
+  void SetUp() {
+    utils::prepareSimulation();
+    writer = std::make_shared<BinaryLogWriter>(filename, 2);
+    logger = new BinaryLogger(writer);
+    logger->setQNodeAddress(7);
+  }
+  void TearDown() {
+    delete logger;
+    std::remove(filename);
+  }
+  std::string readFile() {
+    std::ifstream file(filename, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), {});
+  }
+  // the records of all the records blocks
+  std::vector<BinaryLogRecord> readRecords() {
+    auto bytes = readFile();
+    std::vector<BinaryLogRecord> records;
+    std::size_t pos = 8;
+    while (pos < bytes.size()) {
+      uint32_t type, count;
+      uint64_t size;
+      std::memcpy(&type, &bytes[pos], 4);
+      std::memcpy(&count, &bytes[pos + 4], 4);
+      std::memcpy(&size, &bytes[pos + 8], 8);
+      pos += 16;
+      if (type == BinaryLogWriter::Records) {
+        for (uint32_t i = 0; i < count; i++) {
+          BinaryLogRecord record;
+          std::memcpy(&record, &bytes[pos + i * sizeof(BinaryLogRecord)], sizeof(BinaryLogRecord));
+          records.push_back(record);
+        }
+      }
+      pos += size;
+    }
+    return records;
+  }
+  const char* filename = "binary_logger_test.blog";
+  std::shared_ptr<BinaryLogWriter> writer;
+  BinaryLogger* logger;
+};
+
+TEST_F(BinaryLoggerTest, StartsWithMagic) {
+  writer->flush();
+  EXPECT_EQ(readFile().substr(0, 8), "QSPBLOG1");
+}
+
+TEST_F(BinaryLoggerTest, InternsStrings) {
+  auto id = writer->intern("Generated");
+  EXPECT_EQ(writer->intern("Generated"), id);
+  EXPECT_NE(writer->intern("Erased"), id);
+  EXPECT_EQ(writer->intern(""), 0);
+}
+
+TEST_F(BinaryLoggerTest, WritesRecordsInBlocks) {
+  logger->logQubitState(quisp::modules::QNIC_E, 1, 2, true, false);
+  EXPECT_TRUE(readRecords().empty());
+  logger->logBellPairInfo("Generated", 3, quisp::modules::QNIC_E, 2, 4);
+  // the block of 2 records is written
+  auto records = readRecords();
+  ASSERT_EQ(records.size(), 2);
+  EXPECT_EQ(records[0].kind, BinaryLogEventKind::QubitState);
+  EXPECT_EQ(records[0].address, 7);
+  EXPECT_EQ(records[0].qubit_index, 2);
+  EXPECT_EQ(records[0].flags, 1);
+  EXPECT_EQ(records[1].kind, BinaryLogEventKind::BellPair);
+  EXPECT_EQ(records[1].event_type, writer->intern("BellPairGenerated"));
+  EXPECT_EQ(records[1].partner_addr, 3);
+}
+
+TEST_F(BinaryLoggerTest, PacketFields) {
+  auto* req = new ConnectionSetupRequest();
+  req->setApplicationId(1);
+  req->setActual_destAddr(5);
+  req->setActual_srcAddr(2);
+  logger->logPacket("test", req);
+  writer->flush();
+  auto records = readRecords();
+  ASSERT_EQ(records.size(), 1);
+  EXPECT_EQ(records[0].kind, BinaryLogEventKind::Packet);
+  EXPECT_EQ(records[0].msg_type, writer->intern("quisp::messages::ConnectionSetupRequest"));
+  EXPECT_EQ(records[0].application_id, 1);
+  EXPECT_EQ(records[0].actual_src_addr, 2);
+  EXPECT_EQ(records[0].actual_dest_addr, 5);
+  EXPECT_EQ(records[0].qnic_index, -1);
+  delete req;
+}
+
+TEST_F(BinaryLoggerTest, ReadTheLogAndTheTrace) {
+  logger->logBellPairInfo("Generated", 3, quisp::modules::QNIC_E, 2, 4);
+  EventTraceRecord trace_record{};
+  trace_record.kind = EventTraceKind::Stimulus;
+  trace_record.module = writer->intern("net.EndNode1.app");
+  trace_record.dest_addr = 5;
+  writer->write(trace_record);
+  writer->flush();
+
+  auto log = BinaryLog::read(filename);
+  ASSERT_EQ(log.records.size(), 1);
+  EXPECT_EQ(log.strings[log.records[0].event_type], "BellPairGenerated");
+  ASSERT_EQ(log.trace_records.size(), 1);
+  EXPECT_EQ(log.trace_records[0].kind, EventTraceKind::Stimulus);
+  EXPECT_EQ(log.strings[log.trace_records[0].module], "net.EndNode1.app");
+  EXPECT_EQ(log.trace_records[0].dest_addr, 5);
+  EXPECT_THROW(BinaryLog::read("no_such_binary_log.blog"), omnetpp::cRuntimeError);
+}
+
+}  // namespace
@@ -4,12 +4,14 @@
 namespace quisp::modules::Logger {
 
 /**
- * \brief DisabledLogger class is used for
+ * \brief DisabledLogger class is used for the runs without logging.
+ *
+ * It disables every event type, so QUISP_LOG skips the events without calling it.
  */
 class DisabledLogger : public ILogger {
  public:
-  DisabledLogger(){};
-  virtual ~DisabledLogger(){};
+  DisabledLogger() { enabled_events = 0; };
+  virtual ~DisabledLogger() { enabled_events = 0; };
   void logPacket(const std::string& event_type, omnetpp::cMessage const* const msg) override { return; }
   void logQubitState(quisp::modules::QNIC_type qnic_type, int qnic_index, int qubit_index, bool is_busy, bool is_allocated) override { return; }
   void logBellPairInfo(const std::string& event_type, int partner_addr, quisp::modules::QNIC_type qnic_type, int qnic_index, int qubit_index) override { return; }
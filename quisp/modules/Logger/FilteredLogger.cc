@@ -0,0 +1,93 @@
+#include "FilteredLogger.h"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace quisp::modules::Logger {
+
+LogFilter::LogFilter(const std::string& rules, uint64_t seed) : rng(seed) {
+  std::istringstream is(rules);
+  std::string rule;
+  while (is >> rule) {
+    accepts_all = false;
+    auto colon = rule.find(':');
+    auto event_type = rule.substr(0, colon);
+    double rate = 1;
+    if (colon != std::string::npos) {
+      try {
+        rate = std::stod(rule.substr(colon + 1));
+      } catch (const std::logic_error&) {
+        throw std::invalid_argument("invalid sampling rate: " + rule);
+      }
+    }
+    if (event_type.empty() || rate < 0 || 1 < rate) throw std::invalid_argument("invalid log filter rule: " + rule);
+    rates[event_type] = rate;
+    if (event_type.rfind("BellPair", 0) == 0) bell_pair_rates[event_type.substr(8)] = rate;
+  }
+  if (!accepts_all) {
+    auto it = rates.find("QubitStateChange");
+    qubit_state_rate = it == rates.end() ? 0 : it->second;
+  }
+}
+
+bool LogFilter::accept(std::string_view event_type) {
+  if (accepts_all) return true;
+  auto it = rates.find(event_type);
+  return it != rates.end() && sample(it->second);
+}
+
+bool LogFilter::acceptPacket(omnetpp::cMessage const* const msg) {
+  if (accepts_all) return true;
+  std::string_view class_name = msg->getClassName();
+  auto separator = class_name.rfind("::");
+  if (separator != std::string_view::npos) class_name.remove_prefix(separator + 2);
+  return accept(class_name);
+}
+
+bool LogFilter::acceptBellPair(const std::string& event_type) {
+  if (accepts_all) return true;
+  auto it = bell_pair_rates.find(event_type);
+  return it != bell_pair_rates.end() && sample(it->second);
+}
+
+bool LogFilter::mayAccept(LogEventType type) const {
+  if (accepts_all) return true;
+  switch (type) {
+    case LogEventType::QubitState:
+      return qubit_state_rate > 0;
+    case LogEventType::BellPair:
+      return std::any_of(bell_pair_rates.begin(), bell_pair_rates.end(), [](auto& entry) { return entry.second > 0; });
+    case LogEventType::Packet:
+      return std::any_of(rates.begin(), rates.end(), [](auto& entry) { return entry.second > 0 && entry.first != "QubitStateChange" && entry.first.rfind("BellPair", 0) != 0; });
+  }
+  return true;
+}
+
+FilteredLogger::FilteredLogger(ILogger* logger, std::shared_ptr<LogFilter> filter) : logger(logger), filter(filter) {
+  for (auto type : {LogEventType::Packet, LogEventType::QubitState, LogEventType::BellPair}) {
+    setEnabled(type, logger->enabled(type) && filter->mayAccept(type));
+  }
+}
+
+FilteredLogger::~FilteredLogger() {}
+
+void FilteredLogger::logPacket(const std::string& event_type, omnetpp::cMessage const* const msg) {
+  if (!filter->acceptPacket(msg)) return;
+  logger->logPacket(event_type, msg);
+}
+
+void FilteredLogger::logQubitState(quisp::modules::QNIC_type qnic_type, int qnic_index, int qubit_index, bool is_busy, bool is_allocated) {
+  if (!filter->acceptQubitState()) return;
+  logger->logQubitState(qnic_type, qnic_index, qubit_index, is_busy, is_allocated);
+}
+
+void FilteredLogger::logBellPairInfo(const std::string& event_type, int partner_addr, quisp::modules::QNIC_type qnic_type, int qnic_index, int qubit_index) {
+  if (!filter->acceptBellPair(event_type)) return;
+  logger->logBellPairInfo(event_type, partner_addr, qnic_type, qnic_index, qubit_index);
+}
+
+void FilteredLogger::setModule(omnetpp::cModule const* const mod) { logger->setModule(mod); }
+
+void FilteredLogger::setQNodeAddress(int addr) { logger->setQNodeAddress(addr); }
+
+}  // namespace quisp::modules::Logger
@@ -0,0 +1,65 @@
+#pragma once
+#include <functional>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include "ILogger.h"
+
+namespace quisp::modules::Logger {
+
+/**
+ * \brief LogFilter decides which events are logged, by event type and sampling rate.
+ *
+ * The rules are whitespace separated "EventType" (always logged) or "EventType:rate" (logged with probability rate),
+ * and the event types not in the rules are not logged. The event type of a packet is its class name without
+ * the namespace, e.g. "ConnectionSetupRequest", and the others are the event_type of JsonLogger,
+ * i.e. "QubitStateChange", "BellPairGenerated" and "BellPairErased". Empty rules log everything.
+ * It has its own random number generator so the sampling doesn't change the simulation.
+ */
+class LogFilter {
+ public:
+  explicit LogFilter(const std::string& rules, uint64_t seed = 0);
+  bool acceptsAll() const { return accepts_all; }
+  bool acceptPacket(omnetpp::cMessage const* const msg);
+  bool acceptQubitState() { return sample(qubit_state_rate); }
+  bool acceptBellPair(const std::string& event_type);
+  // false if no event of the type can be accepted, the packets are the event types other than QubitStateChange and BellPair*
+  bool mayAccept(LogEventType type) const;
+
+ protected:
+  bool accept(std::string_view event_type);
+  bool sample(double rate) { return rate >= 1 || (rate > 0 && uniform(rng) < rate); }
+
+  bool accepts_all = true;
+  std::map<std::string, double, std::less<>> rates;
+  // the rates of "BellPair<event_type>" by event_type, not to build the name on every event
+  std::map<std::string, double, std::less<>> bell_pair_rates;
+  // QubitStateChange is looked up on every state change
+  double qubit_state_rate = 1;
+  std::mt19937_64 rng;
+  std::uniform_real_distribution<double> uniform{0, 1};
+};
+
+/**
+ * \brief FilteredLogger passes the events accepted by the LogFilter to the logger.
+ *
+ * The filter is checked before the logger formats anything, and the event types it never accepts
+ * are disabled so QUISP_LOG skips them before building their arguments.
+ */
+class FilteredLogger : public ILogger {
+ public:
+  FilteredLogger(ILogger* logger, std::shared_ptr<LogFilter> filter);
+  virtual ~FilteredLogger();
+  void logPacket(const std::string& event_type, omnetpp::cMessage const* const msg) override;
+  void logQubitState(quisp::modules::QNIC_type qnic_type, int qnic_index, int qubit_index, bool is_busy, bool is_allocated) override;
+  void logBellPairInfo(const std::string& event_type, int partner_addr, quisp::modules::QNIC_type qnic_type, int qnic_index, int qubit_index) override;
+  void setModule(omnetpp::cModule const* const mod) override;
+  void setQNodeAddress(int addr) override;
+
+ protected:
+  std::unique_ptr<ILogger> logger;
+  std::shared_ptr<LogFilter> filter;
+};
+}  // namespace quisp::modules::Logger
@@ -0,0 +1,100 @@
+#include "FilteredLogger.h"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <test_utils/TestUtils.h>
+#include <stdexcept>
+
+#include "DisabledLogger.h"
+
+#include "messages/connection_setup_messages_m.h"
+
+namespace {
+
+using quisp::messages::ConnectionSetupRequest;
+using quisp::messages::ConnectionSetupResponse;
+using quisp::modules::QNIC_E;
+using quisp::modules::Logger::FilteredLogger;
+using quisp::modules::Logger::ILogger;
+using quisp::modules::Logger::LogEventType;
+using quisp::modules::Logger::LogFilter;
+using testing::_;
+
+class MockLogger : public ILogger {
+ public:
+  MOCK_METHOD(void, logPacket, (const std::string&, omnetpp::cMessage const* const), (override));
+  MOCK_METHOD(void, logQubitState, (quisp::modules::QNIC_type, int, int, bool, bool), (override));
+  MOCK_METHOD(void, logBellPairInfo, (const std::string&, int, quisp::modules::QNIC_type, int, int), (override));
+  MOCK_METHOD(void, setModule, (omnetpp::cModule const* const), (override));
+  MOCK_METHOD(void, setQNodeAddress, (int), (override));
+};
+
+TEST(LogFilterTest, EmptyRulesAcceptAll) {
+  LogFilter filter("");
+  EXPECT_TRUE(filter.acceptsAll());
+  EXPECT_TRUE(filter.acceptQubitState());
+  EXPECT_TRUE(filter.acceptBellPair("Generated"));
+}
+
+TEST(LogFilterTest, InvalidRules) {
+  EXPECT_THROW(LogFilter("QubitStateChange:2"), std::invalid_argument);
+  EXPECT_THROW(LogFilter("QubitStateChange:x"), std::invalid_argument);
+  EXPECT_THROW(LogFilter(":0.5"), std::invalid_argument);
+}
+
+TEST(LogFilterTest, SamplingRate) {
+  LogFilter filter("QubitStateChange:0.1 BellPairErased");
+  EXPECT_FALSE(filter.acceptsAll());
+  EXPECT_TRUE(filter.acceptBellPair("Erased"));
+  EXPECT_FALSE(filter.acceptBellPair("Generated"));
+  int accepted = 0;
+  for (int i = 0; i < 10000; i++) accepted += filter.acceptQubitState();
+  EXPECT_NEAR(accepted, 1000, 150);
+}
+
+TEST(FilteredLoggerTest, PassesOnlyAcceptedEvents) {
+  quisp_test::utils::prepareSimulation();
+  auto* mock_logger = new MockLogger;
+  FilteredLogger logger(mock_logger, std::make_shared<LogFilter>("ConnectionSetupRequest BellPairGenerated"));
+  ConnectionSetupRequest req;
+  ConnectionSetupResponse res;
+  EXPECT_CALL(*mock_logger, logPacket("received", &req)).Times(1);
+  EXPECT_CALL(*mock_logger, logPacket(_, &res)).Times(0);
+  EXPECT_CALL(*mock_logger, logQubitState).Times(0);
+  EXPECT_CALL(*mock_logger, logBellPairInfo("Generated", 1, QNIC_E, 0, 2)).Times(1);
+  EXPECT_CALL(*mock_logger, logBellPairInfo("Erased", _, _, _, _)).Times(0);
+  logger.logPacket("received", &req);
+  logger.logPacket("received", &res);
+  logger.logQubitState(QNIC_E, 0, 2, true, true);
+  logger.logBellPairInfo("Generated", 1, QNIC_E, 0, 2);
+  logger.logBellPairInfo("Erased", 1, QNIC_E, 0, 2);
+}
+
+TEST(FilteredLoggerTest, DisablesTheEventTypesNeverAccepted) {
+  FilteredLogger logger(new MockLogger, std::make_shared<LogFilter>("ConnectionSetupRequest BellPairErased:0"));
+  EXPECT_TRUE(logger.enabled(LogEventType::Packet));
+  EXPECT_FALSE(logger.enabled(LogEventType::QubitState));
+  EXPECT_FALSE(logger.enabled(LogEventType::BellPair));
+
+  FilteredLogger qubit_logger(new MockLogger, std::make_shared<LogFilter>("QubitStateChange:0.5"));
+  EXPECT_FALSE(qubit_logger.enabled(LogEventType::Packet));
+  EXPECT_TRUE(qubit_logger.enabled(LogEventType::QubitState));
+}
+
+TEST(QuispLogTest, SkipsTheArgumentsOfDisabledEvents) {
+  int evaluated = 0;
+  auto count = [&]() { return ++evaluated; };
+  ILogger* logger = nullptr;
+  QUISP_LOG(logger, QubitState, logQubitState(QNIC_E, count(), 0, true, true));
+  quisp::modules::Logger::DisabledLogger disabled;
+  logger = &disabled;
+  QUISP_LOG(logger, QubitState, logQubitState(QNIC_E, count(), 0, true, true));
+  EXPECT_EQ(evaluated, 0);
+
+  MockLogger mock_logger;
+  logger = &mock_logger;
+  EXPECT_CALL(mock_logger, logQubitState(QNIC_E, 1, 0, true, true)).Times(1);
+  QUISP_LOG(logger, QubitState, logQubitState(QNIC_E, count(), 0, true, true));
+  EXPECT_EQ(evaluated, 1);
+}
+
+}  // namespace
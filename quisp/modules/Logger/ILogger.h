@@ -4,6 +4,13 @@
 
 namespace quisp::modules::Logger {
 
+/// @brief the kinds of events a component logs, one bit of ILogger::enabled() each.
+enum class LogEventType : unsigned {
+  Packet,
+  QubitState,
+  BellPair,
+};
+
 /**
  * \brief Interface of Logger class. Logger class that inherits ILogger is
  * responsible for logging simulation results.
@@ -27,5 +34,38 @@ class ILogger {
   virtual void logBellPairInfo(const std::string& event_type, int partner_addr, quisp::modules::QNIC_type qnic_type, int qnic_index, int qubit_index) = 0;
   virtual void setModule(omnetpp::cModule const* const mod) = 0;
   virtual void setQNodeAddress(int address) = 0;
+
+  /**
+   * @brief false if the logger drops every event of the type, e.g. the DisabledLogger or a filter without the type.
+   *
+   * It isn't virtual, so QUISP_LOG checks it with a load and a branch before the arguments are evaluated.
+   */
+  bool enabled(LogEventType type) const { return enabled_events & (1u << static_cast<unsigned>(type)); }
+
+ protected:
+  void setEnabled(LogEventType type, bool enabled) {
+    auto bit = 1u << static_cast<unsigned>(type);
+    enabled_events = enabled ? enabled_events | bit : enabled_events & ~bit;
+  }
+
+  unsigned enabled_events = ~0u;
 };
 }  // namespace quisp::modules::Logger
+
+/**
+ * @brief logs the call on the logger if the logger is set and enables the event type, e.g.
+ * QUISP_LOG(logger, QubitState, logQubitState(qnic_type, qnic_index, qubit_index, is_busy, is_allocated));
+ *
+ * The arguments of the call aren't evaluated for a disabled event type, and the NO_LOGGING builds
+ * (make NO_LOGGING=1, see makefrag) define QUISP_NO_LOGGING, where it compiles to nothing.
+ */
+#ifdef QUISP_NO_LOGGING
+#define QUISP_LOG(logger, event_type, call) static_cast<void>(0)
+#else
+#define QUISP_LOG(logger, event_type, call)                                                                                 \
+  do {                                                                                                                      \
+    auto* quisp_log_logger = (logger);                                                                                      \
+    using quisp_log_event_type = ::quisp::modules::Logger::LogEventType;                                                    \
+    if (quisp_log_logger != nullptr && quisp_log_logger->enabled(quisp_log_event_type::event_type)) quisp_log_logger->call; \
+  } while (0)
+#endif
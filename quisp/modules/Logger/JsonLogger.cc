@@ -1,5 +1,7 @@
 #include "JsonLogger.h"
-#include <sstream>
+#include <iterator>
+#include <typeindex>
+#include <unordered_map>
 #include "messages/connection_setup_messages_m.h"
 
 namespace quisp::modules::Logger {
@@ -22,63 +24,94 @@ void JsonLogger::setModule(omnetpp::cModule const* const mod) {
 
 void JsonLogger::setQNodeAddress(int addr) { qnode_address = addr; }
 
+namespace {
+// the buffer of the record being built, reused by all the records of the thread
+fmt::memory_buffer& recordBuffer() {
+  thread_local fmt::memory_buffer buffer;
+  buffer.clear();
+  return buffer;
+}
+
+void formatConnectionSetupRequest(fmt::memory_buffer& buf, omnetpp::cMessage const* const msg) {
+  auto* req = static_cast<const ConnectionSetupRequest*>(msg);
+  fmt::format_to(std::back_inserter(buf),
+                 "\"msg_type\": \"ConnectionSetupRequest\", \"application_id\": {}, \"actual_dest_addr\": {}, \"actual_src_addr\": {}, \"num_measure\": {}, "
+                 "\"num_required_bell_pairs\": {}",
+                 req->getApplicationId(), req->getActual_destAddr(), req->getActual_srcAddr(), req->getNum_measure(), req->getNumber_of_required_Bellpairs());
+}
+
+void formatRejectConnectionSetupRequest(fmt::memory_buffer& buf, omnetpp::cMessage const* const msg) {
+  auto* req = static_cast<const RejectConnectionSetupRequest*>(msg);
+  fmt::format_to(std::back_inserter(buf),
+                 "\"msg_type\": \"RejectConnectionSetupRequest\", \"application_id\": {}, \"actual_dest_addr\": {}, \"actual_src_addr\": {}, \"num_required_bell_pairs\": {}",
+                 req->getApplicationId(), req->getActual_destAddr(), req->getActual_srcAddr(), req->getNumber_of_required_Bellpairs());
+}
+
+void formatConnectionSetupResponse(fmt::memory_buffer& buf, omnetpp::cMessage const* const msg) {
+  auto* req = static_cast<const ConnectionSetupResponse*>(msg);
+  fmt::format_to(std::back_inserter(buf),
+                 "\"msg_type\": \"ConnectionSetupResponse\", \"application_id\": {}, \"actual_dest_addr\": {}, \"actual_src_addr\": {}, \"ruleset_id\": {}, \"ruleset\": {}, "
+                 "\"application_type\": {}, \"stack_of_qnode_indices\": [",
+                 req->getApplicationId(), req->getActual_destAddr(), req->getActual_srcAddr(), req->getRuleSet_id(), req->getRuleSet().dump(), req->getApplication_type());
+  for (int i = 0; i < req->getStack_of_QNodeIndexesArraySize(); i++) {
+    if (i != 0) fmt::format_to(std::back_inserter(buf), ", ");
+    fmt::format_to(std::back_inserter(buf), "{}", req->getStack_of_QNodeIndexes(i));
+  }
+  buf.push_back(']');
+}
+
+using Formatter = void (*)(fmt::memory_buffer&, omnetpp::cMessage const* const);
+// the formatter of each exact message type, instead of trying dynamic_cast one by one
+const std::unordered_map<std::type_index, Formatter>& formatters() {
+  static const std::unordered_map<std::type_index, Formatter> table = {
+      {typeid(ConnectionSetupRequest), formatConnectionSetupRequest},
+      {typeid(RejectConnectionSetupRequest), formatRejectConnectionSetupRequest},
+      {typeid(ConnectionSetupResponse), formatConnectionSetupResponse},
+  };
+  return table;
+}
+}  // namespace
+
+void JsonLogger::log(const fmt::memory_buffer& record) { _logger->log(spdlog::level::info, spdlog::string_view_t(record.data(), record.size())); }
+
 void JsonLogger::logPacket(const std::string& event_type, omnetpp::cMessage const* const msg) {
-  auto current_time = omnetpp::simTime();
-  _logger->info("\"simtime\": {}, \"event_type\": \"{}\", \"address\": \"{}\", {}", current_time, event_type, qnode_address, format(msg));
+  auto& buf = recordBuffer();
+  fmt::format_to(std::back_inserter(buf), "\"simtime\": {}, \"event_type\": \"{}\", \"address\": \"{}\", ", omnetpp::simTime().str(), event_type, qnode_address);
+  formatTo(buf, msg);
+  log(buf);
 }
 
 void JsonLogger::logQubitState(quisp::modules::QNIC_type qnic_type, int qnic_index, int qubit_index, bool is_busy, bool is_allocated) {
-  auto current_time = omnetpp::simTime();
-  _logger->info(
+  auto& buf = recordBuffer();
+  fmt::format_to(
+      std::back_inserter(buf),
       "\"simtime\": {}, \"event_type\": \"QubitStateChange\", \"address\": \"{}\", \"qnic_type\": {}, \"qnic_index\": {}, \"qubit_index\": {}, \"busy\": {}, \"allocated\": {}",
-      current_time, qnode_address, qnic_type, qnic_index, qubit_index, is_busy, is_allocated);
+      omnetpp::simTime().str(), qnode_address, static_cast<int>(qnic_type), qnic_index, qubit_index, is_busy, is_allocated);
+  log(buf);
 }
 
-std::string JsonLogger::format(omnetpp::cMessage const* const msg) {
-  if (auto* req = dynamic_cast<const quisp::messages::ConnectionSetupRequest*>(msg)) {
-    std::stringstream os;
-    os << "\"msg_type\": \"ConnectionSetupRequest\"";
-    os << ", \"application_id\": " << req->getApplicationId();
-    os << ", \"actual_dest_addr\": " << req->getActual_destAddr();
-    os << ", \"actual_src_addr\": " << req->getActual_srcAddr();
-    os << ", \"num_measure\": " << req->getNum_measure();
-    os << ", \"num_required_bell_pairs\": " << req->getNumber_of_required_Bellpairs();
-    return os.str();
-  }
-  if (auto* req = dynamic_cast<const quisp::messages::RejectConnectionSetupRequest*>(msg)) {
-    std::stringstream os;
-    os << "\"msg_type\": \"RejectConnectionSetupRequest\"";
-    os << ", \"application_id\": " << req->getApplicationId();
-    os << ", \"actual_dest_addr\": " << req->getActual_destAddr();
-    os << ", \"actual_src_addr\": " << req->getActual_srcAddr();
-    os << ", \"num_required_bell_pairs\": " << req->getNumber_of_required_Bellpairs();
-    return os.str();
-  }
-  if (auto* req = dynamic_cast<const quisp::messages::ConnectionSetupResponse*>(msg)) {
-    std::stringstream os;
-    os << "\"msg_type\": \"ConnectionSetupResponse\"";
-    os << ", \"application_id\": " << req->getApplicationId();
-    os << ", \"actual_dest_addr\": " << req->getActual_destAddr();
-    os << ", \"actual_src_addr\": " << req->getActual_srcAddr();
-    os << ", \"ruleset_id\": " << req->getRuleSet_id();
-    os << ", \"ruleset\": " << req->getRuleSet();
-    os << ", \"application_type\": " << req->getApplication_type();
-    os << ", \"stack_of_qnode_indices\": [";
-    for (int i = 0; i < req->getStack_of_QNodeIndexesArraySize(); i++) {
-      if (i != 0) os << ", ";
-      os << req->getStack_of_QNodeIndexes(i);
-    }
-    os << "]";
-    return os.str();
+void JsonLogger::formatTo(fmt::memory_buffer& buf, omnetpp::cMessage const* const msg) {
+  auto& table = formatters();
+  auto it = table.find(typeid(*msg));
+  if (it != table.end()) {
+    it->second(buf, msg);
+    return;
   }
+  fmt::format_to(std::back_inserter(buf), "\"msg\": \"unknown class\": \"{}\"", msg->getFullPath());
+}
 
-  return "\"msg\": \"unknown class\": \"" + msg->getFullPath() + "\"";
+std::string JsonLogger::format(omnetpp::cMessage const* const msg) {
+  fmt::memory_buffer buf;
+  formatTo(buf, msg);
+  return fmt::to_string(buf);
 }
 
 void JsonLogger::logBellPairInfo(const std::string& event_type, int partner_addr, quisp::modules::QNIC_type qnic_type, int qnic_index, int qubit_index) {
-  auto current_time = omnetpp::simTime();
-  _logger->info("\"simtime\": {}, \"event_type\": \"BellPair{}\", \"address\": \"{}\", \"partner_addr\": {}, \"qnic_type\": {}, \"qnic_index\": {}, \"qubit_index\": {}",
-                current_time, event_type, qnode_address, partner_addr, qnic_type, qnic_index, qubit_index);
+  auto& buf = recordBuffer();
+  fmt::format_to(std::back_inserter(buf),
+                 "\"simtime\": {}, \"event_type\": \"BellPair{}\", \"address\": \"{}\", \"partner_addr\": {}, \"qnic_type\": {}, \"qnic_index\": {}, \"qubit_index\": {}",
+                 omnetpp::simTime().str(), event_type, qnode_address, partner_addr, static_cast<int>(qnic_type), qnic_index, qubit_index);
+  log(buf);
 }
 
 }  // namespace quisp::modules::Logger
@@ -1,5 +1,6 @@
 #pragma once
 #include <messages/classical_messages.h>
+#include <spdlog/fmt/fmt.h>
 #include <spdlog/fmt/ostr.h>
 #include <spdlog/spdlog.h>
 #include <memory>
@@ -22,7 +23,11 @@ class JsonLogger : public ILogger {
 
  protected:
   std::shared_ptr<spdlog::logger> _logger;
+  // appends the fields of msg to buf
+  static void formatTo(fmt::memory_buffer& buf, omnetpp::cMessage const* const msg);
   static std::string format(omnetpp::cMessage const* const msg);
+  // writes the record as it is, without formatting it again
+  void log(const fmt::memory_buffer& record);
 
   std::string module_path;
   int qnode_address = -1;
@@ -0,0 +1,99 @@
+#include <benchmark/benchmark.h>
+#include <spdlog/sinks/null_sink.h>
+#include <sstream>
+
+#include "JsonLogger.h"
+#include "messages/connection_setup_messages_m.h"
+#include "test_utils/TestUtils.h"
+
+namespace {
+using quisp::messages::ConnectionSetupRequest;
+using quisp::messages::ConnectionSetupResponse;
+using quisp::modules::Logger::JsonLogger;
+
+class BenchJsonLogger : public JsonLogger {
+ public:
+  using JsonLogger::formatTo;
+  BenchJsonLogger() : JsonLogger(std::make_shared<spdlog::logger>("bench_logger", std::make_shared<spdlog::sinks::null_sink_mt>())) {}
+};
+
+// the formatter before the fmt buffers, as the baseline
+std::string formatWithStringstream(omnetpp::cMessage const* const msg) {
+  if (auto* req = dynamic_cast<const quisp::messages::ConnectionSetupRequest*>(msg)) {
+    std::stringstream os;
+    os << "\"msg_type\": \"ConnectionSetupRequest\"";
+    os << ", \"application_id\": " << req->getApplicationId();
+    os << ", \"actual_dest_addr\": " << req->getActual_destAddr();
+    os << ", \"actual_src_addr\": " << req->getActual_srcAddr();
+    os << ", \"num_measure\": " << req->getNum_measure();
+    os << ", \"num_required_bell_pairs\": " << req->getNumber_of_required_Bellpairs();
+    return os.str();
+  }
+  if (auto* req = dynamic_cast<const quisp::messages::ConnectionSetupResponse*>(msg)) {
+    std::stringstream os;
+    os << "\"msg_type\": \"ConnectionSetupResponse\"";
+    os << ", \"application_id\": " << req->getApplicationId();
+    os << ", \"actual_dest_addr\": " << req->getActual_destAddr();
+    os << ", \"actual_src_addr\": " << req->getActual_srcAddr();
+    os << ", \"ruleset_id\": " << req->getRuleSet_id();
+    os << ", \"ruleset\": " << req->getRuleSet();
+    os << ", \"application_type\": " << req->getApplication_type();
+    os << ", \"stack_of_qnode_indices\": [";
+    for (int i = 0; i < req->getStack_of_QNodeIndexesArraySize(); i++) {
+      if (i != 0) os << ", ";
+      os << req->getStack_of_QNodeIndexes(i);
+    }
+    os << "]";
+    return os.str();
+  }
+  return "\"msg\": \"unknown class\": \"" + msg->getFullPath() + "\"";
+}
+
+ConnectionSetupResponse* newResponse() {
+  auto* res = new ConnectionSetupResponse();
+  res->setApplicationId(1);
+  res->setStack_of_QNodeIndexesArraySize(4);
+  for (int i = 0; i < 4; i++) res->setStack_of_QNodeIndexes(i, i);
+  return res;
+}
+
+static void BM_JsonLogger_FormatStringstream(benchmark::State& state) {
+  quisp_test::prepareSimulation();
+  ConnectionSetupRequest req;
+  std::unique_ptr<ConnectionSetupResponse> res(newResponse());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(formatWithStringstream(&req));
+    benchmark::DoNotOptimize(formatWithStringstream(res.get()));
+  }
+  state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(BM_JsonLogger_FormatStringstream);
+
+static void BM_JsonLogger_FormatToBuffer(benchmark::State& state) {
+  quisp_test::prepareSimulation();
+  ConnectionSetupRequest req;
+  std::unique_ptr<ConnectionSetupResponse> res(newResponse());
+  fmt::memory_buffer buf;
+  for (auto _ : state) {
+    buf.clear();
+    BenchJsonLogger::formatTo(buf, &req);
+    BenchJsonLogger::formatTo(buf, res.get());
+    benchmark::DoNotOptimize(buf.data());
+  }
+  state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(BM_JsonLogger_FormatToBuffer);
+
+// the whole record, written to a null sink
+static void BM_JsonLogger_LogQubitState(benchmark::State& state) {
+  quisp_test::prepareSimulation();
+  BenchJsonLogger logger;
+  int i = 0;
+  for (auto _ : state) {
+    logger.logQubitState(quisp::modules::QNIC_E, 0, i++ & 127, true, false);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_JsonLogger_LogQubitState);
+
+}  // namespace
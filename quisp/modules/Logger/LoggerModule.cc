@@ -4,6 +4,7 @@
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/spdlog.h>
 #include "JsonLogger.h"
+#include "utils/ComponentProvider.h"
 
 namespace quisp::modules::Logger {
 
@@ -11,7 +12,7 @@ LoggerModule::LoggerModule() {}
 
 LoggerModule::~LoggerModule() {
   if (logger_type == LoggerType::JsonLogger) {
-    if (spdlog_logger != nullptr) spdlog::shutdown();
+    if (spdlog_logger != nullptr) spdlog_logger->flush();
     return;
   }
 }
@@ -22,18 +23,45 @@ void LoggerModule::initialize() {
     return;
   }
   logger_type = toLoggerType(par("logger"));
+  try {
+    log_filter = std::make_shared<LogFilter>(par("log_event_filter").stdstringValue(), par("log_sampling_seed").intValue());
+  } catch (const std::invalid_argument& e) {
+    error("invalid log_event_filter: %s", e.what());
+  }
   if (logger_type == LoggerType::JsonLogger) {
     if (spdlog_logger != nullptr) return;
 
 #ifndef __EMSCRIPTEN__
-    spdlog_logger = spdlog::basic_logger_mt<spdlog::async_factory>("default_sim_result_logger", trimQuotes(par("log_filename").str()));
+    if (par("async_log").boolValue()) {
+      int queue_size = par("async_queue_size").intValue();
+      if (queue_size <= 0) error("async_queue_size must be positive: %d", queue_size);
+      auto policy = toOverflowPolicy(par("async_overflow_policy").stdstringValue());
+      // the pattern formatting and the file I/O happen on the single worker, which keeps the records in order
+      thread_pool = std::make_shared<spdlog::details::thread_pool>(queue_size, 1);
+      auto sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(trimQuotes(par("log_filename").str()));
+      spdlog_logger = std::make_shared<spdlog::async_logger>("default_sim_result_logger", sink, thread_pool, policy);
+    } else {
+      spdlog_logger = std::make_shared<spdlog::logger>("default_sim_result_logger", std::make_shared<spdlog::sinks::basic_file_sink_mt>(trimQuotes(par("log_filename").str())));
+    }
 #else
     // if the platform is WebAssembly, use single thread logger
-    spdlog_logger = spdlog::basic_logger_st("default_sim_result_logger", trimQuotes(par("log_filename").str()));
+    spdlog_logger = std::make_shared<spdlog::logger>("default_sim_result_logger", std::make_shared<spdlog::sinks::basic_file_sink_st>(trimQuotes(par("log_filename").str())));
 #endif
 
     return;
   }
+  if (logger_type == LoggerType::BinaryLogger) {
+    if (binary_log_writer != nullptr) return;
+    if (par("log_to_event_trace").boolValue()) {
+      // the records of the log are between the deliveries of the events that logged them
+      auto* event_trace = utils::ComponentProvider{this}.getEventTrace();
+      if (event_trace == nullptr) error("log_to_event_trace needs the event_trace_filename of SharedResource");
+      binary_log_writer = event_trace->getWriter();
+      return;
+    }
+    binary_log_writer = std::make_shared<BinaryLogWriter>(trimQuotes(par("log_filename").str()));
+    return;
+  }
   error("unknown logger specified: %s", par("logger").str().c_str());
 }
 
@@ -41,18 +69,30 @@ void LoggerModule::finish() {
   if (logger_type == LoggerType::JsonLogger) {
     if (spdlog_logger != nullptr) spdlog_logger->flush();
   }
+  if (logger_type == LoggerType::BinaryLogger) {
+    if (binary_log_writer != nullptr) binary_log_writer->flush();
+  }
 }
 
 ILogger* LoggerModule::getLogger() {
   if (logger_type == LoggerType::Disabled) return new DisabledLogger();
   if (logger_type == LoggerType::JsonLogger) {
     if (spdlog_logger == nullptr) error("failed to instantiate logger. spdlog is not initialized.");
-    return new JsonLogger(spdlog_logger);
+    return filtered(new JsonLogger(spdlog_logger));
+  }
+  if (logger_type == LoggerType::BinaryLogger) {
+    if (binary_log_writer == nullptr) error("failed to instantiate logger. the binary log is not opened.");
+    return filtered(new BinaryLogger(binary_log_writer));
   }
   error("valid logger is not specified.");
   return nullptr;
 }
 
+ILogger* LoggerModule::filtered(ILogger* logger) {
+  if (log_filter == nullptr || log_filter->acceptsAll()) return logger;
+  return new FilteredLogger(logger, log_filter);
+}
+
 std::string LoggerModule::trimQuotes(std::string s) {
   if (s.length() == 0) return s;
   if (s[0] == '\"') s = s.substr(1);
@@ -62,7 +102,14 @@ std::string LoggerModule::trimQuotes(std::string s) {
 
 LoggerType LoggerModule::toLoggerType(const std::string& s) {
   if (s == "JsonLogger") return LoggerType::JsonLogger;
+  if (s == "BinaryLogger") return LoggerType::BinaryLogger;
   return LoggerType::Unknown;
 }
 
+spdlog::async_overflow_policy LoggerModule::toOverflowPolicy(const std::string& s) {
+  if (s == "block") return spdlog::async_overflow_policy::block;
+  if (s == "overrun_oldest") return spdlog::async_overflow_policy::overrun_oldest;
+  throw omnetpp::cRuntimeError("unknown async_overflow_policy specified: %s", s.c_str());
+}
+
 }  // namespace quisp::modules::Logger
@@ -4,6 +4,8 @@
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/spdlog.h>
 #include <memory>
+#include "BinaryLogger.h"
+#include "FilteredLogger.h"
 #include "ILogger.h"
 
 namespace quisp::modules::Logger {
@@ -11,6 +13,7 @@ namespace quisp::modules::Logger {
 enum class LoggerType {
   Unknown,
   JsonLogger,
+  BinaryLogger,
   Disabled,
 };
 
@@ -24,10 +27,18 @@ class LoggerModule : public omnetpp::cSimpleModule {
 
  protected:
   std::shared_ptr<spdlog::logger> spdlog_logger;
+  // the worker of the async logger, kept until the logger is shut down
+  std::shared_ptr<spdlog::details::thread_pool> thread_pool;
+  std::shared_ptr<BinaryLogWriter> binary_log_writer;
+  // shared by the loggers so that the sampling draws from one generator
+  std::shared_ptr<LogFilter> log_filter;
   LoggerType logger_type = LoggerType::Unknown;
 
+  // wraps logger with log_filter if it filters any event
+  ILogger* filtered(ILogger* logger);
   static std::string trimQuotes(std::string s);
   static LoggerType toLoggerType(const std::string& s);
+  static spdlog::async_overflow_policy toOverflowPolicy(const std::string& s);
 };
 Define_Module(LoggerModule);
 }  // namespace quisp::modules::Logger
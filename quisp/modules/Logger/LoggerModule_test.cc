@@ -11,6 +11,7 @@ using namespace quisp::modules;
 class LoggerModule : public quisp::modules::Logger::LoggerModule {
  public:
   using quisp::modules::Logger::LoggerModule::toLoggerType;
+  using quisp::modules::Logger::LoggerModule::toOverflowPolicy;
   using quisp::modules::Logger::LoggerModule::trimQuotes;
 };
 class LoggerModuleTest : public testing::Test {
@@ -22,6 +23,12 @@ class LoggerModuleTest : public testing::Test {
     setParBool(logger_module, "enabled_log", true);
     setParStr(logger_module, "log_filename", "test.log");
     setParStr(logger_module, "logger", "JsonLogger");
+    setParBool(logger_module, "log_to_event_trace", false);
+    setParStr(logger_module, "log_event_filter", "");
+    setParInt(logger_module, "log_sampling_seed", 0);
+    setParBool(logger_module, "async_log", true);
+    setParInt(logger_module, "async_queue_size", 8192);
+    setParStr(logger_module, "async_overflow_policy", "block");
     sim->registerComponent(logger_module);
   }
   void TearDown() { logger_module->deleteModule(); }
@@ -39,9 +46,16 @@ TEST_F(LoggerModuleTest, trimQuote) {
 TEST_F(LoggerModuleTest, toLoggerType) {
   using quisp::modules::Logger::LoggerType;
   EXPECT_EQ(LoggerModule::toLoggerType("JsonLogger"), LoggerType::JsonLogger);
+  EXPECT_EQ(LoggerModule::toLoggerType("BinaryLogger"), LoggerType::BinaryLogger);
   EXPECT_EQ(LoggerModule::toLoggerType("UnknownLogger"), LoggerType::Unknown);
 }
 
+TEST_F(LoggerModuleTest, toOverflowPolicy) {
+  EXPECT_EQ(LoggerModule::toOverflowPolicy("block"), spdlog::async_overflow_policy::block);
+  EXPECT_EQ(LoggerModule::toOverflowPolicy("overrun_oldest"), spdlog::async_overflow_policy::overrun_oldest);
+  EXPECT_THROW(LoggerModule::toOverflowPolicy("unknown"), omnetpp::cRuntimeError);
+}
+
 TEST_F(LoggerModuleTest, initialize) { logger_module->callInitialize(); }
 
 TEST_F(LoggerModuleTest, finish) {
@@ -55,6 +69,30 @@ TEST_F(LoggerModuleTest, getLogger) {
   ASSERT_NE(logger, nullptr);
 }
 
+TEST_F(LoggerModuleTest, getSyncLogger) {
+  setParBool(logger_module, "async_log", false);
+  logger_module->callInitialize();
+  auto *logger = logger_module->getLogger();
+  ASSERT_NE(logger, nullptr);
+  logger_module->callFinish();
+}
+
+TEST_F(LoggerModuleTest, getBinaryLogger) {
+  setParStr(logger_module, "logger", "BinaryLogger");
+  setParStr(logger_module, "log_filename", "test.blog");
+  logger_module->callInitialize();
+  auto *logger = logger_module->getLogger();
+  EXPECT_NE(dynamic_cast<quisp::modules::Logger::BinaryLogger *>(logger), nullptr);
+  logger_module->callFinish();
+}
+
+TEST_F(LoggerModuleTest, getFilteredLogger) {
+  setParStr(logger_module, "log_event_filter", "ConnectionSetupRequest QubitStateChange:0.01");
+  logger_module->callInitialize();
+  auto *logger = logger_module->getLogger();
+  EXPECT_NE(dynamic_cast<quisp::modules::Logger::FilteredLogger *>(logger), nullptr);
+}
+
 TEST_F(LoggerModuleTest, getDisabledLogger) {
   setParBool(logger_module, "enabled_log", false);
   logger_module->callInitialize();
@@ -18,11 +18,15 @@ Define_Module(BSAController);
 
 BSAController::BSAController() : provider(utils::ComponentProvider{this}) {}
 
-BSAController::~BSAController() { cancelAndDelete(time_out_message); }
+BSAController::~BSAController() {
+  cancelAndDelete(time_out_message);
+  cancelAndDelete(visibility_timer);
+}
 
 void BSAController::finish() { std::cout << "last BSM message that was sent " << last_result_send_time << "\n"; }
 
 void BSAController::initialize() {
+  event_profiler = provider.getEventProfiler();
   bsa = check_and_cast<BellStateAnalyzer *>(getParentModule()->getSubmodule("bsa"));
   // if this BSA is internal set left to be self node
   if (strcmp(getParentModule()->getName(), "qnic_r") == 0 || strcmp(getParentModule()->getName(), "qnic_rp") == 0) {
@@ -44,18 +48,30 @@ void BSAController::initialize() {
     simtime_t first_notification_timer = SimTime(par("initial_notification_timing_buffer").doubleValue());
     right_qnic = getExternalQNICInfoFromPort(1);
     offset_time_for_first_photon = calculateOffsetTimeFromDistance();
+    for (int port = 0; port < 2; port++) {
+      auto *channel = dynamic_cast<const channels::FreeSpaceChannel *>(bsa->gate("quantum_port$i", port)->getIncomingTransmissionChannel());
+      if (channel != nullptr) free_space_channels.push_back(channel);
+    }
+    if (!free_space_channels.empty()) visibility_timer = new cMessage("LinkVisibilityTimer");
     scheduleAt(first_notification_timer, time_out_message);
   }
 }
 
 void BSAController::handleMessage(cMessage *msg) {
+  modules::SharedResource::EventProfiler::Scope profile(event_profiler, this, msg);
+  if (msg == visibility_timer) {
+    setLinkVisible(true);
+    return;
+  }
   if (msg == time_out_message) {
+    bsa->resetState();
+    // the satellite out of view for good ends the link
+    if (deferRoundToVisibility() == SimTime::getMaxTime()) return;
     send(generateFirstNotificationTiming(true), "to_router");
     send(generateFirstNotificationTiming(false), "to_router");
-    bsa->resetState();
     // set timeout to be twice the travel time plus number of no response
     time_out_count++;
-    scheduleAt(simTime() + (2 + time_out_count) * (offset_time_for_first_photon), msg);
+    scheduleAt(simTime() + round_deferral + (2 + time_out_count) * (offset_time_for_first_photon), msg);
     return;
   }
   if (dynamic_cast<CancelBSMTimeOutMsg *>(msg)) {
@@ -75,20 +91,23 @@ void BSAController::handleMessage(cMessage *msg) {
 
 void BSAController::sendMeasurementResults(BatchClickEvent *batch_click_msg) {
   if (is_active) {
+    deferRoundToVisibility();
     CombinedBSAresults *leftpk = generateNextNotificationTiming(true);
     CombinedBSAresults *rightpk = generateNextNotificationTiming(false);
+    CompactClickResults left_successes, right_successes;
     for (int index = 0; index < batch_click_msg->numberOfClicks(); index++) {
-      if (!batch_click_msg->getClickResults(index).success) continue;
-      leftpk->appendSuccessIndex(index);
-      leftpk->appendCorrectionOperation(PauliOperator::I);
-      leftpk->setNeighborAddress(right_qnic.parent_node_addr);
-      rightpk->appendSuccessIndex(index);
-      rightpk->appendCorrectionOperation(batch_click_msg->getClickResults(index).correction_operation);
-      rightpk->setNeighborAddress(left_qnic.parent_node_addr);
+      auto &click_result = batch_click_msg->getClickResults(index);
+      if (!click_result.success) continue;
+      left_successes.append(index, PauliOperator::I, click_result.pauli_error);
+      right_successes.append(index, click_result.correction_operation, click_result.pauli_error);
     }
+    leftpk->setSuccesses(left_successes);
+    leftpk->setNeighborAddress(right_qnic.parent_node_addr);
+    rightpk->setSuccesses(right_successes);
+    rightpk->setNeighborAddress(left_qnic.parent_node_addr);
     send(leftpk, "to_router");
     send(rightpk, "to_router");
-    scheduleAt(simTime() + 1.1 * offset_time_for_first_photon, time_out_message);
+    if (round_deferral < SimTime::getMaxTime()) scheduleAt(simTime() + round_deferral + 1.1 * offset_time_for_first_photon, time_out_message);
   } else {
     SingleClickResult *click_result = new SingleClickResult();
     if (batch_click_msg->numberOfClicks() != 1) {
@@ -111,7 +130,7 @@ BSMTimingNotification *BSAController::generateFirstNotificationTiming(bool is_le
   auto travel_time = (is_left) ? left_travel_time : right_travel_time;
 
   // The node should emit at <arrival_time - travel_time>
-  simtime_t arrival_time = simTime() + offset_time_for_first_photon;
+  simtime_t arrival_time = simTime() + round_deferral + offset_time_for_first_photon;
   simtime_t emit_time = arrival_time - travel_time;
 
   notification_packet->setSrcAddr(address);
@@ -130,9 +149,9 @@ CombinedBSAresults *BSAController::generateNextNotificationTiming(bool is_left)
   auto *notification_packet = new CombinedBSAresults();
   auto travel_time = (is_left) ? left_travel_time : right_travel_time;
 
-  // The node should emit at <arrival_time - travel_time>
-  simtime_t arrival_time = simTime() + offset_time_for_first_photon;
-  simtime_t emit_time = arrival_time - travel_time;
+  // The node should emit at <arrival_time - travel_time>, and never again if the satellite doesn't come back
+  simtime_t emit_time = SimTime::getMaxTime();
+  if (round_deferral < SimTime::getMaxTime()) emit_time = simTime() + round_deferral + offset_time_for_first_photon - travel_time;
 
   notification_packet->setSrcAddr(address);
   notification_packet->setDestAddr(destination);
@@ -143,6 +162,37 @@ CombinedBSAresults *BSAController::generateNextNotificationTiming(bool is_left)
   return notification_packet;
 }
 
+simtime_t BSAController::deferRoundToVisibility() {
+  round_deferral = SIMTIME_ZERO;
+  if (free_space_channels.empty()) return round_deferral;
+  simtime_t arrival_time = simTime() + offset_time_for_first_photon;
+  auto visible_time = channels::FreeSpaceChannel::getNextVisibleTime(free_space_channels, arrival_time);
+  if (visible_time == arrival_time) return round_deferral;
+  // the nodes hold their emission until the window, without the rounds of lost photons in between
+  setLinkVisible(false);
+  if (visible_time == SimTime::getMaxTime()) {
+    round_deferral = visible_time;
+    return round_deferral;
+  }
+  cancelEvent(visibility_timer);
+  scheduleAt(visible_time, visibility_timer);
+  round_deferral = visible_time - arrival_time;
+  return round_deferral;
+}
+
+void BSAController::setLinkVisible(bool visible) {
+  if (link_visible == visible) return;
+  link_visible = visible;
+  for (bool is_left : {true, false}) {
+    auto *pk = new QuantumLinkVisibility("QuantumLinkVisibility");
+    pk->setSrcAddr(address);
+    pk->setDestAddr(is_left ? left_qnic.parent_node_addr : right_qnic.parent_node_addr);
+    pk->setNeighbor_address(is_left ? right_qnic.parent_node_addr : left_qnic.parent_node_addr);
+    pk->setVisible(visible);
+    send(pk, "to_router");
+  }
+}
+
 simtime_t BSAController::calculateOffsetTimeFromDistance() {
   auto one_way_longer_travel_time = std::max(getTravelTimeFromPort(0), getTravelTimeFromPort(1));
   // we add 10 times the photon interval to offset the travel time for safety in case RuleEngine has internal delay;
@@ -9,6 +9,7 @@
 #include <omnetpp.h>
 
 #include "PhotonicQubit_m.h"
+#include "channels/FreeSpaceChannel.h"
 #include "messages/classical_messages.h"
 #include "modules/PhysicalConnection/BSA/BellStateAnalyzer.h"
 #include "modules/PhysicalConnection/BSA/types.h"
@@ -65,6 +66,11 @@ class BSAController : public cSimpleModule {
   double getExternalDistanceFromPort(int port);
   QNicInfo getExternalQNICInfoFromPort(int port);
   void sendMeasurementResults(BatchClickEvent* msg);
+  // defers the next round to the time the satellites of the free space channels are in view, and returns the deferral.
+  // SimTime::getMaxTime() if one never comes back
+  simtime_t deferRoundToVisibility();
+  // notifies both nodes of the link state, as the routing avoids the link while it's out of view
+  void setLinkVisible(bool visible);
 
   // information for communications
   int address;
@@ -78,11 +84,18 @@ class BSAController : public cSimpleModule {
   BSMNotificationTimeout* time_out_message;
   std::vector<BSAClickResult> click_results;
   int time_out_count;
+  // the channels of the ports to the satellites, and the time the next round waits for them
+  std::vector<const channels::FreeSpaceChannel*> free_space_channels;
+  simtime_t round_deferral = SIMTIME_ZERO;
+  bool link_visible = true;
+  // brings the link up at the start of the visibility window
+  cMessage* visibility_timer = nullptr;
 
   // BSA characteristics
   simtime_t time_interval_between_photons;  ///< how separated should the photons be; is calculated by the dead time of the detector
   simtime_t speed_of_light_in_channel;  ///< Speed of light in optical fiber (in km per sec).
   utils::ComponentProvider provider;
+  modules::SharedResource::EventProfiler *event_profiler = nullptr;
   bool is_active;
   BellStateAnalyzer* bsa;
 
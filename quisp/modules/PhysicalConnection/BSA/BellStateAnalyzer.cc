@@ -5,6 +5,7 @@
 #include "BellStateAnalyzer.h"
 
 #include <omnetpp/cexception.h>
+#include <cstring>
 #include <vector>
 
 using namespace omnetpp;
@@ -21,14 +22,31 @@ Define_Module(BellStateAnalyzer);
 
 BellStateAnalyzer::BellStateAnalyzer() : provider(utils::ComponentProvider{this}) {}
 
+BellStateAnalyzer::~BellStateAnalyzer() { cancelAndDelete(photon_trains_timer); }
+
 void BellStateAnalyzer::initialize() {
+  event_profiler = provider.getEventProfiler();
   state = BSAState::Idle;
   darkcount_probability = par("darkcount_probability").doubleValue();
   detection_efficiency = par("detection_efficiency").doubleValue();
   indistinguishability_window = SimTime(par("indistinguishable_time_window").doubleValue() * 1000, SIMTIME_PS);
   collection_efficiency = par("collection_efficiency").doubleValue();
   backend = provider.getQuantumBackend();
+  photon_trains_timer = new cMessage("PhotonTrainsArrival");
+  link_workers = provider.getLinkWorkers();
+  if (link_workers != nullptr) {
+    // the stream of the qnic_r the BSA is in, or of the BSA node
+    auto *parent = getParentModule();
+    if (parent->hasPar("self_qnic_index")) {
+      round_rng = provider.getStreamRNG(parent->par("self_qnic_index").intValue(), -1, strcmp(parent->getName(), "qnic_rp") == 0 ? QNIC_RP : QNIC_R);
+    } else {
+      round_rng = provider.getStreamRNG(-1, -1, static_cast<QNIC_type>(-1));
+    }
+  }
   validateProperties();
+  collection_loss_sampler = fast_link::BernoulliSkipSampler(1 - collection_efficiency);
+  darkcount_sampler = fast_link::BernoulliSkipSampler(darkcount_probability);
+  detection_miss_sampler = fast_link::BernoulliSkipSampler(1 - detection_efficiency);
 }
 
 /**
@@ -37,12 +55,40 @@ void BellStateAnalyzer::initialize() {
  * it will be entangled. We assume that we can distinguish between Psi+/- while
  * we cannot Phi+/- cannot be distinguished. Gate operations will be applied on the photons.
  *
- * @param msg must be of type PhotonicQubit message
+ * @param msg must be of type PhotonicQubit or PhotonicQubitTrain message
  */
 void BellStateAnalyzer::handleMessage(cMessage *msg) {
-  auto photon = getPhotonRecordFromMessage(static_cast<PhotonicQubit *>(msg));
+  modules::SharedResource::EventProfiler::Scope profile(event_profiler, this, msg);
+  if (msg == photon_trains_timer) {
+    if (photon_trains[0] && photon_trains[1])
+      processPhotonTrains();
+    else
+      processPhotonRecords();
+    return;
+  }
+  if (auto *train = dynamic_cast<PhotonicQubitTrain *>(msg)) {
+    acceptPhotonTrainMessage(train);
+    return;
+  }
+  auto *photon_msg = static_cast<PhotonicQubit *>(msg);
+  auto photon = getPhotonRecordFromMessage(photon_msg);
+  // the lost photons the channel dropped arrived before this one. the ones of a round already over would be gone with it
+  for (size_t i = 0; i < photon_msg->getNumDroppedPhotons(); i++) {
+    PhotonRecord dropped{.qubit_ref = nullptr,
+                         .arrival_time = photon_msg->getDroppedArrivalTime(i),
+                         .from_port = photon.from_port,
+                         .is_lost = true,
+                         .is_first = false,
+                         .is_last = false,
+                         .has_x_error = false,
+                         .has_z_error = false};
+    if (dropped.arrival_time >= records_cleared_time) acceptPhoton(dropped);
+  }
   delete msg;
+  acceptPhoton(photon);
+}
 
+void BellStateAnalyzer::acceptPhoton(PhotonRecord &photon) {
   // clang-format off
   if ((state == BSAState::Idle && !photon.is_first) ||
       (state == BSAState::AcceptingFirstPort && photon.from_port == PortNumber::Second) ||
@@ -109,6 +155,7 @@ void BellStateAnalyzer::processPhotonRecords() {
   }
   first_port_records.clear();
   second_port_records.clear();
+  records_cleared_time = simTime();
   send(batch_click_msg, "to_bsa_controller");
 }
 
@@ -125,32 +172,61 @@ PhotonRecord BellStateAnalyzer::getPhotonRecordFromMessage(PhotonicQubit *photon
   return photon;
 }
 
+void BellStateAnalyzer::acceptPhotonTrainMessage(PhotonicQubitTrain *train) {
+  auto port = train->arrivedOn("quantum_port$i", 0) ? PortNumber::First : PortNumber::Second;
+  auto &records = port == PortNumber::First ? first_port_records : second_port_records;
+  // a new train of the same port starts the round over, as the first photon does
+  for (auto &photon : records) discardPhoton(photon);
+  records.clear();
+  auto num_photons = train->getNumPhotons();
+  records.reserve(num_photons);
+  for (size_t i = 0; i < num_photons; i++) {
+    auto &photon = train->getPhoton(i);
+    records.push_back({.qubit_ref = photon.qubit_ref,
+                       .arrival_time = train->getArrivalTime() + photon.emission_offset,
+                       .from_port = port,
+                       .is_lost = photon.is_lost,
+                       .is_first = i == 0,
+                       .is_last = i == num_photons - 1,
+                       .has_x_error = photon.has_x_error,
+                       .has_z_error = photon.has_z_error});
+  }
+  delete train;
+
+  if (first_port_records.empty() || second_port_records.empty()) return;
+  send(new CancelBSMTimeOutMsg(), "to_bsa_controller");
+  // the jitters may swap the photons, so the last one to arrive isn't always the last of the train
+  simtime_t last_arrival_time = SIMTIME_ZERO;
+  for (auto &photon : first_port_records) last_arrival_time = std::max(last_arrival_time, photon.arrival_time);
+  for (auto &photon : second_port_records) last_arrival_time = std::max(last_arrival_time, photon.arrival_time);
+  cancelEvent(photon_trains_timer);
+  scheduleAt(last_arrival_time, photon_trains_timer);
+}
+
 BSAClickResult BellStateAnalyzer::processIndistinguishPhotons(PhotonRecord &p, PhotonRecord &q) {
+  // the rare outcomes of a long train are sampled by their gaps, and the draws nobody looks at are skipped.
+  // the trials are independent, so the statistics are the same as a random number for each of them
+  auto uniform = [this]() { return dblrand(); };
   // although the photons get out of the fiber, we still need to roll the rng whether it will get collected by the detectors
-  if (dblrand() > collection_efficiency) p.is_lost = true;
-  if (dblrand() > collection_efficiency) q.is_lost = true;
-
-  bool left_darkcount_click = dblrand() < darkcount_probability;
-  bool right_darkcount_click = dblrand() < darkcount_probability;
-  // false positive case
-  if ((p.is_lost && left_darkcount_click && q.is_lost && right_darkcount_click) || (!p.is_lost && q.is_lost && right_darkcount_click) ||
-      (p.is_lost && left_darkcount_click && !q.is_lost)) {
+  if (collection_loss_sampler.next(uniform)) p.is_lost = true;
+  if (collection_loss_sampler.next(uniform)) q.is_lost = true;
+
+  // false positive case: the dark counts click in place of all the lost photons
+  if ((p.is_lost || q.is_lost) && (!p.is_lost || darkcount_sampler.next(uniform)) && (!q.is_lost || darkcount_sampler.next(uniform))) {
     discardPhoton(p);
     discardPhoton(q);
     // correction operation doesn't really matter but we still make it 50:50
-    return {.success = true, .correction_operation = (dblrand() < 0.5) ? PauliOperator::X : PauliOperator::Y};
+    auto correction_operation = (dblrand() < 0.5) ? PauliOperator::X : PauliOperator::Y;
+    return {.success = true, .correction_operation = correction_operation, .pauli_error = darkcountPauliError()};
   }
 
   // we assume that only Psi+/- can de distinguished while we can't for Phi+/-
-  bool isPsi = dblrand() < 0.5;
-  bool left_click = dblrand() < detection_efficiency;
-  bool right_click = dblrand() < detection_efficiency;
-  if (!p.is_lost && !q.is_lost && isPsi && left_click && right_click) {
+  if (!p.is_lost && !q.is_lost && dblrand() < 0.5 && !detection_miss_sampler.next(uniform) && !detection_miss_sampler.next(uniform)) {
     bool isPsiPlus = dblrand() < 0.5;
-    measureSuccessfully(p, q, isPsiPlus);
+    auto pauli_error = measureSuccessfully(p, q, isPsiPlus);
     discardPhoton(p);
     discardPhoton(q);
-    return {.success = true, .correction_operation = isPsiPlus ? PauliOperator::X : PauliOperator::Y};
+    return {.success = true, .correction_operation = isPsiPlus ? PauliOperator::X : PauliOperator::Y, .pauli_error = pauli_error};
   }
 
   discardPhoton(p);
@@ -162,6 +238,97 @@ void BellStateAnalyzer::resetState() {
   state = BSAState::Idle;
   first_port_records.clear();
   second_port_records.clear();
+  records_cleared_time = simTime();
+  photon_trains = {};
+  if (round_ticket.has_value()) link_workers->withdraw(*round_ticket);
+  round_ticket.reset();
+  cancelEvent(photon_trains_timer);
+}
+
+void BellStateAnalyzer::acceptPhotonTrain(int port, std::vector<backends::abstract::IQubit *> memory_qubits, simtime_t first_arrival_time, simtime_t interval,
+                                          double emission_success_probability, const channels::QuantumChannel *channel, int num_lost_photons) {
+  Enter_Method("acceptPhotonTrain()");
+  if (port < 0 || port > 1) error("photon train on an unknown port %d", port);
+  if (memory_qubits.empty()) return;
+  // no channel means a lossless connection
+  auto outcomes = channel == nullptr ? std::array<double, 5>{1, 0, 0, 0, 0} : channel->getPhotonOutcomeProbabilities();
+  double not_lost = 1 - outcomes[4];
+  std::array<double, 4> pauli_probabilities{1, 0, 0, 0};
+  if (not_lost > 0) pauli_probabilities = {outcomes[0] / not_lost, outcomes[1] / not_lost, outcomes[2] / not_lost, outcomes[3] / not_lost};
+  auto last_arrival_time = first_arrival_time + interval * (long)(memory_qubits.size() - 1);
+  photon_trains[port] =
+      PhotonTrainRecord{std::move(memory_qubits), last_arrival_time, emission_success_probability * not_lost * collection_efficiency, pauli_probabilities, num_lost_photons};
+
+  if (!photon_trains[0] || !photon_trains[1]) return;
+  // the controller stops waiting for the photons, as it does when the first photons of both sides arrive
+  send(new CancelBSMTimeOutMsg(), "to_bsa_controller");
+  if (link_workers != nullptr) {
+    if (round_ticket.has_value()) link_workers->withdraw(*round_ticket);
+    // the job only reads the copies and writes the outcomes of this BSA, until the timer waits for it
+    int num_pairs = std::min(photon_trains[0]->memory_qubits.size(), photon_trains[1]->memory_qubits.size());
+    auto probabilities = fast_link::pairProbabilities(photon_trains[0]->arrival_probability, photon_trains[1]->arrival_probability, detection_efficiency, darkcount_probability);
+    round_ticket = link_workers->submit(
+        [this, num_pairs, probabilities, left_pauli = photon_trains[0]->pauli_probabilities, right_pauli = photon_trains[1]->pauli_probabilities]() {
+          round_outcomes = fast_link::sampleRoundOutcomes(num_pairs, probabilities, left_pauli, right_pauli, *round_rng);
+        });
+  }
+  scheduleAt(std::max(photon_trains[0]->last_arrival_time, photon_trains[1]->last_arrival_time), photon_trains_timer);
+}
+
+PhotonRecord BellStateAnalyzer::emitPhotonFromMemory(backends::abstract::IQubit *memory_qubit, int photon_error) {
+  // the same as StationaryQubit::generateEntangledPhoton and QuantumChannel::processMessage
+  auto *photon_ref = backend->getShortLiveQubit();
+  memory_qubit->noiselessH();
+  memory_qubit->noiselessCNOT(photon_ref);
+  PhotonRecord photon{.qubit_ref = photon_ref, .is_lost = false, .has_x_error = photon_error == 1 || photon_error == 3, .has_z_error = photon_error >= 2};
+  if (photon.has_x_error) photon_ref->noiselessX();
+  if (photon.has_z_error) photon_ref->noiselessZ();
+  return photon;
+}
+
+std::vector<fast_link::PairOutcome> BellStateAnalyzer::sampleRoundOutcomes() {
+  if (link_workers != nullptr) {
+    link_workers->wait(*round_ticket);
+    round_ticket.reset();
+    return std::move(round_outcomes);
+  }
+  auto &left = *photon_trains[0];
+  auto &right = *photon_trains[1];
+  int num_pairs = std::min(left.memory_qubits.size(), right.memory_qubits.size());
+  auto probabilities = fast_link::pairProbabilities(left.arrival_probability, right.arrival_probability, detection_efficiency, darkcount_probability);
+  backend::rng::RNG rng{this};
+  return fast_link::sampleRoundOutcomes(num_pairs, probabilities, left.pauli_probabilities, right.pauli_probabilities, rng);
+}
+
+void BellStateAnalyzer::processPhotonTrains() {
+  auto &left = *photon_trains[0];
+  auto &right = *photon_trains[1];
+  int num_pairs = std::min(left.memory_qubits.size(), right.memory_qubits.size());
+  std::vector<BSAClickResult> click_results(num_pairs, {.success = false, .correction_operation = PauliOperator::I});
+  int num_lost_pairs = std::max(left.num_lost_photons, right.num_lost_photons);
+  for (auto &outcome : sampleRoundOutcomes()) {
+    // the outcomes are still sampled for all the pairs, to keep the random stream of the round
+    if (outcome.index < num_lost_pairs) continue;
+    auto p = emitPhotonFromMemory(left.memory_qubits[outcome.index], outcome.left_photon_error);
+    auto q = emitPhotonFromMemory(right.memory_qubits[outcome.index], outcome.right_photon_error);
+    auto correction_operation = outcome.is_psi_plus ? PauliOperator::X : PauliOperator::Y;
+    if (outcome.darkcount) {
+      // a dark count; the memories stay entangled with the discarded photons
+      discardPhoton(p);
+      discardPhoton(q);
+      // correction operation doesn't really matter but we still make it 50:50
+      click_results[outcome.index] = {.success = true, .correction_operation = correction_operation, .pauli_error = outcome.darkcount_error};
+      continue;
+    }
+    auto pauli_error = measureSuccessfully(p, q, outcome.is_psi_plus);
+    discardPhoton(p);
+    discardPhoton(q);
+    click_results[outcome.index] = {.success = true, .correction_operation = correction_operation, .pauli_error = pauli_error};
+  }
+  auto *batch_click_msg = new BatchClickEvent();
+  for (auto &click_result : click_results) batch_click_msg->appendClickResults(click_result);
+  photon_trains = {};
+  send(batch_click_msg, "to_bsa_controller");
 }
 
 void BellStateAnalyzer::validateProperties() {
@@ -179,7 +346,10 @@ void BellStateAnalyzer::validateProperties() {
     throw std::runtime_error("BellStateAnalyzer::parameter validation fail; collection_efficiency does not in the [0, 1] range");
 }
 
-void BellStateAnalyzer::measureSuccessfully(PhotonRecord &p, PhotonRecord &q, bool is_psi_plus) {
+// the memories of a dark count are left with the discarded photons, i.e. a Bell pair under a uniformly random Pauli error
+PauliOperator BellStateAnalyzer::darkcountPauliError() { return static_cast<PauliOperator>(intrand(4)); }
+
+PauliOperator BellStateAnalyzer::measureSuccessfully(PhotonRecord &p, PhotonRecord &q, bool is_psi_plus) {
   auto p_ref = p.qubit_ref;
   auto q_ref = q.qubit_ref;
 
@@ -208,6 +378,14 @@ void BellStateAnalyzer::measureSuccessfully(PhotonRecord &p, PhotonRecord &q, bo
   p_ref->noiselessCNOT(q_ref);
   p_ref->noiselessMeasureX(backends::abstract::EigenvalueResult::PLUS_ONE);
   q_ref->noiselessMeasureZ(backends::abstract::EigenvalueResult::PLUS_ONE);
+
+  // the errors of both photons end up on the pair
+  bool x_error = p.has_x_error != q.has_x_error;
+  bool z_error = p.has_z_error != q.has_z_error;
+  if (x_error && z_error) return PauliOperator::Y;
+  if (x_error) return PauliOperator::X;
+  if (z_error) return PauliOperator::Z;
+  return PauliOperator::I;
 }
 
 void BellStateAnalyzer::finish() {
@@ -215,6 +393,9 @@ void BellStateAnalyzer::finish() {
   std::cout << "    " << no_error_count << ' ' << x_error_count << ' ' << y_error_count << ' ' << z_error_count << '\n';
 }
 
-void BellStateAnalyzer::discardPhoton(PhotonRecord &photon) { photon.qubit_ref->relaseBackToPool(); };
+// the photons dropped by the channel released their qubits already
+void BellStateAnalyzer::discardPhoton(PhotonRecord &photon) {
+  if (photon.qubit_ref != nullptr) photon.qubit_ref->relaseBackToPool();
+}
 
 }  // namespace quisp::modules
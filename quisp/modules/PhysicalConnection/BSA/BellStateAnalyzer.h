@@ -1,8 +1,14 @@
 #pragma once
 
 #include <omnetpp.h>
+#include <array>
+#include <memory>
+#include <optional>
+#include <vector>
 
+#include "modules/PhysicalConnection/BSA/FastLinkSampler.h"
 #include "PhotonicQubit_m.h"
+#include "channels/QuantumChannel.h"
 #include "backends/Backends.h"
 #include "backends/interfaces/IQubit.h"
 #include "messages/BSA_ipc_messages_m.h"
@@ -27,8 +33,22 @@ namespace quisp::modules {
 class BellStateAnalyzer : public omnetpp::cSimpleModule {
  public:
   BellStateAnalyzer();
+  ~BellStateAnalyzer();
   void resetState();
 
+  /**
+   * @brief accepts the photon train of a round at once, for the fast link layer of RuleEngine.
+   *
+   * No photon travels. Once the trains of both ports arrive, the successful pairs are sampled at the time
+   * the last photon would arrive, and the memory qubits of those pairs are entangled directly in the backend
+   * with the errors of the channels, as the photons would do. The result goes to the BSAController as usual.
+   *
+   * @param channel the channel the photons would travel through, for the loss and the errors. nullptr for a lossless connection
+   * @param num_lost_photons the first photons of the train lost on the way, e.g. in a reconfiguring PhotonicSwitch
+   */
+  void acceptPhotonTrain(int port, std::vector<backends::abstract::IQubit *> memory_qubits, omnetpp::simtime_t first_arrival_time, omnetpp::simtime_t interval,
+                         double emission_success_probability, const channels::QuantumChannel *channel, int num_lost_photons = 0);
+
  protected:
   virtual void initialize() override;
   virtual void finish() override;
@@ -37,10 +57,21 @@ class BellStateAnalyzer : public omnetpp::cSimpleModule {
  private:
   void discardPhoton(PhotonRecord &photon);
   PhotonRecord getPhotonRecordFromMessage(messages::PhotonicQubit *);
+  // moves the state of the round on with the photon of a PhotonicQubit, or one the channel dropped
+  void acceptPhoton(PhotonRecord &photon);
+  // stores the photons of the train as the records of its port, and processes them after both trains arrive
+  void acceptPhotonTrainMessage(messages::PhotonicQubitTrain *train);
   void processPhotonRecords();
   physical::types::BSAClickResult processIndistinguishPhotons(PhotonRecord &left_photon, PhotonRecord &right_photon);
-  void measureSuccessfully(PhotonRecord &left_photon, PhotonRecord &right_photon, bool is_psi_plus);
+  // returns the Pauli error the photons left on the Bell pair
+  physical::types::PauliOperator measureSuccessfully(PhotonRecord &left_photon, PhotonRecord &right_photon, bool is_psi_plus);
+  physical::types::PauliOperator darkcountPauliError();
   void validateProperties();
+  void processPhotonTrains();
+  // the successful pairs of the round of the photon trains, sampled by the link workers if there are
+  std::vector<fast_link::PairOutcome> sampleRoundOutcomes();
+  // photon_error is 0 to 3 for I, X, Z and Y, see PairOutcome
+  PhotonRecord emitPhotonFromMemory(backends::abstract::IQubit *memory_qubit, int photon_error);
 
   // device parameters
   double collection_efficiency;  // might get deleted later if collection efficiency is implemented at StationaryQubit during emission
@@ -48,13 +79,39 @@ class BellStateAnalyzer : public omnetpp::cSimpleModule {
   double detection_efficiency;
   omnetpp::simtime_t indistinguishability_window;  // Precision of photon arrivial time ~1.5ns
 
+  // the rare events of processIndistinguishPhotons, shared by both detectors
+  fast_link::BernoulliSkipSampler collection_loss_sampler;
+  fast_link::BernoulliSkipSampler darkcount_sampler;
+  fast_link::BernoulliSkipSampler detection_miss_sampler;
+
   // data members for processing
   BSAState state;
   std::vector<PhotonRecord> first_port_records;
   std::vector<PhotonRecord> second_port_records;
+  // the last time the records were processed or reset, the photons dropped before it belong to the rounds over
+  omnetpp::simtime_t records_cleared_time = SIMTIME_ZERO;
   utils::ComponentProvider provider;
+  modules::SharedResource::EventProfiler *event_profiler = nullptr;
   backends::IQuantumBackend *backend;
 
+  // the photon trains of the fast link layer by port
+  struct PhotonTrainRecord {
+    std::vector<backends::abstract::IQubit *> memory_qubits;
+    omnetpp::simtime_t last_arrival_time;
+    double arrival_probability;  // emission, channel and collection
+    std::array<double, 4> pauli_probabilities;  // I, X, Z, Y of an arrived photon
+    int num_lost_photons;  // the pairs of the first photons fail
+  };
+  std::array<std::optional<PhotonTrainRecord>, 2> photon_trains;
+  // fires at the arrival of the last photon, of the fast link layer or of the PhotonicQubitTrain messages
+  omnetpp::cMessage *photon_trains_timer = nullptr;
+  // with the link workers, the round of the photon trains is sampled on them from the stream of the BSA,
+  // submitted when both trains are in and waited for at photon_trains_timer
+  modules::SharedResource::LinkWorkers *link_workers = nullptr;
+  std::unique_ptr<backend::rng::StreamRNG> round_rng;
+  std::optional<modules::SharedResource::LinkWorkers::Ticket> round_ticket;
+  std::vector<fast_link::PairOutcome> round_outcomes;
+
   // for testing and debugging
   long long no_error_count = 0;
   long long x_error_count = 0;
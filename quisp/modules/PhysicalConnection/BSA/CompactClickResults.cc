@@ -0,0 +1,69 @@
+#include "CompactClickResults.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace quisp::physical::types {
+
+namespace {
+// appends the operator of the success_index-th success, 4 to a byte
+void appendOperator(std::vector<std::uint8_t> &operators, int success_index, PauliOperator op) {
+  int shift = (success_index % 4) * 2;
+  if (shift == 0) operators.push_back(0);
+  operators.back() |= static_cast<std::uint8_t>(static_cast<int>(op) << shift);
+}
+
+PauliOperator operatorAt(const std::vector<std::uint8_t> &operators, int success_index) {
+  return static_cast<PauliOperator>((operators[success_index / 4] >> ((success_index % 4) * 2)) & 0b11);
+}
+}  // namespace
+
+void CompactClickResults::append(int photon_index, PauliOperator correction_operation, PauliOperator pauli_error) {
+  if (photon_index <= last_photon_index) {
+    throw std::invalid_argument("photon index " + std::to_string(photon_index) + " isn't larger than the last one " + std::to_string(last_photon_index));
+  }
+  auto gap = static_cast<std::uint32_t>(photon_index - last_photon_index - 1);
+  while (gap >= 0x80) {
+    index_gaps.push_back(static_cast<std::uint8_t>(gap | 0x80));
+    gap >>= 7;
+  }
+  index_gaps.push_back(static_cast<std::uint8_t>(gap));
+
+  appendOperator(correction_operations, num_successes, correction_operation);
+  if (pauli_error != PauliOperator::I && pauli_errors.empty()) {
+    // the successes before the first error had none
+    for (int i = 0; i < num_successes; i++) appendOperator(pauli_errors, i, PauliOperator::I);
+  }
+  if (!pauli_errors.empty() || pauli_error != PauliOperator::I) appendOperator(pauli_errors, num_successes, pauli_error);
+  last_photon_index = photon_index;
+  num_successes++;
+}
+
+std::vector<ClickSuccess> CompactClickResults::decode() const {
+  std::vector<ClickSuccess> successes;
+  successes.reserve(num_successes);
+  int photon_index = -1;
+  std::size_t pos = 0;
+  for (int i = 0; i < num_successes; i++) {
+    std::uint32_t gap = 0;
+    for (int shift = 0;; shift += 7) {
+      auto byte = index_gaps[pos++];
+      gap |= static_cast<std::uint32_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) break;
+    }
+    photon_index += static_cast<int>(gap) + 1;
+    auto pauli_error = pauli_errors.empty() ? PauliOperator::I : operatorAt(pauli_errors, i);
+    successes.push_back({.photon_index = photon_index, .correction_operation = operatorAt(correction_operations, i), .pauli_error = pauli_error});
+  }
+  return successes;
+}
+
+void CompactClickResults::clear() {
+  index_gaps.clear();
+  correction_operations.clear();
+  pauli_errors.clear();
+  num_successes = 0;
+  last_photon_index = -1;
+}
+
+}  // namespace quisp::physical::types
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "modules/PhysicalConnection/BSA/types.h"
+
+namespace quisp::physical::types {
+
+struct ClickSuccess {
+  int photon_index;
+  PauliOperator correction_operation;
+  PauliOperator pauli_error = PauliOperator::I;
+};
+
+/**
+ * @brief the successful photons of a BSM round, compacted for CombinedBSAresults.
+ *
+ * The photon indices increase, so they are stored as the gaps from the previous one in LEB128 varints,
+ * a byte for the gaps under 128. The correction operations take 2 bits each, and so do the Pauli errors
+ * once a success has one; the results without an error don't store them.
+ */
+class CompactClickResults {
+ public:
+  /// @throws std::invalid_argument if photon_index isn't larger than the last one
+  void append(int photon_index, PauliOperator correction_operation, PauliOperator pauli_error = PauliOperator::I);
+  /// @brief the successes in the appended order
+  std::vector<ClickSuccess> decode() const;
+  int size() const { return num_successes; }
+  bool empty() const { return num_successes == 0; }
+  void clear();
+
+ private:
+  std::vector<std::uint8_t> index_gaps;
+  std::vector<std::uint8_t> correction_operations;
+  std::vector<std::uint8_t> pauli_errors;
+  int num_successes = 0;
+  int last_photon_index = -1;
+};
+
+}  // namespace quisp::physical::types
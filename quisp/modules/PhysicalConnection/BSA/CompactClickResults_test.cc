@@ -0,0 +1,63 @@
+#include "CompactClickResults.h"
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+namespace {
+using namespace quisp::physical::types;
+
+TEST(CompactClickResultsTest, Empty) {
+  CompactClickResults results;
+  EXPECT_TRUE(results.empty());
+  EXPECT_TRUE(results.decode().empty());
+}
+
+TEST(CompactClickResultsTest, RoundTrip) {
+  // the gaps of a byte and of several bytes, and all the correction operations
+  std::vector<ClickSuccess> successes = {{0, PauliOperator::I}, {1, PauliOperator::X}, {130, PauliOperator::Y}, {131, PauliOperator::Z}, {20000, PauliOperator::X}, {2000000, PauliOperator::Y}};
+  CompactClickResults results;
+  for (auto &success : successes) results.append(success.photon_index, success.correction_operation);
+  ASSERT_EQ(results.size(), successes.size());
+
+  auto decoded = results.decode();
+  ASSERT_EQ(decoded.size(), successes.size());
+  for (size_t i = 0; i < successes.size(); i++) {
+    EXPECT_EQ(decoded[i].photon_index, successes[i].photon_index);
+    EXPECT_EQ(decoded[i].correction_operation, successes[i].correction_operation);
+  }
+
+  results.clear();
+  EXPECT_TRUE(results.empty());
+  results.append(3, PauliOperator::Z);
+  ASSERT_EQ(results.decode().size(), 1);
+  EXPECT_EQ(results.decode()[0].photon_index, 3);
+}
+
+TEST(CompactClickResultsTest, PauliErrors) {
+  CompactClickResults results;
+  results.append(0, PauliOperator::X);
+  results.append(4, PauliOperator::I);
+  // the first error comes after the successes without one
+  results.append(7, PauliOperator::Y, PauliOperator::Z);
+  results.append(9, PauliOperator::X, PauliOperator::I);
+  results.append(12, PauliOperator::I, PauliOperator::Y);
+  auto decoded = results.decode();
+  ASSERT_EQ(decoded.size(), 5);
+  EXPECT_EQ(decoded[0].pauli_error, PauliOperator::I);
+  EXPECT_EQ(decoded[1].pauli_error, PauliOperator::I);
+  EXPECT_EQ(decoded[2].pauli_error, PauliOperator::Z);
+  EXPECT_EQ(decoded[2].correction_operation, PauliOperator::Y);
+  EXPECT_EQ(decoded[3].pauli_error, PauliOperator::I);
+  EXPECT_EQ(decoded[4].pauli_error, PauliOperator::Y);
+  EXPECT_EQ(decoded[4].photon_index, 12);
+}
+
+TEST(CompactClickResultsTest, IndicesMustIncrease) {
+  CompactClickResults results;
+  results.append(5, PauliOperator::I);
+  EXPECT_THROW(results.append(5, PauliOperator::I), std::invalid_argument);
+  EXPECT_THROW(results.append(2, PauliOperator::I), std::invalid_argument);
+  EXPECT_THROW(CompactClickResults().append(-1, PauliOperator::I), std::invalid_argument);
+}
+
+}  // namespace
@@ -0,0 +1,62 @@
+#include "FastLinkSampler.h"
+
+#include <unordered_set>
+
+namespace quisp::modules::fast_link {
+
+PairProbabilities pairProbabilities(double left_arrival, double right_arrival, double detection_efficiency, double darkcount_probability) {
+  double d = darkcount_probability;
+  PairProbabilities probabilities;
+  // a lost photon is replaced by a dark count on its side, while the other side clicks by itself or by a dark count
+  probabilities.false_positive = (1 - left_arrival) * (1 - right_arrival) * d * d + left_arrival * (1 - right_arrival) * d + (1 - left_arrival) * right_arrival * d;
+  // only Psi+/- are distinguishable, and both detectors have to click
+  probabilities.true_positive = left_arrival * right_arrival * 0.5 * detection_efficiency * detection_efficiency;
+  return probabilities;
+}
+
+std::vector<int> sampleSuccessIndices(int n, double p, IRandomNumberGenerator &rng) {
+  if (n <= 0 || p <= 0) return {};
+  int num_success = rng.binomialRandom(n, p);
+  std::vector<int> indices;
+  indices.reserve(num_success);
+  std::unordered_set<int> selected;
+  for (int j = n - num_success; j < n; j++) {
+    int t = std::min(static_cast<int>(rng.doubleRandom() * (j + 1)), j);
+    if (selected.insert(t).second) {
+      indices.push_back(t);
+    } else {
+      selected.insert(j);
+      indices.push_back(j);
+    }
+  }
+  std::sort(indices.begin(), indices.end());
+  return indices;
+}
+
+std::vector<PairOutcome> sampleRoundOutcomes(int num_pairs, const PairProbabilities &probabilities, const std::array<double, 4> &left_pauli,
+                                             const std::array<double, 4> &right_pauli, IRandomNumberGenerator &rng) {
+  auto photon_error = [&](const std::array<double, 4> &pauli) {
+    double rand = rng.doubleRandom();
+    double cumulative = 0;
+    for (int error = 0; error < 3; error++) {
+      cumulative += pauli[error];
+      if (rand < cumulative) return error;
+    }
+    return 3;
+  };
+  std::vector<PairOutcome> outcomes;
+  for (auto index : sampleSuccessIndices(num_pairs, probabilities.success(), rng)) {
+    PairOutcome outcome;
+    outcome.index = index;
+    outcome.left_photon_error = photon_error(left_pauli);
+    outcome.right_photon_error = photon_error(right_pauli);
+    outcome.darkcount = rng.doubleRandom() * probabilities.success() >= probabilities.true_positive;
+    outcome.is_psi_plus = rng.doubleRandom() < 0.5;
+    outcome.darkcount_error = physical::types::PauliOperator::I;
+    if (outcome.darkcount) outcome.darkcount_error = static_cast<physical::types::PauliOperator>(std::min(static_cast<int>(rng.doubleRandom() * 4), 3));
+    outcomes.push_back(outcome);
+  }
+  return outcomes;
+}
+
+}  // namespace quisp::modules::fast_link
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include "backends/interfaces/IRandomNumberGenerator.h"
+#include "modules/PhysicalConnection/BSA/types.h"
+
+namespace quisp::modules::fast_link {
+using backends::abstract::IRandomNumberGenerator;
+
+/// @brief the probabilities that a pair of photons in the same time slot makes the BSA report a success.
+struct PairProbabilities {
+  double true_positive = 0;  // both photons detected in Psi+/-
+  double false_positive = 0;  // dark counts in place of the lost photons
+  double success() const { return true_positive + false_positive; }
+};
+
+/**
+ * @brief the success probabilities of a photon pair, following BellStateAnalyzer::processIndistinguishPhotons.
+ *
+ * @param left_arrival, right_arrival the probabilities that the photon reaches the detector,
+ *        i.e. the emission, the channel and the collection all succeed
+ */
+PairProbabilities pairProbabilities(double left_arrival, double right_arrival, double detection_efficiency, double darkcount_probability);
+
+/**
+ * @brief samples the number of successes among n photon pairs from Binomial(n, p),
+ * and the indices of the successful pairs uniformly (Floyd's algorithm). The indices are sorted.
+ *
+ * It takes O(k log k) for k successes instead of a random number per pair.
+ */
+std::vector<int> sampleSuccessIndices(int n, double p, IRandomNumberGenerator &rng);
+
+/// @brief the random outcomes of a successful pair of a round of photon trains, drawn before the backend entangles the memories.
+struct PairOutcome {
+  int index;  // of the pair in the round
+  // the Pauli errors of the channels on the photons, 0 to 3 for I, X, Z and Y as in QuantumChannel::getPhotonOutcomeProbabilities
+  int left_photon_error;
+  int right_photon_error;
+  bool darkcount;
+  // Psi+ with the X correction rather than Psi- with the Y correction, for a dark count just the correction
+  bool is_psi_plus;
+  physical::types::PauliOperator darkcount_error;  // uniformly random
+};
+
+/**
+ * @brief samples the successful pairs of a round of photon trains and their outcomes, in the order of BellStateAnalyzer::processPhotonTrains.
+ *
+ * It draws from rng only, so it can run away from the module with a stream of its own.
+ * @param left_pauli, right_pauli the probabilities of I, X, Z and Y on an arrived photon
+ */
+std::vector<PairOutcome> sampleRoundOutcomes(int num_pairs, const PairProbabilities &probabilities, const std::array<double, 4> &left_pauli,
+                                             const std::array<double, 4> &right_pauli, IRandomNumberGenerator &rng);
+
+/**
+ * @brief the outcomes of independent Bernoulli(p) trials, one trial per next() call.
+ *
+ * Instead of a random number per trial, it draws the number of trials until the next rare outcome
+ * from the geometric distribution, so the common outcome takes no random number.
+ * The rare outcome is the event itself for p <= 0.5, and its complement otherwise.
+ */
+class BernoulliSkipSampler {
+ public:
+  explicit BernoulliSkipSampler(double p = 0) : rare_is_event(p <= 0.5), rare_probability(p <= 0.5 ? p : 1 - p) {}
+
+  /// @param uniform returns a random number in [0, 1), called only when the next gap is drawn
+  template <typename Uniform>
+  bool next(Uniform &&uniform) {
+    if (rare_probability <= 0) return !rare_is_event;
+    if (trials_to_rare < 0) {
+      // the failures before the rare outcome; 1 - uniform() is in (0, 1]
+      trials_to_rare = static_cast<long long>(std::floor(std::log(1 - uniform()) / std::log1p(-rare_probability)));
+    }
+    bool is_rare = trials_to_rare-- == 0;
+    return is_rare == rare_is_event;
+  }
+
+ private:
+  bool rare_is_event;
+  double rare_probability;
+  long long trials_to_rare = -1;
+};
+
+}  // namespace quisp::modules::fast_link
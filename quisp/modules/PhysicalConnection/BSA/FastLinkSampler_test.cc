@@ -0,0 +1,101 @@
+#include "FastLinkSampler.h"
+
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+
+namespace {
+using namespace quisp::modules::fast_link;
+
+class MersenneRNG : public IRandomNumberGenerator {
+ public:
+  double doubleRandom() override { return std::uniform_real_distribution<double>(0, 1)(engine); }
+  std::mt19937 engine{1};
+};
+
+TEST(FastLinkSamplerTest, PairProbabilities) {
+  auto ideal = pairProbabilities(1, 1, 1, 0);
+  EXPECT_DOUBLE_EQ(ideal.true_positive, 0.5);
+  EXPECT_DOUBLE_EQ(ideal.false_positive, 0);
+
+  auto lossy = pairProbabilities(0.5, 0.8, 0.9, 0.1);
+  EXPECT_DOUBLE_EQ(lossy.true_positive, 0.5 * 0.8 * 0.5 * 0.81);
+  EXPECT_DOUBLE_EQ(lossy.false_positive, 0.5 * 0.2 * 0.01 + 0.5 * 0.2 * 0.1 + 0.5 * 0.8 * 0.1);
+  EXPECT_DOUBLE_EQ(lossy.success(), lossy.true_positive + lossy.false_positive);
+}
+
+TEST(FastLinkSamplerTest, SampleSuccessIndices) {
+  MersenneRNG gen;
+  EXPECT_TRUE(sampleSuccessIndices(0, 0.5, gen).empty());
+  EXPECT_TRUE(sampleSuccessIndices(10, 0, gen).empty());
+  EXPECT_EQ(sampleSuccessIndices(4, 1, gen), (std::vector<int>{0, 1, 2, 3}));
+
+  long total = 0;
+  std::vector<int> hits(50, 0);
+  for (int round = 0; round < 2000; round++) {
+    auto indices = sampleSuccessIndices(50, 0.2, gen);
+    // distinct, sorted and in range
+    EXPECT_EQ(std::set<int>(indices.begin(), indices.end()).size(), indices.size());
+    EXPECT_TRUE(std::is_sorted(indices.begin(), indices.end()));
+    for (auto i : indices) {
+      ASSERT_GE(i, 0);
+      ASSERT_LT(i, 50);
+      hits[i]++;
+    }
+    total += indices.size();
+  }
+  // 10 successes per round on average, spread evenly over the indices
+  EXPECT_NEAR(total / 2000.0, 10, 0.3);
+  for (auto count : hits) EXPECT_NEAR(count, 400, 100);
+}
+
+TEST(FastLinkSamplerTest, SampleRoundOutcomes) {
+  MersenneRNG rng;
+
+  // no dark count, the left channel always flips Z and the right one leaves Y
+  auto outcomes = sampleRoundOutcomes(100, pairProbabilities(1, 1, 1, 0), {0, 0, 1, 0}, {0, 0, 0, 1}, rng);
+  EXPECT_NEAR(outcomes.size(), 50, 20);
+  int num_psi_plus = 0;
+  for (auto &outcome : outcomes) {
+    EXPECT_FALSE(outcome.darkcount);
+    EXPECT_EQ(outcome.left_photon_error, 2);
+    EXPECT_EQ(outcome.right_photon_error, 3);
+    EXPECT_EQ(outcome.darkcount_error, quisp::physical::types::PauliOperator::I);
+    num_psi_plus += outcome.is_psi_plus;
+  }
+  EXPECT_NEAR(num_psi_plus, outcomes.size() / 2.0, 20);
+
+  // only the dark counts click without the photons
+  outcomes = sampleRoundOutcomes(1000, pairProbabilities(0, 0, 1, 0.5), {1, 0, 0, 0}, {1, 0, 0, 0}, rng);
+  EXPECT_NEAR(outcomes.size(), 250, 50);
+  for (auto &outcome : outcomes) EXPECT_TRUE(outcome.darkcount);
+}
+
+TEST(FastLinkSamplerTest, BernoulliSkipSampler) {
+  std::mt19937 gen(1);
+  std::uniform_real_distribution<double> dist(0, 1);
+  int num_draws = 0;
+  auto uniform = [&]() {
+    num_draws++;
+    return dist(gen);
+  };
+
+  BernoulliSkipSampler never{0}, always{1};
+  for (int i = 0; i < 100; i++) {
+    EXPECT_FALSE(never.next(uniform));
+    EXPECT_TRUE(always.next(uniform));
+  }
+  EXPECT_EQ(num_draws, 0);
+
+  for (double p : {0.01, 0.3, 0.5, 0.9, 0.999}) {
+    BernoulliSkipSampler sampler{p};
+    num_draws = 0;
+    int trials = 200000, events = 0;
+    for (int i = 0; i < trials; i++) events += sampler.next(uniform);
+    EXPECT_NEAR(events / (double)trials, p, 0.005) << "p = " << p;
+    // a random number per rare outcome
+    EXPECT_NEAR(num_draws / (double)trials, std::min(p, 1 - p), 0.005) << "p = " << p;
+  }
+}
+
+}  // namespace
@@ -8,5 +8,7 @@ enum class BellState : int { PhiPlus = 0, PhiMinus, PsiPlus, PsiMinus };
 struct BSAClickResult {
   bool success;
   PauliOperator correction_operation;
+  // the Pauli error the photons of a success left on the Bell pair, uniformly random for a dark count
+  PauliOperator pauli_error = PauliOperator::I;
 };
 }  // namespace quisp::physical::types
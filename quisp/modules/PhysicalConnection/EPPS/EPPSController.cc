@@ -23,11 +23,17 @@ EPPSController::EPPSController() : provider(utils::ComponentProvider{this}) {}
 
 EPPSController::~EPPSController() {}
 
-void EPPSController::finish() { std::cout << "last EPPS message that was sent " << last_result_send_time << "\n"; }
+void EPPSController::finish() {
+  std::cout << "last EPPS message that was sent " << last_result_send_time << "\n";
+  if (backpressure_pause > SIMTIME_ZERO) recordScalar("backpressure_pauses", num_backpressure_pauses);
+}
 
 void EPPSController::initialize() {
+  event_profiler = provider.getEventProfiler();
   epps = check_and_cast<EntangledPhotonPairSource *>(getParentModule()->getSubmodule("epps"));
   photon_emission_per_second = par("photon_emission_per_second");
+  backpressure_pause = par("backpressure_pause");
+  if (backpressure_pause < SIMTIME_ZERO) error("backpressure_pause must not be negative");
   address = getParentModule()->par("address").intValue();
   left_addr = getExternalAdressFromPort(0);
   right_addr = getExternalAdressFromPort(1);
@@ -38,13 +44,26 @@ void EPPSController::initialize() {
   time_out_count = 0;
   emission_stopped = false;
   checkNeighborsBSACapacity();
+  for (int port = 0; port < 2; port++) {
+    auto *channel = dynamic_cast<const channels::FreeSpaceChannel *>(epps->gate("quantum_port$o", port)->findTransmissionChannel());
+    if (channel != nullptr) free_space_channels.push_back(channel);
+  }
   time_out_message = new EPPSNotificationTimeout();
   simtime_t first_notification_timer = par("initial_notification_timing_buffer").doubleValue();
   scheduleAt(first_notification_timer, time_out_message);
 }
 
 void EPPSController::handleMessage(cMessage *msg) {
+  modules::SharedResource::EventProfiler::Scope profile(event_profiler, this, msg);
   if (auto *pk = dynamic_cast<EmitPhotonRequest *>(msg)) {
+    if (!free_space_channels.empty()) {
+      auto visible_time = channels::FreeSpaceChannel::getNextVisibleTime(free_space_channels, simTime());
+      if (visible_time != simTime()) {
+        suspendEmission(pk, visible_time);
+        return;
+      }
+      setLinkVisible(true);
+    }
     epps->emitPhotons();
     scheduleAt(simTime() + pk->getIntervalBetweenPhotons(), pk);
     return;
@@ -63,11 +82,52 @@ void EPPSController::handleMessage(cMessage *msg) {
       cancelAndDelete(emit_req);
       emission_stopped = true;
     }
+  } else if (dynamic_cast<MSMMemoryExhausted *>(msg)) {
+    pauseEmission();
   }
   delete msg;
   return;
 }
 
+void EPPSController::suspendEmission(EmitPhotonRequest *pk, simtime_t visible_time) {
+  setLinkVisible(false);
+  // the request stays with the controller if the satellite never comes back
+  if (visible_time == SimTime::getMaxTime()) return;
+  emit_time = visible_time;
+  send(generateNotifier(true), "to_router");
+  send(generateNotifier(false), "to_router");
+  scheduleAt(emit_time, pk);
+}
+
+/**
+ * The nodes keep the photon indices in step with the EPPS: the new timing notification cancels their emission
+ * a travel time after the EPPS stopped, i.e. after the same photons.
+ */
+void EPPSController::pauseEmission() {
+  if (backpressure_pause <= SIMTIME_ZERO || emission_stopped || emit_req == nullptr || !emit_req->isScheduled()) return;
+  if (simTime() < paused_until) return;
+  cancelEvent(emit_req);
+  emit_time = simTime() + backpressure_pause;
+  paused_until = emit_time;
+  num_backpressure_pauses++;
+  send(generateNotifier(true), "to_router");
+  send(generateNotifier(false), "to_router");
+  scheduleAt(emit_time, emit_req);
+}
+
+void EPPSController::setLinkVisible(bool visible) {
+  if (link_visible == visible) return;
+  link_visible = visible;
+  for (bool is_left : {true, false}) {
+    auto *pk = new QuantumLinkVisibility("QuantumLinkVisibility");
+    pk->setSrcAddr(address);
+    pk->setDestAddr(is_left ? left_addr : right_addr);
+    pk->setNeighbor_address(is_left ? right_addr : left_addr);
+    pk->setVisible(visible);
+    send(pk, "to_router");
+  }
+}
+
 EPPSTimingNotification *EPPSController::generateNotifier(bool is_left) {
   EPPSTimingNotification *pk = new EPPSTimingNotification("EPPSTimingNotification");
   pk->setEPPSAddr(address);
@@ -83,6 +143,7 @@ EPPSTimingNotification *EPPSController::generateNotifier(bool is_left) {
   pk->setSrcAddr(address);
   pk->setDestAddr(is_left ? left_addr : right_addr);
   pk->setTotalTravelTime(left_travel_time + right_travel_time);
+  pk->setBackpressure(backpressure_pause > SIMTIME_ZERO);
   return pk;
 }
 
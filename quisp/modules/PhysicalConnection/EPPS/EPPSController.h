@@ -9,6 +9,7 @@
 #include <omnetpp.h>
 #include <vector>
 #include "EntangledPhotonPairSource.h"
+#include "channels/FreeSpaceChannel.h"
 #include "omnetpp/simtime.h"
 
 using namespace omnetpp;
@@ -32,8 +33,14 @@ class EPPSController : public cSimpleModule {
   virtual void checkNeighborsBSACapacity();
   virtual EPPSTimingNotification *generateNotifier(bool is_left);
 
- private:
   double getTravelTimeFromPort(int port);
+  // holds the emission until the satellites of the free space channels are back in view at visible_time,
+  // and moves the nodes' emission there with new timing notifications
+  void suspendEmission(EmitPhotonRequest *pk, simtime_t visible_time);
+  // notifies both nodes of the link state, as the routing avoids the link while it's out of view
+  void setLinkVisible(bool visible);
+  // pauses the emission for backpressure_pause after a node ran out of free qubits
+  void pauseEmission();
   int getExternalQNICIndexFromPort(int port);
 
   // information for communications
@@ -54,8 +61,16 @@ class EPPSController : public cSimpleModule {
   // EPPS characteristics
   EntangledPhotonPairSource *epps;
   utils::ComponentProvider provider;
-  EmitPhotonRequest *emit_req;
+  modules::SharedResource::EventProfiler *event_profiler = nullptr;
+  EmitPhotonRequest *emit_req = nullptr;
   bool emission_stopped;
+  // the channels of the ports to the satellites
+  std::vector<const channels::FreeSpaceChannel *> free_space_channels;
+  bool link_visible = true;
+  simtime_t backpressure_pause = SIMTIME_ZERO;
+  // the end of the ongoing pause, the other node's MSMMemoryExhausted in it doesn't extend it
+  simtime_t paused_until = SIMTIME_ZERO;
+  long num_backpressure_pauses = 0;
 };
 
 }  // namespace quisp::modules
@@ -0,0 +1,121 @@
+#include "EPPSController.h"
+
+#include <gtest/gtest.h>
+#include <omnetpp.h>
+#include <test_utils/TestUtils.h>
+#include <vector>
+
+namespace {
+using namespace omnetpp;
+using namespace quisp_test;
+using quisp::messages::EPPSTimingNotification;
+using quisp::modules::EPPSController;
+
+class EPPSControllerTestTarget : public EPPSController {
+ public:
+  using EPPSController::address;
+  using EPPSController::backpressure_pause;
+  using EPPSController::emission_stopped;
+  using EPPSController::emit_req;
+  using EPPSController::handleMessage;
+  using EPPSController::left_addr;
+  using EPPSController::left_qnic_index;
+  using EPPSController::left_travel_time;
+  using EPPSController::num_backpressure_pauses;
+  using EPPSController::pauseEmission;
+  using EPPSController::right_addr;
+  using EPPSController::right_qnic_index;
+  using EPPSController::right_travel_time;
+  using EPPSController::time_interval_between_photons;
+
+  EPPSControllerTestTarget() : EPPSController(), router_port(new TestGate(this, "to_router")) {
+    setName("epps_controller_test_target");
+    setComponentType(new TestModuleType("test_epps_controller"));
+    address = 2;
+    left_addr = 1;
+    left_qnic_index = 0;
+    right_addr = 3;
+    right_qnic_index = 1;
+    left_travel_time = 1e-5;
+    right_travel_time = 3e-5;
+    time_interval_between_photons = 1e-6;
+    emission_stopped = false;
+    backpressure_pause = 1e-3;
+  }
+  // the emission as it's started by the first timing notification
+  void startEmission(simtime_t at) {
+    emit_req = new EmitPhotonRequest();
+    emit_req->setIntervalBetweenPhotons(time_interval_between_photons);
+    scheduleAt(at, emit_req);
+  }
+  cGate *gate(const char *gatename, int index = -1) override {
+    if (strcmp(gatename, "to_router") != 0) throw cRuntimeError("unknown gate called");
+    return router_port;
+  }
+  TestGate *router_port;
+};
+
+class EPPSControllerTest : public testing::Test {
+ protected:
+  void SetUp() {
+    sim = prepareSimulation();
+    controller = new EPPSControllerTestTarget;
+    sim->registerComponent(controller);
+    sim->setContext(controller);
+    sim->setSimTime(now);
+    controller->startEmission(now + controller->time_interval_between_photons);
+  }
+  const simtime_t now = 1;
+  utils::TestSimulation *sim;
+  EPPSControllerTestTarget *controller;
+};
+
+TEST_F(EPPSControllerTest, pauseAndNotifyBothNodes) {
+  controller->pauseEmission();
+  EXPECT_EQ(controller->num_backpressure_pauses, 1);
+  ASSERT_TRUE(controller->emit_req->isScheduled());
+  auto pause_end = now + controller->backpressure_pause;
+  EXPECT_EQ(controller->emit_req->getArrivalTime(), pause_end);
+
+  auto &messages = controller->router_port->messages;
+  ASSERT_EQ(messages.size(), 2);
+  auto *left = dynamic_cast<EPPSTimingNotification *>(messages[0]);
+  auto *right = dynamic_cast<EPPSTimingNotification *>(messages[1]);
+  ASSERT_NE(left, nullptr);
+  ASSERT_NE(right, nullptr);
+  // the nodes resume with the photons emitted at the end of the pause
+  EXPECT_EQ(left->getDestAddr(), 1);
+  EXPECT_EQ(left->getFirstPhotonEmitTime(), pause_end + controller->left_travel_time);
+  EXPECT_TRUE(left->getBackpressure());
+  EXPECT_EQ(right->getDestAddr(), 3);
+  EXPECT_EQ(right->getFirstPhotonEmitTime(), pause_end + controller->right_travel_time);
+  EXPECT_TRUE(right->getBackpressure());
+}
+
+TEST_F(EPPSControllerTest, noPauseWithoutBackpressure) {
+  controller->backpressure_pause = 0;
+  controller->pauseEmission();
+  EXPECT_EQ(controller->num_backpressure_pauses, 0);
+  EXPECT_EQ(controller->emit_req->getArrivalTime(), now + controller->time_interval_between_photons);
+  EXPECT_EQ(controller->router_port->messages.size(), 0);
+}
+
+TEST_F(EPPSControllerTest, noPauseWhilePaused) {
+  controller->pauseEmission();
+  // the other node's MSMMemoryExhausted of the same photons
+  sim->setSimTime(now + controller->backpressure_pause / 2);
+  controller->pauseEmission();
+  EXPECT_EQ(controller->num_backpressure_pauses, 1);
+  EXPECT_EQ(controller->emit_req->getArrivalTime(), now + controller->backpressure_pause);
+  EXPECT_EQ(controller->router_port->messages.size(), 2);
+}
+
+TEST_F(EPPSControllerTest, noPauseAfterEmissionStopped) {
+  controller->handleMessage(new StopEPPSEmission);
+  EXPECT_TRUE(controller->emission_stopped);
+  controller->pauseEmission();
+  EXPECT_EQ(controller->num_backpressure_pauses, 0);
+  EXPECT_EQ(controller->router_port->messages.size(), 0);
+}
+
+}  // namespace
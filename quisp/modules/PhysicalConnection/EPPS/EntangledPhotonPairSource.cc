@@ -14,6 +14,7 @@ EntangledPhotonPairSource::~EntangledPhotonPairSource() {}
 void EntangledPhotonPairSource::finish() {}
 
 void EntangledPhotonPairSource::initialize() {
+  event_profiler = provider.getEventProfiler();
   emission_success_probability = par("emission_success_probability").doubleValue();
   emission_x_error_rate = par("emission_x_error_rate").doubleValue();
   emission_y_error_rate = par("emission_y_error_rate").doubleValue();
@@ -29,6 +30,7 @@ void EntangledPhotonPairSource::initialize() {
  * \param msg is the PhotonicQubit message
  */
 void EntangledPhotonPairSource::handleMessage(cMessage *msg) {
+  modules::SharedResource::EventProfiler::Scope profile(event_profiler, this, msg);
   if (!msg->isSelfMessage()) {
     throw cRuntimeError("EntangledPhotonPairSource::handleMessage: message from outside is not expected");
   }
@@ -59,7 +61,7 @@ void EntangledPhotonPairSource::emitPhotons() {
   right_photon->setFirst(true);
   left_photon->setLast(true);
   right_photon->setLast(true);
-  float jitter_timing = normal(0, emission_jittering_standard_deviation);
+  float jitter_timing = module_rng.normalRandom(0, emission_jittering_standard_deviation);
   float abso = fabs(jitter_timing);
   scheduleAt(simTime() + abso, left_photon);
   scheduleAt(simTime() + abso, right_photon);
@@ -22,7 +22,10 @@ class EntangledPhotonPairSource : public omnetpp::cSimpleModule {
   double emission_z_error_rate;
 
   utils::ComponentProvider provider;
+  modules::SharedResource::EventProfiler *event_profiler = nullptr;
   IQuantumBackend* backend;
+  // the samplers over the RNG of the module
+  backend::rng::RNG module_rng{this};
 
  protected:
   virtual void initialize() override;
@@ -5,10 +5,52 @@
  */
 #include "PhotonicSwitch.h"
 
+#include "PhotonicQubit_m.h"
+
+using namespace quisp::messages;
+
 namespace quisp::modules {
 
-void PhotonicSwitch::initialize() {}
+Define_Module(PhotonicSwitch);
+
+void PhotonicSwitch::initialize() {
+  output = par("initial_output").intValue();
+  if (output < 0 || output >= numOutputs()) error("initial_output %d of the switch isn't one of its %d outputs", output, numOutputs());
+}
+
+void PhotonicSwitch::setOutput(int new_output) {
+  Enter_Method("setOutput()");
+  if (new_output < 0 || new_output >= numOutputs()) error("the switch has no output %d", new_output);
+  if (new_output == output) return;
+  output = new_output;
+  reconfigured_at = simTime() + par("reconfiguration_time");
+  num_reconfigurations++;
+}
+
+void PhotonicSwitch::handleMessage(cMessage *msg) {
+  if (isReconfiguring(simTime())) {
+    // the switch is between the outputs, the photons scatter
+    if (auto *photon = dynamic_cast<PhotonicQubit *>(msg)) {
+      photon->setLost(true);
+      num_switching_losses++;
+    } else if (auto *train = dynamic_cast<PhotonicQubitTrain *>(msg)) {
+      for (size_t i = 0; i < train->getNumPhotons(); i++) {
+        auto photon = train->getPhoton(i);
+        // the photons of the train pass the switch at their emission offsets
+        if (!isReconfiguring(simTime() + photon.emission_offset)) continue;
+        photon.is_lost = true;
+        train->setPhoton(i, photon);
+        num_switching_losses++;
+      }
+    }
+  }
+  send(msg, "to_bsa$o", output);
+}
 
-void PhotonicSwitch::handleMessage(cMessage *msg) { send(msg, "to_bsa$o"); }
+void PhotonicSwitch::finish() {
+  if (num_reconfigurations == 0) return;
+  recordScalar("switch reconfigurations", num_reconfigurations);
+  recordScalar("switching lost photons", num_switching_losses);
+}
 
 }  // namespace quisp::modules
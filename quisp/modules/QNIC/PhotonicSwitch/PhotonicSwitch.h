@@ -14,12 +14,30 @@ namespace quisp::modules {
 /** \class PhotonicSwitch PhotonicSwitch.cc
  *
  *  \brief PhotonicSwitch
+ *
+ * The photons of the emitters go out of the selected one of the to_bsa outputs.
+ * A reconfiguration takes reconfiguration_time, and the photons passing meanwhile go to the new output as lost photons,
+ * so the BSA behind it still sees the bounds of the round.
  */
 class PhotonicSwitch : public cSimpleModule {
+ public:
+  // selects the output for the next photons, a no-op for the current one
+  void setOutput(int output);
+  int getOutput() const { return output; }
+  // whether a photon passing the switch at t is lost in the ongoing reconfiguration
+  bool isReconfiguring(simtime_t t) const { return t < reconfigured_at; }
+  int numOutputs() { return gateSize("to_bsa"); }
+
  protected:
   virtual void initialize() override;
   virtual void handleMessage(cMessage *msg) override;
+  virtual void finish() override;
+
+  int output = 0;
+  // the photons are lost until then
+  simtime_t reconfigured_at = SIMTIME_ZERO;
+  long num_reconfigurations = 0;
+  long num_switching_losses = 0;
 };
 
-Define_Module(PhotonicSwitch);
 }  // namespace quisp::modules
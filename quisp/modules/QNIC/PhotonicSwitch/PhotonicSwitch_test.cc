@@ -0,0 +1,117 @@
+#include "PhotonicSwitch.h"
+
+#include <gtest/gtest.h>
+#include <omnetpp.h>
+#include <test_utils/TestUtils.h>
+#include <vector>
+#include "PhotonicQubit_m.h"
+
+namespace {
+using namespace omnetpp;
+using namespace quisp_test;
+using quisp::messages::PhotonicQubit;
+using quisp::messages::PhotonicQubitTrain;
+using quisp::messages::TrainPhoton;
+using quisp::modules::PhotonicSwitch;
+
+class PhotonicSwitchTestTarget : public PhotonicSwitch {
+ public:
+  using PhotonicSwitch::handleMessage;
+  using PhotonicSwitch::num_switching_losses;
+
+  PhotonicSwitchTestTarget() : PhotonicSwitch() {
+    setParInt(this, "initial_output", 0);
+    setParDouble(this, "reconfiguration_time", 1e-6);
+    setName("photonic_switch_test_target");
+    setComponentType(new TestModuleType("test_photonic_switch"));
+    addGateVector("to_bsa", cGate::Type::INOUT, 2);
+    for (int i = 0; i < 2; i++) outputs.push_back(new TestGate(this, "to_bsa$o"));
+  }
+  cGate *gate(const char *gatename, int index = -1) override {
+    if (strcmp(gatename, "to_bsa$o") != 0) throw cRuntimeError("unknown gate called");
+    return outputs.at(index);
+  }
+  std::vector<TestGate *> outputs;
+};
+
+class PhotonicSwitchTest : public testing::Test {
+ protected:
+  void SetUp() {
+    sim = prepareSimulation();
+    lens = new PhotonicSwitchTestTarget;
+    sim->registerComponent(lens);
+    lens->callInitialize();
+    sim->setContext(lens);
+  }
+  PhotonicQubit *arrivedPhoton(int output) {
+    auto &messages = lens->outputs[output]->messages;
+    if (messages.empty()) return nullptr;
+    return dynamic_cast<PhotonicQubit *>(messages.back());
+  }
+  utils::TestSimulation *sim;
+  PhotonicSwitchTestTarget *lens;
+};
+
+TEST_F(PhotonicSwitchTest, selectOutput) {
+  lens->handleMessage(new PhotonicQubit);
+  EXPECT_EQ(lens->outputs[0]->messages.size(), 1);
+
+  lens->setOutput(1);
+  EXPECT_EQ(lens->getOutput(), 1);
+  sim->setSimTime(1);
+  lens->handleMessage(new PhotonicQubit);
+  ASSERT_NE(arrivedPhoton(1), nullptr);
+  EXPECT_FALSE(arrivedPhoton(1)->isLost());
+  EXPECT_EQ(lens->outputs[0]->messages.size(), 1);
+}
+
+TEST_F(PhotonicSwitchTest, rejectUnknownOutput) {
+  EXPECT_THROW(lens->setOutput(2), cRuntimeError);
+  EXPECT_THROW(lens->setOutput(-1), cRuntimeError);
+  EXPECT_EQ(lens->getOutput(), 0);
+}
+
+TEST_F(PhotonicSwitchTest, losePhotonWhileReconfiguring) {
+  // the same output doesn't reconfigure the switch
+  lens->setOutput(0);
+  EXPECT_FALSE(lens->isReconfiguring(simTime()));
+
+  lens->setOutput(1);
+  EXPECT_TRUE(lens->isReconfiguring(simTime()));
+  lens->handleMessage(new PhotonicQubit);
+  ASSERT_NE(arrivedPhoton(1), nullptr);
+  EXPECT_TRUE(arrivedPhoton(1)->isLost());
+  EXPECT_EQ(lens->num_switching_losses, 1);
+
+  sim->setSimTime(2e-6);
+  EXPECT_FALSE(lens->isReconfiguring(simTime()));
+  lens->handleMessage(new PhotonicQubit);
+  EXPECT_FALSE(arrivedPhoton(1)->isLost());
+  EXPECT_EQ(lens->num_switching_losses, 1);
+}
+
+TEST_F(PhotonicSwitchTest, loseTrainPhotonsWhileReconfiguring) {
+  lens->setOutput(1);
+  sim->setSimTime(3e-7);
+  // the photons pass the switch at 3e-7, 7e-7, 1.1e-6 and 1.5e-6, the reconfiguration ends at 1e-6
+  auto *train = new PhotonicQubitTrain;
+  for (int i = 0; i < 4; i++) {
+    TrainPhoton photon;
+    photon.emission_offset = 4e-7 * i;
+    train->appendPhoton(photon);
+  }
+  lens->handleMessage(train);
+
+  auto &messages = lens->outputs[1]->messages;
+  ASSERT_EQ(messages.size(), 1);
+  auto *arrived = dynamic_cast<PhotonicQubitTrain *>(messages[0]);
+  ASSERT_NE(arrived, nullptr);
+  ASSERT_EQ(arrived->getNumPhotons(), 4);
+  EXPECT_TRUE(arrived->getPhoton(0).is_lost);
+  EXPECT_TRUE(arrived->getPhoton(1).is_lost);
+  EXPECT_FALSE(arrived->getPhoton(2).is_lost);
+  EXPECT_FALSE(arrived->getPhoton(3).is_lost);
+  EXPECT_EQ(lens->num_switching_losses, 2);
+}
+
+}  // namespace
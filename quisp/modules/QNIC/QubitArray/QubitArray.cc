@@ -0,0 +1,215 @@
+/** \file QubitArray.cc
+ *
+ *  \brief QubitArray
+ */
+#include "QubitArray.h"
+
+#include <omnetpp.h>
+#include <stdexcept>
+#include "modules/Backend/QubitConfigurationParameters.h"
+#include "utils/UtilFunctions.h"
+
+using quisp::messages::PhotonicQubit;
+using quisp::messages::PhotonicQubitTrain;
+using quisp::messages::TrainPhoton;
+using quisp::modules::qubit_id::QubitId;
+using quisp::types::BellMeasurementResult;
+using quisp::types::EigenvalueResult;
+using quisp::types::MeasurementOutcome;
+using quisp::types::PurificationBasis;
+
+namespace quisp::modules {
+
+Define_Module(QubitArray);
+
+VirtualStationaryQubit::VirtualStationaryQubit(QubitArray *array, int qubit_index, IBackendQubit *qubit_ref) : array(array), qubit_ref(qubit_ref) {
+  stationary_qubit_address = qubit_index;
+  qnic_type = array->qnic_type;
+  qnic_index = array->qnic_index;
+  emission_success_probability = array->emission_success_probability;
+  action_index = -1;
+}
+
+void VirtualStationaryQubit::setFree(bool consumed) { setFreeInBatch(consumed)->setFree(); }
+
+backends::IQubit *VirtualStationaryQubit::setFreeInBatch(bool consumed) {
+  is_busy = false;
+  locked = false;
+  locked_ruleset_id = -1;
+  locked_rule_id = -1;
+  action_index = -1;
+  emitted_time = -1;
+  return qubit_ref;
+}
+
+void VirtualStationaryQubit::Lock(unsigned long rs_id, int rule_id, int action_id) {
+  if (rs_id == -1 || rule_id == -1 || action_id == -1) {
+    throw omnetpp::cRuntimeError("ruleset_id || rule_id || action_id == -1");
+  }
+  locked = true;
+  locked_ruleset_id = rs_id;
+  locked_rule_id = rule_id;
+  action_index = action_id;
+}
+
+void VirtualStationaryQubit::Unlock() {
+  locked = false;
+  locked_ruleset_id = -1;
+  locked_rule_id = -1;
+  action_index = -1;
+}
+
+bool VirtualStationaryQubit::isLocked() { return locked; }
+
+void VirtualStationaryQubit::emitPhoton(int pulse) { array->emitPhoton(this, pulse); }
+
+void VirtualStationaryQubit::emitPhotonIntoTrain(PhotonicQubitTrain *train, omnetpp::simtime_t emission_offset) { array->emitPhotonIntoTrain(this, train, emission_offset); }
+
+void VirtualStationaryQubit::sendPhotonTrain(PhotonicQubitTrain *train) { array->sendPhotonTrain(train); }
+
+EigenvalueResult VirtualStationaryQubit::measureX() { return qubit_ref->measureX(); }
+
+EigenvalueResult VirtualStationaryQubit::measureY() { return qubit_ref->measureY(); }
+
+EigenvalueResult VirtualStationaryQubit::measureZ() { return qubit_ref->measureZ(); }
+
+MeasurementOutcome VirtualStationaryQubit::measureRandomPauliBasis() { return array->measureRandomPauliBasis(this); }
+
+void VirtualStationaryQubit::gateCNOT(IStationaryQubit *target_qubit) { qubit_ref->gateCNOT(target_qubit->getBackendQubitRef()); }
+
+BellMeasurementResult VirtualStationaryQubit::bellMeasure(IStationaryQubit *target_qubit) { return qubit_ref->bellMeasure(target_qubit->getBackendQubitRef()); }
+
+EigenvalueResult VirtualStationaryQubit::purify(IStationaryQubit *trash_qubit, PurificationBasis basis) { return qubit_ref->purify(trash_qubit->getBackendQubitRef(), basis); }
+
+void VirtualStationaryQubit::gateHadamard() { qubit_ref->gateH(); }
+
+void VirtualStationaryQubit::gateX() { qubit_ref->gateX(); }
+
+void VirtualStationaryQubit::gateZ() { qubit_ref->gateZ(); }
+
+void VirtualStationaryQubit::gateY() { qubit_ref->gateY(); }
+
+void VirtualStationaryQubit::gateS() { qubit_ref->gateS(); }
+
+void VirtualStationaryQubit::gateSdg() { qubit_ref->gateSdg(); }
+
+backends::IQubit *VirtualStationaryQubit::getBackendQubitRef() const { return qubit_ref; }
+
+QubitArray::QubitArray() : provider(utils::ComponentProvider{this}) {}
+
+void QubitArray::initialize() {
+  event_profiler = provider.getEventProfiler();
+  emission_success_probability = par("emission_success_probability");
+  node_address = par("node_address");
+  qnic_type = par("qnic_type");
+  qnic_index = par("qnic_index");
+  emission_jittering_standard_deviation = par("emission_jittering_standard_deviation").doubleValue();
+  int num_qubits = par("num_qubits");
+
+  backend = provider.getQuantumBackend();
+  qubits.reserve(num_qubits);
+  for (int i = 0; i < num_qubits; i++) {
+    auto *qubit_ref = backend->createQubit(new QubitId(node_address, qnic_index, qnic_type, i), prepareBackendQubitConfiguration());
+    if (qubit_ref == nullptr) throw std::runtime_error("qubit_ref nullptr error");
+    qubits.emplace_back(this, i, qubit_ref);
+    qubits.back().setFree(false);
+  }
+}
+
+std::unique_ptr<IConfiguration> QubitArray::prepareBackendQubitConfiguration() {
+  auto conf = backend->getDefaultConfiguration();
+  if (auto et_conf = dynamic_cast<backend::StationaryQubitConfiguration *>(conf.get())) {
+    backend::readQubitConfiguration(this, *et_conf);
+  }
+  return conf;
+}
+
+IStationaryQubit *QubitArray::getQubit(int qubit_index) {
+  if (qubit_index < 0 || qubit_index >= qubits.size()) {
+    throw cRuntimeError("QubitArray::getQubit: qubit index %d out of range, it has %d qubits", qubit_index, (int)qubits.size());
+  }
+  return &qubits[qubit_index];
+}
+
+/**
+ * \brief handle the PhotonicQubit scheduled by emitPhoton, the context pointer is the qubit which emitted it.
+ */
+void QubitArray::handleMessage(cMessage *msg) {
+  modules::SharedResource::EventProfiler::Scope profile(event_profiler, this, msg);
+  if (!msg->isSelfMessage()) {
+    throw cRuntimeError("QubitArray::handleMessage: message from outside is not expected");
+  }
+  auto *qubit = static_cast<VirtualStationaryQubit *>(msg->getContextPointer());
+  qubit->is_busy = true;
+  qubit->emitted_time = simTime();
+  auto *pk = check_and_cast<PhotonicQubit *>(msg);
+  if (dblrand() < (1 - emission_success_probability)) pk->setLost(true);
+  send(pk, "tolens_quantum_port");
+}
+
+void QubitArray::emitPhoton(VirtualStationaryQubit *qubit, int pulse) {
+  Enter_Method("emitPhoton()");
+  if (qubit->is_busy) {
+    error("Requested a photon emission to a busy qubit... this should not happen!");
+    return;
+  }
+  auto *pk = new PhotonicQubit("Photon");
+  auto *photon_ref = backend->getShortLiveQubit();
+  qubit->qubit_ref->noiselessH();
+  qubit->qubit_ref->noiselessCNOT(photon_ref);
+  pk->setQubitRef(photon_ref);
+  if (pulse & STATIONARYQUBIT_PULSE_BEGIN) pk->setFirst(true);
+  if (pulse & STATIONARYQUBIT_PULSE_END) pk->setLast(true);
+  if (pulse & STATIONARYQUBIT_PULSE_BOUND) pk->setKind(3);
+  pk->setContextPointer(qubit);
+  float jitter_timing = module_rng.normalRandom(0, emission_jittering_standard_deviation);
+  scheduleAt(simTime() + fabs(jitter_timing), pk);  // cannot send back in time, so only positive lag
+}
+
+void QubitArray::emitPhotonIntoTrain(VirtualStationaryQubit *qubit, PhotonicQubitTrain *train, simtime_t emission_offset) {
+  Enter_Method("emitPhotonIntoTrain()");
+  if (qubit->is_busy) {
+    error("Requested a photon emission to a busy qubit... this should not happen!");
+    return;
+  }
+  TrainPhoton photon;
+  photon.qubit_ref = backend->getShortLiveQubit();
+  qubit->qubit_ref->noiselessH();
+  qubit->qubit_ref->noiselessCNOT(photon.qubit_ref);
+  float jitter_timing = module_rng.normalRandom(0, emission_jittering_standard_deviation);
+  photon.emission_offset = emission_offset + fabs(jitter_timing);
+  qubit->is_busy = true;
+  qubit->emitted_time = simTime();
+  photon.is_lost = dblrand() < (1 - emission_success_probability);
+  train->appendPhoton(photon);
+}
+
+void QubitArray::sendPhotonTrain(PhotonicQubitTrain *train) {
+  Enter_Method("sendPhotonTrain()");
+  take(train);
+  send(train, "tolens_quantum_port");
+}
+
+MeasurementOutcome QubitArray::measureRandomPauliBasis(VirtualStationaryQubit *qubit) {
+  Enter_Method("measureRandomPauliBasis()");
+  // X, Y or Z uniformly
+  static const util_functions::CumulativeDistribution<3> pauli_bases({1, 1, 1});
+  auto outcome = MeasurementOutcome();
+  switch (module_rng.categoricalRandom(pauli_bases)) {
+    case 0:
+      outcome.outcome_is_plus = qubit->qubit_ref->measureX() == EigenvalueResult::PLUS_ONE;
+      outcome.basis = 'X';
+      break;
+    case 1:
+      outcome.outcome_is_plus = qubit->qubit_ref->measureY() == EigenvalueResult::PLUS_ONE;
+      outcome.basis = 'Y';
+      break;
+    default:
+      outcome.outcome_is_plus = qubit->qubit_ref->measureZ() == EigenvalueResult::PLUS_ONE;
+      outcome.basis = 'Z';
+  }
+  outcome.GOD_clean = 'F';  // need to fix this to properly track the error
+  return outcome;
+}
+
+}  // namespace quisp::modules
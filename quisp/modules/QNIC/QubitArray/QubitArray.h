@@ -0,0 +1,102 @@
+/** \file QubitArray.h
+ *
+ *  \brief QubitArray
+ */
+#pragma once
+
+#include <vector>
+#include "modules/QNIC/StationaryQubit/StationaryQubit.h"
+
+namespace quisp::modules {
+
+class QubitArray;
+
+/**
+ * \brief a memory of a QubitArray. It has the state of a StationaryQubit without a module of its own,
+ * the photons are emitted by the QubitArray.
+ */
+class VirtualStationaryQubit : public IStationaryQubit {
+ public:
+  VirtualStationaryQubit(QubitArray *array, int qubit_index, IBackendQubit *qubit_ref);
+
+  void setFree(bool consumed) override;
+  backends::IQubit *setFreeInBatch(bool consumed) override;
+  void Lock(unsigned long rs_id, int rule_id, int action_id) override;
+  void Unlock() override;
+  bool isLocked() override;
+
+  void emitPhoton(int pulse) override;
+  void emitPhotonIntoTrain(messages::PhotonicQubitTrain *train, omnetpp::simtime_t emission_offset) override;
+  void sendPhotonTrain(messages::PhotonicQubitTrain *train) override;
+
+  types::EigenvalueResult measureX() override;
+  types::EigenvalueResult measureY() override;
+  types::EigenvalueResult measureZ() override;
+  types::MeasurementOutcome measureRandomPauliBasis() override;
+
+  void gateCNOT(IStationaryQubit *target_qubit) override;
+  types::BellMeasurementResult bellMeasure(IStationaryQubit *target_qubit) override;
+  types::EigenvalueResult purify(IStationaryQubit *trash_qubit, types::PurificationBasis basis) override;
+  void gateHadamard() override;
+  void gateX() override;
+  void gateZ() override;
+  void gateY() override;
+  void gateS() override;
+  void gateSdg() override;
+
+  backends::IQubit *getBackendQubitRef() const override;
+  bool isBusy() const { return is_busy; }
+
+ private:
+  friend QubitArray;
+  QubitArray *array;
+  IBackendQubit *qubit_ref;
+  bool is_busy = false;
+  bool locked = false;
+  unsigned long locked_ruleset_id = -1;
+  unsigned long locked_rule_id = -1;
+  omnetpp::simtime_t emitted_time = -1;
+};
+
+/** \class QubitArray QubitArray.h
+ *
+ *  \brief QubitArray holds all the memories of a QNIC in one module, instead of a StationaryQubit module each.
+ *
+ *  The memories share the parameters of the module, and ComponentProvider::getStationaryQubit returns their
+ *  VirtualStationaryQubit handles. The photons of all the memories leave through the one tolens_quantum_port.
+ */
+class QubitArray : public omnetpp::cSimpleModule {
+ public:
+  QubitArray();
+  IStationaryQubit *getQubit(int qubit_index);
+  int getNumQubits() const { return qubits.size(); }
+
+ protected:
+  void initialize() override;
+  void handleMessage(omnetpp::cMessage *msg) override;
+
+  std::unique_ptr<IConfiguration> prepareBackendQubitConfiguration();
+
+ private:
+  friend VirtualStationaryQubit;
+  void emitPhoton(VirtualStationaryQubit *qubit, int pulse);
+  void emitPhotonIntoTrain(VirtualStationaryQubit *qubit, messages::PhotonicQubitTrain *train, omnetpp::simtime_t emission_offset);
+  void sendPhotonTrain(messages::PhotonicQubitTrain *train);
+  types::MeasurementOutcome measureRandomPauliBasis(VirtualStationaryQubit *qubit);
+
+  // reserved once in initialize, so the handles stay valid as long as the module
+  std::vector<VirtualStationaryQubit> qubits;
+  double emission_success_probability;
+  double emission_jittering_standard_deviation;
+  int node_address;
+  int qnic_type;
+  int qnic_index;
+
+  utils::ComponentProvider provider;
+  modules::SharedResource::EventProfiler *event_profiler = nullptr;
+  IQuantumBackend *backend;
+  // the samplers over the RNG of the module
+  backend::rng::RNG module_rng{this};
+};
+
+}  // namespace quisp::modules
@@ -0,0 +1,144 @@
+#include "QubitArray.h"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <modules/common_types.h>
+#include <test_utils/TestUtils.h>
+#include <cstring>
+#include <stdexcept>
+#include "backends/interfaces/IConfiguration.h"
+#include "test_utils/Simulation.h"
+#include "test_utils/TestUtilFunctions.h"
+#include "test_utils/mock_backends/MockQuantumBackend.h"
+
+using namespace testing;
+using namespace quisp::modules;
+using namespace quisp::modules::common;
+using namespace quisp_test;
+using namespace omnetpp;
+using quisp::messages::PhotonicQubit;
+using quisp::messages::PhotonicQubitTrain;
+
+namespace {
+
+class Strategy : public TestComponentProviderStrategy {
+ public:
+  Strategy(IQuantumBackend *backend) : backend(backend) {}
+  ~Strategy() {}
+  IQuantumBackend *getQuantumBackend() override { return backend; }
+  IQuantumBackend *backend;
+};
+
+class QubitArrayTarget : public QubitArray {
+ public:
+  using QubitArray::handleMessage;
+  using QubitArray::initialize;
+  using QubitArray::par;
+  QubitArrayTarget(IQuantumBackend *backend) : QubitArray() {
+    setComponentType(new TestModuleType("test qubit array"));
+    provider.setStrategy(std::make_unique<Strategy>(backend));
+    toLensGate = new TestGate(this, "tolens_quantum_port");
+  }
+  void fillParams(int num_qubits, double emission_success_probability) {
+    setParInt(this, "num_qubits", num_qubits);
+    setParDouble(this, "emission_success_probability", emission_success_probability);
+    setParInt(this, "stationary_qubit_address", -1);
+    setParInt(this, "node_address", 1);
+    setParInt(this, "qnic_address", 1);
+    setParInt(this, "qnic_type", 0);
+    setParInt(this, "qnic_index", 0);
+    setParDouble(this, "emission_jittering_standard_deviation", 0);
+  }
+
+  TestGate *toLensGate;
+  cGate *gate(const char *gatename, int index = -1) override {
+    if (strcmp("tolens_quantum_port", gatename) != 0) {
+      throw std::runtime_error("unexpected gate name");
+    }
+    return toLensGate;
+  }
+};
+
+class QubitArrayTest : public ::testing::Test {
+ protected:
+  void SetUp() {
+    sim = prepareSimulation();
+    backend = new MockQuantumBackend();
+    array = new QubitArrayTarget(backend);
+    sim->registerComponent(array);
+  }
+  void TearDown() {
+    for (auto *backend_qubit : backend_qubits) delete backend_qubit;
+    delete backend;
+  }
+
+  // initializes the array with the mock backend qubits
+  void initialize(int num_qubits, double emission_success_probability) {
+    array->fillParams(num_qubits, emission_success_probability);
+    EXPECT_CALL(*backend, getDefaultConfiguration()).Times(num_qubits).WillRepeatedly([]() { return std::make_unique<IConfiguration>(); });
+    for (int i = 0; i < num_qubits; i++) {
+      auto *backend_qubit = new MockBackendQubit();
+      EXPECT_CALL(*backend_qubit, setFree()).WillOnce(Return());
+      backend_qubits.push_back(backend_qubit);
+    }
+    auto next = backend_qubits.begin();
+    EXPECT_CALL(*backend, createQubit(NotNull(), NotNull())).Times(num_qubits).WillRepeatedly([&next](auto, auto) { return *next++; });
+    array->callInitialize();
+  }
+
+  QubitArrayTarget *array;
+  MockQuantumBackend *backend;
+  std::vector<MockBackendQubit *> backend_qubits;
+  simulation::TestSimulation *sim;
+};
+
+TEST_F(QubitArrayTest, initCreatesTheQubits) {
+  initialize(3, 1);
+  ASSERT_EQ(array->getNumQubits(), 3);
+  for (int i = 0; i < 3; i++) {
+    auto *qubit = array->getQubit(i);
+    EXPECT_EQ(qubit->stationary_qubit_address, i);
+    EXPECT_EQ(qubit->qnic_index, 0);
+    EXPECT_EQ(qubit->getBackendQubitRef(), backend_qubits.at(i));
+    EXPECT_FALSE(qubit->isLocked());
+  }
+  EXPECT_THROW(array->getQubit(3), cRuntimeError);
+  EXPECT_THROW(array->getQubit(-1), cRuntimeError);
+}
+
+TEST_F(QubitArrayTest, lockAndUnlock) {
+  initialize(2, 1);
+  auto *qubit = array->getQubit(1);
+  qubit->Lock(1, 2, 3);
+  EXPECT_TRUE(qubit->isLocked());
+  EXPECT_EQ(qubit->action_index, 3);
+  EXPECT_FALSE(array->getQubit(0)->isLocked());
+  qubit->Unlock();
+  EXPECT_FALSE(qubit->isLocked());
+}
+
+TEST_F(QubitArrayTest, emissionThroughTheArray) {
+  initialize(2, 0);
+  sim->setContext(array);
+  auto *qubit = dynamic_cast<VirtualStationaryQubit *>(array->getQubit(1));
+  ASSERT_NE(qubit, nullptr);
+  auto *msg = new PhotonicQubit();
+  msg->setContextPointer(qubit);
+  array->handleMessage(msg);
+  ASSERT_EQ(array->toLensGate->messages.size(), 1);
+  auto *photon = dynamic_cast<PhotonicQubit *>(array->toLensGate->messages.at(0));
+  ASSERT_NE(photon, nullptr);
+  EXPECT_TRUE(photon->isLost());
+  EXPECT_TRUE(qubit->isBusy());
+  EXPECT_FALSE(dynamic_cast<VirtualStationaryQubit *>(array->getQubit(0))->isBusy());
+}
+
+TEST_F(QubitArrayTest, photonTrainGoesToLens) {
+  initialize(1, 1);
+  sim->setContext(array);
+  auto *train = new PhotonicQubitTrain();
+  array->getQubit(0)->sendPhotonTrain(train);
+  ASSERT_EQ(array->toLensGate->messages.size(), 1);
+  EXPECT_EQ(array->toLensGate->messages.at(0), train);
+}
+
+}  // namespace
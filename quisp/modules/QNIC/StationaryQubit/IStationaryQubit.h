@@ -7,23 +7,33 @@
 
 namespace quisp::types {
 
+using quisp::backends::BellMeasurementResult;
 using quisp::backends::EigenvalueResult;
 using quisp::backends::MeasurementOutcome;
 using quisp::backends::MeasureXResult;
 using quisp::backends::MeasureYResult;
 using quisp::backends::MeasureZResult;
+using quisp::backends::PurificationBasis;
 
 }  // namespace quisp::types
 
 namespace quisp::modules {
 
-class IStationaryQubit : public omnetpp::cSimpleModule {
+/**
+ * \brief IStationaryQubit is a memory qubit of a QNIC.
+ *
+ * It's a module of its own (StationaryQubit), or a handle to a memory of the QubitArray of the QNIC.
+ */
+class IStationaryQubit {
  public:
   IStationaryQubit(){};
   virtual ~IStationaryQubit(){};
 
   // RTC
   virtual void setFree(bool consumed) = 0;
+  // setFree() of a batch: resets the qubit and returns its backend qubit for the caller to free with the others, nullptr if it has none.
+  // no log or bubble of its own, the caller reports the batch
+  virtual backends::IQubit *setFreeInBatch(bool consumed) = 0;
   /*In use. E.g. waiting for purification result.*/
   virtual void Lock(unsigned long rs_id, int rule_id, int action_id) = 0;
   virtual void Unlock() = 0;
@@ -34,6 +44,18 @@ class IStationaryQubit : public omnetpp::cSimpleModule {
    * \param pulse is 1 for the beginning of the burst, 2 for the end.
    */
   virtual void emitPhoton(int pulse) = 0;
+  /**
+   * \brief Emit photon in a later time bin of the pulse, as a mode of a multimode memory.
+   * \param emission_offset is the emission time from the beginning of the pulse.
+   */
+  virtual void emitPhotonInTimeBin(int pulse, omnetpp::simtime_t emission_offset) = 0;
+  /**
+   * \brief Emit photon into the train of the qnic, instead of sending it by itself.
+   * \param emission_offset is the emission time from the beginning of the train.
+   */
+  virtual void emitPhotonIntoTrain(messages::PhotonicQubitTrain *train, omnetpp::simtime_t emission_offset) = 0;
+  // sends the train out to the lens, from the qubit of its first photon
+  virtual void sendPhotonTrain(messages::PhotonicQubitTrain *train) = 0;
 
   virtual types::EigenvalueResult measureX() = 0;
   virtual types::EigenvalueResult measureY() = 0;
@@ -41,6 +63,10 @@ class IStationaryQubit : public omnetpp::cSimpleModule {
   virtual types::MeasurementOutcome measureRandomPauliBasis() = 0;
 
   virtual void gateCNOT(IStationaryQubit *target_qubit) = 0;
+  // CNOT to the target, X measurement on this qubit and Z measurement on the target
+  virtual types::BellMeasurementResult bellMeasure(IStationaryQubit *target_qubit) = 0;
+  // one purification round with the trash qubit, returns the outcome of the trash
+  virtual types::EigenvalueResult purify(IStationaryQubit *trash_qubit, types::PurificationBasis basis) = 0;
   virtual void gateHadamard() = 0;
   // RTC
   virtual void gateX() = 0;
@@ -52,6 +78,9 @@ class IStationaryQubit : public omnetpp::cSimpleModule {
   virtual backends::IQubit *getBackendQubitRef() const = 0;
   int qnic_type;
   int qnic_index;
+  // the index of the qubit in the qnic
+  int stationary_qubit_address = -1;
   int action_index;
+  double emission_success_probability = 1;
 };
 }  // namespace quisp::modules
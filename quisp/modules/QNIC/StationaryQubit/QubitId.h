@@ -1,4 +1,6 @@
 #pragma once
+#include <cstdint>
+#include <stdexcept>
 #include "backends/Backends.h"
 #include "modules/QNIC/StationaryQubit/IStationaryQubit.h"
 
@@ -20,12 +22,35 @@ class QubitId : public quisp::backends::IQubitId {
     return node_addr == id.node_addr && qnic_index == id.qnic_index && qnic_type == id.qnic_type && qubit_addr == id.qubit_addr;
   }
 
+  /**
+   * packs the fields into node:24 | qnic type:2 | qnic index:14 | qubit:24 bits, from the most significant bit.
+   * -1 fills its field with ones; the short live qubits of the backends use -1 for the node, the qnic type and the qnic index.
+   */
+  static std::uint64_t pack(int node_addr, int qnic_index, int qnic_type, int qubit_addr) {
+    return packField(node_addr, node_bits) << (qnic_type_bits + qnic_index_bits + qubit_bits) | packField(qnic_type, qnic_type_bits) << (qnic_index_bits + qubit_bits) |
+           packField(qnic_index, qnic_index_bits) << qubit_bits | packField(qubit_addr, qubit_bits);
+  }
+
   int node_addr;
   int qnic_index;
   int qnic_type;
   int qubit_addr;
 
+  static constexpr int node_bits = 24;
+  static constexpr int qnic_type_bits = 2;
+  static constexpr int qnic_index_bits = 14;
+  static constexpr int qubit_bits = 24;
+
  protected:
+  std::uint64_t pack() const override { return pack(node_addr, qnic_index, qnic_type, qubit_addr); }
+
+  static std::uint64_t packField(int value, int bits) {
+    auto mask = (std::uint64_t{1} << bits) - 1;
+    if (value == -1) return mask;
+    if (value < 0 || static_cast<std::uint64_t>(value) >= mask) throw std::invalid_argument("QubitId: a field doesn't fit in its bits of the packed key");
+    return static_cast<std::uint64_t>(value);
+  }
+
   // https://stackoverflow.com/questions/4948780/magic-number-in-boosthash-combine
   void hashCombine(std::size_t& seed, int const& v) const { seed ^= std::hash<int>()(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2); }
 };
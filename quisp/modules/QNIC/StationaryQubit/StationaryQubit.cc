@@ -11,17 +11,24 @@
 #include <unsupported/Eigen/KroneckerProduct>
 #include <unsupported/Eigen/MatrixFunctions>
 #include "backends/interfaces/IQubit.h"
+#include "modules/Backend/QubitConfigurationParameters.h"
 #include "omnetpp/cexception.h"
+#include "utils/Headless.h"
+#include "utils/UtilFunctions.h"
 
 using namespace Eigen;
 
 using quisp::messages::PhotonicQubit;
+using quisp::messages::PhotonicQubitTrain;
+using quisp::messages::TrainPhoton;
 using quisp::modules::qubit_id::QubitId;
+using quisp::types::BellMeasurementResult;
 using quisp::types::EigenvalueResult;
 using quisp::types::MeasurementOutcome;
 using quisp::types::MeasureXResult;
 using quisp::types::MeasureYResult;
 using quisp::types::MeasureZResult;
+using quisp::types::PurificationBasis;
 
 namespace quisp::modules {
 
@@ -29,6 +36,8 @@ Define_Module(StationaryQubit);
 
 StationaryQubit::StationaryQubit() : provider(utils::ComponentProvider{this}) {}
 
+StationaryQubit::~StationaryQubit() { cancelAndDelete(idle_release_timer); }
+
 /**
  * \brief Initialize StationaryQubit
  *
@@ -36,6 +45,7 @@ StationaryQubit::StationaryQubit() : provider(utils::ComponentProvider{this}) {}
  *
  */
 void StationaryQubit::initialize() {
+  event_profiler = provider.getEventProfiler();
   // read and set parameters
   emission_success_probability = par("emission_success_probability");
 
@@ -50,63 +60,31 @@ void StationaryQubit::initialize() {
   /* e^(t/T1) energy relaxation, e^(t/T2) phase relaxation. Want to use only 1/10 of T1 and T2 in general.*/
 
   backend = provider.getQuantumBackend();
-  auto config = prepareBackendQubitConfiguration(true);
-  qubit_ref = backend->createQubit(new QubitId(node_address, qnic_index, qnic_type, stationary_qubit_address), std::move(config));
-  if (qubit_ref == nullptr) throw std::runtime_error("qubit_ref nullptr error");
+  qubit_id = new QubitId(node_address, qnic_index, qnic_type, stationary_qubit_address);
+  lazy_backend_qubit = par("lazy_backend_qubit");
+  simtime_t idle_timeout = par("backend_qubit_idle_timeout");
+  if (idle_timeout < SIMTIME_ZERO) error("backend_qubit_idle_timeout must not be negative");
+  if (idle_timeout > SIMTIME_ZERO) {
+    if (!lazy_backend_qubit) error("backend_qubit_idle_timeout needs lazy_backend_qubit");
+    backend_qubit_idle_timeout = idle_timeout;
+    idle_release_timer = new cMessage("BackendQubitIdleReleaseTimer");
+  }
+  if (!lazy_backend_qubit) backendQubit();
   setFree(false);
 
   // watch variables to show them in the GUI
-  WATCH(emitted_time);
-  WATCH(is_busy);
-  WATCH(qubit_ref);
+  if (utils::showsGUI(this)) {
+    WATCH(emitted_time);
+    WATCH(is_busy);
+    WATCH(qubit_ref);
+  }
 }
 
 std::unique_ptr<IConfiguration> StationaryQubit::prepareBackendQubitConfiguration(bool overwrite) {
   auto conf = backend->getDefaultConfiguration();
   if (!overwrite) return conf;
   if (auto et_conf = dynamic_cast<backend::StationaryQubitConfiguration *>(conf.get())) {
-    et_conf->measurement_x_err_rate = par("x_measurement_error_rate").doubleValue();
-    et_conf->measurement_y_err_rate = par("y_measurement_error_rate").doubleValue();
-    et_conf->measurement_z_err_rate = par("z_measurement_error_rate").doubleValue();
-
-    et_conf->h_gate_err_rate = par("h_gate_error_rate").doubleValue();
-    et_conf->h_gate_x_err_ratio = par("h_gate_x_error_ratio").doubleValue();
-    et_conf->h_gate_y_err_ratio = par("h_gate_y_error_ratio").doubleValue();
-    et_conf->h_gate_z_err_ratio = par("h_gate_z_error_ratio").doubleValue();
-
-    et_conf->x_gate_err_rate = par("x_gate_error_rate").doubleValue();
-    et_conf->x_gate_x_err_ratio = par("x_gate_x_error_ratio").doubleValue();
-    et_conf->x_gate_y_err_ratio = par("x_gate_y_error_ratio").doubleValue();
-    et_conf->x_gate_z_err_ratio = par("x_gate_z_error_ratio").doubleValue();
-
-    et_conf->z_gate_err_rate = par("z_gate_error_rate").doubleValue();
-    et_conf->z_gate_x_err_ratio = par("z_gate_x_error_ratio").doubleValue();
-    et_conf->z_gate_y_err_ratio = par("z_gate_y_error_ratio").doubleValue();
-    et_conf->z_gate_z_err_ratio = par("z_gate_z_error_ratio").doubleValue();
-
-    et_conf->cnot_gate_err_rate = par("cnot_gate_error_rate").doubleValue();
-    et_conf->cnot_gate_ix_err_ratio = par("cnot_gate_ix_error_ratio").doubleValue();
-    et_conf->cnot_gate_iy_err_ratio = par("cnot_gate_iy_error_ratio").doubleValue();
-    et_conf->cnot_gate_iz_err_ratio = par("cnot_gate_iz_error_ratio").doubleValue();
-    et_conf->cnot_gate_xi_err_ratio = par("cnot_gate_xi_error_ratio").doubleValue();
-    et_conf->cnot_gate_xx_err_ratio = par("cnot_gate_xx_error_ratio").doubleValue();
-    et_conf->cnot_gate_xy_err_ratio = par("cnot_gate_xy_error_ratio").doubleValue();
-    et_conf->cnot_gate_xz_err_ratio = par("cnot_gate_xz_error_ratio").doubleValue();
-    et_conf->cnot_gate_yi_err_ratio = par("cnot_gate_yi_error_ratio").doubleValue();
-    et_conf->cnot_gate_yx_err_ratio = par("cnot_gate_yx_error_ratio").doubleValue();
-    et_conf->cnot_gate_yy_err_ratio = par("cnot_gate_yy_error_ratio").doubleValue();
-    et_conf->cnot_gate_yz_err_ratio = par("cnot_gate_yz_error_ratio").doubleValue();
-    et_conf->cnot_gate_zi_err_ratio = par("cnot_gate_zi_error_ratio").doubleValue();
-    et_conf->cnot_gate_zx_err_ratio = par("cnot_gate_zx_error_ratio").doubleValue();
-    et_conf->cnot_gate_zy_err_ratio = par("cnot_gate_zy_error_ratio").doubleValue();
-    et_conf->cnot_gate_zz_err_ratio = par("cnot_gate_zz_error_ratio").doubleValue();
-
-    et_conf->memory_x_err_rate = par("memory_x_error_rate").doubleValue();
-    et_conf->memory_y_err_rate = par("memory_y_error_rate").doubleValue();
-    et_conf->memory_z_err_rate = par("memory_z_error_rate").doubleValue();
-    et_conf->memory_excitation_rate = par("memory_energy_excitation_rate").doubleValue();
-    et_conf->memory_relaxation_rate = par("memory_energy_relaxation_rate").doubleValue();
-    et_conf->memory_completely_mixed_rate = par("memory_completely_mixed_rate").doubleValue();
+    backend::readQubitConfiguration(this, *et_conf);
   }
   return conf;
 }
@@ -119,10 +97,15 @@ void StationaryQubit::finish() {}
  * \param msg is the PhotonicQubit message
  */
 void StationaryQubit::handleMessage(cMessage *msg) {
+  modules::SharedResource::EventProfiler::Scope profile(event_profiler, this, msg);
+  if (msg == idle_release_timer) {
+    releaseIdleBackendQubit();
+    return;
+  }
   if (!msg->isSelfMessage()) {
     throw cRuntimeError("StationaryQubit::handleMessage: message from outside is not expected");
   }
-  bubble("Got a photon!!");
+  if (utils::showsGUI(this)) bubble("Got a photon!!");
   setBusy();
   double rand = dblrand();
   if (rand < (1 - emission_success_probability)) {
@@ -134,31 +117,52 @@ void StationaryQubit::handleMessage(cMessage *msg) {
   }
 }
 
-EigenvalueResult StationaryQubit::measureX() { return qubit_ref->measureX(); }
+EigenvalueResult StationaryQubit::measureX() { return backendQubit()->measureX(); }
+
+EigenvalueResult StationaryQubit::measureY() { return backendQubit()->measureY(); }
+
+EigenvalueResult StationaryQubit::measureZ() { return backendQubit()->measureZ(); }
 
-EigenvalueResult StationaryQubit::measureY() { return qubit_ref->measureY(); }
+void StationaryQubit::gateHadamard() { backendQubit()->gateH(); }
 
-EigenvalueResult StationaryQubit::measureZ() { return qubit_ref->measureZ(); }
+void StationaryQubit::gateX() { backendQubit()->gateX(); }
 
-void StationaryQubit::gateHadamard() { qubit_ref->gateH(); }
+void StationaryQubit::gateZ() { backendQubit()->gateZ(); }
 
-void StationaryQubit::gateX() { qubit_ref->gateX(); }
+void StationaryQubit::gateY() { backendQubit()->gateY(); }
 
-void StationaryQubit::gateZ() { qubit_ref->gateZ(); }
+void StationaryQubit::gateS() { backendQubit()->gateS(); }
 
-void StationaryQubit::gateY() { qubit_ref->gateY(); }
+void StationaryQubit::gateSdg() { backendQubit()->gateSdg(); }
 
-void StationaryQubit::gateS() { qubit_ref->gateS(); }
+// the other qubit may be a module or a memory of a QubitArray, only its backend qubit matters
+void StationaryQubit::gateCNOT(IStationaryQubit *target_qubit) { backendQubit()->gateCNOT(target_qubit->getBackendQubitRef()); }
 
-void StationaryQubit::gateSdg() { qubit_ref->gateSdg(); }
+BellMeasurementResult StationaryQubit::bellMeasure(IStationaryQubit *target_qubit) { return backendQubit()->bellMeasure(target_qubit->getBackendQubitRef()); }
 
-void StationaryQubit::gateCNOT(IStationaryQubit *target_qubit) { qubit_ref->gateCNOT(check_and_cast<StationaryQubit *>(target_qubit)->qubit_ref); }
+EigenvalueResult StationaryQubit::purify(IStationaryQubit *trash_qubit, PurificationBasis basis) { return backendQubit()->purify(trash_qubit->getBackendQubitRef(), basis); }
+
+IBackendQubit *StationaryQubit::backendQubit() {
+  num_backend_qubit_uses++;
+  if (qubit_ref != nullptr) return qubit_ref;
+  // a new backend qubit is in the state of a freed one
+  qubit_ref = backend->createQubit(qubit_id, prepareBackendQubitConfiguration(true));
+  if (qubit_ref == nullptr) throw std::runtime_error("qubit_ref nullptr error");
+  return qubit_ref;
+}
+
+void StationaryQubit::releaseIdleBackendQubit() {
+  // used or emitted again since it was freed
+  if (qubit_ref == nullptr || is_busy || num_backend_qubit_uses != backend_qubit_uses_at_free) return;
+  backend->deleteQubit(qubit_id);
+  qubit_ref = nullptr;
+}
 
 // This is invoked whenever a photon is emitted out from this particular qubit.
 void StationaryQubit::setBusy() {
   is_busy = true;
   emitted_time = simTime();
-  if (hasGUI()) {
+  if (utils::showsGUI(this)) {
     getDisplayString().setTagArg("i", 1, "red");
   }
 }
@@ -166,24 +170,28 @@ void StationaryQubit::setBusy() {
 // Re-initialization of this stationary qubit
 // This is called at the beginning of the simulation (in initialization() above), and whenever it is reinitialized via the RealTimeController.
 void StationaryQubit::setFree(bool consumed) {
-  qubit_ref->setFree();
+  if (auto *backend_qubit = setFreeInBatch(consumed)) backend_qubit->setFree();
+
+  EV_DEBUG << "Freeing this qubit! " << this << " at qnode: " << node_address << " qnic_type: " << qnic_type << " qnic_index: " << qnic_index << "\n";
+  if (utils::showsGUI(this)) bubble(consumed ? "Consumed!" : "Failed to entangle!");
+}
+
+// a lazy backend qubit that isn't materialized has nothing to free
+backends::IQubit *StationaryQubit::setFreeInBatch(bool consumed) {
   is_busy = false;
   locked = false;
   locked_ruleset_id = -1;
   locked_rule_id = -1;
   action_index = -1;
   emitted_time = -1;
-
-  EV_DEBUG << "Freeing this qubit! " << this << " at qnode: " << node_address << " qnic_type: " << qnic_type << " qnic_index: " << qnic_index << "\n";
-  if (hasGUI()) {
-    if (consumed) {
-      bubble("Consumed!");
-      getDisplayString().setTagArg("i", 1, "yellow");
-    } else {
-      bubble("Failed to entangle!");
-      getDisplayString().setTagArg("i", 1, "blue");
-    }
+  if (idle_release_timer != nullptr && qubit_ref != nullptr) {
+    Enter_Method_Silent();
+    backend_qubit_uses_at_free = num_backend_qubit_uses;
+    cancelEvent(idle_release_timer);
+    scheduleAt(simTime() + backend_qubit_idle_timeout, idle_release_timer);
   }
+  if (utils::showsGUI(this)) getDisplayString().setTagArg("i", 1, consumed ? "yellow" : "blue");
+  return qubit_ref;
 }
 
 /*To avoid disturbing this qubit.*/
@@ -195,7 +203,7 @@ void StationaryQubit::Lock(unsigned long rs_id, int rule_id, int action_id) {
   locked_ruleset_id = rs_id;  // Used to identify what this qubit is locked for.
   locked_rule_id = rule_id;
   action_index = action_id;
-  if (hasGUI()) {
+  if (utils::showsGUI(this)) {
     bubble("Locked!");
     getDisplayString().setTagArg("i", 1, "purple");
   }
@@ -206,7 +214,7 @@ void StationaryQubit::Unlock() {
   locked_ruleset_id = -1;  // Used to identify what this qubit is locked for.
   locked_rule_id = -1;
   action_index = -1;
-  if (hasGUI()) {
+  if (utils::showsGUI(this)) {
     bubble("Unlocked!");
     getDisplayString().setTagArg("i", 1, "pink");
   }
@@ -222,7 +230,7 @@ PhotonicQubit *StationaryQubit::generateEntangledPhoton() {
   Enter_Method("generateEntangledPhoton()");
   auto *photon = new PhotonicQubit("Photon");
   auto *photon_ref = backend->getShortLiveQubit();
-  qubit_ref->noiselessH();
+  backendQubit()->noiselessH();
   qubit_ref->noiselessCNOT(photon_ref);
   photon->setQubitRef(photon_ref);
   return photon;
@@ -235,8 +243,15 @@ PhotonicQubit *StationaryQubit::generateEntangledPhoton() {
  *
  * The stationary qubit shouldn't be already busy.
  */
-void StationaryQubit::emitPhoton(int pulse) {
-  Enter_Method("emitPhoton()");
+void StationaryQubit::emitPhoton(int pulse) { emitPhotonInTimeBin(pulse, SIMTIME_ZERO); }
+
+/**
+ * \brief Emit photon emission_offset after now
+ *
+ * The time bins of a pulse are emitted at once, each photon arriving at the BSA in its own bin.
+ */
+void StationaryQubit::emitPhotonInTimeBin(int pulse, simtime_t emission_offset) {
+  Enter_Method("emitPhotonInTimeBin()");
   if (is_busy) {
     error("Requested a photon emission to a busy qubit... this should not happen!");
     return;
@@ -245,25 +260,59 @@ void StationaryQubit::emitPhoton(int pulse) {
   if (pulse & STATIONARYQUBIT_PULSE_BEGIN) pk->setFirst(true);
   if (pulse & STATIONARYQUBIT_PULSE_END) pk->setLast(true);
   if (pulse & STATIONARYQUBIT_PULSE_BOUND) pk->setKind(3);
-  float jitter_timing = normal(0, emission_jittering_standard_deviation);
+  float jitter_timing = module_rng.normalRandom(0, emission_jittering_standard_deviation);
   float abso = fabs(jitter_timing);
-  scheduleAt(simTime() + abso, pk);  // cannot send back in time, so only positive lag
+  scheduleAt(simTime() + emission_offset + abso, pk);  // cannot send back in time, so only positive lag
+}
+
+/**
+ * \brief Emit photon into the train
+ *
+ * The same as emitPhoton and handleMessage, without the message of its own.
+ * The stationary qubit shouldn't be already busy.
+ */
+void StationaryQubit::emitPhotonIntoTrain(PhotonicQubitTrain *train, simtime_t emission_offset) {
+  Enter_Method("emitPhotonIntoTrain()");
+  if (is_busy) {
+    error("Requested a photon emission to a busy qubit... this should not happen!");
+    return;
+  }
+  TrainPhoton photon;
+  photon.qubit_ref = backend->getShortLiveQubit();
+  backendQubit()->noiselessH();
+  qubit_ref->noiselessCNOT(photon.qubit_ref);
+  float jitter_timing = module_rng.normalRandom(0, emission_jittering_standard_deviation);
+  photon.emission_offset = emission_offset + fabs(jitter_timing);  // only positive lag, as emitPhoton
+  setBusy();
+  photon.is_lost = dblrand() < (1 - emission_success_probability);
+  train->appendPhoton(photon);
+}
+
+void StationaryQubit::sendPhotonTrain(PhotonicQubitTrain *train) {
+  Enter_Method("sendPhotonTrain()");
+  take(train);
+  send(train, "tolens_quantum_port");
 }
 
-backends::IQubit *StationaryQubit::getBackendQubitRef() const { return qubit_ref; }
+// e.g. as the target of a two qubit gate, so it's materialized as well
+backends::IQubit *StationaryQubit::getBackendQubitRef() const { return const_cast<StationaryQubit *>(this)->backendQubit(); }
 
 MeasurementOutcome StationaryQubit::measureRandomPauliBasis() {
-  auto rand = dblrand();
+  // X, Y or Z uniformly
+  static const util_functions::CumulativeDistribution<3> pauli_bases({1, 1, 1});
   auto outcome = MeasurementOutcome();
-  if (rand < 1.0 / 3) {
-    outcome.outcome_is_plus = qubit_ref->measureX() == EigenvalueResult::PLUS_ONE;
-    outcome.basis = 'X';
-  } else if (rand < 2.0 / 3) {
-    outcome.outcome_is_plus = qubit_ref->measureY() == EigenvalueResult::PLUS_ONE;
-    outcome.basis = 'Y';
-  } else {
-    outcome.outcome_is_plus = qubit_ref->measureZ() == EigenvalueResult::PLUS_ONE;
-    outcome.basis = 'Z';
+  switch (module_rng.categoricalRandom(pauli_bases)) {
+    case 0:
+      outcome.outcome_is_plus = backendQubit()->measureX() == EigenvalueResult::PLUS_ONE;
+      outcome.basis = 'X';
+      break;
+    case 1:
+      outcome.outcome_is_plus = backendQubit()->measureY() == EigenvalueResult::PLUS_ONE;
+      outcome.basis = 'Y';
+      break;
+    default:
+      outcome.outcome_is_plus = backendQubit()->measureZ() == EigenvalueResult::PLUS_ONE;
+      outcome.basis = 'Z';
   }
   outcome.GOD_clean = 'F';  // need to fix this to properly track the error
   return outcome;
@@ -30,13 +30,16 @@ using quisp::modules::common::IBackendQubit;
 using quisp::modules::common::IConfiguration;
 using quisp::modules::common::IQuantumBackend;
 
-class StationaryQubit : public IStationaryQubit {
+class StationaryQubit : public omnetpp::cSimpleModule, public IStationaryQubit {
  protected:
-  IBackendQubit *qubit_ref;
+  // nullptr while a lazy_backend_qubit isn't materialized
+  IBackendQubit *qubit_ref = nullptr;
 
  public:
   StationaryQubit();
+  ~StationaryQubit();
   void setFree(bool consumed) override;
+  backends::IQubit *setFreeInBatch(bool consumed) override;
   /*In use. E.g. waiting for purification result.*/
   void Lock(unsigned long rs_id, int rule_id, int action_id) override;
   void Unlock() override;
@@ -47,6 +50,9 @@ class StationaryQubit : public IStationaryQubit {
    * \param pulse is 1 for the beginning of the burst, 2 for the end.
    */
   void emitPhoton(int pulse) override;
+  void emitPhotonInTimeBin(int pulse, omnetpp::simtime_t emission_offset) override;
+  void emitPhotonIntoTrain(messages::PhotonicQubitTrain *train, omnetpp::simtime_t emission_offset) override;
+  void sendPhotonTrain(messages::PhotonicQubitTrain *train) override;
 
   virtual types::EigenvalueResult measureX() override;
   virtual types::EigenvalueResult measureY() override;
@@ -54,6 +60,8 @@ class StationaryQubit : public IStationaryQubit {
   virtual types::MeasurementOutcome measureRandomPauliBasis() override;
 
   void gateCNOT(IStationaryQubit *target_qubit) override;
+  types::BellMeasurementResult bellMeasure(IStationaryQubit *target_qubit) override;
+  types::EigenvalueResult purify(IStationaryQubit *trash_qubit, types::PurificationBasis basis) override;
   void gateHadamard() override;
   void gateX() override;
   void gateZ() override;
@@ -63,8 +71,6 @@ class StationaryQubit : public IStationaryQubit {
 
   backends::IQubit *getBackendQubitRef() const override;
 
-  double emission_success_probability;
-
   bool locked;
   unsigned long locked_ruleset_id;
   unsigned long locked_rule_id;
@@ -83,6 +89,10 @@ class StationaryQubit : public IStationaryQubit {
    * if you want to use different qubit configuration, it's useful.
    */
   std::unique_ptr<IConfiguration> prepareBackendQubitConfiguration(bool overwrite);
+  // the backend qubit, created in its freed state at the first use with lazy_backend_qubit
+  IBackendQubit *backendQubit();
+  // deletes the backend qubit left unused for backend_qubit_idle_timeout since it was freed
+  void releaseIdleBackendQubit();
 
   // this is for debugging. class internal use only.
   // and it's different from QubitRecord's one.
@@ -91,12 +101,22 @@ class StationaryQubit : public IStationaryQubit {
   omnetpp::simtime_t emitted_time = -1;
   // Standard deviation
   double emission_jittering_standard_deviation;
-  int stationary_qubit_address;
   int node_address;
   int qnic_address;
 
+  qubit_id::QubitId *qubit_id = nullptr;
+  bool lazy_backend_qubit = false;
+  omnetpp::simtime_t backend_qubit_idle_timeout;
+  omnetpp::cMessage *idle_release_timer = nullptr;
+  // the uses of the backend qubit, to tell if it was used since it was freed
+  long num_backend_qubit_uses = 0;
+  long backend_qubit_uses_at_free = 0;
+
   utils::ComponentProvider provider;
+  modules::SharedResource::EventProfiler *event_profiler = nullptr;
   IQuantumBackend *backend;
+  // the samplers over the RNG of the module
+  backend::rng::RNG module_rng{this};
 };
 
 }  // namespace quisp::modules
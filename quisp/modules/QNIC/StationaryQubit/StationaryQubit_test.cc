@@ -27,6 +27,7 @@ using namespace Eigen;
 using namespace omnetpp;
 using quisp::backends::StationaryQubitConfiguration;
 using quisp::messages::PhotonicQubit;
+using quisp::messages::PhotonicQubitTrain;
 
 namespace {
 
@@ -104,6 +105,8 @@ class StatQubitTarget : public StationaryQubit {
     setParInt(this, "qnic_type", 0);
     setParInt(this, "qnic_index", 0);
     setParDouble(this, "emission_jittering_standard_deviation", 0.5);
+    setParBool(this, "lazy_backend_qubit", false);
+    setParDouble(this, "backend_qubit_idle_timeout", 0);
   }
 
   TestGate *toLensGate;
@@ -141,6 +144,32 @@ TEST_F(StatQubitTest, init) {
   delete backend_qubit;
 }
 
+TEST_F(StatQubitTest, lazyBackendQubit) {
+  setParBool(qubit, "lazy_backend_qubit", true);
+  setParDouble(qubit, "backend_qubit_idle_timeout", 1e-3);
+  EXPECT_CALL(*backend, createQubit(_, _)).Times(0);
+  qubit->callInitialize();
+  Mock::VerifyAndClearExpectations(backend);
+
+  // created at the first use
+  auto *backend_qubit = new MockBackendQubit();
+  EXPECT_CALL(*backend, getDefaultConfiguration()).WillOnce(Return(ByMove(std::make_unique<IConfiguration>())));
+  EXPECT_CALL(*backend, createQubit(NotNull(), NotNull())).WillOnce(Return(backend_qubit));
+  EXPECT_EQ(qubit->getBackendQubitRef(), backend_qubit);
+  EXPECT_EQ(qubit->getBackendQubitRef(), backend_qubit);
+
+  // and deleted after it's left free for the timeout
+  EXPECT_CALL(*backend_qubit, setFree()).WillOnce(Return());
+  sim->setContext(qubit);
+  qubit->reset();
+  ASSERT_EQ(sim->getFES()->getLength(), 1);
+  EXPECT_EQ(sim->getFES()->peekFirst()->getArrivalTime(), SimTime(1, SIMTIME_MS));
+  EXPECT_CALL(*backend, deleteQubit(NotNull())).WillOnce(Return());
+  sim->executeNextEvent();
+  Mock::VerifyAndClearExpectations(backend);
+  delete backend_qubit;
+}
+
 TEST_F(StatQubitTest, StationaryQubitConfigurationOverwrite) {
   auto *config = new StationaryQubitConfiguration();
   setParDouble(qubit, "cnot_gate_error_rate", 0.01);
@@ -298,6 +327,15 @@ TEST_F(StatQubitTest, emissionSuccess) {
   EXPECT_FALSE(photon->isLost());
 }
 
+TEST_F(StatQubitTest, photonTrainGoesToLens) {
+  sim->setContext(qubit);
+  auto *train = new PhotonicQubitTrain();
+  EXPECT_EQ(qubit->toLensGate->messages.size(), 0);
+  qubit->sendPhotonTrain(train);
+  ASSERT_EQ(qubit->toLensGate->messages.size(), 1);
+  EXPECT_EQ(qubit->toLensGate->messages.at(0), train);
+}
+
 TEST_F(StatQubitTest, finish) {
   ASSERT_NO_THROW({ qubit->finish(); });
 }
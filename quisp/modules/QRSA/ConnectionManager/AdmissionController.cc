@@ -0,0 +1,64 @@
+#include "AdmissionController.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace quisp::modules {
+
+AdmissionController::AdmissionController(double pair_rate, double raw_pairs_per_pair, int qubits_per_qnic)
+    : pair_rate(pair_rate), raw_pairs_per_pair(raw_pairs_per_pair), qubits_per_qnic(qubits_per_qnic) {}
+
+double AdmissionController::rawPairsPerPair(int link_rounds, int pumping_rounds, int remote_rounds) {
+  return std::pow(pumping_rounds + 1, link_rounds) * std::pow(2, remote_rounds);
+}
+
+// the rounds are done depth first, so each round keeps one pair while the deeper rounds make the next ones.
+// the end nodes keep the remote purification pairs on top of them.
+int AdmissionController::qubitsPerQnic(int link_rounds, int pumping_rounds, int remote_rounds) {
+  int link_qubits = link_rounds > 0 ? link_rounds * pumping_rounds + 1 : 1;
+  return link_qubits + remote_rounds;
+}
+
+AdmissionController::LinkKey AdmissionController::keyOf(const Link &link) { return {std::min(link.from, link.to), std::max(link.from, link.to)}; }
+
+double AdmissionController::achievableRate(const Path &path) const {
+  double rate = std::numeric_limits<double>::infinity();
+  for (auto &link : path.links) {
+    if (link.pair_rate <= 0) continue;
+    double committed = 0;
+    auto it = committed_link_rates.find(keyOf(link));
+    if (it != committed_link_rates.end()) committed = it->second;
+    rate = std::min(rate, std::max(0.0, link.pair_rate - committed) / raw_pairs_per_pair);
+  }
+  return rate;
+}
+
+bool AdmissionController::isFeasible(const Path &path) const {
+  if (path.min_qubits >= 0 && path.min_qubits < qubits_per_qnic) return false;
+  return achievableRate(path) >= pair_rate;
+}
+
+void AdmissionController::commit(unsigned long connection_id, const Path &path) {
+  release(connection_id);
+  auto &links = connection_links[connection_id];
+  for (auto &link : path.links) {
+    auto key = keyOf(link);
+    committed_link_rates[key] += pair_rate * raw_pairs_per_pair;
+    links.push_back(key);
+  }
+}
+
+bool AdmissionController::release(unsigned long connection_id) {
+  auto it = connection_links.find(connection_id);
+  if (it == connection_links.end()) return false;
+  for (auto &key : it->second) {
+    auto committed = committed_link_rates.find(key);
+    committed->second -= pair_rate * raw_pairs_per_pair;
+    if (committed->second <= 0) committed_link_rates.erase(committed);
+  }
+  connection_links.erase(it);
+  return true;
+}
+
+}  // namespace quisp::modules
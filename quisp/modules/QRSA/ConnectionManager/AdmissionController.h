@@ -0,0 +1,61 @@
+#pragma once
+
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace quisp::modules {
+
+/**
+ * @brief AdmissionController keeps the end-to-end pair rates the responder committed to its connections, by the links of their paths.
+ *
+ * A connection takes pair_rate delivered pairs per second, i.e. pair_rate times the raw pairs the purification consumes
+ * for one delivered pair on every link of its path. A new connection is feasible if each link with a known rate has that much left
+ * over the commitments, and each node on the path gives a connection the qubits the purification holds at once.
+ * The estimate assumes the purifications and the swappings succeed, so it only rejects the requests that can't be served even then.
+ */
+class AdmissionController {
+ public:
+  struct Link {
+    int from;
+    int to;
+    double pair_rate;  // the Bell pairs per second of the link, 0 if not estimated yet
+  };
+  struct Path {
+    std::vector<Link> links;
+    int min_qubits = -1;  // the qubits the smallest qnic on the path gives a connection, -1 if unknown
+  };
+
+  /**
+   * @param pair_rate           the end-to-end Bell pairs per second committed to each connection
+   * @param raw_pairs_per_pair  the link-level pairs consumed for one delivered pair, see rawPairsPerPair
+   * @param qubits_per_qnic     the qubits a connection needs in each qnic, see qubitsPerQnic
+   */
+  AdmissionController(double pair_rate, double raw_pairs_per_pair, int qubits_per_qnic);
+
+  /// @brief (pumping_rounds + 1)^link_rounds pairs for the link purification, doubled by each round of the remote purification.
+  static double rawPairsPerPair(int link_rounds, int pumping_rounds, int remote_rounds);
+  /// @brief the kept pair of each link purification round and the pairs pumped into the last one, and the pairs of the remote purification.
+  static int qubitsPerQnic(int link_rounds, int pumping_rounds, int remote_rounds);
+
+  /// @brief the end-to-end pair rate the path can still give a new connection, infinity if no link rate is known.
+  double achievableRate(const Path &path) const;
+  bool isFeasible(const Path &path) const;
+  /// @brief commits pair_rate on the links of the path to the connection.
+  void commit(unsigned long connection_id, const Path &path);
+  /// @brief returns false if the connection has no commitment.
+  bool release(unsigned long connection_id);
+  std::size_t numCommitments() const { return connection_links.size(); }
+
+ private:
+  using LinkKey = std::pair<int, int>;  // the smaller address first, the links are bidirectional
+  static LinkKey keyOf(const Link &link);
+
+  double pair_rate;
+  double raw_pairs_per_pair;
+  int qubits_per_qnic;
+  std::map<LinkKey, double> committed_link_rates;  // the link-level pairs per second committed on the link
+  std::map<unsigned long, std::vector<LinkKey>> connection_links;  // connection id -> the links of its path
+};
+
+}  // namespace quisp::modules
@@ -0,0 +1,55 @@
+#include "AdmissionController.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+
+namespace {
+using quisp::modules::AdmissionController;
+
+TEST(AdmissionControllerTest, PurificationCosts) {
+  EXPECT_DOUBLE_EQ(AdmissionController::rawPairsPerPair(0, 1, 0), 1);
+  EXPECT_DOUBLE_EQ(AdmissionController::rawPairsPerPair(2, 1, 0), 4);
+  EXPECT_DOUBLE_EQ(AdmissionController::rawPairsPerPair(1, 3, 1), 8);
+  EXPECT_EQ(AdmissionController::qubitsPerQnic(0, 1, 0), 1);
+  EXPECT_EQ(AdmissionController::qubitsPerQnic(2, 1, 0), 3);
+  EXPECT_EQ(AdmissionController::qubitsPerQnic(1, 3, 1), 5);
+}
+
+TEST(AdmissionControllerTest, CommitsTheRateOnTheLinksOfThePath) {
+  // 10 pairs/s per connection, 2 raw pairs each
+  AdmissionController controller(10, 2, 2);
+  AdmissionController::Path path{{{1, 2, 100}, {2, 3, 50}}, 4};
+  EXPECT_DOUBLE_EQ(controller.achievableRate(path), 25);
+  EXPECT_TRUE(controller.isFeasible(path));
+
+  controller.commit(7, path);
+  EXPECT_DOUBLE_EQ(controller.achievableRate(path), 15);
+  controller.commit(8, path);
+  EXPECT_DOUBLE_EQ(controller.achievableRate(path), 5);
+  EXPECT_FALSE(controller.isFeasible(path));
+  EXPECT_EQ(controller.numCommitments(), 2);
+
+  // the other direction of the link has the same commitments, the other links don't
+  EXPECT_DOUBLE_EQ(controller.achievableRate({{{3, 2, 50}}}), 5);
+  EXPECT_DOUBLE_EQ(controller.achievableRate({{{3, 4, 50}}}), 25);
+
+  EXPECT_TRUE(controller.release(7));
+  EXPECT_FALSE(controller.release(7));
+  EXPECT_TRUE(controller.isFeasible(path));
+  EXPECT_EQ(controller.numCommitments(), 1);
+}
+
+TEST(AdmissionControllerTest, UnknownRatesAndMemory) {
+  AdmissionController controller(10, 1, 3);
+  // no link has been estimated yet
+  AdmissionController::Path unknown{{{1, 2, 0}, {2, 3, 0}}, -1};
+  EXPECT_TRUE(std::isinf(controller.achievableRate(unknown)));
+  EXPECT_TRUE(controller.isFeasible(unknown));
+
+  AdmissionController::Path small_qnic{{{1, 2, 100}}, 2};
+  EXPECT_FALSE(controller.isFeasible(small_qnic));
+  small_qnic.min_qubits = 3;
+  EXPECT_TRUE(controller.isFeasible(small_qnic));
+}
+
+}  // namespace
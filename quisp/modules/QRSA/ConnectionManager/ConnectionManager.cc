@@ -3,10 +3,15 @@
  *  \brief ConnectionManager
  */
 
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
 #include <string>
 
 #include "ConnectionManager.h"
 #include "RuleSetGenerator.h"
+#include "modules/Common/Router.h"
+#include "modules/SharedResource/ConnectionMetrics.h"
 
 using namespace omnetpp;
 using namespace quisp::messages;
@@ -19,9 +24,6 @@ Define_Module(ConnectionManager);
 ConnectionManager::ConnectionManager() : provider(utils::ComponentProvider{this}) {}
 
 ConnectionManager::~ConnectionManager() {
-  for (auto *msg : request_send_timing) {
-    cancelAndDelete(msg);
-  }
   for (auto &[qnic_num, q] : connection_setup_buffer) {
     while (!q.empty()) {
       auto req = q.front();
@@ -29,13 +31,26 @@ ConnectionManager::~ConnectionManager() {
       delete req;
     }
   }
+  cancelAndDelete(admission_timer);
+  for (auto *req : admission_batch) {
+    delete req;
+  }
+  for (auto &[responder_addr, connection] : persistent_connections) {
+    while (!connection.waiting_requests.empty()) {
+      delete connection.waiting_requests.front();
+      connection.waiting_requests.pop();
+    }
+  }
+  if (persistent_connections_enabled || admission_controller != nullptr) provider.getQNode()->unsubscribe(connection_terminated_signal, this);
 }
 
 void ConnectionManager::initialize() {
+  event_profiler = provider.getEventProfiler();
   initializeLogger(provider);
   routing_daemon = provider.getRoutingDaemon();
   hardware_monitor = provider.getHardwareMonitor();
   my_address = provider.getNodeAddr();
+  connection_established_signal = registerSignal(SharedResource::CONNECTION_ESTABLISHED_SIGNAL);
   num_of_qnics = par("total_number_of_qnics");
   simultaneous_es_enabled = par("simultaneous_es_enabled");
   num_remote_purification = par("num_remote_purification");
@@ -45,6 +60,7 @@ void ConnectionManager::initialize() {
   std::string pur_type = par("purification_type_cm").str();
   pur_type = pur_type.substr(1, pur_type.size() - 2);
   threshold_fidelity = par("threshold_fidelity");
+  qnic_reservation_qubits = par("qnic_reservation_qubits");
 
   if (simultaneous_es_enabled && es_with_purify) {
     error("Currently, simultaneous entanglement swapping cannot be simulated with purification");
@@ -53,10 +69,65 @@ void ConnectionManager::initialize() {
   if (purification_type == PurType::INVALID) {
     error("Unknown purification type");
   }
+  link_purification.rounds = par("link_purification_rounds");
+  link_purification.type = purification_type;
+  link_purification.pumping_rounds = par("link_pumping_rounds");
+  if (link_purification.pumping_rounds < 1 || link_purification.pumping_rounds > Purification::max_pumping_rounds) {
+    error("link_pumping_rounds must be from 1 to %d", Purification::max_pumping_rounds);
+  }
+  if (link_purification.pumping_rounds > 1 && !Purification::canPump(purification_type)) error("link_pumping_rounds needs a single selection purification_type_cm");
+  if (par("adaptive_link_purification").boolValue()) {
+    if (threshold_fidelity <= 0) error("adaptive_link_purification needs threshold_fidelity");
+    link_purification.target_fidelity = threshold_fidelity;
+  }
+  pipelined_ruleset_distribution = par("pipelined_ruleset_distribution");
+  int ruleset_template_cache_size = par("ruleset_template_cache_size");
+  if (ruleset_template_cache_size > 0) {
+    ruleset_template_cache = std::make_unique<RuleSetTemplateCache>(ruleset_template_cache_size);
+  }
+  try {
+    swapping_tree = RuleSetGenerator::parseSwappingTree(par("swapping_tree").stdstringValue());
+  } catch (const std::invalid_argument &e) {
+    error("%s", e.what());
+  }
+  int ruleset_serialization_threads = par("ruleset_serialization_threads");
+  if (ruleset_serialization_threads > 1) {
+    ruleset_serialization_pool = std::make_unique<utils::ThreadPool>(ruleset_serialization_threads);
+  }
+
+  try {
+    retry_policy = RetryPolicy::create(par("retry_policy").stdstringValue(), par("retry_base_backoff"), par("retry_max_backoff"));
+  } catch (const std::invalid_argument &e) {
+    error("%s", e.what());
+  }
 
+  persistent_connections_enabled = par("persistent_connections");
+  double admission_pair_rate = par("admission_pair_rate");
+  if (admission_pair_rate > 0) {
+    admission_controller = std::make_unique<AdmissionController>(
+        admission_pair_rate, AdmissionController::rawPairsPerPair(link_purification.rounds, link_purification.pumping_rounds, num_remote_purification),
+        AdmissionController::qubitsPerQnic(link_purification.rounds, link_purification.pumping_rounds, num_remote_purification));
+  }
+  if (persistent_connections_enabled || admission_controller != nullptr) {
+    // the RuleEngine of this node emits it when the RuleSet finishes the demand
+    connection_terminated_signal = registerSignal(SharedResource::CONNECTION_TERMINATED_SIGNAL);
+    provider.getQNode()->subscribe(connection_terminated_signal, this);
+  }
+
+  connection_controller = provider.getConnectionController();
+  if (connection_controller != nullptr && (pipelined_ruleset_distribution || admission_controller != nullptr)) {
+    // the requests don't go through the nodes and the responder with the controller
+    error("centralized_connection_setup can't be used with pipelined_ruleset_distribution or admission_pair_rate");
+  }
+
+  admission_window = par("connection_admission_window");
+  if (admission_window > 0) {
+    admission_timer = new cMessage("connection admission");
+  }
+
+  request_send_timers = std::make_unique<utils::TimerService<int>>(this, "send timing", par("request_timer_resolution"));
+  request_send_timing.resize(num_of_qnics);
   for (int i = 0; i < num_of_qnics; i++) {
-    auto msgname = "send timing qnic address-" + std::to_string(i);
-    request_send_timing.push_back(new cMessage(msgname.c_str()));
     connection_retry_count[i] = 0;
   }
 }
@@ -66,18 +137,19 @@ void ConnectionManager::initialize() {
  * \param msg pointer to the cMessage itself
  */
 void ConnectionManager::handleMessage(cMessage *msg) {
+  modules::SharedResource::EventProfiler::Scope profile(event_profiler, this, msg);
   // this should only be the send notification
+  if (msg == admission_timer) {
+    admitBatchedRequests();
+    return;
+  }
   if (msg->isSelfMessage()) {
-    // check which qnic address the notification is for and initiate the connection
-    for (int i = 0; i < request_send_timing.size(); i++) {
-      if (request_send_timing[i] == msg) {
-        initiateApplicationRequest(i);
-        return;
-      }
-    }
-    error("receive a send self-notification but cannot find which qnic to use");
+    if (!request_send_timers->isTimer(msg)) error("receive a send self-notification but cannot find which qnic to use");
+    // the timers carry the qnic address the notification is for
+    request_send_timers->handle([&](int qnic_address) { initiateApplicationRequest(qnic_address); });
+    return;
   }
-  logger->logPacket("handleMessage", msg);
+  QUISP_LOG(logger, Packet, logPacket("handleMessage", msg));
 
   if (auto *req = dynamic_cast<ConnectionSetupRequest *>(msg)) {
     int actual_dst = req->getActual_destAddr();
@@ -89,7 +161,7 @@ void ConnectionManager::handleMessage(cMessage *msg) {
       delete msg;
     } else if (actual_src == my_address) {
       // initiator node
-      queueApplicationRequest(req);
+      handleApplicationRequest(req);
     } else {
       // intermediate node
       tryRelayRequestToNextHop(req);
@@ -101,6 +173,12 @@ void ConnectionManager::handleMessage(cMessage *msg) {
     int initiator_addr = resp->getActual_destAddr();
     int responder_addr = resp->getActual_srcAddr();
 
+    if (initiator_addr == my_address) {
+      num_accepted_requests++;
+      issued_request_qnics.erase({responder_addr, resp->getApplicationId()});
+      if (resp->getPersistent()) persistent_connections[responder_addr].ruleset_id = resp->getRuleSet_id();
+      emitConnectionEstablished(responder_addr, resp->getRequestId(), resp->getRuleSet_id());
+    }
     if (initiator_addr == my_address || responder_addr == my_address) {
       // this node is not a swapper
       storeRuleSetForApplication(resp);
@@ -113,6 +191,12 @@ void ConnectionManager::handleMessage(cMessage *msg) {
     return;
   }
 
+  if (auto *pk = dynamic_cast<ConnectionSetupReleaseNotification *>(msg)) {
+    retryOnRelease(pk);
+    delete msg;
+    return;
+  }
+
   if (auto *pk = dynamic_cast<RejectConnectionSetupRequest *>(msg)) {
     int actual_src = pk->getActual_srcAddr();
 
@@ -126,6 +210,34 @@ void ConnectionManager::handleMessage(cMessage *msg) {
   }
 }
 
+void ConnectionManager::finish() {
+  recordScalar("connection_setup_requests_queued", num_queued_requests);
+  recordScalar("connection_setup_attempts", num_setup_attempts);
+  recordScalar("connection_setups_accepted", num_accepted_requests);
+  recordScalar("connection_setup_rejections", num_rejected_attempts);
+  recordScalar("connection_setup_acceptance_ratio", num_setup_attempts > 0 ? (double)num_accepted_requests / num_setup_attempts : 0);
+  recordScalar("connection_setup_mean_queueing_delay", num_issued_requests > 0 ? total_queueing_delay / num_issued_requests : SIMTIME_ZERO, "s");
+  recordScalar("connection_setup_max_queueing_delay", max_queueing_delay, "s");
+  if (retry_policy != nullptr && retry_policy->waitsForRelease()) {
+    recordScalar("connection_setup_retries_on_release", num_release_triggered_retries);
+  }
+  if (persistent_connections_enabled) {
+    recordScalar("connection_setups_rearmed", num_rearmed_requests);
+  }
+  if (ruleset_template_cache != nullptr) {
+    recordScalar("ruleset_template_cache_hits", ruleset_template_cache->hits());
+    recordScalar("ruleset_template_cache_misses", ruleset_template_cache->misses());
+    recordScalar("ruleset_template_cache_hit_rate", ruleset_template_cache->hitRate());
+  }
+  if (admission_timer != nullptr) {
+    recordScalar("connection_admission_batches", num_admission_batches);
+    recordScalar("connection_requests_admitted_in_batch", num_batch_admitted_requests);
+  }
+  if (admission_controller != nullptr) {
+    recordScalar("connection_setups_rejected_as_infeasible", num_infeasible_rejections);
+  }
+}
+
 PurType ConnectionManager::parsePurType(const std::string &pur_type) {
   if (pur_type == "SINGLE_SELECTION_X_PURIFICATION") {
     return PurType::SINGLE_SELECTION_X_PURIFICATION;
@@ -177,7 +289,8 @@ void ConnectionManager::storeRuleSet(ConnectionSetupResponse *pk) {
   pk_internal->setKind(4);
   pk_internal->setRuleSet_id(pk->getRuleSet_id());
   pk_internal->setRuleSet(pk->getRuleSet());
-  send(pk_internal, "RouterPort$o");
+  pk_internal->setRuntimeRuleSet(pk->getRuntimeRuleSet());
+  sendToRouter(this, pk_internal);
 }
 
 /**
@@ -194,7 +307,42 @@ void ConnectionManager::storeRuleSetForApplication(ConnectionSetupResponse *pk)
   pk_internal->setRuleSet_id(pk->getRuleSet_id());
   pk_internal->setRuleSet(pk->getRuleSet());
   pk_internal->setApplication_type(pk->getApplication_type());
-  send(pk_internal, "RouterPort$o");
+  pk_internal->setPersistent(pk->getPersistent());
+  pk_internal->setRuntimeRuleSet(pk->getRuntimeRuleSet());
+  sendToRouter(this, pk_internal);
+}
+
+/**
+ * Installs the link-level RuleSet of this node for the pipelined request, before the responder sends the rest of it.
+ * The RuleSet has the id of the whole connection, so the RuleEngine appends the rest to it when the response arrives.
+ * \param node_index the index of this node in the path from the initiator
+ * \param left_addr the previous node on the path, -1 for the initiator
+ * \param right_addr the next node on the path, -1 for the responder
+ */
+void ConnectionManager::installLinkRuleSet(ConnectionSetupRequest *req, int node_index, int left_addr, int right_addr) {
+  RuleSetGenerator ruleset_gen{req->getActual_destAddr(), swapping_tree, nullptr, link_purification};
+  auto ruleset = ruleset_gen.buildLinkRuleSet(req->getRuleSet_id(), my_address, node_index, left_addr, right_addr);
+  if (ruleset.rules.empty()) return;
+  ruleset.qos_priority = req->getQos_priority();
+  ruleset.qos_min_share = req->getQos_min_share();
+  auto *pk = new InternalRuleSetForwarding("InternalRuleSetForwarding");
+  pk->setDestAddr(my_address);
+  pk->setSrcAddr(my_address);
+  pk->setKind(4);
+  pk->setRuleSet_id(ruleset.ruleset_id);
+  pk->setRuntimeRuleSet(std::make_shared<const quisp::runtime::RuleSet>(ruleset.construct()));
+  pk->setRuleSet(ruleset.serialize_json());
+  sendToRouter(this, pk);
+}
+
+// the rejected pipelined request leaves the link-level RuleSets on the nodes it went through
+void ConnectionManager::terminateLinkRuleSet(RejectConnectionSetupRequest *pk) {
+  if (pk->getRuleSet_id() == 0) return;
+  auto *termination = new InternalRuleSetTermination("InternalRuleSetTermination");
+  termination->setDestAddr(my_address);
+  termination->setSrcAddr(my_address);
+  termination->setRuleSet_id(pk->getRuleSet_id());
+  sendToRouter(this, termination);
 }
 
 void ConnectionManager::rejectRequest(ConnectionSetupRequest *req) {
@@ -210,6 +358,7 @@ void ConnectionManager::rejectRequest(ConnectionSetupRequest *req) {
     packet->setSrcAddr(my_address);
     packet->setActual_destAddr(req->getActual_destAddr());
     packet->setActual_srcAddr(req->getActual_srcAddr());
+    if (req->getPipelined()) packet->setRuleSet_id(req->getRuleSet_id());
     send(packet, "RouterPort$o");
   }
 }
@@ -224,13 +373,14 @@ void ConnectionManager::rejectRequest(ConnectionSetupRequest *req) {
  * The procedure:
  * @verbatim
  * 1. check the qnic is busy or not
- * 2. generate all the RuleSets by calling RuleSetGenerator
- * 3. reserve the qnic for the connection
- * 4. return ConnectionSetupResponse to each node in this connection.
+ * 2. with the admission control, check the path can give the connection its pair rate on top of the connections admitted before
+ * 3. generate all the RuleSets by calling RuleSetGenerator
+ * 4. reserve the qnic for the connection
+ * 5. return ConnectionSetupResponse to each node in this connection.
  * @endverbatim
+ * For the pipelined request, the nodes already have their link-level rules, so the responses only carry the rest.
  */
 void ConnectionManager::respondToRequest(ConnectionSetupRequest *req) {
-  int application_id = req->getApplicationId();
   int prev_hop_addr = req->getSrcAddr();
 
   // qnic toward to the previous node
@@ -241,29 +391,119 @@ void ConnectionManager::respondToRequest(ConnectionSetupRequest *req) {
 
   // check if the qnics are reserved or not
   if (isQnicBusy(qnic_addr)) {
+    addReleaseWaiter(qnic_addr, req);
     rejectRequest(req);
     return;
   }
 
-  ruleset_gen::RuleSetGenerator ruleset_gen{my_address};
-  auto rulesets = ruleset_gen.generateRuleSets(req, createUniqueId());
+  AdmissionController::Path admission_path;
+  if (admission_controller != nullptr) {
+    admission_path = admissionPathOf(req, qnic_addr);
+    if (!admission_controller->isFeasible(admission_path)) {
+      num_infeasible_rejections++;
+      rejectRequest(req);
+      return;
+    }
+  }
+
+  bool pipelined = req->getPipelined();
+  unsigned long ruleset_id = pipelined ? req->getRuleSet_id() : createUniqueId();
+  if (admission_controller != nullptr) admission_controller->commit(ruleset_id, admission_path);
+  if (pipelined) installLinkRuleSet(req, req->getStack_of_QNodeIndexesArraySize(), prev_hop_addr, -1);
+  auto rulesets = generateRuleSets(req, ruleset_id);
 
-  // distribute rulesets to each qnode in the path
-  for (auto [owner_address, rs] : rulesets) {
-    ConnectionSetupResponse *pkt = new ConnectionSetupResponse("ConnectionSetupResponse");
-    pkt->setApplicationId(application_id);
-    pkt->setRuleSet(rs);
-    pkt->setSrcAddr(my_address);
-    pkt->setDestAddr(owner_address);
-    pkt->setActual_srcAddr(my_address);
-    pkt->setActual_destAddr(owner_address);
-    pkt->setApplication_type(0);
-    pkt->setKind(2);
-    send(pkt, "RouterPort$o");
+  // distribute rulesets to each qnode in the path.
+  for (auto &[owner_address, rs] : rulesets) {
+    send(createSetupResponse(req, ruleset_id, owner_address, rs), "RouterPort$o");
   }
   reserveQnic(qnic_addr);
 }
 
+/**
+ * The response with the RuleSet of the node, from the responder of the request.
+ * The json is kept for logging, the nodes use the compiled RuleSet instead of parsing it.
+ */
+ConnectionSetupResponse *ConnectionManager::createSetupResponse(ConnectionSetupRequest *req, unsigned long ruleset_id, int owner_address, RuleSetTemplateCache::NodeRuleSet &rs) {
+  int responder_addr = req->getActual_destAddr();
+  ConnectionSetupResponse *pkt = new ConnectionSetupResponse("ConnectionSetupResponse");
+  pkt->setApplicationId(req->getApplicationId());
+  pkt->setRequestId(req->getRequestId());
+  pkt->setRuleSet_id(ruleset_id);
+  pkt->setRuleSet(std::move(rs.serialized));
+  pkt->setRuntimeRuleSet(std::move(rs.compiled));
+  pkt->setSrcAddr(responder_addr);
+  pkt->setDestAddr(owner_address);
+  pkt->setActual_srcAddr(responder_addr);
+  pkt->setActual_destAddr(owner_address);
+  pkt->setApplication_type(0);
+  pkt->setPersistent(req->getPersistent());
+  pkt->setKind(2);
+  return pkt;
+}
+
+/**
+ * Generates the RuleSets of the nodes on the path of the request, or instantiates them from the template cache.
+ * The swapping tree and the link purification are the same for all the requests to this node, so the key
+ * only has the path and the parameters of the request. The path ends at the responder of the request,
+ * which is this node unless the connection is set up with the ConnectionController.
+ */
+RuleSetTemplateCache::RuleSets ConnectionManager::generateRuleSets(ConnectionSetupRequest *req, unsigned long ruleset_id) {
+  int responder_addr = req->getActual_destAddr();
+  bool include_link_rules = !req->getPipelined();
+  RuleSetGenerator ruleset_gen{responder_addr, swapping_tree, ruleset_serialization_pool.get(), link_purification};
+  RuleSetTemplateCache::Key key;
+  if (ruleset_template_cache != nullptr) {
+    std::vector<int> path;
+    for (int i = 0; i < req->getStack_of_QNodeIndexesArraySize(); i++) path.push_back(req->getStack_of_QNodeIndexes(i));
+    path.push_back(responder_addr);
+    key = {std::move(path), include_link_rules ? ruleset_gen.linkPurificationRounds(req) : std::vector<int>{}, req->getNum_measure(), include_link_rules};
+    if (auto cached = ruleset_template_cache->instantiate(key, ruleset_id)) {
+      applyQosClass(req, *cached);
+      return std::move(*cached);
+    }
+  }
+
+  auto rulesets = ruleset_gen.buildRuleSets(req, ruleset_id, include_link_rules);
+  auto serialized_rulesets = ruleset_gen.serializeRuleSets(rulesets);
+  RuleSetTemplateCache::RuleSets generated;
+  for (auto &[owner_address, rs] : rulesets) {
+    generated[owner_address] = {std::move(serialized_rulesets.at(owner_address)), std::make_shared<const quisp::runtime::RuleSet>(rs.construct())};
+  }
+  if (ruleset_template_cache != nullptr) ruleset_template_cache->insert(key, generated);
+  applyQosClass(req, generated);
+  return generated;
+}
+
+// the QoS class doesn't change the rules, so the templates are cached without it and the RuleSets of the request get it here
+void ConnectionManager::applyQosClass(ConnectionSetupRequest *req, RuleSetTemplateCache::RuleSets &rulesets) {
+  if (req->getQos_priority() == 0 && req->getQos_min_share() == 0) return;
+  for (auto &[owner_address, rs] : rulesets) {
+    auto compiled = std::make_shared<quisp::runtime::RuleSet>(*rs.compiled);
+    compiled->qos_priority = req->getQos_priority();
+    compiled->qos_min_share = req->getQos_min_share();
+    rs.compiled = std::move(compiled);
+    rs.serialized["qos_priority"] = req->getQos_priority();
+    rs.serialized["qos_min_share"] = req->getQos_min_share();
+  }
+}
+
+/**
+ * The qnics towards the destination by the routing daemon, with threshold_fidelity the one of the cheapest path meeting it first.
+ * Each node takes the whole path from itself, so the nodes after the initiator check the rest of the path against the same target.
+ */
+std::vector<int> ConnectionManager::findOutboundQnics(int dest_addr) {
+  auto qnic_addresses = routing_daemon->findQNicAddrsByDestAddr(dest_addr);
+  if (threshold_fidelity <= 0 || qnic_addresses.empty()) return qnic_addresses;
+  const int qnic_address = routing_daemon->findQNicAddrForFidelity(dest_addr, threshold_fidelity);
+  auto it = std::find(qnic_addresses.begin(), qnic_addresses.end(), qnic_address);
+  if (it == qnic_addresses.end()) {
+    qnic_addresses.insert(qnic_addresses.begin(), qnic_address);
+  } else {
+    std::rotate(qnic_addresses.begin(), it, it + 1);
+  }
+  return qnic_addresses;
+}
+
 /**
  *  This method is called to handle the ConnectionSetupRequest at an intermediate.
  *  This method reserves requested qnics and then send the request to next hop.
@@ -275,24 +515,40 @@ void ConnectionManager::tryRelayRequestToNextHop(ConnectionSetupRequest *req) {
   int application_id = req->getApplicationId();
   int responder_addr = req->getActual_destAddr();
   int prev_hop_addr = req->getSrcAddr();
-  int outbound_qnic_address = routing_daemon->findQNicAddrByDestAddr(responder_addr);
+  auto outbound_qnic_addresses = findOutboundQnics(responder_addr);
   int inbound_qnic_address = routing_daemon->findQNicAddrByDestAddr(prev_hop_addr);
 
-  if (outbound_qnic_address == -1) {
+  if (outbound_qnic_addresses.empty()) {
     error("QNIC to destination not found");
   }
   if (inbound_qnic_address == -1) {
     error("QNIC from source not found");
   }
 
-  // Use the QNIC address to find the next hop QNode, by asking the Hardware Monitor (neighbor table).
-  auto outbound_info = hardware_monitor->findConnectionInfoByQnicAddr(outbound_qnic_address);
-  auto inbound_info = hardware_monitor->findConnectionInfoByQnicAddr(inbound_qnic_address);
+  if (isQnicBusy(inbound_qnic_address)) {
+    addReleaseWaiter(inbound_qnic_address, req);
+    rejectRequest(req);
+    return;
+  }
 
-  if (isQnicBusy(outbound_qnic_address) || isQnicBusy(inbound_qnic_address)) {
+  // Take the best next hop whose qnic is free, skipping the nodes the request already went through not to make a loop.
+  // Use the QNIC address to find the next hop QNode, by asking the Hardware Monitor (neighbor table).
+  const ConnectionSetupInfo *outbound_info = nullptr;
+  for (int qnic_address : outbound_qnic_addresses) {
+    if (qnic_address == inbound_qnic_address || isQnicBusy(qnic_address)) continue;
+    auto info = hardware_monitor->findConnectionInfoByQnicAddr(qnic_address);
+    if (hasVisited(req, info->neighbor_address)) continue;
+    outbound_info = info;
+    break;
+  }
+  if (outbound_info == nullptr) {
+    for (int qnic_address : outbound_qnic_addresses) {
+      if (qnic_address != inbound_qnic_address && isQnicBusy(qnic_address)) addReleaseWaiter(qnic_address, req);
+    }
     rejectRequest(req);
     return;
   }
+  auto inbound_info = hardware_monitor->findConnectionInfoByQnicAddr(inbound_qnic_address);
 
   // Update information and send it to the next Qnode.
   int num_accumulated_nodes = req->getStack_of_QNodeIndexesArraySize();
@@ -313,46 +569,176 @@ void ConnectionManager::tryRelayRequestToNextHop(ConnectionSetupRequest *req) {
 
   reserveQnic(inbound_info->qnic.address);
   reserveQnic(outbound_info->qnic.address);
+  relayed_outbound_qnics[{req->getActual_srcAddr(), responder_addr, application_id}] = outbound_info->qnic.address;
+  if (req->getPipelined()) installLinkRuleSet(req, num_accumulated_nodes, prev_hop_addr, outbound_info->neighbor_address);
+  if (admission_controller != nullptr) appendAdmissionInfo(req, inbound_info->qnic.address, outbound_info->qnic.address);
+  if (link_purification.target_fidelity > 0) appendLinkFidelity(req, outbound_info->qnic.address);
 
   send(req, "RouterPort$o");
 }
 
+/**
+ * Adds the pair rate of the outbound link and the qubits this node gives the connection to the request, for the admission control
+ * of the responder. The qubits are of the smaller of the qnics, inbound_qnic_address is -1 at the initiator.
+ */
+void ConnectionManager::appendAdmissionInfo(ConnectionSetupRequest *req, int inbound_qnic_address, int outbound_qnic_address) {
+  int qubits = connectionQubitsOf(outbound_qnic_address);
+  if (inbound_qnic_address != -1) qubits = std::min(qubits, connectionQubitsOf(inbound_qnic_address));
+  int num_rates = req->getStack_of_linkPairRatesArraySize();
+  req->setStack_of_linkPairRatesArraySize(num_rates + 1);
+  req->setStack_of_linkPairRates(num_rates, hardware_monitor->getLinkPairRate(outbound_qnic_address));
+  int num_qubits = req->getStack_of_QNodeQubitsArraySize();
+  req->setStack_of_QNodeQubitsArraySize(num_qubits + 1);
+  req->setStack_of_QNodeQubits(num_qubits, qubits);
+}
+
+// the fidelity of the outbound link for the link purification rounds of the responder
+void ConnectionManager::appendLinkFidelity(ConnectionSetupRequest *req, int outbound_qnic_address) {
+  int num_fidelities = req->getStack_of_linkFidelitiesArraySize();
+  req->setStack_of_linkFidelitiesArraySize(num_fidelities + 1);
+  req->setStack_of_linkFidelities(num_fidelities, hardware_monitor->getLinkFidelity(outbound_qnic_address));
+}
+
+// the qubits of the qnic, or the ones a connection reserves in it if the connections share it
+int ConnectionManager::connectionQubitsOf(int qnic_address) {
+  auto info = hardware_monitor->findConnectionInfoByQnicAddr(qnic_address);
+  if (info == nullptr) {
+    error("qnic(addr: %d) not found", qnic_address);
+  }
+  int num_qubits = hardware_monitor->getQnicNumQubits(info->qnic.index, info->qnic.type);
+  return qnic_reservation_qubits > 0 ? std::min(qnic_reservation_qubits, num_qubits) : num_qubits;
+}
+
+/**
+ * The links of the request's path with the pair rates the nodes added, and the fewest qubits a node gives the connection.
+ * The links of the nodes without the admission control have no rate.
+ */
+AdmissionController::Path ConnectionManager::admissionPathOf(ConnectionSetupRequest *req, int inbound_qnic_address) {
+  AdmissionController::Path path;
+  path.min_qubits = connectionQubitsOf(inbound_qnic_address);
+  for (int i = 0; i < req->getStack_of_QNodeQubitsArraySize(); i++) {
+    path.min_qubits = std::min(path.min_qubits, req->getStack_of_QNodeQubits(i));
+  }
+  int num_nodes = req->getStack_of_QNodeIndexesArraySize();
+  for (int i = 0; i < num_nodes; i++) {
+    int next_node = i + 1 < num_nodes ? req->getStack_of_QNodeIndexes(i + 1) : my_address;
+    double pair_rate = i < req->getStack_of_linkPairRatesArraySize() ? req->getStack_of_linkPairRates(i) : 0;
+    path.links.push_back({req->getStack_of_QNodeIndexes(i), next_node, pair_rate});
+  }
+  return path;
+}
+
+bool ConnectionManager::hasVisited(ConnectionSetupRequest *req, int node_address) {
+  if (node_address == req->getActual_srcAddr()) return true;
+  for (int i = 0; i < req->getStack_of_QNodeIndexesArraySize(); i++) {
+    if (req->getStack_of_QNodeIndexes(i) == node_address) return true;
+  }
+  return false;
+}
+
+/**
+ * Returns the units a connection reserves in the qnic, and sets the capacity of the qnic the first time.
+ * If qnic_reservation_qubits is 0, a connection locks the whole qnic, i.e. the qnic has one unit.
+ * Otherwise the connections share the qubits of the qnic, qnic_reservation_qubits each.
+ */
+int ConnectionManager::reservationUnitsOf(int qnic_address) {
+  if (qnic_reservation_qubits <= 0) {
+    if (!qnic_reservations.hasCapacity(qnic_address)) qnic_reservations.setCapacity(qnic_address, 1);
+    return 1;
+  }
+  if (!qnic_reservations.hasCapacity(qnic_address)) {
+    auto info = hardware_monitor->findConnectionInfoByQnicAddr(qnic_address);
+    if (info == nullptr) {
+      error("qnic(addr: %d) not found", qnic_address);
+    }
+    qnic_reservations.setCapacity(qnic_address, hardware_monitor->getQnicNumQubits(info->qnic.index, info->qnic.type));
+  }
+  // a qnic smaller than the reservation is taken by one connection at a time
+  return std::max(1, std::min(qnic_reservation_qubits, qnic_reservations.capacity(qnic_address)));
+}
+
 // This is not good way. This property should be held in qnic property.
 void ConnectionManager::reserveQnic(int qnic_address) {
-  auto it = std::find(reserved_qnics.begin(), reserved_qnics.end(), qnic_address);
-  // if qnic is already registered,
-  if (it != reserved_qnics.end()) {
+  int units = reservationUnitsOf(qnic_address);
+  if (!qnic_reservations.canReserve(qnic_address, units)) {
     error("qnic(addr: %d) already reserved", qnic_address);
   }
-  // else register qnic as reserved qnic
-  reserved_qnics.push_back(qnic_address);
+  qnic_reservations.reserve(qnic_address, units);
 }
 
 void ConnectionManager::releaseQnic(int qnic_address) {
-  auto it = std::find(reserved_qnics.begin(), reserved_qnics.end(), qnic_address);
+  int units = reservationUnitsOf(qnic_address);
   // if qnic is not reserved
-  if (it == reserved_qnics.end()) {
+  if (qnic_reservations.reserved(qnic_address) < units) {
     error("qnic(addr: %d)  not reserved", qnic_address);
   }
-  // else if the qnic is propery reserved, erase it from vector
-  reserved_qnics.erase(it);
+  qnic_reservations.release(qnic_address, units);
+  notifyReleaseWaiters(qnic_address);
+}
+
+/**
+ * Remembers the initiator of the request rejected because of the busy qnic,
+ * so that it can retry when the qnic is released instead of guessing the backoff.
+ */
+void ConnectionManager::addReleaseWaiter(int qnic_address, ConnectionSetupRequest *req) {
+  if (retry_policy == nullptr || !retry_policy->waitsForRelease()) return;
+  release_waiters[qnic_address].insert({req->getActual_srcAddr(), req->getActual_destAddr()});
+}
+
+void ConnectionManager::notifyReleaseWaiters(int qnic_address) {
+  auto it = release_waiters.find(qnic_address);
+  if (it == release_waiters.end()) return;
+  for (auto [initiator_addr, responder_addr] : it->second) {
+    auto *pkt = new ConnectionSetupReleaseNotification("ConnectionSetupReleaseNotification");
+    pkt->setSrcAddr(my_address);
+    pkt->setDestAddr(initiator_addr);
+    pkt->setActual_srcAddr(initiator_addr);
+    pkt->setActual_destAddr(responder_addr);
+    pkt->setKind(6);
+    send(pkt, "RouterPort$o");
+  }
+  release_waiters.erase(it);
+}
+
+/**
+ * Brings forward the backoff of the requests to the responder, a qnic on the path has been released.
+ */
+void ConnectionManager::retryOnRelease(ConnectionSetupReleaseNotification *pk) {
+  auto it = release_waiting_qnics.find(pk->getActual_destAddr());
+  if (it == release_waiting_qnics.end()) return;
+  for (int qnic_address : it->second) {
+    if (!request_send_timers->isScheduled(request_send_timing[qnic_address]) || connection_setup_buffer[qnic_address].empty()) continue;
+    num_release_triggered_retries++;
+    scheduleRequestSend(qnic_address, simTime());
+  }
+  release_waiting_qnics.erase(it);
 }
 
 bool ConnectionManager::isQnicBusy(int qnic_address) {
-  auto it = std::find(reserved_qnics.begin(), reserved_qnics.end(), qnic_address);
-  // if the qnic is not registered, it's not busy
-  if (it == reserved_qnics.end()) {
+  // if the qnic has never been reserved, it's not busy
+  if (!qnic_reservations.isReserved(qnic_address)) {
     return false;
   }
-  return true;
+  return !qnic_reservations.canReserve(qnic_address, reservationUnitsOf(qnic_address));
 }
 
 void ConnectionManager::initiator_reject_req_handler(RejectConnectionSetupRequest *pk) {
   int actual_dest = pk->getActual_destAddr();
   int outbound_qnic_address = routing_daemon->findQNicAddrByDestAddr(actual_dest);
+  // the request may have been admitted to an alternative qnic
+  auto issued = issued_request_qnics.find({actual_dest, pk->getApplicationId()});
+  if (issued != issued_request_qnics.end()) {
+    outbound_qnic_address = issued->second;
+    issued_request_qnics.erase(issued);
+  }
+  num_rejected_attempts++;
 
   releaseQnic(outbound_qnic_address);
+  terminateLinkRuleSet(pk);
   scheduleRequestRetry(outbound_qnic_address);
+  if (retry_policy != nullptr && retry_policy->waitsForRelease()) {
+    release_waiting_qnics[actual_dest].insert(outbound_qnic_address);
+  }
 }
 
 /**
@@ -379,9 +765,16 @@ void ConnectionManager::intermediate_reject_req_handler(RejectConnectionSetupReq
   // Currently, sending path and returning path are same, but for future, this might not good way
   int outbound_qnic_address = routing_daemon->findQNicAddrByDestAddr(actual_dst);
   int inbound_qnic_address = routing_daemon->findQNicAddrByDestAddr(actual_src);
+  // the request may have been relayed to an alternative next hop
+  auto relayed = relayed_outbound_qnics.find({actual_src, actual_dst, pk->getApplicationId()});
+  if (relayed != relayed_outbound_qnics.end()) {
+    outbound_qnic_address = relayed->second;
+    relayed_outbound_qnics.erase(relayed);
+  }
 
   releaseQnic(outbound_qnic_address);
   releaseQnic(inbound_qnic_address);
+  terminateLinkRuleSet(pk);
 }
 
 unsigned long ConnectionManager::createUniqueId() {
@@ -395,16 +788,188 @@ unsigned long ConnectionManager::createUniqueId() {
   return ruleset_id;
 }
 
+void ConnectionManager::emitConnectionEstablished(int responder_addr, int request_id, unsigned long ruleset_id) {
+  if (!mayHaveListeners(connection_established_signal)) return;
+  SharedResource::ConnectionMetricEvent event;
+  event.initiator_addr = my_address;
+  event.responder_addr = responder_addr;
+  event.request_id = request_id;
+  event.ruleset_id = ruleset_id;
+  event.node_addr = my_address;
+  emit(connection_established_signal, &event);
+}
+
+/**
+ * With persistent_connections, the first request to a responder sets up the persistent connection,
+ * and the later ones re-arm it once its RuleSet is parked, without the routing and the RuleSet generation.
+ * The requests arriving while the connection serves another demand wait for it in order.
+ */
+void ConnectionManager::handleApplicationRequest(ConnectionSetupRequest *req) {
+  if (!persistent_connections_enabled) {
+    queueApplicationRequest(req);
+    return;
+  }
+  auto [it, inserted] = persistent_connections.try_emplace(req->getActual_destAddr());
+  if (inserted) {
+    req->setPersistent(true);
+    queueApplicationRequest(req);
+    return;
+  }
+  auto &connection = it->second;
+  if (!connection.parked) {
+    connection.waiting_requests.push(req);
+    return;
+  }
+  rearmPersistentConnection(connection, req);
+}
+
+// the responder may not have finished the last demand yet, then its RuleSet just takes the new one on top of it
+void ConnectionManager::rearmPersistentConnection(PersistentConnection &connection, ConnectionSetupRequest *req) {
+  int responder_addr = req->getActual_destAddr();
+  connection.parked = false;
+  num_rearmed_requests++;
+  for (int owner_addr : {my_address, responder_addr}) {
+    auto *pkt = new ConnectionRearm("ConnectionRearm");
+    pkt->setSrcAddr(my_address);
+    pkt->setDestAddr(owner_addr);
+    pkt->setRuleSet_id(connection.ruleset_id);
+    pkt->setNum_measure(req->getNum_measure());
+    pkt->setKind(2);
+    send(pkt, "RouterPort$o");
+  }
+  emitConnectionEstablished(responder_addr, req->getRequestId(), connection.ruleset_id);
+  delete req;
+}
+
+void ConnectionManager::receiveSignal(cComponent *source, simsignal_t signal, cObject *obj, cObject *details) {
+  auto *event = dynamic_cast<SharedResource::ConnectionMetricEvent *>(obj);
+  if (signal != connection_terminated_signal || event == nullptr || event->node_addr != my_address) return;
+  // a parked RuleSet keeps its commitment, its connection is re-armed without the admission
+  if (admission_controller != nullptr && !event->parked) admission_controller->release(event->ruleset_id);
+  auto it = std::find_if(persistent_connections.begin(), persistent_connections.end(), [&](auto &entry) { return entry.second.ruleset_id == event->ruleset_id; });
+  if (it == persistent_connections.end()) return;
+  // the RuleEngine emits the signal in its own event
+  Enter_Method_Silent();
+  auto &connection = it->second;
+  if (event->parked) {
+    connection.parked = true;
+    if (connection.waiting_requests.empty()) return;
+    auto *req = connection.waiting_requests.front();
+    connection.waiting_requests.pop();
+    rearmPersistentConnection(connection, req);
+    return;
+  }
+  // the RuleSet is gone, e.g. by a link down, so the waiting requests set up a new connection
+  auto waiting_requests = std::move(connection.waiting_requests);
+  persistent_connections.erase(it);
+  while (!waiting_requests.empty()) {
+    handleApplicationRequest(waiting_requests.front());
+    waiting_requests.pop();
+  }
+}
+
 void ConnectionManager::queueApplicationRequest(ConnectionSetupRequest *req) {
+  num_queued_requests++;
+  request_queued_times[req] = simTime();
+
+  if (admission_timer != nullptr) {
+    admission_batch.push_back(req);
+    if (!admission_timer->isScheduled()) {
+      scheduleAt(simTime() + admission_window, admission_timer);
+    }
+    return;
+  }
+
   int responder_address = req->getActual_destAddr();
-  int outbound_qnic_address = routing_daemon->findQNicAddrByDestAddr(responder_address);
+  int outbound_qnic_address =
+      threshold_fidelity > 0 ? routing_daemon->findQNicAddrForFidelity(responder_address, threshold_fidelity) : routing_daemon->findQNicAddrByDestAddr(responder_address);
 
   if (outbound_qnic_address == -1) {
     error("QNIC to destination cannot be found");
   }
+  enqueueRequestToQnic(req, outbound_qnic_address);
+}
 
+/**
+ * Admits the requests collected over the admission window together.
+ * The requests are assigned to distinct free qnics toward their responders, so that the requests
+ * whose paths diverge at this node are issued at the same time instead of waiting for each other.
+ * The rest of the requests wait in the queue of the primary qnic.
+ */
+void ConnectionManager::admitBatchedRequests() {
+  auto batch = std::move(admission_batch);
+  admission_batch.clear();
+  num_admission_batches++;
+
+  std::vector<std::vector<int>> candidate_qnics;
+  std::vector<int> primary_qnics;
+  for (auto *req : batch) {
+    auto qnic_addresses = findOutboundQnics(req->getActual_destAddr());
+    if (qnic_addresses.empty()) {
+      error("QNIC to destination cannot be found");
+    }
+    primary_qnics.push_back(qnic_addresses.front());
+    // a qnic can take the request right away only if nothing is waiting for it
+    std::vector<int> free_qnics;
+    for (int qnic_address : qnic_addresses) {
+      if (!isQnicBusy(qnic_address) && connection_setup_buffer[qnic_address].empty()) {
+        free_qnics.push_back(qnic_address);
+      }
+    }
+    candidate_qnics.push_back(std::move(free_qnics));
+  }
+
+  auto assigned_qnics = assignQnics(candidate_qnics);
+  for (int i = 0; i < batch.size(); i++) {
+    if (assigned_qnics[i] != -1) {
+      num_batch_admitted_requests++;
+      enqueueRequestToQnic(batch[i], assigned_qnics[i]);
+    } else {
+      enqueueRequestToQnic(batch[i], primary_qnics[i]);
+    }
+  }
+}
+
+/**
+ * Assigns a distinct qnic to as many requests as possible (maximum bipartite matching by augmenting paths).
+ * The earlier requests and the qnics listed first are preferred.
+ * \param candidate_qnics the qnic addresses each request can use
+ * \returns the assigned qnic address of each request, or -1
+ */
+std::vector<int> ConnectionManager::assignQnics(const std::vector<std::vector<int>> &candidate_qnics) {
+  std::vector<int> assigned(candidate_qnics.size(), -1);
+  std::map<int, int> owner_of_qnic;  // qnic address -> request index
+  std::vector<bool> visited;
+
+  std::function<bool(int)> augment = [&](int request) {
+    for (int qnic_address : candidate_qnics[request]) {
+      auto it = owner_of_qnic.find(qnic_address);
+      if (it == owner_of_qnic.end()) {
+        owner_of_qnic[qnic_address] = request;
+        assigned[request] = qnic_address;
+        return true;
+      }
+      if (visited[it->second]) continue;
+      visited[it->second] = true;
+      if (augment(it->second)) {
+        it->second = request;
+        assigned[request] = qnic_address;
+        return true;
+      }
+    }
+    return false;
+  };
+  for (int i = 0; i < candidate_qnics.size(); i++) {
+    visited.assign(candidate_qnics.size(), false);
+    visited[i] = true;
+    augment(i);
+  }
+  return assigned;
+}
+
+void ConnectionManager::enqueueRequestToQnic(ConnectionSetupRequest *req, int outbound_qnic_address) {
   // Use the QNIC address to find the next hop QNode, by asking the Hardware Monitor (neighbor table).
-  auto inbound_info = std::make_unique<ConnectionSetupInfo>(NULL_CONNECTION_SETUP_INFO);
+  const ConnectionSetupInfo *inbound_info = &NULL_CONNECTION_SETUP_INFO;
   auto outbound_info = hardware_monitor->findConnectionInfoByQnicAddr(outbound_qnic_address);
 
   // Update information and send it to the next Qnode.
@@ -422,6 +987,8 @@ void ConnectionManager::queueApplicationRequest(ConnectionSetupRequest *req) {
 
   QNicPairInfo pair_info{inbound_info->qnic, outbound_info->qnic};
   req->setStack_of_QNICs(num_accumulated_pair_info, pair_info);
+  if (admission_controller != nullptr) appendAdmissionInfo(req, -1, outbound_qnic_address);
+  if (link_purification.target_fidelity > 0) appendLinkFidelity(req, outbound_qnic_address);
 
   auto &request_queue = connection_setup_buffer[outbound_qnic_address];
   request_queue.push(req);
@@ -429,7 +996,7 @@ void ConnectionManager::queueApplicationRequest(ConnectionSetupRequest *req) {
   // this is the only request in the queue, try to send it right away
   if (request_queue.size() == 1) {
     EV << "schedule from enqueue" << endl;
-    scheduleAt(simTime(), request_send_timing[outbound_qnic_address]);
+    scheduleRequestSend(outbound_qnic_address, simTime());
   }
 }
 
@@ -439,12 +1006,13 @@ void ConnectionManager::popApplicationRequest(int qnic_address) {
 
   connection_retry_count[qnic_address] = 0;
   request_queue.pop();
+  request_queued_times.erase(req);
   delete req;
   releaseQnic(qnic_address);
 
   if (!request_queue.empty()) {
     EV << "schedule from pop" << endl;
-    scheduleAt(simTime(), request_send_timing[qnic_address]);
+    scheduleRequestSend(qnic_address, simTime());
   }
 }
 
@@ -463,18 +1031,81 @@ void ConnectionManager::initiateApplicationRequest(int qnic_address) {
 
   reserveQnic(qnic_address);
   auto req = request_queue.front();
-  send(req->dup(), "RouterPort$o");
+  issued_request_qnics[{req->getActual_destAddr(), req->getApplicationId()}] = qnic_address;
+  num_setup_attempts++;
+  auto queued = request_queued_times.find(req);
+  if (queued != request_queued_times.end()) {
+    simtime_t queueing_delay = simTime() - queued->second;
+    num_issued_requests++;
+    total_queueing_delay += queueing_delay;
+    max_queueing_delay = std::max(max_queueing_delay, queueing_delay);
+    request_queued_times.erase(queued);
+  }
+  auto *pkt = req->dup();
+  if (connection_controller != nullptr) {
+    setUpConnectionWithController(pkt, qnic_address);
+    return;
+  }
+  if (pipelined_ruleset_distribution) {
+    // each attempt gets its own RuleSet id, the nodes install their link-level rules with it on the way
+    pkt->setPipelined(true);
+    pkt->setRuleSet_id(createUniqueId());
+    installLinkRuleSet(pkt, 0, -1, pkt->getDestAddr());
+  }
+  send(pkt, "RouterPort$o");
+}
+
+/**
+ * Sets up the connection with the ConnectionController instead of sending the request along the path.
+ * The controller walks the path from the qnic and reserves all its qnics, and the RuleSets generated here for the path
+ * reach the nodes after the round trip to the controller, as the responses of the responder.
+ * A path with a reserved qnic is retried as a rejection.
+ */
+void ConnectionManager::setUpConnectionWithController(ConnectionSetupRequest *req, int qnic_address) {
+  int responder_addr = req->getActual_destAddr();
+  auto path = connection_controller->findPath(my_address, qnic_address, responder_addr);
+  if (path.empty()) error("ConnectionController found no path from %d to %d", my_address, responder_addr);
+
+  unsigned long ruleset_id = createUniqueId();
+  if (!connection_controller->reserve(ruleset_id, path)) {
+    issued_request_qnics.erase({responder_addr, req->getApplicationId()});
+    num_rejected_attempts++;
+    releaseQnic(qnic_address);
+    scheduleRequestRetry(qnic_address);
+    delete req;
+    return;
+  }
+
+  // the nodes of the path but the responder, as the request would have collected them
+  req->setStack_of_QNodeIndexesArraySize(path.size() - 1);
+  for (int i = 0; i < path.size() - 1; i++) req->setStack_of_QNodeIndexes(i, path[i].node_addr);
+  if (link_purification.target_fidelity > 0) {
+    req->setStack_of_linkFidelitiesArraySize(path.size() - 1);
+    for (int i = 0; i < path.size() - 1; i++) {
+      req->setStack_of_linkFidelities(i, connection_controller->nodeOf(path[i].node_addr).hardware_monitor->getLinkFidelity(path[i].outbound_qnic_addr));
+    }
+  }
+  auto rulesets = generateRuleSets(req, ruleset_id);
+  simtime_t delay = 2 * connection_controller->delay();
+  for (auto &[owner_address, rs] : rulesets) {
+    auto *connection_manager = connection_controller->nodeOf(owner_address).connection_manager;
+    if (connection_manager == nullptr) error("ConnectionController has no ConnectionManager of the node %d", owner_address);
+    sendDirect(createSetupResponse(req, ruleset_id, owner_address, rs), delay, SIMTIME_ZERO, connection_manager, "controllerIn");
+  }
+  delete req;
+}
+
+void ConnectionManager::scheduleRequestSend(int qnic_address, simtime_t at) {
+  request_send_timers->cancel(request_send_timing[qnic_address]);
+  request_send_timing[qnic_address] = request_send_timers->schedule(at, qnic_address);
 }
 
 void ConnectionManager::scheduleRequestRetry(int qnic_address) {
   connection_retry_count[qnic_address]++;
-  int upper_bound = (1 << connection_retry_count[qnic_address]) - 1;
-  int k = intuniform(0, upper_bound);
-  EV << "upper bound = " << upper_bound << endl;
-  simtime_t backoff = SimTime(50, SIMTIME_US) * k;
+  simtime_t backoff = retry_policy->backoff(connection_retry_count[qnic_address], getRNG(0));
   EV << "cannot initiate the connection. Retry attempt = " << connection_retry_count[qnic_address] << " Retry again in " << backoff << " .\n";
   EV << "schedule from retry" << endl;
-  scheduleAt(simTime() + backoff, request_send_timing[qnic_address]);
+  scheduleRequestSend(qnic_address, simTime() + backoff);
   return;
 }
 
@@ -8,10 +8,20 @@
 #pragma once
 
 #include <omnetpp.h>
+#include <map>
+#include <memory>
 #include <queue>
+#include <set>
+#include <tuple>
+#include <utility>
 #include <vector>
 
+#include "AdmissionController.h"
 #include "IConnectionManager.h"
+#include "QnicReservationTable.h"
+#include "RetryPolicy.h"
+#include "RuleSetTemplateCache.h"
+#include "RuleSetGenerator.h"
 
 #include <messages/classical_messages.h>
 #include <modules/Logger/LoggerBase.h>
@@ -20,6 +30,8 @@
 #include <modules/QRSA/RoutingDaemon/IRoutingDaemon.h>
 #include <rules/Action.h>
 #include <utils/ComponentProvider.h>
+#include <utils/ThreadPool.h>
+#include <utils/TimerService.h>
 
 struct SwappingConfig {
   int left_partner;
@@ -53,41 +65,113 @@ namespace quisp::modules {
  * It is also responsible for the end-to-end reservation of resources,
  * as dictated by the multiplexing (muxing) discipline in use.
  */
-class ConnectionManager : public IConnectionManager, public Logger::LoggerBase {
+class ConnectionManager : public IConnectionManager, public Logger::LoggerBase, public cListener {
  public:
   ConnectionManager();
   ~ConnectionManager();
   utils::ComponentProvider provider;
+  modules::SharedResource::EventProfiler *event_profiler = nullptr;
 
  protected:
   int my_address;
   int num_of_qnics;
   std::map<int, std::queue<messages::ConnectionSetupRequest *>> connection_setup_buffer;  // key is qnic address
   std::map<int, int> connection_retry_count;  // key is qnic address
-  std::vector<int> reserved_qnics = {};  // reserved qnic address table
-  std::vector<cMessage *> request_send_timing;  // self message, notification for sending out request
+  QnicReservationTable qnic_reservations;
+  int qnic_reservation_qubits = 0;  // the qubits a connection reserves in each qnic, 0 reserves the whole qnic
+  std::map<std::tuple<int, int, int>, int> relayed_outbound_qnics;  // {initiator, responder, application id} -> outbound qnic address
+  std::unique_ptr<utils::TimerService<int>> request_send_timers;  // the notifications for sending out the request of each qnic
+  std::vector<utils::TimerService<int>::Handle> request_send_timing;  // key is qnic address
+  std::unique_ptr<RetryPolicy> retry_policy;
+  std::map<int, std::set<std::pair<int, int>>> release_waiters;  // qnic address -> {initiator, responder} of the requests rejected because of the qnic
+  std::map<int, std::set<int>> release_waiting_qnics;  // responder -> outbound qnic addresses waiting for a release notification
+  std::map<std::pair<int, int>, int> issued_request_qnics;  // {responder, application id} -> outbound qnic address of the request on the way
+  std::map<messages::ConnectionSetupRequest *, simtime_t> request_queued_times;  // requests not issued yet
+  // batched admission: the requests from the applications are collected over the window and admitted together
+  simtime_t admission_window;
+  cMessage *admission_timer = nullptr;  // nullptr if the batched admission is disabled
+  std::vector<messages::ConnectionSetupRequest *> admission_batch;
+  // a persistent connection of this initiator, re-armed for the requests to the same responder
+  struct PersistentConnection {
+    unsigned long ruleset_id = 0;  // 0 until the setup is accepted
+    bool parked = false;  // the RuleSet of this node finished the last demand
+    std::queue<messages::ConnectionSetupRequest *> waiting_requests;  // the requests that arrived while the connection was busy
+  };
+  bool persistent_connections_enabled = false;
+  std::map<int, PersistentConnection> persistent_connections;  // key is the responder address
+  // the pair rates the responder committed to the connections it admitted, nullptr if it admits any request with free qnics
+  std::unique_ptr<AdmissionController> admission_controller;
+  // the controller of SharedResource the initiator sets up its connections with, nullptr if the requests go hop by hop
+  modules::SharedResource::ConnectionController *connection_controller = nullptr;
   bool simultaneous_es_enabled;
   bool es_with_purify = false;
   int num_remote_purification;
   double threshold_fidelity;
+
+  // statistics recorded in finish()
+  int num_queued_requests = 0;
+  int num_issued_requests = 0;
+  int num_setup_attempts = 0;
+  int num_accepted_requests = 0;
+  int num_rejected_attempts = 0;
+  int num_admission_batches = 0;
+  int num_batch_admitted_requests = 0;
+  int num_release_triggered_retries = 0;
+  int num_rearmed_requests = 0;
+  int num_infeasible_rejections = 0;
+  simtime_t total_queueing_delay = 0;
+  simtime_t max_queueing_delay = 0;
   rules::PurType purification_type;
+  ruleset_gen::SwappingTree swapping_tree;
+  ruleset_gen::LinkPurification link_purification;
+  bool pipelined_ruleset_distribution = false;
+  std::unique_ptr<RuleSetTemplateCache> ruleset_template_cache;  // nullptr if the responder generates the RuleSets every time
+  std::unique_ptr<utils::ThreadPool> ruleset_serialization_pool;  // nullptr if the RuleSets are serialized on the simulation thread
   IRoutingDaemon *routing_daemon;
   IHardwareMonitor *hardware_monitor;
+  simsignal_t connection_established_signal;
+  simsignal_t connection_terminated_signal;
 
   void initialize() override;
   void handleMessage(cMessage *msg) override;
+  void finish() override;
+  void receiveSignal(cComponent *source, simsignal_t signal, cObject *obj, cObject *details) override;
 
   void respondToRequest(messages::ConnectionSetupRequest *pk);
+  RuleSetTemplateCache::RuleSets generateRuleSets(messages::ConnectionSetupRequest *req, unsigned long ruleset_id);
+  void applyQosClass(messages::ConnectionSetupRequest *req, RuleSetTemplateCache::RuleSets &rulesets);
+  messages::ConnectionSetupResponse *createSetupResponse(messages::ConnectionSetupRequest *req, unsigned long ruleset_id, int owner_address,
+                                                         RuleSetTemplateCache::NodeRuleSet &rs);
   void respondToRequest_deprecated(messages::ConnectionSetupRequest *pk);
   void tryRelayRequestToNextHop(messages::ConnectionSetupRequest *pk);
-
+  std::vector<int> findOutboundQnics(int dest_addr);
+  static bool hasVisited(messages::ConnectionSetupRequest *req, int node_address);
+  void appendAdmissionInfo(messages::ConnectionSetupRequest *req, int inbound_qnic_address, int outbound_qnic_address);
+  void appendLinkFidelity(messages::ConnectionSetupRequest *req, int outbound_qnic_address);
+  int connectionQubitsOf(int qnic_address);
+  AdmissionController::Path admissionPathOf(messages::ConnectionSetupRequest *req, int inbound_qnic_address);
+
+  void handleApplicationRequest(messages::ConnectionSetupRequest *pk);
+  void rearmPersistentConnection(PersistentConnection &connection, messages::ConnectionSetupRequest *pk);
+  void emitConnectionEstablished(int responder_addr, int request_id, unsigned long ruleset_id);
   void queueApplicationRequest(messages::ConnectionSetupRequest *pk);
+  void enqueueRequestToQnic(messages::ConnectionSetupRequest *pk, int outbound_qnic_address);
+  void admitBatchedRequests();
+  static std::vector<int> assignQnics(const std::vector<std::vector<int>> &candidate_qnics);
   void initiateApplicationRequest(int qnic_address);
+  // moves the notification of the qnic to the time, replacing the scheduled one
+  void scheduleRequestSend(int qnic_address, simtime_t at);
+  void setUpConnectionWithController(messages::ConnectionSetupRequest *req, int qnic_address);
   void scheduleRequestRetry(int qnic_address);
+  void addReleaseWaiter(int qnic_address, messages::ConnectionSetupRequest *req);
+  void notifyReleaseWaiters(int qnic_address);
+  void retryOnRelease(messages::ConnectionSetupReleaseNotification *pk);
   void popApplicationRequest(int qnic_address);
 
   void storeRuleSetForApplication(messages::ConnectionSetupResponse *pk);
   void storeRuleSet(messages::ConnectionSetupResponse *pk);
+  void installLinkRuleSet(messages::ConnectionSetupRequest *req, int node_index, int left_addr, int right_addr);
+  void terminateLinkRuleSet(messages::RejectConnectionSetupRequest *pk);
 
   void initiator_reject_req_handler(messages::RejectConnectionSetupRequest *pk);
   void responder_reject_req_handler(messages::RejectConnectionSetupRequest *pk);
@@ -98,6 +182,7 @@ class ConnectionManager : public IConnectionManager, public Logger::LoggerBase {
   void reserveQnic(int qnic_address);
   void releaseQnic(int qnic_address);
   bool isQnicBusy(int qnic_address);
+  int reservationUnitsOf(int qnic_address);
 
   static rules::PurType parsePurType(const std::string &pur_type);
 
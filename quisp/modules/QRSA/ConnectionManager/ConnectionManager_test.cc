@@ -38,15 +38,30 @@ class Strategy : public quisp_test::TestComponentProviderStrategy {
 
 class ConnectionManagerTestTarget : public quisp::modules::ConnectionManager {
  public:
+  using quisp::modules::ConnectionManager::admission_controller;
+  using quisp::modules::ConnectionManager::assignQnics;
+  using quisp::modules::ConnectionManager::findOutboundQnics;
+  using quisp::modules::ConnectionManager::handleMessage;
   using quisp::modules::ConnectionManager::isQnicBusy;
+  using quisp::modules::ConnectionManager::link_purification;
   using quisp::modules::ConnectionManager::par;
+  using quisp::modules::ConnectionManager::connection_terminated_signal;
   using quisp::modules::ConnectionManager::parsePurType;
+  using quisp::modules::ConnectionManager::persistent_connections;
+  using quisp::modules::ConnectionManager::persistent_connections_enabled;
+  using quisp::modules::ConnectionManager::receiveSignal;
   using quisp::modules::ConnectionManager::purification_type;
   using quisp::modules::ConnectionManager::releaseQnic;
-  using quisp::modules::ConnectionManager::reserved_qnics;
+  using quisp::modules::ConnectionManager::qnic_reservation_qubits;
+  using quisp::modules::ConnectionManager::qnic_reservations;
   using quisp::modules::ConnectionManager::reserveQnic;
   using quisp::modules::ConnectionManager::respondToRequest;
   using quisp::modules::ConnectionManager::respondToRequest_deprecated;
+  using quisp::modules::ConnectionManager::storeRuleSet;
+  using quisp::modules::ConnectionManager::storeRuleSetForApplication;
+  using quisp::modules::ConnectionManager::ruleset_template_cache;
+  using quisp::modules::ConnectionManager::threshold_fidelity;
+  using quisp::modules::ConnectionManager::tryRelayRequestToNextHop;
   ConnectionManagerTestTarget(IRoutingDaemon *routing_daemon, IHardwareMonitor *hardware_monitor)
       : quisp::modules::ConnectionManager(), toRouterGate(new TestGate(this, "RouterPort$o")) {
     setParInt(this, "address", 5);
@@ -58,6 +73,21 @@ class ConnectionManagerTestTarget : public quisp::modules::ConnectionManager {
     setParStr(this, "purification_type_cm", "SINGLE_SELECTION_X_PURIFICATION");
     setParDouble(this, "threshold_fidelity", 0);
     setParInt(this, "seed_cm", 0);
+    setParStr(this, "swapping_tree", "reverse_swap_at_half");
+    setParInt(this, "ruleset_serialization_threads", 1);
+    setParDouble(this, "connection_admission_window", 0);
+    setParDouble(this, "request_timer_resolution", 0);
+    setParBool(this, "persistent_connections", false);
+    setParInt(this, "link_purification_rounds", 0);
+    setParInt(this, "link_pumping_rounds", 1);
+    setParBool(this, "adaptive_link_purification", false);
+    setParBool(this, "pipelined_ruleset_distribution", false);
+    setParInt(this, "ruleset_template_cache_size", 0);
+    setParDouble(this, "admission_pair_rate", 0);
+    setParStr(this, "retry_policy", "binary_exponential");
+    setParInt(this, "qnic_reservation_qubits", 0);
+    setParDouble(this, "retry_base_backoff", 50e-6);
+    setParDouble(this, "retry_max_backoff", 1);
 
     this->provider.setStrategy(std::make_unique<Strategy>(routing_daemon, hardware_monitor));
     setComponentType(new module_type::TestModuleType("test cm"));
@@ -84,6 +114,33 @@ TEST(ConnectionManagerTest, Init) {
   ASSERT_EQ(c.par("address").intValue(), 5);
 }
 
+TEST(ConnectionManagerTest, AssignQnicsToBatchedRequests) {
+  // the first request takes qnic 1 first, and moves to qnic 2 so that the second request can use qnic 1
+  auto assigned = ConnectionManagerTestTarget::assignQnics({{1, 2}, {1}, {1}, {3}});
+  EXPECT_EQ(assigned, (std::vector<int>{2, 1, -1, 3}));
+
+  assigned = ConnectionManagerTestTarget::assignQnics({{}, {4, 5}, {5}});
+  EXPECT_EQ(assigned, (std::vector<int>{-1, 4, 5}));
+}
+
+TEST(ConnectionManagerTest, FindOutboundQnicsOfTheFidelityPathFirst) {
+  prepareSimulation();
+  auto *routing_daemon = new MockRoutingDaemon();
+  auto *hardware_monitor = new MockHardwareMonitor();
+  auto *connection_manager = new ConnectionManagerTestTarget(routing_daemon, hardware_monitor);
+
+  // without the target, the cheapest first
+  EXPECT_CALL(*routing_daemon, findQNicAddrsByDestAddr(8)).WillRepeatedly(Return(std::vector<int>{107, 108, 109}));
+  EXPECT_CALL(*routing_daemon, findQNicAddrForFidelity(_, _)).Times(0);
+  EXPECT_EQ(connection_manager->findOutboundQnics(8), (std::vector<int>{107, 108, 109}));
+
+  connection_manager->threshold_fidelity = 0.9;
+  EXPECT_CALL(*routing_daemon, findQNicAddrForFidelity(8, 0.9)).WillOnce(Return(109)).WillOnce(Return(110));
+  EXPECT_EQ(connection_manager->findOutboundQnics(8), (std::vector<int>{109, 107, 108}));
+  // the fidelity path beyond the alternative paths comes first as well
+  EXPECT_EQ(connection_manager->findOutboundQnics(8), (std::vector<int>{110, 107, 108, 109}));
+}
+
 TEST(ConnectionManagerTest, parsePurType) {
   prepareSimulation();
   auto *routing_daemon = new MockRoutingDaemon();
@@ -159,6 +216,10 @@ TEST(ConnectionManagerTest, RespondToRequest) {
     auto ruleset = packetFor2->getRuleSet();  // json serialized ruleset
     ASSERT_NE(ruleset, nullptr);
     EXPECT_EQ(ruleset["rules"].size(), 2);
+    // the compiled ruleset is shipped along with the json
+    auto &compiled_ruleset = packetFor2->getRuntimeRuleSet();
+    ASSERT_NE(compiled_ruleset, nullptr);
+    EXPECT_EQ(compiled_ruleset->rules.size(), 2);
     auto expected_ruleset = R"({
   "num_rules": 2,
   "owner_address": 2,
@@ -572,33 +633,380 @@ TEST(ConnectionManagerTest, RespondToRequest) {
   delete hardware_monitor;
 }
 
+TEST(ConnectionManagerTest, RespondFromRuleSetTemplateCache) {
+  auto *sim = prepareSimulation();
+  auto *routing_daemon = new MockRoutingDaemon();
+  auto *hardware_monitor = new MockHardwareMonitor();
+  auto *connection_manager = new ConnectionManagerTestTarget(routing_daemon, hardware_monitor);
+  sim->registerComponent(connection_manager);
+  connection_manager->callInitialize();
+  connection_manager->ruleset_template_cache = std::make_unique<quisp::modules::RuleSetTemplateCache>(4);
+
+  // [QNode3] -- [QNode4] -- (106)[QNode5(test target)]
+  auto create_request = []() {
+    auto *req = new ConnectionSetupRequest;
+    req->setApplicationId(1);
+    req->setActual_destAddr(5);
+    req->setActual_srcAddr(3);
+    req->setDestAddr(5);
+    req->setSrcAddr(4);
+    req->setNum_measure(100);
+    req->setStack_of_QNodeIndexesArraySize(2);
+    req->setStack_of_QNodeIndexes(0, 3);
+    req->setStack_of_QNodeIndexes(1, 4);
+    return req;
+  };
+  EXPECT_CALL(*routing_daemon, findQNicAddrByDestAddr(4)).WillRepeatedly(Return(106));
+  sim->setContext(connection_manager);
+  auto gate = connection_manager->toRouterGate;
+  for (int i = 0; i < 2; i++) {
+    auto *req = create_request();
+    connection_manager->respondToRequest(req);
+    delete req;
+    connection_manager->releaseQnic(106);
+  }
+  EXPECT_EQ(connection_manager->ruleset_template_cache->misses(), 1);
+  EXPECT_EQ(connection_manager->ruleset_template_cache->hits(), 1);
+
+  // the cached RuleSets are the generated ones
+  ASSERT_EQ(gate->messages.size(), 6);
+  for (int i = 0; i < 3; i++) {
+    auto *generated = dynamic_cast<ConnectionSetupResponse *>(gate->messages[i]);
+    auto *cached = dynamic_cast<ConnectionSetupResponse *>(gate->messages[i + 3]);
+    ASSERT_NE(generated, nullptr);
+    ASSERT_NE(cached, nullptr);
+    EXPECT_EQ(cached->getDestAddr(), generated->getDestAddr());
+    EXPECT_EQ(cached->getRuleSet_id(), 1234);
+    EXPECT_EQ(cached->getRuleSet(), generated->getRuleSet());
+    EXPECT_EQ(cached->getRuntimeRuleSet()->contentKey(), generated->getRuntimeRuleSet()->contentKey());
+    EXPECT_EQ(cached->getRuntimeRuleSet()->id, 1234);
+  }
+  delete routing_daemon;
+  delete hardware_monitor;
+}
+
+TEST(ConnectionManagerTest, RejectRequestBeyondTheCommittedPairRates) {
+  auto *sim = prepareSimulation();
+  auto *routing_daemon = new MockRoutingDaemon();
+  auto *hardware_monitor = new MockHardwareMonitor();
+  auto *connection_manager = new ConnectionManagerTestTarget(routing_daemon, hardware_monitor);
+  sim->registerComponent(connection_manager);
+  connection_manager->callInitialize();
+  sim->setContext(connection_manager);
+  // 20 pairs/s for each connection, the remote purification takes 2 pairs and 2 qubits for each
+  connection_manager->admission_controller = std::make_unique<quisp::modules::AdmissionController>(20, 2, 2);
+  connection_manager->connection_terminated_signal = cComponent::registerSignal("connectionTerminated");
+
+  // [QNode3] --100 pairs/s-- [QNode4] --50 pairs/s-- (106)[QNode5(test target)]
+  auto create_request = []() {
+    auto *req = new ConnectionSetupRequest;
+    req->setApplicationId(1);
+    req->setActual_destAddr(5);
+    req->setActual_srcAddr(3);
+    req->setDestAddr(5);
+    req->setSrcAddr(4);
+    req->setNum_measure(100);
+    req->setStack_of_QNodeIndexesArraySize(2);
+    req->setStack_of_QNodeIndexes(0, 3);
+    req->setStack_of_QNodeIndexes(1, 4);
+    req->setStack_of_linkPairRatesArraySize(2);
+    req->setStack_of_linkPairRates(0, 100);
+    req->setStack_of_linkPairRates(1, 50);
+    req->setStack_of_QNodeQubitsArraySize(2);
+    req->setStack_of_QNodeQubits(0, 4);
+    req->setStack_of_QNodeQubits(1, 4);
+    return req;
+  };
+  ConnectionSetupInfo inbound_info{.qnic = {.type = QNIC_E, .index = 16, .address = 106}, .neighbor_address = 4, .quantum_link_cost = 1};
+  EXPECT_CALL(*routing_daemon, findQNicAddrByDestAddr(4)).WillRepeatedly(Return(106));
+  EXPECT_CALL(*hardware_monitor, findConnectionInfoByQnicAddr(106)).WillRepeatedly(Return(&inbound_info));
+  EXPECT_CALL(*hardware_monitor, getQnicNumQubits(16, QNIC_E)).WillRepeatedly(Return(4));
+  auto &messages = connection_manager->toRouterGate->messages;
+
+  auto *req = create_request();
+  connection_manager->respondToRequest(req);
+  delete req;
+  ASSERT_EQ(messages.size(), 3);
+  EXPECT_NE(dynamic_cast<ConnectionSetupResponse *>(messages[0]), nullptr);
+  connection_manager->releaseQnic(106);
+
+  // the 50 pairs/s link has only 10 pairs/s left, the initiator and QNode4 are rejected
+  req = create_request();
+  connection_manager->respondToRequest(req);
+  delete req;
+  ASSERT_EQ(messages.size(), 5);
+  EXPECT_NE(dynamic_cast<RejectConnectionSetupRequest *>(messages[3]), nullptr);
+  EXPECT_NE(dynamic_cast<RejectConnectionSetupRequest *>(messages[4]), nullptr);
+
+  // the first connection is over
+  quisp::modules::SharedResource::ConnectionMetricEvent event;
+  event.ruleset_id = 1234;
+  event.node_addr = 5;
+  connection_manager->receiveSignal(nullptr, connection_manager->connection_terminated_signal, &event, nullptr);
+  req = create_request();
+  connection_manager->respondToRequest(req);
+  delete req;
+  ASSERT_EQ(messages.size(), 8);
+  EXPECT_NE(dynamic_cast<ConnectionSetupResponse *>(messages[5]), nullptr);
+  delete routing_daemon;
+  delete hardware_monitor;
+}
+
+TEST(ConnectionManagerTest, RelayRequestToAlternativeNextHop) {
+  auto *sim = prepareSimulation();
+  auto *routing_daemon = new MockRoutingDaemon();
+  auto *hardware_monitor = new MockHardwareMonitor();
+  auto *connection_manager = new ConnectionManagerTestTarget(routing_daemon, hardware_monitor);
+  sim->registerComponent(connection_manager);
+  connection_manager->callInitialize();
+
+  // [QNode4] -- (106)[QNode5(test target)](107) -- [QNode6]
+  //                                       (108) -- [QNode7] -- ... -- [QNode8]
+  auto *req = new ConnectionSetupRequest;
+  req->setApplicationId(1);
+  req->setActual_destAddr(8);
+  req->setActual_srcAddr(4);
+  req->setDestAddr(5);
+  req->setSrcAddr(4);
+  req->setStack_of_QNICsArraySize(1);
+  req->setStack_of_QNodeIndexesArraySize(1);
+  req->setStack_of_QNodeIndexes(0, 4);
+  req->setStack_of_QNICs(0, QNicPairInfo{NULL_CONNECTION_SETUP_INFO.qnic, {.type = QNIC_E, .index = 11, .address = 101}});
+
+  // the qnic on the shortest path is used by another connection
+  connection_manager->reserveQnic(107);
+  EXPECT_CALL(*routing_daemon, findQNicAddrsByDestAddr(8)).WillOnce(Return(std::vector<int>{107, 108}));
+  EXPECT_CALL(*routing_daemon, findQNicAddrByDestAddr(4)).WillRepeatedly(Return(106));
+  ConnectionSetupInfo outbound_info{.qnic = {.type = QNIC_E, .index = 18, .address = 108}, .neighbor_address = 7, .quantum_link_cost = 1};
+  ConnectionSetupInfo inbound_info{.qnic = {.type = QNIC_E, .index = 16, .address = 106}, .neighbor_address = 4, .quantum_link_cost = 1};
+  EXPECT_CALL(*hardware_monitor, findConnectionInfoByQnicAddr(108)).WillOnce(Return(&outbound_info));
+  EXPECT_CALL(*hardware_monitor, findConnectionInfoByQnicAddr(106)).WillOnce(Return(&inbound_info));
+
+  sim->setContext(connection_manager);
+  connection_manager->tryRelayRequestToNextHop(req);
+  ASSERT_EQ(connection_manager->toRouterGate->messages.size(), 1);
+  EXPECT_EQ(req->getDestAddr(), 7);
+  EXPECT_TRUE(connection_manager->isQnicBusy(106));
+  EXPECT_TRUE(connection_manager->isQnicBusy(108));
+
+  // a rejection releases the qnic of the alternative path
+  auto *reject = new RejectConnectionSetupRequest;
+  reject->setApplicationId(1);
+  reject->setActual_destAddr(8);
+  reject->setActual_srcAddr(4);
+  EXPECT_CALL(*routing_daemon, findQNicAddrByDestAddr(8)).WillOnce(Return(107));
+  connection_manager->handleMessage(reject);
+  EXPECT_FALSE(connection_manager->isQnicBusy(106));
+  EXPECT_FALSE(connection_manager->isQnicBusy(108));
+  EXPECT_TRUE(connection_manager->isQnicBusy(107));
+  delete routing_daemon;
+  delete hardware_monitor;
+}
+
+TEST(ConnectionManagerTest, InstallLinkRuleSetWhileRelaying) {
+  auto *sim = prepareSimulation();
+  auto *routing_daemon = new MockRoutingDaemon();
+  auto *hardware_monitor = new MockHardwareMonitor();
+  auto *connection_manager = new ConnectionManagerTestTarget(routing_daemon, hardware_monitor);
+  sim->registerComponent(connection_manager);
+  connection_manager->callInitialize();
+  connection_manager->link_purification.rounds = 1;
+
+  // [QNode4] -- (106)[QNode5(test target)](107) -- [QNode6]
+  auto *req = new ConnectionSetupRequest;
+  req->setApplicationId(1);
+  req->setActual_destAddr(6);
+  req->setActual_srcAddr(4);
+  req->setDestAddr(5);
+  req->setSrcAddr(4);
+  req->setPipelined(true);
+  req->setRuleSet_id(42);
+  req->setStack_of_QNICsArraySize(1);
+  req->setStack_of_QNodeIndexesArraySize(1);
+  req->setStack_of_QNodeIndexes(0, 4);
+  req->setStack_of_QNICs(0, QNicPairInfo{NULL_CONNECTION_SETUP_INFO.qnic, {.type = QNIC_E, .index = 11, .address = 101}});
+
+  EXPECT_CALL(*routing_daemon, findQNicAddrsByDestAddr(6)).WillOnce(Return(std::vector<int>{107}));
+  EXPECT_CALL(*routing_daemon, findQNicAddrByDestAddr(4)).WillRepeatedly(Return(106));
+  ConnectionSetupInfo outbound_info{.qnic = {.type = QNIC_E, .index = 17, .address = 107}, .neighbor_address = 6, .quantum_link_cost = 1};
+  ConnectionSetupInfo inbound_info{.qnic = {.type = QNIC_E, .index = 16, .address = 106}, .neighbor_address = 4, .quantum_link_cost = 1};
+  EXPECT_CALL(*hardware_monitor, findConnectionInfoByQnicAddr(107)).WillOnce(Return(&outbound_info));
+  EXPECT_CALL(*hardware_monitor, findConnectionInfoByQnicAddr(106)).WillOnce(Return(&inbound_info));
+
+  sim->setContext(connection_manager);
+  connection_manager->tryRelayRequestToNextHop(req);
+
+  // the purification with both neighbors is installed before the request goes on
+  ASSERT_EQ(connection_manager->toRouterGate->messages.size(), 2);
+  auto *forwarding = dynamic_cast<InternalRuleSetForwarding *>(connection_manager->toRouterGate->messages[0]);
+  ASSERT_NE(forwarding, nullptr);
+  EXPECT_EQ(forwarding->getDestAddr(), 5);
+  EXPECT_EQ(forwarding->getRuleSet_id(), 42);
+  ASSERT_NE(forwarding->getRuntimeRuleSet(), nullptr);
+  EXPECT_EQ(forwarding->getRuntimeRuleSet()->rules.size(), 4);
+  EXPECT_EQ(connection_manager->toRouterGate->messages[1], req);
+
+  // a rejection terminates them
+  auto *reject = new RejectConnectionSetupRequest;
+  reject->setApplicationId(1);
+  reject->setActual_destAddr(6);
+  reject->setActual_srcAddr(4);
+  reject->setRuleSet_id(42);
+  EXPECT_CALL(*routing_daemon, findQNicAddrByDestAddr(6)).WillOnce(Return(107));
+  connection_manager->handleMessage(reject);
+  ASSERT_EQ(connection_manager->toRouterGate->messages.size(), 3);
+  auto *termination = dynamic_cast<InternalRuleSetTermination *>(connection_manager->toRouterGate->messages[2]);
+  ASSERT_NE(termination, nullptr);
+  EXPECT_EQ(termination->getRuleSet_id(), 42);
+  delete routing_daemon;
+  delete hardware_monitor;
+}
+
+TEST(ConnectionManagerTest, RearmPersistentConnection) {
+  auto *sim = prepareSimulation();
+  auto *routing_daemon = new MockRoutingDaemon();
+  auto *hardware_monitor = new MockHardwareMonitor();
+  auto *connection_manager = new ConnectionManagerTestTarget(routing_daemon, hardware_monitor);
+  sim->registerComponent(connection_manager);
+  connection_manager->callInitialize();
+  sim->setContext(connection_manager);
+  connection_manager->persistent_connections_enabled = true;
+  connection_manager->connection_terminated_signal = cComponent::registerSignal("connectionTerminated");
+  // the connection to QNode6 is set up and serves its first demand
+  auto &connection = connection_manager->persistent_connections[6];
+  connection.ruleset_id = 1234;
+
+  auto create_request = [](int request_id, int num_measure) {
+    auto *req = new ConnectionSetupRequest;
+    req->setActual_srcAddr(5);
+    req->setActual_destAddr(6);
+    req->setDestAddr(5);
+    req->setSrcAddr(5);
+    req->setRequestId(request_id);
+    req->setNum_measure(num_measure);
+    return req;
+  };
+  // the next request waits for the demand, without routing
+  connection_manager->handleMessage(create_request(1, 20));
+  EXPECT_EQ(connection.waiting_requests.size(), 1);
+  EXPECT_EQ(connection_manager->toRouterGate->messages.size(), 0);
+
+  // the RuleSet of this node is parked, both end nodes re-arm it for the waiting request
+  quisp::modules::SharedResource::ConnectionMetricEvent event;
+  event.ruleset_id = 1234;
+  event.node_addr = 5;
+  event.parked = true;
+  connection_manager->receiveSignal(nullptr, connection_manager->connection_terminated_signal, &event, nullptr);
+  EXPECT_TRUE(connection.waiting_requests.empty());
+  EXPECT_FALSE(connection.parked);
+  ASSERT_EQ(connection_manager->toRouterGate->messages.size(), 2);
+  for (int i = 0; i < 2; i++) {
+    auto *rearm = dynamic_cast<ConnectionRearm *>(connection_manager->toRouterGate->messages[i]);
+    ASSERT_NE(rearm, nullptr);
+    EXPECT_EQ(rearm->getDestAddr(), i == 0 ? 5 : 6);
+    EXPECT_EQ(rearm->getRuleSet_id(), 1234);
+    EXPECT_EQ(rearm->getNum_measure(), 20);
+  }
+
+  // parked again, the next request re-arms it right away
+  connection_manager->receiveSignal(nullptr, connection_manager->connection_terminated_signal, &event, nullptr);
+  EXPECT_TRUE(connection.parked);
+  connection_manager->handleMessage(create_request(2, 5));
+  EXPECT_EQ(connection_manager->toRouterGate->messages.size(), 4);
+
+  // the RuleSet is terminated, the connection is forgotten
+  event.parked = false;
+  connection_manager->receiveSignal(nullptr, connection_manager->connection_terminated_signal, &event, nullptr);
+  EXPECT_TRUE(connection_manager->persistent_connections.empty());
+  delete routing_daemon;
+  delete hardware_monitor;
+}
+
+TEST(ConnectionManagerTest, ForwardCompiledRuleSet) {
+  auto *sim = prepareSimulation();
+  auto *routing_daemon = new MockRoutingDaemon();
+  auto *hardware_monitor = new MockHardwareMonitor();
+  auto *connection_manager = new ConnectionManagerTestTarget(routing_daemon, hardware_monitor);
+  sim->registerComponent(connection_manager);
+  connection_manager->callInitialize();
+  sim->setContext(connection_manager);
+
+  auto compiled_ruleset = std::make_shared<const quisp::runtime::RuleSet>("compiled rs");
+  ConnectionSetupResponse resp;
+  resp.setDestAddr(5);
+  resp.setRuleSet_id(1234);
+  resp.setRuntimeRuleSet(compiled_ruleset);
+
+  // the RuleEngine gets the RuleSet the responder compiled, not a copy of it
+  connection_manager->storeRuleSet(&resp);
+  connection_manager->storeRuleSetForApplication(&resp);
+  auto gate = connection_manager->toRouterGate;
+  ASSERT_EQ(gate->messages.size(), 2);
+  auto *forwarding = dynamic_cast<InternalRuleSetForwarding *>(gate->messages[0]);
+  ASSERT_NE(forwarding, nullptr);
+  EXPECT_EQ(forwarding->getRuleSet_id(), 1234);
+  EXPECT_EQ(forwarding->getRuntimeRuleSet(), compiled_ruleset);
+  auto *forwarding_app = dynamic_cast<InternalRuleSetForwarding_Application *>(gate->messages[1]);
+  ASSERT_NE(forwarding_app, nullptr);
+  EXPECT_EQ(forwarding_app->getRuleSet_id(), 1234);
+  EXPECT_EQ(forwarding_app->getRuntimeRuleSet(), compiled_ruleset);
+  delete routing_daemon;
+  delete hardware_monitor;
+}
+
 TEST(ConnectionManagerTest, QnicReservation) {
   prepareSimulation();
   auto *connection_manager = new ConnectionManagerTestTarget();
 
   int qnic_address = 13, qnic_address2 = 15;
   // qnic reservation
-  EXPECT_EQ(connection_manager->reserved_qnics.size(), 0);
+  EXPECT_EQ(connection_manager->qnic_reservations.numReservedQnics(), 0);
   connection_manager->reserveQnic(qnic_address);
-  EXPECT_EQ(connection_manager->reserved_qnics.size(), 1);
-  EXPECT_EQ(connection_manager->reserved_qnics.at(0), qnic_address);
+  EXPECT_EQ(connection_manager->qnic_reservations.numReservedQnics(), 1);
+  EXPECT_EQ(connection_manager->qnic_reservations.reserved(qnic_address), 1);
   EXPECT_TRUE(connection_manager->isQnicBusy(qnic_address));
   EXPECT_FALSE(connection_manager->isQnicBusy(qnic_address2));
   connection_manager->reserveQnic(qnic_address2);
-  EXPECT_EQ(connection_manager->reserved_qnics.size(), 2);
-  EXPECT_EQ(connection_manager->reserved_qnics.at(1), qnic_address2);
+  EXPECT_EQ(connection_manager->qnic_reservations.numReservedQnics(), 2);
+  EXPECT_EQ(connection_manager->qnic_reservations.reserved(qnic_address2), 1);
   EXPECT_TRUE(connection_manager->isQnicBusy(qnic_address));
   EXPECT_TRUE(connection_manager->isQnicBusy(qnic_address2));
 
   // qnic release
   connection_manager->releaseQnic(qnic_address);
-  EXPECT_EQ(connection_manager->reserved_qnics.size(), 1);
-  EXPECT_EQ(connection_manager->reserved_qnics.at(0), qnic_address2);
+  EXPECT_EQ(connection_manager->qnic_reservations.numReservedQnics(), 1);
+  EXPECT_EQ(connection_manager->qnic_reservations.reserved(qnic_address2), 1);
   EXPECT_FALSE(connection_manager->isQnicBusy(qnic_address));
   EXPECT_TRUE(connection_manager->isQnicBusy(qnic_address2));
   connection_manager->releaseQnic(qnic_address2);
-  EXPECT_EQ(connection_manager->reserved_qnics.size(), 0);
+  EXPECT_EQ(connection_manager->qnic_reservations.numReservedQnics(), 0);
   EXPECT_FALSE(connection_manager->isQnicBusy(qnic_address));
   EXPECT_FALSE(connection_manager->isQnicBusy(qnic_address2));
 }
+TEST(ConnectionManagerTest, SharedQnicReservation) {
+  prepareSimulation();
+  auto *routing_daemon = new MockRoutingDaemon();
+  auto *hardware_monitor = new MockHardwareMonitor();
+  auto *connection_manager = new ConnectionManagerTestTarget(routing_daemon, hardware_monitor);
+  connection_manager->qnic_reservation_qubits = 3;
+  ConnectionSetupInfo info{.qnic = {.type = QNIC_E, .index = 3, .address = 13}, .neighbor_address = 7, .quantum_link_cost = 1};
+  EXPECT_CALL(*hardware_monitor, findConnectionInfoByQnicAddr(13)).WillOnce(Return(&info));
+  EXPECT_CALL(*hardware_monitor, getQnicNumQubits(3, QNIC_E)).WillOnce(Return(7));
+
+  // two connections share the 7 qubits of the qnic, 3 qubits each
+  int qnic_address = 13;
+  connection_manager->reserveQnic(qnic_address);
+  EXPECT_FALSE(connection_manager->isQnicBusy(qnic_address));
+  connection_manager->reserveQnic(qnic_address);
+  EXPECT_EQ(connection_manager->qnic_reservations.reserved(qnic_address), 6);
+  EXPECT_TRUE(connection_manager->isQnicBusy(qnic_address));
+
+  connection_manager->releaseQnic(qnic_address);
+  EXPECT_FALSE(connection_manager->isQnicBusy(qnic_address));
+  connection_manager->releaseQnic(qnic_address);
+  EXPECT_EQ(connection_manager->qnic_reservations.numReservedQnics(), 0);
+  delete routing_daemon;
+  delete hardware_monitor;
+}
+
 }  // namespace
@@ -0,0 +1,53 @@
+#include "QnicReservationTable.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace quisp::modules {
+
+void QnicReservationTable::setCapacity(int qnic_address, int capacity) {
+  if (qnic_address < 0) throw std::out_of_range("invalid qnic address: " + std::to_string(qnic_address));
+  if ((std::size_t)qnic_address >= entries.size()) entries.resize(qnic_address + 1);
+  entries[qnic_address].capacity = capacity;
+}
+
+bool QnicReservationTable::hasCapacity(int qnic_address) const {
+  auto *entry = find(qnic_address);
+  return entry != nullptr && entry->capacity >= 0;
+}
+
+int QnicReservationTable::capacity(int qnic_address) const {
+  auto *entry = find(qnic_address);
+  return entry != nullptr ? entry->capacity : -1;
+}
+
+bool QnicReservationTable::canReserve(int qnic_address, int amount) const {
+  auto *entry = find(qnic_address);
+  return entry != nullptr && entry->reserved + amount <= entry->capacity;
+}
+
+void QnicReservationTable::reserve(int qnic_address, int amount) {
+  if (!canReserve(qnic_address, amount)) throw std::out_of_range("qnic(addr: " + std::to_string(qnic_address) + ") doesn't have " + std::to_string(amount) + " free units");
+  auto &entry = entries[qnic_address];
+  if (entry.reserved == 0 && amount > 0) num_reserved_qnics++;
+  entry.reserved += amount;
+}
+
+void QnicReservationTable::release(int qnic_address, int amount) {
+  if (reserved(qnic_address) < amount) throw std::out_of_range("qnic(addr: " + std::to_string(qnic_address) + ") doesn't have " + std::to_string(amount) + " reserved units");
+  auto &entry = entries[qnic_address];
+  entry.reserved -= amount;
+  if (entry.reserved == 0 && amount > 0) num_reserved_qnics--;
+}
+
+int QnicReservationTable::reserved(int qnic_address) const {
+  auto *entry = find(qnic_address);
+  return entry != nullptr ? entry->reserved : 0;
+}
+
+const QnicReservationTable::Entry *QnicReservationTable::find(int qnic_address) const {
+  if (qnic_address < 0 || (std::size_t)qnic_address >= entries.size()) return nullptr;
+  return &entries[qnic_address];
+}
+
+}  // namespace quisp::modules
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace quisp::modules {
+
+/**
+ * @brief QnicReservationTable counts the reserved units of each qnic, by the qnic address.
+ *
+ * A unit is a qubit of the qnic when the connections share the qnic, or the whole qnic when each connection locks it.
+ * The qnic addresses are small integers, so the counters are kept in a vector indexed by the address.
+ */
+class QnicReservationTable {
+ public:
+  /// @brief the capacity must be set before the qnic is reserved.
+  void setCapacity(int qnic_address, int capacity);
+  bool hasCapacity(int qnic_address) const;
+  /// @brief returns -1 if the capacity is not set.
+  int capacity(int qnic_address) const;
+
+  /// @brief whether amount units of the qnic are not reserved yet.
+  bool canReserve(int qnic_address, int amount) const;
+
+  /// @brief throws std::out_of_range if the qnic doesn't have amount free units.
+  void reserve(int qnic_address, int amount);
+  /// @brief throws std::out_of_range if less than amount units of the qnic are reserved.
+  void release(int qnic_address, int amount);
+
+  int reserved(int qnic_address) const;
+  bool isReserved(int qnic_address) const { return reserved(qnic_address) > 0; }
+  /// @brief the number of the qnics that have any reservation.
+  std::size_t numReservedQnics() const { return num_reserved_qnics; }
+
+ private:
+  struct Entry {
+    int capacity = -1;  // -1 if not set
+    int reserved = 0;
+  };
+  const Entry *find(int qnic_address) const;
+
+  std::vector<Entry> entries;
+  std::size_t num_reserved_qnics = 0;
+};
+
+}  // namespace quisp::modules
@@ -0,0 +1,41 @@
+#include "QnicReservationTable.h"
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+namespace {
+using quisp::modules::QnicReservationTable;
+
+TEST(QnicReservationTableTest, ReserveAndRelease) {
+  QnicReservationTable table;
+  EXPECT_FALSE(table.hasCapacity(3));
+  EXPECT_FALSE(table.canReserve(3, 1));
+  EXPECT_THROW(table.reserve(3, 1), std::out_of_range);
+
+  table.setCapacity(3, 7);
+  table.setCapacity(5, 7);
+  EXPECT_TRUE(table.hasCapacity(3));
+  EXPECT_EQ(table.capacity(3), 7);
+  EXPECT_EQ(table.capacity(4), -1);
+  table.reserve(3, 4);
+  EXPECT_TRUE(table.isReserved(3));
+  EXPECT_FALSE(table.isReserved(5));
+  EXPECT_EQ(table.numReservedQnics(), 1);
+  // the rest of the qnic is shared with another connection
+  EXPECT_TRUE(table.canReserve(3, 3));
+  EXPECT_FALSE(table.canReserve(3, 4));
+  table.reserve(3, 3);
+  EXPECT_EQ(table.reserved(3), 7);
+  EXPECT_THROW(table.reserve(3, 1), std::out_of_range);
+
+  table.release(3, 4);
+  EXPECT_EQ(table.reserved(3), 3);
+  EXPECT_EQ(table.numReservedQnics(), 1);
+  table.release(3, 3);
+  EXPECT_FALSE(table.isReserved(3));
+  EXPECT_EQ(table.numReservedQnics(), 0);
+  EXPECT_THROW(table.release(3, 1), std::out_of_range);
+  EXPECT_THROW(table.setCapacity(-1, 1), std::out_of_range);
+}
+
+}  // namespace
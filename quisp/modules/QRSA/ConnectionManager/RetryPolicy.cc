@@ -0,0 +1,31 @@
+#include "RetryPolicy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace quisp::modules {
+
+using omnetpp::simtime_t;
+
+std::unique_ptr<RetryPolicy> RetryPolicy::create(const std::string &name, simtime_t base_backoff, simtime_t max_backoff) {
+  if (name == "binary_exponential") return std::make_unique<BinaryExponentialBackoff>(base_backoff, max_backoff);
+  if (name == "exponential_with_jitter") return std::make_unique<ExponentialBackoffWithJitter>(base_backoff, max_backoff);
+  if (name == "reservation_aware") return std::make_unique<ReservationAwareRetry>(base_backoff, max_backoff);
+  throw std::invalid_argument("unknown retry policy: " + name);
+}
+
+simtime_t BinaryExponentialBackoff::backoff(int retry_count, omnetpp::cRNG *rng) const {
+  // keep the shift in the range of int, the backoff is capped by max_backoff anyway
+  int upper_bound = (1 << std::min(retry_count, 30)) - 1;
+  int k = omnetpp::intuniform(rng, 0, upper_bound);
+  return std::min(slot * k, max_backoff);
+}
+
+simtime_t ExponentialBackoffWithJitter::backoff(int retry_count, omnetpp::cRNG *rng) const {
+  double window = base_backoff.dbl() * std::pow(2.0, retry_count);
+  window = std::min(window, max_backoff.dbl());
+  return omnetpp::uniform(rng, 0, window);
+}
+
+}  // namespace quisp::modules
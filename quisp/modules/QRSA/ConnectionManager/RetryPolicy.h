@@ -0,0 +1,76 @@
+#pragma once
+
+#include <omnetpp.h>
+#include <memory>
+#include <string>
+
+namespace quisp::modules {
+
+/**
+ * @brief RetryPolicy decides when the initiator retries a rejected connection setup request.
+ */
+class RetryPolicy {
+ public:
+  virtual ~RetryPolicy() {}
+
+  /**
+   * @brief the delay before the retry.
+   *
+   * @param retry_count the number of the retries including this one, starts from 1
+   * @param rng the random number generator of the ConnectionManager
+   */
+  virtual omnetpp::simtime_t backoff(int retry_count, omnetpp::cRNG *rng) const = 0;
+
+  /**
+   * @brief whether the retry is brought forward when the qnic that rejected the request is released.
+   */
+  virtual bool waitsForRelease() const { return false; }
+
+  /**
+   * @brief create the policy by the name used in the ned parameter. throws std::invalid_argument for an unknown name.
+   *
+   * @param name "binary_exponential", "exponential_with_jitter" or "reservation_aware"
+   * @param base_backoff the slot time of the backoff
+   * @param max_backoff the upper bound of the backoff
+   */
+  static std::unique_ptr<RetryPolicy> create(const std::string &name, omnetpp::simtime_t base_backoff, omnetpp::simtime_t max_backoff);
+};
+
+/**
+ * @brief waits a random number of slots in [0, 2^retry_count - 1], so the retries of the initiators are aligned to the slots.
+ */
+class BinaryExponentialBackoff : public RetryPolicy {
+ public:
+  BinaryExponentialBackoff(omnetpp::simtime_t slot, omnetpp::simtime_t max_backoff) : slot(slot), max_backoff(max_backoff) {}
+  omnetpp::simtime_t backoff(int retry_count, omnetpp::cRNG *rng) const override;
+
+ private:
+  omnetpp::simtime_t slot;
+  omnetpp::simtime_t max_backoff;
+};
+
+/**
+ * @brief waits a uniformly random time in [0, min(max_backoff, base_backoff * 2^retry_count)),
+ * so the initiators that were rejected together don't retry at the same time.
+ */
+class ExponentialBackoffWithJitter : public RetryPolicy {
+ public:
+  ExponentialBackoffWithJitter(omnetpp::simtime_t base_backoff, omnetpp::simtime_t max_backoff) : base_backoff(base_backoff), max_backoff(max_backoff) {}
+  omnetpp::simtime_t backoff(int retry_count, omnetpp::cRNG *rng) const override;
+
+ private:
+  omnetpp::simtime_t base_backoff;
+  omnetpp::simtime_t max_backoff;
+};
+
+/**
+ * @brief waits for the release notification of the qnic that rejected the request,
+ * and retries after a jittered exponential backoff if no notification comes.
+ */
+class ReservationAwareRetry : public ExponentialBackoffWithJitter {
+ public:
+  using ExponentialBackoffWithJitter::ExponentialBackoffWithJitter;
+  bool waitsForRelease() const override { return true; }
+};
+
+}  // namespace quisp::modules
@@ -0,0 +1,39 @@
+#include "RetryPolicy.h"
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+#include "test_utils/RNG.h"
+
+namespace {
+using namespace omnetpp;
+using quisp::modules::RetryPolicy;
+using quisp_test::rng::TestRNG;
+
+TEST(RetryPolicyTest, BinaryExponentialBackoff) {
+  auto policy = RetryPolicy::create("binary_exponential", SimTime(50, SIMTIME_US), SimTime(1, SIMTIME_MS));
+  TestRNG rng;
+  rng.intValue = 3;
+  EXPECT_EQ(policy->backoff(2, &rng), SimTime(150, SIMTIME_US));
+  rng.intValue = 100;
+  EXPECT_EQ(policy->backoff(10, &rng), SimTime(1, SIMTIME_MS));
+  EXPECT_FALSE(policy->waitsForRelease());
+}
+
+TEST(RetryPolicyTest, ExponentialBackoffWithJitter) {
+  auto policy = RetryPolicy::create("exponential_with_jitter", SimTime(50, SIMTIME_US), SimTime(1, SIMTIME_MS));
+  TestRNG rng;
+  rng.doubleValue = 0.5;
+  EXPECT_EQ(policy->backoff(2, &rng), SimTime(100, SIMTIME_US));
+  // capped by the max backoff
+  EXPECT_EQ(policy->backoff(10, &rng), SimTime(500, SIMTIME_US));
+  EXPECT_FALSE(policy->waitsForRelease());
+
+  auto reservation_aware = RetryPolicy::create("reservation_aware", SimTime(50, SIMTIME_US), SimTime(1, SIMTIME_MS));
+  EXPECT_TRUE(reservation_aware->waitsForRelease());
+  EXPECT_EQ(reservation_aware->backoff(2, &rng), SimTime(100, SIMTIME_US));
+
+  EXPECT_THROW(RetryPolicy::create("unknown", 0, 0), std::invalid_argument);
+}
+
+}  // namespace
@@ -1,4 +1,7 @@
+#include <algorithm>
+#include <cmath>
 #include <memory>
+#include <stdexcept>
 
 #include "RuleSetGenerator.h"
 #include "rules/Action.h"
@@ -9,71 +12,171 @@ namespace quisp::modules::ruleset_gen {
 
 using namespace quisp::rules;
 
-void RuleSetGenerator::generateReverseSwapAtHalfRuleSets(int left_index, int right_index, std::map<int, std::vector<std::unique_ptr<Rule>>>& rules_map, std::vector<int>& path,
-                                                         int& shared_rule_tag) {
+SwappingTree RuleSetGenerator::parseSwappingTree(const std::string& name) {
+  if (name == "reverse_swap_at_half") return SwappingTree::ReverseSwapAtHalf;
+  if (name == "sequential") return SwappingTree::Sequential;
+  throw std::invalid_argument("unknown swapping tree: " + name);
+}
+
+int RuleSetGenerator::swapperIndex(int left_index, int right_index) const {
+  switch (swapping_tree) {
+    case SwappingTree::Sequential:
+      return right_index - 1;
+    case SwappingTree::ReverseSwapAtHalf:
+    default:
+      return (left_index + right_index) / 2;
+  }
+}
+
+int RuleSetGenerator::numSwappings(int left_index, int right_index) { return std::max(0, right_index - left_index - 1); }
+
+void RuleSetGenerator::generateSwappingRules(int left_index, int right_index, int tag_base, const std::vector<int>& path, std::vector<RuleSet>& rulesets) {
   if (left_index == right_index || left_index + 1 == right_index) return;
-  int swapper_index = (left_index + right_index) / 2;
+  int swapper_index = swapperIndex(left_index, right_index);
 
-  int swapper_addr = path[swapper_index];
-  int left_addr = path[left_index];
-  int right_addr = path[right_index];
-  rules_map[swapper_addr].emplace_back(swapRule({left_addr, right_addr}, ++shared_rule_tag));
-  rules_map[left_addr].emplace_back(swapCorrectionRule(swapper_addr, shared_rule_tag));
-  rules_map[right_addr].emplace_back(swapCorrectionRule(swapper_addr, shared_rule_tag));
+  // the swapping between left and right takes tag_base + 1, the one of the left half follows and then the right half.
+  // the halves are visited first so that each node gets the swappings nearest to it first,
+  // which is the order the node executes them.
+  int shared_rule_tag = tag_base + 1;
+  generateSwappingRules(swapper_index, right_index, shared_rule_tag + numSwappings(left_index, swapper_index), path, rulesets);
+  generateSwappingRules(left_index, swapper_index, shared_rule_tag, path, rulesets);
 
   // if you want to do purification between from and swapper or swapper and to before the swap; do it here.
   // e.g. generatePurificationRule(from, swapper, <protocol>);
   // e.g. generatePurificationRule(swapper, to, <protocol>);
 
-  generateReverseSwapAtHalfRuleSets(left_index, swapper_index, rules_map, path, shared_rule_tag);
-  generateReverseSwapAtHalfRuleSets(swapper_index, right_index, rules_map, path, shared_rule_tag);
+  int swapper_addr = path[swapper_index];
+  int left_addr = path[left_index];
+  int right_addr = path[right_index];
+  rulesets[swapper_index].addRule(swapRule({left_addr, right_addr}, shared_rule_tag));
+  rulesets[left_index].addRule(swapCorrectionRule(swapper_addr, shared_rule_tag));
+  rulesets[right_index].addRule(swapCorrectionRule(swapper_addr, shared_rule_tag));
 };
 
+void RuleSetGenerator::addLinkPurificationRules(RuleSet& ruleset, int link_index, int partner_address, int rounds) {
+  for (int round = 0; round < rounds; round++) {
+    int shared_rule_tag = link_index * link_purification.rounds + round + 1;
+    ruleset.addRule(purifyRule(partner_address, link_purification.type, shared_rule_tag, link_purification.pumping_rounds));
+    ruleset.addRule(purificationCorrelationRule(partner_address, link_purification.type, shared_rule_tag));
+  }
+}
+
+RuleSet RuleSetGenerator::buildLinkRuleSet(unsigned long ruleset_id, int owner_address, int node_index, int left_address, int right_address) {
+  return buildLinkRuleSet(ruleset_id, owner_address, node_index, left_address, right_address, link_purification.rounds, link_purification.rounds);
+}
+
+RuleSet RuleSetGenerator::buildLinkRuleSet(unsigned long ruleset_id, int owner_address, int node_index, int left_address, int right_address, int left_rounds,
+                                           int right_rounds) {
+  RuleSet ruleset(ruleset_id, owner_address);
+  if (left_address != -1) addLinkPurificationRules(ruleset, node_index - 1, left_address, left_rounds);
+  if (right_address != -1) addLinkPurificationRules(ruleset, node_index, right_address, right_rounds);
+  return ruleset;
+}
+
+std::vector<int> RuleSetGenerator::linkPurificationRounds(messages::ConnectionSetupRequest* req) {
+  int num_links = req->getStack_of_QNodeIndexesArraySize();
+  std::vector<int> rounds(num_links, link_purification.rounds);
+  if (link_purification.target_fidelity <= 0 || link_purification.rounds == 0 || req->getStack_of_linkFidelitiesArraySize() != num_links) return rounds;
+  double target_werner_parameter = std::clamp((4 * link_purification.target_fidelity - 1) / 3, 0.0, 1.0);
+  double link_target_fidelity = (3 * std::pow(target_werner_parameter, 1.0 / num_links) + 1) / 4;
+  for (int i = 0; i < num_links; i++) rounds[i] = roundsFor(req->getStack_of_linkFidelities(i), link_target_fidelity);
+  return rounds;
+}
+
+int RuleSetGenerator::roundsFor(double link_fidelity, double target_fidelity) const {
+  // not estimated yet
+  if (link_fidelity <= 0) return link_purification.rounds;
+  double fidelity = link_fidelity;
+  for (int round = 0; round < link_purification.rounds; round++) {
+    if (fidelity >= target_fidelity) return round;
+    // each round pumps the pairs of the previous round into its kept one
+    double fresh_fidelity = fidelity;
+    for (int i = 0; i < link_purification.pumping_rounds; i++) fidelity = purifiedFidelity(fidelity, fresh_fidelity);
+  }
+  return link_purification.rounds;
+}
+
+double RuleSetGenerator::purifiedFidelity(double kept_fidelity, double fresh_fidelity) {
+  double kept_error = (1 - kept_fidelity) / 3;
+  double fresh_error = (1 - fresh_fidelity) / 3;
+  double success = kept_fidelity * fresh_fidelity + kept_fidelity * fresh_error + kept_error * fresh_fidelity + 5 * kept_error * fresh_error;
+  return (kept_fidelity * fresh_fidelity + kept_error * fresh_error) / success;
+}
+
 std::map<int, json> RuleSetGenerator::generateRuleSets(messages::ConnectionSetupRequest* req, unsigned long ruleset_id) {
+  auto rulesets = buildRuleSets(req, ruleset_id);
+  return serializeRuleSets(rulesets);
+}
+
+std::map<int, json> RuleSetGenerator::serializeRuleSets(std::map<int, RuleSet>& rulesets) {
+  std::vector<RuleSet*> targets;
+  targets.reserve(rulesets.size());
+  for (auto& [owner_address, ruleset] : rulesets) targets.push_back(&ruleset);
+
+  std::vector<json> serialized(targets.size());
+  auto serialize = [&](std::size_t i) { serialized[i] = targets[i]->serialize_json(); };
+  if (serialization_pool != nullptr) {
+    serialization_pool->parallelFor(targets.size(), serialize);
+  } else {
+    for (std::size_t i = 0; i < targets.size(); i++) serialize(i);
+  }
+
+  std::map<int, json> serialized_rulesets{};
+  for (std::size_t i = 0; i < targets.size(); i++) {
+    serialized_rulesets.emplace(targets[i]->owner_addr, std::move(serialized[i]));
+  }
+  return serialized_rulesets;
+}
+
+std::map<int, RuleSet> RuleSetGenerator::buildRuleSets(messages::ConnectionSetupRequest* req, unsigned long ruleset_id, bool include_link_rules) {
   // prepare information for RuleSets generation
   auto path = collectPath(req);
-  std::map<int /* node addr */, std::vector<std::unique_ptr<Rule>>> rules_map;
   int num_measure = req->getNum_measure();
-  int shared_rule_tag = 0;
-
-  generateReverseSwapAtHalfRuleSets(0, path.size() - 1, rules_map, path, shared_rule_tag);
-  // if you want to do link-level purification; do it here and add to the back.
-  for (auto& [address, rs] : rules_map) {
-    std::reverse(rs.begin(), rs.end());
+  int last_index = path.size() - 1;
+
+  // the rules are added to the RuleSet of each node directly, in the order the node executes them
+  std::vector<RuleSet> rulesets;
+  rulesets.reserve(path.size());
+  for (int address : path) rulesets.emplace_back(ruleset_id, address);
+
+  // the link-level rules come first, the same as buildLinkRuleSet() of each node
+  if (include_link_rules) {
+    auto link_rounds = linkPurificationRounds(req);
+    for (int i = 0; i <= last_index; i++) {
+      auto link_ruleset = buildLinkRuleSet(ruleset_id, path[i], i, i > 0 ? path[i - 1] : -1, i < last_index ? path[i + 1] : -1, i > 0 ? link_rounds[i - 1] : 0,
+                                           i < last_index ? link_rounds[i] : 0);
+      for (auto& rule : link_ruleset.rules) rulesets[i].addRule(std::move(rule));
+    }
   }
+  int link_tags = last_index * link_purification.rounds;
+  generateSwappingRules(0, last_index, link_tags, path, rulesets);
+  int shared_rule_tag = link_tags + numSwappings(0, last_index);
 
   // // if you want to do e2e purification before tomography do it here
   // int left_addr = path.front();
   // int right_addr = path.back();
-  // rules_map[left_addr].emplace_back(purifyRule(right_addr, PurType::SINGLE_SELECTION_X_PURIFICATION, ++shared_rule_tag));
-  // rules_map[right_addr].emplace_back(purifyRule(left_addr, PurType::SINGLE_SELECTION_X_PURIFICATION, shared_rule_tag));
-  // rules_map[left_addr].emplace_back(purificationCorrelationRule(right_addr, PurType::SINGLE_SELECTION_X_PURIFICATION, shared_rule_tag));
-  // rules_map[right_addr].emplace_back(purificationCorrelationRule(left_addr, PurType::SINGLE_SELECTION_X_PURIFICATION, shared_rule_tag));
+  // rulesets.front().addRule(purifyRule(right_addr, PurType::SINGLE_SELECTION_X_PURIFICATION, ++shared_rule_tag));
+  // rulesets.back().addRule(purifyRule(left_addr, PurType::SINGLE_SELECTION_X_PURIFICATION, shared_rule_tag));
+  // rulesets.front().addRule(purificationCorrelationRule(right_addr, PurType::SINGLE_SELECTION_X_PURIFICATION, shared_rule_tag));
+  // rulesets.back().addRule(purificationCorrelationRule(left_addr, PurType::SINGLE_SELECTION_X_PURIFICATION, shared_rule_tag));
 
-  // rules_map[left_addr].emplace_back(purifyRule(right_addr, PurType::SINGLE_SELECTION_Z_PURIFICATION, ++shared_rule_tag));
-  // rules_map[right_addr].emplace_back(purifyRule(left_addr, PurType::SINGLE_SELECTION_Z_PURIFICATION, shared_rule_tag));
-  // rules_map[left_addr].emplace_back(purificationCorrelationRule(right_addr, PurType::SINGLE_SELECTION_Z_PURIFICATION, shared_rule_tag));
-  // rules_map[right_addr].emplace_back(purificationCorrelationRule(left_addr, PurType::SINGLE_SELECTION_Z_PURIFICATION, shared_rule_tag));
+  // rulesets.front().addRule(purifyRule(right_addr, PurType::SINGLE_SELECTION_Z_PURIFICATION, ++shared_rule_tag));
+  // rulesets.back().addRule(purifyRule(left_addr, PurType::SINGLE_SELECTION_Z_PURIFICATION, shared_rule_tag));
+  // rulesets.front().addRule(purificationCorrelationRule(right_addr, PurType::SINGLE_SELECTION_Z_PURIFICATION, shared_rule_tag));
+  // rulesets.back().addRule(purificationCorrelationRule(left_addr, PurType::SINGLE_SELECTION_Z_PURIFICATION, shared_rule_tag));
 
   // add tomography rules
   auto initiator_addr = path.front();
   ++shared_rule_tag;
-  rules_map[initiator_addr].emplace_back(tomographyRule(responder_addr, initiator_addr, num_measure, shared_rule_tag));
-  rules_map[responder_addr].emplace_back(tomographyRule(initiator_addr, responder_addr, num_measure, shared_rule_tag));
-
-  std::map<int, json> rulesets{};
-  // pack rules into RuleSets and serialize it as json
-  for (auto it = rules_map.begin(); it != rules_map.end(); ++it) {
-    int owner_address = it->first;
-    auto rules = std::move(it->second);
-    RuleSet ruleset(ruleset_id, owner_address);
-    for (int i = 0; i < rules.size(); i++) {
-      auto rule = std::move(rules.at(i));
-      ruleset.addRule(std::move(rule));
-    }
-    rulesets.emplace(owner_address, ruleset.serialize_json());
+  rulesets.front().addRule(tomographyRule(responder_addr, initiator_addr, num_measure, shared_rule_tag));
+  rulesets.back().addRule(tomographyRule(initiator_addr, responder_addr, num_measure, shared_rule_tag));
+
+  std::map<int, RuleSet> ruleset_map{};
+  for (auto& ruleset : rulesets) {
+    int owner_address = ruleset.owner_addr;
+    ruleset_map.emplace(owner_address, std::move(ruleset));
   }
-  return rulesets;
+  return ruleset_map;
 }
 
 std::vector<int> RuleSetGenerator::collectPath(messages::ConnectionSetupRequest* req) {
@@ -106,7 +209,7 @@ std::unique_ptr<Rule> RuleSetGenerator::tomographyRule(int partner_address, int
   return tomography_rule;
 }
 
-std::unique_ptr<Rule> RuleSetGenerator::purifyRule(int partner_address, PurType purification_type, int shared_rule_tag) {
+std::unique_ptr<Rule> RuleSetGenerator::purifyRule(int partner_address, PurType purification_type, int shared_rule_tag, int pumping_rounds) {
   auto purify_rule = std::make_unique<Rule>(partner_address, shared_rule_tag, -1);
   // TODO: add purification protocol to rule name
   purify_rule->setName("purification with " + std::to_string(partner_address));
@@ -127,6 +230,11 @@ std::unique_ptr<Rule> RuleSetGenerator::purifyRule(int partner_address, PurType
   } else {
     throw std::runtime_error("unknown purification type");
   }
+  if (pumping_rounds > 1) {
+    if (!Purification::canPump(purification_type)) throw std::invalid_argument("entanglement pumping needs a single selection purification type");
+    // the kept pair and a fresh pair for each round
+    num_resource = pumping_rounds + 1;
+  }
 
   // prepare condition
   auto condition = std::make_unique<Condition>();
@@ -135,7 +243,7 @@ std::unique_ptr<Rule> RuleSetGenerator::purifyRule(int partner_address, PurType
   purify_rule->setCondition(std::move(condition));
 
   // prepare action
-  auto purify_action = std::make_unique<Purification>(purification_type, partner_address, shared_rule_tag);
+  auto purify_action = std::make_unique<Purification>(purification_type, partner_address, shared_rule_tag, pumping_rounds);
   purify_rule->setAction(std::move(purify_action));
 
   return purify_rule;
@@ -1,17 +1,55 @@
 #pragma once
 #include <map>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include <nlohmann/json.hpp>
 
 #include "messages/classical_messages.h"
 #include "rules/RuleSet.h"
+#include "utils/ThreadPool.h"
 
 namespace quisp::modules::ruleset_gen {
 
+/**
+ * @brief the order of the entanglement swappings along the path.
+ *
+ * ReverseSwapAtHalf: the middle node swaps last, each half is swapped the same way recursively.
+ * Sequential: the nodes swap one after another from the initiator side to the responder side.
+ */
+enum class SwappingTree { ReverseSwapAtHalf, Sequential };
+
+/**
+ * @brief the purification of each link before the swappings: the rounds of the purification type, none by default.
+ *
+ * With pumping_rounds > 1 each round pumps that many fresh pairs into its kept pair in one action and checks them all
+ * with one correlation, so the rounds don't wait for a round trip to the partner per purification (single selection types only).
+ * With a target_fidelity, the links with an estimated fidelity in the request only take the rounds they need for it, see linkPurificationRounds().
+ */
+struct LinkPurification {
+  int rounds = 0;
+  rules::PurType type = rules::PurType::SINGLE_SELECTION_X_PURIFICATION;
+  int pumping_rounds = 1;
+  double target_fidelity = 0;  // the end-to-end fidelity the rounds of the links are chosen for, 0 takes all the rounds on every link
+};
+
 class RuleSetGenerator {
  public:
-  RuleSetGenerator(int responder_addr) : responder_addr(responder_addr) {}
+  /**
+   * @param responder_addr
+   * @param swapping_tree      the order of the entanglement swappings
+   * @param serialization_pool serializes the RuleSets of the nodes in parallel if given
+   * @param link_purification  the purification of each link before the swappings
+   */
+  RuleSetGenerator(int responder_addr, SwappingTree swapping_tree = SwappingTree::ReverseSwapAtHalf, utils::ThreadPool* serialization_pool = nullptr,
+                   LinkPurification link_purification = {})
+      : responder_addr(responder_addr), swapping_tree(swapping_tree), serialization_pool(serialization_pool), link_purification(link_purification) {}
+
+  /**
+   * @brief parse the swapping tree name used in the ned parameter. throws std::invalid_argument for an unknown name.
+   */
+  static SwappingTree parseSwappingTree(const std::string& name);
 
   /**
    * @brief generate RuleSets for the given connection setup request.
@@ -23,16 +61,61 @@ class RuleSetGenerator {
   std::map<int, nlohmann::json> generateRuleSets(messages::ConnectionSetupRequest* req, unsigned long ruleset_id);
 
   /**
-   * @brief generate rules for each node in the path.
+   * @brief generate RuleSets for the given connection setup request without serializing them.
+   *
+   * @param req
+   * @param ruleset_id
+   * @param include_link_rules false to leave out the link-level rules the nodes installed by buildLinkRuleSet() during the setup.
+   *                           the other rules keep their shared rule tags, so the nodes append them to the link-level ones.
+   * @return std::map<int, rules::RuleSet> a map of RuleSets and its node addresses as key
+   */
+  std::map<int, rules::RuleSet> buildRuleSets(messages::ConnectionSetupRequest* req, unsigned long ruleset_id, bool include_link_rules = true);
+
+  /**
+   * @brief build the link-level rules of a node on the path, which only depend on its neighbors on the path.
+   * The node can run them before the rest of the path is known, see buildRuleSets().
+   *
+   * @param ruleset_id    the RuleSet id of the whole connection
+   * @param owner_address
+   * @param node_index    index of the node in the path from initiator to responder
+   * @param left_address  the previous node on the path, -1 for the initiator
+   * @param right_address the next node on the path, -1 for the responder
+   * @return rules::RuleSet the link-level rules, empty without the link purification
+   */
+  rules::RuleSet buildLinkRuleSet(unsigned long ruleset_id, int owner_address, int node_index, int left_address, int right_address);
+
+  /**
+   * @brief the link purification rounds of each link on the path of the request, link_purification.rounds unless it has a target_fidelity.
+   * A link of the fidelity estimated in stack_of_linkFidelities takes the fewest rounds of purifiedFidelity() that reach its share of the target,
+   * the n-th root of the target Werner parameter for n links, as the Werner parameters multiply over the swappings.
+   * The links not estimated yet and those the rounds can't bring there take all the rounds.
+   */
+  std::vector<int> linkPurificationRounds(messages::ConnectionSetupRequest* req);
+
+  /**
+   * @brief the fidelity of the kept Werner pair after purifying it with a fresh one, by the recurrence of BBPSSW.
+   */
+  static double purifiedFidelity(double kept_fidelity, double fresh_fidelity);
+
+  /**
+   * @brief serialize the RuleSets to json, on the serialization pool if the generator has one.
+   *
+   * @param rulesets
+   * @return std::map<int, nlohmann::json> a map of json serialized RuleSets and its node addresses as key
+   */
+  std::map<int, nlohmann::json> serializeRuleSets(std::map<int, rules::RuleSet>& rulesets);
+
+  /**
+   * @brief add the swapping rules between the left and the right node into the RuleSets of the nodes in one traversal.
+   * the rules of each node are added in the order the node executes them, the swappings nearest to the node first.
    *
    * @param left_node_index  index in the path from initiator to responder
    * @param right_node_index index in the path from initiator to responder
-   * @param rules_map        store rules for each node <node_address, vector<Rules>>
+   * @param tag_base         the shared rule tags of the swappings between the nodes start from tag_base + 1
    * @param path             store address from initiator to responder
-   * @param shared_rule_tag
+   * @param rulesets         the RuleSet of each node, in the same order as the path
    */
-  void generateReverseSwapAtHalfRuleSets(int left_node_index, int right_node_index, std::map<int, std::vector<std::unique_ptr<rules::Rule>>>& rules_map, std::vector<int>& path,
-                                         int& shared_rule_tag);
+  void generateSwappingRules(int left_node_index, int right_node_index, int tag_base, const std::vector<int>& path, std::vector<rules::RuleSet>& rulesets);
 
  protected:
   /**
@@ -43,6 +126,33 @@ class RuleSetGenerator {
    */
   std::vector<int> collectPath(messages::ConnectionSetupRequest* req);
 
+  /**
+   * @brief the index of the node that swaps the entanglement between the left and the right node
+   */
+  int swapperIndex(int left_node_index, int right_node_index) const;
+
+  /**
+   * @brief the number of the swappings needed to entangle the left and the right node
+   */
+  static int numSwappings(int left_node_index, int right_node_index);
+
+  /**
+   * @brief add the link purification rules with the partner to the RuleSet.
+   * the rounds of the link_index-th link take the shared rule tags from link_index * link_purification.rounds + 1,
+   * so the links with fewer rounds leave their last tags unused.
+   */
+  void addLinkPurificationRules(rules::RuleSet& ruleset, int link_index, int partner_address, int rounds);
+
+  /**
+   * @brief the link-level rules of buildLinkRuleSet() with the rounds of the left and the right link, at most link_purification.rounds.
+   */
+  rules::RuleSet buildLinkRuleSet(unsigned long ruleset_id, int owner_address, int node_index, int left_address, int right_address, int left_rounds, int right_rounds);
+
+  /**
+   * @brief the rounds of linkPurificationRounds() for a link of the fidelity towards the fidelity of the link.
+   */
+  int roundsFor(double link_fidelity, double target_fidelity) const;
+
   /**
    * @brief create tomography rule
    *
@@ -60,9 +170,10 @@ class RuleSetGenerator {
    * @param partner_address
    * @param purification_type
    * @param shared_rule_tag
+   * @param pumping_rounds    the pairs pumped into the kept pair in the action, see rules::Purification::pumping_rounds
    * @return std::unique_ptr<rules::Rule>
    */
-  std::unique_ptr<rules::Rule> purifyRule(int partner_address, rules::PurType purification_type, int shared_rule_tag);
+  std::unique_ptr<rules::Rule> purifyRule(int partner_address, rules::PurType purification_type, int shared_rule_tag, int pumping_rounds = 1);
 
   /**
    * @brief create rule that waits for purification measurement result and check for its correlation
@@ -93,5 +204,8 @@ class RuleSetGenerator {
   std::unique_ptr<rules::Rule> swapCorrectionRule(int swapper_address, int shared_rule_tag);
 
   int responder_addr;
+  SwappingTree swapping_tree;
+  utils::ThreadPool* serialization_pool;
+  LinkPurification link_purification;
 };
 }  // namespace quisp::modules::ruleset_gen
@@ -1,3 +1,4 @@
+#include <stdexcept>
 #include <utility>
 
 #include <gtest/gtest.h>
@@ -16,6 +17,7 @@ using OriginalRSG = quisp::modules::ruleset_gen::RuleSetGenerator;
 using quisp::modules::NULL_CONNECTION_SETUP_INFO;
 using quisp::modules::QNIC_E;
 using quisp::modules::QNIC_R;
+using quisp::modules::ruleset_gen::SwappingTree;
 
 using namespace quisp::messages;
 using namespace quisp_test::utils;
@@ -23,7 +25,7 @@ using namespace quisp::rules;
 
 class RuleSetGenerator : public OriginalRSG {
  public:
-  RuleSetGenerator(int responder_addr) : OriginalRSG(responder_addr) {}
+  RuleSetGenerator(int responder_addr, SwappingTree swapping_tree = SwappingTree::ReverseSwapAtHalf) : OriginalRSG(responder_addr, swapping_tree) {}
   using OriginalRSG::collectPath;
   using OriginalRSG::purifyRule;
   using OriginalRSG::swapRule;
@@ -42,52 +44,161 @@ class RuleSetGeneratorTest : public testing::Test {
 };
 
 TEST_F(RuleSetGeneratorTest, generateSimpleSwappingRuleSets) {
-  std::map<int, std::vector<std::unique_ptr<Rule>>> rules_map{};
   std::vector<int> path{1, 2, 3, 4, 5};
-  std::map<int, std::pair<int, int>> swapping_partners_table{{2, {1, 3}}, {4, {3, 5}}, {3, {1, 5}}};
-  int shared_rule_tag = 0;
-  int num_measure = 50;
-  rsg->generateReverseSwapAtHalfRuleSets(0, 4, rules_map, path, shared_rule_tag);
-  EXPECT_EQ(rules_map.size(), 5);
-  EXPECT_EQ(rules_map.find(1)->second.size(), 2);
+  std::vector<RuleSet> rulesets;
+  for (int address : path) rulesets.emplace_back(1234, address);
+  rsg->generateSwappingRules(0, 4, 0, path, rulesets);
+
+  // node 3 swaps 1 and 5 (tag 1) after node 2 swaps 1 and 3 (tag 2) and node 4 swaps 3 and 5 (tag 3)
+  EXPECT_EQ(rulesets.at(0).rules.size(), 2);
   {
-    auto &rule = rules_map.find(1)->second.at(0);
+    auto &rule = rulesets.at(0).rules.at(0);
     EXPECT_EQ(rule->qnic_interfaces.size(), 1);
-    EXPECT_EQ(rule->qnic_interfaces.at(0).partner_addr, 3);
+    EXPECT_EQ(rule->qnic_interfaces.at(0).partner_addr, 2);
+    EXPECT_EQ(rule->receive_tag, 2);
+    EXPECT_EQ(rulesets.at(0).rules.at(1)->qnic_interfaces.at(0).partner_addr, 3);
+    EXPECT_EQ(rulesets.at(0).rules.at(1)->receive_tag, 1);
   }
 
-  EXPECT_EQ(rules_map.find(2)->second.size(), 1);
+  EXPECT_EQ(rulesets.at(1).rules.size(), 1);
   {
-    auto &rule = rules_map.find(2)->second.at(0);
+    auto &rule = rulesets.at(1).rules.at(0);
     EXPECT_EQ(rule->qnic_interfaces.size(), 2);
     EXPECT_EQ(rule->qnic_interfaces.at(0).partner_addr, 1);
     EXPECT_EQ(rule->qnic_interfaces.at(1).partner_addr, 3);
+    EXPECT_EQ(rule->send_tag, 2);
   }
 
-  EXPECT_EQ(rules_map.find(3)->second.size(), 3);
+  EXPECT_EQ(rulesets.at(2).rules.size(), 3);
   {
-    auto &rule = rules_map.find(3)->second.at(0);
+    EXPECT_EQ(rulesets.at(2).rules.at(0)->qnic_interfaces.at(0).partner_addr, 4);
+    EXPECT_EQ(rulesets.at(2).rules.at(1)->qnic_interfaces.at(0).partner_addr, 2);
+    auto &rule = rulesets.at(2).rules.at(2);
     EXPECT_EQ(rule->qnic_interfaces.size(), 2);
     EXPECT_EQ(rule->qnic_interfaces.at(0).partner_addr, 1);
     EXPECT_EQ(rule->qnic_interfaces.at(1).partner_addr, 5);
+    EXPECT_EQ(rule->send_tag, 1);
   }
 
-  EXPECT_EQ(rules_map.find(4)->second.size(), 1);
+  EXPECT_EQ(rulesets.at(3).rules.size(), 1);
   {
-    auto &rule = rules_map.find(4)->second.at(0);
+    auto &rule = rulesets.at(3).rules.at(0);
     EXPECT_EQ(rule->qnic_interfaces.size(), 2);
     EXPECT_EQ(rule->qnic_interfaces.at(0).partner_addr, 3);
     EXPECT_EQ(rule->qnic_interfaces.at(1).partner_addr, 5);
+    EXPECT_EQ(rule->send_tag, 3);
   }
 
-  EXPECT_EQ(rules_map.find(5)->second.size(), 2);
+  EXPECT_EQ(rulesets.at(4).rules.size(), 2);
   {
-    auto &rule = rules_map.find(5)->second.at(0);
+    auto &rule = rulesets.at(4).rules.at(0);
     EXPECT_EQ(rule->qnic_interfaces.size(), 1);
-    EXPECT_EQ(rule->qnic_interfaces.at(0).partner_addr, 3);
+    EXPECT_EQ(rule->qnic_interfaces.at(0).partner_addr, 4);
+    EXPECT_EQ(rulesets.at(4).rules.at(1)->qnic_interfaces.at(0).partner_addr, 3);
   }
 }
 
+TEST_F(RuleSetGeneratorTest, generateSequentialSwappingRuleSets) {
+  RuleSetGenerator sequential_rsg{responder_addr, SwappingTree::Sequential};
+  std::vector<int> path{1, 2, 3, 4};
+  std::vector<RuleSet> rulesets;
+  for (int address : path) rulesets.emplace_back(1234, address);
+  sequential_rsg.generateSwappingRules(0, 3, 0, path, rulesets);
+
+  // node 2 swaps 1 and 3 (tag 2), then node 3 swaps 1 and 4 (tag 1)
+  ASSERT_EQ(rulesets.at(1).rules.size(), 1);
+  EXPECT_EQ(rulesets.at(1).rules.at(0)->qnic_interfaces.at(0).partner_addr, 1);
+  EXPECT_EQ(rulesets.at(1).rules.at(0)->qnic_interfaces.at(1).partner_addr, 3);
+  EXPECT_EQ(rulesets.at(1).rules.at(0)->send_tag, 2);
+
+  ASSERT_EQ(rulesets.at(2).rules.size(), 2);
+  EXPECT_EQ(rulesets.at(2).rules.at(0)->qnic_interfaces.at(0).partner_addr, 2);
+  EXPECT_EQ(rulesets.at(2).rules.at(1)->qnic_interfaces.at(0).partner_addr, 1);
+  EXPECT_EQ(rulesets.at(2).rules.at(1)->qnic_interfaces.at(1).partner_addr, 4);
+  EXPECT_EQ(rulesets.at(2).rules.at(1)->send_tag, 1);
+
+  ASSERT_EQ(rulesets.at(0).rules.size(), 2);
+  EXPECT_EQ(rulesets.at(0).rules.at(0)->qnic_interfaces.at(0).partner_addr, 2);
+  EXPECT_EQ(rulesets.at(0).rules.at(1)->qnic_interfaces.at(0).partner_addr, 3);
+  ASSERT_EQ(rulesets.at(3).rules.size(), 1);
+  EXPECT_EQ(rulesets.at(3).rules.at(0)->qnic_interfaces.at(0).partner_addr, 3);
+
+  EXPECT_EQ(OriginalRSG::parseSwappingTree("sequential"), SwappingTree::Sequential);
+  EXPECT_THROW(OriginalRSG::parseSwappingTree("unknown"), std::invalid_argument);
+}
+
+TEST_F(RuleSetGeneratorTest, LinkPurificationRuleSets) {
+  OriginalRSG purifying_rsg{responder_addr, SwappingTree::ReverseSwapAtHalf, nullptr, {.rounds = 1, .type = PurType::SINGLE_SELECTION_X_PURIFICATION}};
+  // [QNode2] -- [QNode3] -- [QNode4] -- [QNode5(responder)]
+  auto *req = new ConnectionSetupRequest();
+  req->setActual_destAddr(5);
+  req->setActual_srcAddr(2);
+  req->setStack_of_QNodeIndexesArraySize(3);
+  req->setStack_of_QNodeIndexes(0, 2);
+  req->setStack_of_QNodeIndexes(1, 3);
+  req->setStack_of_QNodeIndexes(2, 4);
+  auto rulesets = purifying_rsg.buildRuleSets(req, 1234);
+
+  // QNode3 purifies the link to QNode2 (tag 1) and the one to QNode4 (tag 2) before the swappings, which start from tag 4
+  auto &node3_rules = rulesets.at(3).rules;
+  ASSERT_EQ(node3_rules.size(), 6);
+  EXPECT_EQ(node3_rules.at(0)->qnic_interfaces.at(0).partner_addr, 2);
+  EXPECT_EQ(node3_rules.at(0)->send_tag, 1);
+  EXPECT_EQ(node3_rules.at(1)->receive_tag, 1);
+  EXPECT_EQ(node3_rules.at(2)->qnic_interfaces.at(0).partner_addr, 4);
+  EXPECT_EQ(node3_rules.at(2)->send_tag, 2);
+  EXPECT_EQ(node3_rules.at(3)->receive_tag, 2);
+  EXPECT_EQ(node3_rules.at(5)->send_tag, 4);
+  // the other ends of the links have the same tags
+  EXPECT_EQ(rulesets.at(2).rules.at(0)->send_tag, 1);
+  EXPECT_EQ(rulesets.at(4).rules.at(0)->send_tag, 2);
+  EXPECT_EQ(rulesets.at(5).rules.at(0)->send_tag, 3);
+
+  // the link-level RuleSet of QNode3 is the beginning of its RuleSet, and the rest keeps its tags
+  auto link_ruleset = purifying_rsg.buildLinkRuleSet(1234, 3, 1, 2, 4);
+  ASSERT_EQ(link_ruleset.rules.size(), 4);
+  for (int i = 0; i < 4; i++) EXPECT_EQ(link_ruleset.rules.at(i)->serialize_json(), node3_rules.at(i)->serialize_json());
+  auto tails = purifying_rsg.buildRuleSets(req, 1234, false);
+  ASSERT_EQ(tails.at(3).rules.size(), 2);
+  EXPECT_EQ(tails.at(3).rules.at(1)->serialize_json(), node3_rules.at(5)->serialize_json());
+
+  // without link purification there are no link-level rules
+  EXPECT_TRUE(rsg->buildLinkRuleSet(1234, 3, 1, 2, 4).rules.empty());
+  delete req;
+}
+
+TEST_F(RuleSetGeneratorTest, AdaptiveLinkPurificationRounds) {
+  EXPECT_NEAR(OriginalRSG::purifiedFidelity(0.85, 0.85), 0.725 / 0.82, 1e-9);
+  OriginalRSG adaptive_rsg{responder_addr, SwappingTree::ReverseSwapAtHalf, nullptr, {.rounds = 2, .type = PurType::SINGLE_SELECTION_X_PURIFICATION, .target_fidelity = 0.8}};
+  // [QNode2] -(0.99)- [QNode3] -(0.91)- [QNode4] -(not estimated)- [QNode5(responder)]
+  auto *req = new ConnectionSetupRequest();
+  req->setActual_destAddr(5);
+  req->setActual_srcAddr(2);
+  req->setStack_of_QNodeIndexesArraySize(3);
+  req->setStack_of_QNodeIndexes(0, 2);
+  req->setStack_of_QNodeIndexes(1, 3);
+  req->setStack_of_QNodeIndexes(2, 4);
+  req->setStack_of_linkFidelitiesArraySize(3);
+  req->setStack_of_linkFidelities(0, 0.99);
+  req->setStack_of_linkFidelities(1, 0.91);
+  req->setStack_of_linkFidelities(2, 0);
+
+  // each link needs about 0.926 for 0.8 over the three links
+  EXPECT_EQ(adaptive_rsg.linkPurificationRounds(req), (std::vector<int>{0, 1, 2}));
+  auto rulesets = adaptive_rsg.buildRuleSets(req, 1234);
+  // QNode3 only purifies the link to QNode4, with the tag of the first round of the second link
+  auto &node3_rules = rulesets.at(3).rules;
+  EXPECT_EQ(node3_rules.at(0)->qnic_interfaces.at(0).partner_addr, 4);
+  EXPECT_EQ(node3_rules.at(0)->send_tag, 3);
+  EXPECT_EQ(rulesets.at(5).rules.at(0)->send_tag, 5);
+  EXPECT_EQ(rulesets.at(5).rules.at(2)->send_tag, 6);
+
+  // without the target every link takes all the rounds
+  OriginalRSG purifying_rsg{responder_addr, SwappingTree::ReverseSwapAtHalf, nullptr, {.rounds = 2, .type = PurType::SINGLE_SELECTION_X_PURIFICATION}};
+  EXPECT_EQ(purifying_rsg.linkPurificationRounds(req), (std::vector<int>{2, 2, 2}));
+  delete req;
+}
+
 TEST_F(RuleSetGeneratorTest, Simple) {
   auto *req = new ConnectionSetupRequest();
   // qnic_index(id)     11       12           13       14           15       16
@@ -239,6 +350,19 @@ TEST_F(RuleSetGeneratorTest, PurificationRule) {
   EXPECT_EQ(serialized, expected);
 }
 
+TEST_F(RuleSetGeneratorTest, PumpingPurificationRule) {
+  auto purification_rule = rsg->purifyRule(1, PurType::SINGLE_SELECTION_XZ_PURIFICATION, 15, 3);
+  auto serialized = purification_rule->serialize_json();
+  // the kept pair and a fresh pair for each round
+  EXPECT_EQ(serialized["condition"]["clauses"][0]["options"]["num_resource"], 4);
+  EXPECT_EQ(serialized["action"]["options"]["pumping_rounds"], 3);
+  Purification deserialized{serialized["action"]};
+  EXPECT_EQ(deserialized.pumping_rounds, 3);
+  // the plain purification has no pumping rounds in its json
+  EXPECT_EQ(Purification{rsg->purifyRule(1, PurType::SINGLE_SELECTION_XZ_PURIFICATION, 15)->serialize_json()["action"]}.pumping_rounds, 1);
+  EXPECT_THROW(rsg->purifyRule(1, PurType::DOUBLE_SELECTION_X_PURIFICATION, 15, 3), std::invalid_argument);
+}
+
 TEST_F(RuleSetGeneratorTest, SwapRule) {
   // rule arguments
   std::pair<int, int> partner_addr{1, 3};
@@ -0,0 +1,47 @@
+#include "RuleSetTemplateCache.h"
+
+#include <stdexcept>
+
+namespace quisp::modules {
+
+RuleSetTemplateCache::RuleSetTemplateCache(std::size_t capacity) : capacity(capacity) {
+  if (capacity == 0) throw std::invalid_argument("RuleSetTemplateCache: the capacity must be positive");
+}
+
+std::optional<RuleSetTemplateCache::RuleSets> RuleSetTemplateCache::instantiate(const Key& key, unsigned long ruleset_id) {
+  auto it = index.find(key);
+  if (it == index.end()) {
+    num_misses++;
+    return std::nullopt;
+  }
+  num_hits++;
+  entries.splice(entries.begin(), entries, it->second);
+
+  RuleSets rulesets;
+  for (auto& [owner_address, node_ruleset] : it->second->second) {
+    auto compiled = std::make_shared<runtime::RuleSet>(*node_ruleset.compiled);
+    compiled->id = ruleset_id;
+    auto& instance = rulesets[owner_address];
+    instance.serialized = node_ruleset.serialized;
+    instance.serialized["ruleset_id"] = ruleset_id;
+    instance.compiled = std::move(compiled);
+  }
+  return rulesets;
+}
+
+void RuleSetTemplateCache::insert(const Key& key, const RuleSets& rulesets) {
+  auto it = index.find(key);
+  if (it != index.end()) {
+    it->second->second = rulesets;
+    entries.splice(entries.begin(), entries, it->second);
+    return;
+  }
+  if (entries.size() == capacity) {
+    index.erase(entries.back().first);
+    entries.pop_back();
+  }
+  entries.emplace_front(key, rulesets);
+  index.emplace(key, entries.begin());
+}
+
+}  // namespace quisp::modules
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "runtime/RuleSet.h"
+
+namespace quisp::modules {
+
+/**
+ * @brief RuleSetTemplateCache keeps the RuleSets the responder generated for the recent paths, least recently used first out.
+ *
+ * The rules and their shared rule tags only depend on the path and the request parameters, so a template is
+ * the RuleSets of a connection without its RuleSet id. A hit patches the id into a copy, skipping the generation,
+ * the serialization and the compilation of the RuleSets.
+ */
+class RuleSetTemplateCache {
+ public:
+  /// @brief the path from the initiator to the responder, the link purification rounds of its links, num_measure, and whether the link-level rules are included
+  using Key = std::tuple<std::vector<int>, std::vector<int>, int, bool>;
+
+  struct NodeRuleSet {
+    nlohmann::json serialized;
+    std::shared_ptr<const runtime::RuleSet> compiled;
+  };
+  /// @brief the RuleSets by the owner address
+  using RuleSets = std::map<int, NodeRuleSet>;
+
+  /// @param capacity the number of the templates kept, must be positive
+  explicit RuleSetTemplateCache(std::size_t capacity);
+
+  /// @brief returns a copy of the cached RuleSets with the RuleSet id, or nullopt if the key is not cached.
+  std::optional<RuleSets> instantiate(const Key& key, unsigned long ruleset_id);
+
+  /// @brief caches the RuleSets as the template of the key, evicting the least recently used one if it's full.
+  void insert(const Key& key, const RuleSets& rulesets);
+
+  std::size_t size() const { return entries.size(); }
+  std::size_t hits() const { return num_hits; }
+  std::size_t misses() const { return num_misses; }
+  double hitRate() const { return num_hits + num_misses > 0 ? (double)num_hits / (num_hits + num_misses) : 0; }
+
+ private:
+  std::size_t capacity;
+  // the most recently used first
+  std::list<std::pair<Key, RuleSets>> entries;
+  std::map<Key, std::list<std::pair<Key, RuleSets>>::iterator> index;
+  std::size_t num_hits = 0;
+  std::size_t num_misses = 0;
+};
+
+}  // namespace quisp::modules
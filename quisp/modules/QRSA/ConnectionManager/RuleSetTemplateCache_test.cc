@@ -0,0 +1,71 @@
+#include "RuleSetTemplateCache.h"
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+using quisp::modules::RuleSetTemplateCache;
+
+RuleSetTemplateCache::RuleSets createRuleSets(unsigned long ruleset_id, std::vector<int> path) {
+  RuleSetTemplateCache::RuleSets rulesets;
+  for (int owner_address : path) {
+    auto compiled = std::make_shared<quisp::runtime::RuleSet>("ruleset of " + std::to_string(owner_address));
+    compiled->id = ruleset_id;
+    compiled->owner_addr = owner_address;
+    rulesets[owner_address] = {{{"ruleset_id", ruleset_id}, {"owner_address", owner_address}}, compiled};
+  }
+  return rulesets;
+}
+
+TEST(RuleSetTemplateCacheTest, InstantiateWithRuleSetId) {
+  RuleSetTemplateCache cache{2};
+  RuleSetTemplateCache::Key key{{1, 2, 3}, {}, 100, true};
+  EXPECT_FALSE(cache.instantiate(key, 10).has_value());
+  cache.insert(key, createRuleSets(10, {1, 2, 3}));
+
+  auto rulesets = cache.instantiate(key, 20);
+  ASSERT_TRUE(rulesets.has_value());
+  ASSERT_EQ(rulesets->size(), 3);
+  auto &node2 = rulesets->at(2);
+  EXPECT_EQ(node2.serialized["ruleset_id"], 20);
+  EXPECT_EQ(node2.serialized["owner_address"], 2);
+  EXPECT_EQ(node2.compiled->id, 20);
+  EXPECT_EQ(node2.compiled->owner_addr, 2);
+  EXPECT_EQ(node2.compiled->name, "ruleset of 2");
+
+  // the template keeps its id
+  EXPECT_EQ(cache.instantiate(key, 30)->at(2).compiled->id, 30);
+  EXPECT_EQ(cache.hits(), 2);
+  EXPECT_EQ(cache.misses(), 1);
+  EXPECT_DOUBLE_EQ(cache.hitRate(), 2.0 / 3);
+
+  // the other parameters are other templates
+  EXPECT_FALSE(cache.instantiate({{1, 2, 3}, {}, 200, true}, 40).has_value());
+  EXPECT_FALSE(cache.instantiate({{1, 2, 3}, {}, 100, false}, 40).has_value());
+  EXPECT_FALSE(cache.instantiate({{1, 4, 3}, {}, 100, true}, 40).has_value());
+  EXPECT_FALSE(cache.instantiate({{1, 2, 3}, {1, 0}, 100, true}, 40).has_value());
+}
+
+TEST(RuleSetTemplateCacheTest, EvictLeastRecentlyUsed) {
+  RuleSetTemplateCache cache{2};
+  RuleSetTemplateCache::Key key1{{1, 2}, {}, 100, true}, key2{{1, 3}, {}, 100, true}, key3{{1, 4}, {}, 100, true};
+  cache.insert(key1, createRuleSets(10, {1, 2}));
+  cache.insert(key2, createRuleSets(11, {1, 3}));
+  // key1 is used after key2
+  EXPECT_TRUE(cache.instantiate(key1, 20).has_value());
+  cache.insert(key3, createRuleSets(12, {1, 4}));
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_TRUE(cache.instantiate(key1, 21).has_value());
+  EXPECT_FALSE(cache.instantiate(key2, 22).has_value());
+  EXPECT_TRUE(cache.instantiate(key3, 23).has_value());
+
+  // inserting a cached key replaces its template
+  cache.insert(key1, createRuleSets(13, {1, 5}));
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(cache.instantiate(key1, 24)->count(5), 1);
+
+  EXPECT_THROW(RuleSetTemplateCache{0}, std::invalid_argument);
+}
+
+}  // namespace
@@ -4,21 +4,24 @@
  */
 #include "HardwareMonitor.h"
 
-#include <fstream>
 #include <iostream>
 #include <memory>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 #include <omnetpp/cexception.h>
-#include <unsupported/Eigen/KroneckerProduct>
 #include <unsupported/Eigen/MatrixFunctions>
 
 #include "messages/classical_messages.h"
+#include "modules/Common/Router.h"
 #include "modules/PhysicalConnection/BSA/BSAController.h"
 #include "modules/PhysicalConnection/BSA/BellStateAnalyzer.h"
 #include "modules/PhysicalConnection/EPPS/EPPSController.h"
 #include "rules/RuleSet.h"
+#include "utils/Headless.h"
+#include "utils/MemoryUsage.h"
 
 using namespace quisp::messages;
 using namespace quisp::rules;
@@ -28,18 +31,14 @@ using Eigen::Vector4cd;
 namespace quisp::modules {
 
 HardwareMonitor::HardwareMonitor() : provider(utils::ComponentProvider{this}) {}
-HardwareMonitor::~HardwareMonitor() {}
+HardwareMonitor::~HardwareMonitor() { cancelAndDelete(link_cost_estimation_timer); }
 
 // HardwareMonitor is also responsible for calculating the rssi/oka's protocol/fidelity calculate and give it to the RoutingDaemon
 void HardwareMonitor::initialize(int stage) {
+  event_profiler = provider.getEventProfiler();
   EV_INFO << "HardwareMonitor booted\n";
   routing_daemon = provider.getRoutingDaemon();
 
-  Pauli.X << 0, 1, 1, 0;
-  Pauli.Y << 0, std::complex<double>(0, -1), std::complex<double>(0, 1), 0;
-  Pauli.Z << 1, 0, 0, -1;
-  Pauli.I << 1, 0, 0, 1;
-
   num_qnic_rp = par("number_of_qnics_rp");
   num_qnic_r = par("number_of_qnics_r");
   num_qnic = par("number_of_qnics");
@@ -49,7 +48,7 @@ void HardwareMonitor::initialize(int stage) {
 
   /* This is used to keep your own tomography data, and also to match and store the received partner's tomography data */
   // Assumes link tomography only between neighbors.
-  temporal_tomography_output = new TomographyOutcomeTable[num_qnic_total];
+  tomography_accumulators = new TomographyAccumulatorTable[num_qnic_total];
   tomography_runningtime_holder = new LinkCostMap[num_qnic_total];
 
   /*This keeps which node is connected to which local qnic.*/
@@ -63,14 +62,22 @@ void HardwareMonitor::initialize(int stage) {
   Z_Purification = par("z_purification");
   purification_type = par("purification_type").stdstringValue();
   num_measure = par("num_measure");
+  link_cost_estimation_interval = par("link_cost_estimation_interval").doubleValue();
+  tomography_target_precision = par("tomography_target_precision").doubleValue();
+  tomography_confidence_z = par("tomography_confidence_z").doubleValue();
+  tomography_min_measurements = par("tomography_min_measurements").intValue();
+  connection_tomography_target_precision = par("connection_tomography_target_precision").doubleValue();
   my_address = provider.getNodeAddr();
 
   if (stage == 0) {
+    if (auto *memory_accounting = provider.getMemoryAccounting()) {
+      memory_accounting->addReporter([this](modules::SharedResource::MemoryAccounting::Usage &usage) { reportMemoryUsage(usage); });
+    }
     return;
   }
 
   prepareNeighborTable();
-  WATCH_MAP(neighbor_table);
+  if (utils::showsGUI(this)) WATCH_MAP(neighbor_table);
 
   if (do_link_level_tomography) {
     for (auto it = neighbor_table.cbegin(); it != neighbor_table.cend(); ++it) {
@@ -85,7 +92,30 @@ void HardwareMonitor::initialize(int stage) {
         send(pk, "RouterPort$o");
       }
     }
+    if (link_cost_estimation_interval > 0 && !neighbor_table.empty()) {
+      link_cost_estimation_timer = new cMessage("LinkCostEstimation");
+      scheduleAt(simTime() + link_cost_estimation_interval, link_cost_estimation_timer);
+    }
+  }
+}
+
+void HardwareMonitor::reportMemoryUsage(modules::SharedResource::MemoryAccounting::Usage &usage) const {
+  modules::SharedResource::MemoryAccounting::Footprint tomography;
+  for (int i = 0; i < num_qnic_total; i++) {
+    tomography.objects += tomography_accumulators[i].size() + tomography_runningtime_holder[i].size();
+    tomography.bytes += utils::heapBytesOf(tomography_accumulators[i]) + utils::heapBytesOf(tomography_runningtime_holder[i]);
+    for (auto &[partner_address, accumulator] : tomography_accumulators[i]) {
+      tomography.objects += accumulator.pendingSize();
+      tomography.bytes += accumulator.allocatedBytes();
+    }
   }
+  tomography.objects += link_estimates.size() + sequential_tomographies.size() + connection_tomographies.size();
+  tomography.bytes += utils::heapBytesOf(link_estimates) + utils::heapBytesOf(sequential_tomographies) + utils::heapBytesOf(connection_tomographies);
+  for (auto &[ruleset_id, connection] : connection_tomographies) {
+    tomography.objects += connection.accumulator.pendingSize();
+    tomography.bytes += connection.accumulator.allocatedBytes();
+  }
+  usage["tomography"] += tomography;
 }
 
 unsigned long HardwareMonitor::createUniqueId() {
@@ -100,17 +130,22 @@ unsigned long HardwareMonitor::createUniqueId() {
   return ruleset_id;
 }
 
-std::unique_ptr<InterfaceInfo> HardwareMonitor::findInterfaceByNeighborAddr(int neighbor_address) {
-  for (auto it = neighbor_table.cbegin(); it != neighbor_table.cend(); ++it) {
-    if (it->second.neighborQNode_address == neighbor_address) {
-      // return unique_ptr<InterfaceInfo>(new InterfaceInfo(it->second));
-      return std::make_unique<InterfaceInfo>(it->second);
-    }
-  }
-  return nullptr;
+const InterfaceInfo *HardwareMonitor::findInterfaceByNeighborAddr(int neighbor_address) {
+  auto *qnic_address = qnic_addr_by_neighbor_addr.find(neighbor_address);
+  if (qnic_address == nullptr) return nullptr;
+  return interfaces_by_qnic_addr.find(*qnic_address);
 }
 
+const InterfaceInfo *HardwareMonitor::findInterfaceByQnicAddr(int qnic_address) const { return interfaces_by_qnic_addr.find(qnic_address); }
+
 void HardwareMonitor::handleMessage(cMessage *msg) {
+  modules::SharedResource::EventProfiler::Scope profile(event_profiler, this, msg);
+  if (msg == link_cost_estimation_timer) {
+    // stop estimating once every link finished the tomography, so that the timer doesn't keep the simulation running
+    if (estimateLinkCosts()) scheduleAt(simTime() + link_cost_estimation_interval, link_cost_estimation_timer);
+    return;
+  }
+
   if (auto *request = dynamic_cast<LinkTomographyRequest *>(msg)) {
     /* Received a tomography request from neighbor */
 
@@ -150,6 +185,7 @@ void HardwareMonitor::handleMessage(cMessage *msg) {
     QNIC_type partner_qnic_type = ack->getQnic_type();
     int partner_qnic_index = ack->getQnic_index();
     sendLinkTomographyRuleSet(partner_address, my_address, partner_qnic_type, partner_qnic_index, RuleSet_id);
+    if (tomography_target_precision > 0) sequential_tomographies[partner_address] = SequentialTomography{static_cast<unsigned long>(RuleSet_id), simTime()};
     delete ack;
     return;
   }
@@ -157,66 +193,16 @@ void HardwareMonitor::handleMessage(cMessage *msg) {
   if (auto *result = dynamic_cast<LinkTomographyResult *>(msg)) {
     /*Link tomography measurement result/basis from neighbor received.*/
     int partner_addr = result->getPartner_address();
-    // Get QNIC info from neighbor address.
-    int qnic_addr_to_partner = routing_daemon->findQNicAddrByDestAddr(partner_addr);
-    auto local_qnic_info = findConnectionInfoByQnicAddr(qnic_addr_to_partner);
-    if (local_qnic_info == nullptr) {
-      error("local qnic info should not be null");
-    }
-    InterfaceInfo inter_info = getQnicInterfaceByQnicAddr(local_qnic_info->qnic.index, local_qnic_info->qnic.type);
-    QNIC local_qnic = inter_info.qnic;
+    QNIC local_qnic = findLocalQnicByPartnerAddr(partner_addr);
 
     // 1. find partner
-    auto partner_outputs_iter = temporal_tomography_output[local_qnic.address].find(partner_addr);
-    if (partner_outputs_iter != temporal_tomography_output[local_qnic.address].end()) {
-      // partner info found in this output
-      auto partner_output_iter = temporal_tomography_output[local_qnic.address][partner_addr].find(result->getCount_id());
-      if (partner_output_iter != temporal_tomography_output[local_qnic.address][partner_addr].end()) {
-        EV << "Tomography data already found. Updating with result from partner\n";
-        TomographyOutcome temp = partner_output_iter->second;
-        if (result->getSrcAddr() == my_address) {
-          temp.my_basis = result->getBasis();
-          temp.my_output_is_plus = result->getOutput_is_plus();
-          temp.my_GOD_clean = result->getGOD_clean();
-        } else {
-          temp.partner_basis = result->getBasis();
-          temp.partner_output_is_plus = result->getOutput_is_plus();
-          temp.partner_GOD_clean = result->getGOD_clean();
-        }
-        partner_output_iter->second = temp;
-      } else {
-        EV << "Fresh tomography data with partner :" << partner_addr << "\n";
-        TomographyOutcome temp;
-        if (result->getSrcAddr() == my_address) {
-          temp.my_basis = result->getBasis();
-          temp.my_output_is_plus = result->getOutput_is_plus();
-          temp.my_GOD_clean = result->getGOD_clean();
-        } else {
-          temp.partner_basis = result->getBasis();
-          temp.partner_output_is_plus = result->getOutput_is_plus();
-          temp.partner_GOD_clean = result->getGOD_clean();
-        }
-        temporal_tomography_output[local_qnic.address][partner_addr].insert(std::make_pair(result->getCount_id(), temp));
-      }
-    } else {
+    auto &accumulators = tomography_accumulators[local_qnic.address];
+    auto accumulator_iter = accumulators.find(partner_addr);
+    if (accumulator_iter == accumulators.end()) {
       // no partner info found in this output
       EV << "No partner information found with partner: " << partner_addr << "\n";
-      TomographyOutcome temp;
-      if (result->getSrcAddr() == my_address) {
-        temp.my_basis = result->getBasis();
-        temp.my_output_is_plus = result->getOutput_is_plus();
-        temp.my_GOD_clean = result->getGOD_clean();
-      } else {
-        temp.partner_basis = result->getBasis();
-        temp.partner_output_is_plus = result->getOutput_is_plus();
-        temp.partner_GOD_clean = result->getGOD_clean();
-      }
       // If this partner is new, then initialize tables
-      std::map<int, TomographyOutcome> temp_result;
-      temp_result.insert(std::make_pair(result->getCount_id(), temp));
-      /* temporal_tomography_output is filled in, those data are summarized into basis based measurement outcome table.
-       * This accumulates the number of ++, +-, -+ and -- for each basis combination.*/
-      temporal_tomography_output[local_qnic.address].insert(std::make_pair(partner_addr, temp_result));
+      accumulator_iter = accumulators.emplace(partner_addr, tomography::TomographyAccumulator{}).first;
       // NOTE: if you do buffer based multiplex and tomogrpahy need hack here
       qnic_partner_map.insert(std::make_pair(local_qnic.address, partner_addr));
 
@@ -226,6 +212,40 @@ void HardwareMonitor::handleMessage(cMessage *msg) {
       temp_cost.tomography_measurements = -1;
       temp_cost.tomography_time = -1;
       tomography_runningtime_holder[local_qnic.address].insert(std::make_pair(partner_addr, temp_cost));
+
+      if (link_cost_estimation_timer != nullptr) {
+        auto &estimate = link_estimates[local_qnic.address];
+        estimate.first_measured_at = simTime();
+        estimate.fidelity_signal = registerLinkSignal("linkFidelity", partner_addr);
+        estimate.bellpair_per_sec_signal = registerLinkSignal("linkBellPairPerSec", partner_addr);
+        estimate.cost_signal = registerLinkSignal("linkCost", partner_addr);
+      }
+    }
+    /* The first half of the outcome waits for the other half with the same count_id,
+     * and then the pair is summarized into the number of ++, +-, -+ and -- for each basis combination.*/
+    tomography::MeasurementHalf half{result->getBasis(), result->getOutput_is_plus(), result->getGOD_clean()};
+    try {
+      if (accumulator_iter->second.addMeasurement(result->getCount_id(), result->getSrcAddr() == my_address, half)) {
+        EV_DEBUG << "Tomography outcome " << result->getCount_id() << " with partner " << partner_addr << " completed\n";
+        auto sequential = sequential_tomographies.find(partner_addr);
+        if (sequential != sequential_tomographies.end() && isPreciseEnough(accumulator_iter->second, tomography_target_precision)) {
+          simtime_t finish = simTime() - sequential->second.started_at;
+          int measurements = accumulator_iter->second.getTotalMeasurements();
+          LinkTomographyStop *pk = new LinkTomographyStop("LinkTomographyStop");
+          pk->setSrcAddr(my_address);
+          pk->setDestAddr(partner_addr);
+          pk->setKind(6);
+          pk->setRuleset_id(sequential->second.ruleset_id);
+          pk->setFinish(finish);
+          pk->setMeasurements(measurements);
+          send(pk, "RouterPort$o");
+          stopLinkTomography(local_qnic.address, partner_addr, sequential->second.ruleset_id, finish, measurements);
+          sequential_tomographies.erase(sequential);
+        }
+      }
+      if (connection_tomography_target_precision > 0 && findInterfaceByNeighborAddr(partner_addr) == nullptr) addConnectionTomographyOutcome(result, half);
+    } catch (const std::invalid_argument &e) {
+      error("Basis combination for tomography with partner: %d at %d is not found: %s", partner_addr, local_qnic.address, e.what());
     }
 
     if (result->getFinish() != -1) {
@@ -241,16 +261,146 @@ void HardwareMonitor::handleMessage(cMessage *msg) {
         pk->setQnic_address(local_qnic.address);
         pk->setDestAddr(my_address);
         pk->setSrcAddr(my_address);
-        send(pk, "RouterPort$o");
+        sendToRouter(this, pk);
       }
     }
     delete result;
     return;
   }
+
+  // the link is routed around while its satellite is out of view
+  if (auto *visibility = dynamic_cast<QuantumLinkVisibility *>(msg)) {
+    setQuantumLinkState(visibility->getNeighbor_address(), visibility->getVisible());
+    delete visibility;
+    return;
+  }
+
+  if (auto *stop = dynamic_cast<LinkTomographyStop *>(msg)) {
+    QNIC local_qnic = findLocalQnicByPartnerAddr(stop->getSrcAddr());
+    stopLinkTomography(local_qnic.address, stop->getSrcAddr(), stop->getRuleset_id(), stop->getFinish(), stop->getMeasurements());
+    delete stop;
+    return;
+  }
+}
+
+/**
+ * The neighbor table keeps the interface with the link state. The shared topology recomputes only the next hops
+ * through the link, and the RuleEngine terminates only the RuleSets with the neighbor or with qubits of the qnic.
+ * The Bell pairs already made stay, the link just isn't routed through while it's down.
+ */
+void HardwareMonitor::setQuantumLinkState(int neighbor_address, bool up) {
+  auto *qnic_address = qnic_addr_by_neighbor_addr.find(neighbor_address);
+  if (qnic_address == nullptr) error("no quantum link to the neighbor %d", neighbor_address);
+  auto interface = *interfaces_by_qnic_addr.find(*qnic_address);
+  if (interface.link_up == up) return;
+  interface.link_up = up;
+  interfaces_by_qnic_addr.set(interface.qnic.address, interface);
+  for (auto &[_, inf] : neighbor_table) {
+    if (inf.qnic.address == interface.qnic.address) inf.link_up = up;
+  }
+  EV_INFO << "Quantum link to " << neighbor_address << " is " << (up ? "up" : "down") << "\n";
+
+  cModule *neighbor_node = getQNodeWithAddress(neighbor_address);
+  if (neighbor_node != nullptr) provider.setQuantumLinkEnabled(neighbor_node, up);
+  if (up) return;
+
+  QuantumLinkDown *pk = new QuantumLinkDown("QuantumLinkDown");
+  pk->setSrcAddr(my_address);
+  pk->setDestAddr(my_address);
+  pk->setQnic_index(interface.qnic.index);
+  pk->setQnic_type(interface.qnic.type);
+  pk->setNeighbor_address(neighbor_address);
+  send(pk, "RouterPort$o");
+}
+
+// the rate of the finished or stopped tomography with the neighbor of the qnic, the running one hasn't recorded it yet
+double HardwareMonitor::getLinkPairRate(int qnic_address) {
+  auto *info = connection_infos_by_qnic_addr.find(qnic_address);
+  if (info == nullptr || qnic_address >= num_qnic_total) return 0;
+  auto &link_costs = tomography_runningtime_holder[qnic_address];
+  auto it = link_costs.find(info->neighbor_address);
+  if (it == link_costs.end() || it->second.tomography_time < 0) return 0;
+  return it->second.Bellpair_per_sec;
+}
+
+// only the links estimated online during the tomography have it, with link_cost_estimation_interval
+double HardwareMonitor::getLinkFidelity(int qnic_address) {
+  auto it = link_estimates.find(qnic_address);
+  if (it == link_estimates.end()) return 0;
+  return it->second.fidelity;
+}
+
+// the link tomography partners are the neighbors, so the neighbor table knows the qnic without the routing table.
+// the end-to-end tomography partners are found by the routing table
+QNIC HardwareMonitor::findLocalQnicByPartnerAddr(int partner_address) {
+  if (auto *local_interface = findInterfaceByNeighborAddr(partner_address)) return local_interface->qnic;
+  auto *local_qnic_info = findConnectionInfoByQnicAddr(routing_daemon->findQNicAddrByDestAddr(partner_address));
+  if (local_qnic_info == nullptr) {
+    error("local qnic info should not be null");
+  }
+  return local_qnic_info->qnic;
+}
+
+// whether the half width of the confidence interval of the fidelity reached the target precision
+bool HardwareMonitor::isPreciseEnough(const tomography::TomographyAccumulator &accumulator, double target_precision) const {
+  if (accumulator.getTotalMeasurements() < tomography_min_measurements || !accumulator.hasAllBasisCombinations()) return false;
+  return accumulator.fidelityConfidenceHalfWidth(tomography_confidence_z) <= target_precision;
+}
+
+/**
+ * Accumulates the outcome in the tomography of its connection, apart from the other connections with the same partner.
+ * Once the fidelity is precise enough, the RuleSets of both end nodes are terminated as by their termination conditions,
+ * so their qubits go to the other connections before num_measure. The partner may stop the same connection by itself too.
+ */
+void HardwareMonitor::addConnectionTomographyOutcome(LinkTomographyResult *result, const tomography::MeasurementHalf &half) {
+  unsigned long ruleset_id = result->getRuleset_id();
+  auto &connection = connection_tomographies[ruleset_id];
+  if (connection.stopped || !connection.accumulator.addMeasurement(result->getCount_id(), result->getSrcAddr() == my_address, half)) return;
+  if (!isPreciseEnough(connection.accumulator, connection_tomography_target_precision)) return;
+  int partner_addr = result->getPartner_address();
+  EV_INFO << "Tomography of the connection with " << partner_addr << " stopped after " << connection.accumulator.getTotalMeasurements() << " measurements\n";
+  connection.stopped = true;
+  connection.accumulator = tomography::TomographyAccumulator{};
+  num_connection_tomographies_stopped++;
+
+  for (int dest_addr : {my_address, partner_addr}) {
+    auto *termination = new InternalRuleSetTermination("InternalRuleSetTermination");
+    termination->setSrcAddr(my_address);
+    termination->setDestAddr(dest_addr);
+    termination->setRuleSet_id(ruleset_id);
+    if (dest_addr == my_address) {
+      sendToRouter(this, termination);
+    } else {
+      send(termination, "RouterPort$o");
+    }
+  }
+}
+
+/**
+ * Ends the link tomography before num_measure outcomes, with the same records as a finished one.
+ * The RuleEngine terminates the tomography RuleSet, frees its qubits and stops the emission of the MSM link.
+ */
+void HardwareMonitor::stopLinkTomography(int qnic_address, int partner_address, unsigned long ruleset_id, simtime_t finish, int measurements) {
+  auto &link_cost = tomography_runningtime_holder[qnic_address][partner_address];
+  if (link_cost.tomography_time < 0) {
+    link_cost.Bellpair_per_sec = finish > 0 ? measurements / finish.dbl() : 0;
+    link_cost.tomography_measurements = measurements;
+    link_cost.tomography_time = finish;
+  }
+  EV_INFO << "Link tomography with " << partner_address << " stopped after " << measurements << " measurements\n";
+
+  StopEmitting *pk = new StopEmitting("StopEmitting");
+  pk->setQnic_address(qnic_address);
+  pk->setDestAddr(my_address);
+  pk->setSrcAddr(my_address);
+  pk->setTerminate_ruleset(true);
+  pk->setRuleset_id(ruleset_id);
+  sendToRouter(this, pk);
 }
 
 void HardwareMonitor::finish() {
   EV << "Finishing Hardware Monitor\n";
+  if (connection_tomography_target_precision > 0) recordScalar("connection_tomographies_stopped_early", num_connection_tomographies_stopped);
   // file name
   std::string file_name = tomography_output_filename;
   std::string df = "default";
@@ -260,94 +410,25 @@ void HardwareMonitor::finish() {
   } else {
     std::cout << df << "!=" << file_name << "\n";
   }
-  std::string file_name_dm = file_name + std::string("_dm");
-  std::ofstream tomography_stats(file_name, std::ios_base::app);
-  std::ofstream tomography_dm(file_name_dm, std::ios_base::app);
-  std::cout << "Opened new file to write. Address is " << my_address << "\n";
-
-  // here generate tomography data storage
-  tomography_data = new RawData[num_qnic_total];
-
-  OutputCount initial;
-  initial.minus_minus = 0;
-  initial.minus_plus = 0;
-  initial.plus_minus = 0;
-  initial.plus_plus = 0;
-  initial.total_count = 0;
-  for (auto it = qnic_partner_map.begin(); it != qnic_partner_map.end(); ++it) {
-    int qnic_id = it->first;
-    int part = it->second;
-    tomography_data[qnic_id][part].insert(std::make_pair("XX", initial));
-    tomography_data[qnic_id][part].insert(std::make_pair("XY", initial));
-    tomography_data[qnic_id][part].insert(std::make_pair("XZ", initial));
-    tomography_data[qnic_id][part].insert(std::make_pair("ZX", initial));
-    tomography_data[qnic_id][part].insert(std::make_pair("ZY", initial));
-    tomography_data[qnic_id][part].insert(std::make_pair("ZZ", initial));
-    tomography_data[qnic_id][part].insert(std::make_pair("YX", initial));
-    tomography_data[qnic_id][part].insert(std::make_pair("YY", initial));
-    tomography_data[qnic_id][part].insert(std::make_pair("YZ", initial));
-  }
-
+  if (qnic_partner_map.empty()) return;
+  // the results of all the nodes are buffered in SharedResource and written to the file at once
+  auto *tomography_writer = provider.getTomographyResultWriter(file_name + ".csv");
+
+  std::vector<int> qnics;
+  for (auto &[qnic, partner_address] : qnic_partner_map) qnics.push_back(qnic);
+  auto density_matrices = reconstruct_density_matrices(qnics);
+  int link_index = 0;
   for (auto it = qnic_partner_map.begin(); it != qnic_partner_map.end(); it++) {
     int qnic = it->first;
     int partner_address = it->second;
-    // qnic index
-    //  - partner address
-    //  - - measurement counts
-    // qnic index
-    // initial variables for this tomography partner
-    int meas_total = 0;  // total number of measurement
-    int GOD_clean_pair_total = 0;  // clean pair?
-    int GOD_X_pair_total = 0;
-    int GOD_Z_pair_total = 0;
-    int GOD_Y_pair_total = 0;
-
-    for (auto it = temporal_tomography_output[qnic][partner_address].begin(); it != temporal_tomography_output[qnic][partner_address].end(); it++) {
-      std::string basis_combination = "";
-      basis_combination += it->second.my_basis;
-      basis_combination += it->second.partner_basis;
-      if (tomography_data[qnic][partner_address].count(basis_combination) != 1) {
-        error("Basis combination for tomography with partner: %d at %d is not found", partner_address, qnic);
-      }
-      tomography_data[qnic][partner_address][basis_combination].total_count++;
-      // the number of total measurement
-      meas_total++;
-
-      EV_DEBUG << it->second.my_GOD_clean << "," << it->second.partner_GOD_clean << "\n";
-      // count for ideal state?
-      // clean pair ... no error bell pairs
-      // X pair ... X error bell pairs?
-      // Y pair ... Y error bell pairs?
-      // Z pair ... Z error bell pairs?
-      if ((it->second.my_GOD_clean == 'F' && it->second.partner_GOD_clean == 'F') || (it->second.my_GOD_clean == 'X' && it->second.partner_GOD_clean == 'X') ||
-          (it->second.my_GOD_clean == 'Z' && it->second.partner_GOD_clean == 'Z') || (it->second.my_GOD_clean == 'Y' && it->second.partner_GOD_clean == 'Y')) {
-        GOD_clean_pair_total++;
-      } else if ((it->second.my_GOD_clean == 'X' && it->second.partner_GOD_clean == 'F') || (it->second.my_GOD_clean == 'F' && it->second.partner_GOD_clean == 'X')) {
-        GOD_X_pair_total++;
-      } else if ((it->second.my_GOD_clean == 'Z' && it->second.partner_GOD_clean == 'F') || (it->second.my_GOD_clean == 'F' && it->second.partner_GOD_clean == 'Z')) {
-        GOD_Z_pair_total++;
-      } else if ((it->second.my_GOD_clean == 'Y' && it->second.partner_GOD_clean == 'F') || (it->second.my_GOD_clean == 'F' && it->second.partner_GOD_clean == 'Y')) {
-        GOD_Y_pair_total++;
-      }
-
-      // empirical result
-      if (it->second.my_output_is_plus && it->second.partner_output_is_plus) {
-        // mine: +, partner: +
-        tomography_data[qnic][partner_address][basis_combination].plus_plus++;
-      } else if (it->second.my_output_is_plus && !it->second.partner_output_is_plus) {
-        // mine: +, partner: -
-        tomography_data[qnic][partner_address][basis_combination].plus_minus++;
-      } else if (!it->second.my_output_is_plus && it->second.partner_output_is_plus) {
-        // mine: -, partner: +
-        tomography_data[qnic][partner_address][basis_combination].minus_plus++;
-      } else if (!it->second.my_output_is_plus && !it->second.partner_output_is_plus) {
-        // mine: -, partner: -
-        tomography_data[qnic][partner_address][basis_combination].minus_minus++;
-      } else {
-        error("This should not happen though..... ?");
-      }
-    }  // end for
-    Matrix4cd extended_density_matrix_reconstructed = reconstruct_density_matrix(qnic, partner_address);
+    // the outcomes are summarized while they arrive in handleMessage
+    auto &accumulator = tomography_accumulators[qnic][partner_address];
+    int meas_total = accumulator.getTotalMeasurements();
+    int GOD_clean_pair_total = accumulator.getGODCleanPairTotal();
+    int GOD_X_pair_total = accumulator.getGODXPairTotal();
+    int GOD_Z_pair_total = accumulator.getGODZPairTotal();
+    int GOD_Y_pair_total = accumulator.getGODYPairTotal();
+    Matrix4cd &extended_density_matrix_reconstructed = density_matrices[link_index++];
 
     Vector4cd Bellpair;
     Bellpair << 1 / sqrt(2), 0, 0, 1 / sqrt(2);
@@ -373,170 +454,145 @@ void HardwareMonitor::finish() {
     double Yerr_rate = (extended_density_matrix_reconstructed.real() * density_matrix_Y.real()).trace();
     EV << "Yerr = " << Yerr_rate << "\n";
 
-    // FIXME should be updated
-    double denom = fidelity * fidelity * tomography_runningtime_holder[qnic][partner_address].Bellpair_per_sec;
-    double link_cost;
-    // TODO currently, it's just placed. consider how to culculate this
-    if (denom != 0) {
-      link_cost = (double)1 / denom;
-    } else {
-      link_cost = 1;
-    }
-    auto info = findConnectionInfoByQnicAddr(qnic);
-    if (info == nullptr) {
+    double link_cost = calculateLinkCost(fidelity, tomography_runningtime_holder[qnic][partner_address].Bellpair_per_sec);
+    auto *interface = findInterfaceByQnicAddr(qnic);
+    if (interface == nullptr) {
       error("info not found");
     }
     // outputs
-    InterfaceInfo interface = getQnicInterfaceByQnicAddr(info->qnic.index, info->qnic.type);
     cModule *this_node = this->getParentModule()->getParentModule();
     cModule *partner_node = getQNodeWithAddress(partner_address);
-    cChannel *channel = interface.qnic.pointer->gate("qnic_quantum_port$o")->getNextGate()->getChannel();
+    cChannel *channel = interface->qnic.pointer->gate("qnic_quantum_port$o")->getNextGate()->getChannel();
     double dis = channel->par("distance");
     if (partner_node == nullptr) {
       error("here, partner node is null");
     }
-    // density matrix output
-    tomography_dm << this_node->getFullName() << "<--->" << partner_node->getFullName() << "\n";
-    tomography_dm << "REAL\n";
-    tomography_dm << extended_density_matrix_reconstructed.real() << "\n";
-    tomography_dm << "IMAGINARY\n";
-    tomography_dm << extended_density_matrix_reconstructed.imag() << "\n";
-
-    // link stats output
-    tomography_stats << this_node->getFullName() << "<-->QuantumChannel{cost=" << link_cost << ";distance=" << dis << "km;fidelity=" << fidelity
-                     << ";bellpair_per_sec=" << tomography_runningtime_holder[qnic][partner_address].Bellpair_per_sec
-                     << ";tomography_time=" << tomography_runningtime_holder[qnic][partner_address].tomography_time
-                     << ";tomography_measurements=" << tomography_runningtime_holder[qnic][partner_address].tomography_measurements << ";actual_meas=" << meas_total
-                     << "; GOD_clean_pair_total=" << GOD_clean_pair_total << "; GOD_X_pair_total=" << GOD_X_pair_total << "; GOD_Y_pair_total=" << GOD_Y_pair_total
-                     << "; GOD_Z_pair_total=" << GOD_Z_pair_total << ";}<-->" << partner_node->getFullName() << "; F=" << fidelity << "; X=" << Xerr_rate << "; Z=" << Zerr_rate
-                     << "; Y=" << Yerr_rate << endl;
+    // link stats and density matrix output
+    SharedResource::LinkTomographyRecord record;
+    record.node_name = this_node->getFullName();
+    record.partner_name = partner_node->getFullName();
+    record.link_cost = link_cost;
+    record.distance_km = dis;
+    record.fidelity = fidelity;
+    record.x_error_rate = Xerr_rate;
+    record.y_error_rate = Yerr_rate;
+    record.z_error_rate = Zerr_rate;
+    record.bellpair_per_sec = tomography_runningtime_holder[qnic][partner_address].Bellpair_per_sec;
+    record.tomography_time = tomography_runningtime_holder[qnic][partner_address].tomography_time.dbl();
+    record.tomography_measurements = tomography_runningtime_holder[qnic][partner_address].tomography_measurements;
+    record.actual_measurements = meas_total;
+    record.GOD_clean_pair_total = GOD_clean_pair_total;
+    record.GOD_X_pair_total = GOD_X_pair_total;
+    record.GOD_Y_pair_total = GOD_Y_pair_total;
+    record.GOD_Z_pair_total = GOD_Z_pair_total;
+    for (int i = 0; i < 16; i++) {
+      record.density_matrix_real[i] = extended_density_matrix_reconstructed(i / 4, i % 4).real();
+      record.density_matrix_imag[i] = extended_density_matrix_reconstructed(i / 4, i % 4).imag();
+    }
+    tomography_writer->write(record);
     // this is a temporary implementation so that the e2e-test can read fidelity and error rates
     std::cout << this_node->getFullName() << "<-->QuantumChannel{cost=" << link_cost << ";distance=" << dis << "km;fidelity=" << fidelity
               << ";bellpair_per_sec=" << tomography_runningtime_holder[qnic][partner_address].Bellpair_per_sec << ";}<-->" << partner_node->getFullName()
               << "; Fidelity=" << fidelity << "; Xerror=" << Xerr_rate << "; Zerror=" << Zerr_rate << "; Yerror=" << Yerr_rate << endl;
   }
-  tomography_stats.close();
-  tomography_dm.close();
-  std::cout << "Closed file to write.\n";
 }
 
-Matrix4cd HardwareMonitor::reconstruct_density_matrix(int qnic_id, int partner) {
-  // II
-  auto data = tomography_data[qnic_id][partner];
-  double S00 = 1.0;
-  double S01 = (double)data["XX"].plus_plus / (double)data["XX"].total_count - (double)data["XX"].plus_minus / (double)data["XX"].total_count +
-               (double)data["XX"].minus_plus / (double)data["XX"].total_count - (double)data["XX"].minus_minus / (double)data["XX"].total_count;
-  if (std::isnan(S01)) {
-    EV << "total count: " << (double)data["XX"].total_count << "\n";
-    error("S01 error at node %d qnic: %d, with partner: %d", my_address, qnic_id, partner);
-  }
-  double S02 = (double)data["YY"].plus_plus / (double)data["YY"].total_count - (double)data["YY"].plus_minus / (double)data["YY"].total_count +
-               (double)data["YY"].minus_plus / (double)data["YY"].total_count - (double)data["YY"].minus_minus / (double)data["YY"].total_count;
-  if (std::isnan(S02)) {
-    error("S02 error at node %d qnic: %d, with partner: %d", my_address, qnic_id, partner);
-  }
-  double S03 = (double)data["ZZ"].plus_plus / (double)data["ZZ"].total_count - (double)data["ZZ"].plus_minus / (double)data["ZZ"].total_count +
-               (double)data["ZZ"].minus_plus / (double)data["ZZ"].total_count - (double)data["ZZ"].minus_minus / (double)data["ZZ"].total_count;
-  if (std::isnan(S03)) {
-    error("S03 error at node %d qnic: %d, with partner: %d", my_address, qnic_id, partner);
-  }
-  // XX
-  double S10 = (double)data["XX"].plus_plus / (double)data["XX"].total_count + (double)data["XX"].plus_minus / (double)data["XX"].total_count -
-               (double)data["XX"].minus_plus / (double)data["XX"].total_count - (double)data["XX"].minus_minus / (double)data["XX"].total_count;
-  if (std::isnan(S10)) {
-    error("S10 error at node %d qnic: %d, with partner: %d", my_address, qnic_id, partner);
-  }
-  double S11 = (double)data["XX"].plus_plus / (double)data["XX"].total_count - (double)data["XX"].plus_minus / (double)data["XX"].total_count -
-               (double)data["XX"].minus_plus / (double)data["XX"].total_count + (double)data["XX"].minus_minus / (double)data["XX"].total_count;
-  if (std::isnan(S11)) {
-    error("S11 error at node %d qnic: %d, with partner: %d", my_address, qnic_id, partner);
-  }
-  double S12 = (double)data["XY"].plus_plus / (double)data["XY"].total_count - (double)data["XY"].plus_minus / (double)data["XY"].total_count -
-               (double)data["XY"].minus_plus / (double)data["XY"].total_count + (double)data["XY"].minus_minus / (double)data["XY"].total_count;
-  if (std::isnan(S12)) {
-    error("S12 error at node %d qnic: %d, with partner: %d", my_address, qnic_id, partner);
-  }
-  double S13 = (double)data["XZ"].plus_plus / (double)data["XZ"].total_count - (double)data["XZ"].plus_minus / (double)data["XZ"].total_count -
-               (double)data["XZ"].minus_plus / (double)data["XZ"].total_count + (double)data["XZ"].minus_minus / (double)data["XZ"].total_count;
-  if (std::isnan(S13)) {
-    error("S13 error at node %d qnic: %d, with partner: %d", my_address, qnic_id, partner);
-  }
-  // YY
-  double S20 = (double)data["YY"].plus_plus / (double)data["YY"].total_count + (double)data["YY"].plus_minus / (double)data["YY"].total_count -
-               (double)data["YY"].minus_plus / (double)data["YY"].total_count - (double)data["YY"].minus_minus / (double)data["YY"].total_count;
-  if (std::isnan(S20)) {
-    error("S20 error at node %d qnic: %d, with partner: %d", my_address, qnic_id, partner);
-  }
-  double S21 = (double)data["YX"].plus_plus / (double)data["YX"].total_count - (double)data["YX"].plus_minus / (double)data["YX"].total_count -
-               (double)data["YX"].minus_plus / (double)data["YX"].total_count + (double)data["YX"].minus_minus / (double)data["YX"].total_count;
-  if (std::isnan(S21)) {
-    error("S21 error at node %d qnic: %d, with partner: %d", my_address, qnic_id, partner);
-  }
-  double S22 = (double)data["YY"].plus_plus / (double)data["YY"].total_count - (double)data["YY"].plus_minus / (double)data["YY"].total_count -
-               (double)data["YY"].minus_plus / (double)data["YY"].total_count + (double)data["YY"].minus_minus / (double)data["YY"].total_count;
-  if (std::isnan(S22)) {
-    error("S22 error at node %d qnic: %d, with partner: %d", my_address, qnic_id, partner);
-  }
-  double S23 = (double)data["YZ"].plus_plus / (double)data["YZ"].total_count - (double)data["YZ"].plus_minus / (double)data["YZ"].total_count -
-               (double)data["YZ"].minus_plus / (double)data["YZ"].total_count + (double)data["YZ"].minus_minus / (double)data["YZ"].total_count;
-  if (std::isnan(S23)) {
-    error("S23 error at node %d qnic: %d, with partner: %d", my_address, qnic_id, partner);
-  }
-  // ZZ
-  double S30 = (double)data["ZZ"].plus_plus / (double)data["ZZ"].total_count + (double)data["ZZ"].plus_minus / (double)data["ZZ"].total_count -
-               (double)data["ZZ"].minus_plus / (double)data["ZZ"].total_count - (double)data["ZZ"].minus_minus / (double)data["ZZ"].total_count;
-  if (std::isnan(S30)) {
-    error("S30 error at node %d qnic: %d, with partner: %d", my_address, qnic_id, partner);
-  }
-  double S31 = (double)data["ZX"].plus_plus / (double)data["ZX"].total_count - (double)data["ZX"].plus_minus / (double)data["ZX"].total_count -
-               (double)data["ZX"].minus_plus / (double)data["ZX"].total_count + (double)data["ZX"].minus_minus / (double)data["ZX"].total_count;
-  if (std::isnan(S31)) {
-    error("S31 error at node %d qnic: %d, with partner: %d", my_address, qnic_id, partner);
-  }
-  double S32 = (double)data["ZY"].plus_plus / (double)data["ZY"].total_count - (double)data["ZY"].plus_minus / (double)data["ZY"].total_count -
-               (double)data["ZY"].minus_plus / (double)data["ZY"].total_count + (double)data["ZY"].minus_minus / (double)data["ZY"].total_count;
-  if (std::isnan(S32)) {
-    error("S32 error at node %d qnic: %d, with partner: %d", my_address, qnic_id, partner);
+/**
+ * Re-estimates the fidelity, the Bell pair rate and the cost of the links under the link tomography
+ * from the outcomes accumulated so far, and publishes them as signals and as the quantum link weights
+ * in the RoutingDaemon's topology. The links without new outcomes since the last estimation are skipped.
+ * Returns false if the tomography of every link finished and the final outcomes are estimated.
+ */
+bool HardwareMonitor::estimateLinkCosts() {
+  bool running = link_estimates.empty();
+  Vector4cd Bellpair;
+  Bellpair << 1 / sqrt(2), 0, 0, 1 / sqrt(2);
+  Matrix4cd density_matrix_ideal = Bellpair * Bellpair.adjoint();
+
+  // the links with new outcomes are reconstructed together
+  std::vector<int> qnics;
+  for (auto &[qnic, estimate] : link_estimates) {
+    int partner_address = qnic_partner_map[qnic];
+    auto &accumulator = tomography_accumulators[qnic][partner_address];
+    int meas_total = accumulator.getTotalMeasurements();
+    if (tomography_runningtime_holder[qnic][partner_address].tomography_time < 0) running = true;
+    if (meas_total == estimate.estimated_measurements || !accumulator.hasAllBasisCombinations()) continue;
+    estimate.estimated_measurements = meas_total;
+    qnics.push_back(qnic);
   }
-  double S33 = (double)data["ZZ"].plus_plus / (double)data["ZZ"].total_count - (double)data["ZZ"].plus_minus / (double)data["ZZ"].total_count -
-               (double)data["ZZ"].minus_plus / (double)data["ZZ"].total_count + (double)data["ZZ"].minus_minus / (double)data["ZZ"].total_count;
-  if (std::isnan(S33)) {
-    error("S33 error at node %d qnic: %d, with partner: %d", my_address, qnic_id, partner);
+  if (qnics.empty()) return running;
+  auto density_matrices = reconstruct_density_matrices(qnics);
+
+  for (std::size_t i = 0; i < qnics.size(); i++) {
+    int qnic = qnics[i];
+    auto &estimate = link_estimates[qnic];
+    int partner_address = qnic_partner_map[qnic];
+    int meas_total = estimate.estimated_measurements;
+    double fidelity = (density_matrices[i].real() * density_matrix_ideal.real()).trace();
+    // the finished tomography knows the actual rate, otherwise estimate it from the outcomes so far
+    double bellpair_per_sec = tomography_runningtime_holder[qnic][partner_address].Bellpair_per_sec;
+    if (bellpair_per_sec <= 0) {
+      simtime_t elapsed = simTime() - estimate.first_measured_at;
+      bellpair_per_sec = elapsed > 0 ? meas_total / elapsed.dbl() : 0;
+    }
+    double link_cost = calculateLinkCost(fidelity, bellpair_per_sec);
+    estimate.fidelity = fidelity;
+
+    emit(estimate.fidelity_signal, fidelity);
+    emit(estimate.bellpair_per_sec_signal, bellpair_per_sec);
+    emit(estimate.cost_signal, link_cost);
+    cModule *partner_node = getQNodeWithAddress(partner_address);
+    if (partner_node != nullptr) {
+      provider.setQuantumLinkCost(partner_node, link_cost);
+      provider.setQuantumLinkFidelity(partner_node, fidelity);
+    }
   }
+  return running;
+}
 
-  double S = (double)data["XX"].plus_plus / (double)data["XX"].total_count + (double)data["XX"].plus_minus / (double)data["XX"].total_count +
-             (double)data["XX"].minus_plus / (double)data["XX"].total_count + (double)data["XX"].minus_minus / (double)data["XX"].total_count;
-  if (std::isnan(S)) {
-    error(" final S error at node %d qnic: %d, with partner: %d", my_address, qnic_id, partner);
+simsignal_t HardwareMonitor::registerLinkSignal(const char *name, int partner_address) {
+  std::string signal_name = std::string(name) + "-" + std::to_string(partner_address);
+  simsignal_t signal = registerSignal(signal_name.c_str());
+  cProperty *statistic_template = getProperties()->get("statisticTemplate", name);
+  if (statistic_template != nullptr) getEnvir()->addResultRecorders(this, signal, signal_name.c_str(), statistic_template);
+  return signal;
+}
+
+double HardwareMonitor::calculateLinkCost(double fidelity, double bellpair_per_sec) {
+  // FIXME should be updated
+  double denom = fidelity * fidelity * bellpair_per_sec;
+  // TODO currently, it's just placed. consider how to culculate this
+  if (denom != 0) {
+    return (double)1 / denom;
   }
+  return 1;
+}
 
-  EV << S00 << ", " << S01 << ", " << S02 << ", " << S03 << "\n";
-  EV << S10 << ", " << S11 << ", " << S12 << ", " << S13 << "\n";
-  EV << S20 << ", " << S21 << ", " << S22 << ", " << S23 << "\n";
-  EV << S30 << ", " << S31 << ", " << S32 << ", " << S33 << "\n";
-
-  Matrix4cd extended_density_matrix_reconstructed =
-      (double)1 / (double)4 *
-      (S01 * kroneckerProduct(Pauli.I, Pauli.X).eval() + S02 * kroneckerProduct(Pauli.I, Pauli.Y).eval() + S03 * kroneckerProduct(Pauli.I, Pauli.Z).eval() +
-       S10 * kroneckerProduct(Pauli.X, Pauli.I).eval() + S11 * kroneckerProduct(Pauli.X, Pauli.X).eval() + S12 * kroneckerProduct(Pauli.X, Pauli.Y).eval() +
-       S13 * kroneckerProduct(Pauli.X, Pauli.Z).eval() + S20 * kroneckerProduct(Pauli.Y, Pauli.I).eval() + S21 * kroneckerProduct(Pauli.Y, Pauli.X).eval() +
-       S22 * kroneckerProduct(Pauli.Y, Pauli.Y).eval() + S23 * kroneckerProduct(Pauli.Y, Pauli.Z).eval() + S30 * kroneckerProduct(Pauli.Z, Pauli.I).eval() +
-       S31 * kroneckerProduct(Pauli.Z, Pauli.X).eval() + S32 * kroneckerProduct(Pauli.Z, Pauli.Y).eval() + S33 * kroneckerProduct(Pauli.Z, Pauli.Z).eval() +
-       S * kroneckerProduct(Pauli.I, Pauli.I).eval());
-  EV << "DM = " << extended_density_matrix_reconstructed << "\n";
-  return extended_density_matrix_reconstructed;
+std::vector<Matrix4cd> HardwareMonitor::reconstruct_density_matrices(const std::vector<int> &qnic_ids) {
+  std::vector<const tomography::TomographyAccumulator *> accumulators;
+  accumulators.reserve(qnic_ids.size());
+  for (int qnic_id : qnic_ids) {
+    int partner = qnic_partner_map[qnic_id];
+    auto &data = tomography_accumulators[qnic_id][partner];
+    if (!data.hasAllBasisCombinations()) {
+      error("tomography has no outcome in some basis combinations at node %d qnic: %d, with partner: %d", my_address, qnic_id, partner);
+    }
+    accumulators.push_back(&data);
+  }
+  auto density_matrices = tomography::reconstructDensityMatrices(accumulators);
+  for (auto &density_matrix : density_matrices) EV << "DM = " << density_matrix << "\n";
+  return density_matrices;
 }
 
 void HardwareMonitor::writeToFile_Topology_with_LinkCost(int qnic_id, double link_cost, double fidelity, double bellpair_per_sec) {
-  auto info = findConnectionInfoByQnicAddr(qnic_id);
-  if (info == nullptr) {
+  auto *interface = findInterfaceByQnicAddr(qnic_id);
+  if (interface == nullptr) {
     error("qnic info not found");
   }
-  InterfaceInfo interface = getQnicInterfaceByQnicAddr(info->qnic.index, info->qnic.type);
   cModule *const this_node = provider.getQNode();
-  cModule *const neighbor_node = provider.getNeighborNode(interface.qnic.pointer);
+  cModule *const neighbor_node = provider.getNeighborNode(interface->qnic.pointer);
   const cModuleType *const neighbor_node_type = neighbor_node->getModuleType();
-  cChannel *channel = interface.qnic.pointer->gate("qnic_quantum_port$o")->getNextGate()->getChannel();
+  cChannel *channel = interface->qnic.pointer->gate("qnic_quantum_port$o")->getNextGate()->getChannel();
   double dis = channel->par("distance");
   if (provider.isQNodeType(neighbor_node_type) && provider.isBSANodeType(neighbor_node_type) && provider.isEPPSNodeType(neighbor_node_type)) {
     error("Module Type not recognized when writing to file...");
@@ -1104,20 +1160,7 @@ InterfaceInfo HardwareMonitor::getQnicInterfaceByQnicAddr(int qnic_index, QNIC_t
   return inf;
 }
 
-std::unique_ptr<ConnectionSetupInfo> HardwareMonitor::findConnectionInfoByQnicAddr(int qnic_address) {
-  for (auto it = neighbor_table.cbegin(); it != neighbor_table.cend(); ++it) {
-    if (it->second.qnic.address == qnic_address) {
-      auto info = std::make_unique<ConnectionSetupInfo>();
-      info->qnic.type = it->second.qnic.type;
-      info->qnic.index = it->second.qnic.index;
-      info->qnic.address = it->second.qnic.address;
-      info->neighbor_address = it->second.neighborQNode_address;
-      info->quantum_link_cost = it->second.link_cost;
-      return info;
-    }
-  }
-  return nullptr;
-}
+const ConnectionSetupInfo *HardwareMonitor::findConnectionInfoByQnicAddr(int qnic_address) { return connection_infos_by_qnic_addr.find(qnic_address); }
 
 // This neighbor table includes all neighbors of qnic, qnic_r and qnic_rp
 void HardwareMonitor::prepareNeighborTable() {
@@ -1144,6 +1187,18 @@ void HardwareMonitor::prepareNeighborTable() {
     inf.neighborQNode_address = n_inf->neighborQNode_address;
     neighbor_table[neighborNodeAddress] = inf;
   }
+
+  // the first entry of a qnic or a neighbor QNode in the table order wins, as the linear search did
+  for (auto &[_, inf] : neighbor_table) {
+    if (interfaces_by_qnic_addr.contains(inf.qnic.address)) continue;
+    interfaces_by_qnic_addr.set(inf.qnic.address, inf);
+    ConnectionSetupInfo info;
+    info.qnic = inf.qnic;
+    info.neighbor_address = inf.neighborQNode_address;
+    info.quantum_link_cost = inf.link_cost;
+    connection_infos_by_qnic_addr.set(inf.qnic.address, info);
+    if (!qnic_addr_by_neighbor_addr.contains(inf.neighborQNode_address)) qnic_addr_by_neighbor_addr.set(inf.neighborQNode_address, inf.qnic.address);
+  }
 }
 
 // This method finds out the address of the neighboring node with respect to the
@@ -1162,23 +1217,7 @@ std::unique_ptr<NeighborInfo> HardwareMonitor::getNeighbor(cModule *qnic_module)
   return neighbor_info;
 }
 
-cModule *HardwareMonitor::getQNodeWithAddress(int address) {
-  cTopology *topo = new cTopology("topo");
-  // veryfication?
-  topo->extractByParameter("included_in_topology", "\"yes\"");
-  int addr;
-  for (int i = 0; i < topo->getNumNodes(); i++) {
-    cTopology::Node *node = topo->getNode(i);
-    addr = (int)node->getModule()->par("address");
-    EV_DEBUG << "End node address is " << addr << "\n";
-    if (addr == address) {
-      auto *mod = node->getModule();
-      delete topo;
-      return mod;
-    }
-  }
-  delete topo;
-}
+cModule *HardwareMonitor::getQNodeWithAddress(int address) { return provider.getQNodeWithAddress(address); }
 
 std::unique_ptr<NeighborInfo> HardwareMonitor::createNeighborInfo(const cModule &thisNode) {
   cModuleType *type = thisNode.getModuleType();
@@ -1192,6 +1231,12 @@ std::unique_ptr<NeighborInfo> HardwareMonitor::createNeighborInfo(const cModule
     return inf;
   }
 
+  // the StubNode of TopologyBuilder answers the qnic as a BSA in place of the QNode
+  if (thisNode.hasPar("node_type") && thisNode.par("node_type").stdstringValue() == "Stub") {
+    inf->neighborQNode_address = thisNode.par("address");
+    return inf;
+  }
+
   if (provider.isBSANodeType(type)) {
     auto *controller = dynamic_cast<BSAController *>(thisNode.getSubmodule("bsa_controller"));
     if (controller == nullptr) {
@@ -1244,7 +1289,7 @@ std::unique_ptr<NeighborInfo> HardwareMonitor::createNeighborInfo(const cModule
 
   error(
       "This simulator only recognizes the following network level node "
-      "types: QNode, EPPS and BSA. Not %s",
+      "types: QNode, EPPS, BSA and Stub. Not %s",
       thisNode.getClassName());
 }
 
@@ -8,7 +8,9 @@
 
 #include <complex>
 
+#include "messages/classical_messages.h"
 #include "rules/Rule.h"
+#include "utils/AddressTable.h"
 #include "utils/ComponentProvider.h"
 
 namespace quisp::modules {
@@ -23,21 +25,17 @@ class HardwareMonitor : public IHardwareMonitor {
   HardwareMonitor();
   ~HardwareMonitor();
   int getQnicNumQubits(int qnic_index, QNIC_type qnic_type) override;
-  std::unique_ptr<InterfaceInfo> findInterfaceByNeighborAddr(int neighbor_address) override;
-  std::unique_ptr<ConnectionSetupInfo> findConnectionInfoByQnicAddr(int qnic_address) override;
+  const InterfaceInfo *findInterfaceByNeighborAddr(int neighbor_address) override;
+  const ConnectionSetupInfo *findConnectionInfoByQnicAddr(int qnic_address) override;
+  void setQuantumLinkState(int neighbor_address, bool up) override;
+  double getLinkPairRate(int qnic_address) override;
+  double getLinkFidelity(int qnic_address) override;
 
  protected:
   utils::ComponentProvider provider;
+  modules::SharedResource::EventProfiler *event_profiler = nullptr;
 
  private:
-  // Matrices of single qubit errors. Used when conducting tomography.
-  struct SingleQubitError {
-    Eigen::Matrix2cd X;  // double 2*2 matrix
-    Eigen::Matrix2cd Y;  // complex double 2*2 matrix
-    Eigen::Matrix2cd Z;
-    Eigen::Matrix2cd I;
-  };
-
   int my_address;
 
   // number of qnics connected to stand alone BSA or internal hom in the neighbor.
@@ -62,11 +60,46 @@ class HardwareMonitor : public IHardwareMonitor {
 
   cModule *getQnic(int qnic_index, QNIC_type qnic_type);
   NeighborTable neighbor_table;
-  RawData *tomography_data;
-  SingleQubitError Pauli;
+  // the indexes of neighbor_table, built in prepareNeighborTable
+  utils::AddressTable<InterfaceInfo> interfaces_by_qnic_addr;  // qnic address -> interface
+  utils::AddressTable<ConnectionSetupInfo> connection_infos_by_qnic_addr;  // qnic address -> qnic and neighbor QNode
+  utils::AddressTable<int> qnic_addr_by_neighbor_addr;  // neighbor QNode address -> qnic address
 
-  TomographyOutcomeTable *temporal_tomography_output;  // qnic address -> partner . count_id . outcome
+  TomographyAccumulatorTable *tomography_accumulators;  // qnic address -> partner . accumulated outcomes
   LinkCostMap *tomography_runningtime_holder;
+
+  // online link cost estimation during the link tomography
+  struct LinkEstimate {
+    simtime_t first_measured_at = -1;
+    // the number of the outcomes used for the last estimation
+    int estimated_measurements = 0;
+    double fidelity = 0;  // the last estimate
+    simsignal_t fidelity_signal;
+    simsignal_t bellpair_per_sec_signal;
+    simsignal_t cost_signal;
+  };
+  simtime_t link_cost_estimation_interval;
+  cMessage *link_cost_estimation_timer = nullptr;
+  std::map<int, LinkEstimate> link_estimates;  // qnic address -> estimate with the partner
+
+  // sequential link tomography, stopped once the confidence interval of the fidelity is narrow enough. 0 disables it.
+  double tomography_target_precision;
+  double tomography_confidence_z;
+  int tomography_min_measurements;
+  // the tomography RuleSets this node sent, only this side decides when to stop
+  struct SequentialTomography {
+    unsigned long ruleset_id;
+    simtime_t started_at;
+  };
+  std::map<int, SequentialTomography> sequential_tomographies;  // partner address -> the running tomography
+  // sequential end-to-end tomography of the connections, with tomography_confidence_z and tomography_min_measurements. 0 disables it.
+  double connection_tomography_target_precision;
+  struct ConnectionTomography {
+    tomography::TomographyAccumulator accumulator;  // the outcomes of the RuleSet only, cleared once it's stopped
+    bool stopped = false;
+  };
+  std::map<unsigned long, ConnectionTomography> connection_tomographies;  // RuleSet id -> the tomography of the connection
+  int num_connection_tomographies_stopped = 0;
   std::string tomography_output_filename;
   std::string file_dir_name;
   std::string purification_type;
@@ -82,8 +115,19 @@ class HardwareMonitor : public IHardwareMonitor {
   virtual cModule *getQNodeWithAddress(int address);
   virtual InterfaceInfo getQnicInterfaceByQnicAddr(int qnic_index, QNIC_type qnic_type);
   virtual void sendLinkTomographyRuleSet(int my_address, int partner_address, QNIC_type qnic_type, int qnic_index, unsigned long rule_id);
-  virtual Eigen::Matrix4cd reconstruct_density_matrix(int qnic_id, int partner);
+  const InterfaceInfo *findInterfaceByQnicAddr(int qnic_address) const;
+  virtual QNIC findLocalQnicByPartnerAddr(int partner_address);
+  bool isPreciseEnough(const tomography::TomographyAccumulator &accumulator, double target_precision) const;
+  void addConnectionTomographyOutcome(messages::LinkTomographyResult *result, const tomography::MeasurementHalf &half);
+  void stopLinkTomography(int qnic_address, int partner_address, unsigned long ruleset_id, simtime_t finish, int measurements);
+  // the density matrices of the links of the qnics with their partners in qnic_partner_map, reconstructed together
+  virtual std::vector<Eigen::Matrix4cd> reconstruct_density_matrices(const std::vector<int> &qnic_ids);
+  virtual bool estimateLinkCosts();
+  simsignal_t registerLinkSignal(const char *name, int partner_address);
+  static double calculateLinkCost(double fidelity, double bellpair_per_sec);
   virtual unsigned long createUniqueId();
+  // the tomography accumulators with their pending outcomes, and the link estimates, for SharedResource's memory accounting
+  void reportMemoryUsage(modules::SharedResource::MemoryAccounting::Usage &usage) const;
   virtual void writeToFile_Topology_with_LinkCost(int qnic_id, double link_cost, double fidelity, double bellpair_per_sec);
 
   std::unique_ptr<quisp::rules::Rule> constructPurifyRule(const std::string &rule_name, const rules::PurType pur_type, const int partner_address, const QNIC_type qnic_type,
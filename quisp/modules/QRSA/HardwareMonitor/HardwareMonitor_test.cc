@@ -57,6 +57,11 @@ class HardwareMonitorTestTarget : public quisp::modules::HardwareMonitor {
     setParBool(this, "z_purification", true);
     setParStr(this, "purification_type", "");
     setParInt(this, "num_measure", 0);
+    setParDouble(this, "link_cost_estimation_interval", 0);
+    setParDouble(this, "tomography_target_precision", 0);
+    setParDouble(this, "tomography_confidence_z", 1.96);
+    setParInt(this, "tomography_min_measurements", 100);
+    setParDouble(this, "connection_tomography_target_precision", 0);
 
     this->setName("hardware_monitor_test_target");
     this->provider.setStrategy(std::make_unique<Strategy>(mock_qubit, routing_daemon));
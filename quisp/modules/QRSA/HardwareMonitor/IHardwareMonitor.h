@@ -4,6 +4,7 @@
 #include <memory>
 
 #include "modules/QNIC.h"
+#include "modules/QRSA/HardwareMonitor/TomographyAccumulator/TomographyAccumulator.h"
 
 using namespace omnetpp;
 
@@ -21,6 +22,8 @@ struct InterfaceInfo {
   int buffer_size;
   double link_cost;
   int neighborQNode_address;
+  // false while the quantum link is down by setQuantumLinkState
+  bool link_up = true;
 };
 
 struct ConnectionSetupInfo {
@@ -37,23 +40,6 @@ const ConnectionSetupInfo NULL_CONNECTION_SETUP_INFO{.qnic =
                                                      .neighbor_address = -1,
                                                      .quantum_link_cost = -1};
 
-struct TomographyOutcome {
-  char my_basis;
-  bool my_output_is_plus;
-  char my_GOD_clean;
-  char partner_basis;
-  bool partner_output_is_plus;
-  char partner_GOD_clean;
-};
-
-struct OutputCount {
-  int total_count;
-  int plus_plus;
-  int plus_minus;
-  int minus_plus;
-  int minus_minus;
-};
-
 struct LinkCost {
   simtime_t tomography_time;
   int tomography_measurements;
@@ -63,19 +49,22 @@ struct LinkCost {
 // qnic_index -> InterfaceInfo
 using NeighborTable = std::map<int, InterfaceInfo>;
 
-// basis combination -> raw output count
-// e.g.
-// "XX" -> {plus_plus = 56, plus_minus = 55, minus_plus = 50, minus_minus = 50},
-// "XY" -> {....
-using RawData = std::map<int, std::map<std::string, OutputCount>>;  // qnic -> partner . basis string . output
 using LinkCostMap = std::map<int, LinkCost>;
-using TomographyOutcomeTable = std::map<int, std::map<int, TomographyOutcome>>;  // partner -> <count_id, outcome>
+using TomographyAccumulatorTable = std::map<int, tomography::TomographyAccumulator>;  // partner -> accumulated outcomes
 
 class IHardwareMonitor : public cSimpleModule {
  public:
   virtual ~IHardwareMonitor(){};
   virtual int getQnicNumQubits(int qnic_index, QNIC_type qnic_type) = 0;
-  virtual std::unique_ptr<InterfaceInfo> findInterfaceByNeighborAddr(int neighbor_address) = 0;
-  virtual std::unique_ptr<ConnectionSetupInfo> findConnectionInfoByQnicAddr(int qnic_address) = 0;
+  /// @brief the interface towards the neighbor QNode, or nullptr. The pointer is valid as long as the module.
+  virtual const InterfaceInfo *findInterfaceByNeighborAddr(int neighbor_address) = 0;
+  /// @brief the qnic and the neighbor QNode of the qnic address, or nullptr. The pointer is valid as long as the module.
+  virtual const ConnectionSetupInfo *findConnectionInfoByQnicAddr(int qnic_address) = 0;
+  /// @brief takes the quantum link to the neighbor QNode down or back up, e.g. to inject a failure.
+  virtual void setQuantumLinkState(int neighbor_address, bool up) = 0;
+  /// @brief the Bell pairs per second of the link of the qnic measured by the link tomography, or 0 before it.
+  virtual double getLinkPairRate(int qnic_address) = 0;
+  /// @brief the last fidelity of the link of the qnic estimated during the link tomography, or 0 before it.
+  virtual double getLinkFidelity(int qnic_address) = 0;
 };
 }  // namespace quisp::modules
@@ -0,0 +1,160 @@
+#include "TomographyAccumulator.h"
+
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unsupported/Eigen/KroneckerProduct>
+
+namespace quisp::modules::tomography {
+
+namespace {
+using PauliProductBasis = Eigen::Matrix<std::complex<double>, 16, 16>;
+
+// the column a * 4 + b is the column-major sigma_a (x) sigma_b / 4, so the basis times the Stokes parameters is the density matrix
+const PauliProductBasis &pauliProductBasis() {
+  static const PauliProductBasis basis = [] {
+    std::array<Eigen::Matrix2cd, 4> paulis;
+    paulis[0] << 1, 0, 0, 1;
+    paulis[1] << 0, 1, 1, 0;
+    paulis[2] << 0, std::complex<double>(0, -1), std::complex<double>(0, 1), 0;
+    paulis[3] << 1, 0, 0, -1;
+    PauliProductBasis basis;
+    for (int a = 0; a < 4; a++) {
+      for (int b = 0; b < 4; b++) {
+        Eigen::Matrix4cd product = kroneckerProduct(paulis[a], paulis[b]).eval() / 4.0;
+        basis.col(a * 4 + b) = Eigen::Map<const Eigen::Matrix<std::complex<double>, 16, 1>>(product.data());
+      }
+    }
+    return basis;
+  }();
+  return basis;
+}
+}  // namespace
+
+bool TomographyAccumulator::addMeasurement(int count_id, bool is_mine, const MeasurementHalf &half) {
+  basisIndex(half.basis);
+  auto &outcome = pending[count_id];
+  if (is_mine) {
+    outcome.mine = half;
+    outcome.has_mine = true;
+  } else {
+    outcome.partner = half;
+    outcome.has_partner = true;
+  }
+  if (!outcome.has_mine || !outcome.has_partner) return false;
+  fold(outcome.mine, outcome.partner);
+  pending.erase(count_id);
+  return true;
+}
+
+const OutputCount &TomographyAccumulator::getOutputCount(char my_basis, char partner_basis) const {
+  return counts[basisIndex(my_basis) * 3 + basisIndex(partner_basis)];
+}
+
+bool TomographyAccumulator::hasAllBasisCombinations() const {
+  for (auto &count : counts) {
+    if (count.total_count == 0) return false;
+  }
+  return true;
+}
+
+StokesVector TomographyAccumulator::getStokesParameters() const {
+  if (!hasAllBasisCombinations()) throw std::runtime_error("TomographyAccumulator: no outcome in some basis combinations");
+  StokesVector stokes;
+  stokes(0) = 1.0;
+  for (int a = 0; a < 3; a++) {
+    // the marginals come from the combinations in the same basis
+    auto &same = counts[a * 3 + a];
+    double total = same.total_count;
+    stokes((a + 1) * 4) = (same.plus_plus + same.plus_minus - same.minus_plus - same.minus_minus) / total;
+    stokes(a + 1) = (same.plus_plus - same.plus_minus + same.minus_plus - same.minus_minus) / total;
+    for (int b = 0; b < 3; b++) {
+      auto &count = counts[a * 3 + b];
+      stokes((a + 1) * 4 + b + 1) = (count.plus_plus - count.plus_minus - count.minus_plus + count.minus_minus) / static_cast<double>(count.total_count);
+    }
+  }
+  return stokes;
+}
+
+double TomographyAccumulator::estimateFidelity() const {
+  double fidelity = 1;
+  for (int a = 0; a < 3; a++) {
+    auto &same = counts[a * 3 + a];
+    double correlation = (same.plus_plus - same.plus_minus - same.minus_plus + same.minus_minus) / static_cast<double>(same.total_count);
+    // <YY> is -1 for |Phi+>
+    fidelity += a == 1 ? -correlation : correlation;
+  }
+  return fidelity / 4;
+}
+
+double TomographyAccumulator::fidelityConfidenceHalfWidth(double z) const {
+  double variance = 0;
+  for (int a = 0; a < 3; a++) {
+    auto &same = counts[a * 3 + a];
+    if (same.total_count == 0) return std::numeric_limits<double>::infinity();
+    double p = (same.plus_plus + same.minus_minus + 1) / (same.total_count + 2.0);
+    variance += 4 * p * (1 - p) / same.total_count;
+  }
+  return z * std::sqrt(variance) / 4;
+}
+
+Eigen::Matrix4cd TomographyAccumulator::reconstructDensityMatrix() const {
+  Eigen::Matrix<std::complex<double>, 16, 1> density_matrix = pauliProductBasis() * getStokesParameters().cast<std::complex<double>>();
+  return Eigen::Map<Eigen::Matrix4cd>(density_matrix.data());
+}
+
+std::vector<Eigen::Matrix4cd> reconstructDensityMatrices(const std::vector<const TomographyAccumulator *> &accumulators) {
+  Eigen::Matrix<std::complex<double>, 16, Eigen::Dynamic> stokes(16, accumulators.size());
+  for (std::size_t i = 0; i < accumulators.size(); i++) stokes.col(i) = accumulators[i]->getStokesParameters().cast<std::complex<double>>();
+  Eigen::Matrix<std::complex<double>, 16, Eigen::Dynamic> density_matrices = pauliProductBasis() * stokes;
+  std::vector<Eigen::Matrix4cd> results;
+  results.reserve(accumulators.size());
+  for (std::size_t i = 0; i < accumulators.size(); i++) results.emplace_back(Eigen::Map<Eigen::Matrix4cd>(density_matrices.col(i).data()));
+  return results;
+}
+
+int TomographyAccumulator::basisIndex(char basis) {
+  switch (basis) {
+    case 'X':
+      return 0;
+    case 'Y':
+      return 1;
+    case 'Z':
+      return 2;
+    default:
+      throw std::invalid_argument(std::string("TomographyAccumulator: unknown basis ") + basis);
+  }
+}
+
+void TomographyAccumulator::fold(const MeasurementHalf &mine, const MeasurementHalf &partner) {
+  auto &count = counts[basisIndex(mine.basis) * 3 + basisIndex(partner.basis)];
+  count.total_count++;
+  meas_total++;
+
+  // clean pair ... no error bell pairs, or the same error on both qubits
+  // X, Y, Z pair ... the error on one of the qubits
+  char my_GOD = mine.GOD_clean, partner_GOD = partner.GOD_clean;
+  if (my_GOD == partner_GOD && (my_GOD == 'F' || my_GOD == 'X' || my_GOD == 'Y' || my_GOD == 'Z')) {
+    GOD_clean_pair_total++;
+  } else if ((my_GOD == 'X' && partner_GOD == 'F') || (my_GOD == 'F' && partner_GOD == 'X')) {
+    GOD_X_pair_total++;
+  } else if ((my_GOD == 'Z' && partner_GOD == 'F') || (my_GOD == 'F' && partner_GOD == 'Z')) {
+    GOD_Z_pair_total++;
+  } else if ((my_GOD == 'Y' && partner_GOD == 'F') || (my_GOD == 'F' && partner_GOD == 'Y')) {
+    GOD_Y_pair_total++;
+  }
+
+  if (mine.output_is_plus && partner.output_is_plus) {
+    count.plus_plus++;
+  } else if (mine.output_is_plus) {
+    count.plus_minus++;
+  } else if (partner.output_is_plus) {
+    count.minus_plus++;
+  } else {
+    count.minus_minus++;
+  }
+}
+
+}  // namespace quisp::modules::tomography
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <Eigen/Eigen>
+#include <array>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+#include "utils/MemoryUsage.h"
+
+namespace quisp::modules::tomography {
+
+struct OutputCount {
+  int total_count = 0;
+  int plus_plus = 0;
+  int plus_minus = 0;
+  int minus_plus = 0;
+  int minus_minus = 0;
+};
+
+/// @brief the measurement bases of the link tomography, in the order of the basis combination counters.
+enum class TomographyBasis : int { X, Y, Z };
+
+/// @brief the Stokes parameters <sigma_a (x) sigma_b> at a * 4 + b, in the I, X, Y, Z order. a is this node's Pauli and b the partner's.
+using StokesVector = Eigen::Matrix<double, 16, 1>;
+
+/// @brief one node's half of a link tomography outcome.
+struct MeasurementHalf {
+  char basis;
+  bool output_is_plus;
+  char GOD_clean;
+};
+
+/**
+ * @brief TomographyAccumulator summarizes the link tomography outcomes with a partner while they arrive.
+ *
+ * Each outcome consists of this node's and the partner's measurement with the same count_id.
+ * The first half waits in a small pending buffer, and when the other half arrives, the outcome is
+ * folded into the basis combination counters and the entry is freed.
+ * So the memory doesn't grow with the number of measurements, and the counters are up to date at any time.
+ */
+class TomographyAccumulator {
+ public:
+  /// @brief adds a half of the outcome. Returns true if it completed the outcome. Throws std::invalid_argument for an unknown basis.
+  bool addMeasurement(int count_id, bool is_mine, const MeasurementHalf &half);
+  /// @brief the output counts of the completed outcomes measured in the basis combination, e.g. ('X', 'Z').
+  const OutputCount &getOutputCount(char my_basis, char partner_basis) const;
+  const OutputCount &getOutputCount(TomographyBasis my_basis, TomographyBasis partner_basis) const {
+    return counts[static_cast<int>(my_basis) * 3 + static_cast<int>(partner_basis)];
+  }
+  /// @brief true if every basis combination has a completed outcome, so the density matrix can be reconstructed.
+  bool hasAllBasisCombinations() const;
+  /// @brief the Stokes parameters estimated from the counters. Throws std::runtime_error without all basis combinations.
+  StokesVector getStokesParameters() const;
+  /// @brief the fidelity (1 + <XX> - <YY> + <ZZ>) / 4 to |Phi+>, the same as the one of the reconstructed density matrix.
+  double estimateFidelity() const;
+  /**
+   * @brief the half width of the normal confidence interval of estimateFidelity() for the z score, e.g. 1.96 for 95%.
+   * The variances of the correlations use the (k + 1) / (n + 2) estimate, so links without errors don't get a zero width
+   * from a few outcomes. Infinite until XX, YY and ZZ have an outcome each.
+   */
+  double fidelityConfidenceHalfWidth(double z) const;
+  /// @brief the density matrix (1/4) sum_ab S_ab sigma_a (x) sigma_b of the Stokes parameters. Throws std::runtime_error without all basis combinations.
+  Eigen::Matrix4cd reconstructDensityMatrix() const;
+
+  int getTotalMeasurements() const { return meas_total; }
+  int getGODCleanPairTotal() const { return GOD_clean_pair_total; }
+  int getGODXPairTotal() const { return GOD_X_pair_total; }
+  int getGODYPairTotal() const { return GOD_Y_pair_total; }
+  int getGODZPairTotal() const { return GOD_Z_pair_total; }
+  /// @brief the number of the outcomes waiting for the other half.
+  std::size_t pendingSize() const { return pending.size(); }
+  std::size_t allocatedBytes() const { return utils::heapBytesOf(pending); }
+
+ protected:
+  struct PendingOutcome {
+    MeasurementHalf mine;
+    MeasurementHalf partner;
+    bool has_mine = false;
+    bool has_partner = false;
+  };
+
+  static int basisIndex(char basis);
+  void fold(const MeasurementHalf &mine, const MeasurementHalf &partner);
+
+  std::unordered_map<int, PendingOutcome> pending;
+  // [my basis * 3 + partner basis], in the X, Y, Z order
+  std::array<OutputCount, 9> counts{};
+  int meas_total = 0;
+  int GOD_clean_pair_total = 0;
+  int GOD_X_pair_total = 0;
+  int GOD_Y_pair_total = 0;
+  int GOD_Z_pair_total = 0;
+};
+
+/**
+ * @brief reconstructs the density matrices of the links at once.
+ * The Stokes parameters of all the links are stacked and multiplied with the Pauli products in a single matrix product.
+ */
+std::vector<Eigen::Matrix4cd> reconstructDensityMatrices(const std::vector<const TomographyAccumulator *> &accumulators);
+
+}  // namespace quisp::modules::tomography
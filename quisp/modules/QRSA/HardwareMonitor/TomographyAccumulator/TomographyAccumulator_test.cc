@@ -0,0 +1,185 @@
+#include "TomographyAccumulator.h"
+
+#include <gtest/gtest.h>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+using quisp::modules::tomography::MeasurementHalf;
+using quisp::modules::tomography::reconstructDensityMatrices;
+using quisp::modules::tomography::TomographyAccumulator;
+using quisp::modules::tomography::TomographyBasis;
+
+// adds the outcome of a pair measured in the bases
+void addOutcome(TomographyAccumulator &acc, int &count_id, char my_basis, bool my_plus, char partner_basis, bool partner_plus) {
+  acc.addMeasurement(count_id, true, MeasurementHalf{my_basis, my_plus, 'F'});
+  acc.addMeasurement(count_id, false, MeasurementHalf{partner_basis, partner_plus, 'F'});
+  count_id++;
+}
+
+// the outcomes of a state with the correlations <XX>, <YY> and <ZZ> and no other Stokes parameters
+TomographyAccumulator correlatedOutcomes(bool xx_same, bool yy_same, bool zz_same) {
+  TomographyAccumulator acc;
+  int count_id = 0;
+  for (char my_basis : {'X', 'Y', 'Z'}) {
+    for (char partner_basis : {'X', 'Y', 'Z'}) {
+      if (my_basis != partner_basis) {
+        for (bool my_plus : {true, false}) {
+          for (bool partner_plus : {true, false}) addOutcome(acc, count_id, my_basis, my_plus, partner_basis, partner_plus);
+        }
+        continue;
+      }
+      bool same = my_basis == 'X' ? xx_same : my_basis == 'Y' ? yy_same : zz_same;
+      addOutcome(acc, count_id, my_basis, true, partner_basis, same);
+      addOutcome(acc, count_id, my_basis, false, partner_basis, !same);
+    }
+  }
+  return acc;
+}
+
+TEST(TomographyAccumulatorTest, FoldCompletedOutcomes) {
+  TomographyAccumulator acc;
+  // the partner's half can arrive first
+  EXPECT_FALSE(acc.addMeasurement(0, false, MeasurementHalf{'Z', false, 'F'}));
+  EXPECT_FALSE(acc.addMeasurement(1, true, MeasurementHalf{'X', true, 'F'}));
+  EXPECT_EQ(acc.pendingSize(), 2);
+  EXPECT_EQ(acc.getTotalMeasurements(), 0);
+
+  EXPECT_TRUE(acc.addMeasurement(0, true, MeasurementHalf{'X', true, 'X'}));
+  EXPECT_TRUE(acc.addMeasurement(1, false, MeasurementHalf{'X', true, 'F'}));
+  EXPECT_EQ(acc.pendingSize(), 0);
+  EXPECT_EQ(acc.getTotalMeasurements(), 2);
+
+  auto &xz = acc.getOutputCount('X', 'Z');
+  EXPECT_EQ(xz.total_count, 1);
+  EXPECT_EQ(xz.plus_minus, 1);
+  auto &xx = acc.getOutputCount('X', 'X');
+  EXPECT_EQ(xx.total_count, 1);
+  EXPECT_EQ(xx.plus_plus, 1);
+  EXPECT_EQ(acc.getOutputCount('Z', 'X').total_count, 0);
+
+  EXPECT_EQ(acc.getGODCleanPairTotal(), 1);
+  EXPECT_EQ(acc.getGODXPairTotal(), 1);
+}
+
+TEST(TomographyAccumulatorTest, CountIdIsReusableAfterFolding) {
+  TomographyAccumulator acc;
+  for (int i = 0; i < 3; i++) {
+    acc.addMeasurement(5, true, MeasurementHalf{'Y', false, 'F'});
+    EXPECT_TRUE(acc.addMeasurement(5, false, MeasurementHalf{'Y', false, 'F'}));
+  }
+  EXPECT_EQ(acc.getOutputCount('Y', 'Y').minus_minus, 3);
+  EXPECT_EQ(acc.pendingSize(), 0);
+}
+
+TEST(TomographyAccumulatorTest, HasAllBasisCombinations) {
+  TomographyAccumulator acc;
+  int count_id = 0;
+  for (char my_basis : {'X', 'Y', 'Z'}) {
+    for (char partner_basis : {'X', 'Y', 'Z'}) {
+      EXPECT_FALSE(acc.hasAllBasisCombinations());
+      acc.addMeasurement(count_id, true, MeasurementHalf{my_basis, true, 'F'});
+      acc.addMeasurement(count_id, false, MeasurementHalf{partner_basis, true, 'F'});
+      count_id++;
+    }
+  }
+  EXPECT_TRUE(acc.hasAllBasisCombinations());
+}
+
+TEST(TomographyAccumulatorTest, RejectUnknownBasis) {
+  TomographyAccumulator acc;
+  EXPECT_THROW(acc.addMeasurement(0, true, MeasurementHalf{'W', true, 'F'}), std::invalid_argument);
+  EXPECT_EQ(acc.pendingSize(), 0);
+  EXPECT_THROW(acc.getOutputCount('X', 'I'), std::invalid_argument);
+}
+
+TEST(TomographyAccumulatorTest, EnumIndexedOutputCount) {
+  TomographyAccumulator acc;
+  int count_id = 0;
+  addOutcome(acc, count_id, 'Y', true, 'Z', false);
+  EXPECT_EQ(&acc.getOutputCount(TomographyBasis::Y, TomographyBasis::Z), &acc.getOutputCount('Y', 'Z'));
+  EXPECT_EQ(acc.getOutputCount(TomographyBasis::Y, TomographyBasis::Z).plus_minus, 1);
+}
+
+TEST(TomographyAccumulatorTest, ReconstructBellPair) {
+  // |Phi+> has <XX> = 1, <YY> = -1 and <ZZ> = 1
+  auto acc = correlatedOutcomes(true, false, true);
+  auto stokes = acc.getStokesParameters();
+  EXPECT_DOUBLE_EQ(stokes(0), 1);
+  EXPECT_DOUBLE_EQ(stokes(1 * 4 + 1), 1);
+  EXPECT_DOUBLE_EQ(stokes(2 * 4 + 2), -1);
+  EXPECT_DOUBLE_EQ(stokes(3 * 4 + 3), 1);
+  EXPECT_DOUBLE_EQ(stokes(1 * 4 + 3), 0);
+  EXPECT_DOUBLE_EQ(stokes(3), 0);
+
+  Eigen::Vector4cd bell_pair;
+  bell_pair << 1 / sqrt(2), 0, 0, 1 / sqrt(2);
+  Eigen::Matrix4cd expected = bell_pair * bell_pair.adjoint();
+  EXPECT_TRUE(acc.reconstructDensityMatrix().isApprox(expected));
+}
+
+TEST(TomographyAccumulatorTest, ReconstructMarginals) {
+  // this node always measures + and the partner -, i.e. the product state |+>|->, |+i>|-i> or |0>|1> per basis
+  TomographyAccumulator acc;
+  int count_id = 0;
+  for (char my_basis : {'X', 'Y', 'Z'}) {
+    for (char partner_basis : {'X', 'Y', 'Z'}) addOutcome(acc, count_id, my_basis, true, partner_basis, false);
+  }
+  auto stokes = acc.getStokesParameters();
+  for (int a = 1; a < 4; a++) {
+    EXPECT_DOUBLE_EQ(stokes(a * 4), 1);
+    EXPECT_DOUBLE_EQ(stokes(a), -1);
+  }
+  auto density_matrix = acc.reconstructDensityMatrix();
+  EXPECT_NEAR(density_matrix.trace().real(), 1, 1e-12);
+  EXPECT_TRUE(density_matrix.isApprox(density_matrix.adjoint()));
+}
+
+TEST(TomographyAccumulatorTest, ReconstructLinksAtOnce) {
+  auto phi_plus = correlatedOutcomes(true, false, true);
+  auto psi_minus = correlatedOutcomes(false, false, false);
+  auto density_matrices = reconstructDensityMatrices({&phi_plus, &psi_minus});
+  ASSERT_EQ(density_matrices.size(), 2);
+  EXPECT_TRUE(density_matrices[0].isApprox(phi_plus.reconstructDensityMatrix()));
+  EXPECT_TRUE(density_matrices[1].isApprox(psi_minus.reconstructDensityMatrix()));
+  EXPECT_NEAR(density_matrices[1](1, 2).real(), -0.5, 1e-12);
+  EXPECT_TRUE(reconstructDensityMatrices({}).empty());
+}
+
+TEST(TomographyAccumulatorTest, FidelityConfidenceInterval) {
+  TomographyAccumulator acc;
+  EXPECT_EQ(acc.fidelityConfidenceHalfWidth(1.96), std::numeric_limits<double>::infinity());
+  int count_id = 0;
+  double last_half_width = std::numeric_limits<double>::infinity();
+  for (int round = 0; round < 4; round++) {
+    // a perfect |Phi+> measured in XX, YY and ZZ
+    for (int i = 0; i < 25; i++) {
+      addOutcome(acc, count_id, 'X', i % 2 == 0, 'X', i % 2 == 0);
+      addOutcome(acc, count_id, 'Y', i % 2 == 0, 'Y', i % 2 != 0);
+      addOutcome(acc, count_id, 'Z', i % 2 == 0, 'Z', i % 2 == 0);
+    }
+    EXPECT_DOUBLE_EQ(acc.estimateFidelity(), 1);
+    double half_width = acc.fidelityConfidenceHalfWidth(1.96);
+    EXPECT_GT(half_width, 0);
+    EXPECT_LT(half_width, last_half_width);
+    last_half_width = half_width;
+  }
+  auto bell_pair = correlatedOutcomes(true, false, true);
+  EXPECT_NEAR(bell_pair.estimateFidelity(), 1, 1e-12);
+  auto mixed = correlatedOutcomes(true, true, true);
+  // <YY> = +1 instead of -1 halves the fidelity
+  EXPECT_NEAR(mixed.estimateFidelity(), 0.5, 1e-12);
+  Eigen::Vector4cd phi_plus;
+  phi_plus << 1 / sqrt(2), 0, 0, 1 / sqrt(2);
+  EXPECT_NEAR((phi_plus.adjoint() * mixed.reconstructDensityMatrix() * phi_plus)(0).real(), 0.5, 1e-12);
+}
+
+TEST(TomographyAccumulatorTest, ReconstructionNeedsAllBasisCombinations) {
+  TomographyAccumulator acc;
+  int count_id = 0;
+  addOutcome(acc, count_id, 'X', true, 'X', true);
+  EXPECT_THROW(acc.getStokesParameters(), std::runtime_error);
+  EXPECT_THROW(reconstructDensityMatrices({&acc}), std::runtime_error);
+}
+
+}  // namespace
@@ -4,6 +4,9 @@
 #include "modules/QNIC.h"
 #include "modules/QRSA/QRSA.h"
 #include "modules/QRSA/RuleEngine/QubitRecord/IQubitRecord.h"
+
+#include <vector>
+
 namespace quisp {
 namespace modules {
 
@@ -14,8 +17,16 @@ class IRealTimeController : public cSimpleModule {
 
  public:
   virtual void EmitPhoton(int qnic_index, int qubit_index, QNIC_type qnic_type, int pulse) = 0;
+  // emits the photons of the qubits interval apart, as one PhotonicQubitTrain
+  // emits the photons of the qubits interval apart as the time-bin modes of one pulse, a PhotonicQubit each.
+  // the first photon gets the BEGIN of the pulse flags and the last one the END
+  virtual void EmitPhotonPulse(int qnic_index, const std::vector<int>& qubit_indices, QNIC_type qnic_type, simtime_t interval, int pulse) = 0;
+  virtual void EmitPhotonTrain(int qnic_index, const std::vector<int>& qubit_indices, QNIC_type qnic_type, simtime_t interval) = 0;
   virtual void ReInitialize_StationaryQubit(int qnic_index, int qubit_index, QNIC_type qnic_type, bool consumed) = 0;
   virtual void ReInitialize_StationaryQubit(qrsa::IQubitRecord* const qubit_record, bool consumed) = 0;
+  virtual void ReInitialize_StationaryQubits(int qnic_index, const std::vector<int>& qubit_indices, QNIC_type qnic_type, bool consumed) = 0;
+  // frees the qubits of the records as a batch: their backend qubits in one IQuantumBackend::setFree, and a log line and a bubble for all of them
+  virtual void ReInitialize_StationaryQubits(const std::vector<qrsa::IQubitRecord*>& qubit_records, bool consumed) = 0;
   virtual void applyXGate(qrsa::IQubitRecord* const qubit_record) = 0;
   virtual void applyZGate(qrsa::IQubitRecord* const qubit_record) = 0;
   virtual void applyYGate(qrsa::IQubitRecord* const qubit_record) = 0;
@@ -4,12 +4,20 @@
  */
 #include "RealTimeController.h"
 
+#include <string>
+
+#include "modules/QNIC/StationaryQubit/StationaryQubit.h"
+#include "utils/Headless.h"
+
 namespace quisp::modules {
 
 Define_Module(RealTimeController);
 
 RealTimeController::RealTimeController() : provider(utils::ComponentProvider{this}) {}
-void RealTimeController::initialize() { myAddress = provider.getNodeAddr(); }
+void RealTimeController::initialize() {
+  myAddress = provider.getNodeAddr();
+  backend = provider.getQuantumBackend();
+}
 
 void RealTimeController::handleMessage(cMessage *msg) {}
 
@@ -19,6 +27,26 @@ void RealTimeController::EmitPhoton(int qnic_index, int qubit_index, QNIC_type q
   q->emitPhoton(pulse);
 }
 
+void RealTimeController::EmitPhotonPulse(int qnic_index, const std::vector<int> &qubit_indices, QNIC_type qnic_type, simtime_t interval, int pulse) {
+  Enter_Method("EmitPhotonPulse()");
+  for (size_t i = 0; i < qubit_indices.size(); i++) {
+    int bin_pulse = 0;
+    if (i == 0) bin_pulse |= pulse & STATIONARYQUBIT_PULSE_BEGIN;
+    if (i == qubit_indices.size() - 1) bin_pulse |= pulse & STATIONARYQUBIT_PULSE_END;
+    provider.getStationaryQubit(qnic_index, qubit_indices[i], qnic_type)->emitPhotonInTimeBin(bin_pulse, interval * (long)i);
+  }
+}
+
+void RealTimeController::EmitPhotonTrain(int qnic_index, const std::vector<int> &qubit_indices, QNIC_type qnic_type, simtime_t interval) {
+  Enter_Method("EmitPhotonTrain()");
+  if (qubit_indices.empty()) return;
+  auto *train = new messages::PhotonicQubitTrain("PhotonTrain");
+  for (size_t i = 0; i < qubit_indices.size(); i++) {
+    provider.getStationaryQubit(qnic_index, qubit_indices[i], qnic_type)->emitPhotonIntoTrain(train, interval * (long)i);
+  }
+  provider.getStationaryQubit(qnic_index, qubit_indices.front(), qnic_type)->sendPhotonTrain(train);
+}
+
 void RealTimeController::ReInitialize_StationaryQubit(int qnic_index, int qubit_index, QNIC_type qnic_type, bool consumed) {
   auto *q = provider.getStationaryQubit(qnic_index, qubit_index, qnic_type);
   q->setFree(consumed);
@@ -28,6 +56,33 @@ void RealTimeController::ReInitialize_StationaryQubit(qrsa::IQubitRecord *const
   qubit->setFree(consumed);
 }
 
+void RealTimeController::ReInitialize_StationaryQubits(int qnic_index, const std::vector<int> &qubit_indices, QNIC_type qnic_type, bool consumed) {
+  qubits_to_free.clear();
+  for (auto qubit_index : qubit_indices) qubits_to_free.push_back(provider.getStationaryQubit(qnic_index, qubit_index, qnic_type));
+  freeQubits(consumed);
+}
+
+void RealTimeController::ReInitialize_StationaryQubits(const std::vector<qrsa::IQubitRecord *> &qubit_records, bool consumed) {
+  qubits_to_free.clear();
+  for (auto *qubit_record : qubit_records) qubits_to_free.push_back(provider.getStationaryQubit(qubit_record));
+  freeQubits(consumed);
+}
+
+void RealTimeController::freeQubits(bool consumed) {
+  if (qubits_to_free.empty()) return;
+  backend_qubits_to_free.clear();
+  for (auto *qubit : qubits_to_free) {
+    if (auto *backend_qubit = qubit->setFreeInBatch(consumed)) backend_qubits_to_free.push_back(backend_qubit);
+  }
+  if (backend != nullptr) {
+    backend->setFree(backend_qubits_to_free);
+  } else {
+    for (auto *backend_qubit : backend_qubits_to_free) backend_qubit->setFree();
+  }
+  EV_DEBUG << "Freeing " << qubits_to_free.size() << " qubits at qnode: " << myAddress << "\n";
+  if (utils::showsGUI(this)) bubble(((consumed ? "Consumed " : "Failed to entangle ") + std::to_string(qubits_to_free.size()) + " qubits").c_str());
+}
+
 void RealTimeController::applyXGate(qrsa::IQubitRecord *const qubit_record) {
   auto *qubit = provider.getStationaryQubit(qubit_record);
   qubit->gateX();
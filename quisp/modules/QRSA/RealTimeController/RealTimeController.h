@@ -18,6 +18,12 @@ namespace modules {
 class RealTimeController : public IRealTimeController {
  private:
   int myAddress;
+  // frees qubits_to_free as one batch
+  void freeQubits(bool consumed);
+  backends::IQuantumBackend* backend = nullptr;
+  // the batch being freed, reused to keep its capacity
+  std::vector<IStationaryQubit*> qubits_to_free;
+  std::vector<backends::IQubit*> backend_qubits_to_free;
 
  protected:
   virtual void initialize() override;
@@ -26,8 +32,12 @@ class RealTimeController : public IRealTimeController {
  public:
   RealTimeController();
   void EmitPhoton(int qnic_index, int qubit_index, QNIC_type qnic_type, int pulse) override;
+  void EmitPhotonPulse(int qnic_index, const std::vector<int>& qubit_indices, QNIC_type qnic_type, simtime_t interval, int pulse) override;
+  void EmitPhotonTrain(int qnic_index, const std::vector<int>& qubit_indices, QNIC_type qnic_type, simtime_t interval) override;
   void ReInitialize_StationaryQubit(int qnic_index, int qubit_index, QNIC_type qnic_type, bool consumed) override;
   void ReInitialize_StationaryQubit(qrsa::IQubitRecord* const qubit_record, bool consumed) override;
+  void ReInitialize_StationaryQubits(int qnic_index, const std::vector<int>& qubit_indices, QNIC_type qnic_type, bool consumed) override;
+  void ReInitialize_StationaryQubits(const std::vector<qrsa::IQubitRecord*>& qubit_records, bool consumed) override;
 
   void applyXGate(qrsa::IQubitRecord* const qubit_record) override;
   void applyZGate(qrsa::IQubitRecord* const qubit_record) override;
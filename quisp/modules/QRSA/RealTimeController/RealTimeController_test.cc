@@ -3,10 +3,13 @@
 #include <gtest/gtest.h>
 #include <omnetpp.h>
 #include <utils/IComponentProviderStrategy.h>
+#include <memory>
+#include "modules/Logger/DisabledLogger.h"
 #include "modules/QNIC.h"
 #include "modules/QNIC/StationaryQubit/StationaryQubit.h"
 #include "modules/QRSA/HardwareMonitor/HardwareMonitor.h"
 #include "modules/QRSA/RoutingDaemon/RoutingDaemon.h"
+#include "modules/QRSA/RuleEngine/QubitRecord/QubitRecord.h"
 #include "omnetpp/csimulation.h"
 #include "test_utils/TestUtils.h"
 
@@ -16,6 +19,9 @@ using namespace omnetpp;
 using namespace quisp::utils;
 using namespace quisp::modules;
 using namespace quisp_test;
+using quisp::modules::Logger::DisabledLogger;
+using quisp::modules::qrsa::IQubitRecord;
+using quisp::modules::qubit_record::QubitRecord;
 
 class Strategy : public quisp_test::TestComponentProviderStrategy {
  public:
@@ -59,6 +65,32 @@ TEST(RealTimeControllerTest, EmitPhoton) {
   c.EmitPhoton(1, 2, quisp::modules::QNIC_E, 7);
 }
 
+TEST(RealTimeControllerTest, EmitPhotonTrain) {
+  prepareSimulation();
+  auto* qubit = new MockQubit{};
+  RTCTestTarget c{qubit};
+  c.initialize();
+
+  EXPECT_CALL(*qubit, emitPhotonIntoTrain(testing::NotNull(), SimTime(0))).Times(1);
+  EXPECT_CALL(*qubit, emitPhotonIntoTrain(testing::NotNull(), SimTime(2, SIMTIME_NS))).Times(1);
+  EXPECT_CALL(*qubit, emitPhotonIntoTrain(testing::NotNull(), SimTime(4, SIMTIME_NS))).Times(1);
+  EXPECT_CALL(*qubit, sendPhotonTrain(testing::NotNull())).WillOnce([](quisp::messages::PhotonicQubitTrain* train) { delete train; });
+  c.EmitPhotonTrain(1, {0, 2, 3}, quisp::modules::QNIC_E, SimTime(2, SIMTIME_NS));
+}
+
+TEST(RealTimeControllerTest, EmitPhotonPulse) {
+  prepareSimulation();
+  auto* qubit = new MockQubit{};
+  RTCTestTarget c{qubit};
+  c.initialize();
+
+  // the modes take the bins of the pulse one after another, the flags of the pulse go to its ends
+  EXPECT_CALL(*qubit, emitPhotonInTimeBin(STATIONARYQUBIT_PULSE_BEGIN, SimTime(0))).Times(1);
+  EXPECT_CALL(*qubit, emitPhotonInTimeBin(0, SimTime(2, SIMTIME_NS))).Times(1);
+  EXPECT_CALL(*qubit, emitPhotonInTimeBin(STATIONARYQUBIT_PULSE_END, SimTime(4, SIMTIME_NS))).Times(1);
+  c.EmitPhotonPulse(1, {0, 2, 3}, quisp::modules::QNIC_E, SimTime(2, SIMTIME_NS), STATIONARYQUBIT_PULSE_BOUND);
+}
+
 TEST(RealTimeControllerTest, ReInitializeStationaryQubit) {
   prepareSimulation();
   auto* qubit = new MockQubit{};
@@ -69,4 +101,34 @@ TEST(RealTimeControllerTest, ReInitializeStationaryQubit) {
   c.ReInitialize_StationaryQubit(1, 2, quisp::modules::QNIC_E, true);
 }
 
+TEST(RealTimeControllerTest, ReInitializeStationaryQubits) {
+  prepareSimulation();
+  auto* qubit = new MockQubit{};
+  RTCTestTarget c{qubit};
+  c.initialize();
+
+  // the qubits are reset as a batch, then their backend qubits are freed
+  MockBackendQubit backend_qubit;
+  EXPECT_CALL(*qubit, setFreeInBatch(false)).Times(3).WillRepeatedly(testing::Return(&backend_qubit));
+  EXPECT_CALL(backend_qubit, setFree()).Times(3);
+  c.ReInitialize_StationaryQubits(1, {0, 2, 3}, quisp::modules::QNIC_E, false);
+}
+
+TEST(RealTimeControllerTest, ReInitializeStationaryQubitRecords) {
+  prepareSimulation();
+  auto* qubit = new MockQubit{};
+  RTCTestTarget c{qubit};
+  c.initialize();
+  auto logger = std::make_unique<DisabledLogger>();
+  QubitRecord record0{quisp::modules::QNIC_E, 1, 0, logger.get()};
+  QubitRecord record1{quisp::modules::QNIC_E, 1, 1, logger.get()};
+
+  // a lazy backend qubit that isn't materialized isn't freed
+  MockBackendQubit backend_qubit;
+  EXPECT_CALL(*qubit, setFreeInBatch(true)).WillOnce(testing::Return(&backend_qubit)).WillOnce(testing::Return(nullptr));
+  EXPECT_CALL(backend_qubit, setFree()).Times(1);
+  c.ReInitialize_StationaryQubits({&record0, &record1}, true);
+  c.ReInitialize_StationaryQubits(std::vector<IQubitRecord*>{}, true);
+}
+
 }  // namespace
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <omnetpp.h>
+#include <vector>
 
 using omnetpp::cSimpleModule;
 
@@ -10,5 +11,9 @@ class IRoutingDaemon : public cSimpleModule {
  public:
   virtual int getNumEndNodes() = 0;
   virtual int findQNicAddrByDestAddr(int destAddr) = 0;
+  /// @brief the qnics towards the first hops of the alternative paths, the first one is findQNicAddrByDestAddr(destAddr)
+  virtual std::vector<int> findQNicAddrsByDestAddr(int destAddr) = 0;
+  /// @brief the qnic towards the cheapest path whose swapped pairs meet the fidelity, or towards the cleanest path if none does
+  virtual int findQNicAddrForFidelity(int destAddr, double threshold_fidelity) = 0;
 };
 }  // namespace quisp::modules
@@ -0,0 +1,96 @@
+#include "KShortestPaths.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+
+namespace quisp::modules::routing_daemon {
+
+KShortestPaths::KShortestPaths(int num_nodes) : adjacency(num_nodes) {}
+
+void KShortestPaths::addEdge(int from, int to, double cost) {
+  if (from < 0 || to < 0 || from >= (int)adjacency.size() || to >= (int)adjacency.size()) throw std::out_of_range("KShortestPaths::addEdge: node out of range");
+  for (auto &[neighbor, edge_cost] : adjacency[from]) {
+    if (neighbor != to) continue;
+    edge_cost = std::min(edge_cost, cost);
+    return;
+  }
+  adjacency[from].emplace_back(to, cost);
+}
+
+std::vector<Path> KShortestPaths::find(int src, int dst, int k) const {
+  std::vector<Path> paths;
+  std::vector<bool> no_removed_nodes(adjacency.size(), false);
+  auto shortest = shortestPath(src, dst, no_removed_nodes, {});
+  if (!shortest) return paths;
+  paths.push_back(*shortest);
+
+  // ordered by the cost, and then by the nodes so that the result doesn't depend on the insertion order
+  std::set<std::pair<double, std::vector<int>>> candidates;
+  while ((int)paths.size() < k) {
+    const auto &last_path = paths.back().nodes;
+    double root_cost = 0;
+    for (size_t i = 0; i + 1 < last_path.size(); i++) {
+      const int spur_node = last_path[i];
+      // the edges used by the found paths sharing the root, so that the spur path deviates from all of them
+      std::set<std::pair<int, int>> removed_edges;
+      for (const auto &path : paths) {
+        if (path.nodes.size() > i + 1 && std::equal(last_path.begin(), last_path.begin() + i + 1, path.nodes.begin())) removed_edges.emplace(path.nodes[i], path.nodes[i + 1]);
+      }
+      std::vector<bool> removed_nodes(adjacency.size(), false);
+      for (size_t j = 0; j < i; j++) removed_nodes[last_path[j]] = true;
+
+      if (auto spur_path = shortestPath(spur_node, dst, removed_nodes, removed_edges)) {
+        std::vector<int> nodes(last_path.begin(), last_path.begin() + i);
+        nodes.insert(nodes.end(), spur_path->nodes.begin(), spur_path->nodes.end());
+        candidates.emplace(root_cost + spur_path->cost, std::move(nodes));
+      }
+      root_cost += edgeCost(last_path[i], last_path[i + 1]);
+    }
+    if (candidates.empty()) break;
+    auto next = candidates.begin();
+    paths.push_back(Path{next->second, next->first});
+    candidates.erase(next);
+  }
+  return paths;
+}
+
+std::optional<Path> KShortestPaths::shortestPath(int src, int dst, const std::vector<bool> &removed_nodes, const std::set<std::pair<int, int>> &removed_edges) const {
+  constexpr double infinity = std::numeric_limits<double>::infinity();
+  std::vector<double> distances(adjacency.size(), infinity);
+  std::vector<int> prev_nodes(adjacency.size(), -1);
+  using Entry = std::pair<double, int>;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+  distances[src] = 0;
+  queue.emplace(0, src);
+  while (!queue.empty()) {
+    auto [distance, node] = queue.top();
+    queue.pop();
+    if (distance > distances[node]) continue;
+    if (node == dst) break;
+    for (const auto &[neighbor, cost] : adjacency[node]) {
+      if (removed_nodes[neighbor] || removed_edges.count({node, neighbor})) continue;
+      if (distance + cost >= distances[neighbor]) continue;
+      distances[neighbor] = distance + cost;
+      prev_nodes[neighbor] = node;
+      queue.emplace(distances[neighbor], neighbor);
+    }
+  }
+  if (distances[dst] == infinity) return std::nullopt;
+
+  Path path{{}, distances[dst]};
+  for (int node = dst; node != -1; node = prev_nodes[node]) path.nodes.push_back(node);
+  std::reverse(path.nodes.begin(), path.nodes.end());
+  return path;
+}
+
+double KShortestPaths::edgeCost(int from, int to) const {
+  for (const auto &[neighbor, cost] : adjacency[from]) {
+    if (neighbor == to) return cost;
+  }
+  throw std::out_of_range("KShortestPaths::edgeCost: no edge");
+}
+
+}  // namespace quisp::modules::routing_daemon
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <optional>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace quisp::modules::routing_daemon {
+
+struct Path {
+  std::vector<int> nodes;
+  double cost = 0;
+};
+
+/**
+ * @brief KShortestPaths finds the k shortest loopless paths between two nodes of a directed graph by Yen's algorithm.
+ *
+ * The nodes are the indices [0, num_nodes). Each of the k paths costs a Dijkstra run per node of the previous path,
+ * so the callers should cache the paths instead of finding them per request.
+ */
+class KShortestPaths {
+ public:
+  explicit KShortestPaths(int num_nodes);
+
+  /// @brief adds a directed edge. A parallel edge with a lower cost replaces the higher one.
+  void addEdge(int from, int to, double cost);
+
+  /// @brief returns up to k paths from src to dst in the order of their costs, or nothing if dst is unreachable.
+  std::vector<Path> find(int src, int dst, int k) const;
+
+ private:
+  std::optional<Path> shortestPath(int src, int dst, const std::vector<bool> &removed_nodes, const std::set<std::pair<int, int>> &removed_edges) const;
+  double edgeCost(int from, int to) const;
+
+  // node -> {neighbor, cost}
+  std::vector<std::vector<std::pair<int, double>>> adjacency;
+};
+
+}  // namespace quisp::modules::routing_daemon
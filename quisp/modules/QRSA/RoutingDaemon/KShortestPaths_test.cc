@@ -0,0 +1,51 @@
+#include "KShortestPaths.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+using quisp::modules::routing_daemon::KShortestPaths;
+
+void addLink(KShortestPaths &graph, int a, int b, double cost) {
+  graph.addEdge(a, b, cost);
+  graph.addEdge(b, a, cost);
+}
+
+TEST(KShortestPathsTest, FindPathsInOrderOfCost) {
+  // 0-1 (1), 0-2 (2), 1-3 (1), 1-4 (3), 2-4 (1), 3-5 (1), 4-5 (1)
+  KShortestPaths graph{6};
+  addLink(graph, 0, 1, 1);
+  addLink(graph, 0, 2, 2);
+  addLink(graph, 1, 3, 1);
+  addLink(graph, 1, 4, 3);
+  addLink(graph, 2, 4, 1);
+  addLink(graph, 3, 5, 1);
+  addLink(graph, 4, 5, 1);
+
+  auto paths = graph.find(0, 5, 4);
+  ASSERT_EQ(paths.size(), 4);
+  EXPECT_EQ(paths[0].nodes, (std::vector<int>{0, 1, 3, 5}));
+  EXPECT_DOUBLE_EQ(paths[0].cost, 3);
+  EXPECT_EQ(paths[1].nodes, (std::vector<int>{0, 2, 4, 5}));
+  EXPECT_DOUBLE_EQ(paths[1].cost, 4);
+  EXPECT_EQ(paths[2].nodes, (std::vector<int>{0, 1, 4, 5}));
+  EXPECT_DOUBLE_EQ(paths[2].cost, 5);
+  EXPECT_EQ(paths[3].nodes, (std::vector<int>{0, 2, 4, 1, 3, 5}));
+  EXPECT_DOUBLE_EQ(paths[3].cost, 8);
+
+  // there are only 4 loopless paths
+  EXPECT_EQ(graph.find(0, 5, 10).size(), 4);
+}
+
+TEST(KShortestPathsTest, UnreachableAndParallelEdges) {
+  KShortestPaths graph{3};
+  graph.addEdge(0, 1, 5);
+  graph.addEdge(0, 1, 2);
+  auto paths = graph.find(0, 1, 2);
+  ASSERT_EQ(paths.size(), 1);
+  EXPECT_DOUBLE_EQ(paths[0].cost, 2);
+  EXPECT_TRUE(graph.find(1, 0, 2).empty());
+  EXPECT_TRUE(graph.find(0, 2, 2).empty());
+  EXPECT_THROW(graph.addEdge(0, 3, 1), std::out_of_range);
+}
+
+}  // namespace
@@ -0,0 +1,57 @@
+#include "ParetoPaths.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include <tuple>
+
+namespace quisp::modules::routing_daemon {
+
+ParetoPaths::ParetoPaths(int num_nodes) : adjacency(num_nodes) {}
+
+double ParetoPaths::wernerParameterOf(double fidelity) { return std::clamp((4 * fidelity - 1) / 3, 0.0, 1.0); }
+
+void ParetoPaths::addEdge(int from, int to, double cost, double werner_parameter) {
+  if (from < 0 || to < 0 || from >= (int)adjacency.size() || to >= (int)adjacency.size()) throw std::out_of_range("ParetoPaths::addEdge: node out of range");
+  for (auto &edge : adjacency[from]) {
+    if (edge.to != to) continue;
+    if (cost <= edge.cost && werner_parameter >= edge.werner_parameter) edge = {to, cost, werner_parameter};
+    return;
+  }
+  adjacency[from].push_back({to, cost, werner_parameter});
+}
+
+std::vector<std::vector<ParetoPath>> ParetoPaths::findFrom(int src, std::size_t max_labels_per_node) const {
+  if (src < 0 || src >= (int)adjacency.size()) throw std::out_of_range("ParetoPaths::findFrom: node out of range");
+  std::vector<std::vector<ParetoPath>> fronts(adjacency.size());
+  // {cost, -werner_parameter, node, first_hop}, the cheapest and then the cleanest first
+  using Label = std::tuple<double, double, int, int>;
+  std::priority_queue<Label, std::vector<Label>, std::greater<Label>> queue;
+  queue.emplace(0, -1.0, src, -1);
+  while (!queue.empty()) {
+    const auto [cost, negative_werner_parameter, node, first_hop] = queue.top();
+    queue.pop();
+    auto &front = fronts[node];
+    const double werner_parameter = -negative_werner_parameter;
+    // the labels of the front are cheaper or as cheap, so the last one is the cleanest
+    if (front.size() >= max_labels_per_node || (!front.empty() && front.back().werner_parameter >= werner_parameter)) continue;
+    front.push_back({cost, werner_parameter, first_hop});
+    for (const auto &edge : adjacency[node]) {
+      if (edge.to == src) continue;
+      queue.emplace(cost + edge.cost, -werner_parameter * edge.werner_parameter, edge.to, node == src ? edge.to : first_hop);
+    }
+  }
+  fronts[src].clear();
+  return fronts;
+}
+
+const ParetoPath *ParetoPaths::cheapestMeeting(const std::vector<ParetoPath> &front, double threshold_fidelity) {
+  if (front.empty()) return nullptr;
+  for (const auto &path : front) {
+    if (path.fidelity() >= threshold_fidelity) return &path;
+  }
+  return &front.back();
+}
+
+}  // namespace quisp::modules::routing_daemon
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace quisp::modules::routing_daemon {
+
+/// @brief a path on the Pareto front of (cost, fidelity), by its first hop from the source.
+struct ParetoPath {
+  double cost = 0;
+  // the product of the Werner parameters of the links, the fidelity of the swapped pair without purification
+  double werner_parameter = 1;
+  int first_hop = -1;
+  double fidelity() const { return (3 * werner_parameter + 1) / 4; }
+};
+
+/**
+ * @brief ParetoPaths finds the paths from a source that no other path beats on both the cost and the fidelity.
+ *
+ * The fidelity of a path is that of the Werner state swapped over its links, so the Werner parameters multiply along the path.
+ * The search is the label-setting algorithm of Martins: the labels leave the queue in the order of their costs,
+ * and a label stays only if none of the node's labels has both a lower or equal cost and a higher or equal fidelity.
+ * max_labels_per_node bounds the front of each node, keeping the cheapest ones.
+ */
+class ParetoPaths {
+ public:
+  explicit ParetoPaths(int num_nodes);
+
+  /// @brief the Werner parameter of a link of fidelity F, (4F - 1) / 3 clamped into [0, 1].
+  static double wernerParameterOf(double fidelity);
+
+  /// @brief adds a directed edge. A parallel edge replaces the old one if it's better on both.
+  void addEdge(int from, int to, double cost, double werner_parameter);
+
+  /// @brief the Pareto fronts of all the nodes from src, each ordered by the cost and so by the fidelity as well.
+  std::vector<std::vector<ParetoPath>> findFrom(int src, std::size_t max_labels_per_node) const;
+
+  /// @brief the cheapest path of the front meeting the fidelity, or the one of the highest fidelity if none does. nullptr for an empty front.
+  static const ParetoPath *cheapestMeeting(const std::vector<ParetoPath> &front, double threshold_fidelity);
+
+ private:
+  struct Edge {
+    int to;
+    double cost;
+    double werner_parameter;
+  };
+  // node -> its out edges
+  std::vector<std::vector<Edge>> adjacency;
+};
+
+}  // namespace quisp::modules::routing_daemon
@@ -0,0 +1,54 @@
+#include "ParetoPaths.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+using quisp::modules::routing_daemon::ParetoPath;
+using quisp::modules::routing_daemon::ParetoPaths;
+
+void addLink(ParetoPaths &graph, int a, int b, double cost, double werner_parameter) {
+  graph.addEdge(a, b, cost, werner_parameter);
+  graph.addEdge(b, a, cost, werner_parameter);
+}
+
+TEST(ParetoPathsTest, FrontOfCostAndFidelity) {
+  // 0-1-3 is cheap and noisy, 0-2-3 costs more and is clean, 0-4-3 is beaten by 0-2-3 on both
+  ParetoPaths graph{5};
+  addLink(graph, 0, 1, 1, 0.8);
+  addLink(graph, 1, 3, 1, 0.8);
+  addLink(graph, 0, 2, 2, 1);
+  addLink(graph, 2, 3, 2, 0.9);
+  addLink(graph, 0, 4, 3, 0.9);
+  addLink(graph, 4, 3, 3, 0.9);
+
+  auto fronts = graph.findFrom(0, 8);
+  const auto &front = fronts[3];
+  ASSERT_EQ(front.size(), 2);
+  EXPECT_DOUBLE_EQ(front[0].cost, 2);
+  EXPECT_DOUBLE_EQ(front[0].werner_parameter, 0.64);
+  EXPECT_EQ(front[0].first_hop, 1);
+  EXPECT_DOUBLE_EQ(front[1].cost, 4);
+  EXPECT_DOUBLE_EQ(front[1].werner_parameter, 0.9);
+  EXPECT_EQ(front[1].first_hop, 2);
+  EXPECT_TRUE(fronts[0].empty());
+
+  // the cheapest path that meets the fidelity, the cleanest one if none does
+  EXPECT_EQ(ParetoPaths::cheapestMeeting(front, 0.7)->first_hop, 1);
+  EXPECT_EQ(ParetoPaths::cheapestMeeting(front, 0.9)->first_hop, 2);
+  EXPECT_EQ(ParetoPaths::cheapestMeeting(front, 0.99)->first_hop, 2);
+  EXPECT_EQ(ParetoPaths::cheapestMeeting({}, 0.5), nullptr);
+
+  // the bounded front keeps the cheapest
+  auto bounded_fronts = graph.findFrom(0, 1);
+  ASSERT_EQ(bounded_fronts[3].size(), 1);
+  EXPECT_EQ(bounded_fronts[3][0].first_hop, 1);
+}
+
+TEST(ParetoPathsTest, WernerParameterOfFidelity) {
+  EXPECT_DOUBLE_EQ(ParetoPaths::wernerParameterOf(1), 1);
+  EXPECT_DOUBLE_EQ(ParetoPaths::wernerParameterOf(0.25), 0);
+  EXPECT_DOUBLE_EQ(ParetoPaths::wernerParameterOf(0.1), 0);
+  EXPECT_DOUBLE_EQ((ParetoPath{0, ParetoPaths::wernerParameterOf(0.85), -1}).fidelity(), 0.85);
+}
+
+}  // namespace
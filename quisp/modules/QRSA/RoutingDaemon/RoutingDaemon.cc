@@ -5,6 +5,7 @@
  */
 #include "RoutingDaemon.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "messages/classical_messages.h"
@@ -46,15 +47,25 @@ namespace quisp::modules::routing_daemon {
  */
 
 RoutingDaemon::RoutingDaemon() : provider(utils::ComponentProvider{this}) {}
+RoutingDaemon::~RoutingDaemon() {
+  cancelAndDelete(lsa_flooding_timer);
+  cancelAndDelete(hello_coalescing_timer);
+}
 
 void RoutingDaemon::initialize(int stage) {
   if (stage >= 1) return;
 
+  event_profiler = provider.getEventProfiler();
   my_address = provider.getNodeAddr();
 
   run_ospf = par("run_ospf");
 
   if (run_ospf) {
+    ospf_area = par("ospf_area");
+    lsa_flooding_delay = par("lsa_flooding_delay");
+    hello_coalescing_delay = par("hello_coalescing_delay");
+    if (lsa_flooding_delay > 0) lsa_flooding_timer = new cMessage("OspfLsaFlooding");
+    if (hello_coalescing_delay > 0) hello_coalescing_timer = new cMessage("OspfHelloCoalescing");
     ospfInitializeRoutingDaemon();
   } else {
     // Topology creation for routing table
@@ -65,32 +76,41 @@ void RoutingDaemon::initialize(int stage) {
       return;
     }
 
-    generateRoutingTable(topo);
+    num_alternative_paths = par("num_alternative_paths");
+    max_pareto_paths = par("max_pareto_paths");
+    generateRoutingTable(topo, provider.getNextHopTableForRoutingDaemon(this));
   }
 }
 
-void RoutingDaemon::generateRoutingTable() { qrtable = link_state_database.generateRoutingTableFromGraph(my_address); }
+void RoutingDaemon::generateRoutingTable() {
+  qrtable = link_state_database.generateRoutingTableFromGraph(my_address);
+  if (ospf_area == no_area) return;
+  area_qrtable = link_state_database.generateAreaRoutingTable(my_address);
+  ospfAdvertiseAreaCosts();
+}
 
-void RoutingDaemon::generateRoutingTable(cTopology *topo) {
+void RoutingDaemon::generateRoutingTable(cTopology *topo, const SharedResource::NextHopTable *next_hops) {
+  topology = topo;
+  topology_next_hops = next_hops;
+  topology_version = next_hops->getVersion();
+  qrtable.clear();
   cTopology::Node *this_node = topo->getNodeFor(getParentModule()->getParentModule());  // The parent node with this specific router
 
   for (int i = 0; i < topo->getNumNodes(); i++) {  // Traverse through all the destinations from the thisNode
     const auto node = topo->getNode(i);
     if (node == this_node) continue;  // skip the node that is running this specific router app
 
-    // Apply dijkstra to each node to find all shortest paths.
-    topo->calculateWeightedSingleShortestPathsTo(node);  // Overwrites getNumPaths() and so on.
-
-    // Check the number of shortest paths towards the target node. This may be more than 1 if multiple paths have the same minimum cost.
-    if (this_node->getNumPaths() == 0) {
-      error("Path not found. This means that a node is completely separated...Probably not what you want now");
+    // The next link in the shortest path towards the target node, shared with the other routing daemons.
+    auto *next_link = next_hops->getNextHop(this_node, node);
+    if (next_link == nullptr) {
+      // a link down may separate the nodes, but the initial topology must be connected
+      if (topology_version == 0) error("Path not found. This means that a node is completely separated...Probably not what you want now");
       continue;  // not connected
     }
-    // Returns the next link/gate in the ith shortest paths towards the target node.
-    cGate *parentModuleGate = this_node->getPath(0)->getLocalGate();
+    cGate *parentModuleGate = next_link->getLocalGate();
     int destAddr = node->getModule()->par("address");
 
-    qrtable[destAddr] = getQNicAddr(parentModuleGate);
+    qrtable.set(destAddr, getQNicAddr(parentModuleGate));
 
     if (!strstr(parentModuleGate->getFullName(), "quantum")) {
       error("Quantum routing table referring to classical gates...");
@@ -110,28 +130,124 @@ int RoutingDaemon::getQNicAddr(const cGate *const module_gate) {
  *
  */
 int RoutingDaemon::findQNicAddrByDestAddr(int destAddr) {
-  RoutingTable::iterator it = qrtable.find(destAddr);
-  if (it == qrtable.end()) {
+  refreshRoutingTable();
+  auto *qnic_addr = qrtable.find(destAddr);
+  if (qnic_addr == nullptr && ospf_area != no_area) {
+    // the destinations outside of the area go towards the border node of their area
+    auto it = area_qrtable.find(ospfAreaOf(destAddr));
+    if (it != area_qrtable.end()) return it->second.hop_address;
+  }
+  if (qnic_addr == nullptr) {
     EV << "Quantum: address " << destAddr << " unreachable from this node \n";
     return -1;
   }
-  return it->second;
+  return *qnic_addr;
 }
 
-int RoutingDaemon::getNumEndNodes() {
-  cTopology *topo = new cTopology("topo");
-  topo->extractByParameter("included_in_topology", "\"yes\"");
-  int num_end_nodes = 0;
-  for (int i = 0; i < topo->getNumNodes(); i++) {
-    cTopology::Node *node = topo->getNode(i);
-    std::string node_type = node->getModule()->par("node_type");
-    if (node_type == "EndNode") {  // ignore myself
-      num_end_nodes++;
+/**
+ * @details The qnics are ordered by the cost of the cheapest path through them, each qnic once.
+ *          The paths to a destination are found by Yen's algorithm on its first lookup, from the link weights at that time.
+ *          Without alternative paths (num_alternative_paths = 1, or OSPF), it returns the qnic in the routing table only.
+ */
+std::vector<int> RoutingDaemon::findQNicAddrsByDestAddr(int destAddr) {
+  const int qnic_addr = findQNicAddrByDestAddr(destAddr);
+  if (qnic_addr == -1) return {};
+  if (num_alternative_paths <= 1 || topology == nullptr) return {qnic_addr};
+  if (auto *qnic_addrs = alternative_qrtable.find(destAddr)) return *qnic_addrs;
+
+  if (topology_paths == nullptr) buildTopologyPaths();
+  std::vector<int> qnic_addrs{qnic_addr};
+  auto dst_it = topology_node_indices.find(destAddr);
+  if (dst_it != topology_node_indices.end()) {
+    cTopology::Node *this_node = topology->getNodeFor(getParentModule()->getParentModule());
+    for (const auto &path : topology_paths->find(topology_node_indices.at(my_address), dst_it->second, num_alternative_paths)) {
+      const auto *next_node = topology->getNode(path.nodes[1]);
+      for (int i = 0; i < this_node->getNumOutLinks(); i++) {
+        auto *link = this_node->getLinkOut(i);
+        if (link->getRemoteNode() != next_node) continue;
+        const int alternative_qnic_addr = getQNicAddr(link->getLocalGate());
+        if (std::find(qnic_addrs.begin(), qnic_addrs.end(), alternative_qnic_addr) == qnic_addrs.end()) qnic_addrs.push_back(alternative_qnic_addr);
+        break;
+      }
     }
   }
-  delete topo;
-  return num_end_nodes;
-};
+  alternative_qrtable.set(destAddr, qnic_addrs);
+  return qnic_addrs;
+}
+
+/**
+ * @details The fidelity of a path is the one of the pair swapped over the links of the estimated fidelities,
+ *          without purification. The front is usually a few paths, so the lookup doesn't depend on the network size.
+ *          Without the shared topology (OSPF), it returns the qnic in the routing table.
+ */
+int RoutingDaemon::findQNicAddrForFidelity(int destAddr, double threshold_fidelity) {
+  const int qnic_addr = findQNicAddrByDestAddr(destAddr);
+  if (qnic_addr == -1 || topology == nullptr) return qnic_addr;
+  if (pareto_link_version != provider.getQuantumLinkVersion()) buildParetoFronts();
+  auto *front = pareto_qrtable.find(destAddr);
+  if (front == nullptr) return qnic_addr;
+  const auto *path = ParetoPaths::cheapestMeeting(*front, threshold_fidelity);
+  return path == nullptr ? qnic_addr : path->first_hop;
+}
+
+void RoutingDaemon::buildParetoFronts() {
+  pareto_link_version = provider.getQuantumLinkVersion();
+  pareto_qrtable.clear();
+  const int num_nodes = topology->getNumNodes();
+  ParetoPaths graph(num_nodes);
+  std::unordered_map<const cTopology::Node *, int> indices;
+  for (int i = 0; i < num_nodes; i++) indices[topology->getNode(i)] = i;
+  for (int i = 0; i < num_nodes; i++) {
+    auto *node = topology->getNode(i);
+    for (int j = 0; j < node->getNumOutLinks(); j++) {
+      auto *link = node->getLinkOut(j);
+      if (!link->isEnabled()) continue;
+      graph.addEdge(i, indices.at(link->getRemoteNode()), link->getWeight(), ParetoPaths::wernerParameterOf(provider.getQuantumLinkFidelity(link)));
+    }
+  }
+
+  cTopology::Node *this_node = topology->getNodeFor(getParentModule()->getParentModule());
+  // the neighbor's index -> the qnic towards it
+  std::unordered_map<int, int> first_hop_qnics;
+  for (int i = 0; i < this_node->getNumOutLinks(); i++) {
+    auto *link = this_node->getLinkOut(i);
+    first_hop_qnics.emplace(indices.at(link->getRemoteNode()), getQNicAddr(link->getLocalGate()));
+  }
+  auto fronts = graph.findFrom(indices.at(this_node), max_pareto_paths);
+  for (int i = 0; i < num_nodes; i++) {
+    if (fronts[i].empty()) continue;
+    for (auto &path : fronts[i]) path.first_hop = first_hop_qnics.at(path.first_hop);
+    pareto_qrtable.set(topology->getNode(i)->getModule()->par("address").intValue(), std::move(fronts[i]));
+  }
+}
+
+// the alternative paths are searched again from the current link weights after the change
+void RoutingDaemon::refreshRoutingTable() {
+  if (topology_next_hops == nullptr || topology_next_hops->getVersion() == topology_version) return;
+  generateRoutingTable(topology, topology_next_hops);
+  alternative_qrtable.clear();
+  topology_paths.reset();
+}
+
+void RoutingDaemon::buildTopologyPaths() {
+  const int num_nodes = topology->getNumNodes();
+  topology_paths = std::make_unique<KShortestPaths>(num_nodes);
+  std::unordered_map<const cTopology::Node *, int> indices;
+  for (int i = 0; i < num_nodes; i++) {
+    indices[topology->getNode(i)] = i;
+    topology_node_indices[topology->getNode(i)->getModule()->par("address").intValue()] = i;
+  }
+  for (int i = 0; i < num_nodes; i++) {
+    auto *node = topology->getNode(i);
+    for (int j = 0; j < node->getNumOutLinks(); j++) {
+      auto *link = node->getLinkOut(j);
+      if (!link->isEnabled()) continue;
+      topology_paths->addEdge(i, indices.at(link->getRemoteNode()), link->getWeight());
+    }
+  }
+}
+
+int RoutingDaemon::getNumEndNodes() { return provider.getNumEndNodes(); }
 
 /**
  * Once we begin using dynamic routing protocols, this is where the messages
@@ -140,6 +256,16 @@ int RoutingDaemon::getNumEndNodes() {
  * TODO Handle dynamic routing protocol messages.
  **/
 void RoutingDaemon::handleMessage(cMessage *msg) {
+  modules::SharedResource::EventProfiler::Scope profile(event_profiler, this, msg);
+  if (msg == lsa_flooding_timer) {
+    ospfFloodLsdbSummaries();
+    return;
+  }
+  if (msg == hello_coalescing_timer) {
+    ospfSendCoalescedHelloPackets();
+    return;
+  }
+
   if (auto pk = dynamic_cast<OspfHelloPacket *>(msg)) {
     ospfHandleHelloPacket(pk);
   }
@@ -156,12 +282,25 @@ void RoutingDaemon::handleMessage(cMessage *msg) {
     ospfHandleLinkStateUpdate(pk);
   }
 
+  if (auto pk = dynamic_cast<OspfAreaSummaryPacket *>(msg)) {
+    ospfHandleAreaSummaryPacket(pk);
+  }
+
   if (auto pk = dynamic_cast<OspfLsAckPacket *>(msg)) {
   }
   delete msg;
   return;
 }
 
+void RoutingDaemon::finish() {
+  if (!run_ospf) return;
+  recordScalar("ospf_lsdb_summaries_requested", num_lsdb_summaries_requested);
+  recordScalar("ospf_lsdb_summaries_sent", num_lsdb_summaries_sent);
+  recordScalar("ospf_hellos_requested", num_hellos_requested);
+  recordScalar("ospf_hellos_sent", num_hellos_sent);
+  recordScalar("ospf_lsdb_digest_matches", num_lsdb_digest_matches);
+}
+
 /**
  * @brief returns the number of neighbors of this node
  * @details we are assuming
@@ -179,6 +318,12 @@ void RoutingDaemon::ospfHandleHelloPacket(const OspfHelloPacket *const pk) {
   } else if (ospfMyAddressIsRecognizedByNeighbor(pk) && ospfNeighborIsRegistered(src)) {
     if (neighbor_table[src].state != OspfState::INIT) error("neighbor_table[%d].state expected to be OspfState::INIT or 1, but it’s %d", src, neighbor_table[src].state);
     neighbor_table[src].state = OspfState::TWO_WAY;
+    if (ospfNeighborIsInOtherArea(src)) {
+      // no LSDB exchange across areas, only the area costs
+      neighbor_table[src].state = OspfState::FULL;
+      ospfSendAreaSummary(src);
+      return;
+    }
     neighbor_table[src].state = OspfState::EXSTART;
 
     ospfSendExstartDbdPacket(src);
@@ -201,16 +346,35 @@ void RoutingDaemon::ospfInitializeRoutingDaemon() {
     OspfHelloPacket *msg = new OspfHelloPacket;
     msg->setSrcAddr(this->my_address);
     msg->setNeighborTable(neighbor_table);
+    msg->setArea(ospf_area);
     msg->setSendingGateIndex(i);
     msg->setDestAddr(unidentified_destination);
     send(msg, "RouterPort$o");
   }
 }
 
+/**
+ * @details With hello_coalescing_delay, the replies to the same neighbor within the window are merged into one hello,
+ *          which carries the neighbor table at the time it's sent.
+ */
 void RoutingDaemon::ospfSendHelloPacketToNeighbor(NodeAddr neighbor) {
+  num_hellos_requested++;
+  if (hello_coalescing_timer == nullptr) return ospfSendHelloPacket(neighbor);
+  neighbors_to_hello.insert(neighbor);
+  if (!hello_coalescing_timer->isScheduled()) scheduleAt(simTime() + hello_coalescing_delay, hello_coalescing_timer);
+}
+
+void RoutingDaemon::ospfSendCoalescedHelloPackets() {
+  for (const NodeAddr neighbor : neighbors_to_hello) ospfSendHelloPacket(neighbor);
+  neighbors_to_hello.clear();
+}
+
+void RoutingDaemon::ospfSendHelloPacket(NodeAddr neighbor) {
+  num_hellos_sent++;
   OspfHelloPacket *msg = new OspfHelloPacket;
   msg->setSrcAddr(this->my_address);
   msg->setNeighborTable(neighbor_table);
+  msg->setArea(ospf_area);
   msg->setDestAddr(neighbor);
   send(msg, "RouterPort$o");
 }
@@ -229,12 +393,14 @@ void RoutingDaemon::ospfRegisterNeighbor(const OspfPacket *const pk, OspfState s
   const int qnic_address = qnic_interface->qnic.address;
   const double link_cost = qnic_interface->link_cost;
   neighbor_table[src] = OspfNeighborInfo(src, qnic_address, state, link_cost);
+  if (auto hello = dynamic_cast<const OspfHelloPacket *>(pk)) neighbor_table[src].area = hello->getArea();
   ospfUpdateMyAddressLsaInLsdb();
 }
 
 bool RoutingDaemon::ospfNeighborIsRegistered(NodeAddr address) const { return static_cast<bool>(neighbor_table.count(address)); }
 
 void RoutingDaemon::ospfHandleDbdPacket(const OspfDbdPacket *const pk) {
+  neighbor_lsdb_digests[pk->getSrcAddr()] = pk->getLsdbDigest();
   if (pk->getState() == OspfState::EXSTART) {
     return ospfExStartState(pk);
   }
@@ -243,7 +409,16 @@ void RoutingDaemon::ospfHandleDbdPacket(const OspfDbdPacket *const pk) {
 
   if (pk->getState() != OspfState::EXCHANGE) error("RoutingDaemon::ospfHandleDbdPacket: Node%d expected to be in EXCHANGE state, but it's not", src);
 
-  if (pk->getLsdb().empty()) error("RoutingDaemon::ospfHandleDbdPacket: expected LSDB to be not empty, but it is");
+  // in sync already, neither the summary of this node nor the requests are needed
+  if (ospfHasSameLsdbAs(src)) {
+    num_lsdb_digest_matches++;
+    neighbor_table[src].state = OspfState::FULL;
+    return;
+  }
+
+  // a digest without the summary comes from a neighbor in sync with the LSDB before this node updated it:
+  // this node has nothing to request, and the master sends its summary below
+  if (pk->getLsdb().empty() && pk->getLsdbDigest() == 0) error("RoutingDaemon::ospfHandleDbdPacket: expected LSDB to be not empty, but it is");
 
   bool i_am_master = !pk->isMaster();
   if (i_am_master) {
@@ -286,12 +461,14 @@ void RoutingDaemon::ospfSendExstartDbdPacket(NodeAddr neighbor) {
   msg->setSrcAddr(my_address);
   msg->setState(OspfState::EXSTART);
   msg->setIsMaster(true);
+  msg->setLsdbDigest(link_state_database.getDigest());
   msg->setDestAddr(neighbor);
   send(msg, "RouterPort$o");
 }
 
 void RoutingDaemon::ospfSlaveInitiateExchangeState(NodeAddr dest) {
-  neighbor_table[dest].state = OspfState::EXCHANGE;
+  // the master has the same LSDB, only the digest is sent for it to finish the exchange
+  neighbor_table[dest].state = ospfHasSameLsdbAs(dest) ? OspfState::FULL : OspfState::EXCHANGE;
   ospfSendLsdbSummary(dest);
 }
 
@@ -304,13 +481,25 @@ void RoutingDaemon::ospfSendLsdbSummary(NodeAddr dest, bool i_am_master) {
   OspfDbdPacket *msg = new OspfDbdPacket;
   msg->setSrcAddr(my_address);
   msg->setState(OspfState::EXCHANGE);
-  LinkStateDatabaseSummary lsdb_summary = link_state_database.getLinkStateDatabaseSummary();
-  msg->setLsdb(lsdb_summary);
+  if (!ospfHasSameLsdbAs(dest)) {
+    LinkStateDatabaseSummary lsdb_summary = link_state_database.getLinkStateDatabaseSummary();
+    msg->setLsdb(lsdb_summary);
+  }
+  msg->setLsdbDigest(link_state_database.getDigest());
   msg->setIsMaster(i_am_master);
   msg->setDestAddr(dest);
   send(msg, "RouterPort$o");
 }
 
+/**
+ * @details The digest needs the own LSA in the LSDB, an empty LSDB is never taken as the same as the neighbor's.
+ */
+bool RoutingDaemon::ospfHasSameLsdbAs(NodeAddr neighbor) const {
+  auto it = neighbor_lsdb_digests.find(neighbor);
+  if (it == neighbor_lsdb_digests.end() || !link_state_database.hasLinkStateAdvertisementOf(my_address)) return false;
+  return it->second == link_state_database.getDigest();
+}
+
 void RoutingDaemon::ospfSendLinkStateRequest(NodeAddr dst, const RouterIds &missing_lsa_ids) {
   neighbor_table[dst].state = OspfState::LOADING;
 
@@ -326,8 +515,7 @@ void RoutingDaemon::ospfHandleLinkStateRequest(const OspfLsrPacket *const pk) {
   lsu->setSrcAddr(my_address);
 
   const RouterIds ids_of_requested_lsa = pk->getIDsOfRequestedLsa();
-  const LinkStateUpdate lsas = link_state_database.getLinkStateUpdatesFor(ids_of_requested_lsa, my_address);
-  lsu->setLsas(lsas);
+  lsu->setLsas(link_state_database.getLinkStateUpdatesFor(ids_of_requested_lsa));
   lsu->setDestAddr(pk->getSrcAddr());
   send(lsu, "RouterPort$o");
 }
@@ -345,28 +533,124 @@ void RoutingDaemon::ospfHandleLinkStateUpdate(const OspfLsuPacket *const pk) {
 }
 
 void RoutingDaemon::ospfUpdateLinkStateDatabase(const OspfLsuPacket *const pk) {
-  LinkStateUpdate lsu = pk->getLsas();
-  for (LinkStateAdvertisement &lsa : lsu) {
+  for (const LinkStateAdvertisementPtr &lsa : pk->getLsas()) {
+    if (lsa->area != ospf_area) continue;
     link_state_database.updateLinkStateDatabase(lsa);
   }
 }
 
+/**
+ * @details With lsa_flooding_delay, the updates within the window are flooded as one LSDB summary per neighbor,
+ *          which is taken when the window closes and so covers all of them.
+ */
 void RoutingDaemon::ospfSendUpdatedLsdbToNeighboringRouters(NodeAddr source_of_updated_lsdb) {
   for (const auto neighbor_entry : neighbor_table) {
     const NodeAddr neighbor_id = neighbor_entry.first;
-    if (neighbor_id == source_of_updated_lsdb) continue;
+    if (neighbor_id == source_of_updated_lsdb || ospfNeighborIsInOtherArea(neighbor_id)) continue;
+    num_lsdb_summaries_requested++;
+    neighbors_to_flood.insert(neighbor_id);
+  }
+  if (lsa_flooding_timer == nullptr) return ospfFloodLsdbSummaries();
+  if (!neighbors_to_flood.empty() && !lsa_flooding_timer->isScheduled()) scheduleAt(simTime() + lsa_flooding_delay, lsa_flooding_timer);
+}
+
+void RoutingDaemon::ospfFloodLsdbSummaries() {
+  for (const NodeAddr neighbor_id : neighbors_to_flood) {
+    // the neighbor already told to have the LSDB after the updates
+    if (ospfHasSameLsdbAs(neighbor_id)) {
+      num_lsdb_digest_matches++;
+      continue;
+    }
+    num_lsdb_summaries_sent++;
     ospfSendLsdbSummary(neighbor_id, true);
   }
+  neighbors_to_flood.clear();
 }
 
 void RoutingDaemon::ospfUpdateMyAddressLsaInLsdb() {
   LinkStateAdvertisement my_lsa{my_address, my_address, neighbor_table};
+  my_lsa.area = ospf_area;
+  my_lsa.area_summaries = ospfSummariseOtherAreas();
   if (link_state_database.hasLinkStateAdvertisementOf(my_address)) {
-    int curr_lsa_age = link_state_database.getLinkStateAdvertisementOf(my_address).lsa_age;
+    int curr_lsa_age = link_state_database.getLinkStateAdvertisementOf(my_address)->lsa_age;
     my_lsa.lsa_age = curr_lsa_age + 1;
   }
   link_state_database.updateLinkStateDatabase(my_lsa);
 }
 
+bool RoutingDaemon::ospfNeighborIsInOtherArea(NodeAddr neighbor) const { return neighbor_table.count(neighbor) && neighbor_table.at(neighbor).area != ospf_area; }
+
+/**
+ * @brief Takes the area costs of a neighbor in another area
+ * @details The neighbor that sends the first one replies with its own, so both of them learn the other's.
+ *          When the costs change the summaries of this border node, its LSA is updated and flooded within its area.
+ */
+void RoutingDaemon::ospfHandleAreaSummaryPacket(const OspfAreaSummaryPacket *const pk) {
+  const NodeAddr src = pk->getSrcAddr();
+  if (!ospfNeighborIsInOtherArea(src)) error("RoutingDaemon::ospfHandleAreaSummaryPacket: Router%d is not a neighbor in another area", src);
+  const bool is_new_neighbor = neighbor_table[src].state != OspfState::FULL;
+  neighbor_table[src].state = OspfState::FULL;
+  neighbor_area_costs[src] = pk->getAreaCosts();
+  if (ospfSummariseOtherAreas() != link_state_database.getLinkStateAdvertisementOf(my_address)->area_summaries) {
+    ospfUpdateMyAddressLsaInLsdb();
+    ospfSendUpdatedLsdbToNeighboringRouters(src);
+  }
+  const AreaCosts prev_area_costs = advertised_area_costs;
+  generateRoutingTable();
+  // the new neighbor gets the area costs even if they didn't change
+  if (is_new_neighbor && advertised_area_costs == prev_area_costs) ospfSendAreaSummary(src);
+}
+
+void RoutingDaemon::ospfSendAreaSummary(NodeAddr neighbor) {
+  OspfAreaSummaryPacket *msg = new OspfAreaSummaryPacket;
+  msg->setSrcAddr(my_address);
+  msg->setArea(ospf_area);
+  msg->setAreaCosts(ospfAreaCosts());
+  msg->setDestAddr(neighbor);
+  send(msg, "RouterPort$o");
+}
+
+// sends the area costs to the neighbors in the other areas when the routing table changed them
+void RoutingDaemon::ospfAdvertiseAreaCosts() {
+  auto area_costs = ospfAreaCosts();
+  if (area_costs == advertised_area_costs) return;
+  advertised_area_costs = std::move(area_costs);
+  for (const auto &[neighbor, info] : neighbor_table) {
+    if (ospfNeighborIsInOtherArea(neighbor) && info.state == OspfState::FULL) ospfSendAreaSummary(neighbor);
+  }
+}
+
+/**
+ * @brief the cheapest way out to each other area from this node, through its neighbors in the other areas
+ * @details Costs only drop as the areas learn their topology, so the exchange of area costs settles like distance vector routing.
+ */
+AreaSummaries RoutingDaemon::ospfSummariseOtherAreas() const {
+  AreaSummaries area_summaries;
+  for (const auto &[neighbor, area_costs] : neighbor_area_costs) {
+    const double link_cost = neighbor_table.at(neighbor).cost;
+    for (const auto &[area, cost] : area_costs) {
+      if (area == ospf_area) continue;
+      auto it = area_summaries.find(area);
+      if (it == area_summaries.end() || link_cost + cost < it->second.cost) area_summaries[area] = AreaSummary(link_cost + cost, neighbor);
+    }
+  }
+  return area_summaries;
+}
+
+// the own area costs nothing, the others what the routes through the border nodes cost
+AreaCosts RoutingDaemon::ospfAreaCosts() const {
+  AreaCosts area_costs{{ospf_area, 0}};
+  for (const auto &[area, route] : area_qrtable) area_costs[area] = route.cost;
+  return area_costs;
+}
+
+AreaId RoutingDaemon::ospfAreaOf(int address) {
+  auto *node = provider.getQNodeWithAddress(address);
+  if (node == nullptr) return no_area;
+  auto *rd = node->findModuleByPath(".qrsa.rd");
+  if (rd == nullptr || !rd->hasPar("ospf_area")) return no_area;
+  return rd->par("ospf_area").intValue();
+}
+
 Define_Module(RoutingDaemon);
 }  // namespace quisp::modules::routing_daemon
@@ -7,10 +7,19 @@
 
 #pragma once
 
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <set>
+#include <unordered_map>
+
 #include "IRoutingDaemon.h"
+#include "KShortestPaths.h"
+#include "ParetoPaths.h"
 #include "messages/classical_messages.h"
 #include "modules/QNIC.h"
 #include "modules/QRSA/RoutingDaemon/RoutingProtocol/Ospf/Ospf.h"
+#include "utils/AddressTable.h"
 #include "utils/ComponentProvider.h"
 
 /** \class RoutingDaemon RoutingDaemon.cc
@@ -20,7 +29,7 @@
 namespace quisp::modules::routing_daemon {
 
 // destaddr -> {self_qnic_address (unique)}
-using RoutingTable = std::map<int, int>;
+using RoutingTable = utils::AddressTable<int>;
 
 using namespace ospf;
 using namespace quisp::messages;
@@ -28,20 +37,30 @@ using namespace quisp::messages;
 class RoutingDaemon : public IRoutingDaemon {
  public:
   RoutingDaemon();
+  ~RoutingDaemon();
 
  protected:
   NodeAddr my_address;
   RoutingTable qrtable;
   utils::ComponentProvider provider;
+  modules::SharedResource::EventProfiler *event_profiler = nullptr;
   ospf::NeighborTable neighbor_table;
   LinkStateDatabase link_state_database;
 
+  // the area of this node, no_area keeps the flat LSDB of the whole network.
+  // The LSAs stay within the area, the border nodes exchange only the area costs with their neighbors in the other areas.
+  AreaId ospf_area = no_area;
+  AreaRoutingTable area_qrtable;
+  std::map<NodeAddr, AreaCosts> neighbor_area_costs;  // neighbor in another area -> the area costs it sent
+  AreaCosts advertised_area_costs;
+
   void generateRoutingTable();
-  void generateRoutingTable(cTopology *topo);
+  void generateRoutingTable(cTopology *topo, const SharedResource::NextHopTable *next_hops);
   int getQNicAddr(const cGate *const parentModuleGate);
 
   void initialize(int stage) override;
   void handleMessage(cMessage *msg) override;
+  void finish() override;
   int numInitStages() const override { return 3; };
 
   size_t getNumNeighbors();
@@ -49,6 +68,8 @@ class RoutingDaemon : public IRoutingDaemon {
   void ospfHandleHelloPacket(const OspfHelloPacket *const pk);
   void ospfInitializeRoutingDaemon();
   void ospfSendHelloPacketToNeighbor(NodeAddr neighbor);
+  void ospfSendHelloPacket(NodeAddr neighbor);
+  void ospfSendCoalescedHelloPackets();
   bool ospfMyAddressIsRecognizedByNeighbor(const OspfHelloPacket *const msg);
   void ospfRegisterNeighbor(const OspfPacket *const pk, OspfState state);
   bool ospfNeighborIsRegistered(NodeAddr address) const;
@@ -59,6 +80,7 @@ class RoutingDaemon : public IRoutingDaemon {
   void ospfSlaveInitiateExchangeState(NodeAddr dest);
   void ospfMasterEnterExchangeState(NodeAddr dest);
   void ospfSendLsdbSummary(NodeAddr destination, bool i_am_master = false);
+  bool ospfHasSameLsdbAs(NodeAddr neighbor) const;
 
   void ospfSendLinkStateRequest(NodeAddr dst, const RouterIds &missing_lsa_ids);
   void ospfHandleLinkStateRequest(const OspfLsrPacket *const pk);
@@ -66,15 +88,62 @@ class RoutingDaemon : public IRoutingDaemon {
   void ospfHandleLinkStateUpdate(const OspfLsuPacket *const pk);
   void ospfUpdateLinkStateDatabase(const OspfLsuPacket *const msg);
   void ospfSendUpdatedLsdbToNeighboringRouters(NodeAddr source_of_updated_lsdb);
+  void ospfFloodLsdbSummaries();
 
   void ospfUpdateMyAddressLsaInLsdb();
 
+  bool ospfNeighborIsInOtherArea(NodeAddr neighbor) const;
+  void ospfHandleAreaSummaryPacket(const OspfAreaSummaryPacket *const pk);
+  void ospfSendAreaSummary(NodeAddr neighbor);
+  void ospfAdvertiseAreaCosts();
+  AreaSummaries ospfSummariseOtherAreas() const;
+  AreaCosts ospfAreaCosts() const;
+  AreaId ospfAreaOf(int address);
+
  public:
   int getNumEndNodes() override;
   int findQNicAddrByDestAddr(int destAddr) override;
+  std::vector<int> findQNicAddrsByDestAddr(int destAddr) override;
+  int findQNicAddrForFidelity(int destAddr, double threshold_fidelity) override;
 
  private:
   bool run_ospf;
+
+  // the first hops of num_alternative_paths shortest paths over the shared topology, found on the first lookup of each destination
+  int num_alternative_paths = 1;
+  cTopology *topology = nullptr;
+  // the routing table is regenerated when the shared next hops changed by a link going down or up
+  const SharedResource::NextHopTable *topology_next_hops = nullptr;
+  std::uint64_t topology_version = 0;
+  void refreshRoutingTable();
+  std::unique_ptr<KShortestPaths> topology_paths;
+  std::unordered_map<int, int> topology_node_indices;  // destaddr -> node index in topology
+  utils::AddressTable<std::vector<int>> alternative_qrtable;  // destaddr -> {self_qnic_address}
+  void buildTopologyPaths();
+
+  // the Pareto fronts of (cost, fidelity) over the shared topology, each path by the qnic of its first hop in first_hop.
+  // They're found for all the destinations on the first lookup, and again when the quantum links changed.
+  int max_pareto_paths = 8;
+  std::optional<std::uint64_t> pareto_link_version;
+  utils::AddressTable<std::vector<ParetoPath>> pareto_qrtable;  // destaddr -> the front
+  void buildParetoFronts();
+
+  // the floods and hello replies to the same neighbor within these windows are sent as one packet, 0 sends them at once
+  simtime_t lsa_flooding_delay = 0;
+  simtime_t hello_coalescing_delay = 0;
+  cMessage *lsa_flooding_timer = nullptr;
+  cMessage *hello_coalescing_timer = nullptr;
+  std::set<NodeAddr> neighbors_to_flood;
+  std::set<NodeAddr> neighbors_to_hello;
+  // neighbor -> the LSDB digest of its last DBD packet
+  std::map<NodeAddr, std::uint64_t> neighbor_lsdb_digests;
+
+  // the packets the protocol asked for and the ones actually sent, recorded in finish()
+  long num_lsdb_summaries_requested = 0;
+  long num_lsdb_summaries_sent = 0;
+  long num_hellos_requested = 0;
+  long num_hellos_sent = 0;
+  long num_lsdb_digest_matches = 0;
 };
 
 }  // namespace quisp::modules::routing_daemon
@@ -23,8 +23,17 @@ class MockLinkStateDatabase : public LinkStateDatabase {
 
 class Strategy : public quisp_test::TestComponentProviderStrategy {
  public:
-  Strategy(TestQNode* _qnode, IHardwareMonitor* _hardware_monitor) : parent_qnode(_qnode), hardware_monitor(_hardware_monitor) {}
-  Strategy(TestQNode* _qnode) : parent_qnode(_qnode) {}
+  Strategy(TestQNode* _qnode, IHardwareMonitor* _hardware_monitor) : parent_qnode(_qnode), hardware_monitor(_hardware_monitor) {
+    setParBool(&shared_resource, "profile_events", false);
+    setParStr(&shared_resource, "event_trace_filename", "");
+    setParStr(&shared_resource, "event_replay_filename", "");
+    setParInt(&shared_resource, "init_threads", 1);
+    setParBool(&shared_resource, "keep_tables_across_runs", false);
+    setParBool(&shared_resource, "centralized_connection_setup", false);
+    setParDouble(&shared_resource, "controller_delay", 0);
+    setParStr(&shared_resource, "validation_level", "full");
+  }
+  Strategy(TestQNode* _qnode) : Strategy(_qnode, nullptr) {}
   cModule* getNode() override { return parent_qnode; }
   int getNodeAddr() override { return parent_qnode->address; }
   SharedResource* getSharedResource() override { return &shared_resource; }
@@ -46,8 +55,14 @@ class RoutingDaemonTestTarget : public RoutingDaemon {
   using RoutingDaemon::my_address;
   using RoutingDaemon::neighbor_table;
   using RoutingDaemon::qrtable;
+  using RoutingDaemon::area_qrtable;
+  using RoutingDaemon::ospf_area;
+  using RoutingDaemon::ospfUpdateMyAddressLsaInLsdb;
   RoutingDaemonTestTarget(TestQNode* qnode) : RoutingDaemon() {
     setParBool(this, "run_ospf", true);
+    setParInt(this, "ospf_area", -1);
+    setParDouble(this, "lsa_flooding_delay", 0);
+    setParDouble(this, "hello_coalescing_delay", 0);
     my_address = qnode->address;
     RouterPort = new TestGate(this, "RouterPort$o");
     this->provider.setStrategy(std::make_unique<Strategy>(qnode));
@@ -129,10 +144,10 @@ TEST_F(RoutingDaemonTest, ospfReceiveHelloPacketAndEstablishInitState) {
   auto msg_from_other_node = new OspfHelloPacket;
   msg_from_other_node->setSrcAddr(src);
 
-  auto expected_qnic = std::make_unique<InterfaceInfo>();
-  expected_qnic->qnic.address = 0;
-  expected_qnic->link_cost = 1;
-  EXPECT_CALL(*mock_hardware_monitor, findInterfaceByNeighborAddr(_)).WillOnce(Return(ByMove(std::move(expected_qnic))));
+  InterfaceInfo expected_qnic;
+  expected_qnic.qnic.address = 0;
+  expected_qnic.link_cost = 1;
+  EXPECT_CALL(*mock_hardware_monitor, findInterfaceByNeighborAddr(_)).WillOnce(Return(&expected_qnic));
 
   routing_daemon->handleMessage(msg_from_other_node);
 
@@ -155,10 +170,10 @@ TEST_F(RoutingDaemonTest, ospfReceiveHelloPacketAndEstablishTwoWayState) {
   neighbor_table[routing_daemon->my_address] = OspfNeighborInfo(routing_daemon->my_address);
   msg_from_other_node->setNeighborTable(neighbor_table);
 
-  auto expected_qnic = std::make_unique<InterfaceInfo>();
-  expected_qnic->qnic.address = 0;
-  expected_qnic->link_cost = 1;
-  EXPECT_CALL(*mock_hardware_monitor, findInterfaceByNeighborAddr(_)).WillOnce(Return(ByMove(std::move(expected_qnic))));
+  InterfaceInfo expected_qnic;
+  expected_qnic.qnic.address = 0;
+  expected_qnic.link_cost = 1;
+  EXPECT_CALL(*mock_hardware_monitor, findInterfaceByNeighborAddr(_)).WillOnce(Return(&expected_qnic));
 
   routing_daemon->handleMessage(msg_from_other_node);
 
@@ -191,6 +206,57 @@ TEST_F(RoutingDaemonTest, ospfReceiveHelloPacketAndTransitionFromInitToTwoWaySta
   ASSERT_TRUE(dbd_pk->isMaster());
 }
 
+TEST_F(RoutingDaemonTest, ospfNeighborInAnotherAreaGetsTheAreaCostsInsteadOfTheLsdb) {
+  const NodeAddr src = 1;
+  routing_daemon->ospf_area = 0;
+  auto msg_from_other_node = new OspfHelloPacket;
+  msg_from_other_node->setSrcAddr(src);
+  msg_from_other_node->setArea(1);
+  NeighborTable neighbor_table;
+  neighbor_table[routing_daemon->my_address] = OspfNeighborInfo(routing_daemon->my_address);
+  msg_from_other_node->setNeighborTable(neighbor_table);
+
+  routing_daemon->neighbor_table[src] = OspfNeighborInfo(src, 0, OspfState::INIT, 1);
+  routing_daemon->neighbor_table[src].area = 1;
+
+  routing_daemon->handleMessage(msg_from_other_node);
+  ASSERT_EQ(routing_daemon->neighbor_table[src].state, OspfState::FULL);
+  ASSERT_EQ(routing_daemon->RouterPort->messages.size(), 1);
+  auto summary_pk = dynamic_cast<OspfAreaSummaryPacket*>(routing_daemon->RouterPort->messages.front());
+  ASSERT_TRUE(summary_pk);
+  EXPECT_EQ(summary_pk->getArea(), 0);
+  EXPECT_EQ(summary_pk->getAreaCosts(), (AreaCosts{{0, 0}}));
+}
+
+TEST_F(RoutingDaemonTest, ospfBorderNodeSummarisesTheAreaCostsOfItsNeighbor) {
+  const NodeAddr src = 1;
+  routing_daemon->ospf_area = 0;
+  routing_daemon->neighbor_table[src] = OspfNeighborInfo(src, 7, OspfState::TWO_WAY, 2);
+  routing_daemon->neighbor_table[src].area = 1;
+  routing_daemon->ospfUpdateMyAddressLsaInLsdb();
+
+  auto summary_pk = new OspfAreaSummaryPacket;
+  summary_pk->setSrcAddr(src);
+  summary_pk->setArea(1);
+  summary_pk->setAreaCosts(AreaCosts{{0, 5}, {1, 0}, {2, 4}});
+  routing_daemon->handleMessage(summary_pk);
+
+  ASSERT_EQ(routing_daemon->neighbor_table[src].state, OspfState::FULL);
+  // the own area is not summarised
+  auto& my_lsa = *routing_daemon->link_state_database.getLinkStateAdvertisementOf(routing_daemon->my_address);
+  EXPECT_EQ(my_lsa.area, 0);
+  ASSERT_EQ(my_lsa.area_summaries.size(), 2);
+  EXPECT_EQ(my_lsa.area_summaries.at(1), AreaSummary(2, src));
+  EXPECT_EQ(my_lsa.area_summaries.at(2), AreaSummary(6, src));
+  EXPECT_EQ(routing_daemon->area_qrtable.at(2).hop_address, 7);
+
+  // the neighbor learns the area costs of this node once
+  ASSERT_EQ(routing_daemon->RouterPort->messages.size(), 1);
+  auto reply = dynamic_cast<OspfAreaSummaryPacket*>(routing_daemon->RouterPort->messages.front());
+  ASSERT_TRUE(reply);
+  EXPECT_EQ(reply->getAreaCosts(), (AreaCosts{{0, 0}, {1, 2}, {2, 6}}));
+}
+
 TEST_F(RoutingDaemonTest, ospfReceiveHelloPacketButCannotTransitionToTwoWayState) {
   const NodeAddr src = 1;
   auto msg_from_other_node = new OspfHelloPacket;
@@ -303,6 +369,41 @@ TEST_F(RoutingDaemonTest, ospfSlaveRespondsToExchangePacketOfMaster) {
   ASSERT_TRUE(dynamic_cast<OspfLsrPacket*>(sent_msg));
 }
 
+TEST_F(RoutingDaemonTest, ospfMasterSkipsTheExchangeWithTheSameLsdbDigest) {
+  const NodeAddr src = routing_daemon->my_address - 1;
+  routing_daemon->neighbor_table[src] = OspfNeighborInfo(src, 0, OspfState::EXSTART, 1);
+  routing_daemon->ospfUpdateMyAddressLsaInLsdb();
+  auto msg_from_other_node = new OspfDbdPacket;
+  msg_from_other_node->setSrcAddr(src);
+  msg_from_other_node->setIsMaster(false);
+  msg_from_other_node->setState(OspfState::EXCHANGE);
+  msg_from_other_node->setLsdbDigest(routing_daemon->link_state_database.getDigest());
+
+  routing_daemon->handleMessage(msg_from_other_node);
+  ASSERT_EQ(routing_daemon->neighbor_table[src].state, OspfState::FULL);
+  ASSERT_EQ(routing_daemon->RouterPort->messages.size(), 0);
+}
+
+TEST_F(RoutingDaemonTest, ospfSlaveSendsOnlyTheDigestToMasterWithTheSameLsdb) {
+  const NodeAddr src = routing_daemon->my_address + 1;
+  routing_daemon->neighbor_table[src] = OspfNeighborInfo(src, 0, OspfState::EXSTART, 1);
+  routing_daemon->ospfUpdateMyAddressLsaInLsdb();
+  auto msg_from_other_node = new OspfDbdPacket;
+  msg_from_other_node->setSrcAddr(src);
+  msg_from_other_node->setIsMaster(true);
+  msg_from_other_node->setState(OspfState::EXSTART);
+  msg_from_other_node->setLsdbDigest(routing_daemon->link_state_database.getDigest());
+
+  routing_daemon->handleMessage(msg_from_other_node);
+  ASSERT_EQ(routing_daemon->neighbor_table[src].state, OspfState::FULL);
+  ASSERT_EQ(routing_daemon->RouterPort->messages.size(), 1);
+  auto dbd_pk = dynamic_cast<OspfDbdPacket*>(routing_daemon->RouterPort->messages.front());
+  ASSERT_TRUE(dbd_pk);
+  ASSERT_EQ(dbd_pk->getState(), OspfState::EXCHANGE);
+  ASSERT_EQ(dbd_pk->getLsdb().size(), 0);
+  ASSERT_EQ(dbd_pk->getLsdbDigest(), routing_daemon->link_state_database.getDigest());
+}
+
 TEST_F(RoutingDaemonTest, ospfReceiveDbdPacketWithNoLsdb) {
   const NodeAddr src = routing_daemon->my_address + 1;
   auto msg_from_other_node = new OspfDbdPacket;
@@ -312,7 +413,7 @@ TEST_F(RoutingDaemonTest, ospfReceiveDbdPacketWithNoLsdb) {
   auto other_node_lsa = LinkStateAdvertisement(src, src, {});
   msg_from_other_node->setLsdb({other_node_lsa});
   MockLinkStateDatabase mock_link_state_database;
-  mock_link_state_database.link_state_database[src] = other_node_lsa;
+  mock_link_state_database.link_state_database.set(src, std::make_shared<LinkStateAdvertisement>(other_node_lsa));
   routing_daemon->link_state_database = mock_link_state_database;
 
   routing_daemon->handleMessage(msg_from_other_node);
@@ -334,11 +435,11 @@ TEST_F(RoutingDaemonTest, ospfRespondToLsuPacket) {
 
   MockLinkStateDatabase mock_link_state_database;
   routing_daemon->neighbor_table[other_node] = OspfNeighborInfo(other_node, other_node, 0);
-  mock_link_state_database.link_state_database[my_address] = LinkStateAdvertisement(my_address, my_address, routing_daemon->neighbor_table);
+  mock_link_state_database.link_state_database.set(my_address, std::make_shared<LinkStateAdvertisement>(my_address, my_address, routing_daemon->neighbor_table));
 
   NeighborTable other_node_neighbor_table;
   other_node_neighbor_table[my_address] = OspfNeighborInfo(my_address, my_address, 0);
-  mock_link_state_database.link_state_database[other_node] = LinkStateAdvertisement(other_node, other_node, other_node_neighbor_table);
+  mock_link_state_database.link_state_database.set(other_node, std::make_shared<LinkStateAdvertisement>(other_node, other_node, other_node_neighbor_table));
 
   routing_daemon->link_state_database = mock_link_state_database;
 
@@ -350,4 +451,36 @@ TEST_F(RoutingDaemonTest, ospfRespondToLsuPacket) {
   ASSERT_TRUE(dbd_pk->isMaster());
   ASSERT_EQ(dbd_pk->getState(), OspfState::EXCHANGE);
 }
+
+TEST_F(RoutingDaemonTest, ospfAggregateFloodingWithinDelay) {
+  setParDouble(routing_daemon, "lsa_flooding_delay", 0.001);
+  routing_daemon->initialize(0);
+  routing_daemon->RouterPort->messages.clear();
+
+  const NodeAddr other_node = 1;
+  const NodeAddr my_address = routing_daemon->my_address;
+  MockLinkStateDatabase mock_link_state_database;
+  routing_daemon->neighbor_table[other_node] = OspfNeighborInfo(other_node, other_node, 0);
+  mock_link_state_database.link_state_database.set(my_address, std::make_shared<LinkStateAdvertisement>(my_address, my_address, routing_daemon->neighbor_table));
+  NeighborTable other_node_neighbor_table;
+  other_node_neighbor_table[my_address] = OspfNeighborInfo(my_address, my_address, 0);
+  mock_link_state_database.link_state_database.set(other_node, std::make_shared<LinkStateAdvertisement>(other_node, other_node, other_node_neighbor_table));
+  routing_daemon->link_state_database = mock_link_state_database;
+
+  routing_daemon->handleMessage(new OspfLsuPacket);
+  routing_daemon->handleMessage(new OspfLsuPacket);
+  // only the acks are sent, the flooding waits for the delay
+  ASSERT_EQ(routing_daemon->RouterPort->messages.size(), 2);
+  ASSERT_TRUE(dynamic_cast<OspfLsAckPacket*>(routing_daemon->RouterPort->messages[1]));
+
+  auto* fes = sim->getFES();
+  ASSERT_EQ(fes->getLength(), 1);
+  auto* timer = dynamic_cast<cMessage*>(fes->removeFirst());
+  routing_daemon->handleMessage(timer);
+  ASSERT_EQ(routing_daemon->RouterPort->messages.size(), 3);
+  auto dbd_pk = dynamic_cast<OspfDbdPacket*>(routing_daemon->RouterPort->messages[2]);
+  ASSERT_TRUE(dbd_pk);
+  ASSERT_EQ(dbd_pk->getDestAddr(), other_node);
+  ASSERT_EQ(dbd_pk->getState(), OspfState::EXCHANGE);
+}
 }  // namespace
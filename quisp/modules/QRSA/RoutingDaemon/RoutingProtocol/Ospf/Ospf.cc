@@ -1,4 +1,6 @@
 #include "Ospf.h"
+#include <functional>
+#include <utility>
 
 namespace quisp::modules::ospf {
 
@@ -6,16 +8,21 @@ namespace quisp::modules::ospf {
  * @brief Adds new lsa or updated lsa to link_state_database
  *        As a sideffect, this function clears lsdb_summary
  */
-void LinkStateDatabase::updateLinkStateDatabase(LinkStateAdvertisement& lsa) {
-  const NodeAddr lsa_origin_id = lsa.lsa_origin_id;
-  if (link_state_database.count(lsa_origin_id)) {
-    auto my_lsa = link_state_database.at(lsa_origin_id);
-    if (my_lsa.lsa_age >= lsa.lsa_age) throw omnetpp::cRuntimeError("LinkStateDatabase::updateLinkStateDatabase: input lsa is outdated");
-    if (my_lsa.neighbor_nodes.size() >= lsa.neighbor_nodes.size())
+void LinkStateDatabase::updateLinkStateDatabase(LinkStateAdvertisementPtr lsa) {
+  const NodeAddr lsa_origin_id = lsa->lsa_origin_id;
+  LinkStateAdvertisementPtr prev_lsa = link_state_database.share(lsa_origin_id);
+  if (prev_lsa != nullptr) {
+    if (prev_lsa->lsa_age >= lsa->lsa_age) throw omnetpp::cRuntimeError("LinkStateDatabase::updateLinkStateDatabase: input lsa is outdated");
+    // the same size is allowed to update the link costs
+    if (prev_lsa->neighbor_nodes.size() > lsa->neighbor_nodes.size())
       throw omnetpp::cRuntimeError(
           "LinkStateDatabase::updateLinkStateDatabase: size of neighbor_nodes is assumed to monotonically increase, but the input has smaller size of neighbor_nodes");
+    digest ^= digestOf(*prev_lsa);
   }
-  link_state_database[lsa_origin_id] = lsa;
+  // keeps the oldest LSA if it's updated several times before the next routing table generation
+  if (!shortest_path_tree.empty()) lsas_updated_since_tree.emplace(lsa_origin_id, std::move(prev_lsa));
+  digest ^= digestOf(*lsa);
+  link_state_database.set(lsa_origin_id, std::move(lsa));
   lsdb_summary.clear();
 }
 
@@ -27,15 +34,14 @@ void LinkStateDatabase::updateLinkStateDatabase(LinkStateAdvertisement& lsa) {
  */
 LinkStateDatabaseSummary LinkStateDatabase::getLinkStateDatabaseSummary() {
   if (lsdb_summary.empty() == false) return lsdb_summary;
-  for (const auto& lsa_entry : link_state_database) {
-    const LinkStateAdvertisement& lsa = lsa_entry.second;
+  for (const LinkStateAdvertisement& lsa : link_state_database) {
     lsdb_summary.emplace_back(lsa.lsa_id, lsa.lsa_origin_id, lsa.lsa_age);
   }
   return lsdb_summary;
 }
 
 std::map<NodeAddr, int> LinkStateDatabase::generateRoutingTableFromGraph(NodeAddr src_id) const {
-  const auto vertices = dijkstraAlgorithm(src_id);
+  const auto& vertices = shortestPathTreeFrom(src_id);
   std::map<NodeAddr, int> routing_table;
   for (const auto& vertex : vertices) {
     const NodeAddr dst_id = vertex.first;
@@ -46,6 +52,40 @@ std::map<NodeAddr, int> LinkStateDatabase::generateRoutingTableFromGraph(NodeAdd
   return routing_table;
 }
 
+AreaRoutingTable LinkStateDatabase::generateAreaRoutingTable(NodeAddr src_id) const {
+  const auto& vertices = shortestPathTreeFrom(src_id);
+  const AreaId my_area = link_state_database.at(src_id).area;
+  AreaRoutingTable area_routing_table;
+  for (const auto& [border_id, vertex] : vertices) {
+    if (vertex->distance_from_source == std::numeric_limits<double>::max()) continue;
+    for (const auto& [area, summary] : link_state_database.at(border_id).area_summaries) {
+      if (area == my_area) continue;
+      const double cost = vertex->distance_from_source + summary.cost;
+      auto it = area_routing_table.find(area);
+      if (it != area_routing_table.end() && it->second.cost <= cost) continue;
+      // the source itself borders the area, it goes straight to its neighbor there
+      const NodeAddr neighbor_id = border_id == src_id ? summary.via : getSecondNodeInPathToDestNode(src_id, border_id, vertices);
+      area_routing_table[area] = AreaRoute{getHopAddressToNeighbor(src_id, neighbor_id), cost};
+    }
+  }
+  return area_routing_table;
+}
+
+const LinkStateDatabase::VertexMap& LinkStateDatabase::shortestPathTreeFrom(NodeAddr src_id) const {
+  if (shortest_path_tree.empty() || shortest_path_tree_source != src_id) {
+    shortest_path_tree = dijkstraAlgorithm(src_id);
+    shortest_path_tree_source = src_id;
+    lsas_updated_since_tree.clear();
+    in_neighbors.clear();
+    for (const LinkStateAdvertisement& lsa : link_state_database) {
+      for (const auto& neighbor_entry : lsa.neighbor_nodes) in_neighbors[neighbor_entry.first].insert(lsa.lsa_origin_id);
+    }
+  } else if (!lsas_updated_since_tree.empty()) {
+    updateShortestPathTree();
+  }
+  return shortest_path_tree;
+}
+
 RouterIds LinkStateDatabase::identifyMissingLinkStateAdvertisementId(const LinkStateDatabaseSummary& lsdb_summary_from_neighbor) const {
   RouterIds missing_lsas;
   for (const SummaryLinkStateAdvertisement& lsa : lsdb_summary_from_neighbor) {
@@ -55,32 +95,29 @@ RouterIds LinkStateDatabase::identifyMissingLinkStateAdvertisementId(const LinkS
 }
 
 bool LinkStateDatabase::needsFullLinkStateAdvertisementOf(const SummaryLinkStateAdvertisement& summary_lsa) const {
-  const NodeAddr source_of_lsa = summary_lsa.lsa_origin_id;
-  if (!link_state_database.count(source_of_lsa)) return true;
-  if (link_state_database.at(source_of_lsa).lsa_age < summary_lsa.lsa_age) return true;
-  return false;
-}
-
-LinkStateUpdate LinkStateDatabase::getLinkStateUpdatesFor(const RouterIds& requests, int my_address) const {
-  std::vector<LinkStateAdvertisement> lsu;
-  for (const NodeAddr request : requests) {
-    auto lsa = getLinkStateAdvertisementOf(request);
-    lsa.lsa_id = my_address;
-    lsu.push_back(lsa);
-  }
+  const LinkStateAdvertisement* lsa = link_state_database.find(summary_lsa.lsa_origin_id);
+  return lsa == nullptr || lsa->lsa_age < summary_lsa.lsa_age;
+}
+
+LinkStateUpdate LinkStateDatabase::getLinkStateUpdatesFor(const RouterIds& requests) const {
+  LinkStateUpdate lsu;
+  lsu.reserve(requests.size());
+  for (const NodeAddr request : requests) lsu.push_back(getLinkStateAdvertisementOf(request));
   return lsu;
 }
 
-LinkStateAdvertisement LinkStateDatabase::getLinkStateAdvertisementOf(NodeAddr router) const {
-  if (!link_state_database.count(router)) throw omnetpp::cRuntimeError("Requested LSA of router%d does not exist", router);
-  return link_state_database.at(router);
+LinkStateAdvertisementPtr LinkStateDatabase::getLinkStateAdvertisementOf(NodeAddr router) const {
+  auto lsa = link_state_database.share(router);
+  if (lsa == nullptr) throw omnetpp::cRuntimeError("Requested LSA of router%d does not exist", router);
+  return lsa;
 }
 
 bool LinkStateDatabase::hasLinkStateAdvertisementOf(NodeAddr router) const { return link_state_database.count(router); }
 
 int LinkStateDatabase::getHopAddressToNeighbor(NodeAddr src_id, NodeAddr neighbor_id) const {
-  if (link_state_database.count(src_id) && link_state_database.at(src_id).neighbor_nodes.count(neighbor_id)) {
-    return link_state_database.at(src_id).neighbor_nodes.at(neighbor_id).hop_address;
+  const LinkStateAdvertisement* lsa = link_state_database.find(src_id);
+  if (lsa != nullptr && lsa->neighbor_nodes.count(neighbor_id)) {
+    return lsa->neighbor_nodes.at(neighbor_id).hop_address;
   }
   throw omnetpp::cRuntimeError("LinkStateDatabase::getGateIndexToNeighbor: either neighbor node%d or source node%d does not exist in link_state_database", neighbor_id, src_id);
 }
@@ -135,21 +172,122 @@ const LinkStateDatabase::VertexMap LinkStateDatabase::dijkstraAlgorithm(NodeAddr
   return vertices;
 }
 
+/**
+ * @brief Updates shortest_path_tree with the LSAs updated after it was computed, instead of running dijkstraAlgorithm again.
+ * @details
+ * The edges that got cheaper or new only relax their heads.
+ * The edges that got more expensive matter only if they are in the tree: the subtree below such an edge is reset
+ * and reattached through the edges coming from outside of it. Then Dijkstra's Algorithm runs only from the relaxed vertices,
+ * so the vertices that don't get a shorter path are never visited.
+ * Among paths with the same cost, the chosen one may differ from a full recomputation.
+ */
+void LinkStateDatabase::updateShortestPathTree() const {
+  constexpr double infinity = std::numeric_limits<double>::max();
+  auto& tree = shortest_path_tree;
+  std::vector<std::pair<NodeAddr, NodeAddr>> relaxed_edges;
+  std::vector<NodeAddr> reset_roots;
+
+  for (const auto& [origin, prev_lsa] : lsas_updated_since_tree) {
+    const auto& neighbor_nodes = link_state_database.at(origin).neighbor_nodes;
+    if (prev_lsa == nullptr) {
+      // the edges into the new vertex in the other LSAs become usable
+      tree[origin] = std::make_shared<Vertex>(link_state_database.at(origin));
+      for (const NodeAddr in_neighbor : in_neighbors[origin]) relaxed_edges.emplace_back(in_neighbor, origin);
+    } else {
+      for (const auto& [neighbor, info] : prev_lsa->neighbor_nodes) {
+        if (neighbor_nodes.count(neighbor)) continue;
+        in_neighbors[neighbor].erase(origin);
+        auto it = tree.find(neighbor);
+        if (it != tree.end() && it->second->prev_node_in_path == origin) reset_roots.push_back(neighbor);
+      }
+    }
+    for (const auto& [neighbor, info] : neighbor_nodes) {
+      in_neighbors[neighbor].insert(origin);
+      double prev_cost = infinity;
+      if (prev_lsa != nullptr && prev_lsa->neighbor_nodes.count(neighbor)) prev_cost = prev_lsa->neighbor_nodes.at(neighbor).cost;
+      if (info.cost < prev_cost) {
+        relaxed_edges.emplace_back(origin, neighbor);
+      } else if (info.cost > prev_cost) {
+        auto it = tree.find(neighbor);
+        if (it != tree.end() && it->second->prev_node_in_path == origin) reset_roots.push_back(neighbor);
+      }
+    }
+  }
+  lsas_updated_since_tree.clear();
+
+  if (!reset_roots.empty()) {
+    std::map<NodeAddr, std::vector<NodeAddr>> children;
+    for (const auto& [id, vertex] : tree) {
+      if (vertex->prev_node_in_path != Vertex::no_prev_node) children[vertex->prev_node_in_path].push_back(id);
+    }
+    std::set<NodeAddr> reset;
+    std::vector<NodeAddr> stack = reset_roots;
+    while (!stack.empty()) {
+      const NodeAddr id = stack.back();
+      stack.pop_back();
+      if (!reset.insert(id).second) continue;
+      tree.at(id)->distance_from_source = infinity;
+      tree.at(id)->prev_node_in_path = Vertex::no_prev_node;
+      for (const NodeAddr child : children[id]) stack.push_back(child);
+    }
+    for (const NodeAddr id : reset) {
+      for (const NodeAddr in_neighbor : in_neighbors[id]) {
+        if (!reset.count(in_neighbor)) relaxed_edges.emplace_back(in_neighbor, id);
+      }
+    }
+  }
+
+  using Candidate = std::pair<double, NodeAddr>;
+  std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> queue;
+  auto relax = [&](NodeAddr from, NodeAddr to) {
+    auto from_it = tree.find(from);
+    auto to_it = tree.find(to);
+    if (from_it == tree.end() || to_it == tree.end()) return;
+    if (from_it->second->distance_from_source == infinity) return;
+    const auto& neighbor_nodes = link_state_database.at(from).neighbor_nodes;
+    auto edge = neighbor_nodes.find(to);
+    if (edge == neighbor_nodes.end()) return;
+    double distance_of_new_path = from_it->second->distance_from_source + edge->second.cost;
+    if (to_it->second->distance_from_source > distance_of_new_path) {
+      to_it->second->distance_from_source = distance_of_new_path;
+      to_it->second->prev_node_in_path = from;
+      queue.emplace(distance_of_new_path, to);
+    }
+  };
+  for (const auto& [from, to] : relaxed_edges) relax(from, to);
+  while (!queue.empty()) {
+    const auto [distance, id] = queue.top();
+    queue.pop();
+    if (distance > tree.at(id)->distance_from_source) continue;
+    for (const auto& neighbor_entry : link_state_database.at(id).neighbor_nodes) relax(id, neighbor_entry.first);
+  }
+}
+
 LinkStateDatabase::VertexMap LinkStateDatabase::generateVerticesFromLsdb() const {
   std::map<NodeAddr, std::shared_ptr<Vertex>> vertices;
-  for (const auto& lsa : link_state_database) {
-    vertices[lsa.first] = std::shared_ptr<Vertex>(new Vertex(lsa.second));
+  for (const LinkStateAdvertisement& lsa : link_state_database) {
+    vertices[lsa.lsa_origin_id] = std::shared_ptr<Vertex>(new Vertex(lsa));
   }
   return vertices;
 }
 
 double LinkStateDatabase::weight(NodeAddr node1, NodeAddr node2) const {
-  if (link_state_database.count(node1) && link_state_database.at(node1).neighbor_nodes.count(node2)) {
-    return link_state_database.at(node1).neighbor_nodes.at(node2).cost;
+  const LinkStateAdvertisement* lsa = link_state_database.find(node1);
+  if (lsa != nullptr && lsa->neighbor_nodes.count(node2)) {
+    return lsa->neighbor_nodes.at(node2).cost;
   }
   throw omnetpp::cRuntimeError("LinkStateDatabase::weight: couldn't find an edge between node%d and node%d", node1, node2);
 }
 
+// splitmix64 of the origin and the age, which identify the content of an LSA
+std::uint64_t LinkStateDatabase::digestOf(const SummaryLinkStateAdvertisement& lsa) {
+  std::uint64_t x = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(lsa.lsa_origin_id)) << 32) | static_cast<std::uint32_t>(lsa.lsa_age);
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
 LinkStateDatabase::VertexSharedPtr LinkStateDatabase::popMinDistanceNode(PriorityQueue& q) const {
   auto u = q.top();
   q.pop();
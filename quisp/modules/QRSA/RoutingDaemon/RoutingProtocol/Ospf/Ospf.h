@@ -15,9 +15,17 @@
 
 #include <omnetpp.h>
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <limits>
+#include <map>
 #include <memory>
+#include <optional>
 #include <queue>
+#include <set>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 #include "omnetpp/cexception.h"
 
@@ -27,13 +35,25 @@ class LinkStateDatabase;
 struct LinkStateAdvertisement;
 struct SummaryLinkStateAdvertisement;
 struct OspfNeighborInfo;
+struct AreaSummary;
+struct AreaRoute;
 enum class OspfState;
 
 using NodeAddr = int;
+using AreaId = int;
 using RouterIds = std::vector<int>;
 using NeighborTable = std::map<NodeAddr, OspfNeighborInfo>;
 using LinkStateDatabaseSummary = std::vector<SummaryLinkStateAdvertisement>;
-using LinkStateUpdate = std::vector<LinkStateAdvertisement>;
+// the LSAs are never modified once made, so the databases and the LSU packets share them instead of copying
+using LinkStateAdvertisementPtr = std::shared_ptr<const LinkStateAdvertisement>;
+using LinkStateUpdate = std::vector<LinkStateAdvertisementPtr>;
+// area -> the cost to reach it, as an area border node tells its neighbors in the other areas
+using AreaCosts = std::map<AreaId, double>;
+using AreaSummaries = std::map<AreaId, AreaSummary>;
+using AreaRoutingTable = std::map<AreaId, AreaRoute>;
+
+// the area of a node that doesn't use areas, all such nodes share one flat LSDB
+constexpr AreaId no_area = -1;
 
 enum class OspfState { DOWN = 0, INIT = 1, TWO_WAY = 2, EXSTART = 3, EXCHANGE = 4, LOADING = 5, FULL = 6 };
 
@@ -44,6 +64,7 @@ struct OspfNeighborInfo {
   int hop_address = -1;
   OspfState state = OspfState::DOWN;
   double cost;
+  AreaId area = no_area;
 
   OspfNeighborInfo(int _router_id) : router_id(_router_id) {}
   OspfNeighborInfo(int _hop_address, OspfState _state) : hop_address(_hop_address), state(_state) {}
@@ -66,19 +87,111 @@ struct SummaryLinkStateAdvertisement {
   SummaryLinkStateAdvertisement() = default;
 };
 
+/**
+ * @brief
+ * The reachability of another area that an area border node summarises for the nodes of its own area:
+ * the cheapest cost from the border node and the neighbor in another area it goes through.
+ */
+struct AreaSummary {
+  double cost;
+  NodeAddr via;
+  AreaSummary(double _cost, NodeAddr _via) : cost(_cost), via(_via) {}
+  AreaSummary() = default;
+  bool operator==(const AreaSummary& other) const { return cost == other.cost && via == other.via; }
+};
+
+/**
+ * @brief the first hop towards another area, through the border node of the own area with the cheapest total cost.
+ */
+struct AreaRoute {
+  int hop_address;
+  double cost;
+};
+
 /**
  * @brief
  * Full link-state advertisement that holds info of neighbor_nodes.
  * Element that makes up the LinkStateDatabase topology information.
+ * With areas, LSAs are flooded only within the area of their origin, and the border nodes summarise the other areas in area_summaries.
  */
 struct LinkStateAdvertisement : SummaryLinkStateAdvertisement {
   NeighborTable neighbor_nodes;
+  AreaId area = no_area;
+  AreaSummaries area_summaries;
   LinkStateAdvertisement(NodeAddr _id, NodeAddr _origin_id, NeighborTable _neighbor_table) : SummaryLinkStateAdvertisement(_id, _origin_id, 0), neighbor_nodes(_neighbor_table) {}
   LinkStateAdvertisement(NodeAddr _id, NodeAddr _origin_id, int _age, NeighborTable _neighbor_table)
       : SummaryLinkStateAdvertisement(_id, _origin_id, _age), neighbor_nodes(_neighbor_table) {}
   LinkStateAdvertisement() = default;
 };
 
+/**
+ * @brief
+ * The LSAs of a LinkStateDatabase by their origin, one per router.
+ * The router ids are the node addresses, which are small and dense, so the LSAs are kept in a vector indexed by the id
+ * and iterated in the order of the ids. The lsa_age of an LSA is its sequence number.
+ */
+class LinkStateAdvertisementTable {
+  using Entries = std::vector<LinkStateAdvertisementPtr>;
+
+ public:
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = LinkStateAdvertisement;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const LinkStateAdvertisement*;
+    using reference = const LinkStateAdvertisement&;
+
+    const_iterator(Entries::const_iterator it, Entries::const_iterator end) : it(it), end(end) { skipEmpty(); }
+    reference operator*() const { return **it; }
+    pointer operator->() const { return it->get(); }
+    const_iterator& operator++() {
+      ++it;
+      skipEmpty();
+      return *this;
+    }
+    bool operator==(const const_iterator& other) const { return it == other.it; }
+    bool operator!=(const const_iterator& other) const { return it != other.it; }
+
+   private:
+    void skipEmpty() {
+      while (it != end && *it == nullptr) ++it;
+    }
+    Entries::const_iterator it, end;
+  };
+
+  /// @brief the LSA of the origin, or nullptr.
+  const LinkStateAdvertisement* find(NodeAddr origin) const { return 0 <= origin && (std::size_t)origin < lsas.size() ? lsas[origin].get() : nullptr; }
+  /// @brief the LSA of the origin to share with a packet, or nullptr.
+  LinkStateAdvertisementPtr share(NodeAddr origin) const { return find(origin) == nullptr ? nullptr : lsas[origin]; }
+  bool count(NodeAddr origin) const { return find(origin) != nullptr; }
+  /// @brief throws std::out_of_range if the origin has no LSA.
+  const LinkStateAdvertisement& at(NodeAddr origin) const {
+    auto* lsa = find(origin);
+    if (lsa == nullptr) throw std::out_of_range("LinkStateAdvertisementTable::at: no LSA of the origin");
+    return *lsa;
+  }
+  /// @brief stores the LSA of the origin, or replaces it. throws std::out_of_range for a negative origin.
+  void set(NodeAddr origin, LinkStateAdvertisementPtr lsa) {
+    if (origin < 0) throw std::out_of_range("LinkStateAdvertisementTable::set: negative router id");
+    if ((std::size_t)origin >= lsas.size()) lsas.resize(origin + 1);
+    if (lsas[origin] == nullptr) num_lsas++;
+    lsas[origin] = std::move(lsa);
+  }
+  void clear() {
+    lsas.clear();
+    num_lsas = 0;
+  }
+  std::size_t size() const { return num_lsas; }
+  bool empty() const { return num_lsas == 0; }
+  const_iterator begin() const { return const_iterator(lsas.begin(), lsas.end()); }
+  const_iterator end() const { return const_iterator(lsas.end(), lsas.end()); }
+
+ private:
+  Entries lsas;
+  std::size_t num_lsas = 0;
+};
+
 /**
  * @brief
  * Represents the database that holds link-state advertisements of nodes.
@@ -104,37 +217,68 @@ class LinkStateDatabase {
   using PriorityQueue = std::priority_queue<VertexSharedPtr, std::vector<VertexSharedPtr>, VertexMinPriority>;
 
  public:
-  void updateLinkStateDatabase(LinkStateAdvertisement& lsa);
+  void updateLinkStateDatabase(LinkStateAdvertisementPtr lsa);
+  void updateLinkStateDatabase(const LinkStateAdvertisement& lsa) { updateLinkStateDatabase(std::make_shared<const LinkStateAdvertisement>(lsa)); }
 
   LinkStateDatabaseSummary getLinkStateDatabaseSummary();
 
+  /**
+   * @brief a rolling hash of the origins and ages of the LSAs, the same on the neighbors with the same LSDB.
+   * @details Each LSA contributes its own hash by XOR, so an update replaces only the one of its origin.
+   */
+  std::uint64_t getDigest() const { return digest; }
+
+  /**
+   * @brief generates the routing table from the shortest path tree rooted at the source.
+   * @details The tree is cached, and the LSAs updated after the previous call only update the affected part of it.
+   */
   std::map<NodeAddr, int> generateRoutingTableFromGraph(NodeAddr source) const;
 
+  /**
+   * @brief generates the routes to the other areas from the area summaries of the border nodes in the database.
+   * @details Each area goes through the border node with the cheapest intra-area distance plus summarised cost,
+   *          on the shortest path tree of generateRoutingTableFromGraph, so it only adds a pass over the area.
+   */
+  AreaRoutingTable generateAreaRoutingTable(NodeAddr source) const;
+
   RouterIds identifyMissingLinkStateAdvertisementId(const LinkStateDatabaseSummary& lsdb_summary_from_neighbor) const;
   virtual bool needsFullLinkStateAdvertisementOf(const SummaryLinkStateAdvertisement& summary_lsa) const;
-  LinkStateUpdate getLinkStateUpdatesFor(const RouterIds& requests, int my_address) const;
-  virtual LinkStateAdvertisement getLinkStateAdvertisementOf(NodeAddr router) const;
+  /// @brief the LSAs of the requested routers, shared with the database.
+  LinkStateUpdate getLinkStateUpdatesFor(const RouterIds& requests) const;
+  virtual LinkStateAdvertisementPtr getLinkStateAdvertisementOf(NodeAddr router) const;
   bool hasLinkStateAdvertisementOf(NodeAddr router) const;
 
  protected:
+  const VertexMap& shortestPathTreeFrom(NodeAddr source) const;
   int getHopAddressToNeighbor(NodeAddr src, NodeAddr neighbor) const;
   NodeAddr getSecondNodeInPathToDestNode(NodeAddr source_id, NodeAddr dst_id, const VertexMap& vertices) const;
 
   virtual const VertexMap dijkstraAlgorithm(NodeAddr source_id) const;
   VertexMap generateVerticesFromLsdb() const;
   double weight(NodeAddr node1, NodeAddr node2) const;
+  static std::uint64_t digestOf(const SummaryLinkStateAdvertisement& lsa);
   VertexSharedPtr popMinDistanceNode(PriorityQueue& q) const;
+  void updateShortestPathTree() const;
 
  protected:
-  std::map<NodeAddr, LinkStateAdvertisement> link_state_database;
+  LinkStateAdvertisementTable link_state_database;
   LinkStateDatabaseSummary lsdb_summary;
+  std::uint64_t digest = 0;
+
+  // the shortest path tree of the last generateRoutingTableFromGraph call
+  mutable VertexMap shortest_path_tree;
+  mutable NodeAddr shortest_path_tree_source = -1;
+  // origin -> the LSA before the update, of the LSAs updated after the tree was computed. nullptr for a new LSA.
+  mutable std::map<NodeAddr, LinkStateAdvertisementPtr> lsas_updated_since_tree;
+  // node -> the nodes that have it in their neighbor_nodes, to find the edges into a node
+  mutable std::map<NodeAddr, std::set<NodeAddr>> in_neighbors;
 
   struct Vertex {
     NodeAddr node_id;
     double distance_from_source;
     NodeAddr prev_node_in_path;
     static constexpr int no_prev_node = -1;
-    Vertex(LinkStateAdvertisement _lsa) : node_id(_lsa.lsa_origin_id), distance_from_source(std::numeric_limits<double>::max()), prev_node_in_path(no_prev_node) {}
+    Vertex(const LinkStateAdvertisement& _lsa) : node_id(_lsa.lsa_origin_id), distance_from_source(std::numeric_limits<double>::max()), prev_node_in_path(no_prev_node) {}
     Vertex() = default;
   };
 
@@ -0,0 +1,108 @@
+#include <benchmark/benchmark.h>
+#include <fstream>
+#include <map>
+#include <regex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Ospf.h"
+
+namespace {
+using namespace quisp::modules::ospf;
+
+class BenchLinkStateDatabase : public LinkStateDatabase {
+ public:
+  using LinkStateDatabase::link_state_database;
+  void dropShortestPathTree() { shortest_path_tree.clear(); }
+};
+
+// the QNode graph of the first network in topology_complex_network.ned (about 170 nodes),
+// the BSA nodes in the middle of the links are merged into the link cost.
+struct ComplexNetwork {
+  ComplexNetwork() {
+    std::ifstream ned;
+    for (auto path : {"networks/topology_complex_network.ned", "../networks/topology_complex_network.ned", "quisp/networks/topology_complex_network.ned"}) {
+      ned.open(path);
+      if (ned) break;
+    }
+    std::regex connection(R"((\w+\[\d+\])\.quantum_port\+\+ <--> QuantumChannel \{\s*distance = ([\d.]+)km; \} <--> (\w+\[\d+\])\.quantum_port\+\+)");
+    std::map<std::string, std::vector<std::pair<std::string, double>>> bsa_links;
+    int networks = 0;
+    for (std::string line; std::getline(ned, line);) {
+      if (line.rfind("network ", 0) == 0 && ++networks > 1) break;
+      std::smatch match;
+      if (!std::regex_search(line, match, connection)) continue;
+      std::string a = match[1], b = match[3];
+      double distance = std::stod(match[2]);
+      if (a.rfind("hom", 0) == 0) std::swap(a, b);
+      if (b.rfind("hom", 0) == 0) {
+        bsa_links[b].emplace_back(a, distance);
+      } else {
+        addLink(a, b, distance);
+      }
+    }
+    for (auto& [bsa, links] : bsa_links) {
+      if (links.size() == 2) addLink(links[0].first, links[1].first, links[0].second + links[1].second);
+    }
+  }
+
+  void addLink(const std::string& a, const std::string& b, double distance) {
+    int node_a = addressOf(a), node_b = addressOf(b);
+    graph[node_a][node_b] = distance;
+    graph[node_b][node_a] = distance;
+  }
+  int addressOf(const std::string& name) { return addresses.emplace(name, (int)addresses.size()).first->second; }
+
+  void fill(BenchLinkStateDatabase& lsdb) const {
+    for (auto& [node, neighbors] : graph) {
+      NeighborTable neighbor_table;
+      for (auto& [neighbor, cost] : neighbors) neighbor_table[neighbor] = OspfNeighborInfo(neighbor, neighbor, cost);
+      lsdb.link_state_database[node] = LinkStateAdvertisement(node, node, neighbor_table);
+    }
+  }
+
+  std::map<std::string, int> addresses;
+  std::map<NodeAddr, std::map<NodeAddr, double>> graph;
+};
+
+const ComplexNetwork& complexNetwork() {
+  static ComplexNetwork network;
+  return network;
+}
+
+// re-advertises one link with a new cost and regenerates the routing table of node 0, as a dynamic link cost does.
+// state.range(0) == 0 recomputes the whole shortest path tree, 1 updates it incrementally.
+static void BM_Ospf_LinkCostUpdate(benchmark::State& state) {
+  auto& network = complexNetwork();
+  if (network.graph.empty()) {
+    state.SkipWithError("topology_complex_network.ned not found");
+    return;
+  }
+  BenchLinkStateDatabase lsdb;
+  network.fill(lsdb);
+  lsdb.generateRoutingTableFromGraph(0);
+
+  std::vector<std::pair<NodeAddr, NodeAddr>> links;
+  for (auto& [node, neighbors] : network.graph) {
+    for (auto& [neighbor, cost] : neighbors) links.emplace_back(node, neighbor);
+  }
+  bool incremental = state.range(0);
+  size_t i = 0;
+  for (auto _ : state) {
+    auto [node, neighbor] = links[i++ % links.size()];
+    auto lsa = lsdb.getLinkStateAdvertisementOf(node);
+    lsa.lsa_age++;
+    // alternately doubles and restores the cost
+    double base_cost = network.graph.at(node).at(neighbor);
+    lsa.neighbor_nodes[neighbor].cost = lsa.lsa_age % 2 ? base_cost * 2 : base_cost;
+    lsdb.updateLinkStateDatabase(lsa);
+    if (!incremental) lsdb.dropShortestPathTree();
+    benchmark::DoNotOptimize(lsdb.generateRoutingTableFromGraph(0));
+  }
+  state.counters["nodes"] = network.graph.size();
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Ospf_LinkCostUpdate)->Arg(0)->Arg(1);
+
+}  // namespace
@@ -19,6 +19,7 @@ class TestLinkStateDatabase : public LinkStateDatabase {
   using LinkStateDatabase::VertexMap;
 
   using LinkStateDatabase::dijkstraAlgorithm;
+  using LinkStateDatabase::shortest_path_tree;
 };
 
 class LinkStateDatabaseTest : public ::testing::Test {
@@ -60,10 +61,9 @@ class LinkStateDatabaseTest : public ::testing::Test {
         double cost = target_node.second;
         neighbor_table[target] = OspfNeighborInfo(target, target, cost);
       }
-      link_state_database.link_state_database[source] = LinkStateAdvertisement(source, source, neighbor_table);
+      link_state_database.link_state_database.set(source, std::make_shared<LinkStateAdvertisement>(source, source, neighbor_table));
     }
-    for (const auto& lsa_entry : link_state_database.link_state_database) {
-      const LinkStateAdvertisement& lsa = lsa_entry.second;
+    for (const LinkStateAdvertisement& lsa : link_state_database.link_state_database) {
       link_state_database.lsdb_summary.emplace_back(lsa.lsa_id, lsa.lsa_origin_id, lsa.lsa_age);
     }
   }
@@ -75,7 +75,7 @@ class MockLinkStateDatabase : public LinkStateDatabase {
   using LinkStateDatabase::link_state_database;
 
   MOCK_METHOD(bool, needsFullLinkStateAdvertisementOf, (const SummaryLinkStateAdvertisement& summary_lsa), (const, override));
-  MOCK_METHOD(LinkStateAdvertisement, getLinkStateAdvertisementOf, (NodeAddr router), (const, override));
+  MOCK_METHOD(LinkStateAdvertisementPtr, getLinkStateAdvertisementOf, (NodeAddr router), (const, override));
   MOCK_METHOD(const VertexMap, dijkstraAlgorithm, (NodeAddr source_id), (const, override));
 };
 
@@ -128,8 +128,8 @@ TEST_F(LinkStateDatabaseTest, generateRoutingTableFromGraph) {
   MockLinkStateDatabase mock_link_state_database;
   const int source = 1;
   VertexMap expected_vertices;
-  for (const auto& lsa : link_state_database.link_state_database) {
-    expected_vertices[lsa.first] = std::shared_ptr<Vertex>(new Vertex(lsa.second));
+  for (const LinkStateAdvertisement& lsa : link_state_database.link_state_database) {
+    expected_vertices[lsa.lsa_origin_id] = std::shared_ptr<Vertex>(new Vertex(lsa));
   }
   expected_vertices.at(2)->prev_node_in_path = 3;
   expected_vertices.at(3)->prev_node_in_path = source;
@@ -146,8 +146,8 @@ TEST_F(LinkStateDatabaseTest, generatedPathInconsistentWithLinkStateDatabase) {
   MockLinkStateDatabase mock_link_state_database;
   const int source = 1;
   VertexMap expected_vertices;
-  for (const auto& lsa : link_state_database.link_state_database) {
-    expected_vertices[lsa.first] = std::shared_ptr<Vertex>(new Vertex(lsa.second));
+  for (const LinkStateAdvertisement& lsa : link_state_database.link_state_database) {
+    expected_vertices[lsa.lsa_origin_id] = std::shared_ptr<Vertex>(new Vertex(lsa));
   }
   expected_vertices.at(2)->prev_node_in_path = -1;
   EXPECT_CALL(mock_link_state_database, dijkstraAlgorithm(source)).WillOnce(testing::Return(expected_vertices));
@@ -178,13 +178,104 @@ TEST_F(LinkStateDatabaseTest, dijkstraAlgorithmWorks) {
   ASSERT_EQ(vertices[4]->distance_from_source, 2.2);
 }
 
+TEST_F(LinkStateDatabaseTest, updateShortestPathTreeIncrementally) {
+  auto updateCost = [&](NodeAddr origin, NodeAddr neighbor, double cost) {
+    auto lsa = *link_state_database.getLinkStateAdvertisementOf(origin);
+    lsa.lsa_age++;
+    lsa.neighbor_nodes[neighbor] = OspfNeighborInfo(neighbor, neighbor, cost);
+    link_state_database.updateLinkStateDatabase(lsa);
+  };
+  auto expectSameAsFullRecomputation = [&]() {
+    auto routing_table = link_state_database.generateRoutingTableFromGraph(1);
+    auto vertices = link_state_database.dijkstraAlgorithm(1);
+    for (const auto& [id, vertex] : vertices) {
+      EXPECT_DOUBLE_EQ(link_state_database.shortest_path_tree.at(id)->distance_from_source, vertex->distance_from_source) << "node" << id;
+      EXPECT_EQ(link_state_database.shortest_path_tree.at(id)->prev_node_in_path, vertex->prev_node_in_path) << "node" << id;
+    }
+    return routing_table;
+  };
+  auto routing_table = expectSameAsFullRecomputation();
+  ASSERT_EQ(routing_table.at(4), 3);
+
+  // the tree edge 3 -> 4 gets expensive, 4 is reached through 2
+  updateCost(3, 4, 5.0);
+  routing_table = expectSameAsFullRecomputation();
+  ASSERT_EQ(routing_table.at(4), 3);
+  ASSERT_EQ(link_state_database.shortest_path_tree.at(4)->prev_node_in_path, 2);
+
+  // the direct edge to 2 gets cheap
+  updateCost(1, 2, 0.5);
+  routing_table = expectSameAsFullRecomputation();
+  ASSERT_EQ(routing_table.at(2), 2);
+  ASSERT_EQ(routing_table.at(4), 2);
+
+  // a new node 5 connected to 4 and 3
+  updateCost(4, 5, 0.3);
+  updateCost(3, 5, 4.0);
+  auto lsa5 = LinkStateAdvertisement(5, 5, {{4, OspfNeighborInfo(4, 4, 0.3)}, {3, OspfNeighborInfo(3, 3, 4.0)}});
+  link_state_database.updateLinkStateDatabase(lsa5);
+  routing_table = expectSameAsFullRecomputation();
+  ASSERT_EQ(routing_table.at(5), 2);
+}
+
+TEST_F(LinkStateDatabaseTest, generateAreaRoutingTableThroughTheCheapestBorderNode) {
+  std::map<NodeAddr, LinkStateAdvertisement> lsas;
+  for (const LinkStateAdvertisement& lsa : link_state_database.link_state_database) {
+    lsas[lsa.lsa_origin_id] = lsa;
+    lsas[lsa.lsa_origin_id].area = 0;
+  }
+  // node 1 borders area 2 through node 6, node 4 borders areas 1 and 2 through node 5
+  auto& border1 = lsas.at(1);
+  border1.neighbor_nodes[6] = OspfNeighborInfo(6, 6, 3.0);
+  border1.area_summaries[2] = AreaSummary(3.0, 6);
+  auto& border4 = lsas.at(4);
+  border4.neighbor_nodes[5] = OspfNeighborInfo(5, 5, 2.0);
+  border4.area_summaries[0] = AreaSummary(1.0, 5);
+  border4.area_summaries[1] = AreaSummary(2.0, 5);
+  border4.area_summaries[2] = AreaSummary(5.0, 5);
+  for (auto& [origin, lsa] : lsas) link_state_database.link_state_database.set(origin, std::make_shared<LinkStateAdvertisement>(lsa));
+
+  auto area_routing_table = link_state_database.generateAreaRoutingTable(1);
+  // the own area is never routed through a border node
+  ASSERT_EQ(area_routing_table.size(), 2);
+  // 1 -> 3 -> 4 costs 2.2
+  EXPECT_EQ(area_routing_table.at(1).hop_address, 3);
+  EXPECT_DOUBLE_EQ(area_routing_table.at(1).cost, 4.2);
+  // node 1 itself borders area 2 for less than node 4 does
+  EXPECT_EQ(area_routing_table.at(2).hop_address, 6);
+  EXPECT_DOUBLE_EQ(area_routing_table.at(2).cost, 3.0);
+
+  // the routing table within the area has no node of the other areas
+  auto routing_table = link_state_database.generateRoutingTableFromGraph(1);
+  EXPECT_EQ(routing_table.count(5), 0);
+  EXPECT_EQ(routing_table.count(6), 0);
+}
+
+TEST(LinkStateDatabaseDigestTest, sameDigestForTheSameLsas) {
+  LinkStateDatabase lsdb1, lsdb2;
+  EXPECT_EQ(lsdb1.getDigest(), lsdb2.getDigest());
+  LinkStateAdvertisement lsa1{1, 1, {}}, lsa2{2, 2, {}}, lsa2_updated{2, 2, 1, {}};
+  lsdb1.updateLinkStateDatabase(lsa1);
+  lsdb1.updateLinkStateDatabase(lsa2);
+  lsdb2.updateLinkStateDatabase(lsa2);
+  EXPECT_NE(lsdb1.getDigest(), lsdb2.getDigest());
+  // the order of the updates doesn't matter
+  lsdb2.updateLinkStateDatabase(lsa1);
+  EXPECT_EQ(lsdb1.getDigest(), lsdb2.getDigest());
+
+  // a newer LSA replaces the hash of the older one
+  lsdb1.updateLinkStateDatabase(lsa2_updated);
+  EXPECT_NE(lsdb1.getDigest(), lsdb2.getDigest());
+  lsdb2.updateLinkStateDatabase(lsa2_updated);
+  EXPECT_EQ(lsdb1.getDigest(), lsdb2.getDigest());
+}
+
 TEST_F(LinkStateDatabaseTest, dijkstraAlgorithmNoSourceVertex) { ASSERT_ANY_THROW(link_state_database.dijkstraAlgorithm(5)); }
 
 TEST_F(LinkStateDatabaseTest, identifyNoMissingLinkStateAdvertisementId) {
   MockLinkStateDatabase mock_link_state_database;
   LinkStateDatabaseSummary lsdb_summary;
-  for (const auto& lsa_entry : link_state_database.link_state_database) {
-    const LinkStateAdvertisement& lsa = lsa_entry.second;
+  for (const LinkStateAdvertisement& lsa : link_state_database.link_state_database) {
     lsdb_summary.emplace_back(lsa.lsa_id, lsa.lsa_origin_id, lsa.lsa_age);
   }
   EXPECT_CALL(mock_link_state_database, needsFullLinkStateAdvertisementOf).WillRepeatedly(testing::Return(false));
@@ -206,16 +297,14 @@ TEST_F(LinkStateDatabaseTest, identify2UnseenLinkStateAdvertisementId) {
 }
 
 TEST_F(LinkStateDatabaseTest, doesNotNeedsFullLinkStateAdvertisementOfLsa) {
-  for (const auto& lsa_entry : link_state_database.link_state_database) {
-    const LinkStateAdvertisement& lsa = lsa_entry.second;
+  for (const LinkStateAdvertisement& lsa : link_state_database.link_state_database) {
     SummaryLinkStateAdvertisement summary_lsa{lsa.lsa_id, lsa.lsa_origin_id, lsa.lsa_age};
     ASSERT_FALSE(link_state_database.needsFullLinkStateAdvertisementOf(summary_lsa));
   }
 }
 
 TEST_F(LinkStateDatabaseTest, needsFullLinkStateAdvertisementOfUpdatedLsa) {
-  for (const auto& lsa_entry : link_state_database.link_state_database) {
-    const LinkStateAdvertisement& lsa = lsa_entry.second;
+  for (const LinkStateAdvertisement& lsa : link_state_database.link_state_database) {
     SummaryLinkStateAdvertisement summary_lsa{lsa.lsa_id, lsa.lsa_origin_id, lsa.lsa_age + 1};
     ASSERT_TRUE(link_state_database.needsFullLinkStateAdvertisementOf(summary_lsa));
   }
@@ -232,25 +321,26 @@ TEST_F(LinkStateDatabaseTest, getLinkStateUpdatesForRouter1To3) {
   MockLinkStateDatabase mock_link_state_database;
 
   EXPECT_CALL(mock_link_state_database, getLinkStateAdvertisementOf(testing::_)).WillRepeatedly([&](NodeAddr router) {
-    return link_state_database.link_state_database.at(router);
+    return link_state_database.link_state_database.share(router);
   });
 
-  LinkStateUpdate lsu = mock_link_state_database.getLinkStateUpdatesFor(requests, my_address);
+  LinkStateUpdate lsu = mock_link_state_database.getLinkStateUpdatesFor(requests);
   ASSERT_EQ(lsu.size(), requests.size());
   for (int i = 0; i < requests.size(); i++) {
-    ASSERT_EQ(lsu[i].lsa_id, my_address);
-    ASSERT_EQ(lsu[i].lsa_origin_id, requests[i]);
-    ASSERT_EQ(lsu[i].lsa_age, 0);
-    ASSERT_GT(lsu[i].neighbor_nodes.size(), 0);
+    ASSERT_EQ(lsu[i]->lsa_origin_id, requests[i]);
+    ASSERT_EQ(lsu[i]->lsa_age, 0);
+    ASSERT_GT(lsu[i]->neighbor_nodes.size(), 0);
+    // the update shares the LSA of the database
+    ASSERT_EQ(lsu[i].get(), link_state_database.link_state_database.find(requests[i]));
   }
 }
 
 TEST_F(LinkStateDatabaseTest, getLinkStateAdvertisementInDatabase) {
   NodeAddr request = 1;
   auto return_value = link_state_database.getLinkStateAdvertisementOf(request);
-  auto real_lsa = link_state_database.link_state_database.at(request);
-  ASSERT_EQ(return_value.lsa_origin_id, real_lsa.lsa_origin_id);
-  ASSERT_EQ(return_value.neighbor_nodes.size(), real_lsa.neighbor_nodes.size());
+  auto& real_lsa = link_state_database.link_state_database.at(request);
+  ASSERT_EQ(return_value->lsa_origin_id, real_lsa.lsa_origin_id);
+  ASSERT_EQ(return_value->neighbor_nodes.size(), real_lsa.neighbor_nodes.size());
 }
 
 TEST_F(LinkStateDatabaseTest, cannotGetLinkStateAdvertisementNotInDatabase) {
@@ -266,4 +356,29 @@ TEST_F(LinkStateDatabaseTest, hasLinkStateAdvertisementOf1To4) {
 
 TEST_F(LinkStateDatabaseTest, noLinkStateAdvertisementOf5) { ASSERT_FALSE(link_state_database.hasLinkStateAdvertisementOf(5)); }
 
+TEST(LinkStateAdvertisementTableTest, LsasByRouterId) {
+  LinkStateAdvertisementTable table;
+  EXPECT_TRUE(table.empty());
+  EXPECT_EQ(table.find(3), nullptr);
+  EXPECT_EQ(table.find(-1), nullptr);
+  EXPECT_THROW(table.at(3), std::out_of_range);
+  EXPECT_THROW(table.set(-1, std::make_shared<LinkStateAdvertisement>(-1, -1, NeighborTable{})), std::out_of_range);
+
+  table.set(7, std::make_shared<LinkStateAdvertisement>(7, 7, NeighborTable{}));
+  table.set(2, std::make_shared<LinkStateAdvertisement>(2, 2, NeighborTable{}));
+  auto lsa2_updated = std::make_shared<LinkStateAdvertisement>(2, 2, 1, NeighborTable{});
+  table.set(2, lsa2_updated);
+  EXPECT_EQ(table.size(), 2);
+  EXPECT_EQ(table.at(2).lsa_age, 1);
+  EXPECT_EQ(table.share(2), lsa2_updated);
+  EXPECT_EQ(table.share(5), nullptr);
+
+  // in the order of the router ids
+  std::vector<NodeAddr> origins;
+  for (const LinkStateAdvertisement& lsa : table) origins.push_back(lsa.lsa_origin_id);
+  EXPECT_EQ(origins, (std::vector<NodeAddr>{2, 7}));
+  table.clear();
+  EXPECT_EQ(table.begin(), table.end());
+}
+
 }  // namespace
@@ -1,68 +1,205 @@
 #include "BellPairStore.h"
+#include <omnetpp/cexception.h>
+#include <algorithm>
 #include <sstream>
 #include <utility>
 #include "modules/QNIC.h"
 #include "modules/QRSA/QRSA.h"
+#include "utils/MemoryUsage.h"
 
 namespace quisp::modules {
 BellPairStore::BellPairStore(Logger::ILogger *logger) : logger(logger) {}
 BellPairStore::~BellPairStore() {}
 
+void BellPairStore::setMemoryResourceStrategy(utils::MemoryResourceStrategy strategy) {
+  for (auto &qnics : _resources) {
+    if (!qnics.empty()) throw omnetpp::cRuntimeError("BellPairStore::setMemoryResourceStrategy: the qubits are already inserted");
+  }
+  memory_resource = std::make_unique<utils::MemoryResource>(strategy);
+}
+
+BellPairStore::QNicPairs *BellPairStore::findQNic(QNIC_type qnic_type, QNicIndex qnic_index) {
+  if (qnic_type < 0 || qnic_type >= QNIC_N || qnic_index < 0) return nullptr;
+  auto &qnics = _resources[qnic_type];
+  if ((std::size_t)qnic_index >= qnics.size()) return nullptr;
+  return &qnics[qnic_index];
+}
+
+const BellPairStore::QNicPairs *BellPairStore::findQNic(QNIC_type qnic_type, QNicIndex qnic_index) const {
+  return const_cast<BellPairStore *>(this)->findQNic(qnic_type, qnic_index);
+}
+
 void BellPairStore::insertEntangledQubit(QNodeAddr partner_addr, qrsa::IQubitRecord *const qubit) {
   auto qnic_type = qubit->getQNicType();
   auto qnic_index = qubit->getQNicIndex();
-  ResourceKey key{qnic_type, qnic_index};
-  logger->logBellPairInfo("Generated", partner_addr, qubit->getQNicType(), qubit->getQNicIndex(), qubit->getQubitIndex());
-  if (_resources.find(key) == _resources.cend()) {
-    _resources.emplace(key, std::multimap<int, qrsa::IQubitRecord *>{std::make_pair(partner_addr, qubit)});
+  auto qubit_index = qubit->getQubitIndex();
+  if (qnic_type < 0 || qnic_type >= QNIC_N || qnic_index < 0 || qubit_index < 0) {
+    throw omnetpp::cRuntimeError("BellPairStore::insertEntangledQubit: invalid qubit(%d, %d, %d)", qnic_type, qnic_index, qubit_index);
+  }
+  QUISP_LOG(logger, BellPair, logBellPairInfo("Generated", partner_addr, qnic_type, qnic_index, qubit_index));
+  auto &qnics = _resources[qnic_type];
+  while ((std::size_t)qnic_index >= qnics.size()) qnics.emplace_back(memory_resource->get());
+  auto &pairs = qnics[qnic_index];
+  if ((std::size_t)qubit_index >= pairs.slots.size()) pairs.slots.resize(qubit_index + 1);
+  auto &slot = pairs.slots[qubit_index];
+  if (slot.qubit != nullptr) {
+    erasePending(pairs, qubit_index);
+    unlink(pairs, qubit_index);
+  }
+
+  // append to the partner's list, so the list stays oldest first
+  auto &list = pairs.partners[partner_addr];
+  slot.qubit = qubit;
+  slot.partner_addr = partner_addr;
+  slot.prev = list.tail;
+  slot.next = -1;
+  slot.generation++;
+  if (list.tail >= 0) {
+    pairs.slots[list.tail].next = qubit_index;
   } else {
-    _resources[key].emplace(partner_addr, qubit);
+    list.head = qubit_index;
   }
+  list.tail = qubit_index;
+  list.size++;
+  auto &pending = pairs.pending[partner_addr];
+  slot.pending_index = pending.size();
+  pending.push_back(qubit);
 }
 
-void BellPairStore::eraseQubit(qrsa::IQubitRecord *const qubit) {
-  auto qnic_type = (QNIC_type)qubit->getQNicType();
-  auto qnic_index = qubit->getQNicIndex();
-  if (_resources.find(std::make_pair(qnic_type, qnic_index)) == _resources.cend()) {
-    return;
+void BellPairStore::unlink(QNicPairs &pairs, int index) {
+  auto &slot = pairs.slots[index];
+  auto list_it = pairs.partners.find(slot.partner_addr);
+  assert(list_it != pairs.partners.end());
+  auto &list = list_it->second;
+  if (slot.prev >= 0) {
+    pairs.slots[slot.prev].next = slot.next;
+  } else {
+    list.head = slot.next;
   }
-  // take the ref of entangled partner qubits map
-  auto &resource = _resources[std::make_pair(qnic_type, qnic_index)];
-  auto it = resource.begin();
-  while (it != resource.cend()) {
-    if (it->second == qubit) {
-      logger->logBellPairInfo("Erased", it->first, qubit->getQNicType(), qubit->getQNicIndex(), qubit->getQubitIndex());
-      it = resource.erase(it);
-    } else
-      it++;
+  if (slot.next >= 0) {
+    pairs.slots[slot.next].prev = slot.prev;
+  } else {
+    list.tail = slot.prev;
   }
+  if (--list.size == 0) pairs.partners.erase(list_it);
+  slot.qubit = nullptr;
+  slot.partner_addr = -1;
+  slot.prev = -1;
+  slot.next = -1;
+  slot.generation++;
 }
 
-qrsa::IQubitRecord *BellPairStore::findQubit(QNIC_type qnic_type, QNicIndex qnic_index, QNodeAddr addr) {
-  auto key = std::make_pair(qnic_type, qnic_index);
-  if (_resources.find(key) == _resources.cend()) {
-    return nullptr;
-  }
-  auto it = _resources[key].find(addr);
-  if (it == _resources[key].cend()) {
-    return nullptr;
+void BellPairStore::eraseQubit(qrsa::IQubitRecord *const qubit) {
+  auto *pairs = findQNic(qubit->getQNicType(), qubit->getQNicIndex());
+  auto qubit_index = qubit->getQubitIndex();
+  if (pairs == nullptr || qubit_index < 0 || (std::size_t)qubit_index >= pairs->slots.size()) return;
+  auto &slot = pairs->slots[qubit_index];
+  if (slot.qubit != qubit) return;
+  QUISP_LOG(logger, BellPair, logBellPairInfo("Erased", slot.partner_addr, qubit->getQNicType(), qubit->getQNicIndex(), qubit_index));
+  erasePending(*pairs, qubit_index);
+  unlink(*pairs, qubit_index);
+}
+
+void BellPairStore::consumeQubit(qrsa::IQubitRecord *const qubit, omnetpp::simtime_t now) {
+  auto *pairs = findQNic(qubit->getQNicType(), qubit->getQNicIndex());
+  auto qubit_index = qubit->getQubitIndex();
+  if (pairs == nullptr || qubit_index < 0 || (std::size_t)qubit_index >= pairs->slots.size() || pairs->slots[qubit_index].qubit != qubit) return;
+  auto age = (now - qubit->getEntangledTime()).dbl();
+  pairs->consumption_ages.record(age);
+  pairs->interval_consumption_ages.record(age);
+  eraseQubit(qubit);
+}
+
+void BellPairStore::erasePending(QNicPairs &pairs, int index) {
+  auto &slot = pairs.slots[index];
+  if (slot.pending_index < 0) return;
+  pairs.pending.at(slot.partner_addr)[slot.pending_index] = nullptr;
+  slot.pending_index = -1;
+}
+
+void BellPairStore::compactPending(QNicPairs &pairs, std::vector<qrsa::IQubitRecord *> &qubits) {
+  std::size_t size = 0;
+  for (auto *qubit : qubits) {
+    if (qubit == nullptr) continue;
+    pairs.slots[qubit->getQubitIndex()].pending_index = size;
+    qubits[size++] = qubit;
   }
-  return it->second;
+  qubits.resize(size);
+}
+
+qrsa::IQubitRecord *BellPairStore::findQubit(QNIC_type qnic_type, QNicIndex qnic_index, QNodeAddr addr) {
+  auto *pairs = findQNic(qnic_type, qnic_index);
+  if (pairs == nullptr) return nullptr;
+  auto it = pairs->partners.find(addr);
+  if (it == pairs->partners.end()) return nullptr;
+  return pairs->slots[it->second.head].qubit;
 }
 
 PartnerAddrQubitMapRange BellPairStore::getBellPairsRange(QNIC_type qnic_type, int qnic_index, int partner_addr) {
-  auto key = std::make_pair(qnic_type, qnic_index);
-  if (_resources.find(key) == _resources.cend()) {
-    _resources.emplace(key, std::multimap<int, qrsa::IQubitRecord *>{});
+  auto *pairs = findQNic(qnic_type, qnic_index);
+  if (pairs == nullptr) return {};
+  auto it = pairs->partners.find(partner_addr);
+  if (it == pairs->partners.end()) return {};
+  return {PartnerIterator{&pairs->slots, it->second.head}, PartnerIterator{&pairs->slots, -1}};
+}
+
+std::size_t BellPairStore::size(QNIC_type qnic_type, QNicIndex qnic_index) const {
+  auto *pairs = findQNic(qnic_type, qnic_index);
+  if (pairs == nullptr) return 0;
+  std::size_t total = 0;
+  for (auto &[partner_addr, list] : pairs->partners) total += list.size;
+  return total;
+}
+
+std::size_t BellPairStore::size() const {
+  std::size_t total = 0;
+  for (auto &qnics : _resources) {
+    for (auto &pairs : qnics) {
+      for (auto &[partner_addr, list] : pairs.partners) total += list.size;
+    }
+  }
+  return total;
+}
+
+const utils::LogHistogram &BellPairStore::consumptionAges(QNIC_type qnic_type, QNicIndex qnic_index) const {
+  static const utils::LogHistogram empty;
+  auto *pairs = findQNic(qnic_type, qnic_index);
+  return pairs == nullptr ? empty : pairs->consumption_ages;
+}
+
+utils::LogHistogram BellPairStore::takeIntervalConsumptionAges(QNIC_type qnic_type, QNicIndex qnic_index) {
+  auto *pairs = findQNic(qnic_type, qnic_index);
+  if (pairs == nullptr) return utils::LogHistogram{};
+  auto ages = std::move(pairs->interval_consumption_ages);
+  pairs->interval_consumption_ages = utils::LogHistogram{};
+  return ages;
+}
+
+std::size_t BellPairStore::allocatedBytes() const {
+  std::size_t bytes = 0;
+  for (auto &qnics : _resources) {
+    bytes += utils::heapBytesOf(qnics);
+    for (auto &pairs : qnics) {
+      bytes += utils::heapBytesOf(pairs.slots) + utils::heapBytesOf(pairs.partners) + utils::heapBytesOf(pairs.pending);
+      for (auto &[partner_addr, qubits] : pairs.pending) bytes += utils::heapBytesOf(qubits);
+    }
   }
-  return _resources[key].equal_range(partner_addr);
+  return bytes;
 }
 
 std::string BellPairStore::toString() const {
   std::stringstream ss;
-  for (auto &[key, partner_qubit_map] : _resources) {
-    for (auto &[partner, qubit] : partner_qubit_map) {
-      ss << "(type:" << key.first << ", qnic:" << key.second << ", qubit:" << qubit->getQubitIndex() << ")=>(partner:" << partner << "), ";
+  for (int qnic_type = 0; qnic_type < QNIC_N; qnic_type++) {
+    for (int qnic_index = 0; (std::size_t)qnic_index < _resources[qnic_type].size(); qnic_index++) {
+      auto &pairs = _resources[qnic_type][qnic_index];
+      std::vector<QNodeAddr> partners;
+      for (auto &[partner_addr, list] : pairs.partners) partners.push_back(partner_addr);
+      std::sort(partners.begin(), partners.end());
+      for (auto partner_addr : partners) {
+        for (auto i = pairs.partners.at(partner_addr).head; i >= 0; i = pairs.slots[i].next) {
+          ss << "(type:" << qnic_type << ", qnic:" << qnic_index << ", qubit:" << pairs.slots[i].qubit->getQubitIndex() << ")=>(partner:" << partner_addr << "), ";
+        }
+      }
     }
   }
   return ss.str();
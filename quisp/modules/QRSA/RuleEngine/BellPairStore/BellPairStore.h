@@ -4,35 +4,172 @@
 #include <modules/QNIC.h>
 #include <modules/QNIC/StationaryQubit/IStationaryQubit.h>
 #include <modules/QRSA/QRSA.h>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "utils/MemoryResource.h"
+#include "utils/StreamingStats.h"
 
 namespace quisp::modules {
 
 using QNodeAddr = int;
 using QNicIndex = int;
-// entangled partner qnode address -> qubit
-using PartnerAddrQubitMap = std::multimap<QNodeAddr, qrsa::IQubitRecord*>;
 using ResourceKey = std::pair<QNIC_type, QNicIndex>;
-using PartnerAddrQubitMapRange = std::pair<PartnerAddrQubitMap::iterator, PartnerAddrQubitMap::iterator>;
 
 /**
  * this class contains the bell pair information for RuleEngine.
  * this tracks the entangled qubit and its partner addr.
  * RuleEngine recognizes a bell pair generated, store the information to this class.
  * if RuleSet needs bell pair resource, RuleEngine takes a bell pair from this class.
+ *
+ * Each QNIC has a dense array of slots indexed by the qubit index, and the slots of the
+ * qubits entangled with the same partner are linked in the generated order (oldest first).
+ * So insert and erase are O(1), and iterating the Bell pairs with a partner is O(k).
  */
 class BellPairStore {
+ private:
+  struct Slot {
+    qrsa::IQubitRecord* qubit = nullptr;
+    QNodeAddr partner_addr = -1;
+    // the neighbors in the partner's list, -1 if none
+    int prev = -1;
+    int next = -1;
+    // incremented each time a qubit is inserted into or erased from this slot, to detect stale iterators
+    std::uint64_t generation = 0;
+    // the position in the pending qubits of the partner, -1 if allocated
+    int pending_index = -1;
+  };
+
+  struct PartnerList {
+    int head = -1;
+    int tail = -1;
+    std::size_t size = 0;
+  };
+
+  struct QNicPairs {
+    explicit QNicPairs(std::pmr::memory_resource* resource) : partners(resource), pending(resource) {}
+    std::vector<Slot> slots;
+    std::pmr::unordered_map<QNodeAddr, PartnerList> partners;
+    // the inserted qubits waiting for the allocation: partner addr -> qubits in the generated order.
+    // an erased qubit leaves nullptr, so erasing is O(1), and they're dropped before the allocation
+    std::pmr::map<QNodeAddr, std::vector<qrsa::IQubitRecord*>> pending;
+    // the ages of the consumed Bell pairs in seconds, since the start and since the last takeIntervalConsumptionAges()
+    utils::LogHistogram consumption_ages;
+    utils::LogHistogram interval_consumption_ages;
+  };
+
  public:
+  /// @brief iterates the Bell pairs with a partner, oldest first. `it->second` is the qubit record.
+  class PartnerIterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::pair<QNodeAddr, qrsa::IQubitRecord*>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+
+    PartnerIterator() = default;
+    PartnerIterator(const std::vector<Slot>* slots, int index) : slots(slots), index(index) { load(); }
+
+    reference operator*() const { return current; }
+    pointer operator->() const { return &current; }
+    PartnerIterator& operator++() {
+      assert((*slots)[index].generation == generation && "the Bell pair was erased during the iteration");
+      index = (*slots)[index].next;
+      load();
+      return *this;
+    }
+    PartnerIterator operator++(int) {
+      auto copy = *this;
+      ++*this;
+      return copy;
+    }
+    bool operator==(const PartnerIterator& other) const { return index == other.index; }
+    bool operator!=(const PartnerIterator& other) const { return index != other.index; }
+
+   private:
+    void load() {
+      if (index < 0) return;
+      auto& slot = (*slots)[index];
+      current = {slot.partner_addr, slot.qubit};
+      generation = slot.generation;
+    }
+    const std::vector<Slot>* slots = nullptr;
+    int index = -1;
+    std::uint64_t generation = 0;
+    value_type current{-1, nullptr};
+  };
+  using PartnerAddrQubitMapRange = std::pair<PartnerIterator, PartnerIterator>;
+
   BellPairStore(Logger::ILogger* logger = nullptr);
   ~BellPairStore();
   void eraseQubit(qrsa::IQubitRecord* const qubit);
+  /// @brief erases the consumed qubit and records the age of its Bell pair, from its entangled time to now. O(1) like eraseQubit.
+  void consumeQubit(qrsa::IQubitRecord* const qubit, omnetpp::simtime_t now);
+  /// @brief stores the qubit as the newest Bell pair with the partner. If the qubit is already stored, it's moved.
   void insertEntangledQubit(QNodeAddr partner_addr, qrsa::IQubitRecord* qubit);
+  /// @brief returns the oldest qubit entangled with the partner, or nullptr.
   qrsa::IQubitRecord* findQubit(QNIC_type qnic_type, QNicIndex qnic_index, QNodeAddr addr);
   PartnerAddrQubitMapRange getBellPairsRange(QNIC_type qnic_type, QNicIndex qnic_index, QNodeAddr partner_addr);
+  /// @brief returns the number of the Bell pairs in the qnic.
+  std::size_t size(QNIC_type qnic_type, QNicIndex qnic_index) const;
+  /// @brief returns the number of the Bell pairs in all the qnics.
+  std::size_t size() const;
+  /**
+   * @brief the partner lists and the pending qubits of the qnics take their nodes from a resource of this store, see utils/MemoryResource.h.
+   * Set it before inserting any qubit.
+   */
+  void setMemoryResourceStrategy(utils::MemoryResourceStrategy strategy);
+  /// @brief the ages of the Bell pairs consumed from the qnic since the start.
+  const utils::LogHistogram& consumptionAges(QNIC_type qnic_type, QNicIndex qnic_index) const;
+  /// @brief returns the ages of the Bell pairs consumed from the qnic since the last call and starts the next interval.
+  utils::LogHistogram takeIntervalConsumptionAges(QNIC_type qnic_type, QNicIndex qnic_index);
+  /// @brief the approximate heap bytes of the slots, the partner lists and the pending qubits, see utils/MemoryUsage.h.
+  std::size_t allocatedBytes() const;
+
+  /**
+   * @brief calls allocate(partner_addr, qubits) with the qubits entangled with each partner in the qnic
+   * that are not allocated yet, in the generated order. If it returns true, the qubits are no longer pending.
+   * Otherwise, e.g. no RuleSet uses the partner yet, they are passed again in the next call.
+   */
+  template <typename F>
+  void allocatePendingQubits(QNIC_type qnic_type, QNicIndex qnic_index, F allocate) {
+    auto* pairs = findQNic(qnic_type, qnic_index);
+    if (pairs == nullptr) return;
+    auto& pending = pairs->pending;
+    for (auto partner_it = pending.begin(); partner_it != pending.end();) {
+      compactPending(*pairs, partner_it->second);
+      if (partner_it->second.empty() || allocate(partner_it->first, partner_it->second)) {
+        for (auto* qubit : partner_it->second) pairs->slots[qubit->getQubitIndex()].pending_index = -1;
+        partner_it = pending.erase(partner_it);
+      } else {
+        ++partner_it;
+      }
+    }
+  }
+
   std::string toString() const;
   Logger::ILogger* logger;
 
  protected:
-  std::map<ResourceKey, PartnerAddrQubitMap> _resources;
+  // declared before the qnics to outlive their containers
+  std::unique_ptr<utils::MemoryResource> memory_resource = std::make_unique<utils::MemoryResource>();
+  // [qnic_type][qnic_index]
+  std::vector<QNicPairs> _resources[QNIC_N];
+
+  QNicPairs* findQNic(QNIC_type qnic_type, QNicIndex qnic_index);
+  const QNicPairs* findQNic(QNIC_type qnic_type, QNicIndex qnic_index) const;
+  void unlink(QNicPairs& pairs, int index);
+  void erasePending(QNicPairs& pairs, int index);
+  // drops the erased qubits from the pending qubits of a partner, keeping the order of the rest
+  static void compactPending(QNicPairs& pairs, std::vector<qrsa::IQubitRecord*>& qubits);
 };
+using PartnerAddrQubitMapRange = BellPairStore::PartnerAddrQubitMapRange;
 std::ostream& operator<<(std::ostream& os, const quisp::modules::BellPairStore& store);
 }  // namespace quisp::modules
@@ -0,0 +1,71 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <vector>
+
+#include <modules/Logger/DisabledLogger.h>
+#include <modules/QRSA/RuleEngine/QubitRecord/QubitRecord.h>
+#include "BellPairStore.h"
+
+namespace {
+using namespace quisp::modules;
+using quisp::modules::Logger::DisabledLogger;
+using quisp::modules::qubit_record::QubitRecord;
+
+// state.range(0) qubits on one QNIC, entangled with state.range(1) partners in turn.
+struct BenchStore {
+  BenchStore(int num_qubits, int num_partners) : store(&logger) {
+    for (int i = 0; i < num_qubits; i++) {
+      qubits.push_back(std::make_unique<QubitRecord>(QNIC_E, 0, i));
+    }
+    for (int i = 0; i < num_qubits; i++) {
+      partners.push_back(i % num_partners);
+    }
+  }
+  void fill() {
+    for (size_t i = 0; i < qubits.size(); i++) store.insertEntangledQubit(partners[i], qubits[i].get());
+  }
+  DisabledLogger logger;
+  BellPairStore store;
+  std::vector<std::unique_ptr<QubitRecord>> qubits;
+  std::vector<int> partners;
+};
+
+static void BM_BellPairStore_InsertErase(benchmark::State& state) {
+  BenchStore b(state.range(0), state.range(1));
+  for (auto _ : state) {
+    b.fill();
+    for (auto& qubit : b.qubits) b.store.eraseQubit(qubit.get());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BellPairStore_InsertErase)->Args({16, 1})->Args({128, 1})->Args({128, 8});
+
+// walk all the Bell pairs with each partner, as the RuleEngine does to hand resources to the Runtime.
+static void BM_BellPairStore_Range(benchmark::State& state) {
+  BenchStore b(state.range(0), state.range(1));
+  b.fill();
+  for (auto _ : state) {
+    int count = 0;
+    for (int partner = 0; partner < state.range(1); partner++) {
+      auto range = b.store.getBellPairsRange(QNIC_E, 0, partner);
+      for (auto it = range.first; it != range.second; it++) count++;
+    }
+    benchmark::DoNotOptimize(count);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BellPairStore_Range)->Args({16, 1})->Args({128, 1})->Args({128, 8});
+
+static void BM_BellPairStore_FindQubit(benchmark::State& state) {
+  BenchStore b(state.range(0), state.range(1));
+  b.fill();
+  int partner = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(b.store.findQubit(QNIC_E, 0, partner));
+    partner = (partner + 1) % state.range(1);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BellPairStore_FindQubit)->Args({128, 8});
+
+}  // namespace
@@ -4,7 +4,9 @@
 #include <modules/Logger/DisabledLogger.h>
 #include <modules/QRSA/RuleEngine/QubitRecord/IQubitRecord.h>
 #include <modules/QRSA/RuleEngine/QubitRecord/QubitRecord.h>
+#include <memory>
 #include <utility>
+#include <vector>
 #include "test_utils/TestUtils.h"
 
 namespace {
@@ -24,9 +26,9 @@ class BellPairStoreTest : public ::testing::Test {
  protected:
   void SetUp() override {
     qubit1 = new QubitRecord(QNIC_E, 3, 6);
-    qubit2 = new QubitRecord(QNIC_E, 3, 6);
-    qubit3 = new QubitRecord(QNIC_E, 3, 6);
-    qubit4 = new QubitRecord(QNIC_E, 3, 6);
+    qubit2 = new QubitRecord(QNIC_E, 3, 7);
+    qubit3 = new QubitRecord(QNIC_E, 3, 8);
+    qubit4 = new QubitRecord(QNIC_E, 3, 9);
     logger = new DisabledLogger{};
     store = BellPairStore(logger);
   }
@@ -46,33 +48,91 @@ class BellPairStoreTest : public ::testing::Test {
   ILogger *logger;
 };
 
-TEST_F(BellPairStoreTest, init) { EXPECT_EQ(store._resources.size(), 0); }
+TEST_F(BellPairStoreTest, init) { EXPECT_EQ(store.size(QNIC_E, 3), 0); }
 
 TEST_F(BellPairStoreTest, insert) {
   store.insertEntangledQubit(7, qubit1);
-  auto key = std::make_pair(QNIC_E, 3);
-  // check the PartnerAddrQubitMap is created for the key
-  ASSERT_EQ(store._resources.size(), 1);
-  ASSERT_NE(store._resources.find(key), store._resources.end()) << "bell pair not found";
-  auto it = store._resources[key].find(7);
-  ASSERT_FALSE(it == store._resources[key].end());
-  EXPECT_EQ(it->second, dynamic_cast<IQubitRecord *>(qubit1));
+  ASSERT_EQ(store.size(QNIC_E, 3), 1);
+  EXPECT_EQ(store.size(QNIC_R, 3), 0);
+  EXPECT_EQ(store.findQubit(QNIC_E, 3, 7), dynamic_cast<IQubitRecord *>(qubit1));
+}
+
+TEST_F(BellPairStoreTest, sizeAndAllocatedBytes) {
+  EXPECT_EQ(store.size(), 0);
+  auto empty_bytes = store.allocatedBytes();
+  store.insertEntangledQubit(7, qubit1);
+  store.insertEntangledQubit(8, qubit2);
+  EXPECT_EQ(store.size(), 2);
+  EXPECT_GT(store.allocatedBytes(), empty_bytes);
+  store.eraseQubit(qubit1);
+  EXPECT_EQ(store.size(), 1);
 }
 
 TEST_F(BellPairStoreTest, erase) {
   store.insertEntangledQubit(7, qubit1);
-  auto key = std::make_pair(QNIC_E, 3);
   store.eraseQubit(qubit1);
-  auto it = store._resources[key].find(7);
-  ASSERT_TRUE(it == store._resources[key].end());
+  EXPECT_EQ(store.findQubit(QNIC_E, 3, 7), nullptr);
+  EXPECT_EQ(store.size(QNIC_E, 3), 0);
 
   store.insertEntangledQubit(7, qubit1);
   store.insertEntangledQubit(7, qubit2);
+  // inserting the same qubit again moves it to the newest
   store.insertEntangledQubit(7, qubit1);
   store.insertEntangledQubit(7, qubit3);
+  EXPECT_EQ(store.size(QNIC_E, 3), 3);
+  store.eraseQubit(qubit1);
+  EXPECT_EQ(store.size(QNIC_E, 3), 2);
+  EXPECT_EQ(store.findQubit(QNIC_E, 3, 7), qubit2);
+
+  // erasing a qubit not in the store does nothing
+  store.eraseQubit(qubit1);
+  store.eraseQubit(qubit4);
+  EXPECT_EQ(store.size(QNIC_E, 3), 2);
+}
+
+// the iterators of an erased Bell pair must see a new generation, even before the slot is reused
+TEST_F(BellPairStoreTest, eraseBumpsGeneration) {
+  store.insertEntangledQubit(7, qubit1);
+  auto generation = [&]() { return store._resources[QNIC_E][3].slots[6].generation; };
+  auto inserted = generation();
   store.eraseQubit(qubit1);
-  it = store._resources[key].find(7);
-  EXPECT_EQ(store._resources[key].size(), 2);
+  auto erased = generation();
+  EXPECT_GT(erased, inserted);
+  store.insertEntangledQubit(7, qubit1);
+  EXPECT_GT(generation(), erased);
+}
+
+TEST_F(BellPairStoreTest, consumptionAges) {
+  EXPECT_EQ(store.consumptionAges(QNIC_E, 3).count(), 0);
+  qubit1->setEntangledTime(omnetpp::SimTime(1, omnetpp::SIMTIME_MS));
+  qubit2->setEntangledTime(omnetpp::SimTime(2, omnetpp::SIMTIME_MS));
+  store.insertEntangledQubit(7, qubit1);
+  store.insertEntangledQubit(7, qubit2);
+  store.consumeQubit(qubit1, omnetpp::SimTime(5, omnetpp::SIMTIME_MS));
+  EXPECT_EQ(store.size(QNIC_E, 3), 1);
+  // a qubit not in the store has no Bell pair to consume
+  store.consumeQubit(qubit1, omnetpp::SimTime(6, omnetpp::SIMTIME_MS));
+  EXPECT_EQ(store.consumptionAges(QNIC_E, 3).count(), 1);
+
+  auto interval = store.takeIntervalConsumptionAges(QNIC_E, 3);
+  EXPECT_EQ(interval.count(), 1);
+  EXPECT_NEAR(interval.mean(), 4e-3, 1e-12);
+  store.consumeQubit(qubit2, omnetpp::SimTime(10, omnetpp::SIMTIME_MS));
+  interval = store.takeIntervalConsumptionAges(QNIC_E, 3);
+  EXPECT_EQ(interval.count(), 1);
+  EXPECT_NEAR(interval.mean(), 8e-3, 1e-12);
+  EXPECT_EQ(store.takeIntervalConsumptionAges(QNIC_E, 3).count(), 0);
+  EXPECT_EQ(store.consumptionAges(QNIC_E, 3).count(), 2);
+  EXPECT_NEAR(store.consumptionAges(QNIC_E, 3).max(), 8e-3, 1e-12);
+}
+
+TEST_F(BellPairStoreTest, moveToAnotherPartner) {
+  store.insertEntangledQubit(7, qubit1);
+  store.insertEntangledQubit(7, qubit2);
+  store.insertEntangledQubit(8, qubit1);
+  EXPECT_EQ(store.findQubit(QNIC_E, 3, 7), qubit2);
+  EXPECT_EQ(store.findQubit(QNIC_E, 3, 8), qubit1);
+  EXPECT_EQ(store.size(QNIC_E, 3), 2);
 }
 
 TEST_F(BellPairStoreTest, find) {
@@ -134,4 +194,67 @@ TEST_F(BellPairStoreTest, getRangeWithLoop) {
   }
   EXPECT_EQ(count, 4);
 }
+TEST_F(BellPairStoreTest, allocatePendingQubits) {
+  store.insertEntangledQubit(7, qubit1);
+  store.insertEntangledQubit(8, qubit2);
+  store.insertEntangledQubit(7, qubit3);
+  store.insertEntangledQubit(7, qubit4);
+  store.eraseQubit(qubit4);
+
+  // no RuleSet uses the partner 8 yet
+  std::vector<std::pair<QNodeAddr, std::vector<IQubitRecord *>>> allocated;
+  auto allocate_partner_7 = [&](QNodeAddr partner_addr, const std::vector<IQubitRecord *> &qubits) {
+    if (partner_addr != 7) return false;
+    allocated.emplace_back(partner_addr, qubits);
+    return true;
+  };
+  store.allocatePendingQubits(QNIC_E, 3, allocate_partner_7);
+  ASSERT_EQ(allocated.size(), 1);
+  EXPECT_EQ(allocated[0].second, (std::vector<IQubitRecord *>{qubit1, qubit3}));
+
+  // the allocated qubits are not passed again, but the others are
+  allocated.clear();
+  store.allocatePendingQubits(QNIC_E, 3, [&](QNodeAddr partner_addr, const std::vector<IQubitRecord *> &qubits) {
+    allocated.emplace_back(partner_addr, qubits);
+    return true;
+  });
+  ASSERT_EQ(allocated.size(), 1);
+  EXPECT_EQ(allocated[0].first, 8);
+  EXPECT_EQ(allocated[0].second, (std::vector<IQubitRecord *>{qubit2}));
+
+  // the allocated qubits stay in the store
+  EXPECT_EQ(store.findQubit(QNIC_E, 3, 7), qubit1);
+  allocated.clear();
+  store.allocatePendingQubits(QNIC_E, 3, allocate_partner_7);
+  store.allocatePendingQubits(QNIC_R, 0, allocate_partner_7);
+  EXPECT_TRUE(allocated.empty());
+}
+TEST(BellPairStoreScalingTest, EraseIsConstantTime) {
+  struct Fixture {
+    DisabledLogger logger;
+    BellPairStore store{&logger};
+    std::vector<std::unique_ptr<QubitRecord>> qubits;
+  };
+  auto setup = [](std::size_t n) {
+    auto fixture = std::make_unique<Fixture>();
+    for (std::size_t i = 0; i < n; i++) {
+      fixture->qubits.push_back(std::make_unique<QubitRecord>(QNIC_E, 0, i));
+      fixture->store.insertEntangledQubit(7, fixture->qubits.back().get());
+    }
+    return fixture;
+  };
+  // the oldest first while all of them are pending, the worst case of scanning the pending qubits
+  auto erase_all = [](std::unique_ptr<Fixture> &fixture) {
+    for (auto &qubit : fixture->qubits) fixture->store.eraseQubit(qubit.get());
+  };
+  EXPECT_LT(growthExponent(1 << 13, setup, erase_all), 1.5);
+
+  // and after the allocation, with the partners in turn
+  auto allocate_and_erase_all = [](std::unique_ptr<Fixture> &fixture) {
+    fixture->store.allocatePendingQubits(QNIC_E, 0, [](QNodeAddr, const std::vector<IQubitRecord *> &) { return true; });
+    for (auto &qubit : fixture->qubits) fixture->store.eraseQubit(qubit.get());
+  };
+  EXPECT_LT(growthExponent(1 << 13, setup, allocate_and_erase_all), 1.5);
+}
+
 }  // namespace
@@ -0,0 +1,38 @@
+#include "LinkTrace.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace quisp::modules::link_trace {
+
+namespace {
+constexpr const char *link_trace_tag = "QLINKTR1";
+}
+
+LinkTraceWriter::LinkTraceWriter(std::string path, std::size_t batch_size) : file(std::move(path), link_trace_tag, sizeof(LinkTraceRecord)), batch_size(std::max<std::size_t>(batch_size, 1)) {
+  buffer.reserve(this->batch_size);
+}
+
+void LinkTraceWriter::append(const LinkTraceRecord &record) {
+  buffer.push_back(record);
+  num_records++;
+  if (buffer.size() >= batch_size) flush();
+}
+
+void LinkTraceWriter::flush() {
+  file.append(buffer.data(), buffer.size());
+  buffer.clear();
+}
+
+std::vector<LinkTraceRecord> readLinkTrace(const std::string &path, int node_addr) {
+  std::vector<LinkTraceRecord> records;
+  utils::RecordFile{path, link_trace_tag, sizeof(LinkTraceRecord)}.read([&](const std::byte *bytes) {
+    LinkTraceRecord record;
+    std::memcpy(&record, bytes, sizeof(LinkTraceRecord));
+    if (record.node_addr == node_addr) records.push_back(record);
+  });
+  std::stable_sort(records.begin(), records.end(), [](const LinkTraceRecord &a, const LinkTraceRecord &b) { return a.time < b.time; });
+  return records;
+}
+
+}  // namespace quisp::modules::link_trace
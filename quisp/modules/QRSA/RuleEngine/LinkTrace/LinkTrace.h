@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "utils/RecordFile.h"
+
+namespace quisp::modules::link_trace {
+
+/**
+ * @brief a Bell pair of a link as the RuleEngine of node_addr got it from the BSA, the raw record of a link trace file.
+ *
+ * The nodes of a run append their pairs to the same file, and a replay takes the records of each node in the order of their time.
+ */
+struct LinkTraceRecord {
+  double time;  // in seconds
+  std::int32_t node_addr;
+  std::int32_t qnic_type;
+  std::int32_t qnic_index;
+  std::int32_t partner_addr;
+  // PauliOperator of the BSA result
+  std::uint8_t correction_operation;
+  std::uint8_t pauli_error;
+  std::uint8_t padding[6] = {};
+};
+static_assert(sizeof(LinkTraceRecord) == 32, "the records of the files are 32 bytes");
+
+/// @brief buffers the records and appends them to the file in batches.
+class LinkTraceWriter {
+ public:
+  explicit LinkTraceWriter(std::string path, std::size_t batch_size = 4096);
+
+  /// @throws std::runtime_error if a full batch can't be written
+  void append(const LinkTraceRecord &record);
+  /// @throws std::runtime_error if the file can't be written
+  void flush();
+  std::size_t numRecords() const { return num_records; }
+
+ private:
+  utils::RecordFile file;
+  std::size_t batch_size;
+  std::vector<LinkTraceRecord> buffer;
+  std::size_t num_records = 0;
+};
+
+/// @brief the records of the node in the file in the order of their time, the ones of the same time in the recorded order.
+/// @throws std::runtime_error if the file isn't a link trace
+std::vector<LinkTraceRecord> readLinkTrace(const std::string &path, int node_addr);
+
+}  // namespace quisp::modules::link_trace
@@ -0,0 +1,61 @@
+#include "LinkTrace.h"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <stdexcept>
+#include <string>
+
+#include "utils/RecordFile.h"
+
+namespace {
+using namespace quisp::modules::link_trace;
+
+class LinkTraceTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    path = testing::TempDir() + "link_trace_test_" + std::to_string(::getpid());
+    ::unlink(path.c_str());
+  }
+  void TearDown() override { ::unlink(path.c_str()); }
+
+  static LinkTraceRecord makeRecord(double time, int node_addr, int partner_addr) {
+    LinkTraceRecord record{.time = time, .node_addr = node_addr, .qnic_type = 0, .qnic_index = 1, .partner_addr = partner_addr, .correction_operation = 1, .pauli_error = 3};
+    return record;
+  }
+
+  std::string path;
+};
+
+TEST_F(LinkTraceTest, ReadTheRecordsOfTheNodeInTimeOrder) {
+  // the nodes flush their batches at different times, so the file isn't in time order
+  LinkTraceWriter node_1(path, 2), node_2(path);
+  node_1.append(makeRecord(0.3, 1, 2));
+  node_2.append(makeRecord(0.1, 2, 1));
+  node_1.append(makeRecord(0.2, 1, 3));
+  // the full batch is written already
+  EXPECT_EQ(readLinkTrace(path, 1).size(), 2);
+  node_1.append(makeRecord(0.1, 1, 2));
+  node_1.flush();
+  node_2.flush();
+  EXPECT_EQ(node_1.numRecords(), 3);
+
+  auto records = readLinkTrace(path, 1);
+  ASSERT_EQ(records.size(), 3);
+  EXPECT_DOUBLE_EQ(records[0].time, 0.1);
+  EXPECT_DOUBLE_EQ(records[1].time, 0.2);
+  EXPECT_EQ(records[1].partner_addr, 3);
+  EXPECT_EQ(records[1].qnic_index, 1);
+  EXPECT_EQ(records[1].correction_operation, 1);
+  EXPECT_EQ(records[1].pauli_error, 3);
+  EXPECT_DOUBLE_EQ(records[2].time, 0.3);
+  EXPECT_EQ(readLinkTrace(path, 2).size(), 1);
+  EXPECT_TRUE(readLinkTrace(path, 4).empty());
+}
+
+TEST_F(LinkTraceTest, RejectsAnotherRecordFile) {
+  double record = 1;
+  quisp::utils::RecordFile{path, "OTHER", sizeof(record)}.append(&record);
+  EXPECT_THROW(readLinkTrace(path, 1), std::runtime_error);
+}
+
+}  // namespace
@@ -0,0 +1,35 @@
+#include "PhotonTrain.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace quisp::modules::photon_train {
+
+void PhotonTrain::emit(int qubit_index) {
+  qubit_indices.push_back(qubit_index);
+  succeeded.push_back(false);
+}
+
+int PhotonTrain::markSucceeded(int emitted_index) {
+  if (emitted_index < 0 || emitted_index >= (int)qubit_indices.size()) {
+    throw std::out_of_range("PhotonTrain: photon " + std::to_string(emitted_index) + " was not emitted");
+  }
+  succeeded[emitted_index] = true;
+  return qubit_indices[emitted_index];
+}
+
+std::vector<int> PhotonTrain::takeFailedQubitIndices() {
+  std::vector<int> failed;
+  for (std::size_t i = 0; i < qubit_indices.size(); i++) {
+    if (!succeeded[i]) failed.push_back(qubit_indices[i]);
+  }
+  clear();
+  return failed;
+}
+
+void PhotonTrain::clear() {
+  qubit_indices.clear();
+  succeeded.clear();
+}
+
+}  // namespace quisp::modules::photon_train
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace quisp::modules::photon_train {
+
+/**
+ * @brief PhotonTrain records the qubits that emitted photons in a BSM round, in the emitted order.
+ *
+ * The BSA reports the successful photons by their emitted index, so the successes are marked in a bitmap
+ * instead of erasing them from the train. The qubits not marked are the failed attempts.
+ */
+class PhotonTrain {
+ public:
+  void emit(int qubit_index);
+  /// @brief marks the photon as successful and returns its qubit index. Throws std::out_of_range for an unknown photon.
+  int markSucceeded(int emitted_index);
+  /// @brief returns the qubit indices of the photons not marked as successful, in the emitted order, and clears the train.
+  std::vector<int> takeFailedQubitIndices();
+  std::size_t size() const { return qubit_indices.size(); }
+  bool empty() const { return qubit_indices.empty(); }
+  void clear();
+
+ protected:
+  std::vector<int> qubit_indices;
+  std::vector<bool> succeeded;
+};
+
+}  // namespace quisp::modules::photon_train
@@ -0,0 +1,38 @@
+#include "PhotonTrain.h"
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+namespace {
+using quisp::modules::photon_train::PhotonTrain;
+
+TEST(PhotonTrainTest, TakeFailedQubits) {
+  PhotonTrain train;
+  for (int qubit_index : {4, 2, 7, 0}) train.emit(qubit_index);
+  ASSERT_EQ(train.size(), 4);
+
+  EXPECT_EQ(train.markSucceeded(1), 2);
+  EXPECT_EQ(train.markSucceeded(3), 0);
+  // the emitted indices don't shift after a success
+  EXPECT_EQ(train.markSucceeded(2), 7);
+
+  EXPECT_EQ(train.takeFailedQubitIndices(), std::vector<int>{4});
+  EXPECT_TRUE(train.empty());
+  EXPECT_TRUE(train.takeFailedQubitIndices().empty());
+}
+
+TEST(PhotonTrainTest, AllFailed) {
+  PhotonTrain train;
+  train.emit(1);
+  train.emit(3);
+  EXPECT_EQ(train.takeFailedQubitIndices(), (std::vector<int>{1, 3}));
+}
+
+TEST(PhotonTrainTest, UnknownPhoton) {
+  PhotonTrain train;
+  train.emit(1);
+  EXPECT_THROW(train.markSucceeded(1), std::out_of_range);
+  EXPECT_THROW(train.markSucceeded(-1), std::out_of_range);
+}
+
+}  // namespace
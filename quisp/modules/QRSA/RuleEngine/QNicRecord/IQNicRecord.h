@@ -2,9 +2,17 @@
 
 #include <modules/QRSA/QRSA.h>
 #include <utils/ComponentProvider.h>
+#include <utils/StreamingStats.h>
 
 namespace quisp::modules::qnic_record {
 
+/// @brief the time-weighted numbers of the busy and the allocated qubits of a QNIC over a period, the rest of num_qubits are free.
+struct QNicOccupancy {
+  int num_qubits = 0;
+  utils::TimeWeightedAverage busy_qubits;
+  utils::TimeWeightedAverage allocated_qubits;
+};
+
 /** IQNicRecord
  * @brief Interface for QNIC record.
  *
@@ -15,9 +23,15 @@ class IQNicRecord {
  public:
   virtual ~IQNicRecord(){};
   virtual int countNumFreeQubits() = 0;
+  virtual int countNumAllocatedQubits() = 0;
+  virtual int countNumLockedQubits() = 0;
   virtual int takeFreeQubitIndex() = 0;
   virtual void setQubitBusy(int qubit_index, bool is_busy) = 0;
   virtual qrsa::IQubitRecord* getQubit(int qubit_index) = 0;
+  /// @brief the occupancy since the construction of the record.
+  virtual const QNicOccupancy& getOccupancy() const = 0;
+  /// @brief returns the occupancy since the last call, or the construction, and starts the next interval.
+  virtual QNicOccupancy takeIntervalOccupancy() = 0;
 };
 
 }  // namespace quisp::modules::qnic_record
@@ -1,41 +1,105 @@
 #include "QNicRecord.h"
-#include "../QubitRecord/QubitRecord.h"
+#include <utility>
 #include "modules/QNIC.h"
+#include "utils/Validation.h"
 
 namespace quisp::modules::qnic_record {
-using quisp::modules::qubit_record::QubitRecord;
 
-QNicRecord::QNicRecord(utils::ComponentProvider& provider, int index, QNIC_type type, Logger::ILogger* logger) : index(index), type(type) {
-  int num_qubits = provider.getNumQubits(index, type);
-  for (int i = 0; i < num_qubits; i++) {
-    qubits.emplace_back(std::make_unique<QubitRecord>(type, index, i, logger));
+bool QNicQubitRecord::isBusy() const { return !QNicRecord::test(owner->free_qubits, qubit_index); }
+
+void QNicQubitRecord::setBusy(bool _is_busy) {
+  if (isBusy() == _is_busy) {
+    throw omnetpp::cRuntimeError("QubitRecord::setBusy: is_busy is already set to the same value. Qubit(%s, %d, %d)", QNIC_names[owner->type], owner->index, qubit_index);
+  }
+  QNicRecord::assign(owner->free_qubits, qubit_index, !_is_busy);
+  owner->num_free_qubits += _is_busy ? -1 : 1;
+  owner->recordOccupancy();
+  owner->logState(qubit_index);
+}
+
+bool QNicQubitRecord::isAllocated() const { return QNicRecord::test(owner->allocated_qubits, qubit_index); }
+
+void QNicQubitRecord::setAllocated(bool _is_allocated) {
+  if (isAllocated() == _is_allocated) {
+    throw omnetpp::cRuntimeError("QubitRecord::setAllocated: is_allocated is already set to the same value. Qubit(%s, %d, %d)", QNIC_names[owner->type], owner->index, qubit_index);
   }
+  QNicRecord::assign(owner->allocated_qubits, qubit_index, _is_allocated);
+  owner->num_allocated_qubits += _is_allocated ? 1 : -1;
+  owner->recordOccupancy();
+  owner->logState(qubit_index);
 }
 
-int QNicRecord::countNumFreeQubits() {
-  int num_free = 0;
-  for (auto& qubit : qubits) {
-    if (!qubit->isBusy()) {
-      num_free++;
-    }
+int QNicQubitRecord::getQNicIndex() const { return owner->index; }
+QNIC_type QNicQubitRecord::getQNicType() const { return owner->type; }
+omnetpp::simtime_t QNicQubitRecord::getEntangledTime() const { return owner->entangled_times[qubit_index]; }
+void QNicQubitRecord::setEntangledTime(omnetpp::simtime_t time) { owner->entangled_times[qubit_index] = time; }
+
+bool QNicQubitRecord::isLocked() const { return QNicRecord::test(owner->locked_qubits, qubit_index); }
+
+void QNicQubitRecord::lock(unsigned long ruleset_id, int rule_id, int action_index) {
+  if (ruleset_id == (unsigned long)-1 || rule_id == -1 || action_index == -1) {
+    throw omnetpp::cRuntimeError("QubitRecord::lock: ruleset_id, rule_id or action_index is -1. Qubit(%s, %d, %d)", QNIC_names[owner->type], owner->index, qubit_index);
   }
-  return num_free;
+  QNicRecord::assign(owner->locked_qubits, qubit_index, true);
+  owner->locked_ruleset_ids[qubit_index] = ruleset_id;
+  owner->locked_rule_ids[qubit_index] = rule_id;
+  owner->action_indices[qubit_index] = action_index;
+}
+
+void QNicQubitRecord::unlock() {
+  QNicRecord::assign(owner->locked_qubits, qubit_index, false);
+  owner->locked_ruleset_ids[qubit_index] = -1;
+  owner->locked_rule_ids[qubit_index] = -1;
+  owner->action_indices[qubit_index] = -1;
 }
 
+unsigned long QNicQubitRecord::getLockedRuleSetId() const { return owner->locked_ruleset_ids[qubit_index]; }
+int QNicQubitRecord::getLockedRuleId() const { return owner->locked_rule_ids[qubit_index]; }
+int QNicQubitRecord::getActionIndex() const { return owner->action_indices[qubit_index]; }
+int QNicQubitRecord::getPauliFrame() const { return owner->pauli_frames[qubit_index]; }
+void QNicQubitRecord::setPauliFrame(int frame) { owner->pauli_frames[qubit_index] = frame; }
+
+QNicRecord::QNicRecord(utils::ComponentProvider& provider, int index, QNIC_type type, Logger::ILogger* logger) : index(index), type(type), logger(logger) {
+  int num_qubits = provider.getNumQubits(index, type);
+  int num_words = (num_qubits + 63) / 64;
+  qubits.reserve(num_qubits);
+  free_qubits.assign(num_words, 0);
+  allocated_qubits.assign(num_words, 0);
+  locked_qubits.assign(num_words, 0);
+  for (int i = 0; i < num_qubits; i++) {
+    qubits.emplace_back(this, i);
+    assign(free_qubits, i, true);
+  }
+  num_free_qubits = num_qubits;
+  entangled_times.assign(num_qubits, SIMTIME_ZERO);
+  locked_ruleset_ids.assign(num_qubits, -1);
+  locked_rule_ids.assign(num_qubits, -1);
+  action_indices.assign(num_qubits, -1);
+  pauli_frames.assign(num_qubits, 0);
+  occupancy.num_qubits = interval_occupancy.num_qubits = num_qubits;
+  recordOccupancy();
+}
+
+int QNicRecord::countNumFreeQubits() { return num_free_qubits; }
+int QNicRecord::countNumAllocatedQubits() { return num_allocated_qubits; }
+int QNicRecord::countNumLockedQubits() { return count(locked_qubits); }
+
 int QNicRecord::takeFreeQubitIndex() {
-  for (auto& qubit : qubits) {
-    if (!qubit->isBusy()) {
-      qubit->setBusy(true);
-      return qubit->getQubitIndex();
-    }
+  if (num_free_qubits == 0) return -1;
+  for (std::size_t word = 0; word < free_qubits.size(); word++) {
+    if (free_qubits[word] == 0) continue;
+    int qubit_index = word * 64 + __builtin_ctzll(free_qubits[word]);
+    qubits[qubit_index].setBusy(true);
+    return qubit_index;
   }
   return -1;
 }
+
 qrsa::IQubitRecord* QNicRecord::getQubit(int qubit_index) {
-  if (qubits.size() <= qubit_index) {
+  if (utils::validates(utils::ValidationLevel::Cheap) && (qubit_index < 0 || qubits.size() <= qubit_index)) {
     throw omnetpp::cRuntimeError("QNicRecord::getQubit: Qubit index:%d out of range. QNIC{%s, %d}, qubits.size(): %lu", qubit_index, QNIC_names[type], index, qubits.size());
   }
-  return qubits.at(qubit_index).get();
+  return &qubits[qubit_index];
 }
 
 void QNicRecord::setQubitBusy(int qubit_index, bool is_busy) {
@@ -43,4 +107,40 @@ void QNicRecord::setQubitBusy(int qubit_index, bool is_busy) {
   qubit->setBusy(is_busy);
 }
 
+QNicOccupancy QNicRecord::takeIntervalOccupancy() {
+  auto taken = std::move(interval_occupancy);
+  interval_occupancy = QNicOccupancy{};
+  interval_occupancy.num_qubits = taken.num_qubits;
+  recordOccupancy();
+  return taken;
+}
+
+void QNicRecord::recordOccupancy() {
+  double now = omnetpp::simTime().dbl();
+  int num_busy_qubits = qubits.size() - num_free_qubits;
+  for (auto* period : {&occupancy, &interval_occupancy}) {
+    period->busy_qubits.update(now, num_busy_qubits);
+    period->allocated_qubits.update(now, num_allocated_qubits);
+  }
+}
+
+void QNicRecord::assign(Bits& bits, int qubit_index, bool value) {
+  auto bit = std::uint64_t{1} << (qubit_index % 64);
+  if (value) {
+    bits[qubit_index / 64] |= bit;
+  } else {
+    bits[qubit_index / 64] &= ~bit;
+  }
+}
+
+int QNicRecord::count(const Bits& bits) {
+  int n = 0;
+  for (auto word : bits) n += __builtin_popcountll(word);
+  return n;
+}
+
+void QNicRecord::logState(int qubit_index) {
+  QUISP_LOG(logger, QubitState, logQubitState(type, index, qubit_index, !test(free_qubits, qubit_index), test(allocated_qubits, qubit_index)));
+}
+
 }  // namespace quisp::modules::qnic_record
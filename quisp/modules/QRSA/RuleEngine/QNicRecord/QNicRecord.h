@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 #include <modules/Logger/ILogger.h>
 #include <modules/QNIC.h>
@@ -12,23 +14,86 @@ namespace quisp::modules::qnic_record {
 
 using quisp::modules::qubit_record::IQubitRecord;
 
+class QNicRecord;
+
+/**
+ * @brief the handle of a qubit's state kept in its QNicRecord.
+ * The flags are bits and the other fields are elements of the arrays in the owner,
+ * so the owner counts and scans the qubits a word at a time.
+ */
+class QNicQubitRecord : public IQubitRecord {
+ public:
+  QNicQubitRecord(QNicRecord* owner, int qubit_index) : owner(owner), qubit_index(qubit_index) {}
+  bool isBusy() const override;
+  void setBusy(bool _is_busy) override;
+  bool isAllocated() const override;
+  void setAllocated(bool _is_allocated) override;
+  int getQubitIndex() const override { return qubit_index; }
+  int getQNicIndex() const override;
+  QNIC_type getQNicType() const override;
+  omnetpp::simtime_t getEntangledTime() const override;
+  void setEntangledTime(omnetpp::simtime_t time) override;
+  bool isLocked() const override;
+  void lock(unsigned long ruleset_id, int rule_id, int action_index) override;
+  void unlock() override;
+  unsigned long getLockedRuleSetId() const override;
+  int getLockedRuleId() const override;
+  int getActionIndex() const override;
+  int getPauliFrame() const override;
+  void setPauliFrame(int frame) override;
+
+ protected:
+  QNicRecord* owner;
+  int qubit_index;
+};
+
 class QNicRecord : public IQNicRecord {
  public:
   QNicRecord(utils::ComponentProvider& provider, int index, QNIC_type type, Logger::ILogger* logger = nullptr);
   ~QNicRecord(){};
+  QNicRecord(const QNicRecord&) = delete;
+  QNicRecord& operator=(const QNicRecord&) = delete;
 
   int countNumFreeQubits() override;
+  int countNumAllocatedQubits() override;
+  int countNumLockedQubits() override;
   int takeFreeQubitIndex() override;
   void setQubitBusy(int qubit_index, bool is_busy) override;
   qrsa::IQubitRecord* getQubit(int qubit_index) override;
+  const QNicOccupancy& getOccupancy() const override { return occupancy; }
+  QNicOccupancy takeIntervalOccupancy() override;
 
   const int index;
   const QNIC_type type;
 
  protected:
-  // QNicRecord class has the ownership of the QubitRecords.
-  // if QNicRecord is destroyed, all QubitRecords will be destroyed automatically.
-  std::vector<std::unique_ptr<IQubitRecord>> qubits;
+  friend QNicQubitRecord;
+  using Bits = std::vector<std::uint64_t>;
+  static bool test(const Bits& bits, int qubit_index) { return (bits[qubit_index / 64] >> (qubit_index % 64)) & 1; }
+  static void assign(Bits& bits, int qubit_index, bool value);
+  static int count(const Bits& bits);
+  void logState(int qubit_index);
+  // brings the occupancy up to the counts at the current simtime, O(1) on every change of a qubit
+  void recordOccupancy();
+
+  // QNicRecord class has the ownership of the qubit handles.
+  // they are stored contiguously and never reallocated, so the pointers to them stay valid.
+  std::vector<QNicQubitRecord> qubits;
+  // bit i is set if the qubit i is free, i.e. not busy
+  Bits free_qubits;
+  Bits allocated_qubits;
+  Bits locked_qubits;
+  int num_free_qubits = 0;
+  int num_allocated_qubits = 0;
+  QNicOccupancy occupancy;
+  QNicOccupancy interval_occupancy;
+  std::vector<omnetpp::simtime_t> entangled_times;
+  // the Rule action holding the qubit, -1 if not locked
+  std::vector<unsigned long> locked_ruleset_ids;
+  std::vector<int> locked_rule_ids;
+  std::vector<int> action_indices;
+  std::vector<std::uint8_t> pauli_frames;
+  Logger::ILogger* logger;
 };
 
 }  // namespace quisp::modules::qnic_record
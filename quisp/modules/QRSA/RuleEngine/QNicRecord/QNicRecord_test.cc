@@ -79,6 +79,112 @@ TEST(QNicRecord, SetQubitBusy) {
   EXPECT_EQ(1, record.countNumFreeQubits());
 }
 
+TEST(QNicRecord, TakeLowestFreeQubit) {
+  ComponentProvider provider(new cModule());
+  int qnic_index = 3;
+  auto qnic_type = QNIC_E;
+  std::vector<QNicSpec> qnic_specs = {{qnic_type, qnic_index, 70}};
+  provider.setStrategy(std::make_unique<TestComponentProviderStrategy>(qnic_specs));
+
+  QNicRecord record(provider, qnic_index, qnic_type, new DisabledLogger{});
+  for (int i = 0; i < 70; i++) EXPECT_EQ(i, record.takeFreeQubitIndex());
+  EXPECT_EQ(-1, record.takeFreeQubitIndex());
+  record.setQubitBusy(66, false);
+  record.setQubitBusy(3, false);
+  EXPECT_EQ(2, record.countNumFreeQubits());
+  EXPECT_EQ(3, record.takeFreeQubitIndex());
+  EXPECT_EQ(66, record.takeFreeQubitIndex());
+}
+
+TEST(QNicRecord, SetBusyThroughQubitRecord) {
+  ComponentProvider provider(new cModule());
+  int qnic_index = 3;
+  auto qnic_type = QNIC_E;
+  std::vector<QNicSpec> qnic_specs = {{qnic_type, qnic_index, 3}};
+  provider.setStrategy(std::make_unique<TestComponentProviderStrategy>(qnic_specs));
+
+  QNicRecord record(provider, qnic_index, qnic_type, new DisabledLogger{});
+  // the free qubit count follows the changes made directly on the QubitRecord
+  record.getQubit(0)->setBusy(true);
+  EXPECT_EQ(2, record.countNumFreeQubits());
+  EXPECT_EQ(1, record.takeFreeQubitIndex());
+  record.getQubit(0)->setBusy(false);
+  EXPECT_EQ(2, record.countNumFreeQubits());
+  EXPECT_EQ(0, record.takeFreeQubitIndex());
+}
+
+TEST(QNicRecord, QubitStatesInBitsets) {
+  ComponentProvider provider(new cModule());
+  int qnic_index = 3;
+  auto qnic_type = QNIC_R;
+  std::vector<QNicSpec> qnic_specs = {{qnic_type, qnic_index, 70}};
+  provider.setStrategy(std::make_unique<TestComponentProviderStrategy>(qnic_specs));
+
+  QNicRecord record(provider, qnic_index, qnic_type, new DisabledLogger{});
+  auto* qubit = record.getQubit(65);
+  EXPECT_EQ(qnic_index, qubit->getQNicIndex());
+  EXPECT_EQ(qnic_type, qubit->getQNicType());
+  EXPECT_EQ(65, qubit->getQubitIndex());
+
+  qubit->setBusy(true);
+  qubit->setAllocated(true);
+  record.getQubit(2)->setAllocated(true);
+  EXPECT_TRUE(qubit->isBusy());
+  EXPECT_TRUE(qubit->isAllocated());
+  EXPECT_FALSE(record.getQubit(64)->isAllocated());
+  EXPECT_EQ(2, record.countNumAllocatedQubits());
+  EXPECT_THROW(qubit->setAllocated(true), omnetpp::cRuntimeError);
+
+  qubit->lock(1, 2, 3);
+  EXPECT_TRUE(qubit->isLocked());
+  EXPECT_EQ(1, qubit->getLockedRuleSetId());
+  EXPECT_EQ(2, qubit->getLockedRuleId());
+  EXPECT_EQ(3, qubit->getActionIndex());
+  EXPECT_EQ(1, record.countNumLockedQubits());
+  qubit->unlock();
+  EXPECT_FALSE(qubit->isLocked());
+  EXPECT_EQ(-1, qubit->getActionIndex());
+  EXPECT_EQ(0, record.countNumLockedQubits());
+
+  qubit->setEntangledTime(omnetpp::SimTime(5));
+  EXPECT_EQ(omnetpp::SimTime(5), qubit->getEntangledTime());
+  EXPECT_EQ(SIMTIME_ZERO, record.getQubit(64)->getEntangledTime());
+}
+
+TEST(QNicRecord, TimeWeightedOccupancy) {
+  ComponentProvider provider(new cModule());
+  int qnic_index = 3;
+  auto qnic_type = QNIC_E;
+  std::vector<QNicSpec> qnic_specs = {{qnic_type, qnic_index, 4}};
+  provider.setStrategy(std::make_unique<TestComponentProviderStrategy>(qnic_specs));
+  auto* sim = omnetpp::getSimulation();
+
+  QNicRecord record(provider, qnic_index, qnic_type, new DisabledLogger{});
+  // 2 busy qubits for 1s, then 3 busy and 1 allocated for 1s
+  record.setQubitBusy(0, true);
+  record.setQubitBusy(1, true);
+  sim->setSimTime(1);
+  record.setQubitBusy(2, true);
+  record.getQubit(2)->setAllocated(true);
+  sim->setSimTime(2);
+  auto &occupancy = record.getOccupancy();
+  EXPECT_EQ(4, occupancy.num_qubits);
+  EXPECT_DOUBLE_EQ(2.5, occupancy.busy_qubits.average(2));
+  EXPECT_DOUBLE_EQ(0.5, occupancy.allocated_qubits.average(2));
+  EXPECT_DOUBLE_EQ(3, occupancy.busy_qubits.max());
+
+  // the interval restarts from the current counts
+  auto interval = record.takeIntervalOccupancy();
+  EXPECT_DOUBLE_EQ(2.5, interval.busy_qubits.average(2));
+  record.setQubitBusy(0, false);
+  sim->setSimTime(4);
+  interval = record.takeIntervalOccupancy();
+  EXPECT_DOUBLE_EQ(2, interval.busy_qubits.average(4));
+  EXPECT_DOUBLE_EQ(1, interval.allocated_qubits.average(4));
+  EXPECT_DOUBLE_EQ(2.25, record.getOccupancy().busy_qubits.average(4));
+  sim->setSimTime(0);
+}
+
 TEST(QNicRecord, SetQubitBusyWithInvalidIndex) {
   ComponentProvider provider(new cModule());
   int qnic_index = 3;
@@ -2,6 +2,7 @@
 
 #include "modules/QNIC.h"
 #include "modules/QRSA/QRSA.h"
+#include "modules/QRSA/RuleEngine/QNicRecord/IQNicRecord.h"
 
 namespace quisp::modules::qnic_store {
 
@@ -18,6 +19,7 @@ class IQNicStore {
   virtual int takeFreeQubitIndex(QNIC_type type, int qnic_index) = 0;
   virtual void setQubitBusy(QNIC_type type, int qnic_index, int qubit_index, bool is_busy) = 0;
   virtual qrsa::IQubitRecord* getQubitRecord(QNIC_type type, int qnic_index, int qubit_index) = 0;
+  virtual qnic_record::IQNicRecord* getQNicRecord(QNIC_type type, int qnic_index) = 0;
 };
 
 }  // namespace quisp::modules::qnic_store
@@ -44,6 +44,8 @@ qrsa::IQubitRecord* QNicStore::getQubitRecord(QNIC_type type, int qnic_index, in
   return qnic->getQubit(qubit_index);
 }
 
+qnic_record::IQNicRecord* QNicStore::getQNicRecord(QNIC_type type, int qnic_index) { return getQNic(type, qnic_index).get(); }
+
 UniqueQNicRecord& QNicStore::getQNic(QNIC_type type, int qnic_index) {
   if (qnics.size() <= type) {
     throw cRuntimeError("QNicStore::getQNic(): QNIC type %d not found", type);
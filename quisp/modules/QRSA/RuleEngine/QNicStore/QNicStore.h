@@ -23,6 +23,7 @@ class QNicStore : public IQNicStore {
   int takeFreeQubitIndex(QNIC_type type, int qnic_index) override;
   void setQubitBusy(QNIC_type type, int qnic_index, int qubit_index, bool is_busy) override;
   qrsa::IQubitRecord* getQubitRecord(QNIC_type type, int qnic_index, int qubit_index) override;
+  qnic_record::IQNicRecord* getQNicRecord(QNIC_type type, int qnic_index) override;
 
  protected:
   UniqueQNicRecord& getQNic(QNIC_type type, int qnic_index);
@@ -0,0 +1,39 @@
+#include "QosArbiter.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace quisp::modules::qos_arbiter {
+
+int QosArbiter::classOf(int priority, double min_share) {
+  if (min_share < 0 || min_share > 1) throw std::invalid_argument("QosArbiter: the min share must be in [0, 1]: " + std::to_string(min_share));
+  auto [it, inserted] = class_indices.emplace(priority, classes.size());
+  if (inserted) {
+    classes.push_back({priority, min_share});
+  } else {
+    auto &qos_class = classes[it->second];
+    qos_class.min_share = std::max(qos_class.min_share, min_share);
+  }
+  return it->second;
+}
+
+int QosArbiter::choose(const std::vector<int> &candidates) {
+  int chosen = candidates.front();
+  if (candidates.size() > 1) {
+    int behind = -1;
+    for (int class_index : candidates) {
+      auto &qos_class = classes[class_index];
+      qos_class.credit += qos_class.min_share;
+      if (qos_class.credit >= 1 && (behind == -1 || qos_class.credit > classes[behind].credit)) behind = class_index;
+      if (qos_class.priority > classes[chosen].priority) chosen = class_index;
+    }
+    if (behind != -1) chosen = behind;
+    auto &credit = classes[chosen].credit;
+    credit = std::max(0.0, credit - 1);
+  }
+  classes[chosen].delivered++;
+  return chosen;
+}
+
+}  // namespace quisp::modules::qos_arbiter
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace quisp::modules::qos_arbiter {
+
+/**
+ * @brief QosArbiter decides which QoS class takes the next Bell pair among the classes waiting for it.
+ *
+ * A class is the priority chosen at the connection setup, with the minimum share of the pairs it's guaranteed.
+ * Each class waiting for a pair earns min_share credit per pair, and spends one credit per pair it takes, never going below 0.
+ * A class with a whole credit is behind its share, so the one furthest behind takes the pair. Otherwise the highest priority does.
+ * The pairs nobody else waits for aren't contended and don't count for the credits.
+ * The decision is linear in the waiting classes, which are few, not in the Runtimes or the pairs.
+ */
+class QosArbiter {
+ public:
+  /**
+   * @brief returns the index of the class of the priority, adding it the first time.
+   * The min_share of a class is the largest one of its RuleSets. Throws std::invalid_argument if it's not in [0, 1].
+   */
+  int classOf(int priority, double min_share);
+
+  /// @brief chooses the class of the next pair among the candidate classes, and counts the pair delivered to it.
+  int choose(const std::vector<int> &candidates);
+
+  std::size_t numClasses() const { return classes.size(); }
+  int priority(int class_index) const { return classes[class_index].priority; }
+  double minShare(int class_index) const { return classes[class_index].min_share; }
+  std::uint64_t numDelivered(int class_index) const { return classes[class_index].delivered; }
+
+ private:
+  struct QosClass {
+    int priority;
+    double min_share;
+    double credit = 0;
+    std::uint64_t delivered = 0;
+  };
+  std::vector<QosClass> classes;
+  std::unordered_map<int, int> class_indices;
+};
+
+}  // namespace quisp::modules::qos_arbiter
@@ -0,0 +1,54 @@
+#include "QosArbiter.h"
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+namespace {
+using quisp::modules::qos_arbiter::QosArbiter;
+
+TEST(QosArbiterTest, ClassOfThePriority) {
+  QosArbiter arbiter;
+  EXPECT_EQ(arbiter.classOf(0, 0), 0);
+  EXPECT_EQ(arbiter.classOf(5, 0.1), 1);
+  EXPECT_EQ(arbiter.classOf(0, 0.3), 0);
+  EXPECT_EQ(arbiter.numClasses(), 2);
+  EXPECT_EQ(arbiter.priority(1), 5);
+  EXPECT_DOUBLE_EQ(arbiter.minShare(0), 0.3);
+  EXPECT_DOUBLE_EQ(arbiter.minShare(1), 0.1);
+  EXPECT_THROW(arbiter.classOf(1, 1.5), std::invalid_argument);
+  EXPECT_THROW(arbiter.classOf(1, -0.1), std::invalid_argument);
+}
+
+TEST(QosArbiterTest, HighestPriorityFirst) {
+  QosArbiter arbiter;
+  int bulk = arbiter.classOf(0, 0);
+  int latency_sensitive = arbiter.classOf(10, 0);
+  for (int i = 0; i < 10; i++) EXPECT_EQ(arbiter.choose({bulk, latency_sensitive}), latency_sensitive);
+  EXPECT_EQ(arbiter.choose({bulk}), bulk);
+  EXPECT_EQ(arbiter.numDelivered(bulk), 1);
+  EXPECT_EQ(arbiter.numDelivered(latency_sensitive), 10);
+}
+
+TEST(QosArbiterTest, MinShareOfTheContendedPairs) {
+  QosArbiter arbiter;
+  int bulk = arbiter.classOf(0, 0.25);
+  int latency_sensitive = arbiter.classOf(10, 0);
+  for (int i = 0; i < 100; i++) arbiter.choose({bulk, latency_sensitive});
+  EXPECT_EQ(arbiter.numDelivered(bulk), 25);
+  EXPECT_EQ(arbiter.numDelivered(latency_sensitive), 75);
+
+  // the pairs only the bulk class waits for don't build up its credit
+  for (int i = 0; i < 100; i++) arbiter.choose({bulk});
+  EXPECT_EQ(arbiter.choose({bulk, latency_sensitive}), latency_sensitive);
+}
+
+TEST(QosArbiterTest, TheHighPriorityClassKeepsItsShareToo) {
+  QosArbiter arbiter;
+  int low = arbiter.classOf(0, 0.5);
+  int high = arbiter.classOf(10, 0.5);
+  for (int i = 0; i < 100; i++) arbiter.choose({low, high});
+  EXPECT_EQ(arbiter.numDelivered(low), 50);
+  EXPECT_EQ(arbiter.numDelivered(high), 50);
+}
+
+}  // namespace
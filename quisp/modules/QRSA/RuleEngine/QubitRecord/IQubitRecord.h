@@ -24,6 +24,19 @@ class IQubitRecord {
   virtual int getQubitIndex() const = 0;
   virtual int getQNicIndex() const = 0;
   virtual QNIC_type getQNicType() const = 0;
+  // when the qubit got its current Bell pair, the Runtime selects the qubits by their age with it
+  virtual omnetpp::simtime_t getEntangledTime() const = 0;
+  virtual void setEntangledTime(omnetpp::simtime_t time) = 0;
+  // the Rule action holding the qubit not to be disturbed by the other actions
+  virtual bool isLocked() const = 0;
+  virtual void lock(unsigned long ruleset_id, int rule_id, int action_index) = 0;
+  virtual void unlock() = 0;
+  virtual unsigned long getLockedRuleSetId() const = 0;
+  virtual int getLockedRuleId() const = 0;
+  virtual int getActionIndex() const = 0;
+  // the Pauli correction tracked instead of applied to the qubit, the bits of pauli_frame::X and pauli_frame::Z
+  virtual int getPauliFrame() const = 0;
+  virtual void setPauliFrame(int frame) = 0;
 
   IStationaryQubit* qubit_ptr = nullptr;
 };
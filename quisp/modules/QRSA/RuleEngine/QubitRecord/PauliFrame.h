@@ -0,0 +1,43 @@
+#pragma once
+
+namespace quisp::modules::qubit_record::pauli_frame {
+
+/**
+ * @brief the Pauli correction of a qubit kept as classical bits instead of a gate on the backend.
+ *
+ * The bits are the ones of the swapping corrections: Z at bit 0 and X at bit 1, so Y is both.
+ * The frame stands for the Pauli applied to the qubit before the next operation,
+ * so a measurement flips its outcome and a CNOT moves the frame between the qubits instead.
+ */
+constexpr int I = 0;
+constexpr int Z = 1;
+constexpr int X = 2;
+constexpr int Y = X | Z;
+
+// whether the frame flips the outcome of a measurement in the basis 'X', 'Y' or 'Z': the Paulis anticommuting with the basis do
+inline bool flipsMeasurement(int frame, char basis) {
+  switch (basis) {
+    case 'X':
+      return frame & Z;
+    case 'Z':
+      return frame & X;
+    case 'Y':
+      return frame == X || frame == Z;
+  }
+  return false;
+}
+
+// the frames after a CNOT, X of the control spreads to the target and Z of the target to the control
+inline void conjugateCNOT(int &control, int &target) {
+  target ^= control & X;
+  control ^= target & Z;
+}
+
+/**
+ * @brief the bits a BELL_MEASURE result flips, the X of the control at bit 0 and the Z of the target at bit 1.
+ * After the CNOT, a Z of either qubit flips the control's outcome and an X of either flips the target's,
+ * which are the bits of the frames themselves.
+ */
+inline int bellMeasureFlips(int control, int target) { return control ^ target; }
+
+}  // namespace quisp::modules::qubit_record::pauli_frame
@@ -0,0 +1,45 @@
+#include "PauliFrame.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+using namespace quisp::modules::qubit_record::pauli_frame;
+
+TEST(PauliFrameTest, FlipsTheAnticommutingMeasurements) {
+  EXPECT_FALSE(flipsMeasurement(I, 'X'));
+  EXPECT_TRUE(flipsMeasurement(Z, 'X'));
+  EXPECT_FALSE(flipsMeasurement(X, 'X'));
+  EXPECT_TRUE(flipsMeasurement(Y, 'X'));
+  EXPECT_TRUE(flipsMeasurement(X, 'Z'));
+  EXPECT_FALSE(flipsMeasurement(Z, 'Z'));
+  EXPECT_TRUE(flipsMeasurement(X, 'Y'));
+  EXPECT_TRUE(flipsMeasurement(Z, 'Y'));
+  EXPECT_FALSE(flipsMeasurement(Y, 'Y'));
+}
+
+TEST(PauliFrameTest, ConjugateCNOT) {
+  int control = X, target = I;
+  conjugateCNOT(control, target);
+  EXPECT_EQ(control, X);
+  EXPECT_EQ(target, X);
+
+  control = I, target = Z;
+  conjugateCNOT(control, target);
+  EXPECT_EQ(control, Z);
+  EXPECT_EQ(target, Z);
+
+  control = Y, target = Y;
+  conjugateCNOT(control, target);
+  // X of the control cancels the one of the target, Z of the target cancels the one of the control
+  EXPECT_EQ(control, X);
+  EXPECT_EQ(target, Z);
+}
+
+TEST(PauliFrameTest, BellMeasureFlips) {
+  EXPECT_EQ(bellMeasureFlips(Z, I), 1);
+  EXPECT_EQ(bellMeasureFlips(I, X), 2);
+  EXPECT_EQ(bellMeasureFlips(Y, Z), 2);
+  EXPECT_EQ(bellMeasureFlips(X, X), 0);
+}
+
+}  // namespace
@@ -34,7 +34,34 @@ void QubitRecord::setAllocated(bool _is_allocated) {
 int QubitRecord::getQubitIndex() const { return qubit_index; }
 int QubitRecord::getQNicIndex() const { return qnic_index; }
 QNIC_type QubitRecord::getQNicType() const { return qnic_type; }
+omnetpp::simtime_t QubitRecord::getEntangledTime() const { return entangled_time; }
+void QubitRecord::setEntangledTime(omnetpp::simtime_t time) { entangled_time = time; }
 
-void QubitRecord::logState() { logger->logQubitState(qnic_type, qnic_index, qubit_index, is_busy, is_allocated); }
+bool QubitRecord::isLocked() const { return is_locked; }
+
+void QubitRecord::lock(unsigned long ruleset_id, int rule_id, int action_index) {
+  if (ruleset_id == (unsigned long)-1 || rule_id == -1 || action_index == -1) {
+    throw omnetpp::cRuntimeError("QubitRecord::lock: ruleset_id, rule_id or action_index is -1. Qubit(%s, %d, %d)", QNIC_names[qnic_type], qnic_index, qubit_index);
+  }
+  is_locked = true;
+  locked_ruleset_id = ruleset_id;
+  locked_rule_id = rule_id;
+  this->action_index = action_index;
+}
+
+void QubitRecord::unlock() {
+  is_locked = false;
+  locked_ruleset_id = -1;
+  locked_rule_id = -1;
+  action_index = -1;
+}
+
+unsigned long QubitRecord::getLockedRuleSetId() const { return locked_ruleset_id; }
+int QubitRecord::getLockedRuleId() const { return locked_rule_id; }
+int QubitRecord::getActionIndex() const { return action_index; }
+int QubitRecord::getPauliFrame() const { return pauli_frame; }
+void QubitRecord::setPauliFrame(int frame) { pauli_frame = frame; }
+
+void QubitRecord::logState() { QUISP_LOG(logger, QubitState, logQubitState(qnic_type, qnic_index, qubit_index, is_busy, is_allocated)); }
 
 }  // namespace quisp::modules::qubit_record
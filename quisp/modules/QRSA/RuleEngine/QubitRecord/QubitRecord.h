@@ -18,6 +18,16 @@ class QubitRecord : public IQubitRecord {
   int getQubitIndex() const override;
   int getQNicIndex() const override;
   QNIC_type getQNicType() const override;
+  omnetpp::simtime_t getEntangledTime() const override;
+  void setEntangledTime(omnetpp::simtime_t time) override;
+  bool isLocked() const override;
+  void lock(unsigned long ruleset_id, int rule_id, int action_index) override;
+  void unlock() override;
+  unsigned long getLockedRuleSetId() const override;
+  int getLockedRuleId() const override;
+  int getActionIndex() const override;
+  int getPauliFrame() const override;
+  void setPauliFrame(int frame) override;
 
  protected:
   QNIC_type qnic_type;
@@ -25,6 +35,12 @@ class QubitRecord : public IQubitRecord {
   int qubit_index;
   bool is_busy = false;
   bool is_allocated = false;
+  omnetpp::simtime_t entangled_time = SIMTIME_ZERO;
+  bool is_locked = false;
+  unsigned long locked_ruleset_id = -1;
+  int locked_rule_id = -1;
+  int action_index = -1;
+  int pauli_frame = 0;
   Logger::ILogger* logger = nullptr;
 
   inline void logState();
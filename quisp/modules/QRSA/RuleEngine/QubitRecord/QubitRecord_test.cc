@@ -65,4 +65,19 @@ TEST_F(QubitRecordTest, SetAllocated) {
   EXPECT_THROW(record.setAllocated(true), omnetpp::cRuntimeError);
 }
 
+TEST_F(QubitRecordTest, Lock) {
+  EXPECT_FALSE(record.isLocked());
+  record.lock(2, 3, 4);
+  EXPECT_TRUE(record.isLocked());
+  EXPECT_EQ(record.getLockedRuleSetId(), 2);
+  EXPECT_EQ(record.getLockedRuleId(), 3);
+  EXPECT_EQ(record.getActionIndex(), 4);
+  record.unlock();
+  EXPECT_FALSE(record.isLocked());
+  EXPECT_EQ(record.getLockedRuleSetId(), (unsigned long)-1);
+  EXPECT_EQ(record.getLockedRuleId(), -1);
+  EXPECT_EQ(record.getActionIndex(), -1);
+  EXPECT_THROW(record.lock(2, -1, 4), omnetpp::cRuntimeError);
+}
+
 }  // namespace
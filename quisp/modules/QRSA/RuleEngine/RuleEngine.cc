@@ -4,42 +4,65 @@
  */
 #include "RuleEngine.h"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cmath>
 #include <fstream>
 #include <iostream>
 #include <iterator>
+#include <limits>
 #include <memory>
 #include <ostream>
 #include <stdexcept>
+#include <string>
+#include <typeinfo>
 #include <utility>
+#include <vector>
 
 #include "QNicStore/QNicStore.h"
+#include "QubitRecord/PauliFrame.h"
 #include "RuntimeCallback.h"
+#include "channels/QuantumChannel.h"
+#include "modules/PhysicalConnection/BSA/BellStateAnalyzer.h"
 #include "messages/BSA_ipc_messages_m.h"
 #include "messages/QNode_ipc_messages_m.h"
 #include "messages/link_generation_messages_m.h"
 #include "modules/PhysicalConnection/BSA/types.h"
 #include "modules/QNIC.h"
+#include "modules/QNIC/PhotonicSwitch/PhotonicSwitch.h"
 #include "omnetpp/csimulation.h"
 #include "omnetpp/errmsg.h"
 #include "omnetpp/simtime_t.h"
+#include "utils/MemoryUsage.h"
 
 namespace quisp::modules {
 
 using namespace rules;
 using namespace messages;
 using qnic_store::QNicStore;
+namespace pauli_frame = qubit_record::pauli_frame;
 using runtime_callback::RuntimeCallback;
 
-RuleEngine::RuleEngine() : provider(utils::ComponentProvider{this}), runtimes(std::make_unique<RuntimeCallback>(this)) {}
+RuleEngine::RuleEngine() : provider(utils::ComponentProvider{this}), runtimes(std::make_unique<RuntimeCallback>(this)) { registerMessageHandlers(); }
 
 RuleEngine::~RuleEngine() {
   for (int i = 0; i < number_of_qnics; i++) cancelAndDelete(emit_photon_timer_map[{QNIC_type::QNIC_E, i}]);
   for (int i = 0; i < number_of_qnics_r; i++) cancelAndDelete(emit_photon_timer_map[{QNIC_type::QNIC_R, i}]);
   for (int i = 0; i < number_of_qnics_rp; i++) cancelAndDelete(emit_photon_timer_map[{QNIC_type::QNIC_RP, i}]);
+  cancelAndDelete(runtime_continuation_timer);
+  cancelAndDelete(coalesced_pass_timer);
+  cancelAndDelete(link_trace_replay_timer);
+  cancelAndDelete(warm_start_timer);
+  cancelAndDelete(occupancy_report_timer);
+  for (auto *batch : pending_swapping_results) delete batch;
 }
 
 void RuleEngine::initialize() {
+  event_profiler = provider.getEventProfiler();
+  if (auto *memory_accounting = provider.getMemoryAccounting()) {
+    memory_accounting->addReporter([this](modules::SharedResource::MemoryAccounting::Usage &usage) { reportMemoryUsage(usage); });
+  }
   // HardwareMonitor's neighbor table is checked in the initialization stage of the simulation
   // This assumes the topology never changes throughout the simulation.
   // If dynamic change in topology is required, recoding this is needed.
@@ -54,6 +77,112 @@ void RuleEngine::initialize() {
   number_of_qnics = par("number_of_qnics");
   number_of_qnics_r = par("number_of_qnics_r");
   number_of_qnics_rp = par("number_of_qnics_rp");
+  ruleset_qubit_quota = par("ruleset_qubit_quota");
+  qos_allocation = par("qos_allocation");
+  fast_link_layer = par("fast_link_layer");
+  photon_train_messages = par("photon_train_messages");
+  if (fast_link_layer && photon_train_messages) error("fast_link_layer and photon_train_messages can't be used together");
+  demand_driven_emission = par("demand_driven_emission");
+  temporal_modes = par("temporal_modes");
+  if (temporal_modes < 1) error("temporal_modes must be positive");
+  batch_swapping_results = par("batch_swapping_results");
+  msm_result_window = par("msm_result_window");
+  pauli_frame_tracking = par("pauli_frame_tracking");
+  bell_pair_cutoff_time = par("bell_pair_cutoff_time");
+  cutoff_timer_resolution = par("cutoff_timer_resolution");
+  if (bell_pair_cutoff_time < SIMTIME_ZERO) error("bell_pair_cutoff_time must not be negative");
+  if (bell_pair_cutoff_time > SIMTIME_ZERO) {
+    if (cutoff_timer_resolution <= SIMTIME_ZERO) error("cutoff_timer_resolution must be positive");
+    cutoff_timers = std::make_unique<utils::TimerService<IQubitRecord *>>(this, "BellPairCutoffTimer", cutoff_timer_resolution);
+  }
+  if (!par("pool_messages").boolValue()) {
+    purification_result_pool.setCapacity(0);
+    swapping_result_pool.setCapacity(0);
+    msm_result_pool.setCapacity(0);
+    msm_result_batch_pool.setCapacity(0);
+    swapping_result_batch_pool.setCapacity(0);
+  }
+  connection_pair_delivered_signal = registerSignal(SharedResource::CONNECTION_PAIR_DELIVERED_SIGNAL);
+  connection_terminated_signal = registerSignal(SharedResource::CONNECTION_TERMINATED_SIGNAL);
+  auto qubit_selection_policy = std::string(par("qubit_selection_policy").stringValue());
+  if (qubit_selection_policy == "oldest_first") {
+    runtimes.setQubitSelectionPolicy(runtime::QubitSelectionPolicy::OLDEST_FIRST);
+  } else if (qubit_selection_policy == "freshest_first") {
+    runtimes.setQubitSelectionPolicy(runtime::QubitSelectionPolicy::FRESHEST_FIRST);
+  } else if (qubit_selection_policy != "assigned_order") {
+    error("unknown qubit_selection_policy: %s", qubit_selection_policy.c_str());
+  }
+  int ruleset_action_budget = par("ruleset_action_budget");
+  if (ruleset_action_budget < 0) error("ruleset_action_budget must not be negative");
+  if (ruleset_action_budget > 0) {
+    runtimes.setActionBudget(ruleset_action_budget);
+    runtime_continuation_timer = new cMessage("RuntimeContinuationTimer");
+  }
+  coalesce_events = par("coalesce_events");
+  if (coalesce_events) {
+    coalesced_pass_timer = new cMessage("CoalescedPassTimer");
+    // after all the other events of the time, whatever their priority
+    coalesced_pass_timer->setSchedulingPriority(std::numeric_limits<short>::max());
+  }
+  auto link_trace_record_filename = std::string(par("link_trace_record_filename").stringValue());
+  auto link_trace_replay_filename = std::string(par("link_trace_replay_filename").stringValue());
+  if (!link_trace_record_filename.empty() && !link_trace_replay_filename.empty()) error("link_trace_record_filename and link_trace_replay_filename can't be used together");
+  if (!link_trace_record_filename.empty()) link_trace_writer = std::make_unique<link_trace::LinkTraceWriter>(link_trace_record_filename);
+  if (!link_trace_replay_filename.empty()) {
+    replays_link_trace = true;
+    try {
+      link_trace_records = link_trace::readLinkTrace(link_trace_replay_filename, parentAddress);
+    } catch (const std::runtime_error &e) {
+      error("%s", e.what());
+    }
+    link_trace_replay_timer = new cMessage("LinkTraceReplayTimer");
+    if (!link_trace_records.empty()) scheduleAt(SimTime(link_trace_records.front().time), link_trace_replay_timer);
+  }
+  warm_start = par("warm_start").boolValue();
+  warm_start_fidelity = par("warm_start_fidelity").doubleValue();
+  if (warm_start_fidelity < 0 || warm_start_fidelity > 1) error("warm_start_fidelity must be in [0, 1]");
+  if (warm_start) {
+    // after the initialization of all the nodes, as both halves of a pair are made at once
+    warm_start_timer = new cMessage("WarmStartTimer");
+    scheduleAt(simTime(), warm_start_timer);
+  }
+  auto memory_resource = std::string(par("memory_resource").stringValue());
+  auto memory_resource_strategy = utils::memoryResourceStrategyByName(memory_resource);
+  if (!memory_resource_strategy) error("unknown memory_resource: %s", memory_resource.c_str());
+  if (*memory_resource_strategy != utils::MemoryResourceStrategy::Global) {
+    runtimes.setMemoryResourceStrategy(*memory_resource_strategy);
+    bell_pair_store.setMemoryResourceStrategy(*memory_resource_strategy);
+  }
+  record_summaries = par("record_summaries").boolValue();
+  occupancy_report_interval = par("occupancy_report_interval");
+  if (occupancy_report_interval < SIMTIME_ZERO) error("occupancy_report_interval must not be negative");
+  if (occupancy_report_interval > SIMTIME_ZERO) {
+    occupancy_report_timer = new cMessage("OccupancyReportTimer");
+    scheduleAt(simTime() + occupancy_report_interval, occupancy_report_timer);
+  }
+  if (par("profile_runtime").boolValue()) {
+    runtimes.enableProfiling(par("runtime_profile_sample_interval").intValue());
+  }
+  auto runtime_trace = std::string(par("runtime_trace").stringValue());
+  if (!runtime_trace.empty()) {
+    runtime::TraceFilter trace_filter;
+    try {
+      trace_filter = runtime::TraceFilter::parse(par("runtime_trace_filter").stringValue());
+    } catch (const std::invalid_argument &e) {
+      error("%s", e.what());
+    }
+    std::unique_ptr<runtime::ITraceSink> trace_sink;
+    if (runtime_trace == "ring") {
+      int capacity = par("runtime_trace_capacity");
+      if (capacity <= 0) error("runtime_trace_capacity must be positive");
+      trace_sink = std::make_unique<runtime::RingBufferTraceSink>(capacity);
+    } else if (runtime_trace == "stdout") {
+      trace_sink = std::make_unique<runtime::StreamTraceSink>(std::cout);
+    } else {
+      error("unknown runtime_trace: %s", runtime_trace.c_str());
+    }
+    runtimes.enableTracing(std::make_unique<runtime::RuntimeTrace>(std::move(trace_sink), std::move(trace_filter)));
+  }
   if (qnic_store == nullptr) {
     qnic_store = std::make_unique<QNicStore>(provider, number_of_qnics, number_of_qnics_r, number_of_qnics_rp, logger);
   }
@@ -74,115 +203,267 @@ void RuleEngine::initialize() {
   }
 }
 
-void RuleEngine::handleMessage(cMessage *msg) {
-  executeAllRuleSets();  // New resource added to QNIC with qnic_type qnic_index.
-
-  if (auto *notification_packet = dynamic_cast<BSMTimingNotification *>(msg)) {
-    if (auto *bsa_results = dynamic_cast<CombinedBSAresults *>(msg)) {
-      handleLinkGenerationResult(bsa_results);
+void RuleEngine::finish() {
+  auto record_pool = [this](const char *type, long num_allocated, long num_reused) {
+    recordScalar((std::string("message_pool_allocations:") + type).c_str(), num_allocated);
+    recordScalar((std::string("message_pool_reuses:") + type).c_str(), num_reused);
+  };
+  record_pool("PurificationResult", purification_result_pool.numAllocated(), purification_result_pool.numReused());
+  record_pool("SwappingResult", swapping_result_pool.numAllocated(), swapping_result_pool.numReused());
+  record_pool("MSMResult", msm_result_pool.numAllocated(), msm_result_pool.numReused());
+  record_pool("MSMResultBatch", msm_result_batch_pool.numAllocated(), msm_result_batch_pool.numReused());
+  if (batch_swapping_results) record_pool("SwappingResultBatch", swapping_result_batch_pool.numAllocated(), swapping_result_batch_pool.numReused());
+  if (bell_pair_cutoff_time > SIMTIME_ZERO) recordScalar("discarded_bell_pairs", num_discarded_bell_pairs);
+  recordScalar("reclaimed_qubits", runtimes.numReclaimedQubits());
+  if (demand_driven_emission) recordScalar("idle_emission_rounds", num_idle_emission_rounds);
+  if (coalesce_events) recordScalar("coalesced_events", num_coalesced_events);
+  for (int class_index = 0; class_index < (int)qos_classes.numClasses(); class_index++) {
+    auto name = "qos_priority_" + std::to_string(qos_classes.priority(class_index));
+    auto delivered = qos_classes.numDelivered(class_index);
+    recordScalar((name + "_delivered_pairs").c_str(), delivered);
+    if (simTime() > SIMTIME_ZERO) recordScalar((name + "_delivered_rate").c_str(), delivered / simTime().dbl());
+  }
+  if (link_trace_writer != nullptr) {
+    try {
+      link_trace_writer->flush();
+    } catch (const std::runtime_error &e) {
+      error("%s", e.what());
     }
-    auto type = notification_packet->getQnicType();
-    auto qnic_index = notification_packet->getQnicIndex();
-    stopOnGoingPhotonEmission(type, qnic_index);
-    freeFailedEntanglementAttemptQubits(type, qnic_index);
-    schedulePhotonEmission(type, qnic_index, notification_packet);
-  } else if (auto *pk = dynamic_cast<EmitPhotonRequest *>(msg)) {
-    auto type = pk->getQnicType();
-    auto qnic_index = pk->getQnicIndex();
-    auto number_of_free_emitters = qnic_store->countNumFreeQubits(type, qnic_index);
-    auto qubit_index = qnic_store->takeFreeQubitIndex(type, qnic_index);
-    // If this is MSM, we keep on emmiting photons continuously
-    if (pk->isMSM()) {
-      auto &msm_info = msm_info_map[qnic_index];
-      msm_info.photon_index_counter++;
-      if (number_of_free_emitters != 0) {
-        msm_info.qubit_info_map[msm_info.iteration_index] = qubit_index;
-        sendEmitPhotonSignalToQnic(type, qnic_index, qubit_index, true, true);
-      } else {
-        // send MSMResult to partner node, even if we fail to have BSM happen
-        MSMResult *msm_result = new MSMResult();
-        msm_result->setQnicIndex(msm_info.partner_qnic_index);
-        msm_result->setQnicType(QNIC_RP);
-        msm_result->setPhotonIndex(msm_info.photon_index_counter);
-        msm_result->setSuccess(false);
-        msm_result->setCorrectionOperation(PauliOperator ::I);
-        msm_result->setSrcAddr(parentAddress);
-        msm_result->setDestAddr(msm_info.partner_address);
-        msm_result->setKind(6);
-        send(msm_result, "RouterPort$o");
-      }
-      scheduleAt(simTime() + pk->getIntervalBetweenPhotons(), pk);
-      return;
-      // If not, we emit photons on demand
-    } else {
-      if (number_of_free_emitters == 0) return;
-      auto is_first = pk->isFirst();
-      auto is_last = (number_of_free_emitters == 1);
-      // need to set is_first to false
-      pk->setFirst(false);
-      sendEmitPhotonSignalToQnic(type, qnic_index, qubit_index, is_first, is_last);
-      if (!is_last) {
-        scheduleAt(simTime() + pk->getIntervalBetweenPhotons(), pk);
+    recordScalar("recorded_bell_pairs", link_trace_writer->numRecords());
+  }
+  if (replays_link_trace) {
+    recordScalar("replayed_bell_pairs", num_replayed_bell_pairs);
+    recordScalar("missed_replayed_bell_pairs", num_missed_replayed_bell_pairs);
+  }
+  if (warm_start) recordScalar("warm_start_bell_pairs", num_warm_start_bell_pairs);
+  if (record_summaries) {
+    resource_wait_time_histogram.forEachSummary(
+        [this](const std::string &suffix, double value) { recordScalar(("bell_pair_wait_time" + suffix).c_str(), value, suffix == ":count" ? nullptr : "s"); });
+    double now = simTime().dbl();
+    forEachQNic([&](QNIC_type type, int qnic_index, const std::string &label) {
+      if (auto *qnic = qnic_store->getQNicRecord(type, qnic_index)) {
+        auto &occupancy = qnic->getOccupancy();
+        recordScalar((label + " busy_qubits:timeavg").c_str(), occupancy.busy_qubits.average(now));
+        recordScalar((label + " busy_qubits:max").c_str(), occupancy.busy_qubits.max());
+        recordScalar((label + " allocated_qubits:timeavg").c_str(), occupancy.allocated_qubits.average(now));
+        recordScalar((label + " free_qubits:timeavg").c_str(), occupancy.num_qubits - occupancy.busy_qubits.average(now));
       }
-      // early return since this doesn't affect entangled resource
-      // and we don't want to delete these messages
-      return;
+      bell_pair_store.consumptionAges(type, qnic_index).forEachSummary([&](const std::string &suffix, double value) {
+        recordScalar((label + " bell_pair_consumption_age" + suffix).c_str(), value, suffix == ":count" ? nullptr : "s");
+      });
+    });
+  }
+
+  auto *trace = runtimes.getTrace();
+  if (auto *ring = trace != nullptr ? dynamic_cast<runtime::RingBufferTraceSink *>(trace->getSink()) : nullptr) {
+    recordScalar("runtime_trace_events", ring->numWritten());
+    auto trace_filename = std::string(par("runtime_trace_filename").stringValue());
+    if (!trace_filename.empty()) {
+      // all the RuleEngines append to the same file, each trace starts with its header
+      std::ofstream trace_file(trace_filename, std::ios_base::app | std::ios_base::binary);
+      ring->writeBinary(trace_file, *trace, parentAddress);
     }
-    // store message from epps to rule engine
-  } else if (auto *notification_packet = dynamic_cast<EPPSTimingNotification *>(msg)) {
-    auto partner_address = notification_packet->getOtherQnicParentAddr();
-    auto partner_qnic_index = notification_packet->getOtherQnicIndex();
-    auto epps_address = notification_packet->getEPPSAddr();
-    auto qnic_index = notification_packet->getQnicIndex();
-    auto &msm_info = msm_info_map[qnic_index];
-    msm_info.partner_address = partner_address;
-    msm_info.epps_address = epps_address;
-    msm_info.partner_qnic_index = partner_qnic_index;
-    msm_info.total_travel_time = notification_packet->getTotalTravelTime();
-    stopOnGoingPhotonEmission(QNIC_RP, qnic_index);
-    scheduleMSMPhotonEmission(QNIC_RP, qnic_index, notification_packet);
-    // handle result incoming from bsa
-  } else if (auto *click_result = dynamic_cast<SingleClickResult *>(msg)) {
+  }
+
+  auto *profile = runtimes.getProfile();
+  if (profile == nullptr) return;
+  profile->forEachCounter([this](const std::string &name, double value) { recordScalar(name.c_str(), value); });
+  message_dispatcher.forEachCount([this](const std::type_info &type, uint64_t count) { recordScalar((std::string("handled_messages:") + opp_typename(type)).c_str(), count); });
+  recordScalar("handled_messages:unhandled", message_dispatcher.unhandledCount());
+  auto filename = std::string(par("runtime_profile_filename").stringValue());
+  if (!filename.empty()) {
+    // all the RuleEngines append to the same file, one json object per line
+    std::ofstream profile_file(filename, std::ios_base::app);
+    auto json = profile->toJson();
+    json["node_address"] = parentAddress;
+    profile_file << json.dump() << "\n";
+  }
+}
+
+void RuleEngine::registerMessageHandlers() {
+  // CombinedBSAresults is a BSMTimingNotification, so it must be registered first.
+  message_dispatcher.on<CombinedBSAresults>([this](CombinedBSAresults *bsa_results) {
+    handleLinkGenerationResult(bsa_results);
+    handleBSMTimingNotification(bsa_results);
+    return true;
+  });
+  message_dispatcher.on<BSMTimingNotification>([this](BSMTimingNotification *notification) {
+    handleBSMTimingNotification(notification);
+    return true;
+  });
+  // the timers are rescheduled, so they don't affect the entangled resources and must not be deleted.
+  message_dispatcher.on<EmitPhotonRequest>([this](EmitPhotonRequest *pk) {
+    handleEmitPhotonRequest(pk);
+    return false;
+  });
+  // store message from epps to rule engine
+  message_dispatcher.on<EPPSTimingNotification>([this](EPPSTimingNotification *notification) {
+    handleEPPSTimingNotification(notification);
+    return true;
+  });
+  // handle result incoming from bsa
+  message_dispatcher.on<SingleClickResult>([this](SingleClickResult *click_result) {
     handleSingleClickResult(click_result);
-    // handle result incoming from partner node
-  } else if (auto *msm_result = dynamic_cast<MSMResult *>(msg)) {
+    return true;
+  });
+  // handle result incoming from partner node
+  message_dispatcher.on<MSMResult>([this](MSMResult *msm_result) {
     handleMSMResult(msm_result);
-  } else if (auto *pk = dynamic_cast<LinkTomographyRuleSet *>(msg)) {
+    return true;
+  });
+  message_dispatcher.on<MSMResultBatch>([this](MSMResultBatch *batch) {
+    handleMSMResultBatch(batch);
+    return true;
+  });
+  message_dispatcher.on<LinkTomographyRuleSet>([this](LinkTomographyRuleSet *pk) {
     auto *ruleset = pk->getRuleSet();
     runtimes.acceptRuleSet(ruleset->construct());
-  } else if (auto *pkt = dynamic_cast<PurificationResult *>(msg)) {
+    return true;
+  });
+  message_dispatcher.on<PurificationResult>([this](PurificationResult *pkt) {
     handlePurificationResult(pkt);
-  } else if (auto *pkt = dynamic_cast<SwappingResult *>(msg)) {
+    return true;
+  });
+  message_dispatcher.on<SwappingResult>([this](SwappingResult *pkt) {
     handleSwappingResult(pkt);
-    // handle self message to check whether partner's result has arrived
-  } else if (auto *pkt = dynamic_cast<InternalRuleSetForwarding *>(msg)) {
-    // add actual process
-    auto serialized_ruleset = pkt->getRuleSet();
-    RuleSet ruleset(0, 0);
-    ruleset.deserialize_json(serialized_ruleset);
-    runtimes.acceptRuleSet(ruleset.construct());
-  } else if (auto *pkt = dynamic_cast<InternalRuleSetForwarding_Application *>(msg)) {
+    return true;
+  });
+  message_dispatcher.on<SwappingResultBatch>([this](SwappingResultBatch *batch) {
+    handleSwappingResultBatch(batch);
+    return true;
+  });
+  message_dispatcher.on<InternalRuleSetForwarding>([this](InternalRuleSetForwarding *pkt) {
+    acceptForwardedRuleSet(pkt->getRuntimeRuleSet(), pkt->getRuleSet());
+    return true;
+  });
+  message_dispatcher.on<InternalRuleSetForwarding_Application>([this](InternalRuleSetForwarding_Application *pkt) {
     if (pkt->getApplication_type() != 0) error("This application is not recognized yet");
-    auto serialized_ruleset = pkt->getRuleSet();
-    RuleSet ruleset(0, 0);
-    ruleset.deserialize_json(serialized_ruleset);
-    runtimes.acceptRuleSet(ruleset.construct());
-  } else if (auto *pkt = dynamic_cast<InternalRuleSetForwarding *>(msg)) {
-    // add actual process
-    auto serialized_ruleset = pkt->getRuleSet();
-    RuleSet ruleset(0, 0);
-    ruleset.deserialize_json(serialized_ruleset);
-    runtimes.acceptRuleSet(ruleset.construct());
-  } else if (auto *pkt = dynamic_cast<InternalRuleSetForwarding_Application *>(msg)) {
-    if (pkt->getApplication_type() != 0) error("This application is not recognized yet");
-    auto serialized_ruleset = pkt->getRuleSet();
-    RuleSet ruleset(0, 0);
-    ruleset.deserialize_json(serialized_ruleset);
-    runtimes.acceptRuleSet(ruleset.construct());
-  } else if (auto *pkt = dynamic_cast<StopEmitting *>(msg)) {
+    acceptForwardedRuleSet(pkt->getRuntimeRuleSet(), pkt->getRuleSet(), pkt->getPersistent());
+    return true;
+  });
+  message_dispatcher.on<InternalRuleSetTermination>([this](InternalRuleSetTermination *pkt) {
+    if (auto *runtime = runtimes.findById(pkt->getRuleSet_id())) runtime->terminate();
+    return true;
+  });
+  message_dispatcher.on<ConnectionRearm>([this](ConnectionRearm *pkt) {
+    handleConnectionRearm(pkt);
+    return true;
+  });
+  message_dispatcher.on<StopEmitting>([this](StopEmitting *pkt) {
     handleStopEmitting(pkt);
+    return true;
+  });
+  message_dispatcher.on<QuantumLinkDown>([this](QuantumLinkDown *pkt) {
+    handleQuantumLinkDown(pkt);
+    return true;
+  });
+  message_dispatcher.on<BellPairDiscarded>([this](BellPairDiscarded *pkt) {
+    handleBellPairDiscarded(pkt);
+    return true;
+  });
+  // the other messages are just deleted
+  message_dispatcher.otherwise([](cMessage *) { return true; });
+}
+
+void RuleEngine::handleMessage(cMessage *msg) {
+  modules::SharedResource::EventProfiler::Scope profile(event_profiler, this, msg);
+  if (coalesce_events) return handleCoalescedMessage(msg);
+  executeAllRuleSets();  // New resource added to QNIC with qnic_type qnic_index.
+
+  // the message of the cutoff timers is rescheduled, so it must not be deleted
+  if (cutoff_timers != nullptr && cutoff_timers->isTimer(msg)) {
+    cutoff_timers->handle([&](IQubitRecord *qubit_record) {
+      cutoff_timer_handles.erase(qubit_record);
+      discardExpiredBellPair(qubit_record);
+    });
+    return;
+  }
+  // the RuleSets that yielded have just gone on above
+  if (msg == runtime_continuation_timer) return;
+  if (msg == occupancy_report_timer) return reportOccupancy();
+  if (msg == link_trace_replay_timer) {
+    replayLinkTrace();
+    allocateAllResources();
+    executeAllRuleSets();
+    return;
+  }
+  if (msg == warm_start_timer) {
+    warmStart();
+    allocateAllResources();
+    executeAllRuleSets();
+    return;
+  }
+  if (!message_dispatcher.dispatch(msg)) return;
+
+  allocateAllResources();
+  executeAllRuleSets();
+  releaseMessage(msg);
+}
+
+void RuleEngine::handleCoalescedMessage(cMessage *msg) {
+  if (msg == coalesced_pass_timer) {
+    allocateAllResources();
+    executeAllRuleSets();
+    return;
+  }
+  // the messages of the time are handled in the order of the event queue, by priority and then by insertion,
+  // so the pass after them sees the same state in every run
+  if (coalesced_pass_timer->isScheduled()) {
+    num_coalesced_events++;
+  } else {
+    scheduleAt(simTime(), coalesced_pass_timer);
+  }
+  if (cutoff_timers != nullptr && cutoff_timers->isTimer(msg)) {
+    cutoff_timers->handle([&](IQubitRecord *qubit_record) {
+      cutoff_timer_handles.erase(qubit_record);
+      discardExpiredBellPair(qubit_record);
+    });
+    return;
+  }
+  // the RuleSets that yielded go on in the pass
+  if (msg == runtime_continuation_timer) return;
+  if (msg == occupancy_report_timer) return reportOccupancy();
+  if (msg == link_trace_replay_timer) {
+    replayLinkTrace();
+    return;
+  }
+  if (msg == warm_start_timer) {
+    warmStart();
+    return;
   }
+  if (!message_dispatcher.dispatch(msg)) return;
+  releaseMessage(msg);
+}
+
+void RuleEngine::forEachQNic(const std::function<void(QNIC_type, int, const std::string &)> &f) const {
+  std::array<std::pair<QNIC_type, int>, 3> qnics = {{{QNIC_E, number_of_qnics}, {QNIC_R, number_of_qnics_r}, {QNIC_RP, number_of_qnics_rp}}};
+  for (auto [type, num_qnics] : qnics) {
+    for (int i = 0; i < num_qnics; i++) f(type, i, std::string(QNIC_names[type]) + "[" + std::to_string(i) + "]");
+  }
+}
 
+void RuleEngine::reportOccupancy() {
+  double now = simTime().dbl();
+  auto record = [&](const std::string &name, double value) {
+    auto &vector = occupancy_vectors[name];
+    if (vector == nullptr) vector = std::make_unique<cOutVector>(name.c_str());
+    vector->record(value);
+  };
+  forEachQNic([&](QNIC_type type, int qnic_index, const std::string &label) {
+    if (auto *qnic = qnic_store->getQNicRecord(type, qnic_index)) {
+      auto occupancy = qnic->takeIntervalOccupancy();
+      record(label + " busy_qubits", occupancy.busy_qubits.average(now));
+      record(label + " allocated_qubits", occupancy.allocated_qubits.average(now));
+    }
+    auto ages = bell_pair_store.takeIntervalConsumptionAges(type, qnic_index);
+    if (ages.count() == 0) return;
+    record(label + " bell_pair_consumption_age:mean", ages.mean());
+    record(label + " bell_pair_consumption_age:p99", ages.quantile(0.99));
+  });
+  scheduleAt(simTime() + occupancy_report_interval, occupancy_report_timer);
+}
+
+void RuleEngine::allocateAllResources() {
   for (int i = 0; i < number_of_qnics; i++) {
     ResourceAllocation(QNIC_E, i);
   }
@@ -192,11 +473,150 @@ void RuleEngine::handleMessage(cMessage *msg) {
   for (int i = 0; i < number_of_qnics_rp; i++) {
     ResourceAllocation(QNIC_RP, i);
   }
+}
 
-  executeAllRuleSets();
+void RuleEngine::reportMemoryUsage(modules::SharedResource::MemoryAccounting::Usage &usage) const {
+  usage["runtimes"] += {runtimes.size(), runtimes.allocatedBytes()};
+  usage["bell pair store"] += {bell_pair_store.size(), bell_pair_store.allocatedBytes()};
+  modules::SharedResource::MemoryAccounting::Footprint msm;
+  msm.bytes = utils::heapBytesOf(msm_info_map);
+  for (auto &[qnic_index, info] : msm_info_map) {
+    msm.objects += info.qubit_postprocess_info.size();
+    msm.bytes += info.qubit_postprocess_info.allocatedBytes();
+  }
+  usage["msm"] += msm;
+  usage["bell pair cutoff"] += {cutoff_timer_handles.size(), utils::heapBytesOf(cutoff_timer_handles)};
+}
+
+void RuleEngine::releaseMessage(cMessage *msg) {
+  const auto &type = typeid(*msg);
+  if (type == typeid(PurificationResult)) return purification_result_pool.release(static_cast<PurificationResult *>(msg));
+  if (type == typeid(SwappingResult)) return swapping_result_pool.release(static_cast<SwappingResult *>(msg));
+  if (type == typeid(MSMResult)) return msm_result_pool.release(static_cast<MSMResult *>(msg));
+  if (type == typeid(MSMResultBatch)) return msm_result_batch_pool.release(static_cast<MSMResultBatch *>(msg));
+  if (type == typeid(SwappingResultBatch)) return swapping_result_batch_pool.release(static_cast<SwappingResultBatch *>(msg));
   delete msg;
 }
 
+void RuleEngine::handleBSMTimingNotification(BSMTimingNotification *notification) {
+  // the link trace takes the place of the photons
+  if (replays_link_trace) return;
+  auto type = notification->getQnicType();
+  auto qnic_index = notification->getQnicIndex();
+  stopOnGoingPhotonEmission(type, qnic_index);
+  freeFailedEntanglementAttemptQubits(type, qnic_index);
+  // the BSA of a free space link sends no next round once its satellite is out of view for good
+  if (notification->getFirstPhotonEmitTime() == SimTime::getMaxTime()) return;
+  // the BSA sends the timing again after its timeout, so the link resumes by itself once a RuleSet needs the neighbor
+  if (isEmissionIdle(type, qnic_index)) {
+    num_idle_emission_rounds++;
+    return;
+  }
+  schedulePhotonEmission(type, qnic_index, notification);
+}
+
+bool RuleEngine::isEmissionIdle(QNIC_type type, int qnic_index) const {
+  if (!demand_driven_emission) return false;
+  auto it = qnic_neighbors.find({type, qnic_index});
+  if (it == qnic_neighbors.end()) return false;
+  auto *partner_runtimes = runtimes.findAllByPartner(runtime::QNodeAddr{it->second});
+  if (partner_runtimes == nullptr) return true;
+  return std::none_of(partner_runtimes->begin(), partner_runtimes->end(), [](const runtime::Runtime *runtime) { return !runtime->terminated; });
+}
+
+void RuleEngine::handleEmitPhotonRequest(EmitPhotonRequest *pk) {
+  auto type = pk->getQnicType();
+  auto qnic_index = pk->getQnicIndex();
+  auto number_of_free_emitters = qnic_store->countNumFreeQubits(type, qnic_index);
+  auto qubit_index = qnic_store->takeFreeQubitIndex(type, qnic_index);
+  // If this is MSM, we keep on emmiting photons continuously
+  if (pk->isMSM()) {
+    auto &msm_info = msm_info_map[qnic_index];
+    msm_info.photon_index_counter++;
+    if (number_of_free_emitters != 0) {
+      msm_info.emitting_qubit_index = qubit_index;
+      sendEmitPhotonSignalToQnic(type, qnic_index, qubit_index, true, true);
+    } else {
+      // send MSMResult to partner node, even if we fail to have BSM happen
+      reportMSMResult(qnic_index, false, PauliOperator::I);
+      if (msm_info.backpressure && !msm_info.memory_exhausted_sent) reportMemoryExhausted(qnic_index);
+    }
+    scheduleAt(simTime() + pk->getIntervalBetweenPhotons(), pk);
+    return;
+  }
+  // If not, we emit photons on demand
+  if (number_of_free_emitters == 0) return;
+  if (fast_link_layer) {
+    // the qubit taken above is the first of the train
+    qnic_store->setQubitBusy(type, qnic_index, qubit_index, false);
+    emitPhotonTrainAtOnce(type, qnic_index, pk);
+    return;
+  }
+  if (photon_train_messages) {
+    sendEmitPhotonTrainSignalToQnic(type, qnic_index, qubit_index, pk->getIntervalBetweenPhotons());
+    return;
+  }
+  auto is_first = pk->isFirst();
+  // need to set is_first to false
+  pk->setFirst(false);
+  if (temporal_modes > 1) {
+    // the qubit taken above holds the first mode of the pulse
+    bool is_last_pulse = sendEmitPhotonPulseSignalToQnic(type, qnic_index, qubit_index, is_first, pk->getIntervalBetweenPhotons());
+    if (!is_last_pulse) scheduleAt(simTime() + pk->getIntervalBetweenPhotons() * temporal_modes, pk);
+    return;
+  }
+  auto is_last = (number_of_free_emitters == 1);
+  sendEmitPhotonSignalToQnic(type, qnic_index, qubit_index, is_first, is_last);
+  if (!is_last) {
+    scheduleAt(simTime() + pk->getIntervalBetweenPhotons(), pk);
+  }
+}
+
+void RuleEngine::handleEPPSTimingNotification(EPPSTimingNotification *notification) {
+  auto partner_address = notification->getOtherQnicParentAddr();
+  auto partner_qnic_index = notification->getOtherQnicIndex();
+  auto epps_address = notification->getEPPSAddr();
+  auto qnic_index = notification->getQnicIndex();
+  // the results of the last round go to the last partner
+  flushMSMResultWindow(qnic_index);
+  auto &msm_info = msm_info_map[qnic_index];
+  msm_info.partner_address = partner_address;
+  msm_info.epps_address = epps_address;
+  msm_info.partner_qnic_index = partner_qnic_index;
+  msm_info.total_travel_time = notification->getTotalTravelTime();
+  msm_info.backpressure = notification->getBackpressure();
+  msm_info.memory_exhausted_sent = false;
+  // the partner's MSMResult of a photon arrives about total_travel_time after the click, and up to a window later
+  if (notification->getInterval() > 0) {
+    msm_info.qubit_postprocess_info.reserve(std::ceil(msm_info.total_travel_time.dbl() / notification->getInterval().dbl()) + 1 + std::max(msm_result_window, 1));
+  }
+  stopOnGoingPhotonEmission(QNIC_RP, qnic_index);
+  scheduleMSMPhotonEmission(QNIC_RP, qnic_index, notification);
+}
+
+void RuleEngine::acceptForwardedRuleSet(const RuntimeRuleSetPtr &compiled_ruleset, const json &serialized_ruleset, bool keep_alive) {
+  auto ruleset = compiled_ruleset;
+  if (ruleset == nullptr) {
+    RuleSet deserialized(0, 0);
+    deserialized.deserialize_json(serialized_ruleset);
+    ruleset = std::make_shared<const runtime::RuleSet>(deserialized.construct());
+  }
+  auto *runtime = runtimes.findById(ruleset->id);
+  if (runtime != nullptr && !runtime->terminated) {
+    runtimes.extendRuleSet(runtime, *ruleset);
+  } else {
+    runtime = runtimes.acceptRuleSet(*ruleset);
+  }
+  runtime->keep_alive = keep_alive;
+}
+
+// the RuleSet may be terminated, e.g. by a link down, then the initiator finds it out from the termination
+void RuleEngine::handleConnectionRearm(ConnectionRearm *rearm) {
+  auto *runtime = runtimes.findById(rearm->getRuleSet_id());
+  if (runtime == nullptr) return;
+  runtime->rearm(rearm->getNum_measure());
+}
+
 void RuleEngine::schedulePhotonEmission(QNIC_type type, int qnic_index, BSMTimingNotification *notification) {
   auto first_photon_emit_time = getEmitTimeFromBSMNotification(notification);
   auto *timer = emit_photon_timer_map[{type, qnic_index}];
@@ -220,102 +640,389 @@ void RuleEngine::sendEmitPhotonSignalToQnic(QNIC_type qnic_type, int qnic_index,
   if (is_first) pulse |= STATIONARYQUBIT_PULSE_BEGIN;
   if (is_last) pulse |= STATIONARYQUBIT_PULSE_END;
   realtime_controller->EmitPhoton(qnic_index, qubit_index, qnic_type, pulse);
-  if (qnic_type != QNIC_RP) emitted_photon_order_map[{qnic_type, qnic_index}].push_back(qubit_index);
+  if (qnic_type != QNIC_RP) emitted_photon_trains[{qnic_type, qnic_index}].emit(qubit_index);
 }
+
+bool RuleEngine::sendEmitPhotonPulseSignalToQnic(QNIC_type qnic_type, int qnic_index, int first_qubit_index, bool is_first, simtime_t interval) {
+  auto &photon_train = emitted_photon_trains[{qnic_type, qnic_index}];
+  std::vector<int> qubit_indices{first_qubit_index};
+  photon_train.emit(first_qubit_index);
+  while ((int)qubit_indices.size() < temporal_modes) {
+    auto qubit_index = qnic_store->takeFreeQubitIndex(qnic_type, qnic_index);
+    if (qubit_index == -1) break;
+    qubit_indices.push_back(qubit_index);
+    photon_train.emit(qubit_index);
+  }
+  bool is_last = qnic_store->countNumFreeQubits(qnic_type, qnic_index) == 0;
+  int pulse = 0;
+  if (is_first) pulse |= STATIONARYQUBIT_PULSE_BEGIN;
+  if (is_last) pulse |= STATIONARYQUBIT_PULSE_END;
+  realtime_controller->EmitPhotonPulse(qnic_index, qubit_indices, qnic_type, interval, pulse);
+  return is_last;
+}
+
+void RuleEngine::sendEmitPhotonTrainSignalToQnic(QNIC_type qnic_type, int qnic_index, int first_qubit_index, simtime_t interval) {
+  auto &photon_train = emitted_photon_trains[{qnic_type, qnic_index}];
+  std::vector<int> qubit_indices;
+  for (int qubit_index = first_qubit_index; qubit_index != -1; qubit_index = qnic_store->takeFreeQubitIndex(qnic_type, qnic_index)) {
+    qubit_indices.push_back(qubit_index);
+    photon_train.emit(qubit_index);
+  }
+  realtime_controller->EmitPhotonTrain(qnic_index, qubit_indices, qnic_type, interval);
+}
+
+void RuleEngine::emitPhotonTrainAtOnce(QNIC_type qnic_type, int qnic_index, EmitPhotonRequest *pk) {
+  auto &photon_train = emitted_photon_trains[{qnic_type, qnic_index}];
+  std::vector<backends::IQubit *> memory_qubits;
+  double emission_success_probability = 1;
+  for (int qubit_index = qnic_store->takeFreeQubitIndex(qnic_type, qnic_index); qubit_index != -1; qubit_index = qnic_store->takeFreeQubitIndex(qnic_type, qnic_index)) {
+    auto *qubit = provider.getStationaryQubit(qnic_index, qubit_index, qnic_type);
+    if (memory_qubits.empty()) emission_success_probability = qubit->emission_success_probability;
+    memory_qubits.push_back(qubit->getBackendQubitRef());
+    photon_train.emit(qubit_index);
+  }
+  if (memory_qubits.empty()) return;
+
+  // the photons of the qubits go through the selected output of the lens (PhotonicSwitch) of the qnic
+  auto *lens = check_and_cast<PhotonicSwitch *>(provider.getQNIC(qnic_index, qnic_type)->getSubmodule("lens"));
+  auto *lens_gate = lens->gate("to_bsa$o", lens->getOutput());
+  auto *channel = dynamic_cast<channels::QuantumChannel *>(lens_gate->findTransmissionChannel());
+  auto *bsa_gate = lens_gate->getPathEndGate();
+  auto *bsa = dynamic_cast<BellStateAnalyzer *>(bsa_gate->getOwnerModule());
+  if (bsa == nullptr) error("fast_link_layer needs a BellStateAnalyzer at the end of the quantum port of qnic %d", qnic_index);
+  // the internal BSA of a qnic_r is connected without a QuantumChannel
+  simtime_t delay = channel == nullptr ? SIMTIME_ZERO : channel->getDelay();
+  // the first photons scatter in the lens while it's reconfigured, as they do in PhotonicSwitch::handleMessage
+  int num_lost_photons = 0;
+  while (num_lost_photons < (int)memory_qubits.size() && lens->isReconfiguring(simTime() + pk->getIntervalBetweenPhotons() * num_lost_photons)) num_lost_photons++;
+  bsa->acceptPhotonTrain(bsa_gate->getIndex(), std::move(memory_qubits), simTime() + delay, pk->getIntervalBetweenPhotons(), emission_success_probability, channel,
+                         num_lost_photons);
+}
+
 simtime_t RuleEngine::getEmitTimeFromBSMNotification(quisp::messages::BSMTimingNotification *notification) { return notification->getFirstPhotonEmitTime(); }
 
 void RuleEngine::stopOnGoingPhotonEmission(QNIC_type type, int qnic_index) { cancelEvent(emit_photon_timer_map[{type, qnic_index}]); }
 
 void RuleEngine::freeFailedEntanglementAttemptQubits(QNIC_type type, int qnic_index) {
-  auto &emitted_indices = emitted_photon_order_map[{type, qnic_index}];
-  for (auto qubit_index : emitted_indices) {
-    realtime_controller->ReInitialize_StationaryQubit(qnic_index, qubit_index, type, false);
+  auto failed_qubit_indices = emitted_photon_trains[{type, qnic_index}].takeFailedQubitIndices();
+  if (failed_qubit_indices.empty()) return;
+  realtime_controller->ReInitialize_StationaryQubits(qnic_index, failed_qubit_indices, type, false);
+  for (auto qubit_index : failed_qubit_indices) {
     qnic_store->setQubitBusy(type, qnic_index, qubit_index, false);
   }
-  emitted_indices.clear();
 }
 
 void RuleEngine::handleSingleClickResult(SingleClickResult *click_result) {
   auto qnic_index = click_result->getQnicIndex();
   auto &msm_info = msm_info_map[qnic_index];
-  auto qubit_index = msm_info.qubit_info_map[msm_info.iteration_index];
-  MSMResult *msm_result = new MSMResult();
+  auto qubit_index = msm_info.emitting_qubit_index;
+  if (click_result->getClickResult().success) {
+    msm_info.qubit_postprocess_info.insert(msm_info.photon_index_counter, QubitInfo{qubit_index, click_result->getClickResult().correction_operation});
+    msm_info.emitting_qubit_index = 0;
+  } else {
+    realtime_controller->ReInitialize_StationaryQubit(qnic_index, qubit_index, QNIC_RP, false);
+    qnic_store->setQubitBusy(QNIC_RP, qnic_index, qubit_index, false);
+  }
+  reportMSMResult(qnic_index, click_result->getClickResult().success, click_result->getClickResult().correction_operation);
+}
+
+void RuleEngine::reportMSMResult(int qnic_index, bool success, PauliOperator correction_operation) {
+  auto &msm_info = msm_info_map[qnic_index];
+  if (msm_result_window > 1) {
+    auto &window = msm_info.result_window;
+    if (window.num_photons == 0) window.first_photon_index = msm_info.photon_index_counter;
+    if (success) window.successes.append(static_cast<int>(msm_info.photon_index_counter - window.first_photon_index), correction_operation);
+    window.num_photons++;
+    if (window.num_photons >= msm_result_window) flushMSMResultWindow(qnic_index);
+    return;
+  }
+  MSMResult *msm_result = msm_result_pool.acquire("MSMResult");
   msm_result->setQnicIndex(msm_info.partner_qnic_index);
   msm_result->setQnicType(QNIC_RP);
   msm_result->setPhotonIndex(msm_info.photon_index_counter);
-  msm_result->setSuccess(click_result->getClickResult().success);
-  msm_result->setCorrectionOperation(click_result->getClickResult().correction_operation);
+  msm_result->setSuccess(success);
+  msm_result->setCorrectionOperation(correction_operation);
   msm_result->setSrcAddr(parentAddress);
   msm_result->setDestAddr(msm_info.partner_address);
   msm_result->setKind(6);
-  if (click_result->getClickResult().success) {
-    msm_info.qubit_postprocess_info[msm_info.photon_index_counter].qubit_index = qubit_index;
-    msm_info.qubit_postprocess_info[msm_info.photon_index_counter].correction_operation = click_result->getClickResult().correction_operation;
-    msm_info.iteration_index++;
-  } else {
-    realtime_controller->ReInitialize_StationaryQubit(qnic_index, qubit_index, QNIC_RP, false);
-    qnic_store->setQubitBusy(QNIC_RP, qnic_index, qubit_index, false);
-  }
   send(msm_result, "RouterPort$o");
 }
 
+void RuleEngine::reportMemoryExhausted(int qnic_index) {
+  auto &msm_info = msm_info_map[qnic_index];
+  msm_info.memory_exhausted_sent = true;
+  auto *exhausted = new MSMMemoryExhausted("MSMMemoryExhausted");
+  exhausted->setQnicIndex(qnic_index);
+  exhausted->setSrcAddr(parentAddress);
+  exhausted->setDestAddr(msm_info.epps_address);
+  send(exhausted, "RouterPort$o");
+}
+
+void RuleEngine::flushMSMResultWindow(int qnic_index) {
+  auto &msm_info = msm_info_map[qnic_index];
+  auto &window = msm_info.result_window;
+  if (window.num_photons == 0) return;
+  MSMResultBatch *batch = msm_result_batch_pool.acquire("MSMResultBatch");
+  batch->setQnicIndex(msm_info.partner_qnic_index);
+  batch->setQnicType(QNIC_RP);
+  batch->setFirstPhotonIndex(window.first_photon_index);
+  batch->setNumPhotons(window.num_photons);
+  batch->setSuccesses(window.successes);
+  batch->setSrcAddr(parentAddress);
+  batch->setDestAddr(msm_info.partner_address);
+  batch->setKind(6);
+  window.num_photons = 0;
+  window.successes.clear();
+  send(batch, "RouterPort$o");
+}
+
 void RuleEngine::handleMSMResult(MSMResult *msm_result) {
-  auto qnic_index = msm_result->getQnicIndex();
+  processPartnerMSMResult(msm_result->getQnicIndex(), msm_result->getPhotonIndex(), msm_result->getSuccess(), msm_result->getCorrectionOperation());
+  freeFailedMSMQubits(msm_result->getQnicIndex());
+}
+
+void RuleEngine::handleMSMResultBatch(MSMResultBatch *batch) {
+  auto qnic_index = batch->getQnicIndex();
+  auto first_photon_index = batch->getFirstPhotonIndex();
+  auto successes = batch->getSuccesses().decode();
+  auto success = successes.begin();
+  for (int offset = 0; offset < batch->getNumPhotons(); offset++) {
+    if (success != successes.end() && success->photon_index == offset) {
+      processPartnerMSMResult(qnic_index, first_photon_index + offset, true, success->correction_operation);
+      ++success;
+    } else {
+      processPartnerMSMResult(qnic_index, first_photon_index + offset, false, PauliOperator::I);
+    }
+  }
+  freeFailedMSMQubits(qnic_index);
+}
+
+void RuleEngine::processPartnerMSMResult(int qnic_index, uint64_t photon_index, bool success, PauliOperator correction_operation) {
   auto &msm_info = msm_info_map[qnic_index];
-  auto qubit_itr = msm_info.qubit_postprocess_info.find(msm_result->getPhotonIndex());
+  auto *qubit_itr = msm_info.qubit_postprocess_info.find(photon_index);
   // local: fail | partner: success/fail
   // qubit on photon index is not included in msm_info
-  if (qubit_itr == msm_info.qubit_postprocess_info.end()) {
+  if (qubit_itr == nullptr) {
     return;
   }
-  QubitInfo qubit_info = qubit_itr->second;
+  QubitInfo qubit_info = *qubit_itr;
+  msm_info.qubit_postprocess_info.erase(photon_index);
   auto qubit_index = qubit_info.qubit_index;
   // local: success | partner: fail
   // qubit on photon index is included in msm_info but the partner sends fail
-  if (!msm_result->getSuccess()) {
-    realtime_controller->ReInitialize_StationaryQubit(qnic_index, qubit_index, QNIC_RP, false);
-    qnic_store->setQubitBusy(QNIC_RP, qnic_index, qubit_index, false);
+  if (!success) {
+    failed_msm_qubit_indices.push_back(qubit_index);
   }
   // local: success | partner: success
   // qubit on photon index is included in msm_info and the partner sends success
   else {
     auto *qubit_record = qnic_store->getQubitRecord(QNIC_RP, qnic_index, qubit_index);
     // condition whether to apply Z gate or not
-    bool is_phi_minus = qubit_info.correction_operation != msm_result->getCorrectionOperation();
+    bool is_phi_minus = qubit_info.correction_operation != correction_operation;
     // restrict correction operation only on one side
     bool is_younger_address = parentAddress < msm_info.partner_address;
-    if (is_phi_minus && is_younger_address) realtime_controller->applyZGate(qubit_record);
+    if (is_phi_minus && is_younger_address) applyPauliCorrection(qubit_record, PauliOperator::Z);
+    qubit_record->setEntangledTime(simTime());
     bell_pair_store.insertEntangledQubit(msm_info.partner_address, qubit_record);
+    scheduleCutoff(qubit_record);
   }
 }
 
+void RuleEngine::freeFailedMSMQubits(int qnic_index) {
+  if (failed_msm_qubit_indices.empty()) return;
+  realtime_controller->ReInitialize_StationaryQubits(qnic_index, failed_msm_qubit_indices, QNIC_RP, false);
+  for (auto qubit_index : failed_msm_qubit_indices) qnic_store->setQubitBusy(QNIC_RP, qnic_index, qubit_index, false);
+  failed_msm_qubit_indices.clear();
+}
+
 void RuleEngine::handleLinkGenerationResult(CombinedBSAresults *bsa_result) {
   auto type = bsa_result->getQnicType();
   auto qnic_index = bsa_result->getQnicIndex();
-  auto num_success = bsa_result->getSuccessCount();
+  auto successes = bsa_result->getSuccesses().decode();
   auto partner_address = bsa_result->getNeighborAddress();
-  auto &emitted_indices = emitted_photon_order_map[{type, qnic_index}];
-  for (int i = num_success - 1; i >= 0; i--) {
-    auto emitted_index = bsa_result->getSuccessfulPhotonIndices(i);
-    auto qubit_index = emitted_indices[emitted_index];
+  qnic_neighbors[{type, qnic_index}] = partner_address;
+  auto &photon_train = emitted_photon_trains[{type, qnic_index}];
+  for (auto it = successes.rbegin(); it != successes.rend(); ++it) {
+    auto qubit_index = photon_train.markSucceeded(it->photon_index);
     auto *qubit_record = qnic_store->getQubitRecord(type, qnic_index, qubit_index);
-    auto iterator = emitted_indices.begin();
-    std::advance(iterator, emitted_index);
+    qubit_record->setEntangledTime(simTime());
     bell_pair_store.insertEntangledQubit(partner_address, qubit_record);
-    emitted_indices.erase(iterator);
-
-    auto correction_operation = bsa_result->getCorrectionOperationList(i);
-    if (correction_operation == PauliOperator::X) {
-      realtime_controller->applyXGate(qubit_record);
-    } else if (correction_operation == PauliOperator::Z) {
-      realtime_controller->applyZGate(qubit_record);
-    } else if (correction_operation == PauliOperator::Y) {
-      realtime_controller->applyYGate(qubit_record);
+    scheduleCutoff(qubit_record);
+
+    applyPauliCorrection(qubit_record, it->correction_operation);
+    if (link_trace_writer == nullptr) continue;
+    link_trace::LinkTraceRecord record;
+    record.time = simTime().dbl();
+    record.node_addr = parentAddress;
+    record.qnic_type = type;
+    record.qnic_index = qnic_index;
+    record.partner_addr = partner_address;
+    record.correction_operation = static_cast<std::uint8_t>(it->correction_operation);
+    record.pauli_error = static_cast<std::uint8_t>(it->pauli_error);
+    try {
+      link_trace_writer->append(record);
+    } catch (const std::runtime_error &e) {
+      error("%s", e.what());
     }
   }
 }
 
+namespace {
+void applyNoiselessPauli(backends::IQubit *qubit, PauliOperator op) {
+  if (op == PauliOperator::X || op == PauliOperator::Y) qubit->noiselessX();
+  if (op == PauliOperator::Z || op == PauliOperator::Y) qubit->noiselessZ();
+}
+}  // namespace
+
+void RuleEngine::replayLinkTrace() {
+  for (; next_link_trace_record < link_trace_records.size(); next_link_trace_record++) {
+    auto &record = link_trace_records[next_link_trace_record];
+    if (SimTime(record.time) > simTime()) break;
+    replayBellPair(record);
+  }
+  if (next_link_trace_record < link_trace_records.size()) scheduleAt(SimTime(link_trace_records[next_link_trace_record].time), link_trace_replay_timer);
+}
+
+/**
+ * @details Both nodes of a link recorded the pairs in the same order. The node whose record of a pair comes first
+ * takes a free qubit of its own and one of the partner, entangles them as the BSA would, and the partner queues its half until its record.
+ * The pair is missed if either has no free qubit.
+ */
+void RuleEngine::replayBellPair(const link_trace::LinkTraceRecord &record) {
+  auto type = static_cast<QNIC_type>(record.qnic_type);
+  auto partner_addr = record.partner_addr;
+  auto correction_operation = static_cast<PauliOperator>(record.correction_operation);
+  qnic_neighbors[{type, record.qnic_index}] = partner_addr;
+  auto halves = replayed_halves.find(partner_addr);
+  if (halves != replayed_halves.end() && !halves->second.empty()) {
+    auto *qubit_record = halves->second.front();
+    halves->second.pop_front();
+    if (qubit_record == nullptr) {
+      num_missed_replayed_bell_pairs++;
+      return;
+    }
+    insertReplayedBellPair(qubit_record, partner_addr, correction_operation);
+    return;
+  }
+
+  int qubit_index = qnic_store->takeFreeQubitIndex(type, record.qnic_index);
+  auto *partner = findLinkTracePartner(partner_addr);
+  auto *partner_qubit = partner == nullptr ? nullptr : partner->reserveReplayedHalf(parentAddress, qubit_index != -1);
+  if (qubit_index == -1 || partner_qubit == nullptr) {
+    if (qubit_index != -1) qnic_store->setQubitBusy(type, record.qnic_index, qubit_index, false);
+    num_missed_replayed_bell_pairs++;
+    return;
+  }
+  // Phi+ with the error of the photons, the corrections of both halves are undone at their insertion
+  auto *qubit = provider.getStationaryQubit(record.qnic_index, qubit_index, type)->getBackendQubitRef();
+  qubit->noiselessH();
+  qubit->noiselessCNOT(partner_qubit);
+  applyNoiselessPauli(partner_qubit, static_cast<PauliOperator>(record.pauli_error));
+  insertReplayedBellPair(qnic_store->getQubitRecord(type, record.qnic_index, qubit_index), partner_addr, correction_operation);
+}
+
+RuleEngine *RuleEngine::findLinkTracePartner(int partner_addr) {
+  auto *node = provider.getQNodeWithAddress(partner_addr);
+  if (node == nullptr) return nullptr;
+  auto *partner = dynamic_cast<RuleEngine *>(node->findModuleByPath(".qrsa.re"));
+  if (partner == nullptr || !partner->replays_link_trace) return nullptr;
+  return partner;
+}
+
+backends::IQubit *RuleEngine::reserveReplayedHalf(int neighbor_addr, bool available) {
+  Enter_Method_Silent("reserveReplayedHalf()");
+  auto &halves = replayed_halves[neighbor_addr];
+  auto *interface = available ? hardware_monitor->findInterfaceByNeighborAddr(neighbor_addr) : nullptr;
+  int qubit_index = interface == nullptr ? -1 : qnic_store->takeFreeQubitIndex(interface->qnic.type, interface->qnic.index);
+  if (qubit_index == -1) {
+    halves.push_back(nullptr);
+    return nullptr;
+  }
+  halves.push_back(qnic_store->getQubitRecord(interface->qnic.type, interface->qnic.index, qubit_index));
+  return provider.getStationaryQubit(interface->qnic.index, qubit_index, interface->qnic.type)->getBackendQubitRef();
+}
+
+void RuleEngine::insertReplayedBellPair(IQubitRecord *qubit_record, int partner_addr, PauliOperator correction_operation) {
+  // the half as the BSA left it, before the correction
+  auto *qubit = provider.getStationaryQubit(qubit_record->getQNicIndex(), qubit_record->getQubitIndex(), qubit_record->getQNicType())->getBackendQubitRef();
+  applyNoiselessPauli(qubit, correction_operation);
+  qubit_record->setEntangledTime(simTime());
+  bell_pair_store.insertEntangledQubit(partner_addr, qubit_record);
+  scheduleCutoff(qubit_record);
+  applyPauliCorrection(qubit_record, correction_operation);
+  num_replayed_bell_pairs++;
+}
+
+/**
+ * @details The node of the lower address of a link makes the pairs of both nodes. The ages come from the analytic rate of the link,
+ * see warm_start::sampleBellPairAges, and the pairs have the entangled times before t=0 so the cutoff and the ages count from there.
+ * The backends don't age the qubits before t=0, so the decoherence of the pairs starts now.
+ */
+void RuleEngine::warmStart() {
+  forEachQNic([this](QNIC_type type, int qnic_index, const std::string &) {
+    auto *info = hardware_monitor->findConnectionInfoByQnicAddr(provider.getQNIC(qnic_index, type)->par("self_qnic_address"));
+    if (info == nullptr || info->neighbor_address <= parentAddress) return;
+    auto *partner_node = provider.getQNodeWithAddress(info->neighbor_address);
+    auto *partner = partner_node == nullptr ? nullptr : dynamic_cast<RuleEngine *>(partner_node->findModuleByPath(".qrsa.re"));
+    if (partner == nullptr || !partner->warm_start) return;
+    auto ages = warm_start::sampleBellPairAges(provider.getQuantumLinkSecPerBellPair(partner_node), provider.getNumQubits(qnic_index, type), bell_pair_cutoff_time.dbl(),
+                                               [this]() { return dblrand(); });
+    for (auto age : ages) {
+      int qubit_index = qnic_store->takeFreeQubitIndex(type, qnic_index);
+      if (qubit_index == -1) break;
+      simtime_t entangled_time = simTime() - age;
+      auto *partner_qubit = partner->insertWarmStartHalf(parentAddress, entangled_time);
+      if (partner_qubit == nullptr) {
+        qnic_store->setQubitBusy(type, qnic_index, qubit_index, false);
+        break;
+      }
+      auto *qubit = provider.getStationaryQubit(qnic_index, qubit_index, type)->getBackendQubitRef();
+      qubit->noiselessH();
+      qubit->noiselessCNOT(partner_qubit);
+      if (dblrand() >= warm_start_fidelity) applyNoiselessPauli(partner_qubit, static_cast<PauliOperator>(intuniform(1, 3)));
+      insertWarmStartBellPair(qnic_store->getQubitRecord(type, qnic_index, qubit_index), info->neighbor_address, entangled_time);
+    }
+  });
+}
+
+backends::IQubit *RuleEngine::insertWarmStartHalf(int neighbor_addr, simtime_t entangled_time) {
+  Enter_Method_Silent("insertWarmStartHalf()");
+  auto *interface = hardware_monitor->findInterfaceByNeighborAddr(neighbor_addr);
+  int qubit_index = interface == nullptr ? -1 : qnic_store->takeFreeQubitIndex(interface->qnic.type, interface->qnic.index);
+  if (qubit_index == -1) return nullptr;
+  insertWarmStartBellPair(qnic_store->getQubitRecord(interface->qnic.type, interface->qnic.index, qubit_index), neighbor_addr, entangled_time);
+  return provider.getStationaryQubit(interface->qnic.index, qubit_index, interface->qnic.type)->getBackendQubitRef();
+}
+
+void RuleEngine::insertWarmStartBellPair(IQubitRecord *qubit_record, int partner_addr, simtime_t entangled_time) {
+  qubit_record->setEntangledTime(entangled_time);
+  bell_pair_store.insertEntangledQubit(partner_addr, qubit_record);
+  scheduleCutoff(qubit_record, entangled_time);
+  num_warm_start_bell_pairs++;
+}
+
+void RuleEngine::applyPauliCorrection(IQubitRecord *qubit_record, PauliOperator correction_operation) {
+  if (pauli_frame_tracking) {
+    int correction = correction_operation == PauliOperator::X   ? pauli_frame::X
+                     : correction_operation == PauliOperator::Z ? pauli_frame::Z
+                     : correction_operation == PauliOperator::Y ? pauli_frame::Y
+                                                                : pauli_frame::I;
+    qubit_record->setPauliFrame(qubit_record->getPauliFrame() ^ correction);
+    return;
+  }
+  if (correction_operation == PauliOperator::X) {
+    realtime_controller->applyXGate(qubit_record);
+  } else if (correction_operation == PauliOperator::Z) {
+    realtime_controller->applyZGate(qubit_record);
+  } else if (correction_operation == PauliOperator::Y) {
+    realtime_controller->applyYGate(qubit_record);
+  }
+}
+
 void RuleEngine::handleStopEmitting(StopEmitting *stop_emit) {
+  if (stop_emit->getTerminate_ruleset()) {
+    if (auto *runtime = runtimes.findById(stop_emit->getRuleset_id())) runtime->terminate();
+  }
   int qnic_index = stop_emit->getQnic_address();
   auto &msm_info = msm_info_map[qnic_index];
   // only do the following procedure for MSM links
@@ -326,13 +1033,28 @@ void RuleEngine::handleStopEmitting(StopEmitting *stop_emit) {
   send(stop_epps_emission, "RouterPort$o");
 }
 
+// the other RuleSets keep running, their paths don't go through the link
+void RuleEngine::handleQuantumLinkDown(QuantumLinkDown *link_down) {
+  runtime::QNodeAddr neighbor_addr{link_down->getNeighbor_address()};
+  std::vector<runtime::Runtime *> affected;
+  for (auto &runtime : runtimes) {
+    if (runtime.terminated) continue;
+    bool uses_link = runtime.hasPartner(neighbor_addr);
+    runtime.qubits.forEach([&](auto, auto, IQubitRecord *qubit_record) {
+      if (qubit_record->getQNicIndex() == link_down->getQnic_index() && qubit_record->getQNicType() == link_down->getQnic_type()) uses_link = true;
+    });
+    if (uses_link) affected.push_back(&runtime);
+  }
+  for (auto *runtime : affected) runtime->terminate();
+}
+
 void RuleEngine::handlePurificationResult(PurificationResult *result) {
   auto ruleset_id = result->getRulesetId();
   auto shared_rule_tag = result->getSharedRuleTag();
   auto sequence_number = result->getSequenceNumber();
   auto measurement_result = result->getMeasurementResult();
   auto purification_protocol = result->getProtocol();
-  std::vector<int> message_content = {sequence_number, measurement_result, purification_protocol};
+  runtime::MessageRecord message_content{sequence_number, measurement_result, purification_protocol};
   auto runtime = runtimes.findById(ruleset_id);
   if (runtime == nullptr) return;
   runtime->assignMessageToRuleSet(shared_rule_tag, message_content);
@@ -344,43 +1066,206 @@ void RuleEngine::handleSwappingResult(SwappingResult *result) {
   auto sequence_number = result->getSequenceNumber();
   auto correction_frame = result->getCorrectionFrame();
   auto new_partner_addr = result->getNewPartner();
-  std::vector<int> message_content = {sequence_number, correction_frame, new_partner_addr};
+  runtime::MessageRecord message_content{sequence_number, correction_frame, new_partner_addr};
   auto runtime = runtimes.findById(ruleset_id);
   if (runtime == nullptr) return;
   runtime->assignMessageToRuleSet(shared_rule_tag, message_content);
 }
 
+void RuleEngine::handleSwappingResultBatch(SwappingResultBatch *batch) {
+  auto runtime = runtimes.findById(batch->getRulesetId());
+  if (runtime == nullptr) return;
+  for (int i = 0; i < batch->getNumResults(); i++) {
+    auto &result = batch->getResult(i);
+    runtime->assignMessageToRuleSet(result.shared_rule_tag, runtime::MessageRecord{result.sequence_number, result.correction_frame, result.new_partner});
+  }
+}
+
+void RuleEngine::sendSwappingResult(unsigned long ruleset_id, int partner_addr, const SwappingResultEntry &result) {
+  if (!batch_swapping_results) {
+    send(makeSwappingResult(ruleset_id, partner_addr, result), "RouterPort$o");
+    return;
+  }
+  auto it = std::find_if(pending_swapping_results.begin(), pending_swapping_results.end(),
+                         [&](SwappingResultBatch *batch) { return batch->getDestAddr() == partner_addr && batch->getRulesetId() == ruleset_id; });
+  if (it == pending_swapping_results.end()) {
+    auto *batch = swapping_result_batch_pool.acquire("SwappingResultBatch");
+    batch->setSrcAddr(parentAddress);
+    batch->setDestAddr(partner_addr);
+    batch->setRulesetId(ruleset_id);
+    batch->setKind(5);  // cyan
+    it = pending_swapping_results.insert(pending_swapping_results.end(), batch);
+  }
+  (*it)->appendResult(result);
+}
+
+SwappingResult *RuleEngine::makeSwappingResult(unsigned long ruleset_id, int partner_addr, const SwappingResultEntry &result) {
+  SwappingResult *pkt = swapping_result_pool.acquire("SwappingResult");
+  pkt->setSrcAddr(parentAddress);
+  pkt->setDestAddr(partner_addr);
+  pkt->setRulesetId(ruleset_id);
+  pkt->setSharedRuleTag(result.shared_rule_tag);
+  pkt->setSequenceNumber(result.sequence_number);
+  pkt->setKind(5);  // cyan
+  pkt->setCorrectionFrame(result.correction_frame);
+  pkt->setNewPartner(result.new_partner);
+  return pkt;
+}
+
+void RuleEngine::flushSwappingResults() {
+  // in the order of the first result of each batch
+  for (auto *batch : pending_swapping_results) {
+    if (batch->getNumResults() > 1) {
+      send(batch, "RouterPort$o");
+      continue;
+    }
+    send(makeSwappingResult(batch->getRulesetId(), batch->getDestAddr(), batch->getResult(0)), "RouterPort$o");
+    swapping_result_batch_pool.release(batch);
+  }
+  pending_swapping_results.clear();
+}
+
 // Invoked whenever a new resource (entangled with neighbor) has been created.
 // Allocates those resources to a particular ruleset, from top to bottom (all of it).
+// Each qubit goes to the first accepted RuleSet that uses its partner and holds less than
+// ruleset_qubit_quota qubits with the partner, so the RuleSets sharing a qnic take turns.
+// The qubits no RuleSet can take yet stay pending in the BellPairStore until a RuleSet arrives or frees its quota.
 void RuleEngine::ResourceAllocation(int qnic_type, int qnic_index) {
-  for (auto &runtime : runtimes) {
-    auto &partners = runtime.partners;
-    for (auto &partner_addr : partners) {
-      auto range = bell_pair_store.getBellPairsRange((QNIC_type)qnic_type, qnic_index, partner_addr.val);
-      for (auto it = range.first; it != range.second; ++it) {
-        auto qubit_record = it->second;
-
-        // 3. if the qubit is not allocated yet, and the qubit has not been allocated to this rule,
-        // if the qubit has already been assigned to the rule, the qubit is not allocatable to that rule
-        if (!qubit_record->isAllocated()) {  //&& !qubit_record->isRuleApplied((*rule)->rule_id
-          qubit_record->setAllocated(true);
-          runtime.assignQubitToRuleSet(partner_addr, qubit_record);
-        }
+  bell_pair_store.allocatePendingQubits((QNIC_type)qnic_type, qnic_index, [&](int partner, const std::vector<IQubitRecord *> &qubit_records) {
+    runtime::QNodeAddr partner_addr{partner};
+    auto *partner_runtimes = runtimes.findAllByPartner(partner_addr);
+    if (partner_runtimes == nullptr) return false;
+    if (qos_allocation) return allocateByQosClass(partner_addr, *partner_runtimes, qubit_records);
+    auto runtime_it = partner_runtimes->begin();
+    for (auto *qubit_record : qubit_records) {
+      if (qubit_record->isAllocated()) continue;
+      while (runtime_it != partner_runtimes->end() && isAllocationFull(*runtime_it, partner_addr)) ++runtime_it;
+      if (runtime_it == partner_runtimes->end()) return false;
+      qubit_record->setAllocated(true);
+      if (record_summaries) resource_wait_time_histogram.record((simTime() - qubit_record->getEntangledTime()).dbl());
+      (*runtime_it)->assignQubitToRuleSet(partner_addr, qubit_record);
+    }
+    return true;
+  });
+}
+
+// the terminated Runtimes are removed with their qubits at the next exec()
+bool RuleEngine::isAllocationFull(runtime::Runtime *runtime, runtime::QNodeAddr partner_addr) const {
+  return runtime->terminated || (ruleset_qubit_quota > 0 && runtime->qubits.countOf(partner_addr) >= ruleset_qubit_quota);
+}
+
+/**
+ * @details The Runtimes are sorted into their classes once per partner, then each pair takes the next Runtime
+ * with room in its class, so a decision only looks at the classes.
+ */
+bool RuleEngine::allocateByQosClass(runtime::QNodeAddr partner_addr, const std::vector<runtime::Runtime *> &partner_runtimes, const std::vector<IQubitRecord *> &qubit_records) {
+  for (auto &class_runtimes : qos_class_runtimes) class_runtimes.clear();
+  for (auto *runtime : partner_runtimes) {
+    if (runtime->terminated) continue;
+    auto class_index = qos_classes.classOf(runtime->ruleset->qos_priority, runtime->ruleset->qos_min_share);
+    if (class_index >= (int)qos_class_runtimes.size()) qos_class_runtimes.resize(class_index + 1);
+    qos_class_runtimes[class_index].push_back(runtime);
+  }
+  qos_class_cursors.assign(qos_class_runtimes.size(), 0);
+
+  for (auto *qubit_record : qubit_records) {
+    if (qubit_record->isAllocated()) continue;
+    qos_candidate_classes.clear();
+    for (int class_index = 0; class_index < (int)qos_class_runtimes.size(); class_index++) {
+      auto &class_runtimes = qos_class_runtimes[class_index];
+      auto &cursor = qos_class_cursors[class_index];
+      while (cursor < class_runtimes.size() && isAllocationFull(class_runtimes[cursor], partner_addr)) cursor++;
+      if (cursor < class_runtimes.size()) qos_candidate_classes.push_back(class_index);
+    }
+    if (qos_candidate_classes.empty()) return false;
+    auto class_index = qos_classes.choose(qos_candidate_classes);
+    auto *runtime = qos_class_runtimes[class_index][qos_class_cursors[class_index]];
+    qubit_record->setAllocated(true);
+    if (record_summaries) resource_wait_time_histogram.record((simTime() - qubit_record->getEntangledTime()).dbl());
+    runtime->assignQubitToRuleSet(partner_addr, qubit_record);
+  }
+  return true;
+}
+
+void RuleEngine::executeAllRuleSets() {
+  // the RuleSets out of their action budget go on in the next event
+  if (runtimes.exec() && runtime_continuation_timer != nullptr && !runtime_continuation_timer->isScheduled()) {
+    scheduleAt(simTime(), runtime_continuation_timer);
+  }
+  if (!pending_swapping_results.empty()) flushSwappingResults();
+}
+
+void RuleEngine::scheduleCutoff(IQubitRecord *qubit_record) { scheduleCutoff(qubit_record, simTime()); }
+
+void RuleEngine::scheduleCutoff(IQubitRecord *qubit_record, simtime_t entangled_time) {
+  if (bell_pair_cutoff_time == SIMTIME_ZERO) return;
+  // the cutoff starts at the first entanglement, the later corrections of the pair don't extend it
+  if (cutoff_timer_handles.find(qubit_record) != cutoff_timer_handles.end()) return;
+  cutoff_timer_handles.emplace(qubit_record, cutoff_timers->schedule(entangled_time + bell_pair_cutoff_time, qubit_record));
+}
+
+void RuleEngine::cancelCutoff(IQubitRecord *qubit_record) {
+  auto it = cutoff_timer_handles.find(qubit_record);
+  if (it == cutoff_timer_handles.end()) return;
+  cutoff_timers->cancel(it->second);
+  cutoff_timer_handles.erase(it);
+}
+
+void RuleEngine::discardExpiredBellPair(IQubitRecord *qubit_record) {
+  if (qubit_record->isAllocated()) {
+    for (auto &runtime : runtimes) {
+      if (runtime.qubits.find(qubit_record) == nullptr) continue;
+      auto location = runtime.releaseQubit(qubit_record);
+      if (!location.has_value()) {
+        // a Rule is using the qubit, try again at the next tick
+        cutoff_timer_handles.emplace(qubit_record, cutoff_timers->schedule(simTime(), qubit_record));
+        return;
       }
+      auto *discarded = new BellPairDiscarded("BellPairDiscarded");
+      discarded->setSrcAddr(parentAddress);
+      discarded->setDestAddr(location->partner_addr.val);
+      discarded->setRulesetId(runtime.ruleset_id);
+      discarded->setSharedRuleTag(runtime.ruleset->rules.at(location->rule_id).send_tag);
+      discarded->setSequenceNumber(location->sequence_number);
+      send(discarded, "RouterPort$o");
+      break;
     }
   }
+  // the pairs no RuleSet took yet are freed silently, the partner's own cutoff frees the other half
+  num_discarded_bell_pairs++;
+  freeConsumedResource(qubit_record->getQNicIndex(), provider.getStationaryQubit(qubit_record), qubit_record->getQNicType());
 }
 
-void RuleEngine::executeAllRuleSets() { runtimes.exec(); }
+void RuleEngine::handleBellPairDiscarded(BellPairDiscarded *discarded) {
+  auto *runtime = runtimes.findById(discarded->getRulesetId());
+  if (runtime == nullptr) return;
+  auto *qubit_record = runtime->getQubitBySharedRuleTag(runtime::QNodeAddr{discarded->getSrcAddr()}, discarded->getSharedRuleTag(), discarded->getSequenceNumber());
+  // the qubit may be already measured or in use, then the Rules find out the failure by themselves
+  if (qubit_record == nullptr || !runtime->releaseQubit(qubit_record).has_value()) return;
+  num_discarded_bell_pairs++;
+  freeConsumedResource(qubit_record->getQNicIndex(), provider.getStationaryQubit(qubit_record), qubit_record->getQNicType());
+}
 
 void RuleEngine::freeConsumedResource(int qnic_index /*Not the address!!!*/, IStationaryQubit *qubit, QNIC_type qnic_type) {
-  auto *qubit_record = qnic_store->getQubitRecord(qnic_type, qnic_index, qubit->par("stationary_qubit_address"));
+  auto *qubit_record = qnic_store->getQubitRecord(qnic_type, qnic_index, qubit->stationary_qubit_address);
   realtime_controller->ReInitialize_StationaryQubit(qubit_record, false);
+  releaseConsumedQubitRecord(qubit_record);
+}
+
+void RuleEngine::freeConsumedResources(const std::vector<IQubitRecord *> &qubit_records) {
+  realtime_controller->ReInitialize_StationaryQubits(qubit_records, false);
+  for (auto *qubit_record : qubit_records) releaseConsumedQubitRecord(qubit_record);
+}
+
+void RuleEngine::releaseConsumedQubitRecord(IQubitRecord *qubit_record) {
+  qubit_record->unlock();
+  qubit_record->setPauliFrame(pauli_frame::I);
   qubit_record->setBusy(false);
   if (qubit_record->isAllocated()) {
     qubit_record->setAllocated(false);
   }
-  bell_pair_store.eraseQubit(qubit_record);
+  bell_pair_store.consumeQubit(qubit_record, simTime());
+  cancelCutoff(qubit_record);
 }
 
 }  // namespace quisp::modules
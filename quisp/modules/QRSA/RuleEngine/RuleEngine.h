@@ -4,6 +4,11 @@
  */
 #pragma once
 
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -11,9 +16,14 @@
 
 #include "BellPairStore/BellPairStore.h"
 #include "IRuleEngine.h"
+#include "LinkTrace/LinkTrace.h"
+#include "PhotonTrain/PhotonTrain.h"
+#include "QosArbiter/QosArbiter.h"
 #include "QNicStore/IQNicStore.h"
 #include "QubitRecord/IQubitRecord.h"
+#include "WarmStart/WarmStart.h"
 #include "messages/BSA_ipc_messages_m.h"
+#include "messages/MessagePool.h"
 #include "messages/classical_messages.h"
 #include "messages/link_generation_messages_m.h"
 #include "modules/Logger/LoggerBase.h"
@@ -25,6 +35,10 @@
 #include "runtime/Runtime.h"
 #include "runtime/RuntimeManager.h"
 #include "utils/ComponentProvider.h"
+#include "utils/IndexedRingBuffer.h"
+#include "utils/StreamingStats.h"
+#include "utils/TimerService.h"
+#include "utils/TypeDispatcher.h"
 
 using namespace omnetpp;
 using namespace quisp::rules;
@@ -73,15 +87,59 @@ class RuleEngine : public IRuleEngine, public Logger::LoggerBase {
 
   void freeResource(int qnic_index, int qubit_index, QNIC_type qnic_type);
   void freeConsumedResource(int qnic_index, IStationaryQubit *qubit, QNIC_type qnic_type);
+  // freeConsumedResource of a batch of qubits, reinitialized by the RealTimeController at once
+  void freeConsumedResources(const std::vector<IQubitRecord *> &qubit_records);
   void ResourceAllocation(int qnic_type, int qnic_index);
+  // with qos_allocation: the pairs with the partner go to the first Runtime with room of the class qos_classes chooses for each pair
+  bool allocateByQosClass(runtime::QNodeAddr partner_addr, const std::vector<runtime::Runtime *> &partner_runtimes, const std::vector<IQubitRecord *> &qubit_records);
+  bool isAllocationFull(runtime::Runtime *runtime, runtime::QNodeAddr partner_addr) const;
+  /**
+   * @brief with link_trace_replay_filename: takes a free qubit of the qnic to the neighbor for the other half of a Bell pair
+   * the neighbor is replaying, and queues it until the record of the pair here. available is false if the neighbor has no qubit for the pair.
+   * @return the backend qubit to entangle, or nullptr if the pair isn't made
+   */
+  backends::IQubit *reserveReplayedHalf(int neighbor_addr, bool available);
+  /**
+   * @brief with warm_start: takes a free qubit of the qnic to the neighbor for the other half of a Bell pair the neighbor pre-fills,
+   * and holds it as entangled since entangled_time, before t=0.
+   * @return the backend qubit to entangle, or nullptr if there's no free qubit
+   */
+  backends::IQubit *insertWarmStartHalf(int neighbor_addr, simtime_t entangled_time);
 
  protected:
   void initialize() override;
+  void finish() override;
   void handleMessage(cMessage *msg) override;
+  void registerMessageHandlers();
+  void handleBSMTimingNotification(messages::BSMTimingNotification *notification);
+  void handleEmitPhotonRequest(messages::EmitPhotonRequest *pk);
+  void handleEPPSTimingNotification(messages::EPPSTimingNotification *notification);
+  // keep_alive parks the Runtime after the demand of a persistent connection, see handleConnectionRearm.
+  // the RuleSet for a running RuleSet id extends it, e.g. the link-level rules installed during a pipelined connection setup
+  void acceptForwardedRuleSet(const RuntimeRuleSetPtr &compiled_ruleset, const json &serialized_ruleset, bool keep_alive = false);
+  void handleConnectionRearm(messages::ConnectionRearm *rearm);
   void handleMSMResult(messages::MSMResult *msm_result);
+  void handleMSMResultBatch(messages::MSMResultBatch *batch);
+  // applies the partner's result of the photon to the qubit waiting for it
+  void processPartnerMSMResult(int qnic_index, uint64_t photon_index, bool success, PauliOperator correction_operation);
+  // frees the qubits processPartnerMSMResult found the partner failed for, in one batch
+  void freeFailedMSMQubits(int qnic_index);
+  // sends the result of the current photon to the partner, or adds it to the window with msm_result_window
+  void reportMSMResult(int qnic_index, bool success, PauliOperator correction_operation);
+  void flushMSMResultWindow(int qnic_index);
+  // asks the EPPS of the MSM link to pause, as the photons find no free qubit
+  void reportMemoryExhausted(int qnic_index);
   void handleLinkGenerationResult(messages::CombinedBSAresults *bsa_result);
+  // applies the correction to the qubit, or adds it to the qubit's Pauli frame with pauli_frame_tracking
+  void applyPauliCorrection(IQubitRecord *qubit_record, PauliOperator correction_operation);
   void handlePurificationResult(messages::PurificationResult *purification_result);
   void handleSwappingResult(messages::SwappingResult *swapping_result);
+  void handleSwappingResultBatch(messages::SwappingResultBatch *batch);
+  // sends the result to the partner, or adds it to the partner's batch of the event with batch_swapping_results
+  void sendSwappingResult(unsigned long ruleset_id, int partner_addr, const messages::SwappingResultEntry &result);
+  messages::SwappingResult *makeSwappingResult(unsigned long ruleset_id, int partner_addr, const messages::SwappingResultEntry &result);
+  // sends the batches of the event, a batch of one result as a SwappingResult
+  void flushSwappingResults();
   void handleSingleClickResult(messages::SingleClickResult *click_result);
   messages::CombinedBSAresults *generateCombinedBSAresults(int qnic_index);
   void executeAllRuleSets();
@@ -91,14 +149,127 @@ class RuleEngine : public IRuleEngine, public Logger::LoggerBase {
   simtime_t getEmitTimeFromBSMNotification(messages::BSMTimingNotification *notification);
   void schedulePhotonEmission(QNIC_type qnic_type, int qnic_index, messages::BSMTimingNotification *notification);
   void scheduleMSMPhotonEmission(QNIC_type qnic_type, int qnic_index, messages::EPPSTimingNotification *notification);
+  // with demand_driven_emission, true while no running RuleSet uses the neighbor of the qnic. false until the neighbor is known
+  bool isEmissionIdle(QNIC_type qnic_type, int qnic_index) const;
+  // the fast link layer: hands all the free qubits of the qnic to the BSA at once, without emitting photons
+  void emitPhotonTrainAtOnce(QNIC_type qnic_type, int qnic_index, messages::EmitPhotonRequest *pk);
+  // emits the photons of first_qubit_index and up to temporal_modes - 1 more free qubits as the time bins of one pulse.
+  // returns true if it was the last pulse of the round, i.e. no free qubit is left
+  bool sendEmitPhotonPulseSignalToQnic(QNIC_type qnic_type, int qnic_index, int first_qubit_index, bool is_first, simtime_t interval);
+  // emits the photons of first_qubit_index and all the free qubits of the qnic as one PhotonicQubitTrain
+  void sendEmitPhotonTrainSignalToQnic(QNIC_type qnic_type, int qnic_index, int first_qubit_index, simtime_t interval);
   void handleStopEmitting(messages::StopEmitting *stop_emit);
+  void handleQuantumLinkDown(messages::QuantumLinkDown *link_down);
+  // starts the cutoff time of the new Bell pair, a no-op without bell_pair_cutoff_time
+  void scheduleCutoff(IQubitRecord *qubit_record);
+  void scheduleCutoff(IQubitRecord *qubit_record, simtime_t entangled_time);
+  void cancelCutoff(IQubitRecord *qubit_record);
+  // frees the qubit of the Bell pair older than the cutoff time, and notifies the partner if a RuleSet held it
+  void discardExpiredBellPair(IQubitRecord *qubit_record);
+  void handleBellPairDiscarded(messages::BellPairDiscarded *discarded);
+  // with coalesce_events: handles the message without allocating or executing, and schedules the pass of its time
+  void handleCoalescedMessage(cMessage *msg);
+  // allocates the new Bell pairs of the qnics to the RuleSets, the qnics in the order of QNIC_E, QNIC_R and QNIC_RP and their indices
+  void allocateAllResources();
+  // makes the Bell pairs of the link trace up to now, and schedules the next record
+  void replayLinkTrace();
+  void replayBellPair(const link_trace::LinkTraceRecord &record);
+  // the RuleEngine of the partner if it's replaying the link trace too
+  RuleEngine *findLinkTracePartner(int partner_addr);
+  void insertReplayedBellPair(IQubitRecord *qubit_record, int partner_addr, PauliOperator correction_operation);
+  // fills the buffers of the links this node takes the warm start of
+  void warmStart();
+  void insertWarmStartBellPair(IQubitRecord *qubit_record, int partner_addr, simtime_t entangled_time);
+  // the bookkeeping of freeConsumedResource after the qubit is reinitialized
+  void releaseConsumedQubitRecord(IQubitRecord *qubit_record);
+  // returns the consumed message to its pool, or deletes it
+  void releaseMessage(cMessage *msg);
+  // calls f(qnic_type, qnic_index, label) for the qnics of the node, the label like "QNIC_E[0]" names their scalars and vectors
+  void forEachQNic(const std::function<void(QNIC_type, int, const std::string &)> &f) const;
+  // records the occupancy of the qnics and the ages of their consumed Bell pairs over the last occupancy_report_interval
+  void reportOccupancy();
+  // the Runtimes, the Bell pairs and the MSM and cutoff bookkeeping, for SharedResource's memory accounting
+  void reportMemoryUsage(modules::SharedResource::MemoryAccounting::Usage &usage) const;
 
   utils::ComponentProvider provider;
+  modules::SharedResource::EventProfiler *event_profiler = nullptr;
   std::unique_ptr<IQNicStore> qnic_store = nullptr;
 
   runtime::RuntimeManager runtimes;
+  // the qubits a RuleSet can hold with each partner, 0 for no limit
+  int ruleset_qubit_quota = 0;
+  // the Bell pairs go to the RuleSets by their QoS class instead of in the accepted order
+  bool qos_allocation = false;
+  qos_arbiter::QosArbiter qos_classes;
+  // the Runtimes of each class waiting for the pairs being allocated, and the next one to take a pair, reused by allocateByQosClass
+  std::vector<std::vector<runtime::Runtime *>> qos_class_runtimes;
+  std::vector<std::size_t> qos_class_cursors;
+  std::vector<int> qos_candidate_classes;
+  bool fast_link_layer = false;
+  bool photon_train_messages = false;
+  bool demand_driven_emission = false;
+  // the time-bin modes of an emission pulse, 1 for a pulse per photon
+  int temporal_modes = 1;
+  // the neighbor of the qnic from its last CombinedBSAresults
+  std::unordered_map<std::pair<QNIC_type, int>, int> qnic_neighbors;
+  long num_idle_emission_rounds = 0;
+  // the results exchanged with the partners, recycled instead of allocated for every event
+  messages::MessagePool<messages::PurificationResult> purification_result_pool{"purification_result_pool"};
+  messages::MessagePool<messages::SwappingResult> swapping_result_pool{"swapping_result_pool"};
+  messages::MessagePool<messages::MSMResult> msm_result_pool{"msm_result_pool"};
+  messages::MessagePool<messages::MSMResultBatch> msm_result_batch_pool{"msm_result_batch_pool"};
+  messages::MessagePool<messages::SwappingResultBatch> swapping_result_batch_pool{"swapping_result_batch_pool"};
+  bool batch_swapping_results = false;
+  // the batches being filled in this event, few as the results go to the two ends of the swapped pairs
+  std::vector<messages::SwappingResultBatch *> pending_swapping_results;
+  // the MSM photons reported to the partner in one message, 1 for a message per photon
+  int msm_result_window = 1;
+  // the corrections are tracked in the qubit records, see RuntimeCallback
+  bool pauli_frame_tracking = false;
+  // the Bell pairs are discarded this long after they're entangled, 0 for no cutoff
+  simtime_t bell_pair_cutoff_time = SIMTIME_ZERO;
+  // the tick of the cutoff_timers, the qubits are discarded up to a tick after their cutoff time
+  simtime_t cutoff_timer_resolution;
+  // the cutoff times of all the Bell pairs on a single self message instead of a timer per qubit, nullptr without the cutoff
+  std::unique_ptr<utils::TimerService<IQubitRecord *>> cutoff_timers;
+  std::unordered_map<IQubitRecord *, utils::TimerService<IQubitRecord *>::Handle> cutoff_timer_handles;
+  // brings the RuleSets that used up their action budget back in the next event
+  cMessage *runtime_continuation_timer = nullptr;
+  long num_discarded_bell_pairs = 0;
+  // a single allocation and execution pass after all the messages of the same time, instead of one after every message
+  bool coalesce_events = false;
+  cMessage *coalesced_pass_timer = nullptr;
+  // the messages handled by the pass of an earlier message of their time
+  long num_coalesced_events = 0;
+  // the Bell pairs of the links with the BSA recorded, or replayed in place of the photons
+  std::unique_ptr<link_trace::LinkTraceWriter> link_trace_writer;
+  bool replays_link_trace = false;
+  std::vector<link_trace::LinkTraceRecord> link_trace_records;
+  std::size_t next_link_trace_record = 0;
+  cMessage *link_trace_replay_timer = nullptr;
+  // the halves of the Bell pairs the neighbors prepared by their earlier records, nullptr for a pair not made, by the neighbor address
+  std::unordered_map<int, std::deque<IQubitRecord *>> replayed_halves;
+  long num_replayed_bell_pairs = 0;
+  long num_missed_replayed_bell_pairs = 0;
+  // the buffers of the links filled at t=0, see warm_start in the NED
+  bool warm_start = false;
+  double warm_start_fidelity = 1;
+  cMessage *warm_start_timer = nullptr;
+  long num_warm_start_bell_pairs = 0;
+  // from the entanglement of the Bell pairs to their allocation to a RuleSet
+  bool record_summaries = true;
+  utils::LogHistogram resource_wait_time_histogram;
+  // the occupancy of the qnics and the ages of the consumed Bell pairs are recorded as vectors at this interval, 0 for none
+  simtime_t occupancy_report_interval = SIMTIME_ZERO;
+  cMessage *occupancy_report_timer = nullptr;
+  std::map<std::string, std::unique_ptr<cOutVector>> occupancy_vectors;
+  simsignal_t connection_pair_delivered_signal;
+  simsignal_t connection_terminated_signal;
+  // returns false if the message is kept, e.g. the rescheduled timers
+  utils::TypeDispatcher<cMessage, bool> message_dispatcher;
   std::unordered_map<std::pair<QNIC_type, int>, messages::EmitPhotonRequest *> emit_photon_timer_map;
-  std::unordered_map<std::pair<QNIC_type, int>, std::vector<int>> emitted_photon_order_map;
+  // the photons emitted in the ongoing BSM round
+  std::unordered_map<std::pair<QNIC_type, int>, photon_train::PhotonTrain> emitted_photon_trains;
 
   struct QubitInfo {
     int qubit_index;
@@ -110,16 +281,25 @@ class RuleEngine : public IRuleEngine, public Logger::LoggerBase {
     int partner_qnic_index;
     int epps_address;
     unsigned long long photon_index_counter;
-    int iteration_index;
     simtime_t total_travel_time;
-    // map of iteration index and qubit index
-    std::unordered_map<int, int> qubit_info_map;
-    // map of photon index and qubit info
-    std::unordered_map<int, QubitInfo> qubit_postprocess_info;
+    // the EPPS pauses on an MSMMemoryExhausted, which is sent once until the next timing notification
+    bool backpressure = false;
+    bool memory_exhausted_sent = false;
+    // the qubit emitting photons until the next successful click. it's reset to 0 after the click
+    int emitting_qubit_index;
+    // the qubit info by photon index, until the partner's MSMResult of the photon arrives
+    utils::IndexedRingBuffer<QubitInfo> qubit_postprocess_info;
+    // the results not sent to the partner yet, with msm_result_window
+    struct ResultWindow {
+      unsigned long long first_photon_index = 0;
+      int num_photons = 0;
+      CompactClickResults successes;
+    } result_window;
   };
 
   // [Key: qnic_index, Value: qubit_index]
   std::unordered_map<int, MSMInfo> msm_info_map;
+  std::vector<int> failed_msm_qubit_indices;
 };
 
 Define_Module(RuleEngine);
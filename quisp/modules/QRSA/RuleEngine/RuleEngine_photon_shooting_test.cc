@@ -63,6 +63,26 @@ class RuleEngineTestTarget : public quisp::modules::RuleEngine {
     setParInt(this, "number_of_qnics_r", 1);
     setParInt(this, "number_of_qnics", 3);
     setParInt(this, "total_number_of_qnics", 2);
+    setParBool(this, "profile_runtime", false);
+    setParStr(this, "runtime_trace", "");
+    setParBool(this, "record_summaries", true);
+    setParInt(this, "ruleset_qubit_quota", 0);
+    setParBool(this, "qos_allocation", false);
+    setParInt(this, "ruleset_action_budget", 0);
+    setParStr(this, "memory_resource", "global");
+    setParBool(this, "pool_messages", true);
+    setParBool(this, "fast_link_layer", false);
+    setParBool(this, "demand_driven_emission", false);
+    setParBool(this, "batch_swapping_results", false);
+    setParBool(this, "pauli_frame_tracking", false);
+    setParBool(this, "coalesce_events", false);
+    setParStr(this, "link_trace_record_filename", "");
+    setParStr(this, "link_trace_replay_filename", "");
+    setParBool(this, "warm_start", false);
+    setParDouble(this, "warm_start_fidelity", 1);
+    setParBool(this, "photon_train_messages", false);
+    setParInt(this, "temporal_modes", 1);
+    setParInt(this, "msm_result_window", 1);
     setName("rule_engine_test_target");
     provider.setStrategy(std::make_unique<Strategy>(hardware_monitor, qnic_specs, realtime_controller));
     setComponentType(new TestModuleType("rule_engine_test"));
@@ -189,6 +209,88 @@ TEST(RuleEnginePhotonShootingTest, EmitPhotonWithTwoFreeQubits) {
   delete mockRealtimeController;
 }
 
+TEST(RuleEnginePhotonShootingTest, EmitPhotonTrainWithTwoFreeQubits) {
+  auto* sim = prepareSimulation();
+  auto* mockHardwareMonitor = new MockHardwareMonitor;
+  auto* mockRealtimeController = new MockRealTimeController;
+  int qnic_index = 1;
+
+  // Emitter QNIC(index:0~2) has 2 qubit, Receiver QNIC(index:0) has 1 qubit
+  std::vector<QNicSpec> qnic_specs = {
+      {QNIC_E, 0, 2},
+      {QNIC_E, 1, 2},
+      {QNIC_E, 2, 2},
+      {QNIC_R, 0, 1},
+  };
+  auto rule_engine = new RuleEngineTestTarget{mockHardwareMonitor, qnic_specs, mockRealtimeController};
+  setParBool(rule_engine, "photon_train_messages", true);
+
+  sim->registerComponent(rule_engine);
+  rule_engine->callInitialize();
+  sim->setContext(rule_engine);
+
+  auto* pk = new EmitPhotonRequest();
+  pk->setQnicType(QNIC_E);
+  pk->setQnicIndex(qnic_index);
+  pk->setFirst(true);
+  pk->setIntervalBetweenPhotons(0.0001);
+
+  // both photons leave at once, without the timer for the second one
+  EXPECT_CALL(*mockRealtimeController, EmitPhotonTrain(qnic_index, std::vector<int>({0, 1}), QNIC_E, SimTime(0.0001)));
+  rule_engine->handleMessage(pk);
+  EXPECT_EQ(rule_engine->getNumFreeQubitsInQnic(QNIC_E, qnic_index), 0);
+  EXPECT_EQ(sim->getFES()->getLength(), 0);
+
+  sim->getFES()->clear();
+  delete mockHardwareMonitor;
+  delete mockRealtimeController;
+}
+
+TEST(RuleEnginePhotonShootingTest, EmitPhotonPulsesOfTemporalModes) {
+  auto* sim = prepareSimulation();
+  auto* mockHardwareMonitor = new MockHardwareMonitor;
+  auto* mockRealtimeController = new MockRealTimeController;
+  int qnic_index = 1;
+
+  // Emitter QNIC1 has 5 qubits, the memory slots of two pulses of 3 modes
+  std::vector<QNicSpec> qnic_specs = {
+      {QNIC_E, 0, 2},
+      {QNIC_E, 1, 5},
+      {QNIC_E, 2, 2},
+      {QNIC_R, 0, 1},
+  };
+  auto rule_engine = new RuleEngineTestTarget{mockHardwareMonitor, qnic_specs, mockRealtimeController};
+  setParInt(rule_engine, "temporal_modes", 3);
+
+  sim->registerComponent(rule_engine);
+  rule_engine->callInitialize();
+  sim->setContext(rule_engine);
+
+  auto* pk = new EmitPhotonRequest();
+  pk->setQnicType(QNIC_E);
+  pk->setQnicIndex(qnic_index);
+  pk->setFirst(true);
+  pk->setIntervalBetweenPhotons(0.0001);
+
+  EXPECT_CALL(*mockRealtimeController, EmitPhotonPulse(qnic_index, std::vector<int>({0, 1, 2}), QNIC_E, SimTime(0.0001), STATIONARYQUBIT_PULSE_BEGIN));
+  rule_engine->handleMessage(pk);
+  EXPECT_EQ(sim->getFES()->getLength(), 1);
+  EXPECT_TRUE(pk->isScheduled());
+  // the next pulse starts after the time bins of this one
+  EXPECT_EQ(pk->getArrivalTime(), SimTime(0.0003));
+  EXPECT_EQ(rule_engine->getNumFreeQubitsInQnic(QNIC_E, qnic_index), 2);
+
+  // the last pulse has the modes left
+  EXPECT_CALL(*mockRealtimeController, EmitPhotonPulse(qnic_index, std::vector<int>({3, 4}), QNIC_E, SimTime(0.0001), STATIONARYQUBIT_PULSE_END));
+  sim->executeNextEvent();
+  EXPECT_EQ(rule_engine->getNumFreeQubitsInQnic(QNIC_E, qnic_index), 0);
+  EXPECT_EQ(sim->getFES()->getLength(), 0);
+
+  sim->getFES()->clear();
+  delete mockHardwareMonitor;
+  delete mockRealtimeController;
+}
+
 TEST(RuleEnginePhotonShootingTest, EmitPhotonWithThreeFreeQubits) {
   auto* sim = prepareSimulation();
   auto* mockHardwareMonitor = new MockHardwareMonitor;
@@ -1,3 +1,4 @@
+#include <limits>
 #include <memory>
 #include <utility>
 
@@ -7,6 +8,7 @@
 
 #include "BellPairStore/BellPairStore.h"
 #include "IRuleEngine.h"
+#include "QubitRecord/PauliFrame.h"
 #include "QubitRecord/QubitRecord.h"
 #include "RuleEngine.h"
 #include "messages/purification_messages_m.h"
@@ -75,21 +77,62 @@ class Strategy : public quisp_test::TestComponentProviderStrategy {
 
 class RuleEngineTestTarget : public quisp::modules::RuleEngine {
  public:
+  using quisp::modules::RuleEngine::bell_pair_store;
+  using quisp::modules::RuleEngine::handleEmitPhotonRequest;
+  using quisp::modules::RuleEngine::handleEPPSTimingNotification;
+  using quisp::modules::RuleEngine::handleMSMResultBatch;
   using quisp::modules::RuleEngine::handlePurificationResult;
+  using quisp::modules::RuleEngine::msm_info_map;
+  using quisp::modules::RuleEngine::num_discarded_bell_pairs;
+  using quisp::modules::RuleEngine::scheduleCutoff;
+  using quisp::modules::RuleEngine::QubitInfo;
   using quisp::modules::RuleEngine::handleSwappingResult;
+  using quisp::modules::RuleEngine::handleSwappingResultBatch;
+  using quisp::modules::RuleEngine::pending_swapping_results;
+  using quisp::modules::RuleEngine::sendSwappingResult;
   using quisp::modules::RuleEngine::initialize;
+  using quisp::modules::RuleEngine::isEmissionIdle;
+  using quisp::modules::RuleEngine::message_dispatcher;
   using quisp::modules::RuleEngine::par;
+  using quisp::modules::RuleEngine::qnic_neighbors;
   using quisp::modules::RuleEngine::qnic_store;
+  using quisp::modules::RuleEngine::qos_allocation;
+  using quisp::modules::RuleEngine::qos_classes;
+  using quisp::modules::RuleEngine::ruleset_qubit_quota;
   using quisp::modules::RuleEngine::runtimes;
 
   RuleEngineTestTarget(IStationaryQubit* mockQubit, MockRoutingDaemon* routingdaemon, MockHardwareMonitor* hardware_monitor, MockRealTimeController* realtime_controller,
                        std::vector<QNicSpec> qnic_specs = {})
-      : quisp::modules::RuleEngine() {
+      : quisp::modules::RuleEngine(), router_port(new TestGate(this, "RouterPort$o")) {
     setParInt(this, "address", 2);
     setParInt(this, "number_of_qnics_rp", 0);
     setParInt(this, "number_of_qnics_r", 1);
     setParInt(this, "number_of_qnics", 1);
     setParInt(this, "total_number_of_qnics", 2);
+    setParBool(this, "profile_runtime", false);
+    setParStr(this, "runtime_trace", "");
+    setParBool(this, "record_summaries", true);
+    setParInt(this, "ruleset_qubit_quota", 0);
+    setParBool(this, "qos_allocation", false);
+    setParInt(this, "ruleset_action_budget", 0);
+    setParStr(this, "memory_resource", "global");
+    setParBool(this, "pool_messages", true);
+    setParBool(this, "fast_link_layer", false);
+    setParBool(this, "demand_driven_emission", false);
+    setParBool(this, "batch_swapping_results", false);
+    setParBool(this, "pauli_frame_tracking", false);
+    setParBool(this, "coalesce_events", false);
+    setParStr(this, "link_trace_record_filename", "");
+    setParStr(this, "link_trace_replay_filename", "");
+    setParBool(this, "warm_start", false);
+    setParDouble(this, "warm_start_fidelity", 1);
+    setParBool(this, "photon_train_messages", false);
+    setParInt(this, "temporal_modes", 1);
+    setParInt(this, "msm_result_window", 1);
+    setParDouble(this, "bell_pair_cutoff_time", 0);
+    setParDouble(this, "cutoff_timer_resolution", 1e-6);
+    setParDouble(this, "occupancy_report_interval", 0);
+    setParStr(this, "qubit_selection_policy", "assigned_order");
     setName("rule_engine_test_target");
     provider.setStrategy(std::make_unique<Strategy>(mockQubit, routingdaemon, hardware_monitor, realtime_controller, qnic_specs));
     setComponentType(new TestModuleType("rule_engine_test"));
@@ -97,6 +140,11 @@ class RuleEngineTestTarget : public quisp::modules::RuleEngine {
   }
   // setter function for allResorces[qnic_type][qnic_index]
   void setAllResources(int partner_addr, IQubitRecord* qubit) { this->bell_pair_store.insertEntangledQubit(partner_addr, qubit); };
+  cGate* gate(const char* gatename, int index = -1) override {
+    if (strcmp(gatename, "RouterPort$o") == 0) return router_port;
+    return quisp::modules::RuleEngine::gate(gatename, index);
+  }
+  TestGate* router_port;
 
  private:
   FRIEND_TEST(RuleEngineTest, ESResourceUpdate);
@@ -152,10 +200,238 @@ TEST_F(RuleEngineTest, resourceAllocation) {
 
   // resource allocation assigns a corresponding qubit to action's resource
   auto& rt = rule_engine->runtimes.at(0);
-  EXPECT_EQ(rt.ruleset.rules.size(), 1);
+  EXPECT_EQ(rt.ruleset->rules.size(), 1);
   EXPECT_EQ(rt.qubits.size(), 1);
 }
 
+TEST_F(RuleEngineTest, MSMResultBatch) {
+  auto logger = std::make_unique<DisabledLogger>();
+  auto* qubit_record = new QubitRecord(QNIC_RP, 0, 7, logger.get());
+  auto rule_engine = new RuleEngineTestTarget{nullptr, routing_daemon, hardware_monitor, realtime_controller, qnic_specs};
+  sim->registerComponent(rule_engine);
+  rule_engine->callInitialize();
+  auto& msm_info = rule_engine->msm_info_map[0];
+  msm_info.partner_address = 5;
+  // the photons 3 and 5 clicked here; the partner reports the photons 3 to 6 in one batch
+  msm_info.qubit_postprocess_info.insert(3, RuleEngineTestTarget::QubitInfo{7, PauliOperator::X});
+  msm_info.qubit_postprocess_info.insert(5, RuleEngineTestTarget::QubitInfo{8, PauliOperator::X});
+
+  auto* batch = new quisp::messages::MSMResultBatch;
+  batch->setQnicIndex(0);
+  batch->setFirstPhotonIndex(3);
+  batch->setNumPhotons(4);
+  CompactClickResults successes;
+  successes.append(0, PauliOperator::Y);
+  successes.append(3, PauliOperator::X);
+  batch->setSuccesses(successes);
+
+  auto* qnic_store = dynamic_cast<MockQNicStore*>(rule_engine->qnic_store.get());
+  // photon 3: both succeeded in Phi-, and this node has the younger address
+  EXPECT_CALL(*qnic_store, getQubitRecord(QNIC_RP, 0, 7)).WillOnce(Return(qubit_record));
+  EXPECT_CALL(*realtime_controller, applyZGate(qubit_record)).Times(1);
+  // photon 5: the partner failed
+  EXPECT_CALL(*realtime_controller, ReInitialize_StationaryQubits(0, std::vector<int>{8}, QNIC_RP, false)).Times(1);
+  EXPECT_CALL(*qnic_store, setQubitBusy(QNIC_RP, 0, 8, false)).Times(1);
+  rule_engine->handleMSMResultBatch(batch);
+
+  EXPECT_EQ(rule_engine->bell_pair_store.findQubit(QNIC_RP, 0, 5), qubit_record);
+  EXPECT_EQ(msm_info.qubit_postprocess_info.size(), 0);
+  delete batch;
+}
+
+TEST_F(RuleEngineTest, reportMemoryExhaustedOncePerTimingNotification) {
+  auto* rule_engine = new RuleEngineTestTarget{nullptr, routing_daemon, hardware_monitor, realtime_controller, qnic_specs};
+  setParInt(rule_engine, "number_of_qnics_rp", 1);
+  sim->registerComponent(rule_engine);
+  rule_engine->callInitialize();
+  sim->setContext(rule_engine);
+  auto* qnic_store = dynamic_cast<MockQNicStore*>(rule_engine->qnic_store.get());
+  // no free qubit for any photon of the EPPS
+  EXPECT_CALL(*qnic_store, countNumFreeQubits(QNIC_RP, 0)).WillRepeatedly(Return(0));
+  EXPECT_CALL(*qnic_store, takeFreeQubitIndex(QNIC_RP, 0)).WillRepeatedly(Return(-1));
+  auto notify = [&]() {
+    auto* notification = new quisp::messages::EPPSTimingNotification;
+    notification->setQnicIndex(0);
+    notification->setOtherQnicParentAddr(5);
+    notification->setEPPSAddr(10);
+    notification->setFirstPhotonEmitTime(simTime() + 1);
+    notification->setInterval(1e-6);
+    notification->setBackpressure(true);
+    rule_engine->handleEPPSTimingNotification(notification);
+    delete notification;
+  };
+  auto emitPhoton = [&]() {
+    auto* request = new quisp::messages::EmitPhotonRequest;
+    request->setQnicType(QNIC_RP);
+    request->setQnicIndex(0);
+    request->setMSM(true);
+    request->setIntervalBetweenPhotons(1e-6);
+    rule_engine->handleEmitPhotonRequest(request);
+  };
+  auto countExhausted = [&]() {
+    int count = 0;
+    for (auto* msg : rule_engine->router_port->messages) {
+      if (auto* exhausted = dynamic_cast<quisp::messages::MSMMemoryExhausted*>(msg)) {
+        EXPECT_EQ(exhausted->getDestAddr(), 10);
+        count++;
+      }
+    }
+    return count;
+  };
+
+  notify();
+  emitPhoton();
+  emitPhoton();
+  EXPECT_EQ(countExhausted(), 1);
+  EXPECT_TRUE(rule_engine->msm_info_map[0].memory_exhausted_sent);
+
+  // the EPPS resumes the emission with a new notification
+  notify();
+  EXPECT_FALSE(rule_engine->msm_info_map[0].memory_exhausted_sent);
+  emitPhoton();
+  EXPECT_EQ(countExhausted(), 2);
+}
+
+TEST_F(RuleEngineTest, trackPauliCorrectionsInTheFrame) {
+  auto logger = std::make_unique<DisabledLogger>();
+  auto* qubit_record = new QubitRecord(QNIC_RP, 0, 7, logger.get());
+  auto rule_engine = new RuleEngineTestTarget{nullptr, routing_daemon, hardware_monitor, realtime_controller, qnic_specs};
+  setParBool(rule_engine, "pauli_frame_tracking", true);
+  sim->registerComponent(rule_engine);
+  rule_engine->callInitialize();
+  auto& msm_info = rule_engine->msm_info_map[0];
+  msm_info.partner_address = 5;
+  msm_info.qubit_postprocess_info.insert(3, RuleEngineTestTarget::QubitInfo{7, PauliOperator::X});
+
+  auto* batch = new quisp::messages::MSMResultBatch;
+  batch->setQnicIndex(0);
+  batch->setFirstPhotonIndex(3);
+  batch->setNumPhotons(1);
+  CompactClickResults successes;
+  successes.append(0, PauliOperator::Y);
+  batch->setSuccesses(successes);
+
+  auto* qnic_store = dynamic_cast<MockQNicStore*>(rule_engine->qnic_store.get());
+  EXPECT_CALL(*qnic_store, getQubitRecord(QNIC_RP, 0, 7)).WillOnce(Return(qubit_record));
+  // the Phi- correction goes to the frame instead of the gate
+  EXPECT_CALL(*realtime_controller, applyZGate(qubit_record)).Times(0);
+  rule_engine->handleMSMResultBatch(batch);
+  EXPECT_EQ(qubit_record->getPauliFrame(), quisp::modules::qubit_record::pauli_frame::Z);
+  delete batch;
+}
+
+TEST_F(RuleEngineTest, swappingResultBatch) {
+  auto rule_engine = new RuleEngineTestTarget{nullptr, routing_daemon, hardware_monitor, realtime_controller, qnic_specs};
+  sim->registerComponent(rule_engine);
+  rule_engine->callInitialize();
+  Program empty{"empty", {}};
+  auto rs = quisp::runtime::RuleSet{"test rs", {quisp::runtime::Rule{"wait swapping", -1, 7, empty, empty}}};
+  rs.id = 42;
+  auto* runtime = rule_engine->runtimes.acceptRuleSet(rs);
+
+  auto* batch = new quisp::messages::SwappingResultBatch;
+  batch->setRulesetId(42);
+  batch->appendResult({7, 0, 1, 5});
+  batch->appendResult({7, 1, 3, 5});
+  // no rule receives the tag
+  batch->appendResult({8, 2, 0, 5});
+  rule_engine->handleSwappingResultBatch(batch);
+  EXPECT_EQ(runtime->messages.size(), 2);
+  delete batch;
+}
+
+TEST_F(RuleEngineTest, batchSwappingResultsByPartnerAndRuleSet) {
+  auto rule_engine = new RuleEngineTestTarget{nullptr, routing_daemon, hardware_monitor, realtime_controller, qnic_specs};
+  setParBool(rule_engine, "batch_swapping_results", true);
+  sim->registerComponent(rule_engine);
+  rule_engine->callInitialize();
+  rule_engine->sendSwappingResult(1, 5, {7, 0, 1, 3});
+  rule_engine->sendSwappingResult(1, 3, {7, 0, 1, 5});
+  rule_engine->sendSwappingResult(1, 5, {7, 1, 2, 3});
+  rule_engine->sendSwappingResult(2, 5, {9, 0, 0, 3});
+  auto& batches = rule_engine->pending_swapping_results;
+  ASSERT_EQ(batches.size(), 3);
+  EXPECT_EQ(batches[0]->getDestAddr(), 5);
+  EXPECT_EQ(batches[0]->getRulesetId(), 1);
+  ASSERT_EQ(batches[0]->getNumResults(), 2);
+  EXPECT_EQ(batches[0]->getResult(1).sequence_number, 1);
+  EXPECT_EQ(batches[0]->getResult(1).correction_frame, 2);
+  EXPECT_EQ(batches[1]->getDestAddr(), 3);
+  EXPECT_EQ(batches[2]->getRulesetId(), 2);
+  for (auto* batch : batches) delete batch;
+  batches.clear();
+}
+
+TEST_F(RuleEngineTest, resourceAllocationWithQuota) {
+  auto logger = std::make_unique<DisabledLogger>();
+  auto* qubit_record0 = new QubitRecord(QNIC_E, 3, 0, logger.get());
+  auto* qubit_record1 = new QubitRecord(QNIC_E, 3, 1, logger.get());
+  auto* qubit_record2 = new QubitRecord(QNIC_E, 3, 2, logger.get());
+  auto rule_engine = new RuleEngineTestTarget{nullptr, routing_daemon, hardware_monitor, nullptr, qnic_specs};
+  sim->registerComponent(rule_engine);
+  rule_engine->callInitialize();
+  rule_engine->ruleset_qubit_quota = 1;
+  rule_engine->setAllResources(1, qubit_record0);
+  rule_engine->setAllResources(1, qubit_record1);
+  rule_engine->setAllResources(1, qubit_record2);
+  int q0 = 0;
+  QNodeAddr partner_addr{1};
+  Program test_action{"testAction", {quisp::runtime::INSTR_GET_QUBIT_QubitId_QNodeAddr_int_{{q0, partner_addr, 0}}}};
+  Program empty_condition{"emptyCondition", {}};
+  auto rs1 = quisp::runtime::RuleSet{"test rs1", {quisp::runtime::Rule{"test", -1, -1, empty_condition, test_action}}};
+  auto rs2 = quisp::runtime::RuleSet{"test rs2", {quisp::runtime::Rule{"test", -1, -1, empty_condition, test_action}}};
+  rs1.id = 1;
+  rs2.id = 2;
+  rule_engine->runtimes.acceptRuleSet(rs1);
+  rule_engine->runtimes.acceptRuleSet(rs2);
+
+  // each RuleSet takes one qubit, the last one waits until a RuleSet frees its quota
+  rule_engine->ResourceAllocation(QNIC_E, 3);
+  EXPECT_EQ(rule_engine->runtimes.at(0).qubits.size(), 1);
+  EXPECT_EQ(rule_engine->runtimes.at(1).qubits.size(), 1);
+  EXPECT_TRUE(qubit_record0->isAllocated());
+  EXPECT_TRUE(qubit_record1->isAllocated());
+  EXPECT_FALSE(qubit_record2->isAllocated());
+
+  rule_engine->ruleset_qubit_quota = 0;
+  rule_engine->ResourceAllocation(QNIC_E, 3);
+  EXPECT_TRUE(qubit_record2->isAllocated());
+  EXPECT_EQ(rule_engine->runtimes.at(0).qubits.size(), 2);
+}
+
+TEST_F(RuleEngineTest, resourceAllocationByQosClass) {
+  auto logger = std::make_unique<DisabledLogger>();
+  auto* qubit_record0 = new QubitRecord(QNIC_E, 3, 0, logger.get());
+  auto* qubit_record1 = new QubitRecord(QNIC_E, 3, 1, logger.get());
+  auto* qubit_record2 = new QubitRecord(QNIC_E, 3, 2, logger.get());
+  auto rule_engine = new RuleEngineTestTarget{nullptr, routing_daemon, hardware_monitor, nullptr, qnic_specs};
+  sim->registerComponent(rule_engine);
+  rule_engine->callInitialize();
+  rule_engine->qos_allocation = true;
+  rule_engine->setAllResources(1, qubit_record0);
+  rule_engine->setAllResources(1, qubit_record1);
+  rule_engine->setAllResources(1, qubit_record2);
+  int q0 = 0;
+  QNodeAddr partner_addr{1};
+  Program test_action{"testAction", {quisp::runtime::INSTR_GET_QUBIT_QubitId_QNodeAddr_int_{{q0, partner_addr, 0}}}};
+  Program empty_condition{"emptyCondition", {}};
+  auto bulk = quisp::runtime::RuleSet{"bulk", {quisp::runtime::Rule{"test", -1, -1, empty_condition, test_action}}};
+  auto latency_sensitive = quisp::runtime::RuleSet{"latency sensitive", {quisp::runtime::Rule{"test", -1, -1, empty_condition, test_action}}};
+  bulk.id = 1;
+  latency_sensitive.id = 2;
+  latency_sensitive.qos_priority = 5;
+  rule_engine->runtimes.acceptRuleSet(bulk);
+  rule_engine->runtimes.acceptRuleSet(latency_sensitive);
+
+  // the later RuleSet of the higher priority takes the pairs ahead of the first one
+  rule_engine->ResourceAllocation(QNIC_E, 3);
+  EXPECT_EQ(rule_engine->runtimes.at(0).qubits.size(), 0);
+  EXPECT_EQ(rule_engine->runtimes.at(1).qubits.size(), 3);
+  ASSERT_EQ(rule_engine->qos_classes.numClasses(), 2);
+  EXPECT_EQ(rule_engine->qos_classes.priority(1), 5);
+  EXPECT_EQ(rule_engine->qos_classes.numDelivered(1), 3);
+}
+
 TEST_F(RuleEngineTest, freeConsumedResource) {
   auto* rule_engine = new RuleEngineTestTarget{nullptr, routing_daemon, hardware_monitor, realtime_controller};
   sim->registerComponent(rule_engine);
@@ -175,4 +451,134 @@ TEST_F(RuleEngineTest, freeConsumedResource) {
   delete rule_engine->qnic_store.get();
 }
 
+TEST_F(RuleEngineTest, acceptForwardedCompiledRuleSet) {
+  auto* rule_engine = new RuleEngineTestTarget{nullptr, routing_daemon, hardware_monitor, realtime_controller};
+  sim->registerComponent(rule_engine);
+  rule_engine->callInitialize();
+  Program empty{"empty", {}};
+  auto compiled = quisp::runtime::RuleSet{"compiled rs", {quisp::runtime::Rule{"test", -1, -1, empty, empty}}};
+  compiled.id = 3;
+  auto* pkt = new quisp::messages::InternalRuleSetForwarding;
+  pkt->setRuleSet_id(3);
+  pkt->setRuntimeRuleSet(std::make_shared<const quisp::runtime::RuleSet>(compiled));
+
+  // the json RuleSet is empty, so the RuleEngine can only run the compiled one
+  EXPECT_TRUE(rule_engine->message_dispatcher.dispatch(pkt));
+  ASSERT_EQ(rule_engine->runtimes.size(), 1);
+  EXPECT_EQ(rule_engine->runtimes.at(0).ruleset_id, 3);
+  EXPECT_EQ(rule_engine->runtimes.at(0).ruleset->name, "compiled rs");
+  delete pkt;
+}
+
+TEST_F(RuleEngineTest, discardBellPairAtCutoffTime) {
+  auto* qubit = new MockQubit(QNIC_E, 3);
+  qubit->fillParams();
+  auto* rule_engine = new RuleEngineTestTarget{qubit, routing_daemon, hardware_monitor, realtime_controller, qnic_specs};
+  setParDouble(rule_engine, "bell_pair_cutoff_time", 1e-3);
+  sim->registerComponent(rule_engine);
+  rule_engine->callInitialize();
+  auto logger = std::make_unique<DisabledLogger>();
+  auto* qubit_record = new QubitRecord(QNIC_E, 3, 1, logger.get());
+  qubit_record->setBusy(true);
+  rule_engine->setAllResources(5, qubit_record);
+  rule_engine->scheduleCutoff(qubit_record);
+  // the later pairs of the qubit don't restart its cutoff
+  rule_engine->scheduleCutoff(qubit_record);
+  ASSERT_EQ(sim->getFES()->getLength(), 1);
+  EXPECT_EQ(sim->getFES()->peekFirst()->getArrivalTime(), SimTime(1, SIMTIME_MS));
+
+  // no RuleSet took the pair yet, so it's freed without notifying the partner
+  EXPECT_CALL(*realtime_controller, ReInitialize_StationaryQubit(qubit_record, false)).Times(1).WillOnce(Return());
+  EXPECT_CALL(*dynamic_cast<MockQNicStore*>(rule_engine->qnic_store.get()), getQubitRecord(QNIC_E, 3, 1)).Times(1).WillOnce(Return(qubit_record));
+  sim->executeNextEvent();
+  EXPECT_EQ(rule_engine->num_discarded_bell_pairs, 1);
+  EXPECT_FALSE(qubit_record->isBusy());
+  EXPECT_EQ(rule_engine->bell_pair_store.findQubit(QNIC_E, 3, 5), nullptr);
+  EXPECT_EQ(sim->getFES()->getLength(), 0);
+}
+
+TEST_F(RuleEngineTest, coalesceEventsOfTheSameTime) {
+  auto* qubit = new MockQubit(QNIC_E, 3);
+  qubit->fillParams();
+  auto* rule_engine = new RuleEngineTestTarget{qubit, routing_daemon, hardware_monitor, realtime_controller, qnic_specs};
+  setParBool(rule_engine, "coalesce_events", true);
+  setParDouble(rule_engine, "bell_pair_cutoff_time", 1e-3);
+  sim->registerComponent(rule_engine);
+  rule_engine->callInitialize();
+  auto logger = std::make_unique<DisabledLogger>();
+  auto* qubit_record = new QubitRecord(QNIC_E, 3, 1, logger.get());
+  qubit_record->setBusy(true);
+  rule_engine->setAllResources(5, qubit_record);
+  rule_engine->scheduleCutoff(qubit_record);
+
+  EXPECT_CALL(*realtime_controller, ReInitialize_StationaryQubit(qubit_record, false)).Times(1).WillOnce(Return());
+  EXPECT_CALL(*dynamic_cast<MockQNicStore*>(rule_engine->qnic_store.get()), getQubitRecord(QNIC_E, 3, 1)).Times(1).WillOnce(Return(qubit_record));
+  sim->executeNextEvent();
+  EXPECT_EQ(rule_engine->num_discarded_bell_pairs, 1);
+  // the allocation and execution pass of the time comes after the cutoff
+  ASSERT_EQ(sim->getFES()->getLength(), 1);
+  EXPECT_EQ(sim->getFES()->peekFirst()->getArrivalTime(), SimTime(1, SIMTIME_MS));
+  EXPECT_EQ(sim->getFES()->peekFirst()->getSchedulingPriority(), std::numeric_limits<short>::max());
+  sim->executeNextEvent();
+  EXPECT_EQ(sim->getFES()->getLength(), 0);
+}
+
+TEST_F(RuleEngineTest, reclaimQubitsOfTerminatedRuleSet) {
+  auto* qubit = new MockQubit(QNIC_E, 3);
+  qubit->fillParams();
+  auto* rule_engine = new RuleEngineTestTarget{qubit, routing_daemon, hardware_monitor, realtime_controller, qnic_specs};
+  sim->registerComponent(rule_engine);
+  rule_engine->callInitialize();
+  auto logger = std::make_unique<DisabledLogger>();
+  auto* qubit_record = new QubitRecord(QNIC_E, 3, 1, logger.get());
+  qubit_record->setBusy(true);
+  rule_engine->setAllResources(5, qubit_record);
+  Program get_qubit{"getQubit", {quisp::runtime::INSTR_GET_QUBIT_QubitId_QNodeAddr_int_{{0, QNodeAddr{5}, 0}}}};
+  Program empty_condition{"emptyCondition", {}};
+  // the rule doesn't share a tag with the partner, so the partner isn't notified
+  auto rs = quisp::runtime::RuleSet{"test rs", {quisp::runtime::Rule{"test", -1, -1, empty_condition, get_qubit}}};
+  auto* runtime = rule_engine->runtimes.acceptRuleSet(rs);
+  rule_engine->ResourceAllocation(QNIC_E, 3);
+  ASSERT_EQ(runtime->qubits.size(), 1);
+
+  runtime->terminate();
+  // a terminated RuleSet doesn't take the new pairs
+  auto* qubit_record2 = new QubitRecord(QNIC_E, 3, 2, logger.get());
+  rule_engine->setAllResources(5, qubit_record2);
+  rule_engine->ResourceAllocation(QNIC_E, 3);
+  EXPECT_FALSE(qubit_record2->isAllocated());
+
+  // the qubits of the RuleSet are reinitialized in one batch
+  EXPECT_CALL(*realtime_controller, ReInitialize_StationaryQubits(std::vector<IQubitRecord*>{qubit_record}, false)).Times(1).WillOnce(Return());
+  rule_engine->runtimes.exec();
+  EXPECT_EQ(rule_engine->runtimes.size(), 0);
+  EXPECT_EQ(rule_engine->runtimes.numReclaimedQubits(), 1);
+  EXPECT_FALSE(qubit_record->isBusy());
+  EXPECT_FALSE(qubit_record->isAllocated());
+  EXPECT_EQ(rule_engine->bell_pair_store.findQubit(QNIC_E, 3, 5), qubit_record2);
+}
+
+TEST_F(RuleEngineTest, idleEmissionWithoutRuleSetOfNeighbor) {
+  auto* rule_engine = new RuleEngineTestTarget{nullptr, routing_daemon, hardware_monitor, realtime_controller, qnic_specs};
+  setParBool(rule_engine, "demand_driven_emission", true);
+  sim->registerComponent(rule_engine);
+  rule_engine->callInitialize();
+  // the neighbor isn't known before the first results of the BSA
+  EXPECT_FALSE(rule_engine->isEmissionIdle(QNIC_E, 0));
+  rule_engine->qnic_neighbors[{QNIC_E, 0}] = 5;
+  EXPECT_TRUE(rule_engine->isEmissionIdle(QNIC_E, 0));
+
+  Program get_qubit{"getQubit", {quisp::runtime::INSTR_GET_QUBIT_QubitId_QNodeAddr_int_{{0, QNodeAddr{5}, 0}}}};
+  Program empty_condition{"emptyCondition", {}};
+  auto rs = quisp::runtime::RuleSet{"test rs", {quisp::runtime::Rule{"test", -1, -1, empty_condition, get_qubit}}};
+  auto* runtime = rule_engine->runtimes.acceptRuleSet(rs);
+  EXPECT_FALSE(rule_engine->isEmissionIdle(QNIC_E, 0));
+  // the other qnic goes to another neighbor
+  rule_engine->qnic_neighbors[{QNIC_R, 0}] = 6;
+  EXPECT_TRUE(rule_engine->isEmissionIdle(QNIC_R, 0));
+
+  runtime->terminate();
+  EXPECT_TRUE(rule_engine->isEmissionIdle(QNIC_E, 0));
+}
+
 }  // namespace
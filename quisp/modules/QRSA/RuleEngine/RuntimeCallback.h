@@ -8,10 +8,14 @@
 #include <runtime/Runtime.h>
 #include <runtime/types.h>
 #include <utils/ComponentProvider.h>
+#include <utils/Headless.h>
 
 #include "RuleEngine.h"
+#include "modules/Common/Router.h"
 #include "modules/QNIC/StationaryQubit/IStationaryQubit.h"
 #include "modules/QRSA/RuleEngine/QubitRecord/IQubitRecord.h"
+#include "modules/QRSA/RuleEngine/QubitRecord/PauliFrame.h"
+#include "modules/SharedResource/ConnectionMetrics.h"
 
 namespace quisp::modules::runtime_callback {
 
@@ -19,85 +23,134 @@ using namespace quisp::runtime;
 using quisp::modules::RuleEngine;
 using quisp::runtime::QNodeAddr;
 using namespace quisp::messages;
+namespace pauli_frame = quisp::modules::qubit_record::pauli_frame;
 
 struct RuntimeCallback : public quisp::runtime::Runtime::ICallBack {
   RuntimeCallback(RuleEngine *re) : rule_engine(re), provider(re->provider) {}
 
+  // the corrections in the Pauli frames of the qubit records flip the outcomes instead of being applied, see RuleEngine::pauli_frame_tracking
   MeasurementOutcome measureQubitRandomly(IQubitRecord *qubit_rec) override {
     auto qubit = provider.getStationaryQubit(qubit_rec);
-    return qubit->measureRandomPauliBasis();
+    return unframed(qubit_rec, qubit->measureRandomPauliBasis());
   }
 
   MeasurementOutcome measureQubitX(IQubitRecord *qubit_rec) override {
     auto qubit = provider.getStationaryQubit(qubit_rec);
-    return MeasurementOutcome{.basis = 'X', .outcome_is_plus = qubit->measureX() == types::EigenvalueResult::PLUS_ONE};
+    return unframed(qubit_rec, MeasurementOutcome{.basis = 'X', .outcome_is_plus = qubit->measureX() == types::EigenvalueResult::PLUS_ONE});
   }
 
   MeasurementOutcome measureQubitZ(IQubitRecord *qubit_rec) override {
     auto qubit = provider.getStationaryQubit(qubit_rec);
-    return MeasurementOutcome{.basis = 'Z', .outcome_is_plus = qubit->measureZ() == types::EigenvalueResult::PLUS_ONE};
+    return unframed(qubit_rec, MeasurementOutcome{.basis = 'Z', .outcome_is_plus = qubit->measureZ() == types::EigenvalueResult::PLUS_ONE});
   }
 
   MeasurementOutcome measureQubitY(IQubitRecord *qubit_rec) override {
     auto qubit = provider.getStationaryQubit(qubit_rec);
-    return MeasurementOutcome{.basis = 'Y', .outcome_is_plus = qubit->measureY() == types::EigenvalueResult::PLUS_ONE};
+    return unframed(qubit_rec, MeasurementOutcome{.basis = 'Y', .outcome_is_plus = qubit->measureY() == types::EigenvalueResult::PLUS_ONE});
+  }
+
+  MeasurementOutcome unframed(IQubitRecord *qubit_rec, MeasurementOutcome outcome) {
+    if (pauli_frame::flipsMeasurement(qubit_rec->getPauliFrame(), outcome.basis)) outcome.outcome_is_plus = !outcome.outcome_is_plus;
+    return outcome;
+  }
+
+  // adds the gate to the Pauli frame of the qubit instead of applying it, with pauli_frame_tracking
+  bool trackPauli(IQubitRecord *qubit_rec, int pauli) {
+    if (!rule_engine->pauli_frame_tracking) return false;
+    qubit_rec->setPauliFrame(qubit_rec->getPauliFrame() ^ pauli);
+    return true;
   }
 
   void gateX(IQubitRecord *qubit_rec) override {
+    if (trackPauli(qubit_rec, pauli_frame::X)) return;
     auto *qubit = provider.getStationaryQubit(qubit_rec);
     assert(qubit != nullptr);
     qubit->gateX();
   }
 
   void gateZ(IQubitRecord *qubit_rec) override {
+    if (trackPauli(qubit_rec, pauli_frame::Z)) return;
     auto *qubit = provider.getStationaryQubit(qubit_rec);
     assert(qubit != nullptr);
     qubit->gateZ();
   }
 
   void gateY(IQubitRecord *qubit_rec) override {
+    if (trackPauli(qubit_rec, pauli_frame::Y)) return;
     auto *qubit = provider.getStationaryQubit(qubit_rec);
     assert(qubit != nullptr);
     qubit->gateY();
   }
 
+  // applies the tracked correction to the qubit before an operation the frame can't pass through
+  void applyPauliFrame(IQubitRecord *qubit_rec, IStationaryQubit *qubit) {
+    auto frame = qubit_rec->getPauliFrame();
+    if (frame == pauli_frame::I) return;
+    if (frame == pauli_frame::X) qubit->gateX();
+    if (frame == pauli_frame::Z) qubit->gateZ();
+    if (frame == pauli_frame::Y) qubit->gateY();
+    qubit_rec->setPauliFrame(pauli_frame::I);
+  }
+
   void gateCNOT(IQubitRecord *control_qubit_rec, IQubitRecord *target_qubit_rec) override {
     auto *control_qubit = provider.getStationaryQubit(control_qubit_rec);
     auto *target_qubit = provider.getStationaryQubit(target_qubit_rec);
     assert(control_qubit != nullptr);
     assert(target_qubit != nullptr);
     control_qubit->gateCNOT(target_qubit);
+    int control_frame = control_qubit_rec->getPauliFrame(), target_frame = target_qubit_rec->getPauliFrame();
+    if (control_frame == pauli_frame::I && target_frame == pauli_frame::I) return;
+    pauli_frame::conjugateCNOT(control_frame, target_frame);
+    control_qubit_rec->setPauliFrame(control_frame);
+    target_qubit_rec->setPauliFrame(target_frame);
   }
 
-  int purifyX(IQubitRecord *qubit_rec, IQubitRecord *trash_qubit_rec) override {
-    auto *qubit = provider.getStationaryQubit(qubit_rec);
-    auto *trash_qubit = provider.getStationaryQubit(trash_qubit_rec);
-    assert(qubit != nullptr);
-    assert(trash_qubit != nullptr);
-    qubit->gateCNOT(trash_qubit);
-    return trash_qubit->measureZ() == types::EigenvalueResult::PLUS_ONE ? 0 : 1;
-  }
+  int purifyX(IQubitRecord *qubit_rec, IQubitRecord *trash_qubit_rec) override { return purify(qubit_rec, trash_qubit_rec, types::PurificationBasis::X); }
+
+  int purifyZ(IQubitRecord *qubit_rec, IQubitRecord *trash_qubit_rec) override { return purify(qubit_rec, trash_qubit_rec, types::PurificationBasis::Z); }
+
+  int purifyY(IQubitRecord *qubit_rec, IQubitRecord *trash_qubit_rec) override { return purify(qubit_rec, trash_qubit_rec, types::PurificationBasis::Y); }
 
-  int purifyZ(IQubitRecord *qubit_rec, IQubitRecord *trash_qubit_rec) override {
+  int purify(IQubitRecord *qubit_rec, IQubitRecord *trash_qubit_rec, types::PurificationBasis basis) {
     auto *qubit = provider.getStationaryQubit(qubit_rec);
     auto *trash_qubit = provider.getStationaryQubit(trash_qubit_rec);
     assert(qubit != nullptr);
     assert(trash_qubit != nullptr);
-    trash_qubit->gateCNOT(qubit);
-    return trash_qubit->measureX() == types::EigenvalueResult::PLUS_ONE ? 0 : 1;
+    applyPauliFrame(qubit_rec, qubit);
+    applyPauliFrame(trash_qubit_rec, trash_qubit);
+    return qubit->purify(trash_qubit, basis) == types::EigenvalueResult::PLUS_ONE ? 0 : 1;
   }
 
-  int purifyY(IQubitRecord *qubit_rec, IQubitRecord *trash_qubit_rec) override {
-    auto *qubit = provider.getStationaryQubit(qubit_rec);
-    auto *trash_qubit = provider.getStationaryQubit(trash_qubit_rec);
-    assert(qubit != nullptr);
-    assert(trash_qubit != nullptr);
+  // hands the whole batch to the backend in one call
+  void purify(Basis basis, const std::vector<IQubitRecord *> &qubit_recs, const std::vector<IQubitRecord *> &trash_qubit_recs, Bitset &results) override {
+    batch_qubits.clear();
+    batch_trash_qubits.clear();
+    for (std::size_t i = 0; i < qubit_recs.size(); i++) {
+      auto *qubit = provider.getStationaryQubit(qubit_recs[i]);
+      auto *trash_qubit = provider.getStationaryQubit(trash_qubit_recs[i]);
+      assert(qubit != nullptr);
+      assert(trash_qubit != nullptr);
+      applyPauliFrame(qubit_recs[i], qubit);
+      applyPauliFrame(trash_qubit_recs[i], trash_qubit);
+      batch_qubits.push_back(qubit->getBackendQubitRef());
+      batch_trash_qubits.push_back(trash_qubit->getBackendQubitRef());
+    }
+    auto purification_basis = basis == Basis::X ? types::PurificationBasis::X : basis == Basis::Z ? types::PurificationBasis::Z : types::PurificationBasis::Y;
+    provider.getQuantumBackend()->purify(batch_qubits, batch_trash_qubits, purification_basis, batch_results);
+    for (std::size_t i = 0; i < batch_results.size(); i++) {
+      if (batch_results[i] == types::EigenvalueResult::MINUS_ONE) results.set(i);
+    }
+  }
 
-    trash_qubit->gateSdg();
-    qubit->gateSdg();
-    trash_qubit->gateCNOT(qubit);
-    qubit->gateS();
-    return trash_qubit->measureX() == types::EigenvalueResult::PLUS_ONE ? 0 : 1;
+  int bellMeasure(IQubitRecord *control_qubit_rec, IQubitRecord *target_qubit_rec) override {
+    auto *control_qubit = provider.getStationaryQubit(control_qubit_rec);
+    auto *target_qubit = provider.getStationaryQubit(target_qubit_rec);
+    assert(control_qubit != nullptr);
+    assert(target_qubit != nullptr);
+    auto result = control_qubit->bellMeasure(target_qubit);
+    int outcome = (result.x_result == types::EigenvalueResult::PLUS_ONE ? 0 : 1) | (result.z_result == types::EigenvalueResult::PLUS_ONE ? 0 : 2);
+    // the frames of the measured pair go on as the correction of the swapped one
+    return outcome ^ pauli_frame::bellMeasureFlips(control_qubit_rec->getPauliFrame(), target_qubit_rec->getPauliFrame());
   }
 
   void sendLinkTomographyResult(const unsigned long ruleset_id, const runtime::Rule &rule, const int action_index, const runtime::QNodeAddr partner_addr, int count,
@@ -112,6 +165,7 @@ struct RuntimeCallback : public quisp::runtime::Runtime::ICallBack {
     pk->setOutput_is_plus(outcome.outcome_is_plus);
     pk->setBasis(outcome.basis);
     pk->setGOD_clean(outcome.GOD_clean);
+    pk->setRuleset_id(ruleset_id);
     if (count == max_count) {
       pk->setFinish(simTime() - start_time);
       pk->setMax_count(max_count);
@@ -121,12 +175,27 @@ struct RuntimeCallback : public quisp::runtime::Runtime::ICallBack {
     pk_for_self->setPartner_address(pk->getDestAddr());
     pk_for_self->setDestAddr(pk->getSrcAddr());
     rule_engine->send(pk, "RouterPort$o");
-    rule_engine->send(pk_for_self, "RouterPort$o");
+    sendToRouter(rule_engine, pk_for_self);
+    emitConnectionEvent(rule_engine->connection_pair_delivered_signal, ruleset_id);
+  }
+
+  void notifyRuleSetTerminated(const unsigned long ruleset_id) override { emitConnectionEvent(rule_engine->connection_terminated_signal, ruleset_id); }
+
+  // the demand of the connection is over as for a terminated RuleSet
+  void notifyRuleSetParked(const unsigned long ruleset_id) override { emitConnectionEvent(rule_engine->connection_terminated_signal, ruleset_id, true); }
+
+  void emitConnectionEvent(simsignal_t signal, const unsigned long ruleset_id, bool parked = false) {
+    if (!rule_engine->mayHaveListeners(signal)) return;
+    SharedResource::ConnectionMetricEvent event;
+    event.ruleset_id = ruleset_id;
+    event.node_addr = rule_engine->parentAddress;
+    event.parked = parked;
+    rule_engine->emit(signal, &event);
   }
 
   void sendPurificationResult(const unsigned long ruleset_id, const QNodeAddr partner_addr, const int shared_rule_tag, const int sequence_number, const int measurement_result,
                               PurType protocol) override {
-    auto *pkt = new PurificationResult{"PurificationResult"};
+    auto *pkt = rule_engine->purification_result_pool.acquire("PurificationResult");
     pkt->setSrcAddr(rule_engine->parentAddress);
     pkt->setDestAddr(partner_addr.val);
     pkt->setKind(7);
@@ -138,21 +207,13 @@ struct RuntimeCallback : public quisp::runtime::Runtime::ICallBack {
     auto *pk_for_self = pkt->dup();
     pk_for_self->setDestAddr(rule_engine->parentAddress);
     rule_engine->send(pkt, "RouterPort$o");
-    rule_engine->send(pk_for_self, "RouterPort$o");
+    // the own result doesn't need to go through the Router, deliver it at the same time.
+    rule_engine->scheduleAt(omnetpp::simTime(), pk_for_self);
   }
 
   void sendSwappingResult(const unsigned long ruleset_id, const QNodeAddr partner_addr, const QNodeAddr new_partner_addr, const int shared_rule_tag, const int sequence_number,
                           const int frame_correction) override {
-    SwappingResult *pkt = new SwappingResult("SwappingResult");
-    pkt->setSrcAddr(rule_engine->parentAddress);
-    pkt->setDestAddr(partner_addr.val);
-    pkt->setRulesetId(ruleset_id);
-    pkt->setSharedRuleTag(shared_rule_tag);
-    pkt->setSequenceNumber(sequence_number);
-    pkt->setKind(5);  // cyan
-    pkt->setCorrectionFrame(frame_correction);
-    pkt->setNewPartner(new_partner_addr.val);
-    rule_engine->send(pkt, "RouterPort$o");
+    rule_engine->sendSwappingResult(ruleset_id, partner_addr.val, SwappingResultEntry{shared_rule_tag, sequence_number, frame_correction, new_partner_addr.val});
   }
 
   void freeAndResetQubit(IQubitRecord *qubit) override {
@@ -160,19 +221,32 @@ struct RuntimeCallback : public quisp::runtime::Runtime::ICallBack {
     rule_engine->freeConsumedResource(qubit->getQNicIndex(), stat_qubit, qubit->getQNicType());
   };
 
-  bool isQubitLocked(IQubitRecord *const qubit_rec) override {
-    auto *qubit = provider.getStationaryQubit(qubit_rec);
-    return qubit->isLocked();
+  // the partners free the other halves as for the Bell pairs past the cutoff
+  void reclaimQubits(const unsigned long ruleset_id, const std::vector<HeldQubit> &qubits) override {
+    reclaimed_qubits.clear();
+    for (auto &held : qubits) reclaimed_qubits.push_back(held.qubit);
+    rule_engine->freeConsumedResources(reclaimed_qubits);
+    for (auto &held : qubits) {
+      // no rule of the partner matches the qubits held past the last rule
+      if (held.shared_rule_tag < 0) continue;
+      auto *discarded = new BellPairDiscarded("BellPairDiscarded");
+      discarded->setSrcAddr(rule_engine->parentAddress);
+      discarded->setDestAddr(held.partner_addr.val);
+      discarded->setRulesetId(ruleset_id);
+      discarded->setSharedRuleTag(held.shared_rule_tag);
+      discarded->setSequenceNumber(held.sequence_number);
+      rule_engine->send(discarded, "RouterPort$o");
+    }
   }
 
+  bool isQubitLocked(IQubitRecord *const qubit_rec) override { return qubit_rec->isLocked(); }
+
   void lockQubit(IQubitRecord *const qubit_rec, unsigned long rs_id, int rule_id, int action_index) override {
-    auto *qubit = provider.getStationaryQubit(qubit_rec);
-    qubit->Lock(rs_id, rule_id, action_index);
-  }
-  int getActionIndex(IQubitRecord *const qubit_rec) override {
-    auto *qubit = provider.getStationaryQubit(qubit_rec);
-    return qubit->action_index;
+    qubit_rec->lock(rs_id, rule_id, action_index);
+    // the StationaryQubit only mirrors the lock for the GUI
+    if (utils::showsGUI(rule_engine)) provider.getStationaryQubit(qubit_rec)->Lock(rs_id, rule_id, action_index);
   }
+  int getActionIndex(IQubitRecord *const qubit_rec) override { return qubit_rec->getActionIndex(); }
 
   std::string getNodeInfo() override {
     std::stringstream ss;
@@ -184,6 +258,12 @@ struct RuntimeCallback : public quisp::runtime::Runtime::ICallBack {
   utils::ComponentProvider &provider;
   int right_qubit_index = -1;
   int left_qubit_index = -1;
+  // reused buffers of the batch purification
+  std::vector<backends::IQubit *> batch_qubits;
+  std::vector<backends::IQubit *> batch_trash_qubits;
+  std::vector<types::EigenvalueResult> batch_results;
+  // reused buffer of the qubits of the terminated RuleSet
+  std::vector<IQubitRecord *> reclaimed_qubits;
 };
 
 }  // namespace quisp::modules::runtime_callback
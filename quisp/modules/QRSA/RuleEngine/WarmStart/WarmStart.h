@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+namespace quisp::modules::warm_start {
+
+/**
+ * @brief the ages of the Bell pairs the buffer of a link holds in the steady state, the freshest first.
+ *
+ * The link makes a pair every sec_per_bell_pair on average as a Poisson process, so the ages are the sums of exponential gaps back from now.
+ * Nothing consumes the pairs before the RuleSets come, so the buffer keeps the capacity freshest pairs, none older than cutoff_time if it's positive.
+ * uniform() returns a uniform random number in [0, 1). Empty for a link that makes no pairs.
+ */
+template <typename Uniform>
+std::vector<double> sampleBellPairAges(double sec_per_bell_pair, int capacity, double cutoff_time, Uniform uniform) {
+  std::vector<double> ages;
+  if (!(sec_per_bell_pair > 0) || !std::isfinite(sec_per_bell_pair) || capacity <= 0) return ages;
+  ages.reserve(capacity);
+  double age = 0;
+  while (static_cast<int>(ages.size()) < capacity) {
+    age -= sec_per_bell_pair * std::log1p(-uniform());
+    if (cutoff_time > 0 && age >= cutoff_time) break;
+    ages.push_back(age);
+  }
+  return ages;
+}
+
+}  // namespace quisp::modules::warm_start
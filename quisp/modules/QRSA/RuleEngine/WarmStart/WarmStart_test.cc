@@ -0,0 +1,42 @@
+#include "WarmStart.h"
+
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+using quisp::modules::warm_start::sampleBellPairAges;
+
+TEST(WarmStartTest, FillsTheBufferWithTheFreshestPairs) {
+  std::mt19937_64 engine{42};
+  auto uniform = [&]() { return std::uniform_real_distribution<double>(0, 1)(engine); };
+  double total_age = 0;
+  for (int i = 0; i < 2000; i++) {
+    auto ages = sampleBellPairAges(1e-3, 10, 0, uniform);
+    ASSERT_EQ(ages.size(), 10);
+    for (std::size_t j = 1; j < ages.size(); j++) ASSERT_GT(ages[j], ages[j - 1]);
+    total_age += ages.back();
+  }
+  // the oldest of the 10 is the sum of 10 gaps
+  EXPECT_NEAR(total_age / 2000, 10e-3, 0.3e-3);
+}
+
+TEST(WarmStartTest, DropsThePairsOlderThanTheCutoff) {
+  std::mt19937_64 engine{42};
+  auto uniform = [&]() { return std::uniform_real_distribution<double>(0, 1)(engine); };
+  double total_pairs = 0;
+  for (int i = 0; i < 2000; i++) {
+    auto ages = sampleBellPairAges(1e-3, 100, 5e-3, uniform);
+    for (auto age : ages) ASSERT_LT(age, 5e-3);
+    total_pairs += ages.size();
+  }
+  // Poisson(5) pairs in the cutoff time
+  EXPECT_NEAR(total_pairs / 2000, 5, 0.15);
+}
+
+TEST(WarmStartTest, NoPairsWithoutTheLinkOrTheBuffer) {
+  auto uniform = []() { return 0.5; };
+  EXPECT_TRUE(sampleBellPairAges(0, 10, 0, uniform).empty());
+  EXPECT_TRUE(sampleBellPairAges(1e-3, 0, 0, uniform).empty());
+}
+
+}  // namespace
@@ -0,0 +1,52 @@
+#include "AliasTable.h"
+
+#include <stdexcept>
+#include <utility>
+
+namespace quisp::modules::SharedResource {
+
+AliasTable::AliasTable(std::vector<int> items, const std::vector<double> &weights) : items(std::move(items)), weights(weights) {
+  auto n = this->items.size();
+  if (n != weights.size()) throw std::invalid_argument("AliasTable: the numbers of the items and the weights differ");
+  for (auto weight : weights) {
+    if (weight < 0) throw std::invalid_argument("AliasTable: negative weight");
+    total_weight += weight;
+  }
+  if (total_weight <= 0) throw std::invalid_argument("AliasTable: no positive weight");
+
+  keep_probabilities.resize(n);
+  aliases.resize(n);
+  std::vector<std::size_t> small, large;
+  for (std::size_t i = 0; i < n; i++) {
+    // scaled so that the average column is 1
+    keep_probabilities[i] = weights[i] * n / total_weight;
+    aliases[i] = i;
+    (keep_probabilities[i] < 1.0 ? small : large).push_back(i);
+  }
+  while (!small.empty() && !large.empty()) {
+    auto s = small.back();
+    small.pop_back();
+    auto l = large.back();
+    // the large item fills the rest of the small column
+    aliases[s] = l;
+    keep_probabilities[l] -= 1.0 - keep_probabilities[s];
+    if (keep_probabilities[l] < 1.0) {
+      large.pop_back();
+      small.push_back(l);
+    }
+  }
+  // the rest are 1 up to the rounding errors
+  for (auto i : small) keep_probabilities[i] = 1.0;
+  for (auto i : large) keep_probabilities[i] = 1.0;
+}
+
+int AliasTable::sample(double u) const {
+  double scaled = u * items.size();
+  auto column = static_cast<std::size_t>(scaled);
+  if (column >= items.size()) column = items.size() - 1;
+  return scaled - column < keep_probabilities[column] ? items[column] : items[aliases[column]];
+}
+
+double AliasTable::probabilityOf(std::size_t index) const { return weights.at(index) / total_weight; }
+
+}  // namespace quisp::modules::SharedResource
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace quisp::modules::SharedResource {
+
+/**
+ * @brief AliasTable samples an item with the probability proportional to its weight in O(1),
+ * by Vose's alias method. The table is built in O(n) once.
+ */
+class AliasTable {
+ public:
+  /// @throws std::invalid_argument if the sizes differ, a weight is negative or no weight is positive.
+  AliasTable(std::vector<int> items, const std::vector<double> &weights);
+
+  /// @brief returns the item for the uniform random number u in [0, 1).
+  int sample(double u) const;
+  /// @brief the probability of the item at the index, for testing and debugging.
+  double probabilityOf(std::size_t index) const;
+  const std::vector<int> &getItems() const { return items; }
+  std::size_t size() const { return items.size(); }
+
+ private:
+  std::vector<int> items;
+  std::vector<double> weights;
+  double total_weight = 0;
+  // the probability to keep the column's own item, otherwise its alias is taken
+  std::vector<double> keep_probabilities;
+  std::vector<std::size_t> aliases;
+};
+
+}  // namespace quisp::modules::SharedResource
@@ -0,0 +1,44 @@
+#include "AliasTable.h"
+
+#include <gtest/gtest.h>
+#include <map>
+#include <stdexcept>
+
+namespace {
+using quisp::modules::SharedResource::AliasTable;
+
+std::map<int, double> sampledFrequencies(const AliasTable &table, int num_samples) {
+  std::map<int, double> frequencies;
+  for (int i = 0; i < num_samples; i++) frequencies[table.sample((i + 0.5) / num_samples)] += 1.0 / num_samples;
+  return frequencies;
+}
+
+TEST(AliasTableTest, SampleByWeight) {
+  AliasTable table{{10, 20, 30, 40}, {1, 0, 3, 4}};
+  ASSERT_EQ(table.size(), 4);
+  EXPECT_DOUBLE_EQ(table.probabilityOf(0), 0.125);
+  EXPECT_DOUBLE_EQ(table.probabilityOf(1), 0);
+
+  // the evenly spaced u covers each column uniformly, so the frequencies are exact up to the spacing
+  auto frequencies = sampledFrequencies(table, 80000);
+  EXPECT_NEAR(frequencies[10], 0.125, 1e-3);
+  EXPECT_EQ(frequencies.count(20), 0);
+  EXPECT_NEAR(frequencies[30], 0.375, 1e-3);
+  EXPECT_NEAR(frequencies[40], 0.5, 1e-3);
+}
+
+TEST(AliasTableTest, SingleItemAndBoundary) {
+  AliasTable table{{7}, {2}};
+  EXPECT_EQ(table.sample(0), 7);
+  EXPECT_EQ(table.sample(0.999999), 7);
+  EXPECT_EQ(table.sample(1.0), 7);
+}
+
+TEST(AliasTableTest, InvalidWeights) {
+  EXPECT_THROW((AliasTable{{1, 2}, {1}}), std::invalid_argument);
+  EXPECT_THROW((AliasTable{{1, 2}, {1, -1}}), std::invalid_argument);
+  EXPECT_THROW((AliasTable{{1, 2}, {0, 0}}), std::invalid_argument);
+  EXPECT_THROW((AliasTable{{}, {}}), std::invalid_argument);
+}
+
+}  // namespace
@@ -0,0 +1,85 @@
+#include "ConnectionController.h"
+
+#include <set>
+
+#include "ConnectionMetrics.h"
+#include "modules/QRSA/HardwareMonitor/IHardwareMonitor.h"
+#include "modules/QRSA/RoutingDaemon/IRoutingDaemon.h"
+
+using namespace omnetpp;
+
+namespace quisp::modules::SharedResource {
+
+ConnectionController::ConnectionController(NodeLookup lookup, simtime_t delay) : lookup(std::move(lookup)), control_delay(delay) {}
+
+void ConnectionController::subscribe(cModule *module) {
+  terminated_signal = cComponent::registerSignal(CONNECTION_TERMINATED_SIGNAL);
+  module->subscribe(terminated_signal, this);
+}
+
+void ConnectionController::unsubscribe(cModule *module) {
+  if (terminated_signal != -1 && module->isSubscribed(terminated_signal, this)) module->unsubscribe(terminated_signal, this);
+}
+
+void ConnectionController::receiveSignal(cComponent *source, simsignal_t signal, cObject *obj, cObject *details) {
+  auto *event = dynamic_cast<ConnectionMetricEvent *>(obj);
+  if (signal != terminated_signal || event == nullptr) return;
+  // a parked RuleSet keeps its qnics for the next demand of its persistent connection
+  if (!event->parked) release(event->node_addr, event->ruleset_id);
+}
+
+ConnectionController::Path ConnectionController::findPath(int initiator_addr, int outbound_qnic_addr, int responder_addr) const {
+  Path path{{initiator_addr, -1, outbound_qnic_addr}};
+  std::set<int> visited{initiator_addr};
+  int current_addr = initiator_addr;
+  int outbound = outbound_qnic_addr;
+  while (true) {
+    auto *hardware_monitor = lookup(current_addr).hardware_monitor;
+    if (hardware_monitor == nullptr) return {};
+    auto *info = hardware_monitor->findConnectionInfoByQnicAddr(outbound);
+    if (info == nullptr) return {};
+    int next_addr = info->neighbor_address;
+    if (!visited.insert(next_addr).second) return {};
+    auto *routing_daemon = lookup(next_addr).routing_daemon;
+    if (routing_daemon == nullptr) return {};
+    int inbound = routing_daemon->findQNicAddrByDestAddr(current_addr);
+    if (next_addr == responder_addr) {
+      path.push_back({next_addr, inbound, -1});
+      return path;
+    }
+    outbound = routing_daemon->findQNicAddrByDestAddr(responder_addr);
+    if (outbound == -1) return {};
+    path.push_back({next_addr, inbound, outbound});
+    current_addr = next_addr;
+  }
+}
+
+bool ConnectionController::reserve(unsigned long ruleset_id, const Path &path) {
+  for (auto &hop : path) {
+    for (int qnic_addr : {hop.inbound_qnic_addr, hop.outbound_qnic_addr}) {
+      if (qnic_addr != -1 && isReserved(hop.node_addr, qnic_addr)) {
+        num_rejections++;
+        return false;
+      }
+    }
+  }
+  for (auto &hop : path) {
+    auto &qnics = ruleset_qnics[{ruleset_id, hop.node_addr}];
+    for (int qnic_addr : {hop.inbound_qnic_addr, hop.outbound_qnic_addr}) {
+      if (qnic_addr == -1) continue;
+      reserved_qnics.insert({hop.node_addr, qnic_addr});
+      qnics.push_back(qnic_addr);
+    }
+  }
+  num_setups++;
+  return true;
+}
+
+void ConnectionController::release(int node_addr, unsigned long ruleset_id) {
+  auto it = ruleset_qnics.find({ruleset_id, node_addr});
+  if (it == ruleset_qnics.end()) return;
+  for (int qnic_addr : it->second) reserved_qnics.erase({node_addr, qnic_addr});
+  ruleset_qnics.erase(it);
+}
+
+}  // namespace quisp::modules::SharedResource
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <omnetpp.h>
+#include <functional>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+// the QRSA headers include ComponentProvider, which includes SharedResource
+namespace quisp::modules {
+class IRoutingDaemon;
+class IHardwareMonitor;
+}  // namespace quisp::modules
+
+namespace quisp::modules::SharedResource {
+
+/**
+ * @brief ConnectionController sets up the connections of the whole network in one place, like an SDN controller.
+ *
+ * The initiator asks it for the path to the responder instead of sending the request hop by hop. It walks the path
+ * by the routing tables and the neighbor tables of the nodes, reserves the qnics of the whole path at once in its reservation table,
+ * and the initiator installs the RuleSets generated for the path into each node after delay(), the request to the controller and the RuleSets back.
+ * The qnics are released when the RuleSet of the node terminates without being parked.
+ */
+class ConnectionController : public omnetpp::cListener {
+ public:
+  struct Node {
+    IRoutingDaemon *routing_daemon = nullptr;
+    IHardwareMonitor *hardware_monitor = nullptr;
+    omnetpp::cModule *connection_manager = nullptr;
+  };
+  // the modules of the node with the address, all nullptr if there is no such node
+  using NodeLookup = std::function<Node(int address)>;
+
+  struct Hop {
+    int node_addr;
+    int inbound_qnic_addr;  // -1 at the initiator
+    int outbound_qnic_addr;  // -1 at the responder
+  };
+  using Path = std::vector<Hop>;
+
+  ConnectionController(NodeLookup lookup, omnetpp::simtime_t delay);
+
+  void subscribe(omnetpp::cModule *module);
+  void unsubscribe(omnetpp::cModule *module);
+  void receiveSignal(omnetpp::cComponent *source, omnetpp::simsignal_t signal, omnetpp::cObject *obj, omnetpp::cObject *details) override;
+
+  /// @brief the hops from the initiator through its qnic to the responder, empty if a node on the way has no route or the routes loop.
+  Path findPath(int initiator_addr, int outbound_qnic_addr, int responder_addr) const;
+  /// @brief reserves all the qnics of the path for the RuleSet, or none of them if one is reserved already.
+  bool reserve(unsigned long ruleset_id, const Path &path);
+  /// @brief releases the qnics of the node reserved for the RuleSet.
+  void release(int node_addr, unsigned long ruleset_id);
+  bool isReserved(int node_addr, int qnic_addr) const { return reserved_qnics.count({node_addr, qnic_addr}) > 0; }
+
+  Node nodeOf(int address) const { return lookup(address); }
+  /// @brief the propagation delay between a node and the controller.
+  omnetpp::simtime_t delay() const { return control_delay; }
+  long numSetups() const { return num_setups; }
+  long numRejections() const { return num_rejections; }
+
+ private:
+  using QnicKey = std::pair<int, int>;  // node address, qnic address
+
+  NodeLookup lookup;
+  omnetpp::simtime_t control_delay;
+  omnetpp::simsignal_t terminated_signal = -1;
+  std::set<QnicKey> reserved_qnics;
+  std::map<std::pair<unsigned long, int>, std::vector<int>> ruleset_qnics;  // (RuleSet id, node address) -> the reserved qnic addresses
+  long num_setups = 0;
+  long num_rejections = 0;
+};
+
+}  // namespace quisp::modules::SharedResource
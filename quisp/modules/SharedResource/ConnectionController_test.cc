@@ -0,0 +1,104 @@
+#include "ConnectionController.h"
+
+#include <gtest/gtest.h>
+#include <map>
+
+#include "test_utils/mock_modules/MockHardwareMonitor.h"
+#include "test_utils/mock_modules/MockRoutingDaemon.h"
+
+namespace {
+using namespace omnetpp;
+using quisp::modules::ConnectionSetupInfo;
+using quisp::modules::SharedResource::ConnectionController;
+using quisp_test::mock_modules::hardware_monitor::MockHardwareMonitor;
+using quisp_test::mock_modules::routing_daemon::MockRoutingDaemon;
+using testing::Return;
+
+// the line 1 - 2 - 3, with the qnics 10 (1 to 2), 20 (2 to 1), 21 (2 to 3) and 30 (3 to 2)
+class ConnectionControllerTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    for (int address : {1, 2, 3}) {
+      routing_daemons[address] = std::make_unique<MockRoutingDaemon>();
+      hardware_monitors[address] = std::make_unique<MockHardwareMonitor>();
+    }
+    link(1, 10, 2);
+    link(2, 20, 1);
+    link(2, 21, 3);
+    link(3, 30, 2);
+    // node 2 routes to 3 through 21
+    ON_CALL(*routing_daemons[2], findQNicAddrByDestAddr(3)).WillByDefault(Return(21));
+  }
+
+  void link(int address, int qnic_addr, int neighbor_addr) {
+    auto &info = infos[qnic_addr];
+    info.qnic.address = qnic_addr;
+    info.neighbor_address = neighbor_addr;
+    ON_CALL(*hardware_monitors[address], findConnectionInfoByQnicAddr(qnic_addr)).WillByDefault(Return(&info));
+    ON_CALL(*routing_daemons[address], findQNicAddrByDestAddr(neighbor_addr)).WillByDefault(Return(qnic_addr));
+  }
+
+  ConnectionController makeController() {
+    return ConnectionController(
+        [this](int address) -> ConnectionController::Node {
+          if (routing_daemons.count(address) == 0) return {};
+          return {routing_daemons[address].get(), hardware_monitors[address].get(), nullptr};
+        },
+        0.01);
+  }
+
+  std::map<int, std::unique_ptr<MockRoutingDaemon>> routing_daemons;
+  std::map<int, std::unique_ptr<MockHardwareMonitor>> hardware_monitors;
+  std::map<int, ConnectionSetupInfo> infos;
+};
+
+TEST_F(ConnectionControllerTest, FindPath) {
+  auto controller = makeController();
+  auto path = controller.findPath(1, 10, 3);
+  ASSERT_EQ(path.size(), 3);
+  EXPECT_EQ(path[0].node_addr, 1);
+  EXPECT_EQ(path[0].inbound_qnic_addr, -1);
+  EXPECT_EQ(path[0].outbound_qnic_addr, 10);
+  EXPECT_EQ(path[1].node_addr, 2);
+  EXPECT_EQ(path[1].inbound_qnic_addr, 20);
+  EXPECT_EQ(path[1].outbound_qnic_addr, 21);
+  EXPECT_EQ(path[2].node_addr, 3);
+  EXPECT_EQ(path[2].inbound_qnic_addr, 30);
+  EXPECT_EQ(path[2].outbound_qnic_addr, -1);
+  EXPECT_DOUBLE_EQ(controller.delay().dbl(), 0.01);
+}
+
+TEST_F(ConnectionControllerTest, NoPathIfTheRoutesLoop) {
+  // node 2 sends the requests to 3 back to 1
+  ON_CALL(*routing_daemons[2], findQNicAddrByDestAddr(3)).WillByDefault(Return(20));
+  auto controller = makeController();
+  EXPECT_TRUE(controller.findPath(1, 10, 3).empty());
+  // no such node
+  EXPECT_TRUE(controller.findPath(1, 10, 4).empty());
+}
+
+TEST_F(ConnectionControllerTest, ReservesTheWholePath) {
+  auto controller = makeController();
+  auto shorter_path = controller.findPath(2, 21, 3);
+  ASSERT_TRUE(controller.reserve(100, shorter_path));
+  EXPECT_TRUE(controller.isReserved(2, 21));
+  EXPECT_TRUE(controller.isReserved(3, 30));
+
+  // the path 1 - 2 - 3 shares the qnics of 2 and 3, and doesn't take the free ones either
+  auto path = controller.findPath(1, 10, 3);
+  EXPECT_FALSE(controller.reserve(101, path));
+  EXPECT_FALSE(controller.isReserved(1, 10));
+  EXPECT_FALSE(controller.isReserved(2, 20));
+  EXPECT_EQ(controller.numSetups(), 1);
+  EXPECT_EQ(controller.numRejections(), 1);
+
+  // each node releases its qnics when its RuleSet terminates
+  controller.release(2, 100);
+  EXPECT_FALSE(controller.isReserved(2, 21));
+  EXPECT_TRUE(controller.isReserved(3, 30));
+  controller.release(3, 100);
+  EXPECT_TRUE(controller.reserve(101, path));
+  EXPECT_TRUE(controller.isReserved(1, 10));
+}
+
+}  // namespace
@@ -0,0 +1,124 @@
+#include "ConnectionMetrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+namespace quisp::modules::SharedResource {
+
+using namespace omnetpp;
+
+namespace {
+void recordSamples(cComponent *component, const std::string &name, const std::vector<double> &samples, const char *unit) {
+  cHistogram histogram(name.c_str());
+  for (double sample : samples) histogram.collect(sample);
+  component->recordStatistic(&histogram, unit);
+  component->recordScalar((name + ":p50").c_str(), ConnectionMetricsCollector::percentile(samples, 50), unit);
+  component->recordScalar((name + ":p99").c_str(), ConnectionMetricsCollector::percentile(samples, 99), unit);
+}
+}  // namespace
+
+void ConnectionMetricsCollector::subscribe(cModule *module) {
+  requested_signal = cComponent::registerSignal(CONNECTION_REQUESTED_SIGNAL);
+  established_signal = cComponent::registerSignal(CONNECTION_ESTABLISHED_SIGNAL);
+  pair_delivered_signal = cComponent::registerSignal(CONNECTION_PAIR_DELIVERED_SIGNAL);
+  terminated_signal = cComponent::registerSignal(CONNECTION_TERMINATED_SIGNAL);
+  for (auto signal : {requested_signal, established_signal, pair_delivered_signal, terminated_signal}) module->subscribe(signal, this);
+}
+
+void ConnectionMetricsCollector::unsubscribe(cModule *module) {
+  for (auto signal : {requested_signal, established_signal, pair_delivered_signal, terminated_signal}) {
+    if (module->isSubscribed(signal, this)) module->unsubscribe(signal, this);
+  }
+}
+
+void ConnectionMetricsCollector::receiveSignal(cComponent *source, simsignal_t signal, cObject *obj, cObject *details) {
+  auto *event = dynamic_cast<ConnectionMetricEvent *>(obj);
+  if (event == nullptr) return;
+  auto now = simTime();
+  if (signal == requested_signal) {
+    onRequested(*event, now);
+  } else if (signal == established_signal) {
+    onEstablished(*event, now);
+  } else if (signal == pair_delivered_signal) {
+    onPairDelivered(*event, now);
+  } else if (signal == terminated_signal) {
+    onTerminated(*event, now);
+  }
+}
+
+void ConnectionMetricsCollector::onRequested(const ConnectionMetricEvent &event, simtime_t now) {
+  auto &connection = connections[{event.initiator_addr, event.request_id}];
+  connection.initiator_addr = event.initiator_addr;
+  // a retried request keeps the time of the first attempt
+  if (connection.requested_at < 0) connection.requested_at = now;
+}
+
+void ConnectionMetricsCollector::onEstablished(const ConnectionMetricEvent &event, simtime_t now) {
+  auto it = connections.find({event.initiator_addr, event.request_id});
+  if (it == connections.end()) return;
+  if (it->second.established_at < 0) it->second.established_at = now;
+  connection_by_ruleset[event.ruleset_id] = it->first;
+}
+
+void ConnectionMetricsCollector::onPairDelivered(const ConnectionMetricEvent &event, simtime_t now) {
+  auto *connection = findByRuleSet(event.ruleset_id);
+  if (connection == nullptr || event.node_addr != connection->initiator_addr) return;
+  if (connection->first_pair_at < 0) connection->first_pair_at = now;
+  if (connection->last_pair_at >= 0) pair_intervals.record((now - connection->last_pair_at).dbl());
+  connection->last_pair_at = now;
+  connection->num_pairs++;
+  pair_rate.count(now.dbl());
+}
+
+void ConnectionMetricsCollector::onTerminated(const ConnectionMetricEvent &event, simtime_t now) {
+  auto *connection = findByRuleSet(event.ruleset_id);
+  if (connection == nullptr || event.node_addr != connection->initiator_addr) return;
+  if (connection->terminated_at < 0) connection->terminated_at = now;
+}
+
+ConnectionMetricsCollector::Connection *ConnectionMetricsCollector::findByRuleSet(unsigned long ruleset_id) {
+  auto it = connection_by_ruleset.find(ruleset_id);
+  if (it == connection_by_ruleset.end()) return nullptr;
+  return &connections.at(it->second);
+}
+
+ConnectionMetricsCollector::Summary ConnectionMetricsCollector::summarise() const {
+  Summary summary;
+  for (auto &[key, connection] : connections) {
+    if (connection.requested_at < 0 || connection.established_at < 0) continue;
+    summary.setup_latencies.push_back((connection.established_at - connection.requested_at).dbl());
+    if (connection.num_pairs == 0) continue;
+    summary.first_pair_latencies.push_back((connection.first_pair_at - connection.requested_at).dbl());
+    auto end = connection.terminated_at >= 0 ? connection.terminated_at : connection.last_pair_at;
+    double duration = (end - connection.established_at).dbl();
+    if (duration > 0) summary.pair_rates.push_back(connection.num_pairs / duration);
+  }
+  return summary;
+}
+
+std::vector<ConnectionMetricsCollector::ConnectionState> ConnectionMetricsCollector::connectionStates() const {
+  std::vector<ConnectionState> states;
+  states.reserve(connections.size());
+  for (auto &[key, connection] : connections) {
+    states.push_back({key.first, key.second, connection.num_pairs, connection.established_at >= 0, connection.terminated_at >= 0});
+  }
+  return states;
+}
+
+void ConnectionMetricsCollector::record(cComponent *component) const {
+  auto summary = summarise();
+  recordSamples(component, "connection_setup_latency", summary.setup_latencies, "s");
+  recordSamples(component, "connection_first_pair_latency", summary.first_pair_latencies, "s");
+  recordSamples(component, "connection_pair_rate", summary.pair_rates, nullptr);
+  pair_intervals.forEachSummary([&](const std::string &suffix, double value) { component->recordScalar(("connection_pair_interval" + suffix).c_str(), value, suffix == ":count" ? nullptr : "s"); });
+}
+
+double ConnectionMetricsCollector::percentile(std::vector<double> samples, double p) {
+  if (samples.empty()) return 0;
+  std::sort(samples.begin(), samples.end());
+  auto rank = static_cast<std::size_t>(std::ceil(p / 100 * samples.size()));
+  return samples[std::clamp<std::size_t>(rank, 1, samples.size()) - 1];
+}
+
+}  // namespace quisp::modules::SharedResource
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <omnetpp.h>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "utils/StreamingStats.h"
+
+namespace quisp::modules::SharedResource {
+
+// the signals of the connection lifecycle, emitted with a ConnectionMetricEvent.
+// emitting them costs nothing unless SharedResource.record_connection_metrics is true.
+constexpr const char *CONNECTION_REQUESTED_SIGNAL = "connectionRequested";  // Application, when the initiator sends the request
+constexpr const char *CONNECTION_ESTABLISHED_SIGNAL = "connectionEstablished";  // ConnectionManager, when the initiator receives the RuleSet
+constexpr const char *CONNECTION_PAIR_DELIVERED_SIGNAL = "connectionPairDelivered";  // RuleEngine, when an end-to-end Bell pair is consumed
+constexpr const char *CONNECTION_TERMINATED_SIGNAL = "connectionTerminated";  // RuleEngine, when the RuleSet terminates
+
+/**
+ * @brief ConnectionMetricEvent identifies the connection of a signal.
+ *
+ * Before the RuleSet exists, the connection is identified by the initiator and the request id, then by the RuleSet id.
+ */
+class ConnectionMetricEvent : public omnetpp::cObject {
+ public:
+  int initiator_addr = -1;
+  int responder_addr = -1;
+  int request_id = -1;
+  unsigned long ruleset_id = 0;
+  int node_addr = -1;  // the node that emits the signal
+  bool parked = false;  // the terminated RuleSet is kept for the next demand of its persistent connection
+};
+
+/**
+ * @brief ConnectionMetricsCollector listens to the connection signals of the whole network, and summarises
+ * the setup latency, the latency to the first end-to-end Bell pair and the delivered pair rate of each connection.
+ *
+ * The pairs are counted at the initiator, each pair is consumed at both ends.
+ */
+class ConnectionMetricsCollector : public omnetpp::cListener {
+ public:
+  struct Summary {
+    std::vector<double> setup_latencies;  // s, from the request to the RuleSet
+    std::vector<double> first_pair_latencies;  // s, from the request to the first delivered pair
+    std::vector<double> pair_rates;  // pairs/s, from the RuleSet to the termination or the last pair
+  };
+
+  void subscribe(omnetpp::cModule *module);
+  void unsubscribe(omnetpp::cModule *module);
+  void receiveSignal(omnetpp::cComponent *source, omnetpp::simsignal_t signal, omnetpp::cObject *obj, omnetpp::cObject *details) override;
+
+  void onRequested(const ConnectionMetricEvent &event, omnetpp::simtime_t now);
+  void onEstablished(const ConnectionMetricEvent &event, omnetpp::simtime_t now);
+  void onPairDelivered(const ConnectionMetricEvent &event, omnetpp::simtime_t now);
+  void onTerminated(const ConnectionMetricEvent &event, omnetpp::simtime_t now);
+
+  Summary summarise() const;
+
+  /// @brief the progress of a connection so far, for the live statistics.
+  struct ConnectionState {
+    int initiator_addr;
+    int request_id;
+    long num_pairs;
+    bool established;
+    bool terminated;
+  };
+  /// @brief the connections sorted by the initiator and the request id.
+  std::vector<ConnectionState> connectionStates() const;
+  /// @brief the time between the consecutive pairs of a connection, over all the connections.
+  const utils::LogHistogram &pairIntervals() const { return pair_intervals; }
+  /// @brief the delivered pairs per second of the whole network, averaged over about a second.
+  double pairRate(omnetpp::simtime_t now) const { return pair_rate.rate(now.dbl()); }
+  /// @brief records the histograms and the p50/p99 of the summary as the statistics of the component.
+  void record(omnetpp::cComponent *component) const;
+
+  /// @brief the nearest-rank percentile of the samples, 0 if there is no sample.
+  static double percentile(std::vector<double> samples, double p);
+
+ private:
+  struct Connection {
+    int initiator_addr = -1;
+    omnetpp::simtime_t requested_at = -1;
+    omnetpp::simtime_t established_at = -1;
+    omnetpp::simtime_t first_pair_at = -1;
+    omnetpp::simtime_t last_pair_at = -1;
+    omnetpp::simtime_t terminated_at = -1;
+    long num_pairs = 0;
+  };
+  Connection *findByRuleSet(unsigned long ruleset_id);
+
+  omnetpp::simsignal_t requested_signal = -1;
+  omnetpp::simsignal_t established_signal = -1;
+  omnetpp::simsignal_t pair_delivered_signal = -1;
+  omnetpp::simsignal_t terminated_signal = -1;
+  // {initiator, request id} -> connection
+  std::map<std::pair<int, int>, Connection> connections;
+  std::unordered_map<unsigned long, std::pair<int, int>> connection_by_ruleset;
+  // streamed over the pairs, which are much more than the connections
+  utils::LogHistogram pair_intervals;
+  utils::EwmaRate pair_rate{1.0};
+};
+
+}  // namespace quisp::modules::SharedResource
@@ -0,0 +1,70 @@
+#include "ConnectionMetrics.h"
+
+#include <gtest/gtest.h>
+
+#include "test_utils/TestUtilFunctions.h"
+
+namespace {
+using namespace omnetpp;
+using quisp::modules::SharedResource::ConnectionMetricEvent;
+using quisp::modules::SharedResource::ConnectionMetricsCollector;
+using quisp_test::utils::prepareSimulation;
+
+ConnectionMetricEvent event(int initiator, int request_id, unsigned long ruleset_id, int node) {
+  ConnectionMetricEvent e;
+  e.initiator_addr = initiator;
+  e.request_id = request_id;
+  e.ruleset_id = ruleset_id;
+  e.node_addr = node;
+  return e;
+}
+
+TEST(ConnectionMetricsTest, Summarise) {
+  prepareSimulation();
+  ConnectionMetricsCollector collector;
+  collector.onRequested(event(1, 0, 0, 1), 1);
+  collector.onRequested(event(1, 1, 0, 1), 2);
+  collector.onEstablished(event(1, 0, 100, 1), 1.5);
+  collector.onEstablished(event(1, 1, 101, 1), 3);
+  // the pairs are counted at the initiator only
+  collector.onPairDelivered(event(-1, -1, 100, 1), 2);
+  collector.onPairDelivered(event(-1, -1, 100, 5), 2);
+  collector.onPairDelivered(event(-1, -1, 100, 1), 2.5);
+  collector.onTerminated(event(-1, -1, 100, 1), 3.5);
+  // an unknown RuleSet is ignored
+  collector.onPairDelivered(event(-1, -1, 999, 1), 3);
+
+  auto summary = collector.summarise();
+  ASSERT_EQ(summary.setup_latencies.size(), 2);
+  EXPECT_DOUBLE_EQ(summary.setup_latencies[0], 0.5);
+  EXPECT_DOUBLE_EQ(summary.setup_latencies[1], 1);
+  ASSERT_EQ(summary.first_pair_latencies.size(), 1);
+  EXPECT_DOUBLE_EQ(summary.first_pair_latencies[0], 1);
+  ASSERT_EQ(summary.pair_rates.size(), 1);
+  EXPECT_DOUBLE_EQ(summary.pair_rates[0], 2 / 2.0);
+
+  // the pairs of the connection came 0.5s apart
+  EXPECT_EQ(collector.pairIntervals().count(), 1);
+  EXPECT_NEAR(collector.pairIntervals().quantile(0.5), 0.5, 0.5 / 32);
+  EXPECT_GT(collector.pairRate(2.5), 0);
+
+  auto states = collector.connectionStates();
+  ASSERT_EQ(states.size(), 2);
+  EXPECT_EQ(states[0].request_id, 0);
+  EXPECT_EQ(states[0].num_pairs, 2);
+  EXPECT_TRUE(states[0].terminated);
+  EXPECT_EQ(states[1].num_pairs, 0);
+  EXPECT_TRUE(states[1].established);
+  EXPECT_FALSE(states[1].terminated);
+}
+
+TEST(ConnectionMetricsTest, Percentile) {
+  EXPECT_EQ(ConnectionMetricsCollector::percentile({}, 50), 0);
+  std::vector<double> samples;
+  for (int i = 100; i >= 1; i--) samples.push_back(i);
+  EXPECT_EQ(ConnectionMetricsCollector::percentile(samples, 50), 50);
+  EXPECT_EQ(ConnectionMetricsCollector::percentile(samples, 99), 99);
+  EXPECT_EQ(ConnectionMetricsCollector::percentile({3}, 99), 3);
+}
+
+}  // namespace
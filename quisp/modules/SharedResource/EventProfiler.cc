@@ -0,0 +1,49 @@
+#include "EventProfiler.h"
+#include "EventTrace.h"
+
+namespace quisp::modules::SharedResource {
+
+void EventProfiler::traceDelivery(const omnetpp::cObject *module, const omnetpp::cObject *msg) { trace->delivery(module, msg); }
+
+std::map<std::string, EventProfiler::Stat> EventProfiler::stats() const {
+  std::map<std::string, Stat> stats;
+  for (auto &[types, stat] : stats_by_type) {
+    stats[std::string(omnetpp::opp_typename(*types.module_type)) + "/" + omnetpp::opp_typename(*types.message_type)] = stat;
+  }
+  return stats;
+}
+
+std::map<std::string, EventProfiler::Stat> EventProfiler::moduleStats() const {
+  std::map<std::string, Stat> stats;
+  for (auto &[types, stat] : stats_by_type) {
+    auto &module_stat = stats[omnetpp::opp_typename(*types.module_type)];
+    module_stat.events += stat.events;
+    module_stat.wall_time += stat.wall_time;
+    module_stat.backend_ops += stat.backend_ops;
+  }
+  return stats;
+}
+
+void EventProfiler::forEachCounter(const std::function<void(const std::string &, double)> &f) const {
+  auto record = [&](const std::string &prefix, const Stat &stat) {
+    f(prefix + " events", stat.events);
+    f(prefix + " wall time (s)", std::chrono::duration<double>(stat.wall_time).count());
+    f(prefix + " backend ops", stat.backend_ops);
+  };
+  for (auto &[module, stat] : moduleStats()) record("event profile " + module, stat);
+  for (auto &[key, stat] : stats()) record("event profile " + key, stat);
+  f("event profile backend ops outside events", backend_ops_outside_events);
+}
+
+nlohmann::json EventProfiler::toJson() const {
+  auto to_json = [](const Stat &stat) { return nlohmann::json{{"events", stat.events}, {"wall_time_ns", stat.wall_time.count()}, {"backend_ops", stat.backend_ops}}; };
+  nlohmann::json profile;
+  profile["modules"] = nlohmann::json::object();
+  for (auto &[module, stat] : moduleStats()) profile["modules"][module] = to_json(stat);
+  profile["messages"] = nlohmann::json::object();
+  for (auto &[key, stat] : stats()) profile["messages"][key] = to_json(stat);
+  profile["backend_ops_outside_events"] = backend_ops_outside_events;
+  return profile;
+}
+
+}  // namespace quisp::modules::SharedResource
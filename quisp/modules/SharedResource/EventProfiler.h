@@ -0,0 +1,108 @@
+#pragma once
+
+#include <omnetpp.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+
+namespace quisp::modules::SharedResource {
+
+class EventTrace;
+
+/**
+ * @brief EventProfiler aggregates the events the modules handle, by the module type and the message type.
+ *
+ * Each handleMessage() of the QuISP modules opens a Scope, which counts the event, its wall clock time
+ * and the backend operations it ran. The self messages without their own class count as omnetpp::cMessage.
+ * SharedResource owns the profiler if profile_events is true or the events are traced, otherwise the modules get nullptr
+ * and a Scope costs a null check. With an EventTrace, the outermost scope of each event is also written to the trace.
+ */
+class EventProfiler {
+ public:
+  struct Stat {
+    std::uint64_t events = 0;
+    std::chrono::nanoseconds wall_time{0};
+    std::uint64_t backend_ops = 0;
+  };
+
+  /// @brief profiles the event of the module while it's alive, nested scopes are counted in both.
+  class Scope {
+   public:
+    Scope(EventProfiler *profiler, const omnetpp::cObject *module, const omnetpp::cObject *msg) : profiler(profiler) {
+      if (profiler == nullptr) return;
+      stat = &profiler->statOf(typeid(*module), typeid(*msg));
+      outer = profiler->current;
+      if (outer == nullptr && profiler->trace != nullptr) profiler->traceDelivery(module, msg);
+      backend_ops_before = stat->backend_ops;
+      profiler->current = stat;
+      start = std::chrono::steady_clock::now();
+    }
+    ~Scope() {
+      if (profiler == nullptr) return;
+      stat->events++;
+      stat->wall_time += std::chrono::steady_clock::now() - start;
+      if (outer != nullptr && outer != stat) outer->backend_ops += stat->backend_ops - backend_ops_before;
+      profiler->current = outer;
+    }
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+   private:
+    EventProfiler *profiler;
+    Stat *stat = nullptr;
+    Stat *outer = nullptr;
+    std::uint64_t backend_ops_before = 0;
+    std::chrono::steady_clock::time_point start;
+  };
+
+  /// @brief counts a backend operation for the event being handled, e.g. from the backend callback.
+  void countBackendOp() {
+    if (current != nullptr) {
+      current->backend_ops++;
+    } else {
+      backend_ops_outside_events++;
+    }
+  }
+
+  /// @brief writes the deliveries to the trace too, nullptr to stop.
+  void setTrace(EventTrace *event_trace) { trace = event_trace; }
+
+  /// @brief the stats by "module type/message type", sorted by the key.
+  std::map<std::string, Stat> stats() const;
+  /// @brief the stats summed up by the module type.
+  std::map<std::string, Stat> moduleStats() const;
+  std::uint64_t backendOpsOutsideEvents() const { return backend_ops_outside_events; }
+
+  /// @brief calls f(name, value) for each counter, e.g. to record them as scalars.
+  void forEachCounter(const std::function<void(const std::string &, double)> &f) const;
+
+  nlohmann::json toJson() const;
+
+ protected:
+  struct TypePair {
+    const std::type_info *module_type;
+    const std::type_info *message_type;
+    bool operator==(const TypePair &other) const { return *module_type == *other.module_type && *message_type == *other.message_type; }
+  };
+  struct TypePairHash {
+    std::size_t operator()(const TypePair &types) const { return types.module_type->hash_code() * 31 + types.message_type->hash_code(); }
+  };
+
+  Stat &statOf(const std::type_info &module_type, const std::type_info &message_type) { return stats_by_type[TypePair{&module_type, &message_type}]; }
+
+  // the elements of unordered_map don't move, so the scopes keep the pointers to them
+  std::unordered_map<TypePair, Stat, TypePairHash> stats_by_type;
+  void traceDelivery(const omnetpp::cObject *module, const omnetpp::cObject *msg);
+
+  Stat *current = nullptr;
+  std::uint64_t backend_ops_outside_events = 0;
+  EventTrace *trace = nullptr;
+};
+
+}  // namespace quisp::modules::SharedResource
@@ -0,0 +1,70 @@
+#include "EventProfiler.h"
+
+#include <gtest/gtest.h>
+#include <string>
+
+namespace {
+using quisp::modules::SharedResource::EventProfiler;
+
+class ModuleA : public omnetpp::cObject {};
+class ModuleB : public omnetpp::cObject {};
+class Timer : public omnetpp::cObject {};
+class Packet : public omnetpp::cObject {};
+
+std::string keyOf(const std::type_info &module_type, const std::type_info &message_type) {
+  return std::string(omnetpp::opp_typename(module_type)) + "/" + omnetpp::opp_typename(message_type);
+}
+
+TEST(EventProfilerTest, CountEventsByModuleAndMessageType) {
+  EventProfiler profiler;
+  ModuleA a;
+  ModuleB b;
+  Timer timer;
+  Packet packet;
+  {
+    EventProfiler::Scope profile(&profiler, &a, &timer);
+    profiler.countBackendOp();
+    profiler.countBackendOp();
+  }
+  { EventProfiler::Scope profile(&profiler, &a, &packet); }
+  { EventProfiler::Scope profile(&profiler, &a, &packet); }
+  {
+    EventProfiler::Scope profile(&profiler, &b, &packet);
+    // e.g. a direct method call into the other module in the event
+    EventProfiler::Scope nested(&profiler, &a, &timer);
+    profiler.countBackendOp();
+  }
+  profiler.countBackendOp();
+  // disabled
+  { EventProfiler::Scope profile(nullptr, &a, &timer); }
+
+  auto stats = profiler.stats();
+  ASSERT_EQ(stats.size(), 3);
+  auto &a_timer = stats.at(keyOf(typeid(ModuleA), typeid(Timer)));
+  EXPECT_EQ(a_timer.events, 2);
+  EXPECT_EQ(a_timer.backend_ops, 3);
+  EXPECT_EQ(stats.at(keyOf(typeid(ModuleA), typeid(Packet))).events, 2);
+  EXPECT_EQ(stats.at(keyOf(typeid(ModuleA), typeid(Packet))).backend_ops, 0);
+  auto &b_packet = stats.at(keyOf(typeid(ModuleB), typeid(Packet)));
+  EXPECT_EQ(b_packet.events, 1);
+  // the nested scope's operations are counted in the outer one too
+  EXPECT_EQ(b_packet.backend_ops, 1);
+  EXPECT_EQ(profiler.backendOpsOutsideEvents(), 1);
+
+  auto modules = profiler.moduleStats();
+  ASSERT_EQ(modules.size(), 2);
+  EXPECT_EQ(modules.at(omnetpp::opp_typename(typeid(ModuleA))).events, 4);
+  EXPECT_EQ(modules.at(omnetpp::opp_typename(typeid(ModuleB))).events, 1);
+
+  auto json = profiler.toJson();
+  EXPECT_EQ(json["modules"][omnetpp::opp_typename(typeid(ModuleA))]["backend_ops"], 3);
+  EXPECT_EQ(json["messages"][keyOf(typeid(ModuleB), typeid(Packet))]["events"], 1);
+  EXPECT_EQ(json["backend_ops_outside_events"], 1);
+
+  int num_counters = 0;
+  profiler.forEachCounter([&](const std::string &name, double value) { num_counters++; });
+  // 3 counters for each of the 2 modules and the 3 pairs, and the operations outside the events
+  EXPECT_EQ(num_counters, 16);
+}
+
+}  // namespace
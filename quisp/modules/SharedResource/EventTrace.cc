@@ -0,0 +1,75 @@
+#include "EventTrace.h"
+#include <typeinfo>
+#include <utility>
+
+namespace quisp::modules::SharedResource {
+
+using Logger::EventTraceKind;
+using Logger::EventTraceRecord;
+
+EventTrace::EventTrace(std::shared_ptr<Logger::BinaryLogWriter> writer) : writer(std::move(writer)) {}
+
+void EventTrace::delivery(const omnetpp::cObject *module, const omnetpp::cObject *msg) {
+  auto record = newRecord(EventTraceKind::Delivery, module);
+  auto [it, inserted] = msg_types.emplace(typeid(*msg), 0);
+  if (inserted) it->second = writer->intern(msg->getClassName());
+  record.msg_type = it->second;
+  if (auto *message = dynamic_cast<const omnetpp::cMessage *>(msg)) record.msg_kind = message->getKind();
+  writer->write(record);
+  num_deliveries++;
+}
+
+void EventTrace::stimulus(const omnetpp::cObject *module, int dest_addr, int num_pairs) {
+  auto record = newRecord(EventTraceKind::Stimulus, module);
+  record.dest_addr = dest_addr;
+  record.num_pairs = num_pairs;
+  writer->write(record);
+}
+
+EventTraceRecord EventTrace::newRecord(EventTraceKind kind, const omnetpp::cObject *module) {
+  EventTraceRecord record;
+  auto now = omnetpp::simTime();
+  record.simtime = now.dbl();
+  record.simtime_raw = now.raw();
+  record.event_number = omnetpp::getSimulation()->getEventNumber();
+  record.rng_draws = rngDraws();
+  record.kind = kind;
+  record.module = internModule(module);
+  record.msg_type = 0;
+  record.msg_kind = -1;
+  record.dest_addr = -1;
+  record.num_pairs = -1;
+  return record;
+}
+
+uint32_t EventTrace::internModule(const omnetpp::cObject *module) {
+  auto *component = dynamic_cast<const omnetpp::cComponent *>(module);
+  if (component == nullptr) return writer->intern(module->getFullPath());
+  auto [it, inserted] = module_paths.emplace(component->getId(), 0);
+  if (inserted) it->second = writer->intern(module->getFullPath());
+  return it->second;
+}
+
+std::uint64_t EventTrace::rngDraws() {
+  auto *envir = omnetpp::getEnvir();
+  std::uint64_t draws = 0;
+  for (int k = 0; k < envir->getNumRNGs(); k++) draws += envir->getRNG(k)->getNumbersDrawn();
+  return draws;
+}
+
+EventReplay::EventReplay(const std::string &filename) {
+  auto log = Logger::BinaryLog::read(filename);
+  for (auto &record : log.trace_records) {
+    if (record.kind != EventTraceKind::Stimulus) continue;
+    stimuli_by_module[log.strings.at(record.module)].push_back(Stimulus{omnetpp::SimTime().setRaw(record.simtime_raw), record.dest_addr, record.num_pairs});
+    num_stimuli++;
+  }
+}
+
+const std::vector<EventReplay::Stimulus> &EventReplay::stimuliOf(const std::string &module_path) const {
+  static const std::vector<Stimulus> none;
+  auto it = stimuli_by_module.find(module_path);
+  return it == stimuli_by_module.end() ? none : it->second;
+}
+
+}  // namespace quisp::modules::SharedResource
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <omnetpp.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+#include "modules/Logger/BinaryLogger.h"
+
+namespace quisp::modules::SharedResource {
+
+/**
+ * @brief EventTrace writes the message deliveries and the connection requests of a run as EventTraceRecords,
+ * to diff the event sequences of two runs with scripts/binary_log.py and to replay the requests with EventReplay.
+ *
+ * A delivery is the outermost EventProfiler::Scope of an event, with the numbers drawn from the RNGs before it,
+ * so the first divergent record shows where a change altered the run. The records go into the blocks of
+ * a BinaryLogWriter, which the BinaryLogger can share.
+ */
+class EventTrace {
+ public:
+  explicit EventTrace(std::shared_ptr<Logger::BinaryLogWriter> writer);
+  void delivery(const omnetpp::cObject *module, const omnetpp::cObject *msg);
+  void stimulus(const omnetpp::cObject *module, int dest_addr, int num_pairs);
+  const std::shared_ptr<Logger::BinaryLogWriter> &getWriter() const { return writer; }
+  std::uint64_t numDeliveries() const { return num_deliveries; }
+
+ protected:
+  Logger::EventTraceRecord newRecord(Logger::EventTraceKind kind, const omnetpp::cObject *module);
+  uint32_t internModule(const omnetpp::cObject *module);
+  static std::uint64_t rngDraws();
+
+  std::shared_ptr<Logger::BinaryLogWriter> writer;
+  // by the module id, which is never reused in a run unlike the address of a deleted module
+  std::unordered_map<int, uint32_t> module_paths;
+  std::unordered_map<std::type_index, uint32_t> msg_types;
+  std::uint64_t num_deliveries = 0;
+};
+
+/**
+ * @brief EventReplay reads the connection requests of an event trace, so the Applications send the same requests
+ * at the same times instead of drawing them, e.g. to time a change on the identical workload.
+ */
+class EventReplay {
+ public:
+  struct Stimulus {
+    omnetpp::simtime_t time;
+    int dest_addr;
+    int num_pairs;
+  };
+
+  /// @throws omnetpp::cRuntimeError if the file can't be read.
+  explicit EventReplay(const std::string &filename);
+  /// @brief the requests of the module with the full path in the traced run in their order, empty if it sent none.
+  const std::vector<Stimulus> &stimuliOf(const std::string &module_path) const;
+  std::size_t numStimuli() const { return num_stimuli; }
+
+ protected:
+  std::unordered_map<std::string, std::vector<Stimulus>> stimuli_by_module;
+  std::size_t num_stimuli = 0;
+};
+
+}  // namespace quisp::modules::SharedResource
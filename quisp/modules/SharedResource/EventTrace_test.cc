@@ -0,0 +1,74 @@
+#include "EventTrace.h"
+
+#include <gtest/gtest.h>
+#include <test_utils/TestUtils.h>
+#include <cstdio>
+#include <memory>
+
+#include "EventProfiler.h"
+
+namespace {
+using quisp::modules::Logger::BinaryLog;
+using quisp::modules::Logger::BinaryLogWriter;
+using quisp::modules::Logger::EventTraceKind;
+using quisp::modules::SharedResource::EventProfiler;
+using quisp::modules::SharedResource::EventReplay;
+using quisp::modules::SharedResource::EventTrace;
+
+class EventTraceTest : public testing::Test {
+ protected:
+  void SetUp() { quisp_test::utils::prepareSimulation(); }
+  void TearDown() { std::remove(filename); }
+  const char *filename = "event_trace_test.blog";
+};
+
+TEST_F(EventTraceTest, TraceTheOutermostScopes) {
+  {
+    EventTrace trace(std::make_shared<BinaryLogWriter>(filename));
+    EventProfiler profiler;
+    profiler.setTrace(&trace);
+    omnetpp::cNamedObject app("app"), router("router");
+    omnetpp::cMessage timer("timer", 3);
+    {
+      EventProfiler::Scope profile(&profiler, &app, &timer);
+      // e.g. a direct method call into the other module in the event
+      EventProfiler::Scope nested(&profiler, &router, &timer);
+    }
+    { EventProfiler::Scope profile(&profiler, &router, &timer); }
+    EXPECT_EQ(trace.numDeliveries(), 2);
+  }
+
+  auto log = BinaryLog::read(filename);
+  ASSERT_EQ(log.trace_records.size(), 2);
+  EXPECT_EQ(log.trace_records[0].kind, EventTraceKind::Delivery);
+  EXPECT_EQ(log.strings[log.trace_records[0].module], "app");
+  EXPECT_EQ(log.strings[log.trace_records[0].msg_type], "omnetpp::cMessage");
+  EXPECT_EQ(log.trace_records[0].msg_kind, 3);
+  EXPECT_EQ(log.trace_records[0].dest_addr, -1);
+  EXPECT_EQ(log.strings[log.trace_records[1].module], "router");
+}
+
+TEST_F(EventTraceTest, ReplayTheStimuliByModule) {
+  {
+    EventTrace trace(std::make_shared<BinaryLogWriter>(filename));
+    omnetpp::cNamedObject app1("app1"), app2("app2");
+    trace.stimulus(&app1, 5, 10);
+    trace.stimulus(&app2, 7, 3);
+    trace.stimulus(&app1, 6, 1);
+    EXPECT_EQ(trace.numDeliveries(), 0);
+  }
+
+  EventReplay replay(filename);
+  EXPECT_EQ(replay.numStimuli(), 3);
+  auto &stimuli = replay.stimuliOf("app1");
+  ASSERT_EQ(stimuli.size(), 2);
+  EXPECT_EQ(stimuli[0].time, omnetpp::simTime());
+  EXPECT_EQ(stimuli[0].dest_addr, 5);
+  EXPECT_EQ(stimuli[0].num_pairs, 10);
+  EXPECT_EQ(stimuli[1].dest_addr, 6);
+  EXPECT_EQ(replay.stimuliOf("app2").size(), 1);
+  EXPECT_TRUE(replay.stimuliOf("app3").empty());
+  EXPECT_THROW(EventReplay("no_such_event_trace.blog"), omnetpp::cRuntimeError);
+}
+
+}  // namespace
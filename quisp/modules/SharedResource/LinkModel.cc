@@ -0,0 +1,28 @@
+#include "LinkModel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace quisp::modules::SharedResource {
+
+double LinkModel::getSecPerBellPair(const LinkParameters &params) {
+  auto it = sec_per_bell_pair.find(params);
+  if (it != sec_per_bell_pair.end()) return it->second;
+  return sec_per_bell_pair[params] = calculateSecPerBellPair(params);
+}
+
+double LinkModel::calculateSecPerBellPair(const LinkParameters &params) {
+  double round_trip_sec = 2 * params.distance_km / params.speed_of_light_in_fiber_km_per_sec;
+  double photon_detection_probability = photonArrivalProbability(params) * params.detection_efficiency;
+  double no_darkcount_probability = (1 - params.darkcount_probability) * (1 - params.darkcount_probability);
+  double success_probability = 0.5 * photon_detection_probability * photon_detection_probability * no_darkcount_probability;
+  if (success_probability <= 0) return std::numeric_limits<double>::infinity();
+  return round_trip_sec / (std::max(params.num_qubits, 1) * success_probability);
+}
+
+double LinkModel::photonArrivalProbability(const LinkParameters &params) {
+  return params.emission_success_probability * std::pow(1 - params.channel_loss_rate, params.distance_km) * params.collection_efficiency;
+}
+
+}  // namespace quisp::modules::SharedResource
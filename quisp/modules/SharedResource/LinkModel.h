@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <map>
+#include <tuple>
+
+namespace quisp::modules::SharedResource {
+
+/// @brief the physical parameters of a quantum link, from a qnic to the BSA.
+struct LinkParameters {
+  double distance_km = 0;
+  double speed_of_light_in_fiber_km_per_sec = 208189.206944;
+  // the photon loss probability per km
+  double channel_loss_rate = 0;
+  double emission_success_probability = 1;
+  double collection_efficiency = 1;
+  double detection_efficiency = 1;
+  double darkcount_probability = 0;
+  // the photons emitted per round, one per qubit in the qnic
+  int num_qubits = 1;
+
+  auto tie() const {
+    return std::tie(distance_km, speed_of_light_in_fiber_km_per_sec, channel_loss_rate, emission_success_probability, collection_efficiency, detection_efficiency,
+                    darkcount_probability, num_qubits);
+  }
+  bool operator<(const LinkParameters &other) const { return tie() < other.tie(); }
+};
+
+/**
+ * @brief LinkModel estimates the seconds per Bell pair of a link analytically, for the link weights of the routing.
+ *
+ * A round takes the round trip time to the BSA, and each qubit of the qnic sends a photon per round.
+ * A photon arrives and gets detected with the probability
+ * emission_success_probability * (1 - channel_loss_rate)^distance * collection_efficiency * detection_efficiency,
+ * and the BSA succeeds for half of the pairs of arrived photons from both sides (only Psi+/- are distinguishable).
+ * The successes caused by dark counts are not counted, as they don't make useful Bell pairs.
+ *
+ * Most of the links in a network share the parameters, so the result is computed once per distinct parameters.
+ */
+class LinkModel {
+ public:
+  /// @brief the cached seconds per Bell pair, or infinity if the link never succeeds.
+  double getSecPerBellPair(const LinkParameters &params);
+  static double calculateSecPerBellPair(const LinkParameters &params);
+  /// @brief the probability that a photon of the qnic reaches the detector of the BSA, before the detection efficiency.
+  static double photonArrivalProbability(const LinkParameters &params);
+  std::size_t numCachedLinks() const { return sec_per_bell_pair.size(); }
+
+ private:
+  std::map<LinkParameters, double> sec_per_bell_pair;
+};
+
+}  // namespace quisp::modules::SharedResource
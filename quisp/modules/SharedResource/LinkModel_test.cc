@@ -0,0 +1,44 @@
+#include "LinkModel.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+
+namespace {
+using quisp::modules::SharedResource::LinkModel;
+using quisp::modules::SharedResource::LinkParameters;
+
+TEST(LinkModelTest, SecPerBellPair) {
+  LinkParameters params;
+  params.distance_km = 10;
+  params.speed_of_light_in_fiber_km_per_sec = 200000;
+  params.num_qubits = 4;
+  // a round trip is 100us, 4 photons per round and half of them succeed
+  EXPECT_DOUBLE_EQ(LinkModel::calculateSecPerBellPair(params), 1e-4 / 4 / 0.5);
+
+  params.channel_loss_rate = 0.1;
+  params.emission_success_probability = 0.5;
+  params.detection_efficiency = 0.8;
+  params.darkcount_probability = 0.1;
+  double p = 0.5 * std::pow(0.9, 10) * 0.8;
+  EXPECT_DOUBLE_EQ(LinkModel::calculateSecPerBellPair(params), 1e-4 / 4 / (0.5 * p * p * 0.81));
+
+  EXPECT_DOUBLE_EQ(LinkModel::photonArrivalProbability(params), 0.5 * std::pow(0.9, 10));
+
+  params.detection_efficiency = 0;
+  EXPECT_TRUE(std::isinf(LinkModel::calculateSecPerBellPair(params)));
+}
+
+TEST(LinkModelTest, CachePerDistinctParameters) {
+  LinkModel model;
+  LinkParameters params;
+  params.distance_km = 10;
+  double sec = model.getSecPerBellPair(params);
+  EXPECT_DOUBLE_EQ(model.getSecPerBellPair(params), sec);
+  EXPECT_EQ(model.numCachedLinks(), 1);
+
+  params.num_qubits = 2;
+  EXPECT_DOUBLE_EQ(model.getSecPerBellPair(params), sec / 2);
+  EXPECT_EQ(model.numCachedLinks(), 2);
+}
+
+}  // namespace
@@ -0,0 +1,27 @@
+#include "LinkWorkers.h"
+
+#include <algorithm>
+
+namespace quisp::modules::SharedResource {
+
+LinkWorkers::Ticket LinkWorkers::submit(std::function<void()> job) {
+  queued_jobs.emplace_back(next_ticket, std::move(job));
+  return next_ticket++;
+}
+
+void LinkWorkers::wait(Ticket ticket) {
+  auto queued = std::find_if(queued_jobs.begin(), queued_jobs.end(), [ticket](auto &job) { return job.first == ticket; });
+  if (queued == queued_jobs.end()) return;
+  // the queue is taken first, so a failed batch doesn't run again
+  auto batch = std::move(queued_jobs);
+  queued_jobs.clear();
+  num_batches++;
+  num_jobs += batch.size();
+  pool.parallelFor(batch.size(), [&batch](std::size_t i) { batch[i].second(); });
+}
+
+void LinkWorkers::withdraw(Ticket ticket) {
+  queued_jobs.erase(std::remove_if(queued_jobs.begin(), queued_jobs.end(), [ticket](auto &job) { return job.first == ticket; }), queued_jobs.end());
+}
+
+}  // namespace quisp::modules::SharedResource
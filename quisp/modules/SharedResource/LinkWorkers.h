@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "utils/ThreadPool.h"
+
+namespace quisp::modules::SharedResource {
+
+/**
+ * @brief LinkWorkers runs the physical layer jobs of the links, e.g. the sampling of a round of photon trains, on a thread pool in batches.
+ *
+ * A link submits its job as soon as the inputs are known, and waits for it at the event that needs the result,
+ * which is at least the channel delay later. The first wait runs all the jobs queued by then in parallel,
+ * so the jobs of the links in the same window share one batch. A job must only touch the state of its own link
+ * and draw from a random stream of its own, then the results don't depend on the batches or the number of threads.
+ */
+class LinkWorkers {
+ public:
+  using Ticket = std::uint64_t;
+
+  /// @brief num_threads includes the simulation thread, so 1 runs the batches on it.
+  explicit LinkWorkers(int num_threads) : pool(num_threads) {}
+
+  Ticket submit(std::function<void()> job);
+  /// @brief runs the queued jobs if the job of the ticket hasn't run yet. The first exception of the batch is rethrown.
+  void wait(Ticket ticket);
+  /// @brief drops the job if it hasn't run, e.g. the round was reset.
+  void withdraw(Ticket ticket);
+
+  int numThreads() const { return pool.size(); }
+  long numBatches() const { return num_batches; }
+  long numJobs() const { return num_jobs; }
+
+ private:
+  utils::ThreadPool pool;
+  // in the order of the tickets
+  std::vector<std::pair<Ticket, std::function<void()>>> queued_jobs;
+  Ticket next_ticket = 0;
+  long num_batches = 0;
+  long num_jobs = 0;
+};
+
+}  // namespace quisp::modules::SharedResource
@@ -0,0 +1,44 @@
+#include "LinkWorkers.h"
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+using quisp::modules::SharedResource::LinkWorkers;
+
+TEST(LinkWorkersTest, FirstWaitRunsTheQueuedJobs) {
+  LinkWorkers workers{4};
+  std::vector<int> results(3, 0);
+  auto first = workers.submit([&]() { results[0] = 1; });
+  auto second = workers.submit([&]() { results[1] = 2; });
+  auto third = workers.submit([&]() { results[2] = 3; });
+  workers.withdraw(third);
+  EXPECT_EQ(results, (std::vector<int>{0, 0, 0}));
+
+  workers.wait(second);
+  EXPECT_EQ(results, (std::vector<int>{1, 2, 0}));
+  // the job already ran in the batch of the other one
+  workers.wait(first);
+  EXPECT_EQ(workers.numBatches(), 1);
+  EXPECT_EQ(workers.numJobs(), 2);
+
+  // a withdrawn job never runs
+  workers.wait(third);
+  workers.wait(workers.submit([]() {}));
+  EXPECT_EQ(results[2], 0);
+  EXPECT_EQ(workers.numBatches(), 2);
+}
+
+TEST(LinkWorkersTest, RethrowException) {
+  LinkWorkers workers{2};
+  auto ticket = workers.submit([]() { throw std::runtime_error("failed"); });
+  EXPECT_THROW(workers.wait(ticket), std::runtime_error);
+  // the failed batch is gone
+  EXPECT_NO_THROW(workers.wait(ticket));
+  int result = 0;
+  workers.wait(workers.submit([&]() { result = 1; }));
+  EXPECT_EQ(result, 1);
+}
+
+}  // namespace
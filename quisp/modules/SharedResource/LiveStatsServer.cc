@@ -0,0 +1,75 @@
+#include "LiveStatsServer.h"
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace quisp::modules::SharedResource {
+
+namespace {
+// how often the thread checks whether it's stopped
+constexpr int poll_timeout_ms = 100;
+}  // namespace
+
+LiveStatsServer::LiveStatsServer(const std::string &socket_path) : socket_path(socket_path), snapshot(std::make_shared<const std::string>("{}\n")) {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (socket_path.empty() || socket_path.size() >= sizeof(address.sun_path)) throw std::runtime_error("invalid live stats socket path: " + socket_path);
+  std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+  listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listen_fd < 0) throw std::runtime_error("cannot create the live stats socket: " + std::string(std::strerror(errno)));
+  // the socket file of a previous run that didn't exit cleanly
+  ::unlink(socket_path.c_str());
+  if (::bind(listen_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 || ::listen(listen_fd, 8) < 0) {
+    auto message = std::string(std::strerror(errno));
+    ::close(listen_fd);
+    throw std::runtime_error("cannot listen on the live stats socket " + socket_path + ": " + message);
+  }
+  thread = std::thread([this]() { serve(); });
+}
+
+LiveStatsServer::~LiveStatsServer() {
+  stopping = true;
+  if (thread.joinable()) thread.join();
+  ::close(listen_fd);
+  ::unlink(socket_path.c_str());
+}
+
+void LiveStatsServer::publish(std::string new_snapshot) {
+  std::shared_ptr<const std::string> next = std::make_shared<const std::string>(std::move(new_snapshot));
+  std::atomic_store(&snapshot, std::move(next));
+}
+
+std::shared_ptr<const std::string> LiveStatsServer::latest() const { return std::atomic_load(&snapshot); }
+
+void LiveStatsServer::serve() {
+  while (!stopping) {
+    pollfd listening{listen_fd, POLLIN, 0};
+    if (::poll(&listening, 1, poll_timeout_ms) <= 0 || (listening.revents & POLLIN) == 0) continue;
+    int client_fd = ::accept(listen_fd, nullptr, nullptr);
+    if (client_fd < 0) continue;
+    respond(client_fd);
+    ::close(client_fd);
+  }
+}
+
+void LiveStatsServer::respond(int client_fd) {
+  // a client that doesn't read must not hold the thread, so the destructor can join it
+  timeval timeout{1, 0};
+  ::setsockopt(client_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+  auto current = latest();
+  std::size_t written = 0;
+  while (written < current->size()) {
+    auto n = ::send(client_fd, current->data() + written, current->size() - written, MSG_NOSIGNAL);
+    if (n <= 0) return;
+    written += n;
+  }
+}
+
+}  // namespace quisp::modules::SharedResource
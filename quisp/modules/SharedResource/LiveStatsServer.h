@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace quisp::modules::SharedResource {
+
+/**
+ * @brief LiveStatsServer serves the latest snapshot of the simulation statistics on a Unix socket, for watching a long run.
+ *
+ * A sidecar thread accepts the clients, writes the snapshot and closes the connection, e.g.
+ *
+ *     nc -U quisp_stats.sock
+ *
+ * The simulation thread only hands over the snapshot it formatted, the thread never touches the simulation
+ * and the event loop never waits for a client.
+ */
+class LiveStatsServer {
+ public:
+  /// @brief listens on the socket at the path, replacing a stale socket file. Throws std::runtime_error if it can't.
+  explicit LiveStatsServer(const std::string &socket_path);
+  /// @brief stops the thread and removes the socket file.
+  ~LiveStatsServer();
+  LiveStatsServer(const LiveStatsServer &) = delete;
+  LiveStatsServer &operator=(const LiveStatsServer &) = delete;
+
+  /// @brief replaces the snapshot the clients get. It swaps a pointer, the old snapshot is freed by whichever thread drops it last.
+  void publish(std::string snapshot);
+  std::shared_ptr<const std::string> latest() const;
+  const std::string &socketPath() const { return socket_path; }
+
+ private:
+  void serve();
+  void respond(int client_fd);
+
+  std::string socket_path;
+  int listen_fd = -1;
+  std::atomic<bool> stopping{false};
+  // read and written with std::atomic_load and std::atomic_store
+  std::shared_ptr<const std::string> snapshot;
+  std::thread thread;
+};
+
+}  // namespace quisp::modules::SharedResource
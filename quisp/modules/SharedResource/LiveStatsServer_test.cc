@@ -0,0 +1,56 @@
+#include "LiveStatsServer.h"
+
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace {
+using quisp::modules::SharedResource::LiveStatsServer;
+
+std::string socketPath() { return "/tmp/quisp_live_stats_test_" + std::to_string(::getpid()) + ".sock"; }
+
+// connects to the server and reads until it closes the connection
+std::string fetch(const std::string &path) {
+  int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+  if (::connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0) {
+    ::close(fd);
+    return "connect failed";
+  }
+  std::string response;
+  char buffer[256];
+  ssize_t n;
+  while ((n = ::read(fd, buffer, sizeof(buffer))) > 0) response.append(buffer, n);
+  ::close(fd);
+  return response;
+}
+
+TEST(LiveStatsServerTest, ServeTheLatestSnapshot) {
+  auto path = socketPath();
+  {
+    LiveStatsServer server(path);
+    EXPECT_EQ(fetch(path), "{}\n");
+    server.publish("{\"events\": 1}\n");
+    EXPECT_EQ(fetch(path), "{\"events\": 1}\n");
+    // larger than the socket buffer of a single write
+    std::string large(1 << 20, 'x');
+    server.publish(large);
+    EXPECT_EQ(fetch(path), large);
+  }
+  // the socket file is removed with the server
+  EXPECT_NE(::access(path.c_str(), F_OK), 0);
+}
+
+TEST(LiveStatsServerTest, RejectInvalidPath) {
+  EXPECT_THROW(LiveStatsServer(""), std::runtime_error);
+  EXPECT_THROW(LiveStatsServer("/no/such/directory/quisp.sock"), std::runtime_error);
+  EXPECT_THROW(LiveStatsServer(std::string(200, 'a')), std::runtime_error);
+}
+
+}  // namespace
@@ -0,0 +1,28 @@
+#include "MemoryAccounting.h"
+#include <algorithm>
+#include <utility>
+
+namespace quisp::modules::SharedResource {
+
+void MemoryAccounting::addReporter(Reporter reporter) { reporters.push_back(std::move(reporter)); }
+
+MemoryAccounting::Usage MemoryAccounting::collect() {
+  Usage usage;
+  for (auto &reporter : reporters) reporter(usage);
+  for (auto &[subsystem, footprint] : usage) {
+    auto &peak = peak_usage[subsystem];
+    peak.objects = std::max(peak.objects, footprint.objects);
+    peak.bytes = std::max(peak.bytes, footprint.bytes);
+  }
+  num_collects++;
+  return usage;
+}
+
+void MemoryAccounting::forEachCounter(const std::function<void(const std::string &, double)> &f) const {
+  for (auto &[subsystem, peak] : peak_usage) {
+    f("memory " + subsystem + " peak objects", peak.objects);
+    f("memory " + subsystem + " peak bytes", peak.bytes);
+  }
+}
+
+}  // namespace quisp::modules::SharedResource
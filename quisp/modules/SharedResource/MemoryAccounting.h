@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace quisp::modules::SharedResource {
+
+/**
+ * @brief MemoryAccounting sums up the live objects and the approximate heap bytes of the subsystems of the nodes,
+ * e.g. the backend qubits, the Runtimes and the Bell pair stores, to find what grows in a long run.
+ *
+ * The modules add a reporter in their initialize(), which adds the footprints of their structures by the subsystem name.
+ * SharedResource collects them every memory_report_interval into the vectors, and records the peaks as scalars.
+ * The bytes are estimates by the container sizes, see utils/MemoryUsage.h.
+ */
+class MemoryAccounting {
+ public:
+  struct Footprint {
+    std::size_t objects = 0;
+    std::size_t bytes = 0;
+    Footprint &operator+=(const Footprint &other) {
+      objects += other.objects;
+      bytes += other.bytes;
+      return *this;
+    }
+  };
+  // subsystem -> the sum of its footprints over the nodes
+  using Usage = std::map<std::string, Footprint>;
+  using Reporter = std::function<void(Usage &)>;
+
+  /// @brief the reporter is called in every collect(), so it must not outlive the structures it reports, e.g. a module's.
+  void addReporter(Reporter reporter);
+  /// @brief calls all the reporters, and updates the peaks.
+  Usage collect();
+  /// @brief the largest objects and bytes of each subsystem over the collects, not necessarily at the same time.
+  const Usage &peaks() const { return peak_usage; }
+  std::size_t numCollects() const { return num_collects; }
+
+  /// @brief calls f(name, value) for the peaks of each subsystem, e.g. to record them as scalars.
+  void forEachCounter(const std::function<void(const std::string &, double)> &f) const;
+
+ protected:
+  std::vector<Reporter> reporters;
+  Usage peak_usage;
+  std::size_t num_collects = 0;
+};
+
+}  // namespace quisp::modules::SharedResource
@@ -0,0 +1,39 @@
+#include "MemoryAccounting.h"
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace {
+using quisp::modules::SharedResource::MemoryAccounting;
+
+TEST(MemoryAccountingTest, SumTheSubsystemsAndKeepThePeaks) {
+  MemoryAccounting accounting;
+  std::vector<int> runtimes_a = {1, 2, 3};
+  std::vector<int> runtimes_b = {4};
+  // two nodes report the same subsystem, one of them another one too
+  accounting.addReporter([&](MemoryAccounting::Usage &usage) { usage["runtimes"] += {runtimes_a.size(), runtimes_a.size() * 100}; });
+  accounting.addReporter([&](MemoryAccounting::Usage &usage) {
+    usage["runtimes"] += {runtimes_b.size(), runtimes_b.size() * 100};
+    usage["bell pair store"] += {2, 64};
+  });
+
+  auto usage = accounting.collect();
+  ASSERT_EQ(usage.size(), 2);
+  EXPECT_EQ(usage["runtimes"].objects, 4);
+  EXPECT_EQ(usage["runtimes"].bytes, 400);
+  EXPECT_EQ(usage["bell pair store"].objects, 2);
+
+  runtimes_a.clear();
+  usage = accounting.collect();
+  EXPECT_EQ(usage["runtimes"].objects, 1);
+  EXPECT_EQ(accounting.peaks().at("runtimes").objects, 4);
+  EXPECT_EQ(accounting.peaks().at("runtimes").bytes, 400);
+  EXPECT_EQ(accounting.numCollects(), 2);
+
+  std::vector<std::string> names;
+  accounting.forEachCounter([&](const std::string &name, double value) { names.push_back(name); });
+  EXPECT_EQ(names, (std::vector<std::string>{"memory bell pair store peak objects", "memory bell pair store peak bytes", "memory runtimes peak objects", "memory runtimes peak bytes"}));
+}
+
+}  // namespace
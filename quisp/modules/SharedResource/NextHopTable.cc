@@ -0,0 +1,198 @@
+#include "NextHopTable.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <queue>
+#include <tuple>
+
+namespace quisp::modules::SharedResource {
+
+namespace {
+// FNV-1a over the bytes of the value
+template <typename T>
+void hashValue(std::uint64_t &hash, const T &value) {
+  unsigned char bytes[sizeof(T)];
+  std::memcpy(bytes, &value, sizeof(T));
+  for (auto byte : bytes) hash = (hash ^ byte) * 1099511628211ull;
+}
+constexpr std::uint64_t fnv_offset_basis = 14695981039346656037ull;
+}  // namespace
+
+PathGraph::PathGraph(cTopology *topo) : node_weights(topo->getNumNodes()), node_enabled(topo->getNumNodes()), in_links(topo->getNumNodes()) {
+  std::unordered_map<const cTopology::Node *, int> node_index;
+  std::unordered_map<const cTopology::Link *, std::int16_t> out_index;
+  for (int i = 0; i < getNumNodes(); i++) {
+    auto *node = topo->getNode(i);
+    node_index[node] = i;
+    node_weights[i] = node->getWeight();
+    node_enabled[i] = node->isEnabled();
+    for (int link = 0; link < node->getNumOutLinks(); link++) {
+      if (link > std::numeric_limits<std::int16_t>::max()) throw cRuntimeError("NextHopTable: too many links of %s", node->getModule()->getFullPath().c_str());
+      out_index[node->getLinkOut(link)] = link;
+    }
+  }
+  for (int dst = 0; dst < getNumNodes(); dst++) {
+    auto *node = topo->getNode(dst);
+    for (int i = 0; i < node->getNumInLinks(); i++) {
+      auto *link = node->getLinkIn(i);
+      if (!link->isEnabled()) continue;
+      in_links[dst].push_back({node_index.at(link->getRemoteNode()), out_index.at(link), link->getWeight()});
+    }
+  }
+}
+
+void PathGraph::calculatePathsTo(int dst, std::int16_t *next_links, double *distances) const {
+  constexpr double infinity = std::numeric_limits<double>::infinity();
+  int num_nodes = getNumNodes();
+  std::fill(next_links, next_links + num_nodes, -1);
+  std::fill(distances, distances + num_nodes, infinity);
+  // cTopology keeps the queue as a list sorted by the distance, inserting a node after the ones of the same distance.
+  // The sequence number of the insertion gives the same order, and a node inserted again leaves its old entry stale.
+  using Entry = std::tuple<double, std::uint64_t, int>;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+  std::vector<std::uint64_t> inserted_at(num_nodes, 0);
+  std::uint64_t sequence = 0;
+  distances[dst] = 0;
+  queue.emplace(0, inserted_at[dst] = ++sequence, dst);
+  while (!queue.empty()) {
+    auto [distance, inserted, node] = queue.top();
+    queue.pop();
+    if (inserted != inserted_at[node]) continue;
+    inserted_at[node] = 0;
+    for (auto &link : in_links[node]) {
+      if (!node_enabled[link.src]) continue;
+      double new_distance = distance + link.weight;
+      if (node != dst) new_distance += node_weights[node];
+      if (new_distance == infinity || !(distances[link.src] > new_distance)) continue;
+      distances[link.src] = new_distance;
+      next_links[link.src] = link.src_out_index;
+      queue.emplace(new_distance, inserted_at[link.src] = ++sequence, link.src);
+    }
+  }
+}
+
+std::uint64_t PathGraph::fingerprint() const {
+  std::uint64_t hash = fnv_offset_basis;
+  hashValue(hash, getNumNodes());
+  for (int node = 0; node < getNumNodes(); node++) {
+    hashValue(hash, node_weights[node]);
+    hashValue(hash, static_cast<bool>(node_enabled[node]));
+    hashValue(hash, in_links[node].size());
+    for (auto &link : in_links[node]) {
+      hashValue(hash, link.src);
+      hashValue(hash, link.src_out_index);
+      hashValue(hash, link.weight);
+    }
+  }
+  return hash;
+}
+
+NextHopTable::NextHopTable(cTopology *topo, utils::ThreadPool *pool)
+    : num_nodes(topo->getNumNodes()), next_links((std::size_t)num_nodes * num_nodes, no_link), distances((std::size_t)num_nodes * num_nodes, std::numeric_limits<double>::infinity()) {
+  for (int i = 0; i < num_nodes; i++) node_index[topo->getNode(i)] = i;
+  if (pool == nullptr || pool->size() <= 1) {
+    for (int dst = 0; dst < num_nodes; dst++) calculatePathsTo(topo, dst);
+    return;
+  }
+  // each destination fills its own rows, from the read only graph
+  PathGraph graph(topo);
+  pool->parallelFor(num_nodes, [&](std::size_t dst) {
+    auto offset = dst * num_nodes;
+    graph.calculatePathsTo(dst, next_links.data() + offset, distances.data() + offset);
+  });
+}
+
+void NextHopTable::calculatePathsTo(cTopology *topo, int dst) {
+  // Overwrites getNumPaths() and getPath() of all the nodes towards dst.
+  topo->calculateWeightedSingleShortestPathsTo(topo->getNode(dst));
+  for (int src = 0; src < num_nodes; src++) {
+    auto index = (std::size_t)dst * num_nodes + src;
+    auto *node = topo->getNode(src);
+    next_links[index] = no_link;
+    distances[index] = src == dst ? 0 : node->getDistanceToTarget();
+    if (src == dst || node->getNumPaths() == 0) continue;
+    auto *path = node->getPath(0);
+    for (int link = 0; link < node->getNumOutLinks(); link++) {
+      if (node->getLinkOut(link) != path) continue;
+      if (link > std::numeric_limits<std::int16_t>::max()) throw cRuntimeError("NextHopTable: too many links of %s", node->getModule()->getFullPath().c_str());
+      next_links[index] = link;
+      break;
+    }
+  }
+}
+
+NextHopTable::NextHopTable(const NextHopTable &table, cTopology *topo) : num_nodes(table.num_nodes), next_links(table.next_links), distances(table.distances) {
+  if (topo->getNumNodes() != num_nodes) throw cRuntimeError("NextHopTable: the topology has %d nodes, not %d of the table", topo->getNumNodes(), num_nodes);
+  for (int i = 0; i < num_nodes; i++) node_index[topo->getNode(i)] = i;
+}
+
+std::uint64_t NextHopTable::fingerprint(cTopology *topo) {
+  auto hash = PathGraph(topo).fingerprint();
+  for (int i = 0; i < topo->getNumNodes(); i++) {
+    for (auto c : topo->getNode(i)->getModule()->getFullPath()) hashValue(hash, c);
+  }
+  return hash;
+}
+
+/**
+ * @details The paths towards a destination form a tree, so a path through the link from any node
+ * means the link is the next hop of its local node. An enabled link shortens a path only if
+ * its weight and the distance of its remote node are less than the distance of its local node.
+ */
+int NextHopTable::updateLink(cTopology *topo, cTopology::LinkOut *link) {
+  auto *local_node = link->getLocalNode();
+  int local = indexOf(local_node), remote = indexOf(link->getRemoteNode());
+  if (local < 0 || remote < 0) return 0;
+  int link_index = 0;
+  while (link_index < local_node->getNumOutLinks() && local_node->getLinkOut(link_index) != link) link_index++;
+
+  int num_updated = 0;
+  for (int dst = 0; dst < num_nodes; dst++) {
+    auto offset = (std::size_t)dst * num_nodes;
+    bool was_next_hop = next_links[offset + local] == link_index;
+    bool is_shorter = link->isEnabled() && link->getWeight() + distances[offset + remote] < distances[offset + local];
+    if (!was_next_hop && !is_shorter) continue;
+    calculatePathsTo(topo, dst);
+    num_updated++;
+  }
+  if (num_updated > 0) version++;
+  return num_updated;
+}
+
+cTopology::LinkOut *NextHopTable::getNextHop(cTopology::Node *src, cTopology::Node *dst) const {
+  int src_index = indexOf(src), dst_index = indexOf(dst);
+  if (src_index < 0 || dst_index < 0) return nullptr;
+  auto link = next_links[(std::size_t)dst_index * num_nodes + src_index];
+  if (link == no_link) return nullptr;
+  return src->getLinkOut(link);
+}
+
+std::vector<cTopology::LinkOut *> NextHopTable::getEqualCostNextHops(cTopology::Node *src, cTopology::Node *dst) const {
+  std::vector<cTopology::LinkOut *> links;
+  auto *next_hop = getNextHop(src, dst);
+  if (next_hop == nullptr) return links;
+  links.push_back(next_hop);
+  auto offset = (std::size_t)indexOf(dst) * num_nodes;
+  double distance = distances[offset + indexOf(src)];
+  // the distances are sums of the same weights in another order, so they may differ in the last bits
+  double tolerance = distance * 1e-9;
+  for (int i = 0; i < src->getNumOutLinks(); i++) {
+    auto *link = src->getLinkOut(i);
+    auto *remote = link->getRemoteNode();
+    int remote_index = indexOf(remote);
+    if (link == next_hop || !link->isEnabled() || !remote->isEnabled() || remote_index < 0) continue;
+    double remote_distance = distances[offset + remote_index];
+    if (!(remote_distance < distance - tolerance)) continue;
+    double via_remote = link->getWeight() + remote_distance + (remote == dst ? 0 : remote->getWeight());
+    if (via_remote <= distance + tolerance) links.push_back(link);
+  }
+  return links;
+}
+
+int NextHopTable::indexOf(cTopology::Node *node) const {
+  auto it = node_index.find(node);
+  if (it == node_index.end()) return -1;
+  return it->second;
+}
+
+}  // namespace quisp::modules::SharedResource
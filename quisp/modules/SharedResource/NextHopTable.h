@@ -0,0 +1,98 @@
+#pragma once
+#include <omnetpp.h>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "utils/ThreadPool.h"
+
+using namespace omnetpp;
+
+namespace quisp::modules::SharedResource {
+
+/**
+ * @brief PathGraph is a snapshot of the links of a cTopology for the shortest paths towards a destination,
+ * so the destinations can run on threads without touching the cTopology, which keeps the state of one run in its nodes.
+ *
+ * calculatePathsTo() finds the same paths as cTopology::calculateWeightedSingleShortestPathsTo, the equal ones included:
+ * the nodes are settled in the order of the distance and then of the insertion to the queue, and only a shorter path replaces one.
+ */
+struct PathGraph {
+  struct InLink {
+    int src;
+    // the index of the link in the out links of src
+    std::int16_t src_out_index;
+    double weight;
+  };
+  // the weight of routing through the node, and whether it's enabled
+  std::vector<double> node_weights;
+  std::vector<bool> node_enabled;
+  // [dst] -> the enabled links into dst in the order of cTopology::Node::getLinkIn
+  std::vector<std::vector<InLink>> in_links;
+
+  PathGraph() = default;
+  explicit PathGraph(cTopology *topo);
+  int getNumNodes() const { return node_weights.size(); }
+  /// @brief fills next_links[src] and distances[src] of all the nodes towards dst, -1 and infinity if unreachable.
+  void calculatePathsTo(int dst, std::int16_t *next_links, double *distances) const;
+  /// @brief a hash of the node weights, the enabled nodes and the links, equal for the graphs with the same shortest paths.
+  std::uint64_t fingerprint() const;
+};
+
+/**
+ * @brief NextHopTable keeps the first link of a shortest path between every pair of nodes in a cTopology.
+ *
+ * A Dijkstra run towards a destination gives the next hop of all the nodes at once,
+ * so the whole table costs one run per destination, instead of each Router and RoutingDaemon
+ * running it towards every destination by itself. The next hop is stored as the index of
+ * the source node's out link, 2 bytes per pair, with the distance of the path.
+ *
+ * The table is a snapshot of the link weights at the construction, until updateLink() is called for a changed link.
+ * With a pool, the destinations of the construction run on its threads on a PathGraph of the topology.
+ */
+class NextHopTable {
+ public:
+  explicit NextHopTable(cTopology *topo, utils::ThreadPool *pool = nullptr);
+  /**
+   * @brief the copy of the table for topo, a topology with the same fingerprint() in another run, e.g. the next replication of the process.
+   * @throws cRuntimeError if topo has a different number of nodes
+   */
+  NextHopTable(const NextHopTable &table, cTopology *topo);
+
+  /// @brief the fingerprint of the PathGraph of the topology and the paths of the node modules.
+  static std::uint64_t fingerprint(cTopology *topo);
+
+  /// @brief the out link of src on a shortest path to dst, or nullptr if dst is src or unreachable.
+  cTopology::LinkOut *getNextHop(cTopology::Node *src, cTopology::Node *dst) const;
+
+  /**
+   * @brief all the out links of src on a shortest path to dst, getNextHop() first and the rest in the order of the out links.
+   * A link is on one if its weight, the weight of its remote node and the distance of the remote node add up to the distance of src.
+   * The other links also have to get closer to dst, so the packets spread on them never loop. Empty if dst is src or unreachable.
+   */
+  std::vector<cTopology::LinkOut *> getEqualCostNextHops(cTopology::Node *src, cTopology::Node *dst) const;
+
+  /**
+   * @brief recomputes the destinations whose shortest paths may go differently after the link is enabled, disabled or reweighted.
+   * Those are the destinations the link was the next hop to, and the ones the enabled link gives a shorter path to.
+   * @return the number of the recomputed destinations.
+   */
+  int updateLink(cTopology *topo, cTopology::LinkOut *link);
+
+  /// @brief incremented by each updateLink() that recomputed a destination, so that the users can refresh what they derived from the table.
+  std::uint64_t getVersion() const { return version; }
+
+ private:
+  static constexpr std::int16_t no_link = -1;
+  int indexOf(cTopology::Node *node) const;
+  void calculatePathsTo(cTopology *topo, int dst);
+
+  int num_nodes;
+  std::unordered_map<const cTopology::Node *, int> node_index;
+  // [dst * num_nodes + src] -> out link index of src
+  std::vector<std::int16_t> next_links;
+  // [dst * num_nodes + src] -> distance of the shortest path
+  std::vector<double> distances;
+  std::uint64_t version = 0;
+};
+
+}  // namespace quisp::modules::SharedResource
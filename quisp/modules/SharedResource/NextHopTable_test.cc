@@ -0,0 +1,112 @@
+#include "NextHopTable.h"
+
+#include <gtest/gtest.h>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+using quisp::modules::SharedResource::PathGraph;
+using quisp::utils::ThreadPool;
+
+// a graph of num_nodes without links, each node routes for free
+PathGraph makeGraph(int num_nodes) {
+  PathGraph graph;
+  graph.node_weights.assign(num_nodes, 0);
+  graph.node_enabled.assign(num_nodes, true);
+  graph.in_links.resize(num_nodes);
+  return graph;
+}
+
+// the link src -> dst, the next out link of src
+void addLink(PathGraph &graph, std::vector<std::int16_t> &num_out_links, int src, int dst, double weight) {
+  graph.in_links[dst].push_back({src, num_out_links[src]++, weight});
+}
+
+TEST(PathGraphTest, EqualPathsAsCTopology) {
+  // 0 -> 1 -> 3 and 0 -> 2 -> 3 cost the same, 3 takes the path through its first in link
+  auto graph = makeGraph(4);
+  std::vector<std::int16_t> num_out_links(4, 0);
+  addLink(graph, num_out_links, 0, 2, 1);
+  addLink(graph, num_out_links, 0, 1, 1);
+  addLink(graph, num_out_links, 1, 3, 1);
+  addLink(graph, num_out_links, 2, 3, 1);
+  std::vector<std::int16_t> next_links(4);
+  std::vector<double> distances(4);
+  graph.calculatePathsTo(3, next_links.data(), distances.data());
+  // the out link 1 of node 0 goes to node 1
+  EXPECT_EQ(next_links[0], 1);
+  EXPECT_EQ(next_links[1], 0);
+  EXPECT_EQ(next_links[2], 0);
+  EXPECT_EQ(next_links[3], -1);
+  EXPECT_EQ(distances[0], 2);
+  EXPECT_EQ(distances[3], 0);
+
+  // no path towards 0, and a disabled node doesn't route
+  graph.calculatePathsTo(0, next_links.data(), distances.data());
+  EXPECT_EQ(next_links[1], -1);
+  EXPECT_EQ(distances[1], std::numeric_limits<double>::infinity());
+  graph.node_enabled[1] = false;
+  graph.calculatePathsTo(3, next_links.data(), distances.data());
+  EXPECT_EQ(next_links[0], 0);
+  EXPECT_EQ(next_links[1], -1);
+}
+
+TEST(PathGraphTest, ShortestDistancesOnThreads) {
+  constexpr int num_nodes = 60;
+  auto graph = makeGraph(num_nodes);
+  std::vector<std::int16_t> num_out_links(num_nodes, 0);
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<int> node(0, num_nodes - 1);
+  std::uniform_int_distribution<int> weight(1, 4);
+  for (int i = 0; i < num_nodes * 4; i++) {
+    int src = node(rng), dst = node(rng);
+    if (src != dst) addLink(graph, num_out_links, src, dst, weight(rng));
+  }
+  graph.node_weights[5] = 2;
+
+  std::vector<std::int16_t> next_links(num_nodes * num_nodes), next_links_on_threads(num_nodes * num_nodes);
+  std::vector<double> distances(num_nodes * num_nodes), distances_on_threads(num_nodes * num_nodes);
+  for (int dst = 0; dst < num_nodes; dst++) graph.calculatePathsTo(dst, next_links.data() + dst * num_nodes, distances.data() + dst * num_nodes);
+  ThreadPool pool(4);
+  pool.parallelFor(num_nodes, [&](std::size_t dst) {
+    graph.calculatePathsTo(dst, next_links_on_threads.data() + dst * num_nodes, distances_on_threads.data() + dst * num_nodes);
+  });
+  EXPECT_EQ(next_links, next_links_on_threads);
+  EXPECT_EQ(distances, distances_on_threads);
+
+  // Bellman-Ford towards each destination, the weight of a node counts unless it's the destination
+  for (int dst = 0; dst < num_nodes; dst++) {
+    std::vector<double> expected(num_nodes, std::numeric_limits<double>::infinity());
+    expected[dst] = 0;
+    for (int round = 0; round < num_nodes; round++) {
+      for (int to = 0; to < num_nodes; to++) {
+        for (auto &link : graph.in_links[to]) {
+          double distance = expected[to] + link.weight + (to == dst ? 0 : graph.node_weights[to]);
+          if (distance < expected[link.src]) expected[link.src] = distance;
+        }
+      }
+    }
+    for (int src = 0; src < num_nodes; src++) EXPECT_EQ(distances[dst * num_nodes + src], expected[src]) << src << " -> " << dst;
+  }
+}
+
+TEST(PathGraphTest, FingerprintOfTheShortestPaths) {
+  auto make = [](double weight) {
+    auto graph = makeGraph(3);
+    std::vector<std::int16_t> num_out_links(3, 0);
+    addLink(graph, num_out_links, 0, 1, weight);
+    addLink(graph, num_out_links, 1, 2, 1);
+    return graph;
+  };
+  EXPECT_EQ(make(1).fingerprint(), make(1).fingerprint());
+  EXPECT_NE(make(1).fingerprint(), make(2).fingerprint());
+  auto graph = make(1);
+  graph.node_enabled[1] = false;
+  EXPECT_NE(graph.fingerprint(), make(1).fingerprint());
+  graph = make(1);
+  graph.node_weights[2] = 1;
+  EXPECT_NE(graph.fingerprint(), make(1).fingerprint());
+}
+
+}  // namespace
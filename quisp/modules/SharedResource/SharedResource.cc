@@ -1,17 +1,270 @@
 #include "SharedResource.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <nlohmann/json.hpp>
 #include <random>
+#include <stdexcept>
+#include <string>
 #include <vector>
+#include "channels/QuantumChannel.h"
+#include "modules/QRSA/HardwareMonitor/IHardwareMonitor.h"
+#include "modules/QRSA/RoutingDaemon/IRoutingDaemon.h"
 #include "omnetpp/ctopology.h"
 #include "utils/ComponentProvider.h"
+#include "utils/Validation.h"
 
 namespace quisp::modules::SharedResource {
 
+namespace {
+// the tables of the first run with each topology, kept until the process exits and shared by the simulations on its threads
+struct KeptNextHopTables {
+  std::mutex mutex;
+  // [NextHopTable::fingerprint of the topology] -> the table
+  std::unordered_map<std::uint64_t, std::unique_ptr<const NextHopTable>> tables;
+};
+
+KeptNextHopTables &keptNextHopTables() {
+  static KeptNextHopTables kept;
+  return kept;
+}
+}  // namespace
+
 SharedResource::SharedResource() {}
 
-SharedResource::~SharedResource() {}
+SharedResource::~SharedResource() {
+  if (connection_metrics != nullptr) connection_metrics->unsubscribe(getSimulation()->getSystemModule());
+  if (connection_controller != nullptr) connection_controller->unsubscribe(getSimulation()->getSystemModule());
+  cancelAndDelete(memory_report_timer);
+  cancelAndDelete(live_stats_timer);
+  // the next run on the thread starts with the full checks
+  utils::setValidationLevel(utils::ValidationLevel::Full);
+}
+
+void SharedResource::initialize() {
+  auto validation_level = utils::validationLevelByName(par("validation_level").stdstringValue());
+  if (!validation_level) error("unknown validation_level: %s", par("validation_level").stringValue());
+  utils::setValidationLevel(*validation_level);
+  if (par("record_connection_metrics").boolValue()) {
+    connection_metrics = std::make_unique<ConnectionMetricsCollector>();
+    connection_metrics->subscribe(getSimulation()->getSystemModule());
+  }
+  if (getEnvir()->getParsimNumPartitions() > 1) checkPartitioning();
+  if (getMemoryAccounting() != nullptr && memory_report_interval > SIMTIME_ZERO) {
+    memory_report_timer = new cMessage("memory_report_timer");
+    scheduleAt(simTime() + memory_report_interval, memory_report_timer);
+  }
+  if (!par("live_stats_socket").stdstringValue().empty()) startLiveStats();
+}
+
+void SharedResource::handleMessage(cMessage *msg) {
+  if (msg == memory_report_timer) {
+    reportMemoryUsage();
+    scheduleAt(simTime() + memory_report_interval, memory_report_timer);
+  } else if (msg == live_stats_timer) {
+    publishLiveStats();
+    scheduleAt(simTime() + live_stats_interval, live_stats_timer);
+  } else {
+    error("unexpected message: %s", msg->getName());
+  }
+}
+
+void SharedResource::startLiveStats() {
+  auto socket_path = par("live_stats_socket").stdstringValue();
+  if (getEnvir()->getParsimNumPartitions() > 1) socket_path += "." + std::to_string(getEnvir()->getParsimProcId());
+  live_stats_interval = par("live_stats_interval").doubleValue();
+  if (live_stats_interval <= SIMTIME_ZERO) error("live_stats_interval must be positive");
+  try {
+    live_stats_server = std::make_unique<LiveStatsServer>(socket_path);
+  } catch (const std::runtime_error &e) {
+    error("%s", e.what());
+  }
+  live_stats_published_at = std::chrono::steady_clock::now();
+  live_stats_events = getSimulation()->getEventNumber();
+  publishLiveStats();
+  live_stats_timer = new cMessage("live_stats_timer");
+  scheduleAt(simTime() + live_stats_interval, live_stats_timer);
+}
+
+// formats the snapshot on the simulation thread, the server thread only sends the string
+void SharedResource::publishLiveStats() {
+  auto now = std::chrono::steady_clock::now();
+  auto num_events = getSimulation()->getEventNumber();
+  double elapsed = std::chrono::duration<double>(now - live_stats_published_at).count();
+  nlohmann::json stats;
+  stats["partition"] = getEnvir()->getParsimProcId();
+  stats["sim_time"] = simTime().dbl();
+  stats["events"] = num_events;
+  stats["events_per_sec"] = elapsed > 0 ? (num_events - live_stats_events) / elapsed : 0.0;
+  stats["scheduled_events"] = getSimulation()->getFES()->getLength();
+
+  auto usage = memory_accounting->collect();
+  auto objects_of = [&](const std::string &subsystem) {
+    auto it = usage.find(subsystem);
+    return it == usage.end() ? 0 : it->second.objects;
+  };
+  stats["active_rulesets"] = objects_of("runtimes");
+  stats["queued_messages"] = objects_of("queued messages");
+  stats["memory"] = nlohmann::json::object();
+  for (auto &[subsystem, footprint] : usage) stats["memory"][subsystem] = {{"objects", footprint.objects}, {"bytes", footprint.bytes}};
+
+  if (connection_metrics != nullptr) {
+    stats["pairs_per_sec"] = connection_metrics->pairRate(simTime());
+    stats["connections"] = nlohmann::json::array();
+    for (auto &connection : connection_metrics->connectionStates()) {
+      stats["connections"].push_back({{"initiator", connection.initiator_addr},
+                                      {"request_id", connection.request_id},
+                                      {"pairs", connection.num_pairs},
+                                      {"established", connection.established},
+                                      {"terminated", connection.terminated}});
+    }
+  }
+  live_stats_server->publish(stats.dump() + "\n");
+  live_stats_published_at = now;
+  live_stats_events = num_events;
+}
 
-void SharedResource::initialize() {}
+void SharedResource::reportMemoryUsage() {
+  for (auto &[subsystem, footprint] : memory_accounting->collect()) {
+    auto record = [&](const std::string &name, double value) {
+      auto &vector = memory_vectors[name];
+      if (vector == nullptr) vector = std::make_unique<cOutVector>(name.c_str());
+      vector->record(value);
+    };
+    record("memory " + subsystem + " objects", footprint.objects);
+    record("memory " + subsystem + " bytes", footprint.bytes);
+  }
+}
+
+void SharedResource::checkPartitioning() {
+  auto *config = getEnvir()->getConfigEx();
+  auto partition_of = [&](cModule *node) {
+    const char *id = config->getPerObjectConfigValue(node->getFullPath().c_str(), "partition-id");
+    return std::string(id == nullptr ? "" : id);
+  };
+  std::vector<CrossPartitionChannel> crossing_channels;
+  for (cModule::SubmoduleIterator it(getSimulation()->getSystemModule()); !it.end(); ++it) {
+    cModule *node = *it;
+    for (cModule::GateIterator git(node); !git.end(); ++git) {
+      cGate *gate = *git;
+      if (gate->getType() != cGate::OUTPUT || gate->getChannel() == nullptr) continue;
+      cModule *neighbor = gate->getNextGate()->getOwnerModule();
+      if (partition_of(node) == partition_of(neighbor)) continue;
+      auto *channel = gate->getChannel();
+      double delay = 0;
+      if (auto *datarate_channel = dynamic_cast<cDatarateChannel *>(channel)) delay = datarate_channel->getDelay().dbl();
+      if (auto *delay_channel = dynamic_cast<cDelayChannel *>(channel)) delay = delay_channel->getDelay().dbl();
+      crossing_channels.push_back({channel->getFullPath(), node->getFullPath(), neighbor->getFullPath(), dynamic_cast<channels::QuantumChannel *>(channel) != nullptr, delay});
+    }
+  }
+  double lookahead = partitionLookahead(crossing_channels);
+  EV_INFO << "partition " << getEnvir()->getParsimProcId() << " lookahead: " << lookahead << "s\n";
+  if (std::isfinite(lookahead)) recordScalar("parsim lookahead", lookahead);
+}
+
+double SharedResource::partitionLookahead(const std::vector<CrossPartitionChannel> &channels) {
+  double lookahead = std::numeric_limits<double>::infinity();
+  for (auto &channel : channels) {
+    // entanglement is generated by direct calls between the qubits of the both ends, which cannot cross the processes
+    if (channel.quantum) {
+      throw cRuntimeError("the quantum channel %s crosses the partitions, place %s and %s in the same partition", channel.channel.c_str(), channel.node.c_str(),
+                          channel.neighbor.c_str());
+    }
+    // the null message protocol takes the lookahead from the delays of the channels between the partitions
+    if (channel.delay <= 0) {
+      throw cRuntimeError("the classical channel %s crosses the partitions without delay, no lookahead for the null message protocol", channel.channel.c_str());
+    }
+    lookahead = std::min(lookahead, channel.delay);
+  }
+  return lookahead;
+}
+
+uint64_t SharedResource::getStreamRNGSeed() {
+  std::call_once(stream_rng_seed_init_flag, [&]() {
+    stream_rng_seed = par("stream_rng_seed").intValue();
+    auto *config = getEnvir()->getConfigEx();
+    const char *seed_set = config == nullptr ? nullptr : config->getVariable("seedset");
+    // splitmix64 of the seed-set, so the repetitions of a run get unrelated streams
+    uint64_t z = (seed_set == nullptr ? 0 : std::strtoull(seed_set, nullptr, 10)) + 0x9E3779B97F4A7C15;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+    stream_rng_seed ^= z ^ (z >> 31);
+  });
+  return stream_rng_seed;
+}
+
+EventProfiler *SharedResource::getEventProfiler() {
+  // the modules fetch the profiler in their initialize(), which may run before this module's
+  std::call_once(event_profiler_init_flag, [&]() {
+    // the scopes of the profiler write the deliveries into the trace
+    auto *trace = getEventTrace();
+    if (par("profile_events").boolValue() || trace != nullptr) event_profiler = std::make_unique<EventProfiler>();
+    if (trace != nullptr) event_profiler->setTrace(trace);
+  });
+  return event_profiler.get();
+}
+
+LinkWorkers *SharedResource::getLinkWorkers() {
+  std::call_once(link_workers_init_flag, [&]() {
+    int num_threads = par("link_worker_threads");
+    if (num_threads < 0) error("link_worker_threads must not be negative: %d", num_threads);
+    if (num_threads > 0) link_workers = std::make_unique<LinkWorkers>(num_threads);
+  });
+  return link_workers.get();
+}
+
+ConnectionController *SharedResource::getConnectionController() {
+  std::call_once(connection_controller_init_flag, [&]() {
+    if (!par("centralized_connection_setup").boolValue()) return;
+    // the nodes of the other partitions aren't in this process
+    if (getEnvir()->getParsimNumPartitions() > 1) error("centralized_connection_setup needs a sequential simulation");
+    auto lookup = [this](int address) -> ConnectionController::Node {
+      auto *node = getQNodeWithAddress(address);
+      if (node == nullptr) return {};
+      auto *qrsa = node->getSubmodule("qrsa");
+      if (qrsa == nullptr) return {};
+      return {check_and_cast<IRoutingDaemon *>(qrsa->getSubmodule("rd")), check_and_cast<IHardwareMonitor *>(qrsa->getSubmodule("hm")), qrsa->getSubmodule("cm")};
+    };
+    connection_controller = std::make_unique<ConnectionController>(lookup, par("controller_delay"));
+    connection_controller->subscribe(getSimulation()->getSystemModule());
+  });
+  return connection_controller.get();
+}
+
+EventTrace *SharedResource::getEventTrace() {
+  std::call_once(event_trace_init_flag, [&]() {
+    auto filename = par("event_trace_filename").stdstringValue();
+    if (filename.empty()) return;
+    if (getEnvir()->getParsimNumPartitions() > 1) filename += "." + std::to_string(getEnvir()->getParsimProcId());
+    event_trace = std::make_unique<EventTrace>(std::make_shared<Logger::BinaryLogWriter>(filename));
+  });
+  return event_trace.get();
+}
+
+const EventReplay *SharedResource::getEventReplay() {
+  std::call_once(event_replay_init_flag, [&]() {
+    auto filename = par("event_replay_filename").stdstringValue();
+    if (filename.empty()) return;
+    if (getEnvir()->getParsimNumPartitions() > 1) filename += "." + std::to_string(getEnvir()->getParsimProcId());
+    event_replay = std::make_unique<EventReplay>(filename);
+    EV_INFO << "Replaying " << event_replay->numStimuli() << " connection requests of " << filename << "\n";
+  });
+  return event_replay.get();
+}
+
+MemoryAccounting *SharedResource::getMemoryAccounting() {
+  // the modules add their reporters in their initialize(), which may run before this module's
+  std::call_once(memory_accounting_init_flag, [&]() {
+    memory_report_interval = par("memory_report_interval").doubleValue();
+    // the live stats report the memory too
+    if (memory_report_interval > SIMTIME_ZERO || !par("live_stats_socket").stdstringValue().empty()) memory_accounting = std::make_unique<MemoryAccounting>();
+  });
+  return memory_accounting.get();
+}
 
 const std::unordered_map<int, int> SharedResource::getEndNodeWeightMapForApplication(const char *const node_type) {
   std::call_once(app_init_flag, [&]() {
@@ -31,6 +284,26 @@ const std::unordered_map<int, int> SharedResource::getEndNodeWeightMapForApplica
   return end_node_weight_map;
 }
 
+const AliasTable *SharedResource::getEndNodeSamplerForApplication(const char *const node_type) {
+  auto weight_map = getEndNodeWeightMapForApplication(node_type);
+  std::call_once(app_sampler_init_flag, [&]() {
+    // sorted by the address so that the samples don't depend on the hash order
+    std::map<int, int> sorted_weights(weight_map.begin(), weight_map.end());
+    std::vector<int> addresses;
+    std::vector<double> weights;
+    for (auto [address, weight] : sorted_weights) {
+      addresses.push_back(address);
+      weights.push_back(weight);
+    }
+    try {
+      end_node_sampler = std::make_unique<AliasTable>(std::move(addresses), weights);
+    } catch (const std::invalid_argument &e) {
+      error("no end node to send the requests to: %s", e.what());
+    }
+  });
+  return end_node_sampler.get();
+}
+
 cTopology *SharedResource::getTopologyForRouter() {
   std::call_once(router_init_flag, [&]() { updateChannelWeightsInTopology(router_topology, std::nullopt); });
   return router_topology;
@@ -41,6 +314,149 @@ cTopology *SharedResource::getTopologyForRoutingDaemon(const cModule *const rd_m
   return routingdaemon_topology;
 }
 
+const NextHopTable *SharedResource::getNextHopTableForRoutingDaemon(const cModule *const rd_module) {
+  auto *topo = getTopologyForRoutingDaemon(rd_module);
+  std::call_once(rd_next_hop_init_flag, [&]() { routingdaemon_next_hops = makeNextHopTable(topo); });
+  return routingdaemon_next_hops.get();
+}
+
+const NextHopTable *SharedResource::getNextHopTableForRouter() {
+  auto *topo = getTopologyForRouter();
+  std::call_once(router_next_hop_init_flag, [&]() { router_next_hops = makeNextHopTable(topo); });
+  return router_next_hops.get();
+}
+
+/**
+ * @details The first module that asks for the table builds it at the start, on init_threads threads for the large networks.
+ * With keep_tables_across_runs, the next runs of the process copy the kept table of the same fingerprint,
+ * so that the links changed by setQuantumLinkEnabled in one run don't leak into the others.
+ */
+std::unique_ptr<NextHopTable> SharedResource::makeNextHopTable(cTopology *topo) {
+  bool keeps_tables = par("keep_tables_across_runs");
+  std::uint64_t fingerprint = 0;
+  if (keeps_tables) {
+    fingerprint = NextHopTable::fingerprint(topo);
+    auto &kept = keptNextHopTables();
+    std::lock_guard<std::mutex> lock(kept.mutex);
+    auto it = kept.tables.find(fingerprint);
+    if (it != kept.tables.end()) return std::make_unique<NextHopTable>(*it->second, topo);
+  }
+  std::unique_ptr<NextHopTable> table;
+  int init_threads = par("init_threads");
+  if (init_threads <= 1) {
+    table = std::make_unique<NextHopTable>(topo);
+  } else {
+    utils::ThreadPool pool(init_threads);
+    table = std::make_unique<NextHopTable>(topo, &pool);
+  }
+  if (keeps_tables) {
+    // another simulation may have kept the same table meanwhile, the first one stays
+    auto &kept = keptNextHopTables();
+    std::lock_guard<std::mutex> lock(kept.mutex);
+    kept.tables.try_emplace(fingerprint, std::make_unique<NextHopTable>(*table, topo));
+  }
+  return table;
+}
+
+cModule *SharedResource::getQNodeWithAddress(int address) {
+  std::call_once(node_index_init_flag, [&]() { buildNodeIndex(); });
+  auto it = node_by_address.find(address);
+  if (it == node_by_address.end()) return nullptr;
+  return it->second;
+}
+
+int SharedResource::getNumEndNodes() {
+  std::call_once(node_index_init_flag, [&]() { buildNodeIndex(); });
+  return num_end_nodes;
+}
+
+// extracts the nodes once, instead of each module building its own cTopology to find a node.
+void SharedResource::buildNodeIndex() {
+  cTopology topo("topo");
+  topo.extractByParameter("included_in_topology", "\"yes\"");
+  for (int i = 0; i < topo.getNumNodes(); i++) {
+    cModule *node = topo.getNode(i)->getModule();
+    node_by_address[node->par("address").intValue()] = node;
+    if (node->par("node_type").stdstringValue() == "EndNode") num_end_nodes++;
+  }
+}
+
+/**
+ * @details Replaces the analytic weight with the estimate from the tomography.
+ * If the link goes through a BSA or EPPS node, both halves, node to BSA and BSA to neighbor, take a half of the cost,
+ * as calculateSecPerBellPair does.
+ */
+void SharedResource::setQuantumLinkCost(const cModule *const node, const cModule *const neighbor_node, double cost) {
+  for (auto *link : findQuantumLinks(node, neighbor_node)) link->setWeight(isHalfLink(link) ? cost / 2 : cost);
+  quantum_link_version++;
+}
+
+// the fidelity is of the whole link, so only the link or the half from the node takes it
+void SharedResource::setQuantumLinkFidelity(const cModule *const node, const cModule *const neighbor_node, double fidelity) {
+  for (auto *link : findQuantumLinks(node, neighbor_node)) {
+    if (link->getLocalNode()->getModule() == node) quantum_link_fidelities[link] = fidelity;
+  }
+  quantum_link_version++;
+}
+
+double SharedResource::getQuantumLinkFidelity(const cTopology::LinkOut *const link) const {
+  auto it = quantum_link_fidelities.find(link);
+  return it == quantum_link_fidelities.end() ? 1 : it->second;
+}
+
+// the link or its first half from the node, whose parameters give the rate of the whole link as in calculateSecPerBellPair
+double SharedResource::getQuantumLinkSecPerBellPair(const cModule *const node, const cModule *const neighbor_node) {
+  for (auto *link : findQuantumLinks(node, neighbor_node)) {
+    if (link->getLocalNode()->getModule() == node) return link_model.getSecPerBellPair(getLinkParameters(link));
+  }
+  return 0;
+}
+
+/**
+ * @details Only the destinations whose shortest paths may change are recomputed, see NextHopTable::updateLink.
+ * The RoutingDaemons refresh their routing tables by the version of the table on their next lookup.
+ */
+void SharedResource::setQuantumLinkEnabled(const cModule *const node, const cModule *const neighbor_node, bool enabled) {
+  auto links = findQuantumLinks(node, neighbor_node);
+  auto reverse_links = findQuantumLinks(neighbor_node, node);
+  links.insert(links.end(), reverse_links.begin(), reverse_links.end());
+  for (auto *link : links) {
+    if (link->isEnabled() == enabled) continue;
+    if (enabled) {
+      link->enable();
+    } else {
+      link->disable();
+    }
+    if (routingdaemon_next_hops != nullptr) routingdaemon_next_hops->updateLink(routingdaemon_topology, link);
+    quantum_link_version++;
+  }
+}
+
+// the quantum links from the node to the neighbor in the RoutingDaemon's topology, both halves for the link through a BSA or EPPS node.
+std::vector<cTopology::LinkOut *> SharedResource::findQuantumLinks(const cModule *const node, const cModule *const neighbor_node) {
+  std::vector<cTopology::LinkOut *> links;
+  if (routingdaemon_topology == nullptr) return links;
+  auto *topo_node = routingdaemon_topology->getNodeFor(const_cast<cModule *>(node));
+  if (topo_node == nullptr) return links;
+  for (int i = 0; i < topo_node->getNumOutLinks(); i++) {
+    auto *outgoing_link = topo_node->getLinkOut(i);
+    if (strstr(outgoing_link->getLocalGate()->getFullName(), "quantum") == nullptr) continue;
+    auto *remote_node = outgoing_link->getRemoteNode();
+    if (remote_node->getModule() == neighbor_node) {
+      links.push_back(outgoing_link);
+      continue;
+    }
+    if (!isHalfLink(outgoing_link)) continue;
+    for (int j = 0; j < remote_node->getNumOutLinks(); j++) {
+      auto *second_half = remote_node->getLinkOut(j);
+      if (second_half->getRemoteNode()->getModule() != neighbor_node) continue;
+      links.push_back(outgoing_link);
+      links.push_back(second_half);
+    }
+  }
+  return links;
+}
+
 /**
  * @brief Initialize channel weights for all existing links in the Topology
  *
@@ -49,7 +465,7 @@ cTopology *SharedResource::getTopologyForRoutingDaemon(const cModule *const rd_m
  * rd_module is needed for the function to distinguish between Router and RoutingDaemon,
  * as they require different procedures to initialize cTopology.
  * In detail, RoutingDaemon must call calculateSecPerBellPair function to update
- * the channel weights, and calculateSecPerBellPair function requires the rd_module.
+ * the channel weights, while Router takes the cost of the classical channels.
  */
 void SharedResource::updateChannelWeightsInTopology(cTopology *&topo, std::optional<const cModule *const> rd_module) {
   topo = new cTopology("topo");
@@ -66,7 +482,7 @@ void SharedResource::updateChannelWeightsOfNode(cTopology::Node *node, std::opti
     auto outgoing_link = node->getLinkOut(i);
 
     if (rd_module.has_value()) {
-      double channel_weight = calculateSecPerBellPair(rd_module.value(), outgoing_link);
+      double channel_weight = calculateSecPerBellPair(outgoing_link);
       setWeightOfLink(outgoing_link, channel_weight, true);
     } else {
       double channel_cost = outgoing_link->getLocalGate()->getChannel()->par("cost");
@@ -75,28 +491,62 @@ void SharedResource::updateChannelWeightsOfNode(cTopology::Node *node, std::opti
   }
 }
 
-// The cost metric is taken from https://arxiv.org/abs/1206.5655
-double SharedResource::calculateSecPerBellPair(const cModule *const rd_module, const cTopology::LinkOut *const outgoing_link) {
-  double speed_of_light_in_fiber = outgoing_link->getLocalGate()->getChannel()->par("speed_of_light_in_fiber");
-  double channel_length = outgoing_link->getLocalGate()->getChannel()->par("distance");
+/**
+ * @brief seconds per Bell pair of the link by the analytic LinkModel, from the parameters of the channel, qnic and BSA.
+ * @details A link to a BSA or EPPS node is a half of the link between QNodes,
+ * so it takes a half of the weight for the path through the node to sum up to the whole link.
+ */
+double SharedResource::calculateSecPerBellPair(const cTopology::LinkOut *const outgoing_link) {
+  double sec_per_bell_pair = link_model.getSecPerBellPair(getLinkParameters(outgoing_link));
+  if (isHalfLink(outgoing_link)) return sec_per_bell_pair / 2;
+  return sec_per_bell_pair;
+}
 
-  auto *some_stationary_qubit_in_qnic = rd_module->findModuleByPath("^.^.qnic[0].statQubit[0]");
-  auto *some_stationary_qubit_in_qnic_r = rd_module->findModuleByPath("^.^.qnic_r[0].statQubit[0]");
-  auto *some_stationary_qubit_in_qnic_rp = rd_module->findModuleByPath("^.^.qnic_rp[0].statQubit[0]");
+LinkParameters SharedResource::getLinkParameters(const cTopology::LinkOut *const outgoing_link) {
+  LinkParameters params;
+  auto *channel = outgoing_link->getLocalGate()->getChannel();
+  params.distance_km = channel->par("distance").doubleValue();
+  params.speed_of_light_in_fiber_km_per_sec = channel->par("speed_of_light_in_fiber").doubleValue();
+  if (channel->hasPar("channel_loss_rate")) params.channel_loss_rate = channel->par("channel_loss_rate").doubleValue();
 
-  double emission_prob = 1.0;
-  // TODO: fix this to read the emission success probability correctly. This is a quick fix!!
-  if (some_stationary_qubit_in_qnic != nullptr) {
-    emission_prob = some_stationary_qubit_in_qnic->par("emission_success_probability").doubleValue();
-  } else if (some_stationary_qubit_in_qnic_r != nullptr) {
-    emission_prob = some_stationary_qubit_in_qnic_r->par("emission_success_probability").doubleValue();
-  } else if (some_stationary_qubit_in_qnic_rp != nullptr) {
-    emission_prob = some_stationary_qubit_in_qnic_rp->par("emission_success_probability").doubleValue();
-  } else {
-    error("cannot read emission_success_probability from file");
+  // the qnics and BSAs are the modules connected to the gates of the nodes at both ends
+  params.num_qubits = 0;
+  params.emission_success_probability = 1;
+  for (auto *gate : {outgoing_link->getLocalGate()->getPreviousGate(), outgoing_link->getRemoteGate()->getNextGate()}) {
+    if (gate == nullptr) continue;
+    auto *module = gate->getOwnerModule();
+    if (module->hasPar("num_buffer")) {
+      int num_qubits = module->par("num_buffer").intValue();
+      params.num_qubits = params.num_qubits == 0 ? num_qubits : std::min(params.num_qubits, num_qubits);
+      // the qubits of the qnic are modules of their own or a QubitArray
+      auto *qubit = module->getSubmodule("statQubit", 0);
+      if (qubit == nullptr) qubit = module->getSubmodule("qubits");
+      if (qubit != nullptr) {
+        params.emission_success_probability = std::min(params.emission_success_probability, qubit->par("emission_success_probability").doubleValue());
+      }
+      // the receiver qnic has the BSA inside
+      if (auto *bsa = module->getSubmodule("bsa")) module = bsa;
+    }
+    if (module->hasPar("detection_efficiency")) {
+      params.collection_efficiency = module->par("collection_efficiency").doubleValue();
+      params.detection_efficiency = module->par("detection_efficiency").doubleValue();
+      params.darkcount_probability = module->par("darkcount_probability").doubleValue();
+    }
+    // EPPS
+    if (module->hasPar("emission_success_probability")) {
+      params.emission_success_probability = std::min(params.emission_success_probability, module->par("emission_success_probability").doubleValue());
+    }
   }
+  if (params.num_qubits == 0) params.num_qubits = 1;
+  return params;
+}
 
-  return (channel_length / speed_of_light_in_fiber) * emission_prob;
+bool SharedResource::isHalfLink(const cTopology::LinkOut *const link) {
+  for (auto *node : {link->getLocalGate()->getOwnerModule(), link->getRemoteGate()->getOwnerModule()}) {
+    auto node_type = node->par("node_type").stdstringValue();
+    if (node_type == "BSA" || node_type == "EPPS") return true;
+  }
+  return false;
 }
 
 /**
@@ -115,6 +565,44 @@ void SharedResource::setWeightOfLink(cTopology::LinkOut *link, double weight, bo
   }
 }
 
-void SharedResource::finish() {}
+TomographyResultWriter *SharedResource::getTomographyResultWriter(const std::string &file_name) {
+  auto &writer = tomography_result_writers[file_name];
+  if (writer == nullptr) writer = std::make_unique<TomographyResultWriter>(file_name);
+  return writer.get();
+}
+
+// the nodes finished after this module still write into the buffers, and the rest is written when the writers are destroyed.
+void SharedResource::finish() {
+  for (auto &[file_name, writer] : tomography_result_writers) writer->flush();
+  if (connection_metrics != nullptr) connection_metrics->record(this);
+  if (memory_accounting != nullptr) {
+    // the modules are destroyed after all the finish(), so their structures are still there
+    reportMemoryUsage();
+    recordScalar("memory reports", memory_accounting->numCollects());
+    memory_accounting->forEachCounter([this](const std::string &name, double value) { recordScalar(name.c_str(), value); });
+  }
+  if (connection_controller != nullptr) {
+    recordScalar("controller connection setups", connection_controller->numSetups());
+    recordScalar("controller reservation rejections", connection_controller->numRejections());
+  }
+  if (link_workers != nullptr) {
+    recordScalar("link worker batches", link_workers->numBatches());
+    recordScalar("link worker jobs", link_workers->numJobs());
+  }
+  if (event_trace != nullptr) {
+    event_trace->getWriter()->flush();
+    recordScalar("event trace deliveries", event_trace->numDeliveries());
+  }
+  if (event_profiler == nullptr || !par("profile_events").boolValue()) return;
+  event_profiler->forEachCounter([this](const std::string &name, double value) { recordScalar(name.c_str(), value); });
+  auto filename = std::string(par("event_profile_filename").stringValue());
+  if (!filename.empty()) {
+    // the partitions of a parallel simulation append to the same file, one json object per line
+    std::ofstream profile_file(filename, std::ios_base::app);
+    auto json = event_profiler->toJson();
+    json["partition"] = getEnvir()->getParsimProcId();
+    profile_file << json.dump() << "\n";
+  }
+}
 
 }  // namespace quisp::modules::SharedResource
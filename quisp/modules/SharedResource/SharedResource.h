@@ -1,8 +1,25 @@
 #pragma once
 #include <omnetpp.h>
+#include <chrono>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <optional>
+#include <string>
 #include <unordered_map>
+#include <vector>
+
+#include "AliasTable.h"
+#include "ConnectionController.h"
+#include "ConnectionMetrics.h"
+#include "EventProfiler.h"
+#include "EventTrace.h"
+#include "LinkModel.h"
+#include "LinkWorkers.h"
+#include "LiveStatsServer.h"
+#include "MemoryAccounting.h"
+#include "NextHopTable.h"
+#include "TomographyResultWriter.h"
 
 using namespace omnetpp;
 
@@ -12,13 +29,30 @@ using namespace omnetpp;
  *
  * @details
  * SharedResource provides the following:
- * 1. EndNodeWeightMap for Application module
- * 2. cTopology that has channel weights initialized for RoutingDaemon and Router modules
+ * 1. EndNodeWeightMap for Application module, and the AliasTable sampling the end nodes by the weights
+ * 2. cTopology that has channel weights initialized for RoutingDaemon and Router modules,
+ *    the quantum link weights are the seconds per Bell pair by LinkModel
+ * 3. TomographyResultWriter that collects the link tomography results of all the nodes
+ * 4. the index of the nodes in the topology by their address
+ * 5. ConnectionMetricsCollector that summarises the connection signals of the network, if record_connection_metrics is true
+ * 6. the seed of the per-stream RNGs, the same for all the partitions of a run
+ * 7. EventProfiler that aggregates the events of the modules, if profile_events is true
+ * 8. MemoryAccounting that samples the memory footprint of the subsystems every memory_report_interval, if it's not 0
+ * 9. LiveStatsServer that serves the progress of the run on the live_stats_socket, if it's not empty
+ * 10. EventTrace that writes the deliveries and the connection requests to event_trace_filename, and EventReplay
+ *     that reads the requests of event_replay_filename for the Applications, if they're not empty
+ * 11. ConnectionController that sets up the connections of the whole network, if centralized_connection_setup is true
+ * 12. LinkWorkers that sample the rounds of the photon trains of the BSAs on link_worker_threads, if it's not 0
+ *
+ * In a parallel simulation the network has one SharedResource per partition (sharedResource[N]),
+ * which checks that only classical channels with delay cross the partitions.
  *
  * SharedResource initializes these resources the first time when other modules
  * attempt to access the resources.
  * Once the initialization is done, the resources are
- * never modified again for the lifetime of the SharedResource instance.
+ * never modified again for the lifetime of the SharedResource instance,
+ * except the quantum link weights and fidelities updated by the link estimation in HardwareMonitor,
+ * and the quantum links taken down and back up, which update the RoutingDaemon's next hops incrementally.
  *
  * Modules can access the shared resources by calling methods from ComponentProvider
  *
@@ -33,25 +67,133 @@ class SharedResource : public omnetpp::cSimpleModule {
 
   void initialize() override;
   void finish() override;
+  void handleMessage(cMessage *msg) override;
   const std::unordered_map<int, int> getEndNodeWeightMapForApplication(const char *const node_type);
+  // the end nodes with the weights above, sampled in O(1).
+  const AliasTable *getEndNodeSamplerForApplication(const char *const node_type);
   cTopology *getTopologyForRoutingDaemon(const cModule *const rd_module);
   cTopology *getTopologyForRouter();
+  // the shortest path next hops in the topologies above, computed once for all the nodes.
+  const NextHopTable *getNextHopTableForRoutingDaemon(const cModule *const rd_module);
+  const NextHopTable *getNextHopTableForRouter();
+  // updates the weight of the quantum link from the node to the neighbor in the RoutingDaemon's topology, if it exists.
+  void setQuantumLinkCost(const cModule *const node, const cModule *const neighbor_node, double cost);
+  // enables or disables the quantum link between the nodes in both directions, and recomputes the next hops through it.
+  void setQuantumLinkEnabled(const cModule *const node, const cModule *const neighbor_node, bool enabled);
+  // sets the fidelity of the quantum link from the node to the neighbor estimated by the tomography, on the link from the node.
+  void setQuantumLinkFidelity(const cModule *const node, const cModule *const neighbor_node, double fidelity);
+  // the fidelity of the link set above, 1 for the links not estimated yet and the second halves of the links through a BSA or EPPS node.
+  double getQuantumLinkFidelity(const cTopology::LinkOut *const link) const;
+  // the seconds per Bell pair of the quantum link from the node to the neighbor by the analytic LinkModel, 0 if there's no such link.
+  double getQuantumLinkSecPerBellPair(const cModule *const node, const cModule *const neighbor_node);
+  // counts the changes of the costs, the fidelities and the states of the quantum links, for the caches of the paths over them.
+  uint64_t getQuantumLinkVersion() const { return quantum_link_version; }
+  // returns the node in the topology with the address, or nullptr.
+  cModule *getQNodeWithAddress(int address);
+  int getNumEndNodes();
+  // returns the writer of the file shared by the nodes. The buffered results are written in finish().
+  TomographyResultWriter *getTomographyResultWriter(const std::string &file_name);
+  // the seed of StreamRNG, from stream_rng_seed and the seed-set of the run. It doesn't draw from the OMNeT++ RNGs.
+  uint64_t getStreamRNGSeed();
+  // the profiler of the handleMessage() of the modules, or nullptr if profile_events is false.
+  EventProfiler *getEventProfiler();
+  // the accounting the modules add their memory reporters to, or nullptr if neither memory_report_interval nor live_stats_socket is set.
+  MemoryAccounting *getMemoryAccounting();
+  // the trace of the deliveries and the connection requests, or nullptr if event_trace_filename is empty.
+  EventTrace *getEventTrace();
+  // the connection requests to replay, or nullptr if event_replay_filename is empty.
+  const EventReplay *getEventReplay();
+  // the controller the initiators set up their connections with, or nullptr if centralized_connection_setup is false.
+  ConnectionController *getConnectionController();
+  // the workers of the physical layer of the links, or nullptr if link_worker_threads is 0.
+  LinkWorkers *getLinkWorkers();
+
+  // a channel from a node to the neighbor in another parsim partition
+  struct CrossPartitionChannel {
+    std::string channel;
+    std::string node;
+    std::string neighbor;
+    bool quantum;
+    double delay;
+  };
+  /**
+   * @brief the lookahead of the null message protocol, the smallest delay of the channels. infinity without channels.
+   * @throws cRuntimeError for a quantum channel or a channel without delay
+   */
+  static double partitionLookahead(const std::vector<CrossPartitionChannel> &channels);
 
  protected:
  private:
+  // rejects the quantum channels and the classical channels without delay between the parsim partitions
+  void checkPartitioning();
+  void buildNodeIndex();
   void updateChannelWeightsInTopology(cTopology *&topo, std::optional<const cModule *const> rd_module);
   void updateChannelWeightsOfNode(cTopology::Node *node, std::optional<const cModule *const> rd_module);
-  double calculateSecPerBellPair(const cModule *const rd_module, const cTopology::LinkOut *const outgoing_link);
+  double calculateSecPerBellPair(const cTopology::LinkOut *const outgoing_link);
+  static LinkParameters getLinkParameters(const cTopology::LinkOut *const outgoing_link);
+  static bool isHalfLink(const cTopology::LinkOut *const link);
+  std::vector<cTopology::LinkOut *> findQuantumLinks(const cModule *const node, const cModule *const neighbor_node);
   void setWeightOfLink(cTopology::LinkOut *link, double weight, bool should_set_quantum_channel);
+  std::unique_ptr<NextHopTable> makeNextHopTable(cTopology *topo);
 
   std::once_flag app_init_flag{};
   std::unordered_map<int, int> end_node_weight_map;
+  std::once_flag app_sampler_init_flag{};
+  std::unique_ptr<AliasTable> end_node_sampler;
 
   std::once_flag router_init_flag{};
   cTopology *router_topology = nullptr;
+  std::once_flag router_next_hop_init_flag{};
+  std::unique_ptr<NextHopTable> router_next_hops;
 
   std::once_flag rd_init_flag{};
   cTopology *routingdaemon_topology = nullptr;
+  LinkModel link_model;
+  std::once_flag rd_next_hop_init_flag{};
+  std::unique_ptr<NextHopTable> routingdaemon_next_hops;
+  std::unordered_map<const cTopology::LinkOut *, double> quantum_link_fidelities;
+  uint64_t quantum_link_version = 0;
+
+  std::once_flag node_index_init_flag{};
+  std::unordered_map<int, cModule *> node_by_address;
+  int num_end_nodes = 0;
+
+  std::map<std::string, std::unique_ptr<TomographyResultWriter>> tomography_result_writers;
+  std::unique_ptr<ConnectionMetricsCollector> connection_metrics;
+
+  std::once_flag stream_rng_seed_init_flag{};
+  uint64_t stream_rng_seed = 0;
+
+  std::once_flag event_profiler_init_flag{};
+  std::unique_ptr<EventProfiler> event_profiler;
+
+  std::once_flag event_trace_init_flag{};
+  std::unique_ptr<EventTrace> event_trace;
+  std::once_flag event_replay_init_flag{};
+  std::unique_ptr<EventReplay> event_replay;
+
+  std::once_flag connection_controller_init_flag{};
+  std::unique_ptr<ConnectionController> connection_controller;
+
+  std::once_flag link_workers_init_flag{};
+  std::unique_ptr<LinkWorkers> link_workers;
+
+  std::once_flag memory_accounting_init_flag{};
+  std::unique_ptr<MemoryAccounting> memory_accounting;
+  simtime_t memory_report_interval;
+  cMessage *memory_report_timer = nullptr;
+  // "memory <subsystem> objects" and "memory <subsystem> bytes", created when the subsystem is reported first
+  std::map<std::string, std::unique_ptr<cOutVector>> memory_vectors;
+  void reportMemoryUsage();
+
+  std::unique_ptr<LiveStatsServer> live_stats_server;
+  simtime_t live_stats_interval;
+  cMessage *live_stats_timer = nullptr;
+  // the wall clock time and the event number of the last snapshot, for the events/s
+  std::chrono::steady_clock::time_point live_stats_published_at;
+  eventnumber_t live_stats_events = 0;
+  void startLiveStats();
+  void publishLiveStats();
 };
 
 Define_Module(SharedResource);
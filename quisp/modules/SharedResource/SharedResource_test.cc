@@ -0,0 +1,35 @@
+#include "SharedResource.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+namespace {
+using quisp::modules::SharedResource::SharedResource;
+using CrossPartitionChannel = SharedResource::CrossPartitionChannel;
+
+TEST(SharedResourcePartitionTest, LookaheadIsTheSmallestDelay) {
+  EXPECT_TRUE(std::isinf(SharedResource::partitionLookahead({})));
+  std::vector<CrossPartitionChannel> channels{
+      {"net.Repeater1.port$o[1].channel", "net.Repeater1", "net.Repeater2", false, 5e-5},
+      {"net.Repeater2.port$o[0].channel", "net.Repeater2", "net.Repeater1", false, 2e-5},
+  };
+  EXPECT_DOUBLE_EQ(SharedResource::partitionLookahead(channels), 2e-5);
+}
+
+TEST(SharedResourcePartitionTest, RejectQuantumChannel) {
+  std::vector<CrossPartitionChannel> channels{
+      {"net.Repeater1.port$o[1].channel", "net.Repeater1", "net.Repeater2", false, 5e-5},
+      {"net.Repeater1.quantum_port$o[1].channel", "net.Repeater1", "net.Repeater2", true, 5e-5},
+  };
+  EXPECT_THROW(SharedResource::partitionLookahead(channels), omnetpp::cRuntimeError);
+}
+
+TEST(SharedResourcePartitionTest, RejectClassicalChannelWithoutDelay) {
+  std::vector<CrossPartitionChannel> channels{
+      {"net.Repeater1.port$o[1].channel", "net.Repeater1", "net.Repeater2", false, 0},
+  };
+  EXPECT_THROW(SharedResource::partitionLookahead(channels), omnetpp::cRuntimeError);
+}
+
+}  // namespace
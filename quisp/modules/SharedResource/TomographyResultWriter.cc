@@ -0,0 +1,60 @@
+#include "TomographyResultWriter.h"
+
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace quisp::modules::SharedResource {
+
+TomographyResultWriter::TomographyResultWriter(std::string file_name, std::size_t flush_threshold) : file_name(std::move(file_name)), flush_threshold(flush_threshold) {}
+
+TomographyResultWriter::~TomographyResultWriter() {
+  try {
+    flush();
+  } catch (const std::runtime_error &e) {
+    std::cerr << e.what() << std::endl;
+  }
+}
+
+std::string TomographyResultWriter::header() {
+  std::stringstream ss;
+  ss << "node,partner,link_cost,distance_km,fidelity,x_error_rate,y_error_rate,z_error_rate,bellpair_per_sec,tomography_time,"
+        "tomography_measurements,actual_measurements,GOD_clean_pair_total,GOD_X_pair_total,GOD_Y_pair_total,GOD_Z_pair_total";
+  for (int i = 0; i < 16; i++) ss << ",dm_real_" << i / 4 << i % 4;
+  for (int i = 0; i < 16; i++) ss << ",dm_imag_" << i / 4 << i % 4;
+  ss << "\n";
+  return ss.str();
+}
+
+void TomographyResultWriter::write(const LinkTomographyRecord &record) {
+  std::stringstream ss;
+  ss.precision(std::numeric_limits<double>::max_digits10);
+  ss << record.node_name << "," << record.partner_name << "," << record.link_cost << "," << record.distance_km << "," << record.fidelity << "," << record.x_error_rate << ","
+     << record.y_error_rate << "," << record.z_error_rate << "," << record.bellpair_per_sec << "," << record.tomography_time << "," << record.tomography_measurements << ","
+     << record.actual_measurements << "," << record.GOD_clean_pair_total << "," << record.GOD_X_pair_total << "," << record.GOD_Y_pair_total << ","
+     << record.GOD_Z_pair_total;
+  for (auto value : record.density_matrix_real) ss << "," << value;
+  for (auto value : record.density_matrix_imag) ss << "," << value;
+  ss << "\n";
+  buffer += ss.str();
+  if (buffer.size() >= flush_threshold) flush();
+}
+
+void TomographyResultWriter::flush() {
+  if (buffer.empty() && file_created) return;
+  std::ofstream file(file_name, file_created ? std::ios_base::app : std::ios_base::trunc);
+  if (!file) {
+    throw std::runtime_error("TomographyResultWriter: failed to open " + file_name);
+  }
+  if (!file_created) {
+    file << header();
+    file_created = true;
+  }
+  file << buffer;
+  buffer.clear();
+}
+
+}  // namespace quisp::modules::SharedResource
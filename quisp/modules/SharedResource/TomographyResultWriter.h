@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+
+namespace quisp::modules::SharedResource {
+
+/// @brief the link tomography result of a node with a partner, written as a CSV row.
+struct LinkTomographyRecord {
+  std::string node_name;
+  std::string partner_name;
+  double link_cost;
+  double distance_km;
+  double fidelity;
+  double x_error_rate;
+  double y_error_rate;
+  double z_error_rate;
+  double bellpair_per_sec;
+  double tomography_time;
+  int tomography_measurements;
+  int actual_measurements;
+  int GOD_clean_pair_total;
+  int GOD_X_pair_total;
+  int GOD_Y_pair_total;
+  int GOD_Z_pair_total;
+  // the reconstructed density matrix in the row-major order
+  std::array<double, 16> density_matrix_real;
+  std::array<double, 16> density_matrix_imag;
+};
+
+/**
+ * @brief TomographyResultWriter collects the link tomography results of all the nodes into one CSV file.
+ *
+ * The rows are formatted into an in-memory buffer, and the file is written when the buffer grows
+ * beyond the threshold, on flush() and on destruction. So the nodes don't open and append to the file
+ * one by one at the end of the simulation. The file is truncated by the first write of the process.
+ * scripts/tomography_results.py reads the file.
+ */
+class TomographyResultWriter {
+ public:
+  explicit TomographyResultWriter(std::string file_name, std::size_t flush_threshold = 1 << 20);
+  ~TomographyResultWriter();
+  TomographyResultWriter(const TomographyResultWriter &) = delete;
+  TomographyResultWriter &operator=(const TomographyResultWriter &) = delete;
+
+  void write(const LinkTomographyRecord &record);
+  /// @brief writes the buffered rows to the file. Throws std::runtime_error if the file can't be written.
+  void flush();
+  const std::string &getFileName() const { return file_name; }
+
+  static std::string header();
+
+ protected:
+  std::string file_name;
+  std::size_t flush_threshold;
+  std::string buffer;
+  bool file_created = false;
+};
+
+}  // namespace quisp::modules::SharedResource
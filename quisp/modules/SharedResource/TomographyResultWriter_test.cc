@@ -0,0 +1,62 @@
+#include "TomographyResultWriter.h"
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+using quisp::modules::SharedResource::LinkTomographyRecord;
+using quisp::modules::SharedResource::TomographyResultWriter;
+
+std::vector<std::string> readLines(const std::string &file_name) {
+  std::ifstream file(file_name);
+  std::vector<std::string> lines;
+  for (std::string line; std::getline(file, line);) lines.push_back(line);
+  return lines;
+}
+
+LinkTomographyRecord recordOf(const std::string &node, const std::string &partner) {
+  LinkTomographyRecord record{};
+  record.node_name = node;
+  record.partner_name = partner;
+  record.fidelity = 0.5;
+  record.actual_measurements = 3;
+  record.density_matrix_real[0] = 0.25;
+  return record;
+}
+
+TEST(TomographyResultWriterTest, BufferUntilFlush) {
+  std::string file_name = testing::TempDir() + "tomography_result_writer_test.csv";
+  std::remove(file_name.c_str());
+  {
+    TomographyResultWriter writer{file_name};
+    writer.write(recordOf("EndNode1", "EndNode2"));
+    EXPECT_TRUE(readLines(file_name).empty());
+    writer.flush();
+    auto lines = readLines(file_name);
+    ASSERT_EQ(lines.size(), 2);
+    EXPECT_EQ(lines[0] + "\n", TomographyResultWriter::header());
+    EXPECT_EQ(lines[1].rfind("EndNode1,EndNode2,0,0,0.5,", 0), 0) << lines[1];
+
+    // the rows written after the flush are appended when the writer is destroyed
+    writer.write(recordOf("EndNode2", "EndNode1"));
+  }
+  auto lines = readLines(file_name);
+  ASSERT_EQ(lines.size(), 3);
+  EXPECT_EQ(lines[2].rfind("EndNode2,EndNode1,", 0), 0) << lines[2];
+  std::remove(file_name.c_str());
+}
+
+TEST(TomographyResultWriterTest, FlushAtThreshold) {
+  std::string file_name = testing::TempDir() + "tomography_result_writer_threshold_test.csv";
+  std::remove(file_name.c_str());
+  TomographyResultWriter writer{file_name, 1};
+  writer.write(recordOf("EndNode1", "EndNode2"));
+  EXPECT_EQ(readLines(file_name).size(), 2);
+  std::remove(file_name.c_str());
+}
+
+}  // namespace
@@ -0,0 +1,192 @@
+#include "StubNode.h"
+
+#include <algorithm>
+
+#include "modules/PhysicalConnection/BSA/FastLinkSampler.h"
+#include "modules/QNIC.h"
+#include "modules/SharedResource/LinkModel.h"
+
+using namespace quisp::messages;
+using quisp::modules::SharedResource::LinkModel;
+using quisp::modules::SharedResource::LinkParameters;
+
+namespace quisp::modules::stub_node {
+
+Define_Module(StubNode);
+
+StubNode::StubNode() : provider(utils::ComponentProvider{this}) {}
+
+StubNode::~StubNode() {
+  for (auto &quantum_port : quantum_ports) cancelAndDelete(quantum_port.time_out_message);
+}
+
+void StubNode::initialize() {
+  event_profiler = provider.getEventProfiler();
+  address = par("address").intValue();
+  collection_efficiency = par("collection_efficiency").doubleValue();
+  detection_efficiency = par("detection_efficiency").doubleValue();
+  darkcount_probability = par("darkcount_probability").doubleValue();
+  for (double probability : {collection_efficiency, detection_efficiency, darkcount_probability}) {
+    if (probability < 0 || probability > 1) error("the efficiencies and darkcount_probability of the stub must be in [0, 1]");
+  }
+  int photon_detection_per_second = par("photon_detection_per_second").intValue();
+  if (photon_detection_per_second <= 0) error("photon_detection_per_second must be positive: %d", photon_detection_per_second);
+  time_interval_between_photons = SimTime(1.0 / photon_detection_per_second);
+  auto far_distances = cStringTokenizer(par("far_distances").stringValue()).asDoubleVector();
+
+  simtime_t first_notification_timer = par("initial_notification_timing_buffer").doubleValue();
+  quantum_ports.reserve(gateSize("quantum_port"));
+  for (int port = 0; port < gateSize("quantum_port"); port++) {
+    quantum_ports.push_back(makeQuantumPort(port, port < (int)far_distances.size() ? far_distances[port] : 0));
+    scheduleAt(first_notification_timer, quantum_ports.back().time_out_message);
+  }
+}
+
+/**
+ * @details The quantum port is connected to the quantum_port of the border QNode and to its qnic behind it,
+ * and the classical port with the border QNode at the other end carries the notifications.
+ */
+StubNode::QuantumPort StubNode::makeQuantumPort(int port, double far_distance_km) {
+  auto *border_gate = gate("quantum_port$i", port)->getPreviousGate();  // the border QNode quantum_port
+  auto *qnic_gate = border_gate == nullptr ? nullptr : border_gate->getPreviousGate();  // the QNIC quantum port
+  if (qnic_gate == nullptr || !qnic_gate->getOwnerModule()->hasPar("self_qnic_index")) error("quantum_port[%d] of the stub isn't connected to a qnic", port);
+  QuantumPort quantum_port;
+  quantum_port.border_addr = border_gate->getOwnerModule()->par("address").intValue();
+  quantum_port.qnic_index = qnic_gate->getOwnerModule()->par("self_qnic_index").intValue();
+  quantum_port.classical_port = -1;
+  for (int i = 0; i < gateSize("port"); i++) {
+    auto *next_gate = gate("port$o", i)->getNextGate();
+    if (next_gate != nullptr && next_gate->getOwnerModule()->par("address").intValue() == quantum_port.border_addr) quantum_port.classical_port = i;
+  }
+  if (quantum_port.classical_port == -1) error("no classical port of the stub to the border QNode %d", quantum_port.border_addr);
+
+  auto *channel = gate("quantum_port$i", port)->getIncomingTransmissionChannel();
+  quantum_port.travel_time = channel->par("distance").doubleValue() / channel->par("speed_of_light_in_fiber").doubleValue();
+  // as BSAController, 10 photon intervals for the internal delay of RuleEngine
+  quantum_port.offset_time_for_first_photon = 2 * quantum_port.travel_time + time_interval_between_photons * 10;
+
+  // the far side mirrors the link of the border qnic, as the analytic link weights of the routing
+  LinkParameters params;
+  params.distance_km = far_distance_km;
+  if (channel->hasPar("channel_loss_rate")) params.channel_loss_rate = channel->par("channel_loss_rate").doubleValue();
+  auto *qnic = qnic_gate->getOwnerModule();
+  auto *qubit = qnic->getSubmodule("statQubit", 0);
+  if (qubit == nullptr) qubit = qnic->getSubmodule("qubits");
+  if (qubit != nullptr) params.emission_success_probability = qubit->par("emission_success_probability").doubleValue();
+  params.collection_efficiency = collection_efficiency;
+  quantum_port.far_arrival_probability = LinkModel::photonArrivalProbability(params);
+
+  quantum_port.time_out_message = new cMessage("bsm_notification_timeout", port);
+  return quantum_port;
+}
+
+void StubNode::handleMessage(cMessage *msg) {
+  modules::SharedResource::EventProfiler::Scope profile(event_profiler, this, msg);
+  if (msg->isSelfMessage()) {
+    // the qnic didn't start the round, as BSAController asks again with a longer timeout
+    auto &quantum_port = quantum_ports[msg->getKind()];
+    quantum_port.accepting = false;
+    sendToBorder(quantum_port, generateFirstNotificationTiming(quantum_port), SIMTIME_ZERO);
+    quantum_port.time_out_count++;
+    scheduleAt(simTime() + (2 + quantum_port.time_out_count) * quantum_port.offset_time_for_first_photon, msg);
+    return;
+  }
+  if (auto *photon = dynamic_cast<PhotonicQubit *>(msg)) {
+    acceptPhoton(photon);
+    return;
+  }
+  if (auto *train = dynamic_cast<PhotonicQubitTrain *>(msg)) {
+    acceptPhotonTrain(train);
+    return;
+  }
+  // the protocols with the QNode left out end here
+  num_absorbed_packets++;
+  delete msg;
+}
+
+void StubNode::acceptPhoton(PhotonicQubit *photon) {
+  auto &quantum_port = quantum_ports[photon->getArrivalGate()->getIndex()];
+  if (photon->isFirst()) startRound(quantum_port);
+  if (quantum_port.accepting) {
+    // the lost photons the channel dropped came before this one
+    if (!photon->isFirst()) {
+      for (size_t i = 0; i < photon->getNumDroppedPhotons(); i++) recordPhoton(quantum_port, false);
+    }
+    recordPhoton(quantum_port, !photon->isLost());
+  }
+  photon->getQubitRefForUpdate()->relaseBackToPool();
+  bool is_last = photon->isLast();
+  delete photon;
+  if (is_last && quantum_port.accepting) finishRound(quantum_port, SIMTIME_ZERO);
+}
+
+void StubNode::acceptPhotonTrain(PhotonicQubitTrain *train) {
+  auto &quantum_port = quantum_ports[train->getArrivalGate()->getIndex()];
+  startRound(quantum_port);
+  simtime_t last_emission_offset = SIMTIME_ZERO;
+  for (size_t i = 0; i < train->getNumPhotons(); i++) {
+    auto &photon = train->getPhoton(i);
+    recordPhoton(quantum_port, !photon.is_lost);
+    if (photon.qubit_ref != nullptr) photon.qubit_ref->relaseBackToPool();
+    last_emission_offset = std::max(last_emission_offset, photon.emission_offset);
+  }
+  delete train;
+  finishRound(quantum_port, last_emission_offset);
+}
+
+void StubNode::startRound(QuantumPort &quantum_port) {
+  cancelEvent(quantum_port.time_out_message);
+  quantum_port.time_out_count = 0;
+  quantum_port.accepting = true;
+  quantum_port.num_photons = 0;
+  quantum_port.successes.clear();
+}
+
+void StubNode::recordPhoton(QuantumPort &quantum_port, bool arrived) {
+  int index = quantum_port.num_photons++;
+  auto probabilities = fast_link::pairProbabilities(arrived ? collection_efficiency : 0, quantum_port.far_arrival_probability, detection_efficiency, darkcount_probability);
+  if (dblrand() >= probabilities.success()) return;
+  // the border side takes no correction, as the left side of BSAController
+  quantum_port.successes.append(index, PauliOperator::I);
+  num_successes++;
+}
+
+void StubNode::finishRound(QuantumPort &quantum_port, simtime_t delay) {
+  quantum_port.accepting = false;
+  auto *pk = new CombinedBSAresults();
+  pk->setSrcAddr(address);
+  pk->setDestAddr(quantum_port.border_addr);
+  pk->setFirstPhotonEmitTime(simTime() + delay + quantum_port.offset_time_for_first_photon - quantum_port.travel_time);
+  pk->setInterval(time_interval_between_photons);
+  pk->setQnicIndex(quantum_port.qnic_index);
+  pk->setQnicType(QNIC_E);
+  pk->setNeighborAddress(address);
+  pk->setSuccesses(quantum_port.successes);
+  sendToBorder(quantum_port, pk, delay);
+  scheduleAt(simTime() + delay + 1.1 * quantum_port.offset_time_for_first_photon, quantum_port.time_out_message);
+}
+
+BSMTimingNotification *StubNode::generateFirstNotificationTiming(const QuantumPort &quantum_port) {
+  auto *pk = new BSMTimingNotification();
+  pk->setSrcAddr(address);
+  pk->setDestAddr(quantum_port.border_addr);
+  pk->setFirstPhotonEmitTime(simTime() + quantum_port.offset_time_for_first_photon - quantum_port.travel_time);
+  pk->setInterval(time_interval_between_photons);
+  pk->setQnicIndex(quantum_port.qnic_index);
+  pk->setQnicType(QNIC_E);
+  return pk;
+}
+
+// the packet waits for the previous one on the classical channel, as the Queue of a node does
+void StubNode::sendToBorder(const QuantumPort &quantum_port, Header *pk, simtime_t delay) {
+  auto *out = gate("port$o", quantum_port.classical_port);
+  if (auto *channel = out->findTransmissionChannel()) delay = std::max(delay, channel->getTransmissionFinishTime() - simTime());
+  sendDelayed(pk, delay, out);
+}
+
+void StubNode::finish() {
+  recordScalar("stub_pairs", num_successes);
+  recordScalar("absorbed_packets", num_absorbed_packets);
+}
+
+}  // namespace quisp::modules::stub_node
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <omnetpp.h>
+#include <vector>
+
+#include "PhotonicQubit_m.h"
+#include "messages/classical_messages.h"
+#include "modules/PhysicalConnection/BSA/CompactClickResults.h"
+#include "utils/ComponentProvider.h"
+
+using namespace omnetpp;
+
+namespace quisp::modules::stub_node {
+
+/**
+ * \brief StubNode stands for a QNode outside the region of TopologyBuilder, so that only the region is simulated in detail.
+ *
+ * Each quantum port ends a link from a qnic of a border QNode. The stub runs the rounds of the link as the BSAController of a BSA node,
+ * and decides the success of each photon analytically: the photon from the border qnic as it arrived through the channel,
+ * and the photon of the far side left out with the arrival probability of LinkModel for the length beyond the stub,
+ * with the channel loss rate of the link and the emission of the border qnic. The border qubit of a successful pair
+ * is the half of a Bell pair with the stub, whose half isn't simulated.
+ *
+ * The notifications and the results take the classical channel to the border QNode, and the other packets sent to the stub end there.
+ * The stub doesn't relay anything, so the region should hold the paths of interest.
+ * The fast_link_layer of RuleEngine needs a BellStateAnalyzer and isn't for the links to the stubs.
+ */
+class StubNode : public cSimpleModule {
+ public:
+  StubNode();
+  ~StubNode();
+
+ protected:
+  void initialize() override;
+  void handleMessage(cMessage *msg) override;
+  void finish() override;
+
+ private:
+  // a link from a qnic of a border QNode
+  struct QuantumPort {
+    int border_addr;
+    int qnic_index;
+    int classical_port;
+    simtime_t travel_time;
+    simtime_t offset_time_for_first_photon;
+    // the probability that the photon of the far side reaches the detector
+    double far_arrival_probability;
+    cMessage *time_out_message = nullptr;
+    int time_out_count = 0;
+    bool accepting = false;
+    int num_photons = 0;
+    physical::types::CompactClickResults successes;
+  };
+
+  QuantumPort makeQuantumPort(int port, double far_distance_km);
+  void acceptPhoton(messages::PhotonicQubit *photon);
+  void acceptPhotonTrain(messages::PhotonicQubitTrain *train);
+  void startRound(QuantumPort &quantum_port);
+  // samples the success of the next photon of the round
+  void recordPhoton(QuantumPort &quantum_port, bool arrived);
+  // sends the results of the round after the delay, for the photons that arrive later than the message of their train
+  void finishRound(QuantumPort &quantum_port, simtime_t delay);
+  void sendToBorder(const QuantumPort &quantum_port, messages::Header *pk, simtime_t delay);
+  messages::BSMTimingNotification *generateFirstNotificationTiming(const QuantumPort &quantum_port);
+
+  int address;
+  double collection_efficiency;
+  double detection_efficiency;
+  double darkcount_probability;
+  simtime_t time_interval_between_photons;
+  std::vector<QuantumPort> quantum_ports;
+  utils::ComponentProvider provider;
+  modules::SharedResource::EventProfiler *event_profiler = nullptr;
+
+  long num_successes = 0;
+  long num_absorbed_packets = 0;
+};
+
+}  // namespace quisp::modules::stub_node
@@ -0,0 +1,118 @@
+#include "EdgeList.h"
+
+#include <cctype>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace quisp::modules::topology_builder {
+
+namespace {
+bool isModuleName(const std::string &name) {
+  if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0]))) return false;
+  for (char c : name) {
+    if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_') return false;
+  }
+  return true;
+}
+
+std::vector<std::string> splitFields(const std::string &line) {
+  std::vector<std::string> fields;
+  std::stringstream ss(line);
+  std::string field;
+  while (std::getline(ss, field, ',')) {
+    auto first = field.find_first_not_of(" \t\r");
+    auto last = field.find_last_not_of(" \t\r");
+    fields.push_back(first == std::string::npos ? "" : field.substr(first, last - first + 1));
+  }
+  return fields;
+}
+
+Attributes parseAttributes(const std::vector<std::string> &fields, std::size_t first) {
+  Attributes attributes;
+  for (auto i = first; i < fields.size(); i++) {
+    auto separator = fields[i].find('=');
+    if (separator == std::string::npos || separator == 0) throw std::invalid_argument("expected <parameter>=<value>, got " + fields[i]);
+    attributes.emplace_back(fields[i].substr(0, separator), fields[i].substr(separator + 1));
+  }
+  return attributes;
+}
+
+void writeAttributes(std::ostream &os, const Attributes &attributes) {
+  for (auto &[name, value] : attributes) os << ',' << name << '=' << value;
+}
+}  // namespace
+
+NodeKind EdgeListNode::kind() const {
+  if (node_type == "BSA") return NodeKind::BSA;
+  if (node_type == "EPPS") return NodeKind::EPPS;
+  if (node_type == "Stub") return NodeKind::Stub;
+  return NodeKind::QNode;
+}
+
+int EdgeListTopology::addNode(std::string name, int address, std::string node_type, Attributes attributes) {
+  nodes.push_back(EdgeListNode{std::move(name), address, std::move(node_type), std::move(attributes)});
+  return nodes.size() - 1;
+}
+
+void EdgeListTopology::addLink(int a, int b, double distance_km, Attributes attributes) { links.push_back(EdgeListLink{a, b, distance_km, std::move(attributes)}); }
+
+EdgeListTopology EdgeListTopology::read(std::istream &is) {
+  EdgeListTopology topology;
+  std::unordered_map<std::string, int> node_indices;
+  std::unordered_set<int> addresses;
+  std::string line;
+  for (int line_number = 1; std::getline(is, line); line_number++) {
+    auto comment = line.find('#');
+    if (comment != std::string::npos) line.erase(comment);
+    if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+    try {
+      auto fields = splitFields(line);
+      if (fields.size() < 4) throw std::invalid_argument("too few fields");
+      if (fields[0] == "node") {
+        if (!isModuleName(fields[1])) throw std::invalid_argument("invalid node name " + fields[1]);
+        if (node_indices.count(fields[1]) > 0) throw std::invalid_argument("duplicate node " + fields[1]);
+        int address = std::stoi(fields[2]);
+        if (!addresses.insert(address).second) throw std::invalid_argument("duplicate address " + fields[2]);
+        const auto &type = fields[3];
+        if (type != "EndNode" && type != "Repeater" && type != "Router" && type != "BSA" && type != "EPPS") throw std::invalid_argument("unknown node type " + type);
+        node_indices[fields[1]] = topology.addNode(fields[1], address, type, parseAttributes(fields, 4));
+      } else if (fields[0] == "link") {
+        auto a = node_indices.find(fields[1]), b = node_indices.find(fields[2]);
+        if (a == node_indices.end() || b == node_indices.end()) throw std::invalid_argument("link to an undeclared node");
+        if (a->second == b->second) throw std::invalid_argument("link from " + fields[1] + " to itself");
+        if (topology.nodes[a->second].kind() != NodeKind::QNode && topology.nodes[b->second].kind() != NodeKind::QNode) {
+          throw std::invalid_argument("link without a QNode between " + fields[1] + " and " + fields[2]);
+        }
+        double distance_km = std::stod(fields[3]);
+        if (distance_km < 0) throw std::invalid_argument("negative distance " + fields[3]);
+        topology.addLink(a->second, b->second, distance_km, parseAttributes(fields, 4));
+      } else {
+        throw std::invalid_argument("unknown record " + fields[0]);
+      }
+    } catch (const std::logic_error &e) {
+      // std::stoi and std::stod throw std::invalid_argument or std::out_of_range
+      throw std::invalid_argument("edge list line " + std::to_string(line_number) + ": " + e.what());
+    }
+  }
+  return topology;
+}
+
+void EdgeListTopology::write(std::ostream &os) const {
+  auto precision = os.precision(std::numeric_limits<double>::max_digits10);
+  for (auto &node : nodes) {
+    os << "node," << node.name << ',' << node.address << ',' << node.node_type;
+    writeAttributes(os, node.attributes);
+    os << '\n';
+  }
+  for (auto &link : links) {
+    os << "link," << nodes[link.a].name << ',' << nodes[link.b].name << ',' << link.distance_km;
+    writeAttributes(os, link.attributes);
+    os << '\n';
+  }
+  os.precision(precision);
+}
+
+}  // namespace quisp::modules::topology_builder
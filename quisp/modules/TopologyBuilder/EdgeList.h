@@ -0,0 +1,58 @@
+#pragma once
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace quisp::modules::topology_builder {
+
+// the node modules, QNode for the EndNode, Repeater and Router node types. Stub in place of a QNode outside the region, see StubRegion.h
+enum class NodeKind { QNode, BSA, EPPS, Stub };
+
+// the NED parameters of a node or a channel as name and value expression, e.g. {"buffers", "20"}
+using Attributes = std::vector<std::pair<std::string, std::string>>;
+
+struct EdgeListNode {
+  std::string name;
+  int address;
+  std::string node_type;
+  Attributes attributes;
+
+  NodeKind kind() const;
+};
+
+// a quantum link and the classical link along it, between the nodes at the indices
+struct EdgeListLink {
+  int a;
+  int b;
+  double distance_km;
+  Attributes attributes;
+};
+
+/**
+ * \brief EdgeListTopology is a network as lists of nodes and links, for the networks too large to write as NED.
+ *
+ * The CSV format has a record per line, and '#' starts a comment:
+ *
+ *     node,<name>,<address>,<node_type>[,<parameter>=<value>...]
+ *     link,<node name>,<node name>,<distance in km>[,<parameter>=<value>...]
+ *
+ * node_type is EndNode, Repeater or Router for a QNode, or BSA or EPPS. A node comes before its links.
+ * The values are NED expressions without commas set to the node or to the quantum channel, e.g. buffers=20 or channel_loss_rate=0.01.
+ */
+struct EdgeListTopology {
+  std::vector<EdgeListNode> nodes;
+  std::vector<EdgeListLink> links;
+
+  /// @brief adds the node and returns its index.
+  int addNode(std::string name, int address, std::string node_type, Attributes attributes = {});
+  void addLink(int a, int b, double distance_km, Attributes attributes = {});
+
+  /// @brief parses the CSV format. Throws std::invalid_argument with the line number for an invalid record.
+  static EdgeListTopology read(std::istream &is);
+  void write(std::ostream &os) const;
+};
+
+}  // namespace quisp::modules::topology_builder
@@ -0,0 +1,81 @@
+#include "EdgeList.h"
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+using namespace quisp::modules::topology_builder;
+
+TEST(EdgeListTest, ReadNodesAndLinks) {
+  std::istringstream is(R"(# a repeater chain with a BSA node
+node,alice,1,EndNode,buffers=20
+node, repeater ,2,Repeater
+node,bsa,3,BSA
+node,bob,4,EndNode
+
+link,alice,repeater,10.5,channel_loss_rate=0.01
+link,repeater,bsa,5  # half of the link through the BSA
+link,bsa,bob,5
+)");
+  auto topology = EdgeListTopology::read(is);
+  ASSERT_EQ(topology.nodes.size(), 4);
+  EXPECT_EQ(topology.nodes[0].name, "alice");
+  EXPECT_EQ(topology.nodes[0].address, 1);
+  EXPECT_EQ(topology.nodes[0].attributes, (Attributes{{"buffers", "20"}}));
+  EXPECT_EQ(topology.nodes[1].name, "repeater");
+  EXPECT_EQ(topology.nodes[1].kind(), NodeKind::QNode);
+  EXPECT_EQ(topology.nodes[2].kind(), NodeKind::BSA);
+  ASSERT_EQ(topology.links.size(), 3);
+  EXPECT_EQ(topology.links[0].a, 0);
+  EXPECT_EQ(topology.links[0].b, 1);
+  EXPECT_DOUBLE_EQ(topology.links[0].distance_km, 10.5);
+  EXPECT_EQ(topology.links[0].attributes, (Attributes{{"channel_loss_rate", "0.01"}}));
+  EXPECT_EQ(topology.links[2].b, 3);
+}
+
+TEST(EdgeListTest, WriteAndReadBack) {
+  EdgeListTopology topology;
+  topology.addNode("a", 0, "EndNode", {{"mass", "50"}});
+  topology.addNode("epps", 7, "EPPS");
+  topology.addNode("b", 1, "Router");
+  topology.addLink(0, 1, 1.0 / 3);
+  topology.addLink(1, 2, 2, {{"channel_x_error_rate", "0.1"}});
+  std::stringstream ss;
+  topology.write(ss);
+  auto read = EdgeListTopology::read(ss);
+  ASSERT_EQ(read.nodes.size(), 3);
+  EXPECT_EQ(read.nodes[1].name, "epps");
+  EXPECT_EQ(read.nodes[1].address, 7);
+  EXPECT_EQ(read.nodes[0].attributes, topology.nodes[0].attributes);
+  ASSERT_EQ(read.links.size(), 2);
+  EXPECT_EQ(read.links[0].distance_km, 1.0 / 3);
+  EXPECT_EQ(read.links[1].attributes, topology.links[1].attributes);
+}
+
+TEST(EdgeListTest, InvalidRecords) {
+  auto read = [](const std::string &text) {
+    std::istringstream is(text);
+    return EdgeListTopology::read(is);
+  };
+  EXPECT_THROW(read("node,a,1\n"), std::invalid_argument);
+  EXPECT_THROW(read("node,a,1,Satellite\n"), std::invalid_argument);
+  EXPECT_THROW(read("node,0a,1,EndNode\n"), std::invalid_argument);
+  EXPECT_THROW(read("node,a,x,EndNode\n"), std::invalid_argument);
+  EXPECT_THROW(read("node,a,1,EndNode\nnode,a,2,EndNode\n"), std::invalid_argument);
+  EXPECT_THROW(read("node,a,1,EndNode\nnode,b,1,EndNode\n"), std::invalid_argument);
+  EXPECT_THROW(read("node,a,1,EndNode\nlink,a,b,1\n"), std::invalid_argument);
+  EXPECT_THROW(read("node,a,1,EndNode\nlink,a,a,1\n"), std::invalid_argument);
+  EXPECT_THROW(read("node,a,1,BSA\nnode,b,2,EPPS\nlink,a,b,1\n"), std::invalid_argument);
+  EXPECT_THROW(read("node,a,1,EndNode\nnode,b,2,EndNode\nlink,a,b,-1\n"), std::invalid_argument);
+  EXPECT_THROW(read("node,a,1,EndNode,buffers\n"), std::invalid_argument);
+  EXPECT_THROW(read("edge,a,b,1\n"), std::invalid_argument);
+  try {
+    read("node,a,1,EndNode\n\n# comment\nnode,b,2,Unknown\n");
+    FAIL();
+  } catch (const std::invalid_argument &e) {
+    EXPECT_NE(std::string(e.what()).find("line 4"), std::string::npos);
+  }
+}
+
+}  // namespace
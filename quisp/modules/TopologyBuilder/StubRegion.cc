@@ -0,0 +1,81 @@
+#include "StubRegion.h"
+
+#include <stdexcept>
+#include <unordered_map>
+
+namespace quisp::modules::topology_builder {
+
+RegionTopology selectRegion(const EdgeListTopology &topology, const std::vector<std::string> &region) {
+  auto num_nodes = topology.nodes.size();
+  std::unordered_map<std::string, int> node_indices;
+  for (std::size_t i = 0; i < num_nodes; i++) node_indices[topology.nodes[i].name] = i;
+  std::vector<bool> kept(num_nodes, false);
+  for (auto &name : region) {
+    auto it = node_indices.find(name);
+    if (it == node_indices.end()) throw std::invalid_argument("no node " + name + " in the region");
+    if (topology.nodes[it->second].kind() != NodeKind::QNode) throw std::invalid_argument(name + " in the region isn't a QNode");
+    kept[it->second] = true;
+  }
+
+  // the links of each BSA and EPPS node, which stays if all of its QNodes are in the region
+  std::vector<std::vector<int>> middle_links(num_nodes);
+  for (std::size_t i = 0; i < topology.links.size(); i++) {
+    auto &link = topology.links[i];
+    if (topology.nodes[link.a].kind() != NodeKind::QNode) middle_links[link.a].push_back(i);
+    if (topology.nodes[link.b].kind() != NodeKind::QNode) middle_links[link.b].push_back(i);
+  }
+  for (std::size_t i = 0; i < num_nodes; i++) {
+    if (topology.nodes[i].kind() == NodeKind::QNode || middle_links[i].empty()) continue;
+    bool all_in_region = true;
+    for (int link_index : middle_links[i]) {
+      auto &link = topology.links[link_index];
+      all_in_region &= kept[link.a == (int)i ? link.b : link.a];
+    }
+    kept[i] = all_in_region;
+  }
+
+  RegionTopology result;
+  std::vector<int> new_indices(num_nodes, -1);
+  for (std::size_t i = 0; i < num_nodes; i++) {
+    if (!kept[i]) continue;
+    auto &node = topology.nodes[i];
+    new_indices[i] = result.topology.addNode(node.name, node.address, node.node_type, node.attributes);
+  }
+  std::unordered_map<int, int> stub_indices;
+  auto stub_of = [&](int outside) {
+    auto it = stub_indices.find(outside);
+    if (it != stub_indices.end()) return it->second;
+    auto &node = topology.nodes[outside];
+    return stub_indices[outside] = result.topology.addNode(node.name, node.address, "Stub");
+  };
+  auto add_link = [&](int a, int b, const EdgeListLink &link, double far_distance_km) {
+    result.topology.addLink(a, b, link.distance_km, link.attributes);
+    result.far_distances_km.push_back(far_distance_km);
+  };
+
+  for (auto &link : topology.links) {
+    if (kept[link.a] && kept[link.b]) {
+      add_link(new_indices[link.a], new_indices[link.b], link, 0);
+      continue;
+    }
+    if (!kept[link.a] && !kept[link.b]) continue;
+    int inside = kept[link.a] ? link.a : link.b;
+    int outside = kept[link.a] ? link.b : link.a;
+    // the links of the kept BSA and EPPS nodes are all in the region
+    if (topology.nodes[outside].kind() == NodeKind::QNode) {
+      add_link(new_indices[inside], stub_of(outside), link, 0);
+      continue;
+    }
+    // the QNode on the other side of the BSA or EPPS node, a dangling one has none
+    for (int link_index : middle_links[outside]) {
+      auto &far_link = topology.links[link_index];
+      int far_node = far_link.a == outside ? far_link.b : far_link.a;
+      if (far_node == inside || kept[far_node]) continue;
+      add_link(new_indices[inside], stub_of(far_node), link, far_link.distance_km);
+      break;
+    }
+  }
+  return result;
+}
+
+}  // namespace quisp::modules::topology_builder
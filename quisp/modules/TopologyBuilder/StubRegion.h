@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "EdgeList.h"
+
+namespace quisp::modules::topology_builder {
+
+// the region of a topology to simulate in detail, with the stubs in place of the QNodes around it
+struct RegionTopology {
+  EdgeListTopology topology;
+  // the length of each link of the topology beyond its stub, the half of a link through a BSA or EPPS node left out. 0 for the others
+  std::vector<double> far_distances_km;
+};
+
+/**
+ * @brief the QNodes of the region and the BSA and EPPS nodes between them, and a Stub node for each QNode outside next to the region.
+ *
+ * A stub has the name and the address of the QNode it replaces, and nothing beyond it is kept.
+ * A link from the region to an outside QNode, directly or through a BSA or EPPS node, becomes a link to the stub
+ * with the distance and the attributes of the half in the region.
+ *
+ * @throws std::invalid_argument if a name of the region isn't a QNode of the topology
+ */
+RegionTopology selectRegion(const EdgeListTopology &topology, const std::vector<std::string> &region);
+
+}  // namespace quisp::modules::topology_builder
@@ -0,0 +1,74 @@
+#include "StubRegion.h"
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+namespace {
+using namespace quisp::modules::topology_builder;
+
+// a - b - bsa - c - d, and b - epps - e
+EdgeListTopology makeTopology() {
+  EdgeListTopology topology;
+  int a = topology.addNode("a", 1, "EndNode");
+  int b = topology.addNode("b", 2, "Router", {{"buffers", "20"}});
+  int bsa = topology.addNode("bsa", 3, "BSA");
+  int c = topology.addNode("c", 4, "Router");
+  int d = topology.addNode("d", 5, "EndNode");
+  int epps = topology.addNode("epps", 6, "EPPS");
+  int e = topology.addNode("e", 7, "EndNode");
+  topology.addLink(a, b, 10, {{"channel_loss_rate", "0.01"}});
+  topology.addLink(b, bsa, 4);
+  topology.addLink(bsa, c, 6);
+  topology.addLink(c, d, 20);
+  topology.addLink(b, epps, 3);
+  topology.addLink(epps, e, 5);
+  return topology;
+}
+
+TEST(StubRegionTest, KeepsTheWholeRegion) {
+  auto region = selectRegion(makeTopology(), {"a", "b", "c", "d", "e"});
+  EXPECT_EQ(region.topology.nodes.size(), 7);
+  EXPECT_EQ(region.topology.links.size(), 6);
+  EXPECT_EQ(region.far_distances_km, std::vector<double>(6, 0));
+}
+
+TEST(StubRegionTest, ReplacesTheNodesAroundTheRegionWithStubs) {
+  auto region = selectRegion(makeTopology(), {"a", "b"});
+  auto &nodes = region.topology.nodes;
+  // a, b, and the stubs of c and e beyond the BSA and the EPPS nodes; d isn't next to the region
+  ASSERT_EQ(nodes.size(), 4);
+  EXPECT_EQ(nodes[0].name, "a");
+  EXPECT_EQ(nodes[1].attributes, (Attributes{{"buffers", "20"}}));
+  EXPECT_EQ(nodes[2].name, "c");
+  EXPECT_EQ(nodes[2].address, 4);
+  EXPECT_EQ(nodes[2].kind(), NodeKind::Stub);
+  EXPECT_EQ(nodes[3].name, "e");
+  EXPECT_EQ(nodes[3].kind(), NodeKind::Stub);
+
+  auto &links = region.topology.links;
+  ASSERT_EQ(links.size(), 3);
+  EXPECT_EQ(links[0].attributes, (Attributes{{"channel_loss_rate", "0.01"}}));
+  EXPECT_EQ(links[1].a, 1);
+  EXPECT_EQ(links[1].b, 2);
+  EXPECT_DOUBLE_EQ(links[1].distance_km, 4);
+  EXPECT_EQ(links[2].b, 3);
+  EXPECT_DOUBLE_EQ(links[2].distance_km, 3);
+  EXPECT_EQ(region.far_distances_km, (std::vector<double>{0, 6, 5}));
+}
+
+TEST(StubRegionTest, StubOfADirectLink) {
+  auto region = selectRegion(makeTopology(), {"d"});
+  ASSERT_EQ(region.topology.nodes.size(), 2);
+  EXPECT_EQ(region.topology.nodes[1].name, "c");
+  ASSERT_EQ(region.topology.links.size(), 1);
+  EXPECT_EQ(region.topology.links[0].a, 0);
+  EXPECT_DOUBLE_EQ(region.topology.links[0].distance_km, 20);
+  EXPECT_EQ(region.far_distances_km, (std::vector<double>{0}));
+}
+
+TEST(StubRegionTest, RejectsAnUnknownNode) {
+  EXPECT_THROW(selectRegion(makeTopology(), {"a", "f"}), std::invalid_argument);
+  EXPECT_THROW(selectRegion(makeTopology(), {"a", "bsa"}), std::invalid_argument);
+}
+
+}  // namespace
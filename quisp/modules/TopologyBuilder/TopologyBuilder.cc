@@ -0,0 +1,177 @@
+#include "TopologyBuilder.h"
+
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "StubRegion.h"
+#include "TopologyGenerator.h"
+
+namespace quisp::modules::topology_builder {
+
+Define_Module(TopologyBuilder);
+
+namespace {
+const char *moduleTypeOf(NodeKind kind) {
+  switch (kind) {
+    case NodeKind::BSA:
+      return "modules.BSANode";
+    case NodeKind::EPPS:
+      return "modules.EPPSNode";
+    case NodeKind::Stub:
+      return "modules.StubNode.StubNode";
+    default:
+      return "modules.QNode";
+  }
+}
+}  // namespace
+
+void TopologyBuilder::initialize(int stage) {
+  if (stage == 0) {
+    if (getEnvir()->getParsimNumPartitions() > 1) error("TopologyBuilder doesn't support the parallel simulation, declare the nodes in NED instead");
+    auto topology = loadTopology();
+    std::string output_file = par("output_file").stdstringValue();
+    if (!output_file.empty()) {
+      std::ofstream os(output_file);
+      if (!os) error("failed to open the output_file: %s", output_file.c_str());
+      topology.write(os);
+    }
+    auto region = cStringTokenizer(par("region").stringValue()).asVector();
+    if (region.empty()) {
+      buildTopology(topology);
+    } else {
+      try {
+        auto region_topology = selectRegion(topology, region);
+        buildTopology(region_topology.topology, region_topology.far_distances_km);
+      } catch (const std::invalid_argument &e) {
+        error("invalid region: %s", e.what());
+      }
+    }
+  }
+  // runs the same stage of all the created nodes before the next one, as they read each other's state between the stages
+  bool has_more_stages = false;
+  for (auto *node : nodes) has_more_stages |= node->callInitialize(stage);
+  if (has_more_stages) num_init_stages = stage + 2;
+}
+
+void TopologyBuilder::handleMessage(cMessage *msg) { error("TopologyBuilder doesn't receive messages"); }
+
+EdgeListTopology TopologyBuilder::loadTopology() {
+  std::string topology_file = par("topology_file").stdstringValue();
+  try {
+    if (!topology_file.empty()) {
+      std::ifstream is(topology_file);
+      if (!is) error("failed to open the topology_file: %s", topology_file.c_str());
+      return EdgeListTopology::read(is);
+    }
+    std::string generator = par("generator").stdstringValue();
+    int num_nodes = par("num_nodes").intValue();
+    std::string node_type = par("generated_node_type").stdstringValue();
+    auto seed = (std::uint64_t)par("generator_seed").intValue();
+    if (generator == "lattice") {
+      int columns = par("lattice_columns").intValue();
+      if (columns <= 0) {
+        columns = 1;
+        while ((columns + 1) * (columns + 1) <= num_nodes) columns++;
+      }
+      return generateLattice(num_nodes, columns, par("link_distance").doubleValue(), node_type);
+    }
+    if (generator == "random_geometric") return generateRandomGeometric(num_nodes, par("area_size").doubleValue(), par("link_range").doubleValue(), seed, node_type);
+    if (generator == "scale_free") return generateScaleFree(num_nodes, par("links_per_node").intValue(), par("link_distance").doubleValue(), seed, node_type);
+    error("unknown generator: %s", generator.c_str());
+  } catch (const std::invalid_argument &e) {
+    error("invalid topology %s: %s", topology_file.c_str(), e.what());
+  }
+}
+
+/**
+ * @details A link between QNodes goes through the internal BSA of the receiver qnic of a,
+ * a link with a BSA node or an EPPS node uses a qnic or a passive receiver qnic of the QNode, as declared in the NED networks.
+ * A link with a Stub node uses a qnic of the QNode, and the stub gets the far distance of the link.
+ */
+void TopologyBuilder::buildTopology(const EdgeListTopology &topology, const std::vector<double> &far_distances_km) {
+  std::vector<GateSizes> gate_sizes(topology.nodes.size());
+  std::vector<std::string> far_distances(topology.nodes.size());
+  for (std::size_t i = 0; i < topology.links.size(); i++) {
+    auto &link = topology.links[i];
+    auto a_kind = topology.nodes[link.a].kind(), b_kind = topology.nodes[link.b].kind();
+    gate_sizes[link.a].port++;
+    gate_sizes[link.b].port++;
+    if (a_kind == NodeKind::Stub || b_kind == NodeKind::Stub) {
+      auto stub = a_kind == NodeKind::Stub ? link.a : link.b;
+      gate_sizes[link.a].quantum_port++;
+      gate_sizes[link.b].quantum_port++;
+      far_distances[stub] += std::to_string(i < far_distances_km.size() ? far_distances_km[i] : 0) + " ";
+      continue;
+    }
+    if (a_kind == NodeKind::QNode && b_kind == NodeKind::QNode) {
+      gate_sizes[link.a].quantum_port_receiver++;
+      gate_sizes[link.b].quantum_port++;
+      continue;
+    }
+    auto qnode = a_kind == NodeKind::QNode ? link.a : link.b;
+    auto other = a_kind == NodeKind::QNode ? link.b : link.a;
+    gate_sizes[other].quantum_port++;
+    if (topology.nodes[other].kind() == NodeKind::EPPS) {
+      gate_sizes[qnode].quantum_port_receiver_passive++;
+    } else {
+      gate_sizes[qnode].quantum_port++;
+    }
+  }
+
+  nodes.reserve(topology.nodes.size());
+  for (std::size_t i = 0; i < topology.nodes.size(); i++) nodes.push_back(createNode(topology.nodes[i], gate_sizes[i], far_distances[i]));
+
+  for (auto &link : topology.links) {
+    auto a_kind = topology.nodes[link.a].kind(), b_kind = topology.nodes[link.b].kind();
+    const char *a_gate = "quantum_port", *b_gate = "quantum_port";
+    if (a_kind == NodeKind::QNode && b_kind == NodeKind::QNode) a_gate = "quantum_port_receiver";
+    if (a_kind == NodeKind::EPPS) b_gate = "quantum_port_receiver_passive";
+    if (b_kind == NodeKind::EPPS) a_gate = "quantum_port_receiver_passive";
+    connect(nodes[link.a], "port", nodes[link.b], "port", "channels.ClassicalChannel", link.distance_km, {});
+    connect(nodes[link.a], a_gate, nodes[link.b], b_gate, "channels.QuantumChannel", link.distance_km, link.attributes);
+  }
+}
+
+cModule *TopologyBuilder::createNode(const EdgeListNode &node, const GateSizes &gate_sizes, const std::string &far_distances) {
+  auto *module_type = cModuleType::get(moduleTypeOf(node.kind()));
+  auto *module = module_type->create(node.name.c_str(), getParentModule());
+  module->par("address").setIntValue(node.address);
+  module->par("node_type").setStringValue(node.node_type);
+  if (node.kind() == NodeKind::Stub) module->par("far_distances").setStringValue(far_distances);
+  for (auto &[name, value] : node.attributes) {
+    if (!module->hasPar(name.c_str())) error("%s has no parameter %s", node.name.c_str(), name.c_str());
+    module->par(name.c_str()).parse(value.c_str());
+  }
+  module->finalizeParameters();
+  module->setGateSize("port", gate_sizes.port);
+  module->setGateSize("quantum_port", gate_sizes.quantum_port);
+  if (node.kind() == NodeKind::QNode) {
+    module->setGateSize("quantum_port_receiver", gate_sizes.quantum_port_receiver);
+    module->setGateSize("quantum_port_receiver_passive", gate_sizes.quantum_port_receiver_passive);
+  }
+  module->buildInside();
+  module->scheduleStart(simTime());
+  return module;
+}
+
+// connects the first unconnected gates of a and b in both directions, like a <--> channel <--> b in NED
+void TopologyBuilder::connect(cModule *a, const char *a_gate, cModule *b, const char *b_gate, const char *channel_type, double distance_km, const Attributes &attributes) {
+  cGate *a_in, *a_out, *b_in, *b_out;
+  a->getOrCreateFirstUnconnectedGatePair(a_gate, false, false, a_in, a_out);
+  b->getOrCreateFirstUnconnectedGatePair(b_gate, false, false, b_in, b_out);
+  auto *type = cChannelType::get(channel_type);
+  auto create_channel = [&]() {
+    auto *channel = type->create("channel");
+    channel->par("distance").setDoubleValue(distance_km);
+    for (auto &[name, value] : attributes) {
+      if (!channel->hasPar(name.c_str())) error("%s has no parameter %s", channel_type, name.c_str());
+      channel->par(name.c_str()).parse(value.c_str());
+    }
+    return channel;
+  };
+  a_out->connectTo(b_in, create_channel());
+  b_out->connectTo(a_in, create_channel());
+}
+
+}  // namespace quisp::modules::topology_builder
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <omnetpp.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "EdgeList.h"
+
+using namespace omnetpp;
+
+namespace quisp::modules::topology_builder {
+
+/**
+ * \brief TopologyBuilder creates the QNode, BSANode and EPPSNode modules and their channels in the network
+ * from an EdgeListTopology, so that a network of thousands of nodes needs no NED connections.
+ *
+ * The nodes are initialized stage by stage along with the builder, the same as the nodes declared in NED.
+ * Place the builder after backend, logger and sharedResource in the network.
+ * With a region, only its QNodes are created in detail, and a StubNode stands for each QNode next to it, see StubRegion.h.
+ */
+class TopologyBuilder : public cSimpleModule {
+ protected:
+  void initialize(int stage) override;
+  int numInitStages() const override { return num_init_stages; }
+  void handleMessage(cMessage *msg) override;
+
+  EdgeListTopology loadTopology();
+  // far_distances_km by link for the links to the Stub nodes
+  void buildTopology(const EdgeListTopology &topology, const std::vector<double> &far_distances_km = {});
+  // the sizes of the gate vectors of a node, counted from its links before the node is created
+  struct GateSizes {
+    int port = 0;
+    int quantum_port = 0;
+    int quantum_port_receiver = 0;
+    int quantum_port_receiver_passive = 0;
+  };
+  cModule *createNode(const EdgeListNode &node, const GateSizes &gate_sizes, const std::string &far_distances);
+  void connect(cModule *a, const char *a_gate, cModule *b, const char *b_gate, const char *channel_type, double distance_km, const Attributes &attributes);
+
+  std::vector<cModule *> nodes;
+  // one more than the last stage a created node asked for
+  int num_init_stages = 1;
+};
+
+}  // namespace quisp::modules::topology_builder
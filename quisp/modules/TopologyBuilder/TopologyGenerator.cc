@@ -0,0 +1,114 @@
+#include "TopologyGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace quisp::modules::topology_builder {
+
+namespace {
+EdgeListTopology createNodes(int num_nodes, const std::string &node_type) {
+  if (num_nodes < 1) throw std::invalid_argument("the graph needs a node");
+  EdgeListTopology topology;
+  for (int i = 0; i < num_nodes; i++) topology.addNode("node" + std::to_string(i), i, node_type);
+  return topology;
+}
+
+// std::uniform_real_distribution differs between the standard libraries, this doesn't
+double uniform(std::mt19937_64 &rng) { return (rng() >> 11) * 0x1.0p-53; }
+
+int findRoot(std::vector<int> &parents, int node) {
+  while (parents[node] != node) node = parents[node] = parents[parents[node]];
+  return node;
+}
+}  // namespace
+
+EdgeListTopology generateLattice(int num_nodes, int columns, double spacing_km, const std::string &node_type) {
+  if (columns < 1) throw std::invalid_argument("the lattice needs a column");
+  auto topology = createNodes(num_nodes, node_type);
+  for (int i = 0; i < num_nodes; i++) {
+    if ((i + 1) % columns != 0 && i + 1 < num_nodes) topology.addLink(i, i + 1, spacing_km);
+    if (i + columns < num_nodes) topology.addLink(i, i + columns, spacing_km);
+  }
+  return topology;
+}
+
+EdgeListTopology generateRandomGeometric(int num_nodes, double area_km, double range_km, std::uint64_t seed, const std::string &node_type) {
+  auto topology = createNodes(num_nodes, node_type);
+  std::mt19937_64 rng(seed);
+  std::vector<double> xs(num_nodes), ys(num_nodes);
+  for (int i = 0; i < num_nodes; i++) {
+    xs[i] = uniform(rng) * area_km;
+    ys[i] = uniform(rng) * area_km;
+  }
+  auto distance = [&](int a, int b) { return std::hypot(xs[a] - xs[b], ys[a] - ys[b]); };
+
+  std::vector<int> parents(num_nodes);
+  std::iota(parents.begin(), parents.end(), 0);
+  for (int a = 0; a < num_nodes; a++) {
+    for (int b = a + 1; b < num_nodes; b++) {
+      if (distance(a, b) > range_km) continue;
+      topology.addLink(a, b, distance(a, b));
+      parents[findRoot(parents, a)] = findRoot(parents, b);
+    }
+  }
+
+  // the nodes of a component are compared with the nodes of the components already bridged
+  std::vector<std::vector<int>> components(num_nodes);
+  for (int i = 0; i < num_nodes; i++) components[findRoot(parents, i)].push_back(i);
+  std::vector<int> bridged;
+  for (auto &component : components) {
+    if (component.empty()) continue;
+    if (!bridged.empty()) {
+      double shortest = std::numeric_limits<double>::infinity();
+      int from = -1, to = -1;
+      for (int a : component) {
+        for (int b : bridged) {
+          if (distance(a, b) >= shortest) continue;
+          shortest = distance(a, b);
+          from = b;
+          to = a;
+        }
+      }
+      topology.addLink(from, to, shortest);
+    }
+    bridged.insert(bridged.end(), component.begin(), component.end());
+  }
+  return topology;
+}
+
+EdgeListTopology generateScaleFree(int num_nodes, int links_per_node, double distance_km, std::uint64_t seed, const std::string &node_type) {
+  if (links_per_node < 1) throw std::invalid_argument("the scale-free graph needs a link per node");
+  auto topology = createNodes(num_nodes, node_type);
+  std::mt19937_64 rng(seed);
+  // the nodes repeated by their degree, so that an uniform sample is proportional to the degree
+  std::vector<int> endpoints;
+  int num_seed_nodes = std::min(num_nodes, links_per_node + 1);
+  for (int a = 0; a < num_seed_nodes; a++) {
+    for (int b = a + 1; b < num_seed_nodes; b++) {
+      topology.addLink(a, b, distance_km);
+      endpoints.push_back(a);
+      endpoints.push_back(b);
+    }
+  }
+  std::vector<int> targets;
+  for (int node = num_seed_nodes; node < num_nodes; node++) {
+    targets.clear();
+    while ((int)targets.size() < links_per_node) {
+      int target = endpoints[rng() % endpoints.size()];
+      if (std::find(targets.begin(), targets.end(), target) == targets.end()) targets.push_back(target);
+    }
+    for (int target : targets) {
+      topology.addLink(target, node, distance_km);
+      endpoints.push_back(target);
+      endpoints.push_back(node);
+    }
+  }
+  return topology;
+}
+
+}  // namespace quisp::modules::topology_builder
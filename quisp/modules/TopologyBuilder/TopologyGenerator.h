@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "EdgeList.h"
+
+namespace quisp::modules::topology_builder {
+
+/**
+ * The graphs for the scaling benchmarks, with the QNodes node0, node1, ... at the addresses 0, 1, ...
+ * linked directly with the internal BSA of the QNode. Every generated graph is connected.
+ * The random graphs are the same for the same seed on any platform.
+ */
+
+/// @brief the nodes in rows of columns, the last row is partial if num_nodes isn't a multiple of columns.
+EdgeListTopology generateLattice(int num_nodes, int columns, double spacing_km, const std::string &node_type);
+
+/**
+ * @brief the nodes at uniformly random points in the area_km square, linked within range_km of each other.
+ * The components are bridged by the shortest link to the nodes before them.
+ */
+EdgeListTopology generateRandomGeometric(int num_nodes, double area_km, double range_km, std::uint64_t seed, const std::string &node_type);
+
+/// @brief Barabasi-Albert graph, each new node links to links_per_node nodes chosen by their degree.
+EdgeListTopology generateScaleFree(int num_nodes, int links_per_node, double distance_km, std::uint64_t seed, const std::string &node_type);
+
+}  // namespace quisp::modules::topology_builder
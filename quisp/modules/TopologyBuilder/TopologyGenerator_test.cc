@@ -0,0 +1,93 @@
+#include "TopologyGenerator.h"
+
+#include <gtest/gtest.h>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+using namespace quisp::modules::topology_builder;
+
+bool isConnected(const EdgeListTopology &topology) {
+  std::vector<std::vector<int>> neighbors(topology.nodes.size());
+  for (auto &link : topology.links) {
+    neighbors[link.a].push_back(link.b);
+    neighbors[link.b].push_back(link.a);
+  }
+  std::vector<bool> visited(topology.nodes.size());
+  std::vector<int> stack{0};
+  visited[0] = true;
+  int num_visited = 1;
+  while (!stack.empty()) {
+    int node = stack.back();
+    stack.pop_back();
+    for (int neighbor : neighbors[node]) {
+      if (visited[neighbor]) continue;
+      visited[neighbor] = true;
+      num_visited++;
+      stack.push_back(neighbor);
+    }
+  }
+  return num_visited == (int)topology.nodes.size();
+}
+
+std::vector<int> degrees(const EdgeListTopology &topology) {
+  std::vector<int> degrees(topology.nodes.size());
+  for (auto &link : topology.links) {
+    degrees[link.a]++;
+    degrees[link.b]++;
+  }
+  return degrees;
+}
+
+TEST(TopologyGeneratorTest, Lattice) {
+  // 3 full rows of 4 and a row of 2
+  auto topology = generateLattice(14, 4, 10, "Repeater");
+  ASSERT_EQ(topology.nodes.size(), 14);
+  EXPECT_EQ(topology.nodes[13].name, "node13");
+  EXPECT_EQ(topology.nodes[13].address, 13);
+  EXPECT_EQ(topology.nodes[0].node_type, "Repeater");
+  // 3 * 3 + 1 horizontal and 3 * 4 - 2 vertical links
+  EXPECT_EQ(topology.links.size(), 20);
+  EXPECT_TRUE(isConnected(topology));
+  EXPECT_EQ(degrees(topology)[5], 4);
+  EXPECT_EQ(degrees(topology)[0], 2);
+  for (auto &link : topology.links) EXPECT_EQ(link.distance_km, 10);
+
+  EXPECT_EQ(generateLattice(1, 4, 10, "EndNode").links.size(), 0);
+  EXPECT_THROW(generateLattice(0, 4, 10, "EndNode"), std::invalid_argument);
+}
+
+TEST(TopologyGeneratorTest, RandomGeometric) {
+  auto topology = generateRandomGeometric(200, 100, 8, 42, "EndNode");
+  ASSERT_EQ(topology.nodes.size(), 200);
+  EXPECT_TRUE(isConnected(topology));
+  for (auto &link : topology.links) EXPECT_LT(link.a, link.b == link.a ? 0 : 200);
+
+  // a range too short for any link still gives a tree of the bridges
+  auto sparse = generateRandomGeometric(30, 100, 0, 1, "EndNode");
+  EXPECT_EQ(sparse.links.size(), 29);
+  EXPECT_TRUE(isConnected(sparse));
+
+  auto same = generateRandomGeometric(200, 100, 8, 42, "EndNode");
+  ASSERT_EQ(same.links.size(), topology.links.size());
+  for (std::size_t i = 0; i < same.links.size(); i++) EXPECT_EQ(same.links[i].distance_km, topology.links[i].distance_km);
+}
+
+TEST(TopologyGeneratorTest, ScaleFree) {
+  auto topology = generateScaleFree(500, 2, 20, 7, "EndNode");
+  ASSERT_EQ(topology.nodes.size(), 500);
+  // 3 links of the seed triangle and 2 for each of the others
+  EXPECT_EQ(topology.links.size(), 3 + 2 * 497);
+  EXPECT_TRUE(isConnected(topology));
+  auto node_degrees = degrees(topology);
+  for (int degree : node_degrees) EXPECT_GE(degree, 2);
+  // the preferential attachment makes hubs far above the mean degree of 4
+  EXPECT_GT(*std::max_element(node_degrees.begin(), node_degrees.end()), 20);
+  for (auto &link : topology.links) EXPECT_NE(link.a, link.b);
+
+  EXPECT_EQ(generateScaleFree(2, 3, 20, 7, "EndNode").links.size(), 1);
+  EXPECT_THROW(generateScaleFree(10, 0, 20, 7, "EndNode"), std::invalid_argument);
+}
+
+}  // namespace
@@ -11,9 +11,13 @@ using QNicType = int;
 using QubitIndex = int;
 using QubitId = std::tuple<QNodeAddr, QNicIndex, QNicType, QubitIndex>;
 using IBackendQubit = quisp::backends::IQubit;
+using quisp::backends::DensityMatrixBackend;
 using quisp::backends::GraphStateBackend;
+using quisp::backends::HybridBackend;
 using quisp::backends::IConfiguration;
 using quisp::backends::IQuantumBackend;
 using quisp::backends::IQubitId;
+using quisp::backends::PauliFrameBackend;
+using quisp::backends::StabilizerTableauBackend;
 using quisp::backends::StationaryQubitConfiguration;
 }  // namespace quisp::modules::common
@@ -15,8 +15,13 @@ Action::Action(std::vector<int> partner_addr) {
   }
 }
 
-Purification::Purification(PurType purification_type, int partner_addr, int shared_rule_tag)
-    : Action(partner_addr), purification_type(purification_type), shared_rule_tag(shared_rule_tag) {}
+Purification::Purification(PurType purification_type, int partner_addr, int shared_rule_tag, int pumping_rounds)
+    : Action(partner_addr), purification_type(purification_type), shared_rule_tag(shared_rule_tag), pumping_rounds(pumping_rounds) {}
+
+bool Purification::canPump(PurType purification_type) {
+  return purification_type == SINGLE_SELECTION_X_PURIFICATION || purification_type == SINGLE_SELECTION_Z_PURIFICATION || purification_type == SINGLE_SELECTION_Y_PURIFICATION ||
+         purification_type == SINGLE_SELECTION_XZ_PURIFICATION || purification_type == SINGLE_SELECTION_ZX_PURIFICATION;
+}
 
 json Purification::serialize_json() {
   json purification_json;
@@ -24,16 +29,19 @@ json Purification::serialize_json() {
   purification_json["options"]["purification_type"] = purification_type;
   purification_json["options"]["interface"] = qnic_interfaces;
   purification_json["options"]["shared_rule_tag"] = shared_rule_tag;
+  // the plain purification keeps its json as before
+  if (pumping_rounds > 1) purification_json["options"]["pumping_rounds"] = pumping_rounds;
   return purification_json;
 }
 
-void Purification::deserialize_json(json serialized) {
-  auto options = serialized["options"];
-  if (options != nullptr) {
+void Purification::deserialize_json(const json &serialized) {
+  auto options = serialized.find("options");
+  if (options != serialized.end() && !options->is_null()) {
     // get options one by one
-    options["purification_type"].get_to(purification_type);
-    options["interface"].get_to(qnic_interfaces);
-    options["shared_rule_tag"].get_to(shared_rule_tag);
+    options->at("purification_type").get_to(purification_type);
+    options->at("interface").get_to(qnic_interfaces);
+    options->at("shared_rule_tag").get_to(shared_rule_tag);
+    pumping_rounds = options->value("pumping_rounds", 1);
   }
 }
 
@@ -53,13 +61,13 @@ json EntanglementSwapping::serialize_json() {
   return swapping_json;
 }
 
-void EntanglementSwapping::deserialize_json(json serialized) {
-  auto options = serialized["options"];
-  if (options != nullptr) {
+void EntanglementSwapping::deserialize_json(const json &serialized) {
+  auto options = serialized.find("options");
+  if (options != serialized.end() && !options->is_null()) {
     // get options one by one
-    options["interface"].get_to(qnic_interfaces);
-    options["remote_interface"].get_to(remote_qnic_interfaces);
-    options["shared_rule_tag"].get_to(shared_rule_tag);
+    options->at("interface").get_to(qnic_interfaces);
+    options->at("remote_interface").get_to(remote_qnic_interfaces);
+    options->at("shared_rule_tag").get_to(shared_rule_tag);
   }
 }
 
@@ -72,11 +80,11 @@ json PurificationCorrelation::serialize_json() {
   return wait_json;
 }
 
-void PurificationCorrelation::deserialize_json(json serialized) {
-  auto options = serialized["options"];
-  if (options != nullptr) {
-    options["interface"].get_to(qnic_interfaces);
-    options["shared_rule_tag"].get_to(shared_rule_tag);
+void PurificationCorrelation::deserialize_json(const json &serialized) {
+  auto options = serialized.find("options");
+  if (options != serialized.end() && !options->is_null()) {
+    options->at("interface").get_to(qnic_interfaces);
+    options->at("shared_rule_tag").get_to(shared_rule_tag);
   }
 }
 
@@ -90,11 +98,11 @@ json SwappingCorrection::serialize_json() {
   return wait_json;
 }
 
-void SwappingCorrection::deserialize_json(json serialized) {
-  auto options = serialized["options"];
-  if (options != nullptr) {
-    options["interface"].get_to(qnic_interfaces);
-    options["shared_rule_tag"].get_to(shared_rule_tag);
+void SwappingCorrection::deserialize_json(const json &serialized) {
+  auto options = serialized.find("options");
+  if (options != serialized.end() && !options->is_null()) {
+    options->at("interface").get_to(qnic_interfaces);
+    options->at("shared_rule_tag").get_to(shared_rule_tag);
   }
 }
 
@@ -109,13 +117,13 @@ json Tomography::serialize_json() {
   return tomography_json;
 }
 
-void Tomography::deserialize_json(json serialized) {
-  auto options = serialized["options"];
-  if (options != nullptr) {
+void Tomography::deserialize_json(const json &serialized) {
+  auto options = serialized.find("options");
+  if (options != serialized.end() && !options->is_null()) {
     // get options one by one
-    options["num_measure"].get_to(num_measurement);
-    options["owner_address"].get_to(owner_address);
-    options["interface"].get_to(qnic_interfaces);
+    options->at("num_measure").get_to(num_measurement);
+    options->at("owner_address").get_to(owner_address);
+    options->at("interface").get_to(qnic_interfaces);
   }
 }
 }  // namespace quisp::rules
@@ -54,56 +54,66 @@ class Action {
   std::vector<QnicInterface> qnic_interfaces;
   int partner_address;
   virtual json serialize_json() = 0;
-  virtual void deserialize_json(json serialized) = 0;
+  virtual void deserialize_json(const json &serialized) = 0;
 };
 
 class Purification : public Action {
  public:
-  Purification(json serialized) { deserialize_json(serialized); }  // for deserialization
-  Purification(PurType purification_type, int partner_addr, int shared_rule_tag);
+  Purification(const json &serialized) { deserialize_json(serialized); }  // for deserialization
+  Purification(PurType purification_type, int partner_addr, int shared_rule_tag, int pumping_rounds = 1);
   PurType purification_type;
   int shared_rule_tag;
+  /**
+   * @brief the rounds of the entanglement pumping in this action, 1 for the plain purification of the type.
+   * The kept pair is purified with this many pairs in a row without waiting for the partner, and the results of all the rounds
+   * go to the partner in one message, checked by one PurificationCorrelation. Only for the types canPump() accepts.
+   */
+  int pumping_rounds = 1;
+  // the results of the rounds are the bits of one register
+  static constexpr int max_pumping_rounds = 16;
+  /// @brief the single selection types, XZ and ZX alternate their bases over the pumping rounds.
+  static bool canPump(PurType purification_type);
   json serialize_json() override;
-  void deserialize_json(json serialized) override;
+  void deserialize_json(const json &serialized) override;
 };
 
 class EntanglementSwapping : public Action {
  public:
-  EntanglementSwapping(json serialized) { deserialize_json(serialized); }  // for deserialization
+  EntanglementSwapping(const json &serialized) { deserialize_json(serialized); }  // for deserialization
   EntanglementSwapping(std::vector<int> partner_addr, int shared_rule_tag);
   std::vector<QnicInterface> remote_qnic_interfaces;
   int shared_rule_tag;
   json serialize_json() override;
-  void deserialize_json(json serialized) override;
+  void deserialize_json(const json &serialized) override;
 };
 
 class PurificationCorrelation : public Action {
  public:
-  PurificationCorrelation(json serialized) { deserialize_json(serialized); }  // for deserialization
+  PurificationCorrelation(const json &serialized) { deserialize_json(serialized); }  // for deserialization
   PurificationCorrelation(int partner_addr, int shared_rule_tag);
   int shared_rule_tag;
   json serialize_json() override;
-  void deserialize_json(json serialized) override;
+  void deserialize_json(const json &serialized) override;
 };
 
 class SwappingCorrection : public Action {
  public:
-  SwappingCorrection(json serialized) { deserialize_json(serialized); }  // for deserialization
+  SwappingCorrection(const json &serialized) { deserialize_json(serialized); }  // for deserialization
   SwappingCorrection(int swapper_addr, int shared_rule_tag);
   int shared_rule_tag;
   json serialize_json() override;
-  void deserialize_json(json serialized) override;
+  void deserialize_json(const json &serialized) override;
 };
 
 class Tomography : public Action {
  public:
-  Tomography(json serialized) { deserialize_json(serialized); }  // for deserialization
+  Tomography(const json &serialized) { deserialize_json(serialized); }  // for deserialization
   Tomography(int num_measurement, int owner_addr, int partner_addr);
   simtime_t start_time = -1;
   int num_measurement;
   int owner_address;
   json serialize_json() override;
-  void deserialize_json(json serialized) override;
+  void deserialize_json(const json &serialized) override;
 };
 
 }  // namespace quisp::rules
@@ -120,9 +120,7 @@ TEST_F(ActionExecutionTest, Swapping) {
   setGetQubitRule(6);
   finalizeRuleset();
 
-  EXPECT_CALL(*callback, gateCNOT(qubit1, qubit2)).Times(1);
-  EXPECT_CALL(*callback, measureQubitX(qubit1)).Times(1).WillOnce(Return(MeasurementOutcome{.basis = 'X', .outcome_is_plus = true}));
-  EXPECT_CALL(*callback, measureQubitZ(qubit2)).Times(1).WillOnce(Return(MeasurementOutcome{.basis = 'Z', .outcome_is_plus = true}));
+  EXPECT_CALL(*callback, bellMeasure(qubit1, qubit2)).Times(1).WillOnce(Return(0b00));
   EXPECT_CALL(*callback, freeAndResetQubit(qubit1)).Times(1);
   EXPECT_CALL(*callback, freeAndResetQubit(qubit2)).Times(1);
   EXPECT_CALL(*callback, sendSwappingResult(ruleset_id, QNodeAddr{left_partner_addr}, QNodeAddr{right_partner_addr}, 123, 1, 0b00)).Times(1);
@@ -135,9 +133,7 @@ TEST_F(ActionExecutionTest, Swapping) {
   ASSERT_EQ(getResourceSizeByRuleId(*runtime, 0), 0);
 
   runtime->terminated = false;
-  EXPECT_CALL(*callback, gateCNOT(qubit1, qubit2)).Times(1);
-  EXPECT_CALL(*callback, measureQubitX(qubit1)).Times(1).WillOnce(Return(MeasurementOutcome{.basis = 'X', .outcome_is_plus = false}));
-  EXPECT_CALL(*callback, measureQubitZ(qubit2)).Times(1).WillOnce(Return(MeasurementOutcome{.basis = 'Z', .outcome_is_plus = false}));
+  EXPECT_CALL(*callback, bellMeasure(qubit1, qubit2)).Times(1).WillOnce(Return(0b11));
   EXPECT_CALL(*callback, freeAndResetQubit(qubit1)).Times(1);
   EXPECT_CALL(*callback, freeAndResetQubit(qubit2)).Times(1);
   EXPECT_CALL(*callback, sendSwappingResult(ruleset_id, QNodeAddr{left_partner_addr}, QNodeAddr{right_partner_addr}, 123, 2, 0b11)).Times(1);
@@ -150,9 +146,7 @@ TEST_F(ActionExecutionTest, Swapping) {
   ASSERT_EQ(getResourceSizeByRuleId(*runtime, 0), 0);
 
   runtime->terminated = false;
-  EXPECT_CALL(*callback, gateCNOT(qubit1, qubit2)).Times(1);
-  EXPECT_CALL(*callback, measureQubitX(qubit1)).Times(1).WillOnce(Return(MeasurementOutcome{.basis = 'X', .outcome_is_plus = true}));
-  EXPECT_CALL(*callback, measureQubitZ(qubit2)).Times(1).WillOnce(Return(MeasurementOutcome{.basis = 'Z', .outcome_is_plus = false}));
+  EXPECT_CALL(*callback, bellMeasure(qubit1, qubit2)).Times(1).WillOnce(Return(0b10));
   EXPECT_CALL(*callback, freeAndResetQubit(qubit1)).Times(1);
   EXPECT_CALL(*callback, freeAndResetQubit(qubit2)).Times(1);
   EXPECT_CALL(*callback, sendSwappingResult(ruleset_id, QNodeAddr{left_partner_addr}, QNodeAddr{right_partner_addr}, 123, 3, 0b10)).Times(1);
@@ -165,9 +159,7 @@ TEST_F(ActionExecutionTest, Swapping) {
   ASSERT_EQ(getResourceSizeByRuleId(*runtime, 0), 0);
 
   runtime->terminated = false;
-  EXPECT_CALL(*callback, gateCNOT(qubit1, qubit2)).Times(1);
-  EXPECT_CALL(*callback, measureQubitX(qubit1)).Times(1).WillOnce(Return(MeasurementOutcome{.basis = 'X', .outcome_is_plus = false}));
-  EXPECT_CALL(*callback, measureQubitZ(qubit2)).Times(1).WillOnce(Return(MeasurementOutcome{.basis = 'Z', .outcome_is_plus = true}));
+  EXPECT_CALL(*callback, bellMeasure(qubit1, qubit2)).Times(1).WillOnce(Return(0b01));
   EXPECT_CALL(*callback, freeAndResetQubit(qubit1)).Times(1);
   EXPECT_CALL(*callback, freeAndResetQubit(qubit2)).Times(1);
   EXPECT_CALL(*callback, sendSwappingResult(ruleset_id, QNodeAddr{left_partner_addr}, QNodeAddr{right_partner_addr}, 123, 4, 0b01)).Times(1);
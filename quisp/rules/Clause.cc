@@ -12,12 +12,12 @@ json EnoughResourceConditionClause::serialize_json() {
   return enough_resource_json;
 }
 
-void EnoughResourceConditionClause::deserialize_json(json serialized) {
-  auto options = serialized["options"];
-  if (options != nullptr) {
+void EnoughResourceConditionClause::deserialize_json(const json &serialized) {
+  auto options = serialized.find("options");
+  if (options != serialized.end() && !options->is_null()) {
     // get options one by one
-    options["num_resource"].get_to(num_resource);
-    options["interface"]["partner_address"].get_to(partner_address);
+    options->at("num_resource").get_to(num_resource);
+    options->at("interface").at("partner_address").get_to(partner_address);
   }
 }
 
@@ -31,12 +31,12 @@ json MeasureCountConditionClause::serialize_json() {
   return measure_count_json;
 }
 
-void MeasureCountConditionClause::deserialize_json(json serialized) {
-  auto options = serialized["options"];
-  if (options != nullptr) {
+void MeasureCountConditionClause::deserialize_json(const json &serialized) {
+  auto options = serialized.find("options");
+  if (options != serialized.end() && !options->is_null()) {
     // get options one by one
-    options["num_measure"].get_to(num_measure);
-    options["interface"]["partner_address"].get_to(partner_address);
+    options->at("num_measure").get_to(num_measure);
+    options->at("interface").at("partner_address").get_to(partner_address);
   }
 }
 
@@ -50,12 +50,12 @@ json FidelityConditionClause::serialize_json() {
   return fidelity_json;
 }
 
-void FidelityConditionClause::deserialize_json(json serialized) {
-  auto options = serialized["options"];
-  if (options != nullptr) {
+void FidelityConditionClause::deserialize_json(const json &serialized) {
+  auto options = serialized.find("options");
+  if (options != serialized.end() && !options->is_null()) {
     // get options one by one
-    options["required_fidelity"].get_to(required_fidelity);
-    options["interface"]["partner_address"].get_to(partner_address);
+    options->at("required_fidelity").get_to(required_fidelity);
+    options->at("interface").at("partner_address").get_to(partner_address);
   }
 }
 
@@ -69,11 +69,11 @@ json PurificationCorrelationClause::serialize_json() {
   return wait_json;
 }
 
-void PurificationCorrelationClause::deserialize_json(json serialized) {
-  auto options = serialized["options"];
-  if (options != nullptr) {
-    options["interface"]["partner_address"].get_to(partner_address);
-    options["shared_rule_tag"].get_to(shared_rule_tag);
+void PurificationCorrelationClause::deserialize_json(const json &serialized) {
+  auto options = serialized.find("options");
+  if (options != serialized.end() && !options->is_null()) {
+    options->at("interface").at("partner_address").get_to(partner_address);
+    options->at("shared_rule_tag").get_to(shared_rule_tag);
   }
 }
 
@@ -87,11 +87,11 @@ json SwappingCorrectionClause::serialize_json() {
   return wait_json;
 }
 
-void SwappingCorrectionClause::deserialize_json(json serialized) {
-  auto options = serialized["options"];
-  if (options != nullptr) {
-    options["interface"]["partner_address"].get_to(partner_address);
-    options["shared_rule_tag"].get_to(shared_rule_tag);
+void SwappingCorrectionClause::deserialize_json(const json &serialized) {
+  auto options = serialized.find("options");
+  if (options != serialized.end() && !options->is_null()) {
+    options->at("interface").at("partner_address").get_to(partner_address);
+    options->at("shared_rule_tag").get_to(shared_rule_tag);
   }
 }
 
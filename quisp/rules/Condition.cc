@@ -12,13 +12,13 @@ json Condition::serialize_json() {
   return condition_json;
 }
 
-void Condition::deserialize_json(json serialized) {
+void Condition::deserialize_json(const json &serialized) {
   // prepare empty clauses
-  auto serialized_clauses = serialized["clauses"];
-  if (serialized["clauses"] != nullptr) {
-    for (auto clause : serialized_clauses) {
+  auto serialized_clauses = serialized.find("clauses");
+  if (serialized_clauses != serialized.end() && !serialized_clauses->is_null()) {
+    for (const auto &clause : *serialized_clauses) {
       // check clause type
-      auto clause_type = clause["type"].get<std::string>();
+      const auto &clause_type = clause.at("type").get_ref<const std::string &>();
       if (clause_type == "enough_resource") {
         auto enough_resource = std::make_unique<EnoughResourceConditionClause>(clause);
         clauses.push_back(std::move(enough_resource));
@@ -12,11 +12,11 @@ namespace quisp::rules {
 class Condition {
  public:
   Condition() {}
-  Condition(json serialized) { deserialize_json(serialized); }
+  Condition(const json &serialized) { deserialize_json(serialized); }
 
   std::vector<std::unique_ptr<Clause>> clauses;
   void addClause(std::unique_ptr<Clause> clause);
   json serialize_json();
-  void deserialize_json(json serialized);
+  void deserialize_json(const json &serialized);
 };
 }  // namespace quisp::rules
@@ -120,7 +120,9 @@ TEST_F(ConditionExecutionTest, EnoughResourceCondition) {
   auto clause = new EnoughResourceConditionClause(num_resource_required, partner_addr);
   cond.addClause(std::unique_ptr<Clause>(clause));
   auto program = RuleSetConverter::constructCondition(&cond);
-  runtime->ruleset.partner_initial_rule_table.insert({QNodeAddr{partner_addr}, 0});
+  // the first rule gets the qubits entangled with the partner
+  Program get_qubit{"", {INSTR_GET_QUBIT_QubitId_QNodeAddr_int_{{QubitId{0}, QNodeAddr{partner_addr}, 0}}}};
+  runtime->assignRuleSet(RuleSet{"", {Rule{get_qubit, Program{"", {}}}}});
   EXPECT_CALL(*callback, isQubitLocked(_)).WillRepeatedly(Return(false));
 
   runtime->execProgram(program);
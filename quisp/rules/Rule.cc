@@ -29,17 +29,18 @@ json Rule::serialize_json() {
   return rule_json;
 }
 
-void Rule::deserialize_json(json serialized) {
+void Rule::deserialize_json(const json &serialized) {
   // deserialize rule meta data
-  serialized["name"].get_to(name);
-  serialized["interface"].get_to(qnic_interfaces);
-  serialized["send_tag"].get_to(send_tag);
-  serialized["receive_tag"].get_to(receive_tag);
+  serialized.at("name").get_to(name);
+  serialized.at("interface").get_to(qnic_interfaces);
+  serialized.at("send_tag").get_to(send_tag);
+  serialized.at("receive_tag").get_to(receive_tag);
 
   // deserialize actions
-  if (serialized["action"] != nullptr) {  // action found
-    auto serialized_action = serialized.at("action");
-    auto action_name = serialized_action.at("type").get<std::string>();
+  auto action_json = serialized.find("action");
+  if (action_json != serialized.end() && !action_json->is_null()) {  // action found
+    const auto &serialized_action = *action_json;
+    const auto &action_name = serialized_action.at("type").get_ref<const std::string &>();
     // check which action to be initialized
     if (action_name == "purification") {
       auto purification_action = std::make_unique<Purification>(serialized_action);
@@ -62,9 +63,10 @@ void Rule::deserialize_json(json serialized) {
   }
 
   // deserialize conditions
-  if (serialized["condition"] != nullptr) {  // condition found
+  auto condition_json = serialized.find("condition");
+  if (condition_json != serialized.end() && !condition_json->is_null()) {  // condition found
     // empty condition
-    auto empty_condition = std::make_unique<Condition>(serialized.at("condition"));
+    auto empty_condition = std::make_unique<Condition>(*condition_json);
     setCondition(std::move(empty_condition));
   }
 }
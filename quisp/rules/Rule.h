@@ -20,7 +20,7 @@ class Rule {
   Rule(){};
   Rule(int partner_address, int send_tag, int receive_tag);
   Rule(std::vector<int> partner_address, int send_tag, int receive_tag);
-  Rule(json serialized) { deserialize_json(serialized); };
+  Rule(const json &serialized) { deserialize_json(serialized); };
   int send_tag;  ///< used to denote which rules should receive this message
   int receive_tag;  ///< RuleEngine will assign a message with this tag to this rule.
   std::vector<QnicInterface> qnic_interfaces;
@@ -32,7 +32,7 @@ class Rule {
   void setAction(std::unique_ptr<Action> action);
   void setName(std::string rule_name) { name = rule_name; };
   json serialize_json();
-  void deserialize_json(json serialized);
+  void deserialize_json(const json &serialized);
 };
 
 }  // namespace quisp::rules
@@ -24,13 +24,18 @@ json RuleSet::serialize_json() {
   ruleset_json["ruleset_id"] = ruleset_id;
   ruleset_json["owner_address"] = owner_addr;
   ruleset_json["num_rules"] = rules.size();
+  // only the connections with a QoS class have it
+  if (qos_priority != 0 || qos_min_share != 0) {
+    ruleset_json["qos_priority"] = qos_priority;
+    ruleset_json["qos_min_share"] = qos_min_share;
+  }
   for (auto &rule : rules) {
     ruleset_json["rules"].push_back(rule->serialize_json());
   }
   return ruleset_json;
 };
 
-void RuleSet::deserialize_json(json serialized) {
+void RuleSet::deserialize_json(const json &serialized) {
   // if this function is directly called, check if there is json serialization
   if (serialized == nullptr) {
     throw omnetpp::cRuntimeError("No json serialization found");
@@ -39,10 +44,14 @@ void RuleSet::deserialize_json(json serialized) {
   // get properties from json with type conversion
   serialized.at("ruleset_id").get_to(ruleset_id);
   serialized.at("owner_address").get_to(owner_addr);
+  qos_priority = serialized.value("qos_priority", 0);
+  qos_min_share = serialized.value("qos_min_share", 0.0);
 
   // deserialize rules and push them back
-  auto serialized_rules = serialized.at("rules");
-  for (auto rule : serialized_rules) {
+  // the rules are parsed in place, without copying the subtrees of the json
+  const auto &serialized_rules = serialized.at("rules");
+  rules.reserve(rules.size() + serialized_rules.size());
+  for (const auto &rule : serialized_rules) {
     auto deserialized_rule = std::make_unique<Rule>(rule);
     rules.push_back(std::move(deserialized_rule));
   }
@@ -19,11 +19,13 @@ class RuleSet {
 
   unsigned long ruleset_id;  ///< `ruleset_id` is used for identifying connection
   int owner_addr;  ///< Address of RuleSet owner
+  int qos_priority = 0;  ///< QoS class of the connection chosen at its setup, see runtime::RuleSet
+  double qos_min_share = 0;  ///< share of the contended Bell pairs guaranteed to the connection
   std::vector<std::unique_ptr<Rule>> rules;
 
   Rule *addRule(std::unique_ptr<Rule> rule);
   json serialize_json();
-  void deserialize_json(json serialized);
+  void deserialize_json(const json &serialized);
   unsigned long createUniqueId();
   runtime::RuleSet construct() const;
 };
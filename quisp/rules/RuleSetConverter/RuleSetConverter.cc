@@ -1,11 +1,16 @@
 #include "RuleSetConverter.h"
 
+#include <algorithm>
+#include <deque>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <omnetpp.h>
 
+#include "runtime/ProgramOptimizer.h"
 #include "runtime/Runtime.h"
 #include "runtime/opcode.h"
 
@@ -15,28 +20,234 @@ using runtime::InstructionTypes;
 
 using namespace runtime;
 
-RuleSet RuleSetConverter::construct(const RSData &data) {
+namespace {
+/**
+ * the operands that differ between the RuleSets of the same shape, in the order they appear in the RuleSet data.
+ * the optimizer doesn't look at their values except for the equality, so the key keeps the equality.
+ */
+struct TemplateParams {
+  std::vector<QNodeAddr> partner_addrs;
+  std::vector<Time> times;
+};
+
+struct RuleSetTemplate {
+  RuleSet ruleset;
+  TemplateParams params;
+};
+
+// the templates of the process. the oldest one is dropped when there are max_templates of them.
+struct RuleSetTemplates {
+  std::mutex mutex;
+  std::unordered_map<std::string, RuleSetTemplate> templates;
+  std::deque<std::string> keys_in_insertion_order;
+};
+
+RuleSetTemplates &ruleSetTemplates() {
+  static RuleSetTemplates templates;
+  return templates;
+}
+
+template <typename T>
+int slotOf(const std::vector<T> &params, const T &value) {
+  return std::find(params.begin(), params.end(), value) - params.begin();
+}
+
+template <typename T>
+int paramSlot(std::vector<T> &params, const T &value) {
+  auto slot = slotOf(params, value);
+  if (slot == params.size()) params.push_back(value);
+  return slot;
+}
+
+void writeInt(std::string &key, long long value) { key.append(reinterpret_cast<const char *>(&value), sizeof(value)); }
+void writeAddr(std::string &key, int partner_addr, TemplateParams &params) { writeInt(key, paramSlot(params.partner_addrs, QNodeAddr{partner_addr})); }
+void writeInterfaces(std::string &key, const std::vector<QnicInterface> &interfaces, TemplateParams &params) {
+  writeInt(key, interfaces.size());
+  for (auto &interface : interfaces) writeAddr(key, interface.partner_addr, params);
+}
+
+simtime_t tomographyStartTime(const Tomography *act) { return act->start_time == -1 ? simTime() : act->start_time; }
+
+// returns false for the clauses without a shape, their RuleSets are built without the templates
+bool writeClause(std::string &key, const ClauseData *clause, TemplateParams &params) {
+  if (auto *c = dynamic_cast<const EnoughResourceConditionClause *>(clause)) {
+    writeInt(key, 0);
+    writeInt(key, c->num_resource);
+  } else if (auto *c = dynamic_cast<const MeasureCountConditionClause *>(clause)) {
+    writeInt(key, 1);
+    writeInt(key, c->num_measure);
+  } else if (auto *c = dynamic_cast<const PurificationCorrelationClause *>(clause)) {
+    writeInt(key, 2);
+    writeInt(key, c->shared_rule_tag);
+  } else if (auto *c = dynamic_cast<const SwappingCorrectionClause *>(clause)) {
+    writeInt(key, 3);
+    writeInt(key, c->shared_rule_tag);
+  } else {
+    return false;
+  }
+  writeAddr(key, clause->partner_address, params);
+  return true;
+}
+
+bool writeAction(std::string &key, const ActionData *action, TemplateParams &params) {
+  if (action == nullptr) {
+    writeInt(key, -1);
+    return true;
+  }
+  if (auto *act = dynamic_cast<const Purification *>(action)) {
+    writeInt(key, 0);
+    writeInt(key, act->purification_type);
+    writeInt(key, act->shared_rule_tag);
+    writeInt(key, act->pumping_rounds);
+  } else if (auto *act = dynamic_cast<const EntanglementSwapping *>(action)) {
+    writeInt(key, 1);
+    writeInterfaces(key, act->remote_qnic_interfaces, params);
+    writeInt(key, act->shared_rule_tag);
+  } else if (auto *act = dynamic_cast<const Tomography *>(action)) {
+    writeInt(key, 2);
+    writeInt(key, act->num_measurement);
+    writeAddr(key, act->owner_address, params);
+    writeInt(key, paramSlot(params.times, Time{tomographyStartTime(act)}));
+  } else if (auto *act = dynamic_cast<const PurificationCorrelation *>(action)) {
+    writeInt(key, 3);
+    writeInt(key, act->shared_rule_tag);
+  } else if (auto *act = dynamic_cast<const SwappingCorrection *>(action)) {
+    writeInt(key, 4);
+    writeInt(key, act->shared_rule_tag);
+  } else {
+    return false;
+  }
+  writeInterfaces(key, action->qnic_interfaces, params);
+  return true;
+}
+
+/**
+ * describes everything the programs of the RuleSet are built from, the partner addresses and times are replaced by their slots in params.
+ * the programs only pass those operands through, so the RuleSets with the same key have the same programs except for them.
+ * @return false if the RuleSet has no shape and has to be built without the templates
+ */
+bool templateKey(const RSData &data, std::string &key, TemplateParams &params) {
+  writeInt(key, data.rules.size());
+  for (auto &rule_data : data.rules) {
+    writeInt(key, rule_data->send_tag);
+    writeInt(key, rule_data->receive_tag);
+    auto *condition = rule_data->condition.get();
+    if (condition == nullptr) {
+      writeInt(key, -1);
+    } else {
+      writeInt(key, condition->clauses.size());
+      for (auto &clause : condition->clauses) {
+        if (!writeClause(key, clause.get(), params)) return false;
+      }
+    }
+    if (!writeAction(key, rule_data->action.get(), params)) return false;
+  }
+  return true;
+}
+
+std::string ruleName(const RuleData &rule_data) {
+  std::string name = rule_data.name + " with ";
+  for (auto &interface : rule_data.qnic_interfaces) {
+    name += std::to_string(interface.partner_addr) + "";
+  }
+  return name;
+}
+
+void patchProgram(Program &program, const TemplateParams &from, const TemplateParams &to) {
+  for (auto &instr : program.opcodes) {
+    forEachOperand<QNodeAddr>(instr, [&](QNodeAddr &addr) { addr = to.partner_addrs[slotOf(from.partner_addrs, addr)]; });
+    forEachOperand<Time>(instr, [&](Time &time) { time = to.times[slotOf(from.times, time)]; });
+  }
+  for (auto &guard : program.qubit_count_guards) guard.partner_addr = to.partner_addrs[slotOf(from.partner_addrs, guard.partner_addr)];
+  program.lower();
+}
+
+bool findTemplate(const std::string &key, RuleSetTemplate &found) {
+  auto &templates = ruleSetTemplates();
+  std::lock_guard<std::mutex> lock(templates.mutex);
+  auto it = templates.templates.find(key);
+  if (it == templates.templates.end()) return false;
+  found = it->second;
+  return true;
+}
+
+void addTemplate(std::string key, const RuleSetTemplate &rs_template) {
+  auto &templates = ruleSetTemplates();
+  std::lock_guard<std::mutex> lock(templates.mutex);
+  // another simulation on the other thread may have added it meanwhile
+  if (!templates.templates.emplace(key, rs_template).second) return;
+  templates.keys_in_insertion_order.push_back(std::move(key));
+  if (templates.keys_in_insertion_order.size() > RuleSetConverter::max_templates) {
+    templates.templates.erase(templates.keys_in_insertion_order.front());
+    templates.keys_in_insertion_order.pop_front();
+  }
+}
+}  // namespace
+
+void RuleSetConverter::clearTemplates() {
+  auto &templates = ruleSetTemplates();
+  std::lock_guard<std::mutex> lock(templates.mutex);
+  templates.templates.clear();
+  templates.keys_in_insertion_order.clear();
+}
+
+std::size_t RuleSetConverter::numTemplates() {
+  auto &templates = ruleSetTemplates();
+  std::lock_guard<std::mutex> lock(templates.mutex);
+  return templates.templates.size();
+}
+
+RuleSet RuleSetConverter::constructUncached(const RSData &data) {
   RuleSet rs;
   rs.id = data.ruleset_id;
   rs.owner_addr = data.owner_addr;
+  rs.qos_priority = data.qos_priority;
+  rs.qos_min_share = data.qos_min_share;
   auto &rules_data = data.rules;
   if (data.rules.size() == 0) throw omnetpp::cRuntimeError("empty ruleset");
   for (auto &rule_data : rules_data) {
-    std::string name = rule_data->name + " with ";
-    for (auto &interface : rule_data->qnic_interfaces) {
-      name += std::to_string(interface.partner_addr) + "";
-    }
     auto condition = constructCondition(rule_data->condition.get());
     auto action = constructAction(rule_data->action.get());
     auto terminate_condition = constructTerminateCondition(rule_data->condition.get());
     if (terminate_condition.opcodes.size() > 0) {
       rs.termination_condition = terminate_condition;
     }
-    rs.rules.emplace_back(Rule{name, rule_data->send_tag, rule_data->receive_tag, condition, action});
+    rs.rules.emplace_back(Rule{ruleName(*rule_data), rule_data->send_tag, rule_data->receive_tag, condition, action});
   }
+  ProgramOptimizer::optimize(rs);
   return rs;
 }
 
+RuleSet RuleSetConverter::construct(const RSData &data) {
+  if (data.rules.size() == 0) throw omnetpp::cRuntimeError("empty ruleset");
+  TemplateParams params;
+  std::string key;
+  if (!templateKey(data, key, params)) return constructUncached(data);
+
+  RuleSetTemplate found;
+  if (!findTemplate(key, found)) {
+    auto rs = constructUncached(data);
+    addTemplate(std::move(key), RuleSetTemplate{rs, params});
+    return rs;
+  }
+
+  auto &[instance, template_params] = found;
+  instance.id = data.ruleset_id;
+  instance.owner_addr = data.owner_addr;
+  instance.qos_priority = data.qos_priority;
+  instance.qos_min_share = data.qos_min_share;
+  // the optimizer keeps the rules, only their names have the partner addresses
+  for (int i = 0; i < instance.rules.size(); i++) instance.rules[i].name = ruleName(*data.rules[i]);
+  if (template_params.partner_addrs != params.partner_addrs || template_params.times != params.times) {
+    for (auto &rule : instance.rules) {
+      patchProgram(rule.condition, template_params, params);
+      patchProgram(rule.action, template_params, params);
+    }
+    patchProgram(instance.termination_condition, template_params, params);
+  }
+  return instance;
+}
+
 Program RuleSetConverter::constructTerminateCondition(const ConditionData *data) {
   if (data == nullptr) {
     return Program{"no terminate condition", {}};
@@ -74,12 +285,18 @@ Program RuleSetConverter::constructCondition(const ConditionData *data) {
     return Program{"no condition", {}};
   }
   auto opcodes = std::vector<InstructionTypes>{};
+  std::vector<QubitCountGuard> guards;
+  // the guards can skip the leading EnoughResource clauses only, the other clauses register waits or store values
+  bool leading = true;
   std::string name;
   int i = 0;
   for (auto &clause_data : data->clauses) {
     i++;
     auto clause_ptr = clause_data.get();
-    if (auto *c = dynamic_cast<const EnoughResourceConditionClause *>(clause_ptr)) {
+    auto *enough_resource = dynamic_cast<const EnoughResourceConditionClause *>(clause_ptr);
+    leading = leading && enough_resource != nullptr;
+    if (leading) guards.push_back(QubitCountGuard{enough_resource->partner_address, enough_resource->num_resource});
+    if (auto *c = enough_resource) {
       auto counter = RegId::REG0;
       auto qubit_id = RegId::REG1;
 
@@ -130,6 +347,8 @@ Program RuleSetConverter::constructCondition(const ConditionData *data) {
         INC msg_index
         GET_MESSAGE_SEQ msg_index seq_no
         BRANCH_IF_MESSAGE_FOUND FOUND_MESSAGE
+        WAIT_MESSAGE
+        WAIT_QUBIT partner_addr
         RET COND_FAILED
       FOUND_MESSAGE:
         COUNT_MESSAGE seq_no msg_count
@@ -162,6 +381,9 @@ Program RuleSetConverter::constructCondition(const ConditionData *data) {
       opcodes.push_back(INSTR_INC_RegId_{{msg_index}, {loop_label}});
       opcodes.push_back(INSTR_GET_MESSAGE_SEQ_RegId_RegId_{{seq_no, msg_index}});
       opcodes.push_back(INSTR_BRANCH_IF_MESSAGE_FOUND_Label_{found_message_label});
+      // no message matches a qubit, only a new message or a new qubit can pass this clause
+      opcodes.push_back(INSTR_WAIT_MESSAGE_None_{nullptr});
+      opcodes.push_back(INSTR_WAIT_QUBIT_QNodeAddr_{c->partner_address});
       opcodes.push_back(INSTR_RET_ReturnCode_{ReturnCode::COND_FAILED});
       // FOUND_MESSAGE
       opcodes.push_back(INSTR_COUNT_MESSAGE_RegId_RegId_{{msg_count, seq_no}, found_message_label});
@@ -186,6 +408,8 @@ Program RuleSetConverter::constructCondition(const ConditionData *data) {
         INC msg_index
         GET_MESSAGE_SEQ msg_index seq_no
         BRANCH_IF_MESSAGE_FOUND FIND_QUBIT
+        WAIT_MESSAGE
+        WAIT_QUBIT partner_addr
         RET COND_FAILED
       FIND_QUBIT:
         GET_QUBIT_BY_SEQ_NO qubit_id partner_addr seq_no
@@ -214,6 +438,9 @@ Program RuleSetConverter::constructCondition(const ConditionData *data) {
       opcodes.push_back(INSTR_INC_RegId_{{msg_index}, {loop_label}});
       opcodes.push_back(INSTR_GET_MESSAGE_SEQ_RegId_RegId_{{seq_no, msg_index}});
       opcodes.push_back(INSTR_BRANCH_IF_MESSAGE_FOUND_Label_{find_qubit_label});
+      // no message matches a qubit, only a new message or a new qubit can pass this clause
+      opcodes.push_back(INSTR_WAIT_MESSAGE_None_{nullptr});
+      opcodes.push_back(INSTR_WAIT_QUBIT_QNodeAddr_{c->partner_address});
       opcodes.push_back(INSTR_RET_ReturnCode_{ReturnCode::COND_FAILED});
       // FIND_QUBIT
       opcodes.push_back(INSTR_GET_QUBIT_BY_SEQ_NO_RegId_QNodeAddr_RegId_{{qubit_id, c->partner_address, seq_no}, find_qubit_label});
@@ -246,7 +473,9 @@ Program RuleSetConverter::constructCondition(const ConditionData *data) {
     }
   }
   opcodes.push_back(INSTR_RET_ReturnCode_{{ReturnCode::COND_PASSED}});
-  return Program{name, opcodes};
+  Program condition{name, opcodes};
+  condition.qubit_count_guards = std::move(guards);
+  return condition;
 }
 
 Program RuleSetConverter::constructAction(const ActionData *data) {
@@ -282,9 +511,7 @@ Program RuleSetConverter::constructEntanglementSwappingAction(const Entanglement
     LOAD seq_no "sent_swap_message_{shared_rule}" // if the key has not been set the value stays as is
     GET_QUBIT q0 left_partner  0
     GET_QUBIT q1 right_partner 0
-    GATE_CNOT q0 q1
-    MEASURE pauli_op_left 0 q0 x
-    MEASURE pauli_op_left 1 q1 z
+    BELL_MEASURE pauli_op_left q0 q1 // CNOT q0 q1, X of q0 at bit 0 and Z of q1 at bit 1
     FREE_QUBIT q0
     FREE_QUBIT q1
     SEND_SWAPPING_RESULT left_partner right_partner pauli_op_left  seq_no
@@ -311,9 +538,7 @@ Program RuleSetConverter::constructEntanglementSwappingAction(const Entanglement
     INSTR_LOAD_RegId_MemoryKey_{{seq_no, seq_key}},
     INSTR_GET_QUBIT_QubitId_QNodeAddr_int_{{q0, left_partner_addr, 0}},
     INSTR_GET_QUBIT_QubitId_QNodeAddr_int_{{q1, right_partner_addr, 0}},
-    INSTR_GATE_CNOT_QubitId_QubitId_{{q0, q1}},
-    INSTR_MEASURE_RegId_int_QubitId_Basis_{{op_left, 0, q0, Basis::X}},
-    INSTR_MEASURE_RegId_int_QubitId_Basis_{{op_left, 1, q1, Basis::Z}},
+    INSTR_BELL_MEASURE_RegId_QubitId_QubitId_{{op_left, q0, q1}},
     INSTR_FREE_QUBIT_QubitId_{{q0}},
     INSTR_FREE_QUBIT_QubitId_{{q1}},
     INSTR_SEND_SWAPPING_RESULT_QNodeAddr_RegId_QNodeAddr_RegId_{{left_partner_addr, op_left, right_partner_addr, seq_no}},
@@ -328,6 +553,7 @@ Program RuleSetConverter::constructEntanglementSwappingAction(const Entanglement
   };
 }
 Program RuleSetConverter::constructPurificationAction(const Purification *act) {
+  if (act->pumping_rounds > 1) return constructPumpingPurificationAction(act);
   auto pur_type = act->purification_type;
   if (pur_type == rules::PurType::SINGLE_SELECTION_X_PURIFICATION || pur_type == rules::PurType::SINGLE_SELECTION_Z_PURIFICATION ||
       pur_type == rules::PurType::SINGLE_SELECTION_Y_PURIFICATION) {
@@ -687,6 +913,65 @@ Program RuleSetConverter::constructPurificationAction(const Purification *act) {
   return Program{"Purification", {}};
 }
 
+Program RuleSetConverter::constructPumpingPurificationAction(const Purification *act) {
+  /*
+    qubitId: qubit, trash_qubit_1, ..., trash_qubit_n
+    Reg: result, seq_no // the sequence number of the qubit in the next rule
+  START:
+    SET seq_no 1 // sequence_number starts at 1
+    LOAD seq_no "sent_purification_message_{shared_rule}" // if it has not been set the value stays as is
+    GET_QUBIT qubit partner_addr 0
+    GET_QUBIT trash_qubit_1 partner_addr 1
+    ...
+    GET_QUBIT trash_qubit_n partner_addr n
+    PURIFY_<basis of round 1> result 0 qubit trash_qubit_1
+    ...
+    PURIFY_<basis of round n> result n-1 qubit trash_qubit_n
+    PROMOTE qubit
+    FREE_QUBIT trash_qubit_1
+    ...
+    FREE_QUBIT trash_qubit_n
+    SEND_PURIFICATION_RESULT partner_addr result seq_no // all the rounds in one message, the correlation checks them at once
+    INC seq_no
+    STORE "sent_purificaiton_message_{shared_rule}" seq_no
+  */
+  auto pur_type = act->purification_type;
+  int num_rounds = act->pumping_rounds;
+  if (!Purification::canPump(pur_type)) throw std::runtime_error("entanglement pumping needs a single selection purification type");
+  if (num_rounds > Purification::max_pumping_rounds) throw std::runtime_error("too many pumping rounds");
+
+  QubitId qubit{0};
+  RegId measure_result = RegId::REG0;
+  RegId seq_no = RegId::REG1;
+  auto &interface = act->qnic_interfaces.at(0);
+  QNodeAddr partner_addr{interface.partner_addr};
+  MemoryKey seq_no_key{"sent_purification_message_" + std::to_string(act->shared_rule_tag)};
+
+  // XZ and ZX alternate the bases of the rounds, the others purify each round in the same basis
+  auto purify_instruction = [&](int round, QubitId trash_qubit) -> InstructionTypes {
+    bool alternate = round % 2 == 1;
+    if (pur_type == rules::PurType::SINGLE_SELECTION_Y_PURIFICATION) return INSTR_PURIFY_Y_RegId_int_QubitId_QubitId_{{measure_result, round, qubit, trash_qubit}};
+    if (pur_type == rules::PurType::SINGLE_SELECTION_Z_PURIFICATION || (pur_type == rules::PurType::SINGLE_SELECTION_XZ_PURIFICATION && alternate) ||
+        (pur_type == rules::PurType::SINGLE_SELECTION_ZX_PURIFICATION && !alternate)) {
+      return INSTR_PURIFY_Z_RegId_int_QubitId_QubitId_{{measure_result, round, qubit, trash_qubit}};
+    }
+    return INSTR_PURIFY_X_RegId_int_QubitId_QubitId_{{measure_result, round, qubit, trash_qubit}};
+  };
+
+  std::vector<InstructionTypes> opcodes{
+      INSTR_SET_RegId_int_{{seq_no, 1}},
+      INSTR_LOAD_RegId_MemoryKey_{{seq_no, seq_no_key}},
+  };
+  for (int i = 0; i <= num_rounds; i++) opcodes.push_back(INSTR_GET_QUBIT_QubitId_QNodeAddr_int_{{QubitId{i}, partner_addr, i}});
+  for (int round = 0; round < num_rounds; round++) opcodes.push_back(purify_instruction(round, QubitId{round + 1}));
+  opcodes.push_back(INSTR_PROMOTE_QubitId_{{qubit}});
+  for (int round = 0; round < num_rounds; round++) opcodes.push_back(INSTR_FREE_QUBIT_QubitId_{{QubitId{round + 1}}});
+  opcodes.push_back(INSTR_SEND_PURIFICATION_RESULT_QNodeAddr_RegId_RegId_PurType_{{partner_addr, measure_result, seq_no, pur_type}});
+  opcodes.push_back(INSTR_INC_RegId_{seq_no});
+  opcodes.push_back(INSTR_STORE_MemoryKey_RegId_{{seq_no_key, seq_no}});
+  return Program{"Pumping Purification x" + std::to_string(num_rounds), opcodes};
+}
+
 Program RuleSetConverter::constructPurificationCorrelationAction(const PurificationCorrelation *act) {
   /*
     qubit_id: qubit
@@ -809,10 +1094,7 @@ Program RuleSetConverter::constructTomographyAction(const Tomography *act) {
   auto &qnic = act->qnic_interfaces.at(0);
   QNodeAddr partner_addr = qnic.partner_addr;
   auto qubit_resource_index = 0;
-  simtime_t start_time = act->start_time;
-  if (start_time == -1) {
-    start_time = simTime();
-  }
+  simtime_t start_time = tomographyStartTime(act);
   return Program{
       "Tomography",
       {
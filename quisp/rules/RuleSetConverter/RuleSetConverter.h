@@ -31,16 +31,29 @@ using rules::Tomography;
 using quisp::runtime::Label;
 using quisp::runtime::MemoryKey;
 using quisp::runtime::Program;
+using quisp::runtime::QubitCountGuard;
 using quisp::runtime::Rule;
 using quisp::runtime::RuleSet;
 const std::nullptr_t None = nullptr;
 
 /* \brief RuleSetConverter converts rules::RuleSet into runtime::RuleSet in RuleEngine.
  * RuleEngine receives rules::RuleSet that is json serializable format of RuleSet.
+ *
+ * Many RuleSets have the same shape, e.g. the link tomography RuleSets and the RuleSets of the
+ * intermediate nodes in a path, and differ only in the partner addresses and the times.
+ * construct() keys the RuleSet data by its shape before building any program, optimizes each shape
+ * once, and then instantiates it by patching those operands. The process keeps at most max_templates shapes.
  */
 class RuleSetConverter {
  public:
+  static constexpr std::size_t max_templates = 1024;
+
   static RuleSet construct(const RSData&);
+  /// @brief builds and optimizes the RuleSet without the cached shapes.
+  static RuleSet constructUncached(const RSData&);
+  /// @brief forgets the optimized RuleSet shapes construct() cached.
+  static void clearTemplates();
+  static std::size_t numTemplates();
 
   static Program constructAction(const ActionData* data);
   static Program constructCondition(const ConditionData* data);
@@ -49,6 +62,7 @@ class RuleSetConverter {
   // actions
   static Program constructEntanglementSwappingAction(const EntanglementSwapping* data);
   static Program constructPurificationAction(const Purification* data);
+  static Program constructPumpingPurificationAction(const Purification* data);
   static Program constructTomographyAction(const Tomography* data);
   static Program constructPurificationCorrelationAction(const PurificationCorrelation* data);
   static Program constructSwappingCorrectionAction(const SwappingCorrection* data);
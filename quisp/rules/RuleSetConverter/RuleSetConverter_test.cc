@@ -0,0 +1,186 @@
+#include "RuleSetConverter.h"
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "rules/Action.h"
+#include "rules/Clause.h"
+#include "rules/Condition.h"
+#include "rules/Rule.h"
+#include "test_utils/TestUtils.h"
+
+namespace {
+using namespace quisp::rules;
+using quisp::rules::rs_converter::RuleSetConverter;
+
+// same rules as RuleSetGenerator::swapRule and tomographyRule.
+quisp::rules::RuleSet swappingRuleSet(int owner_addr, int left_addr, int right_addr) {
+  quisp::rules::RuleSet rs(1, owner_addr);
+  auto rule = std::make_unique<quisp::rules::Rule>(std::vector<int>{left_addr, right_addr}, 0, -1);
+  auto condition = std::make_unique<Condition>();
+  condition->addClause(std::make_unique<EnoughResourceConditionClause>(1, left_addr));
+  condition->addClause(std::make_unique<EnoughResourceConditionClause>(1, right_addr));
+  rule->setCondition(std::move(condition));
+  rule->setAction(std::make_unique<EntanglementSwapping>(std::vector<int>{left_addr, right_addr}, 0));
+  rs.addRule(std::move(rule));
+  return rs;
+}
+
+quisp::rules::RuleSet tomographyRuleSet(int owner_addr, int partner_addr, int num_measure, omnetpp::simtime_t start_time = -1) {
+  quisp::rules::RuleSet rs(2, owner_addr);
+  auto rule = std::make_unique<quisp::rules::Rule>(partner_addr, 0, 0);
+  auto condition = std::make_unique<Condition>();
+  condition->addClause(std::make_unique<EnoughResourceConditionClause>(1, partner_addr));
+  condition->addClause(std::make_unique<MeasureCountConditionClause>(num_measure, partner_addr));
+  rule->setCondition(std::move(condition));
+  auto action = std::make_unique<Tomography>(num_measure, owner_addr, partner_addr);
+  action->start_time = start_time;
+  rule->setAction(std::move(action));
+  rs.addRule(std::move(rule));
+  return rs;
+}
+
+// constructs the RuleSet without the cached shapes.
+quisp::runtime::RuleSet constructFresh(const quisp::rules::RuleSet& data) { return RuleSetConverter::constructUncached(data); }
+
+void expectSameRuleSet(const quisp::runtime::RuleSet& actual, const quisp::runtime::RuleSet& expected) {
+  EXPECT_EQ(actual.id, expected.id);
+  EXPECT_EQ(actual.owner_addr, expected.owner_addr);
+  EXPECT_EQ(actual.contentKey(), expected.contentKey());
+}
+
+TEST(RuleSetConverterTest, InstantiateSwappingShape) {
+  quisp_test::prepareSimulation();
+  RuleSetConverter::clearTemplates();
+  RuleSetConverter::construct(swappingRuleSet(1, 0, 2));
+  // the same shape with the other partners
+  auto instance = RuleSetConverter::construct(swappingRuleSet(5, 4, 6));
+  expectSameRuleSet(instance, constructFresh(swappingRuleSet(5, 4, 6)));
+  EXPECT_NE(instance.contentKey(), constructFresh(swappingRuleSet(1, 0, 2)).contentKey());
+  EXPECT_EQ(RuleSetConverter::numTemplates(), 1);
+}
+
+TEST(RuleSetConverterTest, InstantiateTomographyShape) {
+  quisp_test::prepareSimulation();
+  RuleSetConverter::clearTemplates();
+  RuleSetConverter::construct(tomographyRuleSet(1, 2, 100));
+  expectSameRuleSet(RuleSetConverter::construct(tomographyRuleSet(3, 4, 100)), constructFresh(tomographyRuleSet(3, 4, 100)));
+  // the start time is patched as well
+  RuleSetConverter::construct(tomographyRuleSet(1, 2, 100, 1.5));
+  expectSameRuleSet(RuleSetConverter::construct(tomographyRuleSet(3, 4, 100, 2.0)), constructFresh(tomographyRuleSet(3, 4, 100, 2.0)));
+
+  // the number of measurements is a part of the shape
+  RuleSetConverter::clearTemplates();
+  RuleSetConverter::construct(tomographyRuleSet(1, 2, 100));
+  expectSameRuleSet(RuleSetConverter::construct(tomographyRuleSet(1, 2, 10)), constructFresh(tomographyRuleSet(1, 2, 10)));
+}
+
+TEST(RuleSetConverterTest, KeepPartnerEquality) {
+  quisp_test::prepareSimulation();
+  RuleSetConverter::clearTemplates();
+  RuleSetConverter::construct(swappingRuleSet(1, 0, 2));
+  // left and right are the same partner, which the optimizer may treat differently
+  expectSameRuleSet(RuleSetConverter::construct(swappingRuleSet(1, 3, 3)), constructFresh(swappingRuleSet(1, 3, 3)));
+}
+
+TEST(RuleSetConverterTest, BoundTemplates) {
+  quisp_test::prepareSimulation();
+  RuleSetConverter::clearTemplates();
+  // each number of measurements is a shape of its own
+  int num_shapes = RuleSetConverter::max_templates + 1;
+  for (int i = 1; i <= num_shapes; i++) RuleSetConverter::construct(tomographyRuleSet(1, 2, i));
+  EXPECT_EQ(RuleSetConverter::numTemplates(), RuleSetConverter::max_templates);
+  // the oldest shape is dropped first
+  RuleSetConverter::construct(tomographyRuleSet(1, 2, 2));
+  EXPECT_EQ(RuleSetConverter::numTemplates(), RuleSetConverter::max_templates);
+  expectSameRuleSet(RuleSetConverter::construct(tomographyRuleSet(1, 2, 1)), constructFresh(tomographyRuleSet(1, 2, 1)));
+  RuleSetConverter::clearTemplates();
+}
+
+// the simulations on the threads of a process share the templates
+TEST(RuleSetConverterTest, ConstructOnThreads) {
+  quisp_test::prepareSimulation();
+  RuleSetConverter::clearTemplates();
+  std::vector<std::vector<quisp::runtime::RuleSet>> constructed(4);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&constructed, t]() {
+      for (int i = 0; i < 50; i++) constructed[t].push_back(RuleSetConverter::construct(swappingRuleSet(t * 100 + i, t, i + 10)));
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  for (int t = 0; t < 4; t++) {
+    ASSERT_EQ(constructed[t].size(), 50);
+    expectSameRuleSet(constructed[t][7], constructFresh(swappingRuleSet(t * 100 + 7, t, 17)));
+  }
+}
+
+TEST(RuleSetConverterTest, GuardLeadingEnoughResourceClauses) {
+  quisp_test::prepareSimulation();
+  RuleSetConverter::clearTemplates();
+  RuleSetConverter::construct(tomographyRuleSet(1, 2, 100));
+  auto tomography = RuleSetConverter::construct(tomographyRuleSet(3, 4, 100));
+  // the measure count isn't guarded, and the instance guards its own partner
+  auto& guards = tomography.rules[0].condition.qubit_count_guards;
+  ASSERT_EQ(guards.size(), 1);
+  EXPECT_EQ(guards[0].partner_addr.val, 4);
+  EXPECT_EQ(guards[0].min_count, 1);
+
+  // the clauses after another clause aren't guarded, it may register its waits first
+  Condition condition;
+  condition.addClause(std::make_unique<PurificationCorrelationClause>(2, 0));
+  condition.addClause(std::make_unique<EnoughResourceConditionClause>(1, 2));
+  EXPECT_TRUE(RuleSetConverter::constructCondition(&condition).qubit_count_guards.empty());
+}
+
+TEST(RuleSetConverterTest, PumpingPurificationAction) {
+  Purification purification{PurType::SINGLE_SELECTION_XZ_PURIFICATION, 2, 5, 3};
+  auto program = RuleSetConverter::constructAction(&purification);
+  std::vector<quisp::runtime::InstructionTypes> purifications;
+  int num_get_qubits = 0;
+  int num_sends = 0;
+  for (auto& opcode : program.opcodes) {
+    if (std::holds_alternative<quisp::runtime::INSTR_GET_QUBIT_QubitId_QNodeAddr_int_>(opcode)) num_get_qubits++;
+    if (std::holds_alternative<quisp::runtime::INSTR_SEND_PURIFICATION_RESULT_QNodeAddr_RegId_RegId_PurType_>(opcode)) num_sends++;
+    if (std::holds_alternative<quisp::runtime::INSTR_PURIFY_X_RegId_int_QubitId_QubitId_>(opcode) ||
+        std::holds_alternative<quisp::runtime::INSTR_PURIFY_Z_RegId_int_QubitId_QubitId_>(opcode)) {
+      purifications.push_back(opcode);
+    }
+  }
+  EXPECT_EQ(num_get_qubits, 4);
+  // one message for all the rounds, each round on its own bit in the alternating bases
+  EXPECT_EQ(num_sends, 1);
+  ASSERT_EQ(purifications.size(), 3);
+  auto& first = std::get<quisp::runtime::INSTR_PURIFY_X_RegId_int_QubitId_QubitId_>(purifications[0]);
+  auto& second = std::get<quisp::runtime::INSTR_PURIFY_Z_RegId_int_QubitId_QubitId_>(purifications[1]);
+  auto& third = std::get<quisp::runtime::INSTR_PURIFY_X_RegId_int_QubitId_QubitId_>(purifications[2]);
+  EXPECT_EQ(std::get<1>(first.args), 0);
+  EXPECT_EQ(std::get<1>(second.args), 1);
+  EXPECT_EQ(std::get<1>(third.args), 2);
+
+  Purification double_selection{PurType::DOUBLE_SELECTION_X_PURIFICATION, 2, 5, 3};
+  EXPECT_THROW(RuleSetConverter::constructAction(&double_selection), std::runtime_error);
+}
+
+// the pumping rounds are a part of the shape
+TEST(RuleSetConverterTest, PumpingRoundsShape) {
+  quisp_test::prepareSimulation();
+  RuleSetConverter::clearTemplates();
+  auto purificationRuleSet = [](int pumping_rounds) {
+    quisp::rules::RuleSet rs(3, 1);
+    auto rule = std::make_unique<quisp::rules::Rule>(2, 0, 0);
+    auto condition = std::make_unique<Condition>();
+    condition->addClause(std::make_unique<EnoughResourceConditionClause>(4, 2));
+    rule->setCondition(std::move(condition));
+    rule->setAction(std::make_unique<Purification>(PurType::SINGLE_SELECTION_X_PURIFICATION, 2, 0, pumping_rounds));
+    rs.addRule(std::move(rule));
+    return rs;
+  };
+  RuleSetConverter::construct(purificationRuleSet(2));
+  expectSameRuleSet(RuleSetConverter::construct(purificationRuleSet(3)), constructFresh(purificationRuleSet(3)));
+  EXPECT_EQ(RuleSetConverter::numTemplates(), 2);
+}
+
+}  // namespace
@@ -0,0 +1,73 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "RuleSet.h"
+
+using json = nlohmann::json;
+
+namespace {
+using namespace quisp::rules;
+
+constexpr int num_hops = 30;
+
+// the RuleSet of the initiator of a num_hops path: a purification with each node, and a swapping correction from each repeater.
+std::string serializedRuleSet() {
+  RuleSet rs(1, 0);
+  for (int partner = 1; partner <= num_hops; partner++) {
+    auto purification = std::make_unique<Rule>(partner, partner, -1);
+    purification->setName("purification");
+    auto condition = std::make_unique<Condition>();
+    condition->addClause(std::make_unique<EnoughResourceConditionClause>(2, partner));
+    purification->setCondition(std::move(condition));
+    purification->setAction(std::make_unique<Purification>(PurType::DOUBLE_SELECTION_X_PURIFICATION, partner, partner));
+    rs.addRule(std::move(purification));
+
+    auto correlation = std::make_unique<Rule>(partner, -1, partner);
+    correlation->setName("purification correlation");
+    auto correlation_condition = std::make_unique<Condition>();
+    correlation_condition->addClause(std::make_unique<PurificationCorrelationClause>(partner, partner));
+    correlation->setCondition(std::move(correlation_condition));
+    correlation->setAction(std::make_unique<PurificationCorrelation>(partner, partner));
+    rs.addRule(std::move(correlation));
+
+    if (partner == num_hops) continue;
+    auto correction = std::make_unique<Rule>(partner, -1, num_hops + partner);
+    correction->setName("swapping correction");
+    auto correction_condition = std::make_unique<Condition>();
+    correction_condition->addClause(std::make_unique<SwappingCorrectionClause>(partner, num_hops + partner));
+    correction->setCondition(std::move(correction_condition));
+    correction->setAction(std::make_unique<SwappingCorrection>(partner, num_hops + partner));
+    rs.addRule(std::move(correction));
+  }
+  return rs.serialize_json().dump();
+}
+
+// RuleSet::deserialize_json, as the RuleEngine does for the forwarded RuleSet without the compiled one.
+static void BM_RuleSet_DeserializeJson(benchmark::State& state) {
+  auto serialized = json::parse(serializedRuleSet());
+  for (auto _ : state) {
+    RuleSet rs(0, 0);
+    rs.deserialize_json(serialized);
+    benchmark::DoNotOptimize(rs.rules.data());
+  }
+  state.SetItemsProcessed(state.iterations() * serialized.at("rules").size());
+}
+BENCHMARK(BM_RuleSet_DeserializeJson);
+
+// the parse of the dumped string on top, for the RuleSets that arrive as text.
+static void BM_RuleSet_ParseAndDeserializeJson(benchmark::State& state) {
+  auto serialized = serializedRuleSet();
+  for (auto _ : state) {
+    RuleSet rs(0, 0);
+    rs.deserialize_json(json::parse(serialized));
+    benchmark::DoNotOptimize(rs.rules.data());
+  }
+  state.SetBytesProcessed(state.iterations() * serialized.size());
+}
+BENCHMARK(BM_RuleSet_ParseAndDeserializeJson);
+
+}  // namespace
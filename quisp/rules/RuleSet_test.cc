@@ -71,4 +71,17 @@ TEST(RuleSetTest, Reversible_Check) {
   EXPECT_EQ(ruleset.rules.at(0)->qnic_interfaces.at(0).partner_addr, reverted_ruleset.rules.at(0)->qnic_interfaces.at(0).partner_addr);
 }
 
+TEST(RuleSetTest, QosClass) {
+  prepareSimulation();
+  RuleSet ruleset(1, 13);
+  ruleset.addRule(std::make_unique<Rule>(84, 14, 93));
+  EXPECT_FALSE(ruleset.serialize_json().contains("qos_priority"));
+  ruleset.qos_priority = 5;
+  ruleset.qos_min_share = 0.25;
+  RuleSet reverted_ruleset;
+  reverted_ruleset.deserialize_json(ruleset.serialize_json());
+  EXPECT_EQ(reverted_ruleset.qos_priority, 5);
+  EXPECT_DOUBLE_EQ(reverted_ruleset.qos_min_share, 0.25);
+}
+
 }  // namespace
@@ -1,11 +1,181 @@
 #include "InstructionVisitor.h"
 
+#include <array>
+#include <cstring>
+#include <limits>
 #include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <variant>
 
 #include "Runtime.h"
 
 namespace quisp::runtime {
 
+namespace {
+template <std::size_t I>
+void execHandler(InstructionVisitor& visitor, const InstructionTypes& instruction) {
+  visitor(*std::get_if<I>(&instruction));
+}
+
+template <std::size_t... I>
+constexpr std::array<InstructionHandler, sizeof...(I)> makeHandlers(std::index_sequence<I...>) {
+  return {&execHandler<I>...};
+}
+
+// the handlers indexed by the alternative of InstructionTypes
+constexpr auto handlers = makeHandlers(std::make_index_sequence<std::variant_size_v<InstructionTypes>>{});
+
+// the operand size larger than a word, for the operands packed only in Program::opcodes.
+constexpr std::size_t wide_operand = InstructionWord::operand_bytes + 1;
+
+template <class Packed, class Value>
+bool packValue(Value value, unsigned char* out) {
+  if (value < std::numeric_limits<Packed>::min() || value > std::numeric_limits<Packed>::max()) return false;
+  auto packed = static_cast<Packed>(value);
+  std::memcpy(out, &packed, sizeof(Packed));
+  return true;
+}
+
+template <class Packed>
+int unpackValue(const unsigned char* in) {
+  Packed packed;
+  std::memcpy(&packed, in, sizeof(Packed));
+  return packed;
+}
+
+// how an operand is packed in InstructionWord::operands. pack() returns false if the value doesn't fit.
+template <class T>
+struct OperandCodec {
+  static constexpr std::size_t size = wide_operand;
+};
+template <>
+struct OperandCodec<None> {
+  static constexpr std::size_t size = 0;
+  static bool pack(None, unsigned char*) { return true; }
+  static None unpack(const unsigned char*) { return nullptr; }
+};
+template <>
+struct OperandCodec<int> {
+  static constexpr std::size_t size = sizeof(std::int32_t);
+  static bool pack(int value, unsigned char* out) { return packValue<std::int32_t>(value, out); }
+  static int unpack(const unsigned char* in) { return unpackValue<std::int32_t>(in); }
+};
+template <>
+struct OperandCodec<QNodeAddr> {
+  static constexpr std::size_t size = sizeof(std::int32_t);
+  static bool pack(QNodeAddr value, unsigned char* out) { return packValue<std::int32_t>(value.val, out); }
+  static QNodeAddr unpack(const unsigned char* in) { return QNodeAddr{unpackValue<std::int32_t>(in)}; }
+};
+template <>
+struct OperandCodec<QubitId> {
+  static constexpr std::size_t size = sizeof(std::int16_t);
+  static bool pack(QubitId value, unsigned char* out) { return packValue<std::int16_t>(value.val, out); }
+  static QubitId unpack(const unsigned char* in) { return QubitId{unpackValue<std::int16_t>(in)}; }
+};
+template <>
+struct OperandCodec<Label> {
+  static constexpr std::size_t size = sizeof(std::int16_t);
+  static bool pack(const Label& label, unsigned char* out) { return packValue<std::int16_t>(label.pc, out); }
+  static Label unpack(const unsigned char* in) {
+    Label label{""};
+    label.pc = unpackValue<std::int16_t>(in);
+    return label;
+  }
+};
+template <>
+struct OperandCodec<MemoryKey> {
+  static constexpr std::size_t size = sizeof(std::int16_t);
+  // the Runtime looks up the key without slot by its name
+  static bool pack(const MemoryKey& key, unsigned char* out) { return key.slot >= 0 && packValue<std::int16_t>(key.slot, out); }
+  static MemoryKey unpack(const unsigned char* in) {
+    MemoryKey key{""};
+    key.slot = unpackValue<std::int16_t>(in);
+    return key;
+  }
+};
+template <class Enum>
+struct EnumCodec {
+  static constexpr std::size_t size = sizeof(std::int8_t);
+  static bool pack(Enum value, unsigned char* out) { return packValue<std::int8_t>(static_cast<int>(value), out); }
+  static Enum unpack(const unsigned char* in) { return static_cast<Enum>(unpackValue<std::int8_t>(in)); }
+};
+template <>
+struct OperandCodec<RegId> : EnumCodec<RegId> {};
+template <>
+struct OperandCodec<Basis> : EnumCodec<Basis> {};
+template <>
+struct OperandCodec<ReturnCode> : EnumCodec<ReturnCode> {};
+
+template <class... Operands>
+constexpr bool fitsInWord() {
+  return (OperandCodec<Operands>::size + ... + 0) <= InstructionWord::operand_bytes;
+}
+
+template <class T>
+bool packOperand(const T& operand, unsigned char* operands, std::size_t& offset) {
+  bool packed = OperandCodec<T>::pack(operand, operands + offset);
+  offset += OperandCodec<T>::size;
+  return packed;
+}
+
+template <class T>
+T unpackOperand(const unsigned char* operands, std::size_t& offset) {
+  auto operand = OperandCodec<T>::unpack(operands + offset);
+  offset += OperandCodec<T>::size;
+  return operand;
+}
+
+template <class OpLit, class... Operands>
+InstructionWord encodeInstruction(const Instruction<OpLit, Operands...>& instruction, std::size_t alternative) {
+  InstructionWord word;
+  word.alternative = alternative;
+  if constexpr (fitsInWord<Operands...>()) {
+    std::size_t offset = 0;
+    word.wide = !std::apply([&](const auto&... operands) { return (packOperand(operands, word.operands.data(), offset) && ...); }, instruction.args);
+  } else {
+    word.wide = true;
+  }
+  return word;
+}
+
+template <class T>
+struct WordDecoder;
+template <class OpLit, class... Operands>
+struct WordDecoder<Instruction<OpLit, Operands...>> {
+  static constexpr bool fits = fitsInWord<Operands...>();
+  static Instruction<OpLit, Operands...> decode(const InstructionWord& word) {
+    std::size_t offset = 0;
+    // the braced list unpacks the operands from left to right
+    return Instruction<OpLit, Operands...>{std::tuple<Operands...>{unpackOperand<Operands>(word.operands.data(), offset)...}};
+  }
+};
+
+template <std::size_t I>
+void execWord(InstructionVisitor& visitor, const InstructionWord& word) {
+  using Decoder = WordDecoder<std::variant_alternative_t<I, InstructionTypes>>;
+  if constexpr (Decoder::fits) {
+    visitor(Decoder::decode(word));
+  } else {
+    throw std::runtime_error("the wide instruction must be executed from Program::opcodes");
+  }
+}
+
+template <std::size_t... I>
+constexpr std::array<WordHandler, sizeof...(I)> makeWordHandlers(std::index_sequence<I...>) {
+  return {&execWord<I>...};
+}
+}  // namespace
+
+InstructionHandler InstructionVisitor::handlerOf(const InstructionTypes& instruction) { return handlers[instruction.index()]; }
+
+const std::array<WordHandler, std::variant_size_v<InstructionTypes>> InstructionVisitor::word_handlers =
+    makeWordHandlers(std::make_index_sequence<std::variant_size_v<InstructionTypes>>{});
+
+InstructionWord InstructionVisitor::encode(const InstructionTypes& instruction) {
+  return std::visit([&](const auto& instr) { return encodeInstruction(instr, instruction.index()); }, instruction);
+}
+
 InstructionVisitor::InstructionVisitor(const InstructionVisitor& visitor) { runtime = visitor.runtime; }
 
 InstructionVisitor& InstructionVisitor::operator=(const InstructionVisitor& visitor) {
@@ -31,17 +201,16 @@ void InstructionVisitor::operator()(const INSTR_SEND_LINK_TOMOGRAPHY_RESULT_QNod
   auto [partner_addr, counter_reg_id, outcome_key, max_count, start_time] = instruction.args;
   auto count = runtime->getRegVal(counter_reg_id);
   auto outcome = runtime->loadVal(outcome_key).outcome();
-  auto& rs = runtime->ruleset;
-  auto& rule = rs.rules.at(runtime->rule_id);
+  auto& rule = runtime->ruleset->rules.at(runtime->rule_id);
   auto action_index = 0;
-  runtime->callback->sendLinkTomographyResult(rs.id, rule, action_index, partner_addr, count, outcome, max_count, start_time);
+  runtime->callback->sendLinkTomographyResult(runtime->ruleset_id, rule, action_index, partner_addr, count, outcome, max_count, start_time);
 }
 
 void InstructionVisitor::operator()(const INSTR_SEND_PURIFICATION_RESULT_QNodeAddr_RegId_RegId_PurType_& instruction) {
   auto [partner_addr, result_reg, sequence_number_reg, protocol] = instruction.args;
   int measurement_result = runtime->getRegVal(result_reg);  // can only handle up to 32 qubits
   int sequence_number = runtime->getRegVal(sequence_number_reg);
-  auto ruleset_id = runtime->ruleset.id;
+  auto ruleset_id = runtime->ruleset_id;
   runtime->callback->sendPurificationResult(ruleset_id, partner_addr, runtime->send_tag, sequence_number, measurement_result, protocol);
 }
 
@@ -49,7 +218,7 @@ void InstructionVisitor::operator()(const INSTR_SEND_SWAPPING_RESULT_QNodeAddr_R
   auto [partner, pauli_op_reg, new_partner, sequence_number_reg] = instruction.args;
   int pauli_op = runtime->getRegVal(pauli_op_reg);
   int sequence_number = runtime->getRegVal(sequence_number_reg);
-  auto ruleset_id = runtime->ruleset.id;
+  auto ruleset_id = runtime->ruleset_id;
   runtime->callback->sendSwappingResult(ruleset_id, partner, new_partner, runtime->send_tag, sequence_number, pauli_op);
 }
 
@@ -108,6 +277,26 @@ void InstructionVisitor::operator()(const INSTR_PURIFY_Y_RegId_int_QubitId_Qubit
   runtime->purifyY(result_reg_id, bitset_index, qubit_id, trash_qubit_id);
 }
 
+void InstructionVisitor::operator()(const INSTR_PURIFY_X_MemoryKey_QubitId_QubitId_int_& instruction) {
+  auto [result_key, first_qubit_id, first_trash_qubit_id, num_pairs] = instruction.args;
+  runtime->purify(Basis::X, result_key, first_qubit_id, first_trash_qubit_id, num_pairs);
+}
+
+void InstructionVisitor::operator()(const INSTR_PURIFY_Z_MemoryKey_QubitId_QubitId_int_& instruction) {
+  auto [result_key, first_qubit_id, first_trash_qubit_id, num_pairs] = instruction.args;
+  runtime->purify(Basis::Z, result_key, first_qubit_id, first_trash_qubit_id, num_pairs);
+}
+
+void InstructionVisitor::operator()(const INSTR_PURIFY_Y_MemoryKey_QubitId_QubitId_int_& instruction) {
+  auto [result_key, first_qubit_id, first_trash_qubit_id, num_pairs] = instruction.args;
+  runtime->purify(Basis::Y, result_key, first_qubit_id, first_trash_qubit_id, num_pairs);
+}
+
+void InstructionVisitor::operator()(const INSTR_BELL_MEASURE_RegId_QubitId_QubitId_& instruction) {
+  auto [result_reg_id, control_qubit_id, target_qubit_id] = instruction.args;
+  runtime->bellMeasure(result_reg_id, control_qubit_id, target_qubit_id);
+}
+
 void InstructionVisitor::operator()(const INSTR_FREE_QUBIT_QubitId_& instruction) {
   auto [qubit_id] = instruction.args;
   runtime->freeQubit(qubit_id);
@@ -119,7 +308,7 @@ void InstructionVisitor::operator()(const INSTR_LOCK_QUBIT_QubitId_RegId_& instr
   auto& rt = *runtime;
   int action_index = rt.getRegVal(reg_id);
   auto* qubit_rec = rt.getQubitByQubitId(qubit_id);
-  rt.callback->lockQubit(qubit_rec, rt.ruleset.id, rt.rule_id, action_index);
+  rt.callback->lockQubit(qubit_rec, rt.ruleset_id, rt.rule_id, action_index);
 }
 
 void InstructionVisitor::operator()(const INSTR_LOAD_RegId_MemoryKey_& instruction) {
@@ -127,6 +316,11 @@ void InstructionVisitor::operator()(const INSTR_LOAD_RegId_MemoryKey_& instructi
   runtime->loadVal(memory_key, reg_id);
 }
 
+void InstructionVisitor::operator()(const INSTR_LOAD_RegId_MemoryKey_int_& instruction) {
+  auto [reg_id, memory_key, word_index] = instruction.args;
+  runtime->loadVal(memory_key, reg_id, word_index);
+}
+
 void InstructionVisitor::operator()(const INSTR_LOAD_LEFT_OP_RegId_MemoryKey_& instruction) {
   auto [reg_id, outcome_key] = instruction.args;
   auto val = runtime->loadVal(outcome_key);
@@ -218,19 +412,19 @@ void InstructionVisitor::operator()(const INSTR_DEBUG_RUNTIME_STATE_None_& _inst
 void InstructionVisitor::operator()(const INSTR_DEBUG_QubitId_& instruction) {
   auto [qubit_id] = instruction.args;
   auto qubit_ref = runtime->getQubitByQubitId(qubit_id);
-  std::cout << "Debug(QubitId:" << qubit_id << "): "
-            << "\n  qnic type: " << qubit_ref->getQNicType() << "\n  qnic index: " << qubit_ref->getQNicIndex() << "\n  qubit index: " << qubit_ref->getQubitIndex() << std::endl;
+  runtime->writeTrace(TraceEventType::DebugQubit, {qubit_id.val, qubit_ref->getQNicType(), qubit_ref->getQNicIndex(), qubit_ref->getQubitIndex()});
 }
 
 void InstructionVisitor::operator()(const INSTR_DEBUG_String_& instruction) {
   auto [arg] = instruction.args;
-  std::cout << "Debug(string): " << arg << std::endl;
+  auto& trace = runtime->active_trace != nullptr ? *runtime->active_trace : RuntimeTrace::debugTrace();
+  runtime->writeTrace(TraceEventType::DebugString, {trace.internString(arg)});
 }
 
 void InstructionVisitor::operator()(const INSTR_DEBUG_RegId_& instruction) {
   auto [reg1] = instruction.args;
   auto value = runtime->getRegVal(reg1);
-  std::cout << "Debug(Reg): " << value << std::endl;
+  runtime->writeTrace(TraceEventType::DebugRegister, {value});
 }
 
 void InstructionVisitor::operator()(const INSTR_ADD_RegId_RegId_int_& instruction) {
@@ -428,77 +622,89 @@ void InstructionVisitor::operator()(const INSTR_PROMOTE_QubitId_RegId_& instruct
 void InstructionVisitor::operator()(const INSTR_GET_MESSAGE_SEQ_RegId_RegId_& instruction) {
   auto [sequence_number_reg_id, message_index_reg_id] = instruction.args;
   auto message_index = runtime->getRegVal(message_index_reg_id);
-  auto& rule_messages = runtime->messages[{runtime->rule_id}];
-  if (message_index >= rule_messages.size()) {
-    runtime->message_found = false;
-    return;
-  }
-  runtime->message_found = true;
-  auto sequence_number = rule_messages[message_index][0];
-  runtime->setRegVal(sequence_number_reg_id, sequence_number);
+  auto* message = message_index < 0 ? nullptr : runtime->messages.at(runtime->rule_id, message_index);
+  runtime->message_found = message != nullptr;
+  if (message == nullptr) return;
+  runtime->setRegVal(sequence_number_reg_id, message->sequenceNumber());
+}
+
+void InstructionVisitor::operator()(const INSTR_GET_QUBIT_BRANCH_IF_FOUND_Label_QubitId_QNodeAddr_int_& instruction) {
+  auto [label, qubit_id, partner_addr, qubit_resource_index] = instruction.args;
+  auto* qubit_ref = runtime->getQubitByPartnerAddr(partner_addr, qubit_resource_index);
+  runtime->qubit_found = qubit_ref != nullptr;
+  if (qubit_ref == nullptr) return;
+  runtime->setQubit(qubit_ref, qubit_id);
+  runtime->jumpTo(label);
+}
+
+void InstructionVisitor::operator()(const INSTR_GET_QUBIT_BRANCH_IF_FOUND_Label_RegId_QNodeAddr_RegId_& instruction) {
+  auto [label, qubit_id_reg, partner_addr, qubit_resource_index_reg] = instruction.args;
+  int qubit_resource_index = runtime->getRegVal(qubit_resource_index_reg);
+  int qubit_id = runtime->getRegVal(qubit_id_reg);
+  auto* qubit_ref = runtime->getQubitByPartnerAddr(partner_addr, qubit_resource_index);
+  runtime->qubit_found = qubit_ref != nullptr;
+  if (qubit_ref == nullptr) return;
+  runtime->setQubit(qubit_ref, qubit_id);
+  runtime->jumpTo(label);
+}
+
+void InstructionVisitor::operator()(const INSTR_GET_QUBIT_BY_SEQ_NO_BRANCH_IF_FOUND_Label_RegId_QNodeAddr_RegId_& instruction) {
+  auto [label, qubit_id_reg, partner_addr, sequence_number_reg] = instruction.args;
+  auto qubit_id = runtime->getRegVal(qubit_id_reg);
+  auto sequence_number = runtime->getRegVal(sequence_number_reg);
+  auto* qubit_ref = runtime->getQubitBySequenceNumber(partner_addr, runtime->rule_id, sequence_number);
+  runtime->qubit_found = qubit_ref != nullptr;
+  if (qubit_ref == nullptr) return;
+  runtime->setQubit(qubit_ref, qubit_id);
+  runtime->jumpTo(label);
+}
+
+void InstructionVisitor::operator()(const INSTR_GET_MESSAGE_SEQ_BRANCH_IF_FOUND_Label_RegId_RegId_& instruction) {
+  auto [label, sequence_number_reg_id, message_index_reg_id] = instruction.args;
+  auto message_index = runtime->getRegVal(message_index_reg_id);
+  auto* message = message_index < 0 ? nullptr : runtime->messages.at(runtime->rule_id, message_index);
+  runtime->message_found = message != nullptr;
+  if (message == nullptr) return;
+  runtime->setRegVal(sequence_number_reg_id, message->sequenceNumber());
+  runtime->jumpTo(label);
 }
 
 void InstructionVisitor::operator()(const INSTR_COUNT_MESSAGE_RegId_RegId_& instruction) {
   auto [return_reg_id, sequence_number_reg_id] = instruction.args;
   auto sequence_number = runtime->getRegVal(sequence_number_reg_id);
-  auto& rule_messages = runtime->messages[{runtime->rule_id}];
-  int count = 0;
-  for (auto& message : rule_messages) {
-    if (message[0] == sequence_number) {
-      count++;
-    }
-  }
-  runtime->setRegVal(return_reg_id, count);
+  runtime->setRegVal(return_reg_id, static_cast<int32_t>(runtime->messages.count(runtime->rule_id, sequence_number)));
 }
 
 void InstructionVisitor::operator()(const INSTR_GET_MESSAGE_RegId_RegId_int_& instruction) {
   auto [content_reg_id_1, sequence_number_reg_id, message_index] = instruction.args;
   auto sequence_number = runtime->getRegVal(sequence_number_reg_id);
-  auto& rule_messages = runtime->messages[{runtime->rule_id}];
-
-  int i = 0;
-  for (auto& message : rule_messages) {
-    if (message[0] != sequence_number) continue;
-    if (i == message_index && message.size() >= 2) {
-      runtime->message_found = true;
-      runtime->setRegVal(content_reg_id_1, message[1]);
-      return;
-    }
-    i++;
-  }
+  auto* message = message_index < 0 ? nullptr : runtime->messages.find(runtime->rule_id, sequence_number, message_index);
+  if (message == nullptr || message->size() < 2) return;
+  runtime->message_found = true;
+  runtime->setRegVal(content_reg_id_1, (*message)[1]);
 }
 
 void InstructionVisitor::operator()(const INSTR_GET_MESSAGE_RegId_RegId_RegId_int_& instruction) {
   auto [content_reg_id_1, content_reg_id_2, sequence_number_reg_id, message_index] = instruction.args;
   auto sequence_number = runtime->getRegVal(sequence_number_reg_id);
-  auto& rule_messages = runtime->messages[{runtime->rule_id}];
-
-  int i = 0;
-  runtime->message_found = false;
-  for (auto& message : rule_messages) {
-    if (message[0] != sequence_number) continue;
-    if (i == message_index && message.size() >= 3) {
-      runtime->message_found = true;
-      runtime->setRegVal(content_reg_id_1, message[1]);
-      runtime->setRegVal(content_reg_id_2, message[2]);
-      return;
-    }
-    i++;
-  }
+  auto* message = message_index < 0 ? nullptr : runtime->messages.find(runtime->rule_id, sequence_number, message_index);
+  runtime->message_found = message != nullptr && message->size() >= 3;
+  if (!runtime->message_found) return;
+  runtime->setRegVal(content_reg_id_1, (*message)[1]);
+  runtime->setRegVal(content_reg_id_2, (*message)[2]);
 }
 
 void InstructionVisitor::operator()(const INSTR_DELETE_MESSAGE_RegId_& instruction) {
   auto [seq_no_reg] = instruction.args;
   auto sequence_number = runtime->getRegVal(seq_no_reg);
-  auto& rule_messages = runtime->messages[{runtime->rule_id}];
-
-  for (auto it = rule_messages.begin(); it != rule_messages.end();) {
-    if (it->at(0) == sequence_number) {
-      it = rule_messages.erase(it);
-    } else {
-      it++;
-    }
-  }
+  runtime->messages.erase(runtime->rule_id, sequence_number);
+}
+
+void InstructionVisitor::operator()(const INSTR_WAIT_MESSAGE_None_& instruction) { runtime->waitForMessage(); }
+
+void InstructionVisitor::operator()(const INSTR_WAIT_QUBIT_QNodeAddr_& instruction) {
+  auto [partner_addr] = instruction.args;
+  runtime->waitForQubit(partner_addr);
 }
 
 }  // namespace quisp::runtime
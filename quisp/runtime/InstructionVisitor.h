@@ -1,6 +1,10 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include <variant>
 #include "macro_utils.h"
 #include "opcode.h"
 #include "types.h"
@@ -8,6 +12,28 @@
 namespace quisp::runtime {
 
 class Runtime;
+struct InstructionVisitor;
+
+/// @brief pre-decoded handler of an instruction, it executes the instruction with the visitor.
+using InstructionHandler = void (*)(InstructionVisitor&, const InstructionTypes&);
+
+/**
+ * @brief the lowered encoding of an instruction, its alternative of InstructionTypes and the operands packed in 16 bytes.
+ *
+ * RegId, Basis and ReturnCode take a byte, QubitId, Label (pc) and MemoryKey (slot) two, int and QNodeAddr four.
+ * The instruction whose operands don't fit, e.g. with a String, a Time or a MemoryKey without slot, is wide,
+ * and the Runtime executes it from Program::opcodes instead.
+ */
+struct InstructionWord {
+  static constexpr std::size_t operand_bytes = 12;
+  std::uint16_t alternative = 0;
+  bool wide = false;
+  std::array<unsigned char, operand_bytes> operands{};
+};
+static_assert(sizeof(InstructionWord) == 16, "an InstructionWord must fit in 16 bytes");
+
+/// @brief handler of the InstructionWord, it decodes the operands and executes the instruction with the visitor.
+using WordHandler = void (*)(InstructionVisitor&, const InstructionWord&);
 
 /**
  * @brief Visitor class for instructions in a Program.
@@ -27,6 +53,23 @@ struct InstructionVisitor {
 #include "def_instructions.h"
 #undef INSTR
 
+  /**
+   * @brief returns the handler for the type of the given instruction.
+   *
+   * Program::lower() stores the handlers so the Runtime calls them directly
+   * instead of dispatching std::visit over the whole InstructionTypes variant.
+   */
+  static InstructionHandler handlerOf(const InstructionTypes& instruction);
+
+  /// @brief encodes the instruction into an InstructionWord, see Program::words.
+  static InstructionWord encode(const InstructionTypes& instruction);
+
+  /// @brief executes the instruction of the word, only for the word that is not wide.
+  void execute(const InstructionWord& word) { word_handlers[word.alternative](*this, word); }
+
+  /// @brief the handlers of the words indexed by the alternative of InstructionTypes
+  static const std::array<WordHandler, std::variant_size_v<InstructionTypes>> word_handlers;
+
   /// @brief the pointer to the runtime holds this visitor instance.
   Runtime* runtime;
 };
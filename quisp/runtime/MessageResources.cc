@@ -0,0 +1,73 @@
+#include "MessageResources.h"
+
+#include <algorithm>
+
+#include "utils/MemoryUsage.h"
+
+namespace quisp::runtime {
+
+MessageResources::MessageResources(std::pmr::memory_resource* resource) : rules(resource) {}
+
+void MessageResources::insert(RuleId rule_id, const MessageRecord& message) {
+  if (rule_id < 0) return;
+  if (rule_id >= rules.size()) rules.resize(rule_id + 1);
+  auto& rule_messages = rules[rule_id];
+  rule_messages.messages.push_back(message);
+  rule_messages.by_sequence_number[message.sequenceNumber()].push_back(message);
+  total++;
+}
+
+const MessageResources::RuleMessages* MessageResources::rule(RuleId rule_id) const {
+  if (rule_id < 0 || rule_id >= rules.size()) return nullptr;
+  return &rules[rule_id];
+}
+
+const MessageRecord* MessageResources::at(RuleId rule_id, std::size_t index) const {
+  auto* rule_messages = rule(rule_id);
+  if (rule_messages == nullptr || index >= rule_messages->messages.size()) return nullptr;
+  return &rule_messages->messages[index];
+}
+
+std::size_t MessageResources::count(RuleId rule_id, int32_t sequence_number) const {
+  auto* rule_messages = rule(rule_id);
+  if (rule_messages == nullptr) return 0;
+  auto it = rule_messages->by_sequence_number.find(sequence_number);
+  return it != rule_messages->by_sequence_number.end() ? it->second.size() : 0;
+}
+
+const MessageRecord* MessageResources::find(RuleId rule_id, int32_t sequence_number, std::size_t index) const {
+  auto* rule_messages = rule(rule_id);
+  if (rule_messages == nullptr) return nullptr;
+  auto it = rule_messages->by_sequence_number.find(sequence_number);
+  if (it == rule_messages->by_sequence_number.end() || index >= it->second.size()) return nullptr;
+  return &it->second[index];
+}
+
+void MessageResources::erase(RuleId rule_id, int32_t sequence_number) {
+  if (rule_id < 0 || rule_id >= rules.size()) return;
+  auto& rule_messages = rules[rule_id];
+  auto it = rule_messages.by_sequence_number.find(sequence_number);
+  if (it == rule_messages.by_sequence_number.end()) return;
+  total -= it->second.size();
+  rule_messages.by_sequence_number.erase(it);
+  // keep the arrival order, GET_MESSAGE_SEQ picks the messages by their index
+  auto& messages = rule_messages.messages;
+  messages.erase(std::remove_if(messages.begin(), messages.end(), [&](const MessageRecord& message) { return message.sequenceNumber() == sequence_number; }),
+                 messages.end());
+}
+
+std::size_t MessageResources::sizeOf(RuleId rule_id) const {
+  auto* rule_messages = rule(rule_id);
+  return rule_messages != nullptr ? rule_messages->messages.size() : 0;
+}
+
+std::size_t MessageResources::allocatedBytes() const {
+  std::size_t bytes = utils::heapBytesOf(rules);
+  for (auto& rule : rules) {
+    bytes += utils::heapBytesOf(rule.messages) + utils::heapBytesOf(rule.by_sequence_number);
+    for (auto& [sequence_number, messages] : rule.by_sequence_number) bytes += utils::heapBytesOf(messages);
+  }
+  return bytes;
+}
+
+}  // namespace quisp::runtime
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "types.h"
+
+namespace quisp::runtime {
+
+/**
+ * @brief the messages received by a RuleSet, grouped by the rule that waits for them.
+ *
+ * Each rule keeps its messages in the arrival order, and a hash from the sequence number
+ * to the messages with it, so the GET_MESSAGE family of instructions and DELETE_MESSAGE
+ * don't scan all the messages of the rule.
+ * The messages and the indexes take their memory from the memory resource given at the construction, see utils/MemoryResource.h.
+ */
+class MessageResources {
+ public:
+  explicit MessageResources(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+  /// @brief add the message to the rule.
+  void insert(RuleId rule_id, const MessageRecord& message);
+
+  /// @brief returns the index-th message of the rule in the arrival order, or nullptr if there is no such message.
+  const MessageRecord* at(RuleId rule_id, std::size_t index) const;
+
+  /// @brief returns the number of the messages of the rule with the sequence number.
+  std::size_t count(RuleId rule_id, int32_t sequence_number) const;
+
+  /// @brief returns the index-th message of the rule with the sequence number in the arrival order, or nullptr if there is no such message.
+  const MessageRecord* find(RuleId rule_id, int32_t sequence_number, std::size_t index) const;
+
+  /// @brief remove all the messages of the rule with the sequence number.
+  void erase(RuleId rule_id, int32_t sequence_number);
+
+  /// @brief returns the number of the messages of the rule.
+  std::size_t sizeOf(RuleId rule_id) const;
+
+  std::size_t size() const { return total; }
+  bool empty() const { return total == 0; }
+  /// @brief the approximate heap bytes of the messages and the indexes, see utils/MemoryUsage.h.
+  std::size_t allocatedBytes() const;
+
+ private:
+  struct RuleMessages {
+    // the containers of the rule take the resource of the rules
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+    explicit RuleMessages(const allocator_type& alloc = {}) : messages(alloc), by_sequence_number(alloc) {}
+    RuleMessages(const RuleMessages& other, const allocator_type& alloc) : messages(other.messages, alloc), by_sequence_number(other.by_sequence_number, alloc) {}
+    RuleMessages(RuleMessages&& other, const allocator_type& alloc) : messages(std::move(other.messages), alloc), by_sequence_number(std::move(other.by_sequence_number), alloc) {}
+
+    // the arrival order
+    std::pmr::vector<MessageRecord> messages;
+    std::pmr::unordered_map<int32_t, std::pmr::vector<MessageRecord>> by_sequence_number;
+  };
+
+  // indexed by the RuleId
+  std::pmr::vector<RuleMessages> rules;
+  std::size_t total = 0;
+
+  const RuleMessages* rule(RuleId rule_id) const;
+};
+
+}  // namespace quisp::runtime
@@ -0,0 +1,59 @@
+#include "MessageResources.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+using namespace quisp::runtime;
+
+TEST(MessageResourcesTest, InsertAndFind) {
+  MessageResources messages;
+  messages.insert(0, {1, 10, 100});
+  messages.insert(0, {2, 20, 200});
+  messages.insert(0, {1, 11, 101});
+  messages.insert(1, {1, 30});
+  EXPECT_EQ(messages.size(), 4);
+  EXPECT_EQ(messages.sizeOf(0), 3);
+
+  // arrival order
+  ASSERT_NE(messages.at(0, 1), nullptr);
+  EXPECT_EQ(messages.at(0, 1)->sequenceNumber(), 2);
+  EXPECT_EQ(messages.at(0, 3), nullptr);
+
+  EXPECT_EQ(messages.count(0, 1), 2);
+  EXPECT_EQ(messages.count(1, 1), 1);
+  EXPECT_EQ(messages.count(0, 3), 0);
+  ASSERT_NE(messages.find(0, 1, 1), nullptr);
+  EXPECT_EQ(*messages.find(0, 1, 1), (MessageRecord{1, 11, 101}));
+  EXPECT_EQ(messages.find(0, 1, 2), nullptr);
+
+  // unknown rules have no messages
+  EXPECT_EQ(messages.at(2, 0), nullptr);
+  EXPECT_EQ(messages.at(-1, 0), nullptr);
+  EXPECT_EQ(messages.count(2, 1), 0);
+}
+
+TEST(MessageResourcesTest, Erase) {
+  MessageResources messages;
+  messages.insert(0, {1, 10});
+  messages.insert(0, {2, 20});
+  messages.insert(0, {1, 11});
+  messages.insert(0, {3, 30});
+  messages.erase(0, 1);
+  EXPECT_EQ(messages.size(), 2);
+  EXPECT_EQ(messages.count(0, 1), 0);
+  // erasing keeps the arrival order
+  EXPECT_EQ(messages.at(0, 0)->sequenceNumber(), 2);
+  EXPECT_EQ(messages.at(0, 1)->sequenceNumber(), 3);
+  messages.erase(0, 4);
+  messages.erase(1, 2);
+  EXPECT_EQ(messages.size(), 2);
+}
+
+TEST(MessageResourcesTest, MessageRecord) {
+  MessageRecord message{1, 2};
+  EXPECT_EQ(message.size(), 2);
+  EXPECT_EQ(message[1], 2);
+  EXPECT_THROW((MessageRecord{1, 2, 3, 4}), std::runtime_error);
+}
+
+}  // namespace
@@ -0,0 +1,455 @@
+#include "ProgramOptimizer.h"
+
+#include <array>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace quisp::runtime {
+
+namespace {
+constexpr int max_iterations = 16;
+
+std::string& labelOf(InstructionTypes& instr) {
+  return std::visit([](auto& op) -> std::string& { return op.label; }, instr);
+}
+
+int opcodeOf(const InstructionTypes& instr) {
+  return std::visit([](auto& op) { return op.opcode; }, instr);
+}
+
+// the Label operand of the instruction, or nullptr
+Label* targetOf(InstructionTypes& instr) {
+  Label* target = nullptr;
+  forEachOperand<Label>(instr, [&](Label& label) { target = &label; });
+  return target;
+}
+
+// the instructions that only jump, so they can be removed if they jump to the next instruction
+bool isPureBranch(int opcode) {
+  switch (opcode) {
+    case OpType::BEQ:
+    case OpType::BEZ:
+    case OpType::BNZ:
+    case OpType::BLT:
+    case OpType::JMP:
+    case OpType::BRANCH_IF_QUBIT_FOUND:
+    case OpType::BRANCH_IF_MESSAGE_FOUND:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// the instructions that never continue to the next instruction
+bool isTerminator(int opcode) { return opcode == OpType::JMP || opcode == OpType::RET || opcode == OpType::ERROR; }
+
+// the instructions that never write registers
+bool keepsRegisters(int opcode) {
+  switch (opcode) {
+    case OpType::DEBUG:
+    case OpType::DEBUG_RUNTIME_STATE:
+    case OpType::BEQ:
+    case OpType::BEZ:
+    case OpType::BNZ:
+    case OpType::BLT:
+    case OpType::BRANCH_IF_LOCKED:
+    case OpType::BRANCH_IF_QUBIT_FOUND:
+    case OpType::BRANCH_IF_MESSAGE_FOUND:
+    case OpType::STORE:
+    case OpType::GET_QUBIT:
+    case OpType::GET_QUBIT_BY_SEQ_NO:
+    case OpType::MEASURE_RANDOM:
+    case OpType::FREE_QUBIT:
+    case OpType::LOCK_QUBIT:
+    case OpType::GATE_X:
+    case OpType::GATE_Z:
+    case OpType::GATE_Y:
+    case OpType::GATE_CNOT:
+    case OpType::PROMOTE:
+    case OpType::SEND_LINK_TOMOGRAPHY_RESULT:
+    case OpType::SEND_PURIFICATION_RESULT:
+    case OpType::SEND_SWAPPING_RESULT:
+    case OpType::DELETE_MESSAGE:
+    case OpType::WAIT_MESSAGE:
+    case OpType::WAIT_QUBIT:
+    case OpType::GET_QUBIT_BRANCH_IF_FOUND:
+    case OpType::GET_QUBIT_BY_SEQ_NO_BRANCH_IF_FOUND:
+    case OpType::NOP:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// the instructions that never change the assigned qubits, their lock state or the qubit_found flag
+bool keepsQubits(int opcode) {
+  switch (opcode) {
+    case OpType::DEBUG:
+    case OpType::DEBUG_RUNTIME_STATE:
+    case OpType::ADD:
+    case OpType::SUB:
+    case OpType::INC:
+    case OpType::SET:
+    case OpType::BITWISE_AND:
+    case OpType::BITWISE_OR:
+    case OpType::BITWISE_XOR:
+    case OpType::BEQ:
+    case OpType::BEZ:
+    case OpType::BNZ:
+    case OpType::BLT:
+    case OpType::LOAD:
+    case OpType::STORE:
+    case OpType::LOAD_LEFT_OP:
+    case OpType::LOAD_RIGHT_OP:
+    case OpType::MEASURE_RANDOM:
+    case OpType::MEASURE:
+    case OpType::BELL_MEASURE:
+    case OpType::GATE_X:
+    case OpType::GATE_Z:
+    case OpType::GATE_Y:
+    case OpType::GATE_CNOT:
+    case OpType::SEND_LINK_TOMOGRAPHY_RESULT:
+    case OpType::SEND_PURIFICATION_RESULT:
+    case OpType::SEND_SWAPPING_RESULT:
+    case OpType::NOP:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/**
+ * @brief the instructions being optimized.
+ *
+ * A pass marks the instructions to remove, and compact() removes them. The
+ * label of a removed instruction moves to the next remaining instruction.
+ */
+class Code {
+ public:
+  explicit Code(const std::vector<InstructionTypes>& instructions) : instructions(instructions), removed(instructions.size(), false) { compact(); }
+
+  std::size_t size() const { return instructions.size(); }
+  InstructionTypes& operator[](std::size_t i) { return instructions[i]; }
+  void remove(std::size_t i) { removed[i] = true; }
+  bool isRemoved(std::size_t i) const { return removed[i]; }
+
+  // the index of the label, or size() if the Program doesn't have it
+  std::size_t indexOf(const Label& label) const {
+    auto it = label_index.find(label.val);
+    return it != label_index.end() ? it->second : instructions.size();
+  }
+
+  // the label of the instruction, a new one is added if it doesn't have a label
+  std::string labelAt(std::size_t i) {
+    auto& label = labelOf(instructions[i]);
+    if (label.empty()) {
+      label = "__OPT_" + std::to_string(generated_labels++);
+      label_index.emplace(label, i);
+    }
+    return label;
+  }
+
+  // the first instruction from i that is not removed, or size()
+  std::size_t alive(std::size_t i) const {
+    for (; i < instructions.size() && removed[i]; i++) {
+    }
+    return i;
+  }
+
+  // removes the marked instructions and the labels no instruction refers to
+  void compact() {
+    std::unordered_map<std::string, std::string> renamed;
+    std::optional<std::size_t> next_alive;
+    for (auto i = instructions.size(); i-- > 0;) {
+      auto& label = labelOf(instructions[i]);
+      if (removed[i] && !label.empty()) {
+        if (!next_alive) {
+          // keep the label at the end of the Program
+          std::string end_label = label;
+          instructions[i] = INSTR_NOP_None_{nullptr, end_label};
+          removed[i] = false;
+        } else {
+          auto& next_label = labelOf(instructions[*next_alive]);
+          if (next_label.empty()) {
+            next_label = label;
+          } else {
+            renamed.emplace(label, next_label);
+          }
+        }
+      }
+      if (!removed[i]) next_alive = i;
+    }
+
+    std::vector<InstructionTypes> compacted;
+    for (std::size_t i = 0; i < instructions.size(); i++) {
+      if (!removed[i]) compacted.push_back(std::move(instructions[i]));
+    }
+    std::unordered_set<std::string> referred;
+    for (auto& instr : compacted) {
+      forEachOperand<Label>(instr, [&](Label& label) {
+        auto it = renamed.find(label.val);
+        if (it != renamed.end()) label.val = it->second;
+        referred.insert(label.val);
+      });
+    }
+    label_index.clear();
+    for (std::size_t i = 0; i < compacted.size(); i++) {
+      auto& label = labelOf(compacted[i]);
+      if (referred.count(label) == 0) {
+        label.clear();
+      } else {
+        label_index.emplace(label, i);
+      }
+    }
+    instructions = std::move(compacted);
+    removed.assign(instructions.size(), false);
+  }
+
+  std::vector<InstructionTypes> instructions;
+
+ private:
+  std::vector<bool> removed;
+  std::unordered_map<std::string, std::size_t> label_index;
+  int generated_labels = 0;
+};
+
+bool threadJumps(Code& code) {
+  bool changed = false;
+  for (std::size_t i = 0; i < code.size(); i++) {
+    auto* target = targetOf(code[i]);
+    if (target == nullptr) continue;
+    auto index = code.indexOf(*target);
+    // follow NOPs and JMPs, the steps are bounded for the infinite loops
+    for (std::size_t steps = 0; index < code.size() && steps < code.size(); steps++) {
+      auto opcode = opcodeOf(code[index]);
+      if (opcode == OpType::NOP && index + 1 < code.size()) {
+        index++;
+      } else if (opcode == OpType::JMP) {
+        index = code.indexOf(*targetOf(code[index]));
+      } else {
+        break;
+      }
+    }
+    if (index >= code.size()) continue;
+    if (opcodeOf(code[i]) == OpType::JMP && std::holds_alternative<INSTR_RET_ReturnCode_>(code[index])) {
+      auto ret = code[index];
+      labelOf(ret) = labelOf(code[i]);
+      code[i] = ret;
+      changed = true;
+      continue;
+    }
+    auto label = code.labelAt(index);
+    if (target->val != label) {
+      target->val = label;
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+bool removeDeadCode(Code& code) {
+  bool changed = false;
+  bool reachable = true;
+  for (std::size_t i = 0; i < code.size(); i++) {
+    auto& instr = code[i];
+    if (!labelOf(instr).empty()) reachable = true;
+    auto opcode = opcodeOf(instr);
+    // a NOP at the end keeps the label for the branches to the end
+    bool end_label = opcode == OpType::NOP && i + 1 == code.size() && !labelOf(instr).empty();
+    if (!reachable || (opcode == OpType::NOP && !end_label)) {
+      code.remove(i);
+      changed = true;
+      continue;
+    }
+    if (isTerminator(opcode)) reachable = false;
+  }
+  // branches to the next instruction
+  for (std::size_t i = 0; i < code.size(); i++) {
+    if (code.isRemoved(i) || !isPureBranch(opcodeOf(code[i]))) continue;
+    auto target = code.indexOf(*targetOf(code[i]));
+    if (target < code.size() && code.alive(i + 1) == code.alive(target)) {
+      code.remove(i);
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+bool foldConstants(Code& code) {
+  bool changed = false;
+  // the Runtime clears the registers before executing a Program
+  std::array<std::optional<int>, 5> regs;
+  regs.fill(0);
+  auto reg = [&](RegId id) -> std::optional<int>& { return regs[(int)id]; };
+  auto branch = [&](std::size_t i, bool taken) {
+    if (taken) {
+      auto label = labelOf(code[i]);
+      code[i] = INSTR_JMP_Label_{{*targetOf(code[i])}, label};
+    } else {
+      code.remove(i);
+    }
+    changed = true;
+  };
+
+  for (std::size_t i = 0; i < code.size(); i++) {
+    auto& instr = code[i];
+    if (!labelOf(instr).empty()) regs.fill(std::nullopt);
+    if (auto* op = std::get_if<INSTR_SET_RegId_int_>(&instr)) {
+      auto [id, value] = op->args;
+      if (reg(id) == value) {
+        code.remove(i);
+        changed = true;
+      }
+      reg(id) = value;
+    } else if (auto* op = std::get_if<INSTR_INC_RegId_>(&instr)) {
+      auto [id] = op->args;
+      if (reg(id)) reg(id) = *reg(id) + 1;
+    } else if (auto* op = std::get_if<INSTR_ADD_RegId_RegId_int_>(&instr)) {
+      auto [id, src, value] = op->args;
+      reg(id) = reg(src) ? std::optional<int>(*reg(src) + value) : std::nullopt;
+    } else if (auto* op = std::get_if<INSTR_SUB_RegId_RegId_int_>(&instr)) {
+      auto [id, src, value] = op->args;
+      reg(id) = reg(src) ? std::optional<int>(*reg(src) - value) : std::nullopt;
+    } else if (auto* op = std::get_if<INSTR_BEQ_Label_RegId_int_>(&instr)) {
+      auto& [_label, id, value] = op->args;
+      if (reg(id)) branch(i, *reg(id) == value);
+    } else if (auto* op = std::get_if<INSTR_BEQ_Label_RegId_RegId_>(&instr)) {
+      auto& [_label, id1, id2] = op->args;
+      if (reg(id1) && reg(id2)) branch(i, *reg(id1) == *reg(id2));
+    } else if (auto* op = std::get_if<INSTR_BEZ_Label_RegId_>(&instr)) {
+      auto& [_label, id] = op->args;
+      if (reg(id)) branch(i, *reg(id) == 0);
+    } else if (auto* op = std::get_if<INSTR_BNZ_Label_RegId_>(&instr)) {
+      auto& [_label, id] = op->args;
+      if (reg(id)) branch(i, *reg(id) != 0);
+    } else if (auto* op = std::get_if<INSTR_BLT_Label_RegId_int_>(&instr)) {
+      auto& [_label, id, value] = op->args;
+      if (reg(id)) branch(i, *reg(id) < value);
+    } else if (!keepsRegisters(opcodeOf(instr))) {
+      regs.fill(std::nullopt);
+    }
+  }
+  return changed;
+}
+
+bool removeDeadStores(Code& code, const std::unordered_set<std::string>& loaded_keys) {
+  bool changed = false;
+  for (std::size_t i = 0; i < code.size(); i++) {
+    MemoryKey* key = nullptr;
+    if (auto* op = std::get_if<INSTR_STORE_MemoryKey_RegId_>(&code[i])) key = &std::get<0>(op->args);
+    if (auto* op = std::get_if<INSTR_STORE_MemoryKey_int_>(&code[i])) key = &std::get<0>(op->args);
+    if (key != nullptr && loaded_keys.count(key->val) == 0) {
+      code.remove(i);
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+bool removeRepeatedGetQubit(Code& code) {
+  bool changed = false;
+  const INSTR_GET_QUBIT_QubitId_QNodeAddr_int_* last = nullptr;
+  for (std::size_t i = 0; i < code.size(); i++) {
+    auto& instr = code[i];
+    if (!labelOf(instr).empty()) last = nullptr;
+    if (auto* op = std::get_if<INSTR_GET_QUBIT_QubitId_QNodeAddr_int_>(&instr)) {
+      if (last != nullptr && last->args == op->args) {
+        code.remove(i);
+        changed = true;
+      } else {
+        last = op;
+      }
+    } else if (!keepsQubits(opcodeOf(instr))) {
+      last = nullptr;
+    }
+  }
+  return changed;
+}
+
+// fuses the instruction with the following BRANCH_IF_QUBIT_FOUND / BRANCH_IF_MESSAGE_FOUND
+void fuse(Code& code) {
+  for (std::size_t i = 0; i + 1 < code.size(); i++) {
+    auto& instr = code[i];
+    auto& next = code[i + 1];
+    if (!labelOf(next).empty()) continue;
+    auto label = labelOf(instr);
+    if (auto* branch = std::get_if<INSTR_BRANCH_IF_QUBIT_FOUND_Label_>(&next)) {
+      auto [target] = branch->args;
+      if (auto* op = std::get_if<INSTR_GET_QUBIT_QubitId_QNodeAddr_int_>(&instr)) {
+        auto [qubit_id, partner_addr, index] = op->args;
+        instr = INSTR_GET_QUBIT_BRANCH_IF_FOUND_Label_QubitId_QNodeAddr_int_{{target, qubit_id, partner_addr, index}, label};
+      } else if (auto* op = std::get_if<INSTR_GET_QUBIT_RegId_QNodeAddr_RegId_>(&instr)) {
+        auto [qubit_id_reg, partner_addr, index_reg] = op->args;
+        instr = INSTR_GET_QUBIT_BRANCH_IF_FOUND_Label_RegId_QNodeAddr_RegId_{{target, qubit_id_reg, partner_addr, index_reg}, label};
+      } else if (auto* op = std::get_if<INSTR_GET_QUBIT_BY_SEQ_NO_RegId_QNodeAddr_RegId_>(&instr)) {
+        auto [qubit_id_reg, partner_addr, seq_no_reg] = op->args;
+        instr = INSTR_GET_QUBIT_BY_SEQ_NO_BRANCH_IF_FOUND_Label_RegId_QNodeAddr_RegId_{{target, qubit_id_reg, partner_addr, seq_no_reg}, label};
+      } else {
+        continue;
+      }
+    } else if (auto* branch = std::get_if<INSTR_BRANCH_IF_MESSAGE_FOUND_Label_>(&next)) {
+      auto [target] = branch->args;
+      if (auto* op = std::get_if<INSTR_GET_MESSAGE_SEQ_RegId_RegId_>(&instr)) {
+        auto [seq_no_reg, message_index_reg] = op->args;
+        instr = INSTR_GET_MESSAGE_SEQ_BRANCH_IF_FOUND_Label_RegId_RegId_{{target, seq_no_reg, message_index_reg}, label};
+      } else {
+        continue;
+      }
+    } else {
+      continue;
+    }
+    code.remove(i + 1);
+    i++;
+  }
+  code.compact();
+}
+
+// collects the MemoryKeys an instruction other than STORE uses
+void collectLoadedKeys(const Program& program, std::unordered_set<std::string>& loaded_keys) {
+  for (auto& instr : program.opcodes) {
+    if (opcodeOf(instr) == OpType::STORE) continue;
+    forEachOperand<MemoryKey>(instr, [&](const MemoryKey& key) { loaded_keys.insert(key.val); });
+  }
+}
+}  // namespace
+
+void ProgramOptimizer::optimize(RuleSet& ruleset) {
+  std::unordered_set<std::string> loaded_keys;
+  for (auto& rule : ruleset.rules) {
+    collectLoadedKeys(rule.condition, loaded_keys);
+    collectLoadedKeys(rule.action, loaded_keys);
+  }
+  collectLoadedKeys(ruleset.termination_condition, loaded_keys);
+
+  for (auto& rule : ruleset.rules) {
+    rule.condition = optimize(rule.condition, &loaded_keys);
+    rule.action = optimize(rule.action, &loaded_keys);
+  }
+  ruleset.termination_condition = optimize(ruleset.termination_condition, &loaded_keys);
+}
+
+Program ProgramOptimizer::optimize(const Program& program, const std::unordered_set<std::string>* loaded_keys) {
+  if (program.debugging) return program;
+  Code code{program.opcodes};
+  // the passes mostly remove instructions, the iterations are bounded in case jumps form a loop
+  for (int iteration = 0; iteration < max_iterations; iteration++) {
+    bool changed = foldConstants(code);
+    code.compact();
+    changed = threadJumps(code) || changed;
+    changed = removeDeadCode(code) || changed;
+    code.compact();
+    if (loaded_keys != nullptr) changed = removeDeadStores(code, *loaded_keys) || changed;
+    changed = removeRepeatedGetQubit(code) || changed;
+    code.compact();
+    if (!changed) break;
+  }
+  fuse(code);
+  Program optimized{program.name, code.instructions, program.debugging};
+  optimized.qubit_count_guards = program.qubit_count_guards;
+  return optimized;
+}
+
+}  // namespace quisp::runtime
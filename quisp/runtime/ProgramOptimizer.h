@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <unordered_set>
+
+#include "RuleSet.h"
+
+namespace quisp::runtime {
+
+/**
+ * @brief peephole optimizer for the Programs the RuleSetConverter produces.
+ *
+ * The converter emits a fixed instruction sequence for each clause and action,
+ * so the Programs contain instructions the Runtime would execute for nothing.
+ * The optimizer applies these passes until nothing changes:
+ * - constant folding: the registers are zero when a Program starts, so a SET
+ *   of the value a register already has is removed, and a branch on known
+ *   values becomes a JMP or is removed.
+ * - dead store elimination: STOREs to the MemoryKeys no Program in the RuleSet reads.
+ * - jump threading: a branch to a NOP or a JMP goes to the final target, a JMP
+ *   to a RET becomes the RET, and branches to the next instruction, NOPs and
+ *   unreachable instructions are removed.
+ * - a GET_QUBIT repeated without anything that may change the resources in between is removed.
+ *
+ * Finally, GET_QUBIT, GET_QUBIT_BY_SEQ_NO and GET_MESSAGE_SEQ followed by the
+ * branch on their flag are fused into one instruction.
+ *
+ * It must run before RuleSet::finalize(). The Programs with the debugging flag are kept as they are.
+ */
+class ProgramOptimizer {
+ public:
+  /// @brief optimizes all the Programs in the RuleSet.
+  static void optimize(RuleSet& ruleset);
+
+  /**
+   * @brief returns the optimized Program.
+   *
+   * @param loaded_keys the MemoryKeys read in the RuleSet, the other STOREs are removed.
+   * if it's nullptr, all the STOREs are kept.
+   */
+  static Program optimize(const Program& program, const std::unordered_set<std::string>* loaded_keys = nullptr);
+};
+
+}  // namespace quisp::runtime
@@ -0,0 +1,159 @@
+#include "ProgramOptimizer.h"
+
+#include <gtest/gtest.h>
+
+#include "modules/QRSA/RuleEngine/QubitRecord/QubitRecord.h"
+#include "runtime/Runtime.h"
+#include "runtime/types.h"
+#include "test.h"
+
+namespace {
+using namespace quisp::runtime;
+using namespace quisp_test;
+using namespace testing;
+using quisp::modules::QNIC_E;
+using quisp::modules::qubit_record::QubitRecord;
+
+std::vector<std::string> instructionsOf(const Program& program) {
+  std::vector<std::string> instructions;
+  for (auto& instr : program.opcodes) {
+    instructions.push_back(std::visit([](auto& op) { return op.toString(); }, instr));
+  }
+  return instructions;
+}
+
+// same as the EnoughResource condition the RuleSetConverter generates.
+Program enoughResourceCondition(QNodeAddr partner_addr, int num_resource) {
+  Label loop{"LOOP"}, found_qubit{"FOUND_QUBIT"}, passed{"PASSED"};
+  return Program{"EnoughResource",
+                 {
+                     INSTR_SET_RegId_int_{{RegId::REG0, 0}},
+                     INSTR_SET_RegId_int_{{RegId::REG1, -1}},
+                     INSTR_INC_RegId_{RegId::REG1, loop},
+                     INSTR_GET_QUBIT_RegId_QNodeAddr_RegId_{{RegId::REG1, partner_addr, RegId::REG1}},
+                     INSTR_BRANCH_IF_QUBIT_FOUND_Label_{found_qubit},
+                     INSTR_RET_ReturnCode_{ReturnCode::COND_FAILED},
+                     INSTR_INC_RegId_{{RegId::REG0}, found_qubit},
+                     INSTR_BEQ_Label_RegId_int_{{passed, RegId::REG0, num_resource}},
+                     INSTR_JMP_Label_{loop},
+                     INSTR_NOP_None_{nullptr, passed},
+                     INSTR_RET_ReturnCode_{{ReturnCode::COND_PASSED}},
+                 }};
+}
+
+TEST(ProgramOptimizerTest, FoldConstants) {
+  Label passed{"PASSED"};
+  Program program{"fold",
+                  {
+                      // the registers are zero at the start
+                      INSTR_SET_RegId_int_{{RegId::REG0, 0}},
+                      INSTR_SET_RegId_int_{{RegId::REG1, 5}},
+                      INSTR_BEQ_Label_RegId_int_{{passed, RegId::REG1, 5}},
+                      INSTR_RET_ReturnCode_{ReturnCode::COND_FAILED},
+                      INSTR_RET_ReturnCode_{{ReturnCode::COND_PASSED}, passed},
+                  }};
+  auto optimized = ProgramOptimizer::optimize(program);
+  ASSERT_EQ(optimized.opcodes.size(), 2);
+  EXPECT_EQ(std::get<INSTR_SET_RegId_int_>(optimized.opcodes[0]).args, std::make_tuple(RegId::REG1, 5));
+  EXPECT_EQ(std::get<INSTR_RET_ReturnCode_>(optimized.opcodes[1]).args, std::make_tuple(ReturnCode::COND_PASSED));
+}
+
+TEST(ProgramOptimizerTest, ThreadJumps) {
+  Label first{"FIRST"}, second{"SECOND"};
+  Program program{"thread",
+                  {
+                      INSTR_LOAD_RegId_MemoryKey_{{RegId::REG0, MemoryKey{"key"}}},
+                      INSTR_BEZ_Label_RegId_{{first, RegId::REG0}},
+                      INSTR_RET_ReturnCode_{ReturnCode::COND_FAILED},
+                      INSTR_JMP_Label_{{second}, first},
+                      INSTR_NOP_None_{nullptr},
+                      INSTR_RET_ReturnCode_{{ReturnCode::COND_PASSED}, second},
+                  }};
+  auto optimized = ProgramOptimizer::optimize(program);
+  ASSERT_EQ(optimized.opcodes.size(), 4);
+  auto& branch = std::get<INSTR_BEZ_Label_RegId_>(optimized.opcodes[1]);
+  EXPECT_EQ(std::get<0>(branch.args).pc, 3);
+  EXPECT_TRUE(std::holds_alternative<INSTR_RET_ReturnCode_>(optimized.opcodes[2]));
+  EXPECT_EQ(std::get<INSTR_RET_ReturnCode_>(optimized.opcodes[3]).args, std::make_tuple(ReturnCode::COND_PASSED));
+}
+
+TEST(ProgramOptimizerTest, FuseEnoughResourceCondition) {
+  auto optimized = ProgramOptimizer::optimize(enoughResourceCondition(QNodeAddr{1}, 1));
+  // SET REG0 0 and the NOP are removed, GET_QUBIT and BRANCH_IF_QUBIT_FOUND are fused
+  auto instructions = instructionsOf(optimized);
+  ASSERT_EQ(instructions.size(), 8) << ::testing::PrintToString(instructions);
+  EXPECT_TRUE(std::holds_alternative<INSTR_SET_RegId_int_>(optimized.opcodes[0]));
+  EXPECT_TRUE(std::holds_alternative<INSTR_GET_QUBIT_BRANCH_IF_FOUND_Label_RegId_QNodeAddr_RegId_>(optimized.opcodes[2]));
+  auto& fused = std::get<INSTR_GET_QUBIT_BRANCH_IF_FOUND_Label_RegId_QNodeAddr_RegId_>(optimized.opcodes[2]);
+  EXPECT_EQ(std::get<0>(fused.args).pc, 4);
+  auto& beq = std::get<INSTR_BEQ_Label_RegId_int_>(optimized.opcodes[5]);
+  EXPECT_EQ(std::get<0>(beq.args).pc, 7);
+  auto& jmp = std::get<INSTR_JMP_Label_>(optimized.opcodes[6]);
+  EXPECT_EQ(std::get<0>(jmp.args).pc, 1);
+}
+
+TEST(ProgramOptimizerTest, OptimizedConditionBehavesTheSame) {
+  QNodeAddr partner_addr{1};
+  MockRuntimeCallback callback;
+  EXPECT_CALL(callback, isQubitLocked(_)).WillRepeatedly(Return(false));
+  QubitRecord qubit1{QNIC_E, 0, 0};
+  QubitRecord qubit2{QNIC_E, 0, 1};
+  for (int num_resource = 1; num_resource <= 3; num_resource++) {
+    auto original = enoughResourceCondition(partner_addr, num_resource);
+    auto optimized = ProgramOptimizer::optimize(original);
+    for (auto* program : {&original, &optimized}) {
+      Runtime runtime;
+      runtime.callback = &callback;
+      runtime.rule_id = 0;
+      runtime.assignQubitToRule(partner_addr, 0, &qubit1);
+      runtime.assignQubitToRule(partner_addr, 0, &qubit2);
+      runtime.execProgram(*program);
+      EXPECT_EQ(runtime.return_code, num_resource <= 2 ? ReturnCode::COND_PASSED : ReturnCode::COND_FAILED) << program->name << " " << num_resource;
+    }
+  }
+}
+
+TEST(ProgramOptimizerTest, RemoveRepeatedGetQubit) {
+  QubitId q0{0};
+  QNodeAddr partner_addr{1};
+  Program program{"get qubit",
+                  {
+                      INSTR_GET_QUBIT_QubitId_QNodeAddr_int_{{q0, partner_addr, 0}},
+                      INSTR_GATE_X_QubitId_{q0},
+                      INSTR_GET_QUBIT_QubitId_QNodeAddr_int_{{q0, partner_addr, 0}},
+                      INSTR_FREE_QUBIT_QubitId_{q0},
+                      // the qubit is freed, so this may find another one
+                      INSTR_GET_QUBIT_QubitId_QNodeAddr_int_{{q0, partner_addr, 0}},
+                  }};
+  auto optimized = ProgramOptimizer::optimize(program);
+  ASSERT_EQ(optimized.opcodes.size(), 4);
+  EXPECT_TRUE(std::holds_alternative<INSTR_GATE_X_QubitId_>(optimized.opcodes[1]));
+  EXPECT_TRUE(std::holds_alternative<INSTR_FREE_QUBIT_QubitId_>(optimized.opcodes[2]));
+  EXPECT_TRUE(std::holds_alternative<INSTR_GET_QUBIT_QubitId_QNodeAddr_int_>(optimized.opcodes[3]));
+}
+
+TEST(ProgramOptimizerTest, RemoveDeadStores) {
+  RuleSet rs{"dead store",
+             {Rule{"rule", -1, -1,
+                   Program{"condition",
+                           {
+                               INSTR_STORE_MemoryKey_int_{{MemoryKey{"unused"}, 1}},
+                               INSTR_STORE_MemoryKey_int_{{MemoryKey{"used"}, 2}},
+                           }},
+                   Program{"action", {INSTR_LOAD_RegId_MemoryKey_{{RegId::REG0, MemoryKey{"used"}}}}}}}};
+  // a single Program doesn't know which keys the others load
+  EXPECT_EQ(ProgramOptimizer::optimize(rs.rules[0].condition).opcodes.size(), 2);
+
+  ProgramOptimizer::optimize(rs);
+  auto& condition = rs.rules[0].condition;
+  ASSERT_EQ(condition.opcodes.size(), 1);
+  EXPECT_EQ(std::get<0>(std::get<INSTR_STORE_MemoryKey_int_>(condition.opcodes[0]).args).val, "used");
+  EXPECT_EQ(rs.rules[0].action.opcodes.size(), 1);
+}
+
+TEST(ProgramOptimizerTest, KeepDebuggingProgram) {
+  Program program{"debug", {INSTR_NOP_None_{nullptr}}, true};
+  EXPECT_EQ(ProgramOptimizer::optimize(program).opcodes.size(), 1);
+}
+
+}  // namespace
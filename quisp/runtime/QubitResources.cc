@@ -0,0 +1,82 @@
+#include "QubitResources.h"
+
+#include <algorithm>
+
+#include "utils/MemoryUsage.h"
+
+namespace quisp::runtime {
+
+namespace {
+auto findEntry(const QubitResources::Entries& entries, SequenceNumber sequence_number) {
+  return std::lower_bound(entries.begin(), entries.end(), sequence_number, [](const QubitResources::Entry& entry, SequenceNumber seq) { return entry.sequence_number < seq; });
+}
+}  // namespace
+
+QubitResources::QubitResources(std::pmr::memory_resource* resource) : groups(resource), locations(resource), partner_counts(resource) {}
+
+SequenceNumber QubitResources::insert(QNodeAddr partner_addr, RuleId rule_id, IQubitRecord* qubit) {
+  erase(qubit);
+  auto& group = groups[{partner_addr, rule_id}];
+  auto sequence_number = ++group.last_sequence_number;
+  auto entangled_time = qubit->getEntangledTime();
+  group.entries.push_back({qubit, sequence_number, entangled_time});
+  group.by_age.emplace(std::make_pair(entangled_time, sequence_number), qubit);
+  locations.emplace(qubit, Location{partner_addr, rule_id, sequence_number});
+  partner_counts[partner_addr]++;
+  return sequence_number;
+}
+
+bool QubitResources::erase(IQubitRecord* qubit) {
+  auto location = locations.find(qubit);
+  if (location == locations.end()) return false;
+  auto& [partner_addr, rule_id, sequence_number] = location->second;
+  auto& group = groups.at({partner_addr, rule_id});
+  // keep the assigned order, the qubits are picked by their index in the group
+  auto entry = findEntry(group.entries, sequence_number);
+  group.by_age.erase({entry->entangled_time, sequence_number});
+  group.entries.erase(entry);
+  if (--partner_counts[partner_addr] == 0) partner_counts.erase(partner_addr);
+  locations.erase(location);
+  return true;
+}
+
+std::size_t QubitResources::countOf(QNodeAddr partner_addr) const {
+  auto it = partner_counts.find(partner_addr);
+  return it != partner_counts.end() ? it->second : 0;
+}
+
+std::size_t QubitResources::countOf(QNodeAddr partner_addr, RuleId rule_id) const {
+  auto it = groups.find({partner_addr, rule_id});
+  return it != groups.end() ? it->second.entries.size() : 0;
+}
+
+const QubitResources::Location* QubitResources::find(IQubitRecord* qubit) const {
+  auto it = locations.find(qubit);
+  return it != locations.end() ? &it->second : nullptr;
+}
+
+IQubitRecord* QubitResources::findBySequenceNumber(QNodeAddr partner_addr, RuleId rule_id, SequenceNumber sequence_number) const {
+  auto* entries = qubitsOf(partner_addr, rule_id);
+  if (entries == nullptr) return nullptr;
+  auto it = findEntry(*entries, sequence_number);
+  if (it == entries->end() || it->sequence_number != sequence_number) return nullptr;
+  return it->qubit;
+}
+
+const QubitResources::Entries* QubitResources::qubitsOf(QNodeAddr partner_addr, RuleId rule_id) const {
+  auto it = groups.find({partner_addr, rule_id});
+  return it != groups.end() ? &it->second.entries : nullptr;
+}
+
+const QubitResources::AgeIndex* QubitResources::qubitsByAgeOf(QNodeAddr partner_addr, RuleId rule_id) const {
+  auto it = groups.find({partner_addr, rule_id});
+  return it != groups.end() ? &it->second.by_age : nullptr;
+}
+
+std::size_t QubitResources::allocatedBytes() const {
+  std::size_t bytes = utils::heapBytesOf(groups) + utils::heapBytesOf(locations) + utils::heapBytesOf(partner_counts);
+  for (auto& [key, group] : groups) bytes += utils::heapBytesOf(group.entries) + utils::heapBytesOf(group.by_age);
+  return bytes;
+}
+
+}  // namespace quisp::runtime
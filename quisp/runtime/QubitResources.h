@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <memory_resource>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "types.h"
+
+namespace quisp::runtime {
+
+/**
+ * @brief the entangled qubits assigned to a RuleSet, grouped by (partner's QNodeAddr, RuleId).
+ *
+ * Each group keeps its qubits in the order they were assigned, with the sequence number
+ * of each assignment. A reverse map from the qubit record to its group and sequence number
+ * lets the Runtime find, promote and free a qubit without scanning all the qubits.
+ * Each group also orders its qubits by their entangled time, for the age based selection.
+ * The groups and the indexes take their nodes from the memory resource given at the construction, see utils/MemoryResource.h.
+ */
+class QubitResources {
+ public:
+  using Key = std::pair<QNodeAddr, RuleId>;
+
+  struct Entry {
+    IQubitRecord* qubit;
+    SequenceNumber sequence_number;
+    // the entangled time when the qubit was assigned, the key of the age index
+    Time entangled_time;
+  };
+
+  /// @brief the qubits of a group by (entangled time, sequence number), the oldest Bell pair first.
+  using AgeIndex = std::pmr::map<std::pair<Time, SequenceNumber>, IQubitRecord*>;
+  using Entries = std::pmr::vector<Entry>;
+
+  /// @brief where the qubit is assigned.
+  struct Location {
+    QNodeAddr partner_addr;
+    RuleId rule_id;
+    SequenceNumber sequence_number;
+  };
+
+  explicit QubitResources(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+  /**
+   * @brief assign the qubit to the rule with the next sequence number of the (partner_addr, rule_id) pair.
+   * If the qubit is already assigned, it's moved.
+   *
+   * @return the sequence number of the qubit
+   */
+  SequenceNumber insert(QNodeAddr partner_addr, RuleId rule_id, IQubitRecord* qubit);
+
+  /// @brief remove the qubit, returns false if the qubit is not assigned.
+  bool erase(IQubitRecord* qubit);
+
+  /// @brief returns the location of the qubit, or nullptr if the qubit is not assigned.
+  const Location* find(IQubitRecord* qubit) const;
+
+  /// @brief returns the qubit with the sequence number, or nullptr if there is no such qubit.
+  IQubitRecord* findBySequenceNumber(QNodeAddr partner_addr, RuleId rule_id, SequenceNumber sequence_number) const;
+
+  /// @brief returns the qubits assigned to the rule with the partner in the assigned order, or nullptr if there is none.
+  const Entries* qubitsOf(QNodeAddr partner_addr, RuleId rule_id) const;
+
+  /// @brief returns the qubits assigned to the rule with the partner by their entangled time, or nullptr if there is none.
+  const AgeIndex* qubitsByAgeOf(QNodeAddr partner_addr, RuleId rule_id) const;
+
+  /// @brief calls f(partner_addr, rule_id, qubit) for each qubit.
+  template <typename F>
+  void forEach(F f) const {
+    for (auto& [key, group] : groups) {
+      for (auto& entry : group.entries) f(key.first, key.second, entry.qubit);
+    }
+  }
+
+  /// @brief the number of the qubits entangled with the partner.
+  std::size_t countOf(QNodeAddr partner_addr) const;
+
+  /// @brief the number of the qubits assigned to the rule with the partner.
+  std::size_t countOf(QNodeAddr partner_addr, RuleId rule_id) const;
+
+  std::size_t size() const { return locations.size(); }
+  bool empty() const { return locations.empty(); }
+  /// @brief the approximate heap bytes of the groups and the indexes, see utils/MemoryUsage.h.
+  std::size_t allocatedBytes() const;
+
+ private:
+  struct Group {
+    // the containers of the group take the resource of the map it's in
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+    explicit Group(const allocator_type& alloc = {}) : entries(alloc), by_age(alloc) {}
+    Group(const Group& other, const allocator_type& alloc) : entries(other.entries, alloc), by_age(other.by_age, alloc), last_sequence_number(other.last_sequence_number) {}
+    Group(Group&& other, const allocator_type& alloc)
+        : entries(std::move(other.entries), alloc), by_age(std::move(other.by_age), alloc), last_sequence_number(other.last_sequence_number) {}
+
+    // sorted by the sequence number
+    Entries entries;
+    AgeIndex by_age;
+    // the latest sequence number assigned in this group
+    SequenceNumber last_sequence_number = 0;
+  };
+
+  std::pmr::unordered_map<Key, Group> groups;
+  std::pmr::unordered_map<IQubitRecord*, Location> locations;
+  std::pmr::unordered_map<QNodeAddr, std::size_t> partner_counts;
+};
+
+}  // namespace quisp::runtime
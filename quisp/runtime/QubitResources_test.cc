@@ -0,0 +1,89 @@
+#include "QubitResources.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "modules/QRSA/RuleEngine/QubitRecord/QubitRecord.h"
+
+namespace {
+using namespace quisp::runtime;
+using quisp::modules::QNIC_E;
+using omnetpp::SimTime;
+using quisp::modules::qubit_record::QubitRecord;
+
+TEST(QubitResourcesTest, InsertAndErase) {
+  QubitResources qubits;
+  QubitRecord q0{QNIC_E, 0, 0}, q1{QNIC_E, 0, 1}, q2{QNIC_E, 0, 2};
+  EXPECT_EQ(qubits.insert(1, 0, &q0), 1);
+  EXPECT_EQ(qubits.insert(1, 0, &q1), 2);
+  EXPECT_EQ(qubits.insert(1, 0, &q2), 3);
+  EXPECT_EQ(qubits.size(), 3);
+  EXPECT_EQ(qubits.countOf(1), 3);
+
+  // erasing keeps the assigned order
+  EXPECT_TRUE(qubits.erase(&q1));
+  auto* entries = qubits.qubitsOf(1, 0);
+  ASSERT_NE(entries, nullptr);
+  ASSERT_EQ(entries->size(), 2);
+  EXPECT_EQ(entries->at(0).qubit, &q0);
+  EXPECT_EQ(entries->at(1).qubit, &q2);
+  EXPECT_EQ(qubits.findBySequenceNumber(1, 0, 2), nullptr);
+  EXPECT_EQ(qubits.findBySequenceNumber(1, 0, 3), &q2);
+  EXPECT_FALSE(qubits.erase(&q1));
+  EXPECT_EQ(qubits.find(&q1), nullptr);
+  EXPECT_EQ(qubits.countOf(1), 2);
+
+  // sequence numbers are not reused
+  EXPECT_EQ(qubits.insert(1, 0, &q1), 4);
+  EXPECT_EQ(qubits.size(), 3);
+}
+
+TEST(QubitResourcesTest, MoveQubit) {
+  QubitResources qubits;
+  QubitRecord q0{QNIC_E, 0, 0};
+  qubits.insert(1, 0, &q0);
+  EXPECT_EQ(qubits.insert(2, 1, &q0), 1);
+  EXPECT_EQ(qubits.size(), 1);
+  EXPECT_EQ(qubits.countOf(1), 0);
+  EXPECT_EQ(qubits.countOf(2), 1);
+  EXPECT_TRUE(qubits.qubitsOf(1, 0)->empty());
+  EXPECT_EQ(qubits.qubitsOf(3, 0), nullptr);
+  auto* location = qubits.find(&q0);
+  ASSERT_NE(location, nullptr);
+  EXPECT_EQ(location->partner_addr, 2);
+  EXPECT_EQ(location->rule_id, 1);
+  EXPECT_EQ(location->sequence_number, 1);
+  EXPECT_EQ(qubits.findBySequenceNumber(1, 0, 1), nullptr);
+  EXPECT_EQ(qubits.findBySequenceNumber(2, 1, 1), &q0);
+}
+
+TEST(QubitResourcesTest, OrderByEntangledTime) {
+  QubitResources qubits;
+  QubitRecord q0{QNIC_E, 0, 0}, q1{QNIC_E, 0, 1}, q2{QNIC_E, 0, 2};
+  // raw times, the tests don't set the SimTime scale
+  auto at = [](int64_t raw) { return SimTime().setRaw(raw); };
+  q0.setEntangledTime(at(3));
+  q1.setEntangledTime(at(1));
+  q2.setEntangledTime(at(3));
+  qubits.insert(1, 0, &q0);
+  qubits.insert(1, 0, &q1);
+  qubits.insert(1, 0, &q2);
+
+  // the pairs of the same age stay in the assigned order
+  auto* by_age = qubits.qubitsByAgeOf(1, 0);
+  ASSERT_NE(by_age, nullptr);
+  std::vector<IQubitRecord*> order;
+  for (auto& [key, qubit] : *by_age) order.push_back(qubit);
+  EXPECT_EQ(order, (std::vector<IQubitRecord*>{&q1, &q0, &q2}));
+
+  // a promoted qubit keeps its age in the next rule
+  qubits.insert(1, 1, &q0);
+  EXPECT_EQ(by_age->size(), 2);
+  EXPECT_EQ(qubits.qubitsByAgeOf(1, 1)->begin()->first.first, at(3));
+  qubits.erase(&q1);
+  EXPECT_EQ(by_age->begin()->second, &q2);
+  EXPECT_EQ(qubits.qubitsByAgeOf(2, 0), nullptr);
+}
+
+}  // namespace
@@ -1,4 +1,7 @@
 #include <algorithm>
+#include <sstream>
+#include <tuple>
+#include <type_traits>
 #include <unordered_map>
 #include <variant>
 
@@ -17,6 +20,26 @@ Program::Program(const std::string& name, const std::vector<InstructionTypes>& o
       label_map.insert({label, pc});
     }
   }
+  for (auto& instr : this->opcodes) {
+    forEachOperand<Label>(instr, [&](Label& label) {
+      auto it = label_map.find(label);
+      label.pc = it != label_map.end() ? it->second : -1;
+    });
+  }
+  lower();
+}
+
+void Program::lower() {
+  handlers.clear();
+  handlers.reserve(opcodes.size());
+  words.clear();
+  words.reserve(opcodes.size());
+  num_qubit_ids = 0;
+  for (auto& instr : opcodes) {
+    handlers.push_back(InstructionVisitor::handlerOf(instr));
+    words.push_back(InstructionVisitor::encode(instr));
+    forEachOperand<QubitId>(instr, [&](QubitId& qubit_id) { num_qubit_ids = std::max(num_qubit_ids, qubit_id.val + 1); });
+  }
 }
 
 void RuleSet::finalize() {
@@ -25,9 +48,16 @@ void RuleSet::finalize() {
     rules[i].id = i;
   }
 
+  // the first rule with the receive_tag gets the messages
+  receive_tag_rule_table.clear();
+  for (auto& rule : rules) {
+    receive_tag_rule_table.emplace(rule.receive_tag, rule.id);
+  }
+
   // collect partner addresses and initial rules
   partners = {};
   partner_initial_rule_table.clear();
+  next_rule_table.clear();
   std::unordered_map<QNodeAddr, std::vector<RuleId>> partner_rules{};
   for (auto rule_iter = rules.begin(); rule_iter != rules.end(); rule_iter++) {
     auto rule_id = rule_iter->id;
@@ -40,14 +70,116 @@ void RuleSet::finalize() {
     }
   }
 
+  // the dense partner indices follow the order of the partners
+  partner_addrs.assign(partners.begin(), partners.end());
+  initial_rules.assign(partner_addrs.size(), -1);
+  next_rules.assign(partner_addrs.size() * rules.size(), -1);
   for (auto& [partner_addr, rule_ids] : partner_rules) {
+    auto partner_index = partnerIndex(partner_addr);
     for (int i = 0; i < rule_ids.size() - 1; i++) {
       auto first_rule_id = rule_ids.at(i);
       auto second_rule_id = rule_ids.at(i + 1);
 
       next_rule_table.emplace(std::make_pair(partner_addr, first_rule_id), second_rule_id);
+      next_rules[partner_index * rules.size() + first_rule_id] = second_rule_id;
     }
     partner_initial_rule_table.emplace(partner_addr, rule_ids.at(0));
+    initial_rules[partner_index] = rule_ids.at(0);
+  }
+
+  // assign a memory slot to each MemoryKey, so the Runtime doesn't hash the key strings.
+  memory_keys.clear();
+  memory_slots.clear();
+  for (auto& rule : rules) {
+    resolveMemoryKeys(rule.condition);
+    resolveMemoryKeys(rule.action);
+    rule.condition.lower();
+    rule.action.lower();
+  }
+  resolveMemoryKeys(termination_condition);
+  termination_condition.lower();
+  analyzeTerminationCondition();
+}
+
+std::shared_ptr<const RuleSet> RuleSet::compile(const RuleSet& ruleset) {
+  auto compiled = std::make_shared<RuleSet>(ruleset);
+  compiled->finalize();
+  return compiled;
+}
+
+std::string RuleSet::contentKey() const {
+  std::stringstream ss;
+  auto write_program = [&](const Program& program) {
+    ss << program.name << '\n' << program.debugging << '\n';
+    for (auto& guard : program.qubit_count_guards) ss << "GUARD " << guard.partner_addr << ' ' << guard.min_count << '\n';
+    for (auto& instr : program.opcodes) {
+      ss << std::visit([](auto& op) { return op.toString(); }, instr) << '\n';
+    }
+  };
+  ss << name << '\n' << debugging << '\n' << qos_priority << ' ' << qos_min_share << '\n';
+  for (auto& rule : rules) {
+    ss << rule.name << '\n' << rule.send_tag << ' ' << rule.receive_tag << ' ' << rule.debugging << '\n';
+    write_program(rule.condition);
+    write_program(rule.action);
+  }
+  write_program(termination_condition);
+  return ss.str();
+}
+
+int RuleSet::internMemoryKey(const MemoryKey& key) {
+  auto [it, inserted] = memory_slots.emplace(key, memory_keys.size());
+  if (inserted) {
+    memory_keys.push_back(key);
+    memory_keys.back().slot = it->second;
+  }
+  return it->second;
+}
+
+int RuleSet::findMemorySlot(const MemoryKey& key) const {
+  auto it = memory_slots.find(key);
+  return it != memory_slots.end() ? it->second : -1;
+}
+
+void RuleSet::resolveMemoryKeys(Program& program) {
+  for (auto& instr : program.opcodes) {
+    forEachOperand<MemoryKey>(instr, [&](MemoryKey& key) { key.slot = internMemoryKey(key); });
+  }
+}
+
+void RuleSet::analyzeTerminationCondition() {
+  termination_reads_memory_only = true;
+  termination_memory_slots.assign(memory_keys.size(), false);
+  for (auto& instr : termination_condition.opcodes) {
+    auto opcode = std::visit([](auto& op) { return op.opcode; }, instr);
+    switch (opcode) {
+      // the registers are reset before each Program execution, so these only depend on the loaded values
+      case OpType::ADD:
+      case OpType::SUB:
+      case OpType::INC:
+      case OpType::SET:
+      case OpType::BITWISE_AND:
+      case OpType::BITWISE_OR:
+      case OpType::BITWISE_XOR:
+      case OpType::RET:
+      case OpType::JMP:
+      case OpType::BEQ:
+      case OpType::BEZ:
+      case OpType::BNZ:
+      case OpType::BNE:
+      case OpType::BLT:
+      case OpType::BGE:
+      case OpType::NOP:
+        break;
+      case OpType::LOAD:
+      case OpType::LOAD_LEFT_OP:
+      case OpType::LOAD_RIGHT_OP:
+        forEachOperand<MemoryKey>(instr, [&](MemoryKey& key) { termination_memory_slots[key.slot] = true; });
+        break;
+      default:
+        // e.g. the qubits, the messages or the callbacks
+        termination_reads_memory_only = false;
+        return;
+    }
   }
 }
 
@@ -57,6 +189,19 @@ void RuleSet::collectPartners(const RuleId rule_id, const InstructionTypes& inst
     auto [_qubit_id, partner_addr, _index] = std::get<INSTR_GET_QUBIT_QubitId_QNodeAddr_int_>(instr).args;
     partners.insert(partner_addr);
 
+    if (partner_rules.find(partner_addr) == partner_rules.end()) {
+      partner_rules.insert({partner_addr, {}});
+    }
+    auto& rule_ids = partner_rules.at(partner_addr);
+    // if the rule_id doesn't exist, add it
+    if (!std::binary_search(rule_ids.begin(), rule_ids.end(), rule_id)) {
+      rule_ids.push_back(rule_id);
+    }
+  } else if (std::holds_alternative<INSTR_GET_QUBIT_BRANCH_IF_FOUND_Label_QubitId_QNodeAddr_int_>(instr)) {
+    // fused GET_QUBIT, see ProgramOptimizer
+    auto [_label, _qubit_id, partner_addr, _index] = std::get<INSTR_GET_QUBIT_BRANCH_IF_FOUND_Label_QubitId_QNodeAddr_int_>(instr).args;
+    partners.insert(partner_addr);
+
     if (partner_rules.find(partner_addr) == partner_rules.end()) {
       partner_rules.insert({partner_addr, {}});
     }
@@ -1,14 +1,23 @@
 #pragma once
 
+#include <algorithm>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "InstructionVisitor.h"
 #include "opcode.h"
 #include "types.h"
 
 namespace quisp::runtime {
 
+/// @brief a necessary condition of a Program: the executing rule has at least min_count qubits with the partner assigned.
+struct QubitCountGuard {
+  QNodeAddr partner_addr;
+  int min_count;
+};
+
 /**
  * @brief The Program is a list of Instructions with metadata.
  * The Runtime can execute the Program.
@@ -20,10 +29,41 @@ class Program {
 
   std::vector<InstructionTypes> opcodes;
 
+  /**
+   * @brief the pre-decoded handler of each instruction in opcodes.
+   *
+   * The Runtime executes the Program by calling these handlers in order.
+   * Call lower() again after changing opcodes.
+   */
+  std::vector<InstructionHandler> handlers;
+
+  /**
+   * @brief the lowered encoding of each instruction in opcodes, 16 bytes each.
+   *
+   * The Runtime executes these words, and the wide ones from opcodes with their handlers.
+   * Call lower() again after resolving the Labels or MemoryKeys, or changing opcodes.
+   */
+  std::vector<InstructionWord> words;
+
+  /// @brief translates opcodes into handlers and words, and counts num_qubit_ids.
+  void lower();
+
+  /**
+   * @brief the guards the Runtime checks before executing the Program, e.g. the EnoughResource clauses of a condition.
+   *
+   * The Program fails without executing any instruction if one of them fails, and the rule waits for a qubit with its partner.
+   * Locked qubits still count, so the Program itself makes the final decision.
+   */
+  std::vector<QubitCountGuard> qubit_count_guards;
+
+  /// @brief one more than the largest QubitId operand, the Runtime makes the slots of the named qubits for them up front.
+  int num_qubit_ids = 0;
+
   /**
    * @brief the map to find instruction index (pc) by label.
    *
-   * The Runtime uses this to jump / branch its execution.
+   * The constructor resolves the Label operands of the instructions with this,
+   * so the Runtime jumps / branches its execution without looking it up.
    */
   LabelMap label_map;
 
@@ -86,9 +126,62 @@ class RuleSet {
   /// @brief analyzes its rules and instructions to collect informations for execution.
   void finalize();
 
+  /**
+   * @brief returns a finalized copy of the given RuleSet.
+   *
+   * The Runtimes only read the compiled RuleSet, so the Runtimes executing
+   * the same RuleSet can share one. See also contentKey().
+   */
+  static std::shared_ptr<const RuleSet> compile(const RuleSet& ruleset);
+
+  /**
+   * @brief returns a string that describes everything the Runtime executes in this RuleSet.
+   *
+   * The RuleSets with the same key compile to the same RuleSet except for the id and the owner_addr.
+   */
+  std::string contentKey() const;
+
+  /**
+   * @brief returns the memory slot of the key, and adds a new slot if the key is not used in this RuleSet yet.
+   *
+   * finalize() resolves the MemoryKey operands of the instructions with this.
+   */
+  int internMemoryKey(const MemoryKey& key);
+
+  /// @brief returns the memory slot of the key, -1 if no slot is assigned to the key.
+  int findMemorySlot(const MemoryKey& key) const;
+
   /// @brief the partner(connection participating nodes) QNodeAddrs used in this RuleSet.
   std::set<QNodeAddr> partners;
 
+  /// @brief the partners in order, the position of a partner is its dense index in this RuleSet.
+  std::vector<QNodeAddr> partner_addrs;
+
+  /// @brief returns the dense index of the partner, -1 if the partner is not in this RuleSet.
+  int partnerIndex(QNodeAddr partner_addr) const {
+    auto it = std::lower_bound(partner_addrs.begin(), partner_addrs.end(), partner_addr);
+    return it != partner_addrs.end() && *it == partner_addr ? it - partner_addrs.begin() : -1;
+  }
+
+  /// @brief see partner_initial_rule_table, -1 if the partner is not in this RuleSet.
+  RuleId initialRule(QNodeAddr partner_addr) const {
+    auto partner_index = partnerIndex(partner_addr);
+    return partner_index >= 0 ? initial_rules[partner_index] : -1;
+  }
+
+  /// @brief see next_rule_table, -1 if the partner's qubit has no rule after rule_id.
+  RuleId nextRule(QNodeAddr partner_addr, RuleId rule_id) const {
+    auto partner_index = partnerIndex(partner_addr);
+    if (partner_index < 0 || rule_id < 0 || rule_id >= rules.size()) return -1;
+    return next_rules[partner_index * rules.size() + rule_id];
+  }
+
+  /// @brief [partner_index] => the first rule of the partner, the table of initialRule().
+  std::vector<RuleId> initial_rules;
+
+  /// @brief [partner_index * rules.size() + rule_id] => the next rule of the partner, the table of nextRule().
+  std::vector<RuleId> next_rules;
+
   /**
    * @brief This contains a list of pairs of the rule_id and partner's QNodeAddr.
    *
@@ -97,18 +190,37 @@ class RuleSet {
    */
   std::unordered_map<QNodeAddr, RuleId> partner_initial_rule_table;
 
+  /**
+   * @brief [receive_tag] => [rule_id] of the rule that waits for the messages with the shared rule tag.
+   *
+   * The Runtime assigns the received message to the rule by looking up this map.
+   */
+  std::unordered_map<int, RuleId> receive_tag_rule_table;
+
   /**
    * @brief contains the next rule ids corresponding to the current partner and
    * rule id like: (partner_addr, current_rule_id): next_rule_id
    */
   std::unordered_map<std::pair<QNodeAddr, RuleId>, RuleId> next_rule_table = {};
 
+  /// @brief the memory slots of the MemoryKeys used in this RuleSet, the index is the slot.
+  std::vector<MemoryKey> memory_keys;
+
+  /// @brief the map to find the memory slot by its key.
+  std::unordered_map<MemoryKey, int> memory_slots;
+
   /// @brief the RuleSet id
   unsigned long id;
 
   /// @brief the owner's QNode address.
   int owner_addr;
 
+  /// @brief the QoS class of the connection, see qos_arbiter::QosArbiter. The RuleEngine gives the pairs to the higher priority first.
+  int qos_priority = 0;
+
+  /// @brief the share of the contended pairs the RuleSet is guaranteed, in [0, 1].
+  double qos_min_share = 0;
+
   /// @brief the RuleSet name for debugging.
   std::string name;
 
@@ -117,6 +229,18 @@ class RuleSet {
 
   /// @brief the Program to check the RuleSet is terminated or not.
   Program termination_condition;
+
+  /**
+   * @brief true if the termination_condition only depends on the memory, e.g. the MeasureCount check.
+   *
+   * finalize() determines this. Then the Runtime executes the termination_condition
+   * again only after one of the termination_memory_slots is stored, instead of after every action.
+   */
+  bool termination_reads_memory_only = false;
+
+  /// @brief termination_memory_slots[slot] is true if the termination_condition loads the memory slot.
+  std::vector<bool> termination_memory_slots;
+
   bool debugging = false;
 
  protected:
@@ -126,5 +250,11 @@ class RuleSet {
    */
   static inline void collectPartners(const RuleId rule_id, const InstructionTypes& instr, std::set<QNodeAddr>& partners,
                                      std::unordered_map<QNodeAddr, std::vector<RuleId>>& partner_rules);
+
+  /// @brief an internal method to assign memory slots to the MemoryKeys in the given Program.
+  void resolveMemoryKeys(Program& program);
+
+  /// @brief an internal method to collect the memory slots the termination_condition depends on.
+  void analyzeTerminationCondition();
 };
 }  // namespace quisp::runtime
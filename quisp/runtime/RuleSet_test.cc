@@ -140,5 +140,94 @@ TEST(RuntimeRuleSetTest, ThreeRule) {
     it = rs.next_rule_table.find({partner2, 1});
     EXPECT_EQ(it->second, 2);
   }
+
+  // the same tables by the dense partner indices
+  EXPECT_EQ(rs.partner_addrs, (std::vector<QNodeAddr>{partner1, partner2, partner3}));
+  EXPECT_EQ(rs.partnerIndex(partner3), 2);
+  EXPECT_EQ(rs.partnerIndex(QNodeAddr{4}), -1);
+  EXPECT_EQ(rs.initialRule(partner2), 1);
+  EXPECT_EQ(rs.initialRule(QNodeAddr{4}), -1);
+  EXPECT_EQ(rs.nextRule(partner1, 0), 2);
+  EXPECT_EQ(rs.nextRule(partner2, 0), -1);
+  EXPECT_EQ(rs.nextRule(partner2, 1), 2);
+  EXPECT_EQ(rs.nextRule(partner3, 2), -1);
+}
+
+TEST(RuntimeRuleSetTest, ResolveLabelsAndMemoryKeys) {
+  MemoryKey count{"count"};
+  MemoryKey outcome{"outcome"};
+  Label end{"end"};
+  auto r0 = RegId::REG0;
+  RuleSet rs{"test ruleset",
+             {
+                 Rule{Program{"condition",
+                              {
+                                  INSTR_LOAD_RegId_MemoryKey_{{r0, count}},
+                                  INSTR_BEZ_Label_RegId_{{end, r0}},
+                                  INSTR_STORE_MemoryKey_int_{{count, 0}},
+                                  INSTR_NOP_None_{nullptr, end},
+                              }},
+                      Program{"action", {INSTR_STORE_MemoryKey_int_{{outcome, 1}}}}},
+             },
+             Program{"termination", {INSTR_LOAD_RegId_MemoryKey_{{r0, count}}}}};
+  rs.finalize();
+
+  // the label is resolved to the index of the NOP instruction
+  auto& condition = rs.rules[0].condition.opcodes;
+  EXPECT_EQ(std::get<0>(std::get<INSTR_BEZ_Label_RegId_>(condition[1]).args).pc, 3);
+
+  // the same key has the same slot in all the Programs
+  EXPECT_EQ(rs.memory_keys.size(), 2);
+  EXPECT_EQ(rs.findMemorySlot(count), 0);
+  EXPECT_EQ(rs.findMemorySlot(outcome), 1);
+  EXPECT_EQ(rs.findMemorySlot(MemoryKey{"unknown"}), -1);
+  EXPECT_EQ(std::get<1>(std::get<INSTR_LOAD_RegId_MemoryKey_>(condition[0]).args).slot, 0);
+  EXPECT_EQ(std::get<0>(std::get<INSTR_STORE_MemoryKey_int_>(condition[2]).args).slot, 0);
+  EXPECT_EQ(std::get<0>(std::get<INSTR_STORE_MemoryKey_int_>(rs.rules[0].action.opcodes[0]).args).slot, 1);
+  EXPECT_EQ(std::get<1>(std::get<INSTR_LOAD_RegId_MemoryKey_>(rs.termination_condition.opcodes[0]).args).slot, 0);
+  EXPECT_EQ(rs.memory_keys[1].val, "outcome");
+
+  // the termination condition only loads the count
+  EXPECT_TRUE(rs.termination_reads_memory_only);
+  EXPECT_EQ(rs.termination_memory_slots, (std::vector<bool>{true, false}));
+}
+
+TEST(RuntimeRuleSetTest, TerminationConditionWithQubit) {
+  RuleSet rs{"test ruleset", {}, Program{"termination", {INSTR_GET_QUBIT_QubitId_QNodeAddr_int_{{QubitId{0}, QNodeAddr{1}, 0}}}}};
+  rs.finalize();
+  EXPECT_FALSE(rs.termination_reads_memory_only);
+}
+
+TEST(RuntimeRuleSetTest, LowerProgram) {
+  auto r0 = RegId::REG0;
+  Program program{"program", {INSTR_SET_RegId_int_{{r0, 1}}, INSTR_INC_RegId_{r0}, INSTR_RET_ReturnCode_{{ReturnCode::COND_PASSED}}}};
+  ASSERT_EQ(program.handlers.size(), 3);
+  for (int i = 0; i < 3; i++) {
+    EXPECT_EQ(program.handlers[i], InstructionVisitor::handlerOf(program.opcodes[i]));
+  }
+  EXPECT_NE(program.handlers[0], program.handlers[1]);
+
+  program.opcodes.push_back(INSTR_INC_RegId_{r0});
+  program.lower();
+  ASSERT_EQ(program.handlers.size(), 4);
+  EXPECT_EQ(program.handlers[3], program.handlers[1]);
+}
+
+TEST(RuntimeRuleSetTest, LowerProgramIntoWords) {
+  auto r0 = RegId::REG0;
+  Program program{"program",
+                  {INSTR_GET_QUBIT_BRANCH_IF_FOUND_Label_QubitId_QNodeAddr_int_{{Label{"found"}, QubitId{2}, QNodeAddr{12345}, -7}},
+                   INSTR_ERROR_String_{{"not found"}}, INSTR_LOAD_RegId_MemoryKey_{{r0, MemoryKey{"count"}}}, INSTR_RET_ReturnCode_{{ReturnCode::COND_PASSED}, Label{"found"}}}};
+  ASSERT_EQ(program.words.size(), 4);
+  for (int i = 0; i < 4; i++) EXPECT_EQ(program.words[i].alternative, program.opcodes[i].index());
+  EXPECT_FALSE(program.words[0].wide);
+  EXPECT_TRUE(program.words[1].wide);
+  // the key without slot is looked up by its name, from opcodes
+  EXPECT_TRUE(program.words[2].wide);
+  EXPECT_FALSE(program.words[3].wide);
+
+  RuleSet rs{"test ruleset", {Rule{"rule", -1, -1, program, Program{"empty", {}}}}};
+  rs.finalize();
+  EXPECT_FALSE(rs.rules[0].condition.words[2].wide);
 }
 }  // namespace
@@ -1,107 +1,264 @@
 #include "Runtime.h"
 
+#include <algorithm>
+#include <chrono>
 #include <omnetpp.h>
 
 namespace quisp::runtime {
 
-Runtime::Runtime(const Runtime& rt) : Runtime() {
+Runtime::Runtime(const Runtime& rt)
+    : visitor(InstructionVisitor{this}),
+      memory_resource(rt.memory_resource.getStrategy()),
+      qubits(memory_resource.get()),
+      messages(memory_resource.get()),
+      memory(memory_resource.get()) {
   visitor = rt.visitor;
   visitor.runtime = this;
   callback = rt.callback;
   rule_id = rt.rule_id;
   qubits = rt.qubits;
-  resource_counter = rt.resource_counter;
-  sequence_number_to_qubit = rt.sequence_number_to_qubit;
-  qubit_to_sequence_number = rt.qubit_to_sequence_number;
-  shared_tag_to_rule_id = rt.shared_tag_to_rule_id;
-  rule_id_to_shared_tag = rt.rule_id_to_shared_tag;
   messages = rt.messages;
+  rule_waits = rt.rule_waits;
   memory = rt.memory;
+  local_memory_keys = rt.local_memory_keys;
+  local_memory_slots = rt.local_memory_slots;
   ruleset = rt.ruleset;
+  ruleset_id = rt.ruleset_id;
+  profile = rt.profile;
+  trace = rt.trace;
+  qubit_selection_policy = rt.qubit_selection_policy;
   partners = rt.partners;
   terminated = rt.terminated;
+  keep_alive = rt.keep_alive;
+  parked = rt.parked;
+  action_budget = rt.action_budget;
+  resume_rule_index = rt.resume_rule_index;
+  yielded = rt.yielded;
+  dirty = rt.dirty;
+  termination_dirty = rt.termination_dirty;
   debugging = rt.debugging;
 }
 
-Runtime::Runtime() : visitor(InstructionVisitor{this}) {}
+Runtime::Runtime() : visitor(InstructionVisitor{this}), ruleset(std::make_shared<const RuleSet>()) {}
 Runtime::Runtime(const RuleSet& ruleset, ICallBack* cb) : visitor(InstructionVisitor{this}), callback(cb) { assignRuleSet(ruleset); }
+Runtime::Runtime(std::shared_ptr<const RuleSet> ruleset, unsigned long ruleset_id, ICallBack* cb, utils::MemoryResourceStrategy memory_resource_strategy)
+    : visitor(InstructionVisitor{this}),
+      callback(cb),
+      memory_resource(memory_resource_strategy),
+      qubits(memory_resource.get()),
+      messages(memory_resource.get()),
+      memory(memory_resource.get()) {
+  assignRuleSet(std::move(ruleset), ruleset_id);
+}
 Runtime& Runtime::operator=(Runtime&& rt) {
   visitor = rt.visitor;
   visitor.runtime = this;
   callback = rt.callback;
   rule_id = rt.rule_id;
   qubits = std::move(rt.qubits);
-  resource_counter = std::move(rt.resource_counter);
-  sequence_number_to_qubit = std::move(rt.sequence_number_to_qubit);
-  qubit_to_sequence_number = std::move(rt.qubit_to_sequence_number);
-  shared_tag_to_rule_id = std::move(rt.shared_tag_to_rule_id);
-  rule_id_to_shared_tag = std::move(rt.rule_id_to_shared_tag);
   messages = std::move(rt.messages);
+  rule_waits = std::move(rt.rule_waits);
   memory = std::move(rt.memory);
+  local_memory_keys = std::move(rt.local_memory_keys);
+  local_memory_slots = std::move(rt.local_memory_slots);
   ruleset = std::move(rt.ruleset);
+  ruleset_id = rt.ruleset_id;
+  profile = rt.profile;
+  trace = rt.trace;
+  qubit_selection_policy = rt.qubit_selection_policy;
   partners = std::move(rt.partners);
   terminated = rt.terminated;
+  keep_alive = rt.keep_alive;
+  parked = rt.parked;
+  action_budget = rt.action_budget;
+  resume_rule_index = rt.resume_rule_index;
+  yielded = rt.yielded;
+  dirty = rt.dirty;
+  termination_dirty = rt.termination_dirty;
   debugging = rt.debugging;
   return *this;
 }
 Runtime::~Runtime() {}
 
 void Runtime::exec() {
-  if (terminated) return;
+  if (terminated || parked) return;
+  // the changes made by this execution mark the Runtime dirty again
+  dirty = false;
   cleanup();
-  debugging = ruleset.debugging;
-  if (debugging) {
-    std::cout << "Run RuleSet: " << ruleset.name << "\n";
-  }
-  for (auto& rule : ruleset.rules) {
+  debugging = ruleset->debugging;
+  active_trace = selectTrace(-1);
+  if (active_trace != nullptr) active_trace->write(TraceEvent{ruleset_id, -1, 0, TraceEventType::ExecRuleSet});
+  auto& rules = ruleset->rules;
+  // the Runtime that ran out of its budget carries on from the rule it stopped at
+  auto first_rule = resume_rule_index < rules.size() ? resume_rule_index : 0;
+  resume_rule_index = 0;
+  yielded = false;
+  int num_actions = 0;
+  for (size_t k = 0; k < rules.size(); k++) {
+    auto rule_index = (first_rule + k) % rules.size();
+    auto& rule = rules[rule_index];
     rule_id = rule.id;
     send_tag = rule.send_tag;
     receive_tag = rule.receive_tag;
-    debugging = rule.debugging || ruleset.debugging;
+    debugging = rule.debugging || ruleset->debugging;
+    active_trace = selectTrace(rule.id);
+    if (isRuleSuspended(rule.id)) continue;
     while (true) {
-      if (debugging) {
-        debugRuntimeState();
-        std::cout << "Run Rule(" << rule.id << "): " << rule.name << ", " << callback->getNodeInfo() << "\n";
+      if (action_budget > 0 && num_actions == action_budget) {
+        resume_rule_index = rule_index;
+        yielded = true;
+        dirty = true;
+        return;
       }
-      execProgram(rule.condition);
-      if (debugging) std::cout << return_code << std::endl;
+      if (active_trace != nullptr) writeTrace(TraceEventType::ExecRule);
+      RuleWait* wait = rule.id >= 0 && rule.id < (int)rule_waits.size() ? &rule_waits[rule.id] : nullptr;
+      if (wait != nullptr) {
+        wait->on_message = false;
+        wait->on_qubits.clear();
+      }
+      if (passesQubitCountGuards(rule.condition)) {
+        execProgram(rule.condition);
+      } else {
+        return_code = ReturnCode::COND_FAILED;
+      }
+      if (active_trace != nullptr) writeTrace(TraceEventType::ConditionResult, {static_cast<std::int32_t>(return_code)});
+      if (profile != nullptr) profile->countCondition(ruleset->name, rule.name, return_code != ReturnCode::COND_FAILED);
       if (return_code == ReturnCode::COND_FAILED) {
+        if (wait != nullptr) wait->suspended = wait->on_message || !wait->on_qubits.empty();
         break;
       }
       execProgram(rule.action);
-      execProgram(ruleset.termination_condition);
-      if (return_code == ReturnCode::RS_TERMINATED) {
-        terminated = true;
-        return;
+      num_actions++;
+      // the result can't change until the memory it depends on is stored
+      if (!ruleset->termination_reads_memory_only || termination_dirty) {
+        execProgram(ruleset->termination_condition);
+        if (return_code == ReturnCode::RS_TERMINATED) {
+          if (keep_alive) {
+            parked = true;
+            callback->notifyRuleSetParked(ruleset_id);
+            return;
+          }
+          terminated = true;
+          callback->notifyRuleSetTerminated(ruleset_id);
+          return;
+        }
+        termination_dirty = false;
       }
     }
   }
 }
 
+void Runtime::terminate() {
+  if (terminated) return;
+  terminated = true;
+  // the RuntimeManager looks at the dirty Runtimes only
+  dirty = true;
+  callback->notifyRuleSetTerminated(ruleset_id);
+}
+
+void Runtime::rearm(int demand) {
+  if (terminated) return;
+  auto& termination_slots = ruleset->termination_memory_slots;
+  for (size_t slot = 0; slot < termination_slots.size() && slot < memory.size(); slot++) {
+    if (!termination_slots[slot] || !memory[slot].has_value() || memory[slot]->type != ValueType::INT) continue;
+    memory[slot] = MemoryValue{memory[slot]->intValue() - demand};
+  }
+  parked = false;
+  dirty = true;
+  termination_dirty = true;
+}
+
 void Runtime::execProgram(const Program& program) {
-  label_map = &program.label_map;
+  if (program.debugging || active_trace != nullptr) {
+    execProgramWithDebug(program);
+  } else if (profile != nullptr) {
+    execProgramWithProfile(program);
+  } else {
+    auto* opcodes = program.opcodes.data();
+    auto* handlers = program.handlers.data();
+    auto* words = program.words.data();
+    auto len = program.opcodes.size();
+    assert(program.handlers.size() == len && program.words.size() == len && "the Program must be lowered after changing its opcodes");
+
+    cleanup();
+    named_qubits.reserve(program.num_qubit_ids);
+    for (pc = 0; pc < len && !should_exit; pc++) {
+      if (words[pc].wide) {
+        handlers[pc](visitor, opcodes[pc]);
+      } else {
+        visitor.execute(words[pc]);
+      }
+    }
+  }
+
+  if (return_code == ReturnCode::ERROR) {
+    std::cout << "Uncaught Error >>>>>> " << callback->getNodeInfo() << std::endl;
+    debugRuntimeState();
+    debugSource(program);
+    throw std::runtime_error("uncaught error");
+  }
+}
+
+void Runtime::execProgramWithDebug(const Program& program) {
   auto& opcodes = program.opcodes;
   auto len = opcodes.size();
 
+  auto* program_trace = active_trace != nullptr ? active_trace : &RuntimeTrace::debugTrace();
   cleanup();
   for (pc = 0; pc < len; pc++) {
     if (should_exit) break;
-    if (program.debugging || debugging) {
-      debugSource(program);
-      debugRuntimeState();
-    }
+    // a jump moves the pc, so the event takes the pc of the instruction
+    auto executed_pc = pc;
     execInstruction(opcodes[pc]);
+    TraceEvent event{ruleset_id, rule_id, executed_pc, TraceEventType::Instruction};
+    event.opcode = std::visit([](auto& op) { return op.opcode; }, opcodes[executed_pc]);
+    for (int i = 0; i < 5; i++) event.values[i] = registers[i].value;
+    program_trace->write(event);
   }
+}
 
-  if (program.debugging || debugging) {
-    debugRuntimeState();
+RuntimeTrace* Runtime::selectTrace(RuleId rule_id) const {
+  if (trace != nullptr && trace->traces(ruleset_id, rule_id)) return trace;
+  return debugging ? &RuntimeTrace::debugTrace() : nullptr;
+}
+
+void Runtime::writeTrace(TraceEventType type, std::initializer_list<std::int32_t> values, std::uint16_t opcode) {
+  TraceEvent event{ruleset_id, rule_id, pc, type, opcode};
+  std::copy_n(values.begin(), std::min<std::size_t>(values.size(), 5), event.values);
+  (active_trace != nullptr ? active_trace : &RuntimeTrace::debugTrace())->write(event);
+}
+
+void Runtime::execProgramWithProfile(const Program& program) {
+  auto& opcodes = program.opcodes;
+  auto& handlers = program.handlers;
+  auto& words = program.words;
+  auto len = opcodes.size();
+  bool sampled = profile->shouldSample();
+  auto start = sampled ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+
+  cleanup();
+  for (pc = 0; pc < len && !should_exit; pc++) {
+    profile->countInstruction(words[pc].alternative);
+    if (words[pc].wide) {
+      handlers[pc](visitor, opcodes[pc]);
+    } else {
+      visitor.execute(words[pc]);
+    }
   }
 
-  if (return_code == ReturnCode::ERROR) {
-    std::cout << "Uncaught Error >>>>>> " << callback->getNodeInfo() << std::endl;
-    debugRuntimeState();
-    debugSource(program);
-    throw std::runtime_error("uncaught error");
+  if (sampled) {
+    auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    std::string key = ruleset->name;
+    if (&program == &ruleset->termination_condition) {
+      key += "/termination";
+    } else if (rule_id >= 0 && rule_id < (int)ruleset->rules.size() && &program == &ruleset->rules[rule_id].condition) {
+      key += "/" + ruleset->rules[rule_id].name + "/condition";
+    } else if (rule_id >= 0 && rule_id < (int)ruleset->rules.size() && &program == &ruleset->rules[rule_id].action) {
+      key += "/" + ruleset->rules[rule_id].name + "/action";
+    } else {
+      key += "/" + program.name;
+    }
+    profile->addSampledTime(key, time);
   }
 }
 
@@ -119,139 +276,231 @@ void Runtime::cleanup() {
 
 void Runtime::execInstruction(const InstructionTypes& instruction) { std::visit(visitor, instruction); }
 
-void Runtime::assignRuleSet(const RuleSet& rs) {
-  ruleset = rs;
-  ruleset.finalize();
-  partners = ruleset.partners;
-}
-
-void Runtime::assignMessageToRuleSet(int shared_rule_tag, MessageRecord& msg_content) {
-  // Currently using for loops with assumption that messages deque size is small, if it is large bimap might be better. need further investigation.
-  for (auto& rule : ruleset.rules) {
-    if (rule.receive_tag == shared_rule_tag) {
-      messages[rule.id].emplace_back(msg_content);
-      return;
-    }
-  }
+void Runtime::assignRuleSet(const RuleSet& rs) { assignRuleSet(RuleSet::compile(rs), rs.id); }
+
+void Runtime::assignRuleSet(std::shared_ptr<const RuleSet> rs, unsigned long rs_id) {
+  ruleset = std::move(rs);
+  ruleset_id = rs_id;
+  partners = ruleset->partner_addrs;
+  memory.assign(ruleset->memory_keys.size(), std::nullopt);
+  rule_waits.assign(ruleset->rules.size(), RuleWait{});
+  local_memory_keys.clear();
+  local_memory_slots.clear();
+  dirty = true;
+  termination_dirty = true;
+}
+
+void Runtime::extendRuleSet(std::shared_ptr<const RuleSet> rs) {
+  // the last rule of each partner in the old RuleSet, where the held qubits came from
+  std::unordered_map<QNodeAddr, RuleId> last_rules;
+  for (auto partner_addr : ruleset->partner_addrs) {
+    auto rule_id = ruleset->initialRule(partner_addr);
+    if (rule_id < 0) continue;
+    for (auto next = ruleset->nextRule(partner_addr, rule_id); next >= 0; next = ruleset->nextRule(partner_addr, rule_id)) rule_id = next;
+    last_rules[partner_addr] = rule_id;
+  }
+  std::vector<std::pair<QNodeAddr, IQubitRecord*>> held_qubits;
+  qubits.forEach([&](QNodeAddr partner_addr, RuleId rule_id, IQubitRecord* qubit) {
+    if (rule_id == held_rule_id) held_qubits.emplace_back(partner_addr, qubit);
+  });
+
+  // the local memory slots follow the slots of the RuleSet, so they move behind the new ones
+  std::vector<std::pair<MemoryKey, MemoryValue>> local_values;
+  for (auto& key : local_memory_keys) {
+    auto slot = local_memory_slots.at(key);
+    if (slot < memory.size() && memory[slot].has_value()) local_values.emplace_back(key, *memory[slot]);
+  }
+  memory.resize(ruleset->memory_keys.size());
+  local_memory_keys.clear();
+  local_memory_slots.clear();
+
+  ruleset = std::move(rs);
+  partners = ruleset->partner_addrs;
+  memory.resize(ruleset->memory_keys.size(), std::nullopt);
+  for (auto& [key, value] : local_values) storeVal(key, value);
+  // the new rules may take the inputs the suspended Rules waited for
+  rule_waits.assign(ruleset->rules.size(), RuleWait{});
+  for (auto [partner_addr, qubit] : held_qubits) {
+    auto last = last_rules.find(partner_addr);
+    if (last == last_rules.end()) continue;
+    auto next = ruleset->nextRule(partner_addr, last->second);
+    if (next >= 0) insertQubit(partner_addr, next, qubit);
+  }
+  dirty = true;
+  termination_dirty = true;
+}
+
+void Runtime::assignMessageToRuleSet(int shared_rule_tag, const MessageRecord& msg_content) {
+  auto it = ruleset->receive_tag_rule_table.find(shared_rule_tag);
+  if (it == ruleset->receive_tag_rule_table.end()) return;
+  messages.insert(it->second, msg_content);
+  if (it->second < rule_waits.size() && rule_waits[it->second].on_message) rule_waits[it->second] = RuleWait{};
+  dirty = true;
 }
 
 void Runtime::assignQubitToRuleSet(QNodeAddr partner_addr, IQubitRecord* qubit_record) {
-  auto it = ruleset.partner_initial_rule_table.find(partner_addr);
-  assert(it != ruleset.partner_initial_rule_table.end());
-  auto rule_id = it->second;
-  auto sequence_number = ++resource_counter[{partner_addr, rule_id}];
-  qubits.emplace(std::make_pair(partner_addr, rule_id), qubit_record);
-  sequence_number_to_qubit[{partner_addr, rule_id, sequence_number}] = qubit_record;
-  qubit_to_sequence_number[qubit_record] = {partner_addr, rule_id, sequence_number};
-}
-
-QubitResources::iterator Runtime::findQubit(IQubitRecord* qubit_record) {
-  for (auto it = qubits.begin(); it != qubits.end(); it++) {
-    if (it->second == qubit_record) {
-      return it;
-    }
-  }
-  throw cRuntimeError("Qubit not found: from the given QubitRecord");
+  auto rule_id = ruleset->initialRule(partner_addr);
+  assert(rule_id >= 0);
+  insertQubit(partner_addr, rule_id, qubit_record);
+  dirty = true;
 }
 
 void Runtime::promoteQubit(IQubitRecord* qubit) {
-  auto [partner_addr, current_rule_id, sequence_number] = qubit_to_sequence_number[qubit];
-  auto it = ruleset.next_rule_table.find({partner_addr, current_rule_id});
-  assert(it != ruleset.next_rule_table.end());
-  auto next_rule_id = it->second;
-  auto next_rule_sequence_number = ++resource_counter[{partner_addr, next_rule_id}];
-  qubits.erase(findQubit(qubit));
-  qubits.emplace(std::make_pair(partner_addr, next_rule_id), qubit);
-  sequence_number_to_qubit.erase(qubit_to_sequence_number[qubit]);
-  sequence_number_to_qubit[{partner_addr, next_rule_id, next_rule_sequence_number}] = qubit;
-  qubit_to_sequence_number[qubit] = {partner_addr, next_rule_id, next_rule_sequence_number};
+  auto* location = qubits.find(qubit);
+  if (location == nullptr) throw cRuntimeError("Qubit not found: from the given QubitRecord");
+  auto partner_addr = location->partner_addr;
+  auto next = ruleset->nextRule(partner_addr, location->rule_id);
+  insertQubit(partner_addr, next >= 0 ? next : held_rule_id, qubit);
+  dirty = true;
 }
 void Runtime::promoteQubitWithNewPartner(IQubitRecord* qubit_record, QNodeAddr new_partner_addr) {
-  QubitResources::iterator qubit_iter;
-  bool found = false;
-  for (auto it = qubits.begin(); it != qubits.end(); it++) {
-    if (it->second == qubit_record) {
-      qubit_iter = it;
-      found = true;
-      break;
-    }
-  }
-  auto [partner_addr, current_rule_id, sequence_number] = qubit_to_sequence_number[qubit_record];
-  assert(found);
-  qubits.erase(qubit_iter);
-  auto it = ruleset.partner_initial_rule_table.find(new_partner_addr);
-  assert(it != ruleset.partner_initial_rule_table.end());
-  auto next_rule_id = it->second;
-  auto next_rule_sequence_number = ++resource_counter[{new_partner_addr, next_rule_id}];
-  qubits.emplace(std::make_pair(new_partner_addr, next_rule_id), qubit_record);
-  sequence_number_to_qubit.erase(qubit_to_sequence_number[qubit_record]);
-  sequence_number_to_qubit[{new_partner_addr, next_rule_id, next_rule_sequence_number}] = qubit_record;
-  qubit_to_sequence_number[qubit_record] = {new_partner_addr, next_rule_id, next_rule_sequence_number};
+  assert(qubits.find(qubit_record) != nullptr);
+  auto rule_id = ruleset->initialRule(new_partner_addr);
+  assert(rule_id >= 0);
+  insertQubit(new_partner_addr, rule_id, qubit_record);
+  dirty = true;
 }
 void Runtime::assignQubitToRule(QNodeAddr partner_addr, RuleId rule_id, IQubitRecord* qubit_record) {
-  qubits.emplace(std::make_pair(partner_addr, rule_id), qubit_record);
-  auto sequence_number = ++resource_counter[{partner_addr, rule_id}];
-  sequence_number_to_qubit.erase(qubit_to_sequence_number[qubit_record]);
-  sequence_number_to_qubit[{partner_addr, rule_id, sequence_number}] = qubit_record;
-  qubit_to_sequence_number[qubit_record] = {partner_addr, rule_id, sequence_number};
+  insertQubit(partner_addr, rule_id, qubit_record);
+  dirty = true;
+}
+
+void Runtime::insertQubit(QNodeAddr partner_addr, RuleId rule_id, IQubitRecord* qubit_record) {
+  qubits.insert(partner_addr, rule_id, qubit_record);
+  if (rule_id < 0 || rule_id >= rule_waits.size()) return;
+  auto& wait = rule_waits[rule_id];
+  if (std::find(wait.on_qubits.begin(), wait.on_qubits.end(), partner_addr) != wait.on_qubits.end()) wait = RuleWait{};
 }
+
+void Runtime::waitForMessage() {
+  if (rule_id >= 0 && rule_id < rule_waits.size()) rule_waits[rule_id].on_message = true;
+}
+
+void Runtime::waitForQubit(QNodeAddr partner_addr) {
+  if (rule_id >= 0 && rule_id < rule_waits.size()) rule_waits[rule_id].on_qubits.push_back(partner_addr);
+}
+
+bool Runtime::passesQubitCountGuards(const Program& program) {
+  for (auto& guard : program.qubit_count_guards) {
+    if ((int)qubits.countOf(guard.partner_addr, rule_id) < guard.min_count) {
+      waitForQubit(guard.partner_addr);
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Runtime::isRuleSuspended(RuleId rule_id) const { return rule_id >= 0 && rule_id < rule_waits.size() && rule_waits[rule_id].suspended; }
 const Register& Runtime::getReg(RegId reg_id) const { return registers[(int)reg_id]; }
 int32_t Runtime::getRegVal(RegId reg_id) const { return registers[(int)reg_id].value; }
 void Runtime::setRegVal(RegId reg_id, int32_t val) { registers[(int)reg_id].value = val; }
 void Runtime::setQubit(IQubitRecord* qubit_ref, QubitId qubit_id) {
   assert(qubit_ref != nullptr);
-  named_qubits.insert({qubit_id, qubit_ref});
+  named_qubits.insert(qubit_id, qubit_ref);
 }
 
 IQubitRecord* Runtime::getQubitByPartnerAddr(QNodeAddr partner_addr, int index) {
   int i = 0;
-  for (auto it = qubits.begin(); it != qubits.end(); it++) {
-    if (it->first.first == partner_addr && it->first.second == rule_id && !callback->isQubitLocked(it->second)) {
-      if (index == i) return it->second;
-      i++;
+  auto select = [&](IQubitRecord* qubit) {
+    if (callback->isQubitLocked(qubit)) return false;
+    return index == i++;
+  };
+  if (qubit_selection_policy == QubitSelectionPolicy::ASSIGNED_ORDER) {
+    auto* entries = qubits.qubitsOf(partner_addr, rule_id);
+    if (entries == nullptr) return nullptr;
+    for (auto& entry : *entries) {
+      if (select(entry.qubit)) return entry.qubit;
+    }
+    return nullptr;
+  }
+  auto* by_age = qubits.qubitsByAgeOf(partner_addr, rule_id);
+  if (by_age == nullptr) return nullptr;
+  if (qubit_selection_policy == QubitSelectionPolicy::OLDEST_FIRST) {
+    for (auto& [key, qubit] : *by_age) {
+      if (select(qubit)) return qubit;
+    }
+  } else {
+    for (auto it = by_age->rbegin(); it != by_age->rend(); ++it) {
+      if (select(it->second)) return it->second;
     }
   }
   return nullptr;
 }
 
 IQubitRecord* Runtime::getQubitBySequenceNumber(QNodeAddr partner_addr, RuleId rule_id, SequenceNumber sequence_number) {
-  if (sequence_number_to_qubit.find({partner_addr, rule_id, sequence_number}) == sequence_number_to_qubit.end()) {
-    return nullptr;
-  }
-  return sequence_number_to_qubit[{partner_addr, rule_id, sequence_number}];
+  return qubits.findBySequenceNumber(partner_addr, rule_id, sequence_number);
+}
+
+IQubitRecord* Runtime::getQubitBySharedRuleTag(QNodeAddr partner_addr, int shared_rule_tag, SequenceNumber sequence_number) {
+  auto it = ruleset->receive_tag_rule_table.find(shared_rule_tag);
+  if (it == ruleset->receive_tag_rule_table.end()) return nullptr;
+  return qubits.findBySequenceNumber(partner_addr, it->second, sequence_number);
+}
+
+std::optional<QubitResources::Location> Runtime::releaseQubit(IQubitRecord* qubit_record) {
+  auto* location = qubits.find(qubit_record);
+  if (location == nullptr || callback->isQubitLocked(qubit_record)) return std::nullopt;
+  auto released = *location;
+  qubits.erase(qubit_record);
+  dirty = true;
+  return released;
 }
 
 IQubitRecord* Runtime::getQubitByQubitId(QubitId id) const {
-  auto it = named_qubits.find(id);
-  if (it != named_qubits.end()) {
-    return it->second;
-  }
-  return nullptr;
+  return named_qubits.find(id);
 }
 
 void Runtime::jumpTo(const Label& label) {
-  auto it = label_map->find(label);
-  if (it != label_map->end()) {
+  if (label.pc >= 0) {
     // pc will be incremeted before executing the next line
-    pc = it->second - 1;
+    pc = label.pc - 1;
   }
 }
 
-void Runtime::storeVal(MemoryKey key, MemoryValue val) { memory.insert_or_assign(key, val); }
-void Runtime::loadVal(MemoryKey key, RegId reg_id) {
-  auto it = memory.find(key);
-  if (it != memory.end()) {
-    setRegVal(reg_id, it->second.intValue());
+int Runtime::getMemorySlot(const MemoryKey& key, bool add_slot) {
+  if (key.slot >= 0) return key.slot;
+  // the key is not in a finalized Program, e.g. a Program executed directly or a key made outside of the RuleSet.
+  auto slot = ruleset->findMemorySlot(key);
+  if (slot >= 0) return slot;
+  auto it = local_memory_slots.find(key);
+  if (it != local_memory_slots.end()) return it->second;
+  if (!add_slot) return -1;
+  slot = ruleset->memory_keys.size() + local_memory_keys.size();
+  local_memory_slots.emplace(key, slot);
+  local_memory_keys.push_back(key);
+  return slot;
+}
+
+void Runtime::storeVal(const MemoryKey& key, MemoryValue val) {
+  auto slot = getMemorySlot(key, true);
+  if (slot >= memory.size()) memory.resize(slot + 1);
+  memory[slot] = val;
+  dirty = true;
+  auto& termination_slots = ruleset->termination_memory_slots;
+  if (slot < termination_slots.size() && termination_slots[slot]) termination_dirty = true;
+}
+
+void Runtime::loadVal(const MemoryKey& key, RegId reg_id) {
+  auto slot = getMemorySlot(key, false);
+  if (slot >= 0 && slot < memory.size() && memory[slot].has_value()) {
+    setRegVal(reg_id, memory[slot]->intValue());
   }
 }
 
-MemoryValue Runtime::loadVal(MemoryKey key) {
-  auto it = memory.find(key);
-  if (it == memory.end()) throw std::runtime_error("the value is empty for the key");
-  return it->second;
+void Runtime::loadVal(const MemoryKey& key, RegId reg_id, int word_index) {
+  auto slot = getMemorySlot(key, false);
+  if (slot < 0 || slot >= memory.size() || !memory[slot].has_value()) return;
+  auto& words = memory[slot]->bitset().words;
+  setRegVal(reg_id, word_index < words.size() ? static_cast<int>(words[word_index]) : 0);
 }
 
-void Runtime::measureQubit(QubitId qubit_id, MemoryKey memory_key, Basis basis) {
+MemoryValue Runtime::loadVal(const MemoryKey& key) {
+  auto slot = getMemorySlot(key, false);
+  if (slot < 0 || slot >= memory.size() || !memory[slot].has_value()) throw std::runtime_error("the value is empty for the key");
+  return *memory[slot];
+}
+
+void Runtime::measureQubit(QubitId qubit_id, const MemoryKey& memory_key, Basis basis) {
   auto qubit_ref = getQubitByQubitId(qubit_id);
   if (qubit_ref == nullptr) {
     return;
@@ -325,15 +574,9 @@ void Runtime::freeQubit(QubitId qubit_id) {
     return;
   }
   callback->freeAndResetQubit(qubit_ref);
-  auto named_qubit = named_qubits.find(qubit_id);
-  named_qubits.erase(named_qubit);
-  for (auto i = qubits.begin(); i != qubits.end(); i++) {
-    if (i->second == qubit_ref) {
-      qubits.erase(i);
-      return;
-    }
-  }
-  throw std::runtime_error("unknown qubit_ref");
+  dirty = true;
+  named_qubits.erase(qubit_id);
+  if (!qubits.erase(qubit_ref)) throw std::runtime_error("unknown qubit_ref");
 }
 
 void Runtime::gateX(QubitId qubit_id) {
@@ -401,28 +644,74 @@ void Runtime::purifyY(RegId result_reg_id, int bitset_index, QubitId qubit_id, Q
   setRegVal(result_reg_id, val);
 }
 
+void Runtime::purify(Basis basis, const MemoryKey& result_key, QubitId first_qubit_id, QubitId first_trash_qubit_id, int num_pairs) {
+  batch_qubits.clear();
+  batch_trash_qubits.clear();
+  batch_pair_indices.clear();
+  for (int i = 0; i < num_pairs; i++) {
+    auto qubit = getQubitByQubitId(QubitId{first_qubit_id.val + i});
+    auto trash_qubit = getQubitByQubitId(QubitId{first_trash_qubit_id.val + i});
+    if (qubit == nullptr || trash_qubit == nullptr) continue;
+    batch_qubits.push_back(qubit);
+    batch_trash_qubits.push_back(trash_qubit);
+    batch_pair_indices.push_back(i);
+  }
+  Bitset results(num_pairs);
+  if (batch_qubits.size() == static_cast<std::size_t>(num_pairs)) {
+    callback->purify(basis, batch_qubits, batch_trash_qubits, results);
+  } else {
+    // the outcomes of the purified pairs go to the bits of their pair indices
+    Bitset batch_results(batch_qubits.size());
+    if (!batch_qubits.empty()) callback->purify(basis, batch_qubits, batch_trash_qubits, batch_results);
+    for (std::size_t i = 0; i < batch_pair_indices.size(); i++) {
+      if (batch_results.test(i)) results.set(batch_pair_indices[i]);
+    }
+  }
+  storeVal(result_key, MemoryValue{std::move(results)});
+}
+
+void Runtime::bellMeasure(RegId result_reg_id, QubitId control_qubit_id, QubitId target_qubit_id) {
+  auto control_qubit = getQubitByQubitId(control_qubit_id);
+  auto target_qubit = getQubitByQubitId(target_qubit_id);
+  if (control_qubit == nullptr) return;
+  if (target_qubit == nullptr) return;
+  int result = callback->bellMeasure(control_qubit, target_qubit);
+  auto val = getRegVal(result_reg_id);
+  val |= result;
+  setRegVal(result_reg_id, val);
+}
+
 bool Runtime::isQubitLocked(IQubitRecord* const qubit) { return callback->isQubitLocked(qubit); }
+std::size_t Runtime::allocatedBytes() const {
+  std::size_t bytes = qubits.allocatedBytes() + messages.allocatedBytes() + named_qubits.allocatedBytes() + utils::heapBytesOf(memory) + utils::heapBytesOf(rule_waits) +
+                      utils::heapBytesOf(batch_qubits) + utils::heapBytesOf(batch_trash_qubits) + utils::heapBytesOf(batch_pair_indices) +
+                      utils::heapBytesOf(local_memory_keys) + utils::heapBytesOf(local_memory_slots) + utils::heapBytesOf(partners);
+  for (auto& wait : rule_waits) bytes += utils::heapBytesOf(wait.on_qubits);
+  return bytes;
+}
+
 void Runtime::debugRuntimeState() {
   std::cout << "\n---------runtime-state---------"
             << "\npc: " << pc << ", rule_id: " << rule_id << ", qubit_found: " << (qubit_found ? "true" : "false");
   std::cout << "\nReg0: " << registers[0].value << ", Reg1: " << registers[1].value << ", Reg2: " << registers[2].value << ", Reg3: " << registers[3].value
             << ", Reg4: " << registers[4].value << "\n----------memory------------\n";
-  for (auto it : memory) {
-    std::cout << "  " << it.first << ": " << it.second << "\n";
+  auto num_ruleset_keys = ruleset->memory_keys.size();
+  for (int slot = 0; slot < memory.size(); slot++) {
+    if (!memory[slot].has_value()) continue;
+    auto& key = slot < num_ruleset_keys ? ruleset->memory_keys[slot] : local_memory_keys[slot - num_ruleset_keys];
+    std::cout << "  " << key << ": " << *memory[slot] << "\n";
   }
   std::cout << "\n----------qubits---------\n";
-  for (auto& [key, qubit] : qubits) {
-    //// (partner's qnode addr, assigned RuleId) => [local half of the bell pair qubit record]
-    auto& [partner_addr, rule_id] = key;
+  qubits.forEach([&](QNodeAddr partner_addr, RuleId rule_id, IQubitRecord* qubit) {
     auto locked = callback->isQubitLocked(qubit);
     std::cout << "  Qubit(qnic:" << qubit->getQNicIndex() << ", qubit_index:" << qubit->getQubitIndex() << "):" << partner_addr << " rule_id:" << rule_id << ", locked:" << locked
               << ", busy:" << qubit->isBusy() << "\n";
-  }
+  });
 
   std::cout << "\n--------named-qubits---------\n";
-  for (auto& [qubit_id, qubit] : named_qubits) {
+  named_qubits.forEach([](QubitId qubit_id, IQubitRecord* qubit) {
     std::cout << "  QubitId(" << qubit_id.val << "): Qubit(qnic: " << qubit->getQNicIndex() << ", index: " << qubit->getQubitIndex() << "):\n";
-  }
+  });
   std::cout << "----------------------------------------\n\n" << std::endl;
 }
 
@@ -1,8 +1,10 @@
 #pragma once
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
-#include <deque>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <stdexcept>
 #include <tuple>
 #include <unordered_map>
@@ -10,36 +12,98 @@
 #include <vector>
 
 #include "InstructionVisitor.h"
+#include "MessageResources.h"
+#include "QubitResources.h"
 #include "RuleSet.h"
+#include "RuntimeProfile.h"
+#include "RuntimeTrace.h"
 #include "macro_utils.h"
 
 #include "Value.h"
 #include "opcode.h"
 #include "types.h"
+#include "utils/MemoryResource.h"
+#include "utils/MemoryUsage.h"
 
 namespace quisp::runtime {
 struct Register {
   int32_t value = 0;
 };
 
-/// @brief (partner's qnode addr, assigned RuleId) => [local half of the bell pair qubit record]
-using QubitResources = std::multimap<std::pair<QNodeAddr, RuleId>, IQubitRecord*>;
-
-/// @brief (partner's qnode addr, assigned RuleId, sequence number) => [local half of the stationary bell pair qubit record]
-using QubitResourcesWithSequenceNumbers = std::map<std::tuple<QNodeAddr, RuleId, SequenceNumber>, IQubitRecord*>;
-using SequenceNumberTracker = std::map<IQubitRecord*, std::tuple<QNodeAddr, RuleId, SequenceNumber>>;
-
-/// @brief ResourceId needs to be increment each time a qubit of certain properties (same <QNodeAddr>) is added to the Rule.
-using SequenceNumberCounter = std::map<std::pair<QNodeAddr, RuleId>, SequenceNumber>;
-
-/// @brief Store messages for each rule for decision making mainly used for WaitRules (e.g., purification, Pauli Frame correction).
-using MessageResources = std::map<RuleId, std::deque<MessageRecord>>;
-
-/// @brief QubitId and qubit record map. This is initialized in before each Program execution
-using QubitNameMap = std::unordered_map<QubitId, IQubitRecord*>;
+/**
+ * @brief QubitId and qubit record map. This is initialized in before each Program execution
+ *
+ * The qubits are in the slots indexed by the QubitId. The slots and the list of the bound ids are kept
+ * over the executions, so binding and clearing the qubits don't allocate once the slots are there.
+ */
+class QubitNameMap {
+ public:
+  /// @brief binds the qubit to the id unless the id already has one, like std::unordered_map::insert.
+  void insert(QubitId qubit_id, IQubitRecord* qubit) {
+    if (qubit_id.val < 0) {
+      // e.g. the qubit id register initialized with -1
+      if (find(qubit_id) == nullptr) negative_ids.emplace_back(qubit_id.val, qubit);
+      return;
+    }
+    if (static_cast<std::size_t>(qubit_id.val) >= slots.size()) slots.resize(qubit_id.val + 1, nullptr);
+    auto& slot = slots[qubit_id.val];
+    if (slot != nullptr) return;
+    slot = qubit;
+    bound_ids.push_back(qubit_id.val);
+  }
+  /// @brief returns the qubit bound to the id, or nullptr.
+  IQubitRecord* find(QubitId qubit_id) const {
+    if (qubit_id.val >= 0) return static_cast<std::size_t>(qubit_id.val) < slots.size() ? slots[qubit_id.val] : nullptr;
+    for (auto& [id, qubit] : negative_ids) {
+      if (id == qubit_id.val) return qubit;
+    }
+    return nullptr;
+  }
+  void erase(QubitId qubit_id) {
+    if (qubit_id.val >= 0) {
+      if (static_cast<std::size_t>(qubit_id.val) >= slots.size() || slots[qubit_id.val] == nullptr) return;
+      slots[qubit_id.val] = nullptr;
+      bound_ids.erase(std::find(bound_ids.begin(), bound_ids.end(), qubit_id.val));
+      return;
+    }
+    negative_ids.erase(std::remove_if(negative_ids.begin(), negative_ids.end(), [&](auto& entry) { return entry.first == qubit_id.val; }), negative_ids.end());
+  }
+  void clear() {
+    for (auto id : bound_ids) slots[id] = nullptr;
+    bound_ids.clear();
+    negative_ids.clear();
+  }
+  /// @brief makes the slots for the ids less than num_qubit_ids.
+  void reserve(std::size_t num_qubit_ids) {
+    if (num_qubit_ids > slots.size()) slots.resize(num_qubit_ids, nullptr);
+  }
+  /// @brief calls f(qubit_id, qubit) for each bound qubit.
+  template <typename F>
+  void forEach(F f) const {
+    for (auto& [id, qubit] : negative_ids) f(QubitId{id}, qubit);
+    for (auto id : bound_ids) f(QubitId{id}, slots[id]);
+  }
+  std::size_t allocatedBytes() const { return utils::heapBytesOf(slots) + utils::heapBytesOf(bound_ids) + utils::heapBytesOf(negative_ids); }
+
+ private:
+  std::vector<IQubitRecord*> slots;
+  std::vector<int> bound_ids;
+  std::vector<std::pair<int, IQubitRecord*>> negative_ids;
+};
 
-/// @brief Memory is a simple dict to store the value during RuleSet execution.
-using Memory = std::unordered_map<MemoryKey, MemoryValue>;
+/// @brief Memory stores the value during RuleSet execution, indexed by the memory slot of RuleSet::memory_keys.
+using Memory = std::pmr::vector<std::optional<MemoryValue>>;
+
+/// @brief how GET_QUBIT picks the index-th unlocked qubit assigned to the Rule with the partner.
+enum class QubitSelectionPolicy {
+  /// @brief in the order the qubits were assigned to the Rule.
+  ASSIGNED_ORDER,
+  /// @brief the oldest Bell pair first. The consecutive indices get the Bell pairs of the closest ages,
+  /// even after purification and swapping reassigned them in another order.
+  OLDEST_FIRST,
+  /// @brief the freshest Bell pair first, it has the least memory error.
+  FRESHEST_FIRST,
+};
 
 /**
  * @brief Runtime class is responsible for executing the given RuleSet and the
@@ -63,6 +127,18 @@ class Runtime {
     virtual bool isQubitLocked(IQubitRecord* const) = 0;
     virtual void lockQubit(IQubitRecord* const, unsigned long rs_id, int rule_id, int action_index) = 0;
     virtual int getActionIndex(IQubitRecord* const) = 0;
+    // a qubit a terminated RuleSet still holds. shared_rule_tag is the send tag of the rule holding it, -1 if no rule holds it
+    struct HeldQubit {
+      IQubitRecord* qubit;
+      QNodeAddr partner_addr;
+      int shared_rule_tag;
+      SequenceNumber sequence_number;
+    };
+    // frees all the qubits of the terminated RuleSet at once, right before the RuntimeManager removes its Runtime.
+    // the default frees them one by one, the RuleEngine also tells the partners to free the other halves.
+    virtual void reclaimQubits(const unsigned long ruleset_id, const std::vector<HeldQubit>& qubits) {
+      for (auto& held : qubits) freeAndResetQubit(held.qubit);
+    }
 
     // Quantum Operations
     virtual MeasurementOutcome measureQubitRandomly(IQubitRecord*) = 0;
@@ -76,6 +152,16 @@ class Runtime {
     virtual int purifyX(IQubitRecord* qubit_rec, IQubitRecord* trash_qubit_rec) = 0;
     virtual int purifyZ(IQubitRecord* qubit_rec, IQubitRecord* trash_qubit_rec) = 0;
     virtual int purifyY(IQubitRecord* qubit_rec, IQubitRecord* trash_qubit_rec) = 0;
+    // returns the bitset of the outcomes: 1 at bit 0 if X of the control is -1, 1 at bit 1 if Z of the target is -1
+    virtual int bellMeasure(IQubitRecord* control_qubit_rec, IQubitRecord* target_qubit_rec) = 0;
+    // purifies qubit_recs[i] with trash_qubit_recs[i] and sets the bit i of the results for the outcome -1, the results have the size of the batch.
+    // the default runs purifyX/Z/Y pair by pair, a callback handing the whole batch to the backend overrides it.
+    virtual void purify(Basis basis, const std::vector<IQubitRecord*>& qubit_recs, const std::vector<IQubitRecord*>& trash_qubit_recs, Bitset& results) {
+      for (std::size_t i = 0; i < qubit_recs.size(); i++) {
+        int result = basis == Basis::X ? purifyX(qubit_recs[i], trash_qubit_recs[i]) : basis == Basis::Z ? purifyZ(qubit_recs[i], trash_qubit_recs[i]) : purifyY(qubit_recs[i], trash_qubit_recs[i]);
+        if (result != 0) results.set(i);
+      }
+    }
 
     // Messaging
     virtual void sendLinkTomographyResult(const unsigned long ruleset_id, const Rule& rule, const int action_index, const QNodeAddr partner_addr, int count,
@@ -86,18 +172,41 @@ class Runtime {
                                         const int measurement_result, PurType protocol) = 0;
     virtual void sendSwappingResult(const unsigned long ruleset_id, const QNodeAddr partner_addr, const QNodeAddr new_partner_addr, const int shared_rule_tag,
                                     const int sequence_number, const int frame_correction) = 0;
+    // Metrics
+    virtual void notifyRuleSetTerminated(const unsigned long ruleset_id) {}
+    virtual void notifyRuleSetParked(const unsigned long ruleset_id) {}
     // Debugging
     virtual std::string getNodeInfo() { return ""; };
   };
 
   Runtime();
   Runtime(const RuleSet& ruleset, ICallBack* callback);
+  /// @param memory_resource_strategy where the qubits, the messages and the memory of this Runtime take their memory from
+  Runtime(std::shared_ptr<const RuleSet> ruleset, unsigned long ruleset_id, ICallBack* callback,
+          utils::MemoryResourceStrategy memory_resource_strategy = utils::MemoryResourceStrategy::Global);
   Runtime(const Runtime&);
   Runtime& operator=(Runtime&& runtime);
   ~Runtime();
 
   void assignRuleSet(const RuleSet& ruleset);
 
+  /**
+   * @brief assign the compiled RuleSet, which may be shared with other Runtimes.
+   *
+   * @param ruleset the RuleSet compiled by RuleSet::compile()
+   * @param ruleset_id the id of the RuleSet this Runtime executes
+   */
+  void assignRuleSet(std::shared_ptr<const RuleSet> ruleset, unsigned long ruleset_id);
+
+  /**
+   * @brief replaces the RuleSet with the one that keeps its rules and appends more, e.g. the swapping rules
+   * following the link-level rules installed before them. The qubits, the messages and the memory carry over,
+   * and the qubits held at the end of the old RuleSet go on to the next rule of their partner.
+   *
+   * @param ruleset the compiled RuleSet, its first rules are the ones of the current RuleSet
+   */
+  void extendRuleSet(std::shared_ptr<const RuleSet> ruleset);
+
   /**
    * @brief this method resets the state before each Program execution.
    */
@@ -106,9 +215,28 @@ class Runtime {
   /// @brief public method to execute the assigned RuleSet.
   void exec();
 
+  /**
+   * @brief terminate the RuleSet from outside, as its termination condition would do.
+   * The qubits stay in @ref qubits until the RuntimeManager reclaims them with ICallBack::reclaimQubits and removes this Runtime.
+   */
+  void terminate();
+
+  /**
+   * @brief resumes the Runtime parked by keep_alive for demand more rounds of its termination condition.
+   * The integer counters the termination_condition loads, e.g. the MeasureCount of the tomography, are rewound by demand,
+   * and the qubits and the rest of the memory carry over. A running Runtime just gets the demand added to its current one.
+   */
+  void rearm(int demand);
+
   /// @brief execute the given Program in a Rule
   void execProgram(const Program& program);
 
+  /// @brief execute the given Program with writing each instruction and the registers after it to the active trace
+  void execProgramWithDebug(const Program& program);
+
+  /// @brief execute the given Program with counting the instructions into the profile
+  void execProgramWithProfile(const Program& program);
+
   /// @brief execute the one Instruction
   void execInstruction(const InstructionTypes& op);
 
@@ -119,7 +247,7 @@ class Runtime {
    * @param rule_id the rule id to assign the qubit
    * @param msg the content of the message (e.g., purification [measurement_result, sequence_number, pur_type], swapping [frame_correction, sequence_number])
    */
-  void assignMessageToRuleSet(int shared_rule_tag, MessageRecord& msg_content);
+  void assignMessageToRuleSet(int shared_rule_tag, const MessageRecord& msg_content);
 
   /**
    * @brief assign the entangled qubit to the RuleSet. The Runtime assign it to
@@ -139,8 +267,31 @@ class Runtime {
    */
   void assignQubitToRule(QNodeAddr partner_addr, RuleId rule_id, IQubitRecord* qubit_record);
 
-  /// @brief find the qubit iterator that match with this rule_id and sequence_number
-  QubitResources::iterator findQubit(IQubitRecord*);
+  /// @brief insert the qubit to the rule in @ref qubits, and resume the rule if it waits for a qubit with the partner.
+  void insertQubit(QNodeAddr partner_addr, RuleId rule_id, IQubitRecord* qubit_record);
+
+  /** @name suspension */
+  //@{
+  /// @brief the inputs a Rule waits for, registered by WAIT_MESSAGE and WAIT_QUBIT during its condition.
+  struct RuleWait {
+    bool on_message = false;
+    std::vector<QNodeAddr> on_qubits;
+    /// @brief the condition failed after the waits, so exec() skips the Rule until one of them is met.
+    bool suspended = false;
+  };
+
+  /// @brief the current Rule gets suspended by its failing condition until a message arrives at it.
+  void waitForMessage();
+
+  /// @brief the current Rule gets suspended by its failing condition until a qubit with the partner is assigned to it.
+  void waitForQubit(QNodeAddr partner_addr);
+
+  /// @brief returns true if exec() skips the Rule for now.
+  bool isRuleSuspended(RuleId rule_id) const;
+
+  /// @brief returns false if a qubit count guard of the Program fails for the current Rule, which then waits for a qubit with its partner.
+  bool passesQubitCountGuards(const Program& program);
+  //@}
 
   /** @name register operations */
   //@{
@@ -186,7 +337,7 @@ class Runtime {
    * @param key
    * @param val
    */
-  void storeVal(MemoryKey key, MemoryValue val);
+  void storeVal(const MemoryKey& key, MemoryValue val);
 
   /**
    * @brief load the value from memory, and put it into the given register.
@@ -194,7 +345,7 @@ class Runtime {
    * @param key
    * @param reg_id
    */
-  void loadVal(MemoryKey key, RegId reg_id);
+  void loadVal(const MemoryKey& key, RegId reg_id);
 
   /**
    * @brief load the value from memory.
@@ -202,7 +353,22 @@ class Runtime {
    * @param key
    * @return MemoryValue
    */
-  MemoryValue loadVal(MemoryKey key);
+  MemoryValue loadVal(const MemoryKey& key);
+
+  /**
+   * @brief load a register wide word of the bitset in memory into the given register.
+   * the register keeps its value if the key has not been set, and gets 0 past the end of the bitset.
+   */
+  void loadVal(const MemoryKey& key, RegId reg_id, int word_index);
+
+  /**
+   * @brief returns the memory slot of the key.
+   *
+   * The keys in the assigned RuleSet are already resolved. The other keys are
+   * looked up by name, and a new slot is added for them if add_slot is true.
+   * Otherwise, this returns -1 for an unknown key.
+   */
+  int getMemorySlot(const MemoryKey& key, bool add_slot);
   //@}
 
   /** @name qubit record operations */
@@ -234,8 +400,9 @@ class Runtime {
    * @brief Get the qubit record by partner's QNodeAddr
    *
    * This method finds an index-th qubit record entangled with the partner from
-   * the @ref qubits member. If the Runtime cannot find the qubit, this returns
-   * nullptr. The qubit must be assigned to the current rule_id.
+   * the @ref qubits member, in the order of the @ref qubit_selection_policy.
+   * If the Runtime cannot find the qubit, this returns nullptr.
+   * The qubit must be assigned to the current rule_id.
    * @param index
    * @return IQubitRecord*
    */
@@ -264,11 +431,15 @@ class Runtime {
    * @brief promote the qubit to the next rule.
    *
    * the next rule id is automatically derived by the Programs in the RuleSet.
+   * The qubit past the last rule of its partner is held by held_rule_id until the RuleSet is extended.
    *
    * @param qubit_record the entangled qubit's record already assigned to the RuleSet
    */
   void promoteQubit(IQubitRecord* qubit_record);
 
+  /// @brief the rule id of the qubits promoted past the last rule of their partner, no rule executes them.
+  static constexpr RuleId held_rule_id = -1;
+
   /**
    * @brief promote the qubit that has new entangled partner.
    *
@@ -278,6 +449,23 @@ class Runtime {
    * @param new_partner_addr new entangled partner's QNode address.
    */
   void promoteQubitWithNewPartner(IQubitRecord* qubit_record, QNodeAddr new_partner_addr);
+
+  /**
+   * @brief release the qubit from the RuleSet outside of the Program execution,
+   * e.g. when its Bell pair got older than the cutoff time. The caller frees the qubit.
+   *
+   * @param qubit_record the qubit's record assigned to the RuleSet
+   * @return where the qubit was assigned, or nullopt if it's not assigned or a Rule locks it
+   */
+  std::optional<QubitResources::Location> releaseQubit(IQubitRecord* qubit_record);
+
+  /**
+   * @brief find the qubit matching the partner's qubit with the sequence number
+   * in the partner's Rule with the shared tag.
+   *
+   * @return IQubitRecord* or nullptr if the Runtime cannot find the qubit
+   */
+  IQubitRecord* getQubitBySharedRuleTag(QNodeAddr partner_addr, int shared_rule_tag, SequenceNumber sequence_number);
   //@}
 
   /** @name quantum operations */
@@ -290,7 +478,7 @@ class Runtime {
    * @param result_key the key to store the measurement result
    * @param basis the measurement result
    */
-  void measureQubit(QubitId qubit_id, MemoryKey result_key, Basis basis);
+  void measureQubit(QubitId qubit_id, const MemoryKey& result_key, Basis basis);
   /**
    * @brief measure qubit with given basis and put result into register
    *
@@ -331,13 +519,30 @@ class Runtime {
 
   /// @brief perform Y purification and store the measurement result
   void purifyY(RegId result, int bitset_index, QubitId qubit_id, QubitId trash_qubit_id);
+
+  /**
+   * @brief purify the pairs (first_qubit_id + i, first_trash_qubit_id + i) for i < num_pairs in one callback,
+   * and store the bitset of the outcomes, 1 at the bit i if the i-th trash qubit measured -1.
+   * the bits of the pairs without assigned qubits stay 0.
+   */
+  void purify(Basis basis, const MemoryKey& result_key, QubitId first_qubit_id, QubitId first_trash_qubit_id, int num_pairs);
+
+  /// @brief perform the Bell state measurement and store the outcomes at bit 0 (X of the control) and 1 (Z of the target)
+  void bellMeasure(RegId result, QubitId control_qubit_id, QubitId target_qubit_id);
   //@}
 
   /** @name debugging */
   //@{
+  /// @brief the trace of the current rule: the trace if its filter passes the rule, debugTrace() if the rule is debugging, or nullptr.
+  RuntimeTrace* selectTrace(RuleId rule_id) const;
+  /// @brief write the event of the current rule and pc to the active trace, or to RuntimeTrace::debugTrace() if no trace is active.
+  void writeTrace(TraceEventType type, std::initializer_list<std::int32_t> values = {}, std::uint16_t opcode = 0);
+  /// @brief print the registers, the memory and the qubits, for the DEBUG_RUNTIME_STATE instruction and the uncaught errors.
   void debugRuntimeState();
   void debugSource(const Program& program) const;
   std::string debugInstruction(const InstructionTypes& instr) const;
+  /// @brief the approximate heap bytes of the qubits, the messages, the memory and the bookkeeping of this Runtime, see utils/MemoryUsage.h.
+  std::size_t allocatedBytes() const;
   //@}
 
   /** @name related components */
@@ -347,6 +552,12 @@ class Runtime {
 
   /// @brief The callback provides a way to access the RuleEngine.
   ICallBack* callback;
+
+  /**
+   * @brief the memory resource of qubits, messages and memory, e.g. the arena of this RuleSet, all released when the Runtime goes away.
+   * Declared before them, so it outlives them. A move assignment keeps the resource of each side.
+   */
+  utils::MemoryResource memory_resource;
   //@}
 
   /** @name states */
@@ -377,26 +588,24 @@ class Runtime {
   /**
    * @brief This stores the entangled qubits that are assigned to the ruleset.
    *
-   * The key is a pair of the entangled partner's QNodeAddr and the assigned
-   * RuleId. When Entanglement Swapping changes the entangled partner, we need
-   * to erase the record and insert a new key with a new entangled partner.
+   * The qubits are grouped by the entangled partner's QNodeAddr and the
+   * assigned RuleId, with the sequence number of each assignment. When
+   * Entanglement Swapping changes the entangled partner, the qubit moves to
+   * the group of the new partner.
    */
   QubitResources qubits;
 
+  /// @brief Store messages for each rule for decision making mainly used for WaitRules (e.g., purification, Pauli Frame correction).
   MessageResources messages;
 
-  QubitResourcesWithSequenceNumbers sequence_number_to_qubit;
-  SequenceNumberTracker qubit_to_sequence_number;
-  /**
-   * @brief This stores the latest sequence no. of resource assigned to the Stage/Rule.
-   */
-  SequenceNumberCounter resource_counter;
-
   /**
-   * @brief [shared_rule_tag] => [rule_id]
+   * @brief the waits of the Rules, indexed by the RuleId.
+   *
+   * A Rule like the purification correlation check fails until the partner's result arrives,
+   * so instead of running its condition on every exec(), the Runtime resumes it when
+   * assignMessageToRuleSet or a qubit assignment brings what it waits for.
    */
-  std::unordered_map<int, RuleId> shared_tag_to_rule_id;
-  std::unordered_map<RuleId, int> rule_id_to_shared_tag;
+  std::vector<RuleWait> rule_waits;
 
   /**
    * @brief This contains a map for a QubitId and a qubit.
@@ -410,33 +619,75 @@ class Runtime {
    *
    * Unlike the registers, a Runtime does not initialize the memory in each
    * Program execution. So we can use memory to pass a value between Condition
-   * and Action, Rules.
+   * and Action, Rules. The names of the slots are in ruleset->memory_keys,
+   * followed by local_memory_keys.
    */
   Memory memory;
 
+  /// @brief reused buffers of the batch purification, they don't carry any state between instructions.
+  std::vector<IQubitRecord*> batch_qubits;
+  std::vector<IQubitRecord*> batch_trash_qubits;
+  std::vector<int> batch_pair_indices;
+
+  /**
+   * @brief The memory keys used by this Runtime but not in the RuleSet, e.g.
+   * in a Program executed directly. Their slots follow the RuleSet's slots.
+   */
+  std::vector<MemoryKey> local_memory_keys;
+  std::unordered_map<MemoryKey, int> local_memory_slots;
+
   /**
    * @brief The assigned RuleSet for this Runtime instance.
    *
    * One Runtime has only one RuleSet to process and is never re-used for
-   * another RuleSet.
+   * another RuleSet. The compiled RuleSet is immutable and shared by the
+   * Runtimes executing the same RuleSet, so use ruleset_id instead of its id.
+   */
+  std::shared_ptr<const RuleSet> ruleset;
+
+  /// @brief the id of the assigned RuleSet.
+  unsigned long ruleset_id = 0;
+
+  /**
+   * @brief the profile to record the execution counters, or nullptr if the
+   * profiling is disabled. The RuntimeManager owns it and shares it among its
+   * Runtimes.
    */
-  RuleSet ruleset;
+  RuntimeProfile* profile = nullptr;
 
   /**
-   * @brief The partners store the possible entangled partners' QNodeAddr.
-   * The RuleEngine looks at this variable to determine which entangled qubit to
-   * assign to which rule set.
+   * @brief the trace to record the execution of the rules passing its filter, or nullptr if the tracing is disabled.
+   * The RuntimeManager owns it and shares it among its Runtimes.
    */
-  std::set<QNodeAddr> partners;
+  RuntimeTrace* trace = nullptr;
+
+  /// @brief the trace of the rule being executed, see selectTrace(). nullptr executes the Programs without tracing.
+  RuntimeTrace* active_trace = nullptr;
 
   /**
-   * @brief The label_map is a map of the instruction index and its label to
-   * allow to jump or branch.
+   * @brief the actions an exec() can run, 0 for no limit. The RuntimeManager sets it for all its Runtimes.
    *
-   * The Runtime changes the value of the pc to the instruction index
-   * corresponding to the given label to jump or branch the execution.
+   * A Runtime running out of its budget yields, and the next exec() goes on from the rule it stopped at,
+   * so one RuleSet with plenty of qubits can't hold up the others in a single event.
    */
-  LabelMap const* label_map = nullptr;
+  int action_budget = 0;
+
+  /// @brief the index of the rule the next exec() starts from, the Runtime yielded at it.
+  std::size_t resume_rule_index = 0;
+
+  /// @brief how GET_QUBIT picks the qubits. The RuntimeManager sets it for all its Runtimes.
+  QubitSelectionPolicy qubit_selection_policy = QubitSelectionPolicy::ASSIGNED_ORDER;
+
+  /**
+   * @brief The partners store the possible entangled partners' QNodeAddr.
+   * The RuleEngine looks at this variable to determine which entangled qubit to
+   * assign to which rule set. They are in order, see RuleSet::partner_addrs.
+   */
+  std::vector<QNodeAddr> partners;
+
+  /// @brief returns true if the partner is one of the partners.
+  bool hasPartner(QNodeAddr partner_addr) const { return ruleset != nullptr && ruleset->partnerIndex(partner_addr) >= 0; }
+
   //@}
 
   /** @name flags */
@@ -463,6 +714,39 @@ class Runtime {
    */
   bool terminated = false;
 
+  /// @brief if this flag is true, the Runtime parks itself instead of terminating when the termination_condition is met.
+  bool keep_alive = false;
+
+  /**
+   * @brief This flag is enabled when the keep_alive Runtime met its termination_condition.
+   *
+   * A parked Runtime runs no Rule until rearm(), but it stays in the RuntimeManager
+   * and keeps getting the qubits of its partners.
+   */
+  bool parked = false;
+
+  /// @brief This flag is enabled when the last exec() stopped with its action_budget used up, the Runtime has more to do.
+  bool yielded = false;
+
+  /**
+   * @brief This flag is enabled when something the Rules depend on changed
+   * since the last exec(), e.g. a qubit or a message is assigned, a qubit is
+   * promoted or freed, or the memory is updated.
+   *
+   * The RuntimeManager only executes the Runtimes with this flag. Otherwise,
+   * every condition would fail again in the same way.
+   */
+  bool dirty = true;
+
+  /**
+   * @brief This flag is enabled when the termination_condition may return a different result,
+   * i.e. one of the memory slots it loads is stored since its last execution.
+   *
+   * The flag is only used when the RuleSet::termination_reads_memory_only is true.
+   * Otherwise, the termination_condition is executed after every action.
+   */
+  bool termination_dirty = true;
+
   /**
    * @brief The GET_QUBIT instruction sets this flag. if it's true, the GET_QUBIT
    * instruction successfully found the qubit. if not, the instruction cannot
@@ -1,35 +1,158 @@
 #include "RuntimeManager.h"
+
+#include <algorithm>
+
 #include "omnetpp/cexception.h"
+#include "utils/MemoryUsage.h"
 
 namespace quisp::runtime {
 
 RuntimeManager::RuntimeManager(std::unique_ptr<Runtime::ICallBack> &&callback) : callback(std::move(callback)) {}
 
-void RuntimeManager::acceptRuleSet(const RuleSet &ruleset) { runtimes.emplace_back(runtime::Runtime(ruleset, callback.get())); }
+std::shared_ptr<const RuleSet> RuntimeManager::compile(const RuleSet &ruleset) {
+  auto &cached = compiled_rulesets[ruleset.contentKey()];
+  auto compiled = cached.lock();
+  if (compiled == nullptr) {
+    compiled = RuleSet::compile(ruleset);
+    cached = compiled;
+  }
+  return compiled;
+}
+
+Runtime *RuntimeManager::acceptRuleSet(const RuleSet &ruleset) {
+  runtime_index.insert_or_assign(ruleset.id, runtimes.size());
+  runtimes.emplace_back(std::make_unique<Runtime>(compile(ruleset), ruleset.id, callback.get(), memory_resource_strategy));
+  auto *rt = runtimes.back().get();
+  rt->profile = profile.get();
+  rt->trace = trace.get();
+  rt->qubit_selection_policy = qubit_selection_policy;
+  rt->action_budget = action_budget;
+  for (auto &partner_addr : rt->partners) partner_runtimes[partner_addr].push_back(rt);
+  return rt;
+}
+
+void RuntimeManager::extendRuleSet(Runtime *rt, const RuleSet &ruleset) {
+  RuleSet extended = *rt->ruleset;
+  extended.rules.insert(extended.rules.end(), ruleset.rules.begin(), ruleset.rules.end());
+  extended.termination_condition = ruleset.termination_condition;
+  auto old_partners = rt->partners;
+  rt->extendRuleSet(compile(extended));
+  for (auto &partner_addr : rt->partners) {
+    if (!std::binary_search(old_partners.begin(), old_partners.end(), partner_addr)) partner_runtimes[partner_addr].push_back(rt);
+  }
+}
+
+Runtime *RuntimeManager::findByPartner(QNodeAddr partner_addr) {
+  auto it = partner_runtimes.find(partner_addr);
+  if (it == partner_runtimes.end() || it->second.empty()) return nullptr;
+  return it->second.front();
+}
+
+const std::vector<Runtime *> *RuntimeManager::findAllByPartner(QNodeAddr partner_addr) const {
+  auto it = partner_runtimes.find(partner_addr);
+  if (it == partner_runtimes.end() || it->second.empty()) return nullptr;
+  return &it->second;
+}
 
 Runtime *RuntimeManager::findById(unsigned long long ruleset_id) {
-  for (auto &rt : runtimes) {
-    if (rt.ruleset.id == ruleset_id) {
-      return &rt;
+  auto it = runtime_index.find(ruleset_id);
+  if (it == runtime_index.end()) return nullptr;
+  return runtimes[it->second].get();
+}
+
+bool RuntimeManager::exec() {
+  // only the Runtimes whose resources changed are executed.
+  bool yielded = false;
+  for (size_t k = 0; k < runtimes.size(); k++) {
+    auto &rt = runtimes[(first_runtime + k) % runtimes.size()];
+    if (rt->dirty) rt->exec();
+    yielded = yielded || rt->yielded;
+  }
+  if (action_budget > 0 && !runtimes.empty()) first_runtime = (first_runtime + 1) % runtimes.size();
+
+  // terminated Runtimes are removed, the others keep their order.
+  bool erased = false;
+  size_t alive = 0;
+  for (size_t i = 0; i < runtimes.size(); i++) {
+    auto &rt = runtimes[i];
+    if (rt->terminated) {
+      reclaimQubits(*rt);
+      auto it = runtime_index.find(rt->ruleset_id);
+      if (it != runtime_index.end() && it->second == i) runtime_index.erase(it);
+      for (auto &partner_addr : rt->partners) {
+        auto &partner_rts = partner_runtimes[partner_addr];
+        partner_rts.erase(std::find(partner_rts.begin(), partner_rts.end(), rt.get()));
+        if (partner_rts.empty()) partner_runtimes.erase(partner_addr);
+      }
+      rt.reset();
+      erased = true;
+      continue;
+    }
+    if (alive != i) {
+      runtime_index[rt->ruleset_id] = alive;
+      runtimes[alive] = std::move(rt);
     }
+    alive++;
   }
-  return nullptr;
-}
+  runtimes.resize(alive);
 
-void RuntimeManager::exec() {
-  for (auto it = runtimes.begin(); it != runtimes.end();) {
-    it->exec();
-    if (it->terminated) {
-      it = runtimes.erase(it);
-    } else {
-      ++it;
+  // drop the compiled RuleSets no Runtime uses anymore
+  if (erased) {
+    for (auto it = compiled_rulesets.begin(); it != compiled_rulesets.end();) {
+      if (it->second.expired()) {
+        it = compiled_rulesets.erase(it);
+      } else {
+        ++it;
+      }
     }
   }
+  return yielded;
+}
+
+void RuntimeManager::reclaimQubits(Runtime &runtime) {
+  reclaimed_qubits.clear();
+  auto &rules = runtime.ruleset->rules;
+  runtime.qubits.forEach([&](QNodeAddr partner_addr, RuleId rule_id, IQubitRecord *qubit) {
+    int shared_rule_tag = rule_id >= 0 && rule_id < (RuleId)rules.size() ? rules[rule_id].send_tag : -1;
+    reclaimed_qubits.push_back({qubit, partner_addr, shared_rule_tag, runtime.qubits.find(qubit)->sequence_number});
+  });
+  if (reclaimed_qubits.empty()) return;
+  num_reclaimed_qubits += reclaimed_qubits.size();
+  callback->reclaimQubits(runtime.ruleset_id, reclaimed_qubits);
+}
+
+void RuntimeManager::enableProfiling(std::uint64_t sample_interval) {
+  profile = std::make_unique<RuntimeProfile>(sample_interval);
+  for (auto &rt : runtimes) rt->profile = profile.get();
+}
+
+const RuntimeProfile *RuntimeManager::getProfile() const { return profile.get(); }
+
+void RuntimeManager::enableTracing(std::unique_ptr<RuntimeTrace> new_trace) {
+  trace = std::move(new_trace);
+  for (auto &rt : runtimes) rt->trace = trace.get();
+}
+
+void RuntimeManager::setQubitSelectionPolicy(QubitSelectionPolicy policy) {
+  qubit_selection_policy = policy;
+  for (auto &rt : runtimes) rt->qubit_selection_policy = policy;
 }
 
-std::vector<Runtime>::iterator RuntimeManager::begin() { return runtimes.begin(); }
-std::vector<Runtime>::iterator RuntimeManager::end() { return runtimes.end(); }
-std::vector<Runtime>::reference RuntimeManager::at(size_t index) { return runtimes.at(index); }
+void RuntimeManager::setActionBudget(int budget) {
+  action_budget = budget;
+  for (auto &rt : runtimes) rt->action_budget = budget;
+}
+
+RuntimeManager::iterator RuntimeManager::begin() { return iterator(runtimes.begin()); }
+RuntimeManager::iterator RuntimeManager::end() { return iterator(runtimes.end()); }
+Runtime &RuntimeManager::at(size_t index) { return *runtimes.at(index); }
 size_t RuntimeManager::size() const { return runtimes.size(); }
 
+std::size_t RuntimeManager::allocatedBytes() const {
+  std::size_t bytes = utils::heapBytesOf(runtimes) + utils::heapBytesOf(runtime_index) + utils::heapBytesOf(partner_runtimes) + utils::heapBytesOf(compiled_rulesets);
+  for (auto &[partner_addr, partner_list] : partner_runtimes) bytes += utils::heapBytesOf(partner_list);
+  for (auto &runtime : runtimes) bytes += sizeof(Runtime) + runtime->allocatedBytes();
+  return bytes;
+}
+
 }  // namespace quisp::runtime
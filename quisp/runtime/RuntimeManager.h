@@ -1,21 +1,146 @@
 #pragma once
 
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include "Runtime.h"
+#include "RuntimeProfile.h"
+#include "RuntimeTrace.h"
 
 namespace quisp::runtime {
 class RuntimeManager {
  public:
+  /// @brief iterates the Runtimes in the order their RuleSets were accepted.
+  class iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Runtime;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Runtime*;
+    using reference = Runtime&;
+
+    explicit iterator(std::vector<std::unique_ptr<Runtime>>::iterator it) : it(it) {}
+    reference operator*() const { return **it; }
+    pointer operator->() const { return it->get(); }
+    iterator& operator++() {
+      ++it;
+      return *this;
+    }
+    iterator operator++(int) { return iterator(it++); }
+    bool operator==(const iterator& other) const { return it == other.it; }
+    bool operator!=(const iterator& other) const { return it != other.it; }
+
+   private:
+    std::vector<std::unique_ptr<Runtime>>::iterator it;
+  };
+
   RuntimeManager(std::unique_ptr<Runtime::ICallBack>&& callback);
-  void acceptRuleSet(const RuleSet&);
+  /// @brief starts a Runtime for the RuleSet and returns it.
+  Runtime* acceptRuleSet(const RuleSet&);
+
+  /**
+   * @brief appends the rules and the termination condition of the RuleSet to the RuleSet of the running Runtime,
+   * e.g. the swapping rules of a connection whose link-level rules were installed during its setup.
+   */
+  void extendRuleSet(Runtime* runtime, const RuleSet& ruleset);
   Runtime* findById(unsigned long long ruleset_id);
-  void exec();
-  std::vector<Runtime>::iterator begin();
-  std::vector<Runtime>::iterator end();
-  std::vector<Runtime>::reference at(size_t);
+
+  /// @brief returns the first accepted Runtime whose RuleSet uses the partner, or nullptr if there is none.
+  Runtime* findByPartner(QNodeAddr partner_addr);
+
+  /// @brief returns all the Runtimes whose RuleSet uses the partner in the accepted order, or nullptr if there is none.
+  const std::vector<Runtime*>* findAllByPartner(QNodeAddr partner_addr) const;
+
+  /**
+   * @brief executes the dirty Runtimes and removes the terminated ones, after reclaiming their qubits in one ICallBack::reclaimQubits each.
+   * @return true if a Runtime yielded with its action budget used up, it needs another exec() to go on.
+   */
+  bool exec();
+  iterator begin();
+  iterator end();
+  Runtime& at(size_t);
   size_t size() const;
+  /// @brief the qubits the terminated Runtimes still held when they were removed.
+  std::uint64_t numReclaimedQubits() const { return num_reclaimed_qubits; }
+  /// @brief the approximate heap bytes of the Runtimes and the indexes, not counting the compiled RuleSets.
+  std::size_t allocatedBytes() const;
+
+  /**
+   * @brief starts recording the execution counters of all the Runtimes.
+   * @param sample_interval time every sample_interval-th Program execution, 0 disables the timing.
+   */
+  void enableProfiling(std::uint64_t sample_interval);
+
+  /// @brief the aggregated profile, or nullptr if the profiling is disabled.
+  const RuntimeProfile* getProfile() const;
+
+  /// @brief starts writing the execution of the rules passing the filter of the trace, in all the Runtimes including the ones accepted later.
+  void enableTracing(std::unique_ptr<RuntimeTrace> trace);
+
+  /// @brief the trace, or nullptr if the tracing is disabled.
+  RuntimeTrace* getTrace() const { return trace.get(); }
+
+  /// @brief sets how GET_QUBIT picks the qubits in all the Runtimes, including the ones accepted later.
+  void setQubitSelectionPolicy(QubitSelectionPolicy policy);
+
+  /**
+   * @brief limits the actions each Runtime runs in an exec(), 0 for no limit, including the Runtimes accepted later.
+   * With a budget, the Runtimes also take turns to be executed first.
+   */
+  void setActionBudget(int budget);
+
+  /// @brief sets the memory resource of the Runtimes accepted later, see Runtime::memory_resource.
+  void setMemoryResourceStrategy(utils::MemoryResourceStrategy strategy) { memory_resource_strategy = strategy; }
 
  protected:
-  std::vector<Runtime> runtimes = {};
+  /**
+   * @brief the Runtimes in the order their RuleSets were accepted.
+   *
+   * Each Runtime is allocated separately, so its address never changes until it terminates.
+   */
+  std::vector<std::unique_ptr<Runtime>> runtimes = {};
+
+  /// @brief the index of the Runtime in runtimes by its RuleSet id.
+  std::unordered_map<unsigned long long, size_t> runtime_index;
+
+  /// @brief the Runtimes whose RuleSet uses the partner, in the order their RuleSets were accepted.
+  std::unordered_map<QNodeAddr, std::vector<Runtime*>> partner_runtimes;
+
   std::unique_ptr<Runtime::ICallBack> callback;
+
+  /**
+   * @brief the compiled RuleSets by RuleSet::contentKey().
+   *
+   * Many RuleSets are identical except for their id, e.g. link tomography and
+   * purification, so their Runtimes share one compiled RuleSet.
+   */
+  std::unordered_map<std::string, std::weak_ptr<const RuleSet>> compiled_rulesets;
+
+  /// @brief the execution counters shared by all the Runtimes.
+  std::unique_ptr<RuntimeProfile> profile = nullptr;
+
+  /// @brief the trace shared by all the Runtimes.
+  std::unique_ptr<RuntimeTrace> trace = nullptr;
+
+  QubitSelectionPolicy qubit_selection_policy = QubitSelectionPolicy::ASSIGNED_ORDER;
+  int action_budget = 0;
+  utils::MemoryResourceStrategy memory_resource_strategy = utils::MemoryResourceStrategy::Global;
+
+  /// @brief the index of the Runtime the next exec() starts from, rotated while the budget is set.
+  size_t first_runtime = 0;
+
+  /// @brief the buffer of the qubits handed to reclaimQubits, kept to reuse its capacity.
+  std::vector<Runtime::ICallBack::HeldQubit> reclaimed_qubits;
+  std::uint64_t num_reclaimed_qubits = 0;
+
+ private:
+  /// @brief returns the compiled RuleSet from compiled_rulesets, compiles it if there is none.
+  std::shared_ptr<const RuleSet> compile(const RuleSet& ruleset);
+  /// @brief frees the qubits the terminated Runtime still holds.
+  void reclaimQubits(Runtime& runtime);
 };
 }  // namespace quisp::runtime
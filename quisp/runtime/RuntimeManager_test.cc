@@ -3,13 +3,17 @@
 
 #include "RuleSet.h"
 #include "RuntimeManager.h"
+#include "modules/QRSA/RuleEngine/QubitRecord/QubitRecord.h"
 #include "runtime/types.h"
 #include "test.h"
+#include "test_utils/Scaling.h"
 
 namespace {
 using namespace quisp::runtime;
 using namespace quisp_test;
 using namespace testing;
+using quisp::modules::QNIC_E;
+using quisp::modules::qubit_record::QubitRecord;
 
 class RuntimeManagerTest : public testing::Test {
  protected:
@@ -38,10 +42,12 @@ Program checker{"cond", {INSTR_STORE_MemoryKey_int_{{MemoryKey{"test"}, 123}}}};
 TEST_F(RuntimeManagerTest, AcceptRuleSet) {
   RuleSet rs{"test ruleset"};
   EXPECT_EQ(runtimes->size(), 0);
+  auto empty_bytes = runtimes->allocatedBytes();
   runtimes->acceptRuleSet(rs);
   EXPECT_EQ(runtimes->size(), 1);
   auto& runtime = runtimes->at(0);
-  EXPECT_EQ(runtime.ruleset.name, rs.name);
+  EXPECT_EQ(runtime.ruleset->name, rs.name);
+  EXPECT_GE(runtimes->allocatedBytes(), empty_bytes + sizeof(Runtime));
 }
 
 TEST_F(RuntimeManagerTest, FindById) {
@@ -55,9 +61,9 @@ TEST_F(RuntimeManagerTest, FindById) {
   runtimes->acceptRuleSet(rs2);
   runtimes->acceptRuleSet(rs3);
   EXPECT_EQ(runtimes->size(), 3);
-  EXPECT_EQ(runtimes->findById(rs2.id)->ruleset.id, rs2.id);
-  EXPECT_EQ(runtimes->findById(rs1.id)->ruleset.id, rs1.id);
-  EXPECT_EQ(runtimes->findById(rs3.id)->ruleset.id, rs3.id);
+  EXPECT_EQ(runtimes->findById(rs2.id)->ruleset_id, rs2.id);
+  EXPECT_EQ(runtimes->findById(rs1.id)->ruleset_id, rs1.id);
+  EXPECT_EQ(runtimes->findById(rs3.id)->ruleset_id, rs3.id);
 }
 
 TEST_F(RuntimeManagerTest, Iterate) {
@@ -75,9 +81,9 @@ TEST_F(RuntimeManagerTest, Iterate) {
   bool rs1_exist = false, rs2_exist = false, rs3_exist = false;
   for (auto it = runtimes->begin(); it != runtimes->end(); it++) {
     count++;
-    if (it->ruleset.id == rs1.id) rs1_exist = true;
-    if (it->ruleset.id == rs2.id) rs2_exist = true;
-    if (it->ruleset.id == rs3.id) rs3_exist = true;
+    if (it->ruleset_id == rs1.id) rs1_exist = true;
+    if (it->ruleset_id == rs2.id) rs2_exist = true;
+    if (it->ruleset_id == rs3.id) rs3_exist = true;
   }
   EXPECT_EQ(count, 3);
   EXPECT_TRUE(rs1_exist);
@@ -113,6 +119,27 @@ TEST_F(RuntimeManagerTest, Exec) {
   }
 }
 
+TEST_F(RuntimeManagerTest, ExecOnMemoryResource) {
+  Rule rule{
+      "", -1, -1, cond_passed_once, checker,
+  };
+  RuleSet rs1{"", {rule}, empty};
+  rs1.id = 1;
+  RuleSet rs2{"", {rule}, empty};
+  rs2.id = 2;
+  runtimes->acceptRuleSet(rs1);
+  runtimes->setMemoryResourceStrategy(quisp::utils::MemoryResourceStrategy::Monotonic);
+  runtimes->acceptRuleSet(rs2);
+  runtimes->exec();
+  auto& global_runtime = runtimes->at(0);
+  auto& arena_runtime = runtimes->at(1);
+  EXPECT_EQ(global_runtime.memory_resource.getStrategy(), quisp::utils::MemoryResourceStrategy::Global);
+  EXPECT_EQ(arena_runtime.memory_resource.getStrategy(), quisp::utils::MemoryResourceStrategy::Monotonic);
+  EXPECT_EQ(arena_runtime.memory.get_allocator().resource(), arena_runtime.memory_resource.get());
+  EXPECT_EQ(global_runtime.loadVal(MemoryKey{"test"}).intValue(), 123);
+  EXPECT_EQ(arena_runtime.loadVal(MemoryKey{"test"}).intValue(), 123);
+}
+
 TEST_F(RuntimeManagerTest, ExecAndTerminated) {
   Program terminator{"terminator", {INSTR_RET_ReturnCode_{{ReturnCode::RS_TERMINATED}}}};
   Rule rule{
@@ -139,4 +166,275 @@ TEST_F(RuntimeManagerTest, ExecAndTerminated) {
     EXPECT_FALSE(rs3.terminated);
   }
 }
+
+TEST_F(RuntimeManagerTest, ShareCompiledRuleSet) {
+  Rule rule{
+      "", -1, -1, cond_passed_once, checker,
+  };
+  RuleSet rs1{"rs", {rule}, empty};
+  rs1.id = 1;
+  RuleSet rs2{"rs", {rule}, empty};
+  rs2.id = 2;
+  RuleSet rs3{"rs", {rule}, checker};
+  rs3.id = 3;
+  runtimes->acceptRuleSet(rs1);
+  runtimes->acceptRuleSet(rs2);
+  runtimes->acceptRuleSet(rs3);
+  ASSERT_EQ(runtimes->size(), 3);
+  auto& rt1 = runtimes->at(0);
+  auto& rt2 = runtimes->at(1);
+  auto& rt3 = runtimes->at(2);
+  EXPECT_EQ(rt1.ruleset, rt2.ruleset);
+  EXPECT_NE(rt1.ruleset, rt3.ruleset);
+  EXPECT_EQ(rt1.ruleset_id, 1);
+  EXPECT_EQ(rt2.ruleset_id, 2);
+
+  // the memory is not shared
+  rt1.storeVal(MemoryKey{"test"}, MemoryValue{1});
+  EXPECT_THROW(rt2.loadVal(MemoryKey{"test"}), std::runtime_error);
+}
+
+TEST_F(RuntimeManagerTest, StableAddressAndLookupAfterTermination) {
+  Program terminator{"terminator", {INSTR_RET_ReturnCode_{{ReturnCode::RS_TERMINATED}}}};
+  Rule rule{
+      "", -1, -1, cond_passed_once, checker,
+  };
+  RuleSet alive{"alive", {rule}, empty};
+  RuleSet terminated{"terminated", {rule}, terminator};
+  for (int i = 0; i < 10; i++) {
+    auto& rs = i % 2 == 0 ? terminated : alive;
+    rs.id = i;
+    runtimes->acceptRuleSet(rs);
+  }
+  auto* rt9 = runtimes->findById(9);
+  ASSERT_NE(rt9, nullptr);
+  for (int i = 10; i < 100; i++) {
+    alive.id = i;
+    runtimes->acceptRuleSet(alive);
+  }
+  // adding Runtimes doesn't move the others
+  EXPECT_EQ(runtimes->findById(9), rt9);
+
+  runtimes->exec();
+  EXPECT_EQ(runtimes->size(), 95);
+  EXPECT_EQ(runtimes->findById(9), rt9);
+  EXPECT_EQ(runtimes->findById(0), nullptr);
+  EXPECT_EQ(runtimes->findById(8), nullptr);
+  for (int i = 1; i < 100; i += (i < 10 ? 2 : 1)) {
+    ASSERT_NE(runtimes->findById(i), nullptr);
+    EXPECT_EQ(runtimes->findById(i)->ruleset_id, i);
+  }
+  // the order is kept
+  EXPECT_EQ(runtimes->at(0).ruleset_id, 1);
+  EXPECT_EQ(runtimes->at(4).ruleset_id, 9);
+  EXPECT_EQ(runtimes->at(5).ruleset_id, 10);
+}
+
+TEST_F(RuntimeManagerTest, ExecOnlyDirtyRuntimes) {
+  Program cond_failed{"cond_failed", {INSTR_RET_ReturnCode_{{ReturnCode::COND_FAILED}}}};
+  Rule rule{"", -1, 0, cond_failed, empty};
+  RuleSet rs{"rs", {rule}, empty};
+  rs.id = 1;
+  runtimes->acceptRuleSet(rs);
+  auto* runtime = runtimes->findById(1);
+  EXPECT_TRUE(runtime->dirty);
+  runtimes->exec();
+  // the condition failed without changing anything
+  EXPECT_FALSE(runtime->dirty);
+
+  // exec() sets the rule_id, so it stays -1 while the Runtime is skipped
+  runtime->rule_id = -1;
+  runtimes->exec();
+  EXPECT_EQ(runtime->rule_id, -1);
+
+  MessageRecord message{0, 0, 0};
+  runtime->assignMessageToRuleSet(0, message);
+  EXPECT_TRUE(runtime->dirty);
+  runtimes->exec();
+  EXPECT_EQ(runtime->rule_id, 0);
+  EXPECT_FALSE(runtime->dirty);
+}
+
+TEST_F(RuntimeManagerTest, FindByPartner) {
+  auto uses_partner = [](QNodeAddr partner_addr) {
+    return Program{"get qubit",
+                   {
+                       INSTR_GET_QUBIT_QubitId_QNodeAddr_int_{{QubitId{0}, partner_addr, 0}},
+                       INSTR_RET_ReturnCode_{{ReturnCode::COND_FAILED}},
+                   }};
+  };
+  Program terminator{"terminator", {INSTR_RET_ReturnCode_{{ReturnCode::RS_TERMINATED}}}};
+  RuleSet rs1{"partner 1", {Rule{"rule", -1, -1, uses_partner(QNodeAddr{1}), empty}}, terminator};
+  rs1.id = 1;
+  RuleSet rs2{"partner 1 and 2", {Rule{"rule", -1, -1, uses_partner(QNodeAddr{1}), empty}, Rule{"rule", -1, -1, uses_partner(QNodeAddr{2}), empty}}};
+  rs2.id = 2;
+  runtimes->acceptRuleSet(rs1);
+  runtimes->acceptRuleSet(rs2);
+  // the first accepted one
+  EXPECT_EQ(runtimes->findByPartner(QNodeAddr{1})->ruleset_id, 1);
+  EXPECT_EQ(runtimes->findByPartner(QNodeAddr{2})->ruleset_id, 2);
+  EXPECT_EQ(runtimes->findByPartner(QNodeAddr{3}), nullptr);
+
+  // the terminated Runtime is removed from the index
+  auto& runtime = runtimes->at(0);
+  runtime.terminated = true;
+  runtimes->exec();
+  EXPECT_EQ(runtimes->findByPartner(QNodeAddr{1})->ruleset_id, 2);
+}
+
+TEST_F(RuntimeManagerTest, ReclaimQubitsOfTerminatedRuntime) {
+  Program get_qubit{"get qubit",
+                    {
+                        INSTR_GET_QUBIT_QubitId_QNodeAddr_int_{{QubitId{0}, QNodeAddr{1}, 0}},
+                        INSTR_RET_ReturnCode_{{ReturnCode::COND_FAILED}},
+                    }};
+  RuleSet rs1{"terminated", {Rule{"rule", 5, 5, get_qubit, empty}}};
+  rs1.id = 1;
+  RuleSet rs2{"alive", {Rule{"rule", 6, 6, get_qubit, empty}}};
+  rs2.id = 2;
+  auto* terminated = runtimes->acceptRuleSet(rs1);
+  auto* alive = runtimes->acceptRuleSet(rs2);
+  QubitRecord qubit1{QNIC_E, 0, 1}, qubit2{QNIC_E, 0, 2}, qubit3{QNIC_E, 0, 3};
+  terminated->assignQubitToRuleSet(QNodeAddr{1}, &qubit1);
+  terminated->assignQubitToRuleSet(QNodeAddr{1}, &qubit2);
+  alive->assignQubitToRuleSet(QNodeAddr{1}, &qubit3);
+
+  terminated->terminate();
+  EXPECT_CALL(*callback, freeAndResetQubit(&qubit1)).Times(1);
+  EXPECT_CALL(*callback, freeAndResetQubit(&qubit2)).Times(1);
+  EXPECT_CALL(*callback, freeAndResetQubit(&qubit3)).Times(0);
+  runtimes->exec();
+  EXPECT_EQ(runtimes->size(), 1);
+  EXPECT_EQ(runtimes->numReclaimedQubits(), 2);
+}
+
+TEST_F(RuntimeManagerTest, ExtendRuleSet) {
+  auto uses_partner = [](QNodeAddr partner_addr) {
+    return Program{"get qubit",
+                   {
+                       INSTR_GET_QUBIT_QubitId_QNodeAddr_int_{{QubitId{0}, partner_addr, 0}},
+                       INSTR_RET_ReturnCode_{{ReturnCode::COND_FAILED}},
+                   }};
+  };
+  Program terminator{"terminator", {INSTR_RET_ReturnCode_{{ReturnCode::RS_TERMINATED}}}};
+  RuleSet link_rs{"link", {Rule{"link", -1, -1, uses_partner(QNodeAddr{1}), empty}}};
+  link_rs.id = 1;
+  auto* runtime = runtimes->acceptRuleSet(link_rs);
+  EXPECT_EQ(runtimes->findByPartner(QNodeAddr{2}), nullptr);
+
+  RuleSet tail{"swap", {Rule{"swap", -1, -1, uses_partner(QNodeAddr{2}), empty}}, terminator};
+  tail.id = 1;
+  runtimes->extendRuleSet(runtime, tail);
+  EXPECT_EQ(runtimes->size(), 1);
+  ASSERT_EQ(runtime->ruleset->rules.size(), 2);
+  EXPECT_EQ(runtime->ruleset->rules[0].name, "link");
+  EXPECT_EQ(runtime->ruleset->rules[1].name, "swap");
+  EXPECT_EQ(runtime->ruleset->termination_condition.name, "terminator");
+  EXPECT_EQ(runtimes->findByPartner(QNodeAddr{1}), runtime);
+  EXPECT_EQ(runtimes->findByPartner(QNodeAddr{2}), runtime);
+  EXPECT_EQ(runtimes->findById(1), runtime);
+}
+
+TEST_F(RuntimeManagerTest, Profile) {
+  Rule rule{"rule", -1, -1, cond_passed_once, checker};
+  RuleSet rs1{"profiled", {rule}, empty};
+  rs1.id = 1;
+  RuleSet rs2{"profiled", {rule}, empty};
+  rs2.id = 2;
+  EXPECT_EQ(runtimes->getProfile(), nullptr);
+  runtimes->acceptRuleSet(rs1);
+  // time every Program execution
+  runtimes->enableProfiling(1);
+  runtimes->acceptRuleSet(rs2);
+  runtimes->exec();
+
+  auto* profile = runtimes->getProfile();
+  ASSERT_NE(profile, nullptr);
+  // the condition passes once and then fails in each Runtime
+  auto& rule_count = profile->ruleCounts().at("profiled/rule");
+  EXPECT_EQ(rule_count.condition_passed, 2);
+  EXPECT_EQ(rule_count.condition_failed, 2);
+
+  auto opcodes = profile->opcodeCounts();
+  EXPECT_EQ(opcodes.at("LOAD"), 4);
+  EXPECT_EQ(opcodes.at("BEZ"), 4);
+  EXPECT_EQ(opcodes.at("INC"), 2);
+  // the condition and the action store a value
+  EXPECT_EQ(opcodes.at("STORE"), 4);
+  EXPECT_EQ(opcodes.at("RET"), 4);
+
+  auto& programs = profile->programTimes();
+  EXPECT_EQ(programs.at("profiled/rule/condition").sampled, 4);
+  EXPECT_EQ(programs.at("profiled/rule/action").sampled, 2);
+  EXPECT_EQ(programs.at("profiled/termination").sampled, 2);
+
+  auto json = profile->toJson();
+  EXPECT_EQ(json["rules"]["profiled/rule"]["condition_passed"], 2);
+  EXPECT_EQ(json["opcodes"]["LOAD"], 4);
+}
+
+TEST_F(RuntimeManagerTest, ExecWithActionBudget) {
+  MemoryKey count{"count"};
+  Label passed{"passed"};
+  // passes 5 times
+  Program cond_passed_five_times{"passed_five_times",
+                                 {
+                                     INSTR_LOAD_RegId_MemoryKey_{{RegId::REG0, count}},
+                                     INSTR_BLT_Label_RegId_int_{{passed, RegId::REG0, 5}},
+                                     INSTR_RET_ReturnCode_{{ReturnCode::COND_FAILED}},
+                                     INSTR_INC_RegId_{{RegId::REG0}, passed},
+                                     INSTR_STORE_MemoryKey_RegId_{{count, RegId::REG0}},
+                                     INSTR_RET_ReturnCode_{{ReturnCode::COND_PASSED}},
+                                 }};
+  Rule rule{"", -1, -1, cond_passed_five_times, empty};
+  RuleSet rs1{"rs1", {rule}, empty};
+  rs1.id = 1;
+  RuleSet rs2{"rs2", {Rule{"", -1, -1, cond_passed_once, checker}, rule}, empty};
+  rs2.id = 2;
+  runtimes->setActionBudget(2);
+  runtimes->acceptRuleSet(rs1);
+  runtimes->acceptRuleSet(rs2);
+
+  // each Runtime runs 2 actions and carries the rest over
+  EXPECT_TRUE(runtimes->exec());
+  EXPECT_EQ(runtimes->at(0).loadVal(count).intValue(), 2);
+  // the first rule of rs2 passes once with the count of 0
+  EXPECT_EQ(runtimes->at(1).loadVal(MemoryKey{"test"}).intValue(), 123);
+  EXPECT_EQ(runtimes->at(1).loadVal(count).intValue(), 2);
+  EXPECT_TRUE(runtimes->at(1).yielded);
+
+  // rs2 goes on from its second rule
+  EXPECT_TRUE(runtimes->exec());
+  EXPECT_EQ(runtimes->at(0).loadVal(count).intValue(), 4);
+  EXPECT_EQ(runtimes->at(1).loadVal(count).intValue(), 4);
+  EXPECT_FALSE(runtimes->exec());
+  EXPECT_EQ(runtimes->at(0).loadVal(count).intValue(), 5);
+  EXPECT_EQ(runtimes->at(1).loadVal(count).intValue(), 5);
+  EXPECT_FALSE(runtimes->at(0).yielded);
+  EXPECT_FALSE(runtimes->at(1).yielded);
+
+  // no limit
+  runtimes->setActionBudget(0);
+  RuleSet rs3{"rs3", {rule}, empty};
+  rs3.id = 3;
+  runtimes->acceptRuleSet(rs3);
+  EXPECT_FALSE(runtimes->exec());
+  EXPECT_EQ(runtimes->at(2).loadVal(count).intValue(), 5);
+}
+TEST(RuntimeManagerScalingTest, FindByIdIsConstantTime) {
+  auto setup = [](std::size_t n) {
+    auto runtimes = std::make_unique<RuntimeManager>(std::make_unique<MockRuntimeCallback>());
+    for (std::size_t i = 1; i <= n; i++) {
+      RuleSet rs{};
+      rs.id = i;
+      runtimes->acceptRuleSet(rs);
+    }
+    return runtimes;
+  };
+  auto find_all = [](std::unique_ptr<RuntimeManager> &runtimes) {
+    for (unsigned long long id = runtimes->size(); id >= 1; id--) ASSERT_NE(runtimes->findById(id), nullptr);
+  };
+  EXPECT_LT(quisp_test::scaling::growthExponent(1 << 10, setup, find_all), 1.5);
+}
+
 }  // namespace
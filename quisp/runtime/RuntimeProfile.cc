@@ -0,0 +1,87 @@
+#include "RuntimeProfile.h"
+
+#include <array>
+#include <map>
+#include <utility>
+
+namespace quisp::runtime {
+
+namespace {
+template <typename I>
+struct OpcodeOf;
+template <class OpLit, class... Operands>
+struct OpcodeOf<Instruction<OpLit, Operands...>> {
+  static constexpr int value = OpLit::Value;
+};
+
+template <std::size_t... I>
+constexpr std::array<int, sizeof...(I)> makeOpcodes(std::index_sequence<I...>) {
+  return {OpcodeOf<std::variant_alternative_t<I, InstructionTypes>>::value...};
+}
+
+// the opcodes indexed by the alternative of InstructionTypes
+constexpr auto opcodes = makeOpcodes(std::make_index_sequence<std::variant_size_v<InstructionTypes>>{});
+
+std::string ruleKey(const std::string& ruleset_name, const std::string& rule_name) { return ruleset_name + "/" + rule_name; }
+
+// sorted to make the output stable
+template <typename T>
+std::map<std::string, T> sorted(const std::unordered_map<std::string, T>& m) {
+  return {m.begin(), m.end()};
+}
+}  // namespace
+
+RuntimeProfile::RuntimeProfile(std::uint64_t sample_interval) : sample_interval(sample_interval) {}
+
+void RuntimeProfile::countCondition(const std::string& ruleset_name, const std::string& rule_name, bool passed) {
+  auto& count = rule_counts[ruleKey(ruleset_name, rule_name)];
+  if (passed) {
+    count.condition_passed++;
+  } else {
+    count.condition_failed++;
+  }
+}
+
+void RuntimeProfile::addSampledTime(const std::string& program_key, std::chrono::nanoseconds time) {
+  auto& program_time = program_times[program_key];
+  program_time.sampled++;
+  program_time.total += time;
+}
+
+std::unordered_map<std::string, std::uint64_t> RuntimeProfile::opcodeCounts() const {
+  std::unordered_map<std::string, std::uint64_t> counts;
+  for (std::size_t i = 0; i < instruction_counts.size(); i++) {
+    if (instruction_counts[i] > 0) counts[OpTypeStr[opcodes[i]]] += instruction_counts[i];
+  }
+  return counts;
+}
+
+void RuntimeProfile::forEachCounter(const std::function<void(const std::string&, double)>& f) const {
+  for (auto& [opcode, count] : sorted(opcodeCounts())) f("runtime opcode " + opcode, count);
+  for (auto& [rule, count] : sorted(rule_counts)) {
+    f("runtime rule " + rule + " condition passed", count.condition_passed);
+    f("runtime rule " + rule + " condition failed", count.condition_failed);
+  }
+  for (auto& [program, time] : sorted(program_times)) {
+    f("runtime program " + program + " sampled", time.sampled);
+    f("runtime program " + program + " sampled time (ns)", time.total.count());
+  }
+}
+
+nlohmann::json RuntimeProfile::toJson() const {
+  nlohmann::json profile;
+  profile["sample_interval"] = sample_interval;
+  profile["opcodes"] = nlohmann::json::object();
+  for (auto& [opcode, count] : opcodeCounts()) profile["opcodes"][opcode] = count;
+  profile["rules"] = nlohmann::json::object();
+  for (auto& [rule, count] : rule_counts) {
+    profile["rules"][rule] = {{"condition_passed", count.condition_passed}, {"condition_failed", count.condition_failed}};
+  }
+  profile["programs"] = nlohmann::json::object();
+  for (auto& [program, time] : program_times) {
+    profile["programs"][program] = {{"sampled", time.sampled}, {"sampled_time_ns", time.total.count()}};
+  }
+  return profile;
+}
+
+}  // namespace quisp::runtime
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include "opcode.h"
+
+namespace quisp::runtime {
+
+/**
+ * @brief execution counters of the Runtimes, aggregated by the RuntimeManager.
+ *
+ * The Runtimes count the executed instructions and the condition results of
+ * each Rule. Every sample_interval-th Program execution is also timed with a
+ * wall clock, which is cheap enough to leave on in large runs.
+ * The Rules and Programs are identified by their names, since the RuleSets
+ * come and go during the simulation.
+ */
+class RuntimeProfile {
+ public:
+  struct RuleCount {
+    std::uint64_t condition_passed = 0;
+    std::uint64_t condition_failed = 0;
+  };
+
+  struct ProgramTime {
+    std::uint64_t sampled = 0;
+    std::chrono::nanoseconds total{0};
+  };
+
+  explicit RuntimeProfile(std::uint64_t sample_interval = 64);
+
+  /// @brief count the instruction by its alternative index of InstructionTypes.
+  void countInstruction(std::size_t index) { instruction_counts[index]++; }
+
+  void countCondition(const std::string& ruleset_name, const std::string& rule_name, bool passed);
+
+  /// @brief returns true if this Program execution should be timed.
+  bool shouldSample() { return sample_interval > 0 && ++program_executions % sample_interval == 0; }
+
+  void addSampledTime(const std::string& program_key, std::chrono::nanoseconds time);
+
+  /// @brief the instruction counts aggregated by the opcode name, e.g. "MEASURE".
+  std::unordered_map<std::string, std::uint64_t> opcodeCounts() const;
+
+  /// @brief calls f(name, value) for each executed opcode and each counter of the evaluated rules and the sampled programs,
+  /// zeros included, e.g. to record them as scalars.
+  void forEachCounter(const std::function<void(const std::string&, double)>& f) const;
+
+  nlohmann::json toJson() const;
+
+  const std::unordered_map<std::string, RuleCount>& ruleCounts() const { return rule_counts; }
+  const std::unordered_map<std::string, ProgramTime>& programTimes() const { return program_times; }
+
+ protected:
+  std::uint64_t sample_interval;
+  std::uint64_t program_executions = 0;
+  std::vector<std::uint64_t> instruction_counts = std::vector<std::uint64_t>(std::variant_size_v<InstructionTypes>, 0);
+
+  /// @brief "ruleset name/rule name" => condition results
+  std::unordered_map<std::string, RuleCount> rule_counts;
+
+  /// @brief "ruleset name/rule name/condition" etc. => sampled wall clock time
+  std::unordered_map<std::string, ProgramTime> program_times;
+};
+
+}  // namespace quisp::runtime
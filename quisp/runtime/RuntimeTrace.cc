@@ -0,0 +1,141 @@
+#include "RuntimeTrace.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+#include "opcode.h"
+
+namespace quisp::runtime {
+
+namespace {
+template <typename T>
+void writeRaw(std::ostream& os, const T& value) {
+  os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+}  // namespace
+
+RingBufferTraceSink::RingBufferTraceSink(std::size_t capacity) : capacity(capacity) {
+  if (capacity == 0) throw std::invalid_argument("RingBufferTraceSink: the capacity must not be 0");
+  buffer.reserve(capacity);
+}
+
+void RingBufferTraceSink::write(const TraceEvent& event, const RuntimeTrace& trace) {
+  if (buffer.size() < capacity) {
+    buffer.push_back(event);
+  } else {
+    buffer[num_written % capacity] = event;
+  }
+  num_written++;
+}
+
+std::vector<TraceEvent> RingBufferTraceSink::events() const {
+  if (buffer.size() < capacity) return buffer;
+  // the oldest event is the next one to be overwritten
+  auto oldest = buffer.begin() + num_written % capacity;
+  std::vector<TraceEvent> events(oldest, buffer.end());
+  events.insert(events.end(), buffer.begin(), oldest);
+  return events;
+}
+
+void RingBufferTraceSink::writeBinary(std::ostream& os, const RuntimeTrace& trace, std::int32_t source) const {
+  os.write("QRTRACE1", 8);
+  writeRaw(os, source);
+  writeRaw(os, static_cast<std::uint32_t>(sizeof(TraceEvent)));
+  writeRaw(os, static_cast<std::uint64_t>(buffer.size()));
+  writeRaw(os, num_written);
+  writeRaw(os, static_cast<std::uint32_t>(trace.numStrings()));
+  auto kept = events();
+  os.write(reinterpret_cast<const char*>(kept.data()), kept.size() * sizeof(TraceEvent));
+  for (std::size_t id = 0; id < trace.numStrings(); id++) {
+    auto& str = trace.stringOf(id);
+    writeRaw(os, static_cast<std::uint32_t>(str.size()));
+    os.write(str.data(), str.size());
+  }
+}
+
+void StreamTraceSink::write(const TraceEvent& event, const RuntimeTrace& trace) {
+  os << "RuleSet(" << event.ruleset_id << ")";
+  if (event.rule_id >= 0) os << " Rule(" << event.rule_id << ")";
+  auto& values = event.values;
+  switch (event.type) {
+    case TraceEventType::ExecRuleSet:
+      os << " exec";
+      break;
+    case TraceEventType::ExecRule:
+      os << " condition";
+      break;
+    case TraceEventType::ConditionResult:
+      os << " " << static_cast<ReturnCode>(values[0]);
+      break;
+    case TraceEventType::Instruction:
+      os << " " << event.pc << ": " << OpTypeStr[event.opcode] << " Reg0: " << values[0] << ", Reg1: " << values[1] << ", Reg2: " << values[2] << ", Reg3: " << values[3]
+         << ", Reg4: " << values[4];
+      break;
+    case TraceEventType::DebugQubit:
+      os << " Debug(QubitId:" << values[0] << "): qnic type: " << values[1] << ", qnic index: " << values[2] << ", qubit index: " << values[3];
+      break;
+    case TraceEventType::DebugString:
+      os << " Debug(string): " << trace.stringOf(values[0]);
+      break;
+    case TraceEventType::DebugRegister:
+      os << " Debug(Reg): " << values[0];
+      break;
+  }
+  os << "\n";
+}
+
+bool TraceFilter::traces(std::uint64_t ruleset_id, RuleId rule_id) const {
+  if (rules.empty()) return true;
+  auto it = rules.find(ruleset_id);
+  if (it == rules.end()) return false;
+  auto& rule_ids = it->second;
+  return rule_id < 0 || rule_ids.empty() || std::find(rule_ids.begin(), rule_ids.end(), rule_id) != rule_ids.end();
+}
+
+TraceFilter TraceFilter::parse(std::string_view spec) {
+  TraceFilter filter;
+  std::size_t begin = 0;
+  while (begin < spec.size()) {
+    auto end = spec.find(' ', begin);
+    if (end == std::string_view::npos) end = spec.size();
+    auto entry = std::string(spec.substr(begin, end - begin));
+    begin = end + 1;
+    if (entry.empty()) continue;
+    auto colon = entry.find(':');
+    try {
+      std::size_t parsed = 0;
+      auto ruleset_id = std::stoull(entry.substr(0, colon), &parsed);
+      if (parsed != std::min(colon, entry.size())) throw std::invalid_argument(entry);
+      auto& rule_ids = filter.rules[ruleset_id];
+      if (colon == std::string::npos) continue;
+      auto rule_id = std::stoi(entry.substr(colon + 1), &parsed);
+      if (parsed != entry.size() - colon - 1 || rule_id < 0) throw std::invalid_argument(entry);
+      rule_ids.push_back(rule_id);
+    } catch (const std::logic_error&) {
+      throw std::invalid_argument("invalid trace filter entry: " + entry);
+    }
+  }
+  return filter;
+}
+
+RuntimeTrace::RuntimeTrace(std::unique_ptr<ITraceSink> sink, TraceFilter filter) : sink(std::move(sink)), filter(std::move(filter)) {}
+
+std::int32_t RuntimeTrace::internString(const std::string& str) {
+  auto [it, inserted] = string_ids.emplace(str, strings.size());
+  if (inserted) strings.push_back(str);
+  return it->second;
+}
+
+const std::string& RuntimeTrace::stringOf(std::int32_t id) const {
+  static const std::string unknown;
+  return id >= 0 && id < (std::int32_t)strings.size() ? strings[id] : unknown;
+}
+
+RuntimeTrace& RuntimeTrace::debugTrace() {
+  // a trace per thread, the simulations on the other threads keep their strings apart
+  static thread_local RuntimeTrace trace{std::make_unique<StreamTraceSink>(std::cout)};
+  return trace;
+}
+
+}  // namespace quisp::runtime
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "types.h"
+
+namespace quisp::runtime {
+
+enum class TraceEventType : std::uint16_t {
+  /// @brief the Runtime starts executing its RuleSet, the rule_id is -1.
+  ExecRuleSet,
+  /// @brief the Runtime starts the condition of the rule.
+  ExecRule,
+  /// @brief values[0] is the ReturnCode of the condition.
+  ConditionResult,
+  /// @brief the instruction at the pc was executed, the opcode is its OpType and the values are the registers after it.
+  Instruction,
+  /// @brief DEBUG of a qubit, the values are the QubitId, the qnic type, the qnic index and the qubit index.
+  DebugQubit,
+  /// @brief DEBUG of a string, values[0] is the id of the string in RuntimeTrace::stringOf().
+  DebugString,
+  /// @brief DEBUG of a register, values[0] is its value.
+  DebugRegister,
+};
+
+/**
+ * @brief a fixed size record of the Runtime execution.
+ *
+ * The RuleSets, the rules, the opcodes and the strings are ids instead of formatted names,
+ * so a sink can keep the events as they are, and the names are looked up in post-processing.
+ */
+struct TraceEvent {
+  std::uint64_t ruleset_id = 0;
+  RuleId rule_id = -1;
+  std::uint32_t pc = 0;
+  TraceEventType type = TraceEventType::ExecRuleSet;
+  std::uint16_t opcode = 0;
+  std::int32_t values[5] = {0, 0, 0, 0, 0};
+};
+
+class RuntimeTrace;
+
+/// @brief where a RuntimeTrace writes its events.
+class ITraceSink {
+ public:
+  virtual ~ITraceSink() {}
+  /// @param trace the trace writing the event, for the names of its ids
+  virtual void write(const TraceEvent& event, const RuntimeTrace& trace) = 0;
+};
+
+/// @brief keeps the last capacity events in memory, cheap enough to leave on in large runs.
+class RingBufferTraceSink : public ITraceSink {
+ public:
+  /// @throws std::invalid_argument if the capacity is 0
+  explicit RingBufferTraceSink(std::size_t capacity);
+  void write(const TraceEvent& event, const RuntimeTrace& trace) override;
+
+  /// @brief the kept events, the oldest first.
+  std::vector<TraceEvent> events() const;
+  /// @brief the events written so far, including the overwritten ones.
+  std::uint64_t numWritten() const { return num_written; }
+
+  /**
+   * @brief writes the header, the kept events as raw TraceEvents, and the strings of the trace.
+   *
+   * header: "QRTRACE1", int32 source, uint32 sizeof(TraceEvent), uint64 number of the kept events, uint64 numWritten(), uint32 number of the strings.
+   * each string follows the events as uint32 length and the bytes.
+   * @param source the id of the writer, e.g. the QNode address, so the traces of the nodes can be appended to one file
+   */
+  void writeBinary(std::ostream& os, const RuntimeTrace& trace, std::int32_t source) const;
+
+ protected:
+  std::vector<TraceEvent> buffer;
+  std::size_t capacity;
+  std::uint64_t num_written = 0;
+};
+
+/// @brief formats each event into a line of the stream, e.g. of the stdout for debugging.
+class StreamTraceSink : public ITraceSink {
+ public:
+  explicit StreamTraceSink(std::ostream& os) : os(os) {}
+  void write(const TraceEvent& event, const RuntimeTrace& trace) override;
+
+ protected:
+  std::ostream& os;
+};
+
+/**
+ * @brief the RuleSets and the rules a RuntimeTrace records, all of them if it's empty.
+ *
+ * The other Runtimes execute without tracing, so a suspect connection can be traced in a large run.
+ */
+struct TraceFilter {
+  /// @brief [ruleset_id] => the traced rule ids, empty for all the rules of the RuleSet.
+  std::unordered_map<std::uint64_t, std::vector<RuleId>> rules;
+
+  /// @brief a rule_id below 0 stands for the RuleSet itself, traced if any of its rules is.
+  bool traces(std::uint64_t ruleset_id, RuleId rule_id) const;
+
+  /**
+   * @brief parses the space separated "ruleset_id" or "ruleset_id:rule_id", e.g. "12 34:0 34:2".
+   * @throws std::invalid_argument for a malformed entry
+   */
+  static TraceFilter parse(std::string_view spec);
+};
+
+/**
+ * @brief the trace of the Runtimes, shared by the Runtimes of a RuntimeManager like the RuntimeProfile.
+ *
+ * A Runtime writes the events of the rules passing the filter, or of all its rules with the debugging flag,
+ * to debugTrace() if no trace is set.
+ */
+class RuntimeTrace {
+ public:
+  explicit RuntimeTrace(std::unique_ptr<ITraceSink> sink, TraceFilter filter = {});
+
+  bool traces(std::uint64_t ruleset_id, RuleId rule_id) const { return filter.traces(ruleset_id, rule_id); }
+  void write(const TraceEvent& event) { sink->write(event, *this); }
+
+  /// @brief returns the id of the string, the same id for the same string.
+  std::int32_t internString(const std::string& str);
+  /// @brief the string of the id, an empty string for an unknown id.
+  const std::string& stringOf(std::int32_t id) const;
+  std::size_t numStrings() const { return strings.size(); }
+
+  ITraceSink* getSink() const { return sink.get(); }
+
+  /// @brief the trace writing to the stdout, for the Rules and RuleSets with the debugging flag.
+  static RuntimeTrace& debugTrace();
+
+ protected:
+  std::unique_ptr<ITraceSink> sink;
+  TraceFilter filter;
+  std::vector<std::string> strings;
+  std::unordered_map<std::string, std::int32_t> string_ids;
+};
+
+}  // namespace quisp::runtime
@@ -0,0 +1,74 @@
+#include "RuntimeTrace.h"
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+using namespace quisp::runtime;
+
+TraceEvent eventOf(std::uint32_t pc) {
+  TraceEvent event;
+  event.type = TraceEventType::Instruction;
+  event.pc = pc;
+  return event;
+}
+
+TEST(RuntimeTraceTest, RingBufferKeepsTheLastEvents) {
+  auto sink = std::make_unique<RingBufferTraceSink>(3);
+  auto* ring = sink.get();
+  RuntimeTrace trace{std::move(sink)};
+  for (std::uint32_t pc = 0; pc < 5; pc++) trace.write(eventOf(pc));
+  auto events = ring->events();
+  ASSERT_EQ(events.size(), 3);
+  EXPECT_EQ(events[0].pc, 2);
+  EXPECT_EQ(events[2].pc, 4);
+  EXPECT_EQ(ring->numWritten(), 5);
+
+  std::stringstream binary;
+  trace.internString("hello");
+  ring->writeBinary(binary, trace, 7);
+  // the header, the kept events and one string
+  EXPECT_EQ(binary.str().size(), 8 + 4 + 4 + 8 + 8 + 4 + 3 * sizeof(TraceEvent) + 4 + 5);
+  EXPECT_EQ(binary.str().substr(0, 8), "QRTRACE1");
+  EXPECT_THROW(RingBufferTraceSink{0}, std::invalid_argument);
+}
+
+TEST(RuntimeTraceTest, InternStrings) {
+  RuntimeTrace trace{std::make_unique<RingBufferTraceSink>(1)};
+  auto id = trace.internString("suspect");
+  EXPECT_EQ(trace.internString("other"), id + 1);
+  EXPECT_EQ(trace.internString("suspect"), id);
+  EXPECT_EQ(trace.stringOf(id), "suspect");
+  EXPECT_EQ(trace.stringOf(100), "");
+}
+
+TEST(RuntimeTraceTest, ParseFilter) {
+  EXPECT_TRUE(TraceFilter::parse("").traces(1, 0));
+
+  auto filter = TraceFilter::parse("12 34:0  34:2");
+  EXPECT_TRUE(filter.traces(12, 5));
+  EXPECT_TRUE(filter.traces(34, 2));
+  EXPECT_FALSE(filter.traces(34, 1));
+  // the RuleSet itself is traced with any of its rules
+  EXPECT_TRUE(filter.traces(34, -1));
+  EXPECT_FALSE(filter.traces(56, -1));
+
+  EXPECT_THROW(TraceFilter::parse("12:"), std::invalid_argument);
+  EXPECT_THROW(TraceFilter::parse("1x"), std::invalid_argument);
+  EXPECT_THROW(TraceFilter::parse("12:-1"), std::invalid_argument);
+}
+
+TEST(RuntimeTraceTest, StreamSinkFormatsTheNames) {
+  std::stringstream out;
+  RuntimeTrace trace{std::make_unique<StreamTraceSink>(out)};
+  TraceEvent event;
+  event.ruleset_id = 3;
+  event.rule_id = 1;
+  event.type = TraceEventType::DebugString;
+  event.values[0] = trace.internString("hello");
+  trace.write(event);
+  EXPECT_EQ(out.str(), "RuleSet(3) Rule(1) Debug(string): hello\n");
+}
+
+}  // namespace
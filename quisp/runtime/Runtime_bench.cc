@@ -0,0 +1,144 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "modules/QNIC.h"
+#include "modules/QRSA/RuleEngine/QubitRecord/QubitRecord.h"
+#include "rules/RuleSet.h"
+#include "rules/RuleSetConverter/RuleSetConverter.h"
+#include "runtime/Runtime.h"
+#include "test_utils/TestUtils.h"
+
+namespace {
+// the heap allocations since the start of the process, reported per iteration by the benchmarks.
+std::atomic<long> num_allocations{0};
+}  // namespace
+
+void* operator new(std::size_t size) {
+  num_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) return ptr;
+  throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace {
+using namespace quisp::runtime;
+using quisp::modules::QNIC_E;
+using quisp::modules::qubit_record::QubitRecord;
+using quisp::rules::rs_converter::RuleSetConverter;
+
+// callback that answers every operation immediately, so only the Runtime itself is measured.
+class BenchRuntimeCallback : public Runtime::ICallBack {
+ public:
+  void freeAndResetQubit(IQubitRecord*) override {}
+  bool isQubitLocked(IQubitRecord* const) override { return false; }
+  void lockQubit(IQubitRecord* const, unsigned long rs_id, int rule_id, int action_index) override {}
+  int getActionIndex(IQubitRecord* const) override { return 0; }
+  MeasurementOutcome measureQubitRandomly(IQubitRecord*) override { return MeasurementOutcome{.basis = 'Z', .outcome_is_plus = true}; }
+  MeasurementOutcome measureQubitX(IQubitRecord*) override { return MeasurementOutcome{.basis = 'X', .outcome_is_plus = true}; }
+  MeasurementOutcome measureQubitZ(IQubitRecord*) override { return MeasurementOutcome{.basis = 'Z', .outcome_is_plus = true}; }
+  MeasurementOutcome measureQubitY(IQubitRecord*) override { return MeasurementOutcome{.basis = 'Y', .outcome_is_plus = true}; }
+  void gateX(IQubitRecord*) override {}
+  void gateZ(IQubitRecord*) override {}
+  void gateY(IQubitRecord*) override {}
+  void gateCNOT(IQubitRecord* control_qubit_rec, IQubitRecord* target_qubit_rec) override {}
+  int purifyX(IQubitRecord* qubit_rec, IQubitRecord* trash_qubit_rec) override { return 0; }
+  int purifyZ(IQubitRecord* qubit_rec, IQubitRecord* trash_qubit_rec) override { return 0; }
+  int purifyY(IQubitRecord* qubit_rec, IQubitRecord* trash_qubit_rec) override { return 0; }
+  int bellMeasure(IQubitRecord* control_qubit_rec, IQubitRecord* target_qubit_rec) override { return 0; }
+  void sendLinkTomographyResult(const unsigned long ruleset_id, const Rule& rule, const int action_index, const QNodeAddr partner_addr, int count, MeasurementOutcome outcome,
+                                int max_count, Time start_time) override {}
+  void sendPurificationResult(const unsigned long ruleset_id, const QNodeAddr partner_addr, const int shared_rule_tag, const int sequence_number, const int measurement_result,
+                              PurType protocol) override {}
+  void sendSwappingResult(const unsigned long ruleset_id, const QNodeAddr partner_addr, const QNodeAddr new_partner_addr, const int shared_rule_tag,
+                          const int sequence_number, const int frame_correction) override {}
+};
+
+// reports the allocations since `start` as the average per iteration.
+void reportAllocations(benchmark::State& state, long start) {
+  state.counters["allocations"] = benchmark::Counter(num_allocations.load(std::memory_order_relaxed) - start, benchmark::Counter::kAvgIterations);
+}
+
+// same rule as RuleSetGenerator::tomographyRule, with enough measurements to never terminate.
+RuleSet tomographyRuleSet(int owner_addr, int partner_addr) {
+  using namespace quisp::rules;
+  quisp::rules::RuleSet rs(1, owner_addr);
+  auto rule = std::make_unique<quisp::rules::Rule>(partner_addr, 0, 0);
+  auto condition = std::make_unique<Condition>();
+  condition->addClause(std::make_unique<EnoughResourceConditionClause>(1, partner_addr));
+  condition->addClause(std::make_unique<MeasureCountConditionClause>(1 << 30, partner_addr));
+  rule->setCondition(std::move(condition));
+  rule->setAction(std::make_unique<Tomography>(1 << 30, owner_addr, partner_addr));
+  rs.addRule(std::move(rule));
+  return RuleSetConverter::construct(rs);
+}
+
+// same rule as RuleSetGenerator::swapRule.
+RuleSet swappingRuleSet(int owner_addr, int left_addr, int right_addr) {
+  using namespace quisp::rules;
+  quisp::rules::RuleSet rs(1, owner_addr);
+  auto rule = std::make_unique<quisp::rules::Rule>(std::vector<int>{left_addr, right_addr}, 0, -1);
+  auto condition = std::make_unique<Condition>();
+  condition->addClause(std::make_unique<EnoughResourceConditionClause>(1, left_addr));
+  condition->addClause(std::make_unique<EnoughResourceConditionClause>(1, right_addr));
+  rule->setCondition(std::move(condition));
+  rule->setAction(std::make_unique<EntanglementSwapping>(std::vector<int>{left_addr, right_addr}, 0));
+  rs.addRule(std::move(rule));
+  return RuleSetConverter::construct(rs);
+}
+
+// exec() with state.range(0) Bell pairs waiting for tomography, the rule measures all of them.
+static void BM_Runtime_Exec_Tomography(benchmark::State& state) {
+  quisp_test::prepareSimulation();
+  BenchRuntimeCallback callback;
+  Runtime runtime(tomographyRuleSet(0, 1), &callback);
+  std::vector<std::unique_ptr<QubitRecord>> qubits;
+  for (int i = 0; i < state.range(0); i++) qubits.push_back(std::make_unique<QubitRecord>(QNIC_E, 0, i));
+
+  long allocations = num_allocations.load(std::memory_order_relaxed);
+  for (auto _ : state) {
+    // the action frees the measured qubits, so assign them again for the next round.
+    for (auto& qubit : qubits) runtime.assignQubitToRuleSet(1, qubit.get());
+    runtime.exec();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  reportAllocations(state, allocations);
+}
+BENCHMARK(BM_Runtime_Exec_Tomography)->Arg(1)->Arg(16)->Arg(128);
+
+// one entanglement swapping per exec().
+static void BM_Runtime_Exec_Swapping(benchmark::State& state) {
+  quisp_test::prepareSimulation();
+  BenchRuntimeCallback callback;
+  Runtime runtime(swappingRuleSet(1, 0, 2), &callback);
+  QubitRecord left(QNIC_E, 0, 0);
+  QubitRecord right(QNIC_E, 1, 0);
+
+  long allocations = num_allocations.load(std::memory_order_relaxed);
+  for (auto _ : state) {
+    runtime.assignQubitToRuleSet(0, &left);
+    runtime.assignQubitToRuleSet(2, &right);
+    runtime.exec();
+  }
+  state.SetItemsProcessed(state.iterations());
+  reportAllocations(state, allocations);
+}
+BENCHMARK(BM_Runtime_Exec_Swapping);
+
+// RuleSetConverter::construct itself, which runs for every RuleSet a RuleEngine receives.
+static void BM_RuleSetConverter_Construct(benchmark::State& state) {
+  long allocations = num_allocations.load(std::memory_order_relaxed);
+  for (auto _ : state) {
+    auto rs = swappingRuleSet(1, 0, 2);
+    benchmark::DoNotOptimize(rs.rules.size());
+  }
+  state.SetItemsProcessed(state.iterations());
+  reportAllocations(state, allocations);
+}
+BENCHMARK(BM_RuleSetConverter_Construct);
+
+}  // namespace
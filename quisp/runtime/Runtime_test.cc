@@ -79,6 +79,42 @@ INSTR_GET_QUBIT_QubitId_QNodeAddr_int_{{q2, partner_addr, 2}},
   EXPECT_FALSE(runtime->qubit_found);
 }
 
+TEST_F(RuntimeTest, BatchPurification) {
+  QubitId q3{3}, q4{4}, q5{5};
+  MemoryKey result_key{"result"};
+  Program program{"batch purification",
+                  {
+                      // clang-format off
+INSTR_GET_QUBIT_QubitId_QNodeAddr_int_{{q0, partner_addr, 0}},
+INSTR_GET_QUBIT_QubitId_QNodeAddr_int_{{q1, partner_addr, 1}},
+INSTR_GET_QUBIT_QubitId_QNodeAddr_int_{{q2, partner_addr, 2}},
+INSTR_GET_QUBIT_QubitId_QNodeAddr_int_{{q3, partner_addr, 3}},
+INSTR_GET_QUBIT_QubitId_QNodeAddr_int_{{q4, partner_addr, 4}},
+// the trash qubit q5 of the third pair is not found
+INSTR_PURIFY_X_MemoryKey_QubitId_QubitId_int_{{result_key, q0, q3, 3}},
+INSTR_LOAD_RegId_MemoryKey_int_{{RegId::REG0, result_key, 0}},
+INSTR_SET_RegId_int_{{RegId::REG1, 7}},
+INSTR_LOAD_RegId_MemoryKey_int_{{RegId::REG1, result_key, 1}},
+                      // clang-format on
+                  }};
+  for (auto* qubit_record : {qubit, qubit2, qubit3, qubit4, qubit5}) runtime->assignQubitToRule(partner_addr, runtime->rule_id, qubit_record);
+
+  EXPECT_CALL(*callback, isQubitLocked(_)).WillRepeatedly(Return(false));
+  // the default batch purification runs the pairs one by one
+  EXPECT_CALL(*callback, purifyX(qubit, qubit4)).WillOnce(Return(0));
+  EXPECT_CALL(*callback, purifyX(qubit2, qubit5)).WillOnce(Return(1));
+  runtime->execProgram(program);
+
+  auto results = runtime->loadVal(result_key).bitset();
+  EXPECT_EQ(results.size(), 3);
+  EXPECT_FALSE(results.test(0));
+  EXPECT_TRUE(results.test(1));
+  EXPECT_FALSE(results.test(2));
+  EXPECT_EQ(runtime->registers[0].value, 0b010);
+  // past the end of the bitset
+  EXPECT_EQ(runtime->registers[1].value, 0);
+}
+
 TEST_F(RuntimeTest, CannotGetLockedQubits) {
   Program program{"",
                   {
@@ -94,6 +130,32 @@ INSTR_GET_QUBIT_QubitId_QNodeAddr_int_{{q0, partner_addr, 0}},
   EXPECT_FALSE(runtime->qubit_found);
 }
 
+TEST_F(RuntimeTest, GetQubitBySelectionPolicy) {
+  auto at = [](int64_t raw) { return omnetpp::SimTime().setRaw(raw); };
+  dynamic_cast<QubitRecord*>(qubit)->setEntangledTime(at(20));
+  dynamic_cast<QubitRecord*>(qubit2)->setEntangledTime(at(10));
+  dynamic_cast<QubitRecord*>(qubit3)->setEntangledTime(at(30));
+  runtime->assignQubitToRule(partner_addr, runtime->rule_id, qubit);
+  runtime->assignQubitToRule(partner_addr, runtime->rule_id, qubit2);
+  runtime->assignQubitToRule(partner_addr, runtime->rule_id, qubit3);
+  EXPECT_CALL(*callback, isQubitLocked(_)).WillRepeatedly(Return(false));
+  EXPECT_CALL(*callback, isQubitLocked(qubit3)).WillRepeatedly(Return(true));
+
+  EXPECT_EQ(runtime->getQubitByPartnerAddr(partner_addr, 0), qubit);
+  EXPECT_EQ(runtime->getQubitByPartnerAddr(partner_addr, 1), qubit2);
+
+  runtime->qubit_selection_policy = QubitSelectionPolicy::OLDEST_FIRST;
+  EXPECT_EQ(runtime->getQubitByPartnerAddr(partner_addr, 0), qubit2);
+  EXPECT_EQ(runtime->getQubitByPartnerAddr(partner_addr, 1), qubit);
+  EXPECT_EQ(runtime->getQubitByPartnerAddr(partner_addr, 2), nullptr);
+
+  // the freshest one is locked
+  runtime->qubit_selection_policy = QubitSelectionPolicy::FRESHEST_FIRST;
+  EXPECT_EQ(runtime->getQubitByPartnerAddr(partner_addr, 0), qubit);
+  EXPECT_EQ(runtime->getQubitByPartnerAddr(partner_addr, 1), qubit2);
+  EXPECT_EQ(runtime->getQubitByPartnerAddr(partner_addr2, 0), nullptr);
+}
+
 TEST_F(RuntimeTest, ExecRuleSetWithCondPassed) {
   MemoryKey result_key{"result"};
   RuleSet rs{"",
@@ -175,7 +237,6 @@ TEST_F(RuntimeTest, PromoteQubit) {
 
   auto* first_rule_qubit = runtime->getQubitByPartnerAddr(partner_addr, 0);
   EXPECT_EQ(first_rule_qubit, qubit);
-  auto it = runtime->qubits.begin();
   runtime->promoteQubit(qubit);
   runtime->rule_id = 1;
   auto* second_rule_qubit = runtime->getQubitByPartnerAddr(partner_addr, 0);
@@ -226,4 +287,338 @@ TEST_F(RuntimeTest, AssignQubit) {
   EXPECT_EQ(runtime->getQubitByPartnerAddr(partner_addr2, 1), qubit3);
 }
 
+TEST_F(RuntimeTest, AssignMessage) {
+  RuleSet rs{"",
+             {
+                 Rule{"sender", 3, -1, Program{"", {}}, Program{"action", {}}},
+                 Rule{"receiver", -1, 3, Program{"", {}}, Program{"action", {}}},
+                 Rule{"another receiver", -1, 3, Program{"", {}}, Program{"action", {}}},
+             }};
+  runtime->assignRuleSet(rs);
+  runtime->dirty = false;
+  runtime->assignMessageToRuleSet(3, {5, 1, 0});
+  EXPECT_TRUE(runtime->dirty);
+  // the first rule with the receive_tag gets the message
+  EXPECT_EQ(runtime->messages.sizeOf(1), 1);
+  EXPECT_EQ(runtime->messages.sizeOf(2), 0);
+  EXPECT_EQ(runtime->messages.count(1, 5), 1);
+
+  // no rule waits for this tag
+  runtime->dirty = false;
+  runtime->assignMessageToRuleSet(4, {5, 1, 0});
+  EXPECT_FALSE(runtime->dirty);
+  EXPECT_EQ(runtime->messages.size(), 1);
+}
+
+TEST_F(RuntimeTest, ReleaseQubit) {
+  RuleSet rs{"",
+             {
+                 Rule{"purification", 3, 3, Program{"", {INSTR_GET_QUBIT_QubitId_QNodeAddr_int_{{QubitId{0}, partner_addr, 0}}}}, Program{"action", {}}},
+             }};
+  runtime->assignRuleSet(rs);
+  runtime->assignQubitToRuleSet(partner_addr, qubit);
+  runtime->assignQubitToRuleSet(partner_addr, qubit2);
+  auto sequence_number = runtime->qubits.find(qubit2)->sequence_number;
+  EXPECT_EQ(runtime->getQubitBySharedRuleTag(partner_addr, 3, sequence_number), qubit2);
+  EXPECT_EQ(runtime->getQubitBySharedRuleTag(partner_addr, 4, sequence_number), nullptr);
+
+  // a Rule locks the qubit, so it stays in the RuleSet
+  EXPECT_CALL(*callback, isQubitLocked(qubit)).WillOnce(Return(true));
+  EXPECT_FALSE(runtime->releaseQubit(qubit).has_value());
+  EXPECT_EQ(runtime->qubits.size(), 2);
+
+  EXPECT_CALL(*callback, isQubitLocked(qubit2)).WillOnce(Return(false));
+  runtime->dirty = false;
+  auto location = runtime->releaseQubit(qubit2);
+  ASSERT_TRUE(location.has_value());
+  EXPECT_EQ(location->partner_addr, partner_addr);
+  EXPECT_EQ(location->rule_id, 0);
+  EXPECT_EQ(location->sequence_number, sequence_number);
+  EXPECT_TRUE(runtime->dirty);
+  EXPECT_EQ(runtime->qubits.size(), 1);
+  EXPECT_EQ(runtime->getQubitBySharedRuleTag(partner_addr, 3, sequence_number), nullptr);
+  EXPECT_FALSE(runtime->releaseQubit(qubit2).has_value());
+}
+
+TEST_F(RuntimeTest, ExecTerminationConditionOnlyAfterItsMemoryChanged) {
+  auto r0 = RegId::REG0;
+  MemoryKey count{"count"}, other{"other"};
+  // passes while the value of the key is less than max, and the action increments it
+  auto counter_rule = [&](const std::string& name, const MemoryKey& key, int max) {
+    Label passed{"PASSED_" + name};
+    return Rule{name,
+                -1,
+                -1,
+                Program{"condition",
+                        {
+                            INSTR_LOAD_RegId_MemoryKey_{{r0, key}},
+                            INSTR_BLT_Label_RegId_int_{{passed, r0, max}},
+                            INSTR_RET_ReturnCode_{{ReturnCode::COND_FAILED}},
+                            INSTR_RET_ReturnCode_{{ReturnCode::COND_PASSED}, passed},
+                        }},
+                Program{"action",
+                        {
+                            INSTR_LOAD_RegId_MemoryKey_{{r0, key}},
+                            INSTR_INC_RegId_{r0},
+                            INSTR_STORE_MemoryKey_RegId_{{key, r0}},
+                        }}};
+  };
+  Label not_terminated{"CONTINUE"};
+  RuleSet rs{"measure",
+             {counter_rule("other", other, 4), counter_rule("count", count, 10)},
+             Program{"termination",
+                     {
+                         INSTR_LOAD_RegId_MemoryKey_{{r0, count}},
+                         INSTR_BLT_Label_RegId_int_{{not_terminated, r0, 3}},
+                         INSTR_RET_ReturnCode_{{ReturnCode::RS_TERMINATED}},
+                         INSTR_NOP_None_{nullptr, not_terminated},
+                     }}};
+  RuntimeProfile profile{1};
+  runtime->assignRuleSet(rs);
+  runtime->profile = &profile;
+  runtime->exec();
+
+  EXPECT_TRUE(runtime->terminated);
+  EXPECT_EQ(runtime->loadVal(count).intValue(), 3);
+  EXPECT_EQ(runtime->loadVal(other).intValue(), 4);
+  // once before the first store and after each store to "count", but not after the stores to "other"
+  EXPECT_EQ(profile.programTimes().at("measure/termination").sampled, 4);
+}
+
+TEST_F(RuntimeTest, ParkAndRearm) {
+  auto r0 = RegId::REG0;
+  MemoryKey count{"count"};
+  Label passed{"PASSED"}, not_terminated{"CONTINUE"};
+  RuleSet rs{"measure",
+             {Rule{"count",
+                   -1,
+                   -1,
+                   Program{"condition",
+                           {
+                               INSTR_LOAD_RegId_MemoryKey_{{r0, count}},
+                               INSTR_BLT_Label_RegId_int_{{passed, r0, 3}},
+                               INSTR_RET_ReturnCode_{{ReturnCode::COND_FAILED}},
+                               INSTR_RET_ReturnCode_{{ReturnCode::COND_PASSED}, passed},
+                           }},
+                   Program{"action",
+                           {
+                               INSTR_LOAD_RegId_MemoryKey_{{r0, count}},
+                               INSTR_INC_RegId_{r0},
+                               INSTR_STORE_MemoryKey_RegId_{{count, r0}},
+                           }}}},
+             Program{"termination",
+                     {
+                         INSTR_LOAD_RegId_MemoryKey_{{r0, count}},
+                         INSTR_BLT_Label_RegId_int_{{not_terminated, r0, 3}},
+                         INSTR_RET_ReturnCode_{{ReturnCode::RS_TERMINATED}},
+                         INSTR_NOP_None_{nullptr, not_terminated},
+                     }}};
+  runtime->assignRuleSet(rs);
+  runtime->keep_alive = true;
+  runtime->exec();
+  EXPECT_TRUE(runtime->parked);
+  EXPECT_FALSE(runtime->terminated);
+  EXPECT_EQ(runtime->loadVal(count).intValue(), 3);
+
+  // parked, the Rules don't run even if the memory changes
+  runtime->storeVal(count, MemoryValue{0});
+  runtime->exec();
+  EXPECT_EQ(runtime->loadVal(count).intValue(), 0);
+  runtime->storeVal(count, MemoryValue{3});
+
+  // a demand larger than the original one rewinds the counter below zero
+  runtime->rearm(5);
+  EXPECT_FALSE(runtime->parked);
+  EXPECT_TRUE(runtime->dirty);
+  EXPECT_EQ(runtime->loadVal(count).intValue(), -2);
+  runtime->exec();
+  EXPECT_TRUE(runtime->parked);
+  EXPECT_EQ(runtime->loadVal(count).intValue(), 3);
+
+  runtime->terminate();
+  EXPECT_TRUE(runtime->terminated);
+  runtime->rearm(1);
+  EXPECT_EQ(runtime->loadVal(count).intValue(), 3);
+}
+
+TEST_F(RuntimeTest, Terminate) {
+  RuleSet rs{"", {Rule{"measure", -1, -1, Program{"", {INSTR_GET_QUBIT_QubitId_QNodeAddr_int_{{QubitId{0}, partner_addr, 0}}}}, Program{"action", {}}}}};
+  runtime->assignRuleSet(rs);
+  runtime->assignQubitToRuleSet(partner_addr, qubit);
+  runtime->dirty = false;
+  runtime->terminate();
+  EXPECT_TRUE(runtime->terminated);
+  EXPECT_TRUE(runtime->dirty);
+  // the qubits are left for the caller to free
+  EXPECT_EQ(runtime->qubits.size(), 1);
+
+  // a terminated Runtime doesn't run its Rules anymore
+  runtime->exec();
+  EXPECT_TRUE(runtime->terminated);
+  EXPECT_EQ(runtime->qubits.size(), 1);
+}
+
+TEST_F(RuntimeTest, ExtendRuleSet) {
+  EXPECT_CALL(*callback, isQubitLocked(_)).WillRepeatedly(Return(false));
+  Program get_qubit{"", {INSTR_GET_QUBIT_QubitId_QNodeAddr_int_{{q0, partner_addr, 0}}}};
+  Rule link_rule{"link", -1, -1, get_qubit, Program{"action", {}}};
+  RuleSet rs{"", {link_rule}};
+  runtime->assignRuleSet(rs);
+  MemoryKey key{"link result"};
+  runtime->storeVal(key, MemoryValue{5});
+  runtime->assignQubitToRuleSet(partner_addr, qubit);
+  runtime->assignQubitToRuleSet(partner_addr, qubit2);
+
+  // the qubit past the last rule is held
+  runtime->promoteQubit(qubit);
+  EXPECT_EQ(runtime->qubits.find(qubit)->rule_id, Runtime::held_rule_id);
+  EXPECT_EQ(runtime->qubits.find(qubit2)->rule_id, 0);
+
+  RuleSet extended{"", {link_rule, Rule{"swap", -1, -1, get_qubit, Program{"action", {}}}}};
+  runtime->dirty = false;
+  runtime->extendRuleSet(RuleSet::compile(extended));
+  EXPECT_TRUE(runtime->dirty);
+  EXPECT_EQ(runtime->ruleset->rules.size(), 2);
+  EXPECT_EQ(runtime->qubits.find(qubit)->rule_id, 1);
+  EXPECT_EQ(runtime->qubits.find(qubit2)->rule_id, 0);
+  EXPECT_EQ(runtime->loadVal(key).intValue(), 5);
+
+  // the following promotions go to the new rule
+  runtime->promoteQubit(qubit2);
+  EXPECT_EQ(runtime->qubits.find(qubit2)->rule_id, 1);
+}
+
+TEST_F(RuntimeTest, SuspendRuleUntilItsInputArrives) {
+  auto r0 = RegId::REG0;
+  MemoryKey passed_key{"passed"};
+  Label found{"FOUND"};
+  // passes if the rule has a message, like the purification correlation check
+  RuleSet rs{"rs",
+             {Rule{"wait", -1, 3,
+                   Program{"condition",
+                           {
+                               INSTR_GET_MESSAGE_SEQ_RegId_RegId_{{r0, r0}},
+                               INSTR_BRANCH_IF_MESSAGE_FOUND_Label_{found},
+                               INSTR_WAIT_MESSAGE_None_{nullptr},
+                               INSTR_WAIT_QUBIT_QNodeAddr_{partner_addr},
+                               INSTR_RET_ReturnCode_{{ReturnCode::COND_FAILED}},
+                               INSTR_DELETE_MESSAGE_RegId_{r0, found},
+                               INSTR_RET_ReturnCode_{{ReturnCode::COND_PASSED}},
+                           }},
+                   Program{"action", {INSTR_STORE_MemoryKey_int_{{passed_key, 1}}}}}}};
+  runtime->assignRuleSet(rs);
+  RuntimeProfile profile{0};
+  runtime->profile = &profile;
+  runtime->exec();
+  EXPECT_TRUE(runtime->isRuleSuspended(0));
+
+  // the suspended rule is skipped
+  runtime->dirty = true;
+  runtime->exec();
+  EXPECT_EQ(profile.ruleCounts().at("rs/wait").condition_failed, 1);
+
+  // a qubit with another partner doesn't resume it
+  runtime->assignQubitToRule(partner_addr2, 0, qubit);
+  EXPECT_TRUE(runtime->isRuleSuspended(0));
+  runtime->assignQubitToRule(partner_addr, 0, qubit2);
+  EXPECT_FALSE(runtime->isRuleSuspended(0));
+  runtime->exec();
+  EXPECT_EQ(profile.ruleCounts().at("rs/wait").condition_failed, 2);
+  EXPECT_TRUE(runtime->isRuleSuspended(0));
+
+  runtime->assignMessageToRuleSet(3, {5, 1});
+  EXPECT_FALSE(runtime->isRuleSuspended(0));
+  runtime->exec();
+  EXPECT_EQ(runtime->loadVal(passed_key).intValue(), 1);
+  // the condition ran again after the action and found no more message
+  EXPECT_EQ(profile.ruleCounts().at("rs/wait").condition_failed, 3);
+  EXPECT_TRUE(runtime->isRuleSuspended(0));
+}
+
+TEST_F(RuntimeTest, SkipConditionByQubitCountGuard) {
+  MemoryKey passed_key{"passed"};
+  Program condition{"condition", {INSTR_RET_ReturnCode_{{ReturnCode::COND_PASSED}}}};
+  condition.qubit_count_guards.push_back(QubitCountGuard{partner_addr, 2});
+  RuleSet rs{"rs",
+             {Rule{"guarded", -1, -1, condition, Program{"action", {INSTR_STORE_MemoryKey_int_{{passed_key, 1}}}}}},
+             Program{"", {INSTR_RET_ReturnCode_{{ReturnCode::RS_TERMINATED}}}}};
+  runtime->assignRuleSet(rs);
+  RuntimeProfile profile{0};
+  runtime->profile = &profile;
+  runtime->exec();
+  EXPECT_EQ(profile.ruleCounts().at("rs/guarded").condition_failed, 1);
+  EXPECT_TRUE(runtime->isRuleSuspended(0));
+
+  // one qubit resumes the rule, but the guard still fails
+  runtime->assignQubitToRule(partner_addr, 0, qubit);
+  EXPECT_FALSE(runtime->isRuleSuspended(0));
+  runtime->exec();
+  EXPECT_EQ(profile.ruleCounts().at("rs/guarded").condition_failed, 2);
+  EXPECT_TRUE(runtime->isRuleSuspended(0));
+
+  // the qubits of another rule don't count
+  runtime->assignQubitToRule(partner_addr, 1, qubit2);
+  runtime->assignQubitToRule(partner_addr, 0, qubit3);
+  runtime->exec();
+  EXPECT_EQ(runtime->loadVal(passed_key).intValue(), 1);
+}
+
+TEST_F(RuntimeTest, TraceTheFilteredRules) {
+  MemoryKey key{"key"};
+  auto rule = [&](const std::string& name) {
+    return Rule{name, -1, -1, Program{"condition", {INSTR_RET_ReturnCode_{{ReturnCode::COND_FAILED}}}}, Program{"action", {INSTR_STORE_MemoryKey_int_{{key, 1}}}}};
+  };
+  RuleSet rs{"rs", {rule("quiet"), rule("suspect")}};
+  rs.id = 7;
+  runtime->assignRuleSet(rs);
+  auto sink = std::make_unique<RingBufferTraceSink>(16);
+  auto* ring = sink.get();
+  RuntimeTrace trace{std::move(sink), TraceFilter::parse("7:1")};
+  runtime->trace = &trace;
+  runtime->exec();
+
+  // the RuleSet, then the condition of the suspect rule with its instruction and result
+  auto events = ring->events();
+  ASSERT_EQ(events.size(), 4);
+  EXPECT_EQ(events[0].type, TraceEventType::ExecRuleSet);
+  EXPECT_EQ(events[1].type, TraceEventType::ExecRule);
+  EXPECT_EQ(events[1].rule_id, 1);
+  EXPECT_EQ(events[2].type, TraceEventType::Instruction);
+  EXPECT_EQ(events[2].opcode, OpType::RET);
+  EXPECT_EQ(events[3].type, TraceEventType::ConditionResult);
+  EXPECT_EQ(events[3].values[0], static_cast<int>(ReturnCode::COND_FAILED));
+  for (auto& event : events) EXPECT_EQ(event.ruleset_id, 7);
+}
+
+TEST(QubitNameMapTest, BindAndClear) {
+  QubitNameMap names;
+  QubitRecord qubit{QNIC_E, 2, 3}, qubit2{QNIC_E, 2, 4};
+  names.reserve(2);
+  names.insert(QubitId{1}, &qubit);
+  // an id keeps its first qubit
+  names.insert(QubitId{1}, &qubit2);
+  EXPECT_EQ(names.find(QubitId{1}), &qubit);
+  EXPECT_EQ(names.find(QubitId{0}), nullptr);
+  EXPECT_EQ(names.find(QubitId{5}), nullptr);
+
+  // a negative id, e.g. the qubit id register initialized with -1
+  names.insert(QubitId{-1}, &qubit2);
+  EXPECT_EQ(names.find(QubitId{-1}), &qubit2);
+
+  names.insert(QubitId{5}, &qubit2);
+  EXPECT_EQ(names.find(QubitId{5}), &qubit2);
+  names.erase(QubitId{5});
+  EXPECT_EQ(names.find(QubitId{5}), nullptr);
+
+  int num_bound = 0;
+  names.forEach([&](QubitId, IQubitRecord*) { num_bound++; });
+  EXPECT_EQ(num_bound, 2);
+
+  names.clear();
+  EXPECT_EQ(names.find(QubitId{1}), nullptr);
+  EXPECT_EQ(names.find(QubitId{-1}), nullptr);
+  names.insert(QubitId{1}, &qubit2);
+  EXPECT_EQ(names.find(QubitId{1}), &qubit2);
+}
+
 }  // namespace
@@ -6,10 +6,17 @@ std::ostream& operator<<(std::ostream& stream, const MemoryValue& value) {
     case ValueType::INT:
       stream << std::to_string(value.intValue());
       break;
-    case ValueType::MEASUREMENT_OUTCOME:
+    case ValueType::MEASUREMENT_OUTCOME: {
       auto o = value.outcome();
       stream << "basis: " << std::to_string(o.basis) << ", GOD_clean: " << std::to_string(o.GOD_clean) << ", is_plus: " << o.outcome_is_plus;
       break;
+    }
+    case ValueType::BITSET: {
+      auto& bits = value.bitset();
+      stream << "bitset: ";
+      for (std::size_t i = 0; i < bits.size(); i++) stream << bits.test(i);
+      break;
+    }
   }
   return stream;
 }
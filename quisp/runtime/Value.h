@@ -1,5 +1,6 @@
 #pragma once
 #include "types.h"
+#include "utils/Validation.h"
 
 namespace quisp::runtime {
 
@@ -15,6 +16,7 @@ union ValueUnion {
 enum class ValueType {
   INT,
   MEASUREMENT_OUTCOME,
+  BITSET,
 };
 
 /// @brief memory value
@@ -22,23 +24,32 @@ class MemoryValue {
  public:
   MemoryValue(int val) : type(ValueType::INT), val(val) {}
   MemoryValue(MeasurementOutcome val) : type(ValueType::MEASUREMENT_OUTCOME), val(val) {}
+  MemoryValue(Bitset val) : type(ValueType::BITSET), val(0), bits(std::move(val)) {}
 
   /// @brief return integer value if the type check passed.
   int intValue() const {
-    if (type != ValueType::INT) throw std::runtime_error("the value is not an integer");
+    if (utils::validates(utils::ValidationLevel::Cheap) && type != ValueType::INT) throw std::runtime_error("the value is not an integer");
     return val.int_value;
   }
 
   /// @brief returns measurement outcome if the type check passed.
   MeasurementOutcome outcome() const {
-    if (type != ValueType::MEASUREMENT_OUTCOME) throw std::runtime_error("the value is not a MeasurementOutcome");
+    if (utils::validates(utils::ValidationLevel::Cheap) && type != ValueType::MEASUREMENT_OUTCOME) throw std::runtime_error("the value is not a MeasurementOutcome");
     return val.outcome;
   }
 
+  /// @brief returns the bitset if the type check passed.
+  const Bitset& bitset() const {
+    if (utils::validates(utils::ValidationLevel::Cheap) && type != ValueType::BITSET) throw std::runtime_error("the value is not a Bitset");
+    return bits;
+  }
+
   ValueType type;
 
  private:
   ValueUnion val;
+  // outside of the union, it owns the words
+  Bitset bits;
 };
 
 std::ostream& operator<<(std::ostream& stream, const MemoryValue& value);
@@ -55,6 +55,7 @@ INSTR(RET, ReturnCode)  // stop execution with the ReturnCode
 
 // memory operations
 INSTR(LOAD, RegId, MemoryKey)
+INSTR(LOAD, RegId, MemoryKey /* bitset */, int /* word index */)  // load one register wide word of a bitset
 INSTR(STORE, MemoryKey, RegId)
 INSTR(STORE, MemoryKey, int)
 
@@ -81,6 +82,11 @@ INSTR(GATE_CNOT, QubitId, QubitId)
 INSTR(PURIFY_X, RegId /* measurement_result */, int, QubitId /* keep_qubit */, QubitId /* trash_qubit */)
 INSTR(PURIFY_Z, RegId /* measurement_result */, int, QubitId /* keep_qubit */, QubitId /* trash_qubit */)
 INSTR(PURIFY_Y, RegId /* measurement_result */, int, QubitId /* keep_qubit */, QubitId /* trash_qubit */)
+// batch purification of the pairs (first_keep + i, first_trash + i) for i < the number of pairs, the outcome of the i-th pair is the bit i of the bitset
+INSTR(PURIFY_X, MemoryKey /* w: bitset */, QubitId /* first keep_qubit */, QubitId /* first trash_qubit */, int /* number of pairs */)
+INSTR(PURIFY_Z, MemoryKey /* w: bitset */, QubitId /* first keep_qubit */, QubitId /* first trash_qubit */, int /* number of pairs */)
+INSTR(PURIFY_Y, MemoryKey /* w: bitset */, QubitId /* first keep_qubit */, QubitId /* first trash_qubit */, int /* number of pairs */)
+INSTR(BELL_MEASURE, RegId /* w: bitset, X of the first at 0, Z of the second at 1 */, QubitId /* control */, QubitId /* target */)
 
 // resource management operations
 // instructions we would want later: crucial for entanglement pumping, banding, and multipartite states
@@ -97,11 +103,21 @@ INSTR(GET_MESSAGE, RegId /* w: content[1] */, RegId /* r: sequence number */, in
 INSTR(GET_MESSAGE, RegId /* w: content[1] */, RegId /* w: content[2] */, RegId /* r: sequence number */, int /* r: message index */)  // for swapping [correction_op, new_partner]
 INSTR(DELETE_MESSAGE, RegId /* read: sequence number */)  // delete all messages with this sequence number
 
+// suspension, the Rule whose condition fails after them isn't executed until a message arrives at it or a qubit with the partner is assigned to it
+INSTR(WAIT_MESSAGE, None)
+INSTR(WAIT_QUBIT, QNodeAddr /* partner addr */)
+
 // send classical messages
 INSTR(SEND_LINK_TOMOGRAPHY_RESULT, QNodeAddr, RegId, MemoryKey, int, Time)  // partner addr, current count reg_id, outcome key, max_count, start_time
 INSTR(SEND_PURIFICATION_RESULT, QNodeAddr, RegId /* measurement_result encoded in int */, RegId /* sequence_number */, PurType)
 INSTR(SEND_SWAPPING_RESULT, QNodeAddr /* receipient */, RegId /* pauli_op */, QNodeAddr /* new partner*/, RegId /* sequence_number */)
 
+// fused instructions, the ProgramOptimizer replaces the retrieval followed by BRANCH_IF_QUBIT_FOUND / BRANCH_IF_MESSAGE_FOUND with them
+INSTR(GET_QUBIT_BRANCH_IF_FOUND, Label, QubitId, QNodeAddr, int)
+INSTR(GET_QUBIT_BRANCH_IF_FOUND, Label, RegId /* qubit id */, QNodeAddr /* partner addr */, RegId /* given qubit index */)
+INSTR(GET_QUBIT_BY_SEQ_NO_BRANCH_IF_FOUND, Label, RegId /* write: qubit */, QNodeAddr /* read */, RegId /* read: seq_no */)
+INSTR(GET_MESSAGE_SEQ_BRANCH_IF_FOUND, Label, RegId /* write: sequence number */, RegId /* read: message index */)
+
 INSTR_LAST(NOP, None)
 #undef INSTR
 #undef INSTR_LAST
@@ -55,6 +55,7 @@ OP(GATE_CNOT)
 OP(PURIFY_X)
 OP(PURIFY_Y)
 OP(PURIFY_Z)
+OP(BELL_MEASURE)
 
 // resource management
 OP(SET_PARTNER)
@@ -71,6 +72,15 @@ OP(DELETE_MESSAGE)
 OP(COUNT_MESSAGE)
 OP(GET_MESSAGE_SEQ)
 
+// suspension
+OP(WAIT_MESSAGE)
+OP(WAIT_QUBIT)
+
+// fused instructions, see ProgramOptimizer
+OP(GET_QUBIT_BRANCH_IF_FOUND)
+OP(GET_QUBIT_BY_SEQ_NO_BRANCH_IF_FOUND)
+OP(GET_MESSAGE_SEQ_BRANCH_IF_FOUND)
+
 OP_LAST(NOP)
 #endif
 #undef OP
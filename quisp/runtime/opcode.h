@@ -2,6 +2,7 @@
 #include <sstream>
 #include <string>
 #include <tuple>
+#include <type_traits>
 #include <variant>
 
 #include "macro_utils.h"
@@ -88,4 +89,21 @@ using InstructionTypes = std::variant<
 #undef INSTR
     >;
 
+/// @brief calls f with each operand of the instruction whose type is T
+template <typename T, typename Instr, typename F>
+void forEachOperand(Instr& instr, F f) {
+  std::visit(
+      [&](auto& op) {
+        std::apply(
+            [&](auto&... args) {
+              auto visit_arg = [&](auto& arg) {
+                if constexpr (std::is_same_v<std::decay_t<decltype(arg)>, T>) f(arg);
+              };
+              (visit_arg(args), ...);
+            },
+            op.args);
+      },
+      instr);
+}
+
 }  // namespace quisp::runtime
@@ -26,6 +26,7 @@ class MockRuntimeCallback : public quisp::runtime::Runtime::ICallBack {
   MOCK_METHOD(int, purifyX, (IQubitRecord*, IQubitRecord*), (override));
   MOCK_METHOD(int, purifyY, (IQubitRecord*, IQubitRecord*), (override));
   MOCK_METHOD(int, purifyZ, (IQubitRecord*, IQubitRecord*), (override));
+  MOCK_METHOD(int, bellMeasure, (IQubitRecord*, IQubitRecord*), (override));
   MOCK_METHOD(void, sendLinkTomographyResult,
               (const unsigned long ruleset_id, const quisp::runtime::Rule& rule, const int action_index, QNodeAddr partner_addr, int count, MeasurementOutcome outcome,
                int max_count, SimTime started_time),
@@ -47,12 +48,11 @@ class MockRuntimeCallback : public quisp::runtime::Runtime::ICallBack {
 /// @brief count the number of qubit resources assigned to the rule.
 static int getResourceSizeByRuleId(quisp::runtime::Runtime& rt, quisp::runtime::RuleId id) {
   int count = 0;
-  for (auto& it : rt.qubits) {
-    auto& [_, rule_id] = it.first;
+  rt.qubits.forEach([&](quisp::runtime::QNodeAddr, quisp::runtime::RuleId rule_id, quisp::runtime::IQubitRecord*) {
     if (rule_id == id) {
       count++;
     }
-  }
+  });
   return count;
 }
 }  // namespace quisp_test
@@ -7,8 +7,13 @@
 #pragma once
 
 #include <omnetpp/simtime.h>
+#include <array>
 #include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 #include <modules/QNIC/StationaryQubit/IStationaryQubit.h>
 #include <modules/QRSA/QRSA.h>
@@ -28,8 +33,25 @@ using SequenceNumber = unsigned long;
  * @brief describes message received that takes part in decision making of RuleSet.
  *
  * first index [0], always contain the sequence number.
+ * The values are stored inline, the messages have at most `capacity` values.
  */
-using MessageRecord = std::vector<int32_t>;
+struct MessageRecord {
+  static constexpr std::size_t capacity = 3;
+
+  MessageRecord() = default;
+  MessageRecord(std::initializer_list<int32_t> init) {
+    if (init.size() > capacity) throw std::runtime_error("MessageRecord: too many values");
+    for (auto value : init) values[length++] = value;
+  }
+
+  int32_t operator[](std::size_t i) const { return values[i]; }
+  std::size_t size() const { return length; }
+  int32_t sequenceNumber() const { return values[0]; }
+  bool operator==(const MessageRecord& other) const { return length == other.length && values == other.values; }
+
+  std::array<int32_t, capacity> values{};
+  std::uint8_t length = 0;
+};
 
 // these types are mainly used for describing type name in def_instruction.h
 using String = std::string;
@@ -39,6 +61,25 @@ using IQubitRecord = quisp::modules::qrsa::IQubitRecord;
 /// @brief measurement outcome for Instructions.
 using MeasurementOutcome = quisp::backends::MeasurementOutcome;
 
+/**
+ * @brief a bitset wider than a register, e.g. the outcomes of a batch purification.
+ * The words are as wide as a register, so LOAD moves one word of it at a time.
+ */
+struct Bitset {
+  static constexpr int word_size = 32;
+
+  Bitset() = default;
+  explicit Bitset(std::size_t size) : words((size + word_size - 1) / word_size, 0), length(size) {}
+
+  bool test(std::size_t i) const { return (words[i / word_size] >> (i % word_size)) & 1; }
+  void set(std::size_t i) { words[i / word_size] |= std::uint32_t{1} << (i % word_size); }
+  std::size_t size() const { return length; }
+  bool operator==(const Bitset& other) const { return length == other.length && words == other.words; }
+
+  std::vector<std::uint32_t> words;
+  std::size_t length = 0;
+};
+
 /// @brief alias for omnetpp's simulation time.
 using Time = omnetpp::SimTime;
 /// @brief purification type for Instructions. see @ref rules::PurType enum.
@@ -95,6 +136,8 @@ bool operator==(const QubitId& a, const QubitId& b);
 struct Label {
   Label(std::string val);
   std::string val;
+  /// @brief the instruction index of the label, resolved when the Program is constructed. -1 if the Program doesn't have the label.
+  int pc = -1;
 };
 std::ostream& operator<<(std::ostream& stream, const Label& value);
 bool operator==(const Label& a, const Label& b);
@@ -103,6 +146,8 @@ bool operator==(const Label& a, const Label& b);
 struct MemoryKey {
   MemoryKey(std::string key);
   std::string val;
+  /// @brief the memory slot of the key, resolved by RuleSet::finalize(). It's only valid in the RuleSet that resolved it.
+  int slot = -1;
 };
 std::ostream& operator<<(std::ostream& stream, const MemoryKey& key);
 bool operator==(const MemoryKey& a, const MemoryKey& b);
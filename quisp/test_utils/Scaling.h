@@ -0,0 +1,49 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace quisp_test::scaling {
+
+/**
+ * @brief the exponent k of the growth of operation(setup(n)) as n^k, from its time at n, 2n and 4n.
+ *
+ * setup(size) builds the fixture outside the timing, and the operation takes it by reference. Each size takes the best of the repetitions,
+ * so a slow run of the machine doesn't look like a growth, and the exponent is the least squares slope of the times in log-log.
+ * A test runs the operation on all the n elements of the fixture, and expects about 1 for O(1) per element and 2 for O(n),
+ * so the margin between the documented exponent and the next one absorbs the noise and the caches.
+ */
+template <typename Setup, typename Operation>
+double growthExponent(std::size_t n, Setup setup, Operation operation, int repetitions = 5) {
+  std::vector<double> log_sizes, log_times;
+  for (std::size_t size = n; size <= 4 * n; size *= 2) {
+    double best = std::numeric_limits<double>::infinity();
+    for (int i = 0; i < repetitions; i++) {
+      auto fixture = setup(size);
+      auto start = std::chrono::steady_clock::now();
+      operation(fixture);
+      auto end = std::chrono::steady_clock::now();
+      best = std::min(best, std::chrono::duration<double>(end - start).count());
+    }
+    log_sizes.push_back(std::log(static_cast<double>(size)));
+    // the clock can't tell a run shorter than its tick from nothing
+    log_times.push_back(std::log(std::max(best, 1e-9)));
+  }
+  double mean_size = 0, mean_time = 0;
+  for (std::size_t i = 0; i < log_sizes.size(); i++) {
+    mean_size += log_sizes[i] / log_sizes.size();
+    mean_time += log_times[i] / log_times.size();
+  }
+  double covariance = 0, variance = 0;
+  for (std::size_t i = 0; i < log_sizes.size(); i++) {
+    covariance += (log_sizes[i] - mean_size) * (log_times[i] - mean_time);
+    variance += (log_sizes[i] - mean_size) * (log_sizes[i] - mean_size);
+  }
+  return covariance / variance;
+}
+
+}  // namespace quisp_test::scaling
@@ -22,8 +22,11 @@ using quisp_test::utils::setParInt;
 class MockHardwareMonitor : public IHardwareMonitor {
  public:
   MOCK_METHOD(int, getQnicNumQubits, (int i, QNIC_type qnic_type), (override));
-  MOCK_METHOD(std::unique_ptr<InterfaceInfo>, findInterfaceByNeighborAddr, (int neighbor_address), (override));
-  MOCK_METHOD(std::unique_ptr<ConnectionSetupInfo>, findConnectionInfoByQnicAddr, (int qnic_address), (override));
+  MOCK_METHOD(const InterfaceInfo *, findInterfaceByNeighborAddr, (int neighbor_address), (override));
+  MOCK_METHOD(const ConnectionSetupInfo *, findConnectionInfoByQnicAddr, (int qnic_address), (override));
+  MOCK_METHOD(void, setQuantumLinkState, (int neighbor_address, bool up), (override));
+  MOCK_METHOD(double, getLinkPairRate, (int qnic_address), (override));
+  MOCK_METHOD(double, getLinkFidelity, (int qnic_address), (override));
 };
 }  // namespace hardware_monitor
 }  // namespace mock_modules
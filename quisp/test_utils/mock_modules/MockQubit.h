@@ -18,14 +18,18 @@ using quisp_test::utils::setParBool;
 using quisp_test::utils::setParDouble;
 using quisp_test::utils::setParInt;
 
-class MockQubit : public IStationaryQubit {
+class MockQubit : public omnetpp::cSimpleModule, public IStationaryQubit {
  public:
-  using IStationaryQubit::initialize;
-  using IStationaryQubit::par;
+  using omnetpp::cSimpleModule::initialize;
+  using omnetpp::cSimpleModule::par;
   IStationaryQubit *entangled_partner;
 
   MOCK_METHOD(void, emitPhoton, (int pulse), (override));
+  MOCK_METHOD(void, emitPhotonInTimeBin, (int pulse, omnetpp::simtime_t emission_offset), (override));
+  MOCK_METHOD(void, emitPhotonIntoTrain, (quisp::messages::PhotonicQubitTrain * train, omnetpp::simtime_t emission_offset), (override));
+  MOCK_METHOD(void, sendPhotonTrain, (quisp::messages::PhotonicQubitTrain * train), (override));
   MOCK_METHOD(void, setFree, (bool consumed), (override));
+  MOCK_METHOD(IQubit *, setFreeInBatch, (bool consumed), (override));
   MOCK_METHOD(quisp::types::EigenvalueResult, measureX, (), (override));
   MOCK_METHOD(quisp::types::EigenvalueResult, measureY, (), (override));
   MOCK_METHOD(quisp::types::EigenvalueResult, measureZ, (), (override));
@@ -36,13 +40,15 @@ class MockQubit : public IStationaryQubit {
   MOCK_METHOD(void, gateSdg, (), (override));
   MOCK_METHOD(void, gateHadamard, (), (override));
   MOCK_METHOD(void, gateCNOT, (IStationaryQubit *), (override));
+  MOCK_METHOD(quisp::types::BellMeasurementResult, bellMeasure, (IStationaryQubit *), (override));
+  MOCK_METHOD(quisp::types::EigenvalueResult, purify, (IStationaryQubit *, quisp::types::PurificationBasis), (override));
   MOCK_METHOD(void, Lock, (unsigned long rs_id, int rule_id, int action_id), (override));
   MOCK_METHOD(void, Unlock, (), (override));
   MOCK_METHOD(bool, isLocked, (), (override));
   MOCK_METHOD(quisp::types::MeasurementOutcome, measureRandomPauliBasis, (), (override));
   MOCK_METHOD(IQubit *const, getBackendQubitRef, (), (const, override));
 
-  MockQubit() : IStationaryQubit() { setComponentType(new module_type::TestModuleType("test qubit")); }
+  MockQubit() : omnetpp::cSimpleModule(), IStationaryQubit() { setComponentType(new module_type::TestModuleType("test qubit")); }
   MockQubit(quisp::modules::QNIC_type _type, quisp::modules::QNicIndex _qnic_index) : MockQubit() {
     qnic_type = _type;
     qnic_index = _qnic_index;
@@ -89,6 +95,8 @@ class MockQubit : public IStationaryQubit {
     setParDouble(this, "z_measurement_error_rate", 1. / 2000);
 
     setParInt(this, "stationary_qubit_address", 1);
+    stationary_qubit_address = 1;
+    emission_success_probability = 0.5;
     setParInt(this, "node_address", 1);
     setParInt(this, "qnic_address", 1);
     setParInt(this, "qnic_type", 0);
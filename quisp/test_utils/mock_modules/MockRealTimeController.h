@@ -16,8 +16,12 @@ class MockRealTimeController : public quisp::modules::IRealTimeController {
   MOCK_METHOD(void, initialize, (), (override));
   MOCK_METHOD(void, handleMessage, (cMessage * msg), (override));
   MOCK_METHOD(void, EmitPhoton, (int qnic_index, int qubit_index, QNIC_type qnic_type, int pulse), (override));
+  MOCK_METHOD(void, EmitPhotonPulse, (int qnic_index, const std::vector<int>& qubit_indices, QNIC_type qnic_type, simtime_t interval, int pulse), (override));
+  MOCK_METHOD(void, EmitPhotonTrain, (int qnic_index, const std::vector<int>& qubit_indices, QNIC_type qnic_type, simtime_t interval), (override));
   MOCK_METHOD(void, ReInitialize_StationaryQubit, (int qnic_index, int qubit_index, QNIC_type qnic_type, bool consumed), (override));
   MOCK_METHOD(void, ReInitialize_StationaryQubit, (IQubitRecord* const qubit_record, bool consumed), (override));
+  MOCK_METHOD(void, ReInitialize_StationaryQubits, (int qnic_index, const std::vector<int>& qubit_indices, QNIC_type qnic_type, bool consumed), (override));
+  MOCK_METHOD(void, ReInitialize_StationaryQubits, (const std::vector<IQubitRecord*>& qubit_records, bool consumed), (override));
   MOCK_METHOD(void, applyXGate, (IQubitRecord* const qubit_record), (override));
   MOCK_METHOD(void, applyZGate, (IQubitRecord* const qubit_record), (override));
   MOCK_METHOD(void, applyYGate, (IQubitRecord* const qubit_record), (override));
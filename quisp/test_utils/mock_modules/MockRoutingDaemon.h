@@ -9,6 +9,8 @@ namespace routing_daemon {
 class MockRoutingDaemon : public quisp::modules::IRoutingDaemon {
  public:
   MOCK_METHOD(int, findQNicAddrByDestAddr, (int destAddr), (override));
+  MOCK_METHOD(std::vector<int>, findQNicAddrsByDestAddr, (int destAddr), (override));
+  MOCK_METHOD(int, findQNicAddrForFidelity, (int destAddr, double threshold_fidelity), (override));
   MOCK_METHOD(int, getNumEndNodes, (), (override));
 };
 
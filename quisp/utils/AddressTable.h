@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace quisp::utils {
+
+/**
+ * \brief AddressTable maps node addresses to values, e.g. a routing table from the destination address to the gate index.
+ *
+ * Node addresses are usually small dense integers, so an address in [0, dense_limit) is looked up
+ * by indexing a vector. Negative or larger addresses, e.g. a network with a sparse address space,
+ * fall back to a hash map. The dense part grows up to the largest address inserted within the limit.
+ */
+template <typename T>
+class AddressTable {
+ public:
+  static constexpr int default_dense_limit = 1 << 16;
+
+  explicit AddressTable(int dense_limit = default_dense_limit) : dense_limit(dense_limit) {}
+
+  /// @brief stores the value of the address, or replaces it.
+  void set(int address, T value) {
+    if (isDense(address)) {
+      if ((std::size_t)address >= dense.size()) dense.resize(address + 1);
+      if (!dense[address]) num_values++;
+      dense[address] = std::move(value);
+      return;
+    }
+    if (sparse.insert_or_assign(address, std::move(value)).second) num_values++;
+  }
+
+  /// @brief returns the value of the address, or nullptr.
+  const T *find(int address) const {
+    if (isDense(address)) {
+      if ((std::size_t)address >= dense.size() || !dense[address]) return nullptr;
+      return &*dense[address];
+    }
+    auto it = sparse.find(address);
+    return it == sparse.end() ? nullptr : &it->second;
+  }
+
+  /**
+   * @brief looks up the addresses in [first, last) at once and writes the values to out,
+   * or not_found for the addresses not in the table.
+   */
+  template <typename InputIt, typename OutputIt>
+  OutputIt findAll(InputIt first, InputIt last, OutputIt out, const T &not_found) const {
+    for (; first != last; ++first, ++out) {
+      auto *value = find(*first);
+      *out = value == nullptr ? not_found : *value;
+    }
+    return out;
+  }
+
+  bool contains(int address) const { return find(address) != nullptr; }
+
+  void clear() {
+    dense.clear();
+    sparse.clear();
+    num_values = 0;
+  }
+
+  /// @brief replaces the contents with the pairs of a map, e.g. the routing table generated by OSPF.
+  template <typename Map>
+  AddressTable &operator=(const Map &map) {
+    clear();
+    for (const auto &[address, value] : map) set(address, value);
+    return *this;
+  }
+
+  std::size_t size() const { return num_values; }
+
+ private:
+  bool isDense(int address) const { return 0 <= address && address < dense_limit; }
+
+  int dense_limit;
+  std::vector<std::optional<T>> dense;
+  std::unordered_map<int, T> sparse;
+  std::size_t num_values = 0;
+};
+
+}  // namespace quisp::utils
@@ -0,0 +1,45 @@
+#include "AddressTable.h"
+
+#include <gtest/gtest.h>
+#include <map>
+#include <vector>
+
+namespace {
+using quisp::utils::AddressTable;
+
+TEST(AddressTableTest, DenseAndSparseAddresses) {
+  AddressTable<int> table{8};
+  table.set(3, 30);
+  // out of the dense range
+  table.set(100, 1000);
+  table.set(-1, -10);
+  EXPECT_EQ(table.size(), 3);
+  ASSERT_NE(table.find(3), nullptr);
+  EXPECT_EQ(*table.find(3), 30);
+  EXPECT_EQ(*table.find(100), 1000);
+  EXPECT_EQ(*table.find(-1), -10);
+  EXPECT_EQ(table.find(2), nullptr);
+  EXPECT_EQ(table.find(7), nullptr);
+  EXPECT_FALSE(table.contains(101));
+
+  table.set(3, 31);
+  table.set(100, 1001);
+  EXPECT_EQ(table.size(), 3);
+  EXPECT_EQ(*table.find(3), 31);
+  EXPECT_EQ(*table.find(100), 1001);
+}
+
+TEST(AddressTableTest, AssignMapAndFindAll) {
+  AddressTable<int> table;
+  table.set(9, 90);
+  table = std::map<int, int>{{1, 10}, {2, 20}, {70000, 7}};
+  EXPECT_EQ(table.size(), 3);
+  EXPECT_FALSE(table.contains(9));
+
+  std::vector<int> addresses{2, 9, 70000, 1};
+  std::vector<int> values(addresses.size());
+  table.findAll(addresses.begin(), addresses.end(), values.begin(), -1);
+  EXPECT_EQ(values, (std::vector<int>{20, -1, 7, 10}));
+}
+
+}  // namespace
@@ -81,6 +81,12 @@ IQuantumBackend *ComponentProvider::getQuantumBackend() {
   return strategy->getQuantumBackend();
 }
 
+std::unique_ptr<modules::backend::rng::StreamRNG> ComponentProvider::getStreamRNG(int qnic_index, int qubit_index, QNIC_type qnic_type) {
+  using modules::backend::rng::StreamRNG;
+  auto seed = getSharedResource()->getStreamRNGSeed();
+  return std::make_unique<StreamRNG>(seed, StreamRNG::streamId(getNodeAddr(), qnic_type, qnic_index, qubit_index));
+}
+
 ILogger *ComponentProvider::getLogger() {
   ensureStrategy();
   return strategy->getLogger();
@@ -91,6 +97,11 @@ const std::unordered_map<int, int> ComponentProvider::getEndNodeWeightMapForAppl
   return shared_resource->getEndNodeWeightMapForApplication(node_type.c_str());
 }
 
+const modules::SharedResource::AliasTable *ComponentProvider::getEndNodeSamplerForApplication(std::string node_type) {
+  auto shared_resource = getSharedResource();
+  return shared_resource->getEndNodeSamplerForApplication(node_type.c_str());
+}
+
 cTopology *ComponentProvider::getTopologyForRoutingDaemon(const cModule *const rd_module) {
   auto shared_resource = getSharedResource();
   return shared_resource->getTopologyForRoutingDaemon(rd_module);
@@ -101,6 +112,97 @@ cTopology *ComponentProvider::getTopologyForRouter() {
   return shared_resource->getTopologyForRouter();
 }
 
+const modules::SharedResource::NextHopTable *ComponentProvider::getNextHopTableForRoutingDaemon(const cModule *const rd_module) {
+  auto shared_resource = getSharedResource();
+  return shared_resource->getNextHopTableForRoutingDaemon(rd_module);
+}
+
+const modules::SharedResource::NextHopTable *ComponentProvider::getNextHopTableForRouter() {
+  auto shared_resource = getSharedResource();
+  return shared_resource->getNextHopTableForRouter();
+}
+
+void ComponentProvider::setQuantumLinkCost(const cModule *const neighbor_node, double cost) {
+  auto shared_resource = getSharedResource();
+  shared_resource->setQuantumLinkCost(getQNode(), neighbor_node, cost);
+}
+
+void ComponentProvider::setQuantumLinkEnabled(const cModule *const neighbor_node, bool enabled) {
+  auto shared_resource = getSharedResource();
+  shared_resource->setQuantumLinkEnabled(getQNode(), neighbor_node, enabled);
+}
+
+void ComponentProvider::setQuantumLinkFidelity(const cModule *const neighbor_node, double fidelity) {
+  auto shared_resource = getSharedResource();
+  shared_resource->setQuantumLinkFidelity(getQNode(), neighbor_node, fidelity);
+}
+
+double ComponentProvider::getQuantumLinkFidelity(const cTopology::LinkOut *const link) {
+  auto shared_resource = getSharedResource();
+  return shared_resource->getQuantumLinkFidelity(link);
+}
+
+double ComponentProvider::getQuantumLinkSecPerBellPair(const cModule *const neighbor_node) {
+  auto shared_resource = getSharedResource();
+  return shared_resource->getQuantumLinkSecPerBellPair(getQNode(), neighbor_node);
+}
+
+uint64_t ComponentProvider::getQuantumLinkVersion() {
+  auto shared_resource = getSharedResource();
+  return shared_resource->getQuantumLinkVersion();
+}
+
+cModule *ComponentProvider::getQNodeWithAddress(int address) {
+  auto shared_resource = getSharedResource();
+  return shared_resource->getQNodeWithAddress(address);
+}
+
+int ComponentProvider::getNumEndNodes() {
+  auto shared_resource = getSharedResource();
+  return shared_resource->getNumEndNodes();
+}
+
+modules::SharedResource::TomographyResultWriter *ComponentProvider::getTomographyResultWriter(const std::string &file_name) {
+  auto shared_resource = getSharedResource();
+  return shared_resource->getTomographyResultWriter(file_name);
+}
+
+modules::SharedResource::EventProfiler *ComponentProvider::getEventProfiler() {
+  auto shared_resource = getSharedResource();
+  if (shared_resource == nullptr) return nullptr;
+  return shared_resource->getEventProfiler();
+}
+
+modules::SharedResource::MemoryAccounting *ComponentProvider::getMemoryAccounting() {
+  auto shared_resource = getSharedResource();
+  if (shared_resource == nullptr) return nullptr;
+  return shared_resource->getMemoryAccounting();
+}
+
+modules::SharedResource::EventTrace *ComponentProvider::getEventTrace() {
+  auto shared_resource = getSharedResource();
+  if (shared_resource == nullptr) return nullptr;
+  return shared_resource->getEventTrace();
+}
+
+const modules::SharedResource::EventReplay *ComponentProvider::getEventReplay() {
+  auto shared_resource = getSharedResource();
+  if (shared_resource == nullptr) return nullptr;
+  return shared_resource->getEventReplay();
+}
+
+modules::SharedResource::ConnectionController *ComponentProvider::getConnectionController() {
+  auto shared_resource = getSharedResource();
+  if (shared_resource == nullptr) return nullptr;
+  return shared_resource->getConnectionController();
+}
+
+modules::SharedResource::LinkWorkers *ComponentProvider::getLinkWorkers() {
+  auto shared_resource = getSharedResource();
+  if (shared_resource == nullptr) return nullptr;
+  return shared_resource->getLinkWorkers();
+}
+
 void ComponentProvider::setStrategy(std::unique_ptr<IComponentProviderStrategy> _strategy) { strategy = std::move(_strategy); }
 
 SharedResource *ComponentProvider::getSharedResource() {
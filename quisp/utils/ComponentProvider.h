@@ -4,6 +4,7 @@
 
 #include "DefaultComponentProviderStrategy.h"
 #include "IComponentProviderStrategy.h"
+#include "modules/Backend/RNG.h"
 #include "modules/Logger/LoggerModule.h"
 #include "modules/QRSA/QRSA.h"
 #include "modules/common_types.h"
@@ -38,10 +39,36 @@ class ComponentProvider {
   IHardwareMonitor *getHardwareMonitor();
   IRealTimeController *getRealTimeController();
   IQuantumBackend *getQuantumBackend();
+  // the random numbers of the qubit of this node, independent of the other streams and of the event order.
+  // qubit_index = -1 for a stream of the QNIC, and qnic_index = qubit_index = -1 for a stream of the node.
+  std::unique_ptr<modules::backend::rng::StreamRNG> getStreamRNG(int qnic_index, int qubit_index, QNIC_type qnic_type);
   ILogger *getLogger();
   cTopology *getTopologyForRoutingDaemon(const cModule *const rd_module);
   cTopology *getTopologyForRouter();
+  const modules::SharedResource::NextHopTable *getNextHopTableForRoutingDaemon(const cModule *const rd_module);
+  const modules::SharedResource::NextHopTable *getNextHopTableForRouter();
+  void setQuantumLinkCost(const cModule *const neighbor_node, double cost);
+  void setQuantumLinkEnabled(const cModule *const neighbor_node, bool enabled);
+  void setQuantumLinkFidelity(const cModule *const neighbor_node, double fidelity);
+  double getQuantumLinkFidelity(const cTopology::LinkOut *const link);
+  double getQuantumLinkSecPerBellPair(const cModule *const neighbor_node);
+  uint64_t getQuantumLinkVersion();
+  cModule *getQNodeWithAddress(int address);
+  int getNumEndNodes();
+  modules::SharedResource::TomographyResultWriter *getTomographyResultWriter(const std::string &file_name);
+  // nullptr if the events are not profiled, or there's no SharedResource as in the unit tests.
+  modules::SharedResource::EventProfiler *getEventProfiler();
+  // nullptr if the memory is not accounted, or there's no SharedResource as in the unit tests.
+  modules::SharedResource::MemoryAccounting *getMemoryAccounting();
+  // nullptr if the events are not traced or replayed, or there's no SharedResource.
+  modules::SharedResource::EventTrace *getEventTrace();
+  const modules::SharedResource::EventReplay *getEventReplay();
+  // nullptr if the connections are set up hop by hop, or there's no SharedResource.
+  modules::SharedResource::ConnectionController *getConnectionController();
+  // nullptr if the physical layer runs on the simulation thread, or there's no SharedResource.
+  modules::SharedResource::LinkWorkers *getLinkWorkers();
   const std::unordered_map<int, int> getEndNodeWeightMapForApplication(std::string node_type);
+  const modules::SharedResource::AliasTable *getEndNodeSamplerForApplication(std::string node_type);
   // when a this class instantiated, a strategy class instantiation may fail because
   // the strategy class may depend on other modules instantiated by OMNeT++'s NED file.
   // So this method is for delaying to instantiate the strategy class.
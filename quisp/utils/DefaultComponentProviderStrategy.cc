@@ -1,12 +1,44 @@
 #include <omnetpp.h>
 
 #include "DefaultComponentProviderStrategy.h"
+#include "modules/QNIC/QubitArray/QubitArray.h"
 
 namespace quisp::utils {
 
 DefaultComponentProviderStrategy::DefaultComponentProviderStrategy(cModule *_self) : self(_self) {}
+DefaultComponentProviderStrategy::DefaultComponentProviderStrategy(cModule *_self, const cModuleType *qnode_type, const cModuleType *epps_type, const cModuleType *bsa_type)
+    : QNodeType(qnode_type), EPPSType(epps_type), BSAType(bsa_type), self(_self) {}
+
+DefaultComponentProviderStrategy::~DefaultComponentProviderStrategy() {
+  if (watched_network != nullptr) watched_network->unsubscribe(PRE_MODEL_CHANGE, this);
+}
+
+void DefaultComponentProviderStrategy::watchModuleDeletions() {
+  if (watched_network != nullptr) return;
+  // the model change signals propagate up to the system module
+  watched_network = getSimulation()->getSystemModule();
+  if (watched_network != nullptr) watched_network->subscribe(PRE_MODEL_CHANGE, this);
+}
+
+void DefaultComponentProviderStrategy::receiveSignal(cComponent *source, simsignal_t signal_id, cObject *obj, cObject *details) {
+  if (signal_id == PRE_MODEL_CHANGE && dynamic_cast<cPreModuleDeleteNotification *>(obj) != nullptr) invalidateCaches();
+}
+
+void DefaultComponentProviderStrategy::invalidateCaches() {
+  qnode = nullptr;
+  node = nullptr;
+  qrsa = nullptr;
+  routing_daemon = nullptr;
+  hardware_monitor = nullptr;
+  real_time_controller = nullptr;
+  quantum_backend = nullptr;
+  logger = nullptr;
+  shared_resource = nullptr;
+  for (auto &qnics : stationary_qubits) qnics.clear();
+}
 
 cModule *DefaultComponentProviderStrategy::getQNode() {
+  if (qnode != nullptr) return qnode;
   cModule *currentModule = self->getParentModule();
   while (currentModule->getModuleType() != QNodeType) {
     currentModule = currentModule->getParentModule();
@@ -14,10 +46,13 @@ cModule *DefaultComponentProviderStrategy::getQNode() {
       throw cRuntimeError("QNode module not found. Have you changed the type name in ned file?");
     }
   }
+  watchModuleDeletions();
+  qnode = currentModule;
   return currentModule;
 }
 
 cModule *DefaultComponentProviderStrategy::getNode() {
+  if (node != nullptr) return node;
   cModule *currentModule = self->getParentModule();
   auto *mod_type = currentModule->getModuleType();
   while (mod_type != QNodeType && mod_type != BSAType && mod_type != EPPSType) {
@@ -27,6 +62,8 @@ cModule *DefaultComponentProviderStrategy::getNode() {
       throw cRuntimeError("Node module not found. Have you changed the type name in ned file?");
     }
   }
+  watchModuleDeletions();
+  node = currentModule;
   return currentModule;
 }
 
@@ -40,16 +77,32 @@ cModule *DefaultComponentProviderStrategy::getNeighborNode(cModule *qnic) {
 }
 
 IStationaryQubit *DefaultComponentProviderStrategy::getStationaryQubit(int qnic_index, int qubit_index, QNIC_type qnic_type) {
+  bool cacheable = qnic_type >= 0 && qnic_type < QNIC_N && qnic_index >= 0 && qubit_index >= 0;
+  if (cacheable) {
+    auto &qnics = stationary_qubits[qnic_type];
+    if (qnic_index >= qnics.size()) qnics.resize(qnic_index + 1);
+    auto &qubits = qnics[qnic_index];
+    if (qubit_index >= qubits.size()) qubits.resize(qubit_index + 1, nullptr);
+    if (qubits[qubit_index] != nullptr) return qubits[qubit_index];
+  }
   auto *qnic = getQNIC(qnic_index, qnic_type);
   if (qnic == nullptr) {
     throw cRuntimeError("QNIC not found. index: %d, type: %d", qnic_index, qnic_type);
   }
-  auto *qubit = qnic->getSubmodule("statQubit", qubit_index);
-  auto *casted_qubit = dynamic_cast<IStationaryQubit *>(qubit);
+  IStationaryQubit *casted_qubit;
+  if (auto *array = dynamic_cast<modules::QubitArray *>(qnic->getSubmodule("qubits"))) {
+    casted_qubit = array->getQubit(qubit_index);
+  } else {
+    casted_qubit = dynamic_cast<IStationaryQubit *>(qnic->getSubmodule("statQubit", qubit_index));
+  }
   if (casted_qubit == nullptr) {
     throw cRuntimeError("FAIL TO CAST QUBITS qubit index %d", qubit_index);
   }
-  return check_and_cast<IStationaryQubit *>(qubit);
+  if (cacheable) {
+    watchModuleDeletions();
+    stationary_qubits[qnic_type][qnic_index][qubit_index] = casted_qubit;
+  }
+  return casted_qubit;
 }
 
 cModule *DefaultComponentProviderStrategy::getQNIC(int qnic_index, QNIC_type qnic_type) {
@@ -68,52 +121,71 @@ int DefaultComponentProviderStrategy::getNumQubits(int qnic_index, QNIC_type qni
 }
 
 IRoutingDaemon *DefaultComponentProviderStrategy::getRoutingDaemon() {
-  auto *qrsa = getQRSA();
-  return check_and_cast<IRoutingDaemon *>(qrsa->getSubmodule("rd"));
+  if (routing_daemon == nullptr) routing_daemon = check_and_cast<IRoutingDaemon *>(getQRSA()->getSubmodule("rd"));
+  return routing_daemon;
 }
 IHardwareMonitor *DefaultComponentProviderStrategy::getHardwareMonitor() {
-  auto *qrsa = getQRSA();
-  return check_and_cast<IHardwareMonitor *>(qrsa->getSubmodule("hm"));
+  if (hardware_monitor == nullptr) hardware_monitor = check_and_cast<IHardwareMonitor *>(getQRSA()->getSubmodule("hm"));
+  return hardware_monitor;
 }
 modules::IRealTimeController *DefaultComponentProviderStrategy::getRealTimeController() {
-  auto *qrsa = getQRSA();
-  return check_and_cast<IRealTimeController *>(qrsa->getSubmodule("rt"));
+  if (real_time_controller == nullptr) real_time_controller = check_and_cast<IRealTimeController *>(getQRSA()->getSubmodule("rt"));
+  return real_time_controller;
 }
 IQuantumBackend *DefaultComponentProviderStrategy::getQuantumBackend() {
+  if (quantum_backend != nullptr) return quantum_backend;
   cModule *currentModule = self->getParentModule();
-  auto *mod = currentModule->findModuleByPath("backend");
+  auto *mod = findPartitionModule(currentModule, "backend");
   if (mod == nullptr) {
     throw cRuntimeError("Quantum backend not found");
   }
   auto *backend_container = check_and_cast<BackendContainer *>(mod);
-  return backend_container->getQuantumBackend();
+  auto *backend = backend_container->getQuantumBackend();
+  if (backend_container->initialized()) {
+    watchModuleDeletions();
+    quantum_backend = backend;
+  }
+  return backend;
 }
 
 ILogger *DefaultComponentProviderStrategy::getLogger() {
+  if (logger != nullptr) return logger;
   auto *qnode = getQNode();
-  auto *mod = qnode->findModuleByPath("logger");
+  auto *mod = findPartitionModule(qnode, "logger");
   if (mod == nullptr) {
     throw cRuntimeError("LoggerModule not found");
   }
   auto *logger_module = check_and_cast<LoggerModule *>(mod);
-  return logger_module->getLogger();
+  logger = logger_module->getLogger();
+  return logger;
+}
+
+cModule *DefaultComponentProviderStrategy::findPartitionModule(cModule *from, const char *name) {
+  if (auto *mod = from->findModuleByPath(name); mod != nullptr) return mod;
+  // in a parallel simulation, the network has a vector of the module with one element per partition
+  auto path = std::string(name) + "[" + std::to_string(getEnvir()->getParsimProcId()) + "]";
+  return from->findModuleByPath(path.c_str());
 }
 
 SharedResource *DefaultComponentProviderStrategy::getSharedResource() {
-  auto *mod = self->findModuleByPath("sharedResource");
+  if (shared_resource != nullptr) return shared_resource;
+  auto *mod = findPartitionModule(self, "sharedResource");
   if (mod == nullptr) {
     throw cRuntimeError("SharedResource not found");
   }
-  auto *shared_resource_holder = check_and_cast<SharedResource *>(mod);
-  return shared_resource_holder;
+  watchModuleDeletions();
+  shared_resource = check_and_cast<SharedResource *>(mod);
+  return shared_resource;
 }
 
 cModule *DefaultComponentProviderStrategy::getQRSA() {
+  if (qrsa != nullptr) return qrsa;
   auto *qnode = getQNode();
-  auto *qrsa = qnode->getSubmodule("qrsa");
-  if (qrsa == nullptr) {
+  auto *qrsa_module = qnode->getSubmodule("qrsa");
+  if (qrsa_module == nullptr) {
     throw cRuntimeError("QRSA module not found.");
   }
+  qrsa = qrsa_module;
   return qrsa;
 }
 
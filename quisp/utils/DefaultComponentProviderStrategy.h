@@ -1,12 +1,15 @@
 #pragma once
 
+#include <vector>
+
 #include "IComponentProviderStrategy.h"
 
 namespace quisp::utils {
 
-class DefaultComponentProviderStrategy : public IComponentProviderStrategy {
+class DefaultComponentProviderStrategy : public IComponentProviderStrategy, public cListener {
  public:
   DefaultComponentProviderStrategy(cModule *_self);
+  ~DefaultComponentProviderStrategy();
   cModule *getQNode() override;
   cModule *getNode() override;
   cModule *getNeighborNode(cModule *qnic) override;
@@ -24,12 +27,39 @@ class DefaultComponentProviderStrategy : public IComponentProviderStrategy {
   ILogger *getLogger() override;
   SharedResource *getSharedResource() override;
 
+ protected:
+  // for the tests and the benchmarks, whose modules have no NED types
+  DefaultComponentProviderStrategy(cModule *_self, const cModuleType *qnode_type, const cModuleType *epps_type, const cModuleType *bsa_type);
+  // a deleted module may be one of the cached, so the caches are cleared
+  void receiveSignal(cComponent *source, simsignal_t signal_id, cObject *obj, cObject *details) override;
+
  private:
   const cModuleType *const QNodeType = cModuleType::get("modules.QNode");
   const cModuleType *const EPPSType = cModuleType::get("modules.EPPSNode");
   const cModuleType *const BSAType = cModuleType::get("modules.BSANode");
   cModule *self;
   cModule *getQRSA();
+  // the network level module of the name, or the element of the partition of this process.
+  static cModule *findPartitionModule(cModule *from, const char *name);
+  // subscribes to the module deletions of the network before the first module is cached
+  void watchModuleDeletions();
+  void invalidateCaches();
+
+  // the modules never move during the simulation, so the lookups by module name are cached until a module is deleted.
+  cModule *qnode = nullptr;
+  cModule *node = nullptr;
+  cModule *qrsa = nullptr;
+  IRoutingDaemon *routing_daemon = nullptr;
+  IHardwareMonitor *hardware_monitor = nullptr;
+  IRealTimeController *real_time_controller = nullptr;
+  // the backend is created in the initialize of its container, so it's cached after that
+  IQuantumBackend *quantum_backend = nullptr;
+  ILogger *logger = nullptr;
+  SharedResource *shared_resource = nullptr;
+  // [qnic_type][qnic_index][qubit_index], nullptr until the qubit is resolved
+  std::vector<std::vector<IStationaryQubit *>> stationary_qubits[QNIC_N];
+  // the system module notifying the module deletions, nullptr until subscribed
+  cModule *watched_network = nullptr;
 };
 
 }  // namespace quisp::utils
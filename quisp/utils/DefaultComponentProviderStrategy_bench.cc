@@ -0,0 +1,84 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+
+#include <test_utils/TestUtils.h>
+#include "DefaultComponentProviderStrategy.h"
+
+namespace {
+using quisp::utils::DefaultComponentProviderStrategy;
+using quisp_test::MockHardwareMonitor;
+using quisp_test::MockRealTimeController;
+using quisp_test::MockRoutingDaemon;
+using quisp_test::TestModuleType;
+
+class BenchModule : public omnetpp::cModule {
+ public:
+  BenchModule(const char* name, omnetpp::cModuleType* type) {
+    setName(name);
+    setComponentType(type);
+    quisp_test::getTestSimulation()->registerComponent(this);
+  }
+  using omnetpp::cModule::insertSubmodule;
+};
+
+class BenchStrategy : public DefaultComponentProviderStrategy {
+ public:
+  BenchStrategy(omnetpp::cModule* self, omnetpp::cModuleType* qnode_type) : DefaultComponentProviderStrategy(self, qnode_type, nullptr, nullptr) {}
+};
+
+// qnode { qrsa { rd, hm, rt, rule_engine } }, as in the QNode of the NED
+struct BenchNode {
+  BenchNode() {
+    insert(qrsa, rd, "rd");
+    insert(qrsa, hm, "hm");
+    insert(qrsa, rt, "rt");
+    qrsa->insertSubmodule(rule_engine);
+    qnode->insertSubmodule(qrsa);
+  }
+  template <typename T>
+  void insert(BenchModule* parent, T* module, const char* name) {
+    module->setName(name);
+    module->setComponentType(&module_type);
+    quisp_test::getTestSimulation()->registerComponent(module);
+    parent->insertSubmodule(module);
+  }
+
+  // the modules below register themselves to this simulation
+  quisp_test::simulation::TestSimulation* sim = quisp_test::prepareSimulation();
+  TestModuleType qnode_type{"modules.QNode"};
+  TestModuleType module_type{"bench module"};
+  BenchModule* qnode = new BenchModule("qnode", &qnode_type);
+  BenchModule* qrsa = new BenchModule("qrsa", &module_type);
+  BenchModule* rule_engine = new BenchModule("rule_engine", &module_type);
+  MockRoutingDaemon* rd = new MockRoutingDaemon();
+  MockHardwareMonitor* hm = new MockHardwareMonitor();
+  MockRealTimeController* rt = new MockRealTimeController();
+};
+
+// the lookups of a RuleEngine event: the hardware monitor, the routing daemon and the real time controller of its node
+template <typename Strategy>
+void lookUpOfEvent(Strategy& strategy) {
+  benchmark::DoNotOptimize(strategy.getQNode());
+  benchmark::DoNotOptimize(strategy.getHardwareMonitor());
+  benchmark::DoNotOptimize(strategy.getRoutingDaemon());
+  benchmark::DoNotOptimize(strategy.getRealTimeController());
+}
+
+static void BM_ComponentProvider_EventLookupsCached(benchmark::State& state) {
+  BenchNode node;
+  BenchStrategy strategy{node.rule_engine, &node.qnode_type};
+  for (auto _ : state) lookUpOfEvent(strategy);
+}
+BENCHMARK(BM_ComponentProvider_EventLookupsCached);
+
+// a fresh strategy resolves each module by the parents and the names, as every call did before the caches
+static void BM_ComponentProvider_EventLookupsResolved(benchmark::State& state) {
+  BenchNode node;
+  for (auto _ : state) {
+    BenchStrategy strategy{node.rule_engine, &node.qnode_type};
+    lookUpOfEvent(strategy);
+  }
+}
+BENCHMARK(BM_ComponentProvider_EventLookupsResolved);
+
+}  // namespace
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <omnetpp.h>
+
+namespace quisp::utils {
+
+/**
+ * @brief whether the component does the GUI-only work: bubbles, display string updates and WATCHes.
+ *
+ * It's false in Cmdenv. The headless builds (make HEADLESS=1, see makefrag) define QUISP_HEADLESS,
+ * where it's a constant false and the GUI-only code is compiled out.
+ */
+inline bool showsGUI(const omnetpp::cComponent *component) {
+#ifdef QUISP_HEADLESS
+  (void)component;
+  return false;
+#else
+  return component->hasGUI();
+#endif
+}
+
+}  // namespace quisp::utils
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace quisp::utils {
+
+/**
+ * \brief IndexedRingBuffer stores values by a monotonically increasing index, e.g. the photon index,
+ * when only the recent indices are looked up.
+ *
+ * The value of the index i lives in the slot (i mod capacity), so insert, find and erase are O(1).
+ * The capacity should cover the indices in flight, e.g. the photons emitted in a round trip.
+ * If an insert hits a slot whose value is not erased yet, the buffer grows instead of overwriting it.
+ */
+template <typename T>
+class IndexedRingBuffer {
+ public:
+  explicit IndexedRingBuffer(std::size_t capacity = 16) { reserve(capacity); }
+
+  /// @brief grows the buffer for at least capacity indices in flight. It never shrinks.
+  void reserve(std::size_t capacity) {
+    std::size_t new_capacity = 1;
+    while (new_capacity < capacity) new_capacity <<= 1;
+    if (new_capacity <= slots.size()) return;
+    std::vector<Slot> old_slots(new_capacity);
+    std::swap(slots, old_slots);
+    for (auto &slot : old_slots) {
+      if (slot.used) slotOf(slot.index) = std::move(slot);
+    }
+  }
+
+  /// @brief stores the value of the index, or replaces it.
+  T &insert(std::uint64_t index, T value) {
+    while (slotOf(index).used && slotOf(index).index != index) reserve(slots.size() * 2);
+    auto &slot = slotOf(index);
+    if (!slot.used) num_values++;
+    slot.index = index;
+    slot.used = true;
+    slot.value = std::move(value);
+    return slot.value;
+  }
+
+  /// @brief returns the value of the index, or nullptr.
+  T *find(std::uint64_t index) {
+    auto &slot = slotOf(index);
+    return slot.used && slot.index == index ? &slot.value : nullptr;
+  }
+
+  bool erase(std::uint64_t index) {
+    auto &slot = slotOf(index);
+    if (!slot.used || slot.index != index) return false;
+    slot.used = false;
+    slot.value = T{};
+    num_values--;
+    return true;
+  }
+
+  std::size_t size() const { return num_values; }
+  std::size_t capacity() const { return slots.size(); }
+  std::size_t allocatedBytes() const { return slots.capacity() * sizeof(Slot); }
+
+ private:
+  struct Slot {
+    std::uint64_t index = 0;
+    bool used = false;
+    T value{};
+  };
+
+  Slot &slotOf(std::uint64_t index) { return slots[index & (slots.size() - 1)]; }
+
+  // the size is a power of two
+  std::vector<Slot> slots;
+  std::size_t num_values = 0;
+};
+
+}  // namespace quisp::utils
@@ -0,0 +1,49 @@
+#include "IndexedRingBuffer.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+using quisp::utils::IndexedRingBuffer;
+
+TEST(IndexedRingBufferTest, InsertFindErase) {
+  IndexedRingBuffer<int> buffer{4};
+  EXPECT_EQ(buffer.capacity(), 4);
+  buffer.insert(1, 10);
+  buffer.insert(2, 20);
+  ASSERT_NE(buffer.find(1), nullptr);
+  EXPECT_EQ(*buffer.find(1), 10);
+  EXPECT_EQ(buffer.find(3), nullptr);
+  // the same slot as 1
+  EXPECT_EQ(buffer.find(5), nullptr);
+
+  EXPECT_TRUE(buffer.erase(1));
+  EXPECT_FALSE(buffer.erase(1));
+  EXPECT_EQ(buffer.find(1), nullptr);
+  EXPECT_EQ(buffer.size(), 1);
+
+  // the slot of 1 is reused
+  buffer.insert(5, 50);
+  EXPECT_EQ(*buffer.find(5), 50);
+  EXPECT_EQ(buffer.capacity(), 4);
+}
+
+TEST(IndexedRingBufferTest, GrowInsteadOfOverwriting) {
+  IndexedRingBuffer<int> buffer{4};
+  for (int i = 0; i < 10; i++) buffer.insert(i, i * 10);
+  EXPECT_EQ(buffer.capacity(), 16);
+  for (int i = 0; i < 10; i++) {
+    ASSERT_NE(buffer.find(i), nullptr);
+    EXPECT_EQ(*buffer.find(i), i * 10);
+  }
+
+  // the sliding window doesn't grow the buffer
+  for (int i = 0; i < 10; i++) buffer.erase(i);
+  for (int i = 10; i < 1000; i++) {
+    buffer.insert(i, i);
+    buffer.erase(i - 2);
+  }
+  EXPECT_EQ(buffer.capacity(), 16);
+  EXPECT_EQ(buffer.size(), 2);
+}
+
+}  // namespace
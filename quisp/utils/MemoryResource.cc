@@ -0,0 +1,27 @@
+#include "MemoryResource.h"
+
+namespace quisp::utils {
+
+std::optional<MemoryResourceStrategy> memoryResourceStrategyByName(std::string_view name) {
+  if (name == "global") return MemoryResourceStrategy::Global;
+  if (name == "pool") return MemoryResourceStrategy::Pool;
+  if (name == "monotonic") return MemoryResourceStrategy::Monotonic;
+  return std::nullopt;
+}
+
+MemoryResource::MemoryResource(MemoryResourceStrategy strategy, bool synchronized) : strategy(strategy), resource(std::pmr::new_delete_resource()) {
+  if (strategy == MemoryResourceStrategy::Global) return;
+  auto* upstream = std::pmr::new_delete_resource();
+  if (strategy == MemoryResourceStrategy::Monotonic) {
+    arena = std::make_unique<std::pmr::monotonic_buffer_resource>(upstream);
+    upstream = arena.get();
+  }
+  if (synchronized) {
+    pool = std::make_unique<std::pmr::synchronized_pool_resource>(upstream);
+  } else {
+    pool = std::make_unique<std::pmr::unsynchronized_pool_resource>(upstream);
+  }
+  resource = pool.get();
+}
+
+}  // namespace quisp::utils
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <string_view>
+
+namespace quisp::utils {
+
+/// @brief where the hot containers of a component take their nodes from.
+enum class MemoryResourceStrategy {
+  // the global new and delete
+  Global,
+  // pools of same sized blocks over the global heap, the freed blocks are reused by the component
+  Pool,
+  // the pools take their chunks from a monotonic arena, which goes back to the heap only with the component
+  Monotonic,
+};
+
+/// @brief "global", "pool" or "monotonic", std::nullopt for any other name.
+std::optional<MemoryResourceStrategy> memoryResourceStrategyByName(std::string_view name);
+
+/**
+ * @brief the std::pmr::memory_resource of the containers of one component, e.g. a Runtime or a backend.
+ * It must outlive the containers using it, so the owner declares it before them.
+ *
+ * Monotonic still pools the freed blocks, otherwise the long lived components would grow the arena on each insert after an erase.
+ * The resource is not thread safe unless synchronized is set.
+ */
+class MemoryResource {
+ public:
+  explicit MemoryResource(MemoryResourceStrategy strategy = MemoryResourceStrategy::Global, bool synchronized = false);
+  MemoryResource(const MemoryResource&) = delete;
+  MemoryResource& operator=(const MemoryResource&) = delete;
+
+  std::pmr::memory_resource* get() const { return resource; }
+  MemoryResourceStrategy getStrategy() const { return strategy; }
+
+ private:
+  MemoryResourceStrategy strategy;
+  std::unique_ptr<std::pmr::monotonic_buffer_resource> arena;
+  std::unique_ptr<std::pmr::memory_resource> pool;
+  std::pmr::memory_resource* resource;
+};
+
+}  // namespace quisp::utils
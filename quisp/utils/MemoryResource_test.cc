@@ -0,0 +1,46 @@
+#include "MemoryResource.h"
+
+#include <gtest/gtest.h>
+#include <map>
+#include <vector>
+
+namespace {
+using quisp::utils::MemoryResource;
+using quisp::utils::MemoryResourceStrategy;
+using quisp::utils::memoryResourceStrategyByName;
+
+TEST(MemoryResourceTest, StrategyByName) {
+  EXPECT_EQ(memoryResourceStrategyByName("global"), MemoryResourceStrategy::Global);
+  EXPECT_EQ(memoryResourceStrategyByName("pool"), MemoryResourceStrategy::Pool);
+  EXPECT_EQ(memoryResourceStrategyByName("monotonic"), MemoryResourceStrategy::Monotonic);
+  EXPECT_EQ(memoryResourceStrategyByName("arena"), std::nullopt);
+}
+
+TEST(MemoryResourceTest, GlobalIsNewDelete) {
+  MemoryResource resource;
+  EXPECT_EQ(resource.getStrategy(), MemoryResourceStrategy::Global);
+  EXPECT_EQ(resource.get(), std::pmr::new_delete_resource());
+}
+
+TEST(MemoryResourceTest, ContainersOnEachStrategy) {
+  for (auto strategy : {MemoryResourceStrategy::Global, MemoryResourceStrategy::Pool, MemoryResourceStrategy::Monotonic}) {
+    for (bool synchronized : {false, true}) {
+      MemoryResource resource{strategy, synchronized};
+      if (strategy != MemoryResourceStrategy::Global) {
+        EXPECT_NE(resource.get(), std::pmr::new_delete_resource());
+      }
+      std::pmr::map<int, std::pmr::vector<int>> map{resource.get()};
+      for (int i = 0; i < 1000; i++) {
+        map[i % 10].push_back(i);
+        if (i % 3 == 0) map.erase(i % 7);
+      }
+      // the values take the resource of the map
+      for (auto& [key, values] : map) {
+        EXPECT_EQ(values.get_allocator().resource(), resource.get());
+      }
+      EXPECT_EQ(map[9].back(), 999);
+    }
+  }
+}
+
+}  // namespace
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace quisp::utils {
+
+/**
+ * @brief the approximate heap bytes of the standard containers, for the memory accounting of the subsystems.
+ *
+ * They count the storage of the container itself, by its capacity and the node layout of libstdc++,
+ * not the heap storage owned by the elements, which the caller adds if it matters.
+ * The numbers are estimates to find the growing structures, not what the allocator uses.
+ */
+namespace memory_usage {
+// the parent, the children and the color of a red-black tree node
+constexpr std::size_t tree_node_overhead = 4 * sizeof(void*);
+// the next pointer and the cached hash of a hash table node
+constexpr std::size_t hash_node_overhead = sizeof(void*) + sizeof(std::size_t);
+}  // namespace memory_usage
+
+template <typename T, typename A>
+std::size_t heapBytesOf(const std::vector<T, A>& container) {
+  return container.capacity() * sizeof(T);
+}
+
+template <typename T, typename A>
+std::size_t heapBytesOf(const std::deque<T, A>& container) {
+  return container.size() * sizeof(T);
+}
+
+template <typename K, typename V, typename C, typename A>
+std::size_t heapBytesOf(const std::map<K, V, C, A>& container) {
+  return container.size() * (sizeof(typename std::map<K, V, C, A>::value_type) + memory_usage::tree_node_overhead);
+}
+
+template <typename K, typename V, typename H, typename E, typename A>
+std::size_t heapBytesOf(const std::unordered_map<K, V, H, E, A>& container) {
+  return container.size() * (sizeof(typename std::unordered_map<K, V, H, E, A>::value_type) + memory_usage::hash_node_overhead) +
+         container.bucket_count() * sizeof(void*);
+}
+
+template <typename K, typename C, typename A>
+std::size_t heapBytesOf(const std::set<K, C, A>& container) {
+  return container.size() * (sizeof(K) + memory_usage::tree_node_overhead);
+}
+
+template <typename K, typename H, typename E, typename A>
+std::size_t heapBytesOf(const std::unordered_set<K, H, E, A>& container) {
+  return container.size() * (sizeof(K) + memory_usage::hash_node_overhead) + container.bucket_count() * sizeof(void*);
+}
+
+}  // namespace quisp::utils
@@ -0,0 +1,30 @@
+#include "MemoryUsage.h"
+
+#include <gtest/gtest.h>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+using quisp::utils::heapBytesOf;
+
+TEST(MemoryUsageTest, HeapBytesOfContainers) {
+  std::vector<int> vector;
+  EXPECT_EQ(heapBytesOf(vector), 0);
+  vector.reserve(10);
+  // by the capacity, not the size
+  EXPECT_EQ(heapBytesOf(vector), 10 * sizeof(int));
+
+  std::map<int, double> map;
+  EXPECT_EQ(heapBytesOf(map), 0);
+  map[1] = 1;
+  map[2] = 2;
+  EXPECT_EQ(heapBytesOf(map), 2 * heapBytesOf(std::map<int, double>{{1, 1}}));
+  EXPECT_GT(heapBytesOf(map), 2 * sizeof(std::pair<const int, double>));
+
+  std::unordered_map<int, int> unordered_map;
+  unordered_map[1] = 1;
+  EXPECT_GE(heapBytesOf(unordered_map), sizeof(std::pair<const int, int>) + unordered_map.bucket_count() * sizeof(void *));
+}
+
+}  // namespace
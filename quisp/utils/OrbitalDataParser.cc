@@ -8,19 +8,98 @@
 
 #include "OrbitalDataParser.h"
 
-OrbitalDataParser::OrbitalDataParser(const string filename) {
-  file.open(filename);
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <mutex>
+
+OrbitalDataParser::OrbitalDataParser(const string filename, Interpolation interpolation) : data(loadDataset(filename)), interpolation(interpolation) {}
+
+std::shared_ptr<const OrbitalDataParser::Dataset> OrbitalDataParser::loadDataset(const string &filename) {
+  // the channels referring to the same orbit file share the data while any of them is alive, also across the simulations on the threads
+  static std::mutex mutex;
+  static std::map<string, std::weak_ptr<const Dataset>> datasets;
+  std::lock_guard<std::mutex> lock(mutex);
+  if (auto dataset = datasets[filename].lock()) return dataset;
+
+  // read the whole file at once, and parse "time,value" lines in place
+  std::ifstream file(filename, std::ios::binary);
   if (!file.is_open()) throw cRuntimeError("Couldn't find CSV file!");
-  string line;
-  double key = 0;
-  double val = 0;
-  char sep;  // throwaway
-  while (file >> line) {
-    std::istringstream ss(line);
-    ss >> key >> sep >> val;
-    property.insert(std::pair<double, double>(key, val));
+  string content{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+  std::vector<std::pair<double, double>> points;
+  const char *cursor = content.c_str();
+  const char *end = cursor + content.size();
+  while (cursor < end) {
+    while (cursor < end && std::isspace(static_cast<unsigned char>(*cursor))) cursor++;
+    if (cursor == end) break;
+    char *parsed;
+    double key = std::strtod(cursor, &parsed);
+    bool has_key = parsed != cursor;
+    cursor = parsed;
+    if (has_key && cursor < end && !std::isspace(static_cast<unsigned char>(*cursor))) {
+      double val = std::strtod(cursor + 1, &parsed);  // skips the separator
+      if (parsed != cursor + 1) points.emplace_back(key, val);
+      cursor = parsed;
+    }
+    // the rest of the line, e.g. a header or the other columns
+    while (cursor < end && *cursor != '\n') cursor++;
+  }
+  if (points.empty()) throw cRuntimeError("CSV file %s has no data points", filename.c_str());
+
+  // sorted by time, and the first value of a duplicated time wins
+  std::stable_sort(points.begin(), points.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+  points.erase(std::unique(points.begin(), points.end(), [](const auto &a, const auto &b) { return a.first == b.first; }), points.end());
+
+  auto dataset = std::make_shared<Dataset>();
+  dataset->times.reserve(points.size());
+  dataset->values.reserve(points.size());
+  for (auto &[key, val] : points) {
+    dataset->times.push_back(key);
+    dataset->values.push_back(val);
+  }
+  auto &times = dataset->times;
+  if (times.size() > 1) {
+    double step = (times.back() - times.front()) / (times.size() - 1);
+    bool is_uniform = true;
+    for (std::size_t i = 0; i < times.size() && is_uniform; i++) is_uniform = std::fabs(times[i] - (times.front() + i * step)) <= 1e-9 * std::max(1.0, std::fabs(times[i]));
+    if (is_uniform) dataset->uniform_step = step;
   }
-  return;
+  datasets[filename] = dataset;
+  return dataset;
+}
+
+std::size_t OrbitalDataParser::findSegment(const double time) {
+  auto &times = data->times;
+  std::size_t last = times.size() - 2;
+  std::size_t i;
+  if (data->uniform_step > 0) {
+    i = std::min(static_cast<std::size_t>((time - times.front()) / data->uniform_step), last);
+    // the rounding of the division may be off by one
+    if (i > 0 && time < times[i]) i--;
+    if (i < last && time >= times[i + 1]) i++;
+  } else if (times[last_segment] <= time && time < times[last_segment + 1]) {
+    i = last_segment;
+  } else if (last_segment < last && times[last_segment + 1] <= time && time < times[last_segment + 2]) {
+    i = last_segment + 1;
+  } else {
+    auto upper = std::upper_bound(times.begin(), times.end(), time);
+    i = std::min(static_cast<std::size_t>(upper - times.begin()) - 1, last);
+  }
+  last_segment = i;
+  return i;
+}
+
+double OrbitalDataParser::slopeAt(std::size_t i) const {
+  auto &times = data->times;
+  auto &values = data->values;
+  std::size_t prev = i == 0 ? 0 : i - 1;
+  std::size_t next = i + 1 == times.size() ? i : i + 1;
+  return (values[next] - values[prev]) / (times[next] - times[prev]);
 }
 
 double OrbitalDataParser::getPropertyAtTime(const double time) {
@@ -31,29 +110,46 @@ double OrbitalDataParser::getPropertyAtTime(const double time) {
   // They should never be used in actual simulation, as they are NOT in any way
   // guaranteed to be accurate.
 
-  if (time != last_polled_time) {
-    last_polled_time = time;
-    auto u_b = property.upper_bound(time);
-    if (u_b == property.end()) {
-      last_polled_value = (--u_b)->second;
-    } else if (u_b == property.begin()) {
-      last_polled_value = u_b->second;
-    } else {
-      auto l_b = u_b;
-      --l_b;
-      const double delta = (time - l_b->first) / (u_b->first - l_b->first);
-      last_polled_value = delta * u_b->second + (1 - delta) * l_b->second;
-    }
-  }
-  return last_polled_value;
+  auto &times = data->times;
+  auto &values = data->values;
+  if (times.size() == 1) return values.front();
+  auto i = findSegment(time);
+  const double width = times[i + 1] - times[i];
+  const double delta = (time - times[i]) / width;
+  if (interpolation == Interpolation::Linear) return delta * values[i + 1] + (1 - delta) * values[i];
+
+  // cubic Hermite spline with the slopes of the neighbors (Catmull-Rom for evenly spaced times)
+  const double delta2 = delta * delta;
+  const double delta3 = delta2 * delta;
+  return (2 * delta3 - 3 * delta2 + 1) * values[i] + (delta3 - 2 * delta2 + delta) * width * slopeAt(i) + (-2 * delta3 + 3 * delta2) * values[i + 1] +
+         (delta3 - delta2) * width * slopeAt(i + 1);
 }
 
-double OrbitalDataParser::getLowestDatapoint() { return property.begin()->first; }
+double OrbitalDataParser::getLowestDatapoint() { return data->times.front(); }
+
+double OrbitalDataParser::getHighestDatapoint() { return data->times.back(); }
 
-double OrbitalDataParser::getHighestDatapoint() { return property.rbegin()->first; }
+double OrbitalDataParser::getLowestDatavalue() { return data->values.front(); }
 
-double OrbitalDataParser::getLowestDatavalue() { return property.begin()->second; }
+double OrbitalDataParser::getHighestDatavalue() { return data->values.back(); }
 
-double OrbitalDataParser::getHighestDatavalue() { return property.rbegin()->second; }
+std::vector<std::pair<double, double>> OrbitalDataParser::findIntervalsAtMost(double max_value) const {
+  auto &times = data->times;
+  auto &values = data->values;
+  constexpr double infinity = std::numeric_limits<double>::infinity();
+  std::vector<std::pair<double, double>> intervals;
+  double begin = -infinity;
+  bool inside = values.front() <= max_value;
+  for (std::size_t i = 1; i < times.size(); i++) {
+    if ((values[i] <= max_value) == inside) continue;
+    // where the segment crosses max_value
+    double crossing = times[i - 1] + (max_value - values[i - 1]) / (values[i] - values[i - 1]) * (times[i] - times[i - 1]);
+    if (inside) intervals.emplace_back(begin, crossing);
+    begin = crossing;
+    inside = !inside;
+  }
+  if (inside) intervals.emplace_back(begin, infinity);
+  return intervals;
+}
 
 OrbitalDataParser::~OrbitalDataParser() {}
@@ -8,28 +8,47 @@
 #pragma once
 
 #include <omnetpp.h>
-#include <fstream>
-#include <map>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
 
 using namespace omnetpp;
 using std::string;
 
 class OrbitalDataParser {
  public:
+  enum class Interpolation { Linear, Cubic };
+
   OrbitalDataParser();
-  OrbitalDataParser(const string filename);
+  // the parsers of the same file share the parsed data points
+  OrbitalDataParser(const string filename, Interpolation interpolation = Interpolation::Linear);
   virtual ~OrbitalDataParser();
   double getPropertyAtTime(const double time);
   double getLowestDatapoint();
   double getHighestDatapoint();
   double getLowestDatavalue();
   double getHighestDatavalue();
+  // the time intervals [begin, end] where the linear interpolation of the data is at most max_value, in order.
+  // the first and the last ones are unbounded if the data starts or ends within max_value, as getPropertyAtTime holds its ends
+  std::vector<std::pair<double, double>> findIntervalsAtMost(double max_value) const;
   char* getName;
 
  private:
-  std::ifstream file;
+  // the data points of a file sorted by time
+  struct Dataset {
+    std::vector<double> times;
+    std::vector<double> values;
+    double uniform_step = 0;  // the step between the times if they are evenly spaced, 0 otherwise
+  };
+  static std::shared_ptr<const Dataset> loadDataset(const string& filename);
+  // returns i such that times[i] <= time < times[i + 1], for time in the range of the data
+  std::size_t findSegment(const double time);
+  double slopeAt(std::size_t i) const;
+
   char* name;
-  double last_polled_time = -1;
-  double last_polled_value = -1;
-  std::map<double, double> property;
+  std::shared_ptr<const Dataset> data;
+  Interpolation interpolation = Interpolation::Linear;
+  // the segment of the last query; the queries of a channel move forward slowly
+  std::size_t last_segment = 0;
 };
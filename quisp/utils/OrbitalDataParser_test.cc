@@ -6,6 +6,7 @@
 
 #include "OrbitalDataParser.h"
 
+#include <cmath>
 #include <cstdio>
 
 using namespace quisp_test;
@@ -53,4 +54,59 @@ TEST_F(OrbitalDataParserTest, normalOperation) {
   ASSERT_DOUBLE_EQ(csv_parser->getPropertyAtTime(287.4), 274800);
 }
 
+TEST_F(OrbitalDataParserTest, cubicInterpolation) {
+  OrbitalDataParser cubic{"channels/test_csv.csv", OrbitalDataParser::Interpolation::Cubic};
+  // through the data points
+  ASSERT_DOUBLE_EQ(cubic.getPropertyAtTime(200), 100000);
+  ASSERT_DOUBLE_EQ(cubic.getPropertyAtTime(300), 300000);
+  ASSERT_DOUBLE_EQ(cubic.getPropertyAtTime(400), 200000);
+  // the slopes at 200, 300 and 400 are 2000, 500 and -1000
+  ASSERT_DOUBLE_EQ(cubic.getPropertyAtTime(250), 0.5 * 100000 + 0.125 * 100 * 2000 + 0.5 * 300000 - 0.125 * 100 * 500);
+  ASSERT_DOUBLE_EQ(cubic.getPropertyAtTime(500), 200000);
+}
+
+TEST_F(OrbitalDataParserTest, unevenlySpacedAndUnsorted) {
+  std::ofstream csv("channels/test_uneven_csv.csv");
+  csv << "10,5\n";
+  csv << "0,0\n";
+  csv << "1,1\n";
+  csv << "4,4\n";
+  csv.close();
+  OrbitalDataParser parser{"channels/test_uneven_csv.csv"};
+  std::remove("channels/test_uneven_csv.csv");
+  ASSERT_DOUBLE_EQ(parser.getLowestDatapoint(), 0);
+  ASSERT_DOUBLE_EQ(parser.getHighestDatapoint(), 10);
+  // forward, backward and jumping queries
+  ASSERT_DOUBLE_EQ(parser.getPropertyAtTime(0.5), 0.5);
+  ASSERT_DOUBLE_EQ(parser.getPropertyAtTime(2.5), 2.5);
+  ASSERT_DOUBLE_EQ(parser.getPropertyAtTime(7), 4.5);
+  ASSERT_DOUBLE_EQ(parser.getPropertyAtTime(1), 1);
+  ASSERT_DOUBLE_EQ(parser.getPropertyAtTime(10), 5);
+}
+
+TEST_F(OrbitalDataParserTest, intervalsAtMost) {
+  // 100000 -> 300000 -> 200000 crosses 150000 on the way up only, 250000 both ways
+  auto below = csv_parser->findIntervalsAtMost(150000);
+  ASSERT_EQ(below.size(), 1);
+  ASSERT_TRUE(std::isinf(below[0].first));
+  ASSERT_DOUBLE_EQ(below[0].second, 225);
+  auto middle = csv_parser->findIntervalsAtMost(250000);
+  ASSERT_EQ(middle.size(), 2);
+  ASSERT_DOUBLE_EQ(middle[0].second, 275);
+  ASSERT_DOUBLE_EQ(middle[1].first, 350);
+  ASSERT_TRUE(std::isinf(middle[1].second));
+  ASSERT_TRUE(csv_parser->findIntervalsAtMost(50000).empty());
+  ASSERT_EQ(csv_parser->findIntervalsAtMost(400000).size(), 1);
+}
+
+TEST_F(OrbitalDataParserTest, sharedDataOfTheSameFile) {
+  // the file is parsed once while a parser of it is alive
+  std::remove("channels/test_csv.csv");
+  OrbitalDataParser same_file{"channels/test_csv.csv"};
+  ASSERT_DOUBLE_EQ(same_file.getPropertyAtTime(350), 250000);
+  delete csv_parser;
+  csv_parser = nullptr;
+  ASSERT_DOUBLE_EQ(same_file.getPropertyAtTime(350), 250000);
+}
+
 }  // namespace
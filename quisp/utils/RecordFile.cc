@@ -0,0 +1,58 @@
+#include "RecordFile.h"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace quisp::utils {
+
+RecordFile::RecordFile(std::string path, std::string_view tag, std::size_t record_size) : path(std::move(path)), tag(tag), record_size(record_size) {
+  if (tag.size() > tag_size) throw std::invalid_argument("RecordFile: the tag is longer than " + std::to_string(tag_size) + " bytes");
+  if (record_size == 0) throw std::invalid_argument("RecordFile: the records must not be empty");
+  this->tag.resize(tag_size, '\0');
+}
+
+void RecordFile::read(const std::function<void(const std::byte *)> &visit) const {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) return;
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+    ::close(fd);
+    return;
+  }
+  std::size_t size = st.st_size;
+  void *mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (mapped == MAP_FAILED) throw std::runtime_error("RecordFile: couldn't map " + path);
+  auto *bytes = static_cast<const std::byte *>(mapped);
+  if (size < tag_size || std::memcmp(bytes, tag.data(), tag_size) != 0) {
+    ::munmap(mapped, size);
+    throw std::runtime_error("RecordFile: " + path + " isn't a file of " + tag.c_str() + " records");
+  }
+  for (std::size_t offset = tag_size; offset + record_size <= size; offset += record_size) visit(bytes + offset);
+  ::munmap(mapped, size);
+}
+
+void RecordFile::append(const void *records, std::size_t num_records) const {
+  if (num_records == 0) return;
+  int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+  if (fd < 0) throw std::runtime_error("RecordFile: couldn't open " + path);
+  // the first appender of a new file writes the tag, the others wait for it
+  ::flock(fd, LOCK_EX);
+  std::vector<char> buffer;
+  struct stat st;
+  if (::fstat(fd, &st) == 0 && st.st_size == 0) buffer.insert(buffer.end(), tag.begin(), tag.end());
+  auto *bytes = static_cast<const char *>(records);
+  buffer.insert(buffer.end(), bytes, bytes + record_size * num_records);
+  bool written = ::write(fd, buffer.data(), buffer.size()) == static_cast<ssize_t>(buffer.size());
+  ::flock(fd, LOCK_UN);
+  ::close(fd);
+  if (!written) throw std::runtime_error("RecordFile: couldn't append to " + path);
+}
+
+}  // namespace quisp::utils
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace quisp::utils {
+
+/**
+ * @brief an append-only file of fixed size records, shared by the runs and the workers of a sweep.
+ *
+ * The file starts with a tag of the record type, and the raw bytes of the records follow.
+ * read() maps the file instead of copying it, and append() writes a record in one write to the file opened with O_APPEND,
+ * so the records of the concurrent appenders don't interleave. A partial record at the end, e.g. of a killed run, is skipped.
+ */
+class RecordFile {
+ public:
+  static constexpr std::size_t tag_size = 8;
+
+  /// @throws std::invalid_argument if the tag is longer than tag_size or record_size is 0
+  RecordFile(std::string path, std::string_view tag, std::size_t record_size);
+
+  /// @brief calls visit with the bytes of each record. A missing file has no records.
+  /// @throws std::runtime_error if the file has another tag
+  void read(const std::function<void(const std::byte *)> &visit) const;
+  /// @brief appends num_records records of record_size bytes in one write, writing the tag first into a new file.
+  /// @throws std::runtime_error if the file can't be written
+  void append(const void *records, std::size_t num_records = 1) const;
+
+  const std::string &getPath() const { return path; }
+
+ private:
+  std::string path;
+  std::string tag;
+  std::size_t record_size;
+};
+
+}  // namespace quisp::utils
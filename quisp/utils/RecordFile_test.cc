@@ -0,0 +1,83 @@
+#include "RecordFile.h"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+using quisp::utils::RecordFile;
+using Record = std::array<double, 3>;
+
+class RecordFileTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    path = testing::TempDir() + "record_file_test_" + std::to_string(::getpid());
+    ::unlink(path.c_str());
+  }
+  void TearDown() override { ::unlink(path.c_str()); }
+
+  std::vector<Record> readAll(const RecordFile &file) {
+    std::vector<Record> records;
+    file.read([&](const std::byte *bytes) {
+      Record record;
+      std::memcpy(&record, bytes, sizeof(Record));
+      records.push_back(record);
+    });
+    return records;
+  }
+
+  std::string path;
+};
+
+TEST_F(RecordFileTest, MissingFileHasNoRecords) {
+  RecordFile file{path, "TEST", sizeof(Record)};
+  EXPECT_TRUE(readAll(file).empty());
+}
+
+TEST_F(RecordFileTest, AppendAndRead) {
+  RecordFile file{path, "TEST", sizeof(Record)};
+  Record first{1.0, 2.0, 3.0}, second{0.5, 0.25, 0.125};
+  file.append(&first);
+  file.append(&second);
+  // another run reads the records of the former
+  RecordFile other{path, "TEST", sizeof(Record)};
+  auto records = readAll(other);
+  ASSERT_EQ(records.size(), 2);
+  EXPECT_EQ(records[0], first);
+  EXPECT_EQ(records[1], second);
+}
+
+TEST_F(RecordFileTest, AppendRecordsAtOnce) {
+  RecordFile file{path, "TEST", sizeof(Record)};
+  std::vector<Record> records{{1.0, 2.0, 3.0}, {4.0, 5.0, 6.0}, {7.0, 8.0, 9.0}};
+  file.append(records.data(), records.size());
+  file.append(records.data(), 0);
+  EXPECT_EQ(readAll(file), records);
+}
+
+TEST_F(RecordFileTest, SkipTruncatedRecord) {
+  RecordFile file{path, "TEST", sizeof(Record)};
+  Record record{1.0, 2.0, 3.0};
+  file.append(&record);
+  {
+    std::ofstream out{path, std::ios::binary | std::ios::app};
+    out.write(reinterpret_cast<const char *>(&record), sizeof(double));
+  }
+  EXPECT_EQ(readAll(file).size(), 1);
+}
+
+TEST_F(RecordFileTest, RejectOtherTag) {
+  Record record{1.0, 2.0, 3.0};
+  RecordFile{path, "TEST", sizeof(Record)}.append(&record);
+  RecordFile other{path, "OTHER", sizeof(Record)};
+  EXPECT_THROW(readAll(other), std::runtime_error);
+}
+
+TEST_F(RecordFileTest, RejectLongTag) { EXPECT_THROW((RecordFile{path, "TOO_LONG_TAG", sizeof(Record)}), std::invalid_argument); }
+
+}  // namespace
@@ -0,0 +1,96 @@
+#include "StreamingStats.h"
+#include <algorithm>
+#include <cmath>
+
+namespace quisp::utils {
+
+LogHistogram::LogHistogram(int precision_bits) : sub_buckets(1 << precision_bits) {}
+
+void LogHistogram::record(double value) {
+  num_samples++;
+  total += value;
+  min_value = std::min(min_value, value);
+  max_value = std::max(max_value, value);
+  if (!(value > 0) || !std::isfinite(value)) {
+    zero_count++;
+    return;
+  }
+  int exponent;
+  // value = mantissa * 2^exponent, mantissa in [0.5, 1)
+  double mantissa = std::frexp(value, &exponent);
+  int sub_bucket = std::min(sub_buckets - 1, static_cast<int>((mantissa - 0.5) * 2 * sub_buckets));
+  if (buckets.empty()) {
+    min_exponent = exponent;
+  } else if (exponent < min_exponent) {
+    // a new smallest exponent, which happens at most once per power of two
+    buckets.insert(buckets.begin(), static_cast<std::size_t>(min_exponent - exponent) * sub_buckets, 0);
+    min_exponent = exponent;
+  }
+  auto index = bucketIndex(exponent, sub_bucket);
+  if (index >= buckets.size()) buckets.resize((index / sub_buckets + 1) * sub_buckets, 0);
+  buckets[index]++;
+}
+
+void LogHistogram::clear() {
+  buckets.clear();
+  zero_count = 0;
+  num_samples = 0;
+  total = 0;
+  min_value = std::numeric_limits<double>::infinity();
+  max_value = -std::numeric_limits<double>::infinity();
+}
+
+double LogHistogram::quantile(double q) const {
+  if (num_samples == 0) return 0;
+  auto rank = static_cast<std::uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * num_samples));
+  rank = std::clamp<std::uint64_t>(rank, 1, num_samples);
+  if (rank <= zero_count) return min_value;
+  std::uint64_t seen = zero_count;
+  for (std::size_t index = 0; index < buckets.size(); index++) {
+    seen += buckets[index];
+    if (seen < rank) continue;
+    int exponent = min_exponent + static_cast<int>(index / sub_buckets);
+    double sub_bucket = static_cast<double>(index % sub_buckets);
+    double midpoint = std::ldexp(0.5 + (sub_bucket + 0.5) / (2 * sub_buckets), exponent);
+    return std::clamp(midpoint, min_value, max_value);
+  }
+  return max_value;
+}
+
+void LogHistogram::forEachSummary(const std::function<void(const std::string &, double)> &f) const {
+  f(":count", num_samples);
+  f(":mean", mean());
+  f(":min", min());
+  f(":max", max());
+  f(":p50", quantile(0.5));
+  f(":p90", quantile(0.9));
+  f(":p99", quantile(0.99));
+}
+
+void EwmaRate::count(double now, double amount) {
+  value = rate(now) + amount / tau;
+  last_time = std::max(last_time, now);
+}
+
+double EwmaRate::rate(double now) const { return value * std::exp(-std::max(0.0, now - last_time) / tau); }
+
+void TimeWeightedAverage::update(double now, double value) {
+  if (!started) {
+    started = true;
+    start_time = now;
+  } else {
+    area += current * (now - last_time);
+  }
+  last_time = now;
+  current = value;
+  max_value = std::max(max_value, value);
+}
+
+double TimeWeightedAverage::average(double now) const {
+  if (!started) return 0;
+  double duration = now - start_time;
+  if (duration <= 0) return current;
+  return (area + current * (now - last_time)) / duration;
+}
+
+}  // namespace quisp::utils
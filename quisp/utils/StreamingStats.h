@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace quisp::utils {
+
+/**
+ * @brief LogHistogram counts the samples in logarithmic buckets with a bounded relative error, like HdrHistogram,
+ * so the quantiles of millions of samples take a few KB and each sample O(1).
+ *
+ * Each power of two is split into 2^precision_bits linear sub-buckets, so a quantile is within 2^-precision_bits
+ * of the true one relatively. The buckets only cover the exponents seen so far.
+ * The samples not larger than 0 are counted in the zero bucket.
+ */
+class LogHistogram {
+ public:
+  explicit LogHistogram(int precision_bits = 5);
+  void record(double value);
+  void clear();
+
+  std::uint64_t count() const { return num_samples; }
+  double sum() const { return total; }
+  double mean() const { return num_samples == 0 ? 0 : total / num_samples; }
+  double min() const { return num_samples == 0 ? 0 : min_value; }
+  double max() const { return num_samples == 0 ? 0 : max_value; }
+  /// @brief the nearest-rank value of the quantile q in [0, 1], the midpoint of its bucket clamped to the min and the max. 0 if empty.
+  double quantile(double q) const;
+
+  /// @brief calls f(suffix, value) for the count, the mean, the min, the max and the p50, p90 and p99, e.g. f(":p99", 0.12).
+  void forEachSummary(const std::function<void(const std::string &, double)> &f) const;
+
+ private:
+  std::size_t bucketIndex(int exponent, int sub_bucket) const { return static_cast<std::size_t>(exponent - min_exponent) * sub_buckets + sub_bucket; }
+
+  int sub_buckets;
+  // the frexp exponent of buckets[0]
+  int min_exponent = 0;
+  std::vector<std::uint64_t> buckets;
+  std::uint64_t zero_count = 0;
+  std::uint64_t num_samples = 0;
+  double total = 0;
+  double min_value = std::numeric_limits<double>::infinity();
+  double max_value = -std::numeric_limits<double>::infinity();
+};
+
+/**
+ * @brief EwmaRate is the exponentially weighted moving average of the rate of the events with the time constant tau,
+ * e.g. the delivered Bell pairs per second over about the last tau seconds.
+ */
+class EwmaRate {
+ public:
+  explicit EwmaRate(double tau) : tau(tau) {}
+  void count(double now, double amount = 1);
+  /// @brief the rate decayed to now, not earlier than the last count.
+  double rate(double now) const;
+
+ private:
+  double tau;
+  double value = 0;
+  double last_time = 0;
+};
+
+/// @brief TimeWeightedAverage is the average of a piecewise constant value over time, like the queue length.
+class TimeWeightedAverage {
+ public:
+  /// @brief the value changes to value at now, which must not go back.
+  void update(double now, double value);
+  double average(double now) const;
+  double max() const { return max_value; }
+
+ private:
+  bool started = false;
+  double start_time = 0;
+  double last_time = 0;
+  double current = 0;
+  double area = 0;
+  double max_value = 0;
+};
+
+}  // namespace quisp::utils
@@ -0,0 +1,72 @@
+#include "StreamingStats.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <map>
+#include <string>
+
+namespace {
+using quisp::utils::EwmaRate;
+using quisp::utils::LogHistogram;
+using quisp::utils::TimeWeightedAverage;
+
+TEST(LogHistogramTest, QuantilesWithinTheRelativeError) {
+  LogHistogram histogram{5};
+  EXPECT_EQ(histogram.quantile(0.5), 0);
+  // 1us to 10s, spread over the exponents
+  for (int i = 1; i <= 10000; i++) histogram.record(i * 1e-3);
+  EXPECT_EQ(histogram.count(), 10000);
+  EXPECT_DOUBLE_EQ(histogram.min(), 1e-3);
+  EXPECT_DOUBLE_EQ(histogram.max(), 10);
+  EXPECT_NEAR(histogram.mean(), 5.0005, 1e-9);
+  for (double q : {0.01, 0.5, 0.9, 0.99}) {
+    double exact = std::ceil(q * 10000) * 1e-3;
+    EXPECT_NEAR(histogram.quantile(q), exact, exact / 32) << q;
+  }
+  EXPECT_DOUBLE_EQ(histogram.quantile(0), 1e-3);
+  EXPECT_DOUBLE_EQ(histogram.quantile(1), 10);
+}
+
+TEST(LogHistogramTest, ZeroAndSmallerExponentLater) {
+  LogHistogram histogram;
+  histogram.record(100);
+  histogram.record(0);
+  // a smaller exponent than the first sample moves the buckets
+  histogram.record(0.001);
+  histogram.record(100);
+  EXPECT_EQ(histogram.quantile(0.25), 0);
+  EXPECT_NEAR(histogram.quantile(0.5), 0.001, 0.001 / 32);
+  EXPECT_NEAR(histogram.quantile(0.75), 100, 100.0 / 32);
+
+  std::map<std::string, double> summary;
+  histogram.forEachSummary([&](const std::string &suffix, double value) { summary[suffix] = value; });
+  EXPECT_EQ(summary.size(), 7);
+  EXPECT_EQ(summary[":count"], 4);
+  EXPECT_EQ(summary[":min"], 0);
+
+  histogram.clear();
+  EXPECT_EQ(histogram.count(), 0);
+  EXPECT_EQ(histogram.max(), 0);
+}
+
+TEST(EwmaRateTest, ConvergeToTheRate) {
+  EwmaRate rate{1.0};
+  // 10 events per second for 20 time constants
+  for (int i = 1; i <= 200; i++) rate.count(i * 0.1);
+  EXPECT_NEAR(rate.rate(20), 10, 0.6);
+  // decays without the events
+  EXPECT_NEAR(rate.rate(21), rate.rate(20) / std::exp(1), 1e-9);
+}
+
+TEST(TimeWeightedAverageTest, AverageOverTime) {
+  TimeWeightedAverage average;
+  EXPECT_EQ(average.average(1), 0);
+  average.update(0, 0);
+  average.update(1, 4);
+  average.update(3, 1);
+  // 0 for 1s, 4 for 2s, 1 for 1s
+  EXPECT_DOUBLE_EQ(average.average(4), 9.0 / 4);
+  EXPECT_EQ(average.max(), 4);
+}
+
+}  // namespace
@@ -0,0 +1,66 @@
+#include "ThreadPool.h"
+
+namespace quisp::utils {
+
+ThreadPool::ThreadPool(int num_threads) {
+  for (int i = 1; i < num_threads; i++) workers.emplace_back([this] { workerLoop(); });
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  work_ready.notify_all();
+  for (auto &worker : workers) worker.join();
+}
+
+void ThreadPool::parallelFor(std::size_t n, const std::function<void(std::size_t)> &f) {
+  if (workers.empty() || n <= 1) {
+    for (std::size_t i = 0; i < n; i++) f(i);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    task = &f;
+    num_tasks = n;
+    next_task = 0;
+    error = nullptr;
+    num_busy_workers = workers.size();
+    generation++;
+  }
+  work_ready.notify_all();
+  runTasks();
+
+  std::unique_lock<std::mutex> lock(mutex);
+  work_done.wait(lock, [this] { return num_busy_workers == 0; });
+  task = nullptr;
+  if (error) std::rethrow_exception(error);
+}
+
+void ThreadPool::workerLoop() {
+  std::uint64_t finished_generation = 0;
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    work_ready.wait(lock, [&] { return stopping || generation != finished_generation; });
+    if (stopping) return;
+    finished_generation = generation;
+    lock.unlock();
+    runTasks();
+    lock.lock();
+    if (--num_busy_workers == 0) work_done.notify_all();
+  }
+}
+
+void ThreadPool::runTasks() {
+  for (std::size_t i = next_task++; i < num_tasks; i = next_task++) {
+    try {
+      (*task)(i);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!error) error = std::current_exception();
+    }
+  }
+}
+
+}  // namespace quisp::utils
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace quisp::utils {
+
+/**
+ * \brief ThreadPool runs the independent iterations of a loop on a fixed set of worker threads.
+ *
+ * The workers are started once and wait for the next parallelFor, so a short loop doesn't pay for starting threads.
+ * The iterations must not touch the simulation (e.g. send a message or draw a random number), OMNeT++ is single threaded.
+ */
+class ThreadPool {
+ public:
+  /// @brief num_threads includes the calling thread, so 1 runs everything on the caller.
+  explicit ThreadPool(int num_threads);
+  ~ThreadPool();
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /// @brief runs f(i) for i in [0, n) and returns when all of them finished. The first exception thrown by f is rethrown.
+  void parallelFor(std::size_t n, const std::function<void(std::size_t)> &f);
+  int size() const { return workers.size() + 1; }
+
+ private:
+  void workerLoop();
+  void runTasks();
+
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable work_ready;
+  std::condition_variable work_done;
+  const std::function<void(std::size_t)> *task = nullptr;
+  std::size_t num_tasks = 0;
+  std::atomic<std::size_t> next_task{0};
+  std::uint64_t generation = 0;
+  std::size_t num_busy_workers = 0;
+  std::exception_ptr error;
+  bool stopping = false;
+};
+
+}  // namespace quisp::utils
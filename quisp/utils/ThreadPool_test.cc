@@ -0,0 +1,33 @@
+#include "ThreadPool.h"
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+using quisp::utils::ThreadPool;
+
+TEST(ThreadPoolTest, RunAllIterations) {
+  ThreadPool pool{4};
+  EXPECT_EQ(pool.size(), 4);
+  for (int round = 0; round < 3; round++) {
+    std::vector<int> results(100, 0);
+    pool.parallelFor(results.size(), [&](std::size_t i) { results[i] = i * i + round; });
+    for (std::size_t i = 0; i < results.size(); i++) EXPECT_EQ(results[i], i * i + round);
+  }
+}
+
+TEST(ThreadPoolTest, RethrowException) {
+  ThreadPool pool{2};
+  EXPECT_THROW(pool.parallelFor(10,
+                                [](std::size_t i) {
+                                  if (i == 7) throw std::runtime_error("failed");
+                                }),
+               std::runtime_error);
+  // the pool is still usable
+  std::vector<int> results(5, 0);
+  pool.parallelFor(results.size(), [&](std::size_t i) { results[i] = 1; });
+  EXPECT_EQ(results, std::vector<int>(5, 1));
+}
+
+}  // namespace
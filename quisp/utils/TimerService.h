@@ -0,0 +1,81 @@
+#pragma once
+
+#include <omnetpp.h>
+#include <utility>
+#include <vector>
+
+#include "TimerWheel.h"
+
+namespace quisp::utils {
+
+/**
+ * \brief TimerService multiplexes the logical timers of a module onto a single self message, over a TimerWheel.
+ *
+ * A timer expires at the end of the tick of the resolution its time falls in, so the simtime precision as the resolution keeps the exact times.
+ * The module creates the service in initialize() and passes the message to handle() when it arrives,
+ * the timers due by then fire in the expiry order and the message moves to the next of them.
+ * A timer scheduled for a tick already handled fires at the next tick.
+ */
+template <typename T>
+class TimerService {
+ public:
+  using Handle = typename TimerWheel<T>::Handle;
+
+  /// @brief resolution of 0 is the simtime precision.
+  TimerService(omnetpp::cSimpleModule *owner, const char *name, omnetpp::simtime_t resolution)
+      : owner(owner),
+        resolution(resolution > omnetpp::SIMTIME_ZERO ? resolution.raw() : 1),
+        wheel(omnetpp::simTime().raw() / this->resolution),
+        timer(new omnetpp::cMessage(name)) {}
+  ~TimerService() { owner->cancelAndDelete(timer); }
+  TimerService(const TimerService &) = delete;
+  TimerService &operator=(const TimerService &) = delete;
+
+  Handle schedule(omnetpp::simtime_t at, T value) {
+    auto handle = wheel.schedule((at.raw() + resolution - 1) / resolution, std::move(value));
+    rearm();
+    return handle;
+  }
+
+  /// @brief cancels the timer. returns false if it already fired or was cancelled, the message stays until the next timer.
+  bool cancel(Handle handle) { return wheel.cancel(handle); }
+  bool isScheduled(Handle handle) const { return wheel.isActive(handle); }
+  bool isTimer(const omnetpp::cMessage *msg) const { return msg == timer; }
+
+  /// @brief fires on_expire(value) for the timers due now. on_expire may schedule and cancel timers.
+  template <typename F>
+  void handle(F on_expire) {
+    expired.clear();
+    wheel.advance(omnetpp::simTime().raw() / resolution, [&](T &value) { expired.push_back(std::move(value)); });
+    // the wheel is done with the tick, so the timers scheduled by on_expire land after it
+    auto firing = std::move(expired);
+    for (auto &value : firing) on_expire(value);
+    expired = std::move(firing);
+    rearm();
+  }
+
+  std::size_t size() const { return wheel.size(); }
+  bool empty() const { return wheel.empty(); }
+
+ private:
+  // moves the message to the tick of the next timer, if it's earlier than the message
+  void rearm() {
+    auto next_tick = wheel.nextExpiry();
+    if (!next_tick.has_value()) return;
+    auto at = omnetpp::SimTime().setRaw(*next_tick * resolution);
+    if (at < omnetpp::simTime()) at = omnetpp::simTime();
+    if (timer->isScheduled()) {
+      if (timer->getArrivalTime() <= at) return;
+      owner->cancelEvent(timer);
+    }
+    owner->scheduleAt(at, timer);
+  }
+
+  omnetpp::cSimpleModule *owner;
+  std::int64_t resolution;
+  TimerWheel<T> wheel;
+  omnetpp::cMessage *timer;
+  std::vector<T> expired;
+};
+
+}  // namespace quisp::utils
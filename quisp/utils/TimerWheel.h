@@ -0,0 +1,197 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace quisp::utils {
+
+/**
+ * \brief TimerWheel is a hierarchical timing wheel of the timers of many objects, over integer ticks.
+ *
+ * Level L has 64 slots of 64^L ticks each, a timer lands in the lowest level that covers its expiry
+ * and moves down a level each time the wheel enters its slot, so scheduling and cancelling are O(1)
+ * and advance() only touches the slots with timers. The timers beyond the top level wait in an overflow list.
+ * A module drives the wheel with a single self message at nextExpiry(), instead of a message per timer.
+ */
+template <typename T>
+class TimerWheel {
+ public:
+  struct Handle {
+    std::uint32_t index = invalid_index;
+    std::uint32_t generation = 0;
+  };
+
+  /// @brief starts the wheel at the tick, the timers expiring before it fire at the first advance().
+  explicit TimerWheel(std::uint64_t start_tick = 0) : now(start_tick) {}
+
+  Handle schedule(std::uint64_t expiry_tick, T value) {
+    std::uint32_t index;
+    if (!free_entries.empty()) {
+      index = free_entries.back();
+      free_entries.pop_back();
+    } else {
+      index = entries.size();
+      entries.emplace_back();
+    }
+    auto &entry = entries[index];
+    entry.expiry = expiry_tick < now ? now : expiry_tick;
+    entry.value = std::move(value);
+    entry.active = true;
+    place(index);
+    num_active++;
+    return {index, entry.generation};
+  }
+
+  /// @brief cancels the timer. returns false if it already fired or was cancelled.
+  bool cancel(Handle handle) {
+    if (!isActive(handle)) return false;
+    entries[handle.index].active = false;
+    entries[handle.index].generation++;
+    num_active--;
+    return true;
+  }
+
+  bool isActive(Handle handle) const { return handle.index < entries.size() && entries[handle.index].active && entries[handle.index].generation == handle.generation; }
+
+  /// @brief fires on_expire(value) for all the timers expiring until the tick (inclusive), in the expiry order.
+  template <typename F>
+  void advance(std::uint64_t tick, F on_expire) {
+    while (now <= tick) {
+      if (level_sizes[0] > 0) {
+        auto &slot = slots[0][now & slot_mask];
+        auto expired = std::move(slot);
+        slot.clear();
+        level_sizes[0] -= expired.size();
+        for (auto index : expired) {
+          auto &entry = entries[index];
+          if (entry.active) {
+            entry.active = false;
+            entry.generation++;
+            num_active--;
+            on_expire(entry.value);
+          }
+          free_entries.push_back(index);
+        }
+      }
+      // skip the empty slots of the lower levels at once
+      int empty_levels = 0;
+      while (empty_levels < num_levels && level_sizes[empty_levels] == 0) empty_levels++;
+      if (empty_levels == num_levels && overflow.empty()) {
+        now = tick + 1;
+        break;
+      }
+      auto step_shift = empty_levels * bits_per_level;
+      auto next = ((now >> step_shift) + 1) << step_shift;
+      // the far timers pass the empty top epochs at once, instead of an epoch at a time
+      if (empty_levels == num_levels) next = std::max(next, overflowEpoch());
+      // never past the tick, a timer scheduled after this call may expire right after it
+      now = std::min(next, tick + 1);
+      cascade();
+    }
+  }
+
+  /**
+   * @brief the tick to advance to next, or nullopt if no timer is scheduled.
+   * It's the earliest expiry, or the earlier tick at which that timer moves down to a lower level.
+   */
+  std::optional<std::uint64_t> nextExpiry() const {
+    if (num_active == 0) return std::nullopt;
+    for (int level = 0; level < num_levels; level++) {
+      if (level_sizes[level] == 0) continue;
+      auto shift = level * bits_per_level;
+      auto current = (now >> shift) & slot_mask;
+      for (auto i = current; i < num_slots; i++) {
+        if (!slots[level][i].empty()) {
+          auto epoch = (now >> (shift + bits_per_level)) << (shift + bits_per_level);
+          auto start = epoch + (i << shift);
+          return start < now ? now : start;
+        }
+      }
+    }
+    return std::max(((now >> top_shift) + 1) << top_shift, overflowEpoch());
+  }
+
+  std::size_t size() const { return num_active; }
+  bool empty() const { return num_active == 0; }
+  std::uint64_t currentTick() const { return now; }
+
+ private:
+  static constexpr int bits_per_level = 6;
+  static constexpr std::uint64_t num_slots = 1 << bits_per_level;
+  static constexpr std::uint64_t slot_mask = num_slots - 1;
+  static constexpr int num_levels = 4;
+  static constexpr std::uint32_t invalid_index = ~std::uint32_t{0};
+  static constexpr int top_shift = num_levels * bits_per_level;
+
+  struct Entry {
+    std::uint64_t expiry = 0;
+    std::uint32_t generation = 0;
+    bool active = false;
+    T value{};
+  };
+
+  void place(std::uint32_t index) {
+    auto expiry = entries[index].expiry;
+    for (int level = 0; level < num_levels; level++) {
+      auto upper_shift = (level + 1) * bits_per_level;
+      if ((expiry >> upper_shift) == (now >> upper_shift)) {
+        slots[level][(expiry >> (level * bits_per_level)) & slot_mask].push_back(index);
+        level_sizes[level]++;
+        return;
+      }
+    }
+    overflow.push_back(index);
+  }
+
+  // the first tick of the top epoch of the earliest timer in the overflow, 0 if none is active
+  std::uint64_t overflowEpoch() const {
+    std::optional<std::uint64_t> earliest;
+    for (auto index : overflow) {
+      if (entries[index].active && (!earliest.has_value() || entries[index].expiry < *earliest)) earliest = entries[index].expiry;
+    }
+    return earliest.has_value() ? (*earliest >> top_shift) << top_shift : 0;
+  }
+
+  // moves the timers of the slots the wheel just entered down, from the top level
+  void cascade() {
+    if ((now & ((std::uint64_t{1} << top_shift) - 1)) == 0) {
+      auto waiting = std::move(overflow);
+      overflow.clear();
+      for (auto index : waiting) replace(index);
+    }
+    for (int level = num_levels - 1; level >= 1; level--) {
+      auto shift = level * bits_per_level;
+      if ((now & ((std::uint64_t{1} << shift) - 1)) != 0) continue;
+      auto &slot = slots[level][(now >> shift) & slot_mask];
+      if (slot.empty()) continue;
+      auto moving = std::move(slot);
+      slot.clear();
+      level_sizes[level] -= moving.size();
+      for (auto index : moving) replace(index);
+    }
+  }
+
+  // places the timer again, or frees it if it was cancelled
+  void replace(std::uint32_t index) {
+    if (!entries[index].active) {
+      free_entries.push_back(index);
+    } else {
+      place(index);
+    }
+  }
+
+  std::uint64_t now;
+  std::vector<Entry> entries;
+  std::vector<std::uint32_t> free_entries;
+  std::array<std::array<std::vector<std::uint32_t>, num_slots>, num_levels> slots;
+  std::array<std::size_t, num_levels> level_sizes{};
+  std::vector<std::uint32_t> overflow;
+  std::size_t num_active = 0;
+};
+
+}  // namespace quisp::utils
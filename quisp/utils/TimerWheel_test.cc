@@ -0,0 +1,114 @@
+#include "TimerWheel.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace {
+using quisp::utils::TimerWheel;
+
+TEST(TimerWheelTest, FireInExpiryOrder) {
+  TimerWheel<int> wheel;
+  wheel.schedule(5, 1);
+  wheel.schedule(70, 2);
+  wheel.schedule(3, 3);
+  wheel.schedule(5000, 4);
+  wheel.schedule(20000000, 5);
+  EXPECT_EQ(wheel.size(), 5);
+  EXPECT_EQ(wheel.nextExpiry(), 3);
+
+  std::vector<int> fired;
+  wheel.advance(69, [&](int value) { fired.push_back(value); });
+  EXPECT_EQ(fired, (std::vector<int>{3, 1}));
+  wheel.advance(30000000, [&](int value) { fired.push_back(value); });
+  EXPECT_EQ(fired, (std::vector<int>{3, 1, 2, 4, 5}));
+  EXPECT_TRUE(wheel.empty());
+  EXPECT_EQ(wheel.nextExpiry(), std::nullopt);
+}
+
+TEST(TimerWheelTest, Cancel) {
+  TimerWheel<int> wheel;
+  auto first = wheel.schedule(10, 1);
+  auto second = wheel.schedule(10, 2);
+  EXPECT_TRUE(wheel.cancel(first));
+  EXPECT_FALSE(wheel.cancel(first));
+  EXPECT_FALSE(wheel.isActive(first));
+  EXPECT_TRUE(wheel.isActive(second));
+  std::vector<int> fired;
+  wheel.advance(10, [&](int value) { fired.push_back(value); });
+  EXPECT_EQ(fired, (std::vector<int>{2}));
+  EXPECT_FALSE(wheel.cancel(second));
+
+  // the slot of the cancelled timer is reused without reviving the old handle
+  auto third = wheel.schedule(20, 3);
+  EXPECT_FALSE(wheel.isActive(first));
+  EXPECT_TRUE(wheel.isActive(third));
+}
+
+TEST(TimerWheelTest, PastExpiryFiresAtNextAdvance) {
+  TimerWheel<int> wheel;
+  std::vector<int> fired;
+  wheel.advance(100, [&](int value) { fired.push_back(value); });
+  wheel.schedule(50, 1);
+  EXPECT_EQ(wheel.nextExpiry(), 101);
+  wheel.advance(101, [&](int value) { fired.push_back(value); });
+  EXPECT_EQ(fired, (std::vector<int>{1}));
+}
+
+TEST(TimerWheelTest, FarTimersSkipTheEmptyEpochs) {
+  constexpr std::uint64_t epoch = std::uint64_t{1} << 24;
+  TimerWheel<int> wheel;
+  wheel.schedule(1000 * epoch + 5, 1);
+  wheel.schedule(3000 * epoch, 2);
+  // the wheel wakes up at the epoch of the timer, not at each epoch before it
+  EXPECT_EQ(wheel.nextExpiry(), 1000 * epoch);
+  std::vector<int> fired;
+  wheel.advance(1000 * epoch, [&](int value) { fired.push_back(value); });
+  EXPECT_TRUE(fired.empty());
+  EXPECT_EQ(wheel.nextExpiry(), 1000 * epoch + 5);
+  wheel.advance(2000 * epoch, [&](int value) { fired.push_back(value); });
+  EXPECT_EQ(fired, (std::vector<int>{1}));
+  EXPECT_EQ(wheel.nextExpiry(), 3000 * epoch);
+  wheel.advance(3000 * epoch, [&](int value) { fired.push_back(value); });
+  EXPECT_EQ(fired, (std::vector<int>{1, 2}));
+}
+
+TEST(TimerWheelTest, MatchesSortedTimers) {
+  std::mt19937_64 rng(1);
+  TimerWheel<int> wheel;
+  std::map<int, std::uint64_t> active;
+  std::vector<TimerWheel<int>::Handle> handles;
+  std::uint64_t now = 0;
+  for (int i = 0; i < 20000; i++) {
+    auto op = rng() % 10;
+    if (op < 5) {
+      auto expiry = now + 1 + rng() % (op < 2 ? 100 : op < 4 ? 20000000 : 5000000000);
+      handles.push_back(wheel.schedule(expiry, handles.size()));
+      active[handles.size() - 1] = expiry;
+    } else if (op < 7 && !handles.empty()) {
+      int id = rng() % handles.size();
+      EXPECT_EQ(wheel.cancel(handles[id]), active.erase(id) == 1);
+    } else {
+      if (!active.empty()) {
+        auto earliest = std::min_element(active.begin(), active.end(), [](auto &a, auto &b) { return a.second < b.second; })->second;
+        ASSERT_LE(wheel.nextExpiry().value(), earliest);
+      }
+      now += rng() % (op == 9 ? 5000000 : 200);
+      std::uint64_t last_expiry = 0;
+      wheel.advance(now, [&](int id) {
+        auto it = active.find(id);
+        ASSERT_NE(it, active.end());
+        EXPECT_LE(it->second, now);
+        EXPECT_GE(it->second, last_expiry);
+        last_expiry = it->second;
+        active.erase(it);
+      });
+      for (auto &[id, expiry] : active) ASSERT_GT(expiry, now);
+    }
+    ASSERT_EQ(wheel.size(), active.size());
+  }
+}
+
+}  // namespace
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+namespace quisp::utils {
+
+/**
+ * \brief TypeDispatcher calls the handler registered for the dynamic type of an object, e.g. a cMessage.
+ *
+ * The handlers are tried in the registration order with dynamic_cast, like the if-else chain of
+ * dynamic_casts in handleMessage(), but only for the first object of each dynamic type.
+ * The result is cached by the dynamic type, so the later dispatches are a single hash lookup.
+ * Each handler counts the objects it handled for instrumentation.
+ *
+ * A module registers its handlers once, e.g. in initialize(), and dispatches in handleMessage().
+ */
+template <typename Base, typename Result = void>
+class TypeDispatcher {
+ public:
+  using Handler = std::function<Result(Base *)>;
+
+  /// @brief registers the handler for T and its subclasses. The earlier registration wins, so register subclasses first.
+  template <typename T, typename F>
+  TypeDispatcher &on(F handler) {
+    static_assert(std::is_base_of_v<Base, T>, "T must be a subclass of Base");
+    entries.push_back(Entry{&typeid(T), [](Base *obj) { return dynamic_cast<T *>(obj) != nullptr; },
+                            [handler](Base *obj) -> Result { return handler(static_cast<T *>(obj)); }});
+    resolved.clear();
+    return *this;
+  }
+
+  /// @brief registers the handler for the objects without a registered handler.
+  TypeDispatcher &otherwise(Handler handler) {
+    fallback = std::move(handler);
+    return *this;
+  }
+
+  /// @brief calls the handler for the object's type. If there's no handler, Result{} is returned.
+  Result dispatch(Base *obj) {
+    auto index = resolve(obj);
+    if (index == none) {
+      unhandled++;
+      if (fallback) return fallback(obj);
+      return Result();
+    }
+    auto &entry = entries[index];
+    entry.count++;
+    return entry.handler(obj);
+  }
+
+  /// @brief calls f(type_info, count) for each registered handler, in the registration order.
+  template <typename F>
+  void forEachCount(F f) const {
+    for (auto &entry : entries) f(*entry.type, entry.count);
+  }
+
+  /// @brief the number of the objects dispatched without a registered handler.
+  std::uint64_t unhandledCount() const { return unhandled; }
+
+  bool empty() const { return entries.empty(); }
+
+ private:
+  static constexpr std::size_t none = std::numeric_limits<std::size_t>::max();
+
+  struct Entry {
+    const std::type_info *type;
+    bool (*matches)(Base *);
+    Handler handler;
+    std::uint64_t count = 0;
+  };
+
+  std::size_t resolve(Base *obj) {
+    std::type_index type{typeid(*obj)};
+    auto it = resolved.find(type);
+    if (it != resolved.end()) return it->second;
+    auto index = none;
+    for (std::size_t i = 0; i < entries.size(); i++) {
+      if (entries[i].matches(obj)) {
+        index = i;
+        break;
+      }
+    }
+    resolved.emplace(type, index);
+    return index;
+  }
+
+  std::vector<Entry> entries;
+  // the handler index by the dynamic type, `none` if no handler matches
+  std::unordered_map<std::type_index, std::size_t> resolved;
+  Handler fallback;
+  std::uint64_t unhandled = 0;
+};
+
+}  // namespace quisp::utils
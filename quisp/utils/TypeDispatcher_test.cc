@@ -0,0 +1,87 @@
+#include "TypeDispatcher.h"
+
+#include <gtest/gtest.h>
+#include <string>
+
+namespace {
+using quisp::utils::TypeDispatcher;
+
+struct Message {
+  virtual ~Message() = default;
+};
+struct Notification : Message {};
+struct CombinedNotification : Notification {};
+struct Request : Message {
+  int value = 0;
+};
+struct Unknown : Message {};
+
+TEST(TypeDispatcherTest, DispatchByDynamicType) {
+  std::string called;
+  TypeDispatcher<Message> dispatcher;
+  dispatcher.on<Notification>([&](Notification *) { called = "notification"; }).on<Request>([&](Request *req) { called = "request " + std::to_string(req->value); });
+
+  Notification notification;
+  Request request;
+  request.value = 3;
+  dispatcher.dispatch(&notification);
+  EXPECT_EQ(called, "notification");
+  dispatcher.dispatch(&request);
+  EXPECT_EQ(called, "request 3");
+}
+
+TEST(TypeDispatcherTest, EarlierRegistrationWins) {
+  std::string called;
+  TypeDispatcher<Message> dispatcher;
+  dispatcher.on<CombinedNotification>([&](CombinedNotification *) { called = "combined"; }).on<Notification>([&](Notification *) { called = "notification"; });
+
+  CombinedNotification combined;
+  Notification notification;
+  dispatcher.dispatch(&combined);
+  EXPECT_EQ(called, "combined");
+  dispatcher.dispatch(&notification);
+  EXPECT_EQ(called, "notification");
+
+  // a subclass without its own handler is handled as its base class
+  TypeDispatcher<Message> base_first;
+  base_first.on<Notification>([&](Notification *) { called = "notification"; }).on<CombinedNotification>([&](CombinedNotification *) { called = "combined"; });
+  base_first.dispatch(&combined);
+  EXPECT_EQ(called, "notification");
+}
+
+TEST(TypeDispatcherTest, ReturnResultAndFallback) {
+  TypeDispatcher<Message, bool> dispatcher;
+  dispatcher.on<Request>([](Request *req) { return req->value > 0; });
+  Request request;
+  request.value = 1;
+  Unknown unknown;
+  EXPECT_TRUE(dispatcher.dispatch(&request));
+  // no handler and no fallback: Result{}
+  EXPECT_FALSE(dispatcher.dispatch(&unknown));
+
+  dispatcher.otherwise([](Message *) { return true; });
+  EXPECT_TRUE(dispatcher.dispatch(&unknown));
+  EXPECT_EQ(dispatcher.unhandledCount(), 2);
+}
+
+TEST(TypeDispatcherTest, CountDispatchedMessages) {
+  TypeDispatcher<Message> dispatcher;
+  dispatcher.on<Notification>([](Notification *) {}).on<Request>([](Request *) {});
+  Notification notification;
+  CombinedNotification combined;
+  Request request;
+  for (int i = 0; i < 3; i++) dispatcher.dispatch(&notification);
+  dispatcher.dispatch(&combined);
+  dispatcher.dispatch(&request);
+
+  std::vector<std::pair<std::string, uint64_t>> counts;
+  dispatcher.forEachCount([&](const std::type_info &type, uint64_t count) { counts.emplace_back(type.name(), count); });
+  ASSERT_EQ(counts.size(), 2);
+  EXPECT_EQ(counts[0].first, typeid(Notification).name());
+  EXPECT_EQ(counts[0].second, 4);
+  EXPECT_EQ(counts[1].first, typeid(Request).name());
+  EXPECT_EQ(counts[1].second, 1);
+  EXPECT_EQ(dispatcher.unhandledCount(), 0);
+}
+
+}  // namespace
@@ -1,3 +1,6 @@
+#pragma once
+#include <array>
+#include <cstddef>
 #include <iostream>
 #include <map>
 #include "backends/interfaces/IRandomNumberGenerator.h"
@@ -35,4 +38,71 @@ Label samplingWithWeights(std::map<Label, double> weights, double rand) {
   }
   return (--weights.end())->first;
 }
+
+/*
+  Description:
+    Precomputed counterpart of samplingWithWeights for a fixed set of N weights.
+    The cumulative distribution is built once, and a guide table maps floor(rand * N) to the first label
+    that can be selected, so a draw costs one random number and O(1) comparisons on average.
+    Labels are the indices of the weights and a given rand selects the same label as samplingWithWeights
+    over a map whose keys are in the same order.
+  Args:
+    std::array<double, N> weights: weight of each label, they don't have to sum up to 1.
+  Example:
+    CumulativeDistribution<4> dist({0.2, 0.3, 0.3, 0.2});
+    dist.sample(0.4)
+
+    returns 1
+ */
+template <std::size_t N>
+class CumulativeDistribution {
+  static_assert(N > 0, "CumulativeDistribution needs at least one label");
+
+ public:
+  // all the weight on the label 0
+  CumulativeDistribution() {
+    cdf.fill(1.0);
+    guide.fill(0);
+  }
+
+  explicit CumulativeDistribution(const std::array<double, N> &weights) {
+    double sum = 0;
+    for (auto w : weights) {
+      sum += w;
+    }
+    double ceil = 0;
+    for (std::size_t i = 0; i < N; i++) {
+      ceil += weights[i] / sum;
+      cdf[i] = ceil;
+    }
+    // a label with cdf * N < bucket can't be selected by any rand in the bucket, since rand * N >= bucket
+    std::size_t label = 0;
+    for (std::size_t bucket = 0; bucket < N; bucket++) {
+      while (label < N - 1 && cdf[label] * N < bucket) {
+        label++;
+      }
+      guide[bucket] = label;
+    }
+  }
+
+  std::size_t sample(double rand) const {
+    std::size_t bucket = rand * N;
+    if (!(bucket < N)) bucket = N - 1;
+    std::size_t label = guide[bucket];
+    while (label < N - 1 && !(rand <= cdf[label])) {
+      label++;
+    }
+    return label;
+  }
+
+  void sample(const double *rands, std::size_t *labels, std::size_t n) const {
+    for (std::size_t i = 0; i < n; i++) {
+      labels[i] = sample(rands[i]);
+    }
+  }
+
+ private:
+  std::array<double, N> cdf;
+  std::array<std::size_t, N> guide;
+};
 }  // namespace quisp::util_functions
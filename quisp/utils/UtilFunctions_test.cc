@@ -3,6 +3,7 @@
 #include "utils/UtilFunctions.h"
 
 namespace {
+using quisp::util_functions::CumulativeDistribution;
 using quisp::util_functions::samplingWithWeights;
 
 TEST(UtilFunctionsTest, samplingWithWeightsTest1) {
@@ -38,4 +39,38 @@ TEST(UtilFunctionsTest, samplingWithWeightsTest2) {
   r = samplingWithWeights(weights, 1.0);
   EXPECT_EQ(r, ErrorLabel::Y);
 }
-}  // namespace
\ No newline at end of file
+
+TEST(UtilFunctionsTest, cumulativeDistributionMatchesSamplingWithWeights) {
+  std::array<double, 6> weights = {0.05, 0.3, 0, 0.25, 0.0001, 0.3999};
+  std::map<int, double> weight_map;
+  for (int i = 0; i < 6; i++) weight_map[i] = weights[i];
+  CumulativeDistribution<6> dist(weights);
+
+  for (int i = 0; i <= 10000; i++) {
+    double rand = i / 10000.0;
+    EXPECT_EQ(dist.sample(rand), samplingWithWeights(weight_map, rand)) << "rand: " << rand;
+  }
+  EXPECT_EQ(dist.sample(0.05), 0);
+  EXPECT_EQ(dist.sample(0.35), 1);
+  EXPECT_EQ(dist.sample(0.350001), 3);
+}
+
+TEST(UtilFunctionsTest, cumulativeDistributionUnnormalizedWeights) {
+  CumulativeDistribution<4> dist({2, 3, 3, 2});
+  EXPECT_EQ(dist.sample(0.2), 0);
+  EXPECT_EQ(dist.sample(0.5), 1);
+  EXPECT_EQ(dist.sample(0.8), 2);
+  EXPECT_EQ(dist.sample(1.0), 3);
+
+  double rands[4] = {0.2, 0.5, 0.8, 1.0};
+  std::size_t labels[4];
+  dist.sample(rands, labels, 4);
+  EXPECT_EQ(labels[0], 0);
+  EXPECT_EQ(labels[1], 1);
+  EXPECT_EQ(labels[2], 2);
+  EXPECT_EQ(labels[3], 3);
+
+  CumulativeDistribution<4> no_weight;
+  EXPECT_EQ(no_weight.sample(0.9), 0);
+}
+}  // namespace
@@ -0,0 +1,12 @@
+#include "Validation.h"
+
+namespace quisp::utils {
+
+std::optional<ValidationLevel> validationLevelByName(std::string_view name) {
+  if (name == "off") return ValidationLevel::Off;
+  if (name == "cheap") return ValidationLevel::Cheap;
+  if (name == "full") return ValidationLevel::Full;
+  return std::nullopt;
+}
+
+}  // namespace quisp::utils
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+
+namespace quisp::utils {
+
+/**
+ * @brief how much the hot paths check their invariants, for the simulation running on the thread.
+ *
+ * The checks skipped below each level:
+ * - Cheap skips the expensive ones:
+ *   - GraphStateQubit::applyMemoryErrorUntil: the sum and the NaN of the transition matrix row
+ * - Off skips the cheap ones as well:
+ *   - QNicRecord::getQubit: the bounds of the qubit index
+ *   - runtime::MemoryValue: the value types of intValue, outcome and bitset
+ *
+ * The asserts are left to NDEBUG. It's Full unless SharedResource sets its validation_level,
+ * so the unit tests always run with the full checks.
+ */
+enum class ValidationLevel {
+  Off,
+  Cheap,
+  Full,
+};
+
+/// @brief "off", "cheap" or "full", std::nullopt for any other name.
+std::optional<ValidationLevel> validationLevelByName(std::string_view name);
+
+inline thread_local ValidationLevel validation_level = ValidationLevel::Full;
+
+inline void setValidationLevel(ValidationLevel level) { validation_level = level; }
+/// @brief true if the checks of the level run, e.g. validates(ValidationLevel::Full) for an expensive one.
+inline bool validates(ValidationLevel level) { return validation_level >= level; }
+
+}  // namespace quisp::utils
@@ -0,0 +1,30 @@
+#include "Validation.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+using quisp::utils::setValidationLevel;
+using quisp::utils::validates;
+using quisp::utils::ValidationLevel;
+using quisp::utils::validationLevelByName;
+
+TEST(ValidationTest, LevelByName) {
+  EXPECT_EQ(validationLevelByName("off"), ValidationLevel::Off);
+  EXPECT_EQ(validationLevelByName("cheap"), ValidationLevel::Cheap);
+  EXPECT_EQ(validationLevelByName("full"), ValidationLevel::Full);
+  EXPECT_EQ(validationLevelByName("debug"), std::nullopt);
+}
+
+TEST(ValidationTest, LevelsIncludeTheLowerOnes) {
+  EXPECT_TRUE(validates(ValidationLevel::Full));
+  setValidationLevel(ValidationLevel::Cheap);
+  EXPECT_FALSE(validates(ValidationLevel::Full));
+  EXPECT_TRUE(validates(ValidationLevel::Cheap));
+  setValidationLevel(ValidationLevel::Off);
+  EXPECT_FALSE(validates(ValidationLevel::Cheap));
+  EXPECT_TRUE(validates(ValidationLevel::Off));
+  // the other tests run with the full checks
+  setValidationLevel(ValidationLevel::Full);
+}
+
+}  // namespace
@@ -0,0 +1,129 @@
+"""Loads the log of BinaryLogger (LoggerModule.logger = "BinaryLogger") and the event trace of
+SharedResource.event_trace_filename into pandas.
+
+    python binary_log.py result.blog
+    python binary_log.py --diff before.trace after.trace
+"""
+import struct
+import sys
+
+import numpy as np
+import pandas as pd
+
+MAGIC = b"QSPBLOG1"
+STRINGS_BLOCK = 1
+RECORDS_BLOCK = 2
+TRACE_BLOCK = 3
+EVENT_KINDS = ["Packet", "QubitState", "BellPair"]
+TRACE_KINDS = ["Delivery", "Stimulus"]
+
+# the layout of BinaryLogRecord in modules/Logger/BinaryLogger.h
+RECORD_DTYPE = np.dtype([
+    ("simtime", "<f8"),
+    ("kind", "<u4"),
+    ("event_type", "<u4"),
+    ("address", "<i4"),
+    ("partner_addr", "<i4"),
+    ("qnic_type", "<i4"),
+    ("qnic_index", "<i4"),
+    ("qubit_index", "<i4"),
+    ("flags", "<u4"),
+    ("msg_type", "<u4"),
+    ("application_id", "<i4"),
+    ("actual_src_addr", "<i4"),
+    ("actual_dest_addr", "<i4"),
+])
+assert RECORD_DTYPE.itemsize == 56
+
+# the layout of EventTraceRecord in modules/Logger/BinaryLogger.h
+TRACE_DTYPE = np.dtype([
+    ("simtime", "<f8"),
+    ("simtime_raw", "<i8"),
+    ("event_number", "<u8"),
+    ("rng_draws", "<u8"),
+    ("kind", "<u4"),
+    ("module", "<u4"),
+    ("msg_type", "<u4"),
+    ("msg_kind", "<i4"),
+    ("dest_addr", "<i4"),
+    ("num_pairs", "<i4"),
+])
+assert TRACE_DTYPE.itemsize == 56
+
+
+def read_blocks(path, dtype=RECORD_DTYPE, block_type=RECORDS_BLOCK):
+    """returns the string table and the records of the block type as a numpy structured array"""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:8] != MAGIC:
+        raise ValueError(f"{path} is not a binary log")
+    strings = []
+    record_blocks = []
+    pos = 8
+    while pos < len(data):
+        block, count, size = struct.unpack_from("<IIQ", data, pos)
+        pos += 16
+        if block == STRINGS_BLOCK:
+            (first_id,) = struct.unpack_from("<I", data, pos)
+            assert first_id == len(strings)
+            p = pos + 4
+            for _ in range(count):
+                (length,) = struct.unpack_from("<I", data, p)
+                strings.append(data[p + 4:p + 4 + length].decode())
+                p += 4 + length
+        elif block == block_type:
+            record_blocks.append(np.frombuffer(data, dtype=dtype, count=count, offset=pos))
+        pos += size
+    records = np.concatenate(record_blocks) if record_blocks else np.empty(0, dtype=dtype)
+    return strings, records
+
+
+def load(path):
+    """returns the log as a DataFrame, the interned strings as categoricals"""
+    strings, records = read_blocks(path)
+    df = pd.DataFrame(records)
+    categories = pd.Index(strings)
+    for column in ["event_type", "msg_type"]:
+        df[column] = pd.Categorical.from_codes(df[column].astype(np.int64), categories=categories)
+    df["kind"] = pd.Categorical.from_codes(df["kind"].astype(np.int64), categories=EVENT_KINDS)
+    df["busy"] = (df["flags"] & 1).astype(bool)
+    df["allocated"] = (df["flags"] & 2).astype(bool)
+    return df.drop(columns="flags")
+
+
+def load_trace(path):
+    """returns the event trace as a DataFrame, the modules and the message types as categoricals"""
+    strings, records = read_blocks(path, TRACE_DTYPE, TRACE_BLOCK)
+    df = pd.DataFrame(records)
+    categories = pd.Index(strings)
+    for column in ["module", "msg_type"]:
+        df[column] = pd.Categorical.from_codes(df[column].astype(np.int64), categories=categories)
+    df["kind"] = pd.Categorical.from_codes(df["kind"].astype(np.int64), categories=TRACE_KINDS)
+    return df.drop(columns="simtime_raw")
+
+
+def first_divergence(a, b):
+    """returns the index of the first record that differs between the event traces, or None if they're the same"""
+    columns = ["simtime", "kind", "module", "msg_type", "msg_kind", "rng_draws", "dest_addr", "num_pairs"]
+    n = min(len(a), len(b))
+    left = a[columns].head(n).astype(str).reset_index(drop=True)
+    right = b[columns].head(n).astype(str).reset_index(drop=True)
+    differs = (left != right).any(axis=1)
+    if differs.any():
+        return int(differs.idxmax())
+    return None if len(a) == len(b) else n
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 2:
+        raise Exception("No input file! Input the binary log you want to load")
+    if sys.argv[1] == "--diff":
+        a, b = load_trace(sys.argv[2]), load_trace(sys.argv[3])
+        index = first_divergence(a, b)
+        if index is None:
+            print(f"the traces are the same: {len(a)} records")
+        else:
+            print(f"the traces diverge at record {index}:")
+            print(pd.concat([a.iloc[index:index + 1], b.iloc[index:index + 1]]))
+    else:
+        print(load(sys.argv[1]))
@@ -0,0 +1,135 @@
+"""Runs the fixed seed scenarios of simulations/perf.ini and reports the speed of each as JSON, for `make perf`.
+
+For each scenario it reports the events/s, the simulated seconds per wall clock second, the peak RSS of the quisp
+process, and the wall clock time of each module type from SharedResource's event profile. Compare the JSON
+of two releases to see what got faster or slower.
+
+    python perf_suite.py -o perf_results.json
+    python perf_suite.py -c Perf_Linear_5 -c Perf_MIM --label my-branch
+
+run `quisp` with `-c` and `-f` relative to the quisp directory, like simulation_tests does.
+"""
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+import time
+
+QUISP_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "quisp")
+NED_PATH = "modules:channels:networks"
+SCENARIOS = ["Perf_Linear_5", "Perf_Linear_20", "Perf_Linear_100", "Perf_Dumbbell", "Perf_Complex", "Perf_MIM", "Perf_MSM"]
+
+
+def parse_progress(output):
+    """the event count and the sim time at the end of the run, from Cmdenv's message at the end, e.g.
+    <!> Simulation time limit reached -- at t=5s, event #123456
+    or else from the last progress line, e.g.
+    ** Event #1225984   t=10.000104015903   Elapsed: 96.8616s (1m 36s)  76% completed  (76% total)
+
+    >>> parse_progress("** Event #12   t=0.5   Elapsed: 1s\\n** Event #34   t=1.25   Elapsed: 2s\\n")
+    (34, 1.25)
+    >>> parse_progress("** Event #12   t=0.5   Elapsed: 1s\\n<!> Simulation time limit reached -- at t=5s, event #56\\n")
+    (56, 5.0)
+    """
+    end = re.findall(r"at t=([0-9.e+\-]+)s, event #(\d+)", output)
+    if end:
+        sim_time, num_events = end[-1]
+        return int(num_events), float(sim_time)
+    matches = re.findall(r"Event #(\d+)\s+t=([0-9.e+\-]+)", output)
+    if not matches:
+        return 0, 0.0
+    num_events, sim_time = matches[-1]
+    return int(num_events), float(sim_time)
+
+
+def read_profile(path):
+    """the wall clock seconds of each module type in the event profile, the largest first"""
+    if not os.path.exists(path):
+        return {}
+    modules = {}
+    with open(path) as f:
+        for line in f:
+            # a parallel simulation writes a line per partition
+            for module, stat in json.loads(line)["modules"].items():
+                modules[module] = modules.get(module, 0.0) + stat["wall_time_ns"] / 1e9
+    return dict(sorted(modules.items(), key=lambda item: -item[1]))
+
+
+def run_scenario(args, config, profile_path):
+    command = [
+        "./quisp",
+        "-u",
+        "Cmdenv",
+        "-c",
+        config,
+        "-f",
+        args.ini,
+        "-n",
+        NED_PATH,
+        "-r",
+        "0",
+        # Cmdenv reports the events and the sim time at the end of the run
+        "--cmdenv-express-mode=true",
+        "--cmdenv-performance-display=true",
+        f'--**.sharedResource.event_profile_filename="{profile_path}"',
+    ]
+    started = time.monotonic()
+    proc = subprocess.Popen(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, cwd=QUISP_DIR)
+    output = proc.stdout.read().decode(errors="replace")
+    # wait4 gives the resource usage of this process alone, ru_maxrss is in KiB on Linux
+    _, status, usage = os.wait4(proc.pid, 0)
+    wall_time = time.monotonic() - started
+    returncode = os.waitstatus_to_exitcode(status)
+    num_events, sim_time = parse_progress(output)
+    return {
+        "config": config,
+        "status": "ok" if returncode == 0 else "failed",
+        "returncode": returncode,
+        "events": num_events,
+        "sim_time": sim_time,
+        "wall_time": wall_time,
+        "events_per_sec": num_events / wall_time if wall_time > 0 else 0,
+        "simsec_per_sec": sim_time / wall_time if wall_time > 0 else 0,
+        "peak_rss_kib": usage.ru_maxrss,
+        "module_time": read_profile(profile_path),
+        **({} if returncode == 0 else {"output_tail": output[-2000:]}),
+    }
+
+
+def git_describe():
+    try:
+        return subprocess.check_output(["git", "describe", "--always", "--dirty"], cwd=QUISP_DIR, stderr=subprocess.DEVNULL).decode().strip()
+    except (OSError, subprocess.CalledProcessError):
+        return "unknown"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("-c", "--config", action="append", default=None, help=f"a scenario to run (default: all of {', '.join(SCENARIOS)})")
+    parser.add_argument("-f", "--ini", default="simulations/perf.ini", help="the ini file, relative to the quisp directory")
+    parser.add_argument("-o", "--out", default="perf_results.json", help="the JSON file of the results")
+    parser.add_argument("--label", default=None, help="the label of the results, e.g. the release (default: git describe)")
+    args = parser.parse_args()
+
+    results = {"label": args.label or git_describe(), "started": time.strftime("%Y-%m-%dT%H:%M:%S%z"), "scenarios": []}
+    num_failed = 0
+    with tempfile.TemporaryDirectory() as tmp:
+        for config in args.config or SCENARIOS:
+            record = run_scenario(args, config, os.path.join(tmp, f"{config}.jsonl"))
+            results["scenarios"].append(record)
+            if record["status"] != "ok":
+                num_failed += 1
+            print(
+                f"{config}: {record['status']}, {record['events']} events in {record['wall_time']:.1f}s, "
+                f"{record['events_per_sec']:.0f} ev/s, {record['simsec_per_sec']:.3g} simsec/s, peak RSS {record['peak_rss_kib'] / 1024:.0f} MiB"
+            )
+    with open(args.out, "w") as f:
+        json.dump(results, f, indent=2)
+    sys.exit(1 if num_failed > 0 else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,234 @@
+"""Runs all the runs of a parameter study (the iteration and repeat variables of a config) on a pool of quisp processes.
+
+Each idle worker takes the next pending run, so long runs don't hold back the others. The workers are pinned to
+their own cores, spread over the NUMA nodes. The results are appended to <out>/results.jsonl as the runs finish,
+and a sweep started again with the same <out> skips the runs that already finished.
+
+    python sweep.py -c Layer2_Simple_MIM_MM -f simulations/simulation_test.ini -j 8 -o sweep_out
+    python sweep.py ... --collect "Tomography_{config}_{run}.csv"   # merge the per run CSV outputs into <out>/<name>
+    python sweep.py ... --runs-per-process 50   # the short runs in batches, without a process per run
+
+run `quisp` with `-c` and `-f` relative to the quisp directory, like simulation_tests does.
+"""
+import argparse
+import asyncio
+import csv
+import glob
+import json
+import os
+import re
+import sys
+import time
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+from simulation_tests.utils import parse_output  # noqa: E402
+
+QUISP_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "quisp")
+NED_PATH = "modules:channels:networks"
+
+
+def quisp_command(args, *options):
+    return ["./quisp", "-u", "Cmdenv", "-c", args.config, "-f", args.ini, "-n", NED_PATH, *options]
+
+
+async def list_runs(args):
+    """the run numbers of the config, from `quisp -q runnumbers`"""
+    proc = await asyncio.create_subprocess_exec(
+        *quisp_command(args, "-s", "-q", "runnumbers", *(["-r", args.runs] if args.runs else [])),
+        stdout=asyncio.subprocess.PIPE,
+        stderr=asyncio.subprocess.PIPE,
+        cwd=QUISP_DIR,
+    )
+    stdout, stderr = await proc.communicate()
+    if proc.returncode != 0:
+        raise RuntimeError(stderr.decode())
+    return [int(n) for n in re.findall(r"\d+", stdout.decode().split(":")[-1])]
+
+
+def numa_cpus():
+    """the usable cpus, interleaved over the NUMA nodes so that the first workers land on different nodes"""
+    usable = sorted(os.sched_getaffinity(0))
+    nodes = []
+    for cpulist in sorted(glob.glob("/sys/devices/system/node/node*/cpulist")):
+        with open(cpulist) as f:
+            cpus = []
+            for part in f.read().strip().split(","):
+                if not part:
+                    continue
+                first, _, last = part.partition("-")
+                cpus += range(int(first), int(last or first) + 1)
+        nodes.append([cpu for cpu in cpus if cpu in usable])
+    nodes = [node for node in nodes if node]
+    if not nodes:
+        return usable
+    interleaved = []
+    for i in range(max(len(node) for node in nodes)):
+        interleaved += [node[i] for node in nodes if i < len(node)]
+    return interleaved
+
+
+def finished_runs(results_path):
+    """the runs that already succeeded in a previous sweep with the same output directory"""
+    done = set()
+    if not os.path.exists(results_path):
+        return done
+    with open(results_path) as f:
+        for line in f:
+            try:
+                record = json.loads(line)
+            except json.JSONDecodeError:
+                continue  # the last line of an interrupted sweep
+            if record["status"] == "ok":
+                done.add(record["run"])
+    return done
+
+
+def merge_csv(source, destination, run):
+    """appends the rows of the run's CSV output to the merged file, with a run column"""
+    if not os.path.exists(source):
+        return 0
+    with open(source, newline="") as f:
+        rows = list(csv.DictReader(f))
+    if not rows:
+        return 0
+    write_header = not os.path.exists(destination)
+    with open(destination, "a", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=["run", *rows[0].keys()])
+        if write_header:
+            writer.writeheader()
+        for row in rows:
+            writer.writerow({"run": run, **row})
+    return len(rows)
+
+
+# Cmdenv starts each run of a batch with this line
+RUN_HEADER = re.compile(r"^Preparing for running configuration .*, run #(\d+)")
+
+
+def run_record(args, run, status, elapsed, cpu, results, returncode=None):
+    return {
+        "config": args.config,
+        "run": run,
+        "status": status,
+        "returncode": returncode,
+        "elapsed": elapsed,
+        "cpu": cpu,
+        "results": results,
+    }
+
+
+async def run_batch(args, runs, cpu):
+    """runs the runs one after another in a single quisp process, and returns the record of each of them.
+
+    the output of the process is split into the runs by the header Cmdenv prints before each run. a failed run
+    doesn't stop the rest of the batch, and the runs the process never started are failed too.
+    """
+    options = ["-r", ",".join(str(run) for run in runs), "--cmdenv-express-mode=true", "--cmdenv-stop-batch-on-error=false", *[f"--{option}" for option in args.set]]
+    proc = await asyncio.create_subprocess_exec(
+        *quisp_command(args, *options),
+        stdout=asyncio.subprocess.PIPE,
+        stderr=asyncio.subprocess.STDOUT,
+        cwd=QUISP_DIR,
+        preexec_fn=(lambda: os.sched_setaffinity(0, {cpu})) if cpu is not None else None,
+    )
+    started = {}
+    failed = set()
+    results = {}
+    run = None
+    log = None
+    async for line in proc.stdout:
+        text = line.decode().strip()
+        header = RUN_HEADER.match(text)
+        if header:
+            if log is not None:
+                log.close()
+            run = int(header.group(1))
+            started[run] = time.monotonic()
+            results[run] = {}
+            log = open(os.path.join(args.out, "logs", f"{args.config}-{run}.out"), "wb")
+        if log is None:
+            continue
+        log.write(line)
+        if text.startswith("<!> Error"):
+            failed.add(run)
+        result = parse_output(text)
+        if result:
+            results[run][result["name"]] = result["data"]
+    await proc.wait()
+    finished = time.monotonic()
+    if log is not None:
+        log.close()
+    # a crash ends the process in the middle of its last run
+    if run is not None and (proc.returncode < 0 or (proc.returncode != 0 and len(runs) == 1)):
+        failed.add(run)
+
+    records = []
+    for i, run in enumerate(runs):
+        if run not in started:
+            records.append(run_record(args, run, "failed", 0.0, cpu, {}, proc.returncode))
+            continue
+        ends = [started[later] for later in runs[i + 1 :] if later in started]
+        elapsed = (ends[0] if ends else finished) - started[run]
+        records.append(run_record(args, run, "failed" if run in failed else "ok", elapsed, cpu, results[run], proc.returncode))
+    return records
+
+
+async def sweep(args):
+    os.makedirs(os.path.join(args.out, "logs"), exist_ok=True)
+    results_path = os.path.join(args.out, "results.jsonl")
+    done = finished_runs(results_path)
+    pending = asyncio.Queue()
+    for run in await list_runs(args):
+        if run not in done:
+            pending.put_nowait(run)
+    total = pending.qsize()
+    print(f"{args.config}: {total} runs to go, {len(done)} finished before")
+
+    cpus = numa_cpus() if args.pin else []
+    num_failed = 0
+
+    async def worker(slot):
+        nonlocal num_failed
+        cpu = cpus[slot % len(cpus)] if cpus else None
+        while not pending.empty():
+            runs = [pending.get_nowait() for _ in range(min(args.runs_per_process, pending.qsize()))]
+            for record in await run_batch(args, runs, cpu):
+                run = record["run"]
+                if args.collect and record["status"] == "ok":
+                    source = os.path.join(QUISP_DIR, args.collect.format(config=args.config, run=run))
+                    merge_csv(source, os.path.join(args.out, os.path.basename(args.collect.format(config=args.config, run="all"))), run)
+                # one line per run, so an interrupted sweep keeps all the finished ones
+                with open(results_path, "a") as f:
+                    f.write(json.dumps(record) + "\n")
+                if record["status"] != "ok":
+                    num_failed += 1
+                print(f"[{total - pending.qsize()}/{total}] run {run}: {record['status']} in {record['elapsed']:.1f}s")
+
+    await asyncio.gather(*[worker(slot) for slot in range(args.jobs)])
+    return num_failed
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("-c", "--config", required=True, help="the config of the ini file to sweep")
+    parser.add_argument("-f", "--ini", default="networks/omnetpp.ini", help="the ini file, relative to the quisp directory")
+    parser.add_argument("-r", "--runs", default=None, help="the run filter of quisp -r, e.g. 0..9 (default: all runs)")
+    parser.add_argument("-j", "--jobs", type=int, default=len(os.sched_getaffinity(0)), help="the number of quisp processes")
+    parser.add_argument("-o", "--out", default="sweep_out", help="the directory of the logs and the merged results")
+    parser.add_argument("--set", action="append", default=[], metavar="OPTION=VALUE", help="an option passed to every run as --OPTION=VALUE")
+    parser.add_argument("--collect", default=None, help="a CSV output of each run to merge, with {config} and {run} placeholders")
+    parser.add_argument(
+        "--runs-per-process",
+        type=int,
+        default=1,
+        help="the runs each quisp process runs one after another, which saves the process start and the network setup caches of the short runs",
+    )
+    parser.add_argument("--no-pin", dest="pin", action="store_false", help="don't pin the workers to cores")
+    args = parser.parse_args()
+    if args.runs_per_process < 1:
+        parser.error("--runs-per-process must be positive")
+    sys.exit(1 if asyncio.run(sweep(args)) > 0 else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,55 @@
+"""Reads the link tomography results written by HardwareMonitor.
+
+HardwareMonitor buffers the results of all the nodes in SharedResource and writes them
+to `<tomography_output_filename>.csv` at the end of the simulation, one row per link and node.
+
+usage: python tomography_results.py Tomography_<network>.csv
+"""
+import csv
+import sys
+
+import numpy as np
+
+INT_COLUMNS = [
+    "tomography_measurements",
+    "actual_measurements",
+    "GOD_clean_pair_total",
+    "GOD_X_pair_total",
+    "GOD_Y_pair_total",
+    "GOD_Z_pair_total",
+]
+STR_COLUMNS = ["node", "partner"]
+
+
+def parse_row(row):
+    result = {}
+    real = np.zeros((4, 4))
+    imag = np.zeros((4, 4))
+    for key, value in row.items():
+        if key in STR_COLUMNS:
+            result[key] = value
+        elif key in INT_COLUMNS:
+            result[key] = int(value)
+        elif key.startswith("dm_real_"):
+            real[int(key[-2]), int(key[-1])] = float(value)
+        elif key.startswith("dm_imag_"):
+            imag[int(key[-2]), int(key[-1])] = float(value)
+        else:
+            result[key] = float(value)
+    result["density_matrix"] = real + 1j * imag
+    return result
+
+
+def read_results(file_path):
+    with open(file_path, newline="") as f:
+        return [parse_row(row) for row in csv.DictReader(f)]
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 2:
+        raise Exception("No input file! Input the tomography result file")
+    for link in read_results(sys.argv[1]):
+        print(
+            "{node}<-->{partner}: fidelity={fidelity:.6f} X={x_error_rate:.6f} Y={y_error_rate:.6f} Z={z_error_rate:.6f} "
+            "bellpair_per_sec={bellpair_per_sec:.3f} cost={link_cost:.6g}".format(**link)
+        )